@@ -48,6 +48,9 @@ const eth_mac_addr_t *u3_net_stack_get_mac_addr(const uint8_t ethno);
 
 uint32_t u3_net_stack_get_stat_counts(const uint8_t ethno);
 
+//! number of UDP packets received for the given port
+uint32_t u3_net_stack_get_udp_counts(const uint16_t port);
+
 //------------------ udp handling ------------------------------------
 
 typedef void (*u3_net_stack_udp_handler_t)(
@@ -99,7 +102,8 @@ void u3_net_stack_send_icmp_pkt(
 
 //------------------ entry point ------------------------------------
 
-void u3_net_stack_handle_one(void);
+//! handle one received packet, returns false when there was none
+bool u3_net_stack_handle_one(void);
 
 //------------------ arp handling ------------------------------------
 
@@ -67,6 +67,7 @@ static uint32_t chksum_buffer(
 #define ARP_CACHE_NENTRIES 32
 
 static size_t arp_cache_wr_index;
+static size_t arp_cache_last_index;
 
 static struct ip_addr arp_cache_ips[ARP_CACHE_NENTRIES];
 static eth_mac_addr_t arp_cache_macs[ARP_CACHE_NENTRIES];
@@ -74,12 +75,20 @@ static uint8_t arp_cache_eths[ARP_CACHE_NENTRIES];
 
 void u3_net_stack_arp_cache_update(const struct ip_addr *ip_addr, const eth_mac_addr_t *mac_addr, const uint8_t ethno)
 {
+    //fast path: every packet of a stream comes from the same host,
+    //so check the entry hit last time before searching the cache
+    const size_t last = arp_cache_last_index;
+    if (memcmp(ip_addr, arp_cache_ips+last, sizeof(struct ip_addr)) == 0 &&
+        memcmp(mac_addr, arp_cache_macs+last, sizeof(eth_mac_addr_t)) == 0 &&
+        arp_cache_eths[last] == ethno) return;
+
     for (size_t i = 0; i < ARP_CACHE_NENTRIES; i++)
     {
         if (memcmp(ip_addr, arp_cache_ips+i, sizeof(struct ip_addr)) == 0)
         {
             memcpy(arp_cache_macs+i, mac_addr, sizeof(eth_mac_addr_t));
             arp_cache_eths[i] = ethno;
+            arp_cache_last_index = i;
             return;
         }
     }
@@ -87,6 +96,7 @@ void u3_net_stack_arp_cache_update(const struct ip_addr *ip_addr, const eth_mac_
     memcpy(arp_cache_ips+arp_cache_wr_index, ip_addr, sizeof(struct ip_addr));
     memcpy(arp_cache_macs+arp_cache_wr_index, mac_addr, sizeof(eth_mac_addr_t));
     arp_cache_eths[arp_cache_wr_index] = ethno;
+    arp_cache_last_index = arp_cache_wr_index;
     arp_cache_wr_index++;
 }
 
@@ -147,6 +157,25 @@ static eth_mac_addr_t net_conf_macs[MAX_NETHS];
 static struct ip_addr net_conf_subnets[MAX_NETHS];
 static struct ip_addr net_conf_bcasts[MAX_NETHS];
 static uint32_t net_stat_counts[MAX_NETHS];
+static padded_arp_t arp_reply_templates[MAX_NETHS];
+
+static void init_arp_reply_template(const uint8_t ethno)
+{
+    //everything but the requester's addresses is known up front
+    padded_arp_t *reply = &arp_reply_templates[ethno];
+    memset(reply, 0, sizeof(padded_arp_t));
+    reply->eth.ethno = ethno;
+    memcpy(&reply->eth.src, u3_net_stack_get_mac_addr(ethno), sizeof(eth_mac_addr_t));
+    reply->eth.ethertype = ETHERTYPE_ARP;
+
+    reply->arp.ar_hrd = ARPHRD_ETHER;
+    reply->arp.ar_pro = ETHERTYPE_IPV4;
+    reply->arp.ar_hln = sizeof(eth_mac_addr_t);
+    reply->arp.ar_pln = sizeof(struct ip_addr);
+    reply->arp.ar_op = ARPOP_REPLY;
+    memcpy(reply->arp.ar_sha, u3_net_stack_get_mac_addr(ethno), sizeof(eth_mac_addr_t));
+    memcpy(reply->arp.ar_sip, u3_net_stack_get_ip_addr(ethno), sizeof(struct ip_addr));
+}
 
 void u3_net_stack_init_eth(
     const uint8_t ethno,
@@ -159,6 +188,7 @@ void u3_net_stack_init_eth(
     memcpy(&net_conf_ips[ethno], ip, sizeof(struct ip_addr));
     memcpy(&net_conf_subnets[ethno], subnet, sizeof(struct ip_addr));
     net_stat_counts[ethno] = 0;
+    init_arp_reply_template(ethno);
 }
 
 const struct ip_addr *u3_net_stack_get_ip_addr(const uint8_t ethno)
@@ -236,26 +266,15 @@ static void send_eth_pkt(
  **********************************************************************/
 static void send_arp_reply(
     const uint8_t ethno,
-    const struct arp_eth_ipv4 *req,
-    const eth_mac_addr_t *our_mac
+    const struct arp_eth_ipv4 *req
 ){
-    padded_arp_t reply;
-    reply.eth.ethno = ethno;
-    memcpy(&reply.eth.dst, (eth_mac_addr_t *)req->ar_sha, sizeof(eth_mac_addr_t));
-    memcpy(&reply.eth.src, u3_net_stack_get_mac_addr(ethno), sizeof(eth_mac_addr_t));
-    reply.eth.ethertype = ETHERTYPE_ARP;
-
-    reply.arp.ar_hrd = req->ar_hrd;
-    reply.arp.ar_pro = req->ar_pro;
-    reply.arp.ar_hln = req->ar_hln;
-    reply.arp.ar_pln = req->ar_pln;
-    reply.arp.ar_op = ARPOP_REPLY;
-    memcpy(reply.arp.ar_sha, our_mac,     sizeof(eth_mac_addr_t));
-    memcpy(reply.arp.ar_sip, req->ar_tip, sizeof(struct ip_addr));
-    memcpy(reply.arp.ar_tha, req->ar_sha, sizeof(eth_mac_addr_t));
-    memcpy(reply.arp.ar_tip, req->ar_sip, sizeof(struct ip_addr));
-
-    send_eth_pkt(&reply, sizeof(reply), NULL, 0, NULL, 0);
+    //only the requester's addresses change from the template
+    padded_arp_t *reply = &arp_reply_templates[ethno];
+    memcpy(&reply->eth.dst, (eth_mac_addr_t *)req->ar_sha, sizeof(eth_mac_addr_t));
+    memcpy(reply->arp.ar_tha, req->ar_sha, sizeof(eth_mac_addr_t));
+    memcpy(reply->arp.ar_tip, req->ar_sip, sizeof(struct ip_addr));
+
+    send_eth_pkt(reply, sizeof(padded_arp_t), NULL, 0, NULL, 0);
 }
 
 void u3_net_stack_send_arp_request(const uint8_t ethno, const struct ip_addr *addr)
@@ -305,7 +324,7 @@ static void handle_arp_packet(const uint8_t ethno, const struct arp_eth_ipv4 *p)
         UHD_FW_TRACE(DEBUG, "ARPOP_REQUEST");
         if (memcmp(p->ar_tip, u3_net_stack_get_ip_addr(ethno), sizeof(struct ip_addr)) == 0)
         {
-            send_arp_reply(ethno, p, u3_net_stack_get_mac_addr(ethno));
+            send_arp_reply(ethno, p);
         }
     }
 }
@@ -317,6 +336,7 @@ static void handle_arp_packet(const uint8_t ethno, const struct arp_eth_ipv4 *p)
 
 static uint16_t udp_handler_ports[UDP_NHANDLERS];
 static u3_net_stack_udp_handler_t udp_handlers[UDP_NHANDLERS];
+static uint32_t udp_handler_counts[UDP_NHANDLERS];
 static size_t udp_handlers_index = 0;
 
 void u3_net_stack_register_udp_handler(
@@ -328,10 +348,20 @@ void u3_net_stack_register_udp_handler(
     {
         udp_handler_ports[udp_handlers_index] = port;
         udp_handlers[udp_handlers_index] = handler;
+        udp_handler_counts[udp_handlers_index] = 0;
         udp_handlers_index++;
     }
 }
 
+uint32_t u3_net_stack_get_udp_counts(const uint16_t port)
+{
+    for (size_t i = 0; i < udp_handlers_index; i++)
+    {
+        if (udp_handler_ports[i] == port) return udp_handler_counts[i];
+    }
+    return 0;
+}
+
 void u3_net_stack_send_udp_pkt(
     const uint8_t ethno,
     const struct ip_addr *dst,
@@ -388,6 +418,7 @@ static void handle_udp_packet(
     {
         if (udp_handler_ports[i] == udp->dest)
         {
+            udp_handler_counts[i]++;
             udp_handlers[i](
                 ethno, src, u3_net_stack_get_ip_addr(ethno), udp->src, udp->dest,
                 ((const uint8_t *)udp) + sizeof(struct udp_hdr),
@@ -575,15 +606,15 @@ static void handle_eth_packet(const void *buff, const size_t num_bytes)
     else return;    // Not ARP or IPV4, ignore
 }
 
-void u3_net_stack_handle_one(void)
+bool u3_net_stack_handle_one(void)
 {
     size_t num_bytes = 0;
     const void *ptr = wb_pkt_iface64_rx_try_claim(pkt_iface_config, &num_bytes);
-    if (ptr != NULL)
-    {
-        UHD_FW_TRACE_FSTR(DEBUG, "u3_net_stack_handle_one got %u bytes", (unsigned)num_bytes);
-        incr_stat_counts(ptr);
-        handle_eth_packet(ptr, num_bytes);
-        wb_pkt_iface64_rx_release(pkt_iface_config);
-    }
+    if (ptr == NULL) return false;
+
+    UHD_FW_TRACE_FSTR(DEBUG, "u3_net_stack_handle_one got %u bytes", (unsigned)num_bytes);
+    incr_stat_counts(ptr);
+    handle_eth_packet(ptr, num_bytes);
+    wb_pkt_iface64_rx_release(pkt_iface_config);
+    return true;
 }
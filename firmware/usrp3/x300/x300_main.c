@@ -134,7 +134,7 @@ void handle_udp_fpga_prog(
 )
 {
     const x300_fpga_prog_t *request = (const x300_fpga_prog_t *)buff;
-    x300_fpga_prog_flags_t reply = {0};
+    x300_fpga_prog_reply_t reply = {0};
     bool status = true;
 
     if (buff == NULL) {
@@ -142,6 +142,9 @@ void handle_udp_fpga_prog(
     } else if (num_bytes < offsetof(x300_fpga_prog_t, data)) {
         reply.flags |= X300_FPGA_PROG_FLAGS_ERROR;
     } else {
+        //echo the location so the host can match acks to packets in flight
+        reply.sector = request->sector;
+        reply.index = request->index;
         if (request->flags & X300_FPGA_PROG_FLAGS_INIT) {
             STATUS_MERGE(chinch_flash_init(), status);
         } else if (request->flags & X300_FPGA_PROG_FLAGS_CLEANUP) {
@@ -152,6 +155,21 @@ void handle_udp_fpga_prog(
         } else if (request->flags & X300_FPGA_PROG_CONFIG_STATUS) {
             if (chinch_get_config_status() != CHINCH_CONFIG_COMPLETED)
                 reply.flags |= X300_FPGA_PROG_FLAGS_ERROR;
+        } else if (request->flags & X300_FPGA_PROG_FLAGS_CHECKSUM) {
+            //Fletcher checksum (modulo 2^16) of size words starting at index
+            uint16_t data[CHINCH_FLASH_MAX_BUF_WRITES];
+            uint16_t sum1 = 0, sum2 = 0;
+            STATUS_MERGE(chinch_flash_select_sector(request->sector), status);
+            for (uint32_t data_idx = 0; (data_idx < request->size) && status; data_idx += CHINCH_FLASH_MAX_BUF_WRITES) {
+                uint32_t rd_len = (request->size - data_idx) >= CHINCH_FLASH_MAX_BUF_WRITES ?
+                    CHINCH_FLASH_MAX_BUF_WRITES : (request->size - data_idx);
+                STATUS_MERGE(chinch_flash_read_buf((request->index + data_idx)*2, data, rd_len), status);
+                for (uint32_t i = 0; i < rd_len; i++) {
+                    sum1 += data[i];
+                    sum2 += sum1;
+                }
+            }
+            reply.checksum = ((uint32_t)sum2 << 16) | sum1;
         } else {
             STATUS_MERGE(chinch_flash_select_sector(request->sector), status);
             if (request->flags & X300_FPGA_PROG_FLAGS_ERASE)
@@ -405,6 +423,8 @@ static void handle_link_state(void)
 /***********************************************************************
  * Main loop runs all the handlers
  **********************************************************************/
+#define NET_MAX_BURST 16 //packets handled in a row before the other jobs run
+
 int main(void)
 {
     x300_init((x300_eeprom_map_t *)&shmem[X300_FW_SHMEM_IDENT]);
@@ -413,6 +433,11 @@ int main(void)
     u3_net_stack_register_udp_handler(X300_FPGA_PROG_UDP_PORT, &handle_udp_fpga_prog);
     u3_net_stack_register_udp_handler(X300_MTU_DETECT_UDP_PORT, &handle_udp_mtu_detect);
 
+    shmem[X300_FW_SHMEM_NET_PKTS] = 0;
+    shmem[X300_FW_SHMEM_NET_CTRL_PKTS] = 0;
+    shmem[X300_FW_SHMEM_NET_MAX_BACKLOG] = 0;
+    shmem[X300_FW_SHMEM_WARM_STATE] = 0;
+
     uint32_t last_cronjob = 0;
 
     while(true)
@@ -438,7 +463,17 @@ int main(void)
         }
 
         //run the network stack - poll and handle
-        u3_net_stack_handle_one();
+        //drain whatever is waiting before the slower jobs below, so that
+        //control packets and ARP requests do not queue up behind them
+        size_t backlog = 0;
+        while (backlog < NET_MAX_BURST && u3_net_stack_handle_one())
+        {
+            backlog++;
+            handle_claim(ticks_now);
+        }
+        if (backlog > shmem[X300_FW_SHMEM_NET_MAX_BACKLOG]) shmem[X300_FW_SHMEM_NET_MAX_BACKLOG] = backlog;
+        shmem[X300_FW_SHMEM_NET_PKTS] += backlog;
+        shmem[X300_FW_SHMEM_NET_CTRL_PKTS] = u3_net_stack_get_udp_counts(X300_FW_COMMS_UDP_PORT);
 
         //run the PCIe listener - poll and fwd to wishbone
         forward_pcie_user_xact_to_wb();
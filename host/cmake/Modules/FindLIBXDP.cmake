@@ -0,0 +1,53 @@
+#
+# Copyright 2017 Ettus Research LLC
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# - Find libxdp (AF_XDP socket helpers)
+# This module defines
+#  LIBXDP_INCLUDE_DIRS, where to find xdp/xsk.h
+#  LIBXDP_LIBRARIES, the libraries needed for AF_XDP sockets (libxdp, libbpf)
+#  LIBXDP_FOUND, If false, do not try to use AF_XDP.
+
+INCLUDE(FindPkgConfig)
+PKG_CHECK_MODULES(PC_LIBXDP QUIET libxdp)
+PKG_CHECK_MODULES(PC_LIBBPF QUIET libbpf)
+
+FIND_PATH(LIBXDP_INCLUDE_DIRS
+    NAMES xdp/xsk.h
+    HINTS $ENV{LIBXDP_DIR}/include ${PC_LIBXDP_INCLUDEDIR}
+    PATHS /usr/local/include /usr/include
+)
+
+FIND_LIBRARY(LIBXDP_LIBRARY
+    NAMES xdp
+    HINTS $ENV{LIBXDP_DIR}/lib ${PC_LIBXDP_LIBDIR}
+    PATHS /usr/local/lib /usr/lib
+)
+
+FIND_LIBRARY(LIBBPF_LIBRARY
+    NAMES bpf
+    HINTS $ENV{LIBXDP_DIR}/lib ${PC_LIBBPF_LIBDIR}
+    PATHS /usr/local/lib /usr/lib
+)
+
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LIBXDP DEFAULT_MSG LIBXDP_LIBRARY LIBBPF_LIBRARY LIBXDP_INCLUDE_DIRS)
+
+IF(LIBXDP_FOUND)
+    SET(LIBXDP_LIBRARIES ${LIBXDP_LIBRARY} ${LIBBPF_LIBRARY})
+ENDIF(LIBXDP_FOUND)
+
+MARK_AS_ADVANCED(LIBXDP_INCLUDE_DIRS LIBXDP_LIBRARY LIBBPF_LIBRARY)
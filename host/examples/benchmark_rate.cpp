@@ -19,15 +19,21 @@
 #include <uhd/convert.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/transport/zero_copy.hpp>
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+#include <boost/chrono.hpp>
 //#include <boost/atomic.hpp>
 #include <iostream>
+#include <fstream>
 #include <complex>
 #include <cstdlib>
+#include <cmath>
 
 namespace po = boost::program_options;
 
@@ -38,17 +44,137 @@ const double INIT_DELAY    = 0.05;  // 50mS initial delay before transmit
 // This is just an example, after all.
 typedef bool atomic_bool;
 
+/***********************************************************************
+ * Per-call latency histogram
+ **********************************************************************/
+//! Logarithmic histogram of call durations: 8 buckets per power of 2,
+//! so the percentiles are within 1/8th of the exact value
+class latency_histogram
+{
+public:
+    latency_histogram(void): _buckets(NUM_BUCKETS, 0), _count(0), _max_ns(0) {}
+
+    void add(const unsigned long long ns)
+    {
+        _buckets[bucket(ns)]++;
+        _count++;
+        _max_ns = std::max(_max_ns, ns);
+    }
+
+    //! The call duration (ns) that a fraction q of the calls did not exceed
+    double percentile(const double q) const
+    {
+        if (_count == 0) return 0.0;
+        const unsigned long long rank = (unsigned long long)(std::ceil(q*_count));
+        unsigned long long num = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            num += _buckets[i];
+            if (num >= rank and num != 0) {
+                return double(std::min(upper_edge(i), _max_ns));
+            }
+        }
+        return double(_max_ns);
+    }
+
+    unsigned long long count(void) const { return _count; }
+    unsigned long long max_ns(void) const { return _max_ns; }
+
+private:
+    static const size_t SUB_BITS = 3;
+    static const size_t NUM_SUB = 1 << SUB_BITS;
+    static const size_t NUM_BUCKETS = NUM_SUB + (64 - SUB_BITS)*NUM_SUB;
+
+    static size_t bucket(const unsigned long long ns)
+    {
+        if (ns < NUM_SUB) return size_t(ns);
+        size_t msb = 0;
+        while ((ns >> msb) > 1) msb++;
+        const size_t shift = msb - SUB_BITS;
+        return NUM_SUB + shift*NUM_SUB + size_t((ns >> shift) & (NUM_SUB - 1));
+    }
+
+    static unsigned long long upper_edge(const size_t index)
+    {
+        if (index < NUM_SUB) return index;
+        const size_t shift = (index - NUM_SUB)/NUM_SUB;
+        const unsigned long long sub = NUM_SUB + (index - NUM_SUB)%NUM_SUB;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<unsigned long long> _buckets;
+    unsigned long long _count;
+    unsigned long long _max_ns;
+};
+
 /***********************************************************************
  * Test result variables
  **********************************************************************/
-unsigned long long num_overflows = 0;
-unsigned long long num_underflows = 0;
-unsigned long long num_rx_samps = 0;
-unsigned long long num_tx_samps = 0;
-unsigned long long num_dropped_samps = 0;
-unsigned long long num_seq_errors = 0;
-unsigned long long num_late_commands = 0;
-unsigned long long num_timeouts = 0;
+//! The results of one streamer, written by its threads only
+struct streamer_results_t
+{
+    streamer_results_t(void):
+        cpu(-1), num_samps(0), num_dropped_samps(0), num_overflows(0),
+        num_late_commands(0), num_timeouts(0), num_underflows(0),
+        num_seq_errors(0), cpu_load(-1.0)
+    {}
+    std::vector<size_t> channels;
+    int cpu; //the CPU the thread is pinned to, or -1
+    unsigned long long num_samps;
+    unsigned long long num_dropped_samps;
+    unsigned long long num_overflows;
+    unsigned long long num_late_commands;
+    unsigned long long num_timeouts;
+    unsigned long long num_underflows;
+    unsigned long long num_seq_errors;
+    latency_histogram latency; //of the recv() or send() calls
+    double cpu_load; //CPU time over wall time of the thread, -1 if unknown
+};
+
+//! Set the priority of a streamer thread, and pin it if a CPU was given
+static void setup_streamer_thread(const streamer_results_t &results)
+{
+    if (results.cpu < 0) {
+        uhd::set_thread_priority_safe();
+    } else if (not uhd::set_thread_priority_safe(uhd::default_thread_priority, true, size_t(results.cpu))) {
+        std::cerr << "Could not pin the streamer thread to CPU " << results.cpu << std::endl;
+    }
+}
+
+//! Measures the CPU time a thread spends over the wall time
+class thread_load_meter
+{
+public:
+    thread_load_meter(void):
+        _wall_start(uhd::time_spec_t::get_system_time())
+#ifdef BOOST_CHRONO_HAS_THREAD_CLOCK
+        , _cpu_start(boost::chrono::thread_clock::now())
+#endif
+    {}
+
+    //! The fraction of the time since construction the thread ran, or -1
+    double get_load(void) const
+    {
+#ifdef BOOST_CHRONO_HAS_THREAD_CLOCK
+        const double wall = (uhd::time_spec_t::get_system_time() - _wall_start).get_real_secs();
+        const double cpu = boost::chrono::duration<double>(
+            boost::chrono::thread_clock::now() - _cpu_start).count();
+        return (wall > 0.0)? cpu/wall : -1.0;
+#else
+        return -1.0;
+#endif
+    }
+
+private:
+    const uhd::time_spec_t _wall_start;
+#ifdef BOOST_CHRONO_HAS_THREAD_CLOCK
+    const boost::chrono::thread_clock::time_point _cpu_start;
+#endif
+};
+
+static UHD_INLINE unsigned long long elapsed_ns(const uhd::time_spec_t &start)
+{
+    return (unsigned long long)((uhd::time_spec_t::get_system_time() - start).to_ticks(1e9));
+}
 
 /***********************************************************************
  * Benchmark RX Rate
@@ -58,9 +184,11 @@ void benchmark_rx_rate(
         const std::string &rx_cpu,
         uhd::rx_streamer::sptr rx_stream,
         bool random_nsamps,
-        atomic_bool& burst_timer_elapsed
+        atomic_bool& burst_timer_elapsed,
+        streamer_results_t &results
 ) {
-    uhd::set_thread_priority_safe();
+    setup_streamer_thread(results);
+    const thread_load_meter load_meter;
 
     //print pre-test summary
     std::cout << boost::format(
@@ -98,12 +226,18 @@ void benchmark_rx_rate(
             rx_stream->issue_stream_cmd(cmd);
         }
         try {
-            num_rx_samps += rx_stream->recv(buffs, max_samps_per_packet, md, recv_timeout)*rx_stream->get_num_channels();
+            const uhd::time_spec_t call_start = uhd::time_spec_t::get_system_time();
+            results.num_samps += rx_stream->recv(buffs, max_samps_per_packet, md, recv_timeout)*rx_stream->get_num_channels();
+            //timeouts only measure the timeout
+            if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                results.latency.add(elapsed_ns(call_start));
+            }
             recv_timeout = burst_pkt_time;
         }
         catch (uhd::io_error &e) {
             std::cerr << "Caught an IO exception. " << std::endl;
             std::cerr << e.what() << std::endl;
+            results.cpu_load = load_meter.get_load();
             return;
         }
 
@@ -112,10 +246,11 @@ void benchmark_rx_rate(
         case uhd::rx_metadata_t::ERROR_CODE_NONE:
             if (had_an_overflow){
                 had_an_overflow = false;
-                num_dropped_samps += (md.time_spec - last_time).to_ticks(rate);
+                results.num_dropped_samps += (md.time_spec - last_time).to_ticks(rate);
             }
             if ((burst_timer_elapsed or stop_called) and md.end_of_burst)
             {
+                results.cpu_load = load_meter.get_load();
                 return;
             }
             break;
@@ -126,12 +261,12 @@ void benchmark_rx_rate(
             had_an_overflow = true;
             // check out_of_sequence flag to see if it was a sequence error or overflow
             if (!md.out_of_sequence)
-                num_overflows++;
+                results.num_overflows++;
             break;
 
         case uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND:
             std::cerr << "Receiver error: " << md.strerror() << ", restart streaming..."<< std::endl;
-            num_late_commands++;
+            results.num_late_commands++;
             // Radio core will be in the idle state. Issue stream command to restart streaming.
             cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(0.05);
             cmd.stream_now = (buffs.size() == 1);
@@ -140,10 +275,11 @@ void benchmark_rx_rate(
 
         case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
             if (burst_timer_elapsed) {
+                results.cpu_load = load_meter.get_load();
                 return;
             }
             std::cerr << "Receiver error: " << md.strerror() << ", continuing..." << std::endl;
-            num_timeouts++;
+            results.num_timeouts++;
             break;
 
             // Otherwise, it's an error
@@ -163,9 +299,11 @@ void benchmark_tx_rate(
         const std::string &tx_cpu,
         uhd::tx_streamer::sptr tx_stream,
         atomic_bool& burst_timer_elapsed,
+        streamer_results_t &results,
         bool random_nsamps=false
 ) {
-    uhd::set_thread_priority_safe();
+    setup_streamer_thread(results);
+    const thread_load_meter load_meter;
 
     //print pre-test summary
     std::cout << boost::format(
@@ -194,14 +332,18 @@ void benchmark_tx_rate(
             usrp->set_time_now(uhd::time_spec_t(0.0));
             while(num_acc_samps < total_num_samps){
                 //send a single packet
-                num_tx_samps += tx_stream->send(buffs, max_samps_per_packet, md, timeout)*tx_stream->get_num_channels();
+                const uhd::time_spec_t call_start = uhd::time_spec_t::get_system_time();
+                results.num_samps += tx_stream->send(buffs, max_samps_per_packet, md, timeout)*tx_stream->get_num_channels();
+                results.latency.add(elapsed_ns(call_start));
                 num_acc_samps += std::min(total_num_samps-num_acc_samps, tx_stream->get_max_num_samps());
             }
         }
     } else {
         //while (not burst_timer_elapsed.load(boost::memory_order_relaxed)) {
         while (not burst_timer_elapsed) {
-            num_tx_samps += tx_stream->send(buffs, max_samps_per_packet, md)*tx_stream->get_num_channels();
+            const uhd::time_spec_t call_start = uhd::time_spec_t::get_system_time();
+            results.num_samps += tx_stream->send(buffs, max_samps_per_packet, md)*tx_stream->get_num_channels();
+            results.latency.add(elapsed_ns(call_start));
             md.has_time_spec = false;
         }
     }
@@ -209,11 +351,13 @@ void benchmark_tx_rate(
     //send a mini EOB packet
     md.end_of_burst = true;
     tx_stream->send(buffs, 0, md);
+    results.cpu_load = load_meter.get_load();
 }
 
 void benchmark_tx_rate_async_helper(
         uhd::tx_streamer::sptr tx_stream,
-        atomic_bool& burst_timer_elapsed
+        atomic_bool& burst_timer_elapsed,
+        streamer_results_t &results
 ) {
     //setup variables and allocate buffer
     uhd::async_metadata_t async_md;
@@ -238,12 +382,12 @@ void benchmark_tx_rate_async_helper(
 
         case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
         case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
-            num_underflows++;
+            results.num_underflows++;
             break;
 
         case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR:
         case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST:
-            num_seq_errors++;
+            results.num_seq_errors++;
             break;
 
         default:
@@ -254,6 +398,136 @@ void benchmark_tx_rate_async_helper(
     }
 }
 
+/***********************************************************************
+ * Helpers for the setup and the summary
+ **********************************************************************/
+//! Parse a comma separated list of numbers, e.g. "0,1"
+static std::vector<size_t> parse_index_list(const std::string &list)
+{
+    std::vector<std::string> strings;
+    std::vector<size_t> indexes;
+    if (list.empty()) return indexes;
+    boost::split(strings, list, boost::is_any_of("\"',"));
+    BOOST_FOREACH(const std::string &str, strings) {
+        indexes.push_back(boost::lexical_cast<size_t>(str));
+    }
+    return indexes;
+}
+
+/*!
+ * Deal the channels out to num_streamers streamers, round robin
+ * (channels 0,1,2,3 on 2 streamers: 0,2 and 1,3), and pin the
+ * streamer threads to the cpus in turn.
+ */
+static std::vector<streamer_results_t> make_streamer_results(
+    const std::vector<size_t> &channel_nums,
+    const size_t num_streamers,
+    const std::vector<size_t> &cpus
+) {
+    if (num_streamers == 0 or num_streamers > channel_nums.size()) {
+        throw std::runtime_error("The number of streamers must be between 1 and the number of channels.");
+    }
+    std::vector<streamer_results_t> results(num_streamers);
+    for (size_t i = 0; i < channel_nums.size(); i++) {
+        results[i % num_streamers].channels.push_back(channel_nums[i]);
+    }
+    for (size_t i = 0; i < num_streamers and not cpus.empty(); i++) {
+        results[i].cpu = int(cpus[i % cpus.size()]);
+    }
+    return results;
+}
+
+static unsigned long long sum_results(
+    const std::vector<streamer_results_t> &results,
+    unsigned long long streamer_results_t::*counter
+) {
+    unsigned long long sum = 0;
+    BOOST_FOREACH(const streamer_results_t &r, results) sum += r.*counter;
+    return sum;
+}
+
+static std::string json_string(const std::string &str)
+{
+    std::string out = "\"";
+    BOOST_FOREACH(const char ch, str) {
+        if (ch == '"' or ch == '\\') out += '\\';
+        out += ch;
+    }
+    return out + "\"";
+}
+
+static std::string json_list(const std::vector<size_t> &list)
+{
+    std::string out = "[";
+    for (size_t i = 0; i < list.size(); i++) {
+        out += ((i == 0)? "" : ", ") + boost::lexical_cast<std::string>(list[i]);
+    }
+    return out + "]";
+}
+
+//! Write the results of one direction as a JSON object
+static void write_json_direction(
+    std::ostream &out,
+    const std::vector<streamer_results_t> &results,
+    const double rate,
+    const std::string &otw,
+    const std::string &cpu,
+    const size_t spp
+) {
+    out << boost::format(
+        "{\n"
+        "    \"rate\": %f,\n"
+        "    \"otw\": %s,\n"
+        "    \"cpu\": %s,\n"
+        "    \"spp\": %u,\n"
+        "    \"num_samps\": %u,\n"
+        "    \"num_dropped_samps\": %u,\n"
+        "    \"num_overflows\": %u,\n"
+        "    \"num_late_commands\": %u,\n"
+        "    \"num_timeouts\": %u,\n"
+        "    \"num_underflows\": %u,\n"
+        "    \"num_seq_errors\": %u,\n"
+        "    \"streamers\": ["
+    ) % rate % json_string(otw) % json_string(cpu) % spp
+      % sum_results(results, &streamer_results_t::num_samps)
+      % sum_results(results, &streamer_results_t::num_dropped_samps)
+      % sum_results(results, &streamer_results_t::num_overflows)
+      % sum_results(results, &streamer_results_t::num_late_commands)
+      % sum_results(results, &streamer_results_t::num_timeouts)
+      % sum_results(results, &streamer_results_t::num_underflows)
+      % sum_results(results, &streamer_results_t::num_seq_errors);
+    for (size_t i = 0; i < results.size(); i++) {
+        const streamer_results_t &r = results[i];
+        out << ((i == 0)? "\n" : ",\n") << boost::format(
+            "      {\"channels\": %s, \"cpu\": %d, \"num_samps\": %u, \"num_calls\": %u,\n"
+            "       \"cpu_load\": %s,\n"
+            "       \"latency_us\": {\"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}}"
+        ) % json_list(r.channels) % r.cpu % r.num_samps % r.latency.count()
+          % ((r.cpu_load < 0.0)? std::string("null") : str(boost::format("%.4f") % r.cpu_load))
+          % (r.latency.percentile(0.5)/1e3) % (r.latency.percentile(0.99)/1e3)
+          % (r.latency.percentile(0.999)/1e3) % (r.latency.max_ns()/1e3);
+    }
+    out << "\n    ]\n  }";
+}
+
+//! Print the latency and the load of each streamer
+static void print_streamer_results(
+    const std::string &direction,
+    const std::vector<streamer_results_t> &results
+) {
+    for (size_t i = 0; i < results.size(); i++) {
+        const streamer_results_t &r = results[i];
+        std::cout << boost::format(
+            "%s streamer %u (channels %s):\n"
+            "  Call latency p50/p99/p99.9/max (us): %.1f/%.1f/%.1f/%.1f\n"
+            "  Thread CPU load:         %s\n"
+        ) % direction % i % json_list(r.channels)
+          % (r.latency.percentile(0.5)/1e3) % (r.latency.percentile(0.99)/1e3)
+          % (r.latency.percentile(0.999)/1e3) % (r.latency.max_ns()/1e3)
+          % ((r.cpu_load < 0.0)? std::string("unknown") : str(boost::format("%.1f%%") % (r.cpu_load*100)));
+    }
+}
+
 /***********************************************************************
  * Main code + dispatcher
  **********************************************************************/
@@ -269,6 +543,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     std::string rx_cpu, tx_cpu;
     std::string mode, ref, pps;
     std::string channel_list, rx_channel_list, tx_channel_list;
+    size_t num_rx_streamers, num_tx_streamers;
+    std::string rx_cpu_list, tx_cpu_list;
+    size_t rx_spp, tx_spp;
+    std::string rx_stream_args, tx_stream_args;
+    std::string json_file;
     bool random_nsamps = false;
     atomic_bool burst_timer_elapsed(false);
 
@@ -293,6 +572,16 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("channels", po::value<std::string>(&channel_list)->default_value("0"), "which channel(s) to use (specify \"0\", \"1\", \"0,1\", etc)")
         ("rx_channels", po::value<std::string>(&rx_channel_list), "which RX channel(s) to use (specify \"0\", \"1\", \"0,1\", etc)")
         ("tx_channels", po::value<std::string>(&tx_channel_list), "which TX channel(s) to use (specify \"0\", \"1\", \"0,1\", etc)")
+        ("rx_streamers", po::value<size_t>(&num_rx_streamers)->default_value(1), "number of RX streamers the RX channels are split between, each with its own thread")
+        ("tx_streamers", po::value<size_t>(&num_tx_streamers)->default_value(1), "number of TX streamers the TX channels are split between, each with its own thread")
+        ("rx_cpus", po::value<std::string>(&rx_cpu_list), "CPUs to pin the RX streamer threads to, in turn (specify \"2\", \"2,3\", etc)")
+        ("tx_cpus", po::value<std::string>(&tx_cpu_list), "CPUs to pin the TX streamer threads to, in turn (specify \"2\", \"2,3\", etc)")
+        ("rx_spp", po::value<size_t>(&rx_spp)->default_value(0), "samples per packet of the RX streamers (0 for the device default)")
+        ("tx_spp", po::value<size_t>(&tx_spp)->default_value(0), "samples per packet of the TX streamers (0 for the device default)")
+        ("rx_stream_args", po::value<std::string>(&rx_stream_args)->default_value(""), "additional stream args for the RX streamers")
+        ("tx_stream_args", po::value<std::string>(&tx_stream_args)->default_value(""), "additional stream args for the TX streamers")
+        ("json", po::value<std::string>(&json_file), "write the results, with the call latency percentiles of each streamer, to this JSON file")
+        ("xport_stats", "print the per-transport counters (timeouts, pool exhaustion, wait time) at the end of the run")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -445,27 +734,38 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
        usrp->set_time_unknown_pps(uhd::time_spec_t(0.0));
     }
 
-    //spawn the receive test thread
+    //spawn the receive test threads, one per streamer
+    std::vector<streamer_results_t> rx_results;
     if (vm.count("rx_rate")){
         usrp->set_rx_rate(rx_rate);
-        //create a receive streamer
-        uhd::stream_args_t stream_args(rx_cpu, rx_otw);
-        stream_args.channels = rx_channel_nums;
-        uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(stream_args);
-        thread_group.create_thread(boost::bind(&benchmark_rx_rate, usrp, rx_cpu, rx_stream, random_nsamps, boost::ref(burst_timer_elapsed)));
+        rx_results = make_streamer_results(rx_channel_nums, num_rx_streamers, parse_index_list(rx_cpu_list));
+        BOOST_FOREACH(streamer_results_t &results, rx_results) {
+            //create a receive streamer
+            uhd::stream_args_t stream_args(rx_cpu, rx_otw);
+            stream_args.channels = results.channels;
+            stream_args.args = uhd::device_addr_t(rx_stream_args);
+            if (rx_spp) stream_args.args["spp"] = boost::lexical_cast<std::string>(rx_spp);
+            uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(stream_args);
+            thread_group.create_thread(boost::bind(&benchmark_rx_rate, usrp, rx_cpu, rx_stream, random_nsamps, boost::ref(burst_timer_elapsed), boost::ref(results)));
+        }
     }
 
-    //spawn the transmit test thread
+    //spawn the transmit test threads, one per streamer
+    std::vector<streamer_results_t> tx_results;
     if (vm.count("tx_rate")){
         usrp->set_tx_rate(tx_rate);
-        //create a transmit streamer
-        uhd::stream_args_t stream_args(tx_cpu, tx_otw);
-        stream_args.channels = tx_channel_nums;
-        uhd::tx_streamer::sptr tx_stream = usrp->get_tx_stream(stream_args);
-        thread_group.create_thread(boost::bind(&benchmark_tx_rate, usrp, tx_cpu, tx_stream, boost::ref(burst_timer_elapsed), random_nsamps));
-        thread_group.create_thread(boost::bind(&benchmark_tx_rate_async_helper, tx_stream, boost::ref(burst_timer_elapsed)));
+        tx_results = make_streamer_results(tx_channel_nums, num_tx_streamers, parse_index_list(tx_cpu_list));
+        BOOST_FOREACH(streamer_results_t &results, tx_results) {
+            //create a transmit streamer
+            uhd::stream_args_t stream_args(tx_cpu, tx_otw);
+            stream_args.channels = results.channels;
+            stream_args.args = uhd::device_addr_t(tx_stream_args);
+            if (tx_spp) stream_args.args["spp"] = boost::lexical_cast<std::string>(tx_spp);
+            uhd::tx_streamer::sptr tx_stream = usrp->get_tx_stream(stream_args);
+            thread_group.create_thread(boost::bind(&benchmark_tx_rate, usrp, tx_cpu, tx_stream, boost::ref(burst_timer_elapsed), boost::ref(results), random_nsamps));
+            thread_group.create_thread(boost::bind(&benchmark_tx_rate_async_helper, tx_stream, boost::ref(burst_timer_elapsed), boost::ref(results)));
+        }
     }
-
     //sleep for the required duration
     const long secs = long(duration);
     const long usecs = long((duration - secs)*1e6);
@@ -490,11 +790,74 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         "  Num underflows detected: %u\n"
         "  Num late commands:       %u\n"
         "  Num timeouts:            %u\n"
-    ) % num_rx_samps % num_dropped_samps
-      % num_overflows % num_tx_samps
-      % num_seq_errors % num_underflows
-      % num_late_commands % num_timeouts
+    ) % sum_results(rx_results, &streamer_results_t::num_samps)
+      % sum_results(rx_results, &streamer_results_t::num_dropped_samps)
+      % sum_results(rx_results, &streamer_results_t::num_overflows)
+      % sum_results(tx_results, &streamer_results_t::num_samps)
+      % sum_results(tx_results, &streamer_results_t::num_seq_errors)
+      % sum_results(tx_results, &streamer_results_t::num_underflows)
+      % (sum_results(rx_results, &streamer_results_t::num_late_commands)
+         + sum_results(tx_results, &streamer_results_t::num_late_commands))
+      % sum_results(rx_results, &streamer_results_t::num_timeouts)
       << std::endl;
+    print_streamer_results("RX", rx_results);
+    print_streamer_results("TX", tx_results);
+
+    //write the results to the JSON file
+    if (vm.count("json")) {
+        std::ofstream json(json_file.c_str());
+        json << "{\n  \"args\": " << json_string(args)
+             << ",\n  \"duration\": " << duration;
+        if (vm.count("rx_rate")) {
+            json << ",\n  \"rx\": ";
+            write_json_direction(json, rx_results, usrp->get_rx_rate(), rx_otw, rx_cpu, rx_spp);
+        }
+        if (vm.count("tx_rate")) {
+            json << ",\n  \"tx\": ";
+            write_json_direction(json, tx_results, usrp->get_tx_rate(), tx_otw, tx_cpu, tx_spp);
+        }
+        json << "\n}\n";
+        if (not json) {
+            std::cerr << "Could not write the results to " << json_file << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    //print transport counters
+    if (vm.count("xport_stats")) {
+        uhd::property_tree::sptr tree = usrp->get_device()->get_tree();
+        for (size_t mb = 0; mb < usrp->get_num_mboards(); mb++) {
+            const uhd::fs_path xports_path = uhd::fs_path("/mboards") / boost::lexical_cast<std::string>(mb) / "xports";
+            if (not tree->exists(xports_path)) continue;
+            BOOST_FOREACH(const std::string &name, tree->list(xports_path)) {
+                if (not tree->exists(xports_path / name / "stats")) continue;
+                const uhd::transport::zero_copy_stats_t stats =
+                    tree->access<uhd::transport::zero_copy_stats_t>(xports_path / name / "stats").get();
+                std::cout << boost::format(
+                    "Transport %u/%s:\n"
+                    "  RX packets/bytes:        %u/%u\n"
+                    "  RX timeouts/pool empty:  %u/%u\n"
+                    "  RX wait time (ns):       %u\n"
+                    "  TX packets:              %u\n"
+                    "  TX timeouts/pool empty:  %u/%u\n"
+                    "  TX wait time (ns):       %u\n"
+                    "  Dropped/queue depth:     %u/%u\n"
+                    "  Kernel drops:            %u\n"
+                    "  RX latency avg/max (ns): %u/%u\n"
+                ) % mb % name
+                  % stats.num_recv_packets % stats.num_recv_bytes
+                  % stats.num_recv_timeouts % stats.num_recv_pool_empty
+                  % stats.recv_wait_ns % stats.num_send_packets
+                  % stats.num_send_timeouts % stats.num_send_pool_empty
+                  % stats.send_wait_ns
+                  % stats.num_dropped % stats.recv_queue_depth
+                  % stats.num_kernel_drops
+                  % (stats.num_recv_packets ? stats.recv_latency_ns / stats.num_recv_packets : 0)
+                  % stats.max_recv_latency_ns
+                  << std::endl;
+            }
+        }
+    }
 
     //finished
     std::cout << std::endl << "Done!" << std::endl << std::endl;
@@ -22,9 +22,61 @@
 #include <boost/format.hpp>
 #include <iostream>
 #include <complex>
+#include <algorithm>
+#include <vector>
 
 namespace po = boost::program_options;
 
+/***********************************************************************
+ * Stage latencies
+ **********************************************************************/
+//! The durations of one stage of the loop, over all the runs
+class stage_stats
+{
+public:
+    stage_stats(const std::string &name): _name(name) {}
+
+    void add(const uhd::time_spec_t &begin, const uhd::time_spec_t &end)
+    {
+        _durations.push_back((end - begin).get_real_secs());
+    }
+
+    void print(void)
+    {
+        if (_durations.empty()) {
+            std::cout << boost::format("%-20s (no samples)") % _name << std::endl;
+            return;
+        }
+        std::sort(_durations.begin(), _durations.end());
+        std::cout << boost::format("%-20s %10.1f %10.1f %10.1f %10.1f")
+            % _name % (percentile(0.0)*1e6) % (percentile(0.5)*1e6)
+            % (percentile(0.99)*1e6) % (percentile(1.0)*1e6)
+        << std::endl;
+    }
+
+private:
+    double percentile(const double q) const
+    {
+        return _durations[size_t(q*(_durations.size() - 1) + 0.5)];
+    }
+
+    const std::string _name;
+    std::vector<double> _durations;
+};
+
+/*!
+ * The device time at the host time now, to put host events on the device
+ * time line. Reading the device time takes a round trip to the device, the
+ * host time is taken half way.
+ */
+static uhd::time_spec_t get_device_time_offset(uhd::usrp::multi_usrp::sptr usrp)
+{
+    const uhd::time_spec_t host_before = uhd::time_spec_t::get_system_time();
+    const uhd::time_spec_t device_now = usrp->get_time_now();
+    const uhd::time_spec_t host_after = uhd::time_spec_t::get_system_time();
+    return device_now - (host_before + uhd::time_spec_t((host_after - host_before).get_real_secs()/2));
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
@@ -34,6 +86,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     double rate;
     double rtt;
     size_t nruns;
+    double process_time;
 
     //setup the program options
     po::options_description desc("Allowed options");
@@ -44,6 +97,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("nruns",  po::value<size_t>(&nruns)->default_value(1000),   "number of tests to perform")
         ("rtt",    po::value<double>(&rtt)->default_value(0.001),    "delay between receive and transmit (seconds)")
         ("rate",   po::value<double>(&rate)->default_value(100e6/4), "sample rate for receive and transmit (sps)")
+        ("process_time", po::value<double>(&process_time)->default_value(0.0), "time to spin between recv() and send(), in place of the processing of an application (seconds)")
         ("verbose", "specify to enable inner-loop verbose")
     ;
     po::variables_map vm;
@@ -63,7 +117,13 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         "    arrive too late at the device indicate an error.\n"
         "    The smallest value of rtt that does not indicate an error is an\n"
         "    approximation for the time it takes for a sample packet to\n"
-        "    go to UHD and back to the device."
+        "    go to UHD and back to the device.\n"
+        "    The summary also has the distributions of the stages of the\n"
+        "    loop, with the host events put on the device time line:\n"
+        "    the last sample received until recv() returns, the processing\n"
+        "    until send() is called, send() itself, the slack from then until\n"
+        "    the transmit time, and the time of the burst ACK on the device\n"
+        "    until recv_async_msg() returns it."
         << std::endl;
         return EXIT_SUCCESS;
     }
@@ -106,15 +166,24 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     int underflow = 0;
     int other = 0;
 
+    //stage latencies, in device time
+    stage_stats device_to_recv("device to recv()");
+    stage_stats processing("processing");
+    stage_stats send_call("send()");
+    stage_stats tx_slack("slack to TX time");
+    stage_stats ack_to_host("ACK to host");
+
     for(size_t nrun = 0; nrun < nruns; nrun++){
 
         /***************************************************************
          * Issue a stream command some time in the near future
          **************************************************************/
+        //measured again on each run, so the clocks do not drift apart
+        const uhd::time_spec_t device_offset = get_device_time_offset(usrp);
         uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
         stream_cmd.num_samps = buffer.size();
         stream_cmd.stream_now = false;
-        stream_cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(0.01);
+        stream_cmd.time_spec = uhd::time_spec_t::get_system_time() + device_offset + uhd::time_spec_t(0.01);
         rx_stream->issue_stream_cmd(stream_cmd);
 
         /***************************************************************
@@ -124,6 +193,15 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         size_t num_rx_samps = rx_stream->recv(
             &buffer.front(), buffer.size(), rx_md
         );
+        const uhd::time_spec_t recv_return = uhd::time_spec_t::get_system_time() + device_offset;
+        if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE and rx_md.has_time_spec) {
+            const uhd::time_spec_t last_sample = rx_md.time_spec
+                + uhd::time_spec_t::from_ticks(num_rx_samps, usrp->get_rx_rate());
+            device_to_recv.add(last_sample, recv_return);
+        }
+
+        //stand in for the processing of an application
+        while ((uhd::time_spec_t::get_system_time() + device_offset - recv_return).get_real_secs() < process_time);
 
         if (verbose) {
             std::cout << boost::format(
@@ -146,9 +224,14 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         tx_md.end_of_burst = true;
         tx_md.has_time_spec = true;
         tx_md.time_spec = rx_md.time_spec + uhd::time_spec_t(rtt);
+        const uhd::time_spec_t send_entry = uhd::time_spec_t::get_system_time() + device_offset;
         size_t num_tx_samps = tx_stream->send(
             &buffer.front(), buffer.size(), tx_md
         );
+        const uhd::time_spec_t send_return = uhd::time_spec_t::get_system_time() + device_offset;
+        processing.add(recv_return, send_entry);
+        send_call.add(send_entry, send_return);
+        tx_slack.add(send_return, tx_md.time_spec);
         if (verbose) {
             std::cout
                 << boost::format("Sent %d samples") % num_tx_samps
@@ -170,6 +253,9 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
 
         case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
             ack++;
+            if (async_md.has_time_spec) {
+                ack_to_host.add(async_md.time_spec, uhd::time_spec_t::get_system_time() + device_offset);
+            }
             break;
 
         case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
@@ -227,5 +313,13 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
               << "Late packets:     " << time_error << std::endl
               << "Other errors:     " << other << std::endl
               << std::endl;
+    std::cout << boost::format("%-20s %10s %10s %10s %10s")
+        % "Stage (us)" % "min" % "median" % "p99" % "max" << std::endl;
+    device_to_recv.print();
+    processing.print();
+    send_call.print();
+    tx_slack.print();
+    ack_to_host.print();
+    std::cout << std::endl;
     return EXIT_SUCCESS;
 }
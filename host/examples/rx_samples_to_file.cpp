@@ -18,13 +18,14 @@
 #include <uhd/types/tune_request.hpp>
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_file.hpp>
+#include <uhd/utils/capture_file.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/exception.hpp>
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <iostream>
-#include <fstream>
 #include <csignal>
 #include <complex>
 
@@ -45,7 +46,8 @@ template<typename samp_type> void recv_to_file(
     bool stats = false,
     bool null = false,
     bool enable_size_map = false,
-    bool continue_on_bad_packet = false
+    bool continue_on_bad_packet = false,
+    const uhd::device_addr_t *capture_settings = NULL
 ){
     unsigned long long num_total_samps = 0;
     //create a receive streamer
@@ -54,9 +56,24 @@ template<typename samp_type> void recv_to_file(
 
     uhd::rx_metadata_t md;
     std::vector<samp_type> buff(samps_per_buff);
-    std::ofstream outfile;
-    if (not null)
-        outfile.open(file.c_str(), std::ofstream::binary);
+    //the writer thread keeps the disk off the receive loop, which
+    //receives straight into the writer's buffers
+    uhd::sample_file_writer::sptr outfile;
+    //or into a capture file, which keeps the times, overflows and an index
+    uhd::capture_file_writer::sptr capfile;
+    const size_t file_buff_size = std::max<size_t>(4*1024*1024,
+        (samps_per_buff*sizeof(samp_type)/4096 + 2)*4096);
+    if (not null and capture_settings != NULL) {
+        uhd::capture_file_info_t info;
+        info.cpu_format = cpu_format;
+        info.num_chans = 1;
+        info.samp_rate = usrp->get_rx_rate();
+        info.settings = *capture_settings;
+        capfile = uhd::capture_file_writer::make(file, info, 1024*1024, file_buff_size);
+    }
+    else if (not null) {
+        outfile = uhd::sample_file_writer::make(file, file_buff_size);
+    }
     bool overflow_message = true;
 
     //setup streaming
@@ -81,13 +98,16 @@ template<typename samp_type> void recv_to_file(
     while(not stop_signal_called and (num_requested_samples != num_total_samps or num_requested_samples == 0)) {
         boost::system_time now = boost::get_system_time();
 
-        size_t num_rx_samps = rx_stream->recv(&buff.front(), buff.size(), md, 3.0, enable_size_map);
+        void *recv_buff = outfile? outfile->get_write_space(buff.size()*sizeof(samp_type)) :
+            capfile? capfile->get_write_space(buff.size()).front() : &buff.front();
+        size_t num_rx_samps = rx_stream->recv(recv_buff, buff.size(), md, 3.0, enable_size_map);
 
         if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
             std::cout << boost::format("Timeout while streaming") << std::endl;
             break;
         }
         if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW){
+            if (capfile) capfile->commit(0, md); //marks where samples were lost
             if (overflow_message) {
                 overflow_message = false;
                 std::cerr << boost::format(
@@ -119,8 +139,10 @@ template<typename samp_type> void recv_to_file(
 
         num_total_samps += num_rx_samps;
 
-        if (outfile.is_open())
-            outfile.write((const char*)&buff.front(), num_rx_samps*sizeof(samp_type));
+        if (outfile)
+            outfile->commit(num_rx_samps*sizeof(samp_type));
+        if (capfile)
+            capfile->commit(num_rx_samps, md);
 
         if (bw_summary) {
             last_update_samps += num_rx_samps;
@@ -144,8 +166,10 @@ template<typename samp_type> void recv_to_file(
     stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS;
     rx_stream->issue_stream_cmd(stream_cmd);
 
-    if (outfile.is_open())
-        outfile.close();
+    if (outfile)
+        outfile->close();
+    if (capfile)
+        capfile->close();
 
     if (stats) {
         std::cout << std::endl;
@@ -155,6 +179,12 @@ template<typename samp_type> void recv_to_file(
         double r = (double)num_total_samps / t;
         std::cout << boost::format("%f Msps") % (r/1e6) << std::endl;
 
+        if (outfile or capfile) {
+            const uhd::sample_file_writer::stats_t file_stats = outfile? outfile->get_stats() : capfile->get_stats();
+            std::cout << boost::format("Waited %d times (%f seconds) for the disk, at most %d buffers queued")
+                % file_stats.num_waits % file_stats.wait_time % file_stats.max_queued << std::endl;
+        }
+
         if (enable_size_map) {
             std::cout << std::endl;
             std::cout << "Packet size map (bytes: count)" << std::endl;
@@ -237,6 +267,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("stats", "show average bandwidth on exit")
         ("sizemap", "track packet size and display breakdown on exit")
         ("null", "run without writing to file")
+        ("capture", "write a capture file with the sample times, overflows, settings and an index (see uhd/utils/capture_file.hpp)")
         ("continue", "don't abort on a bad packet")
         ("skip-lo", "skip checking LO lock status")
         ("int-n", "tune USRP with integer-N tuning")
@@ -328,8 +359,21 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         std::cout << "Press Ctrl + C to stop streaming..." << std::endl;
     }
 
+    //the settings stored in a capture file
+    uhd::device_addr_t capture_settings;
+    capture_settings["args"] = args;
+    capture_settings["device"] = usrp->get_mboard_name();
+    capture_settings["wirefmt"] = wirefmt;
+    capture_settings["rate"] = str(boost::format("%.17g") % usrp->get_rx_rate());
+    capture_settings["freq"] = str(boost::format("%.17g") % usrp->get_rx_freq());
+    capture_settings["gain"] = str(boost::format("%g") % usrp->get_rx_gain());
+    capture_settings["bw"] = str(boost::format("%.17g") % usrp->get_rx_bandwidth());
+    capture_settings["ant"] = usrp->get_rx_antenna();
+    capture_settings["ref"] = ref;
+
 #define recv_to_file_args(format) \
-    (usrp, format, wirefmt, file, spb, total_num_samps, total_time, bw_summary, stats, null, enable_size_map, continue_on_bad_packet)
+    (usrp, format, wirefmt, file, spb, total_num_samps, total_time, bw_summary, stats, null, enable_size_map, continue_on_bad_packet, \
+     vm.count("capture")? &capture_settings : NULL)
     //recv to file
     if (type == "double") recv_to_file<std::complex<double> >recv_to_file_args("fc64");
     else if (type == "float") recv_to_file<std::complex<float> >recv_to_file_args("fc32");
@@ -37,16 +37,15 @@
  *
  * The TwinRX can be used like any other daughterboard, as the multi_usrp::set_rx_freq()
  * function will automatically calculate and set the two LO frequencies as needed.
- * However, this adds to the overall tuning time. If the LO frequencies are manually set
- * with the multi_usrp::set_rx_lo_freq() function, the TwinRX will will not perform the
- * calculation itself, resulting in a faster tune time. This example shows how to take
- * advantage of this as follows:
+ * However, this adds to the overall tuning time. When the LOs of the unused channel are
+ * disabled, its synthesizers can be tuned to the next frequency while the active channel
+ * receives on the current one. The freq/hop_table and freq/hop_index properties of the
+ * TwinRX front-end do this. This example uses them as follows:
  *
- * 1. Tune across the given frequency range, storing the calculated LO frequencies along
- *    the way.
+ * 1. Write the frequencies to scan into the hop table of the active channel.
  * 2. Use timed commands to tell the TwinRX to receive bursts of samples at given intervals.
- * 3. For each frequency, tune the LOs for the inactive channel for the next frequency and
- *    receive at the current frequency.
+ * 3. For each frequency, hop to it. This swaps to the LOs tuned for it during the last
+ *    hop, and tunes the LOs just released to the next frequency.
  * 4. If applicable, send the next timed command for streaming.
  */
 
@@ -207,6 +206,13 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     // Set up buffers
     buffs = recv_buffs_t(rf_freqs.size(), recv_buff_t(spb));
 
+    // Load the hop table of the active channel's front-end
+    const uhd::usrp::subdev_spec_pair_t active_fe = usrp->get_rx_subdev_spec()[ACTIVE_CHAN];
+    const uhd::fs_path fe_path = "/mboards/0/dboards/" + active_fe.db_name + "/rx_frontends/" + active_fe.sd_name;
+    uhd::property_tree::sptr tree = usrp->get_device()->get_tree();
+    tree->access<std::vector<double> >(fe_path / "freq/hop_table").set(rf_freqs);
+    uhd::property<size_t> &hop_index = tree->access<size_t>(fe_path / "freq/hop_index");
+
     // Tune the active channel to the first frequency and reset the USRP's time
     usrp->set_rx_freq(rf_freqs[0], ACTIVE_CHAN);
     usrp->set_time_now(uhd::time_spec_t(0.0));
@@ -235,18 +241,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         uhd::time_spec_t start_time = uhd::time_spec_t::get_system_time();
 
         for (size_t i = 0; i < rf_freqs.size(); i++) {
-            // Swap the mapping of synthesizers by setting the LO source
-            // The unused channel will always
-            std::string lo_src = (i % 2) ? "companion" : "internal";
-            usrp->set_rx_lo_source(lo_src, uhd::usrp::multi_usrp::ALL_LOS, ACTIVE_CHAN);
-
-            // Preconfigure the next frequency
-            usrp->set_rx_freq(rf_freqs[(i+1) % rf_freqs.size()], UNUSED_CHAN);
-
-            // Program the current frequency
-            // This frequency was already pre-programmed in the previous iteration so the local oscillators
-            // are already tuned. This call will only configure front-end filter, amplifiers, etc
-            usrp->set_rx_freq(rf_freqs[i], ACTIVE_CHAN);
+            // Hop to the current frequency
+            // From the second hop on, its LOs were already tuned by the previous hop, so this
+            // swaps to them, configures the front-end filters, amplifiers, etc and tunes the
+            // LOs just released to the next frequency
+            hop_index.set(i);
 
             // Receive one burst of samples
             twinrx_recv(buffs[i]);
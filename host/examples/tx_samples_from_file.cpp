@@ -18,12 +18,12 @@
 #include <uhd/types/tune_request.hpp>
 #include <uhd/utils/thread_priority.hpp>
 #include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/sample_file.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <iostream>
-#include <fstream>
 #include <complex>
 #include <csignal>
 
@@ -48,21 +48,19 @@ template<typename samp_type> void send_from_file(
     md.start_of_burst = false;
     md.end_of_burst = false;
     std::vector<samp_type> buff(samps_per_buff);
-    std::ifstream infile(file.c_str(), std::ifstream::binary);
+    //the reader thread reads ahead, so the disk stays off the send loop
+    uhd::sample_file_reader::sptr infile = uhd::sample_file_reader::make(file);
 
     //loop until the entire file has been read
 
     while(not md.end_of_burst and not stop_signal_called){
 
-        infile.read((char*)&buff.front(), buff.size()*sizeof(samp_type));
-        size_t num_tx_samps = size_t(infile.gcount()/sizeof(samp_type));
+        size_t num_tx_samps = infile->read(&buff.front(), buff.size()*sizeof(samp_type))/sizeof(samp_type);
 
-        md.end_of_burst = infile.eof();
+        md.end_of_burst = (num_tx_samps < buff.size());
 
         tx_stream->send(&buff.front(), num_tx_samps, md);
     }
-
-    infile.close();
 }
 
 int UHD_SAFE_MAIN(int argc, char *argv[]){
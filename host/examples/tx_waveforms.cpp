@@ -20,9 +20,12 @@
 #include <uhd/utils/safe_main.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/device3.hpp>
+#include <uhd/rfnoc/dma_fifo_block_ctrl.hpp>
 #include <uhd/exception.hpp>
 #include <boost/program_options.hpp>
 #include <boost/math/special_functions/round.hpp>
+#include <boost/math/common_factor_rt.hpp> //gcd
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
@@ -73,6 +76,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("otw", po::value<std::string>(&otw)->default_value("sc16"), "specify the over-the-wire sample mode")
         ("channels", po::value<std::string>(&channel_list)->default_value("0"), "which channels to use (specify \"0\", \"1\", \"0,1\", etc)")
         ("int-n", "tune USRP with integer-N tuning")
+        ("playback", "send one period of the waveform and loop it from the DMA FIFO")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -236,6 +240,48 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     std::signal(SIGINT, &sig_int_handler);
     std::cout << "Press Ctrl + C to stop streaming..." << std::endl;
 
+    if (vm.count("playback")){
+        //the FIFO of each radio is the port of the same number on DmaFIFO_0
+        uhd::device3::sptr dev3 = boost::dynamic_pointer_cast<uhd::device3>(usrp->get_device());
+        const uhd::rfnoc::block_id_t fifo_id(0, "DmaFIFO", 0);
+        if (not dev3 or not dev3->has_block<uhd::rfnoc::dma_fifo_block_ctrl>(fifo_id)){
+            throw std::runtime_error("Playback needs a device with a DMA FIFO block.");
+        }
+        uhd::rfnoc::dma_fifo_block_ctrl::sptr fifo =
+            dev3->get_block_ctrl<uhd::rfnoc::dma_fifo_block_ctrl>(fifo_id);
+        BOOST_FOREACH(const size_t chan, channel_nums){
+            if (not fifo->has_playback(chan)){
+                throw std::runtime_error("The FPGA image of this device cannot play back from the DMA FIFO.");
+            }
+            fifo->start_recording(chan);
+        }
+
+        //record a whole number of periods, so that the loop has no seam
+        const size_t period = wave_table_len / boost::math::gcd(step, wave_table_len);
+        std::vector<std::complex<float> > rec_buff(period);
+        for (size_t n = 0; n < rec_buff.size(); n++){
+            rec_buff[n] = wave_table(index += step);
+        }
+        std::vector<std::complex<float> *> rec_buffs(channel_nums.size(), &rec_buff.front());
+        uhd::tx_metadata_t rec_md;
+        tx_stream->send(rec_buffs, rec_buff.size(), rec_md);
+
+        const uhd::time_spec_t start_time = usrp->get_time_now() + uhd::time_spec_t(0.1);
+        BOOST_FOREACH(const size_t chan, channel_nums){
+            fifo->start_playback(true, start_time, chan);
+        }
+        std::cout << boost::format("Playing back %u samples in a loop...") % rec_buff.size() << std::endl;
+        while (not stop_signal_called){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+        }
+        BOOST_FOREACH(const size_t chan, channel_nums){
+            fifo->stop_playback(uhd::time_spec_t(0.0), chan);
+            fifo->stop_recording(chan);
+        }
+        std::cout << std::endl << "Done!" << std::endl << std::endl;
+        return EXIT_SUCCESS;
+    }
+
     // Set up metadata. We start streaming a bit in the future
     // to allow MIMO operation:
     uhd::tx_metadata_t md;
@@ -0,0 +1,147 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_ASYNC_STREAM_HPP
+#define INCLUDED_UHD_ASYNC_STREAM_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/metadata.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace uhd{
+
+/*!
+ * Asynchronous receive on top of an RX streamer.
+ *
+ * async_recv() queues a request and returns at once. A worker thread
+ * owned by this object runs the requests in order with
+ * rx_streamer::recv(), so the application's own threads never block
+ * on the streamer.
+ *
+ * Completion handlers are run in one of two modes:
+ * - Without a notify function, each handler is called on the worker
+ *   thread as soon as its request completes.
+ * - With a notify function, completed requests are queued. The worker
+ *   calls notify when the queue becomes non-empty, and poll() runs all
+ *   queued handlers on the calling thread at once. An event loop can
+ *   post poll() from notify (e.g. with boost::asio::io_service::post()),
+ *   which costs one hand-off per batch of completions rather than one
+ *   per buffer.
+ *
+ * The buffers of a request must stay valid until its handler is called.
+ * Requests still queued when the object is destroyed are dropped
+ * without calling their handlers.
+ */
+class UHD_API async_rx_streamer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<async_rx_streamer> sptr;
+
+    //! Called with the result of rx_streamer::recv() for one request
+    typedef boost::function<void(const size_t nsamps, const rx_metadata_t &metadata)> handler_type;
+
+    //! Called by the worker when completed requests wait for poll()
+    typedef boost::function<void(void)> notify_type;
+
+    /*!
+     * Make a new asynchronous interface for a streamer.
+     * The streamer must not be used directly while this object exists.
+     * \param streamer the streamer to receive from
+     * \param notify see the completion modes above, or empty
+     */
+    static sptr make(rx_streamer::sptr streamer, const notify_type &notify = notify_type());
+
+    virtual ~async_rx_streamer(void);
+
+    /*!
+     * Queue a receive into the given buffers.
+     * \param buffs one buffer per channel of the streamer
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \param handler called when the receive is done
+     * \param timeout passed to rx_streamer::recv()
+     * \param one_packet passed to rx_streamer::recv()
+     */
+    virtual void async_recv(
+        const std::vector<void *> &buffs,
+        const size_t nsamps_per_buff,
+        const handler_type &handler,
+        const double timeout = 0.1,
+        const bool one_packet = false
+    ) = 0;
+
+    /*!
+     * Run the handlers of all completed requests on the calling thread.
+     * Only does something when the object was made with a notify function.
+     * \return the number of handlers that were run
+     */
+    virtual size_t poll(void) = 0;
+};
+
+/*!
+ * Asynchronous send on top of a TX streamer.
+ *
+ * Works like async_rx_streamer: async_send() queues a request, a worker
+ * thread runs it with tx_streamer::send(), and the handler gets the
+ * number of samples sent.
+ */
+class UHD_API async_tx_streamer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<async_tx_streamer> sptr;
+
+    //! Called with the result of tx_streamer::send() for one request
+    typedef boost::function<void(const size_t nsamps_sent)> handler_type;
+
+    //! Called by the worker when completed requests wait for poll()
+    typedef boost::function<void(void)> notify_type;
+
+    /*!
+     * Make a new asynchronous interface for a streamer.
+     * The streamer must not be used directly while this object exists,
+     * except for recv_async_msg().
+     * \param streamer the streamer to send to
+     * \param notify see async_rx_streamer, or empty
+     */
+    static sptr make(tx_streamer::sptr streamer, const notify_type &notify = notify_type());
+
+    virtual ~async_tx_streamer(void);
+
+    /*!
+     * Queue a send of the given buffers.
+     * \param buffs one buffer per channel of the streamer
+     * \param nsamps_per_buff the number of samples to send, per buffer
+     * \param metadata data describing the buffer's contents
+     * \param handler called when the send is done
+     * \param timeout passed to tx_streamer::send()
+     */
+    virtual void async_send(
+        const std::vector<const void *> &buffs,
+        const size_t nsamps_per_buff,
+        const tx_metadata_t &metadata,
+        const handler_type &handler,
+        const double timeout = 0.1
+    ) = 0;
+
+    //! Run the handlers of all completed requests, see async_rx_streamer::poll()
+    virtual size_t poll(void) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_ASYNC_STREAM_HPP */
@@ -23,10 +23,36 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/operators.hpp>
+#include <complex>
 #include <string>
+#include <vector>
 
 namespace uhd{ namespace convert{
 
+    /*!
+     * A DC offset and IQ imbalance correction applied while converting.
+     *
+     * With the I and Q of a sample as a vector, the output is
+     * `iq_matrix*(input*scalar - dc_offset)`: the DC offset is in the
+     * units of the output (e.g. 1.0 is full scale for fc32).
+     */
+    struct UHD_API correction_t{
+        //! Make a correction that leaves the samples unchanged
+        correction_t(void);
+
+        //! Subtracted from the scaled samples
+        std::complex<double> dc_offset;
+
+        //! Row-major 2x2 matrix, row 0 makes the I output, row 1 the Q output
+        double iq_matrix[2][2];
+
+        /*!
+         * Set the matrix from an IQ balance correction:
+         * `I' = (1 + real(cor))*I`, `Q' = Q + imag(cor)*I`.
+         */
+        void set_iq_balance(const std::complex<double> &cor);
+    };
+
     //! A conversion class that implements a conversion from inputs -> outputs.
     class converter{
     public:
@@ -39,6 +65,38 @@ namespace uhd{ namespace convert{
         //! Set the scale factor (used in floating point conversions)
         virtual void set_scalar(const double) = 0;
 
+        /*!
+         * Set a DC offset and IQ correction, see uhd::convert::correction_t.
+         * Only some converters can apply one, see get_converter_with_correction().
+         * \throws uhd::not_implemented_error if this converter cannot
+         */
+        virtual void set_correction(const correction_t &correction);
+
+        /*!
+         * Write the output with non-temporal (streaming) stores, which
+         * bypass the caches. This is for outputs much larger than the
+         * caches that are not read again soon, so they do not evict data
+         * that is still needed. It is a hint: converters without such a
+         * variant ignore it. Off by default.
+         */
+        virtual void set_nontemporal(const bool enb);
+
+        /*!
+         * Measure the power of the converted samples, see get_power().
+         * Only the converters with correction can, see
+         * get_converter_with_correction().
+         * \throws uhd::not_implemented_error if this converter cannot
+         */
+        virtual void set_power_measurement(const bool enb);
+
+        /*!
+         * Get the power of the samples converted since the last call,
+         * and start over: the peak and the mean of |sample|^2 in the
+         * units of the output (1.0 is full scale for fc32).
+         * Both are zero when nothing was measured.
+         */
+        virtual void get_power(double &peak, double &mean);
+
         //! The public conversion method to convert inputs -> outputs
         UHD_INLINE void conv(const input_type &in, const output_type &out, const size_t num){
             if (num != 0) (*this)(in, out, num);
@@ -75,6 +133,9 @@ namespace uhd{ namespace convert{
     //! Implement equality_comparable interface
     UHD_API bool operator==(const id_type &, const id_type &);
 
+    //! Hash a conversion ID, e.g. for use as a uhd::dict key
+    UHD_API size_t hash_value(const id_type &);
+
     /*!
      * Register a converter function.
      *
@@ -90,6 +151,24 @@ namespace uhd{ namespace convert{
         const priority_type prio
     );
 
+    /*!
+     * Register a converter function under a name.
+     *
+     * The name tells implementations of the same conversion apart,
+     * e.g. "sse2" or "avx2", see get_converter_name().
+     *
+     * \param id identify the conversion
+     * \param fcn makes a new converter
+     * \param prio the function priority
+     * \param name the name of the implementation
+     */
+    UHD_API void register_converter(
+        const id_type &id,
+        const function_type &fcn,
+        const priority_type prio,
+        const std::string &name
+    );
+
     /*!
      * Get a converter factory function.
      * \param id identify the conversion
@@ -101,6 +180,64 @@ namespace uhd{ namespace convert{
         const priority_type prio = -1
     );
 
+    /*!
+     * Get the best converter factory function whose converters support
+     * set_correction(). Such a converter does the conversion, scaling
+     * and correction in one pass over the samples.
+     * \param id identify the conversion
+     * \return the converter factory function
+     * \throws uhd::key_error if no converter for the id supports it
+     */
+    UHD_API function_type get_converter_with_correction(const id_type &id);
+
+    //! Get the IDs of all registered conversions
+    UHD_API std::vector<id_type> get_converter_ids(void);
+
+    /*!
+     * Get the priorities registered for a conversion.
+     * \param id identify the conversion
+     * \return the priorities, best first
+     */
+    UHD_API std::vector<priority_type> get_converter_priorities(const id_type &id);
+
+    /*!
+     * Get the name of a converter implementation.
+     * With the default prio, this is the implementation get_converter()
+     * picks, e.g. "avx2" when the CPU supports AVX2.
+     * \param id identify the conversion
+     * \param prio the desired prio or -1 for best
+     * \return the name given at registration
+     */
+    UHD_API std::string get_converter_name(
+        const id_type &id,
+        const priority_type prio = -1
+    );
+
+    /*!
+     * Make a converter that decimates while it converts.
+     *
+     * The samples are converted to fc32 a block at a time with the best
+     * converter for the id, and each block is lowpass filtered and
+     * decimated while it is still in the cache, so the samples make one
+     * pass through memory. conv() takes the number of input samples and
+     * writes one output sample per `decim` input samples: the filter
+     * carries its history and phase from one call to the next, so a
+     * converter is for one stream of samples per output (one channel)
+     * and calls may come in any size.
+     *
+     * \param id identify the conversion, with one input and fc32 outputs
+     * \param decim the decimation, 1 filters without decimating
+     * \param taps the FIR filter, empty for a windowed sinc lowpass with
+     *        unity gain at DC that passes most of the output bandwidth
+     * \return a new converter
+     * \throws uhd::value_error if the id or the decimation do not fit
+     */
+    UHD_API converter::sptr make_decimator(
+        const id_type &id,
+        const size_t decim,
+        const std::vector<float> &taps = std::vector<float>()
+    );
+
     /*!
      * Register the size of a particular item.
      * \param format the item format
@@ -113,6 +250,17 @@ namespace uhd{ namespace convert{
     //! Convert an item format to a size in bytes
     UHD_API size_t get_bytes_per_item(const std::string &format);
 
+    /*!
+     * Get the number of buffers per channel of a format.
+     * Planar formats, whose names end in `_planar`, have 2: one array with
+     * the I and one with the Q of the samples (e.g. `fc32_planar` is two
+     * arrays of float). The size of their items is that of one component.
+     * Other formats have 1.
+     * \param format the item format
+     * \return the number of buffers per channel
+     */
+    UHD_API size_t get_num_planes(const std::string &format);
+
 }} //namespace
 
 #endif /* INCLUDED_UHD_CONVERT_HPP */
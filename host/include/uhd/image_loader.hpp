@@ -19,8 +19,10 @@
 #define INCLUDED_UHD_IMAGE_LOADER_HPP
 
 #include <string>
+#include <vector>
 
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <uhd/config.hpp>
 #include <uhd/types/device_addr.hpp>
@@ -31,14 +33,39 @@ class UHD_API image_loader : boost::noncopyable{
 
 public:
 
+    //! Signature of a progress callback: the fraction of the image loaded so far
+    typedef boost::function<void(double)> progress_fcn_t;
+
     typedef struct{
         uhd::device_addr_t args;
         bool load_firmware;
         bool load_fpga;
         std::string firmware_path;
         std::string fpga_path;
+        //! Optional: called as the image is loaded, instead of printing the progress
+        progress_fcn_t progress;
     } image_loader_args_t;
 
+    //! The outcome of loading one device with load_parallel()
+    typedef struct{
+        bool loaded;       //!< An applicable device was found and loaded
+        std::string error; //!< The error that stopped the load, empty if none
+    } load_result_t;
+
+    //! A read-only image file, mapped into memory
+    class UHD_API image_file : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<image_file> sptr;
+
+        virtual ~image_file(void) = 0;
+
+        //! The contents of the file
+        virtual const char *data(void) const = 0;
+
+        //! The size of the file in bytes
+        virtual size_t size(void) const = 0;
+    };
+
     //! Signature of an image loading function
     /*!
      * This is the function signature for an image loading function.
@@ -75,6 +102,29 @@ public:
      */
     static bool load(const image_loader_args_t &image_loader_args);
 
+    //! Load firmware and/or FPGA onto several devices at the same time
+    /*!
+     * Runs load() for each set of arguments on a thread of its own. Errors
+     * of one device do not stop the others, they are returned instead.
+     * Give each set a progress callback, or the devices print their
+     * progress over each other.
+     * \param image_loader_args arguments for each device
+     * \return the outcome for each device, in the same order
+     */
+    static std::vector<load_result_t> load_parallel(
+        const std::vector<image_loader_args_t> &image_loader_args
+    );
+
+    //! Map an image file into memory
+    /*!
+     * Loaders that run at the same time and map the same file share one
+     * mapping, so the file is read only once.
+     * \param path the path to the image file
+     * \return the mapped file
+     * \throws uhd::io_error if the file cannot be opened
+     */
+    static image_file::sptr map_image(const std::string &path);
+
     //! Get the instructions on how to recovery a particular device
     /*!
      * These instructions should be queried if the user interrupts an image loading
@@ -26,6 +26,8 @@
 
 namespace uhd{
 
+class wb_iface;
+
 /*!
  * A templated property interface for holding the state
  * associated with a property in a uhd::property_tree
@@ -221,6 +223,9 @@ public:
 
     enum coerce_mode_t { AUTO_COERCE, MANUAL_COERCE };
 
+    //! Used by properties to defer a notification while a transaction is open
+    typedef boost::function<bool(const void *, const boost::function<void(void)> &)> txn_hook_type;
+
     virtual ~property_tree(void) = 0;
 
     //! Create a new + empty property tree
@@ -246,6 +251,55 @@ public:
     //! Get access to a property in the tree
     template <typename T> property<T> &access(const fs_path &path);
 
+    /*!
+     * Look up a property in the tree once, to access it many times.
+     * The returned pointer may be stored; it stays valid even if the
+     * property is removed from the tree later on.
+     */
+    template <typename T> boost::shared_ptr<property<T> > resolve(const fs_path &path);
+
+    /*!
+     * Begin a transaction on the whole tree.
+     * Until the matching commit(), setting a property only stores
+     * its desired (or coerced) value; the subscribers and coercer
+     * of that property run on commit(), once and with the last value,
+     * no matter how often the property was set. Until then, get()
+     * returns the coerced value from before the transaction.
+     * Transactions nest: only the outermost commit() runs the
+     * subscribers. Properties must not be removed during a transaction.
+     */
+    virtual void begin_txn(void) = 0;
+
+    /*!
+     * End a transaction and run the deferred subscribers,
+     * in the order their properties were first set.
+     * \throws uhd::runtime_error if there is no transaction
+     */
+    virtual void commit(void) = 0;
+
+    /*!
+     * Batch the register writes on an interface with every transaction:
+     * begin_batch() is called on it with the outermost begin_txn(),
+     * and commit() once all deferred subscribers have run.
+     * The tree only keeps a weak reference to the interface.
+     */
+    virtual void add_batch_iface(boost::shared_ptr<wb_iface> iface) = 0;
+
+    /*!
+     * Batch the register writes on the interfaces from add_batch_iface()
+     * without a transaction: subscribers run right away, and get()
+     * returns the new values, but their writes may be sent without
+     * waiting for each to complete until commit_batch().
+     * Batches nest with each other and with transactions.
+     */
+    virtual void begin_batch(void) = 0;
+
+    /*!
+     * End a batch from begin_batch() and wait for all of its writes.
+     * Throws the first error of the batched writes, if there was one.
+     */
+    virtual void commit_batch(void) = 0;
+
 private:
     //! Internal create property with wild-card type
     virtual void _create(const fs_path &path, const boost::shared_ptr<void> &prop) = 0;
@@ -253,6 +307,12 @@ private:
     //! Internal access property with wild-card type
     virtual boost::shared_ptr<void> &_access(const fs_path &path) const = 0;
 
+    //! Internal get the hook used by properties to join transactions
+    virtual txn_hook_type _txn_hook(void) const = 0;
+
+    //! Internal get the path from the root of the whole tree
+    virtual fs_path _full_path(const fs_path &path) const = 0;
+
 };
 
 } //namespace uhd
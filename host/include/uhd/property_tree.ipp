@@ -19,10 +19,20 @@
 #define INCLUDED_UHD_PROPERTY_TREE_IPP
 
 #include <uhd/exception.hpp>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <vector>
 
+#ifdef UHD_PROPERTY_TREE_PROFILING
+#include <uhd/utils/prop_profiler.hpp>
+#define UHD_PROPERTY_PROBE(name) uhd::prop_profiler::scoped_probe _probe(_path, name)
+#define UHD_PROPERTY_RECORD_USE(is_set) uhd::prop_profiler::record_use(_path, is_set)
+#else
+#define UHD_PROPERTY_PROBE(name)
+#define UHD_PROPERTY_RECORD_USE(is_set)
+#endif
+
 /***********************************************************************
  * Implement templated property impl
  **********************************************************************/
@@ -30,10 +40,23 @@ namespace uhd{ namespace /*anon*/{
 
 template <typename T> class property_impl : public property<T>{
 public:
-    property_impl<T>(property_tree::coerce_mode_t mode) : _coerce_mode(mode){
+    property_impl<T>(
+        property_tree::coerce_mode_t mode,
+        const property_tree::txn_hook_type &txn_hook = property_tree::txn_hook_type(),
+        const std::string &path = std::string()
+    ) :
+        _coerce_mode(mode), _txn_hook(txn_hook), _desired_pending(false), _coerced_pending(false)
+#ifdef UHD_PROPERTY_TREE_PROFILING
+        , _path(path)
+#endif
+    {
+#ifndef UHD_PROPERTY_TREE_PROFILING
+        (void)path; //only kept for the profile
+#endif
         if (_coerce_mode == property_tree::AUTO_COERCE) {
             _coercer = DEFAULT_COERCER;
         }
+        _commit_fcn = boost::bind(&property_impl<T>::_commit_deferred, this);
     }
 
     ~property_impl<T>(void){
@@ -72,26 +95,31 @@ public:
 
     void _set_coerced(const T &value){
         init_or_set_value(_coerced_value, value);
+        UHD_PROPERTY_PROBE("coerced");
         BOOST_FOREACH(typename property<T>::subscriber_type &csub, _coerced_subscribers){
             csub(get_value_ref(_coerced_value)); //let errors propagate
         }
     }
 
     property<T> &set(const T &value){
+        UHD_PROPERTY_RECORD_USE(true);
         init_or_set_value(_value, value);
-        BOOST_FOREACH(typename property<T>::subscriber_type &dsub, _desired_subscribers){
-            dsub(get_value_ref(_value)); //let errors propagate
-        }
-        if (not _coercer.empty()) {
-            _set_coerced(_coercer(get_value_ref(_value)));
-        } else {
-            if (_coerce_mode == property_tree::AUTO_COERCE) uhd::assertion_error("coercer missing for an auto coerced property");
+        if (_defer()) {
+            _desired_pending = true;
+            return *this;
         }
+        _notify_desired();
         return *this;
     }
 
     property<T> &set_coerced(const T &value){
         if (_coerce_mode == property_tree::AUTO_COERCE) uhd::assertion_error("cannot set coerced value an auto coerced property");
+        UHD_PROPERTY_RECORD_USE(true);
+        if (_defer()) {
+            init_or_set_value(_coerced_value, value);
+            _coerced_pending = true;
+            return *this;
+        }
         _set_coerced(value);
         return *this;
     }
@@ -100,7 +128,9 @@ public:
         if (empty()) {
             throw uhd::runtime_error("Cannot get() on an uninitialized (empty) property");
         }
+        UHD_PROPERTY_RECORD_USE(false);
         if (not _publisher.empty()) {
+            UHD_PROPERTY_PROBE("publisher");
             return _publisher();
         } else {
             if (_coerced_value.get() == NULL and _coerce_mode == property_tree::MANUAL_COERCE)
@@ -120,6 +150,40 @@ public:
     }
 
 private:
+    void _notify_desired(void){
+        {
+            UHD_PROPERTY_PROBE("desired");
+            BOOST_FOREACH(typename property<T>::subscriber_type &dsub, _desired_subscribers){
+                dsub(get_value_ref(_value)); //let errors propagate
+            }
+        }
+        if (not _coercer.empty()) {
+            _set_coerced(_coerce());
+        } else {
+            if (_coerce_mode == property_tree::AUTO_COERCE) uhd::assertion_error("coercer missing for an auto coerced property");
+        }
+    }
+
+    //! True if a transaction is open, the notification happens on commit then
+    bool _defer(void){
+        return not _txn_hook.empty() and _txn_hook(this, _commit_fcn);
+    }
+
+    void _commit_deferred(void){
+        const bool desired = _desired_pending, coerced = _coerced_pending;
+        _desired_pending = _coerced_pending = false;
+        if (desired) _notify_desired();
+        //a coercer overrides any coerced value that was set directly
+        if (coerced and (not desired or _coercer.empty())) {
+            _set_coerced(get_value_ref(_coerced_value));
+        }
+    }
+
+    T _coerce(void){
+        UHD_PROPERTY_PROBE("coercer");
+        return _coercer(get_value_ref(_value));
+    }
+
     static T DEFAULT_COERCER(const T& value) {
         return value;
     }
@@ -144,6 +208,13 @@ private:
     typename property<T>::coercer_type                  _coercer;
     boost::scoped_ptr<T>                                _value;
     boost::scoped_ptr<T>                                _coerced_value;
+    const property_tree::txn_hook_type                  _txn_hook;
+    boost::function<void(void)>                         _commit_fcn;
+    bool                                                _desired_pending;
+    bool                                                _coerced_pending;
+#ifdef UHD_PROPERTY_TREE_PROFILING
+    const std::string                                   _path;
+#endif
 };
 
 }} //namespace uhd::/*anon*/
@@ -154,7 +225,7 @@ private:
 namespace uhd{
 
     template <typename T> property<T> &property_tree::create(const fs_path &path, coerce_mode_t coerce_mode){
-        this->_create(path, typename boost::shared_ptr<property<T> >(new property_impl<T>(coerce_mode)));
+        this->_create(path, typename boost::shared_ptr<property<T> >(new property_impl<T>(coerce_mode, this->_txn_hook(), this->_full_path(path))));
         return this->access<T>(path);
     }
 
@@ -162,6 +233,13 @@ namespace uhd{
         return *boost::static_pointer_cast<property<T> >(this->_access(path));
     }
 
+    template <typename T> boost::shared_ptr<property<T> > property_tree::resolve(const fs_path &path){
+        return boost::static_pointer_cast<property<T> >(this->_access(path));
+    }
+
 } //namespace uhd
 
+#undef UHD_PROPERTY_PROBE
+#undef UHD_PROPERTY_RECORD_USE
+
 #endif /* INCLUDED_UHD_PROPERTY_TREE_IPP */
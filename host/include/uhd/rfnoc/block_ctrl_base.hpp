@@ -24,6 +24,7 @@
 #include <uhd/types/stream_cmd.hpp>
 #include <uhd/types/wb_iface.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhd/utils/dirty_tracked.hpp>
 #include <uhd/rfnoc/node_ctrl_base.hpp>
 #include <uhd/rfnoc/block_id.hpp>
 #include <uhd/rfnoc/stream_sig.hpp>
@@ -31,7 +32,10 @@
 #include <uhd/rfnoc/constants.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 #include <stdint.h>
+#include <map>
+#include <set>
 
 namespace uhd {
     namespace rfnoc {
@@ -47,6 +51,7 @@ struct make_args_t
     make_args_t(const std::string &key="") :
         device_index(0),
         is_big_endian(true),
+        noc_id(0),
         block_name(""),
         block_key(key)
     {}
@@ -62,6 +67,11 @@ struct make_args_t
     //  to the constructor.
     uhd::property_tree::sptr tree;
     bool is_big_endian;
+    //! The NoC-ID of the block, only valid if block_def is set
+    uint64_t noc_id;
+    //! The block definition, if it was already looked up. If not set,
+    //  the block controller reads the NoC-ID and looks it up itself.
+    blockdef::sptr block_def;
     //! The name of the block as it will be addressed
     std::string block_name;
     //! The key of the block, i.e. how it was registered
@@ -209,6 +219,20 @@ public:
      */
     uint32_t sr_read32(const settingsbus_reg_t reg, const size_t port = 0);
 
+    /*! Returns the value last written to a settings register.
+     *
+     * The value comes from the shadow registers (see set_sr_shadow_enabled()),
+     * without a transaction, which also works for registers that can't be
+     * read back.
+     *
+     * \param reg The settings register.
+     * \param port Port of the register
+     * \return the value last written.
+     * \throws uhd::key_error if the block keeps no shadow registers,
+     *         or \p reg was not written yet
+     */
+    uint32_t sr_read_shadow(const uint32_t reg, const size_t port = 0);
+
     /*! Allows reading one user-defined register (64-Bit version).
      *
      * This is a shorthand for setting the requested address
@@ -288,6 +312,41 @@ public:
      */
     void clear_command_time(const size_t port);
 
+    /*! Returns the number of commands that can be sent right now without
+     * waiting for an ack.
+     *
+     * The ack of a timed command only comes in once it has executed, so
+     * applications that queue many timed commands can check this instead
+     * of blocking in sr_write() until the oldest one is due.
+     *
+     * \param port Port of the command queue
+     * \returns the free space of the command queue
+     */
+    size_t get_cmd_queue_space(const size_t port = 0);
+
+    /*! Like sr_write(), but never waits for an ack.
+     *
+     * An error in the ack of the write is thrown by a later call on the
+     * port.
+     *
+     * \param reg The settings register to write to.
+     * \param data New value of this register.
+     * \param port Port on which to write
+     * \returns false if the command queue is full, and nothing was written
+     */
+    bool try_sr_write(const uint32_t reg, const uint32_t data, const size_t port = 0);
+
+    /*! Sets a handler that is called with the command time of each timed
+     * command that has executed.
+     *
+     * The handler runs when the ack comes in, within a call on the port
+     * (e.g. get_cmd_queue_space()), and must not call the block.
+     *
+     * \param handler The handler, or an empty function for none
+     * \param port Port
+     */
+    void set_cmd_done_handler(const timed_wb_iface::cmd_done_handler_t &handler, const size_t port = ANY_PORT);
+
     /*! Reset block after streaming operation.
      *
      * This does the following:
@@ -311,7 +370,13 @@ public:
     /***********************************************************************
      * Argument handling
      **********************************************************************/
-    /*! Set multiple block args. Calls set_arg() for all individual items.
+    /*! Set multiple block args in one go.
+     *
+     * First, all values are set. Then, the check and action scripts of
+     * every arg that changed run once, in the order of the block
+     * definition, so they see the new values of all other args. The
+     * register writes are batched (see uhd::wb_iface::begin_batch()) and
+     * complete when this function returns.
      *
      * Note that this function will silently ignore any keys in \p args that
      * aren't already registered as block arguments.
@@ -346,7 +411,7 @@ protected:
     /***********************************************************************
      * Structors
      **********************************************************************/
-    block_ctrl_base(void) {}; // To allow pure virtual (interface) sub-classes
+    block_ctrl_base(void) : _arg_batch_depth(0), _sr_shadow_enabled(false) {}; // To allow pure virtual (interface) sub-classes
     virtual ~block_ctrl_base();
 
     /*! Constructor. This is only called from the internal block factory!
@@ -372,6 +437,19 @@ protected:
     //! Get a control interface object for block port \p block_port
     wb_iface::sptr get_ctrl_iface(const size_t block_port);
 
+    /*! Keep shadow copies of the settings registers.
+     *
+     * With shadow registers, sr_write() skips writes that would not change
+     * the register, and sr_read_shadow() answers with the value last
+     * written. Only enable this for blocks whose registers are plain
+     * settings: registers that trigger an action on every write must be
+     * marked with set_sr_volatile(). Disabling forgets all values.
+     */
+    void set_sr_shadow_enabled(const bool enable);
+
+    //! Never skip writes to settings register \p reg (e.g. strobes)
+    void set_sr_volatile(const uint32_t reg);
+
 
     /***********************************************************************
      * Hooks & Derivables
@@ -411,6 +489,17 @@ private:
     //! Helper function to initialize the block args (used by ctor only)
     void _init_block_args();
 
+    //! Run the \p script ("check" or "action") of block arg \p arg, or
+    // remember to run it later if set_args() is busy setting values
+    void _run_arg_script(
+            const blockdef::arg_t &arg,
+            const std::string &script,
+            const std::string &error_message
+    );
+
+    //! Record a value that reached register \p reg in the shadow registers
+    void _sr_shadow_written(const uint32_t reg, const uint32_t data, const size_t port);
+
     /***********************************************************************
      * Private members
      **********************************************************************/
@@ -425,6 +514,19 @@ private:
 
     //! Interface to NocScript parser
     boost::shared_ptr<nocscript::block_iface> _nocscript_iface;
+
+    //! Nesting depth of set_args() calls that are still setting values
+    size_t _arg_batch_depth;
+
+    //! Args ("port/name") whose scripts set_args() still has to run
+    std::set<std::string> _deferred_args;
+
+    //! Shadow registers: the last value written per port and settings register
+    std::map<size_t, std::map<uint32_t, dirty_tracked<uint32_t> > > _sr_shadow;
+    bool _sr_shadow_enabled;
+    //! Settings registers written even when the value is unchanged
+    std::set<uint32_t> _sr_volatile;
+    boost::mutex _sr_shadow_mutex;
 }; /* class block_ctrl_base */
 
 }} /* namespace uhd::rfnoc */
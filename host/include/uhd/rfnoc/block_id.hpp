@@ -67,7 +67,7 @@ namespace uhd {
         // * is_valid_blockname("FIR_Filter") will return false, because an underscore
         //   is not allowed in a block name.
         //
-        // Internally, this matches the string with uhd::rfnoc::VALID_BLOCKNAME_REGEX.
+        // The rules are those of uhd::rfnoc::VALID_BLOCKNAME_REGEX, but no regex is used.
         static bool is_valid_blockname(const std::string &block_name);
 
         //! Check if a given string is valid as a block ID.
@@ -80,7 +80,7 @@ namespace uhd {
         // * is_valid_block_id("0/Filter_1") will return true.
         // * is_valid_block_id("0/Filter_Foo") will return false.
         //
-        // Internally, this matches the string with uhd::rfnoc::VALID_BLOCKID_REGEX.
+        // The rules are those of uhd::rfnoc::VALID_BLOCKID_REGEX, but no regex is used.
         static bool is_valid_block_id(const std::string &block_id);
 
         //! Check if block_str matches this block.
@@ -139,10 +139,11 @@ namespace uhd {
             return *this;
         }
 
+        //! Compares the block names as integers, see _block_name_key
         bool operator == (const block_id_t &block_id) const {
-            return (_device_no == block_id.get_device_no())
-                and (_block_name == block_id.get_block_name())
-                and (_block_ctr == block_id.get_block_count());
+            return (_device_no == block_id._device_no)
+                and (_block_name_key == block_id._block_name_key)
+                and (_block_ctr == block_id._block_ctr);
         }
 
         bool operator != (const block_id_t &block_id) const {
@@ -194,8 +195,14 @@ namespace uhd {
         }
 
     private:
+        //! Set the block name without checking it
+        void _set_block_name(const std::string &block_name);
+
         size_t _device_no;
         std::string _block_name;
+        //! Equal for equal block names: names are interned in a table that
+        //  only grows, and this is their index in it
+        uint32_t _block_name_key;
         size_t _block_ctr;
     };
 
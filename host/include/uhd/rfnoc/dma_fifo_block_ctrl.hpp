@@ -20,6 +20,7 @@
 
 #include <uhd/rfnoc/source_block_ctrl_base.hpp>
 #include <uhd/rfnoc/sink_block_ctrl_base.hpp>
+#include <uhd/types/time_spec.hpp>
 
 namespace uhd {
     namespace rfnoc {
@@ -32,7 +33,19 @@ namespace uhd {
  * - The base storage for the FIFO can be device
  *   specific. Usually it will be an off-chip SDRAM
  *   bank.
+ * - On FPGA images with playback, a FIFO can record
+ *   what is streamed into it and play it back, once or
+ *   in a loop, without further data from the host.
  *
+ * A playback session looks like this:
+ * \code{.cpp}
+ * dma_fifo->start_recording(chan);
+ * tx_stream->send(buffs, num_samps, md);  // the streamer feeds the FIFO input
+ * dma_fifo->start_playback(true, time_spec_t(2.0), chan);
+ * ...
+ * dma_fifo->stop_playback(chan);
+ * \endcode
+ * The recording must fit into the FIFO depth.
  */
 class UHD_RFNOC_API dma_fifo_block_ctrl : public source_block_ctrl_base, public sink_block_ctrl_base
 {
@@ -43,10 +56,41 @@ public:
     virtual void resize(const uint32_t base_addr, const uint32_t depth, const size_t chan) = 0;
 
     //! Returns the base address of the FIFO (in bytes).
-    uint32_t get_base_addr(const size_t chan) const;
+    virtual uint32_t get_base_addr(const size_t chan) const = 0;
 
     //! Returns the depth of the FIFO (in bytes).
-    uint32_t get_depth(const size_t chan) const;
+    virtual uint32_t get_depth(const size_t chan) const = 0;
+
+    //! Returns true if the FPGA image can record and play back on this FIFO.
+    virtual bool has_playback(const size_t chan) = 0;
+
+    /*! Clear the FIFO and keep everything streamed into it from now on.
+     *
+     * \throws uhd::not_implemented_error without playback support
+     */
+    virtual void start_recording(const size_t chan) = 0;
+
+    //! Returns the size of the recording so far (in bytes).
+    virtual uint32_t get_recorded_bytes(const size_t chan) = 0;
+
+    /*! Play the recording from its beginning.
+     *
+     * \param loop Play the recording over and over, instead of once
+     * \param time When not zero, start at this device time (a timed command)
+     * \throws uhd::not_implemented_error without playback support
+     */
+    virtual void start_playback(const bool loop, const time_spec_t &time, const size_t chan) = 0;
+
+    /*! Stop playing (at the given time, if not zero). The recording is
+     * kept and can be played again.
+     */
+    virtual void stop_playback(const time_spec_t &time, const size_t chan) = 0;
+
+    //! Returns true while the recording is being played.
+    virtual bool is_playing(const size_t chan) = 0;
+
+    //! Drop the recording and go back to working as a FIFO.
+    virtual void stop_recording(const size_t chan) = 0;
 
 }; /* class dma_fifo_block_ctrl*/
 
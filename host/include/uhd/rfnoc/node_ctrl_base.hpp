@@ -28,6 +28,8 @@
 #include <boost/function.hpp>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 namespace uhd {
     namespace rfnoc {
@@ -229,7 +231,28 @@ protected:
             size_t port
     );
 
+    /*! Call this whenever a connection between any two nodes is made or
+     * removed. Drops the results of find_downstream_node() and
+     * find_upstream_node() remembered by all nodes.
+     */
+    static void _topology_changed();
+
 private:
+    //! The result of a node search, see _find_child_node()
+    struct search_cache_t
+    {
+        search_cache_t() : topology_gen(0) {}
+        //! The value of _get_topology_generation() at the time of the search
+        uint32_t topology_gen;
+        //! Our streamer activity at the time of the search
+        std::map<size_t, bool> streamer_active;
+        //! The nodes that were found
+        std::vector<wptr> results;
+    };
+
+    //! Counts the calls to _topology_changed()
+    static uint32_t _get_topology_generation();
+
     /*! Implements the search algorithm for find_downstream_node() and
      * find_upstream_node().
      *
@@ -264,6 +287,11 @@ private:
      */
     std::map<size_t, size_t> _downstream_ports;
 
+    /*! Remembered results of _find_child_node(), by node type, direction
+     *  and active_only argument.
+     */
+    std::map<std::string, search_cache_t> _search_cache;
+
 }; /* class node_ctrl_base */
 
 }} /* namespace uhd::rfnoc */
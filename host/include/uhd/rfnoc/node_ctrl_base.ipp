@@ -22,7 +22,11 @@
 
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
 #include <boost/shared_ptr.hpp>
+#include <string>
+#include <typeinfo>
 #include <vector>
 
 namespace uhd {
@@ -32,6 +36,33 @@ namespace uhd {
     std::vector< boost::shared_ptr<T> > node_ctrl_base::_find_child_node(bool active_only)
     {
         typedef boost::shared_ptr<T> T_sptr;
+        // The result only depends on the connections, and when searching
+        // active ports only, on our own streamer activity. If neither
+        // changed since the last identical search, reuse its result:
+        const std::string cache_key = str(
+            boost::format("%s:%d:%d") % typeid(T).name() % downstream % active_only
+        );
+        const std::map<size_t, bool> &streamer_active = downstream ? _tx_streamer_active : _rx_streamer_active;
+        const uint32_t topology_gen = _get_topology_generation();
+        if (_search_cache.count(cache_key)) {
+            const search_cache_t &cached = _search_cache[cache_key];
+            if (cached.topology_gen == topology_gen
+                and (not active_only or cached.streamer_active == streamer_active)) {
+                std::vector< T_sptr > results;
+                BOOST_FOREACH(const wptr &node, cached.results) {
+                    T_sptr node_sptr = boost::dynamic_pointer_cast<T>(node.lock());
+                    if (not node_sptr) {
+                        results.clear();
+                        break;
+                    }
+                    results.push_back(node_sptr);
+                }
+                if (results.size() == cached.results.size()) {
+                    return results;
+                }
+            }
+        }
+
         static const size_t MAX_ITER = 20;
         size_t iters = 0;
         // List of return values:
@@ -86,6 +117,10 @@ namespace uhd {
         }
 
         std::vector< T_sptr > results(results_s.begin(), results_s.end());
+        search_cache_t &cached = _search_cache[cache_key];
+        cached.topology_gen = topology_gen;
+        cached.streamer_active = streamer_active;
+        cached.results.assign(results.begin(), results.end());
         return results;
     }
 
@@ -0,0 +1,113 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_RX_ACQUISITION_SCHEDULER_HPP
+#define INCLUDED_UHD_RX_ACQUISITION_SCHEDULER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{
+
+/*!
+ * Receives a list of timed, finite captures on an RX streamer.
+ *
+ * Each capture is one stream command for a number of samples at a time.
+ * The scheduler keeps up to queue_depth of them issued to the device
+ * ahead of time, with STREAM_MODE_NUM_SAMPS_AND_MORE while another
+ * capture follows, so the device goes from one capture to the next by
+ * itself. A capture that starts right where the one before ends is
+ * chained without a time, and the two have no gap between them. The last
+ * capture scheduled ends the chain (STREAM_MODE_NUM_SAMPS_AND_DONE). It is
+ * only issued once recv() waits for it, or once another capture follows.
+ * A capture scheduled after that cannot be chained anymore, so schedule
+ * captures well ahead.
+ *
+ * recv() returns the samples of one capture at a time, with its ID. The
+ * first samples of a capture have start_of_burst set and its time, the
+ * last ones end_of_burst.
+ *
+ * When the device reports an error (e.g. an overflow or a late command),
+ * recv() returns it with the ID of the capture it happened in. That
+ * capture and the others already issued are lost: the scheduler stops
+ * the stream and issues the captures that are still to come afresh.
+ *
+ * schedule() may be called from another thread than recv(). The
+ * streamer must not be used otherwise while the scheduler exists.
+ */
+class UHD_API rx_acquisition_scheduler : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_acquisition_scheduler> sptr;
+
+    /*!
+     * Make a new scheduler.
+     * \param streamer the streamer to receive the captures from
+     * \param samp_rate the sample rate of the streamer, to find
+     *        back-to-back captures
+     * \param queue_depth the most stream commands queued in the device,
+     *        at least 2
+     * \throws uhd::value_error for a queue depth below 2
+     */
+    static sptr make(
+        rx_streamer::sptr streamer,
+        const double samp_rate,
+        const size_t queue_depth = 4
+    );
+
+    virtual ~rx_acquisition_scheduler(void);
+
+    /*!
+     * Schedule a capture.
+     * Captures must be scheduled in order of time, and must not overlap.
+     * \param time the device time of the first sample
+     * \param nsamps the number of samples to capture
+     * \return the ID of the capture, as returned by recv()
+     * \throws uhd::value_error if the capture starts before the end of
+     *         the one scheduled last
+     */
+    virtual uint32_t schedule(const time_spec_t &time, const size_t nsamps) = 0;
+
+    //! Get the number of captures that were not fully received yet
+    virtual size_t get_num_pending(void) = 0;
+
+    /*!
+     * Receive samples of the current capture.
+     * Never returns samples of two captures in one call.
+     * \param buffs one buffer per channel of the streamer
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \param metadata filled in like by rx_streamer::recv()
+     * \param capture_id set to the ID of the capture the samples or
+     *        the error belong to
+     * \param timeout the timeout in seconds to wait for a packet
+     * \return the number of samples received, or 0 on error
+     */
+    virtual size_t recv(
+        const rx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        uint32_t &capture_id,
+        const double timeout = 0.1
+    ) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_RX_ACQUISITION_SCHEDULER_HPP */
@@ -0,0 +1,115 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_RX_CAPTURE_RING_HPP
+#define INCLUDED_UHD_RX_CAPTURE_RING_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd{
+
+/*!
+ * Continuous capture into a circular buffer, for pre-trigger recording.
+ *
+ * A worker thread owned by the ring receives from the streamer without
+ * pause, straight into the ring (the streamer converts into it, there
+ * is no other copy). The ring keeps the last samples, indexed by their
+ * device time, and get_window() returns a view of any time window held
+ * in it without copying.
+ *
+ * The worker never waits for readers: a view is only a pointer into
+ * the ring, and the samples it points to are overwritten once the ring
+ * wraps around. Check still_valid() after using a view to find out
+ * whether that happened in the meantime.
+ *
+ * The stream must be started on the streamer (continuous mode), and
+ * the streamer must not be used elsewhere while the ring exists.
+ */
+class UHD_API rx_capture_ring : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_capture_ring> sptr;
+
+    /*!
+     * A window of samples inside the ring.
+     * Where the window wraps around the end of the ring, it comes in
+     * two parts: the samples of part 0 are followed by those of part 1.
+     */
+    struct UHD_API view_t{
+        view_t(void);
+
+        //! The time of the first sample of the window
+        time_spec_t time_spec;
+
+        //! Per part, the number of samples per channel
+        size_t nsamps[2];
+
+        //! Per part, one pointer per channel
+        std::vector<const void *> buffs[2];
+
+        //! Position of the window in the stream, for still_valid()
+        unsigned long long first_sample;
+    };
+
+    /*!
+     * Make a new ring and start capturing.
+     * \param streamer the streamer to capture from
+     * \param cpu_format the cpu format the streamer was made with
+     * \param samp_rate the sample rate of the streamer
+     * \param duration how many seconds of samples the ring holds
+     */
+    static sptr make(
+        rx_streamer::sptr streamer,
+        const std::string &cpu_format,
+        const double samp_rate,
+        const double duration
+    );
+
+    virtual ~rx_capture_ring(void);
+
+    /*!
+     * Get a view of the samples of a time window.
+     * The window must lie in one stretch of samples without gaps: it
+     * may not span an overflow.
+     * \param view filled in with the window
+     * \param time_spec the time of the first sample
+     * \param nsamps the number of samples per channel
+     * \return false if the ring does not hold all of the window
+     */
+    virtual bool get_window(view_t &view, const time_spec_t &time_spec, const size_t nsamps) = 0;
+
+    //! True if the samples of the view were not overwritten yet
+    virtual bool still_valid(const view_t &view) = 0;
+
+    //! Get the time of the oldest sample held, or 0 while empty
+    virtual time_spec_t get_oldest_time(void) = 0;
+
+    //! Get the time just after the newest sample held, or 0 while empty
+    virtual time_spec_t get_newest_time(void) = 0;
+
+    //! Get the number of receive errors other than timeouts, e.g. overflows
+    virtual size_t get_num_errors(void) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_RX_CAPTURE_RING_HPP */
@@ -0,0 +1,77 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_RX_CHANNELIZER_HPP
+#define INCLUDED_UHD_RX_CHANNELIZER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace uhd{
+
+/*!
+ * Splits the band of an RX streamer into equally spaced channels with a
+ * polyphase filter bank.
+ *
+ * The channelizer is an RX streamer itself, with one channel per
+ * sub-band: channel k is centered at k*samp_rate/num_chans (minus
+ * samp_rate for k > num_chans/2), and has a sample rate of
+ * samp_rate/num_chans. recv() fills one fc32 buffer per channel.
+ *
+ * The samples are taken from the streamer with recv_zero_copy() and
+ * converted from the wire format straight into the filter's history, so
+ * the full band is only read once. The streamer must have one channel
+ * and support recv_zero_copy(). Its CPU format does not matter.
+ *
+ * The filter runs with SIMD instructions where the CPU has them, and
+ * its outputs can be spread over several threads.
+ */
+class UHD_API rx_channelizer : public rx_streamer{
+public:
+    typedef boost::shared_ptr<rx_channelizer> sptr;
+
+    /*!
+     * Make a new channelizer.
+     * \param streamer the streamer to split, with one channel
+     * \param num_chans the number of channels, a power of two
+     * \param samp_rate the sample rate of the streamer, for the time specs
+     * \param taps the prototype lowpass filter at the full rate, or empty
+     *        for one of 16 taps per channel with its cutoff at half the
+     *        channel spacing
+     * \param num_threads the number of threads computing the outputs
+     * \throws uhd::value_error for a number of channels that is not a
+     *         power of two, or a streamer with more than one channel
+     */
+    static sptr make(
+        rx_streamer::sptr streamer,
+        const size_t num_chans,
+        const double samp_rate,
+        const std::vector<float> &taps = std::vector<float>(),
+        const size_t num_threads = 1
+    );
+
+    virtual ~rx_channelizer(void);
+
+    //! Get the prototype filter, padded to a multiple of num_chans taps
+    virtual std::vector<float> get_taps(void) const = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_RX_CHANNELIZER_HPP */
@@ -0,0 +1,81 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_RX_SHM_PUBLISHER_HPP
+#define INCLUDED_UHD_RX_SHM_PUBLISHER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+namespace uhd{
+
+/*!
+ * Share a receive stream with other processes through shared memory.
+ *
+ * A worker thread owned by the publisher receives from the streamer
+ * without pause, straight into a ring in shared memory (the streamer
+ * converts into it, there is no other copy). Other processes open the
+ * ring as a device and receive from its read-only streamer:
+ *
+ * \code{.cpp}
+ * uhd::device::sptr dev = uhd::device::make("type=shm,name=rx0");
+ * uhd::rx_streamer::sptr rx = dev->get_rx_stream(uhd::stream_args_t("fc32"));
+ * \endcode
+ *
+ * The publisher never waits for readers. A reader which falls a whole
+ * ring behind loses the oldest packets and gets an overflow.
+ *
+ * The stream must be started on the streamer, and the streamer must not
+ * be used elsewhere while the publisher exists. Readers have no control
+ * over the stream: their stream commands are ignored.
+ */
+class UHD_API rx_shm_publisher : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_shm_publisher> sptr;
+
+    /*!
+     * Make a new publisher and start receiving.
+     * An existing ring of the same name is replaced.
+     * \param streamer the streamer to receive from
+     * \param name the name readers open the ring with
+     * \param cpu_format the cpu format the streamer was made with
+     * \param samp_rate the sample rate of the streamer
+     * \param num_packets how many packets the ring holds
+     */
+    static sptr make(
+        rx_streamer::sptr streamer,
+        const std::string &name,
+        const std::string &cpu_format,
+        const double samp_rate,
+        const size_t num_packets = 256
+    );
+
+    virtual ~rx_shm_publisher(void);
+
+    //! Get the number of readers which have the ring open
+    virtual size_t get_num_readers(void) = 0;
+
+    //! Get the number of receive errors other than timeouts, e.g. overflows
+    virtual size_t get_num_errors(void) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_RX_SHM_PUBLISHER_HPP */
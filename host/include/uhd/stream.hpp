@@ -72,6 +72,15 @@ struct UHD_API stream_args_t{
      *  - fc32 - complex<float>
      *  - sc16 - complex<int16_t>
      *  - sc8 - complex<int8_t>
+     *  - fc32_planar - float I and float Q in separate buffers (RX only,
+     *    from sc16, sc8 and sc12). The buffers passed to recv() hold
+     *    two pointers per channel, the I then the Q buffer.
+     *  - fc16 - complex IEEE 754 half precision floats, as a pair of
+     *    uint16_t (RX only, from sc16, sc12 and fc32)
+     *  - bf16 - complex bfloat16, as a pair of uint16_t (RX only,
+     *    from sc16, sc12 and fc32)
+     *  - item32 - the sc16 wire items without scaling (RX only, from
+     *    sc16): one uint32_t per sample, Q16 I16 in host byte order
      *
      * The following are not implemented, but are listed to demonstrate naming convention:
      *  - f32 - float
@@ -100,6 +109,11 @@ struct UHD_API stream_args_t{
      * noise. On the other hand, it reduces the load on the data link and thus allows more bandwidth
      * (a USRP N210 can work with 25 MHz bandwidth for 16-Bit complex samples, and 50 MHz for 8-Bit
      * complex samples).
+     *
+     * RFNoC devices (X300) also accept `auto`: a block that fixes its
+     * item type (e.g. a radio or DDC, which use sc16) decides the format.
+     * For blocks that take any item type, the streamer uses the widest of
+     * sc16, sc12 and sc8 whose sample rate fits the link.
      */
     std::string otw_format;
 
@@ -128,14 +142,104 @@ struct UHD_API stream_args_t{
      * Users should specify this option to request smaller than default
      * packets, probably with the intention of reducing packet latency.
      *
+     * - profile: (RFNoC and B2xx devices) `throughput' or `latency' picks
+     * the transport settings from the sample rate and the link MTU instead
+     * of the fixed defaults. `throughput' uses full frames and deep
+     * buffers. `latency' uses packets of about 100 us and buffers of a few
+     * ms. RFNoC devices set the frame size, number of frames and RX socket
+     * buffer size per stream; on B2xx the frames are fixed when the device
+     * is made, so only spp changes. The chosen settings are printed when
+     * the streamer is made. Explicit spp and frame/buffer keys win.
+     * RFNoC RX streamers with `latency' return from recv() after every
+     * packet, and spin on their socket when they have a cpu (see the
+     * transport notes).
+     *
      * - noclear: Used by tx_dsp_core_200 and rx_dsp_core_200
      *
+     * - cpu, cpu<N>: (RFNoC devices, RX only) the CPU that receives the
+     * packets of all channels, or of channel N. The transport socket is
+     * steered to that CPU; pin the thread calling recv() to the same CPU
+     * with uhd::set_thread_priority_safe(priority, realtime, cpu). On the
+     * X3x0 over Ethernet, such a channel is received by that thread
+     * instead of the receive offload thread.
+     *
+     * - convert_threads: (RFNoC and B2xx devices) the number of threads,
+     * including the one calling recv() or send(), that convert the
+     * channels of a multi-channel streamer in parallel. The default of 1
+     * converts all channels on the calling thread. The extra threads spin
+     * while samples are streaming, so only use this when the conversion
+     * is the bottleneck and there are spare cores.
+     *
+     * - recv_threads: (RFNoC devices, RX only) 1 to receive the channels
+     * of each motherboard of a multi-device streamer on a thread of its
+     * own. The threads hold up to 16 packets per channel, while recv()
+     * aligns and converts them, so the waits on the motherboards overlap.
+     * Combine with convert_threads to also spread the conversion. The
+     * default of 0 receives all channels on the thread calling recv().
+     *
+     * - pipeline_depth: (RFNoC, B2xx and loopback devices, TX only) the
+     * number of packets per channel that a separate thread sends to the
+     * transport, while the thread calling send() prepares the next ones.
+     * Flow control waits on that thread as well. The default of 0 sends
+     * every packet from send() itself.
+     *
+     * - max_latency, max_latency_samps: (RFNoC devices, TX only) the most
+     * samples that may wait in the device buffers, in seconds at the
+     * sample rate when the streamer is made or in samples. The flow
+     * control window shrinks to the whole packets that fit, and send()
+     * blocks (or times out) until the device consumed enough of them.
+     * By default, the window fills the device buffers, see send_buff_size.
+     *
+     * - overflow_policy: (RFNoC devices, RX only) how a multi-channel
+     * stream recovers from an overflow. With `restart' (the default),
+     * all channels are stopped, the transports flushed, and streaming
+     * restarts 50 ms later. With `continue', the flush is skipped and
+     * streaming restarts after 5 ms, so less data is lost per overflow.
+     * Single-channel streams always just resume. Either way, the first
+     * buffer after the gap reports the number of lost samples in
+     * uhd::rx_metadata_t::num_lost_samps.
+     *
+     * - channel_group: (RFNoC devices, RX only) a name. Streamers of the
+     * same motherboard with the same name share one transport and one
+     * receive thread, which hands each packet to the streamer of its
+     * channel without copying it. Make one single-channel streamer per
+     * channel to receive each channel on its own thread, without
+     * aligning the channels and without a transport per channel.
+     * - channel_group_size: the number of channels the group is made for
+     * (default: 4). Each channel gets that share of the transport's frames
+     * and buffer, so scale num_recv_frames and recv_buff_size to match.
+     *
+     * - nontemporal_stores: (RFNoC, B1xx, B2xx, E100 and loopback
+     * devices, RX only) when the conversion writes the samples with
+     * non-temporal stores, which bypass the CPU caches: `auto' (the
+     * default) for recv() calls with at least 4 MiB of buffers in all,
+     * `on' always, `off' never. Large buffers that are processed much
+     * later would only evict the data of the receive path from the
+     * caches. Only the SIMD converters from sc16 to fc32 have such stores.
+     *
+     * - dc_offset_i, dc_offset_q, iq_balance_mag, iq_balance_phase: (B100
+     * and E100, RX with sc16 over the wire and fc32 on the host) correct
+     * the DC offset and IQ imbalance in software, as part of the
+     * conversion. The DC offset is subtracted first, in full-scale units.
+     * The IQ balance is then applied as `I' = (1 + mag)*I`,
+     * `Q' = Q + phase*I`. Append a channel number (e.g. dc_offset_i1) to
+     * set a value for one channel of the stream only.
+     *
+     * - host_decim: (USRP1 and B100, RX with fc32 on the host) lowpass
+     * filter and decimate by this factor on the host, as part of the
+     * conversion, see uhd::convert::make_decimator(). recv() returns
+     * one sample per `host_decim` samples at the sample rate of the
+     * device. Cannot be combined with the corrections above.
+     *
      * The following are not implemented, but are listed for conceptual purposes:
      * - function: magnitude or phase/magnitude
      * - units: numeric units like counts or dBm
      *
      * Other options are device-specific:
      * - port, addr: Alternative receiver streamer destination.
+     *
+     * Except on RFNoC devices and the N2x0, keys that are not known
+     * are reported with a warning when the streamer is made.
      */
     device_addr_t args;
 
@@ -235,6 +339,129 @@ public:
      * \param stream_cmd the stream command to issue
      */
     virtual void issue_stream_cmd(const stream_cmd_t &stream_cmd) = 0;
+
+    /*!
+     * Get how long the last issue_stream_cmd() took.
+     *
+     * The commands go out to the devices of the streamer in parallel,
+     * so this is the slowest control round trip among them rather than
+     * the sum. A timed start has to be at least this far ahead of the
+     * call to issue_stream_cmd(), which gives the margin to use on a
+     * given setup. Streamers that do not measure it return 0.
+     *
+     * \return seconds from the call until all channels had the command
+     */
+    virtual double get_stream_cmd_latency(void) const;
+
+    /*!
+     * Samples that were received by recv_zero_copy().
+     * The payload stays in the buffers of the transport, which are handed
+     * back when release() is called, when the object is reused for the
+     * next recv_zero_copy(), or when the last copy of it is destroyed.
+     */
+    struct UHD_API zero_copy_buffs_t{
+        zero_copy_buffs_t(void);
+
+        //! Per channel, a pointer to the payload of the packet
+        std::vector<const void *> buffs;
+
+        //! The number of items in each buffer
+        size_t nsamps;
+
+        /*!
+         * The layout of the items, as a converter input format such as
+         * "sc16_item32_le". These are the samples as they came over the
+         * wire: for sc16, each 32-bit item holds I in the upper and Q in
+         * the lower half, in the byte order given by the suffix.
+         */
+        std::string item_format;
+
+        //! Owns the transport buffers
+        boost::shared_ptr<void> handle;
+
+        //! Hand the transport buffers back
+        void release(void);
+    };
+
+    /*!
+     * Receive one packet per channel without converting or copying it.
+     *
+     * Instead of filling user buffers, this hands out pointers to the
+     * payload inside the transport's buffers. Metadata, errors and
+     * timeouts are reported the same way as by recv() with one_packet set.
+     * If an earlier recv() left part of a packet, the rest of that packet
+     * is returned.
+     *
+     * Every packet held by the caller takes one of the transport's frames
+     * (see num_recv_frames), so release the buffers as soon as they are
+     * processed. The same threading rules as for recv() apply.
+     *
+     * Streamers that do not support this throw uhd::not_implemented_error.
+     *
+     * \param buffs filled with the packet, released first if still holding one
+     * \param metadata data to fill describing the packet
+     * \param timeout the timeout in seconds to wait for a packet
+     * \return the number of items per channel, or 0 on error
+     */
+    virtual size_t recv_zero_copy(
+        zero_copy_buffs_t &buffs,
+        rx_metadata_t &metadata,
+        const double timeout = 0.1
+    );
+
+    //! Where one packet of a recv_batch() is, and what came with it
+    struct UHD_API packet_info_t{
+        packet_info_t(void);
+
+        //! The first sample of the packet in the buffers
+        size_t offset;
+
+        //! The number of samples of the packet, per channel
+        size_t nsamps;
+
+        //! The time of the first sample of the packet, if it has one
+        bool has_time_spec;
+        time_spec_t time_spec;
+
+        bool start_of_burst;
+        bool end_of_burst;
+
+        //! The device dropped samples right before this packet
+        bool gap_before;
+    };
+
+    /*!
+     * Receive several packets into the buffers in one call.
+     *
+     * The packets are put one after the other into the buffers, like
+     * recv() does, and each gets an entry in packets with its place and
+     * its own time. The batch ends when the buffers are full, after
+     * max_packets packets, after an end of burst, or on an error.
+     *
+     * Overflows do not end the batch: the packet after one has gap_before
+     * set. An overflow not followed by a packet in this batch is returned
+     * in the metadata instead, like other errors. The metadata otherwise
+     * describes the batch as recv() would: the time is that of the first
+     * packet, and the error code that of the error that ended it.
+     *
+     * Streamers that do not support this throw uhd::not_implemented_error.
+     *
+     * \param buffs a vector of writable memory to fill with samples
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \param packets cleared, then filled with one entry per packet
+     * \param max_packets the most packets to receive
+     * \param metadata data to fill describing the batch
+     * \param timeout the timeout in seconds to wait for each packet
+     * \return the number of samples received, per channel
+     */
+    virtual size_t recv_batch(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        std::vector<packet_info_t> &packets,
+        const size_t max_packets,
+        rx_metadata_t &metadata,
+        const double timeout = 0.1
+    );
 };
 
 /*!
@@ -294,6 +521,140 @@ public:
     virtual bool recv_async_msg(
         async_metadata_t &async_metadata, double timeout = 0.1
     ) = 0;
+
+    /*!
+     * Receive the queued asynchronous messages from this TX stream at once.
+     * Waits up to the timeout for the first message, then also takes the
+     * ones queued already. Repeated error events may come as one message,
+     * see async_metadata_t::num_events.
+     * \param msgs the messages received (its contents are replaced)
+     * \param max_msgs the most messages to receive
+     * \param timeout the timeout in seconds to wait for the first message
+     * \return the number of messages received, 0 for timeout
+     */
+    virtual size_t recv_async_msgs(
+        std::vector<async_metadata_t> &msgs,
+        const size_t max_msgs,
+        const double timeout = 0.1
+    );
+
+    //! Buffers to fill in place, see get_send_buffer()
+    struct UHD_API zero_copy_buffs_t{
+        zero_copy_buffs_t(void);
+
+        //! Per channel, a pointer to the payload area of the next packet
+        std::vector<void *> buffs;
+
+        //! The number of items each buffer can hold
+        size_t nsamps;
+
+        //! The layout to write the items in, such as "sc16_item32_le"
+        std::string item_format;
+    };
+
+    /*!
+     * Get the payload area of the next packet on every channel, to be
+     * filled with samples in the wire format and sent with commit().
+     * This skips the conversion and copy done by send().
+     *
+     * The metadata applies to the packet as is: there is no fragmentation,
+     * and a start of burst is not held back for a later call.
+     *
+     * Streamers that do not support this throw uhd::not_implemented_error.
+     *
+     * \param buffs filled with the payload pointers of the next packet
+     * \param metadata data describing the packet's contents
+     * \param timeout the timeout in seconds to wait for the buffers
+     * \return the number of items per channel that fit, or 0 on timeout
+     */
+    virtual size_t get_send_buffer(
+        zero_copy_buffs_t &buffs,
+        const tx_metadata_t &metadata,
+        const double timeout = 0.1
+    );
+
+    /*!
+     * Send the packet set up by the last get_send_buffer().
+     * \param nsamps the number of items written to each buffer
+     */
+    virtual void commit(const size_t nsamps);
+};
+
+/*!
+ * A set of RX streamers serviced by one thread.
+ *
+ * Each streamer is added with the buffers its samples go to. recv()
+ * returns the next packet of whichever streamer has one, so a single
+ * thread can receive many low-rate streams (e.g. the channels of a
+ * channelizer at different rates) instead of one thread per streamer.
+ *
+ * The transports have no common handle to wait on, so the set polls
+ * the streamers with a zero timeout, round robin, starting after the
+ * streamer that returned last. While none has a packet, the calling
+ * thread sleeps for at most the poll interval between rounds.
+ *
+ * A streamer in a set must not be used from another thread.
+ */
+class UHD_API rx_streamer_set : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_streamer_set> sptr;
+
+    /*!
+     * Make an empty set.
+     * \param poll_interval the longest sleep between polling rounds in
+     *        seconds, which bounds the added latency of a packet
+     */
+    rx_streamer_set(const double poll_interval = 100e-6);
+
+    /*!
+     * Add a streamer to the set.
+     * \param streamer the streamer to receive from
+     * \param buffs one buffer per channel of the streamer, used for every
+     *        recv() that returns samples of this streamer
+     * \param nsamps_per_buff the size of each buffer in number of samples
+     * \return the index of the streamer in the set
+     */
+    size_t add(
+        rx_streamer::sptr streamer,
+        const std::vector<void *> &buffs,
+        const size_t nsamps_per_buff
+    );
+
+    //! Get the number of streamers in the set
+    size_t size(void) const;
+
+    //! Get the streamer at an index
+    rx_streamer::sptr get(const size_t index) const;
+
+    /*!
+     * Receive one packet from any streamer in the set.
+     *
+     * Works like rx_streamer::recv() with one_packet set, on the
+     * streamer given by \p index. Errors of a streamer (overflows, late
+     * commands, ...) are returned as soon as they are seen, with the
+     * index of that streamer.
+     *
+     * \param index set to the index of the streamer that was received from
+     * \param metadata data to fill describing the buffer
+     * \param timeout the timeout in seconds to wait for any packet
+     * \return the number of samples received into the buffers of that
+     *         streamer, or 0 with ERROR_CODE_TIMEOUT in the metadata
+     */
+    size_t recv(
+        size_t &index,
+        rx_metadata_t &metadata,
+        const double timeout = 0.1
+    );
+
+private:
+    struct entry_t{
+        rx_streamer::sptr streamer;
+        std::vector<void *> buffs;
+        size_t nsamps_per_buff;
+    };
+    std::vector<entry_t> _entries;
+    size_t _next;
+    double _poll_interval;
 };
 
 } //namespace uhd
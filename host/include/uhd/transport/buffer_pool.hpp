@@ -19,8 +19,10 @@
 #define INCLUDED_UHD_TRANSPORT_BUFFER_POOL_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 
 namespace uhd{ namespace transport{
 
@@ -35,6 +37,61 @@ namespace uhd{ namespace transport{
 
         virtual ~buffer_pool(void) = 0;
 
+        /*!
+         * Where and how the pool memory is allocated.
+         * The defaults give regular heap memory.
+         */
+        struct UHD_API alloc_policy_t{
+            alloc_policy_t(void): hugepage_size(0), numa_node(-1), lock(false){}
+
+            //! Page size for MAP_HUGETLB (e.g. 2 MiB or 1 GiB), 0 for the heap
+            size_t hugepage_size;
+
+            //! NUMA node to bind the memory to, -1 for no binding
+            int numa_node;
+
+            //! Lock the memory into RAM (mlock)
+            bool lock;
+
+            /*!
+             * Read the policy from transport hints:
+             *  - buff_hugepages: "2M", "1G", or a size in bytes (0 disables)
+             *  - buff_numa_node: the NUMA node index
+             *  - buff_mlock: non-zero to lock the pool memory
+             */
+            static alloc_policy_t from_hints(const device_addr_t &hints);
+
+            /*!
+             * Copy the keys read by from_hints() from device args to
+             * the hints of a transport, for devices which pass their
+             * transports only some of the args.
+             */
+            static void forward_hints(const device_addr_t &args, device_addr_t &hints);
+        };
+
+        /*!
+         * Hooks which allocate the memory of every pool made afterwards,
+         * e.g. memory the driver of a GPU can transfer from directly
+         * (cudaHostAlloc, or heap memory after cudaHostRegister).
+         * Memory from the allocator ignores the allocation policy.
+         */
+        struct UHD_API allocator_t{
+            //! Allocate a number of bytes, return NULL for regular memory
+            boost::function<void *(size_t)> alloc;
+
+            //! Free memory returned by alloc, given its size in bytes
+            boost::function<void(void *, size_t)> free;
+        };
+
+        /*!
+         * Set the allocator for the pools made from now on.
+         * Pools keep the free hook of the allocator they were made with;
+         * it must stay usable until the devices using them are destroyed.
+         * An allocator without an alloc hook restores regular memory.
+         * \param allocator the allocator hooks
+         */
+        static void set_allocator(const allocator_t &allocator);
+
         /*!
          * Make a new buffer pool.
          * \param num_buffs the number of buffers to allocate
@@ -48,6 +105,23 @@ namespace uhd{ namespace transport{
             const size_t alignment = 16
         );
 
+        /*!
+         * Make a new buffer pool with an allocation policy.
+         * If the hugepage or NUMA request cannot be fulfilled, a warning is
+         * printed and the pool falls back to regular memory.
+         * \param num_buffs the number of buffers to allocate
+         * \param buff_size the size of each buffer in bytes
+         * \param alignment the alignment boundary in bytes
+         * \param policy how to allocate the memory
+         * \return a new buffer pool buff_size X num_buffs
+         */
+        static sptr make(
+            const size_t num_buffs,
+            const size_t buff_size,
+            const size_t alignment,
+            const alloc_policy_t &policy
+        );
+
         //! Get a pointer to the buffer start at the specified index
         virtual ptr_type at(const size_t index) const = 0;
 
@@ -105,6 +105,79 @@ namespace chdr{
         if_packet_info_t &if_packet_info
     );
 
+    //! The header cache of one stream, see vrt::if_hdr_cache_t
+    using vrt::if_hdr_cache_t;
+
+    /*!
+     * Unpack a CHDR header to metadata (big endian format), using
+     * the header of the previous packet when it matches.
+     *
+     * Gives the same results as if_hdr_unpack_be().
+     *
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_cached_be(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+    );
+
+    /*!
+     * Unpack a CHDR header to metadata (little endian format), using
+     * the header of the previous packet when it matches.
+     *
+     * Gives the same results as if_hdr_unpack_le().
+     *
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_cached_le(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+    );
+
+    /*!
+     * Unpack the CHDR headers of several packets of one stream
+     * (big endian format).
+     *
+     * As for if_hdr_unpack_be(), `num_packet_words32` of every
+     * if packet info must be set to the size of its buffer.
+     * Throws on the first bad header.
+     *
+     * \param packet_buffs the packets to read the headers from
+     * \param if_packet_infos one if packet info per packet (read/write)
+     * \param num_packets the number of packets
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_batch_be(
+        const uint32_t *const *packet_buffs,
+        if_packet_info_t *if_packet_infos,
+        const size_t num_packets,
+        if_hdr_cache_t &cache
+    );
+
+    /*!
+     * Unpack the CHDR headers of several packets of one stream
+     * (little endian format).
+     *
+     * See if_hdr_unpack_batch_be().
+     *
+     * \param packet_buffs the packets to read the headers from
+     * \param if_packet_infos one if packet info per packet (read/write)
+     * \param num_packets the number of packets
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_batch_le(
+        const uint32_t *const *packet_buffs,
+        if_packet_info_t *if_packet_infos,
+        const size_t num_packets,
+        if_hdr_cache_t &cache
+    );
+
 } //namespace chdr
 
 }}} //namespace uhd::transport::vrt
@@ -0,0 +1,82 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_FRAME_POOL_HPP
+#define INCLUDED_UHD_TRANSPORT_FRAME_POOL_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * A frame pool is memory that several transports of a device share:
+     * Instead of a buffer pool each, sized for the worst case, the
+     * transports borrow frames from the pool while they hold a packet
+     * and give them back once it was consumed. Frames given back are
+     * handed out again first, so the frames in use stay warm in cache.
+     *
+     * Taking and giving back frames is lock-free; only a caller that
+     * waits for a frame of an empty pool takes a lock.
+     */
+    class UHD_API frame_pool : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<frame_pool> sptr;
+
+        virtual ~frame_pool(void) = 0;
+
+        /*!
+         * Make a new frame pool.
+         * \param num_frames the number of frames to allocate
+         * \param frame_size the size of each frame in bytes
+         * \param policy where and how the pool memory is allocated
+         * \return a new frame pool
+         */
+        static sptr make(
+            const size_t num_frames,
+            const size_t frame_size,
+            const buffer_pool::alloc_policy_t &policy = buffer_pool::alloc_policy_t()
+        );
+
+        //! Get the size of each frame in bytes
+        virtual size_t get_frame_size(void) const = 0;
+
+        //! Get the number of frames in the pool
+        virtual size_t get_num_frames(void) const = 0;
+
+        //! Get the number of free frames (already stale, for statistics)
+        virtual size_t get_num_free(void) const = 0;
+
+        /*!
+         * Take a free frame.
+         * \param timeout the time to wait for a frame in seconds
+         * \return the frame, or NULL when none was free in time
+         */
+        virtual void *alloc(const double timeout = 0.0) = 0;
+
+        /*!
+         * Give a frame back to the pool.
+         * \param frame a frame returned by alloc()
+         */
+        virtual void free(void *frame) = 0;
+    };
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_FRAME_POOL_HPP */
@@ -0,0 +1,182 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_HPP
+#define INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_HPP
+
+#include <uhd/transport/lockfree_bounded_buffer.ipp> //detail
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * Implement a lock-free single-producer/single-consumer bounded buffer:
+     * A drop-in replacement for bounded_buffer on hot paths where exactly
+     * one thread pushes and exactly one thread pops. The haste operations
+     * never block or take a lock. The waiting operations spin briefly,
+     * then sleep until the other side delivers or the timeout expires.
+     *
+     * There is no push_with_pop_on_full(): the producer may not pop.
+     */
+    template <typename elem_type> class spsc_bounded_buffer{
+    public:
+
+        /*!
+         * Create a new bounded buffer object.
+         * \param capacity the bounded_buffer capacity
+         */
+        spsc_bounded_buffer(size_t capacity):
+            _detail(capacity)
+        {
+            /* NOP */
+        }
+
+        /*!
+         * Push a new element into the bounded buffer immediately.
+         * The element will not be pushed when the buffer is full.
+         * \param elem the element reference pop to
+         * \return false when the buffer is full
+         */
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            return _detail.push_with_haste(elem);
+        }
+
+        /*!
+         * Push a new element into the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-full.
+         * \param elem the new element to push
+         */
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            return _detail.push_with_wait(elem);
+        }
+
+        /*!
+         * Push a new element into the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-full or timeout.
+         * \param elem the new element to push
+         * \param timeout the timeout in seconds
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            return _detail.push_with_timed_wait(elem, timeout);
+        }
+
+        /*!
+         * Pop an element from the bounded buffer immediately.
+         * The element will not be popped when the buffer is empty.
+         * \param elem the element reference pop to
+         * \return false when the buffer is empty
+         */
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            return _detail.pop_with_haste(elem);
+        }
+
+        /*!
+         * Pop an element from the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-empty.
+         * \param elem the element reference pop to
+         */
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            return _detail.pop_with_wait(elem);
+        }
+
+        /*!
+         * Pop an element from the bounded_buffer.
+         * Wait until the bounded_buffer becomes non-empty or timeout.
+         * \param elem the element reference pop to
+         * \param timeout the timeout in seconds
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            return _detail.pop_with_timed_wait(elem, timeout);
+        }
+
+        /*!
+         * Get the number of elements in the buffer.
+         * The value may already be stale; use it for statistics only.
+         * \return the number of elements
+         */
+        UHD_INLINE size_t size(void) const{
+            return _detail.size();
+        }
+
+    private: lockfree_detail::lockfree_buffer<lockfree_detail::spsc_ring<elem_type>, elem_type> _detail;
+    };
+
+    /*!
+     * Implement a lock-free multi-producer/multi-consumer bounded buffer:
+     * Same interface as spsc_bounded_buffer, but any number of threads
+     * may push and pop concurrently. Used where several threads hand
+     * buffers to each other, e.g. in packet demuxers.
+     */
+    template <typename elem_type> class mpmc_bounded_buffer{
+    public:
+
+        /*!
+         * Create a new bounded buffer object.
+         * \param capacity the bounded_buffer capacity
+         */
+        mpmc_bounded_buffer(size_t capacity):
+            _detail(capacity)
+        {
+            /* NOP */
+        }
+
+        //! \see spsc_bounded_buffer::push_with_haste()
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            return _detail.push_with_haste(elem);
+        }
+
+        //! \see spsc_bounded_buffer::push_with_wait()
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            return _detail.push_with_wait(elem);
+        }
+
+        //! \see spsc_bounded_buffer::push_with_timed_wait()
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            return _detail.push_with_timed_wait(elem, timeout);
+        }
+
+        //! \see spsc_bounded_buffer::pop_with_haste()
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            return _detail.pop_with_haste(elem);
+        }
+
+        //! \see spsc_bounded_buffer::pop_with_wait()
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            return _detail.pop_with_wait(elem);
+        }
+
+        //! \see spsc_bounded_buffer::pop_with_timed_wait()
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            return _detail.pop_with_timed_wait(elem, timeout);
+        }
+
+        /*!
+         * Get the number of elements in the buffer.
+         * The value may already be stale; use it for statistics only.
+         * \return the number of elements
+         */
+        UHD_INLINE size_t size(void) const{
+            return _detail.size();
+        }
+
+    private: lockfree_detail::lockfree_buffer<lockfree_detail::mpmc_ring<elem_type>, elem_type> _detail;
+    };
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_HPP */
@@ -0,0 +1,356 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_IPP
+#define INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_IPP
+
+#include <uhd/config.hpp>
+#include <boost/utility.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace uhd{ namespace transport{ namespace lockfree_detail{
+
+    //! Keep the producer and consumer indexes on separate cache lines
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    /*!
+     * Adaptive waiter used by the lock-free buffers:
+     * A waiting thread first spins on the condition (cheap when the other
+     * side is about to deliver), then parks on a condition variable (a
+     * futex on Linux). The notifying side only pays for a wakeup call
+     * when somebody is actually parked.
+     */
+    class spin_then_block_waiter : boost::noncopyable
+    {
+    public:
+        spin_then_block_waiter(void): _num_waiters(0) {}
+
+        template <typename pred_type>
+        UHD_INLINE bool wait(pred_type ready, const double timeout)
+        {
+            if (ready()) return true;
+            if (timeout <= 0.0) return false;
+
+            static const size_t NUM_SPINS = 256;
+            for (size_t i = 0; i < NUM_SPINS; i++){
+                if (ready()) return true;
+                if ((i & 0x3f) == 0x3f) boost::this_thread::yield();
+            }
+
+            const boost::system_time exit_time =
+                boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_waiters.fetch_add(1);
+            while (not ready()){
+                if (not _cond.timed_wait(lock, exit_time)){
+                    const bool ok = ready();
+                    _num_waiters.fetch_sub(1);
+                    return ok;
+                }
+            }
+            _num_waiters.fetch_sub(1);
+            return true;
+        }
+
+        template <typename pred_type>
+        UHD_INLINE void wait(pred_type ready)
+        {
+            while (not this->wait(ready, 1.0)) /*NOP*/;
+        }
+
+        //! Call after publishing a change the other side may wait on
+        UHD_INLINE void notify(void)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_num_waiters.load(std::memory_order_relaxed) == 0) return;
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_all();
+        }
+
+    private:
+        std::atomic<size_t> _num_waiters;
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
+    };
+
+    /*!
+     * Single-producer/single-consumer ring:
+     * Each side owns one index and only reads the other one. The slot
+     * positions are kept by each side locally, so no division is needed
+     * on the fast path.
+     */
+    template <typename elem_type> class spsc_ring : boost::noncopyable
+    {
+    public:
+        spsc_ring(const size_t capacity):
+            _capacity(capacity), _buffer(capacity),
+            _head(0), _tail(0), _head_slot(0), _tail_slot(0)
+        {
+            /* NOP */
+        }
+
+        UHD_INLINE bool full(void) const
+        {
+            return _tail.load(std::memory_order_relaxed) -
+                _head.load(std::memory_order_acquire) == _capacity;
+        }
+
+        UHD_INLINE bool empty(void) const
+        {
+            return _tail.load(std::memory_order_acquire) ==
+                _head.load(std::memory_order_relaxed);
+        }
+
+        //! Any thread: the number of elements, may be stale
+        UHD_INLINE size_t size(void) const
+        {
+            const size_t head = _head.load(std::memory_order_acquire);
+            const size_t tail = _tail.load(std::memory_order_acquire);
+            return (tail > head)? tail - head : 0;
+        }
+
+        //! Producer only: push unless full
+        UHD_INLINE bool try_push(const elem_type &elem)
+        {
+            const size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) == _capacity) return false;
+            _buffer[_tail_slot] = elem;
+            if (++_tail_slot == _capacity) _tail_slot = 0;
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Consumer only: pop unless empty
+        UHD_INLINE bool try_pop(elem_type &elem)
+        {
+            const size_t head = _head.load(std::memory_order_relaxed);
+            if (_tail.load(std::memory_order_acquire) == head) return false;
+            elem = _buffer[_head_slot];
+            _buffer[_head_slot] = elem_type(); //drop the reference held by the slot
+            if (++_head_slot == _capacity) _head_slot = 0;
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        const size_t _capacity;
+        std::vector<elem_type> _buffer;
+        char _pad0[CACHE_LINE_SIZE];
+        std::atomic<size_t> _head; //written by the consumer
+        char _pad1[CACHE_LINE_SIZE];
+        std::atomic<size_t> _tail; //written by the producer
+        char _pad2[CACHE_LINE_SIZE];
+        size_t _head_slot; //consumer private
+        char _pad3[CACHE_LINE_SIZE];
+        size_t _tail_slot; //producer private
+    };
+
+    /*!
+     * Multi-producer/multi-consumer ring (bounded Vyukov queue):
+     * Every cell carries a sequence number which tells producers and
+     * consumers whether the cell is ready for them. Threads claim a
+     * position with a compare-and-swap on the shared index.
+     */
+    template <typename elem_type> class mpmc_ring : boost::noncopyable
+    {
+    public:
+        mpmc_ring(const size_t capacity):
+            _capacity(capacity), _cells(capacity), _head(0), _tail(0)
+        {
+            for (size_t i = 0; i < _capacity; i++){
+                _cells[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        UHD_INLINE bool full(void) const
+        {
+            return _tail.load(std::memory_order_acquire) -
+                _head.load(std::memory_order_acquire) >= _capacity;
+        }
+
+        UHD_INLINE bool empty(void) const
+        {
+            return _tail.load(std::memory_order_acquire) ==
+                _head.load(std::memory_order_acquire);
+        }
+
+        //! The number of elements, may be stale
+        UHD_INLINE size_t size(void) const
+        {
+            const size_t head = _head.load(std::memory_order_acquire);
+            const size_t tail = _tail.load(std::memory_order_acquire);
+            return (tail > head)? std::min(tail - head, _capacity) : 0;
+        }
+
+        UHD_INLINE bool try_push(const elem_type &elem)
+        {
+            size_t pos = _tail.load(std::memory_order_relaxed);
+            while (true){
+                cell_type &cell = _cells[pos % _capacity];
+                const size_t seq = cell.seq.load(std::memory_order_acquire);
+                const ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+                if (diff == 0){
+                    if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                        cell.elem = elem;
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) return false; //full
+                else pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        UHD_INLINE bool try_pop(elem_type &elem)
+        {
+            size_t pos = _head.load(std::memory_order_relaxed);
+            while (true){
+                cell_type &cell = _cells[pos % _capacity];
+                const size_t seq = cell.seq.load(std::memory_order_acquire);
+                const ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos + 1);
+                if (diff == 0){
+                    if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                        elem = cell.elem;
+                        cell.elem = elem_type(); //drop the reference held by the cell
+                        cell.seq.store(pos + _capacity, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) return false; //empty
+                else pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        struct cell_type
+        {
+            cell_type(void): seq(0) {}
+            std::atomic<size_t> seq;
+            elem_type elem;
+        };
+
+        const size_t _capacity;
+        std::vector<cell_type> _cells;
+        char _pad0[CACHE_LINE_SIZE];
+        std::atomic<size_t> _head;
+        char _pad1[CACHE_LINE_SIZE];
+        std::atomic<size_t> _tail;
+    };
+
+    /*!
+     * The blocking interface shared by the lock-free buffers.
+     * It is the same as the interface of bounded_buffer.
+     */
+    template <typename ring_type, typename elem_type> class lockfree_buffer : boost::noncopyable
+    {
+    public:
+        lockfree_buffer(const size_t capacity): _ring(capacity) {}
+
+        UHD_INLINE bool push_with_haste(const elem_type &elem)
+        {
+            if (not _ring.try_push(elem)) return false;
+            _not_empty.notify();
+            return true;
+        }
+
+        UHD_INLINE void push_with_wait(const elem_type &elem)
+        {
+            while (not _ring.try_push(elem)){
+                _not_full.wait(not_full_pred(_ring));
+            }
+            _not_empty.notify();
+        }
+
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, const double timeout)
+        {
+            if (not _ring.try_push(elem)){
+                const boost::system_time exit_time =
+                    boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+                double time_left = timeout;
+                do {
+                    if (not _not_full.wait(not_full_pred(_ring), time_left)) return false;
+                    time_left = double((exit_time - boost::get_system_time()).total_microseconds())/1e6;
+                } while (not _ring.try_push(elem));
+            }
+            _not_empty.notify();
+            return true;
+        }
+
+        UHD_INLINE bool pop_with_haste(elem_type &elem)
+        {
+            if (not _ring.try_pop(elem)) return false;
+            _not_full.notify();
+            return true;
+        }
+
+        UHD_INLINE void pop_with_wait(elem_type &elem)
+        {
+            while (not _ring.try_pop(elem)){
+                _not_empty.wait(not_empty_pred(_ring));
+            }
+            _not_full.notify();
+        }
+
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, const double timeout)
+        {
+            if (not _ring.try_pop(elem)){
+                const boost::system_time exit_time =
+                    boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+                double time_left = timeout;
+                do {
+                    if (not _not_empty.wait(not_empty_pred(_ring), time_left)) return false;
+                    time_left = double((exit_time - boost::get_system_time()).total_microseconds())/1e6;
+                } while (not _ring.try_pop(elem));
+            }
+            _not_full.notify();
+            return true;
+        }
+
+        UHD_INLINE size_t size(void) const
+        {
+            return _ring.size();
+        }
+
+    private:
+        struct not_full_pred
+        {
+            not_full_pred(const ring_type &ring): _r(ring) {}
+            bool operator()(void) const {return not _r.full();}
+            const ring_type &_r;
+        };
+
+        struct not_empty_pred
+        {
+            not_empty_pred(const ring_type &ring): _r(ring) {}
+            bool operator()(void) const {return not _r.empty();}
+            const ring_type &_r;
+        };
+
+        ring_type _ring;
+        spin_then_block_waiter _not_empty, _not_full;
+    };
+
+}}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_LOCKFREE_BOUNDED_BUFFER_IPP */
@@ -34,6 +34,12 @@ namespace uhd { namespace transport {
  * This class handles demuxing receive streams into the
  * appropriate virtual streams with the given classifier
  * function. A worker therad is spawned to handle the demuxing.
+ *
+ * Frames are handed to the virtual streams without copying: a stream
+ * buffer references the base transport's frame, which is only released
+ * back to the base transport when the consumer releases the stream buffer.
+ * Each stream may hold up to num_recv_frames/max_streams base frames, so
+ * the base transport must be sized for all streams together.
  */
 class muxed_zero_copy_if : private boost::noncopyable {
 public:
@@ -44,17 +50,45 @@ public:
      * The classifier must return a stream number, an arbitrary
      * identifier for a virtual stream that is consistent with
      * the stream number used in the make_stream and remove_stream
-     * fuctions
+     * fuctions. Stream numbers fit in 16 bits (e.g. the destination
+     * address of a SID): the worker thread looks them up in a flat
+     * table, without taking a lock.
      * \param buff a pointer to the payload of the frame
      * \param size number of bytes in the frame payload
      * \return stream number
      */
     typedef boost::function<uint32_t(void* buff, size_t size)> stream_classifier_fn;
 
+    /*!
+     * How the worker thread waits for frames when the base transport is idle.
+     * The worker first polls the base transport without blocking up to
+     * spin_count times, then blocks inside the base transport's
+     * get_recv_buff() (e.g. in poll() on the socket) for up to
+     * block_timeout seconds. block_timeout also bounds how long it takes
+     * to shut down the worker thread.
+     */
+    struct wait_policy_t {
+        wait_policy_t() : spin_count(64), block_timeout(0.1) {}
+        size_t spin_count;
+        double block_timeout;
+    };
+
+    //! Time the worker thread spent waiting for frames
+    struct wait_stats_t {
+        wait_stats_t() : num_spins(0), num_blocks(0), spin_ns(0), block_ns(0) {}
+        uint64_t num_spins;     //!< Number of non-blocking polls that came back empty
+        uint64_t num_blocks;    //!< Number of blocking waits
+        uint64_t spin_ns;       //!< Total time spent in empty polls
+        uint64_t block_ns;      //!< Total time spent in blocking waits
+    };
+
     //! virtual dtor
     virtual ~muxed_zero_copy_if() {}
 
-    //! Make a virtual transport for the specified stream number
+    /*!
+     * Make a virtual transport for the specified stream number
+     * \throws uhd::value_error if the stream number does not fit in 16 bits
+     */
     virtual zero_copy_if::sptr make_stream(const uint32_t stream_num) = 0;
 
     //! Unregister the stream number. All packets destined to the stream will be dropped.
@@ -63,8 +97,16 @@ public:
     //! Get number of frames dropped due to unregistered streams
     virtual size_t get_num_dropped_frames() const = 0;
 
+    //! Get the time the worker thread spent spinning and blocking
+    virtual wait_stats_t get_wait_stats() const = 0;
+
     //! Make a new demuxer from a transport and parameters
-    static sptr make(zero_copy_if::sptr base_xport, stream_classifier_fn classify_fn, size_t max_streams);
+    static sptr make(
+        zero_copy_if::sptr base_xport,
+        stream_classifier_fn classify_fn,
+        size_t max_streams,
+        const wait_policy_t &wait_policy = wait_policy_t()
+    );
 };
 
 }} //namespace uhd::transport
@@ -0,0 +1,95 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_SC16_DELTA_HPP
+#define INCLUDED_UHD_TRANSPORT_SC16_DELTA_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Lossless compression of sc16 sample payloads.
+ *
+ * A payload of N samples (one 32-bit item per sample) is coded as:
+ * - a word holding N in the upper 16 bits and the delta width K
+ *   (0 to 16) in the lower 8 bits,
+ * - the first sample as is,
+ * - for every following sample, the difference of each 16-bit half to
+ *   the one of the previous sample, zigzag coded (0, -1, 1, -2, ... as
+ *   0, 1, 2, 3, ...) in K bits, packed LSB first into 32-bit words.
+ *
+ * K is the smallest width that holds every difference of the payload, so
+ * slowly changing or small signals take a fraction of the sc16 size, and
+ * any signal takes at most two words more. The words are in host order.
+ */
+namespace sc16_delta{
+
+    //! The most words that encode() writes for nsamps samples
+    UHD_API size_t max_encoded_words32(const size_t nsamps);
+
+    /*!
+     * Encode a payload.
+     * \param in nsamps items
+     * \param nsamps the number of samples, at most 65535
+     * \param out room for max_encoded_words32(nsamps) words
+     * \return the number of words written
+     */
+    UHD_API size_t encode(const uint32_t *in, const size_t nsamps, uint32_t *out);
+
+    /*!
+     * Decode a payload.
+     * Throws uhd::value_error if the payload is malformed or holds
+     * more than max_nsamps samples.
+     * \param in the encoded payload
+     * \param nwords32 the number of words in the payload
+     * \param out room for max_nsamps items
+     * \param max_nsamps the most samples to decode
+     * \return the number of samples written
+     */
+    UHD_API size_t decode(
+        const uint32_t *in, const size_t nwords32,
+        uint32_t *out, const size_t max_nsamps
+    );
+
+    /*!
+     * A receive transport that decodes compressed data packets.
+     * The packets it returns have their payload expanded to plain sc16,
+     * so a streamer reads them with the usual sc16 converters. Packets
+     * that are not data packets, or have no payload, pass through.
+     */
+    class UHD_API decoder : public virtual zero_copy_if{
+    public:
+        typedef boost::shared_ptr<decoder> sptr;
+
+        /*!
+         * Make a decoding transport.
+         * \param transport the transport that receives the compressed packets
+         * \param chdr true for CHDR packets, false for VRT packets
+         * \param big_endian true if headers and payload are big endian
+         */
+        static sptr make(zero_copy_if::sptr transport, const bool chdr, const bool big_endian);
+    };
+
+} //namespace sc16_delta
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_SC16_DELTA_HPP */
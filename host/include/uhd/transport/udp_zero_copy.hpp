@@ -20,6 +20,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/frame_pool.hpp>
 #include <uhd/types/device_addr.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -59,13 +60,18 @@ public:
      * \param default_buff_args Default values for frame sizes and num frames
      * \param[out] buff_params_out Returns the actual buffer sizes
      * \param hints optional parameters to pass to the underlying transport
+     * \param shared_frames optional pool to borrow the frames from, instead
+     *        of allocating them; the transport keeps the number of frames
+     *        in the hint shared_frames_reserve (default 8) in each direction
+     *        and borrows the others while a packet is held
      */
     static sptr make(
         const std::string &addr,
         const std::string &port,
         const zero_copy_xport_params &default_buff_args,
         udp_zero_copy::buff_params& buff_params_out,
-        const device_addr_t &hints = device_addr_t()
+        const device_addr_t &hints = device_addr_t(),
+        const frame_pool::sptr &shared_frames = frame_pool::sptr()
     );
 };
 
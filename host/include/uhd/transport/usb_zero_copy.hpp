@@ -21,6 +21,7 @@
 #include <uhd/transport/usb_device_handle.hpp>
 #include <uhd/transport/zero_copy.hpp>
 #include <uhd/types/device_addr.hpp>
+#include <vector>
 
 namespace uhd { namespace transport {
 
@@ -40,6 +41,31 @@ public:
 
     virtual ~usb_zero_copy(void);
 
+    /*!
+     * Transfer timing of one endpoint.
+     * Histogram bucket i counts the events that took between 2^i and
+     * 2^(i+1) microseconds (bucket 0 also holds everything below 1 us,
+     * the last bucket everything above).
+     */
+    struct xfer_stats_t{
+        xfer_stats_t(void): num_transfers(0){}
+
+        //! Number of completed transfers
+        size_t num_transfers;
+
+        //! Time from submission to completion of each transfer
+        std::vector<size_t> latency_hist;
+
+        //! Time from completion until the transfer was submitted again
+        std::vector<size_t> resubmit_hist;
+    };
+
+    //! Get the transfer timing of the IN endpoint (empty if not tracked)
+    virtual xfer_stats_t get_recv_stats(void) const;
+
+    //! Get the transfer timing of the OUT endpoint (empty if not tracked)
+    virtual xfer_stats_t get_send_stats(void) const;
+
     /*!
      * Make a new zero copy USB transport:
      * This transport is for sending and receiving between the host
@@ -203,6 +203,63 @@ namespace vrt{
         has_tlr(false), tlr(0)
     {}
 
+    /*!
+     * Header cache of one stream.
+     *
+     * The packets of a stream almost always have the same type, flags
+     * and length. The cached unpackers (VRT and CHDR) compare the first
+     * header word, without the sequence number, against the previous
+     * packet, and only parse the header in full when it differs.
+     *
+     * A cache must only be used for packets of one stream, by one
+     * thread at a time.
+     */
+    struct if_hdr_cache_t
+    {
+        if_hdr_cache_t(void): valid(false), key(0) {}
+
+        //! Forget the cached header, the next packet is parsed in full
+        void reset(void) { valid = false; }
+
+        bool valid;
+        uint32_t key;
+        if_packet_info_t if_packet_info;
+    };
+
+    /*!
+     * Unpack a vrt header to metadata (big endian format), using
+     * the header of the previous packet when it matches.
+     *
+     * Gives the same results as if_hdr_unpack_be(). Only packets
+     * without a link layer (`LINK_TYPE_NONE`) use the cache.
+     *
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_cached_be(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+    );
+
+    /*!
+     * Unpack a vrt header to metadata (little endian format), using
+     * the header of the previous packet when it matches.
+     *
+     * Gives the same results as if_hdr_unpack_le(). Only packets
+     * without a link layer (`LINK_TYPE_NONE`) use the cache.
+     *
+     * \param packet_buff memory to read the packed vrt header
+     * \param if_packet_info the if packet info (read/write)
+     * \param cache the header cache of this stream
+     */
+    UHD_API void if_hdr_unpack_cached_le(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+    );
+
 } //namespace vrt
 
 }} //namespace
@@ -0,0 +1,88 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_XDP_ZERO_COPY_HPP
+#define INCLUDED_UHD_TRANSPORT_XDP_ZERO_COPY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A kernel-bypass UDP transport built on AF_XDP sockets (Linux only).
+ *
+ * Frames are received into and sent from a UMEM area that is shared with
+ * the NIC driver. Managed receive buffers point directly into the UMEM
+ * frame (past the Ethernet/IPv4/UDP headers), so the payload is never
+ * copied. The IP and UDP headers of outgoing frames are filled in by the
+ * transport.
+ *
+ * The AF_XDP socket takes over every frame arriving on the selected NIC
+ * queue. Traffic for this transport should be steered to a dedicated queue
+ * (e.g. with an ethtool ntuple rule on the UDP port); any other frames
+ * arriving on that queue are dropped.
+ *
+ * A frame must fit into a single UMEM chunk, so the frame sizes are capped
+ * at xdp_zero_copy::max_frame_size().
+ */
+class UHD_API xdp_zero_copy : public virtual zero_copy_if{
+public:
+    typedef boost::shared_ptr<xdp_zero_copy> sptr;
+
+    /*!
+     * Check if this build of UHD has AF_XDP support.
+     */
+    static bool is_supported(void);
+
+    //! The largest frame size (UDP payload) an AF_XDP frame can carry
+    static size_t max_frame_size(void);
+
+    /*!
+     * Make a new AF_XDP zero copy transport.
+     *
+     * The following hints are used:
+     *  - xdp_iface: the network interface to bind to (default: the
+     *    interface whose subnet contains addr)
+     *  - xdp_queue: the NIC receive queue to bind to (default: 0)
+     *  - xdp_zero_copy: 1 to require driver zero-copy mode, 0 to allow
+     *    copy mode (default: 0)
+     *  - recv_frame_size, num_recv_frames, send_frame_size,
+     *    num_send_frames: the UMEM layout
+     *
+     * \param addr a string representing the destination address
+     * \param port a string representing the destination port
+     * \param default_buff_args Default values for frame sizes and num frames
+     * \param[out] buff_params_out Returns the UMEM sizes
+     * \param hints optional parameters to pass to the underlying transport
+     * \throws uhd::not_implemented_error if AF_XDP is not available
+     */
+    static sptr make(
+        const std::string &addr,
+        const std::string &port,
+        const zero_copy_xport_params &default_buff_args,
+        udp_zero_copy::buff_params& buff_params_out,
+        const device_addr_t &hints = device_addr_t()
+    );
+};
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_XDP_ZERO_COPY_HPP */
@@ -23,6 +23,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/intrusive_ptr.hpp>
 #include <boost/detail/atomic_count.hpp>
+#include <stdint.h>
 
 namespace uhd{ namespace transport{
 
@@ -144,6 +145,54 @@ namespace uhd{ namespace transport{
         size_t num_send_frames;
     };
 
+    /*!
+     * Transport performance counters.
+     * The counters start at zero when the transport is created.
+     * Transports that do not keep counters report all zeros.
+     */
+    struct zero_copy_stats_t {
+        zero_copy_stats_t(void):
+            num_recv_packets(0), num_recv_bytes(0), num_recv_timeouts(0),
+            num_recv_pool_empty(0), recv_wait_ns(0),
+            num_send_packets(0), num_send_timeouts(0),
+            num_send_pool_empty(0), send_wait_ns(0),
+            num_dropped(0), recv_queue_depth(0),
+            num_kernel_drops(0), recv_latency_ns(0), max_recv_latency_ns(0)
+        {}
+
+        //! Frames handed out by get_recv_buff()
+        uint64_t num_recv_packets;
+        //! Bytes in the frames handed out by get_recv_buff()
+        uint64_t num_recv_bytes;
+        //! Calls to get_recv_buff() that timed out
+        uint64_t num_recv_timeouts;
+        //! Calls to get_recv_buff() that found all frames held by the user
+        uint64_t num_recv_pool_empty;
+        //! Time spent waiting for data in get_recv_buff()
+        uint64_t recv_wait_ns;
+
+        //! Frames handed out by get_send_buff()
+        uint64_t num_send_packets;
+        //! Calls to get_send_buff() that timed out
+        uint64_t num_send_timeouts;
+        //! Calls to get_send_buff() that found all frames in use
+        uint64_t num_send_pool_empty;
+        //! Time spent waiting for a frame in get_send_buff()
+        uint64_t send_wait_ns;
+
+        //! Received packets the transport discarded
+        uint64_t num_dropped;
+        //! Frames received but not yet handed out (0 if unknown)
+        size_t recv_queue_depth;
+
+        //! Packets the kernel dropped on the socket (0 if unknown)
+        uint64_t num_kernel_drops;
+        //! Sum over received packets of the time from kernel arrival to get_recv_buff()
+        uint64_t recv_latency_ns;
+        //! Largest time from kernel arrival to get_recv_buff()
+        uint64_t max_recv_latency_ns;
+    };
+
     /*!
      * A zero-copy interface for transport objects.
      * Provides a way to get send and receive buffers
@@ -200,6 +249,15 @@ namespace uhd{ namespace transport{
          */
         virtual size_t get_send_frame_size(void) const = 0;
 
+        /*!
+         * Get the performance counters of this transport.
+         * Reading them is cheap and does not disturb the data path.
+         * \return a snapshot of the counters
+         */
+        virtual zero_copy_stats_t get_stats(void) const {
+            return zero_copy_stats_t();
+        }
+
     };
 
 }} //namespace
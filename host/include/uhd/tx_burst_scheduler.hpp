@@ -0,0 +1,106 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TX_BURST_SCHEDULER_HPP
+#define INCLUDED_UHD_TX_BURST_SCHEDULER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+namespace uhd{
+
+/*!
+ * Sends timed bursts on a TX streamer in order of their start times.
+ *
+ * Bursts can be scheduled well ahead of time and in any order. A worker
+ * thread owned by the scheduler sends each burst with its time spec,
+ * start and end of burst flags once its start time is less than the
+ * lead time away. The streamer's flow control keeps the device from
+ * being overfilled, so the application does not have to pace send().
+ *
+ * A burst whose start time has already passed when it is due is not
+ * sent. Instead, recv_async_msg() reports it with
+ * uhd::async_metadata_t::EVENT_CODE_TIME_ERROR, its start time and
+ * its burst ID in user_payload[0]. recv_async_msg() also returns the
+ * async messages of the streamer (e.g. burst ACKs and underflows).
+ *
+ * The samples of a burst are copied when it is scheduled. The streamer
+ * must not be used for sending while the scheduler exists.
+ */
+class UHD_API tx_burst_scheduler : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<tx_burst_scheduler> sptr;
+
+    //! Returns the current device time, e.g. multi_usrp::get_time_now()
+    typedef boost::function<time_spec_t(void)> time_source_type;
+
+    /*!
+     * Make a new scheduler.
+     * \param streamer the streamer to send the bursts to
+     * \param cpu_format the cpu format the streamer was made with
+     * \param get_time_now the device time, used for the lead time and to
+     *        detect late bursts
+     * \param lead_time how long before its start time a burst is sent,
+     *        in seconds
+     */
+    static sptr make(
+        tx_streamer::sptr streamer,
+        const std::string &cpu_format,
+        const time_source_type &get_time_now,
+        const double lead_time = 0.1
+    );
+
+    virtual ~tx_burst_scheduler(void);
+
+    /*!
+     * Schedule a burst.
+     * Bursts with the same start time are sent in the order they were
+     * scheduled.
+     * \param buffs one buffer per channel of the streamer
+     * \param nsamps_per_buff the number of samples in the burst, per buffer
+     * \param time the device time of the first sample
+     * \return the ID of the burst, as reported for late bursts
+     */
+    virtual uint32_t schedule(
+        const tx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const time_spec_t &time
+    ) = 0;
+
+    //! Get the number of bursts that were not sent yet
+    virtual size_t get_num_pending(void) = 0;
+
+    /*!
+     * Get an async message about late bursts or from the streamer.
+     * \param async_metadata the metadata to be filled in
+     * \param timeout the timeout in seconds to wait for a message
+     * \return true when the async_metadata is valid, false for timeout
+     */
+    virtual bool recv_async_msg(
+        async_metadata_t &async_metadata, double timeout = 0.1
+    ) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_TX_BURST_SCHEDULER_HPP */
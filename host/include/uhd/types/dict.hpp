@@ -26,6 +26,9 @@ namespace uhd{
 
     /*!
      * A templated dictionary class with a python-like interface.
+     *
+     * Larger dictionaries keep a hash index for their lookups, so the key
+     * type must be hashable with boost::hash (i.e., have a hash_value()).
      */
     template <typename Key, typename Val> class dict{
     public:
@@ -34,6 +37,19 @@ namespace uhd{
          */
         dict(void);
 
+        /*!
+         * Copy constructor.
+         * \param other the dict to copy
+         */
+        dict(const dict<Key, Val> &other);
+
+        /*!
+         * Assignment operator.
+         * \param other the dict to copy
+         * \return this dict
+         */
+        dict<Key, Val> &operator=(const dict<Key, Val> &other);
+
         /*!
          * Input iterator constructor:
          * Makes boost::assign::map_list_of work.
@@ -137,6 +153,22 @@ namespace uhd{
     private:
         typedef std::pair<Key, Val> pair_t;
         std::list<pair_t> _map; //private container
+
+        /*!
+         * Open-addressing hash index into _map. Empty for small dicts,
+         * which are searched linearly. Otherwise, it has a power-of-two
+         * number of slots and is at most half full (free slots are NULL).
+         */
+        std::vector<pair_t *> _index;
+
+        //! Return the item with \p key, or NULL if there is none
+        pair_t *_find(const Key &key) const;
+
+        //! Add \p item (which must be in _map) to the index
+        void _add_to_index(pair_t *item);
+
+        //! Rebuild the index from _map
+        void _rebuild_index(void);
     };
 
 } //namespace uhd
@@ -21,6 +21,7 @@
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/lexical_cast.hpp>
 #include <typeinfo>
 
@@ -39,6 +40,9 @@ namespace uhd{
                 /* NOP */
             }
         };
+
+        //! Below this size, a linear search is faster than hashing the key
+        static const std::size_t DICT_MIN_INDEXED_SIZE = 8;
     } // namespace /*anon*/
 
     template <typename Key, typename Val>
@@ -50,7 +54,23 @@ namespace uhd{
     dict<Key, Val>::dict(InputIterator first, InputIterator last):
         _map(first, last)
     {
-        /* NOP */
+        _rebuild_index();
+    }
+
+    template <typename Key, typename Val>
+    dict<Key, Val>::dict(const dict<Key, Val> &other):
+        _map(other._map)
+    {
+        _rebuild_index();
+    }
+
+    template <typename Key, typename Val>
+    dict<Key, Val> &dict<Key, Val>::operator=(const dict<Key, Val> &other){
+        if (this != &other){
+            _map = other._map;
+            _rebuild_index();
+        }
+        return *this;
     }
 
     template <typename Key, typename Val>
@@ -61,6 +81,7 @@ namespace uhd{
     template <typename Key, typename Val>
     std::vector<Key> dict<Key, Val>::keys(void) const{
         std::vector<Key> keys;
+        keys.reserve(_map.size());
         BOOST_FOREACH(const pair_t &p, _map){
             keys.push_back(p.first);
         }
@@ -70,6 +91,7 @@ namespace uhd{
     template <typename Key, typename Val>
     std::vector<Val> dict<Key, Val>::vals(void) const{
         std::vector<Val> vals;
+        vals.reserve(_map.size());
         BOOST_FOREACH(const pair_t &p, _map){
             vals.push_back(p.second);
         }
@@ -78,47 +100,45 @@ namespace uhd{
 
     template <typename Key, typename Val>
     bool dict<Key, Val>::has_key(const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return true;
-        }
-        return false;
+        return _find(key) != NULL;
     }
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::get(const Key &key, const Val &other) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
-        return other;
+        const pair_t *p = _find(key);
+        if (p == NULL) return other;
+        return p->second;
     }
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::get(const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
-        throw key_not_found<Key, Val>(key);
+        const pair_t *p = _find(key);
+        if (p == NULL) throw key_not_found<Key, Val>(key);
+        return p->second;
     }
 
     template <typename Key, typename Val>
     void dict<Key, Val>::set(const Key &key, const Val &val){
-        (*this)[key] = val;
+        pair_t *p = _find(key);
+        if (p != NULL){
+            p->second = val;
+            return;
+        }
+        _map.push_back(std::make_pair(key, val));
+        _add_to_index(&_map.back());
     }
 
     template <typename Key, typename Val>
     const Val &dict<Key, Val>::operator[](const Key &key) const{
-        BOOST_FOREACH(const pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
-        throw key_not_found<Key, Val>(key);
+        return get(key);
     }
 
     template <typename Key, typename Val>
     Val &dict<Key, Val>::operator[](const Key &key){
-        BOOST_FOREACH(pair_t &p, _map){
-            if (p.first == key) return p.second;
-        }
+        pair_t *p = _find(key);
+        if (p != NULL) return p->second;
         _map.push_back(std::make_pair(key, Val()));
+        _add_to_index(&_map.back());
         return _map.back().second;
     }
 
@@ -129,12 +149,57 @@ namespace uhd{
             if (it->first == key){
                 Val val = it->second;
                 _map.erase(it);
+                _rebuild_index();
                 return val;
             }
         }
         throw key_not_found<Key, Val>(key);
     }
 
+    template <typename Key, typename Val>
+    typename dict<Key, Val>::pair_t *dict<Key, Val>::_find(const Key &key) const{
+        if (_index.empty()){
+            BOOST_FOREACH(const pair_t &p, _map){
+                if (p.first == key) return const_cast<pair_t *>(&p);
+            }
+            return NULL;
+        }
+        const std::size_t mask = _index.size() - 1;
+        for (std::size_t i = boost::hash<Key>()(key) & mask; _index[i] != NULL; i = (i + 1) & mask){
+            if (_index[i]->first == key) return _index[i];
+        }
+        return NULL;
+    }
+
+    template <typename Key, typename Val>
+    void dict<Key, Val>::_add_to_index(pair_t *item){
+        if (_map.size() * 2 > _index.size()){
+            _rebuild_index();
+            return;
+        }
+        const std::size_t mask = _index.size() - 1;
+        std::size_t i = boost::hash<Key>()(item->first) & mask;
+        while (_index[i] != NULL){
+            i = (i + 1) & mask;
+        }
+        _index[i] = item;
+    }
+
+    template <typename Key, typename Val>
+    void dict<Key, Val>::_rebuild_index(void){
+        _index.clear();
+        if (_map.size() < DICT_MIN_INDEXED_SIZE) return;
+        // Leave room to double in size before the next rebuild
+        std::size_t num_slots = 4 * DICT_MIN_INDEXED_SIZE;
+        while (num_slots < 4 * _map.size()){
+            num_slots <<= 1;
+        }
+        _index.resize(num_slots, NULL);
+        BOOST_FOREACH(pair_t &p, _map){
+            _add_to_index(&p);
+        }
+    }
+
     template <typename Key, typename Val>
     void dict<Key, Val>::update(const dict<Key, Val> &new_dict, bool fail_on_conflict)
     {
@@ -100,6 +100,34 @@ typedef enum {
     UHD_RX_METADATA_ERROR_CODE_BAD_PACKET   = 0xF
 } uhd_rx_metadata_error_code_t;
 
+//! RX metadata as a plain struct, filled by uhd_rx_streamer_recv_fast()
+/*!
+ * See uhd::rx_metadata_t for details.
+ */
+typedef struct {
+    bool has_time_spec;
+    time_t time_spec_full_secs;
+    double time_spec_frac_secs;
+    bool more_fragments;
+    size_t fragment_offset;
+    bool start_of_burst;
+    bool end_of_burst;
+    bool out_of_sequence;
+    uhd_rx_metadata_error_code_t error_code;
+} uhd_rx_metadata_info_t;
+
+//! TX metadata as a plain struct, read by uhd_tx_streamer_send_fast()
+/*!
+ * See uhd::tx_metadata_t for details.
+ */
+typedef struct {
+    bool has_time_spec;
+    time_t time_spec_full_secs;
+    double time_spec_frac_secs;
+    bool start_of_burst;
+    bool end_of_burst;
+} uhd_tx_metadata_info_t;
+
 
 //! Create a new RX metadata handle
 UHD_API uhd_error uhd_rx_metadata_make(
@@ -20,6 +20,7 @@
 
 #include <uhd/config.hpp>
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <stdint.h>
 #include <string>
 
@@ -43,12 +44,17 @@ namespace uhd{
         {
             has_time_spec = false;
             time_spec = time_spec_t(0.0);
+            tick_time = tick_time_t();
             more_fragments = false;
             fragment_offset = 0;
             start_of_burst = false;
             end_of_burst = false;
             error_code = ERROR_CODE_NONE;
             out_of_sequence = false;
+            num_lost_samps = 0;
+            has_power = false;
+            peak_power = 0.0;
+            mean_power = 0.0;
         }
 
         //! Has time specification?
@@ -57,6 +63,15 @@ namespace uhd{
         //! Time of the first sample.
         time_spec_t time_spec;
 
+        /*!
+         * Time of the first sample in ticks of the device clock.
+         * Set with time_spec by streamers that get tick time stamps from
+         * the device (the tick rate is zero otherwise). It is exact, so
+         * it can be compared for equality, e.g. across channels; when the
+         * first sample falls in between ticks, it is the nearest tick.
+         */
+        tick_time_t tick_time;
+
         /*!
          * Fragmentation flag:
          * Similar to IPv4 fragmentation: http://en.wikipedia.org/wiki/IPv4#Fragmentation_and_reassembly
@@ -119,6 +134,28 @@ namespace uhd{
         //! Out of sequence.  The transport has either dropped a packet or received data out of order.
         bool out_of_sequence;
 
+        /*!
+         * The number of samples per channel lost just before this buffer.
+         * Set on the first buffer after an overflow or a sequence error,
+         * from the time stamps on both sides of the gap; zero otherwise,
+         * or when the streamer has no time stamps.
+         */
+        size_t num_lost_samps;
+
+        /*!
+         * Has the power of the samples?
+         * Set when the stream was made with the stream arg power_meta=1:
+         * the power is then measured while the samples are converted.
+         */
+        bool has_power;
+
+        /*!
+         * The peak and the mean of |sample|^2 over the samples (of all
+         * channels) returned by this recv() call, in the units of the
+         * cpu format: 1.0 is full scale for fc32.
+         */
+        double peak_power, mean_power;
+
         /*!
          * Convert a rx_metadata_t into a pretty print string.
          *
@@ -201,6 +238,23 @@ namespace uhd{
          */
         uint32_t user_payload[4];
 
+        /*!
+         * The number of events this message stands for.
+         * Streamers may merge repeated error events (e.g. an underflow on
+         * every packet after a stall) into one message, see
+         * tx_streamer::recv_async_msgs(). The message then has the time,
+         * payload and channel of the first event.
+         */
+        size_t num_events;
+
+        //! When the last of the events occurred, see num_events.
+        time_spec_t last_time_spec;
+
+        /*!
+         * The default constructor:
+         * Sets the fields to default values (one event, no time).
+         */
+        async_metadata_t(void);
     };
 
 } //namespace uhd
@@ -186,6 +186,26 @@ namespace uhd{
             uint32_t data,
             size_t num_bits
         );
+
+        /*!
+        * Perform several spi transactions with the same slave and config.
+        * Implementations may send the words back to back without waiting
+        * for each to complete. The default implementation calls
+        * transact_spi() for every word.
+        * \param which_slave the slave device number
+        * \param config spi config args
+        * \param data the words to write, in order
+        * \param num_bits how many bits in each word
+        * \param readback true to readback a value after each word
+        * \return the spi data of each word if readback set, else empty
+        */
+        virtual std::vector<uint32_t> transact_spi_batch(
+            int which_slave,
+            const spi_config_t &config,
+            const std::vector<uint32_t> &data,
+            size_t num_bits,
+            bool readback
+        );
     };
 
     /*!
@@ -0,0 +1,125 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TYPES_TICK_TIME_HPP
+#define INCLUDED_UHD_TYPES_TICK_TIME_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/operators.hpp>
+
+namespace uhd{
+
+    /*!
+     * A tick_time_t holds a time as an integer count of ticks of a clock,
+     * together with the rate of that clock.
+     *
+     * This is how devices time stamp their packets: keeping the count as is
+     * makes equality exact (e.g. to align the packets of several channels)
+     * and arithmetic in ticks cheap, with no floating point math until the
+     * time is converted to a time_spec_t.
+     *
+     * Two tick times compare by their counts when their rates are the same,
+     * and by their time_spec_t values otherwise.
+     */
+    class tick_time_t : boost::totally_ordered<tick_time_t>{
+    public:
+
+        //! Create a tick time of zero ticks at a rate of zero (unset)
+        tick_time_t(void): ticks(0), tick_rate(0.0){}
+
+        /*!
+         * Create a tick time from a tick count.
+         * \param ticks an integer count of ticks
+         * \param tick_rate the number of ticks per second
+         */
+        tick_time_t(long long ticks, double tick_rate):
+            ticks(ticks), tick_rate(tick_rate){}
+
+        /*!
+         * Convert a time_spec_t to the nearest tick.
+         * \param time the time to convert
+         * \param tick_rate the number of ticks per second
+         */
+        static tick_time_t from_time_spec(const time_spec_t &time, double tick_rate){
+            return tick_time_t(time.to_ticks(tick_rate), tick_rate);
+        }
+
+        /*!
+         * Convert to a time_spec_t.
+         * Converting the result back with the same rate gives the same ticks.
+         */
+        time_spec_t to_time_spec(void) const{
+            return time_spec_t::from_ticks(ticks, tick_rate);
+        }
+
+        /*!
+         * Convert to the nearest tick of another clock.
+         * \param rate the number of ticks per second of the other clock
+         */
+        tick_time_t at_rate(double rate) const{
+            if (rate == tick_rate) return *this;
+            return from_time_spec(to_time_spec(), rate);
+        }
+
+        //! Add a number of ticks
+        tick_time_t &operator+=(long long num_ticks){
+            ticks += num_ticks;
+            return *this;
+        }
+
+        //! Subtract a number of ticks
+        tick_time_t &operator-=(long long num_ticks){
+            ticks -= num_ticks;
+            return *this;
+        }
+
+        //! The number of ticks since another time, in ticks of this clock
+        long long ticks_since(const tick_time_t &earlier) const{
+            return ticks - earlier.at_rate(tick_rate).ticks;
+        }
+
+        //! An integer count of ticks
+        long long ticks;
+
+        //! The number of ticks per second
+        double tick_rate;
+    };
+
+    UHD_INLINE tick_time_t operator+(tick_time_t time, long long num_ticks){
+        return time += num_ticks;
+    }
+
+    UHD_INLINE tick_time_t operator-(tick_time_t time, long long num_ticks){
+        return time -= num_ticks;
+    }
+
+    //! Implement equality_comparable interface
+    UHD_INLINE bool operator==(const tick_time_t &lhs, const tick_time_t &rhs){
+        if (lhs.tick_rate == rhs.tick_rate) return lhs.ticks == rhs.ticks;
+        return lhs.to_time_spec() == rhs.to_time_spec();
+    }
+
+    //! Implement less_than_comparable interface
+    UHD_INLINE bool operator<(const tick_time_t &lhs, const tick_time_t &rhs){
+        if (lhs.tick_rate == rhs.tick_rate) return lhs.ticks < rhs.ticks;
+        return lhs.to_time_spec() < rhs.to_time_spec();
+    }
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_TYPES_TICK_TIME_HPP */
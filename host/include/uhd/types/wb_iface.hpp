@@ -22,6 +22,7 @@
 #include <uhd/types/time_spec.hpp>
 #include <stdint.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
 
 namespace uhd
 {
@@ -75,6 +76,23 @@ public:
      * \return the 16bit data
      */
     virtual uint16_t peek16(const wb_addr_type addr);
+
+    /*!
+     * Begin a batch of register writes.
+     * Until the matching commit(), writes may be sent without waiting
+     * for each to complete, and a timed interface gives them all the
+     * command time set when the batch began. Batches nest: only the
+     * outermost commit() ends the batch.
+     * The default implementation does nothing (every write completes
+     * on its own).
+     */
+    virtual void begin_batch(void);
+
+    /*!
+     * End a batch of register writes and wait for all of them.
+     * Throws the first error of the batched writes, if there was one.
+     */
+    virtual void commit(void);
 };
 
 class UHD_API timed_wb_iface : public wb_iface
@@ -93,6 +111,42 @@ public:
      * \param t the command time
      */
     virtual void set_time(const time_spec_t& t) = 0;
+
+    /*!
+     * Handler for executed timed commands: called with the command time
+     * of each timed command whose ack came in. It runs within calls on
+     * the interface (e.g. get_cmd_queue_space()), and must not call it.
+     */
+    typedef boost::function<void(const time_spec_t &)> cmd_done_handler_t;
+
+    /*!
+     * Get the number of commands that can be sent right now without
+     * waiting for an ack. The ack of a timed command only comes in once
+     * the command has executed, so a queue full of timed commands makes
+     * the next write wait until the first of them is due.
+     * Takes the acks that came in meanwhile.
+     * The default implementation throws uhd::not_implemented_error.
+     * \return the free space of the command queue
+     */
+    virtual size_t get_cmd_queue_space(void);
+
+    /*!
+     * Write a register (32 bits) unless that would wait for an ack.
+     * The write is not acknowledged: an error in its ack is thrown by a
+     * later call, like with posted writes.
+     * The default implementation throws uhd::not_implemented_error.
+     * \param addr the address
+     * \param data the 32bit data
+     * \return false if the command queue is full, and nothing was written
+     */
+    virtual bool try_poke32(const wb_addr_type addr, const uint32_t data);
+
+    /*!
+     * Set the handler for executed timed commands.
+     * The default implementation throws uhd::not_implemented_error.
+     * \param handler the handler, or an empty function for none
+     */
+    virtual void set_cmd_done_handler(const cmd_done_handler_t &handler);
 };
 
 } //namespace uhd
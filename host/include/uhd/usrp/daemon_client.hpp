@@ -0,0 +1,107 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_DAEMON_CLIENT_HPP
+#define INCLUDED_UHD_USRP_DAEMON_CLIENT_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/types/tune_request.hpp>
+#include <uhd/types/tune_result.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * A client of uhd_daemon, which keeps a device open between applications.
+ *
+ * The daemon owns the device and publishes its receive stream in shared
+ * memory (see uhd::rx_shm_publisher). Connecting to it takes no device
+ * initialization, and any number of clients can receive the same
+ * channels at once.
+ *
+ * The calls have the signatures of their uhd::usrp::multi_usrp
+ * counterparts, and the daemon makes them on its multi_usrp, one client
+ * call at a time. Changes are seen by every client. The sample rate is
+ * fixed when the daemon starts, so there is no set_rx_rate().
+ */
+class UHD_API daemon_client : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<daemon_client> sptr;
+
+    /*!
+     * Connect to a daemon.
+     * \param args the address of the daemon, keys addr (default
+     *        127.0.0.1) and port (default 50200)
+     */
+    static sptr make(const device_addr_t &args = device_addr_t());
+
+    virtual ~daemon_client(void);
+
+    //! Get the pretty print string of the daemon's device
+    virtual std::string get_pp_string(void) = 0;
+
+    //! Get the number of RX channels of the daemon's device
+    virtual size_t get_rx_num_channels(void) = 0;
+
+    /*!
+     * Get a streamer of the shared receive stream.
+     * The channels of the stream args are indices into the channels
+     * the daemon publishes, and the cpu format must be the daemon's.
+     */
+    virtual rx_streamer::sptr get_rx_stream(const stream_args_t &args) = 0;
+
+    virtual double get_rx_rate(size_t chan = 0) = 0;
+
+    virtual tune_result_t set_rx_freq(const tune_request_t &tune_request, size_t chan = 0) = 0;
+    virtual double get_rx_freq(size_t chan = 0) = 0;
+
+    virtual void set_rx_gain(double gain, const std::string &name, size_t chan = 0) = 0;
+    virtual double get_rx_gain(const std::string &name, size_t chan = 0) = 0;
+    virtual gain_range_t get_rx_gain_range(const std::string &name, size_t chan = 0) = 0;
+
+    void set_rx_gain(double gain, size_t chan = 0){
+        return this->set_rx_gain(gain, "", chan);
+    }
+    double get_rx_gain(size_t chan = 0){
+        return this->get_rx_gain("", chan);
+    }
+    gain_range_t get_rx_gain_range(size_t chan = 0){
+        return this->get_rx_gain_range("", chan);
+    }
+
+    virtual void set_rx_antenna(const std::string &ant, size_t chan = 0) = 0;
+    virtual std::string get_rx_antenna(size_t chan = 0) = 0;
+
+    virtual void set_rx_bandwidth(double bandwidth, size_t chan = 0) = 0;
+    virtual double get_rx_bandwidth(size_t chan = 0) = 0;
+
+    virtual time_spec_t get_time_now(size_t mboard = 0) = 0;
+
+    virtual sensor_value_t get_mboard_sensor(const std::string &name, size_t mboard = 0) = 0;
+    virtual sensor_value_t get_rx_sensor(const std::string &name, size_t chan = 0) = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_DAEMON_CLIENT_HPP */
@@ -216,6 +216,23 @@ public:
         size_t num_bits
     ) = 0;
 
+    /*!
+     * Write several words to SPI bus peripheral, in order.
+     * The default implementation calls write_spi() for every word
+     * within a batch (see begin_batch()).
+     *
+     * \param unit which unit, rx or tx
+     * \param config configuration settings
+     * \param data the words to write, each MSB first
+     * \param num_bits the number of bits in each word
+     */
+    virtual void write_spi_batch(
+        unit_t unit,
+        const spi_config_t &config,
+        const std::vector<uint32_t> &data,
+        size_t num_bits
+    );
+
     /*!
      * Read and write data to SPI bus peripheral.
      *
@@ -303,6 +320,20 @@ public:
      * \param time time to sleep in nanoseconds
      */
     virtual void sleep(const boost::chrono::nanoseconds& time);
+
+    /*!
+     * Begin a batch of register writes (e.g. a series of SPI writes).
+     * Until commit_batch(), the writes are sent without waiting for
+     * each one, with the command time the batch began with.
+     * Batches nest. The default implementation does nothing.
+     */
+    virtual void begin_batch(void);
+
+    /*!
+     * End a batch of register writes and wait for all of them.
+     * Throws the first error of the batched writes, if there was one.
+     */
+    virtual void commit_batch(void);
 };
 
 }} //namespace
@@ -20,6 +20,7 @@
 
 #include <uhd/types/serial.hpp>
 #include <uhd/types/sensors.hpp>
+#include <uhd/types/dict.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 #include <boost/function.hpp>
@@ -48,6 +49,12 @@ public:
    */
   virtual uhd::sensor_value_t get_sensor(std::string key) = 0;
 
+  /*!
+   * Retrieve all sensors that can be served from recently received data,
+   * without waiting for the GPS. Sensors without fresh data are left out.
+   */
+  virtual uhd::dict<std::string, uhd::sensor_value_t> get_all_sensors(void) = 0;
+
   /*!
    * Tell you if there's a supported GPS connected or not
    * \return true if a supported GPS is connected
@@ -211,6 +211,17 @@ public:
      */
     virtual time_spec_t get_time_now(size_t mboard = 0) = 0;
 
+    /*!
+     * Get an estimate of the current time in the usrp time registers.
+     * The estimate is extrapolated on the host from earlier reads of the
+     * device time, which makes it much cheaper than get_time_now().
+     * Its error bound is published in the property tree under
+     * time/estimate_error. Devices without a time model return get_time_now().
+     * \param mboard which motherboard to query
+     * \return a timespec representing the estimated usrp time
+     */
+    virtual time_spec_t get_time_estimate(size_t mboard = 0) = 0;
+
     /*!
      * Get the time when the last pps pulse occurred.
      * \param mboard which motherboard to query
@@ -400,6 +411,15 @@ public:
      */
     virtual std::vector<std::string> get_mboard_sensor_names(size_t mboard = 0) = 0;
 
+    /*!
+     * Get the values of all motherboard sensors at once.
+     * Devices that can read several sensors in one transaction do so,
+     * any remaining sensors are read one by one.
+     * \param mboard the motherboard index 0 to M-1
+     * \return the sensor values, keyed by the names from get_mboard_sensor_names()
+     */
+    virtual dict<std::string, sensor_value_t> get_all_sensors(size_t mboard = 0) = 0;
+
     /*!
      * Perform write on the user configuration register bus. These only exist if
      * the user has implemented custom setting registers in the device FPGA.
@@ -474,6 +494,28 @@ public:
         const tune_request_t &tune_request, size_t chan = 0
     ) = 0;
 
+    /*!
+     * Set the RX center frequency of many channels at once.
+     * The channels of each motherboard are tuned on a thread of their
+     * own, and their register writes are sent without waiting for each
+     * to complete, so tuning channels on several devices takes about as
+     * long as tuning those of one device.
+     * With a time spec, the tunes are timed commands for that time on
+     * every motherboard involved, and the command time of those
+     * motherboards is cleared afterwards. With a zero time spec, the
+     * current command time applies, as with set_rx_freq().
+     * \param tune_requests one request per channel, or one for all
+     * \param chans the channel indexes 0 to N-1
+     * \param time_spec the time of the tunes, or zero for untimed tunes
+     * \return the tune results, in the order of the channels
+     * \throws uhd::value_error if the numbers of requests and channels differ
+     */
+    virtual std::vector<tune_result_t> set_rx_freq_multi(
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const time_spec_t &time_spec = time_spec_t(0.0)
+    ) = 0;
+
     /*!
      * Get the RX center frequency.
      * \param chan the channel index 0 to N-1
@@ -481,6 +523,33 @@ public:
      */
     virtual double get_rx_freq(size_t chan = 0) = 0;
 
+    /*!
+     * Plan a table of RX center frequencies to hop through with rx_freq_hop().
+     * The frequencies are planned in order: consecutive frequencies within
+     * half the RF bandwidth of one LO frequency share it, so hopping
+     * between them only sets the DSP (CORDIC) frequency, which takes one
+     * register write instead of an RF retune. Planning reads the frontend
+     * and DSP ranges once, and replaces a previous table of the channel.
+     * \param freqs the center frequencies in Hz
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void set_rx_freq_hop_table(
+        const std::vector<double> &freqs, size_t chan = 0
+    ) = 0;
+
+    /*!
+     * Tune to a frequency of the table from set_rx_freq_hop_table().
+     * The RF frontend is only tuned when the hop needs another LO than the
+     * last one, or when it was tuned by other means in between.
+     * Hops use the command time like set_rx_freq().
+     * \param index the index of the frequency in the table
+     * \param chan the channel index 0 to N-1
+     * \return a tune result object
+     * \throws uhd::index_error if the index is not in the table
+     * \throws uhd::runtime_error if the channel has no table
+     */
+    virtual tune_result_t rx_freq_hop(size_t index, size_t chan = 0) = 0;
+
     /*!
      * Get the RX center frequency range.
      * This range includes the overall tunable range of the RX chain,
@@ -844,6 +913,28 @@ public:
         const tune_request_t &tune_request, size_t chan = 0
     ) = 0;
 
+    /*!
+     * Set the TX center frequency of many channels at once.
+     * The channels of each motherboard are tuned on a thread of their
+     * own, and their register writes are sent without waiting for each
+     * to complete, so tuning channels on several devices takes about as
+     * long as tuning those of one device.
+     * With a time spec, the tunes are timed commands for that time on
+     * every motherboard involved, and the command time of those
+     * motherboards is cleared afterwards. With a zero time spec, the
+     * current command time applies, as with set_tx_freq().
+     * \param tune_requests one request per channel, or one for all
+     * \param chans the channel indexes 0 to N-1
+     * \param time_spec the time of the tunes, or zero for untimed tunes
+     * \return the tune results, in the order of the channels
+     * \throws uhd::value_error if the numbers of requests and channels differ
+     */
+    virtual std::vector<tune_result_t> set_tx_freq_multi(
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const time_spec_t &time_spec = time_spec_t(0.0)
+    ) = 0;
+
     /*!
      * Get the TX center frequency.
      * \param chan the channel index 0 to N-1
@@ -851,6 +942,33 @@ public:
      */
     virtual double get_tx_freq(size_t chan = 0) = 0;
 
+    /*!
+     * Plan a table of TX center frequencies to hop through with tx_freq_hop().
+     * The frequencies are planned in order: consecutive frequencies within
+     * half the RF bandwidth of one LO frequency share it, so hopping
+     * between them only sets the DSP (CORDIC) frequency, which takes one
+     * register write instead of an RF retune. Planning reads the frontend
+     * and DSP ranges once, and replaces a previous table of the channel.
+     * \param freqs the center frequencies in Hz
+     * \param chan the channel index 0 to N-1
+     */
+    virtual void set_tx_freq_hop_table(
+        const std::vector<double> &freqs, size_t chan = 0
+    ) = 0;
+
+    /*!
+     * Tune to a frequency of the table from set_tx_freq_hop_table().
+     * The RF frontend is only tuned when the hop needs another LO than the
+     * last one, or when it was tuned by other means in between.
+     * Hops use the command time like set_tx_freq().
+     * \param index the index of the frequency in the table
+     * \param chan the channel index 0 to N-1
+     * \return a tune result object
+     * \throws uhd::index_error if the index is not in the table
+     * \throws uhd::runtime_error if the channel has no table
+     */
+    virtual tune_result_t tx_freq_hop(size_t index, size_t chan = 0) = 0;
+
     /*!
      * Get the TX center frequency range.
      * This range includes the overall tunable range of the TX chain,
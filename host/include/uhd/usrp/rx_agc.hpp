@@ -0,0 +1,86 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_RX_AGC_HPP
+#define INCLUDED_UHD_USRP_RX_AGC_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/types/metadata.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * A host AGC on the RX gain of one multi_usrp channel.
+ *
+ * Feed it the metadata of the recv() calls of a streamer made with the
+ * stream arg power_meta=1, so that the power comes with the samples
+ * (see uhd::rx_metadata_t::has_power) instead of from a sensor read.
+ * When the mean power is off the target by more than the hysteresis,
+ * or the peak reaches full scale, it changes the gain by the difference,
+ * clipped to the gain range.
+ *
+ * The new gain is a timed command, for the device time after the last
+ * sample of the recv() call plus the latency: channels updated from the
+ * same metadata change at the same sample. Until samples from after that
+ * time are received, update() leaves the gain alone. The AGC uses the
+ * command time of the motherboards, which must not be set from another
+ * thread at the same time.
+ */
+class UHD_API rx_agc : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_agc> sptr;
+
+    /*!
+     * Make a new AGC, starting from the current gain.
+     * \param usrp the device
+     * \param chan the RX channel of the device
+     * \param target_dbfs the mean power to aim for, in dB full scale
+     * \param hysteresis_db how far off the target the power may be
+     *        before the gain is changed, in dB
+     * \param latency how long after the last received sample the gain
+     *        changes, in seconds: at least the time it takes the helper
+     *        to get the command to the device
+     */
+    static sptr make(
+        multi_usrp::sptr usrp,
+        const size_t chan = 0,
+        const double target_dbfs = -20.0,
+        const double hysteresis_db = 3.0,
+        const double latency = 0.005
+    );
+
+    virtual ~rx_agc(void);
+
+    /*!
+     * Update from the metadata of a recv() call.
+     * Metadata without power or with an error code is ignored.
+     * \param metadata the metadata filled in by recv()
+     * \param nsamps the number of samples recv() returned
+     * \return true when the gain was changed
+     */
+    virtual bool update(const rx_metadata_t &metadata, const size_t nsamps) = 0;
+
+    //! Get the gain set last, in dB
+    virtual double get_gain(void) = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_RX_AGC_HPP */
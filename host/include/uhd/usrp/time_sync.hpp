@@ -0,0 +1,78 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_USRP_TIME_SYNC_HPP
+#define INCLUDED_UHD_USRP_TIME_SYNC_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace uhd{ namespace usrp{
+
+/*!
+ * Bring the motherboards of a multi_usrp to a common time.
+ *
+ * The steps of each motherboard (switching to the GPSDO, waiting for
+ * the locks, reading the GPS time) run on a thread per motherboard, so
+ * an array of devices takes about as long as a single one. Verifying
+ * reads the time at the last PPS of all motherboards at once, shortly
+ * after a PPS edge.
+ */
+class UHD_API time_sync : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<time_sync> sptr;
+
+    /*!
+     * Make a new time sync for the motherboards of a device.
+     * \param usrp the device
+     */
+    static sptr make(multi_usrp::sptr usrp);
+
+    virtual ~time_sync(void);
+
+    /*!
+     * Set every motherboard to GPS time.
+     * Each motherboard takes its clock and time from its GPSDO, waits
+     * until its reference (if it has a ref_locked sensor) and its GPS
+     * are locked, and sets the time of the next PPS edge from the GPS
+     * time. Then the times are checked with verify().
+     * \param timeout how long to wait for the locks, in seconds
+     * \return true if the times of all motherboards are aligned
+     * \throws uhd::runtime_error if a motherboard has no GPSDO, or did
+     *         not lock in time
+     */
+    virtual bool sync_to_gps(const double timeout = 30.0) = 0;
+
+    /*!
+     * Check that the motherboards agree on the time: wait for a PPS edge,
+     * then compare the times all motherboards latched at it.
+     * \return true if the times of all motherboards are aligned
+     * \throws uhd::runtime_error if there was no PPS edge
+     */
+    virtual bool verify(void) = 0;
+
+    //! Get the times at the last PPS edge read by verify(), per motherboard
+    virtual std::vector<time_spec_t> get_pps_times(void) = 0;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_UHD_USRP_TIME_SYNC_HPP */
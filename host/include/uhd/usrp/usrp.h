@@ -173,6 +173,31 @@ UHD_API uhd_error uhd_rx_streamer_recv(
     size_t *items_recvd
 );
 
+//! Receive samples, with less overhead per call
+/*!
+ * Does the same as uhd_rx_streamer_recv(), for callers which receive at
+ * high rates: the metadata is a plain struct owned by the caller, and the
+ * error strings are only written when the call fails, so the last error
+ * of the streamer is not reset by a successful call.
+ *
+ * \param h RX streamer handle, filled by uhd_usrp_get_rx_stream()
+ * \param buffs pointer to one buffer per channel
+ * \param samps_per_buff max number of samples per buffer
+ * \param md RX metadata in which to receive results
+ * \param timeout timeout in seconds to wait for a packet
+ * \param one_packet send a single packet
+ * \param items_recvd pointer to output variable for number of samples received
+ */
+UHD_API uhd_error uhd_rx_streamer_recv_fast(
+    uhd_rx_streamer_handle h,
+    void** buffs,
+    size_t samps_per_buff,
+    uhd_rx_metadata_info_t *md,
+    double timeout,
+    bool one_packet,
+    size_t *items_recvd
+);
+
 //! Issue the given stream command
 /*!
  * See uhd::rx_streamer::issue_stream_cmd() for more details.
@@ -251,6 +276,29 @@ UHD_API uhd_error uhd_tx_streamer_send(
     size_t *items_sent
 );
 
+//! Send samples, with less overhead per call
+/*!
+ * Does the same as uhd_tx_streamer_send(), for callers which send at
+ * high rates: the metadata is a plain struct owned by the caller, and the
+ * error strings are only written when the call fails, so the last error
+ * of the streamer is not reset by a successful call.
+ *
+ * \param h TX streamer handle, filled by uhd_usrp_get_tx_stream()
+ * \param buffs pointer to one buffer per channel
+ * \param samps_per_buff max number of samples per buffer
+ * \param md TX metadata
+ * \param timeout timeout in seconds to wait for a packet
+ * \param items_sent pointer to output variable for number of samples send
+ */
+UHD_API uhd_error uhd_tx_streamer_send_fast(
+    uhd_tx_streamer_handle h,
+    const void **buffs,
+    size_t samps_per_buff,
+    const uhd_tx_metadata_info_t *md,
+    double timeout,
+    size_t *items_sent
+);
+
 //! Receive an asynchronous message from this streamer
 /*!
  * See uhd::tx_streamer::recv_async_msg() for more details.
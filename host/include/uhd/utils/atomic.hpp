@@ -24,6 +24,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/interprocess/detail/atomic.hpp>
+#include <algorithm>
 
 #include <boost/version.hpp>
 #define BOOST_IPC_DETAIL boost::interprocess::ipcdetail
@@ -139,6 +140,9 @@ namespace uhd{
 
     /*!
      * Spin-wait on a condition with a timeout.
+     * The caller spins (yielding) for a short while first. If the
+     * condition takes longer, it sleeps between checks, for up to
+     * 100 us at a time, so a long wait does not burn a core.
      * \param cond an atomic variable to compare
      * \param value compare to atomic for true/false
      * \param timeout the timeout in seconds
@@ -149,12 +153,20 @@ namespace uhd{
         uint32_t value,
         const double timeout
     ){
+        static const size_t spins_before_sleep = 1000;
+        static const long max_sleep_us = 100;
         if (cond.read() == value) return true;
         const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
-        while (cond.read() != value){
+        long sleep_us = 1;
+        for (size_t spins = 0; cond.read() != value; spins++){
             if (time_spec_t::get_system_time() > exit_time) return false;
-            boost::this_thread::interruption_point();
-            boost::this_thread::yield();
+            if (spins < spins_before_sleep){
+                boost::this_thread::interruption_point();
+                boost::this_thread::yield();
+            } else {
+                boost::this_thread::sleep(boost::posix_time::microseconds(sleep_us));
+                sleep_us = std::min(2*sleep_us, max_sleep_us);
+            }
         }
         return true;
     }
@@ -162,27 +174,68 @@ namespace uhd{
     /*!
      * Claimer class to provide synchronization for multi-thread access.
      * Claiming enables buffer classes to be used with a buffer queue.
+     *
+     * A claim is a compare-and-swap, so only one of several claiming
+     * threads wins. claim_with_wait() spins for a few checks, then blocks
+     * until release() wakes it up or the timeout expires. Releasing only
+     * takes a lock when a thread is blocked.
      */
     class simple_claimer{
     public:
-        simple_claimer(void){
+        /*!
+         * Create a released claimer.
+         * \param spin_count how often claim_with_wait() checks before it blocks
+         */
+        simple_claimer(const size_t spin_count = 100):
+            _spin_count(spin_count)
+        {
             this->release();
         }
 
         UHD_INLINE void release(void){
-            _locked.write(0);
+            //the cas is a full barrier, so a waiter either sees the
+            //release or is counted in _num_waiters before it is read
+            _locked.cas(0, 1);
+            if (_num_waiters.read() != 0){
+                boost::mutex::scoped_lock lock(_mutex);
+                _cond.notify_one();
+            }
+        }
+
+        //! Claim without waiting, return false if already claimed
+        UHD_INLINE bool try_claim(void){
+            return _locked.cas(1, 0) == 0;
         }
 
         UHD_INLINE bool claim_with_wait(const double timeout){
-            if (spin_wait_with_timeout(_locked, 0, timeout)){
-                _locked.write(1);
-                return true;
+            if (this->try_claim()) return true;
+            for (size_t i = 0; i < _spin_count; i++){
+                if (_locked.read() == 0 and this->try_claim()) return true;
             }
-            return false;
+
+            //block until released or timed out
+            const boost::system_time exit_time = boost::get_system_time() +
+                boost::posix_time::microseconds(long(timeout*1e6));
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_waiters.inc();
+            bool claimed = this->try_claim();
+            while (not claimed){
+                if (not _cond.timed_wait(lock, exit_time)){
+                    claimed = this->try_claim();
+                    break;
+                }
+                claimed = this->try_claim();
+            }
+            _num_waiters.dec();
+            return claimed;
         }
 
     private:
+        const size_t _spin_count;
         atomic_uint32_t _locked;
+        atomic_uint32_t _num_waiters;
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
     };
 
 } //namespace uhd
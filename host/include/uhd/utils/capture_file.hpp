@@ -0,0 +1,207 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_CAPTURE_FILE_HPP
+#define INCLUDED_UHD_UTILS_CAPTURE_FILE_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/sample_file.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+#include <vector>
+
+/*! \file capture_file.hpp
+ * A container for received samples with their times and an index.
+ *
+ * A capture file starts with a 4 KiB header: the sample format, the
+ * number of channels, the sample rate and the settings of the device.
+ * Blocks of samples follow, each with a header holding its time, the
+ * number of samples before it and the flags of its rx_metadata_t;
+ * overflows and other errors are blocks without samples. A gap flag
+ * marks blocks whose time does not follow on from the block before.
+ * On close, an index with the time and file offset of about every
+ * index_interval bytes is written after the last block.
+ *
+ * The reader maps the file into memory and finds the block of a time
+ * with a binary search of the index, so seeking in files of terabytes
+ * is immediate. A file whose recording was cut short has no index;
+ * the reader then builds it with one pass over the block headers.
+ * All numbers are in host byte order.
+ */
+
+namespace uhd{
+
+//! The format of the samples of a capture file
+struct UHD_API capture_file_info_t{
+    capture_file_info_t(void);
+    //! The sample type, e.g. "fc32" or "sc16"
+    std::string cpu_format;
+    //! The number of channels, each block holds samples of all of them
+    size_t num_chans;
+    //! Samples per second of each channel
+    double samp_rate;
+    //! The settings of the device (frequency, gain...), at most 4000 bytes as a string
+    device_addr_t settings;
+};
+
+/*!
+ * Writes received samples to a capture file at disk speed.
+ *
+ * The blocks go through a uhd::sample_file_writer, so the disk is
+ * kept off the receive loop, and samples can be received straight into
+ * the writer's buffers:
+ * \code
+ * const std::vector<void *> &buffs = writer->get_write_space(spb);
+ * const size_t n = rx_stream->recv(buffs, spb, md);
+ * writer->commit(n, md);
+ * \endcode
+ */
+class UHD_API capture_file_writer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<capture_file_writer> sptr;
+
+    /*!
+     * Create (or truncate) a capture file and write its header.
+     * \param path the file to write
+     * \param info the format of the samples and the device settings
+     * \param index_interval bytes of blocks between index entries
+     * \param buffer_size the size of one buffer of the writer, see sample_file_writer
+     * \param direct true to bypass the page cache where supported
+     * \throws uhd::value_error when the settings do not fit in the header
+     * \throws uhd::io_error when the file cannot be opened
+     */
+    static sptr make(
+        const std::string &path,
+        const capture_file_info_t &info,
+        const size_t index_interval = 1024*1024,
+        const size_t buffer_size = 4*1024*1024,
+        const bool direct = true
+    );
+
+    //! Closes the file, see close()
+    virtual ~capture_file_writer(void);
+
+    /*!
+     * Get space for a block of up to nsamps samples per channel.
+     * \param nsamps samples per channel, the block must fit in a buffer
+     * \return one pointer per channel, to be filled and then committed
+     */
+    virtual const std::vector<void *> &get_write_space(const size_t nsamps) = 0;
+
+    /*!
+     * Commit the samples written to the space from get_write_space().
+     * Without samples, the block records an error of the metadata
+     * (e.g. an overflow); timeouts are not recorded.
+     * \param nsamps samples per channel, at most the nsamps asked for
+     * \param md the metadata recv() returned with the samples
+     */
+    virtual void commit(const size_t nsamps, const rx_metadata_t &md) = 0;
+
+    //! Copy a block into the file (calls get_write_space() and commit())
+    virtual void write(const std::vector<const void *> &buffs, const size_t nsamps, const rx_metadata_t &md) = 0;
+
+    /*!
+     * Write the index and close the file.
+     * Does nothing when the file is closed already.
+     * \throws uhd::io_error when a write failed
+     */
+    virtual void close(void) = 0;
+
+    //! Get the disk statistics of the writer so far
+    virtual sample_file_writer::stats_t get_stats(void) = 0;
+};
+
+/*!
+ * Reads a capture file through a memory map.
+ *
+ * The blocks are read one after the other with next(), from the start
+ * or from where seek() placed the reader. The samples of a block are
+ * in the mapped file, so reading them costs no copy.
+ */
+class UHD_API capture_file_reader : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<capture_file_reader> sptr;
+
+    //! Block flags
+    enum block_flag_t{
+        FLAG_HAS_TIME = 1 << 0,
+        FLAG_SOB      = 1 << 1,
+        FLAG_EOB      = 1 << 2,
+        //! The block records an error (e.g. an overflow) and has no samples
+        FLAG_ERROR    = 1 << 3,
+        //! The time of the block does not follow on from the block before
+        FLAG_GAP      = 1 << 4
+    };
+
+    //! One block of the file
+    struct UHD_API block_t{
+        block_t(void);
+        //! The samples of each channel, in the mapped file
+        std::vector<const void *> buffs;
+        //! Samples per channel
+        size_t nsamps;
+        //! block_flag_t bits
+        int flags;
+        //! The time of the first sample, with FLAG_HAS_TIME
+        time_spec_t time_spec;
+        //! The samples per channel of the blocks before this one
+        unsigned long long sample_index;
+        //! The error of the metadata, with FLAG_ERROR
+        rx_metadata_t::error_code_t error_code;
+    };
+
+    /*!
+     * Map a capture file and load (or build) its index.
+     * \throws uhd::io_error when the file cannot be mapped or is not a capture file
+     */
+    static sptr make(const std::string &path);
+
+    virtual ~capture_file_reader(void);
+
+    //! Get the format of the samples and the device settings
+    virtual const capture_file_info_t &get_info(void) const = 0;
+
+    //! True when the index was written at close, false when it was rebuilt
+    virtual bool has_index(void) const = 0;
+
+    /*!
+     * Get the next block and move past it.
+     * \return false at the end of the file
+     */
+    virtual bool next(block_t &block) = 0;
+
+    /*!
+     * Place the reader on the block that holds the sample at a time.
+     * Before the first block with a time, it goes to the start of the
+     * file; in a gap, to the first block after the last samples before
+     * the gap, so that an overflow recorded there is read first.
+     * \param time the time of the sample
+     * \return false when the time is after the end of the file
+     */
+    virtual bool seek(const time_spec_t &time) = 0;
+
+    //! Place the reader at the start of the file
+    virtual void rewind(void) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_UTILS_CAPTURE_FILE_HPP */
@@ -53,9 +53,10 @@ namespace uhd{
         /*!
          * Copy ctor: Assign source to this type
          */
-        dirty_tracked(const dirty_tracked& source) {
-            *this = source;
-        }
+        dirty_tracked(const dirty_tracked& source) :
+            _data(source._data),
+            _dirty(source._dirty)
+        {}
 
         /*!
          * Get underlying data
@@ -0,0 +1,108 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_FASTPATH_HPP
+#define INCLUDED_UHD_UTILS_FASTPATH_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <cstddef>
+
+/*! \file fastpath.hpp
+ * Events of the streaming fast path: overflows, underflows and the like.
+ *
+ * The streaming threads post an event with post_event(), which writes it
+ * into a lock-free ring and counts it, without allocating or locking.
+ * A background thread takes the events out of the ring and hands them to
+ * the subscribers, and prints the traditional one letter codes ("O", "U",
+ * "D", "S", "L") as uhd::msg::fastpath messages, unless turned off with
+ * set_console_output().
+ */
+
+namespace uhd{ namespace fastpath{
+
+    //! Fast path event types, the values are the letters printed for them
+    enum event_type_t{
+        //! RX: the device dropped samples, the host did not keep up
+        EVENT_OVERFLOW       = 'O',
+        //! RX: packets were lost between the device and the host
+        EVENT_DROPPED_PACKET = 'D',
+        //! TX: the device ran out of samples to send
+        EVENT_UNDERFLOW      = 'U',
+        //! TX: packets were lost between the host and the device
+        EVENT_SEQ_ERROR      = 'S',
+        //! TX: a packet arrived after its time stamp
+        EVENT_LATE_PACKET    = 'L'
+    };
+
+    //! A fast path event, as the subscribers get it
+    struct event_t{
+        event_type_t type;
+        //! The channel of the streamer (RX) or device (TX) that posted it
+        size_t channel;
+        //! Whether the device time of the event is known
+        bool has_time_spec;
+        //! The device time of the event, if known
+        time_spec_t time_spec;
+        //! Counts all events posted in the process, from 0
+        boost::uint64_t seq;
+    };
+
+    /*!
+     * Post an event, for the streaming code. This is safe to call from
+     * any thread. If the ring is full (the subscribers do not keep up),
+     * the event is still counted, but not delivered.
+     */
+    UHD_API void post_event(
+        const event_type_t type,
+        const size_t channel,
+        const bool has_time_spec = false,
+        const time_spec_t &time_spec = time_spec_t(0.0)
+    );
+
+    //! Get how many events of a type were posted in the process so far
+    UHD_API boost::uint64_t get_event_count(const event_type_t type);
+
+    //! Get how many events were not delivered because the ring was full
+    UHD_API boost::uint64_t get_dropped_event_count(void);
+
+    //! Typedef for a subscriber, called in the background thread
+    typedef boost::function<void(const event_t &)> subscriber_t;
+
+    /*!
+     * Subscribe to the events. The subscriber gets every event posted from
+     * now on (apart from dropped ones), in order, from the background
+     * thread, and so should return quickly.
+     * \param subscriber the function to call for each event
+     * \return an id for unsubscribe()
+     */
+    UHD_API size_t subscribe(const subscriber_t &subscriber);
+
+    //! Remove a subscriber, given the id from subscribe()
+    UHD_API void unsubscribe(const size_t id);
+
+    /*!
+     * Print the one letter codes of the events, on by default.
+     * They go through the message handler as uhd::msg::fastpath messages.
+     */
+    UHD_API void set_console_output(const bool enb);
+
+}} //namespace uhd::fastpath
+
+#endif /* INCLUDED_UHD_UTILS_FASTPATH_HPP */
@@ -0,0 +1,156 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_FLIGHT_RECORDER_HPP
+#define INCLUDED_UHD_UTILS_FLIGHT_RECORDER_HPP
+
+#include <uhd/config.hpp>
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <string>
+
+/*! \file flight_recorder.hpp
+ * An always-on record of the last packets of every streaming thread.
+ *
+ * The streaming and control code records each data packet, flow control
+ * update, control transaction and error into a ring of the calling
+ * thread, without locks or allocations; the ring keeps the newest 8192
+ * records. dump() writes the rings of all threads to a file, which
+ * `flight_log` in tools/uhd_dump reads, so intermittent drops can be
+ * analyzed after the fact without a packet capture.
+ *
+ * With the environment variable UHD_FLIGHT_RECORDER_FILE (or after
+ * set_dump_file()), a background thread writes that file shortly after
+ * a receive streamer failed to align its channels, after a cascade of
+ * errors, and on the signal given to dump_on_signal(). The environment
+ * variable UHD_FLIGHT_RECORDER=0 turns the recorder off.
+ *
+ * The dump file starts with a file_header_t, then for each thread a
+ * thread_header_t and its records (record_t), oldest first, all in host
+ * byte order.
+ */
+
+namespace uhd{ namespace flight_recorder{
+
+    //! Record types, stored as one letter
+    enum record_type_t{
+        //! A data packet the host received; value is its length in bytes
+        RECORD_RX_PACKET = 'R',
+        //! A data packet the host sent; value is its length in bytes
+        RECORD_TX_PACKET = 'T',
+        //! A flow control update; seq is the packet count it acknowledges
+        RECORD_FLOW_CTRL = 'F',
+        //! A control transaction sent; value is the register address
+        RECORD_CTRL      = 'C',
+        //! An error of a streamer; value is the error code of its metadata
+        RECORD_ERROR     = 'E'
+    };
+
+    //! Record flags
+    enum record_flag_t{
+        FLAG_HAS_TSF = 1 << 0,
+        FLAG_SOB     = 1 << 1,
+        FLAG_EOB     = 1 << 2
+    };
+
+    //! One record, in the rings and in the dump file
+    struct record_t{
+        //! When it was recorded, in time stamp counter ticks
+        boost::uint64_t ticks;
+        //! The packet time in device ticks, with FLAG_HAS_TSF
+        boost::uint64_t tsf;
+        boost::uint32_t sid;
+        //! The packet sequence number
+        boost::uint32_t seq;
+        //! Depends on the type, see record_type_t
+        boost::uint32_t value;
+        //! A record_type_t
+        boost::uint8_t type;
+        //! record_flag_t bits
+        boost::uint8_t flags;
+        //! The channel of the streamer
+        boost::uint16_t chan;
+    };
+
+    //! The start of a dump file
+    struct file_header_t{
+        char magic[8]; //!< "UHDFLREC"
+        boost::uint32_t version; //!< 1
+        boost::uint32_t record_size; //!< sizeof(record_t)
+        boost::uint64_t ticks_per_sec; //!< the rate of record_t::ticks
+        boost::uint32_t num_threads;
+        boost::uint32_t reserved;
+    };
+
+    //! The start of the records of one thread in a dump file
+    struct thread_header_t{
+        boost::uint32_t thread; //!< threads are numbered in the order they recorded first
+        boost::uint32_t num_records;
+        //! Records of the thread that were overwritten before the dump
+        boost::uint64_t num_lost;
+    };
+
+    //! Is the recorder on?
+    UHD_API bool enabled(void);
+
+    //! Turn the recorder on or off for all threads
+    UHD_API void set_enabled(const bool enb);
+
+    /*!
+     * Record into the ring of the calling thread, for the streaming code.
+     * Error records count towards a cascade: the third error within a
+     * second asks for a dump (see request_dump()).
+     */
+    UHD_API void record(
+        const record_type_t type,
+        const size_t chan,
+        const boost::uint32_t sid,
+        const boost::uint32_t seq,
+        const boost::uint64_t tsf,
+        const boost::uint32_t value,
+        const boost::uint8_t flags = 0
+    );
+
+    /*!
+     * Write the rings of all threads to a file.
+     * \param path the file to write
+     * \return the number of records written
+     * \throws uhd::io_error if the file cannot be written
+     */
+    UHD_API size_t dump(const std::string &path);
+
+    /*!
+     * Ask the background thread to write the dump file shortly, so the
+     * dump also holds what followed. Requests until then are merged.
+     * Does nothing without a dump file. It does not block or allocate,
+     * so the streaming threads call it on errors.
+     */
+    UHD_API void request_dump(void);
+
+    //! Set the file that request_dump() and dump_on_signal() write
+    UHD_API void set_dump_file(const std::string &path);
+
+    /*!
+     * Write the dump file when the process receives the signal,
+     * e.g. SIGUSR1. Without a dump file, it goes to
+     * uhd_flight_recorder.dat in the working directory.
+     */
+    UHD_API void dump_on_signal(const int signum);
+
+}} //namespace uhd::flight_recorder
+
+#endif /* INCLUDED_UHD_UTILS_FLIGHT_RECORDER_HPP */
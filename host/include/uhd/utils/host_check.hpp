@@ -0,0 +1,91 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_HOST_CHECK_HPP
+#define INCLUDED_UHD_UTILS_HOST_CHECK_HPP
+
+#include <uhd/config.hpp>
+#include <string>
+#include <vector>
+
+/*!
+ * Host check: the settings of the host that a network stream at full
+ * rate depends on, for the interface that reaches a device.
+ *
+ * check() reads the MTU, link speed and RX ring size of the interface,
+ * the CPUs its interrupts may run on, the socket buffer limits and the
+ * CPU frequency governors, and says what falls short and how to fix it.
+ * The X300 and N230 run it when they start and warn about the deficits;
+ * the uhd_host_check utility prints the full report. Only Linux hosts
+ * are checked, elsewhere the report is empty.
+ */
+namespace uhd{ namespace host_check{
+
+    //! One setting of the host
+    struct UHD_API item_t{
+        //! What was checked, e.g. "net.core.rmem_max"
+        std::string name;
+        //! The setting as found
+        std::string value;
+        //! The setting a stream needs
+        std::string wanted;
+        bool ok;
+        //! How to fix it, empty when ok
+        std::string fix;
+    };
+
+    //! The settings of the host for one device address
+    struct UHD_API report_t{
+        report_t(void);
+
+        //! The host interface that reaches the device, empty if not found
+        std::string iface;
+
+        //! Bytes per second of packet payload the link carries, 0 if unknown
+        double link_rate;
+
+        std::vector<item_t> items;
+
+        //! The number of items which are not ok
+        size_t num_deficits(void) const;
+
+        //! One line per item, the deficits with their fixes
+        std::string to_pp_string(void) const;
+    };
+
+    /*!
+     * Check the host settings for streaming to and from a device.
+     * \param addr the IPv4 address of the device
+     * \param frame_size the payload bytes of the UDP packets of a stream
+     * \param recv_buff_size the socket receive buffer a stream asks for,
+     *        0 to skip the check
+     * \param send_buff_size the socket send buffer a stream asks for,
+     *        0 to skip the check
+     * \param rate bytes per second a stream needs, 0 to skip the check
+     * \return the report, which is empty on other hosts than Linux
+     */
+    UHD_API report_t check(
+        const std::string &addr,
+        const size_t frame_size,
+        const size_t recv_buff_size,
+        const size_t send_buff_size,
+        const double rate = 0.0
+    );
+
+}} //namespace uhd::host_check
+
+#endif /* INCLUDED_UHD_UTILS_HOST_CHECK_HPP */
@@ -31,7 +31,17 @@
  *
  * The logger enables UHD library code to easily log events into a file.
  * Log entries are time-stamped and stored with file, line, and function.
- * Each call to the UHD_LOG macros is synchronous and thread-safe.
+ * Each call to the UHD_LOG macros is thread-safe.
+ *
+ * By default, the records are queued on a lock-free ring per thread, and
+ * a background thread writes them out in batches, so logging does not
+ * block the streaming threads. When a ring overflows, its records are
+ * dropped and the number dropped is logged. The environment variables:
+ *   - UHD_LOG_ASYNC=0 writes each record in the call instead.
+ *   - UHD_LOG_SINKS is a comma separated list of where the records go:
+ *     file (the default), console (stderr), syslog (where available).
+ *   - UHD_LOG_FILE_LOCK=0 skips the interprocess lock of the log file,
+ *     which is taken once per batch so processes do not mix records.
  *
  * The log file can be found in the path <temp-directory>/uhd.log,
  * where <temp-directory> is the user or system's temporary directory.
@@ -50,13 +60,25 @@
  *   - Example pre-processor define: -DUHD_LOG_LEVEL=regularly
  *   - Example environment variable: export UHD_LOG_LEVEL=3
  *   - Example environment variable: export UHD_LOG_LEVEL=regularly
+ *
+ * Messages less rare than UHD_LOG_MIN_LEVEL (the integer value of a verbosity,
+ * set with the CMake variable of the same name) are compiled out. For the
+ * others, the streamed arguments are only evaluated when the message is
+ * logged, so a disabled log message costs one comparison.
  */
 
+#ifndef UHD_LOG_MIN_LEVEL
+#define UHD_LOG_MIN_LEVEL 1
+#endif
+
 /*!
  * A UHD logger macro with configurable verbosity.
  * Usage: UHD_LOGV(very_rarely) << "the log message" << std::endl;
  */
 #define UHD_LOGV(verbosity) \
+    (uhd::_log::verbosity < UHD_LOG_MIN_LEVEL or \
+        not uhd::_log::log::is_enabled(uhd::_log::verbosity))? (void)0 : \
+    uhd::_log::log_voidify() & \
     uhd::_log::log(uhd::_log::verbosity, __FILE__, __LINE__, BOOST_CURRENT_FUNCTION)
 
 /*!
@@ -91,6 +113,9 @@ namespace uhd{ namespace _log{
 
         ~log(void);
 
+        //! Would a message of this verbosity be logged at the current level?
+        static bool is_enabled(const verbosity_t verbosity);
+
         // Macro for overloading insertion operators to avoid costly
         // conversion of types if not logging.
         #define INSERTION_OVERLOAD(x)   log& operator<< (x)             \
@@ -113,6 +138,15 @@ namespace uhd{ namespace _log{
         bool _log_it;
     };
 
+    /*!
+     * Turns the log statement in the UHD_LOGV macro into a void expression,
+     * for the other branch of the conditional. The & binds after all <<.
+     */
+    class log_voidify{
+    public:
+        UHD_INLINE void operator&(log &){}
+    };
+
 }} //namespace uhd::_log
 
 #endif /* INCLUDED_UHD_UTILS_LOG_HPP */
@@ -23,15 +23,25 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/utility.hpp>
+#include <string>
 #include <boost/optional/optional.hpp>
 #include <stdint.h>
-#include <vector>
+#include <cstring>
 
 namespace uhd{
 	class UHD_API msg_task : boost::noncopyable{
         public:
             typedef boost::shared_ptr<msg_task> sptr;
-            typedef std::vector<uint8_t> msg_payload_t;
+
+            //! Stranded messages longer than this are truncated (control responses are 32 bytes)
+            static const size_t MAX_MSG_PAYLOAD_SIZE = 64;
+
+            //! A message payload in a fixed-size slot, so storing it never allocates
+            struct msg_payload_t {
+                msg_payload_t(void): size(0) {}
+                size_t size;
+                uint8_t data[MAX_MSG_PAYLOAD_SIZE];
+            };
             typedef std::pair<uint32_t, msg_payload_t > msg_type_t;
             typedef boost::function<boost::optional<msg_type_t>(void)> task_fcn_type;
 
@@ -42,13 +52,13 @@ namespace uhd{
              */
             virtual msg_payload_t get_msg_from_dump_queue(uint32_t sid) = 0;
 
-            UHD_INLINE static std::vector<uint8_t> buff_to_vector(uint8_t* p, size_t n) {
+            UHD_INLINE static msg_payload_t buff_to_payload(const uint8_t* p, size_t n) {
+                msg_payload_t payload;
                 if(p and n > 0){
-                    std::vector<uint8_t> v(n);
-                    memcpy(&v.front(), p, n);
-                    return v;
+                    payload.size = (n < MAX_MSG_PAYLOAD_SIZE)? n : size_t(MAX_MSG_PAYLOAD_SIZE);
+                    memcpy(payload.data, p, payload.size);
                 }
-                return std::vector<uint8_t>();
+                return payload;
             }
 
             virtual ~msg_task(void) = 0;
@@ -70,6 +80,19 @@ namespace uhd{
              * \return a new task object
              */
             static sptr make(const task_fcn_type &task_fcn);
+
+            /*!
+             * Create a new task object for an internal thread of a role.
+             * The thread registers itself under the role and name (see
+             * uhd::get_internal_threads()) and runs with the configuration
+             * of the role (see uhd::set_thread_config()).
+             *
+             * \param task_fcn the task callback function
+             * \param role the role, e.g. "async"
+             * \param name what the thread does, e.g. "tx async messages"
+             * \return a new task object
+             */
+            static sptr make(const task_fcn_type &task_fcn, const std::string &role, const std::string &name);
     };
 } //namespace uhd
 
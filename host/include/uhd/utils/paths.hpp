@@ -88,6 +88,17 @@ namespace uhd {
      * \return the message suggesting the use of the named utility.
      */
     UHD_API std::string print_utility_error(const std::string &name, const std::string &args = "");
+
+    /*!
+     * Replace the contents of a file, such as one of the caches under the
+     * app path. The contents go to a temporary file that is then moved into
+     * place, so concurrent readers in other processes never see a partial
+     * file. Missing parent directories are created.
+     * \param path the file to replace
+     * \param contents the new contents of the file
+     * \throw exception uhd::io_error if the file could not be written
+     */
+    UHD_API void write_file_atomically(const std::string &path, const std::string &contents);
 } //namespace uhd
 
 #endif /* INCLUDED_UHD_UTILS_PATHS_HPP */
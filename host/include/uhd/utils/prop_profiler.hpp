@@ -0,0 +1,78 @@
+//
+// Copyright 2016 Ettus Research
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_PROP_PROFILER_HPP
+#define INCLUDED_UHD_UTILS_PROP_PROFILER_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+/*!
+ * Property tree profiler: Counts the accesses to each property tree path
+ * and measures the time spent in its subscribers, coercer and publisher.
+ *
+ * The instrumentation is only compiled into UHD when it was configured
+ * with -DUHD_PROPERTY_TREE_PROFILING=ON. Otherwise, nothing is recorded
+ * and properties run without any overhead.
+ */
+namespace uhd{ namespace prop_profiler{
+
+    //! True if UHD was built with the property tree instrumentation
+    UHD_API bool enabled(void);
+
+    //! Forget everything that was recorded so far
+    UHD_API void reset(void);
+
+    /*!
+     * Get the statistics of every path as a text table,
+     * sorted by the total time spent in callbacks.
+     */
+    UHD_API std::string to_table(void);
+
+    /*!
+     * Get every recorded callback as a JSON string in the
+     * Chrome trace event format (open it with chrome://tracing).
+     */
+    UHD_API std::string to_chrome_trace(void);
+
+    //! Called by the property tree for every lookup of a path
+    UHD_API void record_access(const std::string &path);
+
+    //! Called by a property for every set() and get()
+    UHD_API void record_use(const std::string &path, bool is_set);
+
+    /*!
+     * Times a callback of a property for as long as it lives.
+     * The name says which callback it is ("desired", "coercer",
+     * "coerced" or "publisher").
+     */
+    class UHD_API scoped_probe : boost::noncopyable{
+    public:
+        scoped_probe(const std::string &path, const char *name);
+        ~scoped_probe(void);
+
+    private:
+        const std::string &_path;
+        const char *_name;
+        const time_spec_t _start;
+    };
+
+}} //namespace uhd::prop_profiler
+
+#endif /* INCLUDED_UHD_UTILS_PROP_PROFILER_HPP */
@@ -0,0 +1,175 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_SAMPLE_FILE_HPP
+#define INCLUDED_UHD_UTILS_SAMPLE_FILE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+namespace uhd{
+
+/*!
+ * Writes a stream of samples to a file at disk speed.
+ *
+ * The samples are collected in a few large, page aligned buffers. A
+ * writer thread owned by the object writes each full buffer to the file
+ * while the next one is filled, so the receive loop never waits on the
+ * disk unless the disk falls behind. Where the platform supports it,
+ * the file is opened with O_DIRECT, which bypasses the page cache.
+ *
+ * With get_write_space() and commit(), samples can be received straight
+ * into the buffers (no copy on the way to the disk):
+ * \code
+ * void *buff = writer->get_write_space(nsamps*bytes_per_samp);
+ * const size_t n = rx_stream->recv(buff, nsamps, md);
+ * writer->commit(n*bytes_per_samp);
+ * \endcode
+ *
+ * Write errors are reported by the next call after they happened.
+ */
+class UHD_API sample_file_writer : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<sample_file_writer> sptr;
+
+    //! How often the disk fell behind and the caller had to wait
+    struct UHD_API stats_t{
+        stats_t(void);
+        //! Bytes handed to the writer
+        unsigned long long bytes;
+        //! Times the caller had to wait for a free buffer
+        size_t num_waits;
+        //! Total time spent waiting for a free buffer, in seconds
+        double wait_time;
+        //! Most buffers that were waiting to be written at once
+        size_t max_queued;
+    };
+
+    /*!
+     * Create (or truncate) a file and start the writer thread.
+     * \param path the file to write
+     * \param buffer_size the size of one buffer in bytes, a multiple of 4096
+     * \param num_buffers the number of buffers, at least 2
+     * \param direct true to bypass the page cache where supported
+     * \throws uhd::io_error when the file cannot be opened
+     */
+    static sptr make(
+        const std::string &path,
+        const size_t buffer_size = 4*1024*1024,
+        const size_t num_buffers = 4,
+        const bool direct = true
+    );
+
+    //! Closes the file, see close()
+    virtual ~sample_file_writer(void);
+
+    /*!
+     * Get space for up to len bytes, to be filled and then committed.
+     * Blocks while all buffers are waiting to be written.
+     * \param len the number of bytes, at most the buffer size
+     * \return a pointer to the space for the bytes
+     */
+    virtual void *get_write_space(const size_t len) = 0;
+
+    /*!
+     * Commit bytes written to the space from get_write_space().
+     * \param len the number of bytes, at most the len asked for
+     */
+    virtual void commit(const size_t len) = 0;
+
+    //! Copy bytes into the file (calls get_write_space() and commit())
+    virtual void write(const void *data, const size_t len) = 0;
+
+    /*!
+     * Write all buffered bytes and close the file.
+     * Does nothing when the file is closed already.
+     * \throws uhd::io_error when a write failed
+     */
+    virtual void close(void) = 0;
+
+    //! Get the statistics so far
+    virtual stats_t get_stats(void) = 0;
+};
+
+/*!
+ * Reads a stream of samples from a file at disk speed.
+ *
+ * The mirror image of uhd::sample_file_writer: a reader thread owned by
+ * the object reads ahead into a few large, page aligned buffers, so the
+ * send loop finds the next samples in memory. With peek() and consume(),
+ * samples can be sent straight from the buffers.
+ */
+class UHD_API sample_file_reader : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<sample_file_reader> sptr;
+
+    //! How often the disk fell behind and the caller had to wait
+    struct UHD_API stats_t{
+        stats_t(void);
+        //! Bytes handed to the caller
+        unsigned long long bytes;
+        //! Times the caller had to wait for the next buffer
+        size_t num_waits;
+        //! Total time spent waiting for the next buffer, in seconds
+        double wait_time;
+    };
+
+    /*!
+     * Open a file and start the reader thread.
+     * \param path the file to read
+     * \param buffer_size the size of one buffer in bytes, a multiple of 4096
+     * \param num_buffers the number of buffers, at least 2
+     * \param direct true to bypass the page cache where supported
+     * \throws uhd::io_error when the file cannot be opened
+     */
+    static sptr make(
+        const std::string &path,
+        const size_t buffer_size = 4*1024*1024,
+        const size_t num_buffers = 4,
+        const bool direct = true
+    );
+
+    virtual ~sample_file_reader(void);
+
+    /*!
+     * Get the next bytes of the file without copying them.
+     * Blocks until the reader thread has read them.
+     * \param len the number of bytes wanted, set to the number available
+     *        in one piece (less than asked for near the end of a buffer)
+     * \return a pointer to the bytes, valid until consume()
+     * \throws uhd::io_error when a read failed
+     */
+    virtual const void *peek(size_t &len) = 0;
+
+    //! Mark bytes returned by peek() as used
+    virtual void consume(const size_t len) = 0;
+
+    /*!
+     * Copy the next bytes of the file.
+     * \return the number of bytes read, less than len only at the end
+     */
+    virtual size_t read(void *data, const size_t len) = 0;
+
+    //! Get the statistics so far
+    virtual stats_t get_stats(void) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_UTILS_SAMPLE_FILE_HPP */
@@ -23,6 +23,7 @@
 #include <uhd/types/wb_iface.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/dirty_tracked.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/unordered_map.hpp>
@@ -463,7 +464,7 @@ public:
  */
 class UHD_API soft_regmap_t : public soft_regmap_accessor_t, public boost::noncopyable {
 public:
-    soft_regmap_t(const std::string& name) : _name(name) {}
+    soft_regmap_t(const std::string& name) : _name(name), _iface(NULL) {}
     virtual ~soft_regmap_t() {};
 
     /*!
@@ -479,6 +480,7 @@ public:
      */
     void initialize(wb_iface& iface, bool sync = false) {
         boost::lock_guard<boost::mutex> lock(_mutex);
+        _iface = &iface;
         BOOST_FOREACH(soft_register_base* reg, _reglist) {
             reg->initialize(iface, sync);
         }
@@ -488,12 +490,28 @@ public:
      * Flush all registers to hardware.
      * The order of writing is the same as the order in
      * which registers were added to the map.
+     * The writes are sent as one batch of the bus (see
+     * wb_iface::begin_batch()), so a bus that supports batching
+     * does not wait for each write to complete.
      */
     void flush() {
         boost::lock_guard<boost::mutex> lock(_mutex);
-        BOOST_FOREACH(soft_register_base* reg, _reglist) {
-            reg->flush();
+        if (_iface == NULL) {
+            BOOST_FOREACH(soft_register_base* reg, _reglist) {
+                reg->flush();
+            }
+            return;
+        }
+        _iface->begin_batch();
+        try {
+            BOOST_FOREACH(soft_register_base* reg, _reglist) {
+                reg->flush();
+            }
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
         }
+        _iface->commit();
     }
 
     /*!
@@ -560,6 +578,7 @@ private:
     const std::string   _name;
     regmap_t            _regmap;    //For lookups
     reglist_t           _reglist;   //To maintain order
+    wb_iface*           _iface;     //The bus of all registers, once initialized
     boost::mutex        _mutex;
 };
 
@@ -0,0 +1,91 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_STARTUP_PROFILE_HPP
+#define INCLUDED_UHD_UTILS_STARTUP_PROFILE_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/utility.hpp>
+#include <string>
+#include <vector>
+
+/*!
+ * Startup profile: the phases of device::make() (discovery, image loads,
+ * motherboard and daughterboard setup, clock locking) with their times.
+ *
+ * device::make() starts a new profile and stores the finished one in
+ * the property tree of the new device at "/startup_profile", as a
+ * uhd::startup_profile::phases_t. The phases are always recorded, they
+ * are few and each costs a lock and a time stamp.
+ */
+namespace uhd{ namespace startup_profile{
+
+    //! One recorded phase
+    struct UHD_API phase_t{
+        std::string name;
+        //! Start since the profile started, in seconds
+        double start_secs;
+        double duration_secs;
+        //! Phases of different threads ran at the same time
+        size_t thread;
+    };
+
+    typedef std::vector<phase_t> phases_t;
+
+    //! Forget the recorded phases and start the profile clock
+    UHD_API void reset(void);
+
+    //! Get the finished phases, in the order they started
+    UHD_API phases_t get_phases(void);
+
+    /*!
+     * Start a phase in the calling thread. This ends the phase that
+     * this thread started before with begin(), so a setup function can
+     * mark each of its steps with a call.
+     */
+    UHD_API void begin(const std::string &name);
+
+    //! End the phase that the calling thread started with begin()
+    UHD_API void end(void);
+
+    /*!
+     * Get the static blocks (UHD_STATIC_BLOCK, UHD_DEFERRED_BLOCK) that
+     * were called so far, in the order they were called. The start times
+     * are since the first one. reset() does not clear them.
+     */
+    UHD_API phases_t get_static_blocks(void);
+
+    //! Record a static block, called by the static block fixtures
+    UHD_API void add_static_block(
+        const std::string &name, const time_spec_t &start, const time_spec_t &duration
+    );
+
+    //! Records a phase from construction to destruction
+    class UHD_API scoped_phase : boost::noncopyable{
+    public:
+        scoped_phase(const std::string &name);
+        ~scoped_phase(void);
+
+    private:
+        const std::string _name;
+        const double _start_secs;
+    };
+
+}} //namespace uhd::startup_profile
+
+#endif /* INCLUDED_UHD_UTILS_STARTUP_PROFILE_HPP */
@@ -19,6 +19,7 @@
 #define INCLUDED_UHD_UTILS_STATIC_HPP
 
 #include <uhd/config.hpp>
+#include <string>
 
 /*!
  * Defines a function that implements the "construct on first use" idiom
@@ -43,4 +44,34 @@ struct UHD_API _uhd_static_fixture{
     _uhd_static_fixture(void (*)(void), const char *);
 };
 
+/*!
+ * Defines a code block that is called on first use of its group,
+ * instead of before main(). Code that needs what the blocks of a group
+ * register calls uhd::run_deferred_blocks() with the group name first.
+ * Blocks added to a group that already ran (e.g. by a module loaded
+ * later) are called right away.
+ * \param _g the name of the group
+ * \param _x the unique name of the fixture (unique per source)
+ */
+#define UHD_DEFERRED_BLOCK(_g, _x) \
+    void _x(void); \
+    static _uhd_deferred_fixture _x##_fixture(_g, &_x, #_x); \
+    void _x(void)
+
+//! Helper for deferred block, constructor adds function to its group
+struct UHD_API _uhd_deferred_fixture{
+    _uhd_deferred_fixture(const char *, void (*)(void), const char *);
+};
+
+namespace uhd{
+
+    /*!
+     * Call the deferred blocks of a group, unless they were called before.
+     * This is thread safe, and the blocks may call it for their own group.
+     * \param group the name given to UHD_DEFERRED_BLOCK
+     */
+    UHD_API void run_deferred_blocks(const std::string &group);
+
+} //namespace uhd
+
 #endif /* INCLUDED_UHD_UTILS_STATIC_HPP */
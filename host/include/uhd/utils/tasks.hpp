@@ -22,6 +22,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/utility.hpp>
+#include <string>
 
 namespace uhd{
 
@@ -45,6 +46,41 @@ namespace uhd{
          */
         static sptr make(const task_fcn_type &task_fcn);
 
+        /*!
+         * Create a new task object for an internal thread of a role.
+         * The thread registers itself under the role and name (see
+         * uhd::get_internal_threads()) and runs with the configuration
+         * of the role (see uhd::set_thread_config()).
+         *
+         * \param task_fcn the task callback function
+         * \param role the role, e.g. "async"
+         * \param name what the thread does, e.g. "tx async messages"
+         * \return a new task object
+         */
+        static sptr make(const task_fcn_type &task_fcn, const std::string &role, const std::string &name);
+
+        typedef boost::function<bool(void)> poll_fcn_type;
+
+        /*!
+         * Create a task that shares a thread with the other pooled tasks
+         * of its role, instead of running in a thread of its own.
+         * The pool has one worker thread per role, or as many as the
+         * environment variable UHD_TASK_POOL_THREADS says.
+         *
+         * The poll function is called again and again, in turn with the
+         * other tasks of the worker. It must not block: it returns true
+         * when it did some work, and false when there was nothing to do.
+         * When none of its tasks did work, the worker sleeps a little
+         * before the next round (up to a few milliseconds).
+         * The deconstructor waits for a call in progress to return.
+         *
+         * \param poll_fcn the task poll function
+         * \param role the role of the worker threads, e.g. "async"
+         * \param name what the task does, for error messages
+         * \return a new task object
+         */
+        static sptr make_pooled(const poll_fcn_type &poll_fcn, const std::string &role, const std::string &name);
+
     };
 } //namespace uhd
 
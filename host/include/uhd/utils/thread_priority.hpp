@@ -19,6 +19,10 @@
 #define INCLUDED_UHD_UTILS_THREAD_PRIORITY_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+#include <vector>
 
 namespace uhd{
 
@@ -53,6 +57,132 @@ namespace uhd{
         bool realtime = true
     );
 
+    /*!
+     * Restrict the current thread to a set of CPUs.
+     *
+     * Pinning a streamer thread to the CPU that handles the interrupts
+     * and socket processing of its transport (see the recv_cpu transport
+     * hint) keeps its packets in the local cache.
+     *
+     * \param cpus the indexes of the CPUs the thread may run on
+     * \throw exception on set affinity failure
+     */
+    UHD_API void set_thread_affinity(const std::vector<size_t> &cpus);
+
+    /*!
+     * Set the scheduling priority on the current thread and pin it to a CPU.
+     * Same as set_thread_priority_safe, but also calls set_thread_affinity.
+     * Does not throw on failure.
+     * \param cpu the CPU to pin the thread to
+     * \return true when both the priority and the affinity could be set
+     */
+    UHD_API bool set_thread_priority_safe(
+        float priority,
+        bool realtime,
+        size_t cpu
+    );
+
+    /*!
+     * Where and how the internal threads of one role run.
+     *
+     * UHD starts threads of its own (async message handlers, flow control,
+     * transport event loops, ...). Each is registered under a role:
+     *  - "rx": receive helpers (offload threads, conversion workers)
+     *  - "tx": send helpers (flow control, burst scheduling)
+     *  - "async": async message and response handlers
+     *  - "transport": transport event loops and demultiplexers
+     *  - "other": everything else (logging, claimer loops, ...)
+     */
+    struct UHD_API thread_config_t{
+        //! The CPUs the threads may run on, empty to leave the affinity alone
+        std::vector<size_t> cpus;
+
+        //! True to set the scheduling priority below
+        bool set_priority;
+
+        //! A value between -1 and 1, see set_thread_priority()
+        float priority;
+
+        //! True to use realtime scheduling
+        bool realtime;
+
+        //! With realtime: SCHED_FIFO instead of SCHED_RR (where supported)
+        bool fifo;
+
+        thread_config_t(void);
+    };
+
+    //! An internal thread, see get_internal_threads()
+    struct UHD_API thread_info_t{
+        std::string name;
+        std::string role;
+
+        //! The thread ID of the OS (the TID on Linux), 0 when unknown
+        size_t os_id;
+
+        //! The CPUs the thread may run on, empty when unknown
+        std::vector<size_t> cpus;
+    };
+
+    /*!
+     * Configure the internal threads of a role.
+     *
+     * The configuration applies to the threads of the role that are
+     * running now and to those started later. The role "" is the default
+     * for the roles without a configuration of their own.
+     *
+     * Without any configuration, internal threads are kept off the CPUs
+     * isolated from the scheduler (see get_isolated_cpus()), which are
+     * usually set aside for the application.
+     *
+     * \param role the role, see thread_config_t
+     * \param config the configuration
+     * \throw value_error for a priority out of range
+     */
+    UHD_API void set_thread_config(
+        const std::string &role,
+        const thread_config_t &config
+    );
+
+    /*!
+     * Configure the internal threads from device arguments:
+     * `<role>_thread_cpu` (e.g. "2" or "2:4-5"), `<role>_thread_priority`
+     * and `<role>_thread_policy` ("other", "rr" or "fifo"), where
+     * `<role>_` is left out for the default (e.g. `thread_cpu=3`).
+     * \param args the device arguments
+     */
+    UHD_API void set_thread_config(const device_addr_t &args);
+
+    /*!
+     * Get the configuration of a role, or the default for it.
+     * \param role the role, see thread_config_t
+     * \param config set to the configuration when there is one
+     * \return true when the role or the default is configured
+     */
+    UHD_API bool get_thread_config(const std::string &role, thread_config_t &config);
+
+    //! Get the internal threads that are running now
+    UHD_API std::vector<thread_info_t> get_internal_threads(void);
+
+    /*!
+     * Get the CPUs isolated from the scheduler (the isolcpus kernel
+     * parameter), empty when none are or the OS cannot tell.
+     */
+    UHD_API std::vector<size_t> get_isolated_cpus(void);
+
+    /*!
+     * Register the current thread as an internal thread of a role while
+     * this object lives, and apply the configuration of the role to it.
+     * Threads started through uhd::task register themselves.
+     */
+    class UHD_API scoped_internal_thread : boost::noncopyable{
+    public:
+        scoped_internal_thread(const std::string &name, const std::string &role);
+        ~scoped_internal_thread(void);
+    private:
+        size_t _key;
+    };
+
 } //namespace uhd
 
 #endif /* INCLUDED_UHD_UTILS_THREAD_PRIORITY_HPP */
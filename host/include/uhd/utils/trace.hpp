@@ -0,0 +1,82 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_UTILS_TRACE_HPP
+#define INCLUDED_UHD_UTILS_TRACE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+#include <string>
+
+/*!
+ * Hot path tracing: records how long the streaming and control code
+ * spends in scoped spans (e.g. in recv(), waiting for a transport buffer,
+ * converting, waiting for a command ack), per thread.
+ *
+ * The spans are only compiled into UHD when it was configured with
+ * -DUHD_TRACING=ON. Otherwise UHD_TRACE_SPAN expands to nothing.
+ * Each thread writes its spans with time stamp counter ticks into its
+ * own buffer, without locks; a buffer that is full drops further spans
+ * until reset(). Set the environment variable UHD_TRACE_FILE to write
+ * the trace to that file when the process exits.
+ */
+namespace uhd{ namespace trace{
+
+    //! True if UHD was built with the tracing instrumentation
+    UHD_API bool enabled(void);
+
+    //! Forget the spans recorded so far, in all threads
+    UHD_API void reset(void);
+
+    /*!
+     * Get the recorded spans as a JSON string in the Chrome trace event
+     * format, which chrome://tracing and the Perfetto UI open.
+     */
+    UHD_API std::string to_chrome_trace(void);
+
+    /*!
+     * Records the time from construction to destruction as a span.
+     * The name must be a string literal (it is stored as a pointer).
+     */
+    class UHD_API scoped_span : boost::noncopyable{
+    public:
+        scoped_span(const char *name);
+        ~scoped_span(void);
+
+    private:
+        const char *_name;
+        const boost::uint64_t _start;
+    };
+
+}} //namespace uhd::trace
+
+#define UHD_TRACE_CAT_(a, b) a ## b
+#define UHD_TRACE_CAT(a, b) UHD_TRACE_CAT_(a, b)
+
+/*!
+ * Trace the rest of the enclosing scope as a span with the given name.
+ * Usage: UHD_TRACE_SPAN("recv");
+ */
+#ifdef UHD_TRACING
+#define UHD_TRACE_SPAN(name) \
+    uhd::trace::scoped_span UHD_TRACE_CAT(_uhd_trace_span_, __LINE__)(name)
+#else
+#define UHD_TRACE_SPAN(name)
+#endif
+
+#endif /* INCLUDED_UHD_UTILS_TRACE_HPP */
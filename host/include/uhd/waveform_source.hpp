@@ -0,0 +1,142 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_WAVEFORM_SOURCE_HPP
+#define INCLUDED_UHD_WAVEFORM_SOURCE_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <stdint.h>
+#include <complex>
+
+namespace uhd{
+
+/*!
+ * Generates test signals for TX streamers: a sum of tones and chirps.
+ *
+ * Each tone or chirp has a phase accumulator with 64 bits, so that
+ * frequencies are exact to a tiny fraction of a Hz at any rate. Sine and
+ * cosine come from polynomials evaluated with SIMD instructions where the
+ * CPU has them (see uhd::convert), accurate to about 1e-6 of full scale.
+ *
+ * The phase of every tone and chirp carries over from one call to the
+ * next, so consecutive buffers form one continuous signal, also across
+ * frequency changes. The sum is not limited: keep the sum of the
+ * amplitudes at or below 1.0 to stay within full scale.
+ *
+ * A waveform source is not thread safe.
+ *
+ * \code{.cpp}
+ * uhd::waveform_source::sptr wave = uhd::waveform_source::make(usrp->get_tx_rate());
+ * wave->add_tone(100e3, 0.3);
+ * wave->add_chirp(-1e6, 1e6, 1e-3, 0.3);
+ * std::vector<std::complex<float> > buff(spb);
+ * while (true) {
+ *     wave->generate(&buff.front(), buff.size());
+ *     tx_stream->send(&buff.front(), buff.size(), md);
+ * }
+ * \endcode
+ */
+class UHD_API waveform_source : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<waveform_source> sptr;
+
+    /*!
+     * Make a new waveform source without tones or chirps.
+     * \param samp_rate the sample rate of the generated samples
+     */
+    static sptr make(const double samp_rate);
+
+    virtual ~waveform_source(void);
+
+    /*!
+     * Add a tone.
+     * \param freq the frequency in Hz, negative for a clockwise rotation
+     * \param ampl the amplitude, 1.0 is full scale
+     * \param phase the phase of the next sample in radians
+     * \return the index of the tone, for set_freq() and set_ampl()
+     */
+    virtual size_t add_tone(
+        const double freq, const double ampl, const double phase = 0.0
+    ) = 0;
+
+    /*!
+     * Add a linear chirp.
+     * The frequency sweeps from start_freq to stop_freq within each
+     * period, then jumps back to start_freq. The phase stays continuous.
+     * \param start_freq the frequency at the start of a period in Hz
+     * \param stop_freq the frequency at the end of a period in Hz
+     * \param period the length of a sweep in seconds
+     * \param ampl the amplitude, 1.0 is full scale
+     * \return the index of the chirp, for set_ampl()
+     * \throws uhd::value_error if the period is shorter than 2 samples
+     */
+    virtual size_t add_chirp(
+        const double start_freq,
+        const double stop_freq,
+        const double period,
+        const double ampl
+    ) = 0;
+
+    /*!
+     * Change the frequency of a tone, from the next sample on.
+     * \throws uhd::index_error if there is no such tone
+     */
+    virtual void set_freq(const size_t index, const double freq) = 0;
+
+    //! Change the amplitude of a tone or chirp
+    virtual void set_ampl(const size_t index, const double ampl) = 0;
+
+    //! Get the number of tones and chirps
+    virtual size_t get_num_components(void) const = 0;
+
+    //! Remove all tones and chirps
+    virtual void clear(void) = 0;
+
+    /*!
+     * Write the next samples as complex float (fc32).
+     * \param buff the buffer to overwrite
+     * \param nsamps the number of samples to write
+     */
+    virtual void generate(std::complex<float> *buff, const size_t nsamps) = 0;
+
+    /*!
+     * Write the next samples as complex int16 (sc16).
+     * 1.0 becomes 32767, larger values saturate.
+     * \param buff the buffer to overwrite
+     * \param nsamps the number of samples to write
+     */
+    virtual void generate(std::complex<int16_t> *buff, const size_t nsamps) = 0;
+
+    /*!
+     * Write the next samples into the buffers of
+     * tx_streamer::get_send_buffer(), in their item format.
+     * Every channel gets the same samples.
+     * \param buffs the buffers returned by get_send_buffer()
+     * \param nsamps the number of samples to write, at most buffs.nsamps
+     * \throws uhd::lookup_error if the item format has no converter
+     */
+    virtual void generate(
+        const tx_streamer::zero_copy_buffs_t &buffs, const size_t nsamps
+    ) = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_WAVEFORM_SOURCE_HPP */
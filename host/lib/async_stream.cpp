@@ -0,0 +1,266 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/async_stream.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <deque>
+
+using namespace uhd;
+
+/***********************************************************************
+ * Worker: runs queued requests in order on its own thread
+ **********************************************************************/
+template <typename request_type>
+class async_worker : boost::noncopyable
+{
+public:
+    typedef boost::function<void(request_type &)> run_type;
+
+    async_worker(const run_type &run, const boost::function<void(void)> &notify):
+        _run(run), _notify(notify)
+    {
+        _task = task::make(boost::bind(&async_worker::loop, this), "async", "async stream worker");
+    }
+
+    ~async_worker(void)
+    {
+        _task.reset(); //stop the worker before the queues go away
+    }
+
+    void push(const request_type &request)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _pending.push_back(request);
+        _cond.notify_one();
+    }
+
+    size_t poll(void)
+    {
+        std::deque<request_type> done;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            done.swap(_done);
+        }
+        //handlers may queue new requests, so run them unlocked
+        for (size_t i = 0; i < done.size(); i++) {
+            done[i].complete();
+        }
+        return done.size();
+    }
+
+private:
+    void loop(void)
+    {
+        request_type request;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_pending.empty()) {
+                _cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(100));
+                if (_pending.empty()) return;
+            }
+            request = _pending.front();
+            _pending.pop_front();
+        }
+
+        _run(request);
+
+        if (not _notify) {
+            request.complete();
+            return;
+        }
+        bool was_empty;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            was_empty = _done.empty();
+            _done.push_back(request);
+        }
+        if (was_empty) _notify();
+    }
+
+    const run_type _run;
+    const boost::function<void(void)> _notify;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::deque<request_type> _pending;
+    std::deque<request_type> _done;
+    task::sptr _task; //declared last, uses the members above
+};
+
+/***********************************************************************
+ * RX
+ **********************************************************************/
+struct async_rx_request_t
+{
+    async_rx_request_t(void): nsamps_per_buff(0), timeout(0.0), one_packet(false), nsamps(0) {}
+    std::vector<void *> buffs;
+    size_t nsamps_per_buff;
+    async_rx_streamer::handler_type handler;
+    double timeout;
+    bool one_packet;
+    size_t nsamps;
+    rx_metadata_t metadata;
+    void complete(void) { handler(nsamps, metadata); }
+};
+
+class async_rx_streamer_impl : public async_rx_streamer
+{
+public:
+    async_rx_streamer_impl(rx_streamer::sptr streamer, const notify_type &notify):
+        _streamer(streamer),
+        _worker(boost::bind(&async_rx_streamer_impl::run, this, _1), notify)
+    {
+        /* NOP */
+    }
+
+    void async_recv(
+        const std::vector<void *> &buffs,
+        const size_t nsamps_per_buff,
+        const handler_type &handler,
+        const double timeout,
+        const bool one_packet
+    ){
+        if (buffs.size() != _streamer->get_num_channels()) {
+            throw uhd::value_error("async_recv(): need one buffer per channel of the streamer");
+        }
+        async_rx_request_t request;
+        request.buffs = buffs;
+        request.nsamps_per_buff = nsamps_per_buff;
+        request.handler = handler;
+        request.timeout = timeout;
+        request.one_packet = one_packet;
+        _worker.push(request);
+    }
+
+    size_t poll(void)
+    {
+        return _worker.poll();
+    }
+
+private:
+    void run(async_rx_request_t &request)
+    {
+        try {
+            request.nsamps = _streamer->recv(
+                request.buffs, request.nsamps_per_buff, request.metadata,
+                request.timeout, request.one_packet
+            );
+        }
+        catch(const std::exception &ex) {
+            //there is no thread to throw to, report it as a bad packet
+            UHD_MSG(error) << "async_recv(): " << ex.what() << std::endl;
+            request.nsamps = 0;
+            request.metadata.reset();
+            request.metadata.error_code = rx_metadata_t::ERROR_CODE_BAD_PACKET;
+        }
+    }
+
+    rx_streamer::sptr _streamer;
+    async_worker<async_rx_request_t> _worker;
+};
+
+async_rx_streamer::~async_rx_streamer(void)
+{
+    /* NOP */
+}
+
+async_rx_streamer::sptr async_rx_streamer::make(rx_streamer::sptr streamer, const notify_type &notify)
+{
+    return sptr(new async_rx_streamer_impl(streamer, notify));
+}
+
+/***********************************************************************
+ * TX
+ **********************************************************************/
+struct async_tx_request_t
+{
+    async_tx_request_t(void): nsamps_per_buff(0), timeout(0.0), nsamps_sent(0) {}
+    std::vector<const void *> buffs;
+    size_t nsamps_per_buff;
+    tx_metadata_t metadata;
+    async_tx_streamer::handler_type handler;
+    double timeout;
+    size_t nsamps_sent;
+    void complete(void) { handler(nsamps_sent); }
+};
+
+class async_tx_streamer_impl : public async_tx_streamer
+{
+public:
+    async_tx_streamer_impl(tx_streamer::sptr streamer, const notify_type &notify):
+        _streamer(streamer),
+        _worker(boost::bind(&async_tx_streamer_impl::run, this, _1), notify)
+    {
+        /* NOP */
+    }
+
+    void async_send(
+        const std::vector<const void *> &buffs,
+        const size_t nsamps_per_buff,
+        const tx_metadata_t &metadata,
+        const handler_type &handler,
+        const double timeout
+    ){
+        if (buffs.size() != _streamer->get_num_channels()) {
+            throw uhd::value_error("async_send(): need one buffer per channel of the streamer");
+        }
+        async_tx_request_t request;
+        request.buffs = buffs;
+        request.nsamps_per_buff = nsamps_per_buff;
+        request.metadata = metadata;
+        request.handler = handler;
+        request.timeout = timeout;
+        _worker.push(request);
+    }
+
+    size_t poll(void)
+    {
+        return _worker.poll();
+    }
+
+private:
+    void run(async_tx_request_t &request)
+    {
+        try {
+            request.nsamps_sent = _streamer->send(
+                request.buffs, request.nsamps_per_buff, request.metadata, request.timeout
+            );
+        }
+        catch(const std::exception &ex) {
+            UHD_MSG(error) << "async_send(): " << ex.what() << std::endl;
+            request.nsamps_sent = 0;
+        }
+    }
+
+    tx_streamer::sptr _streamer;
+    async_worker<async_tx_request_t> _worker;
+};
+
+async_tx_streamer::~async_tx_streamer(void)
+{
+    /* NOP */
+}
+
+async_tx_streamer::sptr async_tx_streamer::make(tx_streamer::sptr streamer, const notify_type &notify)
+{
+    return sptr(new async_tx_streamer_impl(streamer, notify));
+}
@@ -0,0 +1,66 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 8 samples at a time: scale, round, pack with saturation and shuffle into item order
+template <xtox_t to_wire>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static void avx2_fc32_to_item32_sc16(
+    const fc32_t *input, item32_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256 tmplo = _mm256_loadu_ps(reinterpret_cast<const float *>(input+i+0));
+        __m256 tmphi = _mm256_loadu_ps(reinterpret_cast<const float *>(input+i+4));
+
+        /* convert and scale */
+        __m256i tmpilo = _mm256_cvtps_epi32(_mm256_mul_ps(tmplo, scalar));
+        __m256i tmpihi = _mm256_cvtps_epi32(_mm256_mul_ps(tmphi, scalar));
+
+        /* pack (per 128-bit lane), put the 64-bit quarters back in order, swap into item order */
+        __m256i tmpi = _mm256_packs_epi32(tmpilo, tmpihi);
+        tmpi = _mm256_permute4x64_epi64(tmpi, _MM_SHUFFLE(3, 1, 2, 0));
+        tmpi = _mm256_shuffle_epi8(tmpi, shuf);
+
+        /* store to output */
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), tmpi);
+    }
+
+    // convert any remaining samples
+    xx_to_item32_sc16<to_wire>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_fc32_to_item32_sc16<uhd::htowx>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<item32_t *>(outputs[0]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_SWAP_PAIRS)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, sc16_item32_be, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_fc32_to_item32_sc16<uhd::htonx>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<item32_t *>(outputs[0]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_SWAP_BYTES)
+    );
+}
@@ -0,0 +1,73 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_nco.hpp"
+#include "convert_x86.hpp"
+
+using namespace uhd::convert;
+
+// Eight phases at a time, like nco_sse2().
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static void nco_avx2(
+    const uint32_t *phase, float *out, const size_t nsamps, const float ampl
+){
+    const __m256i half_quad = _mm256_set1_epi32(0x20000000);
+    const __m256i quad_mask = _mm256_set1_epi32(0x3fffffff);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256 scale = _mm256_set1_ps(NCO_RAD_PER_LSB);
+    const __m256 a = _mm256_set1_ps(ampl);
+
+    size_t k = 0;
+    for (; k + 8 <= nsamps; k += 8){
+        const __m256i t = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(phase+k)), half_quad);
+        const __m256i quad = _mm256_srli_epi32(t, 30);
+        const __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_and_si256(t, quad_mask), half_quad)), scale);
+        const __m256 x2 = _mm256_mul_ps(x, x);
+
+        __m256 s = _mm256_add_ps(_mm256_set1_ps(NCO_SIN_C5), _mm256_mul_ps(x2, _mm256_set1_ps(NCO_SIN_C7)));
+        s = _mm256_add_ps(_mm256_set1_ps(NCO_SIN_C3), _mm256_mul_ps(x2, s));
+        s = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x2, s));
+        s = _mm256_mul_ps(x, s);
+        __m256 c = _mm256_add_ps(_mm256_set1_ps(NCO_COS_C6), _mm256_mul_ps(x2, _mm256_set1_ps(NCO_COS_C8)));
+        c = _mm256_add_ps(_mm256_set1_ps(NCO_COS_C4), _mm256_mul_ps(x2, c));
+        c = _mm256_add_ps(_mm256_set1_ps(NCO_COS_C2), _mm256_mul_ps(x2, c));
+        c = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x2, c));
+
+        /* odd quarters swap, the sign bits come from bit 1 */
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quad, one), one));
+        const __m256 neg_i = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quad, one), two), 30));
+        const __m256 neg_q = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quad, two), 30));
+        const __m256 i = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), neg_i);
+        const __m256 q = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), neg_q);
+
+        /* interleave within the 128-bit lanes, then put the lanes in order */
+        const __m256 lo = _mm256_unpacklo_ps(i, q);
+        const __m256 hi = _mm256_unpackhi_ps(i, q);
+        float *o = out + 2*k;
+        _mm256_storeu_ps(o+0, _mm256_add_ps(_mm256_loadu_ps(o+0), _mm256_mul_ps(a, _mm256_permute2f128_ps(lo, hi, 0x20))));
+        _mm256_storeu_ps(o+8, _mm256_add_ps(_mm256_loadu_ps(o+8), _mm256_mul_ps(a, _mm256_permute2f128_ps(lo, hi, 0x31))));
+    }
+
+    for (; k < nsamps; k++){
+        nco_add_sample(phase[k], out+2*k, ampl);
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_nco_avx2){
+    if (not cpu_has_feature(CPU_FEATURE_AVX2)) return;
+    register_nco_kernel(&nco_avx2, PRIORITY_SIMD_AVX2, cpu_feature_name(CPU_FEATURE_AVX2));
+}
@@ -0,0 +1,120 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Pack 2x 8 numbers (12 bits each, in 16-bit lanes) into 2 blocks
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static inline void avx2_pack_sc12_blocks(
+    const __m256i &nums, item32_sc12_3x *output, const __m256i &shuf
+){
+    //I*4096 + Q makes each pair one 24-bit number
+    const __m256i pairs = _mm256_madd_epi16(nums, _mm256_set1_epi32(0x00011000));
+    const __m256i tmpi = _mm256_shuffle_epi8(pairs, shuf);
+
+    //the second store overwrites the 4 extra bytes of the first
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output+0), _mm256_castsi256_si128(tmpi));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output+1), _mm256_extracti128_si256(tmpi, 1));
+}
+
+// this converts 2 blocks (8 samples) at a time, each store writes 4 bytes of the next block
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static size_t avx2_pack_fc32_to_sc12(
+    const fc32_t *input, item32_sc12_3x *output, const size_t nblocks, const double scalar
+){
+    const __m256i shuf = le? avx2_broadcast(_mm_setr_epi8(SC12_PACK_LE)) : avx2_broadcast(_mm_setr_epi8(SC12_PACK_BE));
+    const __m256 scalar_ps = _mm256_set1_ps(float(scalar));
+    const __m256i mask = _mm256_set1_epi32(0xfff);
+
+    size_t i = 0;
+    for (; i+2 < nblocks; i+=2){
+        /* load from input */
+        const __m256 tmplo = _mm256_loadu_ps(reinterpret_cast<const float *>(input+4*i+0));
+        const __m256 tmphi = _mm256_loadu_ps(reinterpret_cast<const float *>(input+4*i+4));
+
+        /* scale, truncate and keep the lower 12 bits */
+        const __m256i tmpilo = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(tmplo, scalar_ps)), mask);
+        const __m256i tmpihi = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(tmphi, scalar_ps)), mask);
+
+        /* packs works within 128-bit lanes, put the samples back in order */
+        const __m256i tmpi = _mm256_permute4x64_epi64(_mm256_packs_epi32(tmpilo, tmpihi), _MM_SHUFFLE(3, 1, 2, 0));
+        avx2_pack_sc12_blocks(tmpi, output+i, shuf);
+    }
+    return i;
+}
+
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static size_t avx2_pack_sc16_to_sc12(
+    const sc16_t *input, item32_sc12_3x *output, const size_t nblocks, const double
+){
+    const __m256i shuf = le? avx2_broadcast(_mm_setr_epi8(SC12_PACK_LE)) : avx2_broadcast(_mm_setr_epi8(SC12_PACK_BE));
+
+    size_t i = 0;
+    for (; i+2 < nblocks; i+=2){
+        /* keep the upper 12 bits */
+        const __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+4*i));
+        avx2_pack_sc12_blocks(_mm256_srli_epi16(tmpi, 4), output+i, shuf);
+    }
+    return i;
+}
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx>(&avx2_pack_fc32_to_sc12<true>));
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::ntohx>(&avx2_pack_fc32_to_sc12<false>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::wtohx>(&avx2_pack_sc16_to_sc12<true>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::ntohx>(&avx2_pack_sc16_to_sc12<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_avx2_pack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_AVX2)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_AVX2);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.input_format = "fc32";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_le_1, PRIORITY_SIMD_AVX2, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_be_1, PRIORITY_SIMD_AVX2, name);
+
+    id.input_format = "sc16";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_le_1, PRIORITY_SIMD_AVX2, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_be_1, PRIORITY_SIMD_AVX2, name);
+}
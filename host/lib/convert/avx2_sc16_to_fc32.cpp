@@ -0,0 +1,87 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// Unaligned loads and stores are as fast as aligned ones on aligned data
+// on CPUs with AVX2, so there is no dispatch on the alignment.
+
+// this converts 8 items at a time: shuffle into I/Q order, sign extend, convert and scale
+template <xtox_t to_host, bool stream>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static void avx2_item32_sc16_to_fc32(
+    const item32_t *input, fc32_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    // streaming stores need an aligned output, so convert up to it first
+    if (stream) for (; i < nsamps and (size_t(output+i) & 0x1f); i++){
+        item32_sc16_to_xx<to_host>(input+i, output+i, 1, scale_factor);
+    }
+
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+
+        /* swap into I/Q order */
+        tmpi = _mm256_shuffle_epi8(tmpi, shuf);
+
+        /* sign extend, convert and scale */
+        __m256 tmplo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(tmpi))), scalar);
+        __m256 tmphi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(tmpi, 1))), scalar);
+
+        /* store to output */
+        avx2_store_ps<stream>(reinterpret_cast<float *>(output+i+0), tmplo);
+        avx2_store_ps<stream>(reinterpret_cast<float *>(output+i+4), tmphi);
+    }
+    if (stream) _mm_sfence();
+
+    // convert any remaining samples
+    item32_sc16_to_xx<to_host>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+    const __m256i shuf = avx2_shuffle(SHUFFLE_SWAP_PAIRS);
+
+    //streaming stores need an output aligned to at least a sample
+    if (nontemporal and (size_t(output) & 0x7) == 0){
+        avx2_item32_sc16_to_fc32<uhd::wtohx, true>(input, output, nsamps, scale_factor, shuf);
+    }
+    else{
+        avx2_item32_sc16_to_fc32<uhd::wtohx, false>(input, output, nsamps, scale_factor, shuf);
+    }
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+    const __m256i shuf = avx2_shuffle(SHUFFLE_SWAP_BYTES);
+
+    //streaming stores need an output aligned to at least a sample
+    if (nontemporal and (size_t(output) & 0x7) == 0){
+        avx2_item32_sc16_to_fc32<uhd::ntohx, true>(input, output, nsamps, scale_factor, shuf);
+    }
+    else{
+        avx2_item32_sc16_to_fc32<uhd::ntohx, false>(input, output, nsamps, scale_factor, shuf);
+    }
+}
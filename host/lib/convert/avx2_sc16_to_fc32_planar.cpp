@@ -0,0 +1,72 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 8 items at a time: split each lane into I and Q, gather
+// the I of both lanes in the low half, sign extend, convert and scale
+template <xtox_t to_host>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static void avx2_item32_sc16_to_fc32_planar(
+    const item32_t *input, float *output_i, float *output_q, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+
+        /* I0-3 Q0-3 | I4-7 Q4-7 -> I0-7 | Q0-7 */
+        tmpi = _mm256_shuffle_epi8(tmpi, shuf);
+        tmpi = _mm256_permute4x64_epi64(tmpi, _MM_SHUFFLE(3, 1, 2, 0));
+
+        /* sign extend, convert and scale */
+        __m256 tmp_i = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(tmpi))), scalar);
+        __m256 tmp_q = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(tmpi, 1))), scalar);
+
+        /* store to output */
+        _mm256_storeu_ps(output_i+i, tmp_i);
+        _mm256_storeu_ps(output_q+i, tmp_q);
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        output_i[i] = float(int16_t(item >> 16)*float(scale_factor));
+        output_q[i] = float(int16_t(item >> 0)*float(scale_factor));
+    }
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, fc32_planar, 2, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_item32_sc16_to_fc32_planar<uhd::wtohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]), reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_SPLIT_LE)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, fc32_planar, 2, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_item32_sc16_to_fc32_planar<uhd::ntohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]), reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_SPLIT_BE)
+    );
+}
@@ -0,0 +1,78 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 16 samples (8 items) at a time: shuffle into I/Q order, sign extend, convert and scale
+template <xtox_t to_host>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static void avx2_item32_sc8_to_fc32(
+    const void *input_ptr, fc32_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(size_t(input_ptr) & ~0x3);
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0, j = 0;
+    size_t num_samps = nsamps;
+
+    if ((size_t(input_ptr) & 0x3) != 0){
+        item32_sc8_to_xx<to_host>(input++, output++, 1, scale_factor);
+        num_samps--;
+    }
+
+    for (; j+15 < num_samps; j+=16, i+=8){
+        /* load from input */
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+
+        /* swap into I/Q order */
+        tmpi = _mm256_shuffle_epi8(tmpi, shuf);
+        const __m128i tmpilo = _mm256_castsi256_si128(tmpi);
+        const __m128i tmpihi = _mm256_extracti128_si256(tmpi, 1);
+
+        /* sign extend, convert and scale */
+        __m256 tmp0 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(tmpilo)), scalar);
+        __m256 tmp1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(tmpilo, 8))), scalar);
+        __m256 tmp2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(tmpihi)), scalar);
+        __m256 tmp3 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(tmpihi, 8))), scalar);
+
+        /* store to output */
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+j+0), tmp0);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+j+4), tmp1);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+j+8), tmp2);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+j+12), tmp3);
+    }
+
+    //convert remainder
+    item32_sc8_to_xx<to_host>(input+i, output+j, num_samps-j, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(sc8_item32_be, 1, fc32, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_item32_sc8_to_fc32<uhd::ntohx>(
+        inputs[0], reinterpret_cast<fc32_t *>(outputs[0]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_NONE)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc8_item32_le, 1, fc32, 1, PRIORITY_SIMD_AVX2, UHD_CONVERT_AVX2, CPU_FEATURE_AVX2){
+    avx2_item32_sc8_to_fc32<uhd::wtohx>(
+        inputs[0], reinterpret_cast<fc32_t *>(outputs[0]),
+        nsamps, scale_factor, avx2_shuffle(SHUFFLE_REVERSE)
+    );
+}
@@ -0,0 +1,149 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include "convert_half.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Round 8 floats to bfloat16 (to nearest even) in the low half of each 32-bit lane
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) static inline __m256i avx2_round_bf16(const __m256 &num){
+    //add just under half a unit, plus one on odd results, and truncate
+    const __m256i bits = _mm256_castps_si256(num);
+    const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    const __m256i half = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(bits, _mm256_set1_epi32(0x7fff)), odd), 16);
+
+    //NaNs are truncated and made quiet
+    const __m256i nan = _mm256_castps_si256(_mm256_cmp_ps(num, num, _CMP_UNORD_Q));
+    return _mm256_blendv_epi8(half, _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40)), nan);
+}
+
+//! Narrow 16 floats to 16 halves (fc16 or bf16), round to nearest even
+template <bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) static inline __m256i avx2_narrow(const __m256 &lo, const __m256 &hi){
+    if (not bf16) return _mm256_inserti128_si256(_mm256_castsi128_si256(
+        _mm256_cvtps_ph(lo, _MM_FROUND_TO_NEAREST_INT)), _mm256_cvtps_ph(hi, _MM_FROUND_TO_NEAREST_INT), 1);
+
+    //32 to 16 bits, per lane, then put the lanes back in order
+    const __m256i half = _mm256_packus_epi32(avx2_round_bf16(lo), avx2_round_bf16(hi));
+    return _mm256_permute4x64_epi64(half, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+// this converts 8 items at a time: shuffle into I/Q order, sign extend, convert, scale and narrow
+template <xtox_t to_host, bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) static void avx2_item32_sc16_to_half(
+    const item32_t *input, fc16_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+
+        /* swap into I/Q order */
+        tmpi = _mm256_shuffle_epi8(tmpi, shuf);
+
+        /* sign extend, convert and scale */
+        __m256 tmplo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(tmpi))), scalar);
+        __m256 tmphi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(tmpi, 1))), scalar);
+
+        /* narrow and store to output */
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), avx2_narrow<bf16>(tmplo, tmphi));
+    }
+
+    // convert any remaining samples
+    if (bf16) item32_sc16_to_half<to_host, float_to_bf16>(input+i, output+i, nsamps-i, scale_factor);
+    else item32_sc16_to_half<to_host, float_to_fc16>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+// this converts 8 samples at a time
+template <bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) static void avx2_fc32_to_half(
+    const fc32_t *input, fc16_t *output, const size_t nsamps, const double scale_factor
+){
+    const __m256 scalar = _mm256_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        __m256 tmplo = _mm256_mul_ps(_mm256_loadu_ps(reinterpret_cast<const float *>(input+i+0)), scalar);
+        __m256 tmphi = _mm256_mul_ps(_mm256_loadu_ps(reinterpret_cast<const float *>(input+i+4)), scalar);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), avx2_narrow<bf16>(tmplo, tmphi));
+    }
+
+    // convert any remaining samples
+    if (bf16) fc32_to_half<float_to_bf16>(input+i, output+i, nsamps-i, scale_factor);
+    else fc32_to_half<float_to_fc16>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+/***********************************************************************
+ * Registration, for CPUs with both AVX2 and F16C
+ **********************************************************************/
+template <bool be, bool bf16>
+struct avx2_sc16_to_half : public converter{
+    static sptr make(void){return sptr(new avx2_sc16_to_half());}
+    double scale_factor;
+    void set_scalar(const double s){scale_factor = s;}
+    UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+        fc16_t *output = reinterpret_cast<fc16_t *>(outputs[0]);
+        if (be) avx2_item32_sc16_to_half<uhd::ntohx, bf16>(
+            input, output, nsamps, scale_factor, avx2_shuffle(SHUFFLE_SWAP_BYTES));
+        else avx2_item32_sc16_to_half<uhd::wtohx, bf16>(
+            input, output, nsamps, scale_factor, avx2_shuffle(SHUFFLE_SWAP_PAIRS));
+    }
+};
+
+template <bool bf16>
+struct avx2_fc32_to_half_conv : public converter{
+    static sptr make(void){return sptr(new avx2_fc32_to_half_conv());}
+    double scale_factor;
+    void set_scalar(const double s){scale_factor = s;}
+    UHD_CONVERT_TARGET(UHD_CONVERT_AVX2_F16C) void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        avx2_fc32_to_half<bf16>(
+            reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+            nsamps, scale_factor
+        );
+    }
+};
+
+UHD_DEFERRED_BLOCK("convert", register_avx2_to_half){
+    if (not cpu_has_feature(CPU_FEATURE_AVX2) or not cpu_has_feature(CPU_FEATURE_F16C)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_AVX2);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc16";
+    id.input_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &avx2_sc16_to_half<false, false>::make, PRIORITY_SIMD_AVX2, name);
+    id.input_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &avx2_sc16_to_half<true, false>::make, PRIORITY_SIMD_AVX2, name);
+    id.input_format = "fc32";
+    uhd::convert::register_converter(id, &avx2_fc32_to_half_conv<false>::make, PRIORITY_SIMD_AVX2, name);
+
+    id.output_format = "bf16";
+    id.input_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &avx2_sc16_to_half<false, true>::make, PRIORITY_SIMD_AVX2, name);
+    id.input_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &avx2_sc16_to_half<true, true>::make, PRIORITY_SIMD_AVX2, name);
+    id.input_format = "fc32";
+    uhd::convert::register_converter(id, &avx2_fc32_to_half_conv<true>::make, PRIORITY_SIMD_AVX2, name);
+}
@@ -0,0 +1,118 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Gather the 8 numbers of 2 blocks each into 16-bit lanes, 12 bits on top
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static inline __m256i avx2_unpack_sc12_blocks(
+    const item32_sc12_3x *input, const __m256i &shuf
+){
+    //the numbers in odd lanes start 4 bits lower, shift them up
+    const __m256i shift = _mm256_set1_epi32(0x00100001);
+    const __m256i mask = _mm256_set1_epi32(int(0xfffffff0));
+
+    const __m256i tmpi = _mm256_inserti128_si256(_mm256_castsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+0))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+1)), 1);
+    return _mm256_and_si256(_mm256_mullo_epi16(_mm256_shuffle_epi8(tmpi, shuf), shift), mask);
+}
+
+// this converts 2 blocks (8 samples) at a time, each load reads 4 bytes of the next block
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static size_t avx2_unpack_sc12_to_fc32(
+    const item32_sc12_3x *input, fc32_t *output, const size_t nblocks, const double scalar
+){
+    const __m256i shuf = le? avx2_broadcast(_mm_setr_epi8(SC12_UNPACK_LE)) : avx2_broadcast(_mm_setr_epi8(SC12_UNPACK_BE));
+    const __m256 scalar_ps = _mm256_set1_ps(float(scalar));
+
+    size_t i = 0;
+    for (; i+2 < nblocks; i+=2){
+        const __m256i tmpi = avx2_unpack_sc12_blocks(input+i, shuf);
+
+        /* sign extend, convert and scale */
+        const __m256i tmpilo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(tmpi));
+        const __m256i tmpihi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(tmpi, 1));
+        const __m256 tmplo = _mm256_mul_ps(_mm256_cvtepi32_ps(tmpilo), scalar_ps);
+        const __m256 tmphi = _mm256_mul_ps(_mm256_cvtepi32_ps(tmpihi), scalar_ps);
+
+        /* store to output */
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+4*i+0), tmplo);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+4*i+4), tmphi);
+    }
+    return i;
+}
+
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static size_t avx2_unpack_sc12_to_sc16(
+    const item32_sc12_3x *input, sc16_t *output, const size_t nblocks, const double
+){
+    const __m256i shuf = le? avx2_broadcast(_mm_setr_epi8(SC12_UNPACK_LE)) : avx2_broadcast(_mm_setr_epi8(SC12_UNPACK_BE));
+
+    size_t i = 0;
+    for (; i+2 < nblocks; i+=2){
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+4*i), avx2_unpack_sc12_blocks(input+i, shuf));
+    }
+    return i;
+}
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx>(&avx2_unpack_sc12_to_fc32<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::ntohx>(&avx2_unpack_sc12_to_fc32<false>));
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::wtohx>(&avx2_unpack_sc12_to_sc16<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::ntohx>(&avx2_unpack_sc12_to_sc16<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_avx2_unpack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_AVX2)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_AVX2);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_1, PRIORITY_SIMD_AVX2, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_1, PRIORITY_SIMD_AVX2, name);
+
+    id.output_format = "sc16";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_sc16_1, PRIORITY_SIMD_AVX2, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_sc16_1, PRIORITY_SIMD_AVX2, name);
+}
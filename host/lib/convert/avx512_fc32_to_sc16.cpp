@@ -0,0 +1,65 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 16 samples at a time: scale, round, narrow with saturation and shuffle into item order
+template <xtox_t to_wire>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static void avx512_fc32_to_item32_sc16(
+    const fc32_t *input, item32_t *output, const size_t nsamps,
+    const double scale_factor, const __m512i &shuf
+){
+    const __m512 scalar = _mm512_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+15 < nsamps; i+=16){
+        /* load from input */
+        __m512 tmplo = _mm512_loadu_ps(reinterpret_cast<const float *>(input+i+0));
+        __m512 tmphi = _mm512_loadu_ps(reinterpret_cast<const float *>(input+i+8));
+
+        /* convert and scale */
+        __m256i tmpilo = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(_mm512_mul_ps(tmplo, scalar)));
+        __m256i tmpihi = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(_mm512_mul_ps(tmphi, scalar)));
+
+        /* swap into item order */
+        __m512i tmpi = _mm512_inserti64x4(_mm512_castsi256_si512(tmpilo), tmpihi, 1);
+        tmpi = _mm512_shuffle_epi8(tmpi, shuf);
+
+        /* store to output */
+        _mm512_storeu_si512(output+i, tmpi);
+    }
+
+    // convert any remaining samples
+    xx_to_item32_sc16<to_wire>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_fc32_to_item32_sc16<uhd::htowx>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<item32_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_PAIRS)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, sc16_item32_be, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_fc32_to_item32_sc16<uhd::htonx>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<item32_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_BYTES)
+    );
+}
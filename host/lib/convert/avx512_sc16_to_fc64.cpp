@@ -0,0 +1,70 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 16 items at a time: shuffle into I/Q order, sign extend, convert and scale
+template <xtox_t to_host>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static void avx512_item32_sc16_to_fc64(
+    const item32_t *input, fc64_t *output, const size_t nsamps,
+    const double scale_factor, const __m512i &shuf
+){
+    const __m512d scalar = _mm512_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+15 < nsamps; i+=16){
+        /* load from input */
+        __m512i tmpi = _mm512_loadu_si512(input+i);
+
+        /* swap into I/Q order and sign extend */
+        tmpi = _mm512_shuffle_epi8(tmpi, shuf);
+        const __m512i tmpilo = _mm512_cvtepi16_epi32(_mm512_castsi512_si256(tmpi));
+        const __m512i tmpihi = _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(tmpi, 1));
+
+        /* convert and scale */
+        __m512d tmp0 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(tmpilo)), scalar);
+        __m512d tmp1 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(tmpilo, 1)), scalar);
+        __m512d tmp2 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(tmpihi)), scalar);
+        __m512d tmp3 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(tmpihi, 1)), scalar);
+
+        /* store to output */
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+0), tmp0);
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+4), tmp1);
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+8), tmp2);
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+12), tmp3);
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<to_host>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, fc64, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_fc64<uhd::wtohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc64_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_PAIRS)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, fc64, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_fc64<uhd::ntohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc64_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_BYTES)
+    );
+}
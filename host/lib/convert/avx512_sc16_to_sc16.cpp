@@ -0,0 +1,77 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this shuffles 16 samples at a time (the shuffles are their own inverse)
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static size_t avx512_shuffle_sc16(
+    const void *input, void *output, const size_t nsamps, const __m512i &shuf
+){
+    const uint32_t *in = reinterpret_cast<const uint32_t *>(input);
+    uint32_t *out = reinterpret_cast<uint32_t *>(output);
+
+    size_t i = 0;
+    for (; i+15 < nsamps; i+=16){
+        __m512i m0 = _mm512_loadu_si512(in+i);
+        m0 = _mm512_shuffle_epi8(m0, shuf);
+        _mm512_storeu_si512(out+i, m0);
+    }
+    return i;
+}
+
+DECLARE_TARGET_CONVERTER(sc16, 1, sc16_item32_le, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const size_t i = avx512_shuffle_sc16(input, output, nsamps, avx512_shuffle(SHUFFLE_SWAP_PAIRS));
+
+    // convert any remaining samples
+    xx_to_item32_sc16<uhd::htowx>(input+i, output+i, nsamps-i, 1.0);
+}
+
+DECLARE_TARGET_CONVERTER(sc16, 1, sc16_item32_be, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const size_t i = avx512_shuffle_sc16(input, output, nsamps, avx512_shuffle(SHUFFLE_SWAP_BYTES));
+
+    // convert any remaining samples
+    xx_to_item32_sc16<uhd::htonx>(input+i, output+i, nsamps-i, 1.0);
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, sc16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    const size_t i = avx512_shuffle_sc16(input, output, nsamps, avx512_shuffle(SHUFFLE_SWAP_PAIRS));
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::wtohx>(input+i, output+i, nsamps-i, 1.0);
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, sc16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    const size_t i = avx512_shuffle_sc16(input, output, nsamps, avx512_shuffle(SHUFFLE_SWAP_BYTES));
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::ntohx>(input+i, output+i, nsamps-i, 1.0);
+}
@@ -0,0 +1,76 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// this converts 32 samples (16 items) at a time: shuffle into I/Q order, sign extend, convert and scale
+template <xtox_t to_host>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static void avx512_item32_sc8_to_fc32(
+    const void *input_ptr, fc32_t *output, const size_t nsamps,
+    const double scale_factor, const __m512i &shuf
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(size_t(input_ptr) & ~0x3);
+    const __m512 scalar = _mm512_set1_ps(float(scale_factor));
+
+    size_t i = 0, j = 0;
+    size_t num_samps = nsamps;
+
+    if ((size_t(input_ptr) & 0x3) != 0){
+        item32_sc8_to_xx<to_host>(input++, output++, 1, scale_factor);
+        num_samps--;
+    }
+
+    for (; j+31 < num_samps; j+=32, i+=16){
+        /* load from input */
+        __m512i tmpi = _mm512_loadu_si512(input+i);
+
+        /* swap into I/Q order */
+        tmpi = _mm512_shuffle_epi8(tmpi, shuf);
+
+        /* sign extend, convert and scale */
+        __m512 tmp0 = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(tmpi, 0))), scalar);
+        __m512 tmp1 = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(tmpi, 1))), scalar);
+        __m512 tmp2 = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(tmpi, 2))), scalar);
+        __m512 tmp3 = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm512_extracti32x4_epi32(tmpi, 3))), scalar);
+
+        /* store to output */
+        _mm512_storeu_ps(reinterpret_cast<float *>(output+j+0), tmp0);
+        _mm512_storeu_ps(reinterpret_cast<float *>(output+j+8), tmp1);
+        _mm512_storeu_ps(reinterpret_cast<float *>(output+j+16), tmp2);
+        _mm512_storeu_ps(reinterpret_cast<float *>(output+j+24), tmp3);
+    }
+
+    //convert remainder
+    item32_sc8_to_xx<to_host>(input+i, output+j, num_samps-j, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(sc8_item32_be, 1, fc32, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc8_to_fc32<uhd::ntohx>(
+        inputs[0], reinterpret_cast<fc32_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_NONE)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc8_item32_le, 1, fc32, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc8_to_fc32<uhd::wtohx>(
+        inputs[0], reinterpret_cast<fc32_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_REVERSE)
+    );
+}
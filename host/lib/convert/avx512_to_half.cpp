@@ -0,0 +1,126 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_x86.hpp"
+#include "convert_half.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Narrow 16 floats to 16 halves (fc16 or bf16), round to nearest even
+template <bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static inline __m256i avx512_narrow(const __m512 &num){
+    if (not bf16) return _mm512_cvtps_ph(num, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+    //add just under half a unit, plus one on odd results, and truncate
+    const __m512i bits = _mm512_castps_si512(num);
+    const __m512i odd = _mm512_and_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(1));
+    __m512i half = _mm512_srli_epi32(_mm512_add_epi32(_mm512_add_epi32(bits, _mm512_set1_epi32(0x7fff)), odd), 16);
+    const __mmask16 nan = _mm512_cmp_ps_mask(num, num, _CMP_UNORD_Q);
+    half = _mm512_mask_mov_epi32(half, nan, _mm512_or_si512(_mm512_srli_epi32(bits, 16), _mm512_set1_epi32(0x40)));
+    return _mm512_cvtepi32_epi16(half);
+}
+
+// this converts 16 items at a time: shuffle into I/Q order, sign extend, convert, scale and narrow
+template <xtox_t to_host, bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static void avx512_item32_sc16_to_half(
+    const item32_t *input, fc16_t *output, const size_t nsamps,
+    const double scale_factor, const __m512i &shuf
+){
+    const __m512 scalar = _mm512_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+15 < nsamps; i+=16){
+        /* load from input */
+        __m512i tmpi = _mm512_loadu_si512(input+i);
+
+        /* swap into I/Q order */
+        tmpi = _mm512_shuffle_epi8(tmpi, shuf);
+
+        /* sign extend, convert and scale */
+        __m512 tmplo = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_castsi512_si256(tmpi))), scalar);
+        __m512 tmphi = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(tmpi, 1))), scalar);
+
+        /* narrow and store to output */
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i+0), avx512_narrow<bf16>(tmplo));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i+8), avx512_narrow<bf16>(tmphi));
+    }
+
+    // convert any remaining samples
+    if (bf16) item32_sc16_to_half<to_host, float_to_bf16>(input+i, output+i, nsamps-i, scale_factor);
+    else item32_sc16_to_half<to_host, float_to_fc16>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+// this converts 8 samples at a time
+template <bool bf16>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static void avx512_fc32_to_half(
+    const fc32_t *input, fc16_t *output, const size_t nsamps, const double scale_factor
+){
+    const __m512 scalar = _mm512_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        __m512 tmp = _mm512_mul_ps(_mm512_loadu_ps(reinterpret_cast<const float *>(input+i)), scalar);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i), avx512_narrow<bf16>(tmp));
+    }
+
+    // convert any remaining samples
+    if (bf16) fc32_to_half<float_to_bf16>(input+i, output+i, nsamps-i, scale_factor);
+    else fc32_to_half<float_to_fc16>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, fc16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_half<uhd::wtohx, false>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_PAIRS)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, fc16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_half<uhd::ntohx, false>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_BYTES)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_le, 1, bf16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_half<uhd::wtohx, true>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_PAIRS)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(sc16_item32_be, 1, bf16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_item32_sc16_to_half<uhd::ntohx, true>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor, avx512_shuffle(SHUFFLE_SWAP_BYTES)
+    );
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, fc16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_fc32_to_half<false>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_TARGET_CONVERTER(fc32, 1, bf16, 1, PRIORITY_SIMD_AVX512, UHD_CONVERT_AVX512, CPU_FEATURE_AVX512BW){
+    avx512_fc32_to_half<true>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
@@ -22,6 +22,17 @@
 #include <uhd/utils/static.hpp>
 #include <stdint.h>
 #include <complex>
+#include <string>
+
+/*!
+ * The converters of this library are registered on first use of a
+ * converter table (see UHD_DEFERRED_BLOCK), not before main(). Modules
+ * are loaded first, their converters are registered as they load.
+ */
+static UHD_INLINE void load_converters(void){
+    uhd::run_deferred_blocks("modules");
+    uhd::run_deferred_blocks("convert");
+}
 
 #define _DECLARE_CONVERTER(name, in_form, num_in, out_form, num_out, prio) \
     struct name : public uhd::convert::converter{ \
@@ -30,7 +41,7 @@
         void set_scalar(const double s){scale_factor = s;} \
         void operator()(const input_type&, const output_type&, const size_t); \
     }; \
-    UHD_STATIC_BLOCK(__register_##name##_##prio){ \
+    UHD_DEFERRED_BLOCK("convert", __register_##name##_##prio){ \
         uhd::convert::id_type id; \
         id.input_format = #in_form; \
         id.num_inputs = num_in; \
@@ -58,19 +69,101 @@
 #define DECLARE_CONVERTER(in_form, num_in, out_form, num_out, prio) \
     _DECLARE_CONVERTER(__convert_##in_form##_##num_in##_##out_form##_##num_out##_##prio, in_form, num_in, out_form, num_out, prio)
 
+/***********************************************************************
+ * Run time CPU dispatch
+ **********************************************************************/
+namespace uhd{ namespace convert{
+
+    //! Instruction set extensions converters can be dispatched on
+    enum cpu_feature_t{
+        CPU_FEATURE_SSE2,
+        CPU_FEATURE_SSSE3,
+        CPU_FEATURE_AVX2,
+        CPU_FEATURE_AVX512BW, //with AVX-512F
+        CPU_FEATURE_F16C, //half precision conversions
+        CPU_FEATURE_NEON,
+        CPU_FEATURE_SVE
+    };
+
+    //! True if the running CPU (and OS) support the extension
+    bool cpu_has_feature(const cpu_feature_t feature);
+
+    //! The name of the extension, e.g. "avx2"
+    std::string cpu_feature_name(const cpu_feature_t feature);
+
+}} //namespace
+
+#define _DECLARE_DISPATCHED_CONVERTER(name, in_form, num_in, out_form, num_out, prio, target, feature) \
+    struct name : public uhd::convert::converter{ \
+        name(void): nontemporal(false){} \
+        static sptr make(void){return sptr(new name());} \
+        double scale_factor; \
+        bool nontemporal; /*streaming stores, for the bodies that have them*/ \
+        void set_scalar(const double s){scale_factor = s;} \
+        void set_nontemporal(const bool enb){nontemporal = enb;} \
+        target void operator()(const input_type&, const output_type&, const size_t); \
+    }; \
+    UHD_DEFERRED_BLOCK("convert", __register_##name##_##prio){ \
+        if (not uhd::convert::cpu_has_feature(uhd::convert::feature)) return; \
+        uhd::convert::id_type id; \
+        id.input_format = #in_form; \
+        id.num_inputs = num_in; \
+        id.output_format = #out_form; \
+        id.num_outputs = num_out; \
+        uhd::convert::register_converter(id, &name::make, prio, \
+            uhd::convert::cpu_feature_name(uhd::convert::feature)); \
+    } \
+    target void name::operator()( \
+        const input_type &inputs, const output_type &outputs, const size_t nsamps \
+    )
+
+/*! Declare a converter that needs an instruction set extension
+ *
+ * Like DECLARE_CONVERTER, but the converter is only registered when the
+ * running CPU supports `feature' (a cpu_feature_t), and it is registered
+ * under the name of the extension. Use this for sources built with the
+ * compiler flags of the extension.
+ */
+#define DECLARE_CPU_CONVERTER(in_form, num_in, out_form, num_out, prio, feature) \
+    _DECLARE_DISPATCHED_CONVERTER(__convert_##in_form##_##num_in##_##out_form##_##num_out##_##prio, in_form, num_in, out_form, num_out, prio, , feature)
+
+/*! Declare a converter built for an instruction set extension
+ *
+ * Like DECLARE_CPU_CONVERTER, but only the function block is compiled
+ * for the extension `isa' (a GCC target attribute string like "avx2").
+ * So the source needs no extra compiler flags, one binary runs on CPUs
+ * with and without the extension, and nothing in the static
+ * registration depends on it.
+ */
+#define DECLARE_TARGET_CONVERTER(in_form, num_in, out_form, num_out, prio, isa, feature) \
+    _DECLARE_DISPATCHED_CONVERTER(__convert_##in_form##_##num_in##_##out_form##_##num_out##_##prio, in_form, num_in, out_form, num_out, prio, UHD_CONVERT_TARGET(isa), feature)
+
+//! Compile a function for an instruction set extension (MSVC needs no flag)
+#if defined(__GNUC__)
+    #define UHD_CONVERT_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define UHD_CONVERT_TARGET(isa)
+#endif
+
 /***********************************************************************
  * Setup priorities
  **********************************************************************/
 static const int PRIORITY_GENERAL = 0;
 static const int PRIORITY_EMPTY = -1;
+//! Converters with a DC offset and IQ correction, only used when asked for
+static const int PRIORITY_CORRECTION = -3;
+static const int PRIORITY_CORRECTION_SIMD = -2;
 
-#ifdef __ARM_NEON__
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
 static const int PRIORITY_SIMD = 2;
 static const int PRIORITY_TABLE = 1; //tables require large cache, so they are slower on arm
 #else
 // We used to have ORC, too, so SIMD is 3
 static const int PRIORITY_SIMD = 3;
 static const int PRIORITY_TABLE = 1;
+//! Wider SIMD, only registered when the CPU has it
+static const int PRIORITY_SIMD_AVX2 = 4;
+static const int PRIORITY_SIMD_AVX512 = 5;
 #endif
 
 /***********************************************************************
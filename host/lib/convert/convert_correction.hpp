@@ -0,0 +1,133 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP
+#define INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP
+
+#include "convert_common.hpp"
+#include <algorithm>
+
+/*!
+ * The scalar, DC offset and IQ matrix of a correction folded into one
+ * affine map of the raw input samples:
+ * `I' = ii*I + iq*Q - off_i`, `Q' = qi*I + qq*Q - off_q`.
+ */
+struct correction_coeffs_t{
+    float ii, iq, qi, qq, off_i, off_q;
+};
+
+//! The |sample|^2 of the converted samples, see converter::get_power()
+struct power_acc_t{
+    float peak;
+    double sum;
+    size_t num;
+};
+
+/*!
+ * Base of the converters that apply a uhd::convert::correction_t.
+ * Derived converters only implement the conversion, with the
+ * coefficients in _coeffs.
+ */
+class converter_with_correction : public uhd::convert::converter{
+public:
+    converter_with_correction(void):
+        _measure_power(false),
+        _scalar(1.0)
+    {
+        _power.peak = 0.0f;
+        _power.sum = 0.0;
+        _power.num = 0;
+        this->update();
+    }
+
+    void set_scalar(const double scalar){
+        _scalar = scalar;
+        this->update();
+    }
+
+    void set_correction(const uhd::convert::correction_t &correction){
+        _correction = correction;
+        this->update();
+    }
+
+    void set_power_measurement(const bool enb){
+        _measure_power = enb;
+    }
+
+    void get_power(double &peak, double &mean){
+        peak = _power.peak;
+        mean = (_power.num == 0)? 0.0 : _power.sum/_power.num;
+        _power.peak = 0.0f;
+        _power.sum = 0.0;
+        _power.num = 0;
+    }
+
+protected:
+    correction_coeffs_t _coeffs;
+    bool _measure_power;
+    power_acc_t _power;
+
+private:
+    void update(void){
+        const double (&m)[2][2] = _correction.iq_matrix;
+        const std::complex<double> &dc = _correction.dc_offset;
+        _coeffs.ii = float(m[0][0]*_scalar);
+        _coeffs.iq = float(m[0][1]*_scalar);
+        _coeffs.qi = float(m[1][0]*_scalar);
+        _coeffs.qq = float(m[1][1]*_scalar);
+        _coeffs.off_i = float(m[0][0]*dc.real() + m[0][1]*dc.imag());
+        _coeffs.off_q = float(m[1][0]*dc.real() + m[1][1]*dc.imag());
+    }
+
+    double _scalar;
+    uhd::convert::correction_t _correction;
+};
+
+/***********************************************************************
+ * Convert items32 sc16 buffer to fc32, with correction
+ * (and the power of the output when measure is set)
+ **********************************************************************/
+template <xtox_t to_host, bool measure>
+UHD_INLINE void item32_sc16_to_fc32_corrected(
+    const item32_t *input,
+    fc32_t *output,
+    const size_t nsamps,
+    const correction_coeffs_t &c,
+    power_acc_t &power
+){
+    float peak = power.peak, sum = 0.0f;
+    for (size_t i = 0; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        const float re = float(int16_t(item >> 16));
+        const float im = float(int16_t(item >> 0));
+        const float out_re = (c.ii*re + c.iq*im) - c.off_i;
+        const float out_im = (c.qq*im + c.qi*re) - c.off_q;
+        output[i] = fc32_t(out_re, out_im);
+        if (measure){
+            const float mag2 = out_re*out_re + out_im*out_im;
+            peak = std::max(peak, mag2);
+            sum += mag2;
+        }
+    }
+    if (measure){
+        power.peak = peak;
+        power.sum += sum;
+        power.num += nsamps;
+    }
+}
+
+#endif /* INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP */
@@ -0,0 +1,243 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_fir.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/utils/static.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * The kernel registry
+ **********************************************************************/
+struct fir_decim_entry_t{
+    fir_decim_kernel_t kernel;
+    std::string name;
+};
+typedef std::map<priority_type, fir_decim_entry_t> fir_decim_table_type;
+UHD_SINGLETON_FCN(fir_decim_table_type, get_registered_fir_decims);
+
+static fir_decim_table_type &get_fir_decim_table(void){
+    load_converters();
+    return get_registered_fir_decims();
+}
+
+void uhd::convert::register_fir_decim_kernel(
+    const fir_decim_kernel_t kernel, const priority_type prio, const std::string &name
+){
+    fir_decim_entry_t &entry = get_fir_decim_table()[prio];
+    entry.kernel = kernel;
+    entry.name = name;
+}
+
+fir_decim_kernel_t uhd::convert::get_fir_decim_kernel(void){
+    return get_fir_decim_table().rbegin()->second.kernel;
+}
+
+std::string uhd::convert::get_fir_decim_kernel_name(void){
+    return get_fir_decim_table().rbegin()->second.name;
+}
+
+static void fir_decim_generic(
+    const float *in, float *out, const size_t nout,
+    const size_t decim, const float *taps, const size_t ntaps
+){
+    for (size_t k = 0; k < nout; k++){
+        const float *x = in + 2*k*decim;
+        float acc_i = 0.0f, acc_q = 0.0f;
+        for (size_t j = 0; j < 2*ntaps; j += 2){
+            acc_i += taps[j+0]*x[j+0];
+            acc_q += taps[j+1]*x[j+1];
+        }
+        out[2*k+0] = acc_i;
+        out[2*k+1] = acc_q;
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_fir_decim_generic){
+    register_fir_decim_kernel(&fir_decim_generic, PRIORITY_GENERAL, "generic");
+}
+
+/***********************************************************************
+ * The polyphase fold kernels
+ **********************************************************************/
+typedef std::map<priority_type, pfb_fold_kernel_t> pfb_fold_table_type;
+UHD_SINGLETON_FCN(pfb_fold_table_type, get_registered_pfb_folds);
+
+void uhd::convert::register_pfb_fold_kernel(
+    const pfb_fold_kernel_t kernel, const priority_type prio, const std::string &
+){
+    load_converters();
+    get_registered_pfb_folds()[prio] = kernel;
+}
+
+pfb_fold_kernel_t uhd::convert::get_pfb_fold_kernel(void){
+    load_converters();
+    return get_registered_pfb_folds().rbegin()->second;
+}
+
+static void pfb_fold_generic(
+    const float *in, const float *taps, float *out,
+    const size_t width, const size_t rows
+){
+    for (size_t i = 0; i < width; i++){
+        out[i] = 0.0f;
+    }
+    for (size_t r = 0; r < rows; r++){
+        const float *x = in + r*width;
+        const float *h = taps + r*width;
+        for (size_t i = 0; i < width; i++){
+            out[i] += x[i]*h[i];
+        }
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_pfb_fold_generic){
+    register_pfb_fold_kernel(&pfb_fold_generic, PRIORITY_GENERAL, "generic");
+}
+
+/***********************************************************************
+ * Default taps: a windowed sinc lowpass
+ **********************************************************************/
+//! Taps of the default filter per unit of decimation
+static const size_t DECIM_TAPS_PER_PHASE = 32;
+
+//! Cutoff of the default filter, as a fraction of the output bandwidth
+static const double DECIM_CUTOFF = 0.84;
+
+/*!
+ * A Blackman windowed sinc with unity gain at DC. Its cutoff (at half
+ * the gain) leaves most of the output band flat, and the transition
+ * ends about at the output Nyquist frequency, so there is little
+ * aliasing into the band kept.
+ */
+static std::vector<float> make_default_taps(const size_t decim){
+    static const double pi = std::acos(-1.0);
+    const size_t ntaps = DECIM_TAPS_PER_PHASE*decim;
+    const double cutoff = DECIM_CUTOFF/decim; //in cycles per input sample, times two
+    const double center = (ntaps - 1)/2.0;
+    std::vector<double> taps(ntaps);
+    double sum = 0.0;
+    for (size_t n = 0; n < ntaps; n++){
+        const double window = 0.42
+            - 0.5*std::cos(2*pi*n/(ntaps - 1))
+            + 0.08*std::cos(4*pi*n/(ntaps - 1));
+        const double x = pi*cutoff*(n - center);
+        taps[n] = ((x == 0.0)? 1.0 : std::sin(x)/x)*window;
+        sum += taps[n];
+    }
+    std::vector<float> ftaps(ntaps);
+    for (size_t n = 0; n < ntaps; n++) ftaps[n] = float(taps[n]/sum);
+    return ftaps;
+}
+
+/***********************************************************************
+ * Conversion fused with decimation
+ **********************************************************************/
+//! Input samples per block, so that the filter history stays in the L1 cache
+static const size_t DECIM_BLOCK_SIZE = 1024;
+
+/*!
+ * Convert a block at a time with the best fc32 converter for the input
+ * format, into the end of a history buffer per output, and filter and
+ * decimate each buffer while it is in the cache. The history carries
+ * the last samples of the filter window from one call to the next.
+ */
+class convert_decim : public converter{
+public:
+    convert_decim(const id_type &id, const size_t decim, const std::vector<float> &taps):
+        _decim(decim),
+        _num_outputs(id.num_outputs),
+        _input_stride(get_bytes_per_item(id.input_format)*id.num_outputs),
+        _kernel(get_fir_decim_kernel()),
+        _phase(0)
+    {
+        if (id.output_format != "fc32" or id.num_inputs != 1){
+            throw uhd::value_error(str(boost::format(
+                "host decimation needs a conversion from one input to fc32, not %s") % id.to_string()));
+        }
+        if (decim == 0 or taps.empty()){
+            throw uhd::value_error("host decimation needs a decimation of at least 1 and some taps");
+        }
+        _to_fc32 = get_converter(id)();
+
+        //reverse, pad with leading zeros and duplicate for I and Q
+        _ntaps = FIR_TAPS_ALIGN*((taps.size() + FIR_TAPS_ALIGN - 1)/FIR_TAPS_ALIGN);
+        _taps.resize(2*_ntaps, 0.0f);
+        for (size_t j = 0; j < taps.size(); j++){
+            const size_t k = _ntaps - 1 - j;
+            _taps[2*k+0] = _taps[2*k+1] = taps[j];
+        }
+
+        _history = _ntaps - 1;
+        _buffs.resize(_num_outputs, std::vector<fc32_t>(_history + DECIM_BLOCK_SIZE));
+        _block_ptrs.resize(_num_outputs);
+        for (size_t i = 0; i < _num_outputs; i++) _block_ptrs[i] = &_buffs[i][_history];
+    }
+
+    void set_scalar(const double scalar){
+        _to_fc32->set_scalar(scalar);
+    }
+
+private:
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const char *input = reinterpret_cast<const char *>(inputs[0]);
+        const output_type block(_block_ptrs);
+        size_t nout = 0;
+
+        for (size_t i = 0; i < nsamps; i += DECIM_BLOCK_SIZE){
+            const size_t n = std::min(DECIM_BLOCK_SIZE, nsamps - i);
+            _to_fc32->conv(input + i*_input_stride, block, n);
+
+            //the next output is due at the (_decim - _phase)th sample
+            const size_t first = _decim - 1 - _phase;
+            const size_t n_block_out = (_phase + n)/_decim;
+            for (size_t k = 0; k < _num_outputs; k++){
+                const float *buff = reinterpret_cast<const float *>(&_buffs[k].front());
+                float *out = reinterpret_cast<float *>(outputs[k]) + 2*nout;
+                _kernel(buff + 2*first, out, n_block_out, _decim, &_taps.front(), _ntaps);
+                std::memmove(&_buffs[k].front(), &_buffs[k][n], _history*sizeof(fc32_t));
+            }
+            nout += n_block_out;
+            _phase = (_phase + n) % _decim;
+        }
+    }
+
+    const size_t _decim;
+    const size_t _num_outputs;
+    const size_t _input_stride; //bytes per sample of all outputs
+    const fir_decim_kernel_t _kernel;
+    converter::sptr _to_fc32;
+    std::vector<float> _taps;
+    size_t _ntaps, _history;
+    std::vector<std::vector<fc32_t> > _buffs; //history, then a block
+    std::vector<void *> _block_ptrs;
+    size_t _phase; //samples since the last output
+};
+
+converter::sptr uhd::convert::make_decimator(
+    const id_type &id, const size_t decim, const std::vector<float> &taps
+){
+    return converter::sptr(new convert_decim(
+        id, decim, (taps.empty() and decim != 0)? make_default_taps(decim) : taps));
+}
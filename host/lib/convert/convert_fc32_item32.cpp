@@ -95,7 +95,7 @@ static converter::sptr make_convert_ ## itype ## _1_ ## otype ## _1(void) \
 { \
     return converter::sptr(new fcn<type, conv>()); \
 } \
-UHD_STATIC_BLOCK(register_convert_ ## itype ## _1_ ## otype ## _1) \
+UHD_DEFERRED_BLOCK("convert", register_convert_ ## itype ## _1_ ## otype ## _1) \
 { \
     uhd::convert::id_type id; \
     id.num_inputs = 1; id.num_outputs = 1;  \
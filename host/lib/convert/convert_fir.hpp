@@ -0,0 +1,84 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_FIR_HPP
+#define INCLUDED_LIBUHD_CONVERT_FIR_HPP
+
+#include "convert_common.hpp"
+#include <string>
+
+/***********************************************************************
+ * Decimating FIR kernels for the decimating converters
+ *
+ * A kernel filters interleaved fc32 samples (I, Q, I, Q, ...) and keeps
+ * every decim-th output:
+ *
+ *     out[k] = sum over j < ntaps of taps[j]*in[k*decim + j]
+ *
+ * so `in` starts at the oldest sample of the window of out[0]. The taps
+ * come time reversed (taps[0] weighs the oldest sample), each one twice
+ * in a row, once for I and once for Q. The number of taps is padded
+ * with leading zeros to a multiple of FIR_TAPS_ALIGN, so the kernels
+ * need no tail loop.
+ **********************************************************************/
+namespace uhd{ namespace convert{
+
+    //! Multiple of the number of taps a kernel is called with
+    static const size_t FIR_TAPS_ALIGN = 8;
+
+    typedef void (*fir_decim_kernel_t)(
+        const float *in, float *out, const size_t nout,
+        const size_t decim, const float *taps, const size_t ntaps
+    );
+
+    //! Register a kernel, the one with the highest priority is used
+    void register_fir_decim_kernel(
+        const fir_decim_kernel_t kernel, const priority_type prio, const std::string &name
+    );
+
+    //! Get the kernel with the highest priority
+    fir_decim_kernel_t get_fir_decim_kernel(void);
+
+    //! Get the name of the kernel get_fir_decim_kernel() returns
+    std::string get_fir_decim_kernel_name(void);
+
+    /*!
+     * Polyphase fold kernels, for uhd::rx_channelizer: multiply a window
+     * by the taps and add up its rows,
+     *
+     *     out[i] = sum over r < rows of in[r*width + i]*taps[r*width + i]
+     *
+     * for i < width. The window and taps are fc32 and real taps as for
+     * the decimating kernels, and width counts floats, i.e. twice the
+     * number of samples per row.
+     */
+    typedef void (*pfb_fold_kernel_t)(
+        const float *in, const float *taps, float *out,
+        const size_t width, const size_t rows
+    );
+
+    //! Register a kernel, the one with the highest priority is used
+    void register_pfb_fold_kernel(
+        const pfb_fold_kernel_t kernel, const priority_type prio, const std::string &name
+    );
+
+    //! Get the kernel with the highest priority
+    pfb_fold_kernel_t get_pfb_fold_kernel(void);
+
+}} //namespace
+
+#endif /* INCLUDED_LIBUHD_CONVERT_FIR_HPP */
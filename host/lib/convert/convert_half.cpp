@@ -0,0 +1,154 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_half.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * sc16 and fc32 to half precision
+ **********************************************************************/
+DECLARE_CONVERTER(sc16_item32_le, 1, fc16, 1, PRIORITY_GENERAL){
+    item32_sc16_to_half<uhd::wtohx, float_to_fc16>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(sc16_item32_be, 1, fc16, 1, PRIORITY_GENERAL){
+    item32_sc16_to_half<uhd::ntohx, float_to_fc16>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(sc16_item32_le, 1, bf16, 1, PRIORITY_GENERAL){
+    item32_sc16_to_half<uhd::wtohx, float_to_bf16>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(sc16_item32_be, 1, bf16, 1, PRIORITY_GENERAL){
+    item32_sc16_to_half<uhd::ntohx, float_to_bf16>(
+        reinterpret_cast<const item32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(fc32, 1, fc16, 1, PRIORITY_GENERAL){
+    fc32_to_half<float_to_fc16>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(fc32, 1, bf16, 1, PRIORITY_GENERAL){
+    fc32_to_half<float_to_bf16>(
+        reinterpret_cast<const fc32_t *>(inputs[0]), reinterpret_cast<fc16_t *>(outputs[0]),
+        nsamps, scale_factor
+    );
+}
+
+/***********************************************************************
+ * sc12 to half precision, through fc32
+ **********************************************************************/
+//! Samples per block, so that a block of fc32 stays in the L1 cache
+static const size_t HALF_BLOCK_SIZE = 512;
+
+/*!
+ * Convert with the best fc32 converter for the input format a block at
+ * a time, and narrow each block with the best fc32 to half converter
+ * while it is in the cache.
+ */
+class convert_star_1_to_half_1 : public converter{
+public:
+    convert_star_1_to_half_1(const std::string &input_format, const std::string &output_format):
+        _bytes_per_item(get_bytes_per_item(input_format)),
+        _block(HALF_BLOCK_SIZE)
+    {
+        id_type id;
+        id.input_format = input_format;
+        id.num_inputs = 1;
+        id.output_format = "fc32";
+        id.num_outputs = 1;
+        _to_fc32 = get_converter(id)();
+        id.input_format = "fc32";
+        id.output_format = output_format;
+        _to_half = get_converter(id)();
+        _to_half->set_scalar(1.0);
+    }
+
+    void set_scalar(const double scalar){
+        _to_fc32->set_scalar(scalar);
+    }
+
+private:
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const char *input = reinterpret_cast<const char *>(inputs[0]);
+        fc16_t *output = reinterpret_cast<fc16_t *>(outputs[0]);
+
+        for (size_t i = 0; i < nsamps; i += HALF_BLOCK_SIZE){
+            const size_t n = std::min(HALF_BLOCK_SIZE, nsamps - i);
+            _to_fc32->conv(input + i*_bytes_per_item, &_block.front(), n);
+            _to_half->conv(&_block.front(), output + i, n);
+        }
+    }
+
+    const size_t _bytes_per_item;
+    converter::sptr _to_fc32, _to_half;
+    std::vector<fc32_t> _block;
+};
+
+//the converters are picked when the converter is made, so that all the
+//SIMD ones are registered by then
+static converter::sptr make_convert_sc12_item32_le_1_to_fc16_1(void){
+    return converter::sptr(new convert_star_1_to_half_1("sc12_item32_le", "fc16"));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc16_1(void){
+    return converter::sptr(new convert_star_1_to_half_1("sc12_item32_be", "fc16"));
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_bf16_1(void){
+    return converter::sptr(new convert_star_1_to_half_1("sc12_item32_le", "bf16"));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_bf16_1(void){
+    return converter::sptr(new convert_star_1_to_half_1("sc12_item32_be", "bf16"));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_convert_sc12_to_half){
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc16";
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc16_1, PRIORITY_GENERAL);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc16_1, PRIORITY_GENERAL);
+
+    id.output_format = "bf16";
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_bf16_1, PRIORITY_GENERAL);
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_bf16_1, PRIORITY_GENERAL);
+}
@@ -0,0 +1,110 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_HALF_HPP
+#define INCLUDED_LIBUHD_CONVERT_HALF_HPP
+
+#include "convert_common.hpp"
+#include <cstring>
+
+/***********************************************************************
+ * Half precision CPU formats, as pairs of 16-bit words (I then Q):
+ * - fc16: IEEE 754 binary16
+ * - bf16: bfloat16, the upper half of a float
+ * Both round to nearest even, like the SIMD conversion instructions.
+ **********************************************************************/
+typedef std::complex<uint16_t> fc16_t;
+
+UHD_INLINE uint32_t float_bits(const float num){
+    uint32_t bits;
+    std::memcpy(&bits, &num, sizeof(bits));
+    return bits;
+}
+
+//! Convert a float to IEEE 754 binary16, rounding to nearest even
+UHD_INLINE uint16_t float_to_fc16(const float num){
+    const uint32_t bits = float_bits(num);
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    const uint32_t abs = bits & 0x7fffffff;
+
+    if (abs > 0x7f800000) return uint16_t(sign | 0x7e00 | ((abs >> 13) & 0x3ff)); //NaN, quiet
+    if (abs >= 0x477ff000) return uint16_t(sign | 0x7c00); //rounds to infinity
+    if (abs < 0x33000000) return sign; //rounds to zero
+
+    //subnormal results are units of 2^-24, normal ones rebias the exponent
+    uint32_t half, rem, tie;
+    if (abs < 0x38800000){
+        const uint32_t shift = 126 - (abs >> 23);
+        const uint32_t mant = (abs & 0x7fffff) | 0x800000;
+        half = mant >> shift;
+        rem = mant & ((1u << shift) - 1);
+        tie = 1u << (shift - 1);
+    }
+    else{
+        half = (abs - 0x38000000) >> 13;
+        rem = abs & 0x1fff;
+        tie = 0x1000;
+    }
+    if (rem > tie or (rem == tie and (half & 1))) half++;
+    return uint16_t(sign | half);
+}
+
+//! Convert a float to bfloat16, rounding to nearest even
+UHD_INLINE uint16_t float_to_bf16(const float num){
+    const uint32_t bits = float_bits(num);
+    if ((bits & 0x7fffffff) > 0x7f800000) return uint16_t((bits >> 16) | 0x40); //NaN, quiet
+    return uint16_t((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+/***********************************************************************
+ * Convert items32 sc16 buffer to half precision
+ **********************************************************************/
+template <xtox_t to_host, uint16_t narrow(const float)>
+UHD_INLINE void item32_sc16_to_half(
+    const item32_t *input,
+    fc16_t *output,
+    const size_t nsamps,
+    const double scale_factor
+){
+    for (size_t i = 0; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        output[i] = fc16_t(
+            narrow(int16_t(item >> 16)*float(scale_factor)),
+            narrow(int16_t(item >> 0)*float(scale_factor))
+        );
+    }
+}
+
+/***********************************************************************
+ * Convert fc32 buffer to half precision
+ **********************************************************************/
+template <uint16_t narrow(const float)>
+UHD_INLINE void fc32_to_half(
+    const fc32_t *input,
+    fc16_t *output,
+    const size_t nsamps,
+    const double scale_factor
+){
+    for (size_t i = 0; i < nsamps; i++){
+        output[i] = fc16_t(
+            narrow(input[i].real()*float(scale_factor)),
+            narrow(input[i].imag()*float(scale_factor))
+        );
+    }
+}
+
+#endif /* INCLUDED_LIBUHD_CONVERT_HALF_HPP */
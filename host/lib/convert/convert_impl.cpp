@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "convert_common.hpp"
 #include <uhd/convert.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/static.hpp>
@@ -23,7 +24,23 @@
 #include <stdint.h>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
 #include <complex>
+#include <functional>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #define UHD_CONVERT_CPU_X86
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(__linux__) && (defined(__arm__) || defined(__aarch64__))
+    #define UHD_CONVERT_CPU_ARM_LINUX
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+#endif
 
 using namespace uhd;
 
@@ -31,6 +48,34 @@ convert::converter::~converter(void){
     /* NOP */
 }
 
+void convert::converter::set_correction(const correction_t &){
+    throw uhd::not_implemented_error("this converter does not support a DC offset or IQ correction");
+}
+
+void convert::converter::set_nontemporal(const bool){
+    /* NOP */
+}
+
+void convert::converter::set_power_measurement(const bool enb){
+    if (enb) throw uhd::not_implemented_error("this converter does not support a power measurement");
+}
+
+void convert::converter::get_power(double &peak, double &mean){
+    peak = mean = 0.0;
+}
+
+convert::correction_t::correction_t(void):
+    dc_offset(0.0)
+{
+    iq_matrix[0][0] = 1.0; iq_matrix[0][1] = 0.0;
+    iq_matrix[1][0] = 0.0; iq_matrix[1][1] = 1.0;
+}
+
+void convert::correction_t::set_iq_balance(const std::complex<double> &cor){
+    iq_matrix[0][0] = 1.0 + cor.real(); iq_matrix[0][1] = 0.0;
+    iq_matrix[1][0] = cor.imag();       iq_matrix[1][1] = 1.0;
+}
+
 bool convert::operator==(const convert::id_type &lhs, const convert::id_type &rhs){
     return true
         and (lhs.input_format  == rhs.input_format)
@@ -40,6 +85,15 @@ bool convert::operator==(const convert::id_type &lhs, const convert::id_type &rh
     ;
 }
 
+size_t convert::hash_value(const convert::id_type &id){
+    size_t seed = 0;
+    boost::hash_combine(seed, id.input_format);
+    boost::hash_combine(seed, id.num_inputs);
+    boost::hash_combine(seed, id.output_format);
+    boost::hash_combine(seed, id.num_outputs);
+    return seed;
+}
+
 std::string convert::id_type::to_pp_string(void) const{
     return str(boost::format(
         "conversion ID\n"
@@ -64,11 +118,112 @@ std::string convert::id_type::to_string(void) const{
     );
 }
 
+/***********************************************************************
+ * CPU feature detection for the dispatched converters
+ **********************************************************************/
+#ifdef UHD_CONVERT_CPU_X86
+static void cpuid(const unsigned leaf, unsigned regs[4]){
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, int(leaf), 0);
+    for (size_t i = 0; i < 4; i++) regs[i] = unsigned(info[i]);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+//! The register states the OS saves on context switches (XCR0)
+static uint64_t get_os_states(const unsigned features1_ecx){
+    if ((features1_ecx & (1 << 27)) == 0) return 0; //no OSXSAVE, no xgetbv
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (uint64_t(hi) << 32) | lo;
+#endif
+}
+#endif /* UHD_CONVERT_CPU_X86 */
+
+static unsigned detect_cpu_features(void){
+    unsigned features = 0;
+#if defined(UHD_CONVERT_CPU_X86)
+    unsigned regs[4];
+    cpuid(0, regs);
+    const unsigned max_leaf = regs[0];
+    cpuid(1, regs);
+    const unsigned features1_ecx = regs[2], features1_edx = regs[3];
+    unsigned features7_ebx = 0;
+    if (max_leaf >= 7){
+        cpuid(7, regs);
+        features7_ebx = regs[1];
+    }
+    const uint64_t os_states = get_os_states(features1_ecx);
+    const uint64_t ymm_states = 0x6; //SSE and AVX
+    const uint64_t zmm_states = 0xe6; //and opmask and ZMM
+    const unsigned avx512f_bw = (1 << 16) | (1u << 30);
+
+    if (features1_edx & (1 << 26)) features |= 1 << convert::CPU_FEATURE_SSE2;
+    if (features1_ecx & (1 << 9)) features |= 1 << convert::CPU_FEATURE_SSSE3;
+    if ((os_states & ymm_states) == ymm_states and (features7_ebx & (1 << 5))){
+        features |= 1 << convert::CPU_FEATURE_AVX2;
+    }
+    if ((os_states & zmm_states) == zmm_states and (features7_ebx & avx512f_bw) == avx512f_bw){
+        features |= 1 << convert::CPU_FEATURE_AVX512BW;
+    }
+    if ((os_states & ymm_states) == ymm_states and (features1_ecx & (1 << 29))){
+        features |= 1 << convert::CPU_FEATURE_F16C;
+    }
+#elif defined(UHD_CONVERT_CPU_ARM_LINUX)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    #if defined(__aarch64__)
+        features |= 1 << convert::CPU_FEATURE_NEON; //always there
+        #ifdef HWCAP_SVE
+            if (hwcap & HWCAP_SVE) features |= 1 << convert::CPU_FEATURE_SVE;
+        #endif
+    #elif defined(HWCAP_NEON)
+        if (hwcap & HWCAP_NEON) features |= 1 << convert::CPU_FEATURE_NEON;
+    #endif
+    (void)hwcap;
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    features |= 1 << convert::CPU_FEATURE_NEON; //built for it, no way to ask
+#endif
+    return features;
+}
+
+bool convert::cpu_has_feature(const cpu_feature_t feature){
+    //converters register from static blocks, so detect on first use
+    static const unsigned features = detect_cpu_features();
+    return (features & (1 << feature)) != 0;
+}
+
+std::string convert::cpu_feature_name(const cpu_feature_t feature){
+    switch(feature){
+    case CPU_FEATURE_SSE2: return "sse2";
+    case CPU_FEATURE_SSSE3: return "ssse3";
+    case CPU_FEATURE_AVX2: return "avx2";
+    case CPU_FEATURE_AVX512BW: return "avx512bw";
+    case CPU_FEATURE_F16C: return "f16c";
+    case CPU_FEATURE_NEON: return "neon";
+    case CPU_FEATURE_SVE: return "sve";
+    }
+    return "unknown";
+}
+
 /***********************************************************************
  * Setup the table registry
  **********************************************************************/
-typedef uhd::dict<convert::id_type, uhd::dict<convert::priority_type, convert::function_type> > fcn_table_type;
-UHD_SINGLETON_FCN(fcn_table_type, get_table);
+struct converter_entry_t{
+    convert::function_type fcn;
+    std::string name;
+};
+typedef uhd::dict<convert::id_type, uhd::dict<convert::priority_type, converter_entry_t> > fcn_table_type;
+UHD_SINGLETON_FCN(fcn_table_type, get_registered_table);
+
+static fcn_table_type &get_table(void){
+    load_converters();
+    return get_registered_table();
+}
 
 /***********************************************************************
  * The registry functions
@@ -78,11 +233,23 @@ void uhd::convert::register_converter(
     const function_type &fcn,
     const priority_type prio
 ){
-    get_table()[id][prio] = fcn;
+    register_converter(id, fcn, prio,
+        (prio == PRIORITY_GENERAL)? "generic" : str(boost::format("prio %d") % prio));
+}
+
+void uhd::convert::register_converter(
+    const id_type &id,
+    const function_type &fcn,
+    const priority_type prio,
+    const std::string &name
+){
+    converter_entry_t &entry = get_table()[id][prio];
+    entry.fcn = fcn;
+    entry.name = name;
 
     //----------------------------------------------------------------//
     UHD_LOGV(always) << "register_converter: " << id.to_pp_string() << std::endl
-        << "    prio: " << prio << std::endl
+        << "    prio: " << prio << " (" << name << ")" << std::endl
         << std::endl
     ;
     //----------------------------------------------------------------//
@@ -91,16 +258,16 @@ void uhd::convert::register_converter(
 /***********************************************************************
  * The converter functions
  **********************************************************************/
-convert::function_type convert::get_converter(
-    const id_type &id,
-    const priority_type prio
+static const converter_entry_t &find_converter(
+    const convert::id_type &id,
+    const convert::priority_type prio
 ){
     if (not get_table().has_key(id)) throw uhd::key_error(
         "Cannot find a conversion routine for " + id.to_pp_string());
 
     //find a matching priority
-    priority_type best_prio = -1;
-    BOOST_FOREACH(priority_type prio_i, get_table()[id].keys()){
+    convert::priority_type best_prio = -1;
+    BOOST_FOREACH(convert::priority_type prio_i, get_table()[id].keys()){
         if (prio_i == prio) {
             //----------------------------------------------------------------//
             UHD_LOGV(always) << "get_converter: For converter ID: " << id.to_pp_string() << std::endl
@@ -128,11 +295,58 @@ convert::function_type convert::get_converter(
     return get_table()[id][best_prio];
 }
 
+convert::function_type convert::get_converter(
+    const id_type &id,
+    const priority_type prio
+){
+    return find_converter(id, prio).fcn;
+}
+
+std::string convert::get_converter_name(
+    const id_type &id,
+    const priority_type prio
+){
+    return find_converter(id, prio).name;
+}
+
+convert::function_type convert::get_converter_with_correction(const id_type &id){
+    //ask the converters themselves, best first
+    BOOST_FOREACH(const priority_type prio, get_converter_priorities(id)){
+        const function_type &fcn = get_table()[id][prio].fcn;
+        try{
+            fcn()->set_correction(correction_t());
+            return fcn;
+        }
+        catch(const uhd::not_implemented_error &){
+            continue;
+        }
+    }
+    throw uhd::key_error(
+        "Cannot find a conversion routine with DC offset and IQ correction for " + id.to_pp_string());
+}
+
+std::vector<convert::id_type> convert::get_converter_ids(void){
+    return get_table().keys();
+}
+
+std::vector<convert::priority_type> convert::get_converter_priorities(const id_type &id){
+    if (not get_table().has_key(id)) throw uhd::key_error(
+        "Cannot find a conversion routine for " + id.to_pp_string());
+    std::vector<priority_type> prios = get_table()[id].keys();
+    std::sort(prios.begin(), prios.end(), std::greater<priority_type>());
+    return prios;
+}
+
 /***********************************************************************
  * Mappings for item format to byte size for all items we can
  **********************************************************************/
 typedef uhd::dict<std::string, size_t> item_size_type;
-UHD_SINGLETON_FCN(item_size_type, get_item_size_table);
+UHD_SINGLETON_FCN(item_size_type, get_registered_item_sizes);
+
+static item_size_type &get_item_size_table(void){
+    load_converters();
+    return get_registered_item_sizes();
+}
 
 void convert::register_bytes_per_item(
     const std::string &format, const size_t size
@@ -155,7 +369,14 @@ size_t convert::get_bytes_per_item(const std::string &format){
     throw uhd::key_error("Cannot find an item size:\n" + format);
 }
 
-UHD_STATIC_BLOCK(convert_register_item_sizes){
+size_t convert::get_num_planes(const std::string &format){
+    static const std::string suffix = "_planar";
+    const bool planar = format.size() > suffix.size()
+        and format.compare(format.size() - suffix.size(), suffix.size(), suffix) == 0;
+    return planar? 2 : 1;
+}
+
+UHD_DEFERRED_BLOCK("convert", convert_register_item_sizes){
     //register standard complex types
     convert::register_bytes_per_item("fc64", sizeof(std::complex<double>));
     convert::register_bytes_per_item("fc32", sizeof(std::complex<float>));
@@ -173,6 +394,13 @@ UHD_STATIC_BLOCK(convert_register_item_sizes){
     convert::register_bytes_per_item("s8", sizeof(int8_t));
     convert::register_bytes_per_item("u8", sizeof(uint8_t));
 
+    //register half precision complex types: IEEE 754 binary16 and bfloat16
+    convert::register_bytes_per_item("fc16", 2*sizeof(uint16_t));
+    convert::register_bytes_per_item("bf16", 2*sizeof(uint16_t));
+
+    //register planar types, by the size of one component
+    convert::register_bytes_per_item("fc32_planar", sizeof(float));
+
     //register VITA types
     convert::register_bytes_per_item("item32", sizeof(int32_t));
 }
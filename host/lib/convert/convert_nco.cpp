@@ -0,0 +1,65 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_nco.hpp"
+#include <uhd/utils/static.hpp>
+#include <map>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * The kernel registry
+ **********************************************************************/
+struct nco_entry_t{
+    nco_kernel_t kernel;
+    std::string name;
+};
+typedef std::map<priority_type, nco_entry_t> nco_table_type;
+UHD_SINGLETON_FCN(nco_table_type, get_registered_ncos);
+
+static nco_table_type &get_nco_table(void){
+    load_converters();
+    return get_registered_ncos();
+}
+
+void uhd::convert::register_nco_kernel(
+    const nco_kernel_t kernel, const priority_type prio, const std::string &name
+){
+    nco_entry_t &entry = get_nco_table()[prio];
+    entry.kernel = kernel;
+    entry.name = name;
+}
+
+nco_kernel_t uhd::convert::get_nco_kernel(void){
+    return get_nco_table().rbegin()->second.kernel;
+}
+
+std::string uhd::convert::get_nco_kernel_name(void){
+    return get_nco_table().rbegin()->second.name;
+}
+
+static void nco_generic(
+    const uint32_t *phase, float *out, const size_t nsamps, const float ampl
+){
+    for (size_t k = 0; k < nsamps; k++){
+        nco_add_sample(phase[k], out+2*k, ampl);
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_nco_generic){
+    register_nco_kernel(&nco_generic, PRIORITY_GENERAL, "generic");
+}
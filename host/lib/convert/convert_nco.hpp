@@ -0,0 +1,91 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_NCO_HPP
+#define INCLUDED_LIBUHD_CONVERT_NCO_HPP
+
+#include "convert_common.hpp"
+#include <string>
+
+/***********************************************************************
+ * Oscillator kernels for uhd::waveform_source
+ *
+ * A kernel adds a complex exponential to interleaved fc32 samples:
+ *
+ *     out[k] += ampl*(cos(theta[k]), sin(theta[k]))
+ *
+ * with theta[k] = 2*pi*phase[k]/2^32, so a full turn is the whole range
+ * of a uint32_t. The sine and cosine come from the same polynomials in
+ * every kernel, so their results only differ by rounding.
+ **********************************************************************/
+namespace uhd{ namespace convert{
+
+    typedef void (*nco_kernel_t)(
+        const uint32_t *phase, float *out, const size_t nsamps, const float ampl
+    );
+
+    //! Register a kernel, the one with the highest priority is used
+    void register_nco_kernel(
+        const nco_kernel_t kernel, const priority_type prio, const std::string &name
+    );
+
+    //! Get the kernel with the highest priority
+    nco_kernel_t get_nco_kernel(void);
+
+    //! Get the name of the kernel get_nco_kernel() returns
+    std::string get_nco_kernel_name(void);
+
+    /*!
+     * Polynomials for a quarter turn around zero, |theta| <= pi/4.
+     * Truncated Taylor series: the errors are below 4e-7 for the sine
+     * and 3e-8 for the cosine, less than float resolution near 1.
+     */
+    static const float NCO_SIN_C3 = -1.0f/6;
+    static const float NCO_SIN_C5 = 1.0f/120;
+    static const float NCO_SIN_C7 = -1.0f/5040;
+    static const float NCO_COS_C2 = -1.0f/2;
+    static const float NCO_COS_C4 = 1.0f/24;
+    static const float NCO_COS_C6 = -1.0f/720;
+    static const float NCO_COS_C8 = 1.0f/40320;
+
+    //! Radians per unit of the phase
+    static const float NCO_RAD_PER_LSB = 1.4629180792671596e-09f; //2*pi/2^32
+
+    /*!
+     * Add one sample, as the kernels do, e.g. for the tail of a SIMD kernel.
+     * The phase is split into the nearest quarter turn and the offset from
+     * it, so the polynomials only see |theta| <= pi/4. The quarter turn then
+     * swaps and negates the sine and cosine.
+     */
+    static inline void nco_add_sample(const uint32_t phase, float *out, const float ampl){
+        const uint32_t t = phase + 0x20000000;
+        const uint32_t quad = t >> 30;
+        const float x = float(int32_t(t & 0x3fffffff) - 0x20000000)*NCO_RAD_PER_LSB;
+        const float x2 = x*x;
+        const float s = x*(1.0f + x2*(NCO_SIN_C3 + x2*(NCO_SIN_C5 + x2*NCO_SIN_C7)));
+        const float c = 1.0f + x2*(NCO_COS_C2 + x2*(NCO_COS_C4 + x2*(NCO_COS_C6 + x2*NCO_COS_C8)));
+        float i = (quad & 1)? s : c;
+        float q = (quad & 1)? c : s;
+        if ((quad + 1) & 2) i = -i;
+        if (quad & 2) q = -q;
+        out[0] += ampl*i;
+        out[1] += ampl*q;
+    }
+
+}} //namespace
+
+#endif /* INCLUDED_LIBUHD_CONVERT_NCO_HPP */
@@ -0,0 +1,72 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_NEON_HPP
+#define INCLUDED_LIBUHD_CONVERT_NEON_HPP
+
+#include "convert_common.hpp"
+#include <arm_neon.h>
+
+/***********************************************************************
+ * Helpers of the NEON converters. They only use ARMv7 NEON, so the
+ * same sources build for 32-bit ARM and AArch64.
+ **********************************************************************/
+
+//! Gather bytes by a 16 byte control, like pshufb: an index of -1 gives 0
+static inline uint8x16_t neon_shuffle(const uint8x16_t &in, const uint8x16_t &ctrl)
+{
+#if defined(__aarch64__)
+    return vqtbl1q_u8(in, ctrl);
+#else
+    uint8x8x2_t table;
+    table.val[0] = vget_low_u8(in);
+    table.val[1] = vget_high_u8(in);
+    return vcombine_u8(vtbl2_u8(table, vget_low_u8(ctrl)), vtbl2_u8(table, vget_high_u8(ctrl)));
+#endif
+}
+
+//! Load a byte control like SC12_UNPACK_LE
+static inline uint8x16_t neon_load_ctrl(const int8_t *ctrl)
+{
+    return vreinterpretq_u8_s8(vld1q_s8(ctrl));
+}
+
+//! Sign extend 8 16-bit numbers, convert and scale them
+static inline void neon_s16_to_f32(
+    const int16x8_t &in, float32x4_t &lo, float32x4_t &hi, const float32x4_t &scalar
+){
+    lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), scalar);
+    hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), scalar);
+}
+
+//! Scale 8 floats, truncate and saturate them to 16 bits
+static inline int16x8_t neon_f32_to_s16(
+    const float32x4_t &lo, const float32x4_t &hi, const float32x4_t &scalar
+){
+    return vcombine_s16(
+        vqmovn_s32(vcvtq_s32_f32(vmulq_f32(lo, scalar))),
+        vqmovn_s32(vcvtq_s32_f32(vmulq_f32(hi, scalar)))
+    );
+}
+
+//! Swap the bytes of each 16-bit number: sc16 <-> sc16_item32_be
+static inline int16x8_t neon_swap_bytes(const int16x8_t &in)
+{
+    return vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(in)));
+}
+
+#endif /* INCLUDED_LIBUHD_CONVERT_NEON_HPP */
@@ -0,0 +1,147 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * sc16 to planar fc32
+ **********************************************************************/
+template <xtox_t to_host>
+UHD_INLINE void item32_sc16_to_fc32_planar(
+    const item32_t *input,
+    float *output_i,
+    float *output_q,
+    const size_t nsamps,
+    const double scale_factor
+){
+    for (size_t i = 0; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        output_i[i] = float(int16_t(item >> 16)*float(scale_factor));
+        output_q[i] = float(int16_t(item >> 0)*float(scale_factor));
+    }
+}
+
+DECLARE_CONVERTER(sc16_item32_le, 1, fc32_planar, 2, PRIORITY_GENERAL){
+    item32_sc16_to_fc32_planar<uhd::wtohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]),
+        reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CONVERTER(sc16_item32_be, 1, fc32_planar, 2, PRIORITY_GENERAL){
+    item32_sc16_to_fc32_planar<uhd::ntohx>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]),
+        reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor
+    );
+}
+
+/***********************************************************************
+ * Other formats to planar fc32, through the interleaved converters
+ **********************************************************************/
+//! Samples per block, so that a block of fc32 stays in the L1 cache
+static const size_t PLANAR_BLOCK_SIZE = 512;
+
+/*!
+ * Convert with the best interleaved fc32 converter for the input format,
+ * a block at a time, and split each block into I and Q while it is in
+ * the cache. So the formats that pack samples (sc8, sc12) get planar
+ * output at the speed of their SIMD converters.
+ */
+class convert_star_1_to_fc32_planar_2 : public converter{
+public:
+    convert_star_1_to_fc32_planar_2(const std::string &input_format):
+        _bytes_per_item(get_bytes_per_item(input_format)),
+        _block(PLANAR_BLOCK_SIZE)
+    {
+        id_type id;
+        id.input_format = input_format;
+        id.num_inputs = 1;
+        id.output_format = "fc32";
+        id.num_outputs = 1;
+        _converter = get_converter(id)();
+    }
+
+    void set_scalar(const double scalar){
+        _converter->set_scalar(scalar);
+    }
+
+private:
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const char *input = reinterpret_cast<const char *>(inputs[0]);
+        float *output_i = reinterpret_cast<float *>(outputs[0]);
+        float *output_q = reinterpret_cast<float *>(outputs[1]);
+
+        for (size_t i = 0; i < nsamps; i += PLANAR_BLOCK_SIZE){
+            const size_t n = std::min(PLANAR_BLOCK_SIZE, nsamps - i);
+            _converter->conv(input + i*_bytes_per_item, &_block.front(), n);
+            for (size_t j = 0; j < n; j++){
+                output_i[i+j] = _block[j].real();
+                output_q[i+j] = _block[j].imag();
+            }
+        }
+    }
+
+    const size_t _bytes_per_item;
+    converter::sptr _converter;
+    std::vector<fc32_t> _block;
+};
+
+//the interleaved converter is picked when the converter is made, so that
+//all the SIMD ones are registered by then
+static converter::sptr make_convert_sc8_item32_le_1_to_fc32_planar_2(void){
+    return converter::sptr(new convert_star_1_to_fc32_planar_2("sc8_item32_le"));
+}
+
+static converter::sptr make_convert_sc8_item32_be_1_to_fc32_planar_2(void){
+    return converter::sptr(new convert_star_1_to_fc32_planar_2("sc8_item32_be"));
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_planar_2(void){
+    return converter::sptr(new convert_star_1_to_fc32_planar_2("sc12_item32_le"));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_planar_2(void){
+    return converter::sptr(new convert_star_1_to_fc32_planar_2("sc12_item32_be"));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_convert_planar){
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.output_format = "fc32_planar";
+    id.num_outputs = 2;
+
+    id.input_format = "sc8_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_fc32_planar_2, PRIORITY_GENERAL);
+
+    id.input_format = "sc8_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_fc32_planar_2, PRIORITY_GENERAL);
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_planar_2, PRIORITY_GENERAL);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_planar_2, PRIORITY_GENERAL);
+}
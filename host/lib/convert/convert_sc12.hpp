@@ -0,0 +1,399 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_SC12_HPP
+#define INCLUDED_LIBUHD_CONVERT_SC12_HPP
+
+#include "convert_common.hpp"
+
+typedef uint32_t (*tohost32_type)(uint32_t);
+typedef uint32_t (*towire32_type)(uint32_t);
+
+/* C language specification requires this to be packed
+ * (i.e., line0, line1, line2 will be in adjacent memory locations).
+ * If this was not true, we'd need compiler flags here to specify
+ * alignment/packing.
+ */
+struct item32_sc12_3x
+{
+    item32_t line0;
+    item32_t line1;
+    item32_t line2;
+};
+
+enum item32_sc12_3x_enable {
+    CONVERT12_LINE0 = 0x01,
+    CONVERT12_LINE1 = 0x02,
+    CONVERT12_LINE2 = 0x04,
+    CONVERT12_LINE_ALL = 0x07,
+};
+
+/***********************************************************************
+ * sc12 byte gathers within one 3 line block (12 bytes), as 16 byte
+ * controls for the byte shuffles of SSSE3 (pshufb) and NEON (tbl):
+ * an index of -1 gives a zero byte
+ **********************************************************************/
+//! Unpack: 8 16-bit lanes, each with the 2 bytes a 12-bit number lies in
+#define SC12_UNPACK_BE  1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+#define SC12_UNPACK_LE  2, 3, 1, 2, 7, 0, 6, 7, 4, 5, 11, 4, 9, 10, 8, 9
+//! Pack: 4 32-bit lanes, each with a 24-bit I/Q pair, into the 12 bytes
+#define SC12_PACK_BE    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+#define SC12_PACK_LE    6, 0, 1, 2, 9, 10, 4, 5, 12, 13, 14, 8, -1, -1, -1, -1
+
+/*
+ * Scaling of one number.
+ * Floats are scaled in float precision, like the SIMD converters do,
+ * so all of them give the same results. sc16 is not scaled: the 12 bits
+ * are the upper bits of the 16-bit number, the lower 4 bits are zero on
+ * unpacking and dropped on packing.
+ */
+template <typename type>
+UHD_INLINE type unpack_sc12_scale(const int16_t num, const double scalar)
+{
+    return type(num)*type(scalar);
+}
+
+template <>
+UHD_INLINE int16_t unpack_sc12_scale(const int16_t num, const double)
+{
+    return num;
+}
+
+template <typename type>
+UHD_INLINE item32_t pack_sc12_scale(const type num, const double scalar)
+{
+    return int32_t(num*type(scalar)) & 0xfff;
+}
+
+template <>
+UHD_INLINE item32_t pack_sc12_scale(const int16_t num, const double)
+{
+    return item32_t(num >> 4) & 0xfff;
+}
+
+/*
+ * convert_sc12_item32_3_to_star_4 takes in 3 lines with 32 bit each
+ * and converts them 4 samples of type 'std::complex<type>'.
+ * The structure of the 3 lines is as follows:
+ *  _ _ _ _ _ _ _ _
+ * |_ _ _1_ _ _|_ _|
+ * |_2_ _ _|_ _ _3_|
+ * |_ _|_ _ _4_ _ _|
+ *
+ * The numbers mark the position of one complex sample.
+ */
+template <typename type, tohost32_type tohost>
+void convert_sc12_item32_3_to_star_4
+(
+    const item32_sc12_3x &input,
+    std::complex<type> &out0,
+    std::complex<type> &out1,
+    std::complex<type> &out2,
+    std::complex<type> &out3,
+    const double scalar
+)
+{
+    //step 0: extract the lines from the input buffer
+    const item32_t line0 = tohost(input.line0);
+    const item32_t line1 = tohost(input.line1);
+    const item32_t line2 = tohost(input.line2);
+    const uint64_t line01 = (uint64_t(line0) << 32) | line1;
+    const uint64_t line12 = (uint64_t(line1) << 32) | line2;
+
+    //step 1: shift out and mask off the individual numbers
+    const type i0 = unpack_sc12_scale<type>(int16_t((line0 >> 16) & 0xfff0), scalar);
+    const type q0 = unpack_sc12_scale<type>(int16_t((line0 >> 4) & 0xfff0), scalar);
+
+    const type i1 = unpack_sc12_scale<type>(int16_t((line01 >> 24) & 0xfff0), scalar);
+    const type q1 = unpack_sc12_scale<type>(int16_t((line1 >> 12) & 0xfff0), scalar);
+
+    const type i2 = unpack_sc12_scale<type>(int16_t((line1 >> 0) & 0xfff0), scalar);
+    const type q2 = unpack_sc12_scale<type>(int16_t((line12 >> 20) & 0xfff0), scalar);
+
+    const type i3 = unpack_sc12_scale<type>(int16_t((line2 >> 8) & 0xfff0), scalar);
+    const type q3 = unpack_sc12_scale<type>(int16_t((line2 << 4) & 0xfff0), scalar);
+
+    //step 2: load the outputs
+    out0 = std::complex<type>(i0, q0);
+    out1 = std::complex<type>(i1, q1);
+    out2 = std::complex<type>(i2, q2);
+    out3 = std::complex<type>(i3, q3);
+}
+
+/*
+ * Packed 12-bit converter with selective line enable
+ *
+ * The converter operates on 4 complex inputs and selectively writes to one to
+ * three 32-bit lines. Line selection allows for partial writes of less than
+ * 4 complex samples, or a full 3 x 32-bit struct. Writes are always full 32-bit
+ * lines, so in the case of partial writes, the number of bytes written will
+ * exceed the the number of bytes filled by actual samples.
+ *
+ *  _ _ _ _ _ _ _ _
+ * |_ _ _1_ _ _|_ _| 0
+ * |_2_ _ _|_ _ _3_|
+ * |_ _|_ _ _4_ _ _| 2
+ * 31              0
+ */
+template <typename type, towire32_type towire>
+void convert_star_4_to_sc12_item32_3
+(
+    const std::complex<type> &in0,
+    const std::complex<type> &in1,
+    const std::complex<type> &in2,
+    const std::complex<type> &in3,
+    const int enable,
+    item32_sc12_3x &output,
+    const double scalar
+)
+{
+    const item32_t i0 = pack_sc12_scale<type>(in0.real(), scalar);
+    const item32_t q0 = pack_sc12_scale<type>(in0.imag(), scalar);
+
+    const item32_t i1 = pack_sc12_scale<type>(in1.real(), scalar);
+    const item32_t q1 = pack_sc12_scale<type>(in1.imag(), scalar);
+
+    const item32_t i2 = pack_sc12_scale<type>(in2.real(), scalar);
+    const item32_t q2 = pack_sc12_scale<type>(in2.imag(), scalar);
+
+    const item32_t i3 = pack_sc12_scale<type>(in3.real(), scalar);
+    const item32_t q3 = pack_sc12_scale<type>(in3.imag(), scalar);
+
+    const item32_t line0 = (i0 << 20) | (q0 << 8) | (i1 >> 4);
+    const item32_t line1 = (i1 << 28) | (q1 << 16) | (i2 << 4) | (q2 >> 8);
+    const item32_t line2 = (q2 << 24) | (i3 << 12) | (q3);
+
+    if (enable & CONVERT12_LINE0)
+        output.line0 = towire(line0);
+    if (enable & CONVERT12_LINE1)
+        output.line1 = towire(line1);
+    if (enable & CONVERT12_LINE2)
+        output.line2 = towire(line2);
+}
+
+template <typename type, tohost32_type tohost>
+struct convert_sc12_item32_1_to_star_1 : public uhd::convert::converter
+{
+    /*!
+     * Converts whole 3 line blocks, e.g. with SIMD instructions.
+     * It may convert fewer blocks than it is given (but may read one
+     * block further), and returns how many it converted.
+     */
+    typedef size_t (*body_type)(const item32_sc12_3x *input, std::complex<type> *output, const size_t nblocks, const double scalar);
+
+    convert_sc12_item32_1_to_star_1(const body_type body = NULL):_scalar(0.0), _body(body)
+    {
+        //NOP
+    }
+
+    void set_scalar(const double scalar)
+    {
+        const int unpack_growth = 16;
+        _scalar = scalar/unpack_growth;
+    }
+
+    /*
+     * This converter takes in 24 bits complex samples, 12 bits I and 12 bits Q, and converts them to type 'std::complex<type>'.
+     * 'type' is usually 'float'.
+     * For the converter to work correctly the used managed_buffer which holds all samples of one packet has to be 32 bits aligned.
+     * We assume 32 bits to be one line. This said the converter must be aware where it is supposed to start within 3 lines.
+     *
+     */
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps)
+    {
+        /*
+         * Looking at the line structure above we can identify 4 cases.
+         * Each corresponds to the start of a different sample within a 3 line block.
+         * head_samps derives the number of samples left within one block.
+         * Then the number of bytes the converter has to rewind are calculated.
+         */
+        const size_t head_samps = size_t(inputs[0]) & 0x3;
+        size_t rewind = 0;
+        switch(head_samps)
+        {
+            case 0: break;
+            case 1: rewind = 9; break;
+            case 2: rewind = 6; break;
+            case 3: rewind = 3; break;
+        }
+
+        /*
+         * The pointer *input now points to the head of a 3 line block.
+         */
+        const item32_sc12_3x *input = reinterpret_cast<const item32_sc12_3x *>(size_t(inputs[0]) - rewind);
+        std::complex<type> *output = reinterpret_cast<std::complex<type> *>(outputs[0]);
+
+        //helper variables
+        std::complex<type> dummy0, dummy1, dummy2;
+        size_t i = 0, o = 0;
+
+        /*
+         * handle the head case
+         * head_samps holds the number of samples left in a block.
+         * The 3 line converter is called for the whole block and already processed samples are dumped.
+         * We don't run into the risk of a SIGSEGV because input will always point to valid memory within a managed_buffer.
+         * Furthermore the bytes in a buffer remain unchanged after they have been copied into it.
+         */
+        switch (head_samps)
+        {
+        case 0: break; //no head
+        case 1: convert_sc12_item32_3_to_star_4<type, tohost>(input[i++], dummy0, dummy1, dummy2, output[0], _scalar); break;
+        case 2: convert_sc12_item32_3_to_star_4<type, tohost>(input[i++], dummy0, dummy1, output[0], output[1], _scalar); break;
+        case 3: convert_sc12_item32_3_to_star_4<type, tohost>(input[i++], dummy0, output[0], output[1], output[2], _scalar); break;
+        }
+        o += head_samps;
+
+        //convert the body, as much as possible in whole blocks
+        if (_body != NULL and o < nsamps)
+        {
+            const size_t nblocks = _body(input+i, output+o, (nsamps-o)/4, _scalar);
+            i += nblocks; o += 4*nblocks;
+        }
+        while (o+3 < nsamps)
+        {
+            convert_sc12_item32_3_to_star_4<type, tohost>(input[i], output[o+0], output[o+1], output[o+2], output[o+3], _scalar);
+            i++; o += 4;
+        }
+
+        /*
+         * handle the tail case
+         * The converter can be called with any number of samples to be converted.
+         * This can end up in only a part of a block to be converted in one call.
+         * We never have to worry about SIGSEGVs here as long as we end in the middle of a managed_buffer.
+         * If we are at the end of managed_buffer there are 2 precautions to prevent SIGSEGVs.
+         * Firstly only a read operation is performed.
+         * Secondly managed_buffers allocate a fixed size memory which is always larger than the actually used size.
+         * e.g. The current sample maximum is 2000 samples in a packet over USB.
+         * With sc12 samples a packet consists of 6000kb but managed_buffers allocate 16kb each.
+         * Thus we don't run into problems here either.
+         */
+        const size_t tail_samps = nsamps - o;
+        switch (tail_samps)
+        {
+        case 0: break; //no tail
+        case 1: convert_sc12_item32_3_to_star_4<type, tohost>(input[i], output[o+0], dummy0, dummy1, dummy2, _scalar); break;
+        case 2: convert_sc12_item32_3_to_star_4<type, tohost>(input[i], output[o+0], output[o+1], dummy1, dummy2, _scalar); break;
+        case 3: convert_sc12_item32_3_to_star_4<type, tohost>(input[i], output[o+0], output[o+1], output[o+2], dummy2, _scalar); break;
+        }
+    }
+
+    double _scalar;
+    const body_type _body;
+};
+
+template <typename type, towire32_type towire>
+struct convert_star_1_to_sc12_item32_1 : public uhd::convert::converter
+{
+    /*!
+     * Converts whole 3 line blocks, e.g. with SIMD instructions.
+     * It may convert fewer blocks than it is given (but may write past
+     * the blocks it converted, into the ones it was given), and returns
+     * how many it converted.
+     */
+    typedef size_t (*body_type)(const std::complex<type> *input, item32_sc12_3x *output, const size_t nblocks, const double scalar);
+
+    convert_star_1_to_sc12_item32_1(const body_type body = NULL):_scalar(0.0), _body(body)
+    {
+        //NOP
+    }
+
+    void set_scalar(const double scalar)
+    {
+        _scalar = scalar;
+    }
+
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps)
+    {
+        const std::complex<type> *input = reinterpret_cast<const std::complex<type> *>(inputs[0]);
+
+        /*
+         * Effectively outputs will point to a managed_buffer instance. These buffers are 32 bit aligned.
+         * For a detailed description see comments in 'convert_unpack_sc12.cpp'.
+         */
+        const size_t head_samps = size_t(outputs[0]) & 0x3;
+        int enable;
+        size_t rewind = 0;
+        switch(head_samps)
+        {
+            case 0: break;
+            case 1: rewind = 9; break;
+            case 2: rewind = 6; break;
+            case 3: rewind = 3; break;
+        }
+        item32_sc12_3x *output = reinterpret_cast<item32_sc12_3x *>(size_t(outputs[0]) - rewind);
+
+        //helper variables
+        size_t i = 0, o = 0;
+
+        //handle the head case
+        switch (head_samps)
+        {
+        case 0:
+            break; //no head
+        case 1:
+            enable = CONVERT12_LINE2;
+            convert_star_4_to_sc12_item32_3<type, towire>(0, 0, 0, input[0], enable, output[o++], _scalar);
+            break;
+        case 2:
+            enable = CONVERT12_LINE2 | CONVERT12_LINE1;
+            convert_star_4_to_sc12_item32_3<type, towire>(0, 0, input[0], input[1], enable, output[o++], _scalar);
+            break;
+        case 3:
+            enable = CONVERT12_LINE2 | CONVERT12_LINE1 | CONVERT12_LINE0;
+            convert_star_4_to_sc12_item32_3<type, towire>(0, input[0], input[1], input[2], enable, output[o++], _scalar);
+            break;
+        }
+        i += head_samps;
+
+        //convert the body, as much as possible in whole blocks
+        if (_body != NULL and i < nsamps)
+        {
+            const size_t nblocks = _body(input+i, output+o, (nsamps-i)/4, _scalar);
+            o += nblocks; i += 4*nblocks;
+        }
+        while (i+3 < nsamps)
+        {
+            convert_star_4_to_sc12_item32_3<type, towire>(input[i+0], input[i+1], input[i+2], input[i+3], CONVERT12_LINE_ALL, output[o], _scalar);
+            o++; i += 4;
+        }
+
+        //handle the tail case
+        const size_t tail_samps = nsamps - i;
+        switch (tail_samps)
+        {
+        case 0:
+            break; //no tail
+        case 1:
+            enable = CONVERT12_LINE0;
+            convert_star_4_to_sc12_item32_3<type, towire>(input[i+0], 0, 0, 0, enable, output[o], _scalar);
+            break;
+        case 2:
+            enable = CONVERT12_LINE0 | CONVERT12_LINE1;
+            convert_star_4_to_sc12_item32_3<type, towire>(input[i+0], input[i+1], 0, 0, enable, output[o], _scalar);
+            break;
+        case 3:
+            enable = CONVERT12_LINE0 | CONVERT12_LINE1 | CONVERT12_LINE2;
+            convert_star_4_to_sc12_item32_3<type, towire>(input[i+0], input[i+1], input[i+2], 0, enable, output[o], _scalar);
+            break;
+        }
+    }
+
+    double _scalar;
+    const body_type _body;
+};
+
+#endif /* INCLUDED_LIBUHD_CONVERT_SC12_HPP */
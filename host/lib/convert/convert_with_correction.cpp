@@ -0,0 +1,53 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_correction.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+template <xtox_t to_host>
+class convert_sc16_item32_1_to_fc32_1_corrected : public converter_with_correction{
+private:
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+        fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+        if (_measure_power) item32_sc16_to_fc32_corrected<to_host, true>(input, output, nsamps, _coeffs, _power);
+        else item32_sc16_to_fc32_corrected<to_host, false>(input, output, nsamps, _coeffs, _power);
+    }
+};
+
+static converter::sptr make_convert_sc16_item32_le_1_to_fc32_1_corrected(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected<uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc16_item32_be_1_to_fc32_1_corrected(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected<uhd::ntohx>());
+}
+
+UHD_DEFERRED_BLOCK("convert", register_convert_with_correction){
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc32_1_corrected, PRIORITY_CORRECTION, "correction");
+
+    id.input_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc32_1_corrected, PRIORITY_CORRECTION, "correction");
+}
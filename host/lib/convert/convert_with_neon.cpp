@@ -19,15 +19,30 @@
 #include <uhd/utils/byteswap.hpp>
 #include <arm_neon.h>
 
+#if defined(__aarch64__)
+//convert_neon.S is 32-bit ARM assembly, the same swap of 16 samples at a time
+static void neon_item32_sc16_swap_16n(void *in, void *out, int iter)
+{
+    const int16_t *input = reinterpret_cast<const int16_t *>(in);
+    int16_t *output = reinterpret_cast<int16_t *>(out);
+    for (; iter > 0; iter--, input += 32, output += 32) {
+        vst1q_s16(output+0, vrev32q_s16(vld1q_s16(input+0)));
+        vst1q_s16(output+8, vrev32q_s16(vld1q_s16(input+8)));
+        vst1q_s16(output+16, vrev32q_s16(vld1q_s16(input+16)));
+        vst1q_s16(output+24, vrev32q_s16(vld1q_s16(input+24)));
+    }
+}
+#else
 extern "C" {
 void neon_item32_sc16_swap_16n(void *, void *, int iter);
 }
+#endif
 
 static const int SIMD_WIDTH = 16;
 
 using namespace uhd::convert;
 
-DECLARE_CONVERTER(fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
     const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
     item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
 
@@ -68,7 +83,7 @@ DECLARE_CONVERTER(fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD){
     xx_to_item32_sc16<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
 }
 
-DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
 
@@ -109,7 +124,7 @@ DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD){
     item32_sc16_to_xx<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
 }
 
-DECLARE_CONVERTER(sc16, 1, sc16_item32_le, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc16, 1, sc16_item32_le, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
     const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
     item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
 
@@ -123,7 +138,7 @@ DECLARE_CONVERTER(sc16, 1, sc16_item32_le, 1, PRIORITY_SIMD){
     xx_to_item32_sc16<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
 }
 
-DECLARE_CONVERTER(sc16_item32_le, 1, sc16, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc16_item32_le, 1, sc16, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
 
@@ -18,6 +18,13 @@
 #include "convert_common.hpp"
 #include <uhd/utils/byteswap.hpp>
 #include <boost/math/special_functions/round.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 using namespace uhd::convert;
@@ -26,53 +33,124 @@ static const size_t sc16_table_len = size_t(1 << 16);
 
 typedef uint16_t (*tohost16_type)(uint16_t);
 
+/***********************************************************************
+ * Tables shared between converters
+ *  - Converters of one kind with the same scalar use the same table, so
+ *    making many streamers or setting the same scalar again is cheap
+ *  - A table lives while a converter uses it
+ **********************************************************************/
+typedef std::pair<std::string, double> table_key_type;
+typedef std::map<table_key_type, boost::weak_ptr<void> > table_cache_type;
+UHD_SINGLETON_FCN(table_cache_type, get_table_cache);
+UHD_SINGLETON_FCN(boost::mutex, get_table_cache_mutex);
+
+template <typename table_type>
+static boost::shared_ptr<const table_type> get_shared_table(
+    const std::string &kind, const double scalar, void (*fill)(table_type &, const double)
+){
+    boost::mutex::scoped_lock lock(get_table_cache_mutex());
+    table_cache_type &cache = get_table_cache();
+
+    //forget the tables no converter uses anymore
+    for (table_cache_type::iterator it = cache.begin(); it != cache.end();){
+        if (it->second.expired()) cache.erase(it++);
+        else ++it;
+    }
+
+    boost::weak_ptr<void> &entry = cache[table_key_type(kind, scalar)];
+    const boost::shared_ptr<void> cached = entry.lock();
+    if (cached) return boost::static_pointer_cast<const table_type>(cached);
+
+    boost::shared_ptr<table_type> table(new table_type(sc16_table_len));
+    fill(*table, scalar);
+    entry = table;
+    return table;
+}
+
+/*!
+ * Base for the table converters: set_scalar() only notes the scalar,
+ * and the first conversion after it gets the table for it.
+ * The derived class has a static fill(table, scalar).
+ */
+template <typename derived, typename table_type>
+class table_converter : public converter{
+public:
+    table_converter(void): _scalar(1.0){}
+
+    void set_scalar(const double scalar){
+        if (scalar == _scalar) return;
+        _scalar = scalar;
+        _table.reset();
+    }
+
+protected:
+    const table_type &get_table(void){
+        if (not _table) _table = get_shared_table<table_type>(
+            typeid(derived).name(), _scalar, &derived::fill);
+        return *_table;
+    }
+
+private:
+    double _scalar;
+    boost::shared_ptr<const table_type> _table;
+};
+
+/*!
+ * The host order value of table index (hi << 8) | lo: looping over the
+ * bytes of the index makes the values a linear sequence in the inner
+ * loop, without shuffles, so the compiler can vectorize the fills.
+ */
+template <tohost16_type tohost>
+UHD_INLINE uint16_t table_value(const size_t hi, const size_t lo){
+    const bool swap = tohost(0x0102) != 0x0102; //constant per instantiation
+    return swap? uint16_t((lo << 8) | hi) : uint16_t((hi << 8) | lo);
+}
+
 /***********************************************************************
  * Implementation for sc16 to sc8 lookup table
  *  - Lookup the real and imaginary parts individually
  **********************************************************************/
 template <bool swap>
-class convert_sc16_1_to_sc8_item32_1 : public converter{
+class convert_sc16_1_to_sc8_item32_1 :
+    public table_converter<convert_sc16_1_to_sc8_item32_1<swap>, std::vector<uint8_t> >
+{
 public:
-    convert_sc16_1_to_sc8_item32_1(void): _table(sc16_table_len){}
-
-    void set_scalar(const double scalar){
+    static void fill(std::vector<uint8_t> &table, const double scalar){
         for (size_t i = 0; i < sc16_table_len; i++){
             const int16_t val = uint16_t(i);
-            _table[i] = int8_t(boost::math::iround(val * scalar / 32767.));
+            table[i] = int8_t(boost::math::iround(val * scalar / 32767.));
         }
     }
 
-    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+    void operator()(const converter::input_type &inputs, const converter::output_type &outputs, const size_t nsamps){
         const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
         item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+        const std::vector<uint8_t> &table = this->get_table();
 
         const size_t num_pairs = nsamps/2;
         for (size_t i = 0, j = 0; i < num_pairs; i++, j+=2){
-            output[i] = this->lookup(input[j], input[j+1]);
+            output[i] = lookup(table, input[j], input[j+1]);
         }
 
         if (nsamps != num_pairs*2){
-            output[num_pairs] = this->lookup(input[nsamps-1], 0);;
+            output[num_pairs] = lookup(table, input[nsamps-1], 0);;
         }
     }
 
-    item32_t lookup(const sc16_t &in0, const sc16_t &in1){
+    static item32_t lookup(const std::vector<uint8_t> &table, const sc16_t &in0, const sc16_t &in1){
         if (swap){ //hope this compiles out, its a template constant
             return
-            (item32_t(_table[uint16_t(in1.real())]) << 16) |
-            (item32_t(_table[uint16_t(in1.imag())]) << 24) |
-            (item32_t(_table[uint16_t(in0.real())]) << 0) |
-            (item32_t(_table[uint16_t(in0.imag())]) << 8) ;
+            (item32_t(table[uint16_t(in1.real())]) << 16) |
+            (item32_t(table[uint16_t(in1.imag())]) << 24) |
+            (item32_t(table[uint16_t(in0.real())]) << 0) |
+            (item32_t(table[uint16_t(in0.imag())]) << 8) ;
         }
         return
-            (item32_t(_table[uint16_t(in1.real())]) << 8) |
-            (item32_t(_table[uint16_t(in1.imag())]) << 0) |
-            (item32_t(_table[uint16_t(in0.real())]) << 24) |
-            (item32_t(_table[uint16_t(in0.imag())]) << 16) ;
+            (item32_t(table[uint16_t(in1.real())]) << 8) |
+            (item32_t(table[uint16_t(in1.imag())]) << 0) |
+            (item32_t(table[uint16_t(in0.real())]) << 24) |
+            (item32_t(table[uint16_t(in0.imag())]) << 16) ;
     }
-
-private:
-    std::vector<uint8_t> _table;
 };
 
 /***********************************************************************
@@ -80,32 +158,32 @@ private:
  *  - Lookup the real and imaginary parts individually
  **********************************************************************/
 template <typename type, tohost16_type tohost, size_t re_shift, size_t im_shift>
-class convert_sc16_item32_1_to_fcxx_1 : public converter{
+class convert_sc16_item32_1_to_fcxx_1 :
+    public table_converter<convert_sc16_item32_1_to_fcxx_1<type, tohost, re_shift, im_shift>, std::vector<type> >
+{
 public:
-    convert_sc16_item32_1_to_fcxx_1(void): _table(sc16_table_len){}
-
-    void set_scalar(const double scalar){
-        for (size_t i = 0; i < sc16_table_len; i++){
-            const uint16_t val = tohost(uint16_t(i & 0xffff));
-            _table[i] = type(int16_t(val)*scalar);
+    static void fill(std::vector<type> &table, const double scalar){
+        for (size_t hi = 0; hi < 256; hi++){
+            type *row = &table[hi << 8];
+            for (size_t lo = 0; lo < 256; lo++){
+                row[lo] = type(int16_t(table_value<tohost>(hi, lo))*scalar);
+            }
         }
     }
 
-    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+    void operator()(const converter::input_type &inputs, const converter::output_type &outputs, const size_t nsamps){
         const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
         std::complex<type> *output = reinterpret_cast<std::complex<type> *>(outputs[0]);
+        const std::vector<type> &table = this->get_table();
 
         for (size_t i = 0; i < nsamps; i++){
             const item32_t item = input[i];
             output[i] = std::complex<type>(
-                _table[uint16_t(item >> re_shift)],
-                _table[uint16_t(item >> im_shift)]
+                table[uint16_t(item >> re_shift)],
+                table[uint16_t(item >> im_shift)]
             );
         }
     }
-
-private:
-    std::vector<type> _table;
 };
 
 /***********************************************************************
@@ -113,10 +191,10 @@ private:
  *  - Lookup the real and imaginary parts together
  **********************************************************************/
 template <typename type, tohost16_type tohost, size_t lo_shift, size_t hi_shift>
-class convert_sc8_item32_1_to_fcxx_1 : public converter{
+class convert_sc8_item32_1_to_fcxx_1 :
+    public table_converter<convert_sc8_item32_1_to_fcxx_1<type, tohost, lo_shift, hi_shift>, std::vector<std::complex<type> > >
+{
 public:
-    convert_sc8_item32_1_to_fcxx_1(void): _table(sc16_table_len){}
-
     //special case for sc16 type, 32767 undoes float normalization
     static type conv(const int8_t &num, const double scalar){
         if (sizeof(type) == sizeof(s16_t)){
@@ -125,42 +203,43 @@ public:
         return type(num*scalar);
     }
 
-    void set_scalar(const double scalar){
-        for (size_t i = 0; i < sc16_table_len; i++){
-            const uint16_t val = tohost(uint16_t(i & 0xffff));
-            const type real = conv(int8_t(val >> 8), scalar);
-            const type imag = conv(int8_t(val >> 0), scalar);
-            _table[i] = std::complex<type>(real, imag);
+    static void fill(std::vector<std::complex<type> > &table, const double scalar){
+        for (size_t hi = 0; hi < 256; hi++){
+            std::complex<type> *row = &table[hi << 8];
+            for (size_t lo = 0; lo < 256; lo++){
+                const uint16_t val = table_value<tohost>(hi, lo);
+                const type real = conv(int8_t(val >> 8), scalar);
+                const type imag = conv(int8_t(val >> 0), scalar);
+                row[lo] = std::complex<type>(real, imag);
+            }
         }
     }
 
-    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+    void operator()(const converter::input_type &inputs, const converter::output_type &outputs, const size_t nsamps){
         const item32_t *input = reinterpret_cast<const item32_t *>(size_t(inputs[0]) & ~0x3);
         std::complex<type> *output = reinterpret_cast<std::complex<type> *>(outputs[0]);
+        const std::vector<std::complex<type> > &table = this->get_table();
 
         size_t num_samps = nsamps;
 
         if ((size_t(inputs[0]) & 0x3) != 0){
             const item32_t item0 = *input++;
-            *output++ = _table[uint16_t(item0 >> hi_shift)];
+            *output++ = table[uint16_t(item0 >> hi_shift)];
             num_samps--;
         }
 
         const size_t num_pairs = num_samps/2;
         for (size_t i = 0, j = 0; i < num_pairs; i++, j+=2){
             const item32_t item_i = (input[i]);
-            output[j] = _table[uint16_t(item_i >> lo_shift)];
-            output[j + 1] = _table[uint16_t(item_i >> hi_shift)];
+            output[j] = table[uint16_t(item_i >> lo_shift)];
+            output[j + 1] = table[uint16_t(item_i >> hi_shift)];
         }
 
         if (num_samps != num_pairs*2){
             const item32_t item_n = input[num_pairs];
-            output[num_samps-1] = _table[uint16_t(item_n >> lo_shift)];
+            output[num_samps-1] = table[uint16_t(item_n >> lo_shift)];
         }
     }
-
-private:
-    std::vector<std::complex<type> > _table;
 };
 
 /***********************************************************************
@@ -227,56 +306,56 @@ static converter::sptr make_convert_sc16_1_to_sc8_item32_le_1(void){
     return converter::sptr(new convert_sc16_1_to_sc8_item32_1<LE_SWAP>());
 }
 
-UHD_STATIC_BLOCK(register_convert_sc16_item32_1_to_fcxx_1){
+UHD_DEFERRED_BLOCK("convert", register_convert_sc16_item32_1_to_fcxx_1){
     uhd::convert::id_type id;
     id.num_inputs = 1;
     id.num_outputs = 1;
 
     id.output_format = "fc32";
     id.input_format = "sc16_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc32_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc32_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc64";
     id.input_format = "sc16_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc64_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc64_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc32";
     id.input_format = "sc16_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc32_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc32_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc64";
     id.input_format = "sc16_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc64_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc64_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc32";
     id.input_format = "sc8_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_fc32_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_fc32_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc64";
     id.input_format = "sc8_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_fc64_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_fc64_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc32";
     id.input_format = "sc8_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_fc32_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_fc32_1, PRIORITY_TABLE, "table");
 
     id.output_format = "fc64";
     id.input_format = "sc8_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_fc64_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_fc64_1, PRIORITY_TABLE, "table");
 
     id.output_format = "sc16";
     id.input_format = "sc8_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_sc16_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_be_1_to_sc16_1, PRIORITY_TABLE, "table");
 
     id.output_format = "sc16";
     id.input_format = "sc8_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_sc16_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc8_item32_le_1_to_sc16_1, PRIORITY_TABLE, "table");
 
     id.input_format = "sc16";
     id.output_format = "sc8_item32_be";
-    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc8_item32_be_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc8_item32_be_1, PRIORITY_TABLE, "table");
 
     id.input_format = "sc16";
     id.output_format = "sc8_item32_le";
-    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc8_item32_le_1, PRIORITY_TABLE);
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc8_item32_le_1, PRIORITY_TABLE, "table");
 }
@@ -0,0 +1,81 @@
+//
+// Copyright 2011-2013 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_X86_HPP
+#define INCLUDED_LIBUHD_CONVERT_X86_HPP
+
+#include "convert_common.hpp"
+#include <immintrin.h>
+
+//! Target attribute strings for DECLARE_TARGET_CONVERTER
+#define UHD_CONVERT_SSSE3 "ssse3"
+#define UHD_CONVERT_AVX2 "avx2"
+#define UHD_CONVERT_AVX2_F16C "avx2,f16c"
+#define UHD_CONVERT_AVX512 "avx512f,avx512bw"
+
+/***********************************************************************
+ * Byte shuffles within each 32-bit item, as 4 control words for a
+ * 128-bit lane of the pshufb family
+ **********************************************************************/
+//! Swap the 16-bit halves: sc16 I/Q order <-> sc16_item32_le
+#define SHUFFLE_SWAP_PAIRS  0x01000302, 0x05040706, 0x09080b0a, 0x0d0c0f0e
+//! Swap the bytes of each 16-bit half: sc16 <-> sc16_item32_be
+#define SHUFFLE_SWAP_BYTES  0x02030001, 0x06070405, 0x0a0b0809, 0x0e0f0c0d
+//! Reverse the 4 bytes: sc8 I/Q order <-> sc8_item32_le
+#define SHUFFLE_REVERSE     0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f
+//! Keep the order: sc8 I/Q order <-> sc8_item32_be
+#define SHUFFLE_NONE        0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c
+//! Split 4 sc16_item32_le items into their 4 I, then their 4 Q
+#define SHUFFLE_SPLIT_LE    0x07060302, 0x0f0e0b0a, 0x05040100, 0x0d0c0908
+//! Split 4 sc16_item32_be items into their 4 I, then their 4 Q
+#define SHUFFLE_SPLIT_BE    0x04050001, 0x0c0d0809, 0x06070203, 0x0e0f0a0b
+
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static inline __m256i avx2_shuffle(
+    const int c0, const int c1, const int c2, const int c3
+){
+    return _mm256_setr_epi32(c0, c1, c2, c3, c0, c1, c2, c3);
+}
+
+//! Repeat a 128-bit control, e.g. _mm_setr_epi8(SC12_PACK_LE), in both lanes
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static inline __m256i avx2_broadcast(const __m128i &ctrl){
+    return _mm256_broadcastsi128_si256(ctrl);
+}
+
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static inline __m512i avx512_shuffle(
+    const int c0, const int c1, const int c2, const int c3
+){
+    return _mm512_broadcast_i32x4(_mm_setr_epi32(c0, c1, c2, c3));
+}
+
+/***********************************************************************
+ * Stores for kernels with a non-temporal variant (see
+ * uhd::convert::converter::set_nontemporal()): streaming stores need
+ * an aligned address, and an sfence once the kernel is done.
+ **********************************************************************/
+template <bool stream>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX2) static inline void avx2_store_ps(float *out, const __m256 &num){
+    if (stream) _mm256_stream_ps(out, num);
+    else _mm256_storeu_ps(out, num);
+}
+
+template <bool stream>
+UHD_CONVERT_TARGET(UHD_CONVERT_AVX512) static inline void avx512_store_ps(float *out, const __m512 &num){
+    if (stream) _mm512_stream_ps(out, num);
+    else _mm512_storeu_ps(out, num);
+}
+
+#endif /* INCLUDED_LIBUHD_CONVERT_X86_HPP */
@@ -0,0 +1,49 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// sc16_item32_le is in convert_with_neon.cpp
+DECLARE_CPU_CONVERTER(fc32, 1, sc16_item32_be, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    const float32x4_t scalar = vdupq_n_f32(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        const float32x4_t tmp0 = vld1q_f32(reinterpret_cast<const float *>(input+i+0));
+        const float32x4_t tmp1 = vld1q_f32(reinterpret_cast<const float *>(input+i+2));
+        const float32x4_t tmp2 = vld1q_f32(reinterpret_cast<const float *>(input+i+4));
+        const float32x4_t tmp3 = vld1q_f32(reinterpret_cast<const float *>(input+i+6));
+
+        /* scale, convert, swap the bytes of each number */
+        const int16x8_t out0 = neon_swap_bytes(neon_f32_to_s16(tmp0, tmp1, scalar));
+        const int16x8_t out1 = neon_swap_bytes(neon_f32_to_s16(tmp2, tmp3, scalar));
+
+        /* store to output */
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+0), out0);
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+4), out1);
+    }
+
+    //convert remainder
+    xx_to_item32_sc16<uhd::htonx>(input+i, output+i, nsamps-i, scale_factor);
+}
@@ -0,0 +1,65 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Convert 8 samples into 4 items; sc8_item32_be is in I/Q order, _le reversed
+template <bool le>
+static inline void neon_pack_sc8_8x(const fc32_t *input, item32_t *output, const float32x4_t &scalar)
+{
+    /* load from input, scale and convert */
+    const int16x8_t tmplo = neon_f32_to_s16(
+        vld1q_f32(reinterpret_cast<const float *>(input+0)),
+        vld1q_f32(reinterpret_cast<const float *>(input+2)), scalar);
+    const int16x8_t tmphi = neon_f32_to_s16(
+        vld1q_f32(reinterpret_cast<const float *>(input+4)),
+        vld1q_f32(reinterpret_cast<const float *>(input+6)), scalar);
+
+    /* saturate to 8 bits, store to output */
+    int8x16_t tmpi = vcombine_s8(vqmovn_s16(tmplo), vqmovn_s16(tmphi));
+    if (le) tmpi = vrev32q_s8(tmpi);
+    vst1q_s8(reinterpret_cast<int8_t *>(output), tmpi);
+}
+
+template <bool le, xtox_t to_wire>
+static void neon_fc32_to_sc8_item32(
+    const void *in, void *out, const size_t nsamps, const double scale_factor
+){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(in);
+    item32_t *output = reinterpret_cast<item32_t *>(out);
+
+    const float32x4_t scalar = vdupq_n_f32(float(scale_factor));
+
+    size_t i = 0, j = 0;
+    for (; j+7 < nsamps; j+=8, i+=4){
+        neon_pack_sc8_8x<le>(input+j, output+i, scalar);
+    }
+
+    //convert remainder
+    xx_to_item32_sc8<to_wire>(input+j, output+i, nsamps-j, scale_factor);
+}
+
+DECLARE_CPU_CONVERTER(fc32, 1, sc8_item32_be, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    neon_fc32_to_sc8_item32<false, uhd::htonx>(inputs[0], outputs[0], nsamps, scale_factor);
+}
+
+DECLARE_CPU_CONVERTER(fc32, 1, sc8_item32_le, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    neon_fc32_to_sc8_item32<true, uhd::htowx>(inputs[0], outputs[0], nsamps, scale_factor);
+}
@@ -0,0 +1,120 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+static const int8_t pack_le[16] = {SC12_PACK_LE};
+static const int8_t pack_be[16] = {SC12_PACK_BE};
+
+//! Pack 8 numbers (12 bits each, in 16-bit lanes) into a block
+static inline void neon_pack_sc12_block(
+    const uint16x8_t &nums, item32_sc12_3x *output, const uint8x16_t &shuf
+){
+    //I*4096 + Q makes each pair one 24-bit number
+    const uint32x4_t tmpi = vreinterpretq_u32_u16(nums);
+    const uint32x4_t pairs = vorrq_u32(
+        vshlq_n_u32(vandq_u32(tmpi, vdupq_n_u32(0xffff)), 12), vshrq_n_u32(tmpi, 16));
+    vst1q_u8(reinterpret_cast<uint8_t *>(output), neon_shuffle(vreinterpretq_u8_u32(pairs), shuf));
+}
+
+// this converts 1 block (4 samples) at a time, each store writes 4 bytes of the next block
+template <bool le>
+static size_t neon_pack_fc32_to_sc12(
+    const fc32_t *input, item32_sc12_3x *output, const size_t nblocks, const double scalar
+){
+    const uint8x16_t shuf = neon_load_ctrl(le? pack_le : pack_be);
+    const float32x4_t scalar_ps = vdupq_n_f32(float(scalar));
+    const uint32x4_t mask = vdupq_n_u32(0xfff);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        /* load from input */
+        const float32x4_t tmplo = vld1q_f32(reinterpret_cast<const float *>(input+4*i+0));
+        const float32x4_t tmphi = vld1q_f32(reinterpret_cast<const float *>(input+4*i+2));
+
+        /* scale, truncate and keep the lower 12 bits */
+        const uint32x4_t tmpilo = vandq_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(vmulq_f32(tmplo, scalar_ps))), mask);
+        const uint32x4_t tmpihi = vandq_u32(vreinterpretq_u32_s32(vcvtq_s32_f32(vmulq_f32(tmphi, scalar_ps))), mask);
+
+        neon_pack_sc12_block(vcombine_u16(vmovn_u32(tmpilo), vmovn_u32(tmpihi)), output+i, shuf);
+    }
+    return i;
+}
+
+template <bool le>
+static size_t neon_pack_sc16_to_sc12(
+    const sc16_t *input, item32_sc12_3x *output, const size_t nblocks, const double
+){
+    const uint8x16_t shuf = neon_load_ctrl(le? pack_le : pack_be);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        /* keep the upper 12 bits */
+        const uint16x8_t tmpi = vld1q_u16(reinterpret_cast<const uint16_t *>(input+4*i));
+        neon_pack_sc12_block(vshrq_n_u16(tmpi, 4), output+i, shuf);
+    }
+    return i;
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx>(&neon_pack_fc32_to_sc12<true>));
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::ntohx>(&neon_pack_fc32_to_sc12<false>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::wtohx>(&neon_pack_sc16_to_sc12<true>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::ntohx>(&neon_pack_sc16_to_sc12<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_neon_pack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_NEON)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_NEON);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.input_format = "fc32";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_le_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_be_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc16";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_le_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_be_1, PRIORITY_SIMD, name);
+}
@@ -0,0 +1,50 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// sc16_item32_le is in convert_with_neon.cpp
+DECLARE_CPU_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const float32x4_t scalar = vdupq_n_f32(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input, swap the bytes of each number */
+        const int16x8_t tmp0 = neon_swap_bytes(vld1q_s16(reinterpret_cast<const int16_t *>(input+i+0)));
+        const int16x8_t tmp1 = neon_swap_bytes(vld1q_s16(reinterpret_cast<const int16_t *>(input+i+4)));
+
+        /* sign extend, convert and scale */
+        float32x4_t out0, out1, out2, out3;
+        neon_s16_to_f32(tmp0, out0, out1, scalar);
+        neon_s16_to_f32(tmp1, out2, out3, scalar);
+
+        /* store to output */
+        vst1q_f32(reinterpret_cast<float *>(output+i+0), out0);
+        vst1q_f32(reinterpret_cast<float *>(output+i+2), out1);
+        vst1q_f32(reinterpret_cast<float *>(output+i+4), out2);
+        vst1q_f32(reinterpret_cast<float *>(output+i+6), out3);
+    }
+
+    //convert remainder
+    item32_sc16_to_xx<uhd::ntohx>(input+i, output+i, nsamps-i, scale_factor);
+}
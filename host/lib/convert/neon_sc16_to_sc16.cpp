@@ -0,0 +1,54 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+// sc16_item32_le is in convert_with_neon.cpp
+DECLARE_CPU_CONVERTER(sc16, 1, sc16_item32_be, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    const sc16_t *input = reinterpret_cast<const sc16_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        const int16x8_t tmp0 = vld1q_s16(reinterpret_cast<const int16_t *>(input+i+0));
+        const int16x8_t tmp1 = vld1q_s16(reinterpret_cast<const int16_t *>(input+i+4));
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+0), neon_swap_bytes(tmp0));
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+4), neon_swap_bytes(tmp1));
+    }
+
+    //convert remainder
+    xx_to_item32_sc16<uhd::htonx>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CPU_CONVERTER(sc16_item32_be, 1, sc16, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        const int16x8_t tmp0 = vld1q_s16(reinterpret_cast<const int16_t *>(input+i+0));
+        const int16x8_t tmp1 = vld1q_s16(reinterpret_cast<const int16_t *>(input+i+4));
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+0), neon_swap_bytes(tmp0));
+        vst1q_s16(reinterpret_cast<int16_t *>(output+i+4), neon_swap_bytes(tmp1));
+    }
+
+    //convert remainder
+    item32_sc16_to_xx<uhd::ntohx>(input+i, output+i, nsamps-i, scale_factor);
+}
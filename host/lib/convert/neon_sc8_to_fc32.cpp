@@ -0,0 +1,74 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Convert 8 samples (4 items); sc8_item32_be is in I/Q order, _le reversed
+template <bool le>
+static inline void neon_unpack_sc8_8x(const item32_t *input, fc32_t *output, const float32x4_t &scalar)
+{
+    int8x16_t tmpi = vld1q_s8(reinterpret_cast<const int8_t *>(input));
+    if (le) tmpi = vrev32q_s8(tmpi);
+
+    /* sign extend, convert and scale */
+    float32x4_t out0, out1, out2, out3;
+    neon_s16_to_f32(vmovl_s8(vget_low_s8(tmpi)), out0, out1, scalar);
+    neon_s16_to_f32(vmovl_s8(vget_high_s8(tmpi)), out2, out3, scalar);
+
+    /* store to output */
+    vst1q_f32(reinterpret_cast<float *>(output+0), out0);
+    vst1q_f32(reinterpret_cast<float *>(output+2), out1);
+    vst1q_f32(reinterpret_cast<float *>(output+4), out2);
+    vst1q_f32(reinterpret_cast<float *>(output+6), out3);
+}
+
+template <bool le, xtox_t to_host>
+static void neon_sc8_item32_to_fc32(
+    const void *in, void *out, const size_t nsamps, const double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(size_t(in) & ~0x3);
+    fc32_t *output = reinterpret_cast<fc32_t *>(out);
+
+    const float32x4_t scalar = vdupq_n_f32(float(scale_factor));
+    size_t num_samps = nsamps;
+
+    //starting in the middle of an item: its second sample
+    if ((size_t(in) & 0x3) != 0 and num_samps != 0){
+        fc32_t dummy;
+        item32_sc8_x1_to_xx(to_host(*input++), dummy, *output++, scale_factor);
+        num_samps--;
+    }
+
+    size_t i = 0, j = 0;
+    for (; j+7 < num_samps; j+=8, i+=4){
+        neon_unpack_sc8_8x<le>(input+i, output+j, scalar);
+    }
+
+    //convert remainder
+    item32_sc8_to_xx<to_host>(input+i, output+j, num_samps-j, scale_factor);
+}
+
+DECLARE_CPU_CONVERTER(sc8_item32_be, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    neon_sc8_item32_to_fc32<false, uhd::ntohx>(inputs[0], outputs[0], nsamps, scale_factor);
+}
+
+DECLARE_CPU_CONVERTER(sc8_item32_le, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_NEON){
+    neon_sc8_item32_to_fc32<true, uhd::wtohx>(inputs[0], outputs[0], nsamps, scale_factor);
+}
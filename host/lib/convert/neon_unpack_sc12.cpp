@@ -0,0 +1,116 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_neon.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+static const int8_t unpack_le[16] = {SC12_UNPACK_LE};
+static const int8_t unpack_be[16] = {SC12_UNPACK_BE};
+
+//! Gather the 8 numbers of a block into 16-bit lanes, 12 bits on top
+static inline int16x8_t neon_unpack_sc12_block(const item32_sc12_3x *input, const uint8x16_t &shuf)
+{
+    //the numbers in odd lanes start 4 bits lower, shift them up
+    static const int16_t shift[8] = {0, 4, 0, 4, 0, 4, 0, 4};
+    static const uint16_t mask[8] = {0xfff0, 0xffff, 0xfff0, 0xffff, 0xfff0, 0xffff, 0xfff0, 0xffff};
+
+    const uint8x16_t tmpi = neon_shuffle(vld1q_u8(reinterpret_cast<const uint8_t *>(input)), shuf);
+    const uint16x8_t nums = vshlq_u16(vreinterpretq_u16_u8(tmpi), vld1q_s16(shift));
+    return vreinterpretq_s16_u16(vandq_u16(nums, vld1q_u16(mask)));
+}
+
+// this converts 1 block (4 samples) at a time, each load reads 4 bytes of the next block
+template <bool le>
+static size_t neon_unpack_sc12_to_fc32(
+    const item32_sc12_3x *input, fc32_t *output, const size_t nblocks, const double scalar
+){
+    const uint8x16_t shuf = neon_load_ctrl(le? unpack_le : unpack_be);
+    const float32x4_t scalar_ps = vdupq_n_f32(float(scalar));
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        /* sign extend, convert and scale */
+        float32x4_t tmplo, tmphi;
+        neon_s16_to_f32(neon_unpack_sc12_block(input+i, shuf), tmplo, tmphi, scalar_ps);
+
+        /* store to output */
+        vst1q_f32(reinterpret_cast<float *>(output+4*i+0), tmplo);
+        vst1q_f32(reinterpret_cast<float *>(output+4*i+2), tmphi);
+    }
+    return i;
+}
+
+template <bool le>
+static size_t neon_unpack_sc12_to_sc16(
+    const item32_sc12_3x *input, sc16_t *output, const size_t nblocks, const double
+){
+    const uint8x16_t shuf = neon_load_ctrl(le? unpack_le : unpack_be);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        vst1q_s16(reinterpret_cast<int16_t *>(output+4*i), neon_unpack_sc12_block(input+i, shuf));
+    }
+    return i;
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx>(&neon_unpack_sc12_to_fc32<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::ntohx>(&neon_unpack_sc12_to_fc32<false>));
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::wtohx>(&neon_unpack_sc12_to_sc16<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::ntohx>(&neon_unpack_sc12_to_sc16<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_neon_unpack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_NEON)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_NEON);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc16";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_sc16_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_sc16_1, PRIORITY_SIMD, name);
+}
@@ -39,7 +39,7 @@ UHD_INLINE __m128i pack_sc32_4x(
     return _mm_unpacklo_epi64(tmpi_lo, tmpi_hi);
 }
 
-DECLARE_CONVERTER(fc64, 1, sc8_item32_be, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(fc64, 1, sc8_item32_be, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
     item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
 
@@ -83,7 +83,7 @@ DECLARE_CONVERTER(fc64, 1, sc8_item32_be, 1, PRIORITY_SIMD){
     xx_to_item32_sc8<uhd::htonx>(input+i, output+(i/2), nsamps-i, scale_factor);
 }
 
-DECLARE_CONVERTER(fc64, 1, sc8_item32_le, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(fc64, 1, sc8_item32_le, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
     item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
 
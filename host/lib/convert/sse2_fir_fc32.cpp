@@ -0,0 +1,75 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_fir.hpp"
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+// Each vector holds two samples, so the even and odd samples of the
+// window are summed apart and added at the end. Two accumulators hide
+// the latency of the additions.
+static void fir_decim_sse2(
+    const float *in, float *out, const size_t nout,
+    const size_t decim, const float *taps, const size_t ntaps
+){
+    for (size_t k = 0; k < nout; k++){
+        const float *x = in + 2*k*decim;
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        for (size_t j = 0; j < 2*ntaps; j += 8){
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x+j+0), _mm_loadu_ps(taps+j+0)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x+j+4), _mm_loadu_ps(taps+j+4)));
+        }
+        const __m128 acc = _mm_add_ps(acc0, acc1);
+
+        /* add the odd samples onto the even ones, store I and Q */
+        _mm_storel_pi(reinterpret_cast<__m64 *>(out+2*k), _mm_add_ps(acc, _mm_movehl_ps(acc, acc)));
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_fir_decim_sse2){
+    if (not cpu_has_feature(CPU_FEATURE_SSE2)) return;
+    register_fir_decim_kernel(&fir_decim_sse2, PRIORITY_SIMD, cpu_feature_name(CPU_FEATURE_SSE2));
+}
+
+// Four floats (two samples) of every row at a time.
+static void pfb_fold_sse2(
+    const float *in, const float *taps, float *out,
+    const size_t width, const size_t rows
+){
+    size_t i = 0;
+    for (; i + 4 <= width; i += 4){
+        __m128 acc = _mm_setzero_ps();
+        for (size_t r = 0; r < rows; r++){
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(in+r*width+i), _mm_loadu_ps(taps+r*width+i)));
+        }
+        _mm_storeu_ps(out+i, acc);
+    }
+    for (; i < width; i++){
+        float acc = 0.0f;
+        for (size_t r = 0; r < rows; r++){
+            acc += in[r*width+i]*taps[r*width+i];
+        }
+        out[i] = acc;
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_pfb_fold_sse2){
+    if (not cpu_has_feature(CPU_FEATURE_SSE2)) return;
+    register_pfb_fold_kernel(&pfb_fold_sse2, PRIORITY_SIMD, cpu_feature_name(CPU_FEATURE_SSE2));
+}
@@ -0,0 +1,72 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_nco.hpp"
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+// Four phases at a time, see nco_add_sample() for the quarter turns. The
+// swap and the negations are done with masks instead of branches.
+static void nco_sse2(
+    const uint32_t *phase, float *out, const size_t nsamps, const float ampl
+){
+    const __m128i half_quad = _mm_set1_epi32(0x20000000);
+    const __m128i quad_mask = _mm_set1_epi32(0x3fffffff);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128 scale = _mm_set1_ps(NCO_RAD_PER_LSB);
+    const __m128 a = _mm_set1_ps(ampl);
+
+    size_t k = 0;
+    for (; k + 4 <= nsamps; k += 4){
+        const __m128i t = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(phase+k)), half_quad);
+        const __m128i quad = _mm_srli_epi32(t, 30);
+        const __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(t, quad_mask), half_quad)), scale);
+        const __m128 x2 = _mm_mul_ps(x, x);
+
+        __m128 s = _mm_add_ps(_mm_set1_ps(NCO_SIN_C5), _mm_mul_ps(x2, _mm_set1_ps(NCO_SIN_C7)));
+        s = _mm_add_ps(_mm_set1_ps(NCO_SIN_C3), _mm_mul_ps(x2, s));
+        s = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, s));
+        s = _mm_mul_ps(x, s);
+        __m128 c = _mm_add_ps(_mm_set1_ps(NCO_COS_C6), _mm_mul_ps(x2, _mm_set1_ps(NCO_COS_C8)));
+        c = _mm_add_ps(_mm_set1_ps(NCO_COS_C4), _mm_mul_ps(x2, c));
+        c = _mm_add_ps(_mm_set1_ps(NCO_COS_C2), _mm_mul_ps(x2, c));
+        c = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, c));
+
+        /* odd quarters swap, the sign bits come from bit 1 */
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quad, one), one));
+        const __m128 neg_i = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quad, one), two), 30));
+        const __m128 neg_q = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quad, two), 30));
+        const __m128 i = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), neg_i);
+        const __m128 q = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), neg_q);
+
+        /* interleave and add onto the output */
+        float *o = out + 2*k;
+        _mm_storeu_ps(o+0, _mm_add_ps(_mm_loadu_ps(o+0), _mm_mul_ps(a, _mm_unpacklo_ps(i, q))));
+        _mm_storeu_ps(o+4, _mm_add_ps(_mm_loadu_ps(o+4), _mm_mul_ps(a, _mm_unpackhi_ps(i, q))));
+    }
+
+    for (; k < nsamps; k++){
+        nco_add_sample(phase[k], out+2*k, ampl);
+    }
+}
+
+UHD_DEFERRED_BLOCK("convert", register_nco_sse2){
+    if (not cpu_has_feature(CPU_FEATURE_SSE2)) return;
+    register_nco_kernel(&nco_sse2, PRIORITY_SIMD, cpu_feature_name(CPU_FEATURE_SSE2));
+}
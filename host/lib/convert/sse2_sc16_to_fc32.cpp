@@ -21,7 +21,7 @@
 
 using namespace uhd::convert;
 
-DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
 
@@ -29,7 +29,7 @@ DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD){
     const __m128i zeroi = _mm_setzero_si128();
 
     // this macro converts values faster by using SSE intrinsics to convert 4 values at a time
-    #define convert_item32_1_to_fc32_1_nswap_guts(_al_)                 \
+    #define convert_item32_1_to_fc32_1_nswap_guts(_store_)              \
     for (; i+3 < nsamps; i+=4){                                         \
         /* load from input */                                           \
         __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
@@ -45,35 +45,41 @@ DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_SIMD){
         __m128 tmphi = _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar);     \
                                                                         \
         /* store to output */                                           \
-        _mm_store ## _al_ ## ps(reinterpret_cast<float *>(output+i+0), tmplo); \
-        _mm_store ## _al_ ## ps(reinterpret_cast<float *>(output+i+2), tmphi); \
+        _store_(reinterpret_cast<float *>(output+i+0), tmplo);          \
+        _store_(reinterpret_cast<float *>(output+i+2), tmphi);          \
     }                                                                   \
 
     size_t i = 0;
 
     // need to dispatch according to alignment for fastest conversion
     switch (size_t(output) & 0xf){
-    case 0x0:
-        // the data is 16-byte aligned, so do the fast processing of the bulk of the samples
-        convert_item32_1_to_fc32_1_nswap_guts(_)
-        break;
     case 0x8:
         // the first sample is 8-byte aligned - process it to align the remainder of the samples to 16-bytes
         item32_sc16_to_xx<uhd::htowx>(input, output, 1, scale_factor);
         i++;
-        // do faster processing of the bulk of the samples now that we are 16-byte aligned
-        convert_item32_1_to_fc32_1_nswap_guts(_)
+        // the remainder of the samples is 16-byte aligned now
+        // fall through
+    case 0x0:
+        // the data is 16-byte aligned, so do the fast processing of the bulk of the samples,
+        // with streaming stores when the output is not read again soon
+        if (nontemporal){
+            convert_item32_1_to_fc32_1_nswap_guts(_mm_stream_ps)
+            _mm_sfence();
+        }
+        else{
+            convert_item32_1_to_fc32_1_nswap_guts(_mm_store_ps)
+        }
         break;
     default:
         // we are not 8 or 16-byte aligned, so do fast processing with the unaligned load and store
-        convert_item32_1_to_fc32_1_nswap_guts(u_)
+        convert_item32_1_to_fc32_1_nswap_guts(_mm_storeu_ps)
     }
 
     // convert any remaining samples
     item32_sc16_to_xx<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
 }
 
-DECLARE_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
     fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
 
@@ -81,7 +87,7 @@ DECLARE_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD){
     const __m128i zeroi = _mm_setzero_si128();
 
     // this macro converts values faster by using SSE intrinsics to convert 4 values at a time
-    #define convert_item32_1_to_fc32_1_bswap_guts(_al_)                 \
+    #define convert_item32_1_to_fc32_1_bswap_guts(_store_)              \
     for (; i+3 < nsamps; i+=4){                                         \
         /* load from input */                                           \
         __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
@@ -96,28 +102,34 @@ DECLARE_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_SIMD){
         __m128 tmphi = _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar);     \
                                                                         \
         /* store to output */                                           \
-        _mm_store ## _al_ ## ps(reinterpret_cast<float *>(output+i+0), tmplo); \
-        _mm_store ## _al_ ## ps(reinterpret_cast<float *>(output+i+2), tmphi); \
+        _store_(reinterpret_cast<float *>(output+i+0), tmplo);          \
+        _store_(reinterpret_cast<float *>(output+i+2), tmphi);          \
     }                                                                   \
 
     size_t i = 0;
 
     // need to dispatch according to alignment for fastest conversion
     switch (size_t(output) & 0xf){
-    case 0x0:
-        // the data is 16-byte aligned, so do the fast processing of the bulk of the samples
-        convert_item32_1_to_fc32_1_bswap_guts(_)
-        break;
     case 0x8:
         // the first sample is 8-byte aligned - process it to align the remainder of the samples to 16-bytes
         item32_sc16_to_xx<uhd::htonx>(input, output, 1, scale_factor);
         i++;
-        // do faster processing of the bulk of the samples now that we are 16-byte aligned
-        convert_item32_1_to_fc32_1_bswap_guts(_)
+        // the remainder of the samples is 16-byte aligned now
+        // fall through
+    case 0x0:
+        // the data is 16-byte aligned, so do the fast processing of the bulk of the samples,
+        // with streaming stores when the output is not read again soon
+        if (nontemporal){
+            convert_item32_1_to_fc32_1_bswap_guts(_mm_stream_ps)
+            _mm_sfence();
+        }
+        else{
+            convert_item32_1_to_fc32_1_bswap_guts(_mm_store_ps)
+        }
         break;
     default:
         // we are not 8 or 16-byte aligned, so do fast processing with the unaligned load and store
-        convert_item32_1_to_fc32_1_bswap_guts(u_)
+        convert_item32_1_to_fc32_1_bswap_guts(_mm_storeu_ps)
     }
 
     // convert any remaining samples
@@ -0,0 +1,123 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_correction.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/*!
+ * Convert, scale and correct 4 samples at a time. The 16-bit values end
+ * up in the upper half of 32-bit lanes, which the coefficients undo.
+ */
+template <xtox_t to_host, bool swap16>
+class sse2_sc16_item32_1_to_fc32_1_corrected : public converter_with_correction{
+private:
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+        fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+        if (_measure_power) this->convert<true>(input, output, nsamps);
+        else this->convert<false>(input, output, nsamps);
+    }
+
+    template <bool measure>
+    UHD_INLINE void convert(const item32_t *input, fc32_t *output, const size_t nsamps){
+
+        // lanes hold I, Q, I, Q: multiply by the row of each, and by the
+        // other component swapped in for the cross terms
+        const float f = 1.0f/(1 << 16);
+        const __m128 diag = _mm_set_ps(_coeffs.qq*f, _coeffs.ii*f, _coeffs.qq*f, _coeffs.ii*f);
+        const __m128 cross = _mm_set_ps(_coeffs.qi*f, _coeffs.iq*f, _coeffs.qi*f, _coeffs.iq*f);
+        const __m128 offset = _mm_set_ps(_coeffs.off_q, _coeffs.off_i, _coeffs.off_q, _coeffs.off_i);
+        const __m128i zeroi = _mm_setzero_si128();
+
+        // |sample|^2 of both samples in a register: the squares of I and
+        // Q are summed across the pair of lanes of each sample
+        __m128 peak = _mm_setzero_ps();
+        __m128 sum = _mm_setzero_ps();
+
+        size_t i = 0;
+        for (; i+3 < nsamps; i+=4){
+            __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+
+            // to I, Q order of 16-bit values
+            if (swap16){
+                tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+                tmpi = _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            else{
+                tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+            }
+            const __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(zeroi, tmpi));
+            const __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(zeroi, tmpi));
+
+            const __m128 outlo = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(lo, diag),
+                _mm_mul_ps(_mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 3, 0, 1)), cross)), offset);
+            const __m128 outhi = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(hi, diag),
+                _mm_mul_ps(_mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 3, 0, 1)), cross)), offset);
+
+            _mm_storeu_ps(reinterpret_cast<float *>(output+i+0), outlo);
+            _mm_storeu_ps(reinterpret_cast<float *>(output+i+2), outhi);
+
+            if (measure){
+                const __m128 sqlo = _mm_mul_ps(outlo, outlo);
+                const __m128 sqhi = _mm_mul_ps(outhi, outhi);
+                const __m128 maglo = _mm_add_ps(sqlo, _mm_shuffle_ps(sqlo, sqlo, _MM_SHUFFLE(2, 3, 0, 1)));
+                const __m128 maghi = _mm_add_ps(sqhi, _mm_shuffle_ps(sqhi, sqhi, _MM_SHUFFLE(2, 3, 0, 1)));
+                peak = _mm_max_ps(peak, _mm_max_ps(maglo, maghi));
+                sum = _mm_add_ps(sum, _mm_add_ps(sqlo, sqhi));
+            }
+        }
+
+        if (measure){
+            float peaks[4], sums[4];
+            _mm_storeu_ps(peaks, peak);
+            _mm_storeu_ps(sums, sum);
+            _power.peak = std::max(_power.peak, std::max(peaks[0], peaks[2]));
+            _power.sum += double(sums[0]) + sums[1] + sums[2] + sums[3];
+            _power.num += i;
+        }
+
+        // convert any remaining samples
+        item32_sc16_to_fc32_corrected<to_host, measure>(input+i, output+i, nsamps-i, _coeffs, _power);
+    }
+};
+
+static converter::sptr make_sse2_sc16_item32_le_1_to_fc32_1_corrected(void){
+    return converter::sptr(new sse2_sc16_item32_1_to_fc32_1_corrected<uhd::wtohx, true>());
+}
+
+static converter::sptr make_sse2_sc16_item32_be_1_to_fc32_1_corrected(void){
+    return converter::sptr(new sse2_sc16_item32_1_to_fc32_1_corrected<uhd::ntohx, false>());
+}
+
+UHD_DEFERRED_BLOCK("convert", register_sse2_sc16_to_fc32_corrected){
+    if (not cpu_has_feature(CPU_FEATURE_SSE2)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_SSE2) + " correction";
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &make_sse2_sc16_item32_le_1_to_fc32_1_corrected, PRIORITY_CORRECTION_SIMD, name);
+
+    id.input_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &make_sse2_sc16_item32_be_1_to_fc32_1_corrected, PRIORITY_CORRECTION_SIMD, name);
+}
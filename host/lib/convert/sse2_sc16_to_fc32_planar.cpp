@@ -0,0 +1,74 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+// this converts 4 items at a time: with the 16-bit values of each in the
+// upper half of a 32-bit lane, conversion and scaling are exact
+template <xtox_t to_host, bool swap_bytes>
+static void sse2_item32_sc16_to_fc32_planar(
+    const item32_t *input, float *output_i, float *output_q, const size_t nsamps,
+    const double scale_factor
+){
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+    const __m128i upper = _mm_set1_epi32(int(0xffff0000));
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load from input, the I in the upper half of each lane */
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        if (swap_bytes){
+            tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+            tmpi = _mm_or_si128(_mm_srli_epi32(tmpi, 16), _mm_slli_epi32(tmpi, 16));
+        }
+
+        /* convert and scale */
+        __m128 tmp_i = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(tmpi, upper)), scalar);
+        __m128 tmp_q = _mm_mul_ps(_mm_cvtepi32_ps(_mm_slli_epi32(tmpi, 16)), scalar);
+
+        /* store to output */
+        _mm_storeu_ps(output_i+i, tmp_i);
+        _mm_storeu_ps(output_q+i, tmp_q);
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        output_i[i] = float(int16_t(item >> 16)*float(scale_factor));
+        output_q[i] = float(int16_t(item >> 0)*float(scale_factor));
+    }
+}
+
+DECLARE_CPU_CONVERTER(sc16_item32_le, 1, fc32_planar, 2, PRIORITY_SIMD, CPU_FEATURE_SSE2){
+    sse2_item32_sc16_to_fc32_planar<uhd::wtohx, false>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]), reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor
+    );
+}
+
+DECLARE_CPU_CONVERTER(sc16_item32_be, 1, fc32_planar, 2, PRIORITY_SIMD, CPU_FEATURE_SSE2){
+    sse2_item32_sc16_to_fc32_planar<uhd::ntohx, true>(
+        reinterpret_cast<const item32_t *>(inputs[0]),
+        reinterpret_cast<float *>(outputs[0]), reinterpret_cast<float *>(outputs[1]),
+        nsamps, scale_factor
+    );
+}
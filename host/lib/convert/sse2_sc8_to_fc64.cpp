@@ -55,7 +55,7 @@ UHD_INLINE void unpack_sc32_8x(
     out7 = _mm_mul_pd(_mm_cvtepi32_pd(tmp), scalar);
 }
 
-DECLARE_CONVERTER(sc8_item32_be, 1, fc64, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc8_item32_be, 1, fc64, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const item32_t *input = reinterpret_cast<const item32_t *>(size_t(inputs[0]) & ~0x3);
     fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
 
@@ -102,7 +102,7 @@ DECLARE_CONVERTER(sc8_item32_be, 1, fc64, 1, PRIORITY_SIMD){
     item32_sc8_to_xx<uhd::ntohx>(input+i, output+j, num_samps-j, scale_factor);
 }
 
-DECLARE_CONVERTER(sc8_item32_le, 1, fc64, 1, PRIORITY_SIMD){
+DECLARE_CPU_CONVERTER(sc8_item32_le, 1, fc64, 1, PRIORITY_SIMD, CPU_FEATURE_SSE2){
     const item32_t *input = reinterpret_cast<const item32_t *>(size_t(inputs[0]) & ~0x3);
     fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
 
@@ -0,0 +1,115 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Pack 8 numbers (12 bits each, in 16-bit lanes) into a block
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static inline void ssse3_pack_sc12_block(
+    const __m128i &nums, item32_sc12_3x *output, const __m128i &shuf
+){
+    //I*4096 + Q makes each pair one 24-bit number
+    const __m128i pairs = _mm_madd_epi16(nums, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm_shuffle_epi8(pairs, shuf));
+}
+
+// this converts 1 block (4 samples) at a time, each store writes 4 bytes of the next block
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static size_t ssse3_pack_fc32_to_sc12(
+    const fc32_t *input, item32_sc12_3x *output, const size_t nblocks, const double scalar
+){
+    const __m128i shuf = le? _mm_setr_epi8(SC12_PACK_LE) : _mm_setr_epi8(SC12_PACK_BE);
+    const __m128 scalar_ps = _mm_set1_ps(float(scalar));
+    const __m128i mask = _mm_set1_epi32(0xfff);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        /* load from input */
+        const __m128 tmplo = _mm_loadu_ps(reinterpret_cast<const float *>(input+4*i+0));
+        const __m128 tmphi = _mm_loadu_ps(reinterpret_cast<const float *>(input+4*i+2));
+
+        /* scale, truncate and keep the lower 12 bits */
+        const __m128i tmpilo = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(tmplo, scalar_ps)), mask);
+        const __m128i tmpihi = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(tmphi, scalar_ps)), mask);
+
+        ssse3_pack_sc12_block(_mm_packs_epi32(tmpilo, tmpihi), output+i, shuf);
+    }
+    return i;
+}
+
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static size_t ssse3_pack_sc16_to_sc12(
+    const sc16_t *input, item32_sc12_3x *output, const size_t nblocks, const double
+){
+    const __m128i shuf = le? _mm_setr_epi8(SC12_PACK_LE) : _mm_setr_epi8(SC12_PACK_BE);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        /* keep the upper 12 bits */
+        const __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i));
+        ssse3_pack_sc12_block(_mm_srli_epi16(tmpi, 4), output+i, shuf);
+    }
+    return i;
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx>(&ssse3_pack_fc32_to_sc12<true>));
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::ntohx>(&ssse3_pack_fc32_to_sc12<false>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::wtohx>(&ssse3_pack_sc16_to_sc12<true>));
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<int16_t, uhd::ntohx>(&ssse3_pack_sc16_to_sc12<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_ssse3_pack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_SSSE3)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_SSSE3);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.input_format = "fc32";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_le_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_be_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc16";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_le_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_be_1, PRIORITY_SIMD, name);
+}
@@ -0,0 +1,117 @@
+//
+// Copyright 2011-2012 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_x86.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+//! Gather the 8 numbers of a block into 16-bit lanes, 12 bits on top
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static inline __m128i ssse3_unpack_sc12_block(
+    const item32_sc12_3x *input, const __m128i &shuf
+){
+    //the numbers in odd lanes start 4 bits lower, shift them up
+    const __m128i shift = _mm_setr_epi16(1, 16, 1, 16, 1, 16, 1, 16);
+    const __m128i mask = _mm_setr_epi16(short(0xfff0), -1, short(0xfff0), -1, short(0xfff0), -1, short(0xfff0), -1);
+
+    const __m128i tmpi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input)), shuf);
+    return _mm_and_si128(_mm_mullo_epi16(tmpi, shift), mask);
+}
+
+// this converts 1 block (4 samples) at a time, each load reads 4 bytes of the next block
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static size_t ssse3_unpack_sc12_to_fc32(
+    const item32_sc12_3x *input, fc32_t *output, const size_t nblocks, const double scalar
+){
+    const __m128i shuf = le? _mm_setr_epi8(SC12_UNPACK_LE) : _mm_setr_epi8(SC12_UNPACK_BE);
+    const __m128 scalar_ps = _mm_set1_ps(float(scalar));
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        const __m128i tmpi = ssse3_unpack_sc12_block(input+i, shuf);
+
+        /* sign extend, convert and scale */
+        const __m128i tmpilo = _mm_srai_epi32(_mm_unpacklo_epi16(tmpi, tmpi), 16);
+        const __m128i tmpihi = _mm_srai_epi32(_mm_unpackhi_epi16(tmpi, tmpi), 16);
+        const __m128 tmplo = _mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar_ps);
+        const __m128 tmphi = _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar_ps);
+
+        /* store to output */
+        _mm_storeu_ps(reinterpret_cast<float *>(output+4*i+0), tmplo);
+        _mm_storeu_ps(reinterpret_cast<float *>(output+4*i+2), tmphi);
+    }
+    return i;
+}
+
+template <bool le>
+UHD_CONVERT_TARGET(UHD_CONVERT_SSSE3) static size_t ssse3_unpack_sc12_to_sc16(
+    const item32_sc12_3x *input, sc16_t *output, const size_t nblocks, const double
+){
+    const __m128i shuf = le? _mm_setr_epi8(SC12_UNPACK_LE) : _mm_setr_epi8(SC12_UNPACK_BE);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i++){
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i), ssse3_unpack_sc12_block(input+i, shuf));
+    }
+    return i;
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx>(&ssse3_unpack_sc12_to_fc32<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::ntohx>(&ssse3_unpack_sc12_to_fc32<false>));
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::wtohx>(&ssse3_unpack_sc12_to_sc16<true>));
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<int16_t, uhd::ntohx>(&ssse3_unpack_sc12_to_sc16<false>));
+}
+
+UHD_DEFERRED_BLOCK("convert", register_ssse3_unpack_sc12)
+{
+    if (not cpu_has_feature(CPU_FEATURE_SSSE3)) return;
+    const std::string name = cpu_feature_name(CPU_FEATURE_SSSE3);
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_1, PRIORITY_SIMD, name);
+
+    id.output_format = "sc16";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_sc16_1, PRIORITY_SIMD, name);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_sc16_1, PRIORITY_SIMD, name);
+}
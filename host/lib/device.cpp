@@ -22,12 +22,25 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/algorithm.hpp>
+#include <uhd/utils/paths.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/startup_profile.hpp>
+#include <uhd/property_tree.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <map>
 
 using namespace uhd;
 
@@ -67,7 +80,13 @@ static size_t hash_device_addr(
 typedef boost::tuple<device::find_t, device::make_t, device::device_filter_t> dev_fcn_reg_t;
 
 // instantiate the device function registry container
-UHD_SINGLETON_FCN(std::vector<dev_fcn_reg_t>, get_dev_fcn_regs)
+UHD_SINGLETON_FCN(std::vector<dev_fcn_reg_t>, get_registered_devices)
+
+//modules, which may register more devices, are loaded on first use
+static std::vector<dev_fcn_reg_t> &get_dev_fcn_regs(void){
+    uhd::run_deferred_blocks("modules");
+    return get_registered_devices();
+}
 
 void device::register_device(
     const find_t &find,
@@ -82,6 +101,199 @@ device::~device(void){
     /* NOP */
 }
 
+/***********************************************************************
+ * Concurrent discovery
+ **********************************************************************/
+//! Run one find function, errors are reported and give no devices
+static void run_find_fcn(
+    const device::find_t &find,
+    const device_addr_t &hint,
+    device_addrs_t &found
+){
+    try {
+        found = find(hint);
+    }
+    catch (const std::exception &e) {
+        UHD_MSG(error) << "Device discovery error: " << e.what() << std::endl;
+    }
+}
+
+/*!
+ * Call the find functions of all registered devices that pass the filter.
+ * Every find function waits out its own discovery timeout (broadcasts,
+ * USB enumeration), so they all run at the same time. The results are
+ * returned in registration order to keep device indexes stable.
+ */
+static std::vector<device_addrs_t> find_all_devices(
+    const device_addr_t &hint,
+    device::device_filter_t filter
+){
+    const std::vector<dev_fcn_reg_t> &regs = get_dev_fcn_regs();
+    std::vector<device_addrs_t> found(regs.size());
+
+    std::vector<size_t> matching;
+    for (size_t i = 0; i < regs.size(); i++) {
+        if (filter == device::ANY or regs[i].get<2>() == filter) {
+            matching.push_back(i);
+        }
+    }
+
+    if (matching.size() == 1) {
+        run_find_fcn(regs[matching[0]].get<0>(), hint, found[matching[0]]);
+        return found;
+    }
+
+    boost::thread_group find_threads;
+    BOOST_FOREACH(const size_t i, matching) {
+        find_threads.create_thread(boost::bind(
+            &run_find_fcn, regs[i].get<0>(), boost::cref(hint), boost::ref(found[i])
+        ));
+    }
+    find_threads.join_all();
+    return found;
+}
+
+/***********************************************************************
+ * Discovery cache
+ *
+ * Opt-in with the environment variable UHD_DISCOVERY_CACHE=1. The cache
+ * lives in <app path>/.uhd/discovery_cache, each line maps a discovery
+ * request (filter and hint) to the devices it found:
+ *
+ *   <filter>|<sorted hint><TAB><device address><TAB><device address>...
+ *
+ * A cached entry is only used after every device in it answered a find
+ * with its full address, which is a unicast probe for the network
+ * devices instead of a broadcast on every interface.
+ **********************************************************************/
+namespace fs = boost::filesystem;
+
+static bool discovery_cache_enabled(void)
+{
+    const char *enable = std::getenv("UHD_DISCOVERY_CACHE");
+    return enable != NULL and std::string(enable) != "0";
+}
+
+static fs::path get_discovery_cache_path(void)
+{
+    return fs::path(uhd::get_app_path()) / ".uhd" / "discovery_cache";
+}
+
+static std::string discovery_cache_key(const device_addr_t &hint, device::device_filter_t filter)
+{
+    std::string key = boost::lexical_cast<std::string>(int(filter)) + "|";
+    BOOST_FOREACH(const std::string &hint_key, uhd::sorted(hint.keys())){
+        key += hint_key + "=" + hint[hint_key] + ",";
+    }
+    return key;
+}
+
+typedef std::map<std::string, device_addrs_t> discovery_cache_t;
+
+static discovery_cache_t read_discovery_cache(const fs::path &path)
+{
+    discovery_cache_t cache;
+    std::ifstream file(path.string().c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        boost::split(fields, line, boost::is_any_of("\t"));
+        if (fields.size() < 2) continue;
+        device_addrs_t &addrs = cache[fields[0]];
+        for (size_t i = 1; i < fields.size(); i++) {
+            addrs.push_back(device_addr_t(fields[i]));
+        }
+    }
+    return cache;
+}
+
+static void store_discovery_cache(const std::string &key, const device_addrs_t &addrs)
+{
+    const fs::path path = get_discovery_cache_path();
+    try {
+        discovery_cache_t cache = read_discovery_cache(path);
+        cache[key] = addrs;
+
+        std::ostringstream contents;
+        BOOST_FOREACH(const discovery_cache_t::value_type &item, cache) {
+            contents << item.first;
+            BOOST_FOREACH(const device_addr_t &addr, item.second) {
+                contents << "\t" << addr.to_string();
+            }
+            contents << std::endl;
+        }
+        uhd::write_file_atomically(path.string(), contents.str());
+    }
+    catch (const std::exception &e) {
+        UHD_LOG << "Could not update discovery cache " << path.string() << ": " << e.what() << std::endl;
+    }
+}
+
+//! Thread body for re-probing one cached device
+static void probe_cached_device(
+    const device_addr_t &cached_addr,
+    device::device_filter_t filter,
+    std::vector<device_addrs_t> &found
+){
+    found = find_all_devices(cached_addr, filter);
+}
+
+/*!
+ * Find devices, going through the discovery cache when it is enabled.
+ * Returns the same per-registration lists as find_all_devices().
+ */
+static std::vector<device_addrs_t> find_devices(
+    const device_addr_t &hint,
+    device::device_filter_t filter
+){
+    if (not discovery_cache_enabled()) return find_all_devices(hint, filter);
+
+    const std::string key = discovery_cache_key(hint, filter);
+    const discovery_cache_t cache = read_discovery_cache(get_discovery_cache_path());
+    discovery_cache_t::const_iterator entry = cache.find(key);
+    if (entry != cache.end()) {
+        //probe every cached device at its full address, any miss means the
+        //set of devices changed and a full discovery is needed; the probes
+        //run at the same time so a hit costs one discovery timeout at most
+        const device_addrs_t &cached_addrs = entry->second;
+        std::vector<std::vector<device_addrs_t> > probed(cached_addrs.size());
+        boost::thread_group probe_threads;
+        for (size_t j = 0; j < cached_addrs.size(); j++) {
+            probe_threads.create_thread(boost::bind(
+                &probe_cached_device, boost::cref(cached_addrs[j]), filter, boost::ref(probed[j])
+            ));
+        }
+        probe_threads.join_all();
+
+        std::vector<device_addrs_t> found(get_dev_fcn_regs().size());
+        bool valid = true;
+        BOOST_FOREACH(const std::vector<device_addrs_t> &probe, probed) {
+            size_t num_probed = 0;
+            for (size_t i = 0; i < probe.size(); i++) {
+                found[i].insert(found[i].end(), probe[i].begin(), probe[i].end());
+                num_probed += probe[i].size();
+            }
+            if (num_probed == 0) {
+                valid = false;
+                break;
+            }
+        }
+        if (valid) {
+            UHD_LOG << "Using cached discovery result for " << key << std::endl;
+            return found;
+        }
+        UHD_LOG << "Cached discovery result for " << key << " is stale" << std::endl;
+    }
+
+    const std::vector<device_addrs_t> found = find_all_devices(hint, filter);
+    device_addrs_t all_addrs;
+    BOOST_FOREACH(const device_addrs_t &addrs, found) {
+        all_addrs.insert(all_addrs.end(), addrs.begin(), addrs.end());
+    }
+    if (not all_addrs.empty()) store_discovery_cache(key, all_addrs);
+    return found;
+}
+
 /***********************************************************************
  * Discover
  **********************************************************************/
@@ -90,20 +302,12 @@ device_addrs_t device::find(const device_addr_t &hint, device_filter_t filter){
 
     device_addrs_t device_addrs;
 
-    BOOST_FOREACH(const dev_fcn_reg_t &fcn, get_dev_fcn_regs()) {
-        try {
-            if (filter == ANY or fcn.get<2>() == filter) {
-                device_addrs_t discovered_addrs = fcn.get<0>()(hint);
-                device_addrs.insert(
-                    device_addrs.begin(),
-                    discovered_addrs.begin(),
-                    discovered_addrs.end()
-                );
-            }
-        }
-        catch (const std::exception &e) {
-            UHD_MSG(error) << "Device discovery error: " << e.what() << std::endl;
-        }
+    BOOST_FOREACH(const device_addrs_t &discovered_addrs, find_devices(hint, filter)) {
+        device_addrs.insert(
+            device_addrs.begin(),
+            discovered_addrs.begin(),
+            discovered_addrs.end()
+        );
     }
 
     return device_addrs;
@@ -114,21 +318,20 @@ device_addrs_t device::find(const device_addr_t &hint, device_filter_t filter){
  **********************************************************************/
 device::sptr device::make(const device_addr_t &hint, device_filter_t filter, size_t which){
     boost::mutex::scoped_lock lock(_device_mutex);
+    startup_profile::reset();
 
     typedef boost::tuple<device_addr_t, make_t> dev_addr_make_t;
     std::vector<dev_addr_make_t> dev_addr_makers;
 
-    BOOST_FOREACH(const dev_fcn_reg_t &fcn, get_dev_fcn_regs()){
-        try{
-            if(filter == ANY or fcn.get<2>() == filter){
-                BOOST_FOREACH(device_addr_t dev_addr, fcn.get<0>()(hint)){
-                    //append the discovered address and its factory function
-                    dev_addr_makers.push_back(dev_addr_make_t(dev_addr, fcn.get<1>()));
-                }
-            }
-        }
-        catch(const std::exception &e){
-            UHD_MSG(error) << "Device discovery error: " << e.what() << std::endl;
+    std::vector<device_addrs_t> found;
+    {
+        startup_profile::scoped_phase phase("find");
+        found = find_devices(hint, filter);
+    }
+    for (size_t i = 0; i < found.size(); i++){
+        BOOST_FOREACH(const device_addr_t &dev_addr, found[i]){
+            //append the discovered address and its factory function
+            dev_addr_makers.push_back(dev_addr_make_t(dev_addr, get_dev_fcn_regs()[i].get<1>()));
         }
     }
 
@@ -166,9 +369,22 @@ device::sptr device::make(const device_addr_t &hint, device_filter_t filter, siz
         return hash_to_device[dev_hash].lock();
     }
     else {
+        //configure the internal threads before the device starts them
+        set_thread_config(dev_addr);
+
         //create and register a new device
-        device::sptr dev = maker(dev_addr);
+        device::sptr dev;
+        {
+            startup_profile::scoped_phase phase("make");
+            dev = maker(dev_addr);
+        }
         hash_to_device[dev_hash] = dev;
+
+        //keep the profile of this make with the device
+        if (dev->get_tree() and not dev->get_tree()->exists("/startup_profile")) {
+            dev->get_tree()->create<startup_profile::phases_t>("/startup_profile")
+                .set(startup_profile::get_phases());
+        }
         return dev;
     }
 }
@@ -18,6 +18,7 @@
 #include "expert_container.hpp"
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/trace.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
@@ -54,6 +55,9 @@ typedef std::list<expert_graph_t::vertex_descriptor>             node_queue_t;
 
 typedef boost::graph_traits<expert_graph_t>::edge_iterator       edge_iter;
 typedef boost::graph_traits<expert_graph_t>::vertex_iterator     vertex_iter;
+typedef boost::graph_traits<expert_graph_t>::out_edge_iterator   out_edge_iter;
+typedef std::vector<bool>                                        node_set_t;
+typedef std::map<std::string, std::vector<dag_vertex_t*> >       resource_groups_t;
 
 class expert_container_impl : public expert_container
 {
@@ -73,7 +77,7 @@ private:    //Visitor class for cycle detection algorithm
 
 public:
     expert_container_impl(const std::string& name):
-        _name(name)
+        _name(name), _topology_dirty(true)
     {
     }
 
@@ -93,27 +97,55 @@ public:
         boost::lock_guard<boost::mutex> lock(_mutex);
         EX_LOG(0, str(boost::format("resolve_all(%s)") % (force?"force":"")));
         // Do a full resolve of the graph
-        _resolve_helper("", "", force);
+        _update_topology();
+        _resolve_helper(node_set_t(), force);
     }
 
-    void resolve_from(const std::string&)
+    void resolve_from(const std::string& node_name)
     {
         boost::lock_guard<boost::recursive_mutex> resolve_lock(_resolve_mutex);
         boost::lock_guard<boost::mutex> lock(_mutex);
-        EX_LOG(0, "resolve_from (overridden to resolve_all)");
-        // Do a full resolve of the graph
-        // Not optimizing the traversal using node_name to reduce experts complexity
-        _resolve_helper("", "", false);
+        EX_LOG(0, str(boost::format("resolve_from(%s)") % node_name));
+        _update_topology();
+        // Only the nodes that depend on node_name (directly or through
+        // a worker that consumes other dirty inputs) need to be visited
+        node_set_t cone(boost::num_vertices(_expert_dag), false);
+        node_set_t expanded(boost::num_vertices(_expert_dag), false);
+        node_queue_t to_expand;
+        to_expand.push_back(_lookup_vertex(node_name));
+        _expand_cone(to_expand, cone, expanded);
+        _resolve_helper(cone, false);
     }
 
-    void resolve_to(const std::string&)
+    void resolve_to(const std::string& node_name)
     {
         boost::lock_guard<boost::recursive_mutex> resolve_lock(_resolve_mutex);
         boost::lock_guard<boost::mutex> lock(_mutex);
-        EX_LOG(0, "resolve_to (overridden to resolve_all)");
-        // Do a full resolve of the graph
-        // Not optimizing the traversal using node_name to reduce experts complexity
-        _resolve_helper("", "", false);
+        EX_LOG(0, str(boost::format("resolve_to(%s)") % node_name));
+        _update_topology();
+        // Visit everything that node_name depends on. Any worker in that set
+        // may produce new values, so its consumers must be visited as well.
+        node_set_t cone(boost::num_vertices(_expert_dag), false);
+        node_set_t expanded(boost::num_vertices(_expert_dag), false);
+        node_queue_t to_expand;
+        node_queue_t to_visit;
+        to_visit.push_back(_lookup_vertex(node_name));
+        cone[to_visit.front()] = true;
+        while (not to_visit.empty()) {
+            const expert_graph_t::vertex_descriptor v = to_visit.front();
+            to_visit.pop_front();
+            if (_get_vertex(v).get_class() == CLASS_WORKER) {
+                to_expand.push_back(v);
+            }
+            BOOST_FOREACH(const expert_graph_t::vertex_descriptor u, _node_inputs[v]) {
+                if (not cone[u]) {
+                    cone[u] = true;
+                    to_visit.push_back(u);
+                }
+            }
+        }
+        _expand_cone(to_expand, cone, expanded);
+        _resolve_helper(cone, false);
     }
 
     dag_vertex_t& retrieve(const std::string& name) const
@@ -306,6 +338,7 @@ protected:
             expert_graph_t::vertex_descriptor gr_node = boost::add_vertex(data_node, _expert_dag);
             EX_LOG(1, str(boost::format("added vertex %s") % data_node->get_name()));
             _datanode_map.insert(vertex_map_t::value_type(data_node->get_name(), gr_node));
+            _topology_dirty = true;
 
             //Add resolve callbacks
             if (resolve_mode == AUTO_RESOLVE_ON_WRITE or resolve_mode == AUTO_RESOLVE_ON_READ_WRITE) {
@@ -345,6 +378,7 @@ protected:
             expert_graph_t::vertex_descriptor gr_node = boost::add_vertex(worker, _expert_dag);
             EX_LOG(1, str(boost::format("added vertex %s") % worker->get_name()));
             _worker_map.insert(vertex_map_t::value_type(worker->get_name(), gr_node));
+            _topology_dirty = true;
 
             //For each input, add an edge from the input to this node
             BOOST_FOREACH(const std::string& node_name, worker->get_inputs()) {
@@ -407,13 +441,22 @@ protected:
         // Release all nodes in the map
         _worker_map.clear();
         _datanode_map.clear();
+
+        // Release the cached traversal order
+        _sorted_nodes.clear();
+        _node_inputs.clear();
+        _node_levels.clear();
+        _topology_dirty = true;
     }
 
 private:
-    void _resolve_helper(std::string start, std::string stop, bool force)
+    void _update_topology()
     {
+        if (not _topology_dirty) return;
+
         //Sort the graph topologically. This ensures that for all dependencies, the dependant
-        //is always after all of its dependencies.
+        //is always after all of its dependencies. The order only changes when nodes are
+        //added so it is cached between resolves.
         node_queue_t sorted_nodes;
         try {
             boost::topological_sort(_expert_dag, std::front_inserter(sorted_nodes));
@@ -430,45 +473,113 @@ private:
                                          "The following back-edges were found:" + edges);
             }
         }
-        if (sorted_nodes.empty()) return;
 
-        //Determine the start and stop node. If one is not explicitly specified then
-        //resolve everything
-        expert_graph_t::vertex_descriptor start_vertex = sorted_nodes.front();
-        expert_graph_t::vertex_descriptor stop_vertex = sorted_nodes.back();
-        if (not start.empty()) start_vertex = _lookup_vertex(start);
-        if (not stop.empty()) stop_vertex = _lookup_vertex(stop);
-
-        //First Pass: Resolve all nodes if they are dirty, in a topological order
-        std::list<dag_vertex_t*> resolved_workers;
-        bool start_node_encountered = false;
-        for (node_queue_t::iterator node_iter = sorted_nodes.begin();
-             node_iter != sorted_nodes.end();
-             ++node_iter
+        //The graph only stores out-edges so keep a reverse adjacency list around
+        _node_inputs.assign(boost::num_vertices(_expert_dag), std::vector<expert_graph_t::vertex_descriptor>());
+        for (std::pair<edge_iter, edge_iter> ei = boost::edges(_expert_dag);
+             ei.first != ei.second;
+             ++ei.first
         ) {
-            //Determine if we are at or beyond the starting node
-            if (*node_iter == start_vertex) start_node_encountered = true;
-
-            //Only resolve if the starting node has passed
-            if (start_node_encountered) {
-                dag_vertex_t& node = _get_vertex(*node_iter);
-                std::string node_val;
-                if (force or node.is_dirty()) {
-                    node.resolve();
-                    if (node.get_class() == CLASS_WORKER) {
-                        resolved_workers.push_back(&node);
-                    }
-                    EX_LOG(1, str(boost::format("resolved node %s (%s) [%s]") %
-                                    node.get_name() % (node.is_dirty()?"dirty":"clean") % node.to_string()));
+            _node_inputs[boost::target(*(ei.first), _expert_dag)].push_back(
+                boost::source(*(ei.first), _expert_dag));
+        }
+
+        //Assign each node a level that is one past the deepest of its inputs. Nodes
+        //on the same level never depend on each other so they can be resolved in any
+        //order (or at the same time). Reorder the nodes by level.
+        _node_levels.assign(boost::num_vertices(_expert_dag), 0);
+        BOOST_FOREACH(const expert_graph_t::vertex_descriptor v, sorted_nodes) {
+            BOOST_FOREACH(const expert_graph_t::vertex_descriptor u, _node_inputs[v]) {
+                _node_levels[v] = std::max(_node_levels[v], _node_levels[u] + 1);
+            }
+        }
+        _sorted_nodes.clear();
+        for (size_t level = 0; not sorted_nodes.empty(); level++) {
+            for (node_queue_t::iterator node_iter = sorted_nodes.begin();
+                 node_iter != sorted_nodes.end();
+            ) {
+                if (_node_levels[*node_iter] == level) {
+                    _sorted_nodes.push_back(*node_iter);
+                    node_iter = sorted_nodes.erase(node_iter);
                 } else {
-                    EX_LOG(1, str(boost::format("skipped node %s (%s) [%s]") %
-                                    node.get_name() % (node.is_dirty()?"dirty":"clean") % node.to_string()));
+                    ++node_iter;
+                }
+            }
+        }
+        _topology_dirty = false;
+    }
+
+    void _expand_cone(node_queue_t& to_expand, node_set_t& cone, node_set_t& expanded)
+    {
+        //Add everything downstream of the nodes in to_expand to the cone. A worker
+        //marks all of its inputs clean once it resolves, so the consumers of any
+        //other dirty input of a worker in the cone have to be visited too.
+        while (not to_expand.empty()) {
+            const expert_graph_t::vertex_descriptor v = to_expand.front();
+            to_expand.pop_front();
+            if (expanded[v]) continue;
+            expanded[v] = true;
+            cone[v] = true;
+            if (_get_vertex(v).get_class() == CLASS_WORKER) {
+                BOOST_FOREACH(const expert_graph_t::vertex_descriptor u, _node_inputs[v]) {
+                    if (not expanded[u] and _get_vertex(u).is_dirty()) {
+                        to_expand.push_back(u);
+                    }
+                }
+            }
+            for (std::pair<out_edge_iter, out_edge_iter> ei = boost::out_edges(v, _expert_dag);
+                 ei.first != ei.second;
+                 ++ei.first
+            ) {
+                const expert_graph_t::vertex_descriptor u = boost::target(*(ei.first), _expert_dag);
+                if (not expanded[u]) {
+                    to_expand.push_back(u);
                 }
             }
+        }
+    }
 
-            //Determine if we are beyond the stop node
-            if (*node_iter == stop_vertex) break;
+    void _resolve_helper(const node_set_t& cone, bool force)
+    {
+        UHD_TRACE_SPAN("expert_resolve");
+
+        //An empty cone means that the whole graph is resolved
+
+        //First Pass: Resolve all nodes if they are dirty, in a topological order. Workers
+        //that declare a resource are held back until all other nodes of their level are
+        //done and are then resolved concurrently, one thread per resource.
+        std::list<dag_vertex_t*> resolved_workers;
+        resource_groups_t resource_groups;
+        size_t level = 0;
+        BOOST_FOREACH(const expert_graph_t::vertex_descriptor v, _sorted_nodes) {
+            if (not cone.empty() and not cone[v]) continue;
+
+            if (_node_levels[v] != level) {
+                _resolve_concurrently(resource_groups);
+                resource_groups.clear();
+                level = _node_levels[v];
+            }
+
+            dag_vertex_t& node = _get_vertex(v);
+            if (force or node.is_dirty()) {
+                if (node.get_class() == CLASS_WORKER) {
+                    resolved_workers.push_back(&node);
+                    const std::string& resource =
+                        static_cast<const worker_node_t&>(node).get_resource();
+                    if (not resource.empty()) {
+                        resource_groups[resource].push_back(&node);
+                        continue;
+                    }
+                }
+                node.resolve();
+                EX_LOG(1, str(boost::format("resolved node %s (%s) [%s]") %
+                                node.get_name() % (node.is_dirty()?"dirty":"clean") % node.to_string()));
+            } else {
+                EX_LOG(1, str(boost::format("skipped node %s (%s) [%s]") %
+                                node.get_name() % (node.is_dirty()?"dirty":"clean") % node.to_string()));
+            }
         }
+        _resolve_concurrently(resource_groups);
 
         //Second Pass: Mark all the workers clean. The policy is that a worker will mark all of
         //its dependencies clean so after this step all data nodes that are not consumed by a worker
@@ -481,6 +592,47 @@ private:
         }
     }
 
+    void _resolve_concurrently(const resource_groups_t& resource_groups)
+    {
+        if (resource_groups.empty()) return;
+
+        //The first group is resolved in this thread, all others get a thread each
+        std::vector<std::string> errors(resource_groups.size());
+        boost::thread_group threads;
+        size_t group_index = 0;
+        BOOST_FOREACH(const resource_groups_t::value_type& group, resource_groups) {
+            if (group_index > 0) {
+                threads.create_thread(boost::bind(
+                    &expert_container_impl::_resolve_group, this,
+                    boost::cref(group.second), &errors[group_index]));
+            }
+            group_index++;
+        }
+        _resolve_group(resource_groups.begin()->second, &errors[0]);
+        threads.join_all();
+
+        BOOST_FOREACH(const std::string& error, errors) {
+            if (not error.empty()) {
+                throw uhd::runtime_error(error);
+            }
+        }
+    }
+
+    void _resolve_group(const std::vector<dag_vertex_t*>& group, std::string* error)
+    {
+        try {
+            BOOST_FOREACH(dag_vertex_t* node, group) {
+                node->resolve();
+                EX_LOG(1, str(boost::format("resolved node %s (%s) [%s]") %
+                                node->get_name() % (node->is_dirty()?"dirty":"clean") % node->to_string()));
+            }
+        } catch (const std::exception& ex) {
+            *error = ex.what();
+        } catch (...) {
+            *error = "Unknown error resolving a worker";
+        }
+    }
+
     expert_graph_t::vertex_descriptor _lookup_vertex(const std::string& name) const
     {
         expert_graph_t::vertex_descriptor vertex;
@@ -524,6 +676,10 @@ private:
     vertex_map_t            _datanode_map;      //A map from vertex name to vertex descriptor for data nodes
     boost::mutex            _mutex;
     boost::recursive_mutex  _resolve_mutex;
+    bool                    _topology_dirty;    //Set when nodes were added since the last sort
+    std::vector<expert_graph_t::vertex_descriptor> _sorted_nodes;   //Cached topological order
+    std::vector<std::vector<expert_graph_t::vertex_descriptor> > _node_inputs; //Reverse adjacency list
+    std::vector<size_t>     _node_levels;       //Depth of each node in the graph
 };
 
 expert_container::sptr expert_container::make(const std::string& name)
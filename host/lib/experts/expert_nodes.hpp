@@ -399,12 +399,22 @@ namespace uhd { namespace experts {
      * data nodes. The worker can also operate on other non-expert
      * interfaces because worker_node_t is abstract and the client
      * is required to implement the "resolve" method in a subclass.
+     *
+     * A worker may name the resource (e.g. a register interface)
+     * that it operates on. Independent workers that use different
+     * resources can be resolved concurrently. Workers without a
+     * resource are always resolved serially.
      * ---------------------------------------------------------
      */
     class worker_node_t : public dag_vertex_t {
     public:
-        worker_node_t(const std::string& name) :
-            dag_vertex_t(CLASS_WORKER, name) {}
+        worker_node_t(const std::string& name, const std::string& resource = "") :
+            dag_vertex_t(CLASS_WORKER, name), _resource(resource) {}
+
+        // Scheduling info
+        inline const std::string& get_resource() const {
+            return _resource;
+        }
 
         // Worker node specific
         std::list<std::string> get_inputs() const {
@@ -474,6 +484,7 @@ namespace uhd { namespace experts {
         virtual bool has_read_callback() const { return false; }
         virtual void clear_read_callback() {}
 
+        const std::string           _resource;
         std::list<data_accessor_t*> _inputs;
         std::list<data_accessor_t*> _outputs;
     };
@@ -19,9 +19,15 @@
 #include <map>
 #include <utility>
 
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/weak_ptr.hpp>
 
 #include <uhd/exception.hpp>
 #include <uhd/image_loader.hpp>
@@ -30,6 +36,7 @@
 #include <uhd/utils/static.hpp>
 
 namespace fs = boost::filesystem;
+namespace ip = boost::interprocess;
 
 typedef std::map<std::string, uhd::image_loader::loader_fcn_t> loader_fcn_map_t;
 typedef std::map<std::string, std::string> string_map_t;
@@ -38,7 +45,13 @@ typedef std::map<std::string, std::string> string_map_t;
 typedef std::pair<std::string, uhd::image_loader::loader_fcn_t> loader_fcn_pair_t;
 typedef std::pair<std::string, std::string> string_pair_t;
 
-UHD_SINGLETON_FCN(loader_fcn_map_t, get_image_loaders);
+UHD_SINGLETON_FCN(loader_fcn_map_t, get_registered_image_loaders);
+
+//modules, which may register more image loaders, are loaded on first use
+static loader_fcn_map_t &get_image_loaders(void){
+    uhd::run_deferred_blocks("modules");
+    return get_registered_image_loaders();
+}
 UHD_SINGLETON_FCN(string_map_t,     get_recovery_strings);
 
 /*
@@ -76,6 +89,81 @@ bool uhd::image_loader::load(const uhd::image_loader::image_loader_args_t &image
     }
 }
 
+/*
+ * Parallel loading
+ */
+static void load_one(const uhd::image_loader::image_loader_args_t &image_loader_args,
+                     uhd::image_loader::load_result_t &result){
+    try{
+        result.loaded = uhd::image_loader::load(image_loader_args);
+    }
+    catch(const std::exception &e){
+        result.error = e.what();
+    }
+}
+
+std::vector<uhd::image_loader::load_result_t> uhd::image_loader::load_parallel(
+    const std::vector<image_loader_args_t> &image_loader_args
+){
+    get_image_loaders(); //load the modules before the threads look up loaders
+
+    std::vector<load_result_t> results(image_loader_args.size());
+    boost::thread_group load_threads;
+    for(size_t i = 0; i < image_loader_args.size(); i++){
+        results[i].loaded = false;
+        load_threads.create_thread(boost::bind(&load_one, boost::cref(image_loader_args[i]), boost::ref(results[i])));
+    }
+    load_threads.join_all();
+    return results;
+}
+
+/*
+ * Memory-mapped image files
+ */
+uhd::image_loader::image_file::~image_file(void){
+    /* NOP */
+}
+
+class image_file_impl : public uhd::image_loader::image_file{
+public:
+    image_file_impl(const std::string &path){
+        try{
+            _file = ip::file_mapping(path.c_str(), ip::read_only);
+            _region = ip::mapped_region(_file, ip::read_only);
+        }
+        catch(const ip::interprocess_exception &e){
+            throw uhd::io_error(str(boost::format("Could not map the image at path \"%s\": %s")
+                                    % path % e.what()));
+        }
+    }
+
+    const char *data(void) const{
+        return static_cast<const char *>(_region.get_address());
+    }
+
+    size_t size(void) const{
+        return _region.get_size();
+    }
+
+private:
+    ip::file_mapping _file;
+    ip::mapped_region _region;
+};
+
+uhd::image_loader::image_file::sptr uhd::image_loader::map_image(const std::string &path){
+    static boost::mutex mutex;
+    static std::map<std::string, boost::weak_ptr<image_file> > mapped;
+
+    const std::string key = fs::absolute(path).string();
+    boost::mutex::scoped_lock lock(mutex);
+    image_file::sptr file = mapped[key].lock();
+    if(not file){
+        file.reset(new image_file_impl(key));
+        mapped[key] = file;
+    }
+    return file;
+}
+
 /*
  * Get recovery instructions for particular device
  */
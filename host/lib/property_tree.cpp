@@ -16,10 +16,19 @@
 //
 
 #include <uhd/property_tree.hpp>
-#include <uhd/types/dict.hpp>
+#include <uhd/types/wb_iface.hpp>
+#include <uhd/utils/prop_profiler.hpp>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/weak_ptr.hpp>
+#include <algorithm>
 #include <iostream>
 
 using namespace uhd;
@@ -27,10 +36,23 @@ using namespace uhd;
 /***********************************************************************
  * Helper function to iterate through paths
  **********************************************************************/
-#include <boost/tokenizer.hpp>
-#define path_tokenizer(path) \
-    boost::tokenizer<boost::char_separator<char> > \
-    (path, boost::char_separator<char>("/"))
+//! Split a path into its non-empty names ("/a//b/" -> ["a", "b"])
+static std::vector<std::string> path_tokenizer(const std::string &path)
+{
+    std::vector<std::string> names;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t next = path.find('/', pos);
+        if (next == std::string::npos) {
+            next = path.size();
+        }
+        if (next != pos) {
+            names.push_back(path.substr(pos, next - pos));
+        }
+        pos = next + 1;
+    }
+    return names;
+}
 
 /***********************************************************************
  * Property path implementation wrapper
@@ -85,7 +107,7 @@ public:
 
     sptr subtree(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
         property_tree_impl *subtree = new property_tree_impl(path);
         subtree->_guts = this->_guts; //copy the guts sptr
@@ -94,52 +116,42 @@ public:
 
     void remove(const fs_path &path_){
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::unique_lock<boost::shared_mutex> lock(_guts->mutex);
 
         node_type *parent = NULL;
         node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
-            if (not node->has_key(name)) throw_path_not_found(path);
             parent = node;
-            node = &(*node)[name];
+            node = node->find(name);
+            if (node == NULL) throw_path_not_found(path);
         }
         if (parent == NULL) throw uhd::runtime_error("Cannot uproot");
-        parent->pop(fs_path(path.leaf()));
+        parent->pop(path.leaf());
     }
 
     bool exists(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
-        node_type *node = &_guts->root;
-        BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
-            if (not node->has_key(name)) return false;
-            node = &(*node)[name];
-        }
-        return true;
+        return _find(path) != NULL;
     }
 
     std::vector<std::string> list(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
-        node_type *node = &_guts->root;
-        BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
-            if (not node->has_key(name)) throw_path_not_found(path);
-            node = &(*node)[name];
-        }
-
-        return node->keys();
+        node_type *node = _find(path);
+        if (node == NULL) throw_path_not_found(path);
+        return node->names;
     }
 
     void _create(const fs_path &path_, const boost::shared_ptr<void> &prop){
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+        boost::unique_lock<boost::shared_mutex> lock(_guts->mutex);
 
         node_type *node = &_guts->root;
         BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
-            if (not node->has_key(name)) (*node)[name] = node_type();
-            node = &(*node)[name];
+            node = &node->get_or_add(name);
         }
         if (node->prop.get() != NULL) throw uhd::runtime_error("Cannot create! Property already exists at: " + path);
         node->prop = prop;
@@ -147,31 +159,180 @@ public:
 
     boost::shared_ptr<void> &_access(const fs_path &path_) const{
         const fs_path path = _root / path_;
-        boost::mutex::scoped_lock lock(_guts->mutex);
+#ifdef UHD_PROPERTY_TREE_PROFILING
+        prop_profiler::record_access(path);
+#endif
+        boost::shared_lock<boost::shared_mutex> lock(_guts->mutex);
 
-        node_type *node = &_guts->root;
-        BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
-            if (not node->has_key(name)) throw_path_not_found(path);
-            node = &(*node)[name];
-        }
+        node_type *node = _find(path);
+        if (node == NULL) throw_path_not_found(path);
         if (node->prop.get() == NULL) throw uhd::runtime_error("Cannot access! Property uninitialized at: " + path);
         return node->prop;
     }
 
+    void begin_txn(void){
+        _guts->txn->begin();
+    }
+
+    void commit(void){
+        _guts->txn->commit();
+    }
+
+    void add_batch_iface(uhd::wb_iface::sptr iface){
+        boost::mutex::scoped_lock lock(_guts->txn->mutex);
+        _guts->txn->ifaces.push_back(iface);
+    }
+
+    void begin_batch(void){
+        _guts->txn->begin_batch();
+    }
+
+    void commit_batch(void){
+        _guts->txn->commit_batch();
+    }
+
+    txn_hook_type _txn_hook(void) const{
+        return boost::bind(&txn_type::defer, _guts->txn, _1, _2);
+    }
+
+    fs_path _full_path(const fs_path &path) const{
+        return _root / path;
+    }
+
 private:
     void throw_path_not_found(const fs_path &path) const{
         throw uhd::lookup_error("Path not found in tree: " + path);
     }
 
     //basic structural node element
-    struct node_type : uhd::dict<std::string, node_type>{
+    struct node_type{
         boost::shared_ptr<void> prop;
+        //the children, hashed by name
+        boost::unordered_map<std::string, boost::shared_ptr<node_type> > children;
+        //the names of the children in the order they were added
+        std::vector<std::string> names;
+
+        node_type *find(const std::string &name){
+            boost::unordered_map<std::string, boost::shared_ptr<node_type> >::iterator it = children.find(name);
+            return (it == children.end())? NULL : it->second.get();
+        }
+
+        node_type &get_or_add(const std::string &name){
+            boost::shared_ptr<node_type> &child = children[name];
+            if (not child){
+                child = boost::make_shared<node_type>();
+                names.push_back(name);
+            }
+            return *child;
+        }
+
+        void pop(const std::string &name){
+            children.erase(name);
+            names.erase(std::remove(names.begin(), names.end(), name), names.end());
+        }
+    };
+
+    //find a node, or NULL if there is none (call with the mutex locked)
+    node_type *_find(const fs_path &path) const{
+        node_type *node = &_guts->root;
+        BOOST_FOREACH(const std::string &name, path_tokenizer(path)){
+            node = node->find(name);
+            if (node == NULL) return NULL;
+        }
+        return node;
+    }
+
+    //transaction state, shared with the properties (which is why it is not in the guts)
+    struct txn_type{
+        txn_type(void): depth(0){}
+
+        boost::mutex mutex;
+        size_t depth;
+        std::vector<boost::function<void(void)> > pending;
+        boost::unordered_set<const void *> pending_keys;
+        std::vector<boost::weak_ptr<uhd::wb_iface> > ifaces;
+
+        bool defer(const void *key, const boost::function<void(void)> &notify){
+            boost::mutex::scoped_lock lock(mutex);
+            if (depth == 0) return false;
+            if (pending_keys.insert(key).second) pending.push_back(notify);
+            return true;
+        }
+
+        void begin(void){
+            boost::mutex::scoped_lock lock(mutex);
+            if (depth++ != 0) return;
+            const std::vector<uhd::wb_iface::sptr> live_ifaces = get_ifaces();
+            lock.unlock();
+            BOOST_FOREACH(const uhd::wb_iface::sptr &iface, live_ifaces){
+                iface->begin_batch();
+            }
+        }
+
+        void commit(void){
+            boost::mutex::scoped_lock lock(mutex);
+            if (depth == 0) throw uhd::runtime_error("Cannot commit! No property tree transaction was begun");
+            if (--depth != 0) return;
+            std::vector<boost::function<void(void)> > notifications;
+            notifications.swap(pending);
+            pending_keys.clear();
+            const std::vector<uhd::wb_iface::sptr> live_ifaces = get_ifaces();
+            lock.unlock();
+
+            //the transaction is closed, so subscribers run (and set other properties) as usual
+            try{
+                BOOST_FOREACH(const boost::function<void(void)> &notify, notifications){
+                    notify();
+                }
+            }
+            catch(...){
+                commit_ifaces(live_ifaces);
+                throw;
+            }
+            commit_ifaces(live_ifaces);
+        }
+
+        void begin_batch(void){
+            boost::mutex::scoped_lock lock(mutex);
+            const std::vector<uhd::wb_iface::sptr> live_ifaces = get_ifaces();
+            lock.unlock();
+            BOOST_FOREACH(const uhd::wb_iface::sptr &iface, live_ifaces){
+                iface->begin_batch();
+            }
+        }
+
+        void commit_batch(void){
+            boost::mutex::scoped_lock lock(mutex);
+            const std::vector<uhd::wb_iface::sptr> live_ifaces = get_ifaces();
+            lock.unlock();
+            commit_ifaces(live_ifaces);
+        }
+
+        //get the interfaces that still exist (call with the mutex locked)
+        std::vector<uhd::wb_iface::sptr> get_ifaces(void){
+            std::vector<uhd::wb_iface::sptr> live_ifaces;
+            BOOST_FOREACH(const boost::weak_ptr<uhd::wb_iface> &iface, ifaces){
+                uhd::wb_iface::sptr live_iface = iface.lock();
+                if (live_iface) live_ifaces.push_back(live_iface);
+            }
+            return live_ifaces;
+        }
+
+        static void commit_ifaces(const std::vector<uhd::wb_iface::sptr> &live_ifaces){
+            BOOST_FOREACH(const uhd::wb_iface::sptr &iface, live_ifaces){
+                iface->commit();
+            }
+        }
     };
 
     //tree guts which may be referenced in a subtree
     struct tree_guts_type{
+        tree_guts_type(void): txn(boost::make_shared<txn_type>()){}
+
         node_type root;
-        boost::mutex mutex;
+        //shared for lookups, unique to change the tree structure
+        boost::shared_mutex mutex;
+        boost::shared_ptr<txn_type> txn;
     };
 
     //members, the tree and root prefix
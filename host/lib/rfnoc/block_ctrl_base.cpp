@@ -50,17 +50,24 @@ block_ctrl_base::block_ctrl_base(
 ) : _tree(make_args.tree),
     _transport_is_big_endian(make_args.is_big_endian),
     _ctrl_ifaces(make_args.ctrl_ifaces),
-    _base_address(make_args.base_address & 0xFFF0)
+    _base_address(make_args.base_address & 0xFFF0),
+    _arg_batch_depth(0),
+    _sr_shadow_enabled(false)
 {
     UHD_BLOCK_LOG() << "block_ctrl_base()" << std::endl;
 
     /*** Identify this block (NoC-ID, block-ID, and block definition) *******/
-    // Read NoC-ID (name is passed in through make_args):
-    uint64_t noc_id = sr_read64(SR_READBACK_REG_ID);
-    _block_def = blockdef::make_from_noc_id(noc_id);
-    if (_block_def) UHD_BLOCK_LOG() <<  "Found valid blockdef" << std::endl;
-    if (not _block_def)
-        _block_def = blockdef::make_from_noc_id(DEFAULT_NOC_ID);
+    // Read NoC-ID (name is passed in through make_args), unless the
+    // device already did that while enumerating the blocks:
+    uint64_t noc_id = make_args.noc_id;
+    _block_def = make_args.block_def;
+    if (not _block_def) {
+        noc_id = sr_read64(SR_READBACK_REG_ID);
+        _block_def = blockdef::make_from_noc_id(noc_id);
+        if (_block_def) UHD_BLOCK_LOG() <<  "Found valid blockdef" << std::endl;
+        if (not _block_def)
+            _block_def = blockdef::make_from_noc_id(DEFAULT_NOC_ID);
+    }
     UHD_ASSERT_THROW(_block_def);
     // For the block ID, we start with block count 0 and increase until
     // we get a block ID that's not already registered:
@@ -173,7 +180,7 @@ void block_ctrl_base::_init_block_args()
     // Next: Create all the subscribers and coercers.
     // TODO: Add coercer
 #define _SUBSCRIBE_CHECK_AND_RUN(type, arg_tag, error_message) \
-    _tree->access<type>(arg_val_path).add_coerced_subscriber(boost::bind((&nocscript::block_iface::run_and_check), _nocscript_iface, arg[#arg_tag], error_message))
+    _tree->access<type>(arg_val_path).add_coerced_subscriber(boost::bind((&block_ctrl_base::_run_arg_script), this, arg, #arg_tag, error_message))
     BOOST_FOREACH(const blockdef::arg_t &arg, args) {
         fs_path arg_val_path = arg_path / arg["port"] / arg["name"] / "value";
         if (not arg["check"].empty()) {
@@ -205,6 +212,18 @@ void block_ctrl_base::_init_block_args()
     }
 }
 
+void block_ctrl_base::_run_arg_script(
+        const blockdef::arg_t &arg,
+        const std::string &script,
+        const std::string &error_message
+) {
+    if (_arg_batch_depth) {
+        _deferred_args.insert(arg["port"] + "/" + arg["name"]);
+        return;
+    }
+    _nocscript_iface->run_and_check(arg[script], error_message);
+}
+
 /***********************************************************************
  * FPGA control & communication
  **********************************************************************/
@@ -224,6 +243,29 @@ std::vector<size_t> block_ctrl_base::get_ctrl_ports() const
     return ctrl_ports;
 }
 
+void block_ctrl_base::set_sr_shadow_enabled(const bool enable)
+{
+    boost::mutex::scoped_lock lock(_sr_shadow_mutex);
+    _sr_shadow_enabled = enable;
+    if (not enable) {
+        _sr_shadow.clear();
+    } else {
+        // Writing these triggers the action, not the value
+        _sr_volatile.insert(SR_CLEAR_RX_FC);
+        _sr_volatile.insert(SR_CLEAR_TX_FC);
+    }
+}
+
+void block_ctrl_base::set_sr_volatile(const uint32_t reg)
+{
+    boost::mutex::scoped_lock lock(_sr_shadow_mutex);
+    _sr_volatile.insert(reg);
+    typedef std::map<size_t, std::map<uint32_t, dirty_tracked<uint32_t> > > shadow_map_t;
+    for (shadow_map_t::iterator it = _sr_shadow.begin(); it != _sr_shadow.end(); ++it) {
+        it->second.erase(reg);
+    }
+}
+
 void block_ctrl_base::sr_write(const uint32_t reg, const uint32_t data, const size_t port)
 {
     //UHD_BLOCK_LOG() << "  ";
@@ -231,12 +273,40 @@ void block_ctrl_base::sr_write(const uint32_t reg, const uint32_t data, const si
     if (not _ctrl_ifaces.count(port)) {
         throw uhd::key_error(str(boost::format("[%s] sr_write(): No such port: %d") % get_block_id().get() % port));
     }
+    // The lock is not held across the poke: a timed write can block for
+    // a long time, and writes to other registers must not wait for it.
+    bool shadowed = false;
+    {
+        boost::mutex::scoped_lock lock(_sr_shadow_mutex);
+        if (_sr_shadow_enabled and not _sr_volatile.count(reg)) {
+            dirty_tracked<uint32_t> &shadow = _sr_shadow[port][reg]; // A new shadow register starts out dirty
+            shadow = data;
+            if (not shadow.is_dirty()) {
+                return;
+            }
+            shadowed = true;
+        }
+    }
     try {
         _ctrl_ifaces[port]->poke32(_sr_to_addr(reg), data);
     }
     catch(const std::exception &ex) {
         throw uhd::io_error(str(boost::format("[%s] sr_write() failed: %s") % get_block_id().get() % ex.what()));
     }
+    // Only clean once written, so a failed write is repeated
+    if (shadowed) {
+        _sr_shadow_written(reg, data, port);
+    }
+}
+
+void block_ctrl_base::_sr_shadow_written(const uint32_t reg, const uint32_t data, const size_t port)
+{
+    boost::mutex::scoped_lock lock(_sr_shadow_mutex);
+    if (_sr_shadow_enabled and not _sr_volatile.count(reg)) {
+        dirty_tracked<uint32_t> &shadow = _sr_shadow[port][reg];
+        shadow = data;
+        shadow.mark_clean();
+    }
 }
 
 void block_ctrl_base::sr_write(const std::string &reg, const uint32_t data, const size_t port)
@@ -271,6 +341,18 @@ uint64_t block_ctrl_base::sr_read64(const settingsbus_reg_t reg, const size_t po
     }
 }
 
+uint32_t block_ctrl_base::sr_read_shadow(const uint32_t reg, const size_t port)
+{
+    boost::mutex::scoped_lock lock(_sr_shadow_mutex);
+    if (not _sr_shadow_enabled) {
+        throw uhd::key_error(str(boost::format("[%s] sr_read_shadow(): Block keeps no shadow registers") % get_block_id().get()));
+    }
+    if (not _sr_shadow.count(port) or not _sr_shadow[port].count(reg) or _sr_shadow[port][reg].is_dirty()) {
+        throw uhd::key_error(str(boost::format("[%s] sr_read_shadow(): Register %d was not written on port %d") % get_block_id().get() % reg % port));
+    }
+    return _sr_shadow[port][reg].get();
+}
+
 uint32_t block_ctrl_base::sr_read32(const settingsbus_reg_t reg, const size_t port)
 {
     if (not _ctrl_ifaces.count(port)) {
@@ -374,6 +456,65 @@ time_spec_t block_ctrl_base::get_command_time(
     return iface_sptr->get_time();
 }
 
+size_t block_ctrl_base::get_cmd_queue_space(const size_t port)
+{
+    boost::shared_ptr<ctrl_iface> iface_sptr =
+        boost::dynamic_pointer_cast<ctrl_iface>(get_ctrl_iface(port));
+    if (not iface_sptr) {
+        throw uhd::assertion_error(str(
+            boost::format("[%s] No command queue on port '%d'")
+            % unique_id() % port
+        ));
+    }
+
+    return iface_sptr->get_cmd_queue_space();
+}
+
+bool block_ctrl_base::try_sr_write(const uint32_t reg, const uint32_t data, const size_t port)
+{
+    boost::shared_ptr<ctrl_iface> iface_sptr =
+        boost::dynamic_pointer_cast<ctrl_iface>(get_ctrl_iface(port));
+    if (not iface_sptr) {
+        throw uhd::assertion_error(str(
+            boost::format("[%s] No command queue on port '%d'")
+            % unique_id() % port
+        ));
+    }
+    bool written;
+    try {
+        written = iface_sptr->try_poke32(_sr_to_addr(reg), data);
+    }
+    catch(const std::exception &ex) {
+        throw uhd::io_error(str(boost::format("[%s] try_sr_write() failed: %s") % get_block_id().get() % ex.what()));
+    }
+    if (written) {
+        _sr_shadow_written(reg, data, port);
+    }
+    return written;
+}
+
+void block_ctrl_base::set_cmd_done_handler(
+        const timed_wb_iface::cmd_done_handler_t &handler,
+        const size_t port
+) {
+    if (port == ANY_PORT) {
+        BOOST_FOREACH(const size_t specific_port, get_ctrl_ports()) {
+            set_cmd_done_handler(handler, specific_port);
+        }
+        return;
+    }
+    boost::shared_ptr<ctrl_iface> iface_sptr =
+        boost::dynamic_pointer_cast<ctrl_iface>(get_ctrl_iface(port));
+    if (not iface_sptr) {
+        throw uhd::assertion_error(str(
+            boost::format("[%s] No command queue on port '%d'")
+            % unique_id() % port
+        ));
+    }
+
+    iface_sptr->set_cmd_done_handler(handler);
+}
+
 void block_ctrl_base::set_command_tick_rate(
         const double tick_rate,
         const size_t port
@@ -431,10 +572,54 @@ uint32_t block_ctrl_base::get_address(size_t block_port) {
  **********************************************************************/
 void block_ctrl_base::set_args(const uhd::device_addr_t &args, const size_t port)
 {
-    BOOST_FOREACH(const std::string &key, args.keys()) {
-        if (_tree->exists(get_arg_path(key, port))) {
-            set_arg(key, args.get(key), port);
+    typedef std::pair<size_t, wb_iface::sptr> ctrl_iface_pair_t;
+    BOOST_FOREACH(const ctrl_iface_pair_t &ctrl_iface, _ctrl_ifaces) {
+        ctrl_iface.second->begin_batch();
+    }
+    try {
+        // Set all the values, but hold back the scripts:
+        _arg_batch_depth++;
+        try {
+            BOOST_FOREACH(const std::string &key, args.keys()) {
+                if (_tree->exists(get_arg_path(key, port))) {
+                    set_arg(key, args.get(key), port);
+                }
+            }
+        } catch (...) {
+            _arg_batch_depth--;
+            throw;
         }
+        _arg_batch_depth--;
+        // Now run the scripts of all args that were set, once each. If we
+        // were called from within another set_args(), that one runs them.
+        if (_arg_batch_depth == 0 and not _deferred_args.empty()) {
+            std::set<std::string> deferred_args;
+            deferred_args.swap(_deferred_args);
+            BOOST_FOREACH(const blockdef::arg_t &arg, _block_def->get_args()) {
+                if (not deferred_args.count(arg["port"] + "/" + arg["name"])) {
+                    continue;
+                }
+                if (not arg["check"].empty()) {
+                    _nocscript_iface->run_and_check(arg["check"], arg["check_message"]);
+                }
+                if (not arg["action"].empty()) {
+                    _nocscript_iface->run_and_check(arg["action"], "");
+                }
+            }
+        }
+    } catch (...) {
+        _deferred_args.clear();
+        BOOST_FOREACH(const ctrl_iface_pair_t &ctrl_iface, _ctrl_ifaces) {
+            try {
+                ctrl_iface.second->commit();
+            } catch (...) {
+                // We're already throwing the first error
+            }
+        }
+        throw;
+    }
+    BOOST_FOREACH(const ctrl_iface_pair_t &ctrl_iface, _ctrl_ifaces) {
+        ctrl_iface.second->commit();
     }
 }
 
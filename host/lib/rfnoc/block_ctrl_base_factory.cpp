@@ -48,7 +48,8 @@ void block_ctrl_base::register_block(
 static void lookup_block_key(uint64_t noc_id, make_args_t &make_args)
 {
     try {
-        blockdef::sptr bd = blockdef::make_from_noc_id(noc_id);
+        blockdef::sptr bd = make_args.block_def ?
+            make_args.block_def : blockdef::make_from_noc_id(noc_id);
         if (not bd) {
             make_args.block_key  = DEFAULT_BLOCK_NAME;
             make_args.block_name = DEFAULT_BLOCK_NAME;
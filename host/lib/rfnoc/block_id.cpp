@@ -16,20 +16,143 @@
 //
 
 #include <boost/format.hpp>
-#include <boost/regex.hpp>
-#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/property_tree.hpp>
 #include <uhd/rfnoc/constants.hpp>
 #include <uhd/rfnoc/block_id.hpp>
+#include <uhd/utils/static.hpp>
 
 #include <iostream>
+#include <limits>
+#include <map>
 
 using namespace uhd::rfnoc;
 
+/***********************************************************************
+ * Parsing
+ *
+ * Block IDs are parsed by hand, following VALID_BLOCKID_REGEX, so that
+ * looking up blocks by name does not compile a regex on every call.
+ **********************************************************************/
+//! The components of a block ID string. The name is always present.
+struct block_id_parts_t
+{
+    bool has_device_no;
+    size_t device_no;
+    std::string block_name;
+    bool has_block_ctr;
+    size_t block_ctr;
+};
+
+static bool is_alpha(const char c)
+{
+    return (c >= 'A' and c <= 'Z') or (c >= 'a' and c <= 'z');
+}
+
+static bool is_digit(const char c)
+{
+    return c >= '0' and c <= '9';
+}
+
+//! Parse the digits in [begin, end) into \p value, return false on overflow
+static bool parse_number(const char *begin, const char *end, size_t &value)
+{
+    value = 0;
+    for (; begin != end; begin++) {
+        const size_t digit = size_t(*begin - '0');
+        if (value > (std::numeric_limits<size_t>::max() - digit) / 10) {
+            return false;
+        }
+        value = value*10 + digit;
+    }
+    return true;
+}
+
+//! Return the length of the block name at \p begin (VALID_BLOCKNAME_REGEX), 0 if there is none
+static size_t blockname_length(const char *begin, const char *end)
+{
+    if (begin == end or not is_alpha(*begin)) {
+        return 0;
+    }
+    const char *p = begin + 1;
+    while (p != end and (is_alpha(*p) or is_digit(*p))) p++;
+    return size_t(p - begin);
+}
+
+//! Split a block ID string like "0/FFT_1", return false if it is not valid
+static bool parse_block_id(const std::string &block_str, block_id_parts_t &parts)
+{
+    const char *p = block_str.data();
+    const char *end = p + block_str.size();
+
+    // DEVICE/
+    const char *digits_end = p;
+    while (digits_end != end and is_digit(*digits_end)) digits_end++;
+    parts.has_device_no = (digits_end != p);
+    if (parts.has_device_no) {
+        if (digits_end == end or *digits_end != '/' or not parse_number(p, digits_end, parts.device_no)) {
+            return false;
+        }
+        p = digits_end + 1;
+    }
+
+    // BLOCKNAME
+    const size_t name_len = blockname_length(p, end);
+    if (name_len == 0) {
+        return false;
+    }
+    parts.block_name.assign(p, name_len);
+    p += name_len;
+
+    // _COUNTER, with one or two digits
+    parts.has_block_ctr = (p != end);
+    if (parts.has_block_ctr) {
+        if (*p != '_') {
+            return false;
+        }
+        p++;
+        digits_end = p;
+        while (digits_end != end and is_digit(*digits_end)) digits_end++;
+        if (digits_end != end or digits_end == p or digits_end - p > 2) {
+            return false;
+        }
+        parse_number(p, digits_end, parts.block_ctr);
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Block name interning
+ **********************************************************************/
+typedef std::map<std::string, uint32_t> block_name_keys_t;
+UHD_SINGLETON_FCN(block_name_keys_t, get_block_name_keys);
+UHD_SINGLETON_FCN(boost::mutex, get_block_name_keys_mutex);
+
+//! Return the key of a block name, the same for the same name. "" is 0.
+static uint32_t intern_block_name(const std::string &block_name)
+{
+    if (block_name.empty()) {
+        return 0;
+    }
+    boost::mutex::scoped_lock lock(get_block_name_keys_mutex());
+    block_name_keys_t &keys = get_block_name_keys();
+    block_name_keys_t::const_iterator it = keys.find(block_name);
+    if (it != keys.end()) {
+        return it->second;
+    }
+    const uint32_t key = uint32_t(keys.size() + 1);
+    keys[block_name] = key;
+    return key;
+}
+
+/***********************************************************************
+ * block_id_t
+ **********************************************************************/
 block_id_t::block_id_t() :
     _device_no(0),
     _block_name(""),
+    _block_name_key(0),
     _block_ctr(0)
 {
 }
@@ -37,6 +160,7 @@ block_id_t::block_id_t() :
 block_id_t::block_id_t(const std::string &block_str)
     : _device_no(0),
     _block_name(""),
+    _block_name_key(0),
     _block_ctr(0)
 {
     if (not set(block_str)) {
@@ -50,6 +174,7 @@ block_id_t::block_id_t(
         const size_t block_ctr
 ) : _device_no(device_no),
     _block_name(block_name),
+    _block_name_key(intern_block_name(block_name)),
     _block_ctr(block_ctr)
 {
     if (not is_valid_blockname(block_name)) {
@@ -59,12 +184,14 @@ block_id_t::block_id_t(
 
 bool block_id_t::is_valid_blockname(const std::string &block_name)
 {
-    return boost::regex_match(block_name, boost::regex(VALID_BLOCKNAME_REGEX));
+    return not block_name.empty()
+        and blockname_length(block_name.data(), block_name.data() + block_name.size()) == block_name.size();
 }
 
 bool block_id_t::is_valid_block_id(const std::string &block_name)
 {
-    return boost::regex_match(block_name, boost::regex(VALID_BLOCKID_REGEX));
+    block_id_parts_t parts;
+    return parse_block_id(block_name, parts);
 }
 
 std::string block_id_t::to_string() const
@@ -93,35 +220,27 @@ uhd::fs_path block_id_t::get_tree_root() const
 
 bool block_id_t::match(const std::string &block_str)
 {
-    boost::cmatch matches;
-    if (not boost::regex_match(block_str.c_str(), matches, boost::regex(VALID_BLOCKID_REGEX))) {
+    block_id_parts_t parts;
+    if (not parse_block_id(block_str, parts)) {
         return false;
     }
-    try {
-        return  (matches[1] == "" or boost::lexical_cast<size_t>(matches[1]) == _device_no)
-            and (matches[2] == "" or matches[2] == _block_name)
-            and (matches[3] == "" or boost::lexical_cast<size_t>(matches[3]) == _block_ctr)
-            and not (matches[1] == "" and matches[2] == "" and matches[3] == "");
-    } catch (const std::bad_cast &e) {
-        return false;
-    }
-    return false;
+    return  (not parts.has_device_no or parts.device_no == _device_no)
+        and parts.block_name == _block_name
+        and (not parts.has_block_ctr or parts.block_ctr == _block_ctr);
 }
 
 bool block_id_t::set(const std::string &new_name)
 {
-    boost::cmatch matches;
-    if (not boost::regex_match(new_name.c_str(), matches, boost::regex(VALID_BLOCKID_REGEX))) {
+    block_id_parts_t parts;
+    if (not parse_block_id(new_name, parts)) {
         return false;
     }
-    if (not (matches[1] == "")) {
-        _device_no = boost::lexical_cast<size_t>(matches[1]);
-    }
-    if (not (matches[2] == "")) {
-        _block_name = matches[2];
+    if (parts.has_device_no) {
+        _device_no = parts.device_no;
     }
-    if (not (matches[3] == "")) {
-        _block_ctr = boost::lexical_cast<size_t>(matches[3]);
+    _set_block_name(parts.block_name);
+    if (parts.has_block_ctr) {
+        _block_ctr = parts.block_ctr;
     }
     return true;
 }
@@ -144,7 +263,13 @@ bool block_id_t::set_block_name(const std::string &block_name)
     if (not is_valid_blockname(block_name)) {
         return false;
     }
-    _block_name = block_name;
+    _set_block_name(block_name);
     return true;
 }
 
+void block_id_t::_set_block_name(const std::string &block_name)
+{
+    _block_name = block_name;
+    _block_name_key = intern_block_name(block_name);
+}
+
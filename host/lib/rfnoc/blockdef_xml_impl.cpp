@@ -20,6 +20,7 @@
 #include <uhd/rfnoc/blockdef.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/paths.hpp>
+#include <uhd/utils/static.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
@@ -28,7 +29,11 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
 #include <cstdlib>
+#include <ctime>
+#include <map>
 
 using namespace uhd;
 using namespace uhd::rfnoc;
@@ -39,6 +44,55 @@ static const fs::path XML_BLOCKS_SUBDIR("blocks");
 static const fs::path XML_COMPONENTS_SUBDIR("components");
 static const fs::path XML_EXTENSION(".xml");
 
+/****************************************************************************
+ * XML file cache
+ ****************************************************************************/
+//! A parsed XML file, the NoC IDs it lists, or why it could not be read
+struct xml_file_t
+{
+    xml_file_t() : mtime(0) {}
+    std::time_t mtime;
+    boost::shared_ptr<const pt::ptree> ptree;
+    std::vector<std::string> ids;
+    std::string error;
+};
+
+typedef std::map<std::string, boost::shared_ptr<const xml_file_t> > xml_file_cache_t;
+UHD_SINGLETON_FCN(xml_file_cache_t, get_xml_file_cache);
+UHD_SINGLETON_FCN(boost::mutex, get_xml_file_cache_mutex);
+
+/*! Return the XML file at filename, parsed.
+ *
+ * Every block lookup goes through all the files, so each one is only
+ * parsed once per process, and again when it was modified since.
+ */
+static boost::shared_ptr<const xml_file_t> get_xml_file(const fs::path &filename)
+{
+    const std::time_t mtime = fs::last_write_time(filename);
+    boost::mutex::scoped_lock lock(get_xml_file_cache_mutex());
+    boost::shared_ptr<const xml_file_t> &cached = get_xml_file_cache()[filename.string()];
+    if (cached and cached->mtime == mtime) {
+        return cached;
+    }
+
+    boost::shared_ptr<xml_file_t> file = boost::make_shared<xml_file_t>();
+    file->mtime = mtime;
+    try {
+        boost::shared_ptr<pt::ptree> propt = boost::make_shared<pt::ptree>();
+        read_xml(filename.string(), *propt);
+        BOOST_FOREACH(pt::ptree::value_type &v, propt->get_child("nocblock.ids")) {
+            if (v.first == "id") {
+                file->ids.push_back(v.second.data());
+            }
+        }
+        file->ptree = propt;
+    } catch (std::exception &e) {
+        file->error = e.what();
+    }
+    cached = file;
+    return cached;
+}
+
 
 /****************************************************************************
  * port_t stuff
@@ -215,11 +269,13 @@ public:
     //! Open the file at filename and see if it's a block definition for the given NoC ID
     static bool has_noc_id(uint64_t noc_id, const fs::path &filename)
     {
-        pt::ptree propt;
         try {
-            read_xml(filename.string(), propt);
-            BOOST_FOREACH(pt::ptree::value_type &v, propt.get_child("nocblock.ids")) {
-                if (v.first == "id" and match_noc_id(v.second.data(), noc_id)) {
+            boost::shared_ptr<const xml_file_t> file = get_xml_file(filename);
+            if (not file->error.empty()) {
+                throw uhd::runtime_error(file->error);
+            }
+            BOOST_FOREACH(const std::string &id, file->ids) {
+                if (match_noc_id(id, noc_id)) {
                     return true;
                 }
             }
@@ -235,7 +291,12 @@ public:
         _noc_id(noc_id)
     {
         //UHD_MSG(status) << "Reading XML file: " << filename.string().c_str() << std::endl;
-        read_xml(filename.string(), _pt);
+        boost::shared_ptr<const xml_file_t> file = get_xml_file(filename);
+        if (file->ptree) {
+            _pt = *file->ptree;
+        } else {
+            read_xml(filename.string(), _pt); // Throws the parser's error
+        }
         try {
             // Check key is valid
             get_key();
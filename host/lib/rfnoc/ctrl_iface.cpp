@@ -20,8 +20,10 @@
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/flight_recorder.hpp>
 #include <uhd/utils/safe_call.hpp>
-#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/utils/trace.hpp>
+#include <uhd/transport/lockfree_bounded_buffer.hpp>
 #include <uhd/types/sid.hpp>
 #include <uhd/transport/chdr.hpp>
 #include <uhd/rfnoc/constants.hpp>
@@ -29,6 +31,7 @@
 #include <boost/thread/thread.hpp>
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
+#include <algorithm>
 #include <queue>
 
 using namespace uhd;
@@ -38,6 +41,7 @@ using namespace uhd::transport;
 static const double ACK_TIMEOUT = 2.0; //supposed to be worst case practical timeout
 static const double MASSIVE_TIMEOUT = 10.0; //for when we wait on a timed command
 static const size_t SR_READBACK = 32;
+static const size_t MAX_RESP_MSGS = 128; //responses queued when they are pushed
 
 ctrl_iface::~ctrl_iface(void){
     /* NOP */
@@ -60,8 +64,11 @@ public:
         _name(name),
         _seq_out(0),
         _timeout(ACK_TIMEOUT),
-        _resp_queue(128/*max response msgs*/),
+        _resp_queue(MAX_RESP_MSGS),
         _resp_queue_size(_resp_xport ? _resp_xport->get_num_recv_frames() : 3),
+        _max_outstanding(_resp_queue_size),
+        _posted(false),
+        _batch_depth(0),
         _rb_address(uhd::rfnoc::SR_READBACK)
     {
         if (resp_xport) {
@@ -87,7 +94,9 @@ public:
     {
         boost::mutex::scoped_lock lock(_mutex);
         this->send_pkt(addr/4, data);
-        this->wait_for_ack(false);
+        if (_batch_depth != 0) this->collect_posted_acks(this->get_ack_limit());
+        else if (_posted) this->collect_posted_acks(_max_outstanding);
+        else this->wait_for_ack(false);
     }
 
     uint32_t peek32(const wb_addr_type addr)
@@ -95,6 +104,7 @@ public:
         boost::mutex::scoped_lock lock(_mutex);
         this->send_pkt(_rb_address, addr/8);
         const uint64_t res = this->wait_for_ack(true);
+        this->throw_posted_error();
         const uint32_t lo = uint32_t(res & 0xffffffff);
         const uint32_t hi = uint32_t(res >> 32);
         return ((addr/4) & 0x1)? hi : lo;
@@ -104,7 +114,67 @@ public:
     {
         boost::mutex::scoped_lock lock(_mutex);
         this->send_pkt(_rb_address, addr/8);
-        return this->wait_for_ack(true);
+        const uint64_t res = this->wait_for_ack(true);
+        this->throw_posted_error();
+        return res;
+    }
+
+    /*******************************************************************
+     * Posted writes
+     ******************************************************************/
+    void set_posted_writes(const size_t max_outstanding)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _posted = max_outstanding != 0;
+        _max_outstanding = _posted ? std::max<size_t>(1, std::min(max_outstanding, this->get_ack_limit())) : _resp_queue_size;
+    }
+
+    void flush(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        this->wait_for_all_acks();
+    }
+
+    /*******************************************************************
+     * Batched writes
+     ******************************************************************/
+    void begin_batch(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_batch_depth++ == 0) _batch_time = _time;
+    }
+
+    void commit(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_batch_depth == 0 or --_batch_depth != 0) return;
+        this->wait_for_all_acks();
+    }
+
+    /*******************************************************************
+     * Flow control of timed commands
+     ******************************************************************/
+    bool try_poke32(const wb_addr_type addr, const uint32_t data)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        this->collect_arrived_acks();
+        this->throw_posted_error();
+        if (this->get_queue_space() == 0) return false;
+        this->send_pkt(addr/4, data);
+        return true;
+    }
+
+    size_t get_cmd_queue_space(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        this->collect_arrived_acks();
+        return this->get_queue_space();
+    }
+
+    void set_cmd_done_handler(const cmd_done_handler_t &handler)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _cmd_done_handler = handler;
     }
 
     /*******************************************************************
@@ -155,14 +225,16 @@ private:
         packet_info.num_payload_words32 = 2;
         packet_info.num_payload_bytes = packet_info.num_payload_words32*sizeof(uint32_t);
         packet_info.packet_count = _seq_out;
-        packet_info.tsf = _time.to_ticks(_tick_rate);
+        //all the writes of a batch take the command time it began with
+        const uhd::time_spec_t &time = (_batch_depth != 0)? _batch_time : _time;
+        packet_info.tsf = time.to_ticks(_tick_rate);
         packet_info.sob = false;
         packet_info.eob = false;
         packet_info.sid = _sid;
         packet_info.has_sid = true;
         packet_info.has_cid = false;
         packet_info.has_tsi = false;
-        packet_info.has_tsf = _use_time;
+        packet_info.has_tsf = time != uhd::time_spec_t(0.0);
         packet_info.has_tlr = false;
 
         //load header
@@ -175,135 +247,235 @@ private:
         //UHD_MSG(status) << boost::format("0x%08x, 0x%08x\n") % addr % data;
         //send the buffer over the interface
         _outstanding_seqs.push(_seq_out);
+        _outstanding_times.push(time);
         buff->commit(sizeof(uint32_t)*(packet_info.num_packet_words32));
+        flight_recorder::record(flight_recorder::RECORD_CTRL, 0, _sid, _seq_out,
+            packet_info.tsf, addr, packet_info.has_tsf? flight_recorder::FLAG_HAS_TSF : 0);
 
         _seq_out++;//inc seq for next call
     }
 
     UHD_INLINE uint64_t wait_for_ack(const bool readback)
     {
-        while (readback or (_outstanding_seqs.size() >= _resp_queue_size))
+        UHD_TRACE_SPAN("wait_for_ack");
+        uint64_t value = 0;
+        while (readback or (_outstanding_seqs.size() >= _max_outstanding))
         {
-            //get seq to ack from outstanding packets list
-            UHD_ASSERT_THROW(not _outstanding_seqs.empty());
-            const size_t seq_to_ack = _outstanding_seqs.front();
-            _outstanding_seqs.pop();
+            this->collect_ack(_timeout, value);
 
-            //parse the packet
-            vrt::if_packet_info_t packet_info;
-            resp_buff_type resp_buff;
-            memset(&resp_buff, 0x00, sizeof(resp_buff));
-            uint32_t const *pkt = NULL;
-            managed_recv_buffer::sptr buff;
+            //return the readback value
+            if (readback and _outstanding_seqs.empty()) return value;
+        }
+        return 0;
+    }
 
-            //get buffer from response endpoint - or die in timeout
-            if (_resp_xport)
+    //! Wait for the acks of all commands in flight, throw the first error of the posted writes
+    void wait_for_all_acks(void)
+    {
+        uint64_t value;
+        while (not _outstanding_seqs.empty())
+        {
+            try
             {
-                buff = _resp_xport->get_recv_buff(_timeout);
-                try
-                {
-                    UHD_ASSERT_THROW(bool(buff));
-                    UHD_ASSERT_THROW(buff->size() > 0);
-                }
-                catch(const std::exception &ex)
-                {
-                    throw uhd::io_error(str(boost::format("Block ctrl (%s) no response packet - %s") % _name % ex.what()));
-                }
-                pkt = buff->cast<const uint32_t *>();
-                packet_info.num_packet_words32 = buff->size()/sizeof(uint32_t);
+                this->collect_ack(_timeout, value);
             }
-
-            //get buffer from response endpoint - or die in timeout
-            else
+            catch(const uhd::exception &ex)
             {
-                /*
-                 * Couldn't get message with haste.
-                 * Now check both possible queues for messages.
-                 * Messages should come in on _resp_queue,
-                 * but could end up in dump_queue.
-                 * If we don't get a message --> Die in timeout.
-                 */
-                double accum_timeout = 0.0;
-                const double short_timeout = 0.005; // == 5ms
-                while(not ((_resp_queue.pop_with_haste(resp_buff))
-                        || (check_dump_queue(resp_buff))
-                        || (_resp_queue.pop_with_timed_wait(resp_buff, short_timeout))
-                        )){
-                    /*
-                     * If a message couldn't be received within a given timeout
-                     * --> throw AssertionError!
-                     */
-                    accum_timeout += short_timeout;
-                    UHD_ASSERT_THROW(accum_timeout < _timeout);
-                }
-
-                pkt = resp_buff.data;
-                packet_info.num_packet_words32 = sizeof(resp_buff)/sizeof(uint32_t);
+                this->post_error(ex);
             }
+        }
+        this->throw_posted_error();
+    }
 
-            //parse the buffer
+    //! Take the acks of posted writes that came in, wait for the oldest beyond the limit
+    void collect_posted_acks(const size_t max_outstanding)
+    {
+        uint64_t value;
+        try
+        {
+            while (not _outstanding_seqs.empty() and this->collect_ack(0.0, value)) {}
+            while (_outstanding_seqs.size() >= max_outstanding) this->collect_ack(_timeout, value);
+        }
+        catch(const uhd::exception &ex)
+        {
+            this->post_error(ex);
+        }
+    }
+
+    //! Take the acks that came in, without waiting
+    void collect_arrived_acks(void)
+    {
+        uint64_t value;
+        try
+        {
+            while (not _outstanding_seqs.empty() and this->collect_ack(0.0, value)) {}
+        }
+        catch(const uhd::exception &ex)
+        {
+            this->post_error(ex);
+        }
+    }
+
+    //! The writes that can be sent before one waits for an ack
+    size_t get_queue_space(void) const
+    {
+        const size_t limit = (_batch_depth != 0)? this->get_ack_limit() : _max_outstanding;
+        const size_t used = _outstanding_seqs.size() + 1; //a write waits once it fills the queue
+        return (used < limit)? limit - used : 0;
+    }
+
+    //! More responses in flight than the transport (or the queue) holds would be lost
+    size_t get_ack_limit(void) const
+    {
+        return _resp_xport ? _resp_xport->get_num_recv_frames() : MAX_RESP_MSGS;
+    }
+
+    //! Keep the first error of the posted writes for the next peek or flush
+    void post_error(const uhd::exception &ex)
+    {
+        if (not _posted_error) _posted_error.reset(ex.dynamic_clone());
+    }
+
+    void throw_posted_error(void)
+    {
+        if (not _posted_error) return;
+        boost::shared_ptr<uhd::exception> error;
+        error.swap(_posted_error);
+        error->dynamic_throw();
+    }
+
+    /*!
+     * Take the response to the oldest outstanding command and check it.
+     * \param timeout the time to wait for it, 0.0 to only take one that is there
+     * \param value set to the readback value of the response
+     * \return false if there was no response with a timeout of 0.0
+     */
+    bool collect_ack(const double timeout, uint64_t &value)
+    {
+        //get seq to ack from outstanding packets list
+        UHD_ASSERT_THROW(not _outstanding_seqs.empty());
+        const size_t seq_to_ack = _outstanding_seqs.front();
+        const uhd::time_spec_t cmd_time = _outstanding_times.front();
+
+        //parse the packet
+        vrt::if_packet_info_t packet_info;
+        resp_buff_type resp_buff;
+        memset(&resp_buff, 0x00, sizeof(resp_buff));
+        uint32_t const *pkt = NULL;
+        managed_recv_buffer::sptr buff;
+
+        //get buffer from response endpoint - or die in timeout
+        if (_resp_xport)
+        {
+            buff = _resp_xport->get_recv_buff(timeout);
+            if (not buff and timeout == 0.0) return false;
+            _outstanding_seqs.pop();
+            _outstanding_times.pop();
             try
             {
-                packet_info.link_type = _link_type;
-                if (_bige) vrt::chdr::if_hdr_unpack_be(pkt, packet_info);
-                else vrt::chdr::if_hdr_unpack_le(pkt, packet_info);
+                UHD_ASSERT_THROW(bool(buff));
+                UHD_ASSERT_THROW(buff->size() > 0);
             }
             catch(const std::exception &ex)
             {
-                UHD_MSG(error) << "[" << _name << "] Block ctrl bad VITA packet: " << ex.what() << std::endl;
-                if (buff){
-                    UHD_MSG(status) << boost::format("%08X") % pkt[0] << std::endl;
-                    UHD_MSG(status) << boost::format("%08X") % pkt[1] << std::endl;
-                    UHD_MSG(status) << boost::format("%08X") % pkt[2] << std::endl;
-                    UHD_MSG(status) << boost::format("%08X") % pkt[3] << std::endl;
-                }
-                else{
-                    UHD_MSG(status) << "buff is NULL" << std::endl;
-                }
+                throw uhd::io_error(str(boost::format("Block ctrl (%s) no response packet - %s") % _name % ex.what()));
             }
+            pkt = buff->cast<const uint32_t *>();
+            packet_info.num_packet_words32 = buff->size()/sizeof(uint32_t);
+        }
 
-            //check the buffer
-            try
-            {
-                UHD_ASSERT_THROW(packet_info.has_sid);
-                if (packet_info.sid != uint32_t((_sid >> 16) | (_sid << 16))) {
-                    throw uhd::io_error(
-                        str(
-                            boost::format("Expected SID: %s  Received SID: %s")
-                            % uhd::sid_t(_sid).reversed().to_pp_string_hex()
-                            % uhd::sid_t(packet_info.sid).to_pp_string_hex()
-                        )
-                    );
-                }
-
-                if (packet_info.packet_count != (seq_to_ack & 0xfff)) {
-                    throw uhd::io_error(
-                        str(
-                            boost::format("Expected packet index: %d  Received index: %d")
-                            % packet_info.packet_count
-                            % (seq_to_ack & 0xfff)
-                        )
-                    );
-                }
-
-                UHD_ASSERT_THROW(packet_info.num_payload_words32 == 2);
-                //UHD_ASSERT_THROW(packet_info.packet_type == _packet_type);
+        //get buffer from response endpoint - or die in timeout
+        else
+        {
+            /*
+             * Couldn't get message with haste.
+             * Now check both possible queues for messages.
+             * Messages should come in on _resp_queue,
+             * but could end up in dump_queue.
+             * If we don't get a message --> Die in timeout.
+             */
+            const bool ready = _resp_queue.pop_with_haste(resp_buff) or check_dump_queue(resp_buff);
+            if (not ready and timeout == 0.0) return false;
+            _outstanding_seqs.pop();
+            _outstanding_times.pop();
+            double accum_timeout = 0.0;
+            const double short_timeout = 0.005; // == 5ms
+            while(not (ready
+                    || (_resp_queue.pop_with_haste(resp_buff))
+                    || (check_dump_queue(resp_buff))
+                    || (_resp_queue.pop_with_timed_wait(resp_buff, short_timeout))
+                    )){
+                /*
+                 * If a message couldn't be received within a given timeout
+                 * --> throw AssertionError!
+                 */
+                accum_timeout += short_timeout;
+                UHD_ASSERT_THROW(accum_timeout < timeout);
             }
-            catch(const std::exception &ex)
-            {
-                throw uhd::io_error(str(boost::format("Block ctrl (%s) packet parse error - %s") % _name % ex.what()));
+
+            pkt = resp_buff.data;
+            packet_info.num_packet_words32 = sizeof(resp_buff)/sizeof(uint32_t);
+        }
+
+        //parse the buffer
+        try
+        {
+            packet_info.link_type = _link_type;
+            if (_bige) vrt::chdr::if_hdr_unpack_be(pkt, packet_info);
+            else vrt::chdr::if_hdr_unpack_le(pkt, packet_info);
+        }
+        catch(const std::exception &ex)
+        {
+            UHD_MSG(error) << "[" << _name << "] Block ctrl bad VITA packet: " << ex.what() << std::endl;
+            if (buff){
+                UHD_MSG(status) << boost::format("%08X") % pkt[0] << std::endl;
+                UHD_MSG(status) << boost::format("%08X") % pkt[1] << std::endl;
+                UHD_MSG(status) << boost::format("%08X") % pkt[2] << std::endl;
+                UHD_MSG(status) << boost::format("%08X") % pkt[3] << std::endl;
             }
+            else{
+                UHD_MSG(status) << "buff is NULL" << std::endl;
+            }
+        }
 
-            //return the readback value
-            if (readback and _outstanding_seqs.empty())
-            {
-                const uint64_t hi = (_bige)? uhd::ntohx(pkt[packet_info.num_header_words32+0]) : uhd::wtohx(pkt[packet_info.num_header_words32+0]);
-                const uint64_t lo = (_bige)? uhd::ntohx(pkt[packet_info.num_header_words32+1]) : uhd::wtohx(pkt[packet_info.num_header_words32+1]);
-                return ((hi << 32) | lo);
+        //check the buffer
+        try
+        {
+            UHD_ASSERT_THROW(packet_info.has_sid);
+            if (packet_info.sid != uint32_t((_sid >> 16) | (_sid << 16))) {
+                throw uhd::io_error(
+                    str(
+                        boost::format("Expected SID: %s  Received SID: %s")
+                        % uhd::sid_t(_sid).reversed().to_pp_string_hex()
+                        % uhd::sid_t(packet_info.sid).to_pp_string_hex()
+                    )
+                );
             }
+
+            if (packet_info.packet_count != (seq_to_ack & 0xfff)) {
+                throw uhd::io_error(
+                    str(
+                        boost::format("Expected packet index: %d  Received index: %d")
+                        % packet_info.packet_count
+                        % (seq_to_ack & 0xfff)
+                    )
+                );
+            }
+
+            UHD_ASSERT_THROW(packet_info.num_payload_words32 == 2);
+            //UHD_ASSERT_THROW(packet_info.packet_type == _packet_type);
+        }
+        catch(const std::exception &ex)
+        {
+            throw uhd::io_error(str(boost::format("Block ctrl (%s) packet parse error - %s") % _name % ex.what()));
         }
 
-        return 0;
+        //the readback value
+        const uint64_t hi = (_bige)? uhd::ntohx(pkt[packet_info.num_header_words32+0]) : uhd::wtohx(pkt[packet_info.num_header_words32+0]);
+        const uint64_t lo = (_bige)? uhd::ntohx(pkt[packet_info.num_header_words32+1]) : uhd::wtohx(pkt[packet_info.num_header_words32+1]);
+        value = ((hi << 32) | lo);
+        if (_cmd_done_handler and cmd_time != uhd::time_spec_t(0.0)) _cmd_done_handler(cmd_time);
+        return true;
     }
 
     /*
@@ -321,10 +493,10 @@ private:
         do{
             msg = _async_task->get_msg_from_dump_queue(recv_sid);
         }
-        while(msg.size() < min_buff_size && msg.size() != 0);
+        while(msg.size < min_buff_size && msg.size != 0);
 
-        if(msg.size() >= min_buff_size) {
-            memcpy(b.data, &msg.front(), std::min(msg.size(), sizeof(b.data)));
+        if(msg.size >= min_buff_size) {
+            memcpy(b.data, msg.data, std::min(msg.size, sizeof(b.data)));
             return true;
         }
         return false;
@@ -357,8 +529,15 @@ private:
     double _tick_rate;
     double _timeout;
     std::queue<size_t> _outstanding_seqs;
-    bounded_buffer<resp_buff_type> _resp_queue;
+    std::queue<uhd::time_spec_t> _outstanding_times; //command times of the commands in flight
+    spsc_bounded_buffer<resp_buff_type> _resp_queue;
     const size_t _resp_queue_size;
+    size_t _max_outstanding; //commands in flight before a write waits
+    bool _posted;
+    boost::shared_ptr<uhd::exception> _posted_error;
+    size_t _batch_depth; //nesting of begin_batch() calls
+    uhd::time_spec_t _batch_time;
+    cmd_done_handler_t _cmd_done_handler;
 
     const size_t _rb_address;
 };
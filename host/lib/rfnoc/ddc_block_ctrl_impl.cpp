@@ -49,6 +49,9 @@ public:
 
     UHD_RFNOC_BLOCK_CONSTRUCTOR(ddc_block_ctrl)
     {
+        // All registers are plain settings, skip rewriting unchanged ones
+        set_sr_shadow_enabled(true);
+
         // Argument/prop tree hooks
         for (size_t chan = 0; chan < get_input_ports().size(); chan++) {
             double default_freq = get_arg<double>("freq", chan);
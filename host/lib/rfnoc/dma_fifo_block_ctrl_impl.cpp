@@ -88,6 +88,14 @@ public:
                 .add_coerced_subscriber(boost::bind(&dma_fifo_block_ctrl_impl::resize, this, boost::ref(_perifs[i].base_addr), _1, i))
                 .set(_perifs[i].depth)
             ;
+            //timed playback commands
+            if (_tree->exists("tick_rate")) {
+                const double tick_rate = _tree->access<double>("tick_rate").get();
+                set_command_tick_rate(tick_rate, i);
+                _tree->access<double>("tick_rate")
+                    .add_coerced_subscriber(boost::bind(&block_ctrl_base::set_command_tick_rate, this, _1, i))
+                ;
+            }
         }
     }
 
@@ -106,7 +114,60 @@ public:
         return _perifs[chan].depth;
     }
 
+    bool has_playback(const size_t chan) {
+        return _perifs.at(chan).core->playback_supported();
+    }
+
+    void start_recording(const size_t chan) {
+        boost::lock_guard<boost::mutex> lock(_config_mutex);
+        //stop sending first, then drop what is stored
+        _perifs.at(chan).core->set_playback_mode(dma_fifo_core_3000::PLAYBACK_MODE_RECORD);
+        _perifs.at(chan).core->flush();
+    }
+
+    uint32_t get_recorded_bytes(const size_t chan) {
+        return _perifs.at(chan).core->get_bytes_occupied();
+    }
+
+    void start_playback(const bool loop, const time_spec_t &time, const size_t chan) {
+        boost::lock_guard<boost::mutex> lock(_config_mutex);
+        _set_playback_mode(
+            loop ? dma_fifo_core_3000::PLAYBACK_MODE_PLAY_LOOP : dma_fifo_core_3000::PLAYBACK_MODE_PLAY_ONCE,
+            time, chan);
+    }
+
+    void stop_playback(const time_spec_t &time, const size_t chan) {
+        boost::lock_guard<boost::mutex> lock(_config_mutex);
+        _set_playback_mode(dma_fifo_core_3000::PLAYBACK_MODE_RECORD, time, chan);
+    }
+
+    bool is_playing(const size_t chan) {
+        return _perifs.at(chan).core->is_playing();
+    }
+
+    void stop_recording(const size_t chan) {
+        boost::lock_guard<boost::mutex> lock(_config_mutex);
+        _perifs.at(chan).core->set_playback_mode(dma_fifo_core_3000::PLAYBACK_MODE_FIFO);
+        _perifs.at(chan).core->flush();
+    }
+
 private:
+    void _set_playback_mode(
+            const dma_fifo_core_3000::playback_mode_t mode,
+            const time_spec_t &time,
+            const size_t chan
+    ) {
+        const bool timed = (time != time_spec_t(0.0));
+        if (timed) set_command_time(time, chan);
+        try {
+            _perifs.at(chan).core->set_playback_mode(mode);
+        } catch (...) {
+            if (timed) clear_command_time(chan);
+            throw;
+        }
+        if (timed) clear_command_time(chan);
+    }
+
     struct fifo_perifs_t
     {
         wb_iface::sptr           ctrl;
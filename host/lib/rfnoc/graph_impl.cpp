@@ -27,10 +27,12 @@ using namespace uhd::rfnoc;
  ***************************************************************************/
 graph_impl::graph_impl(
             const std::string &name,
-            boost::weak_ptr<uhd::device3> device_ptr
+            boost::weak_ptr<uhd::device3> device_ptr,
+            const route_fn_t &route_fn
             //async_msg_handler::sptr msg_handler
 ) : _name(name)
   , _device_ptr(device_ptr)
+  , _route_fn(route_fn)
 {
 
 }
@@ -112,6 +114,18 @@ void graph_impl::connect(
     sid_t sid = dst->get_address(dst_block_port);
     sid.set_src(src->get_address(src_block_port));
 
+    // Blocks on different motherboards talk to each other over the
+    // network, without going through the host
+    if (sid.get_src_addr() != sid.get_dst_addr()) {
+        if (not _route_fn) {
+            throw uhd::not_implemented_error(str(
+                boost::format("Can't connect block %s to %s: This device can't stream between motherboards.")
+                % src->get_block_id().get() % dst->get_block_id().get()
+            ));
+        }
+        _route_fn(sid);
+    }
+
     // Set SID on source block
     src->set_destination(sid.get(), src_block_port);
 
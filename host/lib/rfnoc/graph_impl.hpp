@@ -20,20 +20,30 @@
 
 #include <uhd/rfnoc/graph.hpp>
 #include <uhd/device3.hpp>
+#include <uhd/types/sid.hpp>
+#include <boost/function.hpp>
 
 namespace uhd { namespace rfnoc {
 
 class graph_impl : public graph
 {
 public:
+    /*! Sets up the routes for a stream whose source and destination
+     *  blocks are on different motherboards. The argument is the stream's SID.
+     */
+    typedef boost::function<void(const uhd::sid_t &)> route_fn_t;
+
     /*!
      * \param name An optional name to describe this graph
      * \param device_ptr Weak pointer to the originating device3
+     * \param route_fn Routes streams between motherboards. If empty,
+     *                 connecting blocks on different motherboards fails.
      * \param msg_handler Pointer to the async message handler
      */
     graph_impl(
             const std::string &name,
-            boost::weak_ptr<uhd::device3> device_ptr
+            boost::weak_ptr<uhd::device3> device_ptr,
+            const route_fn_t &route_fn = route_fn_t()
             //async_msg_handler::sptr msg_handler
     );
     virtual ~graph_impl() {};
@@ -68,6 +78,9 @@ private:
     //! Reference to the generating device object
     const boost::weak_ptr<uhd::device3> _device_ptr;
 
+    //! Routes streams between motherboards, see route_fn_t
+    const route_fn_t _route_fn;
+
 };
 
 }} /* namespace uhd::rfnoc */
@@ -30,8 +30,13 @@
 #include <uhd/utils/log.hpp>
 #include <uhd/transport/chdr.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/assign.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <algorithm>
 
 #define UHD_LEGACY_LOG() UHD_LOGV(never)
 
@@ -51,6 +56,7 @@ static const std::string DUC_BLOCK_NAME = "DUC";
 static const size_t MAX_BYTES_PER_HEADER =
         uhd::transport::vrt::chdr::max_if_hdr_words64 * sizeof(uint64_t);
 static const size_t BYTES_PER_SAMPLE = 4; // We currently only support sc16
+static const size_t MAX_DRAIN_PACKETS = 10000;
 static boost::mutex _make_mutex;
 
 /************************************************************************
@@ -97,6 +103,151 @@ size_t calc_num_tx_chans_per_radio(
     );
 }
 
+/************************************************************************
+ * Streamer reuse
+ ***********************************************************************/
+//! Stop an RX streamer that is being put aside, so it doesn't overflow
+static void prepare_idle(uhd::rx_streamer::sptr streamer)
+{
+    streamer->issue_stream_cmd(stream_cmd_t(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+}
+
+static void prepare_idle(uhd::tx_streamer::sptr)
+{
+    /* NOP */
+}
+
+//! Throw away whatever an idle RX streamer received since it was put aside
+static void prepare_reuse(uhd::rx_streamer::sptr streamer, const uhd::stream_args_t &args)
+{
+    const size_t bytes_per_samp = uhd::convert::get_bytes_per_item(args.cpu_format);
+    std::vector<std::vector<char> > buffs(
+        streamer->get_num_channels(),
+        std::vector<char>(streamer->get_max_num_samps() * bytes_per_samp)
+    );
+    std::vector<void *> buff_ptrs;
+    for (size_t i = 0; i < buffs.size(); i++) {
+        buff_ptrs.push_back(&buffs[i].front());
+    }
+    uhd::rx_metadata_t md;
+    for (size_t i = 0; i < MAX_DRAIN_PACKETS; i++) {
+        const size_t num_samps = streamer->recv(buff_ptrs, streamer->get_max_num_samps(), md, 0.0);
+        if (num_samps == 0 and md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
+            break;
+        }
+    }
+}
+
+static void prepare_reuse(uhd::tx_streamer::sptr, const uhd::stream_args_t &)
+{
+    /* NOP */
+}
+
+/*! Streamers that the application released, kept around for a while.
+ *
+ * The streamers handed out by legacy_compat are wrappers: When the application
+ * releases one, the actual streamer (and its transports) is moved into this pool
+ * instead of being destroyed. Asking for a streamer with the same arguments again
+ * takes it back out, which skips setting up transports and flow control. Idle
+ * streamers that share a channel with a new streamer are destroyed before it
+ * is made.
+ */
+template <typename streamer_type>
+class idle_streamer_pool : boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<streamer_type> streamer_sptr;
+    typedef boost::shared_ptr<idle_streamer_pool<streamer_type> > sptr;
+
+    //! Take an idle streamer that was made for these args, or return NULL
+    streamer_sptr take(const std::string &key)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        for (typename std::list<entry_t>::iterator it = _idle.begin(); it != _idle.end(); ++it) {
+            if (it->key == key) {
+                streamer_sptr streamer = it->streamer;
+                _idle.erase(it);
+                return streamer;
+            }
+        }
+        return streamer_sptr();
+    }
+
+    //! Destroy all idle streamers that use any of these channels
+    void purge(const std::vector<size_t> &channels)
+    {
+        std::list<entry_t> purged;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            for (typename std::list<entry_t>::iterator it = _idle.begin(); it != _idle.end();) {
+                bool overlaps = false;
+                BOOST_FOREACH(const size_t chan, channels) {
+                    overlaps |= std::find(it->channels.begin(), it->channels.end(), chan) != it->channels.end();
+                }
+                if (overlaps) {
+                    purged.splice(purged.end(), _idle, it++);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        // The streamers in purged are destroyed here, outside the lock
+    }
+
+    //! Wrap a streamer so it's returned to the pool when the application releases it
+    static streamer_sptr wrap(
+            sptr pool,
+            streamer_sptr streamer,
+            const std::string &key,
+            const std::vector<size_t> &channels
+    ) {
+        entry_t entry;
+        entry.key = key;
+        entry.channels = channels;
+        entry.streamer = streamer;
+        return streamer_sptr(streamer.get(), parker_t(pool, entry));
+    }
+
+private:
+    struct entry_t
+    {
+        std::string key;
+        std::vector<size_t> channels;
+        streamer_sptr streamer;
+    };
+
+    //! The deleter of the wrapped streamers
+    struct parker_t
+    {
+        parker_t(sptr pool, const entry_t &entry) : pool(pool), entry(entry) {}
+
+        void operator()(streamer_type *)
+        {
+            sptr pool_sptr = pool.lock();
+            if (not pool_sptr) return; // The streamer is destroyed with entry
+            UHD_SAFE_CALL(prepare_idle(entry.streamer);)
+            boost::mutex::scoped_lock lock(pool_sptr->_mutex);
+            pool_sptr->_idle.push_back(entry);
+        }
+
+        boost::weak_ptr<idle_streamer_pool<streamer_type> > pool;
+        entry_t entry;
+    };
+
+    boost::mutex _mutex;
+    std::list<entry_t> _idle;
+};
+
+//! Identifies a streamer configuration (stream args after setting the block IDs)
+static std::string get_streamer_key(const uhd::stream_args_t &args)
+{
+    std::string key = args.cpu_format + ";" + args.otw_format + ";" + args.args.to_string() + ";";
+    BOOST_FOREACH(const size_t chan, args.channels) {
+        key += str(boost::format("%d,") % chan);
+    }
+    return key;
+}
+
 double lambda_const_double(const double d)
 {
     return d;
@@ -144,7 +295,9 @@ public:
         _rx_spp(get_block_ctrl<radio_ctrl>(0, RADIO_BLOCK_NAME, 0)->get_arg<int>("spp")),
         _tx_spp(_rx_spp),
         _rx_channel_map(_num_mboards, std::vector<radio_port_pair_t>(_num_radios_per_board)),
-        _tx_channel_map(_num_mboards, std::vector<radio_port_pair_t>(_num_radios_per_board))
+        _tx_channel_map(_num_mboards, std::vector<radio_port_pair_t>(_num_radios_per_board)),
+        _idle_rx_streamers(boost::make_shared<idle_streamer_pool<uhd::rx_streamer> >()),
+        _idle_tx_streamers(boost::make_shared<idle_streamer_pool<uhd::tx_streamer> >())
     {
         _device->clear();
         check_available_periphs(); // Throws if invalid configuration.
@@ -275,11 +428,19 @@ public:
         }
         _update_stream_args_for_streaming<uhd::RX_DIRECTION>(args, _rx_channel_map);
         UHD_LEGACY_LOG() << "[legacy_compat] rx stream args: " << args.args.to_string() << std::endl;
-        uhd::rx_streamer::sptr streamer = _device->get_rx_stream(args);
+        const std::string key = get_streamer_key(args);
+        uhd::rx_streamer::sptr streamer = _idle_rx_streamers->take(key);
+        if (streamer) {
+            UHD_LEGACY_LOG() << "[legacy_compat] reusing rx streamer" << std::endl;
+            prepare_reuse(streamer, args);
+        } else {
+            _idle_rx_streamers->purge(args.channels);
+            streamer = _device->get_rx_stream(args);
+        }
         BOOST_FOREACH(const size_t chan, args.channels) {
             _rx_stream_cache[chan] = streamer;
         }
-        return streamer;
+        return idle_streamer_pool<uhd::rx_streamer>::wrap(_idle_rx_streamers, streamer, key, args.channels);
     }
 
     //! Sets block_id<N> and block_port<N> in the streamer args, otherwise forwards the call.
@@ -292,11 +453,19 @@ public:
         }
         _update_stream_args_for_streaming<uhd::TX_DIRECTION>(args, _tx_channel_map);
         UHD_LEGACY_LOG() << "[legacy_compat] tx stream args: " << args.args.to_string() << std::endl;
-        uhd::tx_streamer::sptr streamer = _device->get_tx_stream(args);
+        const std::string key = get_streamer_key(args);
+        uhd::tx_streamer::sptr streamer = _idle_tx_streamers->take(key);
+        if (streamer) {
+            UHD_LEGACY_LOG() << "[legacy_compat] reusing tx streamer" << std::endl;
+            prepare_reuse(streamer, args);
+        } else {
+            _idle_tx_streamers->purge(args.channels);
+            streamer = _device->get_tx_stream(args);
+        }
         BOOST_FOREACH(const size_t chan, args.channels) {
             _tx_stream_cache[chan] = streamer;
         }
-        return streamer;
+        return idle_streamer_pool<uhd::tx_streamer>::wrap(_idle_tx_streamers, streamer, key, args.channels);
     }
 
     double get_tick_rate(const size_t mboard_idx=0)
@@ -487,7 +656,11 @@ private: // methods
             }
             for (size_t mboard = 0; mboard < _num_mboards; mboard++) {
                 for (size_t radio = 0; radio < _num_radios_per_board; radio++) {
-                    get_block_ctrl<radio_ctrl>(mboard, RADIO_BLOCK_NAME, radio)->set_arg<int>("spp", target_spp);
+                    // Skip the register writes if nothing changes
+                    radio_ctrl::sptr radio_ctrl_sptr = get_block_ctrl<radio_ctrl>(mboard, RADIO_BLOCK_NAME, radio);
+                    if (radio_ctrl_sptr->get_arg<int>("spp") != int(target_spp)) {
+                        radio_ctrl_sptr->set_arg<int>("spp", target_spp);
+                    }
                 }
             }
             _rx_spp = target_spp;
@@ -884,6 +1057,10 @@ private: // attributes
     typedef std::map< size_t, boost::weak_ptr<uhd::tx_streamer> > tx_stream_map_type;
     tx_stream_map_type _tx_stream_cache;
 
+    //! Streamers that were released by the application, for reuse
+    idle_streamer_pool<uhd::rx_streamer>::sptr _idle_rx_streamers;
+    idle_streamer_pool<uhd::tx_streamer>::sptr _idle_tx_streamers;
+
     graph::sptr _graph;
 };
 
@@ -117,7 +117,10 @@ void block_iface::run_and_check(const std::string &code, const std::string &erro
     boost::mutex::scoped_lock local_interpreter_lock(_lil_mutex);
 
     UHD_NOCSCRIPT_LOG() << "[NocScript] Executing and asserting code: " << code << std::endl;
-    expression::sptr e = _parser->create_expr_tree(code);
+    expression::sptr &e = _compiled[code];
+    if (not e) {
+        e = _parser->create_expr_tree(code);
+    }
     expression_literal result = e->eval();
     if (not result.to_bool()) {
         if (error_message.empty()) {
@@ -157,32 +160,37 @@ expression_literal block_iface::_nocscript__sr_write(expression_container::expr_
 
 expression::type_t block_iface::_nocscript__arg_get_type(const std::string &varname)
 {
+    std::map<std::string, expression::type_t>::const_iterator it = _arg_types.find(varname);
+    if (it != _arg_types.end()) {
+        return it->second;
+    }
     const std::string var_type = _block_ptr->get_arg_type(varname);
+    expression::type_t type;
     if (var_type == "int") {
-        return expression::TYPE_INT;
+        type = expression::TYPE_INT;
     } else if (var_type == "string") {
-        return expression::TYPE_STRING;
+        type = expression::TYPE_STRING;
     } else if (var_type == "double") {
-        return expression::TYPE_DOUBLE;
+        type = expression::TYPE_DOUBLE;
     } else if (var_type == "int_vector") {
         UHD_THROW_INVALID_CODE_PATH(); // TODO
     } else {
         UHD_THROW_INVALID_CODE_PATH();
     }
+    _arg_types[varname] = type;
+    return type;
 }
 
 expression_literal block_iface::_nocscript__arg_get_val(const std::string &varname)
 {
-    const std::string var_type = _block_ptr->get_arg_type(varname);
-    if (var_type == "int") {
+    switch (_nocscript__arg_get_type(varname)) {
+    case expression::TYPE_INT:
         return expression_literal(_block_ptr->get_arg<int>(varname));
-    } else if (var_type == "string") {
+    case expression::TYPE_STRING:
         return expression_literal(_block_ptr->get_arg<std::string>(varname));
-    } else if (var_type == "double") {
+    case expression::TYPE_DOUBLE:
         return expression_literal(_block_ptr->get_arg<double>(varname));
-    } else if (var_type == "int_vector") {
-        UHD_THROW_INVALID_CODE_PATH(); // TODO
-    } else {
+    default:
         UHD_THROW_INVALID_CODE_PATH();
     }
 }
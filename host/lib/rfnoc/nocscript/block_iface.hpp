@@ -86,6 +86,12 @@ class block_iface {
 
     //! Container for scoped variables
     std::map<std::string, expression_literal> _vars;
+
+    //! Expression trees of the code run so far, so each is parsed only once
+    std::map<std::string, expression::sptr> _compiled;
+
+    //! Types of the arguments looked up so far (they never change)
+    std::map<std::string, expression::type_t> _arg_types;
 };
 
 }}} /* namespace uhd::rfnoc::nocscript */
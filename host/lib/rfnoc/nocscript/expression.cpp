@@ -361,7 +361,11 @@ expression::type_t expression_function::infer_type() const
 
 expression_literal expression_function::eval()
 {
-    return _func_table->eval(_name, _arg_types, _sub_exprs);
+    // The signature is fixed once parsed, so only look the function up once
+    if (not _function) {
+        _function = _func_table->get_function(_name, _arg_types);
+    }
+    return _function(_sub_exprs);
 }
 
 
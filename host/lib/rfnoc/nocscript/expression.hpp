@@ -324,6 +324,8 @@ class expression_function : public expression_container
     std::string _name;
     const boost::shared_ptr<function_table> _func_table;
     std::vector<expression::type_t> _arg_types;
+    //! The function for this signature, looked up on the first eval()
+    boost::function<expression_literal(expression_container::expr_list_type&)> _function;
 };
 
 
@@ -84,14 +84,21 @@ class function_table_impl : public function_table
             const expression_function::argtype_list_type &arg_types,
             expression_container::expr_list_type &arguments
     ) {
-        if (not function_exists(name, arg_types)) {
+        return get_function(name, arg_types)(arguments);
+    }
+
+    function_ptr get_function(
+            const std::string &name,
+            const expression_function::argtype_list_type &arg_types
+    ) const {
+        table_type::const_iterator it = _table.find(name);
+        if (it == _table.end() or (it->second.find(arg_types) == it->second.end())) {
             throw uhd::syntax_error(str(
                         boost::format("Cannot eval() function %s, not a known signature")
                         % expression_function::to_string(name, arg_types)
             ));
         }
-
-        return _table[name][arg_types].function(arguments);
+        return it->second.find(arg_types)->second.function;
     }
 
     void register_function(
@@ -72,6 +72,15 @@ class function_table
             expression_container::expr_list_type &arguments
     ) = 0;
 
+    /*! Return the function for a signature, to call it without a lookup
+     *
+     * \throws uhd::syntax_error if there is no function with this name and signature
+     */
+    virtual function_ptr get_function(
+            const std::string &name,
+            const expression_function::argtype_list_type &arg_types
+    ) const = 0;
+
     /*! Register a new function
      *
      * \param name Name of the function (e.g. 'ADD')
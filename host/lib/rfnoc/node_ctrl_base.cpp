@@ -17,6 +17,8 @@
 
 #include <uhd/rfnoc/node_ctrl_base.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/static.hpp>
 #include <boost/range/adaptor/map.hpp>
 
 using namespace uhd::rfnoc;
@@ -34,6 +36,19 @@ void node_ctrl_base::clear()
     // Reset connections:
     _upstream_nodes.clear();
     _downstream_nodes.clear();
+    _topology_changed();
+}
+
+UHD_SINGLETON_FCN(uhd::atomic_uint32_t, get_topology_counter);
+
+void node_ctrl_base::_topology_changed()
+{
+    get_topology_counter().inc();
+}
+
+uint32_t node_ctrl_base::_get_topology_generation()
+{
+    return get_topology_counter().read();
 }
 
 void node_ctrl_base::_register_downstream_node(
@@ -126,6 +141,7 @@ void node_ctrl_base::disconnect()
     _downstream_ports.clear();
     _upstream_nodes.clear();
     _upstream_ports.clear();
+    _topology_changed();
 }
 
 void node_ctrl_base::disconnect_output_port(const size_t output_port)
@@ -136,6 +152,7 @@ void node_ctrl_base::disconnect_output_port(const size_t output_port)
     }
     _downstream_nodes.erase(output_port);
     _downstream_ports.erase(output_port);
+    _topology_changed();
 }
 
 void node_ctrl_base::disconnect_input_port(const size_t input_port)
@@ -146,5 +163,6 @@ void node_ctrl_base::disconnect_input_port(const size_t input_port)
     }
     _upstream_nodes.erase(input_port);
     _upstream_ports.erase(input_port);
+    _topology_changed();
 }
 
@@ -21,6 +21,7 @@
 #include <boost/bind.hpp>
 #include <uhd/convert.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <uhd/types/ranges.hpp>
 #include <uhd/types/direction.hpp>
 #include "radio_ctrl_impl.hpp"
@@ -108,6 +109,14 @@ radio_ctrl_impl::radio_ctrl_impl() :
             .set_publisher(boost::bind(&radio_ctrl_impl::get_time_now, this))
         ;
     }
+    if (not _tree->exists(fs_path("time") / "estimate")) {
+        _tree->create<time_spec_t>(fs_path("time") / "estimate")
+            .set_publisher(boost::bind(&time_core_3000::get_time_estimate, _time64, static_cast<double *>(NULL)))
+        ;
+        _tree->create<double>(fs_path("time") / "estimate_error")
+            .set_publisher(boost::bind(&time_core_3000::get_time_estimate_error, _time64))
+        ;
+    }
     if (not _tree->exists(fs_path("time") / "pps")) {
         _tree->create<time_spec_t>(fs_path("time") / "pps")
             .set_publisher(boost::bind(&radio_ctrl_impl::get_time_last_pps, this))
@@ -273,11 +282,19 @@ void radio_ctrl_impl::issue_stream_cmd(const uhd::stream_cmd_t &stream_cmd, cons
     cmd_word |= uint32_t((inst_stop)?             1 : 0) << 28;
     cmd_word |= (inst_samps)? stream_cmd.num_samps : ((inst_stop)? 0 : 1);
 
-    //issue the stream command
+    //issue the stream command, posting the writes so that they cost one round trip
     const uint64_t ticks = (stream_cmd.stream_now)? 0 : stream_cmd.time_spec.to_ticks(get_rate());
-    sr_write(regs::RX_CTRL_CMD, cmd_word, chan);
-    sr_write(regs::RX_CTRL_TIME_HI, uint32_t(ticks >> 32), chan);
-    sr_write(regs::RX_CTRL_TIME_LO, uint32_t(ticks >> 0),  chan); //latches the command
+    wb_iface::sptr iface = get_ctrl_iface(chan);
+    iface->begin_batch();
+    try {
+        sr_write(regs::RX_CTRL_CMD, cmd_word, chan);
+        sr_write(regs::RX_CTRL_TIME_HI, uint32_t(ticks >> 32), chan);
+        sr_write(regs::RX_CTRL_TIME_LO, uint32_t(ticks >> 0),  chan); //latches the command
+    } catch (...) {
+        UHD_SAFE_CALL(iface->commit();)
+        throw;
+    }
+    iface->commit();
 }
 
 std::vector<size_t> radio_ctrl_impl::get_active_rx_ports()
@@ -25,6 +25,11 @@
 
 using namespace uhd::rfnoc;
 
+//! How far ahead a multi-channel restart after an overrun is timed
+static const double RESTART_LEAD_TIME = 0.05;
+//! The same without the flush, for the `continue' overflow policy
+static const double FAST_RESTART_LEAD_TIME = 0.005;
+
 size_t rx_stream_terminator::_count = 0;
 
 rx_stream_terminator::rx_stream_terminator() :
@@ -62,7 +67,7 @@ void rx_stream_terminator::set_rx_streamer(bool active, const size_t)
     }
 }
 
-void rx_stream_terminator::handle_overrun(boost::weak_ptr<uhd::rx_streamer> streamer, const size_t)
+void rx_stream_terminator::handle_overrun(boost::weak_ptr<uhd::rx_streamer> streamer, const size_t, const bool fast)
 {
     std::vector<boost::shared_ptr<uhd::rfnoc::radio_ctrl_impl> > upstream_radio_nodes =
         find_upstream_node<uhd::rfnoc::radio_ctrl_impl>();
@@ -109,12 +114,16 @@ void rx_stream_terminator::handle_overrun(boost::weak_ptr<uhd::rx_streamer> stre
         }
     }
     //flush transports
-    my_streamer->flush_all(0.001); // TODO flushing will probably have to go away.
+    //Without the flush, the packets still in flight are dropped by the
+    //receive packet handler's alignment logic once the restart is aligned.
+    if (not fast) {
+        my_streamer->flush_all(0.001); // TODO flushing will probably have to go away.
+    }
     //restart streaming on all channels
     if (in_continuous_streaming_mode) {
         stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
         stream_cmd.stream_now = false;
-        stream_cmd.time_spec = upstream_radio_nodes[0]->get_time_now() + time_spec_t(0.05);
+        stream_cmd.time_spec = upstream_radio_nodes[0]->get_time_now() + time_spec_t(fast ? FAST_RESTART_LEAD_TIME : RESTART_LEAD_TIME);
 
         BOOST_FOREACH(const boost::shared_ptr<uhd::rfnoc::radio_ctrl_impl> &node, upstream_radio_nodes) {
             BOOST_FOREACH(const size_t port, node->get_active_rx_ports()) {
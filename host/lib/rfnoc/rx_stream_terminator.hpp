@@ -63,7 +63,12 @@ public:
 
     virtual ~rx_stream_terminator();
 
-    void handle_overrun(boost::weak_ptr<uhd::rx_streamer>, const size_t);
+    /*!
+     * Restart streaming after an overrun.
+     * \param fast skip the flush and restart multi-channel streams sooner,
+     *        for the `continue' overflow policy
+     */
+    void handle_overrun(boost::weak_ptr<uhd::rx_streamer>, const size_t, const bool fast = false);
 
 protected:
     rx_stream_terminator();
@@ -92,5 +92,6 @@ void source_node_ctrl::_register_downstream_node(
     // Alles klar, Herr Kommissar :)
 
     _downstream_nodes[port] = boost::weak_ptr<node_ctrl_base>(downstream_node);
+    _topology_changed();
 }
 
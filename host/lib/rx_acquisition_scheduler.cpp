@@ -0,0 +1,223 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/rx_acquisition_scheduler.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <algorithm>
+#include <deque>
+
+using namespace uhd;
+
+rx_acquisition_scheduler::~rx_acquisition_scheduler(void)
+{
+    /* NOP */
+}
+
+struct rx_capture_t
+{
+    uint32_t id;
+    time_spec_t time;
+    size_t nsamps;
+    size_t received;
+};
+
+class rx_acquisition_scheduler_impl : public rx_acquisition_scheduler
+{
+public:
+    rx_acquisition_scheduler_impl(
+        rx_streamer::sptr streamer,
+        const double samp_rate,
+        const size_t queue_depth
+    ):
+        _streamer(streamer),
+        _samp_rate(samp_rate),
+        _queue_depth(queue_depth),
+        _next_id(0),
+        _num_issued(0),
+        _chain_open(false),
+        _issued_end(0),
+        _has_last(false),
+        _last_nsamps(0)
+    {
+        if (samp_rate <= 0.0) {
+            throw uhd::value_error("rx_acquisition_scheduler: the sample rate must be positive");
+        }
+        //the next command must be queued before the current one ends
+        if (queue_depth < 2) {
+            throw uhd::value_error("rx_acquisition_scheduler: the queue depth must be at least 2");
+        }
+    }
+
+    ~rx_acquisition_scheduler_impl(void)
+    {
+        UHD_SAFE_CALL(
+            if (_num_issued > 0) {
+                _streamer->issue_stream_cmd(stream_cmd_t(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+            }
+        )
+    }
+
+    uint32_t schedule(const time_spec_t &time, const size_t nsamps)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (nsamps == 0) {
+            throw uhd::value_error("rx_acquisition_scheduler: a capture needs samples");
+        }
+        if (_has_last and (time - _last_time).to_ticks(_samp_rate) < (long long)(_last_nsamps)) {
+            throw uhd::value_error(str(boost::format(
+                "rx_acquisition_scheduler: the capture at %f s starts before the end of the one before")
+                % time.get_real_secs()));
+        }
+        rx_capture_t capture;
+        capture.id = _next_id++;
+        capture.time = time;
+        capture.nsamps = nsamps;
+        capture.received = 0;
+        _captures.push_back(capture);
+        _has_last = true;
+        _last_time = time;
+        _last_nsamps = nsamps;
+
+        this->issue_more(false);
+        _cond.notify_one();
+        return capture.id;
+    }
+
+    size_t get_num_pending(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _captures.size();
+    }
+
+    size_t recv(
+        const rx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        uint32_t &capture_id,
+        const double timeout
+    ){
+        metadata.reset();
+        rx_capture_t capture;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_captures.empty()) {
+                _cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6)));
+            }
+            if (_captures.empty()) {
+                metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+                return 0;
+            }
+            this->issue_more(true);
+            capture = _captures.front();
+        }
+        capture_id = capture.id;
+
+        size_t nsamps = 0;
+        while (true) {
+            nsamps = _streamer->recv(buffs,
+                std::min(nsamps_per_buff, capture.nsamps - capture.received), metadata, timeout);
+            if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) break;
+            //samples left over from before an error
+            if (capture.received == 0 and metadata.has_time_spec
+                and (metadata.time_spec - capture.time).to_ticks(_samp_rate) < 0) continue;
+            break;
+        }
+
+        boost::mutex::scoped_lock lock(_mutex);
+        if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            if (metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                this->restart();
+            }
+            return 0;
+        }
+        rx_capture_t &current = _captures.front();
+        metadata.start_of_burst = (current.received == 0);
+        metadata.end_of_burst = false;
+        current.received += nsamps;
+        if (current.received == current.nsamps) {
+            metadata.end_of_burst = true;
+            _captures.pop_front();
+            _num_issued--;
+            this->issue_more(true);
+        }
+        return nsamps;
+    }
+
+private:
+    /*!
+     * Keep up to queue_depth commands issued, call locked.
+     * The last capture is held back until recv() needs it (last), as a
+     * capture scheduled after it could not be chained anymore.
+     */
+    void issue_more(const bool last)
+    {
+        while (_num_issued < _captures.size() and _num_issued < _queue_depth) {
+            const rx_capture_t &capture = _captures[_num_issued];
+            const bool has_next = (_num_issued + 1 < _captures.size());
+            if (not has_next and not last) break;
+            stream_cmd_t cmd(has_next?
+                stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE : stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+            cmd.num_samps = capture.nsamps;
+            cmd.stream_now = _chain_open and _issued_end == capture.time.to_ticks(_samp_rate);
+            cmd.time_spec = capture.time;
+            _streamer->issue_stream_cmd(cmd);
+            _chain_open = has_next;
+            _issued_end = capture.time.to_ticks(_samp_rate) + (long long)(capture.nsamps);
+            _num_issued++;
+        }
+    }
+
+    //! After an error: drop the issued captures, issue the others afresh
+    void restart(void)
+    {
+        _streamer->issue_stream_cmd(stream_cmd_t(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS));
+        UHD_MSG(warning) << boost::format(
+            "rx_acquisition_scheduler: %u captures lost") % _num_issued << std::endl;
+        _captures.erase(_captures.begin(), _captures.begin() + _num_issued);
+        _num_issued = 0;
+        _chain_open = false;
+        this->issue_more(true);
+    }
+
+    rx_streamer::sptr _streamer;
+    const double _samp_rate;
+    const size_t _queue_depth;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::deque<rx_capture_t> _captures; //the first _num_issued have commands
+    uint32_t _next_id;
+    size_t _num_issued;
+    bool _chain_open; //the last command issued was NUM_SAMPS_AND_MORE
+    long long _issued_end; //in ticks, after the last capture issued
+    bool _has_last;
+    time_spec_t _last_time; //of the capture scheduled last
+    size_t _last_nsamps;
+};
+
+rx_acquisition_scheduler::sptr rx_acquisition_scheduler::make(
+    rx_streamer::sptr streamer,
+    const double samp_rate,
+    const size_t queue_depth
+){
+    return sptr(new rx_acquisition_scheduler_impl(streamer, samp_rate, queue_depth));
+}
@@ -0,0 +1,233 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/rx_capture_ring.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+using namespace uhd;
+
+rx_capture_ring::~rx_capture_ring(void)
+{
+    /* NOP */
+}
+
+rx_capture_ring::view_t::view_t(void):
+    first_sample(0)
+{
+    nsamps[0] = nsamps[1] = 0;
+}
+
+class rx_capture_ring_impl : public rx_capture_ring
+{
+public:
+    rx_capture_ring_impl(
+        rx_streamer::sptr streamer,
+        const std::string &cpu_format,
+        const double samp_rate,
+        const double duration
+    ):
+        _streamer(streamer),
+        _bytes_per_item(convert::get_bytes_per_item(cpu_format)),
+        _samp_rate(samp_rate),
+        _capacity(std::max<size_t>(
+            size_t(std::ceil(samp_rate*duration)), 2*streamer->get_max_num_samps())),
+        _buffs(streamer->get_num_channels()),
+        _num_written(0),
+        _num_claimed(0),
+        _new_segment(true),
+        _num_errors(0)
+    {
+        if (samp_rate <= 0.0 or duration <= 0.0) {
+            throw uhd::value_error("rx_capture_ring: the sample rate and duration must be positive");
+        }
+        if (convert::get_num_planes(cpu_format) != 1) {
+            throw uhd::value_error("rx_capture_ring: planar cpu formats are not supported");
+        }
+        for (size_t i = 0; i < _buffs.size(); i++) {
+            _buffs[i].resize(_capacity*_bytes_per_item);
+        }
+        _task = task::make(boost::bind(&rx_capture_ring_impl::capture, this), "rx", "rx capture ring");
+    }
+
+    ~rx_capture_ring_impl(void)
+    {
+        UHD_SAFE_CALL(
+            _task.reset();
+        )
+    }
+
+    bool get_window(view_t &view, const time_spec_t &time_spec, const size_t nsamps)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_segments.empty() or nsamps > _capacity) return false;
+
+        //the last stretch that starts no later than the window
+        size_t seg = _segments.size();
+        while (seg > 0 and _segments[seg-1].time_spec > time_spec) seg--;
+        if (seg == 0) return false;
+        const segment_t &segment = _segments[seg-1];
+        const uint64_t segment_end = (seg < _segments.size())? _segments[seg].first_sample : _num_written;
+
+        const long long offset = (time_spec - segment.time_spec).to_ticks(_samp_rate);
+        const uint64_t first = segment.first_sample + uint64_t(offset);
+        if (first + nsamps > segment_end or first < oldest_sample()) return false;
+
+        const size_t pos = size_t(first % _capacity);
+        view.time_spec = segment.time_spec + time_spec_t::from_ticks(offset, _samp_rate);
+        view.first_sample = first;
+        view.nsamps[0] = std::min(nsamps, _capacity - pos);
+        view.nsamps[1] = nsamps - view.nsamps[0];
+        for (size_t part = 0; part < 2; part++) {
+            view.buffs[part].resize(_buffs.size());
+            const size_t part_pos = (part == 0)? pos : 0;
+            for (size_t i = 0; i < _buffs.size(); i++) {
+                view.buffs[part][i] = &_buffs[i].front() + part_pos*_bytes_per_item;
+            }
+        }
+        return true;
+    }
+
+    bool still_valid(const view_t &view)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return view.first_sample >= oldest_sample();
+    }
+
+    time_spec_t get_oldest_time(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_segments.empty()) return time_spec_t(0.0);
+        return time_of(std::max(oldest_sample(), _segments.front().first_sample));
+    }
+
+    time_spec_t get_newest_time(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_segments.empty()) return time_spec_t(0.0);
+        return time_of(_num_written);
+    }
+
+    size_t get_num_errors(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _num_errors;
+    }
+
+private:
+    //! A stretch of samples without gaps, starting at a known time
+    struct segment_t
+    {
+        uint64_t first_sample;
+        time_spec_t time_spec;
+    };
+
+    //! The oldest sample not overwritten (or about to be), call locked
+    uint64_t oldest_sample(void) const
+    {
+        return (_num_claimed > _capacity)? _num_claimed - _capacity : 0;
+    }
+
+    //! The time of a sample in the ring, call locked
+    time_spec_t time_of(const uint64_t sample) const
+    {
+        size_t seg = _segments.size();
+        while (seg > 1 and _segments[seg-1].first_sample > sample) seg--;
+        const segment_t &segment = _segments[seg-1];
+        return segment.time_spec + time_spec_t::from_ticks(
+            (long long)(sample - segment.first_sample), _samp_rate);
+    }
+
+    void capture(void)
+    {
+        //receive up to a packet, without wrapping around the end
+        const uint64_t first = _num_written;
+        const size_t pos = size_t(first % _capacity);
+        const size_t nsamps = std::min(_streamer->get_max_num_samps(), _capacity - pos);
+        {
+            //readers must stop trusting what is about to be overwritten
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_claimed = first + nsamps;
+        }
+
+        std::vector<void *> buffs(_buffs.size());
+        for (size_t i = 0; i < _buffs.size(); i++) {
+            buffs[i] = &_buffs[i].front() + pos*_bytes_per_item;
+        }
+        rx_metadata_t md;
+        const size_t num_rx_samps = _streamer->recv(buffs, nsamps, md, 0.1, true);
+
+        boost::mutex::scoped_lock lock(_mutex);
+        if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            if (md.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                _num_errors++;
+                _new_segment = true; //samples were lost
+            }
+            if (num_rx_samps == 0) return;
+        }
+
+        //start a new stretch after a gap or when the time does not follow on
+        if (not _new_segment and md.has_time_spec) {
+            const long long expected = time_of(first).to_ticks(_samp_rate);
+            _new_segment = (md.time_spec.to_ticks(_samp_rate) != expected);
+        }
+        if (_new_segment) {
+            if (not md.has_time_spec) return; //cannot index these samples
+            segment_t segment;
+            segment.first_sample = first;
+            segment.time_spec = md.time_spec;
+            _segments.push_back(segment);
+            _new_segment = false;
+        }
+        _num_written = first + num_rx_samps;
+
+        //forget the stretches that were overwritten completely
+        while (_segments.size() > 1 and _segments[1].first_sample <= oldest_sample()) {
+            _segments.pop_front();
+        }
+    }
+
+    rx_streamer::sptr _streamer;
+    const size_t _bytes_per_item;
+    const double _samp_rate;
+    const size_t _capacity; //in samples per channel
+    std::vector<std::vector<char> > _buffs;
+    boost::mutex _mutex;
+    uint64_t _num_written; //samples received since the start
+    uint64_t _num_claimed; //samples received or being received
+    std::deque<segment_t> _segments;
+    bool _new_segment;
+    size_t _num_errors;
+    task::sptr _task; //declared last, uses the members above
+};
+
+rx_capture_ring::sptr rx_capture_ring::make(
+    rx_streamer::sptr streamer,
+    const std::string &cpu_format,
+    const double samp_rate,
+    const double duration
+){
+    return sptr(new rx_capture_ring_impl(streamer, cpu_format, samp_rate, duration));
+}
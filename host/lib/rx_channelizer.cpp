@@ -0,0 +1,414 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_fir.hpp"
+#include <uhd/rx_channelizer.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+using namespace uhd;
+
+static const size_t CHAN_TAPS_PER_CHAN = 16; //default prototype length
+static const size_t CHAN_MIN_OUTPUTS_PER_THREAD = 16;
+
+rx_channelizer::~rx_channelizer(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Inverse FFT of a power of two size, in place, without scaling
+ **********************************************************************/
+class chan_ifft
+{
+public:
+    chan_ifft(const size_t size): _size(size), _rev(size), _twiddles(size/2)
+    {
+        static const double pi = std::acos(-1.0);
+        size_t bits = 0;
+        while ((size_t(1) << bits) < size) bits++;
+        for (size_t i = 0; i < size; i++) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; b++) {
+                if (i & (size_t(1) << b)) r |= size_t(1) << (bits - 1 - b);
+            }
+            _rev[i] = r;
+        }
+        for (size_t i = 0; i < size/2; i++) {
+            _twiddles[i] = std::complex<float>(std::polar(1.0, 2*pi*i/size));
+        }
+    }
+
+    void operator()(std::complex<float> *x) const
+    {
+        for (size_t i = 0; i < _size; i++) {
+            if (i < _rev[i]) std::swap(x[i], x[_rev[i]]);
+        }
+        for (size_t half = 1; half < _size; half *= 2) {
+            const size_t step = _size/(2*half);
+            for (size_t start = 0; start < _size; start += 2*half) {
+                for (size_t k = 0; k < half; k++) {
+                    const std::complex<float> t = _twiddles[k*step]*x[start+k+half];
+                    x[start+k+half] = x[start+k] - t;
+                    x[start+k] += t;
+                }
+            }
+        }
+    }
+
+private:
+    const size_t _size;
+    std::vector<size_t> _rev;
+    std::vector<std::complex<float> > _twiddles;
+};
+
+/***********************************************************************
+ * Implementation
+ *
+ * Output j of every channel is computed from the window of L = T*M
+ * input samples that ends with input sample j*M + L - 1. The window,
+ * multiplied by the time reversed prototype, is folded into M sums of
+ * every M-th product (one per polyphase branch). An inverse DFT over
+ * the branches then gives the M channels:
+ *
+ *     y_k[j] = sum over m < L of h[m]*x[j*M + L-1 - m]*exp(2j*pi*k*m/M)
+ *
+ * Folding row r = i mod M of the window gives branch M-1 - r.
+ **********************************************************************/
+class rx_channelizer_impl : public rx_channelizer
+{
+public:
+    rx_channelizer_impl(
+        rx_streamer::sptr streamer,
+        const size_t num_chans,
+        const double samp_rate,
+        const std::vector<float> &taps,
+        const size_t num_threads
+    ):
+        _streamer(streamer),
+        _num_chans(num_chans),
+        _samp_rate(samp_rate),
+        _fold(convert::get_pfb_fold_kernel()),
+        _ifft(num_chans),
+        _in_len(0),
+        _has_time(false),
+        _pending_error(rx_metadata_t::ERROR_CODE_NONE),
+        _job_out(NULL),
+        _job_offset(0),
+        _job_count(0),
+        _job_threads(0),
+        _job_generation(0),
+        _job_remaining(0)
+    {
+        if (num_chans < 2 or (num_chans & (num_chans - 1)) != 0) {
+            throw uhd::value_error(str(boost::format(
+                "rx_channelizer: the number of channels must be a power of two, not %u") % num_chans));
+        }
+        if (streamer->get_num_channels() != 1) {
+            throw uhd::value_error("rx_channelizer: the streamer must have exactly one channel");
+        }
+        if (samp_rate <= 0.0) {
+            throw uhd::value_error("rx_channelizer: the sample rate must be positive");
+        }
+
+        _taps = taps.empty()? make_default_taps(num_chans) : taps;
+        _taps.resize(((_taps.size() + num_chans - 1)/num_chans)*num_chans, 0.0f);
+        _window_len = _taps.size();
+
+        //time reversed, each tap twice for I and Q
+        _fold_taps.resize(2*_window_len);
+        for (size_t i = 0; i < _window_len; i++) {
+            _fold_taps[2*i+0] = _fold_taps[2*i+1] = _taps[_window_len - 1 - i];
+        }
+
+        this->reset_history();
+        const size_t nthreads = std::max<size_t>(num_threads, 1);
+        _scratch.resize(nthreads);
+        for (size_t i = 0; i < nthreads; i++) {
+            _scratch[i].resize(2*num_chans);
+        }
+        _worker_generation.resize(nthreads, _job_generation);
+        for (size_t i = 1; i < nthreads; i++) {
+            _workers.push_back(task::make(
+                boost::bind(&rx_channelizer_impl::worker, this, i), "rx", "rx channelizer"));
+        }
+    }
+
+    ~rx_channelizer_impl(void)
+    {
+        UHD_SAFE_CALL(
+            _workers.clear();
+        )
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return _num_chans;
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return std::max<size_t>(_streamer->get_max_num_samps()/_num_chans, 1);
+    }
+
+    std::vector<float> get_taps(void) const
+    {
+        return _taps;
+    }
+
+    void issue_stream_cmd(const stream_cmd_t &stream_cmd)
+    {
+        stream_cmd_t cmd = stream_cmd;
+        cmd.num_samps *= _num_chans;
+        _streamer->issue_stream_cmd(cmd);
+    }
+
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        const double timeout,
+        const bool one_packet
+    ){
+        metadata.reset();
+        if (_pending_error != rx_metadata_t::ERROR_CODE_NONE) {
+            metadata.error_code = _pending_error;
+            _pending_error = rx_metadata_t::ERROR_CODE_NONE;
+            return 0;
+        }
+
+        size_t nsamps = 0;
+        bool eob = false;
+        while (true) {
+            //outputs whose windows are complete
+            const size_t avail = (_in_len >= _window_len)? (_in_len - _window_len)/_num_chans + 1 : 0;
+            const size_t n = std::min(avail, nsamps_per_buff - nsamps);
+            if (n > 0) {
+                if (nsamps == 0) {
+                    metadata.has_time_spec = _has_time;
+                    metadata.time_spec = this->time_of(_window_len - 1);
+                }
+                this->compute(buffs, nsamps, n);
+                this->consume(n*_num_chans);
+                nsamps += n;
+            }
+            if (nsamps == nsamps_per_buff or (one_packet and nsamps > 0) or eob) break;
+
+            rx_metadata_t md;
+            const size_t num_items = _streamer->recv_zero_copy(_zc_buffs, md, timeout);
+            if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+                _zc_buffs.release();
+                if (md.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW) {
+                    this->reset_history();
+                }
+                if (nsamps == 0) {
+                    metadata.error_code = md.error_code;
+                    metadata.out_of_sequence = md.out_of_sequence;
+                } else if (md.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                    _pending_error = md.error_code;
+                }
+                break;
+            }
+            this->append(md, num_items);
+            if (md.end_of_burst) {
+                metadata.end_of_burst = eob = true;
+            }
+        }
+        return nsamps;
+    }
+
+private:
+    //! A windowed sinc with its cutoff at half the channel spacing
+    static std::vector<float> make_default_taps(const size_t num_chans)
+    {
+        static const double pi = std::acos(-1.0);
+        const size_t ntaps = CHAN_TAPS_PER_CHAN*num_chans;
+        std::vector<float> taps(ntaps);
+        for (size_t i = 0; i < ntaps; i++) {
+            const double t = (i - (ntaps - 1)/2.0)/num_chans;
+            const double sinc = (t == 0.0)? 1.0 : std::sin(pi*t)/(pi*t);
+            const double window = 0.42 - 0.5*std::cos(2*pi*(i + 0.5)/ntaps) + 0.08*std::cos(4*pi*(i + 0.5)/ntaps);
+            taps[i] = float(sinc*window/num_chans);
+        }
+        return taps;
+    }
+
+    //! Start over with a history of zeros, e.g. after an overflow
+    void reset_history(void)
+    {
+        _in_len = _window_len - _num_chans;
+        _in.assign(_in_len, std::complex<float>(0.0f, 0.0f));
+        _has_time = false;
+    }
+
+    time_spec_t time_of(const size_t index) const
+    {
+        return _in_time + time_spec_t::from_ticks((long long)(index), _samp_rate);
+    }
+
+    //! Convert a packet into the history, straight from the transport
+    void append(const rx_metadata_t &md, const size_t num_items)
+    {
+        if (not _conv or _zc_buffs.item_format != _conv_format) {
+            convert::id_type id;
+            id.input_format = _zc_buffs.item_format;
+            id.num_inputs = 1;
+            id.output_format = "fc32";
+            id.num_outputs = 1;
+            _conv = convert::get_converter(id)();
+            _conv->set_scalar(1/32767.);
+            _conv_format = _zc_buffs.item_format;
+        }
+        if (md.has_time_spec) {
+            _in_time = md.time_spec - time_spec_t::from_ticks((long long)(_in_len), _samp_rate);
+            _has_time = true;
+        }
+        if (_in.size() < _in_len + num_items) _in.resize(_in_len + num_items);
+        if (num_items > 0) {
+            void *out = &_in[_in_len];
+            _conv->conv(_zc_buffs.buffs[0], out, num_items);
+        }
+        _in_len += num_items;
+        _zc_buffs.release();
+    }
+
+    void consume(const size_t num)
+    {
+        std::memmove(&_in[0], &_in[num], (_in_len - num)*sizeof(std::complex<float>));
+        _in_len -= num;
+        _in_time += time_spec_t::from_ticks((long long)(num), _samp_rate);
+    }
+
+    //! Outputs [first, first + count) of this call, written at offset
+    void compute_range(const size_t thread, const size_t offset, const size_t first, const size_t count)
+    {
+        std::complex<float> *branches = &_scratch[thread].front();
+        float *fold = reinterpret_cast<float *>(&_scratch[thread][_num_chans]);
+        const size_t rows = _window_len/_num_chans;
+        for (size_t j = first; j < first + count; j++) {
+            _fold(reinterpret_cast<const float *>(&_in[j*_num_chans]),
+                  &_fold_taps.front(), fold, 2*_num_chans, rows);
+            for (size_t p = 0; p < _num_chans; p++) {
+                const size_t r = _num_chans - 1 - p;
+                branches[p] = std::complex<float>(fold[2*r], fold[2*r+1]);
+            }
+            _ifft(branches);
+            for (size_t k = 0; k < _num_chans; k++) {
+                static_cast<std::complex<float> *>((*_job_out)[k])[offset + j] = branches[k];
+            }
+        }
+    }
+
+    //! Compute count outputs, spread over the threads
+    void compute(const buffs_type &buffs, const size_t offset, const size_t count)
+    {
+        const size_t nthreads = std::min(_scratch.size(),
+            std::max<size_t>(count/CHAN_MIN_OUTPUTS_PER_THREAD, 1));
+        _job_out = &buffs;
+        if (nthreads == 1) {
+            this->compute_range(0, offset, 0, count);
+            return;
+        }
+        {
+            boost::mutex::scoped_lock lock(_job_mutex);
+            _job_offset = offset;
+            _job_count = count;
+            _job_threads = nthreads;
+            _job_remaining = nthreads - 1;
+            _job_generation++;
+            _job_cond.notify_all();
+        }
+        this->compute_range(0, offset, 0, count/nthreads);
+        boost::mutex::scoped_lock lock(_job_mutex);
+        while (_job_remaining > 0) _done_cond.wait(lock);
+    }
+
+    void worker(const size_t thread)
+    {
+        size_t offset, first, count;
+        {
+            boost::mutex::scoped_lock lock(_job_mutex);
+            if (_worker_generation[thread] == _job_generation) {
+                _job_cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(100));
+                if (_worker_generation[thread] == _job_generation) return;
+            }
+            _worker_generation[thread] = _job_generation;
+            if (thread >= _job_threads) return;
+            offset = _job_offset;
+            first = thread*_job_count/_job_threads;
+            count = (thread + 1)*_job_count/_job_threads - first;
+        }
+        this->compute_range(thread, offset, first, count);
+        boost::mutex::scoped_lock lock(_job_mutex);
+        if (--_job_remaining == 0) _done_cond.notify_one();
+    }
+
+    rx_streamer::sptr _streamer;
+    const size_t _num_chans;
+    const double _samp_rate;
+    const convert::pfb_fold_kernel_t _fold;
+    const chan_ifft _ifft;
+    std::vector<float> _taps;
+    std::vector<float> _fold_taps;
+    size_t _window_len;
+
+    //the input samples that are not fully used yet
+    std::vector<std::complex<float> > _in;
+    size_t _in_len;
+    time_spec_t _in_time; //of _in[0]
+    bool _has_time;
+    rx_streamer::zero_copy_buffs_t _zc_buffs;
+    convert::converter::sptr _conv;
+    std::string _conv_format;
+    rx_metadata_t::error_code_t _pending_error;
+
+    //per thread: the branches, then the fold
+    std::vector<std::vector<std::complex<float> > > _scratch;
+
+    //the job the threads share
+    boost::mutex _job_mutex;
+    boost::condition_variable _job_cond;
+    boost::condition_variable _done_cond;
+    const buffs_type *_job_out;
+    size_t _job_offset;
+    size_t _job_count;
+    size_t _job_threads;
+    size_t _job_generation;
+    size_t _job_remaining;
+    std::vector<size_t> _worker_generation;
+    std::vector<task::sptr> _workers; //declared last, uses the members above
+};
+
+rx_channelizer::sptr rx_channelizer::make(
+    rx_streamer::sptr streamer,
+    const size_t num_chans,
+    const double samp_rate,
+    const std::vector<float> &taps,
+    const size_t num_threads
+){
+    return sptr(new rx_channelizer_impl(streamer, num_chans, samp_rate, taps, num_threads));
+}
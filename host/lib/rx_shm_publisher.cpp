@@ -0,0 +1,114 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/rx_shm_publisher.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/tasks.hpp>
+#include "transport/shm_ring.hpp"
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+rx_shm_publisher::~rx_shm_publisher(void)
+{
+    /* NOP */
+}
+
+class rx_shm_publisher_impl : public rx_shm_publisher
+{
+public:
+    rx_shm_publisher_impl(
+        rx_streamer::sptr streamer,
+        const std::string &name,
+        const std::string &cpu_format,
+        const double samp_rate,
+        const size_t num_packets
+    ):
+        _streamer(streamer),
+        _num_errors(0)
+    {
+        if (samp_rate <= 0.0) {
+            throw uhd::value_error("rx_shm_publisher: the sample rate must be positive");
+        }
+        if (convert::get_num_planes(cpu_format) != 1) {
+            throw uhd::value_error("rx_shm_publisher: planar cpu formats are not supported");
+        }
+        shm_ring::info_t info;
+        info.cpu_format = cpu_format;
+        info.bytes_per_item = convert::get_bytes_per_item(cpu_format);
+        info.num_chans = streamer->get_num_channels();
+        info.spp = streamer->get_max_num_samps();
+        info.num_slots = num_packets;
+        info.samp_rate = samp_rate;
+        _ring = shm_ring::create(name, info);
+        _task = task::make(boost::bind(&rx_shm_publisher_impl::publish, this), "rx", "rx shm publisher");
+    }
+
+    ~rx_shm_publisher_impl(void)
+    {
+        UHD_SAFE_CALL(
+            _task.reset();
+        )
+    }
+
+    size_t get_num_readers(void)
+    {
+        return _ring->get_num_readers();
+    }
+
+    size_t get_num_errors(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _num_errors;
+    }
+
+private:
+    void publish(void)
+    {
+        rx_metadata_t md;
+        const size_t num_rx_samps = _streamer->recv(
+            _ring->claim(), _ring->get_info().spp, md, 0.1, true);
+
+        if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            if (md.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) return;
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_errors++;
+        }
+        //errors are published too, so the readers see the gap
+        _ring->commit(num_rx_samps, md);
+    }
+
+    rx_streamer::sptr _streamer;
+    shm_ring::sptr _ring;
+    boost::mutex _mutex;
+    size_t _num_errors;
+    task::sptr _task; //declared last, uses the members above
+};
+
+rx_shm_publisher::sptr rx_shm_publisher::make(
+    rx_streamer::sptr streamer,
+    const std::string &name,
+    const std::string &cpu_format,
+    const double samp_rate,
+    const size_t num_packets
+){
+    return sptr(new rx_shm_publisher_impl(streamer, name, cpu_format, samp_rate, num_packets));
+}
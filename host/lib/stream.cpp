@@ -16,6 +16,11 @@
 //
 
 #include <uhd/stream.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
 
 using namespace uhd;
 
@@ -28,3 +33,154 @@ tx_streamer::~tx_streamer(void)
 {
     //empty
 }
+
+rx_streamer::zero_copy_buffs_t::zero_copy_buffs_t(void):
+    nsamps(0)
+{
+    //empty
+}
+
+void rx_streamer::zero_copy_buffs_t::release(void)
+{
+    buffs.clear();
+    nsamps = 0;
+    handle.reset();
+}
+
+double rx_streamer::get_stream_cmd_latency(void) const
+{
+    return 0.0;
+}
+
+size_t rx_streamer::recv_zero_copy(zero_copy_buffs_t &, rx_metadata_t &, const double)
+{
+    throw uhd::not_implemented_error("recv_zero_copy() is not supported by this streamer");
+}
+
+rx_streamer::packet_info_t::packet_info_t(void):
+    offset(0),
+    nsamps(0),
+    has_time_spec(false),
+    start_of_burst(false),
+    end_of_burst(false),
+    gap_before(false)
+{
+    //empty
+}
+
+size_t rx_streamer::recv_batch(
+    const buffs_type &, const size_t, std::vector<packet_info_t> &,
+    const size_t, rx_metadata_t &, const double
+){
+    throw uhd::not_implemented_error("recv_batch() is not supported by this streamer");
+}
+
+tx_streamer::zero_copy_buffs_t::zero_copy_buffs_t(void):
+    nsamps(0)
+{
+    //empty
+}
+
+size_t tx_streamer::get_send_buffer(zero_copy_buffs_t &, const tx_metadata_t &, const double)
+{
+    throw uhd::not_implemented_error("get_send_buffer() is not supported by this streamer");
+}
+
+void tx_streamer::commit(const size_t)
+{
+    throw uhd::not_implemented_error("commit() is not supported by this streamer");
+}
+
+size_t tx_streamer::recv_async_msgs(
+    std::vector<async_metadata_t> &msgs, const size_t max_msgs, const double timeout
+){
+    msgs.clear();
+    async_metadata_t md;
+    while (msgs.size() < max_msgs and this->recv_async_msg(md, msgs.empty()? timeout : 0.0)) {
+        msgs.push_back(md);
+    }
+    return msgs.size();
+}
+
+/***********************************************************************
+ * RX streamer set
+ **********************************************************************/
+//! The first sleep after a round without packets, doubled up to the poll interval
+static const double MIN_POLL_SLEEP = 5e-6;
+
+rx_streamer_set::rx_streamer_set(const double poll_interval):
+    _next(0), _poll_interval(std::max(poll_interval, MIN_POLL_SLEEP))
+{
+    //empty
+}
+
+size_t rx_streamer_set::add(
+    rx_streamer::sptr streamer,
+    const std::vector<void *> &buffs,
+    const size_t nsamps_per_buff
+){
+    if (not streamer) {
+        throw uhd::value_error("rx_streamer_set::add(): null streamer");
+    }
+    if (buffs.size() != streamer->get_num_channels()) {
+        throw uhd::value_error(str(boost::format(
+            "rx_streamer_set::add(): %u buffers for a streamer with %u channels")
+            % buffs.size() % streamer->get_num_channels()));
+    }
+    entry_t entry;
+    entry.streamer = streamer;
+    entry.buffs = buffs;
+    entry.nsamps_per_buff = nsamps_per_buff;
+    _entries.push_back(entry);
+    return _entries.size() - 1;
+}
+
+size_t rx_streamer_set::size(void) const
+{
+    return _entries.size();
+}
+
+rx_streamer::sptr rx_streamer_set::get(const size_t index) const
+{
+    return _entries.at(index).streamer;
+}
+
+size_t rx_streamer_set::recv(
+    size_t &index,
+    rx_metadata_t &metadata,
+    const double timeout
+){
+    if (_entries.empty()) {
+        throw uhd::runtime_error("rx_streamer_set::recv(): the set is empty");
+    }
+
+    const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+    double sleep_time = 0.0;
+    while (true) {
+        for (size_t n = 0; n < _entries.size(); n++) {
+            const size_t i = (_next + n) % _entries.size();
+            entry_t &entry = _entries[i];
+            const size_t nsamps = entry.streamer->recv(
+                entry.buffs, entry.nsamps_per_buff, metadata, 0.0, true
+            );
+            if (nsamps != 0 or metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) {
+                index = i;
+                _next = (i + 1) % _entries.size(); //the others go first next time
+                return nsamps;
+            }
+        }
+
+        //nothing in this round: back off, but not past the timeout
+        const double time_left = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+        if (time_left <= 0.0) break;
+        sleep_time = std::min(std::max(2*sleep_time, MIN_POLL_SLEEP), _poll_interval);
+        boost::this_thread::sleep(boost::posix_time::microseconds(
+            long(std::min(sleep_time, time_left)*1e6)
+        ));
+    }
+
+    index = _next;
+    metadata.reset();
+    metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+    return 0;
+}
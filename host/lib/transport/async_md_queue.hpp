@@ -0,0 +1,133 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_ASYNC_MD_QUEUE_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_ASYNC_MD_QUEUE_HPP
+
+#include <uhd/types/metadata.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <vector>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * The queue of TX async messages between the thread that receives them
+ * from the device and the application, a drop-in replacement for
+ * bounded_buffer<async_metadata_t>.
+ *
+ * After a stall, the device may report an underflow or sequence error
+ * for every packet. Such an error event is merged into the last queued
+ * message when that message has the same event code and channel, and
+ * the application has not received it yet: num_events counts the events,
+ * time_spec stays the time of the first and last_time_spec becomes the
+ * time of the last. Burst ACKs and user payloads are never merged.
+ */
+class async_md_queue : boost::noncopyable
+{
+public:
+    async_md_queue(const size_t capacity):
+        _capacity(capacity)
+    {
+        /* NOP */
+    }
+
+    //! Queue or merge a message, drop the oldest one when the queue is full
+    void push_with_pop_on_full(const async_metadata_t &metadata)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (not _queue.empty() and is_repeat(_queue.back(), metadata)) {
+            async_metadata_t &last = _queue.back();
+            last.num_events += metadata.num_events;
+            last.last_time_spec = (metadata.num_events > 1)?
+                metadata.last_time_spec : metadata.time_spec;
+            return;
+        }
+        if (_queue.size() >= _capacity) _queue.pop_front();
+        _queue.push_back(metadata);
+        if (metadata.num_events <= 1) {
+            _queue.back().num_events = 1;
+            _queue.back().last_time_spec = metadata.time_spec;
+        }
+        lock.unlock();
+        _cond.notify_one();
+    }
+
+    //! Pop a message, wait up to the timeout for one
+    bool pop_with_timed_wait(async_metadata_t &metadata, const double timeout)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (not wait(lock, timeout)) return false;
+        metadata = _queue.front();
+        _queue.pop_front();
+        return true;
+    }
+
+    /*!
+     * Pop up to max_msgs messages, wait up to the timeout for the first.
+     * \return the number of messages, which replace the contents of msgs
+     */
+    size_t pop_all_with_timed_wait(
+        std::vector<async_metadata_t> &msgs, const size_t max_msgs, const double timeout
+    ){
+        msgs.clear();
+        boost::mutex::scoped_lock lock(_mutex);
+        if (max_msgs == 0 or not wait(lock, timeout)) return 0;
+        while (not _queue.empty() and msgs.size() < max_msgs) {
+            msgs.push_back(_queue.front());
+            _queue.pop_front();
+        }
+        return msgs.size();
+    }
+
+private:
+    static bool is_repeat(const async_metadata_t &last, const async_metadata_t &metadata)
+    {
+        static const int MERGED_EVENTS =
+            async_metadata_t::EVENT_CODE_UNDERFLOW |
+            async_metadata_t::EVENT_CODE_SEQ_ERROR |
+            async_metadata_t::EVENT_CODE_TIME_ERROR |
+            async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET |
+            async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST;
+        return last.event_code == metadata.event_code
+            and (metadata.event_code & MERGED_EVENTS) != 0
+            and (metadata.event_code & ~MERGED_EVENTS) == 0
+            and last.channel == metadata.channel
+            and last.has_time_spec == metadata.has_time_spec;
+    }
+
+    bool wait(boost::mutex::scoped_lock &lock, const double timeout)
+    {
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+        while (_queue.empty()) {
+            if (not _cond.timed_wait(lock, exit_time)) return not _queue.empty();
+        }
+        return true;
+    }
+
+    const size_t _capacity;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::deque<async_metadata_t> _queue;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_ASYNC_MD_QUEUE_HPP */
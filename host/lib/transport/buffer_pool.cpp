@@ -17,8 +17,23 @@
 
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/exception.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/thread/mutex.hpp>
 #include <vector>
+#include <cerrno>
+#include <cstring>
+
+#ifdef UHD_PLATFORM_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif
 
 using namespace uhd::transport;
 
@@ -65,6 +80,156 @@ private:
     boost::shared_array<char> _mem;
 };
 
+/***********************************************************************
+ * Allocation policy
+ **********************************************************************/
+buffer_pool::alloc_policy_t buffer_pool::alloc_policy_t::from_hints(
+    const device_addr_t &hints
+){
+    alloc_policy_t policy;
+
+    std::string huge = boost::algorithm::to_upper_copy(
+        hints.get("buff_hugepages", "0"));
+    size_t scale = 1;
+    if (not huge.empty()){
+        switch (huge[huge.size()-1]){
+        case 'K': scale = size_t(1) << 10; break;
+        case 'M': scale = size_t(1) << 20; break;
+        case 'G': scale = size_t(1) << 30; break;
+        default: break;
+        }
+        if (scale != 1) huge.erase(huge.size()-1);
+    }
+    try{
+        policy.hugepage_size = boost::lexical_cast<size_t>(huge)*scale;
+    }
+    catch(const boost::bad_lexical_cast &){
+        throw uhd::value_error(
+            "buffer_pool: invalid buff_hugepages value: " + hints["buff_hugepages"]);
+    }
+
+    policy.numa_node = hints.cast<int>("buff_numa_node", -1);
+    policy.lock = hints.cast<int>("buff_mlock", 0) != 0;
+    return policy;
+}
+
+void buffer_pool::alloc_policy_t::forward_hints(
+    const device_addr_t &args, device_addr_t &hints
+){
+    static const char *keys[] = {"buff_hugepages", "buff_numa_node", "buff_mlock"};
+    for (size_t i = 0; i < sizeof(keys)/sizeof(*keys); i++){
+        if (args.has_key(keys[i])) hints[keys[i]] = args[keys[i]];
+    }
+}
+
+/***********************************************************************
+ * User allocator
+ **********************************************************************/
+static boost::mutex allocator_mutex;
+static buffer_pool::allocator_t allocator;
+
+void buffer_pool::set_allocator(const allocator_t &new_allocator){
+    if (new_allocator.alloc and not new_allocator.free){
+        throw uhd::value_error("buffer_pool: an allocator needs a free hook");
+    }
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    allocator = new_allocator;
+}
+
+//! deleter for the shared array when the memory came from the user allocator
+struct allocator_deleter{
+    allocator_deleter(const boost::function<void(void *, size_t)> &free, const size_t len):
+        free(free), len(len){}
+    void operator()(char *mem){
+        free(mem, len);
+    }
+    boost::function<void(void *, size_t)> free;
+    size_t len;
+};
+
+/*!
+ * Allocate the pool memory with the user allocator.
+ * \return the memory or an empty array when there is no allocator
+ */
+static boost::shared_array<char> alloc_user(const size_t mem_size){
+    boost::mutex::scoped_lock lock(allocator_mutex);
+    if (not allocator.alloc) return boost::shared_array<char>();
+    char *mem = static_cast<char *>(allocator.alloc(mem_size));
+    if (mem == NULL) return boost::shared_array<char>();
+    return boost::shared_array<char>(mem, allocator_deleter(allocator.free, mem_size));
+}
+
+#ifdef UHD_PLATFORM_LINUX
+//! deleter for the shared array when the memory came from mmap
+struct munmap_deleter{
+    munmap_deleter(const size_t len): len(len){}
+    void operator()(char *mem){
+        munlock(mem, len); //harmless when not locked
+        munmap(mem, len);
+    }
+    size_t len;
+};
+
+//! deleter for heap memory that may have been locked
+struct heap_deleter{
+    heap_deleter(const size_t len, const bool locked): len(len), locked(locked){}
+    void operator()(char *mem){
+        if (locked) munlock(mem, len);
+        delete [] mem;
+    }
+    size_t len;
+    bool locked;
+};
+
+/*!
+ * Allocate the pool memory from the hugepage pool.
+ * \return the mapping or an empty array when MAP_HUGETLB fails
+ */
+static boost::shared_array<char> alloc_hugepages(
+    const size_t mem_size, const size_t page_size
+){
+    const size_t map_size = pad_to_boundary(mem_size, page_size);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    //select the page size explicitly, otherwise the kernel default is used
+    size_t page_shift = 0;
+    while ((size_t(1) << page_shift) < page_size) page_shift++;
+    flags |= int(page_shift << MAP_HUGE_SHIFT);
+#endif
+    void *mem = mmap(NULL, map_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mem == MAP_FAILED){
+        UHD_MSG(warning) << boost::format(
+            "buffer_pool: could not map %u bytes of %u byte hugepages (%s).\n"
+            "Check /proc/sys/vm/nr_hugepages; falling back to regular memory."
+        ) % map_size % page_size % std::strerror(errno) << std::endl;
+        return boost::shared_array<char>();
+    }
+    return boost::shared_array<char>(static_cast<char *>(mem), munmap_deleter(map_size));
+}
+
+/*!
+ * Bind the pool memory to a NUMA node.
+ * Called before the pages are touched so they fault in on that node.
+ */
+static void bind_numa_node(char *mem, const size_t mem_size, const int node){
+    const long page = sysconf(_SC_PAGESIZE);
+    const size_t start = size_t(mem) & ~size_t(page-1);
+    const size_t len = size_t(mem) + mem_size - start;
+    unsigned long mask[16] = {};
+    const size_t bits = sizeof(mask)*8;
+    if (size_t(node) >= bits){
+        throw uhd::value_error(str(boost::format(
+            "buffer_pool: NUMA node %d out of range") % node));
+    }
+    mask[node/(sizeof(unsigned long)*8)] |= 1UL << (node%(sizeof(unsigned long)*8));
+    if (syscall(SYS_mbind, start, len, MPOL_BIND, mask, bits, 0) != 0){
+        UHD_MSG(warning) << boost::format(
+            "buffer_pool: could not bind buffers to NUMA node %d (%s)."
+        ) % node % std::strerror(errno) << std::endl;
+    }
+}
+#endif /*UHD_PLATFORM_LINUX*/
+
 /***********************************************************************
  * Buffer pool factor function
  **********************************************************************/
@@ -72,12 +237,53 @@ buffer_pool::sptr buffer_pool::make(
     const size_t num_buffs,
     const size_t buff_size,
     const size_t alignment
+){
+    return make(num_buffs, buff_size, alignment, alloc_policy_t());
+}
+
+buffer_pool::sptr buffer_pool::make(
+    const size_t num_buffs,
+    const size_t buff_size,
+    const size_t alignment,
+    const alloc_policy_t &policy
 ){
     //1) pad the buffer size to be a multiple of alignment
     //2) pad the overall memory size for room after alignment
     //3) allocate the memory in one block of sufficient size
     const size_t padded_buff_size = pad_to_boundary(buff_size, alignment);
-    boost::shared_array<char> mem(new char[padded_buff_size*num_buffs + alignment-1]);
+    const size_t mem_size = padded_buff_size*num_buffs + alignment-1;
+    boost::shared_array<char> mem = alloc_user(mem_size);
+    const bool user_mem = bool(mem);
+
+#ifdef UHD_PLATFORM_LINUX
+    if (not user_mem and policy.hugepage_size != 0){
+        mem = alloc_hugepages(mem_size, policy.hugepage_size);
+    }
+#else
+    if (policy.hugepage_size != 0 or policy.numa_node >= 0 or policy.lock){
+        UHD_MSG(warning) << "buffer_pool: allocation policy not supported on this platform" << std::endl;
+    }
+#endif
+
+    if (not mem){
+#ifdef UHD_PLATFORM_LINUX
+        mem.reset(new char[mem_size], heap_deleter(mem_size, policy.lock));
+#else
+        mem.reset(new char[mem_size]);
+#endif
+    }
+
+#ifdef UHD_PLATFORM_LINUX
+    if (not user_mem and policy.numa_node >= 0){
+        bind_numa_node(mem.get(), mem_size, policy.numa_node);
+    }
+    if (not user_mem and policy.lock and mlock(mem.get(), mem_size) != 0){
+        UHD_MSG(warning) << boost::format(
+            "buffer_pool: could not lock %u bytes of buffer memory (%s).\n"
+            "Check the memlock limit (ulimit -l)."
+        ) % mem_size % std::strerror(errno) << std::endl;
+    }
+#endif
 
     //Fill a vector with boundary-aligned points in the memory
     const size_t mem_start = pad_to_boundary(size_t(mem.get()), alignment);
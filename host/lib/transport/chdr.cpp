@@ -33,6 +33,8 @@ using namespace uhd::transport::vrt;
 static const uint32_t HDR_FLAG_TSF = (1 << 29);
 static const uint32_t HDR_FLAG_EOB = (1 << 28);
 static const uint32_t HDR_FLAG_ERROR = (1 << 28);
+//! Everything in the first header word but the sequence number
+static const uint32_t HDR_CACHE_KEY_MASK = ~(uint32_t(0xFFF) << 16);
 
 /***************************************************************************/
 /* Packing                                                                 */
@@ -180,3 +182,108 @@ void chdr::if_hdr_unpack_le(
     }
 }
 
+
+/***************************************************************************/
+/* Cached unpacking                                                        */
+/***************************************************************************/
+/*! Unpack the first header word, reusing the cached values when the word
+ *  only differs from the cached one in the sequence number.
+ */
+UHD_INLINE void _hdr_unpack_chdr_cached(
+        const uint32_t chdr,
+        if_packet_info_t &if_packet_info,
+        chdr::if_hdr_cache_t &cache
+) {
+    const if_packet_info_t &cached = cache.if_packet_info;
+    if (cache.valid
+        and (chdr & HDR_CACHE_KEY_MASK) == cache.key
+        and if_packet_info.num_packet_words32 >= cached.num_packet_words32
+    ) {
+        if_packet_info.link_type = if_packet_info_t::LINK_TYPE_CHDR;
+        if_packet_info.has_cid = false;
+        if_packet_info.has_sid = true;
+        if_packet_info.has_tsi = false;
+        if_packet_info.has_tlr = false;
+        if_packet_info.sob = false;
+        if_packet_info.has_tsf = cached.has_tsf;
+        if_packet_info.packet_type = cached.packet_type;
+        if_packet_info.eob = cached.eob;
+        if_packet_info.error = cached.error;
+        if_packet_info.packet_count = (chdr >> 16) & 0xFFF;
+        if_packet_info.num_header_words32 = cached.num_header_words32;
+        if_packet_info.num_payload_bytes = cached.num_payload_bytes;
+        if_packet_info.num_payload_words32 = cached.num_payload_words32;
+        return;
+    }
+
+    // Full parse, which also checks the lengths
+    _hdr_unpack_chdr(chdr, if_packet_info);
+    cache.if_packet_info = if_packet_info;
+    // Smallest buffer that holds this packet
+    cache.if_packet_info.num_packet_words32 =
+        if_packet_info.num_header_words32 + if_packet_info.num_payload_words32;
+    cache.key = chdr & HDR_CACHE_KEY_MASK;
+    cache.valid = true;
+}
+
+void chdr::if_hdr_unpack_cached_be(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+) {
+    // Read header and update if_packet_info
+    uint32_t chdr = BE_MACRO(packet_buff[0]);
+    _hdr_unpack_chdr_cached(chdr, if_packet_info, cache);
+
+    // Read SID
+    if_packet_info.sid = BE_MACRO(packet_buff[1]);
+
+    // Read time (has_tsf was updated earlier)
+    if (if_packet_info.has_tsf) {
+        if_packet_info.tsf = 0
+            | uint64_t(BE_MACRO(packet_buff[2])) << 32
+            | BE_MACRO(packet_buff[3]);
+    }
+}
+
+void chdr::if_hdr_unpack_cached_le(
+        const uint32_t *packet_buff,
+        if_packet_info_t &if_packet_info,
+        if_hdr_cache_t &cache
+) {
+    // Read header and update if_packet_info
+    uint32_t chdr = LE_MACRO(packet_buff[0]);
+    _hdr_unpack_chdr_cached(chdr, if_packet_info, cache);
+
+    // Read SID
+    if_packet_info.sid = LE_MACRO(packet_buff[1]);
+
+    // Read time (has_tsf was updated earlier)
+    if (if_packet_info.has_tsf) {
+        if_packet_info.tsf = 0
+            | uint64_t(LE_MACRO(packet_buff[2])) << 32
+            | LE_MACRO(packet_buff[3]);
+    }
+}
+
+void chdr::if_hdr_unpack_batch_be(
+        const uint32_t *const *packet_buffs,
+        if_packet_info_t *if_packet_infos,
+        const size_t num_packets,
+        if_hdr_cache_t &cache
+) {
+    for (size_t i = 0; i < num_packets; i++) {
+        chdr::if_hdr_unpack_cached_be(packet_buffs[i], if_packet_infos[i], cache);
+    }
+}
+
+void chdr::if_hdr_unpack_batch_le(
+        const uint32_t *const *packet_buffs,
+        if_packet_info_t *if_packet_infos,
+        const size_t num_packets,
+        if_hdr_cache_t &cache
+) {
+    for (size_t i = 0; i < num_packets; i++) {
+        chdr::if_hdr_unpack_cached_le(packet_buffs[i], if_packet_infos[i], cache);
+    }
+}
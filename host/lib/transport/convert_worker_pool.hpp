@@ -0,0 +1,173 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_CONVERT_WORKER_POOL_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_CONVERT_WORKER_POOL_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <string>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A small pool of threads to run the per-channel conversion of a
+ * streamer in parallel.
+ *
+ * run() hands out the jobs 0..num_jobs-1 round-robin to the calling
+ * thread and up to num_jobs-1 workers, then waits until all of them are
+ * done. The workers spin on the job word between calls, so a call costs
+ * no system call while packets keep coming. Waiting threads start to
+ * yield after a short spin, and a worker that saw nothing to do for a
+ * while goes to sleep on a condition variable until the next run().
+ *
+ * Only one thread may call run() at a time, which is the case for the
+ * recv() and send() calls of a streamer.
+ */
+class convert_worker_pool : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<convert_worker_pool> sptr;
+    typedef boost::function<void(const size_t)> job_type;
+
+    /*!
+     * Start the worker threads.
+     * \param num_workers the number of threads besides the calling thread
+     * \param name what the workers do, e.g. "rx convert worker"
+     * \param role the thread role of the workers, e.g. "rx"
+     */
+    convert_worker_pool(const size_t num_workers, const std::string &name, const std::string &role):
+        _job_word(0), _num_done(0), _num_sleeping(0), _num_workers(num_workers),
+        _name(name), _role(role)
+    {
+        for (size_t i = 0; i < _num_workers; i++){
+            _threads.create_thread(boost::bind(&convert_worker_pool::worker_loop, this, i + 1));
+        }
+    }
+
+    ~convert_worker_pool(void){
+        _threads.interrupt_all();
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_all();
+        }
+        _threads.join_all();
+    }
+
+    //! Run job(i) for every i in [0, num_jobs) and return when all are done
+    void run(const job_type &job, const size_t num_jobs){
+        const size_t num_active = std::min(_num_workers, num_jobs - 1);
+        if (num_jobs <= 1 or num_active == 0){
+            for (size_t i = 0; i < num_jobs; i++) job(i);
+            return;
+        }
+
+        //publish the job, the generation and the number of helpers in one word
+        _job = job;
+        _num_jobs = num_jobs;
+        _num_done.store(0, boost::memory_order_relaxed);
+        const boost::uint64_t generation = (_job_word.load(boost::memory_order_relaxed) >> 16) + 1;
+        _job_word.store((generation << 16) | num_active);
+        if (_num_sleeping.load() != 0){
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_all();
+        }
+
+        //the calling thread takes slot 0
+        run_slot(0, num_active);
+
+        //the helpers usually finish about the same time we did, so spin,
+        //but let them have the CPU when there are more threads than cores
+        for (size_t spins = 0; _num_done.load(boost::memory_order_acquire) != num_active; spins++){
+            if (spins >= spins_before_yield) boost::this_thread::yield();
+        }
+    }
+
+private:
+    void run_slot(const size_t slot, const size_t num_active){
+        for (size_t i = slot; i < _num_jobs; i += num_active + 1){
+            _job(i);
+        }
+    }
+
+    static const size_t spins_before_yield = 1000;
+
+    void worker_loop(const size_t slot){
+        uhd::scoped_internal_thread internal_thread(_name, _role);
+        static const size_t spins_before_sleep = 20000;
+        boost::uint64_t seen = 0;
+        try{
+            while (true){
+                //wait for a new generation of jobs
+                boost::uint64_t word = _job_word.load(boost::memory_order_acquire);
+                for (size_t spins = 0; (word >> 16) == (seen >> 16); spins++){
+                    if (spins >= spins_before_sleep){
+                        boost::mutex::scoped_lock lock(_mutex);
+                        _num_sleeping++;
+                        while ((word = _job_word.load()) >> 16 == seen >> 16){
+                            _cond.wait(lock); //interruption point
+                        }
+                        _num_sleeping--;
+                        break;
+                    }
+                    if (spins >= spins_before_yield) boost::this_thread::yield();
+                    word = _job_word.load(boost::memory_order_acquire);
+                }
+                seen = word;
+
+                //this generation may need fewer helpers than there are workers
+                const size_t num_active = size_t(word & 0xffff);
+                if (slot > num_active) continue;
+                try{
+                    run_slot(slot, num_active);
+                }
+                catch(const std::exception &e){
+                    UHD_MSG(error) << "Conversion worker: " << e.what() << std::endl;
+                }
+                _num_done.fetch_add(1, boost::memory_order_release);
+            }
+        }
+        catch(const boost::thread_interrupted &){
+            /* pool is going away */
+        }
+    }
+
+    job_type _job;
+    size_t _num_jobs;
+    boost::atomic<boost::uint64_t> _job_word; //generation << 16 | active helpers
+    boost::atomic<size_t> _num_done;
+    boost::atomic<size_t> _num_sleeping;
+    const size_t _num_workers;
+    const std::string _name, _role;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    boost::thread_group _threads;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_CONVERT_WORKER_POOL_HPP */
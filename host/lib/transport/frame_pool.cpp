@@ -0,0 +1,170 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/frame_pool.hpp>
+#include <uhd/exception.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/format.hpp>
+
+using namespace uhd::transport;
+
+frame_pool::~frame_pool(void){
+    /* NOP */
+}
+
+/***********************************************************************
+ * Frame pool implementation:
+ * The free frames are a stack of frame indexes, linked through _next.
+ * The head holds the index of the top frame plus one (0 when empty)
+ * in its lower 32 bits, and a count of the changes in its upper 32
+ * bits, so a pop that raced with a pop and a push of the same frame
+ * fails its compare and exchange (the ABA problem).
+ **********************************************************************/
+class frame_pool_impl : public frame_pool{
+public:
+    frame_pool_impl(
+        const size_t num_frames,
+        const size_t frame_size,
+        const buffer_pool::alloc_policy_t &policy
+    ):
+        _pool(buffer_pool::make(num_frames, frame_size, 16, policy)),
+        _frame_size(frame_size),
+        _stride(1),
+        _next(new boost::atomic<uint32_t>[num_frames]),
+        _head(0),
+        _num_free(0),
+        _num_waiters(0)
+    {
+        if (num_frames == 0 or num_frames >= 0xffffffff){
+            throw uhd::value_error(str(boost::format(
+                "frame_pool: cannot make a pool of %u frames") % num_frames));
+        }
+        if (num_frames > 1){
+            _stride = static_cast<char *>(_pool->at(1)) - static_cast<char *>(_pool->at(0));
+        }
+        //push the last frame first, so the frames go out in memory order
+        for (size_t i = num_frames; i > 0; i--){
+            this->push(uint32_t(i-1));
+        }
+    }
+
+    size_t get_frame_size(void) const{
+        return _frame_size;
+    }
+
+    size_t get_num_frames(void) const{
+        return _pool->size();
+    }
+
+    size_t get_num_free(void) const{
+        return _num_free.load(boost::memory_order_relaxed);
+    }
+
+    void *alloc(const double timeout){
+        uint32_t index;
+        if (this->pop(index)) return _pool->at(index);
+        if (timeout <= 0.0) return NULL;
+
+        //slow path: sleep until a frame comes back or the time is up
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+        boost::mutex::scoped_lock lock(_mutex);
+        _num_waiters++;
+        boost::atomic_thread_fence(boost::memory_order_seq_cst); //see free()
+        bool ok = false;
+        while (not (ok = this->pop(index))){
+            if (not _cond.timed_wait(lock, exit_time)){
+                ok = this->pop(index);
+                break;
+            }
+        }
+        _num_waiters--;
+        return ok? _pool->at(index) : NULL;
+    }
+
+    void free(void *frame){
+        const char *base = static_cast<const char *>(_pool->at(0));
+        const char *mem = static_cast<const char *>(frame);
+        const size_t index = (mem >= base)? size_t(mem - base)/_stride : _pool->size();
+        if (index >= _pool->size() or _pool->at(index) != frame){
+            throw uhd::value_error("frame_pool: freed a frame that is not from this pool");
+        }
+        this->push(uint32_t(index));
+
+        //a waiter either sees the pushed frame or is counted here
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+        if (_num_waiters.load(boost::memory_order_relaxed) != 0){
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_one();
+        }
+    }
+
+private:
+    static uint64_t make_head(const uint64_t head, const uint32_t top){
+        return ((head >> 32) + 1) << 32 | top;
+    }
+
+    UHD_INLINE void push(const uint32_t index){
+        uint64_t head = _head.load(boost::memory_order_relaxed);
+        do{
+            _next[index].store(uint32_t(head), boost::memory_order_relaxed);
+        } while (not _head.compare_exchange_weak(head, make_head(head, index+1),
+            boost::memory_order_release, boost::memory_order_relaxed));
+        _num_free.fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    UHD_INLINE bool pop(uint32_t &index){
+        uint64_t head = _head.load(boost::memory_order_acquire);
+        while (uint32_t(head) != 0){
+            const uint32_t top = uint32_t(head) - 1;
+            if (_head.compare_exchange_weak(head, make_head(head, _next[top].load(boost::memory_order_relaxed)),
+                boost::memory_order_acquire, boost::memory_order_acquire)){
+                _num_free.fetch_sub(1, boost::memory_order_relaxed);
+                index = top;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    buffer_pool::sptr _pool;
+    const size_t _frame_size;
+    size_t _stride; //bytes from one frame to the next
+    boost::scoped_array<boost::atomic<uint32_t> > _next;
+    boost::atomic<uint64_t> _head;
+    boost::atomic<size_t> _num_free;
+
+    //for the callers that wait on an empty pool
+    boost::atomic<size_t> _num_waiters;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+};
+
+/***********************************************************************
+ * Frame pool factory function
+ **********************************************************************/
+frame_pool::sptr frame_pool::make(
+    const size_t num_frames,
+    const size_t frame_size,
+    const buffer_pool::alloc_policy_t &policy
+){
+    return sptr(new frame_pool_impl(num_frames, frame_size, policy));
+}
@@ -75,6 +75,9 @@ static const pred_table_type pred_unpack_table(get_pred_unpack_table());
 //maps num empty bytes to trailer bits
 static const size_t occ_table[] = {0, 2, 1, 3};
 
+//! Everything in the vrt header word but the packet count
+static const uint32_t VRT_HDR_CACHE_KEY_MASK = ~(uint32_t(0xf) << 16);
+
 const uint32_t VRLP = ('V' << 24) | ('R' << 16) | ('L' << 8) | ('P' << 0);
 const uint32_t VEND = ('V' << 24) | ('E' << 16) | ('N' << 8) | ('D' << 0);
 
@@ -345,6 +348,71 @@ void vrt::if_hdr_unpack_${suffix}(
     }
 }
 
+/***********************************************************************
+ * VRT IF unpacking with a header cache
+ **********************************************************************/
+void vrt::if_hdr_unpack_cached_${suffix}(
+    const uint32_t *packet_buff,
+    if_packet_info_t &if_packet_info,
+    if_hdr_cache_t &cache
+){
+    if (if_packet_info.link_type != if_packet_info_t::LINK_TYPE_NONE) {
+        vrt::if_hdr_unpack_${suffix}(packet_buff, if_packet_info);
+        return;
+    }
+
+    const uint32_t vrt_hdr_word32 = ${XE_MACRO}(packet_buff[0]);
+    const size_t packet_words32 = vrt_hdr_word32 & 0xffff;
+    const if_packet_info_t &cached = cache.if_packet_info;
+    if (not cache.valid
+        or (vrt_hdr_word32 & VRT_HDR_CACHE_KEY_MASK) != cache.key
+        or if_packet_info.num_packet_words32 < packet_words32
+    ){
+        //full parse, which also checks the lengths
+        __if_hdr_unpack_${suffix}(packet_buff, if_packet_info, vrt_hdr_word32);
+        cache.if_packet_info = if_packet_info;
+        cache.key = vrt_hdr_word32 & VRT_HDR_CACHE_KEY_MASK;
+        cache.valid = true;
+        return;
+    }
+
+    //same flags and length: the optional fields are at the same place
+    if_packet_info.packet_type = cached.packet_type;
+    if_packet_info.packet_count = (vrt_hdr_word32 >> 16) & 0xf;
+    size_t index = 1;
+    if_packet_info.has_sid = cached.has_sid;
+    if (cached.has_sid) if_packet_info.sid = ${XE_MACRO}(packet_buff[index++]);
+    if_packet_info.has_cid = cached.has_cid;
+    if (cached.has_cid) {
+        if_packet_info.cid = 0; //not implemented
+        index += 2;
+    }
+    if_packet_info.has_tsi = cached.has_tsi;
+    if (cached.has_tsi) if_packet_info.tsi = ${XE_MACRO}(packet_buff[index++]);
+    if_packet_info.has_tsf = cached.has_tsf;
+    if (cached.has_tsf) {
+        if_packet_info.tsf = uint64_t(${XE_MACRO}(packet_buff[index])) << 32;
+        if_packet_info.tsf |= ${XE_MACRO}(packet_buff[index+1]);
+    }
+    if_packet_info.num_header_words32 = cached.num_header_words32;
+    if_packet_info.num_payload_words32 = cached.num_payload_words32;
+
+    //the trailer differs from packet to packet
+    if_packet_info.has_tlr = cached.has_tlr;
+    if_packet_info.sob = (vrt_hdr_word32 & (0x1 << 25)) != 0;
+    if_packet_info.eob = (vrt_hdr_word32 & (0x1 << 24)) != 0;
+    if (cached.has_tlr) {
+        if_packet_info.tlr = ${XE_MACRO}(packet_buff[packet_words32-1]);
+        const int indicators = (if_packet_info.tlr >> 20) & (if_packet_info.tlr >> 8);
+        if ((indicators & (1 << 0)) != 0) if_packet_info.eob = true;
+        if ((indicators & (1 << 1)) != 0) if_packet_info.sob = true;
+        const size_t empty_bytes = occ_table[(indicators >> 2) & 0x3];
+        if_packet_info.num_payload_bytes = if_packet_info.num_payload_words32*sizeof(uint32_t) - empty_bytes;
+    } else {
+        if_packet_info.num_payload_bytes = cached.num_payload_bytes;
+    }
+}
+
 ########################################################################
 </%def>
 ########################################################################
@@ -44,7 +44,7 @@ public:
     libusb_session_impl(void){
         UHD_ASSERT_THROW(libusb_init(&_context) == 0);
         libusb_set_debug(_context, debug_level);
-        task_handler = task::make(boost::bind(&libusb_session_impl::libusb_event_handler_task, this, _context));
+        task_handler = task::make(boost::bind(&libusb_session_impl::libusb_event_handler_task, this, _context), "transport", "libusb events");
     }
 
     virtual ~libusb_session_impl(void);
@@ -68,7 +68,7 @@ private:
         timeval tv;
         tv.tv_sec = 0;
         tv.tv_usec = 100000;
-        int ret = libusb_handle_events_timeout(context, &tv);
+        int ret = libusb_handle_events_timeout_completed(context, &tv, NULL);
         switch (ret)
         {
         case LIBUSB_SUCCESS:
@@ -90,6 +90,9 @@ libusb_session_impl::~libusb_session_impl(void){
 
 libusb::session::sptr libusb::session::get_global_session(void){
     static boost::weak_ptr<session> global_session;
+    //device discovery runs the find functions of all USB devices at once
+    static boost::mutex global_session_mutex;
+    boost::mutex::scoped_lock lock(global_session_mutex);
 
     //not expired -> get existing session
     if (not global_session.expired()) return global_session.lock();
@@ -16,9 +16,14 @@
 //
 
 #include "libusb1_base.hpp"
+#include "zero_copy_stats.hpp"
 #include <uhd/transport/usb_zero_copy.hpp>
 #include <uhd/transport/buffer_pool.hpp>
-#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/lockfree_bounded_buffer.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/trace.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
@@ -26,9 +31,8 @@
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/circular_buffer.hpp>
+#include <boost/atomic.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/condition_variable.hpp>
 #include <list>
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
@@ -43,47 +47,37 @@ using namespace uhd::transport;
 static const size_t DEFAULT_NUM_XFERS = 16;     //num xfers
 static const size_t DEFAULT_XFER_SIZE = 32*512; //bytes
 
-//! type for sharing the release queue with managed buffers
-class libusb_zero_copy_mb;
-typedef boost::shared_ptr<bounded_buffer<libusb_zero_copy_mb *> > mb_queue_sptr;
+//! number of log2(us) buckets in the transfer timing histograms
+static const size_t NUM_STATS_BUCKETS = 20;
 
 /*!
  * The libusb docs state that status and actual length can only be read in the callback.
  * Therefore, this struct is intended to store data seen from the callback function.
+ * It is written by the event handler thread before the transfer is pushed
+ * onto the completion queue and read by the thread that pops it.
  */
 struct lut_result_t
 {
     lut_result_t(void)
     {
-        completed = 0;
         status = LIBUSB_TRANSFER_COMPLETED;
         actual_length = 0;
 #ifdef UHD_TXRX_DEBUG_PRINTS
-        start_time = 0;
         buff_num = -1;
 #endif
     }
-    int completed;
     libusb_transfer_status status;
     int actual_length;
-    boost::mutex mut;
-    boost::condition_variable usb_transfer_complete;
+    time_spec_t submit_time;
+    time_spec_t complete_time;
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
     // These are fore debugging
-    long start_time;
     int buff_num;
     bool is_recv;
 #endif
 };
 
-// Created to be used as an argument to boost::condition_variable::timed_wait() function
-struct lut_result_completed {
-    const lut_result_t& _result;
-    lut_result_completed(const lut_result_t& result):_result(result) {}
-    bool operator()() const {return (_result.completed ? true : false);}
-};
-
 #ifdef UHD_TXRX_DEBUG_PRINTS
 static std::string dbg_prefix("libusb1_zero_copy,");
 static void libusb1_zerocopy_dbg_print_err(std::string msg){
@@ -93,24 +87,56 @@ static void libusb1_zerocopy_dbg_print_err(std::string msg){
 #endif
 
 /*!
- * All libusb callback functions should be marked with the LIBUSB_CALL macro
- * to ensure that they are compiled with the same calling convention as libusb.
+ * Lock-free transfer timing histograms of one endpoint.
+ * Written by one thread each (completion: event handler, resubmit: the
+ * releasing thread), read by anyone.
  */
-
-//! helper function: handles all async callbacks
-static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut)
+class libusb_xfer_stats
 {
-    lut_result_t *r = (lut_result_t *)lut->user_data;
-    boost::lock_guard<boost::mutex> lock(r->mut);
-    r->status = lut->status;
-    r->actual_length = lut->actual_length;
-    r->completed = 1;
-    r->usb_transfer_complete.notify_one();  // wake up thread waiting in wait_for_completion() member function below
-#ifdef UHD_TXRX_DEBUG_PRINTS
-    long end_time = boost::get_system_time().time_of_day().total_microseconds();
-    libusb1_zerocopy_dbg_print_err( (boost::format("libusb_async_cb,%s,%i,%i,%i,%ld,%ld") % (r->is_recv ? "rx":"tx") % r->buff_num % r->actual_length % r->status % end_time % r->start_time).str() );
-#endif
-}
+public:
+    libusb_xfer_stats(void): _num_transfers(0)
+    {
+        for (size_t i = 0; i < NUM_STATS_BUCKETS; i++) {
+            _latency_hist[i] = 0;
+            _resubmit_hist[i] = 0;
+        }
+    }
+
+    UHD_INLINE void add_latency(const time_spec_t &dt)
+    {
+        _num_transfers.fetch_add(1, boost::memory_order_relaxed);
+        _latency_hist[bucket(dt)].fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    UHD_INLINE void add_resubmit_gap(const time_spec_t &dt)
+    {
+        _resubmit_hist[bucket(dt)].fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    usb_zero_copy::xfer_stats_t get(void) const
+    {
+        usb_zero_copy::xfer_stats_t stats;
+        stats.num_transfers = size_t(_num_transfers.load(boost::memory_order_relaxed));
+        for (size_t i = 0; i < NUM_STATS_BUCKETS; i++) {
+            stats.latency_hist.push_back(size_t(_latency_hist[i].load(boost::memory_order_relaxed)));
+            stats.resubmit_hist.push_back(size_t(_resubmit_hist[i].load(boost::memory_order_relaxed)));
+        }
+        return stats;
+    }
+
+private:
+    static UHD_INLINE size_t bucket(const time_spec_t &dt)
+    {
+        const long long us = dt.to_ticks(1e6);
+        size_t i = 0;
+        while (i < NUM_STATS_BUCKETS-1 and (1LL << (i+1)) <= us) i++;
+        return i;
+    }
+
+    boost::atomic<uint64_t> _num_transfers;
+    boost::atomic<uint64_t> _latency_hist[NUM_STATS_BUCKETS];
+    boost::atomic<uint64_t> _resubmit_hist[NUM_STATS_BUCKETS];
+};
 
 /***********************************************************************
  * Reusable managed buffer:
@@ -120,9 +146,13 @@ static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut)
 class libusb_zero_copy_mb : public managed_buffer
 {
 public:
-    libusb_zero_copy_mb(libusb_transfer *lut, const size_t frame_size, boost::function<void(libusb_zero_copy_mb *)> release_cb, const bool is_recv, const std::string &name):
-        _release_cb(release_cb), _is_recv(is_recv), _name(name),
-        _ctx(libusb::session::get_global_session()->get_context()),
+    libusb_zero_copy_mb(
+        libusb_transfer *lut, const size_t frame_size,
+        boost::function<void(libusb_zero_copy_mb *)> release_cb,
+        boost::function<void(libusb_zero_copy_mb *)> complete_cb,
+        const bool is_recv, const std::string &name
+    ):
+        _release_cb(release_cb), _complete_cb(complete_cb), _is_recv(is_recv), _name(name),
         _lut(lut), _frame_size(frame_size) { /* NOP */ }
 
     virtual ~libusb_zero_copy_mb(void);
@@ -134,8 +164,8 @@ public:
     UHD_INLINE void submit(void)
     {
         _lut->length = int((_is_recv)? _frame_size : size()); //always set length
+        result.submit_time = time_spec_t::get_system_time();
 #ifdef UHD_TXRX_DEBUG_PRINTS
-        result.start_time = boost::get_system_time().time_of_day().total_microseconds();
         result.buff_num = num();
         result.is_recv = _is_recv;
 #endif
@@ -145,48 +175,37 @@ public:
             "usb %s submit failed: %s") % _name % libusb_error_name(ret)));
     }
 
+    //! Called from the libusb event handler thread
+    UHD_INLINE void complete(void)
+    {
+        result.status = _lut->status;
+        result.actual_length = _lut->actual_length;
+        result.complete_time = time_spec_t::get_system_time();
+#ifdef UHD_TXRX_DEBUG_PRINTS
+        libusb1_zerocopy_dbg_print_err( (boost::format("libusb_async_cb,%s,%i,%i,%i,%ld,%ld")
+            % (result.is_recv ? "rx":"tx") % result.buff_num % result.actual_length % result.status
+            % result.complete_time.to_ticks(1e6) % result.submit_time.to_ticks(1e6)).str() );
+#endif
+        _complete_cb(this);
+    }
+
     template <typename buffer_type>
-    UHD_INLINE typename buffer_type::sptr get_new(const double timeout)
+    UHD_INLINE typename buffer_type::sptr get_new(void)
     {
-        if (wait_for_completion(timeout))
-        {
-            if (result.status != LIBUSB_TRANSFER_COMPLETED)
-                throw uhd::io_error(str(boost::format("usb %s transfer status: %d")
-                                        % _name % libusb_error_name(result.status)));
-            result.completed = 0;
-            return make(reinterpret_cast<buffer_type *>(this), _lut->buffer, (_is_recv)? size_t(result.actual_length) : _frame_size);
-        }
-        return typename buffer_type::sptr();
+        if (result.status != LIBUSB_TRANSFER_COMPLETED)
+            throw uhd::io_error(str(boost::format("usb %s transfer status: %d")
+                                    % _name % libusb_error_name(result.status)));
+        return make(reinterpret_cast<buffer_type *>(this), _lut->buffer, (_is_recv)? size_t(result.actual_length) : _frame_size);
     }
 
     // This is public because it is accessed from the libusb_zero_copy_single constructor
     lut_result_t result;
 
-    /*!
-     * Wait for a managed buffer to become complete.
-     *
-     * \param timeout the wait timeout in seconds.  A negative value will wait forever.
-     * \return true for completion, false for timeout
-     */
-    UHD_INLINE bool wait_for_completion(const double timeout)
-    {
-        boost::unique_lock<boost::mutex> lock(result.mut);
-        if (!result.completed) {
-            if (timeout < 0.0) {
-                result.usb_transfer_complete.wait(lock);
-            } else {
-                const boost::system_time timeout_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1000000));
-                result.usb_transfer_complete.timed_wait(lock, timeout_time, lut_result_completed(result));
-            }
-        }
-        return (result.completed > 0);
-    }
-
 private:
     boost::function<void(libusb_zero_copy_mb *)> _release_cb;
+    boost::function<void(libusb_zero_copy_mb *)> _complete_cb;
     const bool _is_recv;
     const std::string _name;
-    libusb_context *_ctx;
     libusb_transfer *_lut;
     const size_t _frame_size;
 };
@@ -195,8 +214,25 @@ libusb_zero_copy_mb::~libusb_zero_copy_mb(void) {
     /* NOP */
 }
 
+/*!
+ * All libusb callback functions should be marked with the LIBUSB_CALL macro
+ * to ensure that they are compiled with the same calling convention as libusb.
+ */
+
+//! helper function: handles all async callbacks
+static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut)
+{
+    static_cast<libusb_zero_copy_mb *>(lut->user_data)->complete();
+}
+
 /***********************************************************************
  * USB zero_copy device class
+ *  - All transfers are kept in flight; released buffers are resubmitted
+ *    right away, so the in-flight depth is the number of frames.
+ *  - The libusb event handler thread pushes completed transfers onto a
+ *    lock-free completion queue. A bulk endpoint completes transfers in
+ *    submission order, so the queue order is the buffer order.
+ *  - The queue only takes a lock when the consumer is blocked on it.
  **********************************************************************/
 class libusb_zero_copy_single
 {
@@ -204,16 +240,19 @@ public:
     libusb_zero_copy_single(
         libusb::device_handle::sptr handle,
         const int interface, const unsigned char endpoint,
-        const size_t num_frames, const size_t frame_size
+        const size_t num_frames, const size_t frame_size,
+        const buffer_pool::alloc_policy_t &alloc_policy
     ):
         _handle(handle),
         _num_frames(num_frames),
         _frame_size(frame_size),
-        _buffer_pool(buffer_pool::make(_num_frames, _frame_size)),
-        _enqueued(_num_frames), _released(_num_frames),
+        _buffer_pool(buffer_pool::make(_num_frames, _frame_size, 16, alloc_policy)),
+        _completed(_num_frames),
+        _num_inflight(0),
+        _is_recv((endpoint & 0x80) != 0),
         _status(STATUS_RUNNING)
     {
-        const bool is_recv = (endpoint & 0x80) != 0;
+        const bool is_recv = _is_recv;
         const std::string name = str(boost::format("%s%d") % ((is_recv)? "rx" : "tx") % int(endpoint & 0x7f));
         _handle->claim_interface(interface);
 
@@ -241,7 +280,10 @@ public:
             UHD_ASSERT_THROW(lut != NULL);
 
             _mb_pool.push_back(boost::make_shared<libusb_zero_copy_mb>(
-                lut, this->get_frame_size(), boost::bind(&libusb_zero_copy_single::enqueue_buffer, this, _1), is_recv, name
+                lut, this->get_frame_size(),
+                boost::bind(&libusb_zero_copy_single::submit_buffer, this, _1),
+                boost::bind(&libusb_zero_copy_single::complete_buffer, this, _1),
+                is_recv, name
             ));
 
             libusb_fill_bulk_transfer(
@@ -251,7 +293,7 @@ public:
                 static_cast<unsigned char *>(_buffer_pool->at(i)),      // buffer
                 int(this->get_frame_size()),                            // length
                 libusb_transfer_cb_fn(&libusb_async_cb),                // callback
-                static_cast<void *>(&_mb_pool.back()->result),          // user_data
+                static_cast<void *>(_mb_pool.back().get()),             // user_data
                 0                                                       // timeout (ms)
             );
 
@@ -263,11 +305,7 @@ public:
         {
             libusb_zero_copy_mb &mb = *(_mb_pool[i]);
             if (is_recv) mb.release();
-            else
-            {
-                mb.result.completed = 1;
-                _enqueued.push_back(&mb);
-            }
+            else _completed.push_with_haste(&mb);
         }
     }
 
@@ -280,9 +318,12 @@ public:
         }
 
         //process all transfers until timeout occurs
-        BOOST_FOREACH(libusb_zero_copy_mb *mb, _enqueued)
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(0.01*_num_frames);
+        while (_num_inflight.load(boost::memory_order_acquire) != 0
+               and time_spec_t::get_system_time() < exit_time)
         {
-            mb->wait_for_completion(0.01);
+            libusb_zero_copy_mb *mb = NULL;
+            _completed.pop_with_timed_wait(mb, 0.01);
         }
 
         //free all transfers
@@ -295,34 +336,34 @@ public:
     template <typename buffer_type>
     UHD_INLINE typename buffer_type::sptr get_buff(double timeout)
     {
-        typename buffer_type::sptr buff;
-
         if (_status == STATUS_ERROR)
-            return buff;
-
-        // Serialize access to buffers
-        boost::mutex::scoped_lock get_buff_lock(_get_buff_mutex);
-
-        boost::mutex::scoped_lock queue_lock(_queue_mutex);
-        if (_enqueued.empty())
-        {
-            _buff_ready_cond.timed_wait(queue_lock, boost::posix_time::microseconds(long(timeout*1e6)));
+            return typename buffer_type::sptr();
+
+        libusb_zero_copy_mb *mb = NULL;
+        if (not _completed.pop_with_haste(mb)) {
+            //recv: waiting for the device, send: all transfers in flight
+            if (not _is_recv) _xport_stats.count_send_pool_empty();
+            const time_spec_t wait_start = time_spec_t::get_system_time();
+            const bool ok = _completed.pop_with_timed_wait(mb, timeout);
+            if (_is_recv) _xport_stats.add_recv_wait(wait_start);
+            else _xport_stats.add_send_wait(wait_start);
+            if (not ok) return typename buffer_type::sptr();
         }
-        if (_enqueued.empty()) return buff;
-        libusb_zero_copy_mb *front = _enqueued.front();
-
-        queue_lock.unlock();
-        buff = front->get_new<buffer_type>(timeout);
-        queue_lock.lock();
 
-        if (buff) _enqueued.pop_front();
-        this->submit_what_we_can();
-        return buff;
+        return mb->get_new<buffer_type>();
     }
 
+    //! Counters for this direction, updated by the impl and get_buff()
+    zero_copy_stats_counter &get_xport_stats(void) { return _xport_stats; }
+
+    //! Completed transfers not yet handed out
+    UHD_INLINE size_t get_queue_depth(void) const { return _completed.size(); }
+
     UHD_INLINE size_t get_num_frames(void) const { return _num_frames; }
     UHD_INLINE size_t get_frame_size(void) const { return _frame_size; }
 
+    UHD_INLINE usb_zero_copy::xfer_stats_t get_stats(void) const { return _stats.get(); }
+
 private:
     libusb::device_handle::sptr _handle;
     const size_t _num_frames, _frame_size;
@@ -331,45 +372,88 @@ private:
     buffer_pool::sptr _buffer_pool;
     std::vector<boost::shared_ptr<libusb_zero_copy_mb> > _mb_pool;
 
-    boost::mutex _queue_mutex;
-    boost::condition_variable _buff_ready_cond;
-    boost::mutex _get_buff_mutex;
+    //! Completed transfers in order, filled by the libusb event handler
+    spsc_bounded_buffer<libusb_zero_copy_mb *> _completed;
+    boost::atomic<size_t> _num_inflight;
 
-    //! why 2 queues? there is room in the future to have > N buffers but only N in flight
-    boost::circular_buffer<libusb_zero_copy_mb *> _enqueued, _released;
+    libusb_xfer_stats _stats;
+    const bool _is_recv;
+    zero_copy_stats_counter _xport_stats;
 
     enum {STATUS_RUNNING, STATUS_ERROR} _status;
 
-    void enqueue_buffer(libusb_zero_copy_mb *mb)
-    {
-        boost::mutex::scoped_lock l(_queue_mutex);
-        _released.push_back(mb);
-        this->submit_what_we_can();
-        _buff_ready_cond.notify_one();
-    }
-
-    void submit_what_we_can(void)
+    void submit_buffer(libusb_zero_copy_mb *mb)
     {
         if (_status == STATUS_ERROR)
             return;
-        while (not _released.empty() and not _enqueued.full())
+        if (mb->result.complete_time != time_spec_t(0.0))
+            _stats.add_resubmit_gap(time_spec_t::get_system_time() - mb->result.complete_time);
+        _num_inflight.fetch_add(1, boost::memory_order_relaxed);
+        try {
+            mb->submit();
+        }
+        catch (uhd::usb_error& e)
         {
-            try {
-                _released.front()->submit();
-                _enqueued.push_back(_released.front());
-                _released.pop_front();
-            }
-            catch (uhd::usb_error& e)
-            {
-                _status = STATUS_ERROR;
-                throw e;
-            }
+            _num_inflight.fetch_sub(1, boost::memory_order_relaxed);
+            _status = STATUS_ERROR;
+            throw e;
         }
     }
 
+    void complete_buffer(libusb_zero_copy_mb *mb)
+    {
+        _stats.add_latency(mb->result.complete_time - mb->result.submit_time);
+        _completed.push_with_haste(mb); //never full: one slot per frame
+        _num_inflight.fetch_sub(1, boost::memory_order_release);
+    }
+
     //! a list of all transfer structs we allocated
     std::list<libusb_transfer *> _all_luts;
 };
+/***********************************************************************
+ * CHDR split buffer:
+ *  - A view onto one CHDR packet inside a larger receive transfer.
+ *  - Holds a reference on the transfer until the view is released.
+ **********************************************************************/
+class libusb_chdr_split_mrb : public managed_recv_buffer
+{
+public:
+    libusb_chdr_split_mrb(void){/*NOP*/}
+
+    void release(void){
+        _mrb.reset(); //decrement ref count, other views may hold a ref
+        _claimer.release();
+    }
+
+    /*!
+     * Cut the next packet out of the transfer.
+     * \param mrb the transfer, reset once it has been fully consumed
+     * \param offset_bytes the packet offset in the transfer, advanced
+     */
+    UHD_INLINE sptr get_new(
+        managed_recv_buffer::sptr &mrb, size_t &offset_bytes, const double timeout
+    ){
+        if (not _claimer.claim_with_wait(timeout)) return sptr();
+
+        //the CHDR length field is in bytes, packets start on 64-bit lines
+        char *mem = mrb->cast<char *>() + offset_bytes;
+        const size_t remaining = mrb->size() - offset_bytes;
+        const size_t len = std::min<size_t>(
+            uhd::wtohx(reinterpret_cast<const uint32_t *>(mem)[0]) & 0xffff, remaining);
+        _mrb = mrb;
+
+        //check if this transfer has been exhausted
+        offset_bytes += (len + 7) & ~size_t(7);
+        if (len == 0 or offset_bytes + sizeof(uint64_t) > mrb->size()) mrb.reset(); //drop caller's ref
+        else if ((uhd::wtohx(*reinterpret_cast<const uint32_t *>(mrb->cast<const char *>() + offset_bytes)) & 0xffff) == 0) mrb.reset();
+
+        return make(this, mem, len);
+    }
+
+private:
+    managed_recv_buffer::sptr _mrb;
+    simple_claimer _claimer;
+};
 
 /***********************************************************************
  * USB zero_copy device class
@@ -384,38 +468,106 @@ struct libusb_zero_copy_impl : usb_zero_copy
         const unsigned char send_endpoint,
         const device_addr_t &hints
     ){
+        const buffer_pool::alloc_policy_t alloc_policy =
+            buffer_pool::alloc_policy_t::from_hints(hints);
+        _recv_frame_size = size_t(hints.cast<double>("recv_frame_size", DEFAULT_XFER_SIZE));
+        _recv_offset = 0;
+        _next_split_index = 0;
+
+        //transfers larger than a frame carry several CHDR packets each
+        const size_t recv_xfer_size = std::max(_recv_frame_size,
+            size_t(hints.cast<double>("recv_xfer_size", double(_recv_frame_size))));
         _recv_impl.reset(new libusb_zero_copy_single(
             handle, recv_interface, (recv_endpoint & 0x7f) | 0x80,
             size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_XFERS)),
-            size_t(hints.cast<double>("recv_frame_size", DEFAULT_XFER_SIZE))));
+            recv_xfer_size,
+            alloc_policy));
+        if (recv_xfer_size > _recv_frame_size) {
+            const size_t num_views = _recv_impl->get_num_frames()*(recv_xfer_size/_recv_frame_size);
+            for (size_t i = 0; i < num_views; i++) {
+                _split_mrbs.push_back(boost::make_shared<libusb_chdr_split_mrb>());
+            }
+        }
         _send_impl.reset(new libusb_zero_copy_single(
             handle, send_interface, (send_endpoint & 0x7f) | 0x00,
             size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_XFERS)),
-            size_t(hints.cast<double>("send_frame_size", DEFAULT_XFER_SIZE))));
+            size_t(hints.cast<double>("send_frame_size", DEFAULT_XFER_SIZE)),
+            alloc_policy));
     }
 
     virtual ~libusb_zero_copy_impl(void);
 
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
+        UHD_TRACE_SPAN("usb_recv");
         boost::mutex::scoped_lock l(_recv_mutex);
-        return _recv_impl->get_buff<managed_recv_buffer>(timeout);
+        managed_recv_buffer::sptr buff;
+        if (_split_mrbs.empty()) buff = _recv_impl->get_buff<managed_recv_buffer>(timeout);
+        else buff = get_split_recv_buff(timeout);
+        _recv_impl->get_xport_stats().count_recv(buff);
+        return buff;
+    }
+
+    //! Split the current transfer into its CHDR packets
+    UHD_INLINE managed_recv_buffer::sptr get_split_recv_buff(const double timeout)
+    {
+        //a zero-length or truncated transfer has no CHDR header to parse,
+        //the memory only holds whatever the previous transfer left there
+        while (not _last_recv_buff) {
+            _last_recv_buff = _recv_impl->get_buff<managed_recv_buffer>(timeout);
+            _recv_offset = 0;
+            if (not _last_recv_buff) return managed_recv_buffer::sptr();
+            if (_last_recv_buff->size() < sizeof(uint64_t)) _last_recv_buff.reset();
+        }
+        managed_recv_buffer::sptr buff = _split_mrbs[_next_split_index]->get_new(
+            _last_recv_buff, _recv_offset, timeout);
+        if (buff and ++_next_split_index == _split_mrbs.size()) _next_split_index = 0;
+        return buff;
     }
 
     managed_send_buffer::sptr get_send_buff(double timeout)
     {
+        UHD_TRACE_SPAN("usb_get_send_buff");
         boost::mutex::scoped_lock l(_send_mutex);
-        return _send_impl->get_buff<managed_send_buffer>(timeout);
+        managed_send_buffer::sptr buff = _send_impl->get_buff<managed_send_buffer>(timeout);
+        _send_impl->get_xport_stats().count_send(buff);
+        return buff;
     }
 
-    size_t get_num_recv_frames(void) const { return _recv_impl->get_num_frames(); }
+    zero_copy_stats_t get_stats(void) const
+    {
+        const zero_copy_stats_t recv = _recv_impl->get_xport_stats().get();
+        const zero_copy_stats_t send = _send_impl->get_xport_stats().get();
+        zero_copy_stats_t stats = recv;
+        stats.num_send_packets = send.num_send_packets;
+        stats.num_send_timeouts = send.num_send_timeouts;
+        stats.num_send_pool_empty = send.num_send_pool_empty;
+        stats.send_wait_ns = send.send_wait_ns;
+        stats.recv_queue_depth = _recv_impl->get_queue_depth();
+        return stats;
+    }
+
+    size_t get_num_recv_frames(void) const
+    {
+        return (_split_mrbs.empty())? _recv_impl->get_num_frames() : _split_mrbs.size();
+    }
     size_t get_num_send_frames(void) const { return _send_impl->get_num_frames(); }
 
-    size_t get_recv_frame_size(void) const { return _recv_impl->get_frame_size(); }
+    size_t get_recv_frame_size(void) const { return _recv_frame_size; }
     size_t get_send_frame_size(void) const { return _send_impl->get_frame_size(); }
 
+    xfer_stats_t get_recv_stats(void) const { return _recv_impl->get_stats(); }
+    xfer_stats_t get_send_stats(void) const { return _send_impl->get_stats(); }
+
     boost::shared_ptr<libusb_zero_copy_single> _recv_impl, _send_impl;
     boost::mutex _recv_mutex, _send_mutex;
+
+    //state for splitting large receive transfers (recv_xfer_size)
+    size_t _recv_frame_size;
+    std::vector<boost::shared_ptr<libusb_chdr_split_mrb> > _split_mrbs;
+    managed_recv_buffer::sptr _last_recv_buff;
+    size_t _recv_offset;
+    size_t _next_split_index;
 };
 
 libusb_zero_copy_impl::~libusb_zero_copy_impl(void) {
@@ -429,6 +581,14 @@ usb_zero_copy::~usb_zero_copy(void) {
     /* NOP */
 }
 
+usb_zero_copy::xfer_stats_t usb_zero_copy::get_recv_stats(void) const {
+    return xfer_stats_t();
+}
+
+usb_zero_copy::xfer_stats_t usb_zero_copy::get_send_stats(void) const {
+    return xfer_stats_t();
+}
+
 /***********************************************************************
  * USB zero_copy make functions
  **********************************************************************/
@@ -15,15 +15,21 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "zero_copy_stats.hpp"
+#include "sid_route_table.hpp"
 #include <uhd/transport/muxed_zero_copy_if.hpp>
-#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/lockfree_bounded_buffer.hpp>
 #include <uhd/exception.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/atomic.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/locks.hpp>
-#include <map>
+#include <vector>
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -37,10 +43,16 @@ public:
     muxed_zero_copy_if_impl(
         zero_copy_if::sptr base_xport,
         stream_classifier_fn classify_fn,
-        size_t max_streams
+        size_t max_streams,
+        const wait_policy_t &wait_policy
     ):
         _base_xport(base_xport), _classify(classify_fn),
-        _max_num_streams(max_streams), _num_dropped_frames(0)
+        _num_streams(0), _max_num_streams(max_streams), _num_dropped_frames(0),
+        _wait_policy(wait_policy),
+        _num_spins(0), _num_blocks(0), _spin_ns(0), _block_ns(0),
+        _inflight(base_xport->get_num_recv_frames()),
+        _inflight_head(0), _inflight_count(0),
+        _worker_epoch(0), _worker_running(true), _shutdown(false)
     {
         //Create the receive thread to poll the underlying transport
         //and classify packets into queues
@@ -51,27 +63,32 @@ public:
     virtual ~muxed_zero_copy_if_impl()
     {
         UHD_SAFE_CALL(
+            //Stop a wait for a frame that is never released
+            {
+                boost::mutex::scoped_lock lock(_inflight_mutex);
+                _shutdown = true;
+                _inflight_cond.notify_all();
+            }
             //Interrupt buffer updater loop
             _recv_thread.interrupt();
             //Wait for loop to finish
             //No timeout on join. The recv loop is guaranteed
             //to terminate in a reasonable amount of time because
-            //there are no timed blocks on the underlying.
+            //blocking waits on the underlying are bounded by
+            //the block_timeout of the wait policy.
             _recv_thread.join();
             //Flush base transport
             while (_base_xport->get_recv_buff(0.0001)) /*NOP*/;
-            //Release child streams
-            //Note that this will not delete or flush the child streams
-            //until the owners of the streams have released the respective
-            //shared pointers. This ensures that packets are not dropped.
-            _streams.clear();
         );
     }
 
     virtual zero_copy_if::sptr make_stream(const uint32_t stream_num)
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
-        if (_streams.size() >= _max_num_streams) {
+        if (stream_num > 0xffff) {
+            throw uhd::value_error("muxed_zero_copy_if: stream numbers must fit in 16 bits.");
+        }
+        if (_num_streams >= _max_num_streams) {
             throw uhd::runtime_error("muxed_zero_copy_if: stream capacity exceeded. cannot create more streams.");
         }
         // Only allocate a portion of the base transport's frames to each stream
@@ -80,7 +97,7 @@ public:
             this->shared_from_this(), stream_num,
             _base_xport->get_num_send_frames() / _max_num_streams,
             _base_xport->get_num_recv_frames() / _max_num_streams);
-        _streams[stream_num] = stream;
+        if (_routes.exchange(uint16_t(stream_num), stream.get()) == NULL) _num_streams++;
         return stream;
     }
 
@@ -89,36 +106,56 @@ public:
         return _num_dropped_frames;
     }
 
+    virtual wait_stats_t get_wait_stats() const
+    {
+        wait_stats_t stats;
+        stats.num_spins = _num_spins.load(boost::memory_order_relaxed);
+        stats.num_blocks = _num_blocks.load(boost::memory_order_relaxed);
+        stats.spin_ns = _spin_ns.load(boost::memory_order_relaxed);
+        stats.block_ns = _block_ns.load(boost::memory_order_relaxed);
+        return stats;
+    }
+
     void remove_stream(const uint32_t stream_num)
     {
+        if (stream_num > 0xffff) return;
         boost::lock_guard<boost::mutex> lock(_mutex);
-        _streams.erase(stream_num);
+        if (_routes.exchange(uint16_t(stream_num), NULL) != NULL) _num_streams--;
     }
 
 private:
     /*
-     * @class stream_mrb is used to copy the data and release the original
-     * managed receive buffer back to the base transport.
+     * @class stream_mrb hands a base transport frame to a stream without
+     * copying it. The frame itself is tracked by the muxed transport,
+     * which gives it back to the base transport once the consumer has
+     * released this buffer. The number of stream_mrbs per stream bounds
+     * the number of base frames the stream can hold at any time.
      */
     class stream_mrb : public managed_recv_buffer
     {
     public:
-        stream_mrb(size_t size) : _buff(new char[size]) {}
+        stream_mrb(muxed_zero_copy_if_impl *muxed_xport) :
+            _muxed_xport(muxed_xport), _slot(0) {}
 
-        ~stream_mrb() {
-            delete[] _buff;
+        void release() {
+            _muxed_xport->_retire_frame(_slot);
+            _claimer.release();
         }
 
-        void release() {}
+        UHD_INLINE bool claim_with_wait(const double timeout) {
+            return _claimer.claim_with_wait(timeout);
+        }
 
-        UHD_INLINE sptr get_new(char *buff, size_t len)
+        UHD_INLINE sptr get_new(const size_t slot, void *mem, const size_t len)
         {
-            memcpy(_buff, buff, len);
-            return make(this, _buff, len);
+            _slot = slot;
+            return make(this, mem, len);
         }
 
     private:
-        char *_buff;
+        muxed_zero_copy_if_impl *_muxed_xport;
+        size_t _slot;
+        simple_claimer _claimer;
     };
 
     class stream_impl : public zero_copy_if
@@ -143,7 +180,7 @@ private:
             _buffer_index(0)
         {
             for (size_t i = 0; i < num_recv_frames; i++) {
-                _buffers[i] = boost::make_shared<stream_mrb>(_recv_frame_size);
+                _buffers[i] = boost::make_shared<stream_mrb>(_muxed_xport.get());
             }
         }
 
@@ -151,12 +188,16 @@ private:
         {
             //First remove the stream from muxed transport
             //so no more frames are pushed in
-            _muxed_xport->remove_stream(_stream_num);
-            //Flush the transport
+            const uint64_t epoch = _muxed_xport->_remove_route(_stream_num, this);
+            //Flush the transport until the worker thread is done with
+            //any frame it classified before the route was removed
             managed_recv_buffer::sptr buff;
-            while (_buff_queue.pop_with_haste(buff)) {
-                //NOP
+            while (true) {
+                while (_buff_queue.pop_with_haste(buff)) buff.reset();
+                if (_muxed_xport->_worker_passed(epoch)) break;
+                boost::this_thread::sleep(boost::posix_time::microseconds(100));
             }
+            while (_buff_queue.pop_with_haste(buff)) buff.reset();
         }
 
         size_t get_num_recv_frames(void) const {
@@ -169,16 +210,35 @@ private:
 
         managed_recv_buffer::sptr get_recv_buff(double timeout) {
             managed_recv_buffer::sptr buff;
-            if (_buff_queue.pop_with_timed_wait(buff, timeout)) {
-                return buff;
-            } else {
-                return managed_recv_buffer::sptr();
+            if (not _buff_queue.pop_with_haste(buff)) {
+                const time_spec_t wait_start = time_spec_t::get_system_time();
+                if (not _buff_queue.pop_with_timed_wait(buff, timeout)) {
+                    buff.reset();
+                }
+                _stats.add_recv_wait(wait_start);
             }
+            _stats.count_recv(buff);
+            return buff;
         }
 
-        void push_recv_buff(managed_recv_buffer::sptr buff) {
-            _buff_queue.push_with_wait(_buffers.at(_buffer_index++)->get_new(buff->cast<char*>(), buff->size()));
-            _buffer_index %= _buffers.size();
+        /*!
+         * Hand a frame to the consumer of this stream (worker thread).
+         * Waits for the consumer to hand back the oldest frame if the
+         * stream already holds its share of base frames, but not for
+         * longer than PUSH_TIMEOUT: a stalled consumer must not block
+         * the other streams, nor the destruction of the transport.
+         * \return false if the frame was not queued and must be dropped
+         */
+        bool push_recv_buff(const size_t slot, managed_recv_buffer::sptr buff) {
+            static const double PUSH_TIMEOUT = 1.0;
+            static const double PUSH_POLL = 0.1;
+            stream_mrb &mrb = *_buffers.at(_buffer_index);
+            for (double waited = 0.0; not mrb.claim_with_wait(PUSH_POLL); waited += PUSH_POLL) {
+                if (waited >= PUSH_TIMEOUT or _muxed_xport->_stopping()) return false;
+            }
+            _buffer_index = (_buffer_index + 1) % _buffers.size();
+            _buff_queue.push_with_wait(mrb.get_new(slot, buff->cast<void*>(), buff->size()));
+            return true;
         }
 
         size_t get_num_send_frames(void) const {
@@ -191,7 +251,19 @@ private:
 
         managed_send_buffer::sptr get_send_buff(double timeout)
         {
-            return _muxed_xport->base_xport()->get_send_buff(timeout);
+            managed_send_buffer::sptr buff = _muxed_xport->base_xport()->get_send_buff(timeout);
+            _stats.count_send(buff);
+            return buff;
+        }
+
+        //! Per-stream receive counters; frames dropped by the muxer are
+        //! reported as num_dropped of every stream
+        zero_copy_stats_t get_stats(void) const
+        {
+            zero_copy_stats_t stats = _stats.get();
+            stats.num_dropped = _muxed_xport->get_num_dropped_frames();
+            stats.recv_queue_depth = _buff_queue.size();
+            return stats;
         }
 
     private:
@@ -201,73 +273,87 @@ private:
         const size_t                                _send_frame_size;
         const size_t                                _num_recv_frames;
         const size_t                                _recv_frame_size;
-        bounded_buffer<managed_recv_buffer::sptr>   _buff_queue;
+        //pushed by the muxer thread only, popped by the stream owner only
+        spsc_bounded_buffer<managed_recv_buffer::sptr> _buff_queue;
         std::vector< boost::shared_ptr<stream_mrb> >    _buffers;
         size_t                                      _buffer_index;
+        zero_copy_stats_counter                     _stats;
     };
 
     inline zero_copy_if::sptr& base_xport() { return _base_xport; }
 
     void _update_queues()
     {
+        scoped_internal_thread internal_thread("transport demux", "transport");
         //Run forever:
         // - Pull packets from the base transport
         // - Classify them
         // - Push them to the appropriate receive queue
+        size_t num_empty_polls = 0;
+        time_spec_t spin_start;
         while (true) {
             {   //Uninterruptable block of code
                 boost::this_thread::disable_interruption interrupt_disabler;
-                if (not _process_next_buffer()) {
-                    //Be a good citizen and yield if no packet is processed
-                    static const size_t MIN_DUR = 1;
-                    boost::this_thread::sleep_for(boost::chrono::nanoseconds(MIN_DUR));
-                    //We call sleep(MIN_DUR) above instead of yield() to ensure that we
-                    //relinquish the current scheduler time slot.
-                    //yield() is a hint to the scheduler to end the time
-                    //slice early and schedule in another thread that is ready to run.
-                    //However in most situations, there will be no other thread and
-                    //this thread will continue to run which will rail a CPU core.
-                    //We call sleep(MIN_DUR=1) instead which will sleep for a minimum time.
-                    //Ideally we would like to use boost::chrono::.*seconds::min() but that
-                    //is bound to 0, which causes the sleep_for call to be a no-op and
-                    //thus useless to actually force a sleep.
-
-                    //****************************************************************
-                    //NOTE: This behavior makes this transport a poor choice for
-                    //      low latency communication.
-                    //****************************************************************
+                if (num_empty_polls < _wait_policy.spin_count) {
+                    //Spin: poll the base transport without blocking
+                    if (num_empty_polls == 0) spin_start = time_spec_t::get_system_time();
+                    const bool got_frame = _process_next_buffer(0.0);
+                    _worker_epoch++;
+                    if (got_frame) {
+                        num_empty_polls = 0;
+                    } else if (++num_empty_polls == _wait_policy.spin_count) {
+                        _account(_num_spins, _spin_ns, spin_start, num_empty_polls);
+                    }
+                } else {
+                    //Block: let the base transport wait for the next frame
+                    //(e.g. in poll() on the socket) instead of railing a core
+                    const time_spec_t block_start = time_spec_t::get_system_time();
+                    _process_next_buffer(_wait_policy.block_timeout);
+                    _worker_epoch++;
+                    _account(_num_blocks, _block_ns, block_start, 1);
+                    num_empty_polls = 0;
                 }
             }
             //Check if the master thread has requested a shutdown
             if (boost::this_thread::interruption_requested()) break;
         }
+        _worker_running = false;
     }
 
-    bool _process_next_buffer()
+    //! Add the time since start to a wait statistic
+    static UHD_INLINE void _account(
+        boost::atomic<uint64_t> &count, boost::atomic<uint64_t> &ns,
+        const time_spec_t &start, const size_t num
+    ) {
+        const time_spec_t elapsed = time_spec_t::get_system_time() - start;
+        count.fetch_add(num, boost::memory_order_relaxed);
+        ns.fetch_add(uint64_t(elapsed.to_ticks(1e9)), boost::memory_order_relaxed);
+    }
+
+    bool _process_next_buffer(const double timeout)
     {
-        managed_recv_buffer::sptr buff = _base_xport->get_recv_buff(0.0);
+        managed_recv_buffer::sptr buff = _base_xport->get_recv_buff(timeout);
         if (buff) {
-            stream_impl::sptr stream;
+            stream_impl *stream = NULL;
             try {
                 const uint32_t stream_num = _classify(buff->cast<void*>(), _base_xport->get_recv_frame_size());
-                {
-                    //Hold the stream mutex long enough to pull a bounded buffer
-                    //and lock it (increment its ref count).
-                    boost::lock_guard<boost::mutex> lock(_mutex);
-                    stream_map_t::iterator str_iter = _streams.find(stream_num);
-                    if (str_iter != _streams.end()) {
-                        stream = (*str_iter).second.lock();
-                    }
-                }
+                //No lock: a stream that is destroyed meanwhile waits
+                //for this call to return, see _remove_route()
+                if (stream_num <= 0xffff) stream = _routes.find(uint16_t(stream_num));
             } catch (std::exception&) {
                 //If _classify throws we simply drop the frame
             }
-            //Once a bounded buffer is acquired, we can rely on its
-            //thread safety to serialize with the consumer.
-            if (stream.get()) {
-                stream->push_recv_buff(buff);
-            } else {
-                boost::lock_guard<boost::mutex> lock(_mutex);
+            size_t slot = 0;
+            if (not _track_frame(buff, slot)) {
+                //Shutting down: the frame goes back to the base transport
+                return false;
+            }
+            //The bounded buffer of the stream is thread safe,
+            //so it serializes with the consumer. A stream whose
+            //consumer does not release its frames drops the frame too.
+            if (stream == NULL or not stream->push_recv_buff(slot, buff)) {
+                //Drop the frame without copying it.
+                _retire_frame(slot);
                 _num_dropped_frames++;
             }
             //We processed a packet, and there could be more coming
@@ -280,21 +366,112 @@ private:
         }
     }
 
-    typedef std::map<uint32_t, stream_impl::wptr> stream_map_t;
+    /*!
+     * Base transports may require frames to be released in the order
+     * they were received (e.g. DMA FIFOs, which recycle the oldest
+     * frame on every release). Frames handed to the streams are kept in
+     * arrival order, and are only given back to the base transport from
+     * the oldest end once their consumers are done with them.
+     */
+    struct inflight_frame_t {
+        inflight_frame_t() : done(false) {}
+        managed_recv_buffer::sptr buff;
+        bool done;
+    };
+
+    /*!
+     * Track a new frame, waiting if all base frames are held (worker thread).
+     * The wait ends when the transport is destroyed, even if a frame is
+     * never released.
+     * \return false if the transport is shutting down
+     */
+    bool _track_frame(managed_recv_buffer::sptr &buff, size_t &slot)
+    {
+        boost::mutex::scoped_lock lock(_inflight_mutex);
+        while (_inflight_count == _inflight.size()) {
+            if (_shutdown) return false;
+            _inflight_cond.timed_wait(lock, boost::posix_time::milliseconds(100));
+        }
+        slot = (_inflight_head + _inflight_count) % _inflight.size();
+        _inflight[slot].buff = buff;
+        _inflight[slot].done = false;
+        _inflight_count++;
+        return true;
+    }
+
+    //! Is the transport being destroyed (worker thread)?
+    bool _stopping(void)
+    {
+        if (boost::this_thread::interruption_requested()) return true;
+        boost::mutex::scoped_lock lock(_inflight_mutex);
+        return _shutdown;
+    }
+
+    //! Mark a frame as consumed and release the consumed frames in order
+    void _retire_frame(const size_t slot)
+    {
+        boost::mutex::scoped_lock lock(_inflight_mutex);
+        _inflight[slot].done = true;
+        while (_inflight_count > 0 and _inflight[_inflight_head].done) {
+            _inflight[_inflight_head].buff.reset();
+            _inflight[_inflight_head].done = false;
+            _inflight_head = (_inflight_head + 1) % _inflight.size();
+            _inflight_count--;
+        }
+        _inflight_cond.notify_one();
+    }
+
+    /*!
+     * Remove the route of a stream that is being destroyed, unless
+     * the stream number was given to another stream since.
+     * \return the epoch to pass to _worker_passed()
+     */
+    uint64_t _remove_route(const uint32_t stream_num, stream_impl *stream)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (_routes.find(uint16_t(stream_num)) == stream) {
+            _routes.exchange(uint16_t(stream_num), NULL);
+            _num_streams--;
+        }
+        return _worker_epoch;
+    }
+
+    /*!
+     * Has the worker thread finished a call to _process_next_buffer()
+     * since the epoch? The routes and the epoch are sequentially
+     * consistent, so any later call sees the routes from before the
+     * epoch was read: a removed stream is no longer in use.
+     */
+    bool _worker_passed(const uint64_t epoch) const
+    {
+        return _worker_epoch != epoch or not _worker_running;
+    }
 
     zero_copy_if::sptr      _base_xport;
     stream_classifier_fn    _classify;
-    stream_map_t            _streams;
+    sid_route_table<stream_impl>    _routes;
+    size_t                  _num_streams;
     const size_t            _max_num_streams;
-    size_t                  _num_dropped_frames;
+    boost::atomic<size_t>   _num_dropped_frames;
+    const wait_policy_t     _wait_policy;
+    boost::atomic<uint64_t> _num_spins, _num_blocks, _spin_ns, _block_ns;
     boost::thread           _recv_thread;
     boost::mutex            _mutex;
+    std::vector<inflight_frame_t>   _inflight;
+    size_t                  _inflight_head;
+    size_t                  _inflight_count;
+    boost::mutex            _inflight_mutex;
+    boost::condition_variable       _inflight_cond;
+    boost::atomic<uint64_t> _worker_epoch;
+    boost::atomic<bool>     _worker_running;
+    bool                    _shutdown; //under _inflight_mutex
 };
 
 muxed_zero_copy_if::sptr muxed_zero_copy_if::make(
     zero_copy_if::sptr base_xport,
     muxed_zero_copy_if::stream_classifier_fn classify_fn,
-    size_t max_streams
+    size_t max_streams,
+    const wait_policy_t &wait_policy
 ) {
-    return boost::make_shared<muxed_zero_copy_if_impl>(base_xport, classify_fn, max_streams);
+    return boost::make_shared<muxed_zero_copy_if_impl>(base_xport, classify_fn, max_streams, wait_policy);
 }
@@ -35,7 +35,14 @@ niusrprio_session::niusrprio_session(const std::string& resource_name, const std
     _resource_manager(),
     _rpc_client("localhost", rpc_port_name)
 {
-   _riok_proxy = create_kernel_proxy(resource_name,rpc_port_name);
+   //Look up the interface over the session's own connection instead of
+   //create_kernel_proxy(), which connects to the RPC server once more.
+   //open() reuses the path.
+   nirio_status status = _rpc_client.get_ctor_status();
+   nirio_status_chain(_rpc_client.niusrprio_get_interface_path(_resource_name, _interface_path), status);
+   if (nirio_status_fatal(status)) _interface_path.clear();
+
+   _riok_proxy = niriok_proxy::make_and_open(_interface_path);
    _resource_manager.set_proxy(_riok_proxy);
 }
 
@@ -67,7 +74,9 @@ nirio_status niusrprio_session::open(
     //Make sure that the RPC client connected to the server properly
     nirio_status_chain(_rpc_client.get_ctor_status(), status);
     //Get a handle to the kernel driver
-    nirio_status_chain(_rpc_client.niusrprio_get_interface_path(_resource_name, _interface_path), status);
+    if (_interface_path.empty()) {
+        nirio_status_chain(_rpc_client.niusrprio_get_interface_path(_resource_name, _interface_path), status);
+    }
     nirio_status_chain(_riok_proxy->open(_interface_path), status);
 
     if (nirio_status_not_fatal(status)) {
@@ -56,6 +56,9 @@ rpc_client::rpc_client (
         tcp::resolver::query query(tcp::v4(), server, port, query_flags);
         tcp::resolver::iterator iterator = resolver.resolve(query);
         boost::asio::connect(_socket, iterator);
+        //Every call is a small request followed by a wait for the response,
+        //don't let Nagle's algorithm hold the request back
+        _socket.set_option(tcp::no_delay(true));
 
         UHD_LOG << "rpc_client connected to server." << std::endl;
 
@@ -117,18 +120,17 @@ const boost::system::error_code& rpc_client::call(
 
         _exec_err.clear();
 
-        //Send function call header and args
+        //Send function call header and args in one write
+        std::vector<boost::asio::const_buffer> request_buffs;
+        request_buffs.push_back(boost::asio::buffer(&_request.header, sizeof(_request.header)));
+        if (not _request.data.empty()) {
+            request_buffs.push_back(boost::asio::buffer(&(*_request.data.begin()), _request.data.size()));
+        }
         bool status = true;
         try {
             CHAIN_BLOCKING_XFER(
-                boost::asio::write(_socket, boost::asio::buffer(&_request.header, sizeof(_request.header))),
-                sizeof(_request.header), status);
-            if (not _request.data.empty())
-            {
-                CHAIN_BLOCKING_XFER(
-                    boost::asio::write(_socket, boost::asio::buffer(&(*_request.data.begin()), _request.data.size())),
-                    _request.data.size(), status);
-            }
+                boost::asio::write(_socket, request_buffs),
+                sizeof(_request.header) + _request.data.size(), status);
         } catch (boost::exception&) {
             status = false;
         }
@@ -31,6 +31,7 @@
 #include <algorithm>    // std::max
 //@TODO: Move the register defs required by the class to a common location
 #include "../usrp/x300/x300_regs.hpp"
+#include "zero_copy_stats.hpp"
 
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
 #include <windows.h>
@@ -55,84 +56,83 @@ using namespace uhd::niusrprio;
 
 typedef uint64_t fifo_data_t;
 
-class nirio_zero_copy_mrb : public managed_recv_buffer
+/***********************************************************************
+ * A batch is one acquire() from the DMA FIFO that holds one or more
+ * frames. The frames are handed out as individual buffers and the whole
+ * batch is granted back to the FIFO with a single release() once the
+ * last of them has been released.
+ **********************************************************************/
+class nirio_zero_copy_batch
 {
 public:
-    nirio_zero_copy_mrb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size):
-        _fifo(fifo), _frame_size(frame_size) { }
+    nirio_zero_copy_batch(nirio_fifo<fifo_data_t>& fifo):
+        _fifo(fifo), _num_elems(0), _outstanding(0) { }
 
-    void release(void)
+    UHD_INLINE void reset(const size_t num_frames, const size_t num_elems)
     {
-        _fifo.release(_frame_size / sizeof(fifo_data_t));
+        _num_elems = num_elems;
+        _outstanding.store(num_frames, boost::memory_order_release);
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index)
+    UHD_INLINE void release_frame(void)
     {
-        nirio_status status = 0;
-        size_t elems_acquired = 0;
-        size_t elems_remaining = 0;
-        nirio_status_chain(_fifo.acquire(
-            _typed_buffer, _frame_size / sizeof(fifo_data_t),
-            static_cast<uint32_t>(timeout*1000),
-            elems_acquired, elems_remaining), status);
-        _length = elems_acquired * sizeof(fifo_data_t);
-        _buffer = static_cast<void*>(_typed_buffer);
-
-        if (nirio_status_not_fatal(status)) {
-            index++;        //Advances the caller's buffer
-            return make(this, _buffer, _length);
-        } else if (status == NiRio_Status_CommunicationTimeout) {
-            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
-            return sptr();
-        } else {
-            return sptr();  //NULL for timeout or error.
+        if (_outstanding.fetch_sub(1, boost::memory_order_acq_rel) == 1) {
+            _fifo.release(_num_elems);
         }
     }
 
 private:
     nirio_fifo<fifo_data_t>&    _fifo;
-    fifo_data_t*                _typed_buffer;
-    const size_t                _frame_size;
+    size_t                      _num_elems;
+    boost::atomic<size_t>       _outstanding;
 };
 
-class nirio_zero_copy_msb : public managed_send_buffer
+class nirio_zero_copy_mrb : public managed_recv_buffer
 {
 public:
-    nirio_zero_copy_msb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size):
-        _fifo(fifo), _frame_size(frame_size) { }
+    nirio_zero_copy_mrb(): _batch(NULL) { }
 
     void release(void)
     {
-        _fifo.release(_frame_size / sizeof(fifo_data_t));
+        _batch->release_frame();
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index)
+    UHD_INLINE sptr get_new(fifo_data_t* buffer, const size_t length, nirio_zero_copy_batch* batch)
     {
-        nirio_status status = 0;
-        size_t elems_acquired = 0;
-        size_t elems_remaining = 0;
-        nirio_status_chain(_fifo.acquire(
-            _typed_buffer, _frame_size / sizeof(fifo_data_t),
-            static_cast<uint32_t>(timeout*1000),
-            elems_acquired, elems_remaining), status);
-        _length = elems_acquired * sizeof(fifo_data_t);
-        _buffer = static_cast<void*>(_typed_buffer);
+        _batch = batch;
+        _buffer = static_cast<void*>(buffer);
+        _length = length;
+        return make(this, _buffer, _length);
+    }
 
-        if (nirio_status_not_fatal(status)) {
-            index++;        //Advances the caller's buffer
-            return make(this, _buffer, _length);
-        } else if (status == NiRio_Status_CommunicationTimeout) {
-            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
-            return sptr();
-        } else {
-            return sptr();  //NULL for timeout or error.
-        }
+private:
+    nirio_zero_copy_batch*      _batch;
+};
+
+class nirio_zero_copy_msb : public managed_send_buffer
+{
+public:
+    nirio_zero_copy_msb(nirio_fifo<fifo_data_t>& fifo):
+        _fifo(fifo), _elems(0) { }
+
+    void release(void)
+    {
+        //Commit each frame as soon as it is released so that the tail
+        //of a burst is never held back waiting for the rest of a batch.
+        _fifo.release(_elems);
+    }
+
+    UHD_INLINE sptr get_new(fifo_data_t* buffer, const size_t length)
+    {
+        _elems = length / sizeof(fifo_data_t);
+        _buffer = static_cast<void*>(buffer);
+        _length = length;
+        return make(this, _buffer, _length);
     }
 
 private:
     nirio_fifo<fifo_data_t>&    _fifo;
-    fifo_data_t*                _typed_buffer;
-    const size_t                _frame_size;
+    size_t                      _elems;
 };
 
 class nirio_zero_copy_impl : public nirio_zero_copy {
@@ -142,12 +142,20 @@ public:
     nirio_zero_copy_impl(
         uhd::niusrprio::niusrprio_session::sptr fpga_session,
         uint32_t instance,
-        const zero_copy_xport_params& xport_params
+        const zero_copy_xport_params& xport_params,
+        const size_t recv_batch_size,
+        const size_t send_batch_size
     ):
         _fpga_session(fpga_session),
         _fifo_instance(instance),
         _xport_params(xport_params),
-        _next_recv_buff_index(0), _next_send_buff_index(0)
+        _recv_batch_size(std::max<size_t>(1, std::min(recv_batch_size, xport_params.num_recv_frames))),
+        _send_batch_size(std::max<size_t>(1, std::min(send_batch_size, xport_params.num_send_frames))),
+        _next_recv_buff_index(0), _next_send_buff_index(0),
+        _next_recv_batch_index(0),
+        _recv_batch(NULL), _recv_batch_buffer(NULL), _recv_batch_elems_left(0), _recv_frames_available(0),
+        _send_batch_buffer(NULL), _send_batch_elems_left(0), _send_frames_available(0),
+        _recv_queue_depth(0)
     {
         UHD_LOG << boost::format("Creating PCIe transport for channel %d") % instance << std::endl;
         UHD_LOG << boost::format("nirio zero-copy RX transport configured with frame size = %u, #frames = %u, buffer size = %u\n")
@@ -155,6 +163,8 @@ public:
                     (_xport_params.recv_frame_size * _xport_params.num_recv_frames);
         UHD_LOG << boost::format("nirio zero-copy TX transport configured with frame size = %u, #frames = %u, buffer size = %u\n")
                     % _xport_params.send_frame_size % _xport_params.num_send_frames % (_xport_params.send_frame_size * _xport_params.num_send_frames);
+        UHD_LOG << boost::format("nirio zero-copy transport batching up to %u RX and %u TX frames per acquire\n")
+                    % _recv_batch_size % _send_batch_size;
 
         _recv_buffer_pool = buffer_pool::make(_xport_params.num_recv_frames, _xport_params.recv_frame_size);
         _send_buffer_pool = buffer_pool::make(_xport_params.num_send_frames, _xport_params.send_frame_size);
@@ -216,16 +226,18 @@ public:
             nirio_status_chain(_send_fifo->start(), status);
 
             if (nirio_status_not_fatal(status)) {
-                //allocate re-usable managed receive buffers
+                //allocate re-usable managed receive buffers and batches
+                //(a batch holds at least one frame, so one per frame is enough)
                 for (size_t i = 0; i < get_num_recv_frames(); i++){
-                    _mrb_pool.push_back(boost::shared_ptr<nirio_zero_copy_mrb>(new nirio_zero_copy_mrb(
-                        *_recv_fifo, get_recv_frame_size())));
+                    _mrb_pool.push_back(boost::shared_ptr<nirio_zero_copy_mrb>(new nirio_zero_copy_mrb()));
+                    _recv_batches.push_back(boost::shared_ptr<nirio_zero_copy_batch>(
+                        new nirio_zero_copy_batch(*_recv_fifo)));
                 }
 
                 //allocate re-usable managed send buffers
                 for (size_t i = 0; i < get_num_send_frames(); i++){
                     _msb_pool.push_back(boost::shared_ptr<nirio_zero_copy_msb>(new nirio_zero_copy_msb(
-                        *_send_fifo, get_send_frame_size())));
+                        *_send_fifo)));
                 }
             }
         } else {
@@ -253,12 +265,25 @@ public:
 
     /*******************************************************************
      * Receive implementation:
-     * Block on the managed buffer's get call and advance the index.
+     * Acquire a batch of frames from the FIFO when the current one is
+     * used up, then hand out the next frame of the batch.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
-        if (_next_recv_buff_index == _xport_params.num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        managed_recv_buffer::sptr buff;
+        if (_recv_batch_elems_left > 0 or _acquire_recv_batch(timeout)) {
+            if (_next_recv_buff_index == _xport_params.num_recv_frames) _next_recv_buff_index = 0;
+            const size_t elems = std::min(_recv_batch_elems_left, _recv_frame_elems());
+            buff = _mrb_pool[_next_recv_buff_index++]->get_new(
+                _recv_batch_buffer, elems * sizeof(fifo_data_t), _recv_batch);
+            _recv_batch_buffer += elems;
+            _recv_batch_elems_left -= elems;
+        }
+        _stats.count_recv(buff);
+        _recv_queue_depth.store(
+            _recv_frames_available + _recv_batch_elems_left / _recv_frame_elems(),
+            boost::memory_order_relaxed);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const {return _xport_params.num_recv_frames;}
@@ -266,21 +291,103 @@ public:
 
     /*******************************************************************
      * Send implementation:
-     * Block on the managed buffer's get call and advance the index.
+     * Acquire space for a batch of frames from the FIFO when the current
+     * one is used up, then hand out the next frame of the batch.
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout)
     {
-        if (_next_send_buff_index == _xport_params.num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff;
+        if (_send_batch_elems_left > 0 or _acquire_send_batch(timeout)) {
+            if (_next_send_buff_index == _xport_params.num_send_frames) _next_send_buff_index = 0;
+            const size_t elems = std::min(_send_batch_elems_left, _send_frame_elems());
+            buff = _msb_pool[_next_send_buff_index++]->get_new(
+                _send_batch_buffer, elems * sizeof(fifo_data_t));
+            _send_batch_buffer += elems;
+            _send_batch_elems_left -= elems;
+        }
+        _stats.count_send(buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _xport_params.num_send_frames;}
     size_t get_send_frame_size(void) const {return _xport_params.send_frame_size;}
 
+    zero_copy_stats_t get_stats(void) const
+    {
+        zero_copy_stats_t stats = _stats.get();
+        stats.recv_queue_depth = _recv_queue_depth.load(boost::memory_order_relaxed);
+        return stats;
+    }
+
 private:
 
     UHD_INLINE niriok_proxy::sptr _proxy() { return _fpga_session->get_kernel_proxy(); }
 
+    UHD_INLINE size_t _recv_frame_elems(void) const { return _xport_params.recv_frame_size / sizeof(fifo_data_t); }
+    UHD_INLINE size_t _send_frame_elems(void) const { return _xport_params.send_frame_size / sizeof(fifo_data_t); }
+
+    /*!
+     * Acquire up to _recv_batch_size frames with one FIFO call.
+     * Only as many frames as the last acquire reported available are
+     * requested, so the call never waits for a full batch to arrive;
+     * with nothing known to be available a single frame is requested.
+     */
+    UHD_INLINE bool _acquire_recv_batch(const double timeout)
+    {
+        const size_t frames_requested = std::max<size_t>(1,
+            std::min(_recv_frames_available, _recv_batch_size));
+        nirio_status status = 0;
+        size_t elems_acquired = 0;
+        size_t elems_remaining = 0;
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        nirio_status_chain(_recv_fifo->acquire(
+            _recv_batch_buffer, frames_requested * _recv_frame_elems(),
+            static_cast<uint32_t>(timeout*1000),
+            elems_acquired, elems_remaining), status);
+        _stats.add_recv_wait(wait_start);
+        _recv_frames_available = elems_remaining / _recv_frame_elems();
+
+        if (nirio_status_not_fatal(status) and elems_acquired > 0) {
+            if (_next_recv_batch_index == _recv_batches.size()) _next_recv_batch_index = 0;
+            _recv_batch = _recv_batches[_next_recv_batch_index++].get();
+            _recv_batch->reset(
+                (elems_acquired + _recv_frame_elems() - 1) / _recv_frame_elems(), elems_acquired);
+            _recv_batch_elems_left = elems_acquired;
+            return true;
+        } else if (status == NiRio_Status_CommunicationTimeout) {
+            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
+        }
+        return false;   //timeout or error
+    }
+
+    /*!
+     * Acquire space for up to _send_batch_size frames with one FIFO call.
+     * The frames are committed individually as they are released.
+     */
+    UHD_INLINE bool _acquire_send_batch(const double timeout)
+    {
+        const size_t frames_requested = std::max<size_t>(1,
+            std::min(_send_frames_available, _send_batch_size));
+        nirio_status status = 0;
+        size_t elems_acquired = 0;
+        size_t elems_remaining = 0;
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        nirio_status_chain(_send_fifo->acquire(
+            _send_batch_buffer, frames_requested * _send_frame_elems(),
+            static_cast<uint32_t>(timeout*1000),
+            elems_acquired, elems_remaining), status);
+        _stats.add_send_wait(wait_start);
+        _send_frames_available = elems_remaining / _send_frame_elems();
+
+        if (nirio_status_not_fatal(status) and elems_acquired > 0) {
+            _send_batch_elems_left = elems_acquired;
+            return true;
+        } else if (status == NiRio_Status_CommunicationTimeout) {
+            nirio_status_to_exception(status, "NI-RIO PCIe data transfer failed.");
+        }
+        return false;   //timeout or error
+    }
+
     UHD_INLINE void _flush_rx_buff()
     {
         // acquire is called with 0 elements requested first to
@@ -353,10 +460,22 @@ private:
     uint32_t _fifo_instance;
     nirio_fifo<fifo_data_t>::sptr _recv_fifo, _send_fifo;
     const zero_copy_xport_params _xport_params;
+    const size_t _recv_batch_size, _send_batch_size;
     buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
     std::vector<boost::shared_ptr<nirio_zero_copy_msb> > _msb_pool;
     std::vector<boost::shared_ptr<nirio_zero_copy_mrb> > _mrb_pool;
+    std::vector<boost::shared_ptr<nirio_zero_copy_batch> > _recv_batches;
     size_t _next_recv_buff_index, _next_send_buff_index;
+    size_t _next_recv_batch_index;
+    //receive batch state (only touched by the get_recv_buff() caller)
+    nirio_zero_copy_batch* _recv_batch;
+    fifo_data_t* _recv_batch_buffer;
+    size_t _recv_batch_elems_left, _recv_frames_available;
+    //send batch state (only touched by the get_send_buff() caller)
+    fifo_data_t* _send_batch_buffer;
+    size_t _send_batch_elems_left, _send_frames_available;
+    zero_copy_stats_counter _stats;
+    boost::atomic<size_t> _recv_queue_depth;
 };
 
 
@@ -460,6 +579,11 @@ nirio_zero_copy::sptr nirio_zero_copy::make(
         throw uhd::value_error((boost::format("num_send_frames * send_frame_size must be an even multiple of %d") % page_size).str());
     }
 
-    return nirio_zero_copy::sptr(new nirio_zero_copy_impl(fpga_session, instance, xport_params));
+    //Batching: number of frames to take from the DMA FIFO with one acquire
+    const size_t recv_batch_size = size_t(hints.cast<double>("recv_batch_size", 1));
+    const size_t send_batch_size = size_t(hints.cast<double>("send_batch_size", 1));
+
+    return nirio_zero_copy::sptr(new nirio_zero_copy_impl(
+        fpga_session, instance, xport_params, recv_batch_size, send_batch_size));
 }
 
@@ -0,0 +1,135 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_RECV_HANDLE_POOL_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_RECV_HANDLE_POOL_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Handles for the packets of a zero-copy receive, without allocating.
+ *
+ * A handle owns one buffer per channel until its last copy is dropped,
+ * on any thread. The handles live in a fixed number of slots, and the
+ * control block of each handle's shared pointer is placed in its slot,
+ * so only a caller that holds on to more packets than there are slots
+ * gets handles from the heap.
+ */
+class recv_handle_pool : boost::noncopyable, public boost::enable_shared_from_this<recv_handle_pool>{
+public:
+    typedef boost::shared_ptr<recv_handle_pool> sptr;
+    typedef std::vector<managed_recv_buffer::sptr> buffs_type;
+
+    recv_handle_pool(const size_t num_slots, const size_t num_chans):
+        _num_chans(num_chans), _slots(num_slots)
+    {
+        _free.reserve(num_slots);
+        for (size_t i = num_slots; i > 0; i--){
+            _slots[i-1].buffs.resize(num_chans);
+            _free.push_back(i-1);
+        }
+    }
+
+    //! Get a handle with room for one buffer per channel
+    boost::shared_ptr<buffs_type> make(void){
+        size_t index;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_free.empty()) return boost::make_shared<buffs_type>(_num_chans);
+            index = _free.back();
+            _free.pop_back();
+        }
+        return boost::shared_ptr<buffs_type>(
+            &_slots[index].buffs, releaser(), slot_allocator<char>(shared_from_this(), index));
+    }
+
+private:
+    //! Hand the buffers back to the transports when the handle is dropped
+    struct releaser{
+        void operator()(buffs_type *buffs) const{
+            for (size_t i = 0; i < buffs->size(); i++) (*buffs)[i].reset();
+        }
+    };
+
+    //! Places the control block in the slot, and frees the slot with it
+    template <typename T> struct slot_allocator{
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        template <typename U> struct rebind{typedef slot_allocator<U> other;};
+
+        slot_allocator(const sptr &pool, const size_t index): pool(pool), index(index){}
+        template <typename U> slot_allocator(const slot_allocator<U> &other): pool(other.pool), index(other.index){}
+
+        T *allocate(const size_t n, const void * = NULL){
+            return static_cast<T *>(pool->allocate_block(index, n*sizeof(T)));
+        }
+        void deallocate(T *p, const size_t){
+            pool->deallocate_block(index, p);
+        }
+        template <typename U> bool operator==(const slot_allocator<U> &other) const{
+            return pool == other.pool and index == other.index;
+        }
+        template <typename U> bool operator!=(const slot_allocator<U> &other) const{
+            return not (*this == other);
+        }
+
+        sptr pool; //keeps the slots until the last handle is gone
+        size_t index;
+    };
+
+    void *allocate_block(const size_t index, const size_t size){
+        if (size <= sizeof(_slots[index].block)) return &_slots[index].block;
+        return ::operator new(size); //a control block this large is unexpected
+    }
+
+    void deallocate_block(const size_t index, void *block){
+        if (block != &_slots[index].block) ::operator delete(block);
+        boost::mutex::scoped_lock lock(_mutex);
+        _free.push_back(index);
+    }
+
+    struct slot_t{
+        buffs_type buffs;
+        boost::aligned_storage<128, 16>::type block;
+    };
+
+    const size_t _num_chans;
+    std::vector<slot_t> _slots;
+    std::vector<size_t> _free;
+    boost::mutex _mutex;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_RECV_HANDLE_POOL_HPP */
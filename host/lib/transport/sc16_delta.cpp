@@ -0,0 +1,286 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/sc16_delta.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static const size_t MAX_NSAMPS = 0xffff;
+static const size_t MAX_WIDTH = 16;
+
+static UHD_INLINE uint16_t zigzag(const uint16_t cur, const uint16_t prev)
+{
+    const uint16_t diff = uint16_t(cur - prev);
+    return uint16_t((diff << 1) ^ (0 - (diff >> 15)));
+}
+
+static UHD_INLINE uint16_t unzigzag(const uint32_t z, const uint16_t prev)
+{
+    return uint16_t(prev + ((z >> 1) ^ (0 - (z & 1))));
+}
+
+static size_t encoded_words32(const size_t nsamps, const size_t width)
+{
+    if (nsamps == 0) return 1;
+    return 2 + ((nsamps - 1)*2*width + 31)/32;
+}
+
+/***********************************************************************
+ * Encode and decode
+ **********************************************************************/
+size_t sc16_delta::max_encoded_words32(const size_t nsamps)
+{
+    return encoded_words32(nsamps, MAX_WIDTH);
+}
+
+size_t sc16_delta::encode(const uint32_t *in, const size_t nsamps, uint32_t *out)
+{
+    if (nsamps > MAX_NSAMPS) {
+        throw uhd::value_error("sc16_delta: too many samples for one payload");
+    }
+
+    //find the width that holds every difference
+    uint32_t all_bits = 0;
+    for (size_t i = 1; i < nsamps; i++) {
+        all_bits |= zigzag(uint16_t(in[i] >> 16), uint16_t(in[i-1] >> 16));
+        all_bits |= zigzag(uint16_t(in[i]), uint16_t(in[i-1]));
+    }
+    size_t width = 0;
+    while (all_bits >> width) width++;
+
+    out[0] = uint32_t(nsamps << 16) | uint32_t(width);
+    if (nsamps == 0) return 1;
+    out[1] = in[0];
+
+    size_t index = 2;
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    for (size_t i = 1; i < nsamps; i++) {
+        acc |= uint64_t(zigzag(uint16_t(in[i] >> 16), uint16_t(in[i-1] >> 16))) << acc_bits;
+        acc |= uint64_t(zigzag(uint16_t(in[i]), uint16_t(in[i-1]))) << (acc_bits + width);
+        acc_bits += 2*width;
+        if (acc_bits >= 32) {
+            out[index++] = uint32_t(acc);
+            acc >>= 32;
+            acc_bits -= 32;
+        }
+    }
+    if (acc_bits != 0) out[index++] = uint32_t(acc);
+    return index;
+}
+
+size_t sc16_delta::decode(
+    const uint32_t *in, const size_t nwords32,
+    uint32_t *out, const size_t max_nsamps
+){
+    if (nwords32 == 0) {
+        throw uhd::value_error("sc16_delta: empty payload");
+    }
+    const size_t nsamps = in[0] >> 16;
+    const size_t width = in[0] & 0xff;
+    if (width > MAX_WIDTH or encoded_words32(nsamps, width) > nwords32) {
+        throw uhd::value_error("sc16_delta: malformed payload");
+    }
+    if (nsamps > max_nsamps) {
+        throw uhd::value_error("sc16_delta: payload holds more samples than there is room for");
+    }
+    if (nsamps == 0) return 0;
+
+    uint16_t hi = uint16_t(in[1] >> 16);
+    uint16_t lo = uint16_t(in[1]);
+    out[0] = in[1];
+
+    const uint32_t mask = (uint32_t(1) << width) - 1;
+    size_t index = 2;
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    for (size_t i = 1; i < nsamps; i++) {
+        if (acc_bits < 2*width) {
+            acc |= uint64_t(in[index++]) << acc_bits;
+            acc_bits += 32;
+        }
+        hi = unzigzag(uint32_t(acc) & mask, hi);
+        lo = unzigzag(uint32_t(acc >> width) & mask, lo);
+        acc >>= 2*width;
+        acc_bits -= 2*width;
+        out[i] = (uint32_t(hi) << 16) | lo;
+    }
+    return nsamps;
+}
+
+/***********************************************************************
+ * Decoding transport
+ **********************************************************************/
+class sc16_delta_mrb : public managed_recv_buffer
+{
+public:
+    sc16_delta_mrb(const size_t frame_size):
+        _mem(frame_size/sizeof(uint32_t))
+    {
+        /* NOP */
+    }
+
+    void release(void)
+    {
+        /* NOP */
+    }
+
+    uint32_t *mem(void)
+    {
+        return &_mem.front();
+    }
+
+    size_t mem_words32(void) const
+    {
+        return _mem.size();
+    }
+
+    sptr get(const size_t num_bytes)
+    {
+        return make(this, &_mem.front(), num_bytes);
+    }
+
+private:
+    std::vector<uint32_t> _mem;
+};
+
+class sc16_delta_decoder_impl : public sc16_delta::decoder
+{
+public:
+    sc16_delta_decoder_impl(zero_copy_if::sptr transport, const bool chdr, const bool big_endian):
+        _transport(transport),
+        _chdr(chdr),
+        _big_endian(big_endian),
+        _next_buff(0)
+    {
+        for (size_t i = 0; i < transport->get_num_recv_frames(); i++) {
+            _buffs.push_back(boost::make_shared<sc16_delta_mrb>(transport->get_recv_frame_size()));
+        }
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double timeout)
+    {
+        //the streamer gives a packet back before it asks for one more,
+        //so a free buffer is there unless the streamer holds them all
+        sc16_delta_mrb *out = this->find_free_buff();
+        if (out == NULL) return managed_recv_buffer::sptr();
+
+        managed_recv_buffer::sptr buff = _transport->get_recv_buff(timeout);
+        if (not buff) return buff;
+
+        const uint32_t *pkt = buff->cast<const uint32_t *>();
+        vrt::if_packet_info_t info;
+        info.link_type = _chdr? vrt::if_packet_info_t::LINK_TYPE_CHDR : vrt::if_packet_info_t::LINK_TYPE_NONE;
+        info.num_packet_words32 = buff->size()/sizeof(uint32_t);
+        this->unpack(pkt, info);
+        if (info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_DATA or info.num_payload_words32 == 0) {
+            return buff;
+        }
+
+        //decode in host order, behind the header
+        const uint32_t *payload = pkt + info.num_header_words32;
+        if (_big_endian) {
+            _scratch.resize(info.num_payload_words32);
+            for (size_t i = 0; i < _scratch.size(); i++) _scratch[i] = uhd::ntohx(payload[i]);
+            payload = &_scratch.front();
+        }
+        const size_t room = out->mem_words32() - std::min(out->mem_words32(), info.num_header_words32 + 1);
+        uint32_t *samps = out->mem() + info.num_header_words32;
+        const size_t nsamps = sc16_delta::decode(payload, info.num_payload_words32, samps, room);
+        if (_big_endian) {
+            for (size_t i = 0; i < nsamps; i++) samps[i] = uhd::htonx(samps[i]);
+        }
+
+        info.num_payload_words32 = nsamps;
+        info.num_payload_bytes = nsamps*sizeof(uint32_t);
+        this->pack(out->mem(), info);
+        return out->get(info.num_packet_words32*sizeof(uint32_t));
+    }
+
+    size_t get_num_recv_frames(void) const
+    {
+        return _transport->get_num_recv_frames();
+    }
+
+    size_t get_recv_frame_size(void) const
+    {
+        return _transport->get_recv_frame_size();
+    }
+
+    managed_send_buffer::sptr get_send_buff(double timeout)
+    {
+        return _transport->get_send_buff(timeout);
+    }
+
+    size_t get_num_send_frames(void) const
+    {
+        return _transport->get_num_send_frames();
+    }
+
+    size_t get_send_frame_size(void) const
+    {
+        return _transport->get_send_frame_size();
+    }
+
+private:
+    sc16_delta_mrb *find_free_buff(void)
+    {
+        for (size_t i = 0; i < _buffs.size(); i++) {
+            sc16_delta_mrb *buff = _buffs[_next_buff].get();
+            _next_buff = (_next_buff + 1) % _buffs.size();
+            if (buff->ref_count() == 0) return buff;
+        }
+        return NULL;
+    }
+
+    void unpack(const uint32_t *pkt, vrt::if_packet_info_t &info)
+    {
+        if (_chdr and _big_endian) vrt::chdr::if_hdr_unpack_be(pkt, info);
+        else if (_chdr) vrt::chdr::if_hdr_unpack_le(pkt, info);
+        else if (_big_endian) vrt::if_hdr_unpack_be(pkt, info);
+        else vrt::if_hdr_unpack_le(pkt, info);
+    }
+
+    void pack(uint32_t *pkt, vrt::if_packet_info_t &info)
+    {
+        if (_chdr and _big_endian) vrt::chdr::if_hdr_pack_be(pkt, info);
+        else if (_chdr) vrt::chdr::if_hdr_pack_le(pkt, info);
+        else if (_big_endian) vrt::if_hdr_pack_be(pkt, info);
+        else vrt::if_hdr_pack_le(pkt, info);
+    }
+
+    zero_copy_if::sptr _transport;
+    const bool _chdr;
+    const bool _big_endian;
+    std::vector<boost::shared_ptr<sc16_delta_mrb> > _buffs;
+    size_t _next_buff;
+    std::vector<uint32_t> _scratch;
+};
+
+sc16_delta::decoder::sptr sc16_delta::decoder::make(
+    zero_copy_if::sptr transport, const bool chdr, const bool big_endian
+){
+    return sptr(new sc16_delta_decoder_impl(transport, chdr, big_endian));
+}
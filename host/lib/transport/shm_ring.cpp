@@ -0,0 +1,312 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "shm_ring.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace ip = boost::interprocess;
+
+static const uint32_t SHM_RING_MAGIC   = 0x55534852; //"USHR"
+static const uint32_t SHM_RING_VERSION = 1;
+static const uint32_t SHM_SLOT_INVALID = 0xffffffff;
+static const size_t SHM_ALIGN          = 64;
+static const double SHM_POLL_SECS      = 50e-6; //reader poll interval
+
+static const uint32_t SHM_FLAG_HAS_TIME_SPEC = (1 << 0);
+static const uint32_t SHM_FLAG_START_OF_BURST = (1 << 1);
+static const uint32_t SHM_FLAG_END_OF_BURST = (1 << 2);
+
+/***********************************************************************
+ * Layout of the shared memory
+ **********************************************************************/
+struct shm_ring_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t slot_size; //in bytes, including the slot header
+    uint32_t num_chans;
+    uint32_t spp;
+    uint32_t bytes_per_item;
+    char cpu_format[20];
+    double samp_rate;
+    atomic_uint32_t num_written; //packets committed since the start
+    atomic_uint32_t num_readers;
+    atomic_uint32_t closed;
+};
+
+struct shm_slot_header_t
+{
+    atomic_uint32_t seq; //the packet number, or SHM_SLOT_INVALID while written
+    uint32_t nsamps;
+    uint32_t flags;
+    uint32_t error_code;
+    int64_t full_secs;
+    double frac_secs;
+};
+
+static size_t align_up(const size_t size)
+{
+    return ((size + SHM_ALIGN - 1) / SHM_ALIGN) * SHM_ALIGN;
+}
+
+static size_t header_size(void)
+{
+    return align_up(sizeof(shm_ring_header_t));
+}
+
+static size_t slot_header_size(void)
+{
+    return align_up(sizeof(shm_slot_header_t));
+}
+
+static std::string shm_object_name(const std::string &name)
+{
+    return "uhd_shm_" + name;
+}
+
+shm_ring::~shm_ring(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Implementation, shared by writer and reader
+ **********************************************************************/
+class shm_ring_impl : public shm_ring
+{
+public:
+    //! Create, for writing
+    shm_ring_impl(const std::string &name, const info_t &info):
+        _name(shm_object_name(name)),
+        _writer(true),
+        _info(info),
+        _cursor(0),
+        _offset(0)
+    {
+        if (info.num_chans == 0 or info.spp == 0 or info.num_slots < 2 or info.bytes_per_item == 0) {
+            throw uhd::value_error("shm_ring: the ring needs channels, samples and at least 2 slots");
+        }
+        if (info.cpu_format.size() >= sizeof(((shm_ring_header_t *)0)->cpu_format)) {
+            throw uhd::value_error("shm_ring: cpu format name too long: " + info.cpu_format);
+        }
+        const size_t slot_size = slot_header_size() + align_up(info.num_chans*info.spp*info.bytes_per_item);
+
+        ip::shared_memory_object::remove(_name.c_str());
+        _shm = ip::shared_memory_object(ip::create_only, _name.c_str(), ip::read_write);
+        _shm.truncate(ip::offset_t(header_size() + info.num_slots*slot_size));
+        _region = ip::mapped_region(_shm, ip::read_write);
+
+        _hdr = new (_region.get_address()) shm_ring_header_t();
+        _hdr->magic = SHM_RING_MAGIC;
+        _hdr->version = SHM_RING_VERSION;
+        _hdr->num_slots = uint32_t(info.num_slots);
+        _hdr->slot_size = uint32_t(slot_size);
+        _hdr->num_chans = uint32_t(info.num_chans);
+        _hdr->spp = uint32_t(info.spp);
+        _hdr->bytes_per_item = uint32_t(info.bytes_per_item);
+        std::strncpy(_hdr->cpu_format, info.cpu_format.c_str(), sizeof(_hdr->cpu_format));
+        _hdr->samp_rate = info.samp_rate;
+        for (size_t i = 0; i < info.num_slots; i++) {
+            new (slot(i)) shm_slot_header_t();
+            slot(i)->seq.write(SHM_SLOT_INVALID);
+        }
+        _buffs.resize(info.num_chans);
+    }
+
+    //! Open, for reading
+    shm_ring_impl(const std::string &name):
+        _name(shm_object_name(name)),
+        _writer(false),
+        _cursor(0),
+        _offset(0)
+    {
+        try {
+            _shm = ip::shared_memory_object(ip::open_only, _name.c_str(), ip::read_write);
+            _region = ip::mapped_region(_shm, ip::read_write);
+        } catch (const ip::interprocess_exception &e) {
+            throw uhd::io_error(str(boost::format("shm_ring: cannot open %s: %s") % name % e.what()));
+        }
+        _hdr = static_cast<shm_ring_header_t *>(_region.get_address());
+        if (_region.get_size() < header_size() or _hdr->magic != SHM_RING_MAGIC or _hdr->version != SHM_RING_VERSION) {
+            throw uhd::io_error("shm_ring: " + name + " is not a ring of this UHD version");
+        }
+        _info.cpu_format = std::string(_hdr->cpu_format, strnlen(_hdr->cpu_format, sizeof(_hdr->cpu_format)));
+        _info.bytes_per_item = _hdr->bytes_per_item;
+        _info.num_chans = _hdr->num_chans;
+        _info.spp = _hdr->spp;
+        _info.num_slots = _hdr->num_slots;
+        _info.samp_rate = _hdr->samp_rate;
+        _hdr->num_readers.inc();
+        _cursor = _hdr->num_written.read();
+    }
+
+    ~shm_ring_impl(void)
+    {
+        UHD_SAFE_CALL(
+            if (_writer) {
+                _hdr->closed.write(1);
+                ip::shared_memory_object::remove(_name.c_str());
+            } else {
+                _hdr->num_readers.dec();
+            }
+        )
+    }
+
+    const info_t &get_info(void) const
+    {
+        return _info;
+    }
+
+    size_t get_num_readers(void) const
+    {
+        return _hdr->num_readers.read();
+    }
+
+    const std::vector<void *> &claim(void)
+    {
+        shm_slot_header_t *s = slot(_hdr->num_written.read() % _info.num_slots);
+        s->seq.write(SHM_SLOT_INVALID);
+        char *samps = reinterpret_cast<char *>(s) + slot_header_size();
+        for (size_t i = 0; i < _buffs.size(); i++) {
+            _buffs[i] = samps + i*_info.spp*_info.bytes_per_item;
+        }
+        return _buffs;
+    }
+
+    void commit(const size_t nsamps, const rx_metadata_t &md)
+    {
+        const uint32_t seq = _hdr->num_written.read();
+        shm_slot_header_t *s = slot(seq % _info.num_slots);
+        s->nsamps = uint32_t(std::min(nsamps, _info.spp));
+        s->flags = (md.has_time_spec? SHM_FLAG_HAS_TIME_SPEC : 0)
+                 | (md.start_of_burst? SHM_FLAG_START_OF_BURST : 0)
+                 | (md.end_of_burst? SHM_FLAG_END_OF_BURST : 0);
+        s->error_code = uint32_t(md.error_code);
+        s->full_secs = md.time_spec.get_full_secs();
+        s->frac_secs = md.time_spec.get_frac_secs();
+        s->seq.write(seq);
+        _hdr->num_written.write(seq + 1);
+    }
+
+    size_t read(
+        const std::vector<void *> &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &md,
+        const double timeout
+    ){
+        md.reset();
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+
+        //wait for the packet under the cursor
+        uint32_t num_written = _hdr->num_written.read();
+        while (num_written == _cursor) {
+            if (_hdr->closed.read()) {
+                throw uhd::io_error("shm_ring: the writer closed the ring");
+            }
+            if (boost::get_system_time() > exit_time) {
+                md.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+                return 0;
+            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(long(SHM_POLL_SECS*1e6)));
+            num_written = _hdr->num_written.read();
+        }
+        if (num_written - _cursor > _info.num_slots) {
+            return this->overflow(md);
+        }
+
+        //copy, then check the writer did not reuse the slot meanwhile
+        shm_slot_header_t *s = slot(_cursor % _info.num_slots);
+        if (s->seq.read() != _cursor) return this->overflow(md);
+        const size_t slot_nsamps = std::min<size_t>(s->nsamps, _info.spp);
+        const uint32_t flags = s->flags;
+        const uint32_t error_code = s->error_code;
+        const time_spec_t time_spec(time_t(s->full_secs), s->frac_secs);
+        const size_t nsamps = std::min(nsamps_per_buff, slot_nsamps - std::min(_offset, slot_nsamps));
+        const char *samps = reinterpret_cast<const char *>(s) + slot_header_size();
+        for (size_t i = 0; i < buffs.size() and i < _info.num_chans; i++) {
+            if (buffs[i] == NULL) continue;
+            std::memcpy(buffs[i],
+                samps + (i*_info.spp + _offset)*_info.bytes_per_item,
+                nsamps*_info.bytes_per_item);
+        }
+        if (s->seq.read() != _cursor) return this->overflow(md);
+
+        md.error_code = rx_metadata_t::error_code_t(error_code);
+        md.has_time_spec = (flags & SHM_FLAG_HAS_TIME_SPEC) != 0;
+        md.time_spec = time_spec + time_spec_t::from_ticks((long long)(_offset), _info.samp_rate);
+        md.start_of_burst = (_offset == 0) and (flags & SHM_FLAG_START_OF_BURST) != 0;
+        md.fragment_offset = _offset;
+
+        _offset += nsamps;
+        md.more_fragments = (_offset < slot_nsamps);
+        if (not md.more_fragments) {
+            md.end_of_burst = (flags & SHM_FLAG_END_OF_BURST) != 0;
+            _cursor++;
+            _offset = 0;
+        }
+        return nsamps;
+    }
+
+private:
+    shm_slot_header_t *slot(const size_t index) const
+    {
+        return reinterpret_cast<shm_slot_header_t *>(
+            static_cast<char *>(_region.get_address()) + header_size() + index*_hdr->slot_size);
+    }
+
+    //! The reader fell behind: skip to the newest packet
+    size_t overflow(rx_metadata_t &md)
+    {
+        _cursor = _hdr->num_written.read() - 1;
+        _offset = 0;
+        md.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+        return 0;
+    }
+
+    const std::string _name;
+    const bool _writer;
+    info_t _info;
+    ip::shared_memory_object _shm;
+    ip::mapped_region _region;
+    shm_ring_header_t *_hdr;
+    std::vector<void *> _buffs;
+    uint32_t _cursor; //reader: the next packet to read
+    size_t _offset;   //reader: samples of that packet already read
+};
+
+shm_ring::sptr shm_ring::create(const std::string &name, const info_t &info)
+{
+    return sptr(new shm_ring_impl(name, info));
+}
+
+shm_ring::sptr shm_ring::open(const std::string &name)
+{
+    return sptr(new shm_ring_impl(name));
+}
@@ -0,0 +1,117 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_SHM_RING_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_SHM_RING_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/metadata.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <string>
+#include <vector>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A broadcast ring of received packets in shared memory.
+ *
+ * One process creates the ring and writes into it, any number of
+ * processes open it and read every packet in order. The writer never
+ * waits for the readers: each reader has its own cursor, and a reader
+ * which falls a whole ring behind loses the oldest packets, which
+ * read() reports as an overflow.
+ *
+ * A slot holds one packet, its metadata followed by the samples of each
+ * channel. The writer invalidates the sequence number of a slot while
+ * it fills it, so a reader can tell a good copy from one the writer
+ * overwrote meanwhile.
+ */
+class shm_ring : boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<shm_ring> sptr;
+
+    //! The stream the ring carries, set by the writer
+    struct info_t
+    {
+        info_t(void): bytes_per_item(0), num_chans(0), spp(0), num_slots(0), samp_rate(0.0) {}
+        std::string cpu_format;
+        size_t bytes_per_item;
+        size_t num_chans;
+        size_t spp; //the most samples per channel a slot holds
+        size_t num_slots;
+        double samp_rate;
+    };
+
+    /*!
+     * Create a ring for writing, replacing any ring of the same name.
+     * The ring is removed when the writer goes away.
+     */
+    static sptr create(const std::string &name, const info_t &info);
+
+    /*!
+     * Open an existing ring for reading.
+     * The reader starts at the next packet written.
+     * \throw uhd::io_error if there is no such ring
+     */
+    static sptr open(const std::string &name);
+
+    virtual ~shm_ring(void) = 0;
+
+    //! The stream the ring carries
+    virtual const info_t &get_info(void) const = 0;
+
+    //! The number of readers which have the ring open
+    virtual size_t get_num_readers(void) const = 0;
+
+    /*!
+     * Writer: claim the next slot and get its sample buffers, one per
+     * channel, each with room for info.spp samples. Readers treat the
+     * slot as overwritten from now on.
+     */
+    virtual const std::vector<void *> &claim(void) = 0;
+
+    /*!
+     * Writer: publish the claimed slot.
+     * \param nsamps the number of samples per channel written to it
+     * \param md the metadata of the samples, or just an error code
+     */
+    virtual void commit(const size_t nsamps, const uhd::rx_metadata_t &md) = 0;
+
+    /*!
+     * Reader: copy samples of the next packet.
+     * A packet larger than the buffers is returned over several calls.
+     * \param buffs one buffer per channel of the ring, NULL to skip it
+     * \param nsamps_per_buff the size of the buffers in samples
+     * \param md filled with the metadata of the samples
+     * \param timeout how long to wait for a packet in seconds
+     * \return the number of samples per channel copied
+     * \throw uhd::io_error when the writer has gone away
+     */
+    virtual size_t read(
+        const std::vector<void *> &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &md,
+        const double timeout
+    ) = 0;
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_SHM_RING_HPP */
@@ -0,0 +1,101 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_SID_ROUTE_TABLE_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_SID_ROUTE_TABLE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <stdint.h>
+#include <cstddef>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Routes from a 16-bit stream address (e.g. the destination address of
+ * a SID) to the route_t of a stream, for the threads that classify
+ * received packets.
+ *
+ * find() is two indexed loads and takes no lock, so it can be called
+ * for every packet. The table has 256 pages of 256 entries, and a page
+ * is only allocated when an address in it gets a route, so a demuxer
+ * with a few streams uses a few KiB.
+ *
+ * Routes change with exchange(), an atomic swap of the entry. The table
+ * does not own the routes: a route that was removed may still be in use
+ * by a thread that found it just before. The owner of the table has to
+ * make sure such threads are done before the route is destroyed.
+ */
+template <typename route_t>
+class sid_route_table : boost::noncopyable
+{
+public:
+    sid_route_table(void)
+    {
+        for (size_t i = 0; i < NUM_PAGES; i++) _pages[i] = NULL;
+    }
+
+    ~sid_route_table(void)
+    {
+        for (size_t i = 0; i < NUM_PAGES; i++) delete _pages[i].load();
+    }
+
+    //! Get the route of an address, or NULL if there is none (any thread)
+    UHD_INLINE route_t *find(const uint16_t addr) const
+    {
+        const page_t *page = _pages[addr >> 8].load();
+        return (page == NULL)? NULL : page->entries[addr & 0xff].load();
+    }
+
+    /*!
+     * Set the route of an address, NULL removes it.
+     * \return the route that the address had before, or NULL
+     */
+    route_t *exchange(const uint16_t addr, route_t *route)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        page_t *page = _pages[addr >> 8].load();
+        if (page == NULL) {
+            if (route == NULL) return NULL;
+            page = new page_t();
+            _pages[addr >> 8] = page;
+        }
+        return page->entries[addr & 0xff].exchange(route);
+    }
+
+private:
+    static const size_t NUM_PAGES = 256;
+    static const size_t PAGE_SIZE = 256;
+
+    struct page_t
+    {
+        page_t(void)
+        {
+            for (size_t i = 0; i < PAGE_SIZE; i++) entries[i] = NULL;
+        }
+        boost::atomic<route_t *> entries[PAGE_SIZE];
+    };
+
+    boost::atomic<page_t *> _pages[NUM_PAGES];
+    boost::mutex _mutex; //serializes the writers
+};
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_SID_ROUTE_TABLE_HPP */
@@ -19,23 +19,36 @@
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_RECV_PACKET_HANDLER_HPP
 
 #include "../rfnoc/rx_stream_terminator.hpp"
+#include "convert_worker_pool.hpp"
+#include "recv_handle_pool.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
 #include <uhd/stream.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/fastpath.hpp>
+#include <uhd/utils/flight_recorder.hpp>
 #include <uhd/utils/tasks.hpp>
+#include <uhd/utils/trace.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/transport/chdr.hpp>
 #include <uhd/transport/zero_copy.hpp>
-#include <boost/dynamic_bitset.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <cmath>
 #include <iostream>
+#include <map>
 #include <vector>
 
 // Included for debugging
@@ -45,8 +58,86 @@
 #include "boost/date_time/posix_time/posix_time.hpp"
 #endif
 
+//! The most channels one receive streamer can align
+#ifndef SRPH_MAX_CHANNELS
+#define SRPH_MAX_CHANNELS 256
+#endif
+
+//! Packets from recv_zero_copy() a caller can hold before handles get allocated
+#ifndef SRPH_ZERO_COPY_HANDLES
+#define SRPH_ZERO_COPY_HANDLES 32
+#endif
+
+//! Size of the buffers of one recv() call above which stores bypass the caches
+#ifndef SRPH_NONTEMPORAL_BYTES
+#define SRPH_NONTEMPORAL_BYTES (4 << 20)
+#endif
+
+//! Packets per channel a receive thread may hold for recv(), see set_recv_threads()
+#ifndef SRPH_RECV_THREAD_DEPTH
+#define SRPH_RECV_THREAD_DEPTH 16
+#endif
+
+//! Seconds a receive thread waits on one transport when all were idle
+#ifndef SRPH_RECV_THREAD_WAIT
+#define SRPH_RECV_THREAD_WAIT 100e-6
+#endif
+
 namespace uhd{ namespace transport{ namespace sph{
 
+/***********************************************************************
+ * A fixed-size set of channel indexes for the alignment logic.
+ * Unlike a dynamic_bitset this never allocates, and finding the next
+ * channel is a count-trailing-zeros on a word.
+ **********************************************************************/
+class channel_mask_t{
+public:
+    //! Set the bits for channels 0 to num_channels-1, clear the rest
+    UHD_INLINE void set_first(const size_t num_channels){
+        for (size_t w = 0; w < num_words; w++){
+            const size_t lo = w*64;
+            if (num_channels >= lo + 64) _words[w] = ~uint64_t(0);
+            else if (num_channels > lo) _words[w] = (uint64_t(1) << (num_channels - lo)) - 1;
+            else _words[w] = 0;
+        }
+    }
+
+    UHD_INLINE void reset(const size_t index){
+        _words[index/64] &= ~(uint64_t(1) << (index%64));
+    }
+
+    UHD_INLINE bool any(void) const{
+        for (size_t w = 0; w < num_words; w++){
+            if (_words[w] != 0) return true;
+        }
+        return false;
+    }
+
+    //! The lowest set index, only valid if any() is true
+    UHD_INLINE size_t find_first(void) const{
+        size_t w = 0;
+        while (_words[w] == 0) w++;
+        return w*64 + count_trailing_zeros(_words[w]);
+    }
+
+private:
+    static const size_t num_words = (SRPH_MAX_CHANNELS + 63)/64;
+    uint64_t _words[num_words];
+
+    static UHD_INLINE size_t count_trailing_zeros(uint64_t word){
+        #if defined(__GNUC__)
+        return size_t(__builtin_ctzll(word));
+        #else
+        size_t n = 0;
+        while ((word & 1) == 0){
+            word >>= 1;
+            n++;
+        }
+        return n;
+        #endif
+    }
+};
+
 UHD_INLINE uint32_t get_context_code(
     const uint32_t *vrt_hdr, const vrt::if_packet_info_t &if_packet_info
 ){
@@ -72,15 +163,49 @@ public:
     typedef boost::function<void(const size_t)> handle_flowctrl_type;
     typedef boost::function<void(const stream_cmd_t&)> issue_stream_cmd_type;
     typedef void(*vrt_unpacker_type)(const uint32_t *, vrt::if_packet_info_t &);
+    typedef void(*vrt_cached_unpacker_type)(const uint32_t *, vrt::if_packet_info_t &, vrt::if_hdr_cache_t &);
     //typedef boost::function<void(const uint32_t *, vrt::if_packet_info_t &)> vrt_unpacker_type;
 
+    /*!
+     * Flow control handler called from the receive path.
+     * An alternative to a bound handle_flowctrl_type: the handler keeps
+     * its own state, so a call costs one virtual dispatch and no copies
+     * of bound arguments.
+     */
+    class flowctrl_handler{
+    public:
+        typedef boost::shared_ptr<flowctrl_handler> sptr;
+        virtual ~flowctrl_handler(void){}
+        //! Called with the sequence number of the last received packet
+        virtual void handle_flowctrl(const size_t last_seq) = 0;
+    };
+
     /*!
      * Make a new packet handler for receive
      * \param size the number of transport channels
      */
     recv_packet_handler(const size_t size = 1):
+        _vrt_unpacker(NULL),
+        _vrt_cached_unpacker(NULL),
+        _tsf_elision(false),
+        _tick_rate(1.0), _samp_rate(1.0), _ticks_per_samp(1),
+        _next_samp_rate(1.0), _next_scale_factor(1/32767.),
         _queue_error_for_next_call(false),
-        _buffers_infos_index(0)
+        _gap_pending(false),
+        _next_time_valid(false),
+        _num_planes(1),
+        _scale_factor(1/32767.),
+        _host_decim(1),
+        _decim_phase(0),
+        _power_metadata(false),
+        _one_packet(false),
+        _convert_threads(1),
+        _recv_threads(false),
+        _recv_threads_pending(false),
+        _nontemporal_mode(NONTEMPORAL_AUTO),
+        _nontemporal(false),
+        _buffers_infos_index(0),
+        _stream_cmd_latency(0.0)
     {
         #ifdef  ERROR_INJECT_DROPPED_PACKETS
         recvd_packets = 0;
@@ -91,15 +216,23 @@ public:
     }
 
     ~recv_packet_handler(void){
-        /* NOP */
+        this->stop_recv_threads();
     }
 
     //! Resize the number of transport channels
     void resize(const size_t size){
         if (this->size() == size) return;
+        if (size > SRPH_MAX_CHANNELS){
+            throw uhd::value_error(str(boost::format(
+                "A receive streamer supports at most %u channels, %u requested")
+                % SRPH_MAX_CHANNELS % size));
+        }
+        this->stop_recv_threads();
         _props.resize(size);
         //re-initialize all buffers infos by re-creating the vector
         _buffers_infos = std::vector<buffers_info_type>(4, buffers_info_type(size));
+        _zero_copy_handles = boost::make_shared<recv_handle_pool>(SRPH_ZERO_COPY_HANDLES, size);
+        if (_convert_pool) this->set_convert_threads(_convert_threads);
     }
 
     //! Get the channel width of this handler
@@ -110,9 +243,42 @@ public:
     //! Setup the vrt unpacker function and offset
     void set_vrt_unpacker(const vrt_unpacker_type &vrt_unpacker, const size_t header_offset_words32 = 0){
         _vrt_unpacker = vrt_unpacker;
+        _vrt_cached_unpacker = NULL;
         _header_offset_words32 = header_offset_words32;
     }
 
+    /*!
+     * Setup a cached VRT or CHDR unpacker that reuses the previous
+     * header of each channel when the next one has the same flags
+     * and length.
+     * Used instead of the plain vrt unpacker.
+     */
+    void set_vrt_unpacker(const vrt_cached_unpacker_type &vrt_unpacker, const size_t header_offset_words32 = 0){
+        _vrt_unpacker = NULL;
+        _vrt_cached_unpacker = vrt_unpacker;
+        _header_offset_words32 = header_offset_words32;
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            props.hdr_cache.reset();
+        }
+    }
+
+    /*!
+     * Accept data packets without a time stamp in a continuous stream.
+     *
+     * With this enabled, the device may send the time stamp only with the
+     * first packet of a burst and after a discontinuity. A packet without
+     * one gets the time of the previous packet of its channel plus that
+     * packet's samples. Lost packets (sequence errors) are counted as
+     * packets of the previous size. Channels that never send a time stamp
+     * are not affected.
+     */
+    void set_tsf_elision(const bool enable){
+        _tsf_elision = enable;
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            props.next_tsf_valid = false;
+        }
+    }
+
     ////////////////// RFNOC ///////////////////////////
     //! Set the stream ID for a specific channel (or no SID)
     void set_xport_chan_sid(const size_t xport_chan, const bool has_sid, const uint32_t sid = 0){
@@ -152,11 +318,32 @@ public:
     //! Set the rate of ticks per second
     void set_tick_rate(const double rate){
         _tick_rate = rate;
+        update_ticks_per_samp();
     }
 
     //! Set the rate of samples per second
     void set_samp_rate(const double rate){
+        _samp_rate_change_pending.write(0);
         _samp_rate = rate;
+        update_ticks_per_samp();
+    }
+
+    /*!
+     * Change the rate of samples per second and the scale factor while
+     * streaming, for a timed rate change of the device.
+     * The packets that start before the given time keep the old values,
+     * the first packet that starts at or after it gets the new ones.
+     * May be called from another thread than recv().
+     * \param time the command time of the rate change
+     * \param rate the new rate of samples per second
+     * \param scale_factor the new scale factor
+     */
+    void set_samp_rate(const time_spec_t &time, const double rate, const double scale_factor){
+        boost::mutex::scoped_lock lock(_samp_rate_change_mutex);
+        _samp_rate_change_time = time;
+        _next_samp_rate = rate;
+        _next_scale_factor = scale_factor;
+        _samp_rate_change_pending.write(1);
     }
 
     /*!
@@ -165,12 +352,30 @@ public:
      * \param get_buff the getter function
      */
     void set_xport_chan_get_buff(const size_t xport_chan, const get_buff_type &get_buff, const bool flush = false){
+        this->stop_recv_threads();
         if (flush){
             while (get_buff(0.0)) {};
         }
+        _props.at(xport_chan).xport.reset();
         _props.at(xport_chan).get_buff = get_buff;
     }
 
+    /*!
+     * Receive directly from a transport.
+     * Same as binding zero_copy_if::get_recv_buff with
+     * set_xport_chan_get_buff(), without the function object in between.
+     * \param xport_chan which transport channel
+     * \param xport the transport to receive from
+     */
+    void set_xport_chan(const size_t xport_chan, zero_copy_if::sptr xport, const bool flush = false){
+        this->stop_recv_threads();
+        if (flush){
+            while (xport->get_recv_buff(0.0)) {};
+        }
+        _props.at(xport_chan).get_buff = get_buff_type();
+        _props.at(xport_chan).xport = xport;
+    }
+
     /*!
      * Flush all transports in the streamer:
      * The packet payload is discarded.
@@ -188,21 +393,176 @@ public:
      */
     void set_xport_handle_flowctrl(const size_t xport_chan, const handle_flowctrl_type &handle_flowctrl, const size_t update_window, const bool do_init = false)
     {
+        _props.at(xport_chan).fc_handler.reset();
         _props.at(xport_chan).handle_flowctrl = handle_flowctrl;
         //we need the window size to be within the 0xfff (max 12 bit seq)
         _props.at(xport_chan).fc_update_window = std::min<size_t>(update_window, 0xfff);
         if (do_init) handle_flowctrl(0);
     }
 
+    /*!
+     * Set the handler object for flow control
+     * \param xport_chan which transport channel
+     * \param handler the handler, called like the callback function above
+     */
+    void set_xport_flowctrl_handler(const size_t xport_chan, flowctrl_handler::sptr handler, const size_t update_window, const bool do_init = false)
+    {
+        _props.at(xport_chan).handle_flowctrl = handle_flowctrl_type();
+        _props.at(xport_chan).fc_handler = handler;
+        _props.at(xport_chan).fc_update_window = std::min<size_t>(update_window, 0xfff);
+        if (do_init) handler->handle_flowctrl(0);
+    }
+
     //! Set the conversion routine for all channels
-    void set_converter(const uhd::convert::id_type &id){
+    void set_converter(const uhd::convert::id_type &id_){
+        //planar formats need one output buffer per plane
+        uhd::convert::id_type id = id_;
         _num_outputs = id.num_outputs;
-        _converter = uhd::convert::get_converter(id)();
+        _num_planes = uhd::convert::get_num_planes(id.output_format);
+        id.num_outputs *= _num_planes;
+        _converter_id = id;
+        _make_converter = this->get_converter_factory();
+        _converter = _make_converter();
+        this->update_converters();
         this->set_scale_factor(1/32767.); //update after setting converter
         _bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.input_format);
         _bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.output_format);
     }
 
+    /*!
+     * Convert the channels of this streamer on several threads.
+     * Each channel gets its own converter instance. Call after resize().
+     * \param num_threads total threads including the caller of recv(),
+     *        0 or 1 converts all channels on the calling thread
+     */
+    void set_convert_threads(const size_t num_threads){
+        _convert_threads = num_threads;
+        _convert_pool.reset();
+        if (num_threads > 1 and this->size() > 1 and _converter){
+            _convert_pool = boost::make_shared<convert_worker_pool>(
+                std::min(num_threads, this->size()) - 1, "rx convert worker", "rx");
+        }
+        this->update_converters();
+    }
+
+    /*!
+     * Receive the transports of each stream command group (see
+     * set_issue_stream_cmd()) on a thread of its own.
+     * The threads keep up to SRPH_RECV_THREAD_DEPTH packets per channel
+     * for recv(), which still checks, aligns and converts them. With the
+     * channels on several motherboards, the waits on their transports
+     * overlap instead of adding up on the thread calling recv().
+     * The threads start with the first packet recv() asks for, and stop
+     * when the transports change. A streamer with one group receives
+     * on the calling thread either way.
+     * \param enb true to receive on threads
+     */
+    void set_recv_threads(const bool enb){
+        this->stop_recv_threads();
+        _recv_threads = enb;
+        _recv_threads_pending = enb;
+    }
+
+    /*!
+     * Correct the DC offset and IQ imbalance of a channel in software.
+     * The correction is fused into the conversion, see
+     * uhd::convert::get_converter_with_correction(). Call after
+     * set_converter().
+     */
+    void set_correction(const size_t xport_chan, const uhd::convert::correction_t &correction){
+        if (_host_decim > 1){
+            throw uhd::value_error("a software correction cannot be combined with host_decim");
+        }
+        this->use_corrections();
+        _corrections.at(xport_chan) = correction;
+        this->update_converters();
+    }
+
+    /*!
+     * Return from every recv() call after one packet, as if it was called
+     * with one_packet set: the samples of a packet are delivered as soon
+     * as it arrives, instead of waiting to fill the buffer.
+     */
+    void set_one_packet(const bool enb){
+        _one_packet = enb;
+    }
+
+    /*!
+     * Report the power of the received samples in the recv() metadata,
+     * see uhd::rx_metadata_t::has_power. The power is measured in the
+     * conversion, by the converters with correction (see set_correction(),
+     * no correction by default). Call after set_converter() and resize().
+     */
+    void set_power_metadata(const bool enb){
+        if (enb and _host_decim > 1){
+            throw uhd::value_error("power metadata cannot be combined with host_decim");
+        }
+        _power_metadata = enb;
+        if (enb) this->use_corrections();
+        this->update_converters();
+    }
+
+    /*!
+     * Set the corrections given in stream args, if there are any: the
+     * keys dc_offset_i, dc_offset_q, iq_balance_mag and iq_balance_phase
+     * apply to all channels, each with a channel number appended (e.g.
+     * dc_offset_i1) to one channel of the stream.
+     */
+    void set_corrections(const uhd::device_addr_t &args){
+        static const char *keys[] = {"dc_offset_i", "dc_offset_q", "iq_balance_mag", "iq_balance_phase"};
+        for (size_t i = 0; i < this->size(); i++){
+            const std::string suffix = boost::lexical_cast<std::string>(i);
+            double values[4];
+            bool found = false;
+            for (size_t k = 0; k < 4; k++){
+                const std::string key = args.has_key(keys[k] + suffix)? keys[k] + suffix : keys[k];
+                found = found or args.has_key(key);
+                values[k] = args.cast<double>(key, 0.0);
+            }
+            if (not found) continue;
+            uhd::convert::correction_t correction;
+            correction.dc_offset = std::complex<double>(values[0], values[1]);
+            correction.set_iq_balance(std::complex<double>(values[2], values[3]));
+            this->set_correction(i, correction);
+        }
+    }
+
+    /*!
+     * Choose when the conversion writes with non-temporal stores, see
+     * uhd::convert::converter::set_nontemporal(): "auto" (the default)
+     * for recv() calls with at least SRPH_NONTEMPORAL_BYTES of buffers
+     * in all, "on" always, "off" never.
+     */
+    void set_nontemporal_stores(const std::string &mode){
+        if (mode == "auto") _nontemporal_mode = NONTEMPORAL_AUTO;
+        else if (mode == "on") _nontemporal_mode = NONTEMPORAL_ON;
+        else if (mode == "off") _nontemporal_mode = NONTEMPORAL_OFF;
+        else throw uhd::value_error("nontemporal_stores must be auto, on or off, not " + mode);
+        this->set_nontemporal(_nontemporal_mode == NONTEMPORAL_ON);
+    }
+
+    /*!
+     * Decimate the samples on the host, in the conversion: see
+     * uhd::convert::make_decimator(). recv() then returns one sample
+     * per `decim` samples from the device: the sample rate of the
+     * stream is that of the device divided by `decim`. Each sample is
+     * time stamped with the time of the newest device sample it was
+     * filtered from. Call after set_converter() and resize().
+     * \param decim the decimation, 1 to turn it off
+     */
+    void set_host_decim(const size_t decim){
+        if (decim == 0) throw uhd::value_error("host_decim must be at least 1");
+        if (decim > 1 and (_num_planes != 1 or not _corrections.empty())){
+            throw uhd::value_error("host_decim needs an interleaved cpu format, no software correction and no power metadata");
+        }
+        _host_decim = decim;
+        _decim_phase = 0;
+        _make_converter = this->get_converter_factory();
+        _converter = _make_converter();
+        _converter->set_scalar(_scale_factor);
+        this->update_converters();
+    }
+
     //! Set the transport channel's overflow handler
     void set_overflow_handler(const size_t xport_chan, const handle_overflow_type &handle_overflow){
         _props.at(xport_chan).handle_overflow = handle_overflow;
@@ -210,13 +570,42 @@ public:
 
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
+        _scale_factor = scale_factor;
         _converter->set_scalar(scale_factor);
+        BOOST_FOREACH(const uhd::convert::converter::sptr &converter, _converters){
+            converter->set_scalar(scale_factor);
+        }
     }
 
-    //! Set the callback to issue stream commands
-    void set_issue_stream_cmd(const size_t xport_chan, const issue_stream_cmd_type &issue_stream_cmd)
+    //! Make one converter per channel to convert in parallel, correct channels apart or decimate
+    void update_converters(void){
+        if (_converter) _converter->set_nontemporal(_nontemporal);
+        _converters.clear();
+        if (not _convert_pool and _corrections.empty() and _host_decim == 1) return;
+        for (size_t i = 0; i < this->size(); i++){
+            _converters.push_back(_make_converter());
+            _converters.back()->set_scalar(_scale_factor);
+            _converters.back()->set_nontemporal(_nontemporal);
+            if (i < _corrections.size()) _converters.back()->set_correction(_corrections[i]);
+            if (_power_metadata) _converters.back()->set_power_measurement(true);
+        }
+    }
+
+    /*!
+     * Set the callback to issue stream commands.
+     * The callbacks of channels in different groups are called in
+     * parallel, those of one group one after the other. Channels whose
+     * commands go over independent control paths (e.g. to different
+     * motherboards) belong in different groups.
+     * \param xport_chan the channel
+     * \param issue_stream_cmd the callback
+     * \param group the group of the channel
+     */
+    void set_issue_stream_cmd(const size_t xport_chan, const issue_stream_cmd_type &issue_stream_cmd, const size_t group = 0)
     {
+        if (_props.at(xport_chan).stream_cmd_group != group) this->stop_recv_threads();
         _props.at(xport_chan).issue_stream_cmd = issue_stream_cmd;
+        _props.at(xport_chan).stream_cmd_group = group;
     }
 
     //! Overload call to issue stream commands
@@ -229,10 +618,40 @@ public:
             //throw uhd::runtime_error("Attempting to do multi-channel receive with stream_now == true will result in misaligned channels. Aborting.");
         //}
 
+        const time_spec_t start = time_spec_t::get_system_time();
+        std::map<size_t, std::vector<size_t> > groups;
         for (size_t i = 0; i < _props.size(); i++)
         {
-            if (_props[i].issue_stream_cmd) _props[i].issue_stream_cmd(stream_cmd);
+            if (_props[i].issue_stream_cmd) groups[_props[i].stream_cmd_group].push_back(i);
         }
+
+        //one thread per group, so a timed start reaches all devices after
+        //the slowest control round trip rather than after the sum of them
+        if (groups.size() == 1) {
+            BOOST_FOREACH(const size_t i, groups.begin()->second) {
+                _props[i].issue_stream_cmd(stream_cmd);
+            }
+        } else if (groups.size() > 1) {
+            std::vector<std::string> errors(groups.size());
+            boost::thread_group threads;
+            size_t n = 0;
+            for (std::map<size_t, std::vector<size_t> >::const_iterator it = groups.begin(); it != groups.end(); ++it, ++n) {
+                threads.create_thread(boost::bind(
+                    &recv_packet_handler::issue_stream_cmd_group, this, boost::cref(it->second), boost::cref(stream_cmd), boost::ref(errors[n])
+                ));
+            }
+            threads.join_all();
+            BOOST_FOREACH(const std::string &error, errors) {
+                if (not error.empty()) throw uhd::runtime_error(error);
+            }
+        }
+        _stream_cmd_latency = (time_spec_t::get_system_time() - start).get_real_secs();
+    }
+
+    //! Get the seconds the last issue_stream_cmd() took, see rx_streamer::get_stream_cmd_latency()
+    double get_stream_cmd_latency(void) const
+    {
+        return _stream_cmd_latency;
     }
 
     /*******************************************************************
@@ -247,6 +666,17 @@ public:
         const double timeout,
         const bool one_packet
     ){
+        UHD_TRACE_SPAN("recv");
+        if (_num_planes > 1 and buffs.size() < this->size()*_num_outputs*_num_planes){
+            throw uhd::value_error("recv(): a planar format needs a buffer per plane (I and Q) of each channel");
+        }
+
+        //large buffers are read much later, keep them out of the caches
+        if (_nontemporal_mode == NONTEMPORAL_AUTO){
+            const bool nontemporal = nsamps_per_buff*_bytes_per_cpu_item*buffs.size() >= SRPH_NONTEMPORAL_BYTES;
+            if (nontemporal != _nontemporal) this->set_nontemporal(nontemporal);
+        }
+
         //handle metadata queued from a previous receive
         if (_queue_error_for_next_call){
             _queue_error_for_next_call = false;
@@ -260,15 +690,17 @@ public:
             buffs, nsamps_per_buff, metadata, timeout
         );
 
-        if (one_packet or metadata.end_of_burst){
+        if (one_packet or _one_packet or metadata.end_of_burst){
 #ifdef UHD_TXRX_DEBUG_PRINTS
             dbg_gather_data(nsamps_per_buff, accum_num_samps, metadata, timeout, one_packet);
 #endif
+            if (_power_metadata) this->get_power_metadata(metadata);
             return accum_num_samps;
         }
 
         //first recv had an error code set, return immediately
         if (metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+            if (_power_metadata) this->get_power_metadata(metadata);
             return accum_num_samps;
         }
 
@@ -295,28 +727,179 @@ public:
 #ifdef UHD_TXRX_DEBUG_PRINTS
         dbg_gather_data(nsamps_per_buff, accum_num_samps, metadata, timeout, one_packet);
 #endif
+        if (_power_metadata) this->get_power_metadata(metadata);
         return accum_num_samps;
     }
 
+    /*******************************************************************
+     * Receive a batch:
+     * Fill the buffers like recv() does, and keep the metadata of each
+     * packet. Overflows mark the next packet instead of ending the batch.
+     ******************************************************************/
+    UHD_INLINE size_t recv_batch(
+        const uhd::rx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        std::vector<uhd::rx_streamer::packet_info_t> &packets,
+        const size_t max_packets,
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        UHD_TRACE_SPAN("recv_batch");
+        if (_num_planes > 1 and buffs.size() < this->size()*_num_outputs*_num_planes){
+            throw uhd::value_error("recv_batch(): a planar format needs a buffer per plane (I and Q) of each channel");
+        }
+        if (_nontemporal_mode == NONTEMPORAL_AUTO){
+            const bool nontemporal = nsamps_per_buff*_bytes_per_cpu_item*buffs.size() >= SRPH_NONTEMPORAL_BYTES;
+            if (nontemporal != _nontemporal) this->set_nontemporal(nontemporal);
+        }
+        packets.clear();
+
+        //handle metadata queued from a previous receive
+        if (_queue_error_for_next_call){
+            _queue_error_for_next_call = false;
+            metadata = _queue_metadata;
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return 0;
+        }
+
+        size_t accum_num_samps = 0;
+        bool gap = false;
+        rx_metadata_t gap_metadata;
+        while (accum_num_samps < nsamps_per_buff and packets.size() < max_packets){
+            //the first packet describes the batch, the others go to the queue
+            rx_metadata_t &packet_metadata = packets.empty()? metadata : _queue_metadata;
+            const size_t num_samps = recv_one_packet(
+                buffs, nsamps_per_buff - accum_num_samps, packet_metadata,
+                timeout, accum_num_samps*_bytes_per_cpu_item
+            );
+
+            if (packet_metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW){
+                gap = true;
+                gap_metadata = packet_metadata;
+                continue;
+            }
+            if (packet_metadata.error_code != rx_metadata_t::ERROR_CODE_NONE){
+                _queue_error_for_next_call = not packets.empty();
+                break;
+            }
+
+            uhd::rx_streamer::packet_info_t info;
+            info.offset = accum_num_samps;
+            info.nsamps = num_samps;
+            info.has_time_spec = packet_metadata.has_time_spec;
+            info.time_spec = packet_metadata.time_spec;
+            info.start_of_burst = packet_metadata.start_of_burst;
+            info.end_of_burst = packet_metadata.end_of_burst;
+            info.gap_before = gap;
+            packets.push_back(info);
+            gap = false;
+
+            accum_num_samps += num_samps;
+            metadata.more_fragments = packet_metadata.more_fragments;
+            if (packet_metadata.end_of_burst) break;
+        }
+
+        //an overflow after the last packet is reported like an error
+        if (gap){
+            if (packets.empty()) metadata = gap_metadata;
+            else if (not _queue_error_for_next_call){
+                _queue_metadata = gap_metadata;
+                _queue_error_for_next_call = true;
+            }
+        }
+        if (_power_metadata) this->get_power_metadata(metadata);
+        return accum_num_samps;
+    }
+
+    /*******************************************************************
+     * Receive without conversion:
+     * Hand the current packet of every channel to the caller, together
+     * with the transport buffers that hold it.
+     ******************************************************************/
+    UHD_INLINE size_t recv_zero_copy(
+        uhd::rx_streamer::zero_copy_buffs_t &zc_buffs,
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        zc_buffs.release();
+
+        //handle metadata queued from a previous receive
+        if (_queue_error_for_next_call){
+            _queue_error_for_next_call = false;
+            metadata = _queue_metadata;
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return 0;
+        }
+
+        //get the next buffer if the current one has expired
+        if (get_curr_buffer_info().data_bytes_to_copy == 0)
+        {
+            //perform receive with alignment logic
+            get_aligned_buffs(timeout);
+        }
+
+        buffers_info_type &info = get_curr_buffer_info();
+        make_rx_metadata(info.metadata, info.fragment_offset_in_samps, metadata);
+        metadata.fragment_offset = info.fragment_offset_in_samps;
+        if (info.data_bytes_to_copy == 0) return 0; //error or timeout
+
+        //move the buffers into the handle, they are released with it
+        boost::shared_ptr<recv_handle_pool::buffs_type> handle = _zero_copy_handles->make();
+        zc_buffs.buffs.resize(this->size());
+        for (size_t i = 0; i < this->size(); i++) {
+            zc_buffs.buffs[i] = info[i].copy_buff;
+            (*handle)[i].swap(info[i].buff);
+        }
+        zc_buffs.handle = handle;
+        zc_buffs.nsamps = info.data_bytes_to_copy/_bytes_per_otw_item;
+        zc_buffs.item_format = _converter_id.input_format;
+
+        //the packet is used up as far as this handler is concerned
+        info.data_bytes_to_copy = 0;
+        info.fragment_offset_in_samps += zc_buffs.nsamps;
+
+        return zc_buffs.nsamps;
+    }
+
 private:
     vrt_unpacker_type _vrt_unpacker;
+    vrt_cached_unpacker_type _vrt_cached_unpacker; //used instead of _vrt_unpacker when set
+    bool _tsf_elision; //restore the time stamps the device left out
     size_t _header_offset_words32;
     double _tick_rate, _samp_rate;
+    long long _ticks_per_samp; //when the sample rate divides the tick rate, else 0
+    uhd::atomic_uint32_t _samp_rate_change_pending; //a timed rate change waits for its packet
+    boost::mutex _samp_rate_change_mutex;
+    time_spec_t _samp_rate_change_time;
+    double _next_samp_rate, _next_scale_factor;
     bool _queue_error_for_next_call;
     size_t _alignment_failure_threshold;
     rx_metadata_t _queue_metadata;
+    bool _gap_pending; //samples were lost, measure the gap on the next data
+    bool _next_time_valid;
+    tick_time_t _next_time; //the time just after the last data returned
     struct xport_chan_props_type{
         xport_chan_props_type(void):
             packet_count(0),
             handle_overflow(&handle_overflow_nop),
-            fc_update_window(0)
+            fc_update_window(0),
+            next_tsf_valid(false),
+            next_tsf(0),
+            last_nsamps(0),
+            stream_cmd_group(0)
         {}
         get_buff_type get_buff;
+        zero_copy_if::sptr xport; //used instead of get_buff when set
         issue_stream_cmd_type issue_stream_cmd;
         size_t packet_count;
         handle_overflow_type handle_overflow;
         handle_flowctrl_type handle_flowctrl;
+        flowctrl_handler::sptr fc_handler; //used instead of handle_flowctrl when set
         size_t fc_update_window;
+        vrt::if_hdr_cache_t hdr_cache; //for _vrt_cached_unpacker
+        bool next_tsf_valid; //for _tsf_elision: next_tsf is the time of the next packet
+        uint64_t next_tsf;
+        size_t last_nsamps; //samples of the last data packet
+        size_t stream_cmd_group; //see set_issue_stream_cmd()
+        boost::shared_ptr<bounded_buffer<managed_recv_buffer::sptr> > recv_queue; //filled by a receive thread
 	/////// RFNOC ///////////
         bool has_sid;
         uint32_t sid;
@@ -324,9 +907,78 @@ private:
     };
     std::vector<xport_chan_props_type> _props;
     size_t _num_outputs;
+    size_t _num_planes; //output buffers per output, 2 for planar formats
     size_t _bytes_per_otw_item; //used in conversion
     size_t _bytes_per_cpu_item; //used in conversion
     uhd::convert::converter::sptr _converter; //used in conversion
+    uhd::convert::id_type _converter_id;
+    uhd::convert::function_type _make_converter;
+    double _scale_factor;
+    //! One converter per channel when converting on the worker pool or correcting
+    std::vector<uhd::convert::converter::sptr> _converters;
+    std::vector<uhd::convert::correction_t> _corrections;
+    size_t _host_decim;
+    size_t _decim_phase; //device samples since the last decimated one
+    bool _power_metadata; //report the power measured by the converters
+    bool _one_packet; //every recv() returns after one packet
+    size_t _convert_threads;
+    convert_worker_pool::sptr _convert_pool;
+    //! The channels a receive thread serves, see set_recv_threads()
+    struct recv_group_type{
+        recv_group_type(void): next(0), failed(false){}
+        std::vector<size_t> chans;
+        std::vector<managed_recv_buffer::sptr> pending; //received, but the queue was full
+        size_t next; //the channel to wait on when all were idle
+        bool failed;
+    };
+    bool _recv_threads;
+    bool _recv_threads_pending; //start the threads with the next packet
+    std::vector<recv_group_type> _recv_groups;
+    std::vector<task::sptr> _recv_tasks;
+    uhd::atomic_uint32_t _recv_failed;
+    boost::mutex _recv_error_mutex;
+    std::string _recv_error;
+    recv_handle_pool::sptr _zero_copy_handles; //for recv_zero_copy()
+    enum {NONTEMPORAL_AUTO, NONTEMPORAL_ON, NONTEMPORAL_OFF} _nontemporal_mode;
+    bool _nontemporal; //the converters write with non-temporal stores
+
+    //! The factory for the converters of the conversion, correction and decimation set
+    //! Switch to the converters with correction, with none to start with
+    void use_corrections(void){
+        if (not _corrections.empty()) return;
+        _corrections.resize(this->size());
+        _make_converter = this->get_converter_factory();
+        _converter = _make_converter();
+        _converter->set_scalar(_scale_factor);
+    }
+
+    //! Collect the power measured by the converters since the last call
+    void get_power_metadata(uhd::rx_metadata_t &metadata){
+        metadata.has_power = true;
+        metadata.peak_power = metadata.mean_power = 0.0;
+        BOOST_FOREACH(const uhd::convert::converter::sptr &converter, _converters){
+            double peak, mean;
+            converter->get_power(peak, mean);
+            metadata.peak_power = std::max(metadata.peak_power, peak);
+            metadata.mean_power += mean/_converters.size();
+        }
+    }
+
+    uhd::convert::function_type get_converter_factory(void) const{
+        if (_host_decim > 1) return boost::bind(
+            &uhd::convert::make_decimator, _converter_id, _host_decim, std::vector<float>());
+        if (not _corrections.empty()) return uhd::convert::get_converter_with_correction(_converter_id);
+        return uhd::convert::get_converter(_converter_id);
+    }
+
+    //! Switch the non-temporal stores of all converters
+    void set_nontemporal(const bool nontemporal){
+        _nontemporal = nontemporal;
+        if (_converter) _converter->set_nontemporal(nontemporal);
+        BOOST_FOREACH(const uhd::convert::converter::sptr &converter, _converters){
+            converter->set_nontemporal(nontemporal);
+        }
+    }
 
     //! information stored for a received buffer
     struct per_buffer_info_type{
@@ -334,47 +986,93 @@ private:
         {
             buff.reset();
             vrt_hdr = NULL;
-            time = time_spec_t(0.0);
+            ifpi.tsf = 0;
             copy_buff = NULL;
         }
         managed_recv_buffer::sptr buff;
         const uint32_t *vrt_hdr;
-        vrt::if_packet_info_t ifpi;
-        time_spec_t time;
+        vrt::if_packet_info_t ifpi; //ifpi.tsf is the packet time in ticks
         const char *copy_buff;
     };
 
+    /*!
+     * Compact description of a set of aligned packets: the time stays in
+     * ticks, and the public rx_metadata_t is only made when recv() returns
+     * (see make_rx_metadata()). Small enough to copy and reset cheaply.
+     */
+    struct packet_metadata_t{
+        packet_metadata_t(void){reset();}
+        void reset(void)
+        {
+            tsf = 0;
+            offset_samps = 0;
+            num_lost_samps = 0;
+            error_code = rx_metadata_t::ERROR_CODE_NONE;
+            has_tsf = sob = eob = out_of_sequence = false;
+        }
+        uint64_t tsf; //the packet time in ticks
+        size_t offset_samps; //the first sample is this many samples after tsf
+        size_t num_lost_samps;
+        rx_metadata_t::error_code_t error_code;
+        bool has_tsf, sob, eob, out_of_sequence;
+    };
+
     //!information stored for a set of aligned buffers
     struct buffers_info_type : std::vector<per_buffer_info_type> {
         buffers_info_type(const size_t size):
             std::vector<per_buffer_info_type>(size),
-            indexes_todo(size, true),
+            alignment_tsf(0),
             alignment_time_valid(false),
             data_bytes_to_copy(0),
             fragment_offset_in_samps(0)
-        {/* NOP */}
+        {
+            indexes_todo.set_first(size);
+        }
+        //! Clear everything, including the packet info of every channel
         void reset()
         {
-            indexes_todo.set();
-            alignment_time = time_spec_t(0.0);
+            recycle();
+            for (size_t i = 0; i < size(); i++)
+                at(i).reset();
+        }
+        //! Make ready for reuse in the rotation: release the buffers and
+        //! clear the alignment state. The packet info of each channel is
+        //! overwritten by the next receive, so it is left alone.
+        void recycle()
+        {
+            indexes_todo.set_first(size());
+            alignment_tsf = 0;
             alignment_time_valid = false;
             data_bytes_to_copy = 0;
             fragment_offset_in_samps = 0;
             metadata.reset();
             for (size_t i = 0; i < size(); i++)
-                at(i).reset();
+                (*this)[i].buff.reset();
         }
-        boost::dynamic_bitset<> indexes_todo; //used in alignment logic
-        time_spec_t alignment_time; //used in alignment logic
+        channel_mask_t indexes_todo; //used in alignment logic
+        uint64_t alignment_tsf; //used in alignment logic, in ticks
         bool alignment_time_valid; //used in alignment logic
         size_t data_bytes_to_copy; //keeps track of state
         size_t fragment_offset_in_samps; //keeps track of state
-        rx_metadata_t metadata; //packet description
+        packet_metadata_t metadata; //packet description
     };
 
     //! a circular queue of buffer infos
     std::vector<buffers_info_type> _buffers_infos;
     size_t _buffers_infos_index;
+    double _stream_cmd_latency;
+
+    //! Issue a stream command to the channels of one group, on a thread of its own
+    void issue_stream_cmd_group(const std::vector<size_t> &chans, const stream_cmd_t &stream_cmd, std::string &error)
+    {
+        try {
+            BOOST_FOREACH(const size_t i, chans) {
+                _props[i].issue_stream_cmd(stream_cmd);
+            }
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+    }
     buffers_info_type &get_curr_buffer_info(void){return _buffers_infos[_buffers_infos_index];}
     buffers_info_type &get_prev_buffer_info(void){return _buffers_infos[(_buffers_infos_index + 3)%4];}
     buffers_info_type &get_next_buffer_info(void){return _buffers_infos[(_buffers_infos_index + 1)%4];}
@@ -395,6 +1093,138 @@ private:
 
     uhd::rfnoc::rx_stream_terminator::sptr _terminator;
 
+    //! Get a buffer from the transport of this channel
+    UHD_INLINE managed_recv_buffer::sptr get_xport_buff(const size_t index, const double timeout){
+        UHD_TRACE_SPAN("get_recv_buff");
+        if (_recv_threads_pending) this->start_recv_threads();
+        xport_chan_props_type &props = _props[index];
+        if (props.recv_queue) return this->get_queued_buff(props, timeout);
+        if (props.xport) return props.xport->get_recv_buff(timeout);
+        return props.get_buff(timeout);
+    }
+
+    /*******************************************************************
+     * Receive threads, see set_recv_threads()
+     ******************************************************************/
+    void start_recv_threads(void){
+        _recv_threads_pending = false;
+        std::map<size_t, std::vector<size_t> > groups;
+        for (size_t i = 0; i < _props.size(); i++){
+            groups[_props[i].stream_cmd_group].push_back(i);
+        }
+        if (groups.size() < 2) return; //nothing to overlap
+
+        _recv_failed.write(0);
+        _recv_groups.resize(groups.size());
+        size_t n = 0;
+        for (std::map<size_t, std::vector<size_t> >::const_iterator it = groups.begin(); it != groups.end(); ++it, ++n){
+            _recv_groups[n].chans = it->second;
+            _recv_groups[n].pending.resize(it->second.size());
+            BOOST_FOREACH(const size_t i, it->second){
+                _props[i].recv_queue = boost::make_shared<bounded_buffer<managed_recv_buffer::sptr> >(SRPH_RECV_THREAD_DEPTH);
+            }
+        }
+        BOOST_FOREACH(recv_group_type &group, _recv_groups){
+            _recv_tasks.push_back(task::make(
+                boost::bind(&recv_packet_handler::receiver_loop, this, boost::ref(group)), "rx", "rx receiver"));
+        }
+    }
+
+    //! Stop the receive threads, the packets they held are dropped
+    void stop_recv_threads(void){
+        _recv_tasks.clear();
+        _recv_groups.clear();
+        _recv_threads_pending = _recv_threads;
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            props.recv_queue.reset();
+        }
+    }
+
+    //! One round of a receive thread: move packets from its transports to the queues
+    void receiver_loop(recv_group_type &group){
+        if (group.failed){
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+            return;
+        }
+        try{
+            bool moved = false;
+            for (size_t n = 0; n < group.chans.size(); n++){
+                xport_chan_props_type &props = _props[group.chans[n]];
+                managed_recv_buffer::sptr &buff = group.pending[n];
+                if (not buff) buff = props.xport? props.xport->get_recv_buff(0.0) : props.get_buff(0.0);
+                if (buff and props.recv_queue->push_with_haste(buff)){
+                    buff.reset();
+                    moved = true;
+                }
+            }
+            if (moved) return;
+
+            //all idle: wait a little for a packet, or for room in a queue
+            const size_t n = group.next++ % group.chans.size();
+            xport_chan_props_type &props = _props[group.chans[n]];
+            managed_recv_buffer::sptr &buff = group.pending[n];
+            if (buff){
+                if (props.recv_queue->push_with_timed_wait(buff, SRPH_RECV_THREAD_WAIT)) buff.reset();
+            }
+            else buff = props.xport? props.xport->get_recv_buff(SRPH_RECV_THREAD_WAIT) : props.get_buff(SRPH_RECV_THREAD_WAIT);
+        }
+        catch(const boost::thread_interrupted &){
+            throw;
+        }
+        catch(const std::exception &e){
+            //recv() throws it once the queues ran dry
+            group.failed = true;
+            boost::mutex::scoped_lock lock(_recv_error_mutex);
+            _recv_error = e.what();
+            _recv_failed.write(1);
+        }
+    }
+
+    //! Get a packet a receive thread received for this channel
+    managed_recv_buffer::sptr get_queued_buff(xport_chan_props_type &props, const double timeout){
+        static const double poll_secs = 0.01; //to notice a failed thread
+        managed_recv_buffer::sptr buff;
+        double remaining = timeout;
+        while (true){
+            if (props.recv_queue->pop_with_haste(buff)) return buff;
+            if (_recv_failed.read()){
+                boost::mutex::scoped_lock lock(_recv_error_mutex);
+                throw uhd::io_error(_recv_error);
+            }
+            if (remaining <= 0.0) return buff;
+            const double wait = std::min(remaining, poll_secs);
+            if (props.recv_queue->pop_with_timed_wait(buff, wait)) return buff;
+            remaining -= wait;
+        }
+    }
+
+    //! Does this channel do flow control?
+    UHD_INLINE bool has_flowctrl(const size_t index) const{
+        return _props[index].fc_handler or _props[index].handle_flowctrl;
+    }
+
+    //! Record an error of this channel, after the packet that showed it
+    UHD_INLINE void record_error(
+        const size_t index,
+        const vrt::if_packet_info_t &ifpi,
+        const rx_metadata_t::error_code_t error_code
+    ){
+        flight_recorder::record(flight_recorder::RECORD_ERROR, index,
+            ifpi.has_sid? ifpi.sid : _props[index].sid,
+            uint32_t(ifpi.packet_count), ifpi.tsf, uint32_t(error_code),
+            ifpi.has_tsf? flight_recorder::FLAG_HAS_TSF : 0);
+    }
+
+    //! Send a flow control update for this channel
+    UHD_INLINE void do_flowctrl(const size_t index, const size_t last_seq){
+        UHD_TRACE_SPAN("rx_flowctrl");
+        xport_chan_props_type &props = _props[index];
+        flight_recorder::record(flight_recorder::RECORD_FLOW_CTRL, index,
+            props.sid, uint32_t(last_seq), 0, 0);
+        if (props.fc_handler) props.fc_handler->handle_flowctrl(last_seq);
+        else props.handle_flowctrl(last_seq);
+    }
+
     /*******************************************************************
      * Get and process a single packet from the transport:
      * Receive a single packet at the given index.
@@ -409,7 +1239,7 @@ private:
     ){
         //get a single packet from the transport layer
         managed_recv_buffer::sptr &buff = curr_buffer_info.buff;
-        buff = _props[index].get_buff(timeout);
+        buff = get_xport_buff(index, timeout);
         if (buff.get() == NULL) return PACKET_TIMEOUT_ERROR;
 
         #ifdef  ERROR_INJECT_DROPPED_PACKETS
@@ -417,7 +1247,7 @@ private:
         {
             recvd_packets = 0;
             buff.reset();
-            buff = _props[index].get_buff(timeout);
+            buff = get_xport_buff(index, timeout);
             if (buff.get() == NULL) return PACKET_TIMEOUT_ERROR;
         }
         #endif
@@ -432,16 +1262,23 @@ private:
         per_buffer_info_type &info = curr_buffer_info;
         info.ifpi.num_packet_words32 = num_packet_words32 - _header_offset_words32;
         info.vrt_hdr = buff->cast<const uint32_t *>() + _header_offset_words32;
-        _vrt_unpacker(info.vrt_hdr, info.ifpi);
-        info.time = time_spec_t::from_ticks(info.ifpi.tsf, _tick_rate); //assumes has_tsf is true
+        if (_vrt_cached_unpacker) _vrt_cached_unpacker(info.vrt_hdr, info.ifpi, _props[index].hdr_cache);
+        else _vrt_unpacker(info.vrt_hdr, info.ifpi);
         info.copy_buff = reinterpret_cast<const char *>(info.vrt_hdr + info.ifpi.num_header_words32);
+        flight_recorder::record(flight_recorder::RECORD_RX_PACKET, index,
+            info.ifpi.has_sid? info.ifpi.sid : _props[index].sid,
+            uint32_t(info.ifpi.packet_count), info.ifpi.tsf,
+            uint32_t(info.ifpi.num_packet_words32*sizeof(uint32_t)),
+            (info.ifpi.has_tsf? flight_recorder::FLAG_HAS_TSF : 0)
+            | (info.ifpi.sob? flight_recorder::FLAG_SOB : 0)
+            | (info.ifpi.eob? flight_recorder::FLAG_EOB : 0));
 
         //handle flow control
-        if (_props[index].handle_flowctrl)
+        if (has_flowctrl(index))
         {
             if ((info.ifpi.packet_count % _props[index].fc_update_window) == 0)
             {
-                _props[index].handle_flowctrl(info.ifpi.packet_count);
+                do_flowctrl(index, info.ifpi.packet_count);
             }
         }
 
@@ -460,20 +1297,25 @@ private:
         const size_t seq_mask = (info.ifpi.link_type == vrt::if_packet_info_t::LINK_TYPE_NONE)? 0xf : 0xfff;
         const size_t expected_packet_count = _props[index].packet_count;
         _props[index].packet_count = (info.ifpi.packet_count + 1) & seq_mask;
+        if (_tsf_elision or _samp_rate_change_pending.read()){
+            update_packet_time(index, info.ifpi, (info.ifpi.packet_count - expected_packet_count) & seq_mask);
+        }
         if (expected_packet_count != info.ifpi.packet_count){
             //UHD_MSG(status) << "expected: " << expected_packet_count << " got: " << info.ifpi.packet_count << std::endl;
-            if (_props[index].handle_flowctrl) {
+            if (has_flowctrl(index)) {
                 // Always update flow control in this case, because we don't
                 // know which packet was dropped and what state the upstream
                 // flow control is in.
-                _props[index].handle_flowctrl(info.ifpi.packet_count);
+                do_flowctrl(index, info.ifpi.packet_count);
             }
             return PACKET_SEQUENCE_ERROR;
         }
+        #else
+        if (_tsf_elision or _samp_rate_change_pending.read()) update_packet_time(index, info.ifpi, 0);
         #endif
 
         //3) check for out of order timestamps
-        if (info.ifpi.has_tsf and prev_buffer_info.time > info.time){
+        if (info.ifpi.has_tsf and prev_buffer_info.ifpi.tsf > info.ifpi.tsf){
             return PACKET_TIMESTAMP_ERROR;
         }
 
@@ -481,6 +1323,34 @@ private:
         return PACKET_IF_DATA;
     }
 
+    /*!
+     * Fill in the time stamp of a packet the device sent without one (see
+     * set_tsf_elision()), then apply a timed rate change that starts with
+     * this packet. The time of the next packet comes from the samples of
+     * this one, at the rate they have.
+     */
+    UHD_INLINE void update_packet_time(const size_t index, vrt::if_packet_info_t &ifpi, const size_t num_lost_packets){
+        xport_chan_props_type &props = _props[index];
+        if (_tsf_elision and not ifpi.has_tsf and props.next_tsf_valid){
+            ifpi.has_tsf = true;
+            ifpi.tsf = props.next_tsf + samps_to_ticks(num_lost_packets*props.last_nsamps);
+        }
+        if (_samp_rate_change_pending.read() and ifpi.has_tsf){
+            boost::mutex::scoped_lock lock(_samp_rate_change_mutex);
+            if (_samp_rate_change_pending.read() and
+                tick_time_t(ifpi.tsf, _tick_rate) >= tick_time_t::from_time_spec(_samp_rate_change_time, _tick_rate)){
+                _samp_rate_change_pending.write(0);
+                _samp_rate = _next_samp_rate;
+                update_ticks_per_samp();
+                set_scale_factor(_next_scale_factor);
+            }
+        }
+        if (not _tsf_elision) return;
+        props.last_nsamps = ifpi.num_payload_bytes/_bytes_per_otw_item;
+        props.next_tsf_valid = ifpi.has_tsf and not ifpi.eob;
+        props.next_tsf = ifpi.tsf + samps_to_ticks(props.last_nsamps);
+    }
+
     void _flush_all(double timeout)
     {
         get_prev_buffer_info().reset();
@@ -509,6 +1379,74 @@ private:
         }
     }
 
+    /*******************************************************************
+     * Tick math:
+     * Time stamps are kept in ticks, which is exact and cheap, and
+     * converted to a time_spec_t once per packet for the metadata.
+     ******************************************************************/
+    void update_ticks_per_samp(void){
+        const double ratio = _tick_rate/_samp_rate;
+        const long long ratio_i = (long long)(ratio + 0.5);
+        _ticks_per_samp = (ratio_i > 0 and std::abs(ratio - ratio_i) < 1e-9*ratio)? ratio_i : 0;
+    }
+
+    //! exact when the sample rate divides the tick rate, else the nearest tick
+    UHD_INLINE long long samps_to_ticks(const size_t nsamps) const{
+        if (_ticks_per_samp != 0) return (long long)(nsamps)*_ticks_per_samp;
+        return (long long)(nsamps*_tick_rate/_samp_rate + 0.5);
+    }
+
+    UHD_INLINE long long ticks_to_samps(const long long ticks) const{
+        if (_ticks_per_samp != 0) return ticks/_ticks_per_samp;
+        return (long long)(std::floor(ticks*_samp_rate/_tick_rate + 0.5));
+    }
+
+    //! the time of the sample nsamps after the first one of the packets
+    UHD_INLINE void get_packet_time(
+        const packet_metadata_t &packet, const size_t nsamps,
+        tick_time_t &tick_time, time_spec_t &time_spec
+    ) const{
+        const size_t offset = packet.offset_samps + nsamps;
+        tick_time = tick_time_t(packet.tsf, _tick_rate);
+        if (offset == 0 or _ticks_per_samp != 0){
+            tick_time += (long long)(offset)*_ticks_per_samp;
+            time_spec = tick_time.to_time_spec();
+        }
+        else{
+            //the samples fall in between ticks
+            time_spec = tick_time.to_time_spec() + time_spec_t::from_ticks(offset, _samp_rate);
+            tick_time = tick_time_t::from_time_spec(time_spec, _tick_rate);
+        }
+    }
+
+    UHD_INLINE time_spec_t get_packet_time_spec(const packet_metadata_t &packet) const{
+        tick_time_t tick_time;
+        time_spec_t time_spec;
+        get_packet_time(packet, 0, tick_time, time_spec);
+        return time_spec;
+    }
+
+    /*!
+     * Fill in the public metadata from the compact one, for the sample
+     * nsamps after the first one of the packets. This is done once per
+     * recv() call that returns, so the time is converted once.
+     */
+    UHD_INLINE void make_rx_metadata(
+        const packet_metadata_t &packet, const size_t nsamps, rx_metadata_t &metadata
+    ) const{
+        metadata.has_time_spec = packet.has_tsf;
+        get_packet_time(packet, nsamps, metadata.tick_time, metadata.time_spec);
+        metadata.more_fragments = false;
+        metadata.fragment_offset = 0;
+        metadata.start_of_burst = packet.sob;
+        metadata.end_of_burst = packet.eob;
+        metadata.error_code = packet.error_code;
+        metadata.out_of_sequence = packet.out_of_sequence;
+        metadata.num_lost_samps = packet.num_lost_samps;
+        metadata.has_power = false;
+        metadata.peak_power = metadata.mean_power = 0.0;
+    }
+
     /*******************************************************************
      * Alignment check:
      * Check the received packet for alignment and mark accordingly.
@@ -516,26 +1454,36 @@ private:
     UHD_INLINE void alignment_check(
         const size_t index, buffers_info_type &info
     ){
+        //a single channel is always aligned with itself
+        if (_props.size() == 1){
+            info.alignment_time_valid = true;
+            info.alignment_tsf = info[0].ifpi.tsf;
+            info.indexes_todo.reset(0);
+            info.data_bytes_to_copy = info[0].ifpi.num_payload_bytes;
+            return;
+        }
+
+        //Timestamps are compared as raw tick counts (assumes has_tsf is true).
         //if alignment time was not valid or if the sequence id is newer:
         //  use this index's time as the alignment time
         //  reset the indexes list and remove this index
-        if (not info.alignment_time_valid or info[index].time > info.alignment_time){
+        if (not info.alignment_time_valid or info[index].ifpi.tsf > info.alignment_tsf){
             info.alignment_time_valid = true;
-            info.alignment_time = info[index].time;
-            info.indexes_todo.set();
+            info.alignment_tsf = info[index].ifpi.tsf;
+            info.indexes_todo.set_first(info.size());
             info.indexes_todo.reset(index);
             info.data_bytes_to_copy = info[index].ifpi.num_payload_bytes;
         }
 
         //if the sequence id matches:
         //  remove this index from the list and continue
-        else if (info[index].time == info.alignment_time){
+        else if (info[index].ifpi.tsf == info.alignment_tsf){
             info.indexes_todo.reset(index);
         }
 
         //if the sequence id is older:
         //  continue with the same index to try again
-        //else if (info[index].time < info.alignment_time)...
+        //else if (info[index].ifpi.tsf < info.alignment_tsf)...
     }
 
     /*******************************************************************
@@ -546,7 +1494,7 @@ private:
      ******************************************************************/
     UHD_INLINE void get_aligned_buffs(double timeout){
 
-        get_prev_buffer_info().reset(); // no longer need the previous info - reset it for future use
+        get_prev_buffer_info().recycle(); // no longer need the previous info - recycle it for future use
 
         increment_buffer_info(); //increment to next buffer
 
@@ -592,7 +1540,7 @@ private:
                 //we can receive a packet that comes before the previous packet in time.
                 //This could cause the alignment logic to discard future received packets.
                 //Therefore, when this occurs, we reset the info to restart from scratch.
-                if (curr_info.alignment_time_valid and curr_info.alignment_time != curr_info[index].time){
+                if (curr_info.alignment_time_valid and curr_info.alignment_tsf != curr_info[index].ifpi.tsf){
                     curr_info.alignment_time_valid = false;
                 }
                 alignment_check(index, curr_info);
@@ -600,21 +1548,25 @@ private:
 
             case PACKET_INLINE_MESSAGE:
                 std::swap(curr_info, next_info); //save progress from curr -> next
-                curr_info.metadata.has_time_spec = next_info[index].ifpi.has_tsf;
-                curr_info.metadata.time_spec = next_info[index].time;
+                curr_info.metadata.has_tsf = next_info[index].ifpi.has_tsf;
+                curr_info.metadata.tsf = next_info[index].ifpi.tsf;
+                curr_info.metadata.offset_samps = 0;
                 curr_info.metadata.error_code = rx_metadata_t::error_code_t(get_context_code(next_info[index].vrt_hdr, next_info[index].ifpi));
                 if (curr_info.metadata.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW){
                     // Not sending flow control would cause timeouts due to source flow control locking up.
                     // Send first as the overrun handler may flush the receive buffers which could contain
                     // packets with sequence numbers after this packet's sequence number!
-                    if(_props[index].handle_flowctrl) {
-                        _props[index].handle_flowctrl(next_info[index].ifpi.packet_count);
+                    if(has_flowctrl(index)) {
+                        do_flowctrl(index, next_info[index].ifpi.packet_count);
                     }
 
-                    rx_metadata_t metadata = curr_info.metadata;
+                    const packet_metadata_t metadata = curr_info.metadata;
                     _props[index].handle_overflow();
                     curr_info.metadata = metadata;
-                    UHD_MSG(fastpath) << "O";
+                    _gap_pending = true;
+                    fastpath::post_event(fastpath::EVENT_OVERFLOW, index,
+                        metadata.has_tsf, get_packet_time_spec(metadata));
+                    record_error(index, next_info[index].ifpi, metadata.error_code);
                 }
                 curr_info[index].buff.reset();
                 curr_info[index].copy_buff = NULL;
@@ -622,8 +1574,8 @@ private:
 
             case PACKET_TIMEOUT_ERROR:
                 std::swap(curr_info, next_info); //save progress from curr -> next
-                if(_props[index].handle_flowctrl) {
-                    _props[index].handle_flowctrl(next_info[index].ifpi.packet_count);
+                if(has_flowctrl(index)) {
+                    do_flowctrl(index, next_info[index].ifpi.packet_count);
                 }
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
                 return;
@@ -631,12 +1583,16 @@ private:
             case PACKET_SEQUENCE_ERROR:
                 alignment_check(index, curr_info);
                 std::swap(curr_info, next_info); //save progress from curr -> next
-                curr_info.metadata.has_time_spec = prev_info.metadata.has_time_spec;
-                curr_info.metadata.time_spec = prev_info.metadata.time_spec + time_spec_t::from_ticks(
-                    prev_info[index].ifpi.num_payload_words32*sizeof(uint32_t)/_bytes_per_otw_item, _samp_rate);
+                curr_info.metadata.has_tsf = prev_info.metadata.has_tsf;
+                curr_info.metadata.tsf = prev_info.metadata.tsf;
+                curr_info.metadata.offset_samps = prev_info.metadata.offset_samps +
+                    prev_info[index].ifpi.num_payload_words32*sizeof(uint32_t)/_bytes_per_otw_item;
                 curr_info.metadata.out_of_sequence = true;
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
-                UHD_MSG(fastpath) << "D";
+                _gap_pending = true;
+                fastpath::post_event(fastpath::EVENT_DROPPED_PACKET, index,
+                    curr_info.metadata.has_tsf, get_packet_time_spec(curr_info.metadata));
+                record_error(index, next_info[index].ifpi, curr_info.metadata.error_code);
                 return;
 
             }
@@ -650,6 +1606,8 @@ private:
                 ) % iterations << std::endl;
                 std::swap(curr_info, next_info); //save progress from curr -> next
                 curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_ALIGNMENT;
+                record_error(index, next_info[index].ifpi, curr_info.metadata.error_code);
+                flight_recorder::request_dump();
                 _props[index].handle_overflow();
                 return;
             }
@@ -657,14 +1615,25 @@ private:
         }
 
         //set the metadata from the buffer information at index zero
-        curr_info.metadata.has_time_spec = curr_info[0].ifpi.has_tsf;
-        curr_info.metadata.time_spec = curr_info[0].time;
-        curr_info.metadata.more_fragments = false;
-        curr_info.metadata.fragment_offset = 0;
-        curr_info.metadata.start_of_burst = curr_info[0].ifpi.sob;
-        curr_info.metadata.end_of_burst = curr_info[0].ifpi.eob;
+        curr_info.metadata.has_tsf = curr_info[0].ifpi.has_tsf;
+        curr_info.metadata.tsf = curr_info[0].ifpi.tsf;
+        curr_info.metadata.offset_samps = 0;
+        curr_info.metadata.sob = curr_info[0].ifpi.sob;
+        curr_info.metadata.eob = curr_info[0].ifpi.eob;
         curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_NONE;
 
+        //after lost samples, the time stamps tell how many were lost
+        const tick_time_t packet_time(curr_info.metadata.tsf, _tick_rate);
+        curr_info.metadata.num_lost_samps = 0;
+        if (_gap_pending and _next_time_valid and curr_info.metadata.has_tsf){
+            const long long num_lost = ticks_to_samps(packet_time.ticks_since(_next_time));
+            if (num_lost > 0) curr_info.metadata.num_lost_samps = size_t(num_lost);
+        }
+        _gap_pending = false;
+        _next_time_valid = curr_info.metadata.has_tsf;
+        _next_time = packet_time + samps_to_ticks(
+            curr_info.data_bytes_to_copy/_bytes_per_otw_item/_num_outputs);
+
     }
 
     /*******************************************************************
@@ -688,26 +1657,43 @@ private:
         }
 
         buffers_info_type &info = get_curr_buffer_info();
-        metadata = info.metadata;
 
-        //interpolate the time spec (useful when this is a fragment)
-        metadata.time_spec += time_spec_t::from_ticks(info.fragment_offset_in_samps, _samp_rate);
+        //interpolate the time spec (useful when this is a fragment),
+        //the first decimated sample is filtered up to a later device sample
+        const size_t decim_delay = (_host_decim > 1)? _host_decim - 1 - _decim_phase : 0;
+        make_rx_metadata(info.metadata, info.fragment_offset_in_samps + decim_delay, metadata);
+        if (info.fragment_offset_in_samps != 0) metadata.num_lost_samps = 0; //reported with the first fragment
 
-        //extract the number of samples available to copy
+        //extract the number of samples available to copy,
+        //with host decimation as many as make up the samples asked for
         const size_t nsamps_available = info.data_bytes_to_copy/_bytes_per_otw_item;
-        const size_t nsamps_to_copy = std::min(nsamps_per_buff*_num_outputs, nsamps_available);
+        const size_t nsamps_to_copy = std::min((nsamps_per_buff*_host_decim - _decim_phase)*_num_outputs, nsamps_available);
         const size_t bytes_to_copy = nsamps_to_copy*_bytes_per_otw_item;
-        const size_t nsamps_to_copy_per_io_buff = nsamps_to_copy/_num_outputs;
+        const size_t nsamps_to_convert = nsamps_to_copy/_num_outputs;
+        const size_t nsamps_to_copy_per_io_buff = (_decim_phase + nsamps_to_convert)/_host_decim;
+        _decim_phase = (_decim_phase + nsamps_to_convert) % _host_decim;
 
         //setup the data to share with converter threads
-        _convert_nsamps = nsamps_to_copy_per_io_buff;
+        _convert_nsamps = nsamps_to_convert;
         _convert_buffs = &buffs;
         _convert_buffer_offset_bytes = buffer_offset_bytes;
         _convert_bytes_to_copy = bytes_to_copy;
 
         //perform N channels of conversion
-        for (size_t i = 0; i < this->size(); i++) {
-            convert_to_out_buff(i);
+        if (_convert_pool) {
+            _convert_pool->run(boost::bind(&recv_packet_handler::convert_to_out_buff, this, _1), this->size());
+        } else {
+            for (size_t i = 0; i < this->size(); i++) {
+                convert_to_out_buff(i);
+            }
+        }
+
+        //release the buffers if fully consumed, on this thread so that
+        //transports never see releases from the conversion workers
+        if (info.data_bytes_to_copy == bytes_to_copy) {
+            for (size_t i = 0; i < this->size(); i++) {
+                info[i].buff.reset(); //effectively a release
+            }
         }
 
         //update the copy buffer's availability
@@ -725,34 +1711,34 @@ private:
      *  buffer.
      *
      * - Calls the converter
-     * - Releases internal data buffers
      * - Updates read/write pointers
+     *
+     * May run on a conversion worker; must only touch channel \p index.
      */
     inline void convert_to_out_buff(const size_t index)
     {
+        UHD_TRACE_SPAN("rx_convert");
+
         //shortcut references to local data structures
         buffers_info_type &buff_info = get_curr_buffer_info();
         per_buffer_info_type &info = buff_info[index];
         const rx_streamer::buffs_type &buffs = *_convert_buffs;
 
         //fill IO buffs with pointers into the output buffer
-        void *io_buffs[4/*max interleave*/];
-        for (size_t i = 0; i < _num_outputs; i++){
-            char *b = reinterpret_cast<char *>(buffs[index*_num_outputs + i]);
+        void *io_buffs[8/*max interleave times planes*/];
+        const size_t num_io_buffs = _num_outputs*_num_planes;
+        for (size_t i = 0; i < num_io_buffs; i++){
+            char *b = reinterpret_cast<char *>(buffs[index*num_io_buffs + i]);
             io_buffs[i] = b + _convert_buffer_offset_bytes;
         }
-        const ref_vector<void *> out_buffs(io_buffs, _num_outputs);
+        const ref_vector<void *> out_buffs(io_buffs, num_io_buffs);
 
         //perform the conversion operation
-        _converter->conv(info.copy_buff, out_buffs, _convert_nsamps);
+        const uhd::convert::converter::sptr &converter = _converters.empty()? _converter : _converters[index];
+        converter->conv(info.copy_buff, out_buffs, _convert_nsamps);
 
         //advance the pointer for the source buffer
         info.copy_buff += _convert_bytes_to_copy;
-
-        //release the buffer if fully consumed
-        if (buff_info.data_bytes_to_copy == _convert_bytes_to_copy){
-            info.buff.reset(); //effectively a release
-        }
     }
 
     //! Shared variables for the worker threads
@@ -851,6 +1837,30 @@ public:
         return recv_packet_handler::issue_stream_cmd(stream_cmd);
     }
 
+    double get_stream_cmd_latency(void) const
+    {
+        return recv_packet_handler::get_stream_cmd_latency();
+    }
+
+    size_t recv_zero_copy(
+        rx_streamer::zero_copy_buffs_t &buffs,
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        return recv_packet_handler::recv_zero_copy(buffs, metadata, timeout);
+    }
+
+    size_t recv_batch(
+        const rx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        std::vector<rx_streamer::packet_info_t> &packets,
+        const size_t max_packets,
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        return recv_packet_handler::recv_batch(buffs, nsamps_per_buff, packets, max_packets, metadata, timeout);
+    }
+
 private:
     size_t _max_num_samps;
 };
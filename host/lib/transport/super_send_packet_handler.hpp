@@ -19,22 +19,32 @@
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP
 
 #include "../rfnoc/tx_stream_terminator.hpp"
+#include "convert_worker_pool.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
 #include <uhd/stream.hpp>
+#include <uhd/utils/flight_recorder.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/tasks.hpp>
+#include <uhd/utils/trace.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/atomic.hpp>
 #include <uhd/types/metadata.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/zero_copy.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/thread_time.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/format.hpp>
 #include <iostream>
 #include <vector>
+#include <cstring>
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
 // Included for debugging
@@ -60,6 +70,7 @@ class send_packet_handler{
 public:
     typedef boost::function<managed_send_buffer::sptr(double)> get_buff_type;
     typedef boost::function<bool(uhd::async_metadata_t &, const double)> async_receiver_type;
+    typedef boost::function<size_t(std::vector<uhd::async_metadata_t> &, const size_t, const double)> async_batch_receiver_type;
     typedef void(*vrt_packer_type)(uint32_t *, vrt::if_packet_info_t &);
     //typedef boost::function<void(uint32_t *, vrt::if_packet_info_t &)> vrt_packer_type;
 
@@ -68,14 +79,17 @@ public:
      * \param size the number of transport channels
      */
     send_packet_handler(const size_t size = 1):
-        _next_packet_seq(0), _cached_metadata(false)
+        _next_samp_rate(1.0), _next_scale_factor(32767.),
+        _scale_factor(32767.), _convert_threads(1), _pipeline_depth(0),
+        _next_packet_seq(0), _cached_metadata(false), _zc_pending(false)
     {
         this->set_enable_trailer(true);
         this->resize(size);
     }
 
     ~send_packet_handler(void){
-        /* NOP */
+        //send what is still queued before the transports go away
+        this->set_pipeline_depth(0);
     }
 
     //! Resize the number of transport channels
@@ -84,6 +98,8 @@ public:
         _props.resize(size);
         static const uint64_t zero = 0;
         _zero_buffs.resize(size, &zero);
+        if (_convert_pool) this->set_convert_threads(_convert_threads);
+        if (_sender) this->set_pipeline_depth(_pipeline_depth);
     }
 
     //! Get the channel width of this handler
@@ -136,27 +152,104 @@ public:
 
     //! Set the rate of samples per second
     void set_samp_rate(const double rate){
+        _samp_rate_change_pending.write(0);
         _samp_rate = rate;
     }
 
+    /*!
+     * Change the rate of samples per second and the scale factor while
+     * streaming, for a timed rate change of the device.
+     * The new values apply from the first send() with a time spec at or
+     * after the given time. Samples without a time spec cannot be placed
+     * before or after it, so a send() without one applies them at once.
+     * May be called from another thread than send().
+     * \param time the command time of the rate change
+     * \param rate the new rate of samples per second
+     * \param scale_factor the new scale factor
+     */
+    void set_samp_rate(const time_spec_t &time, const double rate, const double scale_factor){
+        boost::mutex::scoped_lock lock(_samp_rate_change_mutex);
+        _samp_rate_change_time = time;
+        _next_samp_rate = rate;
+        _next_scale_factor = scale_factor;
+        _samp_rate_change_pending.write(1);
+    }
+
     /*!
      * Set the function to get a managed buffer.
      * \param xport_chan which transport channel
      * \param get_buff the getter function
      */
     void set_xport_chan_get_buff(const size_t xport_chan, const get_buff_type &get_buff){
+        _props.at(xport_chan).xport.reset();
         _props.at(xport_chan).get_buff = get_buff;
     }
 
+    /*!
+     * Send directly to a transport.
+     * Same as binding zero_copy_if::get_send_buff with
+     * set_xport_chan_get_buff(), without the function object in between.
+     * \param xport_chan which transport channel
+     * \param xport the transport to send to
+     */
+    void set_xport_chan(const size_t xport_chan, zero_copy_if::sptr xport){
+        _props.at(xport_chan).get_buff = get_buff_type();
+        _props.at(xport_chan).xport = xport;
+    }
+
     //! Set the conversion routine for all channels
     void set_converter(const uhd::convert::id_type &id){
         _num_inputs = id.num_inputs;
+        _converter_id = id;
         _converter = uhd::convert::get_converter(id)();
+        _converters.clear();
+        if (_convert_pool) this->set_convert_threads(_convert_threads);
         this->set_scale_factor(32767.); //update after setting converter
         _bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.output_format);
         _bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.input_format);
     }
 
+    /*!
+     * Convert the channels of this streamer on several threads.
+     * Each channel gets its own converter instance. Call after resize().
+     * \param num_threads total threads including the caller of send(),
+     *        0 or 1 converts all channels on the calling thread
+     */
+    void set_convert_threads(const size_t num_threads){
+        _convert_threads = num_threads;
+        _convert_pool.reset();
+        _converters.clear();
+        if (num_threads <= 1 or this->size() <= 1 or not _converter) return;
+        _convert_pool = boost::make_shared<convert_worker_pool>(
+                std::min(num_threads, this->size()) - 1, "tx convert worker", "tx");
+        for (size_t i = 0; i < this->size(); i++){
+            _converters.push_back(uhd::convert::get_converter(_converter_id)());
+            _converters.back()->set_scalar(_scale_factor);
+        }
+    }
+
+    /*!
+     * Hand committed packets to a sender thread.
+     * The thread releases the buffers to the transports, which is where
+     * the packets are sent and where flow control waits for credits,
+     * while the caller of send() converts the next packets.
+     * \param depth packets per channel that may wait for the sender,
+     *        0 sends every packet on the calling thread
+     */
+    void set_pipeline_depth(const size_t depth){
+        //stop the sender and send the packets it did not get to, in order
+        _sender.reset();
+        if (_send_queue) {
+            managed_send_buffer::sptr buff;
+            while (_send_queue->pop_with_haste(buff)) buff.reset();
+            _send_queue.reset();
+        }
+        _pipeline_depth = depth;
+        if (depth == 0 or this->size() == 0) return;
+        _send_queue = boost::make_shared<bounded_buffer<managed_send_buffer::sptr> >(depth*this->size());
+        _sender = task::make(boost::bind(&send_packet_handler::sender_loop, this), "tx", "tx sender");
+    }
+
     /*!
      * Set the maximum number of samples per host packet.
      * Ex: A USRP1 in dual channel mode would be half.
@@ -168,7 +261,11 @@ public:
 
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
+        _scale_factor = scale_factor;
         _converter->set_scalar(scale_factor);
+        BOOST_FOREACH(const uhd::convert::converter::sptr &converter, _converters){
+            converter->set_scalar(scale_factor);
+        }
     }
 
     //! Set the callback to get async messages
@@ -177,6 +274,12 @@ public:
         _async_receiver = async_receiver;
     }
 
+    //! Set the callback to get all queued async messages at once (optional)
+    void set_async_batch_receiver(const async_batch_receiver_type &async_batch_receiver)
+    {
+        _async_batch_receiver = async_batch_receiver;
+    }
+
     //! Overload call to get async metadata
     bool recv_async_msg(
         uhd::async_metadata_t &async_metadata, double timeout = 0.1
@@ -186,6 +289,19 @@ public:
         return false;
     }
 
+    //! Get all queued async messages, one at a time without a batch receiver
+    size_t recv_async_msgs(
+        std::vector<uhd::async_metadata_t> &msgs, const size_t max_msgs, const double timeout
+    ){
+        if (_async_batch_receiver) return _async_batch_receiver(msgs, max_msgs, timeout);
+        msgs.clear();
+        uhd::async_metadata_t async_metadata;
+        while (msgs.size() < max_msgs and this->recv_async_msg(async_metadata, msgs.empty()? timeout : 0.0)) {
+            msgs.push_back(async_metadata);
+        }
+        return msgs.size();
+    }
+
     /*******************************************************************
      * Send:
      * The entry point for the fast-path send calls.
@@ -197,6 +313,10 @@ public:
         const uhd::tx_metadata_t &metadata,
         const double timeout
     ){
+        UHD_TRACE_SPAN("send");
+
+        if (_samp_rate_change_pending.read()) this->check_samp_rate_change(metadata);
+
         //translate the metadata to vrt if packet info
         vrt::if_packet_info_t if_packet_info;
         if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
@@ -293,33 +413,157 @@ public:
 		return nsamps_sent;
     }
 
+    /*******************************************************************
+     * Send without conversion:
+     * Give out the payload area of the next packet of every channel and
+     * send it with commit() once the caller has filled it.
+     ******************************************************************/
+    UHD_INLINE size_t get_send_buffer(
+        uhd::tx_streamer::zero_copy_buffs_t &zc_buffs,
+        const uhd::tx_metadata_t &metadata,
+        const double timeout
+    ){
+        //translate the metadata to vrt if packet info
+        vrt::if_packet_info_t &if_packet_info = _zc_if_packet_info;
+        if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        if_packet_info.has_cid = false;
+        if_packet_info.has_tlr = _has_tlr;
+        if_packet_info.has_tsi = false;
+        if_packet_info.has_tsf = metadata.has_time_spec;
+        if_packet_info.tsf     = metadata.time_spec.to_ticks(_tick_rate);
+        if_packet_info.sob     = metadata.start_of_burst;
+        if_packet_info.eob     = metadata.end_of_burst;
+        if_packet_info.num_payload_bytes = 0;
+        if_packet_info.num_payload_words32 = 0;
+        if_packet_info.packet_count = _next_packet_seq;
+
+        //get a buffer for each channel or timeout
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            if (not props.buff) props.buff = get_xport_buff(props, timeout);
+            if (not props.buff) return 0; //timeout
+        }
+
+        //the header size only depends on the flags, so pack it once
+        //to find where the payload starts
+        zc_buffs.buffs.resize(this->size());
+        for (size_t i = 0; i < this->size(); i++) {
+            vrt::if_packet_info_t chan_if_packet_info = if_packet_info;
+            chan_if_packet_info.has_sid = _props[i].has_sid;
+            chan_if_packet_info.sid = _props[i].sid;
+            uint32_t *otw_mem = _props[i].buff->cast<uint32_t *>() + _header_offset_words32;
+            _vrt_packer(otw_mem, chan_if_packet_info);
+            zc_buffs.buffs[i] = otw_mem + chan_if_packet_info.num_header_words32;
+        }
+        zc_buffs.nsamps = _max_samples_per_packet;
+        zc_buffs.item_format = _converter_id.output_format;
+        _zc_pending = true;
+        return zc_buffs.nsamps;
+    }
+
+    UHD_INLINE void commit(const size_t nsamps)
+    {
+        if (not _zc_pending) {
+            throw uhd::runtime_error("commit() called without a buffer from get_send_buffer()");
+        }
+        if (nsamps > _max_samples_per_packet) {
+            throw uhd::value_error(str(boost::format(
+                "commit() of %u samples, but the packet only holds %u")
+                % nsamps % _max_samples_per_packet));
+        }
+        _zc_pending = false;
+
+        //hardware does not support packets without samples, send one zero
+        //sample instead like send() does
+        const size_t nitems = (nsamps == 0)? 1 : nsamps;
+
+        vrt::if_packet_info_t if_packet_info = _zc_if_packet_info;
+        if_packet_info.num_payload_bytes = nitems*_num_inputs*_bytes_per_otw_item;
+        if_packet_info.num_payload_words32 = (if_packet_info.num_payload_bytes + 3/*round up*/)/sizeof(uint32_t);
+        if_packet_info.packet_count = _next_packet_seq;
+
+        for (size_t i = 0; i < this->size(); i++){
+            xport_chan_props_type &props = _props[i];
+            uint32_t *otw_mem = props.buff->cast<uint32_t *>() + _header_offset_words32;
+            if_packet_info.has_sid = props.has_sid;
+            if_packet_info.sid = props.sid;
+            _vrt_packer(otw_mem, if_packet_info);
+            if (nsamps == 0) {
+                std::memset(otw_mem + if_packet_info.num_header_words32, 0, if_packet_info.num_payload_bytes);
+            }
+            const size_t num_vita_words32 = _header_offset_words32+if_packet_info.num_packet_words32;
+            props.buff->commit(num_vita_words32*sizeof(uint32_t));
+            record_packet(i, if_packet_info, num_vita_words32*sizeof(uint32_t));
+            release_buff(props.buff);
+        }
+
+        _next_packet_seq++; //increment sequence after commits
+    }
+
 private:
 
     vrt_packer_type _vrt_packer;
     size_t _header_offset_words32;
     double _tick_rate, _samp_rate;
+    uhd::atomic_uint32_t _samp_rate_change_pending; //a timed rate change waits for its samples
+    boost::mutex _samp_rate_change_mutex;
+    time_spec_t _samp_rate_change_time;
+    double _next_samp_rate, _next_scale_factor;
+
+    //! Apply a timed rate change, see set_samp_rate()
+    void check_samp_rate_change(const uhd::tx_metadata_t &metadata){
+        boost::mutex::scoped_lock lock(_samp_rate_change_mutex);
+        if (not _samp_rate_change_pending.read()) return;
+        if (metadata.has_time_spec and metadata.time_spec < _samp_rate_change_time) return;
+        _samp_rate_change_pending.write(0);
+        _samp_rate = _next_samp_rate;
+        set_scale_factor(_next_scale_factor);
+    }
     struct xport_chan_props_type{
-        xport_chan_props_type(void):has_sid(false),sid(0){}
+        xport_chan_props_type(void):has_sid(false),sid(0),commit_bytes(0){}
         get_buff_type get_buff;
+        zero_copy_if::sptr xport; //used instead of get_buff when set
         bool has_sid;
         uint32_t sid;
         managed_send_buffer::sptr buff;
+        size_t commit_bytes; //set by convert_to_in_buff()
     };
     std::vector<xport_chan_props_type> _props;
+
+    //! Get a buffer from the transport of this channel
+    static UHD_INLINE managed_send_buffer::sptr get_xport_buff(xport_chan_props_type &props, const double timeout){
+        UHD_TRACE_SPAN("get_send_buff");
+        if (props.xport) return props.xport->get_send_buff(timeout);
+        return props.get_buff(timeout);
+    }
     size_t _num_inputs;
     size_t _bytes_per_otw_item; //used in conversion
     size_t _bytes_per_cpu_item; //used in conversion
     uhd::convert::converter::sptr _converter; //used in conversion
+    uhd::convert::id_type _converter_id;
+    double _scale_factor;
+    //! One converter per channel when converting on the worker pool
+    std::vector<uhd::convert::converter::sptr> _converters;
+    size_t _convert_threads;
+    convert_worker_pool::sptr _convert_pool;
+    //! Committed packets waiting for the sender thread, in send order
+    size_t _pipeline_depth;
+    boost::shared_ptr<bounded_buffer<managed_send_buffer::sptr> > _send_queue;
+    task::sptr _sender;
     size_t _max_samples_per_packet;
     std::vector<const void *> _zero_buffs;
     size_t _next_packet_seq;
     bool _has_tlr;
     async_receiver_type _async_receiver;
+    async_batch_receiver_type _async_batch_receiver;
     bool _cached_metadata;
     uhd::tx_metadata_t _metadata_cache;
 
     uhd::rfnoc::tx_stream_terminator::sptr _terminator;
 
+    //! Packet set up by get_send_buffer(), waiting for commit()
+    vrt::if_packet_info_t _zc_if_packet_info;
+    bool _zc_pending;
+
 #ifdef UHD_TXRX_DEBUG_PRINTS
     struct dbg_send_stat_t {
         dbg_send_stat_t(long wc, size_t nspb, size_t nss, uhd::tx_metadata_t md, double to, double rate):
@@ -365,6 +609,35 @@ private:
 
 #endif
 
+    //! Send a committed buffer, or queue it for the sender thread
+    UHD_INLINE void release_buff(managed_send_buffer::sptr &buff){
+        if (_send_queue) _send_queue->push_with_wait(buff);
+        buff.reset(); //effectively a release
+    }
+
+    void sender_loop(void){
+        managed_send_buffer::sptr buff;
+        if (not _send_queue->pop_with_timed_wait(buff, 0.1)) return;
+        //the release may wait for flow control credit, which is an
+        //interruption point; stopping the sender must not throw out of it
+        boost::this_thread::disable_interruption di;
+        buff.reset();
+    }
+
+    //! Record a packet this channel sent, see flight_recorder.hpp
+    UHD_INLINE void record_packet(
+        const size_t index,
+        const vrt::if_packet_info_t &if_packet_info,
+        const size_t num_bytes
+    ){
+        flight_recorder::record(flight_recorder::RECORD_TX_PACKET, index,
+            _props[index].sid, uint32_t(if_packet_info.packet_count),
+            if_packet_info.tsf, uint32_t(num_bytes),
+            (if_packet_info.has_tsf? flight_recorder::FLAG_HAS_TSF : 0)
+            | (if_packet_info.sob? flight_recorder::FLAG_SOB : 0)
+            | (if_packet_info.eob? flight_recorder::FLAG_EOB : 0));
+    }
+
     /*******************************************************************
      * Send a single packet:
      ******************************************************************/
@@ -383,7 +656,7 @@ private:
 
         //get a buffer for each channel or timeout
         BOOST_FOREACH(xport_chan_props_type &props, _props){
-            if (not props.buff) props.buff = props.get_buff(timeout);
+            if (not props.buff) props.buff = get_xport_buff(props, timeout);
             if (not props.buff) return 0; //timeout
         }
 
@@ -394,10 +667,24 @@ private:
         _convert_if_packet_info = &if_packet_info;
 
         //perform N channels of conversion
-        for (size_t i = 0; i < this->size(); i++) {
-            convert_to_in_buff(i);
+        if (_convert_pool) {
+            _convert_pool->run(boost::bind(&send_packet_handler::convert_to_in_buff, this, _1), this->size());
+        } else {
+            for (size_t i = 0; i < this->size(); i++) {
+                convert_to_in_buff(i);
+            }
+        }
+
+        //commit the samples to the zero-copy interfaces, on this thread and
+        //in channel order, regardless of where the conversion ran
+        for (size_t i = 0; i < this->size(); i++){
+            xport_chan_props_type &props = _props[i];
+            props.buff->commit(props.commit_bytes);
+            record_packet(i, if_packet_info, props.commit_bytes);
+            release_buff(props.buff);
         }
 
+        _zc_pending = false; //send() used up any buffers from get_send_buffer()
         _next_packet_seq++; //increment sequence after commits
         return nsamps_per_buff;
     }
@@ -405,12 +692,15 @@ private:
     /*! Run the conversion from the internal buffers to the user's input
      *  buffer.
      *
+     * - Packs the VRT header
      * - Calls the converter
-     * - Releases internal data buffers
-     * - Updates read/write pointers
+     *
+     * May run on a conversion worker; must only touch channel \p index.
      */
     UHD_INLINE void convert_to_in_buff(const size_t index)
     {
+        UHD_TRACE_SPAN("tx_convert");
+
         //shortcut references to local data structures
         managed_send_buffer::sptr &buff = _props[index].buff;
         vrt::if_packet_info_t if_packet_info = *_convert_if_packet_info;
@@ -432,12 +722,12 @@ private:
         otw_mem += if_packet_info.num_header_words32;
 
         //perform the conversion operation
-        _converter->conv(in_buffs, otw_mem, _convert_nsamps);
+        const uhd::convert::converter::sptr &converter = _converters.empty()? _converter : _converters[index];
+        converter->conv(in_buffs, otw_mem, _convert_nsamps);
 
-        //commit the samples to the zero-copy interface
+        //remember the size to commit to the zero-copy interface
         const size_t num_vita_words32 = _header_offset_words32+if_packet_info.num_packet_words32;
-        buff->commit(num_vita_words32*sizeof(uint32_t));
-        buff.reset(); //effectively a release
+        _props[index].commit_bytes = num_vita_words32*sizeof(uint32_t);
     }
 
     //! Shared variables for the worker threads
@@ -478,6 +768,25 @@ public:
         return send_packet_handler::recv_async_msg(async_metadata, timeout);
     }
 
+    size_t recv_async_msgs(
+        std::vector<uhd::async_metadata_t> &msgs, const size_t max_msgs, const double timeout = 0.1
+    ){
+        return send_packet_handler::recv_async_msgs(msgs, max_msgs, timeout);
+    }
+
+    size_t get_send_buffer(
+        tx_streamer::zero_copy_buffs_t &buffs,
+        const uhd::tx_metadata_t &metadata,
+        const double timeout
+    ){
+        return send_packet_handler::get_send_buffer(buffs, metadata, timeout);
+    }
+
+    void commit(const size_t nsamps)
+    {
+        send_packet_handler::commit(nsamps);
+    }
+
 private:
     size_t _max_num_samps;
 };
@@ -16,15 +16,26 @@
 //
 
 #include "udp_common.hpp"
+#include "zero_copy_stats.hpp"
 #include <uhd/transport/tcp_zero_copy.hpp>
 #include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/atomic.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <vector>
+#ifdef HAVE_MSG_ZEROCOPY
+#include <sys/socket.h>
+#include <linux/errqueue.h> //sock_extended_err
+#include <netinet/in.h> //IP_RECVERR
+#endif /*HAVE_MSG_ZEROCOPY*/
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -33,85 +44,71 @@ namespace asio = boost::asio;
 static const size_t DEFAULT_NUM_FRAMES = 32;
 static const size_t DEFAULT_FRAME_SIZE = 2048;
 
+/***********************************************************************
+ * Framing:
+ *  Every frame goes over the stream padded to the full frame size,
+ *  so frame boundaries are found at fixed offsets. This lets many
+ *  frames be moved with a single send() or recv() on a contiguous
+ *  ring, and a segment split across recv() calls is reassembled in
+ *  place instead of being handed out as a short frame.
+ **********************************************************************/
+class tcp_zero_copy_asio_impl;
+
 /***********************************************************************
  * Reusable managed receiver buffer:
- *  - get_new performs the recv operation
+ *  - a view of one slot in the receive ring
  **********************************************************************/
 class tcp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    tcp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    tcp_zero_copy_asio_mrb(void *mem, const size_t frame_size):
+        _mem(mem), _frame_size(frame_size) { /*NOP*/ }
 
     void release(void){
         _claimer.release();
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
-
-        #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
-        _len = ::recv(_sock_fd, (char *)_mem, _frame_size, MSG_DONTWAIT);
-        if (_len > 0){
-            index++; //advances the caller's buffer
-            return make(this, _mem, size_t(_len));
-        }
-        #endif
-
-        if (wait_for_recv_ready(_sock_fd, timeout)){
-            _len = ::recv(_sock_fd, (char *)_mem, _frame_size, 0);
-            index++; //advances the caller's buffer
-            return make(this, _mem, size_t(_len));
-        }
+    UHD_INLINE bool claim(const double timeout){
+        return _claimer.claim_with_wait(timeout);
+    }
 
-        _claimer.release(); //undo claim
-        return sptr(); //null for timeout
+    UHD_INLINE sptr get_new(void){
+        return make(this, _mem, _frame_size);
     }
 
 private:
     void *_mem;
-    int _sock_fd;
     size_t _frame_size;
-    ssize_t _len;
     simple_claimer _claimer;
 };
 
 /***********************************************************************
  * Reusable managed send buffer:
- *  - commit performs the send operation
+ *  - a view of one slot in the send ring
+ *  - release hands the slot back to the transport for sending
  **********************************************************************/
 class tcp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    tcp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    tcp_zero_copy_asio_msb(tcp_zero_copy_asio_impl &xport, void *mem, const size_t index, const size_t frame_size):
+        _xport(xport), _mem(mem), _index(index), _frame_size(frame_size) { /*NOP*/ }
 
-    void release(void){
-        //Retry logic because send may fail with ENOBUFS.
-        //This is known to occur at least on some OSX systems.
-        //But it should be safe to always check for the error.
-        while (true)
-        {
-            this->commit(_frame_size); //always full size frames to avoid pkt coalescing
-            const ssize_t ret = ::send(_sock_fd, (const char *)_mem, size(), 0);
-            if (ret == ssize_t(size())) break;
-            if (ret == -1 and errno == ENOBUFS)
-            {
-                boost::this_thread::sleep(boost::posix_time::microseconds(1));
-                continue; //try to send again
-            }
-            UHD_ASSERT_THROW(ret == ssize_t(size()));
-        }
+    void release(void);
+
+    UHD_INLINE bool claim(const double timeout){
+        return _claimer.claim_with_wait(timeout);
+    }
+
+    UHD_INLINE void unclaim(void){
         _claimer.release();
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
-        index++; //advances the caller's buffer
+    UHD_INLINE sptr get_new(void){
         return make(this, _mem, _frame_size);
     }
 
 private:
+    tcp_zero_copy_asio_impl &_xport;
     void *_mem;
-    int _sock_fd;
+    size_t _index;
     size_t _frame_size;
     simple_claimer _claimer;
 };
@@ -122,10 +119,11 @@ tcp_zero_copy::~tcp_zero_copy(void){
 
 /***********************************************************************
  * Zero Copy TCP implementation with ASIO:
- *   This is the portable zero copy implementation for systems
- *   where a faster, platform specific solution is not available.
- *   However, it is not a true zero copy implementation as each
- *   send and recv requires a copy operation to/from userspace.
+ *   Receive fills a ring of frames with as few recv() calls as the
+ *   socket allows. Send writes runs of released frames with a single
+ *   send(); with MSG_ZEROCOPY the kernel transmits straight out of the
+ *   ring and a frame is reused only after its completion arrives on
+ *   the socket error queue.
  **********************************************************************/
 class tcp_zero_copy_asio_impl : public tcp_zero_copy{
 public:
@@ -140,9 +138,16 @@ public:
         _num_recv_frames(size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_FRAMES))),
         _send_frame_size(size_t(hints.cast<double>("send_frame_size", DEFAULT_FRAME_SIZE))),
         _num_send_frames(size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_FRAMES))),
-        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size)),
-        _next_recv_buff_index(0), _next_send_buff_index(0)
+        _send_batch_size(std::max<size_t>(1, std::min<size_t>(_num_send_frames,
+            size_t(hints.cast<double>("send_batch_size", 1))))),
+        _recv_buffer_pool(buffer_pool::make(1, _num_recv_frames*_recv_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
+        _send_buffer_pool(buffer_pool::make(1, _num_send_frames*_send_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
+        _recv_hand_index(0), _recv_fill_index(0), _recv_claim_index(0), _recv_fill_bytes(0),
+        _next_send_buff_index(0), _send_write_index(0), _send_free_index(0), _send_outstanding(0),
+        _send_committed(_num_send_frames, false),
+        _zerocopy(false), _zerocopy_seq(0)
     {
         UHD_LOG << boost::format("Creating tcp transport for %s %s") % addr % port << std::endl;
 
@@ -160,28 +165,44 @@ public:
         asio::ip::tcp::no_delay option(true);
         _socket->set_option(option);
 
+        if (hints.has_key("send_zerocopy") and hints.cast<int>("send_zerocopy", 0) != 0){
+            enable_zerocopy();
+        }
+
         //allocate re-usable managed receive buffers
+        char *recv_ring = static_cast<char *>(_recv_buffer_pool->at(0));
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::make_shared<tcp_zero_copy_asio_mrb>(
-                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size()
+                recv_ring + i*get_recv_frame_size(), get_recv_frame_size()
             ));
         }
 
         //allocate re-usable managed send buffers
+        char *send_ring = static_cast<char *>(_send_buffer_pool->at(0));
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(boost::make_shared<tcp_zero_copy_asio_msb>(
-                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size()
+                boost::ref(*this), send_ring + i*get_send_frame_size(), i, get_send_frame_size()
             ));
         }
     }
 
+    ~tcp_zero_copy_asio_impl(void){
+        //let the kernel finish with the send ring before it is freed
+        if (_zerocopy) while (wait_for_completions(1.0)){}
+    }
+
     /*******************************************************************
      * Receive implementation:
-     * Block on the managed buffer's get call and advance the index.
+     * Hand out the next complete frame of the ring, reading more from
+     * the socket when all received frames have been handed out.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
-        if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        managed_recv_buffer::sptr buff;
+        if (_recv_hand_index < _recv_fill_index or fill_recv_ring(timeout)){
+            buff = _mrb_pool[_recv_hand_index++ % _num_recv_frames]->get_new();
+        }
+        _stats.count_recv(buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
@@ -189,24 +210,278 @@ public:
 
     /*******************************************************************
      * Send implementation:
-     * Block on the managed buffer's get call and advance the index.
+     * Claim the next slot of the ring. Released slots are written in
+     * order by commit().
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
-        if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        tcp_zero_copy_asio_msb &msb = *_msb_pool[_next_send_buff_index];
+        managed_send_buffer::sptr buff;
+        if (claim_send_slot(msb, timeout)){
+            if (++_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
+            {
+                boost::mutex::scoped_lock lock(_send_mutex);
+                _send_outstanding++;
+            }
+            buff = msb.get_new();
+        }
+        _stats.count_send(buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    zero_copy_stats_t get_stats(void) const {return _stats.get();}
+
+    /*!
+     * Mark a send slot released and write out the run of released slots
+     * at the head of the ring. The run is held back (up to send_batch_size
+     * frames) only while the caller still owns other send buffers, so the
+     * last frame of a burst always goes out on release.
+     */
+    void commit(const size_t index){
+        boost::mutex::scoped_lock lock(_send_mutex);
+        _send_committed[index] = true;
+        _send_outstanding--;
+
+        while (true){
+            const size_t first = _send_write_index % _num_send_frames;
+            size_t run = 0;
+            while (first + run < _num_send_frames and _send_committed[first + run]) run++;
+            if (run == 0) return;
+            if (_send_outstanding > 0 and run < _send_batch_size
+                and first + run < _num_send_frames) return;
+            write_send_run(first, run);
+        }
+    }
+
 private:
+    /*!
+     * Read from the socket into the free slots following the last
+     * received frame until at least one new frame is complete.
+     * A read never wraps past the end of the ring.
+     */
+    bool fill_recv_ring(const double timeout){
+        char *ring = static_cast<char *>(_recv_buffer_pool->at(0));
+        while (_recv_fill_index == _recv_hand_index){
+            //a slot to receive into is required, wait for one if needed
+            if (_recv_claim_index == _recv_fill_index){
+                tcp_zero_copy_asio_mrb &mrb = *_mrb_pool[_recv_claim_index % _num_recv_frames];
+                if (not mrb.claim(0.0)){
+                    _stats.count_recv_pool_empty();
+                    if (not mrb.claim(timeout)) return false;
+                }
+                _recv_claim_index++;
+            }
+            //claim further free slots up to the end of the ring
+            while (_recv_claim_index - _recv_hand_index < _num_recv_frames
+                and _recv_claim_index % _num_recv_frames != 0
+                and _mrb_pool[_recv_claim_index % _num_recv_frames]->claim(0.0)){
+                _recv_claim_index++;
+            }
+
+            const size_t first = _recv_fill_index % _num_recv_frames;
+            const size_t num_slots = std::min(_recv_claim_index - _recv_fill_index, _num_recv_frames - first);
+            char *mem = ring + first*_recv_frame_size + _recv_fill_bytes;
+            const size_t len = num_slots*_recv_frame_size - _recv_fill_bytes;
+
+            ssize_t ret = -1;
+            #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
+            ret = ::recv(_sock_fd, mem, len, MSG_DONTWAIT);
+            #endif
+            if (ret <= 0){
+                const time_spec_t wait_start = time_spec_t::get_system_time();
+                const bool ready = wait_for_recv_ready(_sock_fd, timeout);
+                _stats.add_recv_wait(wait_start);
+                if (not ready) return false; //timeout
+                ret = ::recv(_sock_fd, mem, len, 0);
+                if (ret <= 0) return false; //closed or error
+            }
+
+            _recv_fill_bytes += size_t(ret);
+            _recv_fill_index += _recv_fill_bytes / _recv_frame_size;
+            _recv_fill_bytes %= _recv_frame_size;
+        }
+        return true;
+    }
+
+    UHD_INLINE bool claim_send_slot(tcp_zero_copy_asio_msb &msb, const double timeout){
+        if (msb.claim(0.0)) return true;
+        if (_zerocopy){
+            reap_completions();
+            if (msb.claim(0.0)) return true;
+        }
+        _stats.count_send_pool_empty();
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        bool claimed = false;
+        if (_zerocopy){
+            //slots only come back through completions, so wait on those
+            const time_spec_t exit_time = wait_start + time_spec_t(timeout);
+            while (not (claimed = msb.claim(0.0))){
+                const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+                if (remaining <= 0.0 or not wait_for_completions(remaining)) break;
+            }
+        }
+        else{
+            claimed = msb.claim(timeout);
+        }
+        _stats.add_send_wait(wait_start);
+        return claimed;
+    }
+
+    //! Write a run of slots with one send(), called with the send lock held
+    void write_send_run(const size_t first, const size_t run){
+        const char *mem = static_cast<const char *>(_send_buffer_pool->at(0)) + first*_send_frame_size;
+        const size_t len = run*_send_frame_size;
+        size_t sent = 0;
+        while (sent < len){
+            const ssize_t ret = ::send(_sock_fd, mem + sent, len - sent, send_flags());
+            if (ret > 0){
+                sent += size_t(ret);
+                if (_zerocopy) _zerocopy_seq++;
+                continue;
+            }
+            //Retry logic because send may fail with ENOBUFS.
+            //This is known to occur at least on some OSX systems.
+            //With MSG_ZEROCOPY it also means the per-socket limit
+            //of pinned pages was reached: reap completions and retry.
+            if (ret == -1 and errno == ENOBUFS){
+                if (_zerocopy) reap_completions_locked();
+                boost::this_thread::sleep(boost::posix_time::microseconds(1));
+                continue; //try to send again
+            }
+            throw uhd::io_error(str(boost::format("tcp_zero_copy: send() failed: %s") % std::strerror(errno)));
+        }
+
+        for (size_t i = first; i < first + run; i++) _send_committed[i] = false;
+        _send_write_index += run;
+        if (_zerocopy){
+            _zerocopy_pending.push_back(std::make_pair(_zerocopy_seq - 1, _send_write_index));
+        }
+        else{
+            release_send_slots(_send_write_index);
+        }
+    }
+
+    UHD_INLINE void release_send_slots(const size_t end_index){
+        for (; _send_free_index < end_index; _send_free_index++){
+            _msb_pool[_send_free_index % _num_send_frames]->unclaim();
+        }
+    }
+
+    UHD_INLINE int send_flags(void) const{
+        #ifdef HAVE_MSG_ZEROCOPY
+        if (_zerocopy) return MSG_ZEROCOPY;
+        #endif /*HAVE_MSG_ZEROCOPY*/
+        return 0;
+    }
+
+    void enable_zerocopy(void){
+        #ifdef HAVE_MSG_ZEROCOPY
+        int one = 1;
+        if (::setsockopt(_sock_fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0){
+            _zerocopy = true;
+            UHD_LOG << "tcp_zero_copy: MSG_ZEROCOPY send enabled" << std::endl;
+            return;
+        }
+        UHD_MSG(warning) << boost::format(
+            "tcp_zero_copy: SO_ZEROCOPY failed (%s), sending with copies") % std::strerror(errno) << std::endl;
+        #else
+        UHD_MSG(warning) << "tcp_zero_copy: MSG_ZEROCOPY is not supported on this platform, sending with copies" << std::endl;
+        #endif /*HAVE_MSG_ZEROCOPY*/
+    }
+
+    /*!
+     * Drain MSG_ZEROCOPY completions from the socket error queue and
+     * release every slot whose send() the kernel is done with.
+     * \return true if anything was completed
+     */
+    bool reap_completions(void){
+        boost::mutex::scoped_lock lock(_send_mutex);
+        return reap_completions_locked();
+    }
+
+    bool reap_completions_locked(void){
+        #ifdef HAVE_MSG_ZEROCOPY
+        bool reaped = false;
+        while (true){
+            char control[128];
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(_sock_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) break;
+
+            for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)){
+                if (not ((cm->cmsg_level == SOL_IP and cm->cmsg_type == IP_RECVERR)
+                    or (cm->cmsg_level == SOL_IPV6 and cm->cmsg_type == IPV6_RECVERR))) continue;
+                const sock_extended_err *serr = reinterpret_cast<const sock_extended_err *>(CMSG_DATA(cm));
+                if (serr->ee_errno != 0 or serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+                //ee_info..ee_data is the range of completed send() calls,
+                //TCP completes them in order so only the end matters
+                const uint32_t last = serr->ee_data;
+                while (not _zerocopy_pending.empty()
+                    and int32_t(last - _zerocopy_pending.front().first) >= 0){
+                    release_send_slots(_zerocopy_pending.front().second);
+                    _zerocopy_pending.pop_front();
+                }
+                reaped = true;
+            }
+        }
+        return reaped;
+        #else
+        return false;
+        #endif /*HAVE_MSG_ZEROCOPY*/
+    }
+
+    //! Wait for completions to arrive (they are flagged as POLLERR)
+    bool wait_for_completions(const double timeout){
+        #ifdef HAVE_MSG_ZEROCOPY
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        while (true){
+            {
+                boost::mutex::scoped_lock lock(_send_mutex);
+                if (_zerocopy_pending.empty()) return false;
+            }
+            if (reap_completions()) return true;
+            const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+            if (remaining <= 0.0) return false;
+            pollfd pfd;
+            pfd.fd = _sock_fd;
+            pfd.events = 0;
+            pfd.revents = 0;
+            if (::poll(&pfd, 1, std::max(1, int(remaining*1000))) <= 0) return false;
+            if (not reap_completions()) return false; //a real socket error
+            return true;
+        }
+        #else
+        return false;
+        #endif /*HAVE_MSG_ZEROCOPY*/
+    }
+
     //memory management -> buffers and fifos
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
+    const size_t _send_batch_size;
     buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
     std::vector<boost::shared_ptr<tcp_zero_copy_asio_msb> > _msb_pool;
     std::vector<boost::shared_ptr<tcp_zero_copy_asio_mrb> > _mrb_pool;
-    size_t _next_recv_buff_index, _next_send_buff_index;
+    zero_copy_stats_counter _stats;
+
+    //receive ring state, absolute frame counts:
+    //handed out <= filled <= claimed for filling
+    size_t _recv_hand_index, _recv_fill_index, _recv_claim_index;
+    size_t _recv_fill_bytes; //bytes of the partially received frame
+
+    //send ring state, absolute frame counts:
+    //released to the caller <= written to the socket
+    size_t _next_send_buff_index;
+    boost::mutex _send_mutex;
+    size_t _send_write_index, _send_free_index, _send_outstanding;
+    std::vector<bool> _send_committed;
+    bool _zerocopy;
+    uint32_t _zerocopy_seq;
+    std::deque<std::pair<uint32_t, size_t> > _zerocopy_pending;
 
     //asio guts -> socket and service
     asio::io_service        _io_service;
@@ -214,6 +489,10 @@ private:
     int                     _sock_fd;
 };
 
+void tcp_zero_copy_asio_msb::release(void){
+    _xport.commit(_index);
+}
+
 /***********************************************************************
  * TCP zero copy make function
  **********************************************************************/
@@ -19,6 +19,7 @@
 #define INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
 #include <boost/asio.hpp>
 
 namespace uhd{ namespace transport{
@@ -70,6 +71,22 @@ namespace uhd{ namespace transport{
 #endif
     }
 
+    /*!
+     * Wait for the socket to become ready for a receive operation,
+     * without ever sleeping: poll the socket until it is ready or the
+     * timeout passed. This keeps the calling CPU busy the whole time.
+     * \param sock_fd the open socket file descriptor
+     * \param timeout the timeout duration in seconds
+     * \return true when the socket is ready for receive
+     */
+    UHD_INLINE bool spin_for_recv_ready(int sock_fd, double timeout){
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        do{
+            if (wait_for_recv_ready(sock_fd, 0.0)) return true;
+        } while (time_spec_t::get_system_time() < exit_time);
+        return false;
+    }
+
 }} //namespace uhd::transport
 
 #endif /* INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP */
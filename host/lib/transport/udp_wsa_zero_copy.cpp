@@ -15,14 +15,28 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#ifdef HAVE_WIN_RIO
+//Registered I/O needs the Windows 8 API, while the project builds for an
+//older version. Raise it before the first Windows header is pulled in.
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0602
+#endif /*HAVE_WIN_RIO*/
+
 #include "udp_common.hpp"
+#include "zero_copy_stats.hpp"
 #include <uhd/transport/udp_zero_copy.hpp>
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cstring>
 #include <vector>
+#ifdef HAVE_WIN_RIO
+#include <mswsock.h> //Registered I/O extensions
+#endif /*HAVE_WIN_RIO*/
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -72,6 +86,14 @@ struct uhd_wsa_control{
     }
 };
 
+//! Read back the socket's buffer space reserved for receives or sends
+static size_t get_sock_buff_size(SOCKET sock_fd, const int opt){
+    int buff_size = 0;
+    int opt_len = sizeof(buff_size);
+    getsockopt(sock_fd, SOL_SOCKET, opt, (char *)&buff_size, (int *)&opt_len);
+    return (size_t) buff_size;
+}
+
 /***********************************************************************
  * Reusable managed receiver buffer:
  *  - Initialize with memory and a release callback.
@@ -189,8 +211,10 @@ public:
         _num_recv_frames(xport_params.num_recv_frames),
         _send_frame_size(xport_params.send_frame_size),
         _num_send_frames(xport_params.num_send_frames),
-        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size)),
+        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
+        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
         _next_recv_buff_index(0), _next_send_buff_index(0)
     {
         #ifdef CHECK_REG_SEND_THRESH
@@ -278,32 +302,12 @@ public:
 
     //! Read back the socket's buffer space reserved for receives
     size_t get_recv_buff_size(void) {
-        int recv_buff_size = 0;
-        int opt_len = sizeof(recv_buff_size);
-        getsockopt(
-                _sock_fd,
-                SOL_SOCKET,
-                SO_RCVBUF,
-                (char *)&recv_buff_size,
-                (int *)&opt_len
-        );
-
-        return (size_t) recv_buff_size;
+        return get_sock_buff_size(_sock_fd, SO_RCVBUF);
     }
 
     //! Read back the socket's buffer space reserved for sends
     size_t get_send_buff_size(void) {
-        int send_buff_size = 0;
-        int opt_len = sizeof(send_buff_size);
-        getsockopt(
-                _sock_fd,
-                SOL_SOCKET,
-                SO_SNDBUF,
-                (char *)&send_buff_size,
-                (int *)&opt_len
-        );
-
-        return (size_t) send_buff_size;
+        return get_sock_buff_size(_sock_fd, SO_SNDBUF);
     }
 
 private:
@@ -319,6 +323,357 @@ private:
     SOCKET                  _sock_fd;
 };
 
+
+#ifdef HAVE_WIN_RIO
+/***********************************************************************
+ * Reusable managed receive buffer for Registered I/O:
+ *  - a view of one slot of the registered receive memory
+ *  - release posts the slot back to the socket
+ **********************************************************************/
+class udp_zero_copy_rio_impl;
+
+class udp_zero_copy_rio_mrb : public managed_recv_buffer{
+public:
+    udp_zero_copy_rio_mrb(udp_zero_copy_rio_impl &xport, char *mem, const size_t index):
+        _xport(xport), _mem(mem), _index(index) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(const size_t len){
+        return make(this, _mem, len);
+    }
+
+private:
+    udp_zero_copy_rio_impl &_xport;
+    char *_mem;
+    const size_t _index;
+};
+
+/***********************************************************************
+ * Reusable managed send buffer for Registered I/O:
+ *  - a view of one slot of the registered send memory
+ *  - release posts the send, the slot is reused after its completion
+ **********************************************************************/
+class udp_zero_copy_rio_msb : public managed_send_buffer{
+public:
+    udp_zero_copy_rio_msb(udp_zero_copy_rio_impl &xport, char *mem, const size_t index, const size_t frame_size):
+        _xport(xport), _mem(mem), _index(index), _frame_size(frame_size) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void){
+        return make(this, _mem, _frame_size);
+    }
+
+private:
+    udp_zero_copy_rio_impl &_xport;
+    char *_mem;
+    const size_t _index;
+    const size_t _frame_size;
+};
+
+/***********************************************************************
+ * Zero Copy UDP implementation with Registered I/O (Windows 8 and later):
+ *
+ *   The buffer pools are registered with the socket once, so receives
+ *   and sends are posted without locking pages for every call.
+ *   Completions are dequeued from one completion queue per direction
+ *   in batches; the event notification is only armed when a queue is
+ *   found empty, so at full rate no wait objects are touched.
+ *
+ *   A request queue may not be used by two threads at once, so posts
+ *   from get/release on the receive and send side share a lock.
+ **********************************************************************/
+class udp_zero_copy_rio_impl : public udp_zero_copy{
+public:
+    typedef boost::shared_ptr<udp_zero_copy_rio_impl> sptr;
+
+    udp_zero_copy_rio_impl(
+        const std::string &addr,
+        const std::string &port,
+        zero_copy_xport_params& xport_params,
+        const device_addr_t &hints
+    ):
+        _recv_frame_size(xport_params.recv_frame_size),
+        _num_recv_frames(xport_params.num_recv_frames),
+        _send_frame_size(xport_params.send_frame_size),
+        _num_send_frames(xport_params.num_send_frames),
+        _recv_buffer_pool(buffer_pool::make(1, _num_recv_frames*_recv_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
+        _send_buffer_pool(buffer_pool::make(1, _num_send_frames*_send_frame_size, 16,
+            buffer_pool::alloc_policy_t::from_hints(hints))),
+        _sock_fd(INVALID_SOCKET),
+        _recv_buff_id(RIO_INVALID_BUFFERID), _send_buff_id(RIO_INVALID_BUFFERID),
+        _recv_cq(RIO_INVALID_CQ), _send_cq(RIO_INVALID_CQ), _rq(RIO_INVALID_RQ),
+        _recv_event(WSA_INVALID_EVENT), _send_event(WSA_INVALID_EVENT),
+        _recv_results(_num_recv_frames), _num_recv_results(0), _next_recv_result(0),
+        _send_results(_num_send_frames)
+    {
+        #ifdef CHECK_REG_SEND_THRESH
+        check_registry_for_fast_send_threshold(this->get_send_frame_size());
+        #endif /*CHECK_REG_SEND_THRESH*/
+
+        UHD_LOG << boost::format("Creating RIO UDP transport for %s:%s") % addr % port << std::endl;
+        static uhd_wsa_control uhd_wsa; //makes wsa start happen via lazy initialization
+
+        //resolve the address
+        asio::io_service io_service;
+        asio::ip::udp::resolver resolver(io_service);
+        asio::ip::udp::resolver::query query(asio::ip::udp::v4(), addr, port);
+        asio::ip::udp::endpoint receiver_endpoint = *resolver.resolve(query);
+
+        //create the socket
+        _sock_fd = WSASocket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_REGISTERED_IO);
+        if (_sock_fd == INVALID_SOCKET){
+            throw uhd::os_error(str(boost::format("WSASocket() failed with error %d") % WSAGetLastError()));
+        }
+
+        try{
+            //load the RIO function table
+            GUID rio_guid = WSAID_MULTIPLE_RIO;
+            DWORD num_bytes = 0;
+            if (WSAIoctl(_sock_fd, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER,
+                &rio_guid, sizeof(rio_guid), &_rio, sizeof(_rio), &num_bytes, NULL, NULL) != 0){
+                throw uhd::os_error(str(boost::format("Registered I/O is not available (error %d)") % WSAGetLastError()));
+            }
+
+            //resize the socket buffers
+            const int recv_buff_size = int(hints.cast<double>("recv_buff_size", 0.0));
+            const int send_buff_size = int(hints.cast<double>("send_buff_size", 0.0));
+            if (recv_buff_size > 0) setsockopt(_sock_fd, SOL_SOCKET, SO_RCVBUF, (const char *)&recv_buff_size, sizeof(recv_buff_size));
+            if (send_buff_size > 0) setsockopt(_sock_fd, SOL_SOCKET, SO_SNDBUF, (const char *)&send_buff_size, sizeof(send_buff_size));
+
+            //connect the socket so we can send/recv
+            const asio::ip::udp::endpoint::data_type &servaddr = *receiver_endpoint.data();
+            if (WSAConnect(_sock_fd, (const struct sockaddr *)&servaddr, sizeof(servaddr), NULL, NULL, NULL, NULL) != 0){
+                throw uhd::os_error(str(boost::format("WSAConnect() failed with error %d") % WSAGetLastError()));
+            }
+
+            //register the buffer memory
+            _recv_buff_id = _rio.RIORegisterBuffer(_recv_mem(), DWORD(_num_recv_frames*_recv_frame_size));
+            _send_buff_id = _rio.RIORegisterBuffer(_send_mem(), DWORD(_num_send_frames*_send_frame_size));
+            if (_recv_buff_id == RIO_INVALID_BUFFERID or _send_buff_id == RIO_INVALID_BUFFERID){
+                throw uhd::os_error(str(boost::format("RIORegisterBuffer() failed with error %d") % WSAGetLastError()));
+            }
+
+            //completion queues with event notification and the request queue
+            _recv_event = WSACreateEvent();
+            _send_event = WSACreateEvent();
+            UHD_ASSERT_THROW(_recv_event != WSA_INVALID_EVENT and _send_event != WSA_INVALID_EVENT);
+            _recv_cq = make_cq(_num_recv_frames, _recv_event, _recv_notify);
+            _send_cq = make_cq(_num_send_frames, _send_event, _send_notify);
+            _rq = _rio.RIOCreateRequestQueue(_sock_fd,
+                ULONG(_num_recv_frames), 1, ULONG(_num_send_frames), 1, _recv_cq, _send_cq, NULL);
+            if (_rq == RIO_INVALID_RQ){
+                throw uhd::os_error(str(boost::format("RIOCreateRequestQueue() failed with error %d") % WSAGetLastError()));
+            }
+        }
+        catch(...){
+            cleanup();
+            throw;
+        }
+
+        //allocate re-usable managed receive buffers and post them all
+        for (size_t i = 0; i < get_num_recv_frames(); i++){
+            _mrb_pool.push_back(boost::shared_ptr<udp_zero_copy_rio_mrb>(
+                new udp_zero_copy_rio_mrb(*this, _recv_mem() + i*_recv_frame_size, i)
+            ));
+            post_recv(i);
+        }
+
+        //allocate re-usable managed send buffers, all of them free
+        for (size_t i = 0; i < get_num_send_frames(); i++){
+            _msb_pool.push_back(boost::shared_ptr<udp_zero_copy_rio_msb>(
+                new udp_zero_copy_rio_msb(*this, _send_mem() + i*_send_frame_size, i, get_send_frame_size())
+            ));
+            _free_send_frames.push_back(i);
+        }
+    }
+
+    ~udp_zero_copy_rio_impl(void){
+        cleanup();
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     * Hand out the next completion of the last batch, dequeue a new
+     * batch when it is used up, and only then wait on the event.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff;
+        if (_next_recv_result < _num_recv_results or dequeue_recv(timeout)){
+            const RIORESULT &result = _recv_results[_next_recv_result++];
+            const size_t index = size_t(result.RequestContext);
+            if (result.Status != 0){
+                post_recv(index);
+                throw uhd::io_error(str(boost::format("RIO receive failed with error %d") % result.Status));
+            }
+            buff = _mrb_pool[index]->get_new(result.BytesTransferred);
+        }
+        _stats.count_recv(buff);
+        return buff;
+    }
+
+    size_t get_num_recv_frames(void) const {return _num_recv_frames;}
+    size_t get_recv_frame_size(void) const {return _recv_frame_size;}
+
+    /*******************************************************************
+     * Send implementation:
+     * Take a free slot, reaping send completions in a batch when none
+     * are left, and only then wait on the event.
+     ******************************************************************/
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        managed_send_buffer::sptr buff;
+        if (not _free_send_frames.empty() or dequeue_send(timeout)){
+            const size_t index = _free_send_frames.back();
+            _free_send_frames.pop_back();
+            buff = _msb_pool[index]->get_new();
+        }
+        _stats.count_send(buff);
+        return buff;
+    }
+
+    size_t get_num_send_frames(void) const {return _num_send_frames;}
+    size_t get_send_frame_size(void) const {return _send_frame_size;}
+
+    zero_copy_stats_t get_stats(void) const {return _stats.get();}
+
+    //! Read back the socket's buffer space reserved for receives
+    size_t get_recv_buff_size(void) {
+        return get_sock_buff_size(_sock_fd, SO_RCVBUF);
+    }
+
+    //! Read back the socket's buffer space reserved for sends
+    size_t get_send_buff_size(void) {
+        return get_sock_buff_size(_sock_fd, SO_SNDBUF);
+    }
+
+    //! Post a receive slot to the socket
+    void post_recv(const size_t index){
+        RIO_BUF buf;
+        buf.BufferId = _recv_buff_id;
+        buf.Offset = ULONG(index*_recv_frame_size);
+        buf.Length = ULONG(_recv_frame_size);
+        boost::mutex::scoped_lock lock(_rq_mutex);
+        if (not _rio.RIOReceive(_rq, &buf, 1, 0, reinterpret_cast<PVOID>(index))){
+            throw uhd::io_error(str(boost::format("RIOReceive() failed with error %d") % WSAGetLastError()));
+        }
+    }
+
+    //! Post a send slot to the socket
+    void post_send(const size_t index, const size_t len){
+        RIO_BUF buf;
+        buf.BufferId = _send_buff_id;
+        buf.Offset = ULONG(index*_send_frame_size);
+        buf.Length = ULONG(len);
+        boost::mutex::scoped_lock lock(_rq_mutex);
+        if (not _rio.RIOSend(_rq, &buf, 1, 0, reinterpret_cast<PVOID>(index))){
+            throw uhd::io_error(str(boost::format("RIOSend() failed with error %d") % WSAGetLastError()));
+        }
+    }
+
+private:
+    UHD_INLINE char *_recv_mem(void) {return static_cast<char *>(_recv_buffer_pool->at(0));}
+    UHD_INLINE char *_send_mem(void) {return static_cast<char *>(_send_buffer_pool->at(0));}
+
+    RIO_CQ make_cq(const size_t depth, WSAEVENT event, RIO_NOTIFICATION_COMPLETION &notify){
+        std::memset(&notify, 0, sizeof(notify));
+        notify.Type = RIO_EVENT_COMPLETION;
+        notify.Event.EventHandle = event;
+        notify.Event.NotifyReset = TRUE;
+        const RIO_CQ cq = _rio.RIOCreateCompletionQueue(DWORD(depth), &notify);
+        if (cq == RIO_INVALID_CQ){
+            throw uhd::os_error(str(boost::format("RIOCreateCompletionQueue() failed with error %d") % WSAGetLastError()));
+        }
+        return cq;
+    }
+
+    /*!
+     * Dequeue completions from a queue into results, waiting up to the
+     * timeout when the queue is empty.
+     * \\return the number of completions (0 on timeout)
+     */
+    ULONG dequeue(RIO_CQ cq, WSAEVENT event, std::vector<RIORESULT> &results, const double timeout, const bool recv){
+        ULONG num = _rio.RIODequeueCompletion(cq, &results.front(), ULONG(results.size()));
+        if (num == 0){
+            if (not recv) _stats.count_send_pool_empty();
+            const time_spec_t wait_start = time_spec_t::get_system_time();
+            //arm the notification, then look again to not miss a completion
+            _rio.RIONotify(cq);
+            num = _rio.RIODequeueCompletion(cq, &results.front(), ULONG(results.size()));
+            if (num == 0 and WSAWaitForMultipleEvents(1, &event, true, DWORD(timeout*1000), true) == WSA_WAIT_EVENT_0){
+                num = _rio.RIODequeueCompletion(cq, &results.front(), ULONG(results.size()));
+            }
+            if (recv) _stats.add_recv_wait(wait_start);
+            else _stats.add_send_wait(wait_start);
+        }
+        if (num == RIO_CORRUPT_CQ) throw uhd::io_error("RIO completion queue is corrupt");
+        return num;
+    }
+
+    bool dequeue_recv(const double timeout){
+        _num_recv_results = dequeue(_recv_cq, _recv_event, _recv_results, timeout, true);
+        _next_recv_result = 0;
+        return _num_recv_results > 0;
+    }
+
+    bool dequeue_send(const double timeout){
+        const ULONG num = dequeue(_send_cq, _send_event, _send_results, timeout, false);
+        for (ULONG i = 0; i < num; i++){
+            _free_send_frames.push_back(size_t(_send_results[i].RequestContext));
+        }
+        return num > 0;
+    }
+
+    void cleanup(void){
+        //closing the socket cancels the outstanding requests and the request queue
+        if (_sock_fd != INVALID_SOCKET) closesocket(_sock_fd);
+        _sock_fd = INVALID_SOCKET;
+        if (_recv_cq != RIO_INVALID_CQ) _rio.RIOCloseCompletionQueue(_recv_cq);
+        if (_send_cq != RIO_INVALID_CQ) _rio.RIOCloseCompletionQueue(_send_cq);
+        _recv_cq = _send_cq = RIO_INVALID_CQ;
+        if (_recv_buff_id != RIO_INVALID_BUFFERID) _rio.RIODeregisterBuffer(_recv_buff_id);
+        if (_send_buff_id != RIO_INVALID_BUFFERID) _rio.RIODeregisterBuffer(_send_buff_id);
+        _recv_buff_id = _send_buff_id = RIO_INVALID_BUFFERID;
+        if (_recv_event != WSA_INVALID_EVENT) WSACloseEvent(_recv_event);
+        if (_send_event != WSA_INVALID_EVENT) WSACloseEvent(_send_event);
+        _recv_event = _send_event = WSA_INVALID_EVENT;
+    }
+
+    //memory management -> buffers and fifos
+    const size_t _recv_frame_size, _num_recv_frames;
+    const size_t _send_frame_size, _num_send_frames;
+    buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
+    std::vector<boost::shared_ptr<udp_zero_copy_rio_msb> > _msb_pool;
+    std::vector<boost::shared_ptr<udp_zero_copy_rio_mrb> > _mrb_pool;
+    zero_copy_stats_counter _stats;
+
+    //socket and registered I/O guts
+    SOCKET                          _sock_fd;
+    RIO_EXTENSION_FUNCTION_TABLE    _rio;
+    RIO_BUFFERID                    _recv_buff_id, _send_buff_id;
+    RIO_CQ                          _recv_cq, _send_cq;
+    RIO_RQ                          _rq;
+    WSAEVENT                        _recv_event, _send_event;
+    RIO_NOTIFICATION_COMPLETION     _recv_notify, _send_notify;
+    boost::mutex                    _rq_mutex;
+
+    //completions, only touched by the get_*_buff() caller of each side
+    std::vector<RIORESULT>          _recv_results;
+    size_t                          _num_recv_results, _next_recv_result;
+    std::vector<RIORESULT>          _send_results;
+    std::vector<size_t>             _free_send_frames;
+};
+
+void udp_zero_copy_rio_mrb::release(void){
+    _xport.post_recv(_index);
+}
+
+void udp_zero_copy_rio_msb::release(void){
+    _xport.post_send(_index, size());
+}
+#endif /*HAVE_WIN_RIO*/
+
 /***********************************************************************
  * UDP zero copy make function
  **********************************************************************/
@@ -346,11 +701,16 @@ udp_zero_copy::sptr udp_zero_copy::make(
     const std::string &port,
     const zero_copy_xport_params &default_buff_args,
     udp_zero_copy::buff_params& buff_params_out,
-    const device_addr_t &hints
+    const device_addr_t &hints,
+    const frame_pool::sptr &shared_frames
 ){
     //Initialize xport_params
     zero_copy_xport_params xport_params = default_buff_args;
 
+    if (shared_frames) {
+        UHD_LOG << "shared frame pool ignored: the WSA transport registers its own buffers" << std::endl;
+    }
+
     xport_params.recv_frame_size = size_t(hints.cast<double>("recv_frame_size", default_buff_args.recv_frame_size));
     xport_params.num_recv_frames = size_t(hints.cast<double>("num_recv_frames", default_buff_args.num_recv_frames));
     xport_params.send_frame_size = size_t(hints.cast<double>("send_frame_size", default_buff_args.send_frame_size));
@@ -374,6 +734,28 @@ udp_zero_copy::sptr udp_zero_copy::make(
         }
     }
 
+    #ifdef HAVE_WIN_RIO
+    //Registered I/O unless disabled, overlapped WSA when it is not available
+    if (hints.cast<int>("rio", 1) != 0) {
+        try {
+            udp_zero_copy_rio_impl::sptr udp_trans(
+                new udp_zero_copy_rio_impl(addr, port, xport_params, hints)
+            );
+
+            // Read back the actual socket buffer sizes
+            buff_params_out.recv_buff_size = udp_trans->get_recv_buff_size();
+            buff_params_out.send_buff_size = udp_trans->get_send_buff_size();
+            check_usr_buff_size(buff_params_out.recv_buff_size, usr_recv_buff_size, "recv");
+            check_usr_buff_size(buff_params_out.send_buff_size, usr_send_buff_size, "send");
+
+            return udp_trans;
+        }
+        catch(const uhd::os_error &e) {
+            UHD_LOG << "Falling back to the overlapped WSA UDP transport: " << e.what() << std::endl;
+        }
+    }
+    #endif /*HAVE_WIN_RIO*/
+
     udp_zero_copy_wsa_impl::sptr udp_trans(
         new udp_zero_copy_wsa_impl(addr, port, xport_params, hints)
     );
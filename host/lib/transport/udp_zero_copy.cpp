@@ -16,16 +16,32 @@
 //
 
 #include "udp_common.hpp"
+#include "zero_copy_stats.hpp"
 #include <uhd/transport/udp_zero_copy.hpp>
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include <uhd/transport/buffer_pool.hpp>
+#include <uhd/transport/frame_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/atomic.hpp>
+#include <uhd/utils/trace.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <algorithm>
+#include <cstring>
 #include <vector>
+#ifdef HAVE_RECVMMSG
+#include <sys/socket.h> //recvmmsg
+#include <sys/uio.h> //iovec
+#endif /*HAVE_RECVMMSG*/
+
+//per-packet kernel arrival time and socket drop counter (Linux)
+#if defined(SO_RXQ_OVFL) && defined(SO_TIMESTAMPNS)
+#define UDP_RECV_KERNEL_INFO
+#include <sys/socket.h> //recvmsg, cmsg
+#include <time.h> //clock_gettime
+#endif
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -34,6 +50,9 @@ namespace asio = boost::asio;
 //A reasonable number of frames for send/recv and async/sync
 //static const size_t DEFAULT_NUM_FRAMES = 32;
 
+//Frames a transport keeps of a shared frame pool, per direction
+static const size_t DEFAULT_SHARED_FRAMES_RESERVE = 8;
+
 /***********************************************************************
  * Check registry for correct fast-path setting (windows only)
  **********************************************************************/
@@ -64,29 +83,39 @@ static void check_registry_for_fast_send_threshold(const size_t mtu){
 /***********************************************************************
  * Reusable managed receiver buffer:
  *  - get_new performs the recv operation
+ *  - without memory of its own, it borrows a frame of the shared
+ *    frame pool while it is claimed
  **********************************************************************/
 class udp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _len(0) { /*NOP*/ }
+    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size, frame_pool *shared_frames = NULL):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _len(0), _pending(false),
+        _kernel_info(false), _spin(false), _shared_frames((mem == NULL)? shared_frames : NULL) { /*NOP*/ }
 
     void release(void){
+        if (_shared_frames != NULL){
+            _shared_frames->free(_mem);
+            _mem = NULL;
+        }
         _claimer.release();
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+    UHD_INLINE sptr get_new(const double timeout, size_t &index, zero_copy_stats_counter &stats){
+        if (not this->claim(timeout, stats)) return sptr();
 
         #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
-        _len = ::recv(_sock_fd, (char *)_mem, _frame_size, MSG_DONTWAIT);
+        _len = this->recv(MSG_DONTWAIT);
         if (_len > 0){
             index++; //advances the caller's buffer
             return make(this, _mem, size_t(_len));
         }
         #endif
 
-        if (wait_for_recv_ready(_sock_fd, timeout)){
-            _len = ::recv(_sock_fd, (char *)_mem, _frame_size, 0);
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        const bool ready = _spin? spin_for_recv_ready(_sock_fd, timeout) : wait_for_recv_ready(_sock_fd, timeout);
+        stats.add_recv_wait(wait_start);
+        if (ready){
+            _len = this->recv(0);
             if (_len == 0)
                 throw uhd::io_error("socket closed");
             if (_len < 0)
@@ -95,16 +124,163 @@ public:
             return make(this, _mem, size_t(_len));
         }
 
-        _claimer.release(); //undo claim
+        this->release(); //undo claim
         return sptr(); //null for timeout
     }
 
+    /*******************************************************************
+     * Batched receive support:
+     * The transport claims a window of buffers, fills them with one
+     * recvmmsg() call, and hands them out one at a time afterwards.
+     ******************************************************************/
+    UHD_INLINE bool claim(const double timeout, zero_copy_stats_counter &stats){
+        if (not _claimer.try_claim()){
+            stats.count_recv_pool_empty();
+            if (not _claimer.claim_with_wait(timeout)) return false;
+        }
+        if (_mem != NULL) return true;
+
+        //borrow a frame, wait for one when the shared pool is empty
+        _mem = _shared_frames->alloc();
+        if (_mem == NULL){
+            stats.count_recv_pool_empty();
+            _mem = _shared_frames->alloc(timeout);
+        }
+        if (_mem != NULL) return true;
+        _claimer.release();
+        return false;
+    }
+
+    UHD_INLINE bool try_claim(void){
+        if (not _claimer.try_claim()) return false;
+        if (_mem == NULL) _mem = _shared_frames->alloc();
+        if (_mem != NULL) return true;
+        _claimer.release();
+        return false;
+    }
+
+    UHD_INLINE void *mem(void) const{
+        return _mem;
+    }
+
+    UHD_INLINE size_t frame_size(void) const{
+        return _frame_size;
+    }
+
+    //! Mark this (claimed) buffer as filled by a batched receive
+    UHD_INLINE void set_pending(const size_t len){
+        _len = ssize_t(len);
+        _pending = true;
+    }
+
+    UHD_INLINE bool has_pending(void) const{
+        return _pending;
+    }
+
+    //! Wait for data by polling the socket instead of sleeping in the kernel
+    UHD_INLINE void enable_spin(void){
+        _spin = true;
+    }
+
+#ifdef UDP_RECV_KERNEL_INFO
+    /*******************************************************************
+     * Kernel receive info:
+     * With SO_TIMESTAMPNS and SO_RXQ_OVFL enabled on the socket, each
+     * datagram carries its arrival time and the socket drop counter as
+     * control messages, which are kept with the buffer. They stay out of
+     * the public managed_recv_buffer, only the transport reads them.
+     ******************************************************************/
+    UHD_INLINE void enable_kernel_info(void){
+        _kernel_info = true;
+        _arrival_time_ns = 0;
+        _kernel_drops = 0;
+    }
+
+    UHD_INLINE bool has_kernel_info(void) const{
+        return _kernel_info;
+    }
+
+    //! The time the kernel received the packet (CLOCK_REALTIME), 0 if unknown
+    UHD_INLINE int64_t arrival_time_ns(void) const{
+        return _arrival_time_ns;
+    }
+
+    //! The running count of packets the kernel dropped on the socket
+    UHD_INLINE uint32_t kernel_drops(void) const{
+        return _kernel_drops;
+    }
+
+    UHD_INLINE void *control(void){
+        return _control.buf;
+    }
+
+    UHD_INLINE size_t control_size(void) const{
+        return sizeof(_control.buf);
+    }
+
+    //! Extract the kernel info from the control messages of a receive
+    UHD_INLINE void set_kernel_info(const msghdr &msg){
+        _arrival_time_ns = 0;
+        _kernel_drops = 0;
+        for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(const_cast<msghdr *>(&msg), cm)){
+            if (cm->cmsg_level != SOL_SOCKET) continue;
+            if (cm->cmsg_type == SCM_TIMESTAMPNS){
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(cm), sizeof(ts));
+                _arrival_time_ns = int64_t(ts.tv_sec)*1000000000 + ts.tv_nsec;
+            }
+            else if (cm->cmsg_type == SO_RXQ_OVFL){
+                std::memcpy(&_kernel_drops, CMSG_DATA(cm), sizeof(_kernel_drops));
+            }
+        }
+    }
+#endif /*UDP_RECV_KERNEL_INFO*/
+
+    //! Hand out a buffer that was filled by a batched receive
+    UHD_INLINE sptr get_pending(size_t &index){
+        _pending = false;
+        index++; //advances the caller's buffer
+        return make(this, _mem, size_t(_len));
+    }
+
 private:
+    UHD_INLINE ssize_t recv(const int flags){
+        #ifdef UDP_RECV_KERNEL_INFO
+        if (_kernel_info){
+            iovec iov;
+            iov.iov_base = _mem;
+            iov.iov_len = _frame_size;
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = _control.buf;
+            msg.msg_controllen = sizeof(_control.buf);
+            const ssize_t len = ::recvmsg(_sock_fd, &msg, flags);
+            if (len > 0) set_kernel_info(msg);
+            return len;
+        }
+        #endif /*UDP_RECV_KERNEL_INFO*/
+        return ::recv(_sock_fd, (char *)_mem, _frame_size, flags);
+    }
+
     void *_mem;
     int _sock_fd;
     size_t _frame_size;
     ssize_t _len;
+    bool _pending;
+    bool _kernel_info;
+    bool _spin;
+    frame_pool *_shared_frames; //NULL when the buffer has its own memory
     simple_claimer _claimer;
+#ifdef UDP_RECV_KERNEL_INFO
+    int64_t _arrival_time_ns;
+    uint32_t _kernel_drops;
+    union{
+        cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+    } _control;
+#endif /*UDP_RECV_KERNEL_INFO*/
 };
 
 /***********************************************************************
@@ -113,8 +289,9 @@ private:
  **********************************************************************/
 class udp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size, frame_pool *shared_frames = NULL):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size),
+        _shared_frames((mem == NULL)? shared_frames : NULL) { /*NOP*/ }
 
     void release(void){
         //Retry logic because send may fail with ENOBUFS.
@@ -135,22 +312,72 @@ public:
             }
             UHD_ASSERT_THROW(ret == ssize_t(size()));
         }
+        if (_shared_frames != NULL){
+            _shared_frames->free(_mem);
+            _mem = NULL;
+        }
         _claimer.release();
     }
 
-    UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+    UHD_INLINE sptr get_new(const double timeout, size_t &index, zero_copy_stats_counter &stats){
+        if (not _claimer.try_claim()){
+            stats.count_send_pool_empty();
+            const time_spec_t wait_start = time_spec_t::get_system_time();
+            const bool claimed = _claimer.claim_with_wait(timeout);
+            stats.add_send_wait(wait_start);
+            if (not claimed) return sptr();
+        }
+        if (_mem == NULL and not this->borrow(timeout, stats)){
+            _claimer.release();
+            return sptr();
+        }
         index++; //advances the caller's buffer
         return make(this, _mem, _frame_size);
     }
 
 private:
+    //! Borrow a frame of the shared pool, wait for one when it is empty
+    UHD_INLINE bool borrow(const double timeout, zero_copy_stats_counter &stats){
+        _mem = _shared_frames->alloc();
+        if (_mem != NULL) return true;
+        stats.count_send_pool_empty();
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        _mem = _shared_frames->alloc(timeout);
+        stats.add_send_wait(wait_start);
+        return _mem != NULL;
+    }
+
     void *_mem;
     int _sock_fd;
     size_t _frame_size;
+    frame_pool *_shared_frames; //NULL when the buffer has its own memory
     simple_claimer _claimer;
 };
 
+/***********************************************************************
+ * Frames a transport keeps of a shared frame pool, given back when
+ * the transport is destroyed (or fails to construct)
+ **********************************************************************/
+struct udp_zero_copy_reserved_frames{
+    ~udp_zero_copy_reserved_frames(void){
+        for (size_t i = 0; i < frames.size(); i++) pool->free(frames[i]);
+    }
+
+    //! Take a frame to keep, throw when the pool has none left
+    void *reserve(void){
+        void *frame = pool->alloc();
+        if (frame == NULL) throw uhd::runtime_error(str(boost::format(
+            "udp_zero_copy: all %u frames of the shared frame pool are in use, "
+            "none left to reserve for a new transport (see shared_frames_reserve)"
+        ) % pool->get_num_frames()));
+        frames.push_back(frame);
+        return frame;
+    }
+
+    frame_pool::sptr pool;
+    std::vector<void *> frames;
+};
+
 /***********************************************************************
  * Zero Copy UDP implementation with ASIO:
  *   This is the portable zero copy implementation for systems
@@ -165,18 +392,35 @@ public:
     udp_zero_copy_asio_impl(
         const std::string &addr,
         const std::string &port,
-        const zero_copy_xport_params& xport_params
+        const zero_copy_xport_params& xport_params,
+        const size_t recv_batch_size = 1,
+        const buffer_pool::alloc_policy_t &alloc_policy = buffer_pool::alloc_policy_t(),
+        const frame_pool::sptr &shared_frames = frame_pool::sptr(),
+        const size_t num_reserved = 0
     ):
         _recv_frame_size(xport_params.recv_frame_size),
         _num_recv_frames(xport_params.num_recv_frames),
         _send_frame_size(xport_params.send_frame_size),
         _num_send_frames(xport_params.num_send_frames),
-        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size)),
-        _next_recv_buff_index(0), _next_send_buff_index(0)
+        _recv_buffer_pool(shared_frames? buffer_pool::sptr() :
+            buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size, 16, alloc_policy)),
+        _send_buffer_pool(shared_frames? buffer_pool::sptr() :
+            buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size, 16, alloc_policy)),
+        _next_recv_buff_index(0), _next_send_buff_index(0),
+        _recv_batch_size(std::max<size_t>(1, std::min(recv_batch_size, xport_params.num_recv_frames))),
+        _recv_kernel_info(false),
+        _kernel_drops(0),
+        _recv_spin(false)
     {
         UHD_LOG << boost::format("Creating udp transport for %s %s") % addr % port << std::endl;
 
+        _reserved_frames.pool = shared_frames;
+        if (shared_frames and shared_frames->get_frame_size() < std::max(_recv_frame_size, _send_frame_size)){
+            throw uhd::value_error(str(boost::format(
+                "udp_zero_copy: the shared frames (%u bytes) are smaller than the frames of the transport (%u bytes)"
+            ) % shared_frames->get_frame_size() % std::max(_recv_frame_size, _send_frame_size)));
+        }
+
         #ifdef CHECK_REG_SEND_THRESH
         check_registry_for_fast_send_threshold(this->get_send_frame_size());
         #endif /*CHECK_REG_SEND_THRESH*/
@@ -195,18 +439,34 @@ public:
         //allocate re-usable managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::make_shared<udp_zero_copy_asio_mrb>(
-                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size()
+                get_frame(_recv_buffer_pool, i, num_reserved), _sock_fd, get_recv_frame_size(), shared_frames.get()
             ));
         }
 
+        #ifdef HAVE_RECVMMSG
+        _recv_msgs.resize(_recv_batch_size);
+        _recv_iovs.resize(_recv_batch_size);
+        #else
+        if (_recv_batch_size > 1){
+            UHD_LOG << "recv_batch_size ignored: recvmmsg() is not available on this platform" << std::endl;
+            _recv_batch_size = 1;
+        }
+        #endif /*HAVE_RECVMMSG*/
+
         //allocate re-usable managed send buffers
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(boost::make_shared<udp_zero_copy_asio_msb>(
-                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size()
+                get_frame(_send_buffer_pool, i, num_reserved), _sock_fd, get_send_frame_size(), shared_frames.get()
             ));
         }
     }
 
+    //the memory of a buffer: its own, reserved of the shared pool, or NULL to borrow
+    void *get_frame(const buffer_pool::sptr &pool, const size_t index, const size_t num_reserved){
+        if (pool) return pool->at(index);
+        return (index < num_reserved)? _reserved_frames.reserve() : NULL;
+    }
+
     //get size for internal socket buffer
     template <typename Opt> size_t get_buff_size(void) const{
         Opt option;
@@ -221,14 +481,203 @@ public:
         return get_buff_size<Opt>();
     }
 
+    //steer the receive processing of this socket to a CPU
+    void set_incoming_cpu(const int cpu){
+        #ifdef SO_INCOMING_CPU
+        typedef asio::detail::socket_option::integer<SOL_SOCKET, SO_INCOMING_CPU> incoming_cpu_t;
+        boost::system::error_code ec;
+        _socket->set_option(incoming_cpu_t(cpu), ec);
+        if (ec) UHD_MSG(warning) << boost::format(
+            "Could not set SO_INCOMING_CPU=%d on the UDP socket: %s"
+        ) % cpu % ec.message() << std::endl;
+        #else
+        UHD_MSG(warning) << "recv_cpu: SO_INCOMING_CPU is not supported on this platform" << std::endl;
+        (void)cpu;
+        #endif
+    }
+
+    //set a socket option given as an integer, warn if the kernel refuses it
+    template <typename Opt> void set_int_option(const int value, const std::string &name){
+        boost::system::error_code ec;
+        _socket->set_option(Opt(value), ec);
+        if (ec) UHD_MSG(warning) << boost::format(
+            "Could not set %s=%d on the UDP socket: %s"
+        ) % name % value % ec.message() << std::endl;
+    }
+
+    //prioritize the packets of this socket over those of other sockets
+    void set_priority(const int priority){
+        #ifdef SO_PRIORITY
+        set_int_option<asio::detail::socket_option::integer<SOL_SOCKET, SO_PRIORITY> >(priority, "SO_PRIORITY");
+        #else
+        UHD_MSG(warning) << "priority: SO_PRIORITY is not supported on this platform" << std::endl;
+        (void)priority;
+        #endif
+    }
+
+    //mark outgoing packets with a DSCP code point, for switches along the way
+    void set_dscp(const int dscp){
+        #ifdef IP_TOS
+        set_int_option<asio::detail::socket_option::integer<IPPROTO_IP, IP_TOS> >(dscp << 2, "IP_TOS");
+        #else
+        UHD_MSG(warning) << "dscp: IP_TOS is not supported on this platform" << std::endl;
+        (void)dscp;
+        #endif
+    }
+
+    //busy-poll the device queue on a blocking receive, for this many microseconds
+    void set_busy_poll(const int usecs){
+        #ifdef SO_BUSY_POLL
+        set_int_option<asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL> >(usecs, "SO_BUSY_POLL");
+        #else
+        UHD_MSG(warning) << "busy_poll: SO_BUSY_POLL is not supported on this platform" << std::endl;
+        (void)usecs;
+        #endif
+    }
+
+    //let busy-polling receives keep the NIC queue, instead of its interrupts
+    void set_prefer_busy_poll(const int enb){
+        #ifdef SO_PREFER_BUSY_POLL
+        set_int_option<asio::detail::socket_option::integer<SOL_SOCKET, SO_PREFER_BUSY_POLL> >(enb, "SO_PREFER_BUSY_POLL");
+        #else
+        UHD_MSG(warning) << "prefer_busy_poll: SO_PREFER_BUSY_POLL is not supported on this platform" << std::endl;
+        (void)enb;
+        #endif
+    }
+
+    //wait for receive data by spinning on the socket, never sleep
+    void enable_recv_spin(void){
+        _recv_spin = true;
+        for (size_t i = 0; i < _mrb_pool.size(); i++) _mrb_pool[i]->enable_spin();
+    }
+
+    //ask the kernel for per-packet arrival times and drop counts
+    void enable_kernel_recv_info(void){
+        #ifdef UDP_RECV_KERNEL_INFO
+        const int one = 1;
+        if (::setsockopt(_sock_fd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) != 0
+            or ::setsockopt(_sock_fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) != 0){
+            UHD_LOG << boost::format(
+                "Could not enable SO_TIMESTAMPNS/SO_RXQ_OVFL on the UDP socket: %s"
+            ) % strerror(errno) << std::endl;
+            return;
+        }
+        _recv_kernel_info = true;
+        for (size_t i = 0; i < _mrb_pool.size(); i++) _mrb_pool[i]->enable_kernel_info();
+        #endif /*UDP_RECV_KERNEL_INFO*/
+    }
+
     /*******************************************************************
      * Receive implementation:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
+        UHD_TRACE_SPAN("udp_recv");
         if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        const size_t index = _next_recv_buff_index; //the buffer handed out, if any
+        managed_recv_buffer::sptr buff;
+        #ifdef HAVE_RECVMMSG
+        if (_recv_batch_size > 1) buff = get_recv_buff_batched(timeout);
+        else
+        #endif /*HAVE_RECVMMSG*/
+        buff = _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index, _stats);
+        _stats.count_recv(buff);
+        #ifdef UDP_RECV_KERNEL_INFO
+        if (_recv_kernel_info and buff) count_kernel_info(*_mrb_pool[index]);
+        #endif /*UDP_RECV_KERNEL_INFO*/
+        return buff;
+    }
+
+#ifdef UDP_RECV_KERNEL_INFO
+    //! Track the socket drop counter and the arrival to hand-out latency
+    UHD_INLINE void count_kernel_info(const udp_zero_copy_asio_mrb &buff){
+        _stats.set_kernel_drops(buff.kernel_drops());
+        if (buff.kernel_drops() != _kernel_drops){
+            //tells a too small recv_buff_size apart from drops on the link
+            UHD_LOG << boost::format("The host kernel dropped %u packets on the UDP socket (recv_buff_size)")
+                % (buff.kernel_drops() - _kernel_drops) << std::endl;
+            _kernel_drops = buff.kernel_drops();
+        }
+        if (buff.arrival_time_ns() == 0) return;
+        timespec now;
+        ::clock_gettime(CLOCK_REALTIME, &now);
+        const int64_t now_ns = int64_t(now.tv_sec)*1000000000 + now.tv_nsec;
+        if (now_ns > buff.arrival_time_ns()) _stats.add_recv_latency(uint64_t(now_ns - buff.arrival_time_ns()));
     }
+#endif /*UDP_RECV_KERNEL_INFO*/
+
+#ifdef HAVE_RECVMMSG
+    /*******************************************************************
+     * Batched receive implementation:
+     * Hand out a frame left over from the last recvmmsg() call, or
+     * claim the next run of free buffers and fill them in one syscall.
+     * The window never wraps around the end of the pool, so the frames
+     * are still handed out in pool order, one managed buffer each.
+     ******************************************************************/
+    UHD_INLINE managed_recv_buffer::sptr get_recv_buff_batched(const double timeout){
+        const size_t first = _next_recv_buff_index;
+        udp_zero_copy_asio_mrb &head = *_mrb_pool[first];
+        if (head.has_pending()) return head.get_pending(_next_recv_buff_index);
+
+        //the head of the window may block, the rest are taken if free
+        if (not head.claim(timeout, _stats)) return managed_recv_buffer::sptr();
+        size_t num_claimed = 1;
+        const size_t max_claim = std::min(_recv_batch_size, _num_recv_frames - first);
+        while (num_claimed < max_claim and _mrb_pool[first + num_claimed]->try_claim()){
+            num_claimed++;
+        }
+
+        for (size_t i = 0; i < num_claimed; i++){
+            udp_zero_copy_asio_mrb &mrb = *_mrb_pool[first + i];
+            _recv_iovs[i].iov_base = mrb.mem();
+            _recv_iovs[i].iov_len = mrb.frame_size();
+            std::memset(&_recv_msgs[i], 0, sizeof(mmsghdr));
+            _recv_msgs[i].msg_hdr.msg_iov = &_recv_iovs[i];
+            _recv_msgs[i].msg_hdr.msg_iovlen = 1;
+            #ifdef UDP_RECV_KERNEL_INFO
+            if (mrb.has_kernel_info()){
+                _recv_msgs[i].msg_hdr.msg_control = mrb.control();
+                _recv_msgs[i].msg_hdr.msg_controllen = mrb.control_size();
+            }
+            #endif /*UDP_RECV_KERNEL_INFO*/
+        }
+
+        //try a non-blocking receive first, then wait for the socket
+        int num_recvd = ::recvmmsg(_sock_fd, &_recv_msgs.front(), num_claimed, MSG_DONTWAIT, NULL);
+        if (num_recvd < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)){
+            const time_spec_t wait_start = time_spec_t::get_system_time();
+            const bool ready = _recv_spin?
+                spin_for_recv_ready(_sock_fd, timeout) : wait_for_recv_ready(_sock_fd, timeout);
+            _stats.add_recv_wait(wait_start);
+            if (ready){
+                num_recvd = ::recvmmsg(_sock_fd, &_recv_msgs.front(), num_claimed, MSG_DONTWAIT, NULL);
+            }
+            else num_recvd = 0; //timeout
+        }
+        if (num_recvd < 0){
+            const int err = errno;
+            for (size_t i = 0; i < num_claimed; i++) _mrb_pool[first + i]->release();
+            throw uhd::io_error(str(boost::format("recvmmsg error on socket: %s") % strerror(err)));
+        }
+        if (num_recvd > 0 and _recv_msgs[0].msg_len == 0){
+            for (size_t i = 0; i < num_claimed; i++) _mrb_pool[first + i]->release();
+            throw uhd::io_error("socket closed");
+        }
+
+        //mark the filled frames, undo the claims on the rest
+        for (size_t i = 0; i < num_claimed; i++){
+            if (i < size_t(num_recvd)){
+                _mrb_pool[first + i]->set_pending(_recv_msgs[i].msg_len);
+                #ifdef UDP_RECV_KERNEL_INFO
+                if (_recv_kernel_info) _mrb_pool[first + i]->set_kernel_info(_recv_msgs[i].msg_hdr);
+                #endif /*UDP_RECV_KERNEL_INFO*/
+            }
+            else _mrb_pool[first + i]->release();
+        }
+        if (num_recvd == 0) return managed_recv_buffer::sptr(); //null for timeout
+        return head.get_pending(_next_recv_buff_index);
+    }
+#endif /*HAVE_RECVMMSG*/
 
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
     size_t get_recv_frame_size(void) const {return _recv_frame_size;}
@@ -238,21 +687,36 @@ public:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
+        UHD_TRACE_SPAN("udp_get_send_buff");
         if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index, _stats);
+        _stats.count_send(buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    zero_copy_stats_t get_stats(void) const {return _stats.get();}
+
 private:
     //memory management -> buffers and fifos
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
     buffer_pool::sptr _recv_buffer_pool, _send_buffer_pool;
+    udp_zero_copy_reserved_frames _reserved_frames;
     std::vector<boost::shared_ptr<udp_zero_copy_asio_msb> > _msb_pool;
     std::vector<boost::shared_ptr<udp_zero_copy_asio_mrb> > _mrb_pool;
     size_t _next_recv_buff_index, _next_send_buff_index;
+    size_t _recv_batch_size;
+    bool _recv_kernel_info;
+    uint32_t _kernel_drops; //last socket drop count seen
+    bool _recv_spin;
+    zero_copy_stats_counter _stats;
+#ifdef HAVE_RECVMMSG
+    std::vector<mmsghdr> _recv_msgs;
+    std::vector<iovec> _recv_iovs;
+#endif /*HAVE_RECVMMSG*/
 
     //asio guts -> socket and service
     asio::io_service        _io_service;
@@ -299,7 +763,8 @@ udp_zero_copy::sptr udp_zero_copy::make(
     const std::string &port,
     const zero_copy_xport_params &default_buff_args,
     udp_zero_copy::buff_params& buff_params_out,
-    const device_addr_t &hints
+    const device_addr_t &hints,
+    const frame_pool::sptr &shared_frames
 ){
     //Initialize xport_params
     zero_copy_xport_params xport_params = default_buff_args;
@@ -309,6 +774,12 @@ udp_zero_copy::sptr udp_zero_copy::make(
     xport_params.send_frame_size = size_t(hints.cast<double>("send_frame_size", default_buff_args.send_frame_size));
     xport_params.num_send_frames = size_t(hints.cast<double>("num_send_frames", default_buff_args.num_send_frames));
 
+    //number of frames to fill per recvmmsg() call (1 disables batching)
+    const size_t recv_batch_size = size_t(hints.cast<double>("recv_batch_size", 1));
+
+    //frames kept of the shared frame pool per direction, the others are borrowed
+    const size_t shared_frames_reserve = size_t(hints.cast<double>("shared_frames_reserve", DEFAULT_SHARED_FRAMES_RESERVE));
+
     //extract buffer size hints from the device addr
     size_t usr_recv_buff_size = size_t(hints.cast<double>("recv_buff_size", xport_params.num_recv_frames * MAX_ETHERNET_MTU));
     size_t usr_send_buff_size = size_t(hints.cast<double>("send_buff_size", xport_params.num_send_frames * MAX_ETHERNET_MTU));
@@ -330,7 +801,8 @@ udp_zero_copy::sptr udp_zero_copy::make(
     }
 
     udp_zero_copy_asio_impl::sptr udp_trans(
-        new udp_zero_copy_asio_impl(addr, port, xport_params)
+        new udp_zero_copy_asio_impl(addr, port, xport_params, recv_batch_size,
+            buffer_pool::alloc_policy_t::from_hints(hints), shared_frames, shared_frames_reserve)
     );
 
     //call the helper to resize send and recv buffers
@@ -339,5 +811,35 @@ udp_zero_copy::sptr udp_zero_copy::make(
     buff_params_out.send_buff_size =
         resize_buff_helper<asio::socket_base::send_buffer_size>   (udp_trans, usr_send_buff_size, "send");
 
+    //per-packet arrival time and kernel drop counter, off by default since
+    //it costs a recvmsg() and a clock read per packet
+    if (hints.cast<int>("recv_kernel_info", 0) != 0) {
+        udp_trans->enable_kernel_recv_info();
+    }
+
+    //process packets for this socket on the CPU that also runs its streamer
+    if (hints.has_key("recv_cpu")) {
+        udp_trans->set_incoming_cpu(hints.cast<int>("recv_cpu", -1));
+    }
+
+    //latency sensitive traffic (e.g. control) can jump the queues of bulk data
+    if (hints.has_key("priority")) {
+        udp_trans->set_priority(hints.cast<int>("priority", 0));
+    }
+    if (hints.has_key("dscp")) {
+        udp_trans->set_dscp(hints.cast<int>("dscp", 0));
+    }
+    if (hints.has_key("busy_poll")) {
+        udp_trans->set_busy_poll(hints.cast<int>("busy_poll", 0));
+    }
+    if (hints.has_key("prefer_busy_poll")) {
+        udp_trans->set_prefer_busy_poll(hints.cast<int>("prefer_busy_poll", 0));
+    }
+
+    //trade a CPU for the wake-up latency of a blocking receive
+    if (hints.cast<int>("recv_spin", 0) != 0) {
+        udp_trans->enable_recv_spin();
+    }
+
     return udp_trans;
 }
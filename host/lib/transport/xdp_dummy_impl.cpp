@@ -0,0 +1,40 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/xdp_zero_copy.hpp>
+#include <uhd/exception.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+bool xdp_zero_copy::is_supported(void){
+    return false;
+}
+
+size_t xdp_zero_copy::max_frame_size(void){
+    return 0;
+}
+
+xdp_zero_copy::sptr xdp_zero_copy::make(
+    const std::string &,
+    const std::string &,
+    const zero_copy_xport_params &,
+    udp_zero_copy::buff_params &,
+    const device_addr_t &
+){
+    throw uhd::not_implemented_error("no AF_XDP support -> xdp_zero_copy::make not implemented");
+}
@@ -0,0 +1,583 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zero_copy_stats.hpp"
+#include <uhd/transport/xdp_zero_copy.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <xdp/xsk.h>
+#include <boost/asio.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp> //sleep
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <linux/bpf.h> //XDP_PACKET_HEADROOM
+#include <linux/if_ether.h>
+#include <linux/if_xdp.h> //XDP_STATISTICS
+#include <net/if.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <ifaddrs.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+//! Every frame occupies one UMEM chunk
+static const size_t XDP_CHUNK_SIZE = XSK_UMEM__DEFAULT_FRAME_SIZE;
+
+//! Bytes of Ethernet + IPv4 + UDP headers in front of the payload
+static const size_t XDP_HDR_SIZE = sizeof(ethhdr) + sizeof(iphdr) + sizeof(udphdr);
+
+//! Usable payload per chunk once the kernel headroom is taken off
+static const size_t XDP_MAX_FRAME_SIZE = XDP_CHUNK_SIZE - XDP_PACKET_HEADROOM - XDP_HDR_SIZE;
+
+static size_t round_up_pow2(const size_t n){
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/***********************************************************************
+ * Network helpers
+ **********************************************************************/
+//! Find the interface (and its IPv4 address) that reaches remote_ip
+static std::string find_iface(
+    const std::string &iface_hint,
+    const asio::ip::address_v4 &remote_ip,
+    asio::ip::address_v4 &local_ip
+){
+    std::string iface_name;
+    struct ifaddrs *ifap;
+    if (getifaddrs(&ifap) != 0){
+        throw uhd::os_error(str(boost::format("getifaddrs failed: %s") % strerror(errno)));
+    }
+    for (struct ifaddrs *iter = ifap; iter != NULL; iter = iter->ifa_next){
+        if (iter->ifa_addr == NULL or iter->ifa_netmask == NULL) continue;
+        if (iter->ifa_addr->sa_family != AF_INET) continue;
+        const uint32_t addr = ntohl(reinterpret_cast<sockaddr_in*>(iter->ifa_addr)->sin_addr.s_addr);
+        const uint32_t mask = ntohl(reinterpret_cast<sockaddr_in*>(iter->ifa_netmask)->sin_addr.s_addr);
+        const bool match = iface_hint.empty()?
+            ((addr & mask) == (remote_ip.to_ulong() & mask)) : (iface_hint == iter->ifa_name);
+        if (match){
+            iface_name = iter->ifa_name;
+            local_ip = asio::ip::address_v4(addr);
+            break;
+        }
+    }
+    freeifaddrs(ifap);
+    if (iface_name.empty()) throw uhd::lookup_error(str(boost::format(
+        "xdp_zero_copy: no IPv4 interface found for %s%s"
+    ) % remote_ip.to_string() % (iface_hint.empty()? "" : " on " + iface_hint)));
+    return iface_name;
+}
+
+static void get_iface_mac(const std::string &iface, uint8_t mac[ETH_ALEN]){
+    ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, iface.c_str(), IFNAMSIZ-1);
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    const int ret = (fd < 0)? -1 : ::ioctl(fd, SIOCGIFHWADDR, &ifr);
+    if (fd >= 0) ::close(fd);
+    if (ret < 0) throw uhd::os_error(str(boost::format(
+        "xdp_zero_copy: cannot read the MAC address of %s") % iface));
+    std::memcpy(mac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+}
+
+//! Look up the neighbour MAC address in the kernel ARP table
+static bool lookup_arp(const std::string &ip, const std::string &iface, uint8_t mac[ETH_ALEN]){
+    std::ifstream arp("/proc/net/arp");
+    std::string line;
+    std::getline(arp, line); //header
+    while (std::getline(arp, line)){
+        std::vector<std::string> toks;
+        boost::split(toks, line, boost::is_any_of(" "), boost::token_compress_on);
+        //IP address, HW type, Flags, HW address, Mask, Device
+        if (toks.size() < 6 or toks[0] != ip or toks[5] != iface) continue;
+        unsigned int m[ETH_ALEN];
+        if (std::sscanf(toks[3].c_str(), "%x:%x:%x:%x:%x:%x",
+                &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != ETH_ALEN) continue;
+        bool all_zero = true;
+        for (size_t i = 0; i < ETH_ALEN; i++){
+            mac[i] = uint8_t(m[i]);
+            if (m[i] != 0) all_zero = false;
+        }
+        if (not all_zero) return true; //incomplete entries are all zeros
+    }
+    return false;
+}
+
+static uint16_t ip_checksum(const iphdr *hdr){
+    const uint16_t *words = reinterpret_cast<const uint16_t *>(hdr);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < sizeof(iphdr)/2; i++) sum += words[i];
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return uint16_t(~sum);
+}
+
+/***********************************************************************
+ * Reusable managed receive buffer:
+ *  - points into a UMEM chunk past the packet headers
+ *  - release hands the chunk back to the kernel via the fill ring
+ **********************************************************************/
+class xdp_zero_copy_impl;
+
+class xdp_zero_copy_mrb : public managed_recv_buffer{
+public:
+    xdp_zero_copy_mrb(xdp_zero_copy_impl *xport, const uint64_t chunk_addr):
+        _xport(xport), _chunk_addr(chunk_addr) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len){
+        return make(this, mem, len);
+    }
+
+private:
+    xdp_zero_copy_impl *_xport;
+    const uint64_t _chunk_addr;
+};
+
+/***********************************************************************
+ * Reusable managed send buffer:
+ *  - release fills in the headers and posts a TX descriptor
+ **********************************************************************/
+class xdp_zero_copy_msb : public managed_send_buffer{
+public:
+    xdp_zero_copy_msb(xdp_zero_copy_impl *xport, void *mem, const uint64_t chunk_addr, const size_t frame_size):
+        _xport(xport), _mem(mem), _chunk_addr(chunk_addr), _frame_size(frame_size) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void){
+        return make(this, static_cast<char *>(_mem) + XDP_HDR_SIZE, _frame_size);
+    }
+
+    UHD_INLINE void *mem(void) const{
+        return _mem;
+    }
+
+    UHD_INLINE uint64_t chunk_addr(void) const{
+        return _chunk_addr;
+    }
+
+private:
+    xdp_zero_copy_impl *_xport;
+    void *_mem;
+    const uint64_t _chunk_addr;
+    const size_t _frame_size;
+};
+
+/***********************************************************************
+ * AF_XDP zero copy implementation:
+ *   The UMEM holds num_recv_frames receive chunks followed by
+ *   num_send_frames send chunks. Receive chunks live in the kernel
+ *   (fill ring) until a frame arrives; send chunks are kept on a free
+ *   list and return to it through the completion ring.
+ **********************************************************************/
+class xdp_zero_copy_impl : public xdp_zero_copy{
+public:
+    xdp_zero_copy_impl(
+        const std::string &addr,
+        const std::string &port,
+        const zero_copy_xport_params &xport_params,
+        const device_addr_t &hints
+    ):
+        _recv_frame_size(xport_params.recv_frame_size),
+        _num_recv_frames(xport_params.num_recv_frames),
+        _send_frame_size(xport_params.send_frame_size),
+        _num_send_frames(xport_params.num_send_frames),
+        _umem(NULL), _xsk(NULL), _xsk_fd(-1), _num_tx_outstanding(0),
+        _reserve_socket(_io_service)
+    {
+        UHD_LOG << boost::format("Creating AF_XDP transport for %s %s") % addr % port << std::endl;
+
+        //resolve the remote endpoint
+        asio::ip::udp::resolver resolver(_io_service);
+        asio::ip::udp::resolver::query query(asio::ip::udp::v4(), addr, port);
+        const asio::ip::udp::endpoint remote_ep = *resolver.resolve(query);
+        _remote_ip = remote_ep.address().to_v4();
+        _remote_port = remote_ep.port();
+
+        asio::ip::address_v4 local_ip;
+        const std::string iface = find_iface(hints.get("xdp_iface", ""), _remote_ip, local_ip);
+        const uint32_t queue = hints.cast<uint32_t>("xdp_queue", 0);
+
+        //reserve a local port with the kernel so nobody else gets it
+        _reserve_socket.open(asio::ip::udp::v4());
+        _reserve_socket.bind(asio::ip::udp::endpoint(local_ip, 0));
+        _local_port = _reserve_socket.local_endpoint().port();
+
+        this->setup_header_template(iface, local_ip);
+
+        //setup the umem area: recv chunks then send chunks
+        const size_t num_chunks = _num_recv_frames + _num_send_frames;
+        _umem_pool = buffer_pool::make(num_chunks, XDP_CHUNK_SIZE, XDP_CHUNK_SIZE);
+        _umem_area = _umem_pool->at(0);
+
+        xsk_umem_config umem_cfg;
+        std::memset(&umem_cfg, 0, sizeof(umem_cfg));
+        umem_cfg.fill_size = round_up_pow2(_num_recv_frames);
+        umem_cfg.comp_size = round_up_pow2(_num_send_frames);
+        umem_cfg.frame_size = XDP_CHUNK_SIZE;
+        umem_cfg.frame_headroom = 0;
+        int ret = xsk_umem__create(&_umem, _umem_area, num_chunks*XDP_CHUNK_SIZE, &_fill, &_comp, &umem_cfg);
+        if (ret) throw uhd::os_error(str(boost::format(
+            "xdp_zero_copy: xsk_umem__create failed: %s") % strerror(-ret)));
+
+        xsk_socket_config xsk_cfg;
+        std::memset(&xsk_cfg, 0, sizeof(xsk_cfg));
+        xsk_cfg.rx_size = round_up_pow2(_num_recv_frames);
+        xsk_cfg.tx_size = round_up_pow2(_num_send_frames);
+        xsk_cfg.bind_flags = hints.cast<int>("xdp_zero_copy", 0)? XDP_ZEROCOPY : 0;
+        ret = xsk_socket__create(&_xsk, iface.c_str(), queue, _umem, &_rx, &_tx, &xsk_cfg);
+        if (ret){
+            xsk_umem__delete(_umem);
+            throw uhd::os_error(str(boost::format(
+                "xdp_zero_copy: cannot bind an AF_XDP socket to %s queue %u: %s\n"
+                "AF_XDP requires CAP_NET_ADMIN (or CAP_BPF) and driver support.")
+                % iface % queue % strerror(-ret)));
+        }
+        _xsk_fd = xsk_socket__fd(_xsk);
+
+        //hand all receive chunks to the kernel
+        uint32_t idx = 0;
+        UHD_ASSERT_THROW(xsk_ring_prod__reserve(&_fill, _num_recv_frames, &idx) == _num_recv_frames);
+        for (size_t i = 0; i < _num_recv_frames; i++){
+            _mrb_pool.push_back(boost::make_shared<xdp_zero_copy_mrb>(this, i*XDP_CHUNK_SIZE));
+            *xsk_ring_prod__fill_addr(&_fill, idx++) = i*XDP_CHUNK_SIZE;
+        }
+        xsk_ring_prod__submit(&_fill, _num_recv_frames);
+
+        //all send chunks start out free
+        for (size_t i = 0; i < _num_send_frames; i++){
+            const size_t chunk = _num_recv_frames + i;
+            _msb_pool.push_back(boost::make_shared<xdp_zero_copy_msb>(
+                this, _umem_pool->at(chunk), chunk*XDP_CHUNK_SIZE, get_send_frame_size()));
+            _free_msbs.push_back(_msb_pool.back().get());
+        }
+
+        UHD_LOG << boost::format("AF_XDP transport bound to %s queue %u, local port %u")
+            % iface % queue % _local_port << std::endl;
+    }
+
+    ~xdp_zero_copy_impl(void){
+        xsk_socket__delete(_xsk);
+        xsk_umem__delete(_umem);
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     * Take the next descriptor off the RX ring, drop frames which are
+     * not for this transport, and point a buffer at the payload.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff = this->get_recv_frame(timeout);
+        _stats.count_recv(buff);
+        return buff;
+    }
+
+    managed_recv_buffer::sptr get_recv_frame(const double timeout){
+        const int timeout_ms = int(timeout*1000);
+        bool waited = false;
+        while (true){
+            uint32_t idx = 0;
+            if (xsk_ring_cons__peek(&_rx, 1, &idx) == 0){
+                if (waited) return managed_recv_buffer::sptr(); //timeout
+                pollfd pfd;
+                pfd.fd = _xsk_fd;
+                pfd.events = POLLIN;
+                const time_spec_t wait_start = time_spec_t::get_system_time();
+                ::poll(&pfd, 1, timeout_ms);
+                _stats.add_recv_wait(wait_start);
+                waited = true;
+                continue;
+            }
+            const xdp_desc *desc = xsk_ring_cons__rx_desc(&_rx, idx);
+            const uint64_t addr = desc->addr;
+            const uint32_t len = desc->len;
+            xsk_ring_cons__release(&_rx, 1);
+
+            const uint64_t chunk_addr = xsk_umem__extract_addr(addr);
+            char *pkt = static_cast<char *>(xsk_umem__get_data(_umem_area, addr));
+            const size_t payload_len = this->parse_frame(pkt, len);
+            if (payload_len == 0){
+                _stats.count_dropped();
+                this->recycle_recv_chunk(chunk_addr);
+                continue;
+            }
+            return _mrb_pool[chunk_addr/XDP_CHUNK_SIZE]->get_new(pkt + XDP_HDR_SIZE, payload_len);
+        }
+    }
+
+    size_t get_num_recv_frames(void) const {return _num_recv_frames;}
+    size_t get_recv_frame_size(void) const {return _recv_frame_size;}
+
+    //! Called by the managed receive buffers (any thread)
+    void recycle_recv_chunk(const uint64_t chunk_addr){
+        boost::mutex::scoped_lock lock(_fill_mutex);
+        uint32_t idx = 0;
+        while (xsk_ring_prod__reserve(&_fill, 1, &idx) != 1){
+            boost::this_thread::yield(); //cannot happen: the ring holds every chunk
+        }
+        *xsk_ring_prod__fill_addr(&_fill, idx) = chunk_addr;
+        xsk_ring_prod__submit(&_fill, 1);
+    }
+
+    /*******************************************************************
+     * Send implementation:
+     * Reap completed TX chunks, then hand out a free one.
+     ******************************************************************/
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        const time_spec_t wait_start = time_spec_t::get_system_time();
+        const time_spec_t exit_time = wait_start + time_spec_t(timeout);
+        bool waited = false;
+        while (true){
+            {
+                boost::mutex::scoped_lock lock(_tx_mutex);
+                this->reap_completions();
+                if (not _free_msbs.empty()){
+                    xdp_zero_copy_msb *msb = _free_msbs.back();
+                    _free_msbs.pop_back();
+                    if (waited) _stats.add_send_wait(wait_start);
+                    managed_send_buffer::sptr buff = msb->get_new();
+                    _stats.count_send(buff);
+                    return buff;
+                }
+                this->kick_tx();
+            }
+            if (not waited) _stats.count_send_pool_empty();
+            waited = true;
+            if (time_spec_t::get_system_time() > exit_time){
+                _stats.add_send_wait(wait_start);
+                _stats.count_send(managed_send_buffer::sptr());
+                return managed_send_buffer::sptr();
+            }
+            boost::this_thread::yield();
+        }
+    }
+
+    size_t get_num_send_frames(void) const {return _num_send_frames;}
+    size_t get_send_frame_size(void) const {return _send_frame_size;}
+
+    //! The kernel drops are the frames it dropped for this socket
+    zero_copy_stats_t get_stats(void) const {
+        zero_copy_stats_t stats = _stats.get();
+        xdp_statistics xdp_stats;
+        socklen_t len = sizeof(xdp_stats);
+        if (::getsockopt(_xsk_fd, SOL_XDP, XDP_STATISTICS, &xdp_stats, &len) == 0){
+            stats.num_kernel_drops = xdp_stats.rx_dropped;
+        }
+        return stats;
+    }
+
+    //! Called by the managed send buffers on commit
+    void post_send_chunk(xdp_zero_copy_msb *msb, const size_t payload_len){
+        char *pkt = static_cast<char *>(msb->mem());
+        this->fill_headers(pkt, payload_len);
+
+        boost::mutex::scoped_lock lock(_tx_mutex);
+        uint32_t idx = 0;
+        while (xsk_ring_prod__reserve(&_tx, 1, &idx) != 1){
+            this->kick_tx(); //cannot happen: the ring holds every send chunk
+        }
+        xdp_desc *desc = xsk_ring_prod__tx_desc(&_tx, idx);
+        desc->addr = msb->chunk_addr();
+        desc->len = uint32_t(payload_len + XDP_HDR_SIZE);
+        xsk_ring_prod__submit(&_tx, 1);
+        _num_tx_outstanding++;
+        this->kick_tx();
+    }
+
+private:
+    //! Pre-compute the Ethernet/IPv4/UDP headers for outgoing frames
+    void setup_header_template(const std::string &iface, const asio::ip::address_v4 &local_ip){
+        std::memset(_hdr_template, 0, sizeof(_hdr_template));
+        ethhdr *eth = reinterpret_cast<ethhdr *>(_hdr_template);
+        get_iface_mac(iface, eth->h_source);
+
+        //the discovery traffic on udp_simple normally populates the ARP
+        //table by now, otherwise poke the kernel and wait for an answer
+        const std::string remote_ip = _remote_ip.to_string();
+        if (not lookup_arp(remote_ip, iface, eth->h_dest)){
+            asio::ip::udp::socket sock(_io_service, asio::ip::udp::v4());
+            const char nop = 0;
+            sock.send_to(asio::buffer(&nop, 0), asio::ip::udp::endpoint(_remote_ip, 9/*discard*/));
+            bool found = false;
+            for (size_t i = 0; i < 100 and not found; i++){
+                boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+                found = lookup_arp(remote_ip, iface, eth->h_dest);
+            }
+            if (not found) throw uhd::io_error(str(boost::format(
+                "xdp_zero_copy: no ARP entry for %s on %s") % remote_ip % iface));
+        }
+        eth->h_proto = htons(ETH_P_IP);
+
+        iphdr *ip = reinterpret_cast<iphdr *>(_hdr_template + sizeof(ethhdr));
+        ip->version = 4;
+        ip->ihl = sizeof(iphdr)/4;
+        ip->ttl = 64;
+        ip->frag_off = htons(IP_DF);
+        ip->protocol = IPPROTO_UDP;
+        ip->saddr = htonl(local_ip.to_ulong());
+        ip->daddr = htonl(_remote_ip.to_ulong());
+
+        udphdr *udp = reinterpret_cast<udphdr *>(_hdr_template + sizeof(ethhdr) + sizeof(iphdr));
+        udp->source = htons(_local_port);
+        udp->dest = htons(_remote_port);
+        udp->check = 0; //optional for IPv4
+    }
+
+    UHD_INLINE void fill_headers(char *pkt, const size_t payload_len){
+        std::memcpy(pkt, _hdr_template, XDP_HDR_SIZE);
+        iphdr *ip = reinterpret_cast<iphdr *>(pkt + sizeof(ethhdr));
+        ip->tot_len = htons(uint16_t(sizeof(iphdr) + sizeof(udphdr) + payload_len));
+        ip->check = ip_checksum(ip);
+        udphdr *udp = reinterpret_cast<udphdr *>(pkt + sizeof(ethhdr) + sizeof(iphdr));
+        udp->len = htons(uint16_t(sizeof(udphdr) + payload_len));
+    }
+
+    //! \return the UDP payload length, or 0 if the frame is not ours
+    UHD_INLINE size_t parse_frame(const char *pkt, const size_t len) const{
+        if (len < XDP_HDR_SIZE) return 0;
+        const ethhdr *eth = reinterpret_cast<const ethhdr *>(pkt);
+        if (eth->h_proto != htons(ETH_P_IP)) return 0;
+        const iphdr *ip = reinterpret_cast<const iphdr *>(pkt + sizeof(ethhdr));
+        if (ip->ihl != sizeof(iphdr)/4 or ip->protocol != IPPROTO_UDP) return 0;
+        if (ip->saddr != htonl(_remote_ip.to_ulong())) return 0;
+        const udphdr *udp = reinterpret_cast<const udphdr *>(pkt + sizeof(ethhdr) + sizeof(iphdr));
+        if (udp->dest != htons(_local_port)) return 0;
+        const size_t udp_len = ntohs(udp->len);
+        if (udp_len < sizeof(udphdr) or udp_len - sizeof(udphdr) > len - XDP_HDR_SIZE) return 0;
+        return udp_len - sizeof(udphdr);
+    }
+
+    //! Move completed TX chunks back onto the free list (tx lock held)
+    UHD_INLINE void reap_completions(void){
+        if (_num_tx_outstanding == 0) return;
+        uint32_t idx = 0;
+        const uint32_t n = xsk_ring_cons__peek(&_comp, _num_tx_outstanding, &idx);
+        for (uint32_t i = 0; i < n; i++){
+            const uint64_t addr = *xsk_ring_cons__comp_addr(&_comp, idx++);
+            _free_msbs.push_back(_msb_pool[addr/XDP_CHUNK_SIZE - _num_recv_frames].get());
+        }
+        xsk_ring_cons__release(&_comp, n);
+        _num_tx_outstanding -= n;
+    }
+
+    //! Wake up the kernel to process the TX ring (tx lock held)
+    UHD_INLINE void kick_tx(void){
+        const ssize_t ret = ::sendto(_xsk_fd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+        if (ret < 0 and errno != EAGAIN and errno != EBUSY and errno != ENOBUFS){
+            throw uhd::io_error(str(boost::format("xdp_zero_copy: TX kick failed: %s") % strerror(errno)));
+        }
+    }
+
+    const size_t _recv_frame_size, _num_recv_frames;
+    const size_t _send_frame_size, _num_send_frames;
+
+    //umem and rings
+    buffer_pool::sptr _umem_pool;
+    void *_umem_area;
+    xsk_umem *_umem;
+    xsk_socket *_xsk;
+    int _xsk_fd;
+    xsk_ring_prod _fill, _tx;
+    xsk_ring_cons _comp, _rx;
+    boost::mutex _fill_mutex, _tx_mutex;
+    size_t _num_tx_outstanding;
+
+    std::vector<boost::shared_ptr<xdp_zero_copy_mrb> > _mrb_pool;
+    std::vector<boost::shared_ptr<xdp_zero_copy_msb> > _msb_pool;
+    std::vector<xdp_zero_copy_msb *> _free_msbs;
+
+    zero_copy_stats_counter _stats;
+
+    //addressing
+    asio::io_service _io_service;
+    asio::ip::udp::socket _reserve_socket;
+    asio::ip::address_v4 _remote_ip;
+    uint16_t _remote_port, _local_port;
+    char _hdr_template[XDP_HDR_SIZE];
+};
+
+void xdp_zero_copy_mrb::release(void){
+    _xport->recycle_recv_chunk(_chunk_addr);
+}
+
+void xdp_zero_copy_msb::release(void){
+    _xport->post_send_chunk(this, size());
+}
+
+/***********************************************************************
+ * AF_XDP zero copy make function
+ **********************************************************************/
+bool xdp_zero_copy::is_supported(void){
+    return true;
+}
+
+size_t xdp_zero_copy::max_frame_size(void){
+    return XDP_MAX_FRAME_SIZE;
+}
+
+xdp_zero_copy::sptr xdp_zero_copy::make(
+    const std::string &addr,
+    const std::string &port,
+    const zero_copy_xport_params &default_buff_args,
+    udp_zero_copy::buff_params& buff_params_out,
+    const device_addr_t &hints
+){
+    zero_copy_xport_params xport_params = default_buff_args;
+
+    xport_params.recv_frame_size = size_t(hints.cast<double>("recv_frame_size", default_buff_args.recv_frame_size));
+    xport_params.num_recv_frames = size_t(hints.cast<double>("num_recv_frames", default_buff_args.num_recv_frames));
+    xport_params.send_frame_size = size_t(hints.cast<double>("send_frame_size", default_buff_args.send_frame_size));
+    xport_params.num_send_frames = size_t(hints.cast<double>("num_send_frames", default_buff_args.num_send_frames));
+
+    if (xport_params.recv_frame_size > XDP_MAX_FRAME_SIZE or xport_params.send_frame_size > XDP_MAX_FRAME_SIZE){
+        UHD_MSG(warning) << boost::format(
+            "AF_XDP frames are limited to %d bytes, reducing the frame size.\n"
+        ) % XDP_MAX_FRAME_SIZE;
+        xport_params.recv_frame_size = std::min(xport_params.recv_frame_size, XDP_MAX_FRAME_SIZE);
+        xport_params.send_frame_size = std::min(xport_params.send_frame_size, XDP_MAX_FRAME_SIZE);
+    }
+
+    xdp_zero_copy::sptr xport(new xdp_zero_copy_impl(addr, port, xport_params, hints));
+
+    //the umem takes the place of the socket buffers
+    buff_params_out.recv_buff_size = xport_params.num_recv_frames * XDP_CHUNK_SIZE;
+    buff_params_out.send_buff_size = xport_params.num_send_frames * XDP_CHUNK_SIZE;
+
+    return xport;
+}
@@ -15,12 +15,14 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "zero_copy_stats.hpp"
 #include <uhd/transport/zero_copy_recv_offload.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/thread/mutex.hpp>
@@ -84,10 +86,11 @@ public:
     // pulling pointers to managed receiver buffers quickly
     void enqueue_recv()
     {
+        scoped_internal_thread internal_thread("rx offload", "rx");
         while (not is_recv_done()) {
             managed_recv_buffer::sptr buff = _transport->get_recv_buff(_timeout);
             if (not buff) continue;
-            _inbox.push_with_timed_wait(buff, _timeout);
+            if (not _inbox.push_with_timed_wait(buff, _timeout)) _stats.count_dropped();
         }
     }
 
@@ -98,7 +101,12 @@ public:
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
         managed_recv_buffer::sptr ptr;
-        _inbox.pop_with_timed_wait(ptr, timeout);
+        if (not _inbox.pop_with_haste(ptr)) {
+            const time_spec_t wait_start = time_spec_t::get_system_time();
+            _inbox.pop_with_timed_wait(ptr, timeout);
+            _stats.add_recv_wait(wait_start);
+        }
+        _stats.count_recv(ptr);
         return ptr;
     }
 
@@ -131,6 +139,28 @@ public:
         return _transport->get_send_frame_size();
     }
 
+    /*******************************************************************
+     * Stats:
+     * The counters of the linked transport, except that the receive
+     * timeouts and waits are those of the callers of get_recv_buff()
+     * (the receive thread polls with its own timeout), and packets the
+     * receive thread could not queue count as dropped.
+     ******************************************************************/
+    zero_copy_stats_t get_stats(void) const
+    {
+        zero_copy_stats_t stats = _transport->get_stats();
+        const zero_copy_stats_t offload = _stats.get();
+        stats.num_recv_timeouts = offload.num_recv_timeouts;
+        stats.recv_wait_ns = offload.recv_wait_ns;
+        stats.num_dropped += offload.num_dropped;
+        //packets the linked transport handed out but the caller did not get yet
+        const uint64_t num_passed = offload.num_recv_packets + offload.num_dropped;
+        if (stats.num_recv_packets > num_passed) {
+            stats.recv_queue_depth += size_t(stats.num_recv_packets - num_passed);
+        }
+        return stats;
+    }
+
 private:
     // The linked transport
     zero_copy_if::sptr _transport;
@@ -140,6 +170,8 @@ private:
     // Shared buffers
     bounded_buffer_t _inbox;
 
+    zero_copy_stats_counter _stats;
+
     // Threading
     bool _recv_done;
     boost::thread _recv_thread;
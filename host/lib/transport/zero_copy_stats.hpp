@@ -0,0 +1,165 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_STATS_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_STATS_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * Counters behind zero_copy_if::get_stats().
+ *
+ * Each counter has a single writer (the thread calling get_recv_buff()
+ * or get_send_buff()), so updates are a relaxed load and store without
+ * a locked instruction. Concurrent callers of the same get_*_buff()
+ * may lose an occasional increment, which is fine for statistics.
+ * Wait times are only measured on the blocking path of a transport.
+ */
+class zero_copy_stats_counter
+{
+public:
+    zero_copy_stats_counter(void):
+        _num_recv_packets(0), _num_recv_bytes(0), _num_recv_timeouts(0),
+        _num_recv_pool_empty(0), _recv_wait_ns(0),
+        _num_send_packets(0), _num_send_timeouts(0),
+        _num_send_pool_empty(0), _send_wait_ns(0),
+        _num_dropped(0), _num_kernel_drops(0),
+        _recv_latency_ns(0), _max_recv_latency_ns(0)
+    {}
+
+    //! Count the outcome of a get_recv_buff() call
+    UHD_INLINE void count_recv(const managed_recv_buffer::sptr &buff)
+    {
+        if (buff) {
+            add(_num_recv_packets, 1);
+            add(_num_recv_bytes, buff->size());
+        }
+        else add(_num_recv_timeouts, 1);
+    }
+
+    //! Count the outcome of a get_send_buff() call
+    UHD_INLINE void count_send(const managed_send_buffer::sptr &buff)
+    {
+        add((buff)? _num_send_packets : _num_send_timeouts, 1);
+    }
+
+    UHD_INLINE void count_recv_pool_empty(void) { add(_num_recv_pool_empty, 1); }
+    UHD_INLINE void count_send_pool_empty(void) { add(_num_send_pool_empty, 1); }
+    UHD_INLINE void count_dropped(const size_t num = 1) { add(_num_dropped, num); }
+
+    //! Account the time since a blocking receive wait started
+    UHD_INLINE void add_recv_wait(const time_spec_t &start)
+    {
+        add(_recv_wait_ns, elapsed_ns(start));
+    }
+
+    //! Account the time since a blocking send wait started
+    UHD_INLINE void add_send_wait(const time_spec_t &start)
+    {
+        add(_send_wait_ns, elapsed_ns(start));
+    }
+
+    //! Record the kernel's running drop count for the socket
+    UHD_INLINE void set_kernel_drops(const uint64_t num)
+    {
+        _num_kernel_drops.store(num, boost::memory_order_relaxed);
+    }
+
+    //! Account the time from kernel arrival to the hand-out of a packet
+    UHD_INLINE void add_recv_latency(const uint64_t ns)
+    {
+        add(_recv_latency_ns, ns);
+        if (ns > _max_recv_latency_ns.load(boost::memory_order_relaxed)) {
+            _max_recv_latency_ns.store(ns, boost::memory_order_relaxed);
+        }
+    }
+
+    //! Take a snapshot; the queue depth is filled in by the transport
+    zero_copy_stats_t get(void) const
+    {
+        zero_copy_stats_t stats;
+        stats.num_recv_packets = _num_recv_packets.load(boost::memory_order_relaxed);
+        stats.num_recv_bytes = _num_recv_bytes.load(boost::memory_order_relaxed);
+        stats.num_recv_timeouts = _num_recv_timeouts.load(boost::memory_order_relaxed);
+        stats.num_recv_pool_empty = _num_recv_pool_empty.load(boost::memory_order_relaxed);
+        stats.recv_wait_ns = _recv_wait_ns.load(boost::memory_order_relaxed);
+        stats.num_send_packets = _num_send_packets.load(boost::memory_order_relaxed);
+        stats.num_send_timeouts = _num_send_timeouts.load(boost::memory_order_relaxed);
+        stats.num_send_pool_empty = _num_send_pool_empty.load(boost::memory_order_relaxed);
+        stats.send_wait_ns = _send_wait_ns.load(boost::memory_order_relaxed);
+        stats.num_dropped = _num_dropped.load(boost::memory_order_relaxed);
+        stats.num_kernel_drops = _num_kernel_drops.load(boost::memory_order_relaxed);
+        stats.recv_latency_ns = _recv_latency_ns.load(boost::memory_order_relaxed);
+        stats.max_recv_latency_ns = _max_recv_latency_ns.load(boost::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    typedef boost::atomic<uint64_t> counter_t;
+
+    static UHD_INLINE void add(counter_t &counter, const uint64_t delta)
+    {
+        counter.store(counter.load(boost::memory_order_relaxed) + delta, boost::memory_order_relaxed);
+    }
+
+    static UHD_INLINE uint64_t elapsed_ns(const time_spec_t &start)
+    {
+        return uint64_t((time_spec_t::get_system_time() - start).to_ticks(1e9));
+    }
+
+    counter_t _num_recv_packets, _num_recv_bytes, _num_recv_timeouts;
+    counter_t _num_recv_pool_empty, _recv_wait_ns;
+    counter_t _num_send_packets, _num_send_timeouts;
+    counter_t _num_send_pool_empty, _send_wait_ns;
+    counter_t _num_dropped, _num_kernel_drops;
+    counter_t _recv_latency_ns, _max_recv_latency_ns;
+};
+
+//! Publisher helper: reads the stats while the transport is alive
+static UHD_INLINE zero_copy_stats_t get_zero_copy_stats(
+    boost::weak_ptr<zero_copy_if> xport
+){
+    zero_copy_if::sptr locked = xport.lock();
+    return (locked)? locked->get_stats() : zero_copy_stats_t();
+}
+
+/*!
+ * Publish the stats of a transport under <path>/stats in the property tree.
+ * The tree only holds a weak reference, so the transport may be
+ * destroyed first (the stats then read as zeros). An existing entry is
+ * replaced.
+ */
+static UHD_INLINE void publish_zero_copy_stats(
+    property_tree::sptr tree, const fs_path &path, zero_copy_if::sptr xport
+){
+    if (tree->exists(path / "stats")) tree->remove(path / "stats");
+    tree->create<zero_copy_stats_t>(path / "stats")
+        .set_publisher(boost::bind(&get_zero_copy_stats, boost::weak_ptr<zero_copy_if>(xport)));
+}
+
+}} //namespace
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_STATS_HPP */
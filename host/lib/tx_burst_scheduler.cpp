@@ -0,0 +1,230 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/tx_burst_scheduler.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace uhd;
+
+//! Number of late burst messages kept until they are read
+static const size_t MAX_LATE_MSGS = 1000;
+//! Longest the worker sleeps without looking at the queue
+static const double MAX_IDLE_WAIT = 0.1;
+//! Slice of a recv_async_msg() timeout spent waiting on the streamer
+static const double ASYNC_POLL_TIME = 0.01;
+
+tx_burst_scheduler::~tx_burst_scheduler(void)
+{
+    /* NOP */
+}
+
+class tx_burst_scheduler_impl : public tx_burst_scheduler
+{
+public:
+    tx_burst_scheduler_impl(
+        tx_streamer::sptr streamer,
+        const std::string &cpu_format,
+        const time_source_type &get_time_now,
+        const double lead_time
+    ):
+        _streamer(streamer),
+        _bytes_per_item(convert::get_bytes_per_item(cpu_format)),
+        _get_time_now(get_time_now),
+        _lead_time(lead_time),
+        _next_id(0),
+        _sending(false),
+        _late_msgs(MAX_LATE_MSGS)
+    {
+        if (not _get_time_now) {
+            throw uhd::value_error("tx_burst_scheduler needs a time source");
+        }
+        _task = task::make(boost::bind(&tx_burst_scheduler_impl::send_loop, this), "tx", "tx burst scheduler");
+    }
+
+    ~tx_burst_scheduler_impl(void)
+    {
+        UHD_SAFE_CALL(
+            _task.reset();
+        )
+    }
+
+    uint32_t schedule(
+        const tx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const time_spec_t &time
+    ){
+        if (buffs.size() != _streamer->get_num_channels()) {
+            throw uhd::value_error(str(boost::format(
+                "tx_burst_scheduler: %u buffers for a streamer with %u channels")
+                % buffs.size() % _streamer->get_num_channels()));
+        }
+        if (nsamps_per_buff == 0) {
+            throw uhd::value_error("tx_burst_scheduler: a burst needs at least one sample");
+        }
+
+        //copy the samples outside of the lock
+        burst_t burst;
+        burst.nsamps = nsamps_per_buff;
+        burst.samps.resize(buffs.size());
+        for (size_t i = 0; i < buffs.size(); i++) {
+            const char *in = reinterpret_cast<const char *>(buffs[i]);
+            burst.samps[i].assign(in, in + nsamps_per_buff*_bytes_per_item);
+        }
+
+        boost::mutex::scoped_lock lock(_mutex);
+        //a multimap keeps bursts with the same time in insertion order
+        burst_t &queued = _bursts.insert(std::make_pair(time, burst_t()))->second;
+        queued.id = _next_id++;
+        queued.nsamps = burst.nsamps;
+        queued.samps.swap(burst.samps);
+        _cond.notify_one();
+        return queued.id;
+    }
+
+    size_t get_num_pending(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _bursts.size() + (_sending ? 1 : 0);
+    }
+
+    bool recv_async_msg(async_metadata_t &async_metadata, double timeout)
+    {
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        do {
+            if (_late_msgs.pop_with_haste(async_metadata)) return true;
+            const double time_left = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+            if (_streamer->recv_async_msg(async_metadata, std::max(0.0, std::min(time_left, ASYNC_POLL_TIME)))) {
+                return true;
+            }
+        } while (time_spec_t::get_system_time() < exit_time);
+        return _late_msgs.pop_with_haste(async_metadata);
+    }
+
+private:
+    struct burst_t
+    {
+        burst_t(void): id(0), nsamps(0) {}
+        uint32_t id;
+        size_t nsamps;
+        std::vector<std::vector<char> > samps;
+    };
+
+    void send_loop(void)
+    {
+        time_spec_t time;
+        burst_t burst;
+        {
+            //the time source may talk to the device, so ask before locking
+            const time_spec_t now = _get_time_now();
+            boost::mutex::scoped_lock lock(_mutex);
+            _sending = false;
+            if (_bursts.empty()) {
+                _cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::microseconds(long(MAX_IDLE_WAIT*1e6)));
+                return;
+            }
+
+            //wait until the earliest burst is due, or an earlier one comes in
+            const double time_to_send = (_bursts.begin()->first - now).get_real_secs() - _lead_time;
+            if (time_to_send > 0.0) {
+                const double wait_time = std::min(time_to_send, MAX_IDLE_WAIT);
+                _cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::microseconds(long(wait_time*1e6)));
+                return;
+            }
+
+            time = _bursts.begin()->first;
+            burst.id = _bursts.begin()->second.id;
+            burst.nsamps = _bursts.begin()->second.nsamps;
+            burst.samps.swap(_bursts.begin()->second.samps);
+            _bursts.erase(_bursts.begin());
+            _sending = true;
+        }
+
+        //too late: the device would reject it anyway, so save the link
+        if (time < _get_time_now()) {
+            async_metadata_t metadata;
+            metadata.channel = 0;
+            metadata.has_time_spec = true;
+            metadata.time_spec = time;
+            metadata.event_code = async_metadata_t::EVENT_CODE_TIME_ERROR;
+            metadata.user_payload[0] = burst.id;
+            metadata.user_payload[1] = metadata.user_payload[2] = metadata.user_payload[3] = 0;
+            _late_msgs.push_with_pop_on_full(metadata);
+            return;
+        }
+
+        send_burst(time, burst);
+    }
+
+    void send_burst(const time_spec_t &time, const burst_t &burst)
+    {
+        std::vector<const void *> buffs(burst.samps.size());
+        tx_metadata_t metadata;
+        metadata.start_of_burst = true;
+        metadata.end_of_burst = true;
+        metadata.has_time_spec = true;
+        metadata.time_spec = time;
+
+        //send() waits for flow control; retry on timeouts until all is out
+        size_t nsamps_sent = 0;
+        do {
+            for (size_t i = 0; i < buffs.size(); i++) {
+                buffs[i] = &burst.samps[i][nsamps_sent*_bytes_per_item];
+            }
+            const size_t n = _streamer->send(buffs, burst.nsamps - nsamps_sent, metadata, MAX_IDLE_WAIT);
+            if (n != 0) {
+                metadata.start_of_burst = false;
+                metadata.has_time_spec = false;
+            }
+            nsamps_sent += n;
+            boost::this_thread::interruption_point();
+        } while (nsamps_sent < burst.nsamps);
+    }
+
+    tx_streamer::sptr _streamer;
+    const size_t _bytes_per_item;
+    const time_source_type _get_time_now;
+    const double _lead_time;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::multimap<time_spec_t, burst_t> _bursts;
+    uint32_t _next_id;
+    bool _sending;
+    transport::bounded_buffer<async_metadata_t> _late_msgs;
+    task::sptr _task; //declared last, uses the members above
+};
+
+tx_burst_scheduler::sptr tx_burst_scheduler::make(
+    tx_streamer::sptr streamer,
+    const std::string &cpu_format,
+    const time_source_type &get_time_now,
+    const double lead_time
+){
+    return sptr(new tx_burst_scheduler_impl(streamer, cpu_format, get_time_now, lead_time));
+}
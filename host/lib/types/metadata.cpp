@@ -44,6 +44,9 @@ std::string rx_metadata_t::to_pp_string(bool compact) const
         if (error_code != ERROR_CODE_NONE) {
             ss << strerror() << "\n";
         }
+        if (num_lost_samps != 0) {
+            ss << "Samples lost before: " << num_lost_samps << "\n";
+        }
     } else {
         ss << "Has timespec: " << (has_time_spec ? "Yes" : "No")
            << "\tTime of first sample: " << time_spec.get_real_secs()
@@ -52,7 +55,8 @@ std::string rx_metadata_t::to_pp_string(bool compact) const
            << "\nStart of burst: " << (start_of_burst ? "Yes" : "No")
            << "\tEnd of burst: " << (end_of_burst ? "Yes" : "No")
            << "\nError Code: " << strerror()
-           << "\tOut of sequence: " << (out_of_sequence ? "Yes" : "No");
+           << "\tOut of sequence: " << (out_of_sequence ? "Yes" : "No")
+           << "\nSamples lost before: " << num_lost_samps;
     }
 
     return ss.str();
@@ -145,3 +145,21 @@ void spi_iface::write_spi(
         which_slave, config, data, num_bits, false
     );
 }
+
+std::vector<uint32_t> spi_iface::transact_spi_batch(
+    int which_slave,
+    const spi_config_t &config,
+    const std::vector<uint32_t> &data,
+    size_t num_bits,
+    bool readback
+){
+    std::vector<uint32_t> result;
+    if (readback) result.reserve(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        const uint32_t word = transact_spi(
+            which_slave, config, data[i], num_bits, readback
+        );
+        if (readback) result.push_back(word);
+    }
+    return result;
+}
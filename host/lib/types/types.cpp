@@ -17,6 +17,7 @@
 
 #include <uhd/types/stream_cmd.hpp>
 #include <uhd/types/metadata.hpp>
+#include <algorithm>
 
 using namespace uhd;
 
@@ -42,3 +43,14 @@ tx_metadata_t::tx_metadata_t(void):
 {
     /* NOP */
 }
+
+async_metadata_t::async_metadata_t(void):
+    channel(0),
+    has_time_spec(false),
+    time_spec(time_spec_t()),
+    event_code(EVENT_CODE_BURST_ACK),
+    num_events(1),
+    last_time_spec(time_spec_t())
+{
+    std::fill(user_payload, user_payload + 4, 0);
+}
@@ -54,3 +54,28 @@ uint16_t wb_iface::peek16(const wb_iface::wb_addr_type)
 {
     throw uhd::not_implemented_error("peek16 not implemented");
 }
+
+void wb_iface::begin_batch(void)
+{
+    //NOP
+}
+
+void wb_iface::commit(void)
+{
+    //NOP
+}
+
+size_t timed_wb_iface::get_cmd_queue_space(void)
+{
+    throw uhd::not_implemented_error("get_cmd_queue_space not implemented");
+}
+
+bool timed_wb_iface::try_poke32(const wb_iface::wb_addr_type, const uint32_t)
+{
+    throw uhd::not_implemented_error("try_poke32 not implemented");
+}
+
+void timed_wb_iface::set_cmd_done_handler(const cmd_done_handler_t &)
+{
+    throw uhd::not_implemented_error("set_cmd_done_handler not implemented");
+}
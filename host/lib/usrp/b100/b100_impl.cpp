@@ -19,6 +19,7 @@
 #include "b100_impl.hpp"
 #include "b100_regs.hpp"
 #include <uhd/transport/usb_control.hpp>
+#include <uhd/transport/buffer_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/cast.hpp>
 #include <uhd/exception.hpp>
@@ -256,6 +257,8 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     data_xport_args["num_recv_frames"] = device_addr.get("num_recv_frames", "16");
     data_xport_args["send_frame_size"] = device_addr.get("send_frame_size", "16384");
     data_xport_args["num_send_frames"] = device_addr.get("num_send_frames", "16");
+    //forward the buffer allocation policy (hugepages, NUMA, mlock)
+    buffer_pool::alloc_policy_t::forward_hints(device_addr, data_xport_args);
 
     //let packet padder know the LUT size in number of words32
     const size_t rx_lut_size = size_t(data_xport_args.cast<double>("recv_frame_size", 0.0));
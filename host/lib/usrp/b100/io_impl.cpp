@@ -16,6 +16,7 @@
 //
 
 #include "validate_subdev_spec.hpp"
+#include "streamer_args.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "b100_impl.hpp"
@@ -126,6 +127,7 @@ rx_streamer::sptr b100_impl::get_rx_stream(const uhd::stream_args_t &args_){
     //setup defaults for unspecified values
     args.otw_format = args.otw_format.empty()? "sc16" : args.otw_format;
     args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    const streamer_args_t streamer_args(args);
 
     //calculate packet size
     static const size_t hdr_size = 0
@@ -136,14 +138,14 @@ rx_streamer::sptr b100_impl::get_rx_stream(const uhd::stream_args_t &args_){
     ;
     const size_t bpp = _data_transport->get_recv_frame_size() - hdr_size;
     const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-    const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+    const size_t spp = streamer_args.get_spp(bpp/bpi);
 
     //make the new streamer given the samples per packet
     boost::shared_ptr<sph::recv_packet_streamer> my_streamer = boost::make_shared<sph::recv_packet_streamer>(spp);
 
     //init some streamer stuff
     my_streamer->resize(args.channels.size());
-    my_streamer->set_vrt_unpacker(&vrt::if_hdr_unpack_le);
+    my_streamer->set_vrt_unpacker(&vrt::if_hdr_unpack_cached_le);
 
     //set the converter
     uhd::convert::id_type id;
@@ -152,6 +154,11 @@ rx_streamer::sptr b100_impl::get_rx_stream(const uhd::stream_args_t &args_){
     id.output_format = args.cpu_format;
     id.num_outputs = 1;
     my_streamer->set_converter(id);
+    my_streamer->set_corrections(args.args);
+    my_streamer->set_nontemporal_stores(streamer_args.get_nontemporal_stores());
+    //report the sample power in the metadata, see set_power_metadata()
+    my_streamer->set_power_metadata(streamer_args.get_power_meta());
+    my_streamer->set_host_decim(streamer_args.get_host_decim());
 
     //bind callbacks for the handler
     for (size_t chan_i = 0; chan_i < args.channels.size(); chan_i++){
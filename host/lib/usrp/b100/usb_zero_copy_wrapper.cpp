@@ -23,8 +23,7 @@
 #include <uhd/utils/atomic.hpp>
 #include <boost/foreach.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/thread/mutex.hpp>
-#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
 #include <vector>
 #include <iostream>
@@ -79,14 +78,21 @@ private:
 
 /***********************************************************************
  * USB zero copy wrapper - managed send buffer
+ *
+ * Packets are written straight into a larger USB buffer, which is
+ * committed on end of packet, when it is full, or by the auto flusher.
+ * There is a single producer (the streamer that owns the transport), so
+ * the only contention is with the auto flusher. The partially filled USB
+ * buffer is handed between the two with an atomic state, the producer
+ * never takes a lock.
  **********************************************************************/
 class usb_zero_copy_wrapper_msb : public managed_send_buffer{
 public:
     usb_zero_copy_wrapper_msb(const zero_copy_if::sptr internal, const size_t fragmentation_size):
         _internal(internal), _fragmentation_size(fragmentation_size)
     {
-        _ok_to_auto_flush = false;
-        _task = uhd::task::make(boost::bind(&usb_zero_copy_wrapper_msb::auto_flush, this));
+        _state.write(STATE_EMPTY);
+        _task = uhd::task::make(boost::bind(&usb_zero_copy_wrapper_msb::auto_flush, this), "transport", "usb auto flush");
     }
 
     ~usb_zero_copy_wrapper_msb(void)
@@ -96,9 +102,6 @@ public:
     }
 
     void release(void){
-        boost::mutex::scoped_lock lock(_mutex);
-        _ok_to_auto_flush = true;
-
         //get a reference to the VITA header before incrementing
         const uint32_t vita_header = reinterpret_cast<const uint32_t *>(_mem_buffer_tip)[0];
 
@@ -111,19 +114,29 @@ public:
         if (eop or full){
             _last_send_buff->commit(_bytes_in_buffer);
             _last_send_buff.reset();
-
-            //notify the auto-flusher to restart its timed_wait
-            lock.unlock(); _cond.notify_one();
+            _state.write(STATE_EMPTY);
+        }
+        else{
+            //leave the partial buffer to the auto flusher
+            _activity.inc();
+            _state.write(STATE_PENDING);
         }
     }
 
     UHD_INLINE sptr get_new(const double timeout){
-        boost::mutex::scoped_lock lock(_mutex);
-        _ok_to_auto_flush = false;
+        //claim the partial buffer back from the auto flusher
+        while (true){
+            const uint32_t state = _state.read();
+            if (state != STATE_FLUSHING and _state.cas(STATE_PRODUCER, state) == state) break;
+            boost::this_thread::yield(); //the flusher is committing, that's quick
+        }
 
         if (not _last_send_buff){
             _last_send_buff = _internal->get_send_buff(timeout);
-            if (not _last_send_buff) return sptr();
+            if (not _last_send_buff){
+                _state.write(STATE_EMPTY);
+                return sptr();
+            }
             _mem_buffer_tip = _last_send_buff->cast<char *>();
             _bytes_in_buffer = 0;
         }
@@ -132,6 +145,13 @@ public:
     }
 
 private:
+    enum state_t{
+        STATE_EMPTY,    //no partial buffer
+        STATE_PENDING,  //partial buffer, may be flushed
+        STATE_PRODUCER, //the producer is writing a packet
+        STATE_FLUSHING  //the auto flusher is committing the partial buffer
+    };
+
     zero_copy_if::sptr _internal;
     const size_t _fragmentation_size;
     managed_send_buffer::sptr _last_send_buff;
@@ -139,24 +159,27 @@ private:
     char *_mem_buffer_tip;
 
     //private variables for auto flusher
-    boost::mutex _mutex;
-    boost::condition_variable _cond;
+    atomic_uint32_t _state;
+    atomic_uint32_t _activity;
     uhd::task::sptr _task;
-    bool _ok_to_auto_flush;
 
     /*!
      * The auto flusher ensures that buffers are force committed when
-     * the user has not called get_new() within a certain time window.
+     * the user has not released a packet within a certain time window.
      */
     void auto_flush(void)
     {
-        boost::mutex::scoped_lock lock(_mutex);
-        const bool timeout = not _cond.timed_wait(lock, AUTOFLUSH_TIMEOUT);
-        if (timeout and _ok_to_auto_flush and _last_send_buff and _bytes_in_buffer != 0)
+        const uint32_t activity = _activity.read();
+        boost::this_thread::sleep(AUTOFLUSH_TIMEOUT);
+        if (_activity.read() != activity) return; //producer is still busy
+        if (_state.cas(STATE_FLUSHING, STATE_PENDING) != STATE_PENDING) return;
+        if (_bytes_in_buffer != 0)
         {
             _last_send_buff->commit(_bytes_in_buffer);
             _last_send_buff.reset();
+            _state.write(STATE_EMPTY);
         }
+        else _state.write(STATE_PENDING);
     }
 };
 
@@ -104,13 +104,16 @@ static hash_type generate_hash(const char *filename)
 
     hash_type hash = 0;
 
-    char ch;
+    char buff[64*1024];
     long long count = 0;
-    while (file.get(ch)) {
-        count++;
-        //hash algorithm derived from boost hash_combine
-        //http://www.boost.org/doc/libs/1_35_0/doc/html/boost/hash_combine_id241013.html
-        hash ^= ch + 0x9e3779b9 + (hash<<6) + (hash>>2);
+    while (file.read(buff, sizeof(buff)) or file.gcount() > 0) {
+        const std::streamsize n = file.gcount();
+        count += n;
+        for (std::streamsize i = 0; i < n; i++) {
+            //hash algorithm derived from boost hash_combine
+            //http://www.boost.org/doc/libs/1_35_0/doc/html/boost/hash_combine_id241013.html
+            hash ^= buff[i] + 0x9e3779b9 + (hash<<6) + (hash>>2);
+        }
     }
 
     if (count == 0){
@@ -374,6 +377,11 @@ public:
             throw uhd::io_error((boost::format("Short write on set FPGA hash (expecting: %d, returned: %d)") % bytes_to_send % ret).str());
     }
 
+    bool is_fpga_loaded(void) {
+        hash_type loaded_hash; usrp_get_fpga_hash(loaded_hash);
+        return loaded_hash != 0 and get_fx3_status() == FX3_STATE_RUNNING;
+    }
+
     uint32_t load_fpga(const std::string filestring, bool force) {
 
         uint8_t fx3_state = 0;
@@ -121,6 +121,9 @@ public:
     //! load an FPGA image
     virtual uint32_t load_fpga(const std::string filestring, bool force=false) = 0;
 
+    //! true when the FX3 runs a completely loaded FPGA image
+    virtual bool is_fpga_loaded(void) = 0;
+
     virtual void write_eeprom(uint16_t addr, uint16_t offset, const uhd::byte_vector_t &bytes) = 0;
 
     virtual uhd::byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes) = 0;
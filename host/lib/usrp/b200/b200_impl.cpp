@@ -25,6 +25,7 @@
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/startup_profile.hpp>
 #include <uhd/usrp/dboard_eeprom.hpp>
 #include <boost/format.hpp>
 #include <boost/assign/list_of.hpp>
@@ -39,6 +40,7 @@
 #include <cmath>
 
 #include "../../transport/libusb1_base.hpp"
+#include "../../transport/zero_copy_stats.hpp"
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -202,6 +204,7 @@ static device_addrs_t b200_find(const device_addr_t &hint)
         //check if fw was already loaded
         if (!(handle->firmware_loaded()))
         {
+            startup_profile::scoped_phase phase("load firmware");
             b200_iface::make(control)->load_firmware(b200_fw_image);
         }
 
@@ -290,6 +293,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     _tree = property_tree::make();
     _type = device::USRP;
     const fs_path mb_path = "/mboards/0";
+    startup_profile::begin("mb0: connect");
 
     //try to match the given device address with something on the USB bus
     uint16_t vid = B200_VENDOR_ID;
@@ -359,6 +363,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     _iface = b200_iface::make(control);
     this->check_fw_compat(); //check after making
 
+    startup_profile::begin("mb0: EEPROM");
     ////////////////////////////////////////////////////////////////////
     // setup the mboard eeprom
     ////////////////////////////////////////////////////////////////////
@@ -417,6 +422,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         _gpio_state.swap_atr = 0; // ATRs for radio0 are mapped to FE1
     }
 
+    startup_profile::begin("mb0: load FPGA");
     ////////////////////////////////////////////////////////////////////
     // Load the FPGA image, then reset GPIF
     ////////////////////////////////////////////////////////////////////
@@ -425,7 +431,13 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         device_addr.has_key("fpga")? device_addr["fpga"] : default_file_name
     );
 
-    uint32_t status = _iface->load_fpga(b200_fpga_image);
+    //with keep_fpga, whatever image is loaded stays as long as it is compatible
+    uint32_t status = 0;
+    if (device_addr.has_key("keep_fpga") and not device_addr.has_key("fpga") and _iface->is_fpga_loaded()) {
+        UHD_MSG(status) << "Keeping the loaded FPGA image." << std::endl;
+    } else {
+        status = _iface->load_fpga(b200_fpga_image);
+    }
 
     if(status != 0) {
         throw uhd::runtime_error(str(boost::format("fx3 is in state %1%") % status));
@@ -433,6 +445,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
 
     _iface->reset_gpif();
 
+    startup_profile::begin("mb0: transports");
     ////////////////////////////////////////////////////////////////////
     // Create control transport
     ////////////////////////////////////////////////////////////////////
@@ -454,6 +467,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         ctrl_xport_args
     );
     while (_ctrl_transport->get_recv_buff(0.0)){} //flush ctrl xport
+    publish_zero_copy_stats(_tree, mb_path / "xports" / "ctrl", _ctrl_transport);
     _tree->create<double>(mb_path / "link_max_rate").set((usb_speed == 3) ? B200_MAX_RATE_USB3 : B200_MAX_RATE_USB2);
 
     ////////////////////////////////////////////////////////////////////
@@ -465,7 +479,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     {
         _async_task_data->gpsdo_uart = b200_uart::make(_ctrl_transport, B200_TX_GPS_UART_SID);
     }
-    _async_task = uhd::msg_task::make(boost::bind(&b200_impl::handle_async_task, this, _ctrl_transport, _async_task_data));
+    _async_task = uhd::msg_task::make(boost::bind(&b200_impl::handle_async_task, this, _ctrl_transport, _async_task_data), "async", "async messages");
 
     ////////////////////////////////////////////////////////////////////
     // Local control endpoint
@@ -531,6 +545,9 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     data_xport_args["num_recv_frames"] = device_addr.get("num_recv_frames", "16");
     data_xport_args["send_frame_size"] = device_addr.get("send_frame_size", "8192");
     data_xport_args["num_send_frames"] = device_addr.get("num_send_frames", "16");
+    if (device_addr.has_key("recv_xfer_size")) {
+        data_xport_args["recv_xfer_size"] = device_addr["recv_xfer_size"];
+    }
 
     // This may throw a uhd::usb_error, which will be caught by b200_make().
     _data_transport = usb_zero_copy::make(
@@ -540,7 +557,10 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         data_xport_args    // param hints
     );
     while (_data_transport->get_recv_buff(0.0)){} //flush ctrl xport
-    _demux = recv_packet_demuxer_3000::make(_data_transport);
+    publish_zero_copy_stats(_tree, mb_path / "xports" / "data", _data_transport);
+    //one thread receives for all RX streamers, see recv_packet_demuxer_3000
+    _demux = recv_packet_demuxer_3000::make(_data_transport,
+        device_addr.cast<int>("recv_demux_thread", 1) != 0);
 
     ////////////////////////////////////////////////////////////////////
     // create time and clock control objects
@@ -550,6 +570,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         _adf4001_iface = boost::make_shared<b200_ref_pll_ctrl>(_spi_iface);
     }
 
+    startup_profile::begin("mb0: codec");
     ////////////////////////////////////////////////////////////////////
     // Init codec - turns on clocks
     ////////////////////////////////////////////////////////////////////
@@ -607,6 +628,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         .set(subdev_spec_t())
         .add_coerced_subscriber(boost::bind(&b200_impl::update_subdev_spec, this, "tx", _1));
 
+    startup_profile::begin("mb0: radios");
     ////////////////////////////////////////////////////////////////////
     // setup radio control
     ////////////////////////////////////////////////////////////////////
@@ -619,6 +641,8 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     _codec_mgr->init_codec();
     for (size_t i = 0; i < _radio_perifs.size(); i++)
         this->setup_radio(i);
+    BOOST_FOREACH(radio_perifs_t &perif, _radio_perifs)
+        perif.ctrl->set_posted_writes(device_addr.cast<size_t>("ctrl_posted_writes", 0));
 
     //now test each radio module's connection to the codec interface
     BOOST_FOREACH(radio_perifs_t &perif, _radio_perifs)
@@ -639,6 +663,10 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     //re-sync the times when the tick rate changes
     _tree->access<double>(mb_path / "tick_rate")
         .add_coerced_subscriber(boost::bind(&b200_impl::sync_times, this));
+    _tree->create<time_spec_t>(mb_path / "time" / "estimate")
+        .set_publisher(boost::bind(&time_core_3000::get_time_estimate, _radio_perifs[0].time64, static_cast<double *>(NULL)));
+    _tree->create<double>(mb_path / "time" / "estimate_error")
+        .set_publisher(boost::bind(&time_core_3000::get_time_estimate_error, _radio_perifs[0].time64));
     _tree->create<time_spec_t>(mb_path / "time" / "pps")
         .set_publisher(boost::bind(&time_core_3000::get_time_last_pps, _radio_perifs[0].time64));
     BOOST_FOREACH(radio_perifs_t &perif, _radio_perifs)
@@ -687,6 +715,7 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
     _tree->create<dboard_eeprom_t>(mb_path / "dboards" / "A" / "tx_eeprom").set(db_eeprom);
     _tree->create<dboard_eeprom_t>(mb_path / "dboards" / "A" / "gdb_eeprom").set(db_eeprom);
 
+    startup_profile::begin("mb0: clock rate and frontends");
     ////////////////////////////////////////////////////////////////////
     // do some post-init tasks
     ////////////////////////////////////////////////////////////////////
@@ -721,6 +750,18 @@ b200_impl::b200_impl(const uhd::device_addr_t& device_addr, usb_device_handle::s
         _radio_perifs[i].ddc->set_host_rate(default_tick_rate / ad936x_manager::DEFAULT_DECIM);
         _radio_perifs[i].duc->set_host_rate(default_tick_rate / ad936x_manager::DEFAULT_INTERP);
     }
+    startup_profile::end();
+}
+
+//! format a transfer timing histogram as "<bucket us>:<count>" pairs
+static std::string xfer_hist_to_string(const std::vector<size_t> &hist)
+{
+    std::string out;
+    for (size_t i = 0; i < hist.size(); i++) {
+        if (hist[i] == 0) continue;
+        out += str(boost::format(" %u:%u") % (size_t(1) << i) % hist[i]);
+    }
+    return out;
 }
 
 b200_impl::~b200_impl(void)
@@ -728,6 +769,17 @@ b200_impl::~b200_impl(void)
     UHD_SAFE_CALL
     (
          _async_task.reset();
+         usb_zero_copy::sptr usb_xport = boost::dynamic_pointer_cast<usb_zero_copy>(_data_transport);
+         if (usb_xport) {
+             const usb_zero_copy::xfer_stats_t rx = usb_xport->get_recv_stats();
+             const usb_zero_copy::xfer_stats_t tx = usb_xport->get_send_stats();
+             UHD_LOG << "B200 data transport: " << rx.num_transfers << " RX transfers, latency (us)"
+                     << xfer_hist_to_string(rx.latency_hist) << ", resubmit gap (us)"
+                     << xfer_hist_to_string(rx.resubmit_hist) << std::endl;
+             UHD_LOG << "B200 data transport: " << tx.num_transfers << " TX transfers, latency (us)"
+                     << xfer_hist_to_string(tx.latency_hist) << ", resubmit gap (us)"
+                     << xfer_hist_to_string(tx.resubmit_hist) << std::endl;
+         }
     )
 }
 
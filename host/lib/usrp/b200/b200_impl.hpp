@@ -47,6 +47,7 @@
 #include <boost/assign.hpp>
 #include <boost/weak_ptr.hpp>
 #include "recv_packet_demuxer_3000.hpp"
+#include "../../transport/async_md_queue.hpp"
 static const uint8_t  B200_FW_COMPAT_NUM_MAJOR = 8;
 static const uint8_t  B200_FW_COMPAT_NUM_MINOR = 0;
 static const uint16_t B200_FPGA_COMPAT_NUM = 14;
@@ -150,7 +151,7 @@ private:
 
     //async ctrl + msgs
     uhd::msg_task::sptr _async_task;
-    typedef uhd::transport::bounded_buffer<uhd::async_metadata_t> async_md_type;
+    typedef uhd::transport::async_md_queue async_md_type;
     struct AsyncTaskData
     {
         boost::shared_ptr<async_md_type> async_md;
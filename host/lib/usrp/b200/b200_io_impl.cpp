@@ -18,6 +18,7 @@
 #include "b200_regs.hpp"
 #include "b200_impl.hpp"
 #include "validate_subdev_spec.hpp"
+#include "streamer_args.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "async_packet_handler.hpp"
@@ -326,7 +327,7 @@ boost::optional<uhd::msg_task::msg_type_t> b200_impl::handle_async_task(
         	ctrl->push_response(buff->cast<const uint32_t *>());
         }
         else{
-            return std::make_pair(sid, uhd::msg_task::buff_to_vector(buff->cast<uint8_t *>(), buff->size() ) );
+            return std::make_pair(sid, uhd::msg_task::buff_to_payload(buff->cast<const uint8_t *>(), buff->size() ) );
         }
         break;
     }
@@ -392,6 +393,7 @@ rx_streamer::sptr b200_impl::get_rx_stream(const uhd::stream_args_t &args_)
         set_auto_tick_rate(0, "", args.channels.size());
     }
     check_streamer_args(args, this->get_tick_rate(), "RX");
+    const streamer_args_t streamer_args(args);
 
     boost::shared_ptr<sph::recv_packet_streamer> my_streamer;
     for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
@@ -414,7 +416,16 @@ rx_streamer::sptr b200_impl::get_rx_stream(const uhd::stream_args_t &args_)
         ;
         const size_t bpp = _data_transport->get_recv_frame_size() - hdr_size;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-        size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+        const stream_profile_settings_t profile = compute_stream_profile(
+            streamer_args.get_profile(),
+            _tree->access<double>(fs_path("/mboards/0/rx_dsps") / radio_index / "rate" / "value").get(),
+            bpi, hdr_size, _data_transport->get_recv_frame_size()
+        );
+        size_t spp = streamer_args.get_spp(profile.spp ? profile.spp : bpp/bpi);
+        if (profile.spp and stream_i == 0) {
+            UHD_MSG(status) << "[B200] RX stream profile: " << profile.to_string()
+                << " (frames are set when the device is made)" << std::endl;
+        }
         spp = std::min<size_t>(4092, spp); //FPGA FIFO maximum for framing at full rate
 
         //make the new streamer given the samples per packet
@@ -453,6 +464,12 @@ rx_streamer::sptr b200_impl::get_rx_stream(const uhd::stream_args_t &args_)
         this->update_tick_rate(this->get_tick_rate());
         _tree->access<double>(str(boost::format("/mboards/0/rx_dsps/%u/rate/value") % radio_index)).update();
     }
+    //optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(streamer_args.get_convert_threads());
+    //keep large receive buffers out of the caches, see set_nontemporal_stores()
+    my_streamer->set_nontemporal_stores(streamer_args.get_nontemporal_stores());
+    //report the sample power in the metadata, see set_power_metadata()
+    my_streamer->set_power_metadata(streamer_args.get_power_meta());
     this->update_enables();
 
     return my_streamer;
@@ -468,11 +485,11 @@ void b200_impl::handle_overflow(const size_t radio_index)
         const bool in_continuous_streaming_mode = _radio_perifs[radio_index].framer->in_continuous_streaming_mode();
         //stop streaming
         my_streamer->issue_stream_cmd(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
-        //flush demux
-        _demux->realloc_sid(B200_RX_DATA0_SID);
-        _demux->realloc_sid(B200_RX_DATA1_SID);
         //flush actual transport
         while (_data_transport->get_recv_buff(0.001)){}
+        //flush demux, after the transport: its poller may have queued packets meanwhile
+        _demux->realloc_sid(B200_RX_DATA0_SID);
+        _demux->realloc_sid(B200_RX_DATA1_SID);
         //restart streaming
         if (in_continuous_streaming_mode)
         {
@@ -502,6 +519,7 @@ tx_streamer::sptr b200_impl::get_tx_stream(const uhd::stream_args_t &args_)
         set_auto_tick_rate(0, "", args.channels.size());
     }
     check_streamer_args(args, this->get_tick_rate(), "TX");
+    const streamer_args_t streamer_args(args);
 
     boost::shared_ptr<sph::send_packet_streamer> my_streamer;
     for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
@@ -522,7 +540,17 @@ tx_streamer::sptr b200_impl::get_tx_stream(const uhd::stream_args_t &args_)
             - sizeof(vrt::if_packet_info_t().tsi) //no int time ever used
         ;
         static const size_t bpp = _data_transport->get_send_frame_size() - hdr_size;
-        const size_t spp = bpp/convert::get_bytes_per_item(args.otw_format);
+        const size_t bpi = convert::get_bytes_per_item(args.otw_format);
+        const stream_profile_settings_t profile = compute_stream_profile(
+            streamer_args.get_profile(),
+            _tree->access<double>(fs_path("/mboards/0/tx_dsps") / radio_index / "rate" / "value").get(),
+            bpi, hdr_size, _data_transport->get_send_frame_size()
+        );
+        const size_t spp = profile.spp ? profile.spp : bpp/bpi;
+        if (profile.spp and stream_i == 0) {
+            UHD_MSG(status) << "[B200] TX stream profile: " << profile.to_string()
+                << " (frames are set when the device is made)" << std::endl;
+        }
 
         //make the new streamer given the samples per packet
         if (not my_streamer) my_streamer = boost::make_shared<sph::send_packet_streamer>(spp);
@@ -549,6 +577,9 @@ tx_streamer::sptr b200_impl::get_tx_stream(const uhd::stream_args_t &args_)
         my_streamer->set_async_receiver(boost::bind(
             &async_md_type::pop_with_timed_wait, _async_task_data->async_md, _1, _2
         ));
+        my_streamer->set_async_batch_receiver(boost::bind(
+            &async_md_type::pop_all_with_timed_wait, _async_task_data->async_md, _1, _2, _3
+        ));
         my_streamer->set_xport_chan_sid(stream_i, true, radio_index ? B200_TX_DATA1_SID : B200_TX_DATA0_SID);
         my_streamer->set_enable_trailer(false); //TODO not implemented trailer support yet
         perif.tx_streamer = my_streamer; //store weak pointer
@@ -557,6 +588,10 @@ tx_streamer::sptr b200_impl::get_tx_stream(const uhd::stream_args_t &args_)
         this->update_tick_rate(this->get_tick_rate());
         _tree->access<double>(str(boost::format("/mboards/0/tx_dsps/%u/rate/value") % radio_index)).update();
     }
+    //optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(streamer_args.get_convert_threads());
+    //optionally send on a separate thread while the next packets are converted
+    my_streamer->set_pipeline_depth(streamer_args.get_pipeline_depth());
     this->update_enables();
 
     return my_streamer;
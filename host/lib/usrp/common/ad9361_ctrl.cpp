@@ -21,6 +21,7 @@
 #include <uhd/types/serial.hpp>
 #include <cstring>
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
 #include <boost/utility.hpp>
 #include <boost/function.hpp>
 #include <boost/make_shared.hpp>
@@ -202,6 +203,29 @@ public:
         return _device.get_freq(direction);
     }
 
+    std::vector<double> set_hop_table(const std::string &which, const std::vector<double> &freqs)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+
+        //clip to known bounds, like tune()
+        const meta_range_t freq_range = ad9361_ctrl::get_rf_freq_range();
+        std::vector<double> clipped_freqs;
+        BOOST_FOREACH(const double freq, freqs) {
+            clipped_freqs.push_back(freq_range.clip(freq));
+        }
+
+        ad9361_device_t::direction_t direction = _get_direction_from_antenna(which);
+        return _device.set_hop_table(direction, clipped_freqs);
+    }
+
+    double hop(const std::string &which, const size_t index)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+
+        ad9361_device_t::direction_t direction = _get_direction_from_antenna(which);
+        return _device.hop(direction, index);
+    }
+
     //! turn on/off data port loopback
     void data_port_loopback(const bool on)
     {
@@ -249,6 +273,12 @@ public:
         return _device.set_bw_filter(direction, bw);
     }
 
+    void recalibrate()
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _device.recalibrate();
+    }
+
     std::vector<std::string> get_filter_names(const std::string &which)
     {
         boost::lock_guard<boost::mutex> lock(_mutex);
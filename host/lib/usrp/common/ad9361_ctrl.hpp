@@ -145,6 +145,12 @@ public:
     //! get the current frequency for the given frontend
     virtual double get_freq(const std::string &which) = 0;
 
+    //! precompute the synthesizer settings for a list of frequencies, returns the actual frequencies
+    virtual std::vector<double> set_hop_table(const std::string &which, const std::vector<double> &freqs) = 0;
+
+    //! tune to an entry of the hop table without rerunning calibrations
+    virtual double hop(const std::string &which, const size_t index) = 0;
+
     //! turn on/off Catalina's data port loopback
     virtual void data_port_loopback(const bool on) = 0;
 
@@ -164,6 +170,19 @@ public:
     virtual void set_filter(const std::string &which, const std::string &filter_name, const filter_info_base::sptr) = 0;
 
     virtual void output_digital_test_tone(bool enb) = 0;
+
+    //! drop cached calibration results and rerun the calibrations
+    virtual void recalibrate() = 0;
+
+    /*!
+     * Settings without a return value made between begin_batch() and
+     * commit() may be sent to the codec together, at commit() or with
+     * the next call that returns a value. Calls can nest.
+     */
+    virtual void begin_batch() {}
+
+    //! send the settings of a batch, see begin_batch()
+    virtual void commit() {}
 };
 
 }}
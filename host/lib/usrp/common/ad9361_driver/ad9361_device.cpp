@@ -101,6 +101,28 @@ const double ad9361_device_t::AD9361_RECOMMENDED_MAX_BANDWIDTH = 56e6;
 const double ad9361_device_t::DEFAULT_RX_FREQ = 800e6;
 const double ad9361_device_t::DEFAULT_TX_FREQ = 850e6;
 
+/* Poll a status register until (reg & mask) == value, instead of sleeping
+ * for a worst-case interval. Throws with the given error message if the
+ * status isn't reached within the timeout (seconds). The time the step
+ * actually took is logged and returned. */
+double ad9361_device_t::_wait_for_status(
+    const char *step, uint16_t reg, uint8_t mask, uint8_t value, double timeout)
+{
+    const boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::local_time();
+    boost::posix_time::time_duration elapsed;
+    while ((_io_iface->peek8(reg) & mask) != value) {
+        elapsed = boost::posix_time::microsec_clock::local_time() - start_time;
+        if (elapsed.total_microseconds() > (timeout * 1e6)) {
+            throw uhd::runtime_error(str(boost::format("[ad9361_device_t] %s") % step));
+        }
+        boost::this_thread::sleep(boost::posix_time::microseconds(100));
+    }
+    elapsed = boost::posix_time::microsec_clock::local_time() - start_time;
+    const double secs = elapsed.total_microseconds() / 1e6;
+    UHD_LOG << boost::format("[ad9361_device_t] wait for %s: %.3f ms\n") % step % (secs * 1e3);
+    return secs;
+}
+
 /* Program either the RX or TX FIR filter.
  *
  * The process is the same for both filters, but the function must be told
@@ -260,15 +282,7 @@ void ad9361_device_t::_calibrate_lock_bbpll()
     _io_iface->poke8(0x04d, 0x05);
 
     /* Wait for BBPLL lock. */
-    size_t count = 0;
-    while (!(_io_iface->peek8(0x05e) & 0x80)) {
-        if (count > 1000) {
-            throw uhd::runtime_error("[ad9361_device_t] BBPLL not locked");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(2));
-    }
+    _wait_for_status("BBPLL not locked", 0x05e, 0x80, 0x80, 2.0);
 }
 
 /* Calibrate the synthesizer charge pumps.
@@ -284,29 +298,13 @@ void ad9361_device_t::_calibrate_synth_charge_pumps()
     }
 
     /* Calibrate the RX synthesizer charge pump. */
-    size_t count = 0;
     _io_iface->poke8(0x23d, 0x04);
-    while (!(_io_iface->peek8(0x244) & 0x80)) {
-        if (count > 5) {
-            throw uhd::runtime_error("[ad9361_device_t] RX charge pump cal failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-    }
+    _wait_for_status("RX charge pump cal failure", 0x244, 0x80, 0x80, 0.01);
     _io_iface->poke8(0x23d, 0x00);
 
     /* Calibrate the TX synthesizer charge pump. */
-    count = 0;
     _io_iface->poke8(0x27d, 0x04);
-    while (!(_io_iface->peek8(0x284) & 0x80)) {
-        if (count > 5) {
-            throw uhd::runtime_error("[ad9361_device_t] TX charge pump cal failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-    }
+    _wait_for_status("TX charge pump cal failure", 0x284, 0x80, 0x80, 0.01);
     _io_iface->poke8(0x27d, 0x00);
 }
 
@@ -358,16 +356,8 @@ double ad9361_device_t::_calibrate_baseband_rx_analog_filter(double req_rfbw)
     _io_iface->poke8(0x1e3, 0x02);
 
     /* Run the calibration! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x80);
-    while (_io_iface->peek8(0x016) & 0x80) {
-        if (count > 100) {
-            throw uhd::runtime_error("[ad9361_device_t] RX baseband filter cal FAILURE");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-    }
+    _wait_for_status("RX baseband filter cal FAILURE", 0x016, 0x80, 0x00, 0.1);
 
     /* Disable RX1 & RX2 filter tuners. */
     _io_iface->poke8(0x1e2, 0x03);
@@ -414,17 +404,8 @@ double ad9361_device_t::_calibrate_baseband_tx_analog_filter(double req_rfbw)
     _io_iface->poke8(0x0ca, 0x22);
 
     /* Calibrate! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x40);
-    while (_io_iface->peek8(0x016) & 0x40) {
-        if (count > 100) {
-            throw uhd::runtime_error("[ad9361_device_t] TX baseband filter cal FAILURE");
-            break;
-        }
-
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
-    }
+    _wait_for_status("TX baseband filter cal FAILURE", 0x016, 0x40, 0x00, 0.1);
 
     /* Disable the filter tuner. */
     _io_iface->poke8(0x0ca, 0x26);
@@ -735,16 +716,8 @@ void ad9361_device_t::_calibrate_baseband_dc_offset()
     _io_iface->poke8(0x194, 0x01); // More calibration settings
 
     /* Start that calibration, baby. */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x01);
-    while (_io_iface->peek8(0x016) & 0x01) {
-        if (count > 100) {
-            throw uhd::runtime_error("[ad9361_device_t] Baseband DC Offset Calibration Failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
-    }
+    _wait_for_status("Baseband DC Offset Calibration Failure", 0x016, 0x01, 0x00, 0.5);
 }
 
 /* Calibrate the RF DC offset.
@@ -768,16 +741,8 @@ void ad9361_device_t::_calibrate_rf_dc_offset()
     _io_iface->poke8(0x189, 0x30);
 
     /* Run the calibration! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x02);
-    while (_io_iface->peek8(0x016) & 0x02) {
-        if (count > 200) {
-            throw uhd::runtime_error("[ad9361_device_t] RF DC Offset Calibration Failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
-    }
+    _wait_for_status("RF DC Offset Calibration Failure", 0x016, 0x02, 0x00, 10.0);
 
     _io_iface->poke8(0x18b, 0x8d); // Enable RF DC tracking
 }
@@ -819,16 +784,8 @@ void ad9361_device_t::_calibrate_rx_quadrature()
     double current_tx_freq = _tx_freq;
     _tune_helper(TX, _rx_freq + _rx_bb_lp_bw / 2.0);
 
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x20);
-    while (_io_iface->peek8(0x016) & 0x20) {
-        if (count > 1000) {
-            throw uhd::runtime_error("[ad9361_device_t] Rx Quadrature Calibration Failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
-    }
+    _wait_for_status("Rx Quadrature Calibration Failure", 0x016, 0x20, 0x00, 5.0);
 
     _io_iface->poke8(0x057, 0x30); // Re-enable Tx mixers
 
@@ -887,16 +844,8 @@ void ad9361_device_t::_tx_quadrature_cal_routine() {
     _io_iface->poke8(0x0ae, 0x00); // Cal LPF gain index (split mode)
 
     /* Now, calibrate the TX quadrature! */
-    size_t count = 0;
     _io_iface->poke8(0x016, 0x10);
-    while (_io_iface->peek8(0x016) & 0x10) {
-        if (count > 100) {
-            throw uhd::runtime_error("[ad9361_device_t] TX Quadrature Calibration Failure");
-            break;
-        }
-        count++;
-        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-    }
+    _wait_for_status("TX Quadrature Calibration Failure", 0x016, 0x10, 0x00, 1.0);
 }
 
 /* Run the TX quadrature calibration.
@@ -942,6 +891,136 @@ void ad9361_device_t::_calibrate_tx_quadrature()
 }
 
 
+/***********************************************************************
+ * Calibration Result Cache
+ ***********************************************************************/
+
+/* The quadrature calibrations leave their results in the correction word
+ * registers: 0x08E-0x09D for both TX outputs, 0x170-0x184 for all RX
+ * inputs. Reading them back after a calibration and writing them again
+ * later restores the calibration without rerunning it. */
+static const uint16_t TX_QUAD_CAL_REG_FIRST = 0x08E;
+static const uint16_t TX_QUAD_CAL_REG_LAST  = 0x09D;
+static const uint16_t RX_QUAD_CAL_REG_FIRST = 0x170;
+static const uint16_t RX_QUAD_CAL_REG_LAST  = 0x184;
+
+//! Results are reused within this temperature range (degrees C)
+static const double AD9361_CAL_TEMP_BUCKET = 10.0;
+
+bool ad9361_device_t::cal_key_t::operator<(const cal_key_t &rhs) const
+{
+    if (direction != rhs.direction) return direction < rhs.direction;
+    if (clock_rate != rhs.clock_rate) return clock_rate < rhs.clock_rate;
+    if (band != rhs.band) return band < rhs.band;
+    if (bandwidth != rhs.bandwidth) return bandwidth < rhs.bandwidth;
+    if (chains != rhs.chains) return chains < rhs.chains;
+    return temp_bucket < rhs.temp_bucket;
+}
+
+/* Build the cache key for a calibration at the given frequency. Returns
+ * false if the chip temperature can't be read, the result must then not
+ * be cached. */
+bool ad9361_device_t::_get_cal_key(direction_t direction, double freq, cal_key_t &key)
+{
+    double temp;
+    try {
+        temp = _get_temperature(0.0);
+    } catch (const uhd::runtime_error &) {
+        return false;
+    }
+
+    key.direction = direction;
+    key.clock_rate = int64_t(_baseband_bw + 0.5);
+    key.band = int64_t(std::floor(freq / AD9361_CAL_VALID_WINDOW));
+    key.bandwidth = int64_t(((direction == RX) ? _rx_bb_lp_bw : _tx_bb_lp_bw) + 0.5);
+    key.chains = (direction == RX) ? (_regs.rxfilt & 0xC0) : (_regs.txfilt & 0xC0);
+    key.temp_bucket = int(std::floor(temp / AD9361_CAL_TEMP_BUCKET));
+    return true;
+}
+
+bool ad9361_device_t::_restore_quadrature_cal(direction_t direction, double freq)
+{
+    cal_key_t key;
+    if (not _get_cal_key(direction, freq, key)) return false;
+    std::map<cal_key_t, std::vector<uint8_t> >::const_iterator it = _cal_cache.find(key);
+    if (it == _cal_cache.end()) return false;
+
+    const uint16_t first = (direction == RX) ? RX_QUAD_CAL_REG_FIRST : TX_QUAD_CAL_REG_FIRST;
+    for (size_t i = 0; i < it->second.size(); i++) {
+        _io_iface->poke8(first + i, it->second[i]);
+    }
+    UHD_LOG << boost::format("[ad9361_device_t] Restored cached %s quadrature calibration at %.3f MHz\n")
+        % ((direction == RX) ? "RX" : "TX") % (freq / 1e6);
+    return true;
+}
+
+void ad9361_device_t::_store_quadrature_cal(direction_t direction, double freq)
+{
+    cal_key_t key;
+    if (not _get_cal_key(direction, freq, key)) return;
+
+    const uint16_t first = (direction == RX) ? RX_QUAD_CAL_REG_FIRST : TX_QUAD_CAL_REG_FIRST;
+    const uint16_t last = (direction == RX) ? RX_QUAD_CAL_REG_LAST : TX_QUAD_CAL_REG_LAST;
+    std::vector<uint8_t> &regs = _cal_cache[key];
+    regs.clear();
+    for (uint16_t addr = first; addr <= last; addr++) {
+        regs.push_back(_io_iface->peek8(addr));
+    }
+}
+
+/* Run the TX quadrature calibration, unless there is a cached result
+ * for the current conditions. */
+void ad9361_device_t::_run_tx_quadrature_cal(double freq)
+{
+    if (_restore_quadrature_cal(TX, freq)) return;
+    _calibrate_tx_quadrature();
+    _store_quadrature_cal(TX, freq);
+}
+
+/* Run the single shot RX quadrature calibration, unless there is a cached
+ * result for the current conditions. */
+void ad9361_device_t::_run_rx_quadrature_cal(double freq)
+{
+    if (_restore_quadrature_cal(RX, freq)) {
+        _io_iface->poke8(0x169, 0xc0); // Tracking stays off, like after a calibration
+        return;
+    }
+    _calibrate_rx_quadrature();
+    _store_quadrature_cal(RX, freq);
+}
+
+void ad9361_device_t::recalibrate()
+{
+    boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+
+    _cal_cache.clear();
+
+    /* Calibrations run in the ALERT state */
+    int not_in_alert = 0;
+    if ((_io_iface->peek8(0x017) & 0x0F) != 5) {
+        not_in_alert = 1;
+        _io_iface->poke8(0x014, 0x01);
+    }
+
+    _calibrate_rf_dc_offset();
+    if (!_use_iq_balance_tracking)
+        _run_rx_quadrature_cal(_rx_freq);
+    if (_use_dc_offset_tracking)
+        _configure_bb_dc_tracking();
+    _last_rx_cal_freq = _rx_freq;
+
+    if (_regs.txfilt & 0xC0)
+        _run_tx_quadrature_cal(_tx_freq);
+    _last_tx_cal_freq = _tx_freq;
+
+    if (_use_iq_balance_tracking)
+        _configure_rx_iq_tracking();
+
+    if (not_in_alert) {
+        _io_iface->poke8(0x014, 0x21);
+    }
+}
+
 /***********************************************************************
  * Other Misc Setup Functions
  ***********************************************************************/
@@ -1097,12 +1176,12 @@ void ad9361_device_t::_setup_gain_control(bool agc)
     }
 }
 
-/* Setup the RX or TX synthesizers.
+/* Compute the RX or TX synthesizer setup.
  *
  * This setup depends on a fixed look-up table, which is stored in an
  * included header file. The table is indexed based on the passed VCO rate.
- */
-void ad9361_device_t::_setup_synth(direction_t direction, double vcorate)
+ * The register writes are appended to 'regs' in programming order. */
+void ad9361_device_t::_get_synth_regs(direction_t direction, double vcorate, reg_list_t &regs)
 {
     /* The vcorates in the vco_index array represent lower boundaries for
      * rates. Once we find a match, we use that index to look-up the rest of
@@ -1133,31 +1212,31 @@ void ad9361_device_t::_setup_synth(direction_t direction, double vcorate)
 
     /* ... annnd program! */
     if (direction == RX) {
-        _io_iface->poke8(0x23a, 0x40 | vco_output_level);
-        _io_iface->poke8(0x239, 0xC0 | vco_varactor);
-        _io_iface->poke8(0x242, vco_bias_ref | (vco_bias_tcf << 3));
-        _io_iface->poke8(0x238, (vco_cal_offset << 3));
-        _io_iface->poke8(0x245, 0x00);
-        _io_iface->poke8(0x251, vco_varactor_ref);
-        _io_iface->poke8(0x250, 0x70);
-        _io_iface->poke8(0x23b, 0x80 | charge_pump_curr);
-        _io_iface->poke8(0x23e, loop_filter_c1 | (loop_filter_c2 << 4));
-        _io_iface->poke8(0x23f, loop_filter_c3 | (loop_filter_r1 << 4));
-        _io_iface->poke8(0x240, loop_filter_r3);
+        regs.push_back(reg_t(0x23a, 0x40 | vco_output_level));
+        regs.push_back(reg_t(0x239, 0xC0 | vco_varactor));
+        regs.push_back(reg_t(0x242, vco_bias_ref | (vco_bias_tcf << 3)));
+        regs.push_back(reg_t(0x238, (vco_cal_offset << 3)));
+        regs.push_back(reg_t(0x245, 0x00));
+        regs.push_back(reg_t(0x251, vco_varactor_ref));
+        regs.push_back(reg_t(0x250, 0x70));
+        regs.push_back(reg_t(0x23b, 0x80 | charge_pump_curr));
+        regs.push_back(reg_t(0x23e, loop_filter_c1 | (loop_filter_c2 << 4)));
+        regs.push_back(reg_t(0x23f, loop_filter_c3 | (loop_filter_r1 << 4)));
+        regs.push_back(reg_t(0x240, loop_filter_r3));
     } else if (direction == TX) {
-        _io_iface->poke8(0x27a, 0x40 | vco_output_level);
-        _io_iface->poke8(0x279, 0xC0 | vco_varactor);
-        _io_iface->poke8(0x282, vco_bias_ref | (vco_bias_tcf << 3));
-        _io_iface->poke8(0x278, (vco_cal_offset << 3));
-        _io_iface->poke8(0x285, 0x00);
-        _io_iface->poke8(0x291, vco_varactor_ref);
-        _io_iface->poke8(0x290, 0x70);
-        _io_iface->poke8(0x27b, 0x80 | charge_pump_curr);
-        _io_iface->poke8(0x27e, loop_filter_c1 | (loop_filter_c2 << 4));
-        _io_iface->poke8(0x27f, loop_filter_c3 | (loop_filter_r1 << 4));
-        _io_iface->poke8(0x280, loop_filter_r3);
+        regs.push_back(reg_t(0x27a, 0x40 | vco_output_level));
+        regs.push_back(reg_t(0x279, 0xC0 | vco_varactor));
+        regs.push_back(reg_t(0x282, vco_bias_ref | (vco_bias_tcf << 3)));
+        regs.push_back(reg_t(0x278, (vco_cal_offset << 3)));
+        regs.push_back(reg_t(0x285, 0x00));
+        regs.push_back(reg_t(0x291, vco_varactor_ref));
+        regs.push_back(reg_t(0x290, 0x70));
+        regs.push_back(reg_t(0x27b, 0x80 | charge_pump_curr));
+        regs.push_back(reg_t(0x27e, loop_filter_c1 | (loop_filter_c2 << 4)));
+        regs.push_back(reg_t(0x27f, loop_filter_c3 | (loop_filter_r1 << 4)));
+        regs.push_back(reg_t(0x280, loop_filter_r3));
     } else {
-        throw uhd::runtime_error("[ad9361_device_t] [_setup_synth] INVALID_CODE_PATH");
+        throw uhd::runtime_error("[ad9361_device_t] [_get_synth_regs] INVALID_CODE_PATH");
     }
 }
 
@@ -1255,6 +1334,16 @@ void ad9361_device_t::_reprogram_gains()
  * Calculate the VCO settings for the requested frquency, and then either
  * tune the RX or TX VCO. */
 double ad9361_device_t::_tune_helper(direction_t direction, const double value)
+{
+    synth_profile_t profile;
+    _compute_synth_profile(direction, value, profile);
+    return _apply_synth_profile(direction, profile);
+}
+
+/* Calculate everything needed to tune the RX or TX VCO to the requested
+ * frequency, without touching the chip. */
+void ad9361_device_t::_compute_synth_profile(
+    direction_t direction, const double value, synth_profile_t &profile)
 {
     /* The RFPLL runs from 6 GHz - 12 GHz */
     const double fref = 80e6;
@@ -1279,95 +1368,114 @@ double ad9361_device_t::_tune_helper(direction_t direction, const double value)
     int nfrac = static_cast<int>(((vcorate / fref) - nint) * modulus);
 
     double actual_vcorate = fref * (nint + (double) (nfrac) / modulus);
-    double actual_lo = actual_vcorate / vcodiv;
 
-    if (direction == RX) {
+    profile.req_freq = value;
+    profile.actual_lo = actual_vcorate / vcodiv;
+    profile.vcodiv = i & 0x0F;
+    profile.synth_regs.clear();
+    profile.freq_regs.clear();
 
-        _req_rx_freq = value;
+    if (direction == RX) {
 
         /* Set band-specific settings. */
+        profile.inputsel_mask = 0x3F;
         if (value < _client_params->get_band_edge(AD9361_RX_BAND0)) {
-            _regs.inputsel = (_regs.inputsel & 0xC0) | 0x30; // Port C, balanced
+            profile.inputsel_bits = 0x30; // Port C, balanced
         } else if ((value
                 >= _client_params->get_band_edge(AD9361_RX_BAND0))
                 && (value
                         < _client_params->get_band_edge(AD9361_RX_BAND1))) {
-            _regs.inputsel = (_regs.inputsel & 0xC0) | 0x0C; // Port B, balanced
+            profile.inputsel_bits = 0x0C; // Port B, balanced
         } else if ((value
                 >= _client_params->get_band_edge(AD9361_RX_BAND1))
                 && (value <= 6e9)) {
-            _regs.inputsel = (_regs.inputsel & 0xC0) | 0x03; // Port A, balanced
+            profile.inputsel_bits = 0x03; // Port A, balanced
         } else {
             throw uhd::runtime_error("[ad9361_device_t] [_tune_helper] INVALID_CODE_PATH");
         }
 
-        _io_iface->poke8(0x004, _regs.inputsel);
-
-        /* Store vcodiv setting. */
-        _regs.vcodivs = (_regs.vcodivs & 0xF0) | (i & 0x0F);
-
         /* Setup the synthesizer. */
-        _setup_synth(RX, actual_vcorate);
+        _get_synth_regs(RX, actual_vcorate, profile.synth_regs);
 
         /* Tune!!!! */
-        _io_iface->poke8(0x233, nfrac & 0xFF);
-        _io_iface->poke8(0x234, (nfrac >> 8) & 0xFF);
-        _io_iface->poke8(0x235, (nfrac >> 16) & 0xFF);
-        _io_iface->poke8(0x232, (nint >> 8) & 0xFF);
-        _io_iface->poke8(0x231, nint & 0xFF);
-        _io_iface->poke8(0x005, _regs.vcodivs);
-
-        /* Lock the PLL! */
-        boost::this_thread::sleep(boost::posix_time::milliseconds(2));
-        if ((_io_iface->peek8(0x247) & 0x02) == 0) {
-            throw uhd::runtime_error("[ad9361_device_t] RX PLL NOT LOCKED");
-        }
-
-        _rx_freq = actual_lo;
-
-        return actual_lo;
+        profile.freq_regs.push_back(reg_t(0x233, nfrac & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x234, (nfrac >> 8) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x235, (nfrac >> 16) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x232, (nint >> 8) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x231, nint & 0xFF));
 
     } else {
 
-        _req_tx_freq = value;
-
         /* Set band-specific settings. */
+        profile.inputsel_mask = 0x40;
         if (value < _client_params->get_band_edge(AD9361_TX_BAND0)) {
-            _regs.inputsel = _regs.inputsel | 0x40;
+            profile.inputsel_bits = 0x40;
         } else if ((value
                 >= _client_params->get_band_edge(AD9361_TX_BAND0))
                 && (value <= 6e9)) {
-            _regs.inputsel = _regs.inputsel & 0xBF;
+            profile.inputsel_bits = 0x00;
         } else {
             throw uhd::runtime_error("[ad9361_device_t] [_tune_helper] INVALID_CODE_PATH");
         }
 
-        _io_iface->poke8(0x004, _regs.inputsel);
-
-        /* Store vcodiv setting. */
-        _regs.vcodivs = (_regs.vcodivs & 0x0F) | ((i & 0x0F) << 4);
-
         /* Setup the synthesizer. */
-        _setup_synth(TX, actual_vcorate);
+        _get_synth_regs(TX, actual_vcorate, profile.synth_regs);
 
         /* Tune it, homey. */
-        _io_iface->poke8(0x273, nfrac & 0xFF);
-        _io_iface->poke8(0x274, (nfrac >> 8) & 0xFF);
-        _io_iface->poke8(0x275, (nfrac >> 16) & 0xFF);
-        _io_iface->poke8(0x272, (nint >> 8) & 0xFF);
-        _io_iface->poke8(0x271, nint & 0xFF);
-        _io_iface->poke8(0x005, _regs.vcodivs);
-
-        /* Lock the PLL! */
-        boost::this_thread::sleep(boost::posix_time::milliseconds(2));
-        if ((_io_iface->peek8(0x287) & 0x02) == 0) {
-            throw uhd::runtime_error("[ad9361_device_t] TX PLL NOT LOCKED");
-        }
+        profile.freq_regs.push_back(reg_t(0x273, nfrac & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x274, (nfrac >> 8) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x275, (nfrac >> 16) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x272, (nint >> 8) & 0xFF));
+        profile.freq_regs.push_back(reg_t(0x271, nint & 0xFF));
+    }
+}
+
+/* Program a precomputed synthesizer profile and wait for the PLL to lock.
+ *
+ * Synthesizer LUT registers that already hold the right value are skipped,
+ * so hopping within one VCO range only writes the frequency words. */
+double ad9361_device_t::_apply_synth_profile(direction_t direction, const synth_profile_t &profile)
+{
+    reg_list_t &curr_synth_regs = (direction == RX) ? _rx_synth_regs : _tx_synth_regs;
 
-        _tx_freq = actual_lo;
+    const uint8_t inputsel = (_regs.inputsel & ~profile.inputsel_mask) | profile.inputsel_bits;
+    if (inputsel != _regs.inputsel || curr_synth_regs.empty()) {
+        _regs.inputsel = inputsel;
+        _io_iface->poke8(0x004, _regs.inputsel);
+    }
+
+    /* Store vcodiv setting. */
+    if (direction == RX) {
+        _regs.vcodivs = (_regs.vcodivs & 0xF0) | profile.vcodiv;
+    } else {
+        _regs.vcodivs = (_regs.vcodivs & 0x0F) | (profile.vcodiv << 4);
+    }
+
+    /* Setup the synthesizer. */
+    for (size_t i = 0; i < profile.synth_regs.size(); i++) {
+        if (i < curr_synth_regs.size() && curr_synth_regs[i] == profile.synth_regs[i]) continue;
+        _io_iface->poke8(profile.synth_regs[i].first, profile.synth_regs[i].second);
+    }
+    curr_synth_regs = profile.synth_regs;
 
-        return actual_lo;
+    /* The frequency words are always written, the last one starts the VCO cal. */
+    for (size_t i = 0; i < profile.freq_regs.size(); i++) {
+        _io_iface->poke8(profile.freq_regs[i].first, profile.freq_regs[i].second);
     }
+    _io_iface->poke8(0x005, _regs.vcodivs);
+
+    /* Lock the PLL! */
+    if (direction == RX) {
+        _wait_for_status("RX PLL NOT LOCKED", 0x247, 0x02, 0x02, 0.01);
+        _req_rx_freq = profile.req_freq;
+        _rx_freq = profile.actual_lo;
+    } else {
+        _wait_for_status("TX PLL NOT LOCKED", 0x287, 0x02, 0x02, 0.01);
+        _req_tx_freq = profile.req_freq;
+        _tx_freq = profile.actual_lo;
+    }
+
+    return profile.actual_lo;
 }
 
 /* Configure the various clock / sample rates in the RX and TX chains.
@@ -1521,6 +1629,7 @@ double ad9361_device_t::_setup_rates(const double rate)
 void ad9361_device_t::initialize()
 {
     boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+    const boost::posix_time::ptime init_start = boost::posix_time::microsec_clock::local_time();
 
     /* Initialize shadow registers. */
     _regs.vcodivs = 0x00;
@@ -1543,6 +1652,8 @@ void ad9361_device_t::initialize()
     _adcclock_freq = 0.0;
     _rx_bbf_tunediv = 0;
     _curr_gain_table = 0;
+    _rx_synth_regs.clear();
+    _tx_synth_regs.clear();
     _rx1_gain = 0;
     _rx2_gain = 0;
     _tx1_gain = 0;
@@ -1706,7 +1817,7 @@ void ad9361_device_t::initialize()
     _io_iface->poke8(0x015, 0x04); // dual synth mode, synth en ctrl en
     _io_iface->poke8(0x014, 0x05); // use SPI for TXNRX ctrl, to ALERT, TX on
     _io_iface->poke8(0x013, 0x01); // enable ENSM
-    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    _wait_for_status("AD9361 not in ALERT during init", 0x017, 0x0F, 0x05, 0.01);
 
     _calibrate_synth_charge_pumps();
 
@@ -1778,6 +1889,9 @@ void ad9361_device_t::initialize()
 
     /* Set TXers & RXers on (only works in FDD mode) */
     _io_iface->poke8(0x014, 0x21);
+
+    UHD_LOG << boost::format("[ad9361_device_t::initialize] took %.1f ms\n")
+        % ((boost::posix_time::microsec_clock::local_time() - init_start).total_microseconds() / 1e3);
 }
 
 void ad9361_device_t::set_io_iface(ad9361_io::sptr io_iface)
@@ -1846,7 +1960,7 @@ double ad9361_device_t::set_clock_rate(const double req_rate)
     _io_iface->poke8(0x015, 0x04); //dual synth mode, synth en ctrl en
     _io_iface->poke8(0x014, 0x05); //use SPI for TXNRX ctrl, to ALERT, TX on
     _io_iface->poke8(0x013, 0x01); //enable ENSM
-    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    _wait_for_status("AD9361 not in ALERT during clock rate change", 0x017, 0x0F, 0x05, 0.01);
 
     _calibrate_synth_charge_pumps();
 
@@ -1865,7 +1979,7 @@ double ad9361_device_t::set_clock_rate(const double req_rate)
 
     _calibrate_baseband_dc_offset();
     _calibrate_rf_dc_offset();
-    _calibrate_rx_quadrature();
+    _run_rx_quadrature_cal(_rx_freq);
 
     /*
      * Rx BB DC and IQ tracking are both disabled by calibration at this
@@ -1985,7 +2099,7 @@ void ad9361_device_t::set_active_chains(bool tx1, bool tx2, bool rx1, bool rx2)
      * is > 100 MHz). Late calibration provides better performance.
      */
     if (tx1 | tx2)
-        _calibrate_tx_quadrature();
+        _run_tx_quadrature_cal(_tx_freq);
 
     /* Put back into FDD state if necessary */
     if (set_back_to_fdd)
@@ -2048,13 +2162,13 @@ double ad9361_device_t::tune(direction_t direction, const double value)
         if (direction == RX) {
             _calibrate_rf_dc_offset();
             if (!_use_iq_balance_tracking)
-                _calibrate_rx_quadrature();
+                _run_rx_quadrature_cal(tune_freq);
             if (_use_dc_offset_tracking)
                 _configure_bb_dc_tracking();
 
             _last_rx_cal_freq = tune_freq;
         } else {
-            _calibrate_tx_quadrature();
+            _run_tx_quadrature_cal(tune_freq);
             _last_tx_cal_freq = tune_freq;
         }
 
@@ -2071,6 +2185,60 @@ double ad9361_device_t::tune(direction_t direction, const double value)
     return tune_freq;
 }
 
+std::vector<double> ad9361_device_t::set_hop_table(direction_t direction, const std::vector<double> &freqs)
+{
+    boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+
+    std::vector<synth_profile_t> table(freqs.size());
+    std::vector<double> actual_freqs(freqs.size());
+    for (size_t i = 0; i < freqs.size(); i++) {
+        _compute_synth_profile(direction, freqs[i], table[i]);
+        actual_freqs[i] = table[i].actual_lo;
+    }
+
+    if (direction == RX) {
+        _rx_hop_table.swap(table);
+    } else {
+        _tx_hop_table.swap(table);
+    }
+    return actual_freqs;
+}
+
+double ad9361_device_t::hop(direction_t direction, const size_t index)
+{
+    boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+
+    const std::vector<synth_profile_t> &table = (direction == RX) ? _rx_hop_table : _tx_hop_table;
+    if (index >= table.size()) {
+        throw uhd::index_error(str(
+            boost::format("[ad9361_device_t] hop index %d out of range for a table of %d entries")
+            % index % table.size()));
+    }
+
+    /* Same as tune(): retune in the ALERT state and return to FDD after. */
+    int not_in_alert = 0;
+    if ((_io_iface->peek8(0x017) & 0x0F) != 5) {
+        not_in_alert = 1;
+        _io_iface->poke8(0x014, 0x01);
+    }
+
+    const double tune_freq = _apply_synth_profile(direction, table[index]);
+
+    /* The gain indices only need reprogramming if the gain table changed. */
+    if (direction == RX) {
+        const uint8_t last_gain_table = _curr_gain_table;
+        _program_gain_table();
+        if (_curr_gain_table != last_gain_table)
+            _reprogram_gains();
+    }
+
+    if (not_in_alert) {
+        _io_iface->poke8(0x014, 0x21);
+    }
+
+    return tune_freq;
+}
+
 /* Get the current RX or TX frequency. */
 double ad9361_device_t::get_freq(direction_t direction)
 {
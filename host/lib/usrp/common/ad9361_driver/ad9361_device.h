@@ -115,6 +115,20 @@ public:
     /* Get the current RX or TX frequency. */
     double get_freq(direction_t direction);
 
+    /* Precompute the synthesizer settings for a list of RX or TX frequencies.
+     *
+     * Replaces any previous table for that direction. Returns the actual LO
+     * frequency of each entry. */
+    std::vector<double> set_hop_table(direction_t direction, const std::vector<double> &freqs);
+
+    /* Tune to an entry of the hop table.
+     *
+     * Only the registers that differ from the current synthesizer setup are
+     * written. Unlike tune(), no calibrations are rerun, so the table should
+     * stay within AD9361_CAL_VALID_WINDOW of the last tune() or use
+     * recalibrate(). */
+    double hop(direction_t direction, const size_t index);
+
     /* Set the gain of RX1, RX2, TX1, or TX2.
      *
      * Note that the 'value' passed to this function is the actual gain value,
@@ -165,6 +179,10 @@ public:
 
     std::vector<std::string> get_filter_names(direction_t direction);
 
+    /* Drop all cached calibration results and rerun the RF DC offset and
+     * quadrature calibrations at the current frequencies. */
+    void recalibrate();
+
     //Constants
     static const double AD9361_MAX_GAIN;
     static const double AD9361_MAX_CLOCK_RATE;
@@ -196,12 +214,30 @@ private:    //Methods
     void _program_mixer_gm_subtable();
     void _program_gain_table();
     void _setup_gain_control(bool use_agc);
-    void _setup_synth(direction_t direction, double vcorate);
+    typedef std::pair<uint16_t, uint8_t> reg_t;
+    typedef std::vector<reg_t> reg_list_t;
+
+    /* Everything needed to tune one RF synthesizer, see _tune_helper(). */
+    struct synth_profile_t
+    {
+        double      req_freq;
+        double      actual_lo;
+        uint8_t     inputsel_mask;
+        uint8_t     inputsel_bits;
+        uint8_t     vcodiv;
+        reg_list_t  synth_regs;
+        reg_list_t  freq_regs;
+    };
+
+    void _get_synth_regs(direction_t direction, double vcorate, reg_list_t &regs);
+    void _compute_synth_profile(direction_t direction, const double value, synth_profile_t &profile);
+    double _apply_synth_profile(direction_t direction, const synth_profile_t &profile);
     double _tune_bbvco(const double rate);
     void _reprogram_gains();
     double _tune_helper(direction_t direction, const double value);
     double _setup_rates(const double rate);
     double _get_temperature(const double cal_offset, const double timeout = 0.1);
+    double _wait_for_status(const char *step, uint16_t reg, uint8_t mask, uint8_t value, double timeout);
     void _configure_bb_dc_tracking();
     void _configure_rx_iq_tracking();
     void _setup_agc(chain_t chain, gain_mode_t gain_mode);
@@ -220,6 +256,25 @@ private:    //Methods
     void _set_filter_lp_bb(direction_t direction, filter_info_base::sptr filter);
     void _set_filter_lp_tia_sec(direction_t direction, filter_info_base::sptr filter);
 
+    /* Identifies the conditions a quadrature calibration was run under.
+     * The correction words only carry over to the same clock rate, band,
+     * analog bandwidth, active chains and a similar chip temperature. */
+    struct cal_key_t
+    {
+        direction_t direction;
+        int64_t     clock_rate;
+        int64_t     band;
+        int64_t     bandwidth;
+        uint8_t     chains;
+        int         temp_bucket;
+        bool operator<(const cal_key_t &rhs) const;
+    };
+    bool _get_cal_key(direction_t direction, double freq, cal_key_t &key);
+    bool _restore_quadrature_cal(direction_t direction, double freq);
+    void _store_quadrature_cal(direction_t direction, double freq);
+    void _run_tx_quadrature_cal(double freq);
+    void _run_rx_quadrature_cal(double freq);
+
 private:    //Members
     struct chip_regs_t
     {
@@ -281,6 +336,11 @@ private:    //Members
     boost::recursive_mutex  _mutex;
     bool _use_dc_offset_tracking;
     bool _use_iq_balance_tracking;
+    //Quadrature correction words from earlier calibrations
+    std::map<cal_key_t, std::vector<uint8_t> > _cal_cache;
+    //Synthesizer LUT registers as last written, and the hop tables
+    reg_list_t                  _rx_synth_regs, _tx_synth_regs;
+    std::vector<synth_profile_t> _rx_hop_table, _tx_hop_table;
 };
 
 }}  //namespace
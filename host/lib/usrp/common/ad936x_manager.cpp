@@ -66,6 +66,7 @@ class ad936x_manager_impl : public ad936x_manager
      ***********************************************************************/
     void init_codec()
     {
+        _codec_ctrl->begin_batch();
         BOOST_FOREACH(const std::string &rx_fe, _rx_frontends) {
             _codec_ctrl->set_gain(rx_fe, DEFAULT_GAIN);
             _codec_ctrl->set_bw_filter(rx_fe, DEFAULT_BANDWIDTH);
@@ -79,6 +80,7 @@ class ad936x_manager_impl : public ad936x_manager
             _codec_ctrl->set_bw_filter(tx_fe, DEFAULT_BANDWIDTH);
             _codec_ctrl->tune(tx_fe, DEFAULT_FREQ);
         }
+        _codec_ctrl->commit();
     }
 
 
@@ -250,6 +252,13 @@ class ad936x_manager_impl : public ad936x_manager
             .set_publisher(boost::bind(&ad9361_ctrl::get_freq, _codec_ctrl, key))
             .set_coercer(boost::bind(&ad9361_ctrl::tune, _codec_ctrl, key, _1))
         ;
+        subtree->create<std::vector<double> >("freq/hop_table")
+            .set_coercer(boost::bind(&ad9361_ctrl::set_hop_table, _codec_ctrl, key, _1))
+            .set(std::vector<double>())
+        ;
+        subtree->create<size_t>("freq/hop_index")
+            .add_coerced_subscriber(boost::bind(&ad9361_ctrl::hop, _codec_ctrl, key, _1))
+        ;
 
         // Frontend corrections
         if(dir == RX_DIRECTION)
@@ -22,9 +22,12 @@
 #include <uhd/types/dict.hpp>
 #include <uhd/types/ranges.hpp>
 #include <uhd/utils/log.hpp>
+#include <boost/foreach.hpp>
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
 #include <boost/math/special_functions/round.hpp>
+#include <map>
+#include <set>
 #include <vector>
 #include "adf4350_regs.hpp"
 #include "adf4351_regs.hpp"
@@ -66,6 +69,9 @@ public:
 
     virtual double set_frequency(double target_freq, bool int_n_mode, bool flush = false) = 0;
 
+    //! compute the divider settings for a list of frequencies, so later set_frequency() calls reuse them
+    virtual std::vector<double> precompute_frequencies(const std::vector<double> &target_freqs, bool int_n_mode) = 0;
+
     virtual void commit(void) = 0;
 };
 
@@ -78,7 +84,8 @@ public:
         _regs(),
         _fb_after_divider(false),
         _reference_freq(0.0),
-        _N_min(-1)
+        _N_min(-1),
+        _write_all_regs(true)
     {}
 
     virtual ~adf435x_impl() {};
@@ -148,15 +155,156 @@ public:
     }
 
     double set_frequency(double target_freq, bool int_n_mode, bool flush = false)
+    {
+        static const double VCO_FREQ_MIN            = 2.2e9;
+        static const double VCO_FREQ_MAX            = 4.4e9;
+
+        uhd::range_t rf_divider_range = _get_rfdiv_range();
+        uhd::range_t int_range = get_int_range();
+
+        const tuning_solution_t &sol = _get_tuning_solution(target_freq, int_n_mode);
+
+        //Typical phase resync time documented in data sheet pg.24
+        static const double PHASE_RESYNC_TIME = 400e-6;
+
+        _regs.frac_12_bit            = sol.FRAC;
+        _regs.int_16_bit             = sol.N;
+        _regs.mod_12_bit             = sol.MOD;
+        _regs.clock_divider_12_bit   = std::max<uint16_t>(1, uint16_t(std::ceil(PHASE_RESYNC_TIME*sol.pfd_freq/sol.MOD)));
+        _regs.feedback_select        = _fb_after_divider ?
+                                        adf435x_regs_t::FEEDBACK_SELECT_DIVIDED :
+                                        adf435x_regs_t::FEEDBACK_SELECT_FUNDAMENTAL;
+        _regs.clock_div_mode         = _fb_after_divider ?
+                                        adf435x_regs_t::CLOCK_DIV_MODE_RESYNC_ENABLE :
+                                        adf435x_regs_t::CLOCK_DIV_MODE_FAST_LOCK;
+        _regs.r_counter_10_bit       = sol.R;
+        _regs.reference_divide_by_2  = sol.T ?
+                                        adf435x_regs_t::REFERENCE_DIVIDE_BY_2_ENABLED :
+                                        adf435x_regs_t::REFERENCE_DIVIDE_BY_2_DISABLED;
+        _regs.reference_doubler      = sol.D ?
+                                        adf435x_regs_t::REFERENCE_DOUBLER_ENABLED :
+                                        adf435x_regs_t::REFERENCE_DOUBLER_DISABLED;
+        _regs.band_select_clock_div  = uint8_t(sol.BS);
+        _regs.rf_divider_select      = static_cast<typename adf435x_regs_t::rf_divider_select_t>(_get_rfdiv_setting(sol.RFdiv));
+        _regs.ldf                    = int_n_mode ?
+                                        adf435x_regs_t::LDF_INT_N :
+                                        adf435x_regs_t::LDF_FRAC_N;
+
+        std::string tuning_str = (int_n_mode) ? "Integer-N" : "Fractional";
+        UHD_LOGV(often)
+            << boost::format("ADF 435X Frequencies (MHz): REQUESTED=%0.9f, ACTUAL=%0.9f"
+            ) % (target_freq/1e6) % (sol.actual_freq/1e6) << std::endl
+            << boost::format("ADF 435X Intermediates (MHz): Feedback=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f, REF=%0.2f"
+            ) % (sol.feedback_freq/1e6) % (sol.vco_freq/1e6) % (sol.pfd_freq/1e6) % (sol.pfd_freq/sol.BS/1e6) % (_reference_freq/1e6) << std::endl
+            << boost::format("ADF 435X Tuning: %s") % tuning_str.c_str() << std::endl
+            << boost::format("ADF 435X Settings: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d"
+            ) % sol.R % sol.BS % sol.N % sol.FRAC % sol.MOD % sol.T % sol.D % sol.RFdiv << std::endl;
+
+        UHD_ASSERT_THROW((_regs.frac_12_bit          & ((uint16_t)~0xFFF)) == 0);
+        UHD_ASSERT_THROW((_regs.mod_12_bit           & ((uint16_t)~0xFFF)) == 0);
+        UHD_ASSERT_THROW((_regs.clock_divider_12_bit & ((uint16_t)~0xFFF)) == 0);
+        UHD_ASSERT_THROW((_regs.r_counter_10_bit     & ((uint16_t)~0x3FF)) == 0);
+
+        UHD_ASSERT_THROW(sol.vco_freq >= VCO_FREQ_MIN and sol.vco_freq <= VCO_FREQ_MAX);
+        UHD_ASSERT_THROW(sol.RFdiv >= static_cast<uint16_t>(rf_divider_range.start()));
+        UHD_ASSERT_THROW(sol.RFdiv <= static_cast<uint16_t>(rf_divider_range.stop()));
+        UHD_ASSERT_THROW(_regs.int_16_bit >= static_cast<uint16_t>(int_range.start()));
+        UHD_ASSERT_THROW(_regs.int_16_bit <= static_cast<uint16_t>(int_range.stop()));
+
+        if (flush) commit();
+        return sol.actual_freq;
+    }
+
+    std::vector<double> precompute_frequencies(const std::vector<double> &target_freqs, bool int_n_mode)
+    {
+        std::vector<double> actual_freqs;
+        BOOST_FOREACH(const double target_freq, target_freqs) {
+            actual_freqs.push_back(_get_tuning_solution(target_freq, int_n_mode).actual_freq);
+        }
+        return actual_freqs;
+    }
+
+    void commit()
+    {
+        //reset counters
+        _regs.counter_reset = adf435x_regs_t::COUNTER_RESET_ENABLED;
+        std::vector<uint32_t> regs;
+        regs.push_back(_regs.get_reg(uint32_t(2)));
+        _write_fn(regs);
+        _regs.counter_reset = adf435x_regs_t::COUNTER_RESET_DISABLED;
+
+        //write the registers
+        //correct power-up sequence to write registers (5, 4, 3, 2, 1, 0)
+        //after the first commit only the changed registers are written,
+        //plus 2 to release the counter reset and 0 to apply the tuning
+        std::set<uint32_t> changed_regs;
+        if (not _write_all_regs) {
+            changed_regs = _regs.template get_changed_addrs<uint32_t>();
+            changed_regs.insert(2);
+            changed_regs.insert(0);
+        }
+        regs.clear();
+        for (int addr = 5; addr >= 0; addr--) {
+            if (_write_all_regs or changed_regs.count(uint32_t(addr)))
+                regs.push_back(_regs.get_reg(uint32_t(addr)));
+        }
+        _write_fn(regs);
+        _regs.save_state();
+        _write_all_regs = false;
+    }
+
+protected:
+    //! Everything the divider search depends on
+    struct tuning_key_t
+    {
+        double  target_freq;
+        double  reference_freq;
+        bool    fb_after_divider;
+        bool    int_n_mode;
+        int     N_min;
+        bool operator<(const tuning_key_t &rhs) const
+        {
+            if (target_freq != rhs.target_freq) return target_freq < rhs.target_freq;
+            if (reference_freq != rhs.reference_freq) return reference_freq < rhs.reference_freq;
+            if (fb_after_divider != rhs.fb_after_divider) return fb_after_divider < rhs.fb_after_divider;
+            if (int_n_mode != rhs.int_n_mode) return int_n_mode < rhs.int_n_mode;
+            return N_min < rhs.N_min;
+        }
+    };
+
+    //! Result of the divider search
+    struct tuning_solution_t
+    {
+        uint16_t    R, BS, N, FRAC, MOD, RFdiv;
+        bool        D, T;
+        double      pfd_freq, vco_freq, feedback_freq, actual_freq;
+    };
+
+    static const size_t MAX_CACHED_SOLUTIONS = 4096;
+
+    const tuning_solution_t &_get_tuning_solution(double target_freq, bool int_n_mode)
+    {
+        tuning_key_t key;
+        key.target_freq = target_freq;
+        key.reference_freq = _reference_freq;
+        key.fb_after_divider = _fb_after_divider;
+        key.int_n_mode = int_n_mode;
+        key.N_min = _N_min;
+
+        typename std::map<tuning_key_t, tuning_solution_t>::const_iterator it = _tuning_cache.find(key);
+        if (it != _tuning_cache.end()) return it->second;
+
+        const tuning_solution_t sol = _solve_dividers(target_freq, int_n_mode);
+        if (_tuning_cache.size() >= MAX_CACHED_SOLUTIONS) _tuning_cache.clear();
+        return _tuning_cache[key] = sol;
+    }
+
+    tuning_solution_t _solve_dividers(double target_freq, bool int_n_mode)
     {
         static const double REF_DOUBLER_THRESH_FREQ = 12.5e6;
         static const double PFD_FREQ_MAX            = 25.0e6;
         static const double BAND_SEL_FREQ_MAX       = 100e3;
         static const double VCO_FREQ_MIN            = 2.2e9;
-        static const double VCO_FREQ_MAX            = 4.4e9;
-
-        //Default invalid value for actual_freq
-        double actual_freq = 0;
 
         uhd::range_t rf_divider_range = _get_rfdiv_range();
         uhd::range_t int_range = get_int_range();
@@ -232,85 +380,29 @@ public:
             R /= 2;
         }
 
-        //Typical phase resync time documented in data sheet pg.24
-        static const double PHASE_RESYNC_TIME = 400e-6;
-
         //If feedback after divider, then compensation for the divider is pulled into the INT value
         int rf_div_compensation = _fb_after_divider ? 1 : RFdiv;
 
+        tuning_solution_t sol;
+        sol.R = R;
+        sol.BS = BS;
+        sol.N = N;
+        sol.FRAC = FRAC;
+        sol.MOD = MOD;
+        sol.RFdiv = RFdiv;
+        sol.D = D;
+        sol.T = T;
+        sol.pfd_freq = pfd_freq;
+        sol.vco_freq = vco_freq;
+        sol.feedback_freq = feedback_freq;
         //Compute the actual frequency in terms of _reference_freq, N, FRAC, MOD, D, R and T.
-        actual_freq = (
+        sol.actual_freq = (
             double((N + (double(FRAC)/double(MOD))) *
             (_reference_freq*(D?2:1)/(R*(T?2:1))))
         ) / rf_div_compensation;
-
-        _regs.frac_12_bit            = FRAC;
-        _regs.int_16_bit             = N;
-        _regs.mod_12_bit             = MOD;
-        _regs.clock_divider_12_bit   = std::max<uint16_t>(1, uint16_t(std::ceil(PHASE_RESYNC_TIME*pfd_freq/MOD)));
-        _regs.feedback_select        = _fb_after_divider ?
-                                        adf435x_regs_t::FEEDBACK_SELECT_DIVIDED :
-                                        adf435x_regs_t::FEEDBACK_SELECT_FUNDAMENTAL;
-        _regs.clock_div_mode         = _fb_after_divider ?
-                                        adf435x_regs_t::CLOCK_DIV_MODE_RESYNC_ENABLE :
-                                        adf435x_regs_t::CLOCK_DIV_MODE_FAST_LOCK;
-        _regs.r_counter_10_bit       = R;
-        _regs.reference_divide_by_2  = T ?
-                                        adf435x_regs_t::REFERENCE_DIVIDE_BY_2_ENABLED :
-                                        adf435x_regs_t::REFERENCE_DIVIDE_BY_2_DISABLED;
-        _regs.reference_doubler      = D ?
-                                        adf435x_regs_t::REFERENCE_DOUBLER_ENABLED :
-                                        adf435x_regs_t::REFERENCE_DOUBLER_DISABLED;
-        _regs.band_select_clock_div  = uint8_t(BS);
-        _regs.rf_divider_select      = static_cast<typename adf435x_regs_t::rf_divider_select_t>(_get_rfdiv_setting(RFdiv));
-        _regs.ldf                    = int_n_mode ?
-                                        adf435x_regs_t::LDF_INT_N :
-                                        adf435x_regs_t::LDF_FRAC_N;
-
-        std::string tuning_str = (int_n_mode) ? "Integer-N" : "Fractional";
-        UHD_LOGV(often)
-            << boost::format("ADF 435X Frequencies (MHz): REQUESTED=%0.9f, ACTUAL=%0.9f"
-            ) % (target_freq/1e6) % (actual_freq/1e6) << std::endl
-            << boost::format("ADF 435X Intermediates (MHz): Feedback=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f, REF=%0.2f"
-            ) % (feedback_freq/1e6) % (vco_freq/1e6) % (pfd_freq/1e6) % (pfd_freq/BS/1e6) % (_reference_freq/1e6) << std::endl
-            << boost::format("ADF 435X Tuning: %s") % tuning_str.c_str() << std::endl
-            << boost::format("ADF 435X Settings: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d"
-            ) % R % BS % N % FRAC % MOD % T % D % RFdiv << std::endl;
-
-        UHD_ASSERT_THROW((_regs.frac_12_bit          & ((uint16_t)~0xFFF)) == 0);
-        UHD_ASSERT_THROW((_regs.mod_12_bit           & ((uint16_t)~0xFFF)) == 0);
-        UHD_ASSERT_THROW((_regs.clock_divider_12_bit & ((uint16_t)~0xFFF)) == 0);
-        UHD_ASSERT_THROW((_regs.r_counter_10_bit     & ((uint16_t)~0x3FF)) == 0);
-
-        UHD_ASSERT_THROW(vco_freq >= VCO_FREQ_MIN and vco_freq <= VCO_FREQ_MAX);
-        UHD_ASSERT_THROW(RFdiv >= static_cast<uint16_t>(rf_divider_range.start()));
-        UHD_ASSERT_THROW(RFdiv <= static_cast<uint16_t>(rf_divider_range.stop()));
-        UHD_ASSERT_THROW(_regs.int_16_bit >= static_cast<uint16_t>(int_range.start()));
-        UHD_ASSERT_THROW(_regs.int_16_bit <= static_cast<uint16_t>(int_range.stop()));
-
-        if (flush) commit();
-        return actual_freq;
-    }
-
-    void commit()
-    {
-        //reset counters
-        _regs.counter_reset = adf435x_regs_t::COUNTER_RESET_ENABLED;
-        std::vector<uint32_t> regs;
-        regs.push_back(_regs.get_reg(uint32_t(2)));
-        _write_fn(regs);
-        _regs.counter_reset = adf435x_regs_t::COUNTER_RESET_DISABLED;
-
-        //write the registers
-        //correct power-up sequence to write registers (5, 4, 3, 2, 1, 0)
-        regs.clear();
-        for (int addr = 5; addr >= 0; addr--) {
-            regs.push_back(_regs.get_reg(uint32_t(addr)));
-        }
-        _write_fn(regs);
+        return sol;
     }
 
-protected:
     uhd::range_t _get_rfdiv_range();
     int _get_rfdiv_setting(uint16_t div);
 
@@ -319,6 +411,8 @@ protected:
     double          _fb_after_divider;
     double          _reference_freq;
     int             _N_min;
+    bool            _write_all_regs;
+    std::map<tuning_key_t, tuning_solution_t> _tuning_cache;
 };
 
 template <>
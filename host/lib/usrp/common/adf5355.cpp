@@ -54,8 +54,9 @@ static const uint32_t ADF5355_MAX_FRAC2      = 16383;
 class adf5355_impl : public adf5355_iface
 {
 public:
-    adf5355_impl(write_fn_t write_fn) :
+    adf5355_impl(write_fn_t write_fn, wait_fn_t wait_fn) :
         _write_fn(write_fn),
+        _wait_fn(wait_fn),
         _regs(),
         _rewrite_regs(true),
         _wait_time_us(0),
@@ -330,7 +331,11 @@ public:
             _write_fn(addr_vtr_t(ONE_REG, _regs.get_reg(0)));
             _regs.counter_reset = adf5355_regs_t::COUNTER_RESET_DISABLED;
             _write_fn(addr_vtr_t(ONE_REG, _regs.get_reg(4)));
-            boost::this_thread::sleep(boost::posix_time::microsec(_wait_time_us));
+            if (_wait_fn) {
+                _wait_fn(boost::chrono::microseconds(_wait_time_us));
+            } else {
+                boost::this_thread::sleep(boost::posix_time::microsec(_wait_time_us));
+            }
             _regs.autocal_en = adf5355_regs_t::AUTOCAL_EN_ENABLED;
             _write_fn(addr_vtr_t(ONE_REG, _regs.get_reg(0)));
         }
@@ -340,6 +345,7 @@ private: //Members
     typedef std::vector<uint32_t> addr_vtr_t;
 
     write_fn_t      _write_fn;
+    wait_fn_t       _wait_fn;
     adf5355_regs_t  _regs;
     bool            _rewrite_regs;
     uint32_t _wait_time_us;
@@ -348,7 +354,7 @@ private: //Members
     double          _fb_after_divider;
 };
 
-adf5355_iface::sptr adf5355_iface::make(write_fn_t write)
+adf5355_iface::sptr adf5355_iface::make(write_fn_t write, wait_fn_t wait)
 {
-    return sptr(new adf5355_impl(write));
+    return sptr(new adf5355_impl(write, wait));
 }
@@ -19,6 +19,7 @@
 #define INCLUDED_ADF5355_HPP
 
 #include <boost/function.hpp>
+#include <boost/chrono.hpp>
 #include <vector>
 #include <stdint.h>
 
@@ -27,8 +28,10 @@ class adf5355_iface
 public:
     typedef boost::shared_ptr<adf5355_iface> sptr;
     typedef boost::function<void(std::vector<uint32_t>)> write_fn_t;
+    typedef boost::function<void(const boost::chrono::nanoseconds&)> wait_fn_t;
 
-    static sptr make(write_fn_t write);
+    //! the wait function spaces out the VCO calibration, a host sleep is used if none is given
+    static sptr make(write_fn_t write, wait_fn_t wait = wait_fn_t());
 
     virtual ~adf5355_iface() {}
 
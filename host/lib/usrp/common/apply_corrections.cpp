@@ -23,8 +23,11 @@
 #include <uhd/types/dict.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <complex>
 #include <fstream>
 
@@ -52,6 +55,18 @@ static bool fe_cal_comp(fe_cal_t a, fe_cal_t b){
     return (a.lo_freq < b.lo_freq);
 }
 
+static bool fe_cal_freq_comp(double lo_freq, const fe_cal_t &data){
+    return (lo_freq < data.lo_freq);
+}
+
+/*!
+ * Binary calibration tables are written next to the CSV files by the
+ * uhd_cal_* utilities (see store_results() in usrp_cal_utils.hpp):
+ * an 8 byte magic, a uint64_t entry count, then the fe_cal_t entries
+ * sorted by LO frequency, all in host byte order.
+ */
+static const char FE_CAL_BIN_MAGIC[8] = {'U', 'H', 'D', 'C', 'A', 'L', '0', '1'};
+
 static uhd::dict<std::string, std::vector<fe_cal_t> > fe_cal_cache;
 
 static bool is_same_freq(const double f1, const double f2)
@@ -66,21 +81,21 @@ static std::complex<double> get_fe_correction(
     const std::vector<fe_cal_t> &datas = fe_cal_cache[key];
     if (datas.empty()) throw uhd::runtime_error("empty calibration table " + key);
 
-    //search for lo freq
-    size_t lo_index = 0;
+    //search for lo freq, the table is sorted:
+    //find the first entry that is not below the lo freq by more than epsilon
+    const size_t first = std::upper_bound(
+        datas.begin(), datas.end(), lo_freq - 0.1, fe_cal_freq_comp
+    ) - datas.begin();
+    size_t lo_index = datas.size()-1;
     size_t hi_index = datas.size()-1;
-    for (size_t i = 0; i < datas.size(); i++){
-        if (is_same_freq(datas[i].lo_freq, lo_freq))
-        {
-            hi_index = i;
-            lo_index = i;
-            break;
+    if (first < datas.size()){
+        if (is_same_freq(datas[first].lo_freq, lo_freq)){
+            lo_index = hi_index = first;
         }
-        if (datas[i].lo_freq > lo_freq){
-            hi_index = i;
-            break;
+        else{
+            hi_index = first;
+            lo_index = (first == 0)? 0 : first-1;
         }
-        lo_index = i;
     }
 
     if (lo_index == 0) return std::complex<double>(datas[lo_index].iq_corr_real, datas[lo_index].iq_corr_imag);
@@ -93,6 +108,48 @@ static std::complex<double> get_fe_correction(
     );
 }
 
+static bool load_fe_cal_bin(const fs::path &bin_path, std::vector<fe_cal_t> &datas){
+    std::ifstream cal_data(bin_path.string().c_str(), std::ios::binary);
+    char magic[sizeof(FE_CAL_BIN_MAGIC)];
+    boost::uint64_t num_entries = 0;
+    cal_data.read(magic, sizeof(magic));
+    cal_data.read(reinterpret_cast<char *>(&num_entries), sizeof(num_entries));
+    if (not cal_data or std::memcmp(magic, FE_CAL_BIN_MAGIC, sizeof(magic)) != 0) return false;
+    const boost::uintmax_t expected_size = sizeof(magic) + sizeof(num_entries) + num_entries*sizeof(fe_cal_t);
+    if (fs::file_size(bin_path) != expected_size) return false;
+
+    datas.resize(size_t(num_entries));
+    if (not datas.empty()) cal_data.read(reinterpret_cast<char *>(&datas.front()), num_entries*sizeof(fe_cal_t));
+    std::sort(datas.begin(), datas.end(), fe_cal_comp);
+    return bool(cal_data);
+}
+
+static void load_fe_cal_csv(const fs::path &cal_data_path, std::vector<fe_cal_t> &datas){
+    std::ifstream cal_data(cal_data_path.string().c_str());
+    const uhd::csv::rows_type rows = uhd::csv::to_rows(cal_data);
+
+    bool read_data = false, skip_next = false;;
+    datas.clear();
+    BOOST_FOREACH(const uhd::csv::row_type &row, rows){
+        if (not read_data and not row.empty() and row[0] == "DATA STARTS HERE"){
+            read_data = true;
+            skip_next = true;
+            continue;
+        }
+        if (not read_data) continue;
+        if (skip_next){
+            skip_next = false;
+            continue;
+        }
+        fe_cal_t data;
+        std::sscanf(row[0].c_str(), "%lf" , &data.lo_freq);
+        std::sscanf(row[1].c_str(), "%lf" , &data.iq_corr_real);
+        std::sscanf(row[2].c_str(), "%lf" , &data.iq_corr_imag);
+        datas.push_back(data);
+    }
+    std::sort(datas.begin(), datas.end(), fe_cal_comp);
+}
+
 static void apply_fe_corrections(
     uhd::property_tree::sptr sub_tree,
     const uhd::fs_path &db_path,
@@ -107,34 +164,23 @@ static void apply_fe_corrections(
     const fs::path cal_data_path = fs::path(uhd::get_app_path()) / ".uhd" / "cal" / (file_prefix + db_eeprom.serial + ".csv");
     if (not fs::exists(cal_data_path)) return;
 
-    //parse csv file or get from cache
+    //load the binary table when it is not older than the csv file,
+    //parse the csv file otherwise, or get from cache
     if (not fe_cal_cache.has_key(cal_data_path.string())){
-        std::ifstream cal_data(cal_data_path.string().c_str());
-        const uhd::csv::rows_type rows = uhd::csv::to_rows(cal_data);
-
-        bool read_data = false, skip_next = false;;
+        fs::path bin_path = cal_data_path;
+        bin_path.replace_extension(".bin");
         std::vector<fe_cal_t> datas;
-        BOOST_FOREACH(const uhd::csv::row_type &row, rows){
-            if (not read_data and not row.empty() and row[0] == "DATA STARTS HERE"){
-                read_data = true;
-                skip_next = true;
-                continue;
-            }
-            if (not read_data) continue;
-            if (skip_next){
-                skip_next = false;
-                continue;
-            }
-            fe_cal_t data;
-            std::sscanf(row[0].c_str(), "%lf" , &data.lo_freq);
-            std::sscanf(row[1].c_str(), "%lf" , &data.iq_corr_real);
-            std::sscanf(row[2].c_str(), "%lf" , &data.iq_corr_imag);
-            datas.push_back(data);
+        if (fs::exists(bin_path)
+            and fs::last_write_time(bin_path) >= fs::last_write_time(cal_data_path)
+            and load_fe_cal_bin(bin_path, datas)
+        ){
+            UHD_MSG(status) << "Loaded " << bin_path.string() << std::endl;
+        }
+        else{
+            load_fe_cal_csv(cal_data_path, datas);
+            UHD_MSG(status) << "Loaded " << cal_data_path.string() << std::endl;
         }
-        std::sort(datas.begin(), datas.end(), fe_cal_comp);
         fe_cal_cache[cal_data_path.string()] = datas;
-        UHD_MSG(status) << "Loaded " << cal_data_path.string() << std::endl;
-
     }
 
     sub_tree->access<std::complex<double> >(fe_path)
@@ -22,7 +22,7 @@
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/types/metadata.hpp>
 #include <uhd/utils/byteswap.hpp>
-#include <uhd/utils/msg.hpp>
+#include <uhd/utils/fastpath.hpp>
 
 namespace uhd{ namespace usrp{
 
@@ -46,6 +46,8 @@ namespace uhd{ namespace usrp{
             metadata.time_spec = time_spec_t::from_ticks(if_packet_info.tsf, tick_rate);
         }
         metadata.event_code = async_metadata_t::event_code_t(to_host(payload[0]) & 0xff);
+        metadata.num_events = 1;
+        metadata.last_time_spec = metadata.time_spec;
 
         //load user payload
         for (size_t i = 1; i < if_packet_info.num_payload_words32; i++){
@@ -59,14 +61,17 @@ namespace uhd{ namespace usrp{
         if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_UNDERFLOW
             | async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET)
-        ) UHD_MSG(fastpath) << "U";
+        ) fastpath::post_event(fastpath::EVENT_UNDERFLOW,
+                metadata.channel, metadata.has_time_spec, metadata.time_spec);
         else if (metadata.event_code &
             ( async_metadata_t::EVENT_CODE_SEQ_ERROR
             | async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
-        ) UHD_MSG(fastpath) << "S";
+        ) fastpath::post_event(fastpath::EVENT_SEQ_ERROR,
+                metadata.channel, metadata.has_time_spec, metadata.time_spec);
         else if (metadata.event_code &
             async_metadata_t::EVENT_CODE_TIME_ERROR
-        ) UHD_MSG(fastpath) << "L";
+        ) fastpath::post_event(fastpath::EVENT_LATE_PACKET,
+                metadata.channel, metadata.has_time_spec, metadata.time_spec);
     }
 
 
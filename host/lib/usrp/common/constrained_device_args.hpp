@@ -20,6 +20,8 @@
 
 #include <uhd/types/device_addr.hpp>
 #include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
@@ -53,8 +55,10 @@ namespace usrp {
         class generic_arg {
         public:
             generic_arg(const std::string& key): _key(key) {}
+            virtual ~generic_arg() {}
             inline const std::string& key() const { return _key; }
             inline virtual std::string to_string() const = 0;
+            virtual void parse(const std::string& str_rep) = 0;
         private:
             std::string _key;
         };
@@ -146,7 +150,10 @@ namespace usrp {
             inline const enum_t get() const {
                 return _value;
             }
-            inline void parse(const std::string& str_rep, bool assert_invalid = true) {
+            inline void parse(const std::string& str_rep) {
+                parse(str_rep, true);
+            }
+            inline void parse(const std::string& str_rep, bool assert_invalid) {
                 std::string valid_values_str;
                 for (size_t i = 0; i < _str_values.size(); i++) {
                     if (boost::algorithm::to_lower_copy(str_rep) ==
@@ -241,6 +248,48 @@ namespace usrp {
         //client specific device args
         virtual void _parse(const device_addr_t& dev_args) = 0;
 
+        /*!
+         * Utility: Parse the value of each arg in schema from dev_args,
+         * in one pass over its keys. Keys that match no arg are appended
+         * to unknown_keys (if given).
+         */
+        static void _parse_args(
+            const device_addr_t& dev_args,
+            const std::vector<generic_arg*>& schema,
+            std::vector<std::string>* unknown_keys = NULL
+        ) {
+            const std::vector<std::string> keys = dev_args.keys();
+            const std::vector<std::string> vals = dev_args.vals();
+            for (size_t i = 0; i < keys.size(); i++) {
+                generic_arg* arg = NULL;
+                BOOST_FOREACH(generic_arg* a, schema) {
+                    if (a->key() == keys[i]) {
+                        arg = a;
+                        break;
+                    }
+                }
+                if (arg != NULL) {
+                    arg->parse(vals[i]);
+                } else if (unknown_keys != NULL) {
+                    unknown_keys->push_back(keys[i]);
+                }
+            }
+        }
+
+        /*!
+         * Utility: Print a warning for each key in unknown_keys.
+         * \param where names the args in the message (e.g. "stream arg")
+         */
+        static inline void _warn_unknown_keys(
+            const std::string& where,
+            const std::vector<std::string>& unknown_keys
+        ) {
+            BOOST_FOREACH(const std::string& key, unknown_keys) {
+                UHD_MSG(warning) << boost::format(
+                    "Unknown %s key \"%s\" is ignored") % where % key << std::endl;
+            }
+        }
+
         /*!
          * Utility: Ensure that the value of the device arg is between min and max
          */
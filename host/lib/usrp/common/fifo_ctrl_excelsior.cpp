@@ -64,7 +64,7 @@ public:
         while (_xport->get_recv_buff(0.0)){} //flush
         this->set_time(uhd::time_spec_t(0.0));
         this->set_tick_rate(1.0); //something possible but bogus
-        _msg_task = task::make(boost::bind(&fifo_ctrl_excelsior_impl::handle_msg, this));
+        _msg_task = task::make(boost::bind(&fifo_ctrl_excelsior_impl::handle_msg, this), "async", "control responses");
         this->init_spi();
     }
 
@@ -81,7 +81,11 @@ public:
     }
 
     void handle_msg(void){
-        set_thread_priority_safe();
+        //a configured priority for the role was applied already
+        thread_config_t config;
+        if (not get_thread_config("async", config) or not config.set_priority){
+            set_thread_priority_safe();
+        }
         while (not boost::this_thread::interruption_requested()){
             this->handle_msg1();
         }
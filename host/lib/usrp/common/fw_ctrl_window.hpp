@@ -0,0 +1,215 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_FW_CTRL_WINDOW_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_FW_CTRL_WINDOW_HPP
+
+#include <uhd/transport/udp_simple.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/exception.hpp>
+#include <boost/function.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <deque>
+#include <string>
+
+namespace uhd { namespace usrp {
+
+/*!
+ * Keeps several firmware control requests in flight on a UDP transport,
+ * instead of waiting for the reply to each one before sending the next.
+ *
+ * A request is one datagram of type pkt_type, which has a 32-bit
+ * `sequence` field in network byte order. The window numbers the requests,
+ * and the firmware copies the number into its reply. A reply whose number
+ * is not in flight (e.g. the second reply to a request sent twice) is
+ * dropped. When the oldest request gets no reply in time, it and the later
+ * requests still without a reply are sent again, in order.
+ *
+ * The window is not thread safe; the control interface that owns it
+ * serializes the calls.
+ */
+template <typename pkt_type>
+class fw_ctrl_window
+{
+public:
+    /*!
+     * Checks the reply to a request (flags, address, data) and throws if
+     * it is not the right one. The sequence numbers are checked already.
+     */
+    typedef boost::function<void(const pkt_type &request, const pkt_type &reply, const size_t nbytes)> check_type;
+
+    /*!
+     * \param udp the transport to the firmware
+     * \param check the check for replies
+     * \param name the name of the interface, for messages
+     * \param verbose print a warning for each request sent again
+     * \param window the most requests in flight
+     */
+    fw_ctrl_window(
+        uhd::transport::udp_simple::sptr udp,
+        const check_type &check,
+        const std::string &name,
+        const bool verbose,
+        const size_t window = DEFAULT_WINDOW
+    ):
+        _udp(udp), _check(check), _name(name), _verbose(verbose),
+        _window(window), _seq(0), _wait_seq(0)
+    {
+        /* NOP */
+    }
+
+    //! Send a request without waiting for its reply, once there is room in the window
+    void post(pkt_type request)
+    {
+        while (_in_flight.size() >= _window) this->collect_one();
+        this->send(request);
+    }
+
+    //! Send a request and wait for its reply, and those to the requests before it
+    pkt_type transact(pkt_type request)
+    {
+        while (_in_flight.size() >= _window) this->collect_one();
+        this->send(request);
+        _wait_seq = request.sequence;
+        while (not _in_flight.empty()) this->collect_one();
+        this->throw_error();
+        return _wait_reply;
+    }
+
+    //! Wait for the replies to all requests in flight, throw the first error
+    void wait_all(void)
+    {
+        while (not _in_flight.empty()) this->collect_one();
+        this->throw_error();
+    }
+
+    //! Drop the replies that no request waits for
+    void flush(void)
+    {
+        char buff[MAX_REPLY_BYTES] = {};
+        while (_udp->recv(boost::asio::buffer(buff), 0.0)) {} //flush
+    }
+
+    static const size_t DEFAULT_WINDOW = 8;
+
+private:
+    static const size_t NUM_ATTEMPTS = 3;
+    static const size_t MAX_REPLY_BYTES = 1500;
+    static const long TIMEOUT_MS = 1000;
+
+    struct request_t
+    {
+        pkt_type pkt;
+        size_t attempts;
+        boost::system_time deadline;
+    };
+
+    void send(pkt_type &request)
+    {
+        request.sequence = uhd::htonx<uint32_t>(_seq++);
+        request_t req;
+        req.pkt = request;
+        req.attempts = 1;
+        req.deadline = boost::get_system_time() + boost::posix_time::milliseconds(TIMEOUT_MS);
+        if (_in_flight.empty()) this->flush();
+        _udp->send(boost::asio::buffer(&req.pkt, sizeof(req.pkt)));
+        _in_flight.push_back(req);
+    }
+
+    //! Wait for one reply, or send the requests in flight again on a timeout
+    void collect_one(void)
+    {
+        const boost::posix_time::time_duration left = _in_flight.front().deadline - boost::get_system_time();
+        const double timeout = std::max(0.0, left.total_microseconds()/1e6);
+
+        pkt_type reply = pkt_type();
+        const size_t nbytes = _udp->recv(boost::asio::buffer(&reply, sizeof(reply)), timeout);
+        if (nbytes == 0) {
+            if (boost::get_system_time() < _in_flight.front().deadline) return;
+            this->resend();
+            return;
+        }
+
+        typename std::deque<request_t>::iterator it = _in_flight.begin();
+        while (it != _in_flight.end() and it->pkt.sequence != reply.sequence) ++it;
+        if (it == _in_flight.end()) return; //a late duplicate
+
+        const pkt_type request = it->pkt;
+        _in_flight.erase(it);
+        try {
+            _check(request, reply, nbytes);
+            if (request.sequence == _wait_seq) _wait_reply = reply;
+        } catch (const std::exception &ex) {
+            this->post_error(str(boost::format("%s - bad reply: %s") % _name % ex.what()));
+        }
+    }
+
+    //! Send the requests without a reply again, or give up on them
+    void resend(void)
+    {
+        if (_in_flight.front().attempts >= NUM_ATTEMPTS) {
+            const std::string msg = str(boost::format(
+                "%s - reply timed out after %u attempts") % _name % size_t(NUM_ATTEMPTS));
+            _in_flight.clear();
+            this->post_error(msg);
+            return;
+        }
+        if (_verbose) {
+            UHD_MSG(warning) << boost::format(
+                "%s - reply timed out, sending %u requests again"
+            ) % _name % _in_flight.size() << std::endl;
+        }
+        const boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(TIMEOUT_MS);
+        for (size_t i = 0; i < _in_flight.size(); i++) {
+            _in_flight[i].attempts++;
+            _in_flight[i].deadline = deadline;
+            _udp->send(boost::asio::buffer(&_in_flight[i].pkt, sizeof(_in_flight[i].pkt)));
+        }
+    }
+
+    void post_error(const std::string &msg)
+    {
+        if (not _error) _error.reset(new uhd::io_error(msg));
+    }
+
+    void throw_error(void)
+    {
+        if (not _error) return;
+        const uhd::io_error error = *_error;
+        _error.reset();
+        throw error;
+    }
+
+    uhd::transport::udp_simple::sptr _udp;
+    const check_type _check;
+    const std::string _name;
+    const bool _verbose;
+    const size_t _window;
+    uint32_t _seq;
+    std::deque<request_t> _in_flight;
+    uint32_t _wait_seq; //the request transact() waits for, as sent
+    pkt_type _wait_reply;
+    boost::shared_ptr<uhd::io_error> _error;
+};
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_FW_CTRL_WINDOW_HPP */
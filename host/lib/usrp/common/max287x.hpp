@@ -29,6 +29,7 @@
 #include <boost/thread.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <stdint.h>
+#include <map>
 #include <vector>
 #include "max2870_regs.hpp"
 #include "max2871_regs.hpp"
@@ -156,6 +157,22 @@ public:
                 double target_pfd_freq,
                 bool is_int_n) = 0;
 
+    /**
+     * Compute the divider settings for a list of frequencies ahead of time.
+     * Later calls to set_frequency() with the same arguments reuse them
+     * instead of searching the divider space again.
+     * @param target_freqs target frequencies
+     * @param ref_freq reference frequency
+     * @param target_pfd_freq target phase detector frequency
+     * @param is_int_n enable integer-N tuning
+     * @return actual frequencies
+     */
+    virtual std::vector<double> precompute_frequencies(
+                const std::vector<double> &target_freqs,
+                double ref_freq,
+                double target_pfd_freq,
+                bool is_int_n) = 0;
+
     /**
      * Set output power
      * @param power output power
@@ -244,6 +261,11 @@ public:
         double ref_freq,
         double target_pfd_freq,
         bool is_int_n);
+    virtual std::vector<double> precompute_frequencies(
+        const std::vector<double> &target_freqs,
+        double ref_freq,
+        double target_pfd_freq,
+        bool is_int_n);
     virtual void set_output_power(output_power_t power);
     virtual void set_ld_pin_mode(ld_pin_mode_t mode);
     virtual void set_muxout_mode(muxout_mode_t mode);
@@ -258,14 +280,58 @@ public:
     virtual void config_for_sync(bool enable);
 
 protected:
+    /**
+     * Everything the divider search depends on
+     */
+    struct tuning_key_t
+    {
+        double target_freq;
+        double ref_freq;
+        double target_pfd_freq;
+        bool is_int_n;
+        bool feedback_divided;
+        bool operator<(const tuning_key_t &rhs) const
+        {
+            if (target_freq != rhs.target_freq) return target_freq < rhs.target_freq;
+            if (ref_freq != rhs.ref_freq) return ref_freq < rhs.ref_freq;
+            if (target_pfd_freq != rhs.target_pfd_freq) return target_pfd_freq < rhs.target_pfd_freq;
+            if (is_int_n != rhs.is_int_n) return is_int_n < rhs.is_int_n;
+            return feedback_divided < rhs.feedback_divided;
+        }
+    };
+
+    /**
+     * Result of the divider search
+     */
+    struct tuning_solution_t
+    {
+        int T, D, R, BS, N, FRAC, MOD, RFdiv;
+        double vco_freq;
+        double pfd_freq;
+        double actual_freq;
+    };
+
+    /**
+     * Whether the feedback path is taken after the output divider when
+     * tuning to the given frequency
+     */
+    virtual bool is_feedback_divided(double target_freq);
+
+    const tuning_solution_t &get_tuning_solution(const tuning_key_t &key);
+
     max287x_regs_t _regs;
     bool _can_sync;
     bool _config_for_sync;
     bool _write_all_regs;
 
 private:
+    static const size_t MAX_CACHED_SOLUTIONS = 4096;
+
+    tuning_solution_t _solve_dividers(const tuning_key_t &key);
+
     write_fn _write;
     bool _delay_after_write;
+    std::map<tuning_key_t, tuning_solution_t> _tuning_cache;
 };
 
 /**
@@ -289,6 +355,10 @@ public:
 
         return max287x<max2870_regs_t>::set_frequency(target_freq, ref_freq, target_pfd_freq, is_int_n);
     }
+    bool is_feedback_divided(double target_freq)
+    {
+        return target_freq >= 3.0e9;
+    }
     void commit(void)
     {
         // For MAX2870, we always need to write all registers.
@@ -383,6 +453,11 @@ public:
         }
     }
 
+    bool is_feedback_divided(double)
+    {
+        return true;
+    }
+
     double set_frequency(
         double target_freq,
         double ref_freq,
@@ -536,17 +611,127 @@ double max287x<max287x_regs_t>::set_frequency(
         (64,  max287x_regs_t::RF_DIVIDER_SELECT_DIV64)
         (128, max287x_regs_t::RF_DIVIDER_SELECT_DIV128);
 
+    static const uhd::range_t clock_div_range(1,4095,1);
+
+    tuning_key_t key;
+    key.target_freq = target_freq;
+    key.ref_freq = ref_freq;
+    key.target_pfd_freq = target_pfd_freq;
+    key.is_int_n = is_int_n;
+    key.feedback_divided = (_regs.feedback_select == max287x_regs_t::FEEDBACK_SELECT_DIVIDED);
+    const tuning_solution_t &sol = get_tuning_solution(key);
+
+    UHD_LOGV(rarely)
+        << boost::format("MAX287x: Intermediates: ref=%0.2f, outdiv=%f, fbdiv=%f"
+            ) % ref_freq % double(sol.RFdiv*2) % double(sol.N + double(sol.FRAC)/double(sol.MOD)) << std::endl
+        << boost::format("MAX287x: tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d, type=%s"
+            ) % sol.R % sol.BS % sol.N % sol.FRAC % sol.MOD % sol.T % sol.D % sol.RFdiv % ((is_int_n) ? "Integer-N" : "Fractional") << std::endl
+        << boost::format("MAX287x: Frequencies (MHz): REQ=%0.2f, ACT=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f"
+            ) % (target_freq/1e6) % (sol.actual_freq/1e6) % (sol.vco_freq/1e6) % (sol.pfd_freq/1e6) % (sol.pfd_freq/sol.BS/1e6) << std::endl;
+
+    //load the register values
+    _regs.rf_output_enable = max287x_regs_t::RF_OUTPUT_ENABLE_ENABLED;
+
+    if(is_int_n) {
+        _regs.cpl = max287x_regs_t::CPL_DISABLED;
+        _regs.ldf = max287x_regs_t::LDF_INT_N;
+        _regs.int_n_mode = max287x_regs_t::INT_N_MODE_INT_N;
+    } else {
+        _regs.cpl = max287x_regs_t::CPL_ENABLED;
+        _regs.ldf = max287x_regs_t::LDF_FRAC_N;
+        _regs.int_n_mode = max287x_regs_t::INT_N_MODE_FRAC_N;
+    }
+
+    _regs.lds = sol.pfd_freq <= 32e6 ? max287x_regs_t::LDS_SLOW : max287x_regs_t::LDS_FAST;
+
+    _regs.frac_12_bit = sol.FRAC;
+    _regs.int_16_bit = sol.N;
+    _regs.mod_12_bit = sol.MOD;
+    _regs.clock_divider_12_bit = std::max(int(clock_div_range.start()), int(std::ceil(400e-6*sol.pfd_freq/sol.MOD)));
+    UHD_ASSERT_THROW(_regs.clock_divider_12_bit <= clock_div_range.stop());
+    _regs.r_counter_10_bit = sol.R;
+    _regs.reference_divide_by_2 = sol.T ?
+        max287x_regs_t::REFERENCE_DIVIDE_BY_2_ENABLED :
+        max287x_regs_t::REFERENCE_DIVIDE_BY_2_DISABLED;
+    _regs.reference_doubler = sol.D ?
+        max287x_regs_t::REFERENCE_DOUBLER_ENABLED :
+        max287x_regs_t::REFERENCE_DOUBLER_DISABLED;
+    _regs.band_select_clock_div = sol.BS & 0xFF;
+    _regs.bs_msb = (sol.BS & 0x300) >> 8;
+    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(sol.RFdiv));
+    _regs.rf_divider_select = rfdivsel_to_enum[sol.RFdiv];
+
+    if (_regs.clock_div_mode == max287x_regs_t::CLOCK_DIV_MODE_FAST_LOCK)
+    {
+        // Charge pump current needs to be set to lowest value in fast lock mode
+        _regs.charge_pump_current = max287x_regs_t::CHARGE_PUMP_CURRENT_0_32MA;
+        // Make sure the register containing the charge pump current is written
+        _write_all_regs = true;
+    }
+
+    return sol.actual_freq;
+}
+
+template <typename max287x_regs_t>
+std::vector<double> max287x<max287x_regs_t>::precompute_frequencies(
+    const std::vector<double> &target_freqs,
+    double ref_freq,
+    double target_pfd_freq,
+    bool is_int_n)
+{
+    std::vector<double> actual_freqs;
+    for (size_t i = 0; i < target_freqs.size(); i++)
+    {
+        tuning_key_t key;
+        key.target_freq = target_freqs[i];
+        key.ref_freq = ref_freq;
+        key.target_pfd_freq = target_pfd_freq;
+        key.is_int_n = is_int_n;
+        key.feedback_divided = is_feedback_divided(target_freqs[i]);
+        actual_freqs.push_back(get_tuning_solution(key).actual_freq);
+    }
+    return actual_freqs;
+}
+
+template <typename max287x_regs_t>
+bool max287x<max287x_regs_t>::is_feedback_divided(double)
+{
+    return (_regs.feedback_select == max287x_regs_t::FEEDBACK_SELECT_DIVIDED);
+}
+
+template <typename max287x_regs_t>
+const typename max287x<max287x_regs_t>::tuning_solution_t &
+max287x<max287x_regs_t>::get_tuning_solution(const tuning_key_t &key)
+{
+    typename std::map<tuning_key_t, tuning_solution_t>::const_iterator it = _tuning_cache.find(key);
+    if (it != _tuning_cache.end())
+        return it->second;
+
+    const tuning_solution_t sol = _solve_dividers(key);
+    if (_tuning_cache.size() >= MAX_CACHED_SOLUTIONS)
+        _tuning_cache.clear();
+    return _tuning_cache[key] = sol;
+}
+
+template <typename max287x_regs_t>
+typename max287x<max287x_regs_t>::tuning_solution_t
+max287x<max287x_regs_t>::_solve_dividers(const tuning_key_t &key)
+{
     //map mode setting to valid integer divider (N) values
     static const uhd::range_t int_n_mode_div_range(16,65535,1);
     static const uhd::range_t frac_n_mode_div_range(19,4091,1);
 
     //other ranges and constants from MAX287X datasheets
-    static const uhd::range_t clock_div_range(1,4095,1);
     static const uhd::range_t r_range(1,1023,1);
     static const double MIN_VCO_FREQ = 3e9;
     static const double BS_FREQ = 50e3;
     static const int MAX_BS_VALUE = 1023;
 
+    const double target_freq = key.target_freq;
+    const double ref_freq = key.ref_freq;
+    const double target_pfd_freq = key.target_pfd_freq;
+    const bool is_int_n = key.is_int_n;
+
     int T = 0;
     int D = ref_freq <= 10.0e6 ? 1 : 0;
     int R = 0;
@@ -556,7 +741,7 @@ double max287x<max287x_regs_t>::set_frequency(
     int MOD = 4095;
     int RFdiv = 1;
     double pfd_freq = target_pfd_freq;
-    bool feedback_divided = (_regs.feedback_select == max287x_regs_t::FEEDBACK_SELECT_DIVIDED);
+    bool feedback_divided = key.feedback_divided;
 
     //increase RF divider until acceptable VCO frequency (MIN freq for MAX287x VCO is 3GHz)
     UHD_ASSERT_THROW(target_freq > 0);
@@ -638,55 +823,19 @@ double max287x<max287x_regs_t>::set_frequency(
     //actual frequency calculation
     double actual_freq = double((N + (double(FRAC)/double(MOD)))*ref_freq*(1+int(D))/(R*(1+int(T)))) * fb_divisor / RFdiv;
 
-    UHD_LOGV(rarely)
-        << boost::format("MAX287x: Intermediates: ref=%0.2f, outdiv=%f, fbdiv=%f"
-            ) % ref_freq % double(RFdiv*2) % double(N + double(FRAC)/double(MOD)) << std::endl
-        << boost::format("MAX287x: tune: R=%d, BS=%d, N=%d, FRAC=%d, MOD=%d, T=%d, D=%d, RFdiv=%d, type=%s"
-            ) % R % BS % N % FRAC % MOD % T % D % RFdiv % ((is_int_n) ? "Integer-N" : "Fractional") << std::endl
-        << boost::format("MAX287x: Frequencies (MHz): REQ=%0.2f, ACT=%0.2f, VCO=%0.2f, PFD=%0.2f, BAND=%0.2f"
-            ) % (target_freq/1e6) % (actual_freq/1e6) % (vco_freq/1e6) % (pfd_freq/1e6) % (pfd_freq/BS/1e6) << std::endl;
-
-    //load the register values
-    _regs.rf_output_enable = max287x_regs_t::RF_OUTPUT_ENABLE_ENABLED;
-
-    if(is_int_n) {
-        _regs.cpl = max287x_regs_t::CPL_DISABLED;
-        _regs.ldf = max287x_regs_t::LDF_INT_N;
-        _regs.int_n_mode = max287x_regs_t::INT_N_MODE_INT_N;
-    } else {
-        _regs.cpl = max287x_regs_t::CPL_ENABLED;
-        _regs.ldf = max287x_regs_t::LDF_FRAC_N;
-        _regs.int_n_mode = max287x_regs_t::INT_N_MODE_FRAC_N;
-    }
-
-    _regs.lds = pfd_freq <= 32e6 ? max287x_regs_t::LDS_SLOW : max287x_regs_t::LDS_FAST;
-
-    _regs.frac_12_bit = FRAC;
-    _regs.int_16_bit = N;
-    _regs.mod_12_bit = MOD;
-    _regs.clock_divider_12_bit = std::max(int(clock_div_range.start()), int(std::ceil(400e-6*pfd_freq/MOD)));
-    UHD_ASSERT_THROW(_regs.clock_divider_12_bit <= clock_div_range.stop());
-    _regs.r_counter_10_bit = R;
-    _regs.reference_divide_by_2 = T ?
-        max287x_regs_t::REFERENCE_DIVIDE_BY_2_ENABLED :
-        max287x_regs_t::REFERENCE_DIVIDE_BY_2_DISABLED;
-    _regs.reference_doubler = D ?
-        max287x_regs_t::REFERENCE_DOUBLER_ENABLED :
-        max287x_regs_t::REFERENCE_DOUBLER_DISABLED;
-    _regs.band_select_clock_div = BS & 0xFF;
-    _regs.bs_msb = (BS & 0x300) >> 8;
-    UHD_ASSERT_THROW(rfdivsel_to_enum.has_key(RFdiv));
-    _regs.rf_divider_select = rfdivsel_to_enum[RFdiv];
-
-    if (_regs.clock_div_mode == max287x_regs_t::CLOCK_DIV_MODE_FAST_LOCK)
-    {
-        // Charge pump current needs to be set to lowest value in fast lock mode
-        _regs.charge_pump_current = max287x_regs_t::CHARGE_PUMP_CURRENT_0_32MA;
-        // Make sure the register containing the charge pump current is written
-        _write_all_regs = true;
-    }
-
-    return actual_freq;
+    tuning_solution_t sol;
+    sol.T = T;
+    sol.D = D;
+    sol.R = R;
+    sol.BS = BS;
+    sol.N = N;
+    sol.FRAC = FRAC;
+    sol.MOD = MOD;
+    sol.RFdiv = RFdiv;
+    sol.vco_freq = vco_freq;
+    sol.pfd_freq = pfd_freq;
+    sol.actual_freq = actual_freq;
+    return sol;
 }
 
 template <typename max287x_regs_t>
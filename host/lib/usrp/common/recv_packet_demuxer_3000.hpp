@@ -18,8 +18,13 @@
 #ifndef INCLUDED_LIBUHD_USRP_COMMON_RECV_PACKET_DEMUXER_3000_HPP
 #define INCLUDED_LIBUHD_USRP_COMMON_RECV_PACKET_DEMUXER_3000_HPP
 
+#include "../../transport/sid_route_table.hpp"
 #include <uhd/config.hpp>
+#include <uhd/exception.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/lockfree_bounded_buffer.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <stdint.h>
 #include <boost/thread.hpp>
 #include <uhd/utils/msg.hpp>
@@ -27,25 +32,51 @@
 #include <uhd/types/time_spec.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <queue>
-#include <map>
+#include <vector>
+#include <boost/atomic.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
 
 namespace uhd{ namespace usrp{
 
+    /*!
+     * Hands the packets of one transport to the receivers of their sids.
+     *
+     * By default, the receivers take turns calling into the transport and
+     * queue the packets of the other sids they come across. With a poller,
+     * one thread of the demuxer receives all packets instead, and each
+     * receiver waits on a lock-free queue of its own. Receivers of
+     * different sids then never wait on each other.
+     */
     struct recv_packet_demuxer_3000 : boost::enable_shared_from_this<recv_packet_demuxer_3000>
     {
         typedef boost::shared_ptr<recv_packet_demuxer_3000> sptr;
-        static sptr make(transport::zero_copy_if::sptr xport)
+        static sptr make(transport::zero_copy_if::sptr xport, const bool use_poller = false)
         {
-            return sptr(new recv_packet_demuxer_3000(xport));
+            return sptr(new recv_packet_demuxer_3000(xport, use_poller));
         }
 
-        recv_packet_demuxer_3000(transport::zero_copy_if::sptr xport):
-            _xport(xport)
-        {/*NOP*/}
+        recv_packet_demuxer_3000(transport::zero_copy_if::sptr xport, const bool use_poller = false):
+            _xport(xport), _poller_running(use_poller)
+        {
+            if (use_poller) _poller = boost::thread(
+                boost::bind(&recv_packet_demuxer_3000::_poll_loop, this));
+        }
+
+        ~recv_packet_demuxer_3000(void)
+        {
+            UHD_SAFE_CALL(
+                if (_poller.joinable()) {
+                    _poller_running = false;
+                    _poller.join();
+                }
+            )
+        }
 
         transport::managed_recv_buffer::sptr get_recv_buff(const uint32_t sid, const double timeout)
         {
+            if (_poller.joinable()) return _get_polled_buff(sid, timeout);
             const time_spec_t exit_time = time_spec_t(timeout) + time_spec_t::get_system_time();
             transport::managed_recv_buffer::sptr buff;
             buff = _internal_get_recv_buff(sid, timeout);
@@ -66,14 +97,17 @@ namespace uhd{ namespace usrp{
             //----------------------------------------------------------
             //-- Check the queue to see if we already have a buffer
             //----------------------------------------------------------
+            sid_queue_t *own_queue = _find_queue(sid);
+            if (own_queue == NULL) own_queue = _alloc_queue(sid);
+            if (own_queue->size != 0)
             {
                 boost::mutex::scoped_lock l(mutex);
-                queue_type_t &queue = _queues[sid];
-                if (not queue.empty())
+                if (not own_queue->queue.empty())
                 {
-                    buff = queue.front();
-                    queue.front().reset();
-                    queue.pop();
+                    buff = own_queue->queue.front();
+                    own_queue->queue.front().reset();
+                    own_queue->queue.pop();
+                    own_queue->size--;
                     return buff;
                 }
             }
@@ -102,11 +136,16 @@ namespace uhd{ namespace usrp{
                     const uint32_t new_sid = uhd::wtohx(buff->cast<const uint32_t *>()[1]);
                     if (new_sid != sid)
                     {
-                        boost::mutex::scoped_lock l(mutex);
-                        if (_queues.count(new_sid) == 0) UHD_MSG(error)
+                        sid_queue_t *queue = _find_queue(new_sid);
+                        if (queue == NULL) UHD_MSG(error)
                             << "recv packet demuxer unexpected sid 0x" << std::hex << new_sid << std::dec
                             << std::endl;
-                        else _queues[new_sid].push(buff);
+                        else
+                        {
+                            boost::mutex::scoped_lock l(mutex);
+                            queue->queue.push(buff);
+                            queue->size++;
+                        }
                         buff.reset();
                     }
                 }
@@ -118,20 +157,109 @@ namespace uhd{ namespace usrp{
             return buff;
         }
 
+        /*!
+         * Route a sid and clear its queue. Without a poller, not while the
+         * receiver of the sid is in get_recv_buff(); with a poller, any time.
+         */
         void realloc_sid(const uint32_t sid)
         {
+            sid_queue_t *queue = _alloc_queue(sid); //allocated if not already
             boost::mutex::scoped_lock l(mutex);
-            while(not _queues[sid].empty()) //allocated and clears if already allocated
+            while(not queue->queue.empty()) //clears if already allocated
             {
-                _queues[sid].pop();
+                queue->queue.pop();
             }
+            queue->size = 0;
+            transport::managed_recv_buffer::sptr buff;
+            while (queue->polled.pop_with_haste(buff)) buff.reset();
         }
 
         transport::zero_copy_if::sptr make_proxy(const uint32_t sid);
 
         typedef std::queue<transport::managed_recv_buffer::sptr> queue_type_t;
-        std::map<uint32_t, queue_type_t> _queues;
+
+        /*!
+         * The buffers received for one sid, size is read without the lock.
+         * With a poller, the packets go to polled instead, which can hold
+         * every frame of the transport. polled has two consumers: the
+         * receiver of the sid and realloc_sid(), which the overflow handler
+         * of another streamer may call while the receiver is waiting.
+         */
+        struct sid_queue_t
+        {
+            sid_queue_t(const uint32_t sid, const size_t num_frames):
+                sid(sid), size(0), polled(num_frames) {}
+            const uint32_t sid;
+            queue_type_t queue;
+            boost::atomic<size_t> size;
+            transport::mpmc_bounded_buffer<transport::managed_recv_buffer::sptr> polled;
+        };
+
+        /*!
+         * The queues are looked up by both halves of the sid folded into
+         * 16 bits: B1xx and B2xx data sids differ in the low half, the
+         * response sids in the high half.
+         */
+        static UHD_INLINE uint16_t _route_addr(const uint32_t sid)
+        {
+            return uint16_t(sid ^ (sid >> 16));
+        }
+
+        UHD_INLINE sid_queue_t *_find_queue(const uint32_t sid) const
+        {
+            sid_queue_t *queue = _routes.find(_route_addr(sid));
+            return (queue != NULL and queue->sid == sid)? queue : NULL;
+        }
+
+        sid_queue_t *_alloc_queue(const uint32_t sid)
+        {
+            boost::mutex::scoped_lock l(mutex);
+            sid_queue_t *queue = _routes.find(_route_addr(sid));
+            if (queue == NULL)
+            {
+                _queues.push_back(boost::make_shared<sid_queue_t>(sid, _xport->get_num_recv_frames()));
+                queue = _queues.back().get();
+                _routes.exchange(_route_addr(sid), queue);
+            }
+            else if (queue->sid != sid) throw uhd::key_error(str(boost::format(
+                "recv packet demuxer cannot route sid 0x%08x along with sid 0x%08x") % sid % queue->sid));
+            return queue;
+        }
+
+        transport::managed_recv_buffer::sptr _get_polled_buff(const uint32_t sid, const double timeout)
+        {
+            sid_queue_t *own_queue = _find_queue(sid);
+            if (own_queue == NULL) own_queue = _alloc_queue(sid);
+            transport::managed_recv_buffer::sptr buff;
+            own_queue->polled.pop_with_timed_wait(buff, timeout);
+            return buff;
+        }
+
+        //! The poller: receive all packets, push them to the queues of their sids
+        void _poll_loop(void)
+        {
+            scoped_internal_thread internal_thread("recv demux", "transport");
+            while (_poller_running)
+            {
+                //the timeout bounds the time it takes to stop the poller
+                transport::managed_recv_buffer::sptr buff = _xport->get_recv_buff(0.1);
+                if (not buff) continue;
+                const uint32_t new_sid = uhd::wtohx(buff->cast<const uint32_t *>()[1]);
+                sid_queue_t *queue = _find_queue(new_sid);
+                if (queue == NULL) UHD_MSG(error)
+                    << "recv packet demuxer unexpected sid 0x" << std::hex << new_sid << std::dec
+                    << std::endl;
+                //the queue holds all frames of the transport, so it cannot be full
+                else queue->polled.push_with_haste(buff);
+            }
+        }
+
+        //queues are only freed with the demuxer, so a route found is always valid
+        std::vector<boost::shared_ptr<sid_queue_t> > _queues;
+        transport::sid_route_table<sid_queue_t> _routes;
         transport::zero_copy_if::sptr _xport;
+        boost::atomic<bool> _poller_running;
+        boost::thread _poller;
 #ifdef RECV_PACKET_DEMUXER_3000_THREAD_SAFE
         uhd::atomic_uint32_t _claimed;
         boost::condition_variable cond;
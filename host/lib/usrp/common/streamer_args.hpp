@@ -0,0 +1,284 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_STREAMER_ARGS_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_STREAMER_ARGS_HPP
+
+#include "constrained_device_args.hpp"
+#include <uhd/stream.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace uhd {
+namespace usrp {
+
+    //! The transport profiles of stream arg "profile"
+    enum stream_profile_t {
+        STREAM_PROFILE_DEFAULT = 0,
+        STREAM_PROFILE_THROUGHPUT = 1,
+        STREAM_PROFILE_LATENCY = 2
+    };
+
+    //! The values of stream arg "profile", in the order of stream_profile_t
+    inline std::vector<std::string> get_stream_profile_names() {
+        return boost::assign::list_of("default")("throughput")("latency");
+    }
+
+    //! Parse stream arg "profile" alone, for devices that read their other stream args themselves
+    inline stream_profile_t get_stream_profile(const device_addr_t& args) {
+        constrained_device_args_t::enum_arg<stream_profile_t> profile(
+            "profile", STREAM_PROFILE_DEFAULT, get_stream_profile_names());
+        if (args.has_key("profile")) profile.parse(args["profile"]);
+        return profile.get();
+    }
+
+    /*!
+     * The transport settings a stream profile chose.
+     * A value of 0 leaves that setting to the device.
+     */
+    struct stream_profile_settings_t {
+        stream_profile_settings_t():
+            spp(0), frame_size(0), num_frames(0), buff_size(0) {}
+
+        size_t spp;
+        size_t frame_size; //!< bytes per frame, including the header
+        size_t num_frames;
+        size_t buff_size;  //!< socket buffer, in bytes
+
+        std::string to_string() const {
+            return str(boost::format("spp=%u, frame_size=%u, num_frames=%u, buff_size=%u")
+                % spp % frame_size % num_frames % buff_size);
+        }
+    };
+
+    /*!
+     * Choose the transport settings of one stream from its rate.
+     *
+     * - throughput: the largest frames, enough frames for 10 ms and
+     *   a socket buffer for 0.5 s of samples.
+     * - latency: frames that hold about 100 us of samples, enough
+     *   frames for 5 ms and a socket buffer for 20 ms.
+     *
+     * \param profile the stream profile
+     * \param samp_rate samples per second of all channels on the transport, <= 0 if unknown
+     * \param bpi bytes per item over the wire
+     * \param hdr_size the largest packet header, in bytes
+     * \param max_frame_size the largest frame the link (MTU) allows, 0 if unknown
+     */
+    inline stream_profile_settings_t compute_stream_profile(
+        const stream_profile_t profile,
+        const double samp_rate,
+        const size_t bpi,
+        const size_t hdr_size,
+        const size_t max_frame_size
+    ) {
+        static const double THROUGHPUT_FRAMES_SECS = 10e-3;
+        static const double THROUGHPUT_BUFF_SECS   = 0.5;
+        static const double LATENCY_PACKET_SECS    = 100e-6;
+        static const double LATENCY_FRAMES_SECS    = 5e-3;
+        static const double LATENCY_BUFF_SECS      = 20e-3;
+        static const size_t MIN_SPP                = 16;
+        static const size_t MIN_NUM_FRAMES         = 16;
+        static const size_t MAX_NUM_FRAMES         = 1024;
+        static const size_t MAX_BUFF_SIZE          = 64*1024*1024;
+
+        stream_profile_settings_t settings;
+        if (profile == STREAM_PROFILE_DEFAULT or bpi == 0 or max_frame_size < hdr_size + bpi) {
+            return settings;
+        }
+        const size_t max_spp = (max_frame_size - hdr_size) / bpi;
+        const bool latency = (profile == STREAM_PROFILE_LATENCY);
+        settings.spp = max_spp;
+        if (latency and samp_rate > 0) {
+            settings.spp = std::min(max_spp, std::max(MIN_SPP, size_t(samp_rate*LATENCY_PACKET_SECS)));
+        }
+        //whole 32-bit words of payload
+        while (settings.spp > 1 and (settings.spp*bpi) % sizeof(uint32_t) != 0) {
+            settings.spp--;
+        }
+        settings.frame_size = hdr_size + settings.spp*bpi;
+        if (samp_rate <= 0) {
+            return settings;
+        }
+
+        //frames carry their header too
+        const double bytes_per_sec = samp_rate * settings.frame_size / settings.spp;
+        const double frames_secs = latency ? LATENCY_FRAMES_SECS : THROUGHPUT_FRAMES_SECS;
+        const double buff_secs = latency ? LATENCY_BUFF_SECS : THROUGHPUT_BUFF_SECS;
+        settings.num_frames = std::min(MAX_NUM_FRAMES, std::max(MIN_NUM_FRAMES,
+            size_t(std::ceil(bytes_per_sec*frames_secs / settings.frame_size))));
+        settings.buff_size = std::min(MAX_BUFF_SIZE, std::max(settings.num_frames*settings.frame_size,
+            size_t(bytes_per_sec*buff_secs)));
+        return settings;
+    }
+
+    /*!
+     * Cap a TX flow control window at the latency given in stream args.
+     *
+     * Every packet the host has sent and the device did not acknowledge yet
+     * waits in a device buffer, so the window bounds the samples queued
+     * between send() and the DAC. "max_latency_samps" caps that at a number
+     * of samples, "max_latency" at seconds of samples at \p samp_rate.
+     * The window holds whole packets and at least one.
+     *
+     * \param fc_window the window the device buffers allow, in packets
+     * \param stream_args the stream args of this channel
+     * \param spp samples per packet
+     * \param samp_rate samples per second into the device, <= 0 if unknown
+     * \return the window in packets
+     * \throws uhd::value_error for max_latency at an unknown rate
+     */
+    inline size_t compute_tx_latency_window(
+        const size_t fc_window,
+        const device_addr_t& stream_args,
+        const size_t spp,
+        const double samp_rate
+    ) {
+        double max_samps = 0.0;
+        if (stream_args.has_key("max_latency_samps")) {
+            max_samps = stream_args.cast<double>("max_latency_samps", 0.0);
+        } else if (stream_args.has_key("max_latency")) {
+            if (samp_rate <= 0) {
+                throw uhd::value_error("max_latency needs a known sample rate, use max_latency_samps instead");
+            }
+            max_samps = stream_args.cast<double>("max_latency", 0.0) * samp_rate;
+        } else {
+            return fc_window;
+        }
+        if (max_samps <= 0 or spp == 0) {
+            throw uhd::value_error("max_latency and max_latency_samps must be positive");
+        }
+        const size_t window = std::max<size_t>(1, size_t(max_samps / spp));
+        return std::min(fc_window, window);
+    }
+
+    /*!
+     * The generic keys of uhd::stream_args_t::args, parsed once when a
+     * streamer is made. The device specific keys are left to the device,
+     * keys that neither knows about are reported with a warning.
+     */
+    class streamer_args_t : public constrained_device_args_t {
+    public:
+        explicit streamer_args_t(const stream_args_t& stream_args):
+            _spp("spp", 0.0),
+            _fullscale("fullscale", 1.0),
+            _peak("peak", 1.0),
+            _convert_threads("convert_threads", 1),
+            _pipeline_depth("pipeline_depth", 0),
+            _host_decim("host_decim", 1),
+            _power_meta("power_meta", false),
+            _nontemporal_stores("nontemporal_stores", "auto"),
+            _profile("profile", STREAM_PROFILE_DEFAULT, get_stream_profile_names())
+        {
+            parse(stream_args.args);
+        }
+
+        //! True when spp was given (and not 0)
+        bool has_spp() const {
+            return size_t(_spp.get()) != 0;
+        }
+        //! The samples per packet that were given, or default_spp
+        size_t get_spp(const size_t default_spp) const {
+            return has_spp() ? size_t(_spp.get()) : default_spp;
+        }
+        double get_fullscale() const {
+            return _fullscale.get();
+        }
+        double get_peak() const {
+            return _peak.get();
+        }
+        size_t get_convert_threads() const {
+            return _convert_threads.get();
+        }
+        size_t get_pipeline_depth() const {
+            return _pipeline_depth.get();
+        }
+        size_t get_host_decim() const {
+            return _host_decim.get();
+        }
+        bool get_power_meta() const {
+            return _power_meta.get();
+        }
+        const std::string& get_nontemporal_stores() const {
+            return _nontemporal_stores.get();
+        }
+        stream_profile_t get_profile() const {
+            return _profile.get();
+        }
+
+        inline virtual std::string to_string() const {
+            return  _spp.to_string() + ", " +
+                    _fullscale.to_string() + ", " +
+                    _peak.to_string() + ", " +
+                    _convert_threads.to_string() + ", " +
+                    _pipeline_depth.to_string() + ", " +
+                    _host_decim.to_string() + ", " +
+                    _power_meta.to_string() + ", " +
+                    _nontemporal_stores.to_string() + ", " +
+                    _profile.to_string();
+        }
+
+    private:
+        virtual void _parse(const device_addr_t& dev_args) {
+            const std::vector<generic_arg*> schema = boost::assign::list_of<generic_arg*>
+                (&_spp)(&_fullscale)(&_peak)(&_convert_threads)
+                (&_pipeline_depth)(&_host_decim)(&_power_meta)
+                (&_nontemporal_stores)(&_profile);
+            std::vector<std::string> unknown_keys;
+            _parse_args(dev_args, schema, &unknown_keys);
+
+            //keys that one device or another reads by itself
+            std::vector<std::string> ignored_keys;
+            BOOST_FOREACH(const std::string& key, unknown_keys) {
+                if (not _is_device_key(key)) ignored_keys.push_back(key);
+            }
+            _warn_unknown_keys("stream arg", ignored_keys);
+
+            //the streamers check the others when they are set
+            _enforce_range(_spp, 0.0, double(UINT_MAX));
+        }
+
+        //! Is key one of the device specific keys, with or without a channel number
+        static bool _is_device_key(const std::string& key) {
+            static const std::vector<std::string> device_keys = boost::assign::list_of
+                ("underflow_policy")("overflow_policy")("noclear")("port")("addr")
+                ("cpu")("dc_offset_i")("dc_offset_q")("iq_balance_mag")("iq_balance_phase")
+                ("block_id")("block_port")("radio_id")("radio_port")
+                ("recv_frame_size")("send_frame_size")("num_recv_frames")("num_send_frames")
+                ("recv_buff_size")("send_buff_size")
+                ("recv_spin")("busy_poll")("prefer_busy_poll")
+                ("max_latency")("max_latency_samps");
+            const std::string name = boost::algorithm::trim_right_copy_if(
+                key, boost::algorithm::is_digit());
+            return std::find(device_keys.begin(), device_keys.end(), name) != device_keys.end();
+        }
+
+        constrained_device_args_t::num_arg<double>   _spp;
+        constrained_device_args_t::num_arg<double>   _fullscale;
+        constrained_device_args_t::num_arg<double>   _peak;
+        constrained_device_args_t::num_arg<size_t>   _convert_threads;
+        constrained_device_args_t::num_arg<size_t>   _pipeline_depth;
+        constrained_device_args_t::num_arg<size_t>   _host_decim;
+        constrained_device_args_t::bool_arg          _power_meta;
+        constrained_device_args_t::str_ci_arg        _nontemporal_stores;
+        constrained_device_args_t::enum_arg<stream_profile_t> _profile;
+    };
+}} //namespaces
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_STREAMER_ARGS_HPP */
@@ -23,7 +23,6 @@
 #include <boost/format.hpp>
 #include <boost/asio.hpp> //used for htonl and ntohl
 #include <boost/foreach.hpp>
-#include "fw_comm_protocol.h"
 
 namespace uhd { namespace usrp { namespace usrp3 {
 
@@ -47,7 +46,8 @@ usrp3_fw_ctrl_iface::usrp3_fw_ctrl_iface(
     const uint16_t product_id,
     const bool verbose) :
     _product_id(product_id), _verbose(verbose), _udp_xport(udp_xport),
-    _seq_num(0)
+    _window(udp_xport, &usrp3_fw_ctrl_iface::_check_reply, "udp fw", verbose),
+    _batch_depth(0)
 {
     flush();
     peek32(0);
@@ -55,119 +55,76 @@ usrp3_fw_ctrl_iface::usrp3_fw_ctrl_iface(
 
 usrp3_fw_ctrl_iface::~usrp3_fw_ctrl_iface()
 {
-    flush();
+    try {
+        flush();
+    } catch(...) {}
 }
 
 void usrp3_fw_ctrl_iface::flush()
 {
     boost::mutex::scoped_lock lock(_mutex);
-    _flush();
+    _window.wait_all();
+    _window.flush();
 }
 
 void usrp3_fw_ctrl_iface::poke32(const wb_addr_type addr, const uint32_t data)
 {
     boost::mutex::scoped_lock lock(_mutex);
 
-    for (size_t i = 1; i <= NUM_RETRIES; i++) {
-        try {
-            _poke32(addr, data);
-            return;
-        } catch(const std::exception &ex) {
-            const std::string error_msg = str(boost::format(
-                "udp fw poke32 failure #%u\n%s") % i % ex.what());
-            if (_verbose) UHD_MSG(warning) << error_msg << std::endl;
-            if (i == NUM_RETRIES) throw uhd::io_error(error_msg);
-        }
-    }
-}
-
-uint32_t usrp3_fw_ctrl_iface::peek32(const wb_addr_type addr)
-{
-    boost::mutex::scoped_lock lock(_mutex);
-
-    for (size_t i = 1; i <= NUM_RETRIES; i++) {
-        try {
-            return _peek32(addr);
-        } catch(const std::exception &ex) {
-            const std::string error_msg = str(boost::format(
-                "udp fw peek32 failure #%u\n%s") % i % ex.what());
-            if (_verbose) UHD_MSG(warning) << error_msg << std::endl;
-            if (i == NUM_RETRIES) throw uhd::io_error(error_msg);
-        }
-    }
-    return 0;
-}
-
-void usrp3_fw_ctrl_iface::_poke32(const wb_addr_type addr, const uint32_t data)
-{
     //Load request struct
-    fw_comm_pkt_t request;
+    fw_comm_pkt_t request = fw_comm_pkt_t();
     request.id = uhd::htonx<uint32_t>(FW_COMM_GENERATE_ID(_product_id));
     request.flags = uhd::htonx<uint32_t>(FW_COMM_FLAGS_ACK | FW_COMM_CMD_POKE32);
-    request.sequence = uhd::htonx<uint32_t>(_seq_num++);
     request.addr = uhd::htonx(addr);
     request.data_words = 1;
     request.data[0] = uhd::htonx(data);
 
-    //Send request
-    _flush();
-    _udp_xport->send(boost::asio::buffer(&request, sizeof(request)));
-
-    //Recv reply
-    fw_comm_pkt_t reply;
-    const size_t nbytes = _udp_xport->recv(boost::asio::buffer(&reply, sizeof(reply)), 1.0);
-    if (nbytes == 0) throw uhd::io_error("udp fw poke32 - reply timed out");
-
-    //Sanity checks
-    const size_t flags = uhd::ntohx<uint32_t>(reply.flags);
-    UHD_ASSERT_THROW(nbytes == sizeof(reply));
-    UHD_ASSERT_THROW(not (flags & FW_COMM_FLAGS_ERROR_MASK));
-    UHD_ASSERT_THROW(flags & FW_COMM_CMD_POKE32);
-    UHD_ASSERT_THROW(flags & FW_COMM_FLAGS_ACK);
-    UHD_ASSERT_THROW(reply.sequence == request.sequence);
-    UHD_ASSERT_THROW(reply.addr == request.addr);
-    UHD_ASSERT_THROW(reply.data[0] == request.data[0]);
+    //Pokes of a batch go out without waiting for their replies
+    if (_batch_depth != 0) _window.post(request);
+    else _window.transact(request);
 }
 
-uint32_t usrp3_fw_ctrl_iface::_peek32(const wb_addr_type addr)
+uint32_t usrp3_fw_ctrl_iface::peek32(const wb_addr_type addr)
 {
+    boost::mutex::scoped_lock lock(_mutex);
+
     //Load request struct
-    fw_comm_pkt_t request;
+    fw_comm_pkt_t request = fw_comm_pkt_t();
     request.id = uhd::htonx<uint32_t>(FW_COMM_GENERATE_ID(_product_id));
     request.flags = uhd::htonx<uint32_t>(FW_COMM_FLAGS_ACK | FW_COMM_CMD_PEEK32);
-    request.sequence = uhd::htonx<uint32_t>(_seq_num++);
     request.addr = uhd::htonx(addr);
     request.data_words = 1;
     request.data[0] = 0;
 
-    //Send request
-    _flush();
-    _udp_xport->send(boost::asio::buffer(&request, sizeof(request)));
+    //return result!
+    return uhd::ntohx<uint32_t>(_window.transact(request).data[0]);
+}
+
+void usrp3_fw_ctrl_iface::begin_batch(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    _batch_depth++;
+}
 
-    //Recv reply
-    fw_comm_pkt_t reply;
-    const size_t nbytes = _udp_xport->recv(boost::asio::buffer(&reply, sizeof(reply)), 1.0);
-    if (nbytes == 0) throw uhd::io_error("udp fw peek32 - reply timed out");
+void usrp3_fw_ctrl_iface::commit(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    if (_batch_depth == 0 or --_batch_depth != 0) return;
+    _window.wait_all();
+}
 
+void usrp3_fw_ctrl_iface::_check_reply(
+    const fw_comm_pkt_t &request, const fw_comm_pkt_t &reply, const size_t nbytes)
+{
     //Sanity checks
-    const size_t flags = uhd::ntohx<uint32_t>(reply.flags);
+    const uint32_t cmd = uhd::ntohx<uint32_t>(request.flags) & FW_COMM_FLAGS_CMD_MASK;
+    const uint32_t flags = uhd::ntohx<uint32_t>(reply.flags);
     UHD_ASSERT_THROW(nbytes == sizeof(reply));
     UHD_ASSERT_THROW(not (flags & FW_COMM_FLAGS_ERROR_MASK));
-    UHD_ASSERT_THROW(flags & FW_COMM_CMD_PEEK32);
+    UHD_ASSERT_THROW((flags & FW_COMM_FLAGS_CMD_MASK) == cmd);
     UHD_ASSERT_THROW(flags & FW_COMM_FLAGS_ACK);
-    UHD_ASSERT_THROW(reply.sequence == request.sequence);
     UHD_ASSERT_THROW(reply.addr == request.addr);
-
-    //return result!
-    return uhd::ntohx<uint32_t>(reply.data[0]);
-}
-
-void usrp3_fw_ctrl_iface::_flush(void)
-{
-    char buff[FW_COMM_PROTOCOL_MTU] = {};
-    while (_udp_xport->recv(boost::asio::buffer(buff), 0.0)) {
-        /*NOP*/
-    }
+    if (cmd == FW_COMM_CMD_POKE32) UHD_ASSERT_THROW(reply.data[0] == request.data[0]);
 }
 
 std::vector<std::string> usrp3_fw_ctrl_iface::discover_devices(
@@ -21,6 +21,8 @@
 #include <uhd/types/wb_iface.hpp>
 #include <uhd/transport/udp_simple.hpp>
 #include <boost/thread/mutex.hpp>
+#include "fw_comm_protocol.h"
+#include "fw_ctrl_window.hpp"
 #include <vector>
 
 namespace uhd { namespace usrp { namespace usrp3 {
@@ -37,6 +39,8 @@ public:
     // -- uhd::wb_iface --
     void poke32(const wb_addr_type addr, const uint32_t data);
     uint32_t peek32(const wb_addr_type addr);
+    void begin_batch(void);
+    void commit(void);
     void flush();
 
     static uhd::wb_iface::sptr make(
@@ -54,17 +58,14 @@ public:
         uint16_t product_id);
 
 private:
-    void _poke32(const wb_addr_type addr, const uint32_t data);
-    uint32_t _peek32(const wb_addr_type addr);
-    void _flush(void);
+    static void _check_reply(const fw_comm_pkt_t &request, const fw_comm_pkt_t &reply, const size_t nbytes);
 
     const uint16_t               _product_id;
     const bool                          _verbose;
     uhd::transport::udp_simple::sptr    _udp_xport;
-    uint32_t                     _seq_num;
+    fw_ctrl_window<fw_comm_pkt_t>       _window;
+    size_t                              _batch_depth;
     boost::mutex                        _mutex;
-
-    static const size_t NUM_RETRIES = 3;
 };
 
 }}} //namespace
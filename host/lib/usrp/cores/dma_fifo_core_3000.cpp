@@ -40,6 +40,7 @@ protected:
         static const uint32_t RB_BIST_STATUS     = 1;
         static const uint32_t RB_BIST_XFER_CNT   = 2;
         static const uint32_t RB_BIST_CYC_CNT    = 3;
+        static const uint32_t RB_PLAYBACK_STATUS = 4;
 
         rb_addr_reg_t(uint32_t base):
             soft_reg32_wo_t(base + 0)
@@ -154,6 +155,18 @@ protected:
         }
     };
 
+    class playback_ctrl_reg_t : public soft_reg32_wo_t {
+    public:
+        UHD_DEFINE_SOFT_REG_FIELD(MODE,    /*width*/ 2, /*shift*/ 0);  //[1:0]
+
+        playback_ctrl_reg_t(uint32_t base):
+            soft_reg32_wo_t(base + 32)
+        {
+            //Initial values
+            set(MODE, PLAYBACK_MODE_FIFO);
+        }
+    };
+
 public:
     class fifo_readback {
     public:
@@ -214,6 +227,18 @@ public:
             return (static_cast<double>(xfer_cnt)/cyc_cnt);
         }
 
+        bool is_playback_supported() {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _addr_reg.write(rb_addr_reg_t::ADDR, rb_addr_reg_t::RB_BIST_STATUS);
+            return _iface->peek32(_rb_addr) & 0x40000000;
+        }
+
+        bool is_playing() {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _addr_reg.write(rb_addr_reg_t::ADDR, rb_addr_reg_t::RB_PLAYBACK_STATUS);
+            return _iface->peek32(_rb_addr) & 0x1;
+        }
+
     private:
         wb_iface::sptr  _iface;
         rb_addr_reg_t   _addr_reg;
@@ -225,7 +250,8 @@ public:
     dma_fifo_core_3000_impl(wb_iface::sptr iface, const size_t base, const size_t readback):
         _iface(iface), _fifo_readback(iface, base, readback),
         _fifo_ctrl_reg(base), _base_addr_reg(base), _addr_mask_reg(base),
-        _bist_ctrl_reg(base), _bist_cfg_reg(base), _bist_delay_reg(base), _bist_sid_reg(base)
+        _bist_ctrl_reg(base), _bist_cfg_reg(base), _bist_delay_reg(base), _bist_sid_reg(base),
+        _playback_ctrl_reg(base)
     {
         _fifo_ctrl_reg.initialize(*iface, true);
         _base_addr_reg.initialize(*iface, true);
@@ -237,6 +263,11 @@ public:
             _bist_delay_reg.initialize(*iface, true);
             _bist_sid_reg.initialize(*iface, true);
         }
+        _has_playback = _fifo_readback.is_playback_supported();
+        if (_has_playback) {
+            //back to FIFO mode, a recording of an earlier session may still be playing
+            _playback_ctrl_reg.initialize(*iface, true);
+        }
         flush();
     }
 
@@ -337,7 +368,30 @@ public:
         }
     }
 
+    virtual bool playback_supported() {
+        return _has_playback;
+    }
+
+    virtual void set_playback_mode(const playback_mode_t mode) {
+        _require_playback();
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _playback_ctrl_reg.write(playback_ctrl_reg_t::MODE, mode);
+    }
+
+    virtual bool is_playing() {
+        _require_playback();
+        return _fifo_readback.is_playing();
+    }
+
 private:
+    void _require_playback()
+    {
+        if (not _has_playback) {
+            throw uhd::not_implemented_error(
+                "dma_fifo_core_3000: Playback only available on FPGA images with DMA FIFO playback enabled");
+        }
+    }
+
     void _wait_for_fifo_empty()
     {
         boost::posix_time::ptime start_time = boost::posix_time::microsec_clock::local_time();
@@ -370,6 +424,7 @@ private:
     wb_iface::sptr  _iface;
     boost::mutex    _mutex;
     bool            _has_ext_bist;
+    bool            _has_playback;
 
     fifo_readback       _fifo_readback;
     fifo_ctrl_reg_t     _fifo_ctrl_reg;
@@ -379,6 +434,7 @@ private:
     bist_cfg_reg_t      _bist_cfg_reg;
     bist_delay_reg_t    _bist_delay_reg;
     bist_sid_reg_t      _bist_sid_reg;
+    playback_ctrl_reg_t _playback_ctrl_reg;
 };
 
 //
@@ -30,6 +30,18 @@ public:
     typedef boost::shared_ptr<dma_fifo_core_3000> sptr;
     virtual ~dma_fifo_core_3000(void) = 0;
 
+    //! What the FIFO does with its contents (playback only)
+    enum playback_mode_t {
+        //! Pass everything on, as a FIFO (the default)
+        PLAYBACK_MODE_FIFO      = 0,
+        //! Store what comes in and hold it
+        PLAYBACK_MODE_RECORD    = 1,
+        //! Send the stored contents on once, and keep them
+        PLAYBACK_MODE_PLAY_ONCE = 2,
+        //! Send the stored contents on over and over
+        PLAYBACK_MODE_PLAY_LOOP = 3
+    };
+
     /*!
      * Create a DMA FIFO controller using the given bus, settings and readback base
      * Throws uhd::runtime_error if a DMA FIFO is not instantiated in the FPGA
@@ -81,6 +93,23 @@ public:
      */
     virtual double get_bist_throughput(double fifo_clock_rate) = 0;
 
+    /*!
+     * Can the FIFO record and play back its contents (playback FPGA images only)
+     */
+    virtual bool playback_supported() = 0;
+
+    /*!
+     * Change the playback mode. The play modes start from the beginning of
+     * the recording, flush() clears it. If a command time is set on the
+     * interface, the change is timed (playback FPGA images only).
+     */
+    virtual void set_playback_mode(const playback_mode_t mode) = 0;
+
+    /*!
+     * Is the FIFO currently sending a recording on (playback FPGA images only)
+     */
+    virtual bool is_playing() = 0;
+
 };
 
 #endif /* INCLUDED_LIBUHD_USRP_DMA_FIFO_CORE_3000_HPP */
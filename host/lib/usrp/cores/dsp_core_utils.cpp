@@ -20,16 +20,60 @@
 #include <uhd/exception.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <boost/math/special_functions/sign.hpp>
+#include <cmath>
 
 static const int32_t MAX_FREQ_WORD = boost::numeric::bounds<int32_t>::highest();
 static const int32_t MIN_FREQ_WORD = boost::numeric::bounds<int32_t>::lowest();
 
+/*!
+ * Calculate the frequency word with integer arithmetic, which is exact,
+ * when the requested frequency and the tick rate are whole numbers of Hz.
+ * The tick rate must be below 2^31 Hz so the word fits an int64 before
+ * the division. Rounds half away from zero, as the floating point path.
+ * \return false if the arguments cannot be handled this way
+ */
+static bool get_freq_word_exact(
+        const double requested_freq,
+        const double tick_rate,
+        int32_t &freq_word
+) {
+    static const double max_exact = std::pow(2.0, 53);
+    static const double max_rate = std::pow(2.0, 31);
+    if (tick_rate < 1.0 or tick_rate >= max_rate) return false;
+    if (std::abs(requested_freq) >= max_exact) return false;
+    if (std::floor(tick_rate) != tick_rate) return false;
+    if (std::floor(requested_freq) != requested_freq) return false;
+
+    const int64_t rate = int64_t(tick_rate);
+
+    //correct for outside of rate (wrap around), as fmod does
+    int64_t freq = int64_t(requested_freq) % rate;
+    if (2*freq > rate) freq -= rate;
+    else if (2*freq < -rate) freq += rate;
+
+    //round(freq/rate * 2^32) = (2*|freq|*2^32 + rate) / (2*rate)
+    const int64_t num = (freq < 0)? -freq : freq;
+    int64_t word = ((num << 33) + rate) / (2*rate);
+    if (freq < 0) word = -word;
+
+    if (word >= MAX_FREQ_WORD) freq_word = MAX_FREQ_WORD;
+    else if (word <= MIN_FREQ_WORD) freq_word = MIN_FREQ_WORD;
+    else freq_word = int32_t(word);
+    return true;
+}
+
 void get_freq_and_freq_word(
         const double requested_freq,
         const double tick_rate,
         double &actual_freq,
         int32_t &freq_word
 ) {
+    static const double scale_factor = std::pow(2.0, 32);
+    if (get_freq_word_exact(requested_freq, tick_rate, freq_word)) {
+        actual_freq = (double(freq_word) / scale_factor) * tick_rate;
+        return;
+    }
+
     //correct for outside of rate (wrap around)
     double freq = std::fmod(requested_freq, tick_rate);
     if (std::abs(freq) > tick_rate/2.0)
@@ -47,7 +91,6 @@ void get_freq_and_freq_word(
      */
     freq_word = 0;
 
-    static const double scale_factor = std::pow(2.0, 32);
     if ((freq / tick_rate) >= (MAX_FREQ_WORD / scale_factor)) {
         /* Operation would have caused a positive overflow of int32. */
         freq_word = MAX_FREQ_WORD;
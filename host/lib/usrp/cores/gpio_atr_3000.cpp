@@ -18,6 +18,11 @@
 #include "gpio_atr_3000.hpp"
 #include <uhd/types/dict.hpp>
 #include <uhd/utils/soft_register.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
 
 using namespace uhd;
 using namespace usrp;
@@ -42,7 +47,8 @@ public:
         const wb_iface::wb_addr_type base,
         const wb_iface::wb_addr_type rb_addr = READBACK_DISABLED
     ):
-        _iface(iface), _rb_addr(rb_addr),
+        _iface(iface), _rb_addr(rb_addr), _idle_addr(REG_ATR_IDLE_OFFSET),
+        _seq_handler_set(false), _seq_last_time(0.0), _seq_num_late(0), _seq_done_time(0.0),
         _atr_idle_reg(REG_ATR_IDLE_OFFSET, _atr_disable_reg),
         _atr_rx_reg(REG_ATR_RX_OFFSET),
         _atr_tx_reg(REG_ATR_TX_OFFSET),
@@ -58,6 +64,16 @@ public:
         _atr_disable_reg.initialize(*_iface, true);
     }
 
+    virtual ~gpio_atr_3000_impl(void)
+    {
+        UHD_SAFE_CALL(
+            if (_seq_handler_set) {
+                boost::dynamic_pointer_cast<timed_wb_iface>(_iface)->set_cmd_done_handler(
+                    timed_wb_iface::cmd_done_handler_t());
+            }
+        )
+    }
+
     virtual void set_atr_mode(const gpio_atr_mode_t mode, const uint32_t mask)
     {
         //Each bit in the "ATR Disable" register determines whether the respective bit in the GPIO
@@ -164,6 +180,45 @@ public:
         }
     }
 
+    virtual size_t set_gpio_sequence(const std::vector<gpio_event_t> &events)
+    {
+        timed_wb_iface::sptr iface = this->get_timed_iface();
+
+        //Check all events before any of them changes the shadow registers.
+        //A command time of 0.0 would make an untimed write.
+        time_spec_t last_time = _seq_last_time;
+        BOOST_FOREACH(const gpio_event_t &event, events) {
+            if (event.time == time_spec_t(0.0) or event.time < last_time) {
+                throw uhd::value_error("set_gpio_sequence: the events need times, in order");
+            }
+            last_time = event.time;
+        }
+        _seq_last_time = last_time;
+
+        //Each event writes the value of the IDLE register that set_gpio_out() would write
+        BOOST_FOREACH(const gpio_event_t &event, events) {
+            _atr_idle_reg.set_gpio_out_with_mask(event.value, event.mask);
+            _seq_queued.push_back(seq_write_t(event.time, _atr_idle_reg.get_reg_value()));
+        }
+        //The shadow register holds the state after the last event
+        if (not events.empty()) {
+            _atr_idle_reg.set(uhd::soft_reg32_wo_t::REGISTER, _seq_queued.back().data);
+        }
+        return this->push_sequence(*iface);
+    }
+
+    virtual gpio_sequence_status_t get_gpio_sequence_status(void)
+    {
+        gpio_sequence_status_t status;
+        if (_seq_handler_set) {
+            this->push_sequence(*this->get_timed_iface());
+        }
+        status.num_queued = _seq_queued.size();
+        status.num_pending = _seq_sent.size();
+        status.num_late = _seq_num_late;
+        return status;
+    }
+
 protected:
     //Special RB addr value to indicate no readback
     //This value is invalid as a real address because it is not a multiple of 4
@@ -213,11 +268,13 @@ protected:
             return _gpio_out_cache;
         }
 
+        uint32_t get_reg_value() {
+            return (_atr_idle_cache & (~_atr_disable_reg.get())) |
+                   (_gpio_out_cache & _atr_disable_reg.get());
+        }
+
         virtual void flush() {
-            set(REGISTER,
-                (_atr_idle_cache & (~_atr_disable_reg.get())) |
-                (_gpio_out_cache & _atr_disable_reg.get())
-            );
+            set(REGISTER, get_reg_value());
             masked_reg_t::flush();
         }
 
@@ -227,8 +284,80 @@ protected:
         masked_reg_t&   _atr_disable_reg;
     };
 
+    //! A write of the IDLE register at a command time
+    struct seq_write_t
+    {
+        seq_write_t(const time_spec_t &time_, const uint32_t data_): time(time_), data(data_) {}
+        time_spec_t time;
+        uint32_t data;
+    };
+
+    timed_wb_iface::sptr get_timed_iface(void)
+    {
+        timed_wb_iface::sptr iface = boost::dynamic_pointer_cast<timed_wb_iface>(_iface);
+        if (not iface) {
+            throw uhd::not_implemented_error("GPIO sequences need a timed register interface");
+        }
+        if (not _seq_handler_set) {
+            iface->set_cmd_done_handler(boost::bind(&gpio_atr_3000_impl::handle_cmd_done, this, _1));
+            _seq_handler_set = true;
+        }
+        return iface;
+    }
+
+    //! Called by the interface for each executed timed command
+    void handle_cmd_done(const time_spec_t &time)
+    {
+        boost::mutex::scoped_lock lock(_seq_done_mutex);
+        if (time > _seq_done_time) _seq_done_time = time;
+    }
+
+    //! Post queued writes until the command queue is full
+    size_t push_sequence(timed_wb_iface &iface)
+    {
+        iface.get_cmd_queue_space(); //takes the acks that came in
+
+        //Commands execute in order: all writes up to the time of the
+        //latest executed command have executed too
+        time_spec_t done_time;
+        {
+            boost::mutex::scoped_lock lock(_seq_done_mutex);
+            done_time = _seq_done_time;
+        }
+        while (not _seq_sent.empty() and _seq_sent.front() <= done_time) {
+            _seq_sent.pop_front();
+        }
+
+        size_t num_sent = 0;
+        const time_spec_t cmd_time = iface.get_time();
+        try {
+            while (not _seq_queued.empty()) {
+                const seq_write_t &write = _seq_queued.front();
+                iface.set_time(write.time);
+                if (not iface.try_poke32(_idle_addr, write.data)) break;
+                if (write.time <= done_time) _seq_num_late++;
+                _seq_sent.push_back(write.time);
+                _seq_queued.pop_front();
+                num_sent++;
+            }
+        } catch (...) {
+            iface.set_time(cmd_time);
+            throw;
+        }
+        iface.set_time(cmd_time);
+        return num_sent;
+    }
+
     wb_iface::sptr          _iface;
     wb_iface::wb_addr_type  _rb_addr;
+    const wb_iface::wb_addr_type _idle_addr;
+    bool                    _seq_handler_set;
+    time_spec_t             _seq_last_time;
+    std::deque<seq_write_t> _seq_queued;
+    std::deque<time_spec_t> _seq_sent;
+    size_t                  _seq_num_late;
+    boost::mutex            _seq_done_mutex;
+    time_spec_t             _seq_done_time;
     atr_idle_reg_t          _atr_idle_reg;
     masked_reg_t            _atr_rx_reg;
     masked_reg_t            _atr_tx_reg;
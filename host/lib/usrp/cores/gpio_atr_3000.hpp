@@ -23,6 +23,8 @@
 #include <uhd/usrp/gpio_defs.hpp>
 #include <boost/shared_ptr.hpp>
 #include <uhd/types/wb_iface.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <vector>
 
 namespace uhd { namespace usrp { namespace gpio_atr {
 
@@ -34,6 +36,31 @@ public:
 
     virtual ~gpio_atr_3000(void) {};
 
+    //! A timed write to the static GPIO outputs
+    struct gpio_event_t
+    {
+        uhd::time_spec_t time;
+        uint32_t value;
+        uint32_t mask;
+
+        gpio_event_t(
+            const uhd::time_spec_t &time_ = uhd::time_spec_t(0.0),
+            const uint32_t value_ = 0,
+            const uint32_t mask_ = MASK_SET_ALL
+        ): time(time_), value(value_), mask(mask_) {}
+    };
+
+    //! The progress of the timed GPIO writes
+    struct gpio_sequence_status_t
+    {
+        //! Events on the host, waiting for room in the command queue
+        size_t num_queued;
+        //! Events sent to the device that are not known to have executed
+        size_t num_pending;
+        //! Events that were sent after their time had passed
+        size_t num_late;
+    };
+
     /*!
      * Create a read-write GPIO ATR interface object
      *
@@ -104,6 +131,33 @@ public:
      * \param value the value to write to the attribute
      */
     virtual void set_gpio_attr(const gpio_attr_t attr, const uint32_t value) = 0;
+
+    /*!
+     * Schedule a sequence of timed writes to the static GPIO outputs.
+     * The writes are posted to the command queue of the device without
+     * waiting for each to execute, as many as it has room for. The rest
+     * wait on the host and go out with later calls, and with
+     * get_gpio_sequence_status().
+     * This needs a timed register interface, and takes over its
+     * handler for executed commands.
+     *
+     * \param events the writes, in order of time, and after those of
+     *        earlier sequences
+     * \return the number of writes sent to the device by this call
+     * \throws uhd::value_error if an event has no time or is out of order
+     */
+    virtual size_t set_gpio_sequence(const std::vector<gpio_event_t> &events) = 0;
+
+    /*!
+     * Send more of the scheduled GPIO writes, if there is room, and get
+     * the progress of the schedule.
+     * A write is late if the device had already executed a command for
+     * the same time or later when it was sent. It still executes, once
+     * it arrives.
+     *
+     * \return the numbers of queued, pending and late writes
+     */
+    virtual gpio_sequence_status_t get_gpio_sequence_status(void) = 0;
 };
 
 class db_gpio_atr_3000 {
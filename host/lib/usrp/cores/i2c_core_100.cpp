@@ -19,6 +19,7 @@
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <algorithm>
 
 #define REG_I2C_PRESCALER_LO _base + 0
 #define REG_I2C_PRESCALER_HI _base + 2
@@ -53,6 +54,9 @@
 
 using namespace uhd;
 
+//! The most bytes read from an EEPROM in one transaction
+static const size_t EEPROM_READ_CHUNK_LEN = 32;
+
 i2c_core_100::~i2c_core_100(void){
     /* NOP */
 }
@@ -121,6 +125,20 @@ public:
         return bytes;
     }
 
+    //override read_eeprom so we can write the offset once, then read
+    //sequentially; the default implementation calls read i2c once per byte
+    byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes)
+    {
+        byte_vector_t bytes;
+        while (bytes.size() < num_bytes){
+            const size_t chunk_len = std::min(num_bytes - bytes.size(), EEPROM_READ_CHUNK_LEN);
+            this->write_i2c(addr, byte_vector_t(1, uint8_t(offset + bytes.size())));
+            const byte_vector_t chunk = this->read_i2c(addr, chunk_len);
+            bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+        }
+        return bytes;
+    }
+
 private:
     void i2c_wait(void) {
         for (size_t i = 0; i < 100; i++){
@@ -18,7 +18,10 @@
 #include "i2c_core_100_wb32.hpp"
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 #define REG_I2C_PRESCALER_LO _base + 0
 #define REG_I2C_PRESCALER_HI _base + 4
@@ -53,6 +56,11 @@
 
 using namespace uhd;
 
+//! How long to wait for a transfer in progress
+static const long I2C_TIMEOUT_MS = 10;
+//! Status poll interval, about the time of one byte at 400 kHz
+static const long I2C_POLL_US = 25;
+
 i2c_core_100_wb32::~i2c_core_100_wb32(void){
     /* NOP */
 }
@@ -78,6 +86,49 @@ public:
     void write_i2c(
         uint16_t addr,
         const byte_vector_t &bytes
+    ){
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+        _iface->begin_batch();
+        try {
+            this->write_bytes(addr, bytes);
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
+        }
+        _iface->commit();
+    }
+
+    byte_vector_t read_i2c(
+        uint16_t addr,
+        size_t num_bytes
+    ){
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+        _iface->begin_batch();
+        byte_vector_t bytes;
+        try {
+            bytes = this->read_bytes(addr, num_bytes);
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
+        }
+        _iface->commit();
+        return bytes;
+    }
+
+    //override read_eeprom so we can write once, read all N bytes
+    //the default implementation calls read i2c once per byte
+    byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes)
+    {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
+        this->write_i2c(addr, byte_vector_t(1, uint8_t(offset)));
+        return this->read_i2c(addr, num_bytes);
+    }
+
+private:
+    //! Write bytes, the pokes are sent within a batch
+    void write_bytes(
+        uint16_t addr,
+        const byte_vector_t &bytes
     ){
         _iface->poke32(REG_I2C_DATA, (addr << 1) | 0); //addr and read bit (0)
         _iface->poke32(REG_I2C_CMD_STATUS, I2C_CMD_WR | I2C_CMD_START | (bytes.size() == 0 ? I2C_CMD_STOP : 0));
@@ -98,7 +149,8 @@ public:
         }
     }
 
-    byte_vector_t read_i2c(
+    //! Read bytes, the pokes are sent within a batch
+    byte_vector_t read_bytes(
         uint16_t addr,
         size_t num_bytes
     ){
@@ -123,31 +175,28 @@ public:
         return bytes;
     }
 
-    //override read_eeprom so we can write once, read all N bytes
-    //the default implementation calls read i2c once per byte
-    byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes)
-    {
-        this->write_i2c(addr, byte_vector_t(1, uint8_t(offset)));
-        return this->read_i2c(addr, num_bytes);
-    }
-
-private:
-    void i2c_wait(void) {
-        for (size_t i = 0; i < 10; i++)
-        {
-            if ((_iface->peek32(REG_I2C_CMD_STATUS) & I2C_ST_TIP) == 0) return;
-            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    //! Wait for the transfer in progress, return the last status read
+    uint32_t i2c_wait(void) {
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::milliseconds(I2C_TIMEOUT_MS);
+        while (true) {
+            const uint32_t status = _iface->peek32(REG_I2C_CMD_STATUS);
+            if ((status & I2C_ST_TIP) == 0) return status;
+            if (boost::get_system_time() > exit_time) break;
+            boost::this_thread::sleep(boost::posix_time::microseconds(I2C_POLL_US));
         }
         UHD_MSG(error) << "i2c_core_100_wb32: i2c_wait timeout" << std::endl;
+        return I2C_ST_RXACK;
     }
 
     bool wait_chk_ack(void){
-        i2c_wait();
-        return (_iface->peek32(REG_I2C_CMD_STATUS) & I2C_ST_RXACK) == 0;
+        return (i2c_wait() & I2C_ST_RXACK) == 0;
     }
 
     wb_iface::sptr _iface;
     const size_t _base;
+    //! The dboards sharing the bus may be set up from several threads
+    boost::recursive_mutex _mutex;
 };
 
 i2c_core_100_wb32::sptr i2c_core_100_wb32::make(wb_iface::sptr iface, const size_t base)
@@ -18,7 +18,9 @@
 #include "i2c_core_200.hpp"
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <algorithm>
 #include <boost/thread/mutex.hpp>
 
 #define REG_I2C_WR_PRESCALER_LO (1 << 3) | 0
@@ -56,6 +58,14 @@
 
 using namespace uhd;
 
+//! How long to wait for a transfer in progress
+static const long I2C_TIMEOUT_MS = 100;
+//! Status poll interval, about the time of one byte at 400 kHz
+static const long I2C_POLL_US = 25;
+
+//! The most bytes read from an EEPROM in one transaction
+static const size_t EEPROM_READ_CHUNK_LEN = 32;
+
 i2c_core_200::~i2c_core_200(void){
     /* NOP */
 }
@@ -79,6 +89,52 @@ public:
     void write_i2c(
         uint16_t addr,
         const byte_vector_t &bytes
+    ){
+        _iface->begin_batch();
+        try {
+            this->write_bytes(addr, bytes);
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
+        }
+        _iface->commit();
+    }
+
+    byte_vector_t read_i2c(
+        uint16_t addr,
+        size_t num_bytes
+    ){
+        _iface->begin_batch();
+        byte_vector_t bytes;
+        try {
+            bytes = this->read_bytes(addr, num_bytes);
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
+        }
+        _iface->commit();
+        return bytes;
+    }
+
+    //override read_eeprom so we can write the offset once, then read
+    //sequentially; the default implementation calls read i2c once per byte
+    byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes)
+    {
+        byte_vector_t bytes;
+        while (bytes.size() < num_bytes){
+            const size_t chunk_len = std::min(num_bytes - bytes.size(), EEPROM_READ_CHUNK_LEN);
+            this->write_i2c(addr, byte_vector_t(1, uint8_t(offset + bytes.size())));
+            const byte_vector_t chunk = this->read_i2c(addr, chunk_len);
+            bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+        }
+        return bytes;
+    }
+
+private:
+    //! Write bytes, the pokes are sent within a batch
+    void write_bytes(
+        uint16_t addr,
+        const byte_vector_t &bytes
     ){
         this->poke(REG_I2C_WR_DATA, (addr << 1) | 0); //addr and read bit (0)
         this->poke(REG_I2C_WR_CMD, I2C_CMD_WR | I2C_CMD_START | (bytes.size() == 0 ? I2C_CMD_STOP : 0));
@@ -99,7 +155,8 @@ public:
         }
     }
 
-    byte_vector_t read_i2c(
+    //! Read bytes, the pokes are sent within a batch
+    byte_vector_t read_bytes(
         uint16_t addr,
         size_t num_bytes
     ){
@@ -124,18 +181,22 @@ public:
         return bytes;
     }
 
-private:
-    void i2c_wait(void) {
-        for (size_t i = 0; i < 100; i++){
-            if ((this->peek(REG_I2C_RD_ST) & I2C_ST_TIP) == 0) return;
-            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    //! Wait for the transfer in progress, return the last status read
+    uint8_t i2c_wait(void) {
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::milliseconds(I2C_TIMEOUT_MS);
+        while (true) {
+            const uint8_t status = this->peek(REG_I2C_RD_ST);
+            if ((status & I2C_ST_TIP) == 0) return status;
+            if (boost::get_system_time() > exit_time) break;
+            boost::this_thread::sleep(boost::posix_time::microseconds(I2C_POLL_US));
         }
         UHD_MSG(error) << "i2c_core_200: i2c_wait timeout" << std::endl;
+        return I2C_ST_RXACK;
     }
 
     bool wait_chk_ack(void){
-        i2c_wait();
-        return (this->peek(REG_I2C_RD_ST) & I2C_ST_RXACK) == 0;
+        return (i2c_wait() & I2C_ST_RXACK) == 0;
     }
 
     void poke(const size_t what, const uint8_t cmd)
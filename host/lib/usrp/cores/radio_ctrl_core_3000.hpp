@@ -59,6 +59,23 @@ public:
 
     //! Set the tick rate (converting time into ticks)
     virtual void set_tick_rate(const double rate) = 0;
+
+    /*!
+     * Post register writes: poke32() returns without waiting for the
+     * ack as long as fewer than max_outstanding commands are in flight,
+     * and takes the acks that came in meanwhile. An error in an ack of
+     * a posted write is thrown by the next peek or flush() instead.
+     * The limit is capped at the responses the transport can hold.
+     * \param max_outstanding the commands in flight, 0 to wait for each
+     * ack once the transport's responses are used up (the default)
+     */
+    virtual void set_posted_writes(const size_t max_outstanding) = 0;
+
+    /*!
+     * Wait for the acks of all commands in flight.
+     * Throws the first error of a posted write, if there was one.
+     */
+    virtual void flush(void) = 0;
 };
 
 #endif /* INCLUDED_LIBUHD_USRP_RADIO_CTRL_3000_HPP */
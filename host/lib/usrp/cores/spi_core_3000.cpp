@@ -18,6 +18,7 @@
 #include "spi_core_3000.hpp"
 #include <uhd/exception.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/thread/thread.hpp> //sleep
 
 #define SPI_DIV      _base + 0
@@ -48,7 +49,64 @@ public:
         bool readback
     ){
         boost::lock_guard<boost::mutex> lock(_mutex);
+        return this->transact_one(which_slave, config, data, num_bits, readback);
+    }
+
+    std::vector<uint32_t> transact_spi_batch(
+        int which_slave,
+        const spi_config_t &config,
+        const std::vector<uint32_t> &data,
+        size_t num_bits,
+        bool readback
+    ){
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        std::vector<uint32_t> result;
+        if (readback) result.reserve(data.size());
+
+        //the divider and control word are sent once at most (cached),
+        //the data words are sent without waiting for each write to complete;
+        //readbacks still go one by one, there is a single readback register
+        _iface->begin_batch();
+        try {
+            for (size_t i = 0; i < data.size(); i++) {
+                const uint32_t word = this->transact_one(
+                    which_slave, config, data[i], num_bits, readback
+                );
+                if (readback) result.push_back(word);
+            }
+        } catch (...) {
+            UHD_SAFE_CALL(_iface->commit();)
+            throw;
+        }
+        _iface->commit();
+        return result;
+    }
+
+    void set_shutdown(const bool shutdown)
+    {
+        _shutdown_cache = shutdown;
+        _iface->poke32(SPI_SHUTDOWN, _shutdown_cache);
+    }
+
+    bool get_shutdown()
+    {
+        return(_shutdown_cache);
+    }
+
+    void set_divider(const double div)
+    {
+        _div = size_t((div/2) - 0.5);
+    }
 
+private:
+    //! One transaction, with _mutex held
+    uint32_t transact_one(
+        int which_slave,
+        const spi_config_t &config,
+        uint32_t data,
+        size_t num_bits,
+        bool readback
+    ){
         //load SPI divider
         size_t spi_divider = _div;
         if (config.use_custom_divider) {
@@ -92,24 +150,6 @@ public:
         return 0;
     }
 
-    void set_shutdown(const bool shutdown)
-    {
-        _shutdown_cache = shutdown;
-        _iface->poke32(SPI_SHUTDOWN, _shutdown_cache);
-    }
-
-    bool get_shutdown()
-    {
-        return(_shutdown_cache);
-    }
-
-    void set_divider(const double div)
-    {
-        _div = size_t((div/2) - 0.5);
-    }
-
-private:
-
     wb_iface::sptr _iface;
     const size_t _base;
     const size_t _readback;
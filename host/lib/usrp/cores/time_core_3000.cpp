@@ -18,7 +18,11 @@
 #include "time_core_3000.hpp"
 #include <uhd/utils/safe_call.hpp>
 #include <uhd/utils/msg.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <cmath>
+#include <cstring>
 
 #define REG_TIME_HI       _base + 0
 #define REG_TIME_LO       _base + 4
@@ -30,6 +34,94 @@
 
 using namespace uhd;
 
+//! The time model is sampled again once it is older than this
+static const double TIME_MODEL_MAX_AGE = 0.1;
+//! The assumed drift between host and device clock before it was measured
+static const double TIME_MODEL_MAX_DRIFT = 100e-6;
+//! The samples used to measure the drift are at least this far apart...
+static const double TIME_MODEL_MIN_SPAN = 0.05;
+//! ...but not further than this (to follow a slowly changing drift)
+static const double TIME_MODEL_MAX_SPAN = 60.0;
+//! Time for which the model is not used after setting the time at the next PPS
+static const double TIME_MODEL_PPS_HOLD = 1.5;
+
+/***********************************************************************
+ * Seqlock protected snapshot of the time model:
+ * Written under a mutex, read without locks (readers retry if the
+ * snapshot changed while it was copied).
+ **********************************************************************/
+namespace {
+    struct time_model_t
+    {
+        time_model_t(void): valid(false), host_secs(0.0), dev_secs(0.0),
+            slope(1.0), uncertainty(0.0), drift(TIME_MODEL_MAX_DRIFT) {}
+
+        bool valid;
+        double host_secs;   //host time of the sample
+        double dev_secs;    //device time of the sample
+        double slope;       //device seconds per host second
+        double uncertainty; //error of the sample
+        double drift;       //error of the slope
+    };
+
+    class time_model_seqlock
+    {
+    public:
+        time_model_seqlock(void): _seq(0)
+        {
+            this->write(time_model_t());
+        }
+
+        void write(const time_model_t &model)
+        {
+            const uint32_t seq = _seq.load(boost::memory_order_relaxed);
+            _seq.store(seq + 1, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_release);
+            _store(0, model.valid? 1.0 : 0.0);
+            _store(1, model.host_secs);
+            _store(2, model.dev_secs);
+            _store(3, model.slope);
+            _store(4, model.uncertainty);
+            _store(5, model.drift);
+            _seq.store(seq + 2, boost::memory_order_release);
+        }
+
+        time_model_t read(void) const
+        {
+            time_model_t model;
+            while (true) {
+                const uint32_t seq = _seq.load(boost::memory_order_acquire);
+                if (seq & 1) continue; //write in progress
+                model.valid = _load(0) != 0.0;
+                model.host_secs = _load(1);
+                model.dev_secs = _load(2);
+                model.slope = _load(3);
+                model.uncertainty = _load(4);
+                model.drift = _load(5);
+                boost::atomic_thread_fence(boost::memory_order_acquire);
+                if (_seq.load(boost::memory_order_relaxed) == seq) return model;
+            }
+        }
+
+    private:
+        void _store(const size_t i, const double value)
+        {
+            uint64_t bits; std::memcpy(&bits, &value, sizeof(bits));
+            _fields[i].store(bits, boost::memory_order_relaxed);
+        }
+
+        double _load(const size_t i) const
+        {
+            const uint64_t bits = _fields[i].load(boost::memory_order_relaxed);
+            double value; std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        boost::atomic<uint32_t> _seq;
+        boost::atomic<uint64_t> _fields[6];
+    };
+}
+
 time_core_3000::~time_core_3000(void){
     /* NOP */
 }
@@ -42,7 +134,9 @@ struct time_core_3000_impl : time_core_3000
     ):
         _iface(iface),
         _base(base),
-        _readback_bases(readback_bases)
+        _readback_bases(readback_bases),
+        _host_epoch(time_spec_t::get_system_time()),
+        _hold_until(0.0)
     {
         this->set_tick_rate(1); //init to non zero
     }
@@ -58,6 +152,7 @@ struct time_core_3000_impl : time_core_3000
     void set_tick_rate(const double rate)
     {
         _tick_rate = rate;
+        _invalidate_model();
     }
 
     void self_test(void)
@@ -82,8 +177,43 @@ struct time_core_3000_impl : time_core_3000
 
     uhd::time_spec_t get_time_now(void)
     {
+        const double host_before = _host_secs();
         const uint64_t ticks = _iface->peek64(_readback_bases.rb_now);
-        return time_spec_t::from_ticks(ticks, _tick_rate);
+        const double host_after = _host_secs();
+        const time_spec_t time_now = time_spec_t::from_ticks(ticks, _tick_rate);
+        _update_model(host_before, host_after, time_now);
+        return time_now;
+    }
+
+    uhd::time_spec_t get_time_estimate(double *error_bound)
+    {
+        const double host_now = _host_secs();
+        time_model_t model = _model.read();
+        if (not model.valid or host_now - model.host_secs > TIME_MODEL_MAX_AGE) {
+            //one thread samples the device, the others use what it got
+            boost::mutex::scoped_lock lock(_sample_mutex);
+            model = _model.read();
+            if (not model.valid or _host_secs() - model.host_secs > TIME_MODEL_MAX_AGE) {
+                const double host_before = _host_secs();
+                const time_spec_t time_now = this->get_time_now();
+                model = _model.read();
+                if (not model.valid) {
+                    //the model is on hold, use the exact read
+                    if (error_bound != NULL) *error_bound = _host_secs() - host_before;
+                    return time_now;
+                }
+            }
+        }
+        const double age = _host_secs() - model.host_secs;
+        if (error_bound != NULL) *error_bound = model.uncertainty + std::abs(age)*model.drift;
+        return time_spec_t(model.dev_secs) + time_spec_t(age*model.slope);
+    }
+
+    double get_time_estimate_error(void)
+    {
+        double error_bound = 0.0;
+        this->get_time_estimate(&error_bound);
+        return error_bound;
     }
 
     uhd::time_spec_t get_time_last_pps(void)
@@ -98,6 +228,7 @@ struct time_core_3000_impl : time_core_3000
         _iface->poke32(REG_TIME_HI, uint32_t(ticks >> 32));
         _iface->poke32(REG_TIME_LO, uint32_t(ticks >> 0));
         _iface->poke32(REG_TIME_CTRL, CTRL_LATCH_TIME_NOW);
+        _invalidate_model();
     }
 
     void set_time_sync(const uhd::time_spec_t &time)
@@ -106,6 +237,7 @@ struct time_core_3000_impl : time_core_3000
         _iface->poke32(REG_TIME_HI, uint32_t(ticks >> 32));
         _iface->poke32(REG_TIME_LO, uint32_t(ticks >> 0));
         _iface->poke32(REG_TIME_CTRL, CTRL_LATCH_TIME_SYNC);
+        _invalidate_model();
     }
 
     void set_time_next_pps(const uhd::time_spec_t &time)
@@ -114,12 +246,61 @@ struct time_core_3000_impl : time_core_3000
         _iface->poke32(REG_TIME_HI, uint32_t(ticks >> 32));
         _iface->poke32(REG_TIME_LO, uint32_t(ticks >> 0));
         _iface->poke32(REG_TIME_CTRL, CTRL_LATCH_TIME_PPS);
+        //the time jumps at the next PPS, which we can't see
+        _invalidate_model(TIME_MODEL_PPS_HOLD);
+    }
+
+private:
+    double _host_secs(void) const
+    {
+        return (time_spec_t::get_system_time() - _host_epoch).get_real_secs();
+    }
+
+    void _invalidate_model(const double hold_secs = 0.0)
+    {
+        boost::mutex::scoped_lock lock(_model_mutex);
+        _hold_until = _host_secs() + hold_secs;
+        _anchor = time_model_t();
+        _model.write(time_model_t());
+    }
+
+    void _update_model(const double host_before, const double host_after, const time_spec_t &time_now)
+    {
+        boost::mutex::scoped_lock lock(_model_mutex);
+        if (host_before < _hold_until) return;
+
+        time_model_t model;
+        model.valid = true;
+        model.host_secs = (host_before + host_after)/2;
+        model.dev_secs = time_now.get_real_secs();
+        model.uncertainty = (host_after - host_before)/2 + 1.0/_tick_rate;
+
+        //measure the drift against the oldest sample (up to a limit)
+        const double span = model.host_secs - _anchor.host_secs;
+        if (_anchor.valid and span >= TIME_MODEL_MIN_SPAN) {
+            const double slope = (model.dev_secs - _anchor.dev_secs)/span;
+            model.drift = (model.uncertainty + _anchor.uncertainty)/span;
+            model.slope = std::max(1.0 - TIME_MODEL_MAX_DRIFT, std::min(1.0 + TIME_MODEL_MAX_DRIFT, slope));
+            model.drift = std::min(model.drift, TIME_MODEL_MAX_DRIFT) + std::abs(slope - model.slope);
+        } else {
+            const time_model_t last = _model.read();
+            model.slope = last.valid? last.slope : 1.0;
+            model.drift = last.valid? last.drift : TIME_MODEL_MAX_DRIFT;
+        }
+        if (not _anchor.valid or span > TIME_MODEL_MAX_SPAN) _anchor = model;
+        _model.write(model);
     }
 
     wb_iface::sptr _iface;
     const size_t _base;
     const readback_bases_type _readback_bases;
     double _tick_rate;
+    const time_spec_t _host_epoch;
+    boost::mutex _model_mutex;      //serializes model updates
+    boost::mutex _sample_mutex;     //only one thread samples a stale model
+    time_model_seqlock _model;
+    time_model_t _anchor;           //oldest sample used to measure the drift
+    double _hold_until;             //model unused until this host time
 };
 
 time_core_3000::sptr time_core_3000::make(
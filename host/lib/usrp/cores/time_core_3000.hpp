@@ -47,8 +47,22 @@ public:
 
     virtual void set_tick_rate(const double rate) = 0;
 
+    //! Read the time from the device (always a register round trip)
     virtual uhd::time_spec_t get_time_now(void) = 0;
 
+    /*!
+     * Get the device time from a host-side model of the device clock.
+     * The model is updated with every get_time_now() and extrapolated
+     * from the host clock in between, so most calls do not touch the
+     * device. The model is sampled again when it gets too old.
+     * \param error_bound if not NULL, set to the maximum error of the estimate in seconds
+     * \return the estimated device time
+     */
+    virtual uhd::time_spec_t get_time_estimate(double *error_bound = NULL) = 0;
+
+    //! Get the error bound of get_time_estimate() in seconds, if it were called now
+    virtual double get_time_estimate_error(void) = 0;
+
     virtual uhd::time_spec_t get_time_last_pps(void) = 0;
 
     virtual void set_time_now(const uhd::time_spec_t &time) = 0;
@@ -0,0 +1,262 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/daemon_client.hpp>
+#include <uhd/device.hpp>
+#include <uhd/exception.hpp>
+#include <boost/asio.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/format.hpp>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::usrp;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * The daemon protocol: one request line, one reply line, with tab
+ * separated fields. A request is a call name and its arguments, a reply
+ * is "ok" and the results, or "error" and a message.
+ **********************************************************************/
+static const std::string DAEMON_DEFAULT_PORT = "50200";
+
+typedef std::vector<std::string> fields_t;
+
+template <typename T> static std::string to_field(const T &value){
+    return boost::lexical_cast<std::string>(value);
+}
+
+daemon_client::~daemon_client(void)
+{
+    /* NOP */
+}
+
+class daemon_client_impl : public daemon_client
+{
+public:
+    daemon_client_impl(const device_addr_t &args):
+        _socket(_io_service)
+    {
+        const std::string addr = args.get("addr", "127.0.0.1");
+        const std::string port = args.get("port", DAEMON_DEFAULT_PORT);
+        try {
+            asio::ip::tcp::resolver resolver(_io_service);
+            asio::ip::tcp::resolver::query query(asio::ip::tcp::v4(), addr, port);
+            asio::connect(_socket, resolver.resolve(query));
+            _socket.set_option(asio::ip::tcp::no_delay(true));
+        } catch (const boost::system::system_error &e) {
+            throw uhd::io_error(str(boost::format(
+                "daemon_client: cannot connect to uhd_daemon at %s:%s: %s"
+            ) % addr % port % e.what()));
+        }
+    }
+
+    std::string get_pp_string(void)
+    {
+        //the pretty print string spans lines, the daemon sends one per field
+        return boost::algorithm::join(call(fields("get_pp_string")), "\n");
+    }
+
+    size_t get_rx_num_channels(void)
+    {
+        return result<size_t>(fields("get_rx_num_channels"));
+    }
+
+    rx_streamer::sptr get_rx_stream(const stream_args_t &args)
+    {
+        boost::mutex::scoped_lock lock(_stream_mutex);
+        if (not _shm_device) {
+            const std::string name = result<std::string>(fields("get_shm_name"));
+            _shm_device = device::make(device_addr_t("type=shm,name=" + name), device::USRP);
+        }
+        return _shm_device->get_rx_stream(args);
+    }
+
+    double get_rx_rate(size_t chan)
+    {
+        return result<double>(fields("get_rx_rate", chan));
+    }
+
+    tune_result_t set_rx_freq(const tune_request_t &tune_request, size_t chan)
+    {
+        fields_t request = fields("set_rx_freq", chan);
+        request.push_back(to_field(tune_request.target_freq));
+        request.push_back(std::string(1, char(tune_request.rf_freq_policy)));
+        request.push_back(to_field(tune_request.rf_freq));
+        request.push_back(std::string(1, char(tune_request.dsp_freq_policy)));
+        request.push_back(to_field(tune_request.dsp_freq));
+        request.push_back(tune_request.args.to_string());
+        const fields_t reply = call(request, 5);
+
+        tune_result_t tune_result;
+        tune_result.clipped_rf_freq = boost::lexical_cast<double>(reply[0]);
+        tune_result.target_rf_freq = boost::lexical_cast<double>(reply[1]);
+        tune_result.actual_rf_freq = boost::lexical_cast<double>(reply[2]);
+        tune_result.target_dsp_freq = boost::lexical_cast<double>(reply[3]);
+        tune_result.actual_dsp_freq = boost::lexical_cast<double>(reply[4]);
+        return tune_result;
+    }
+
+    double get_rx_freq(size_t chan)
+    {
+        return result<double>(fields("get_rx_freq", chan));
+    }
+
+    void set_rx_gain(double gain, const std::string &name, size_t chan)
+    {
+        fields_t request = fields("set_rx_gain", chan);
+        request.push_back(to_field(gain));
+        request.push_back(name);
+        call(request, 0);
+    }
+
+    double get_rx_gain(const std::string &name, size_t chan)
+    {
+        fields_t request = fields("get_rx_gain", chan);
+        request.push_back(name);
+        return result<double>(request);
+    }
+
+    gain_range_t get_rx_gain_range(const std::string &name, size_t chan)
+    {
+        fields_t request = fields("get_rx_gain_range", chan);
+        request.push_back(name);
+        const fields_t reply = call(request, 3);
+        return gain_range_t(
+            boost::lexical_cast<double>(reply[0]),
+            boost::lexical_cast<double>(reply[1]),
+            boost::lexical_cast<double>(reply[2])
+        );
+    }
+
+    void set_rx_antenna(const std::string &ant, size_t chan)
+    {
+        fields_t request = fields("set_rx_antenna", chan);
+        request.push_back(ant);
+        call(request, 0);
+    }
+
+    std::string get_rx_antenna(size_t chan)
+    {
+        return result<std::string>(fields("get_rx_antenna", chan));
+    }
+
+    void set_rx_bandwidth(double bandwidth, size_t chan)
+    {
+        fields_t request = fields("set_rx_bandwidth", chan);
+        request.push_back(to_field(bandwidth));
+        call(request, 0);
+    }
+
+    double get_rx_bandwidth(size_t chan)
+    {
+        return result<double>(fields("get_rx_bandwidth", chan));
+    }
+
+    time_spec_t get_time_now(size_t mboard)
+    {
+        const fields_t reply = call(fields("get_time_now", mboard), 2);
+        return time_spec_t(
+            boost::lexical_cast<time_t>(reply[0]),
+            boost::lexical_cast<double>(reply[1])
+        );
+    }
+
+    sensor_value_t get_mboard_sensor(const std::string &name, size_t mboard)
+    {
+        fields_t request = fields("get_mboard_sensor", mboard);
+        request.push_back(name);
+        return to_sensor(call(request, 4));
+    }
+
+    sensor_value_t get_rx_sensor(const std::string &name, size_t chan)
+    {
+        fields_t request = fields("get_rx_sensor", chan);
+        request.push_back(name);
+        return to_sensor(call(request, 4));
+    }
+
+private:
+    static fields_t fields(const std::string &name)
+    {
+        return fields_t(1, name);
+    }
+
+    static fields_t fields(const std::string &name, const size_t index)
+    {
+        fields_t request = fields(name);
+        request.push_back(to_field(index));
+        return request;
+    }
+
+    //! A sensor is sent as name, value, unit and type
+    static sensor_value_t to_sensor(const fields_t &reply)
+    {
+        sensor_value_t sensor(reply[0], reply[1], reply[2]);
+        sensor.type = sensor_value_t::data_type_t(reply[3].at(0));
+        return sensor;
+    }
+
+    template <typename T> T result(const fields_t &request)
+    {
+        return boost::lexical_cast<T>(call(request, 1)[0]);
+    }
+
+    //! Make a call, and check it succeeded with at least num_results results
+    fields_t call(const fields_t &request, const size_t num_results = 0)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        try {
+            asio::write(_socket, asio::buffer(boost::algorithm::join(request, "\t") + "\n"));
+            asio::read_until(_socket, _buff, '\n');
+        } catch (const boost::system::system_error &e) {
+            throw uhd::io_error(str(boost::format(
+                "daemon_client: lost the connection to uhd_daemon: %s") % e.what()));
+        }
+        std::istream is(&_buff);
+        std::string line;
+        std::getline(is, line);
+
+        fields_t reply;
+        boost::split(reply, line, boost::is_any_of("\t"));
+        if (reply.front() == "error") {
+            throw uhd::runtime_error(str(boost::format(
+                "daemon_client: %s failed in uhd_daemon: %s")
+                % request.front() % (reply.size() > 1? reply[1] : "")));
+        }
+        if (reply.front() != "ok" or reply.size() < num_results + 1) {
+            throw uhd::io_error(str(boost::format(
+                "daemon_client: bad reply to %s from uhd_daemon: %s") % request.front() % line));
+        }
+        reply.erase(reply.begin());
+        return reply;
+    }
+
+    asio::io_service _io_service;
+    asio::ip::tcp::socket _socket;
+    asio::streambuf _buff;
+    boost::mutex _mutex;
+    boost::mutex _stream_mutex;
+    device::sptr _shm_device;
+};
+
+daemon_client::sptr daemon_client::make(const device_addr_t &args)
+{
+    return sptr(new daemon_client_impl(args));
+}
@@ -91,7 +91,7 @@ static dboard_base::sptr make_lf_tx(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new basic_tx(args, 32e6));
 }
 
-UHD_STATIC_BLOCK(reg_basic_and_lf_dboards){
+UHD_DEFERRED_BLOCK("dboard", reg_basic_and_lf_dboards){
     dboard_manager::register_dboard(0x0000, &make_basic_tx, "Basic TX", sd_name_to_conn.keys());
     dboard_manager::register_dboard(0x0001, &make_basic_rx, "Basic RX", sd_name_to_conn.keys());
     dboard_manager::register_dboard(0x000e, &make_lf_tx,    "LF TX",    sd_name_to_conn.keys());
@@ -162,7 +162,7 @@ static dboard_base::sptr make_dbsrx(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new dbsrx(args));
 }
 
-UHD_STATIC_BLOCK(reg_dbsrx_dboard){
+UHD_DEFERRED_BLOCK("dboard", reg_dbsrx_dboard){
     //register the factory function for the rx dbid (others version)
     dboard_manager::register_dboard(0x000D, &make_dbsrx, "DBSRX");
     //register the factory function for the rx dbid (USRP1 version)
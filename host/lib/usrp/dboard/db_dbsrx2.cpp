@@ -172,7 +172,7 @@ static dboard_base::sptr make_dbsrx2(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new dbsrx2(args));
 }
 
-UHD_STATIC_BLOCK(reg_dbsrx2_dboard){
+UHD_DEFERRED_BLOCK("dboard", reg_dbsrx2_dboard){
     //register the factory function for the rx dbid
     dboard_manager::register_dboard(0x0012, &make_dbsrx2, "DBSRX2");
 }
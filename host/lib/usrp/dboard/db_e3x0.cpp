@@ -58,7 +58,7 @@ static dboard_base::sptr make_e300_dboard(dboard_base::ctor_args_t args){
 
 using namespace uhd::usrp;
 
-UHD_STATIC_BLOCK(reg_e3x0_dboards){
+UHD_DEFERRED_BLOCK("dboard", reg_e3x0_dboards){
     dboard_manager::register_dboard(0x0110, &make_e310_dboard, "E310 MIMO XCVR");
     dboard_manager::register_dboard(0x0100, &make_e300_dboard, "E300 SISO XCVR");
 }
@@ -143,7 +143,7 @@ static dboard_base::sptr make_rfx_flex2400(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new rfx_xcvr(args, freq_range_t(2300e6, 2900e6), false, false));
 }
 
-UHD_STATIC_BLOCK(reg_rfx_dboards){
+UHD_DEFERRED_BLOCK("dboard", reg_rfx_dboards){
     dboard_manager::register_dboard(0x0024, 0x0028, &make_rfx_flex400,  "RFX400");
     dboard_manager::register_dboard(0x0025, 0x0029, &make_rfx_flex900,  "RFX900");
     dboard_manager::register_dboard(0x0034, 0x0035, &make_rfx_flex1800, "RFX1800");
@@ -29,7 +29,7 @@ static dboard_base::sptr make_sbx(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new sbx_xcvr(args));
 }
 
-UHD_STATIC_BLOCK(reg_sbx_dboards){
+UHD_DEFERRED_BLOCK("dboard", reg_sbx_dboards){
     dboard_manager::register_dboard(0x0054, 0x0055, &make_sbx, "SBX");
     dboard_manager::register_dboard(0x0065, 0x0064, &make_sbx, "SBX v4");
     dboard_manager::register_dboard(0x0067, 0x0066, &make_sbx, "CBX");
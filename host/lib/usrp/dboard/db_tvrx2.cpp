@@ -900,7 +900,7 @@ static dboard_base::sptr make_tvrx2(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new tvrx2(args));
 }
 
-UHD_STATIC_BLOCK(reg_tvrx2_dboard){
+UHD_DEFERRED_BLOCK("dboard", reg_tvrx2_dboard){
     //register the factory function for the rx dbid
     dboard_manager::register_dboard(0x0046, &make_tvrx2, "TVRX2", tvrx2_sd_name_to_conn.keys());
 }
@@ -31,6 +31,7 @@
 #include <boost/make_shared.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
 //#include <fstream>    //Needed for _expert->to_dot() below
 
 using namespace uhd;
@@ -41,6 +42,109 @@ using namespace uhd::experts;
 static const dboard_id_t TWINRX_V100_000_ID(0x91);
 static const dboard_id_t TWINRX_V100_100_ID(0x93);
 
+/*!
+ * twinrx_hop_schedule hops the front-ends of a TwinRX board through
+ * tables of frequencies. If the companion front-end has its LOs
+ * disabled, its synthesizers are tuned to the next frequency while the
+ * current one is in use, and a hop swaps the two sets (LO ping-pong).
+ *
+ */
+class twinrx_hop_schedule : boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<twinrx_hop_schedule> sptr;
+
+    twinrx_hop_schedule(dboard_iface::sptr db_iface) : _db_iface(db_iface)
+    {
+    }
+
+    void add_fe(const std::string& ch_name, property_tree::sptr subtree)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _fes[ch_name].subtree = subtree;
+        _fes[ch_name].pretuned = NOT_PRETUNED;
+    }
+
+    std::vector<double> set_table(const std::string& ch_name, const std::vector<double>& freqs)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        fe_hops_t& fe = _fes[ch_name];
+        const meta_range_t freq_range = _get_subtree(ch_name)->access<meta_range_t>("freq/range").get();
+        fe.freqs.clear();
+        BOOST_FOREACH(const double freq, freqs) {
+            fe.freqs.push_back(freq_range.clip(freq));
+        }
+        fe.pretuned = NOT_PRETUNED;
+        return fe.freqs;
+    }
+
+    void hop(const std::string& ch_name, const size_t index)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        fe_hops_t& fe = _fes[ch_name];
+        if (index >= fe.freqs.size()) {
+            throw uhd::index_error(str(boost::format("TwinRX hop %u out of range (table of %u)")
+                % index % fe.freqs.size()));
+        }
+        property_tree::sptr subtree = _get_subtree(ch_name);
+        property_tree::sptr companion = _get_subtree(ch_name == "0" ? "1" : "0");
+
+        //Untimed, every write of the hop goes out in one batch. A timed
+        //hop keeps the batches of the settings expert, so that the waits
+        //between LO writes still advance the command time.
+        const bool batch = (_db_iface->get_command_time() == time_spec_t(0.0));
+        if (batch) _db_iface->begin_batch();
+        try {
+            property<std::string>& lo_source = subtree->access<std::string>("los/all/source/value");
+            const std::string source = lo_source.get();
+            const bool ping_pong =
+                (source == "internal" or source == "companion") and
+                companion->access<std::string>("los/all/source/value").get() == "disabled";
+            if (ping_pong) {
+                //The idle synthesizers already hold this frequency: swap to them
+                if (fe.pretuned == index) {
+                    lo_source.set(source == "internal" ? "companion" : "internal");
+                }
+                //Tune the synthesizers that are now idle to the next hop
+                const size_t next = (index + 1) % fe.freqs.size();
+                companion->access<double>("freq/value").set(fe.freqs[next]);
+                fe.pretuned = next;
+            } else {
+                fe.pretuned = NOT_PRETUNED;
+            }
+            //The LOs are already there when pretuned, this only sets the front-end
+            subtree->access<double>("freq/value").set(fe.freqs[index]);
+        } catch (...) {
+            fe.pretuned = NOT_PRETUNED;
+            if (batch) _db_iface->commit_batch();
+            throw;
+        }
+        if (batch) _db_iface->commit_batch();
+    }
+
+private:
+    static const size_t NOT_PRETUNED = size_t(-1);
+
+    struct fe_hops_t {
+        boost::weak_ptr<property_tree> subtree;
+        std::vector<double>            freqs;
+        size_t                         pretuned;    //Hop the idle synthesizers are tuned to
+    };
+
+    property_tree::sptr _get_subtree(const std::string& ch_name)
+    {
+        property_tree::sptr subtree = _fes[ch_name].subtree.lock();
+        if (not subtree) {
+            throw uhd::runtime_error("TwinRX front-end " + ch_name + " does not exist");
+        }
+        return subtree;
+    }
+
+    boost::mutex                        _mutex;
+    dboard_iface::sptr                  _db_iface;
+    std::map<std::string, fe_hops_t>    _fes;
+};
+
 /*!
  * twinrx_rcvr_fe is the dbaord class (dboard_base) that
  * represents each front-end of a TwinRX board. UHD will
@@ -54,7 +158,8 @@ public:
     twinrx_rcvr_fe(
         ctor_args_t args,
         expert_container::sptr expert,
-        twinrx_ctrl::sptr ctrl
+        twinrx_ctrl::sptr ctrl,
+        twinrx_hop_schedule::sptr hops
     ) :
         rx_dboard_base(args), _expert(expert), _ctrl(ctrl),
         _ch_name(dboard_ctor_args_t::cast(args).sd_name)
@@ -89,6 +194,12 @@ public:
             1.0e9, AUTO_RESOLVE_ON_READ_WRITE);
         get_rx_subtree()->create<device_addr_t>("tune_args")
             .set(device_addr_t());
+        hops->add_fe(_ch_name, get_rx_subtree());
+        get_rx_subtree()->create<std::vector<double> >("freq/hop_table")
+            .set_coercer(boost::bind(&twinrx_hop_schedule::set_table, hops, _ch_name, _1))
+            .set(std::vector<double>());
+        get_rx_subtree()->create<size_t>("freq/hop_index")
+            .add_coerced_subscriber(boost::bind(&twinrx_hop_schedule::hop, hops, _ch_name, _1));
 
         static const double DEFAULT_IF_FREQ = 150e6;
         meta_range_t if_freq_range;
@@ -229,6 +340,7 @@ public:
         cpld_regs->initialize(*gpio_iface, false);
         _ctrl = twinrx_ctrl::make(_db_iface, gpio_iface, cpld_regs);
         _expert = expert_factory::create_container("twinrx_expert");
+        _hops = boost::make_shared<twinrx_hop_schedule>(_db_iface);
     }
 
     virtual ~twinrx_rcvr(void)
@@ -243,6 +355,10 @@ public:
         return _ctrl;
     }
 
+    inline twinrx_hop_schedule::sptr get_hops() {
+        return _hops;
+    }
+
     virtual void initialize()
     {
         //---------------------------------------------------------
@@ -297,7 +413,7 @@ public:
         sptr container = boost::dynamic_pointer_cast<twinrx_rcvr>(db_args.rx_container);
         if (container) {
             dboard_base::sptr fe = dboard_base::sptr(
-                new twinrx_rcvr_fe(args, container->get_expert(), container->get_ctrl()));
+                new twinrx_rcvr_fe(args, container->get_expert(), container->get_ctrl(), container->get_hops()));
             container->add_twinrx_fe(db_args.sd_name);
             return fe;
         } else {
@@ -317,6 +433,7 @@ private:
     twinrx_ctrl::sptr           _ctrl;
     std::vector<std::string>    _fe_names;
     expert_container::sptr      _expert;
+    twinrx_hop_schedule::sptr   _hops;
 };
 
 /*!
@@ -332,7 +449,7 @@ static dboard_base::sptr make_twinrx_container(dboard_base::ctor_args_t args)
     return dboard_base::sptr(new twinrx_rcvr(args));
 }
 
-UHD_STATIC_BLOCK(reg_twinrx_dboards)
+UHD_DEFERRED_BLOCK("dboard", reg_twinrx_dboards)
 {
     dboard_manager::register_dboard_restricted(
         TWINRX_V100_000_ID,
@@ -557,8 +557,16 @@ private:
     {
         boost::mutex::scoped_lock lock(_spi_mutex);
         ROUTE_SPI(_iface, dest);
-        BOOST_FOREACH(uint32_t value, values)
-            WRITE_SPI(_iface, value);
+        //one round trip for all the registers instead of one per write
+        _iface->begin_batch();
+        try {
+            BOOST_FOREACH(uint32_t value, values)
+                WRITE_SPI(_iface, value);
+        } catch (...) {
+            _iface->commit_batch();
+            throw;
+        }
+        _iface->commit_batch();
     }
 
     void set_cpld_field(ubx_cpld_field_id_t id, uint32_t value)
@@ -1270,7 +1278,7 @@ static dboard_base::sptr make_ubx(dboard_base::ctor_args_t args)
     return dboard_base::sptr(new ubx_xcvr(args));
 }
 
-UHD_STATIC_BLOCK(reg_ubx_dboards)
+UHD_DEFERRED_BLOCK("dboard", reg_ubx_dboards)
 {
     dboard_manager::register_dboard(UBX_PROTO_V3_RX_ID,  UBX_PROTO_V3_TX_ID,  &make_ubx, "UBX v0.3");
     dboard_manager::register_dboard(UBX_PROTO_V4_RX_ID,  UBX_PROTO_V4_TX_ID,  &make_ubx, "UBX v0.4");
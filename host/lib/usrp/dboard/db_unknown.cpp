@@ -82,7 +82,7 @@ static dboard_base::sptr make_unknown_tx(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new unknown_tx(args));
 }
 
-UHD_STATIC_BLOCK(reg_unknown_dboards){
+UHD_DEFERRED_BLOCK("dboard", reg_unknown_dboards){
     dboard_manager::register_dboard(0xfff0, &make_unknown_tx, "Unknown TX");
     dboard_manager::register_dboard(0xfff1, &make_unknown_rx, "Unknown RX");
 }
@@ -187,7 +187,7 @@ static dboard_base::sptr make_xcvr2450(dboard_base::ctor_args_t args){
     return dboard_base::sptr(new xcvr2450(args));
 }
 
-UHD_STATIC_BLOCK(reg_xcvr2450_dboard){
+UHD_DEFERRED_BLOCK("dboard", reg_xcvr2450_dboard){
     //register the factory function for the rx and tx dbids
     dboard_manager::register_dboard(0x0061, 0x0060, &make_xcvr2450, "XCVR2450");
     dboard_manager::register_dboard(0x0061, 0x0059, &make_xcvr2450, "XCVR2450 - r2.1");
@@ -51,9 +51,11 @@ public:
         }
         //Initialize synthesizer objects
         _lo1_iface[size_t(CH1)] = adf5355_iface::make(
-                boost::bind(&twinrx_ctrl_impl::_write_lo_spi, this, dboard_iface::UNIT_TX, _1));
+                boost::bind(&twinrx_ctrl_impl::_write_lo_spi, this, dboard_iface::UNIT_TX, _1),
+                boost::bind(&dboard_iface::sleep, _db_iface, _1));
         _lo1_iface[size_t(CH2)] = adf5355_iface::make(
-                boost::bind(&twinrx_ctrl_impl::_write_lo_spi, this, dboard_iface::UNIT_TX, _1));
+                boost::bind(&twinrx_ctrl_impl::_write_lo_spi, this, dboard_iface::UNIT_TX, _1),
+                boost::bind(&dboard_iface::sleep, _db_iface, _1));
 
         _lo2_iface[size_t(CH1)] = adf435x_iface::make_adf4351(
                 boost::bind(&twinrx_ctrl_impl::_write_lo_spi, this, dboard_iface::UNIT_RX, _1));
@@ -506,15 +508,45 @@ private:    //Functions
 
     void _write_lo_spi(dboard_iface::unit_t unit, const std::vector<uint32_t> &regs)
     {
-        BOOST_FOREACH(uint32_t reg, regs) {
-             spi_config_t spi_config = spi_config_t(spi_config_t::EDGE_RISE);
-             spi_config.use_custom_divider = true;
-             spi_config.divider = 67;
-            _db_iface->write_spi(unit, spi_config, reg, 32);
+        //one round trip for all the registers instead of one per write
+        _db_iface->begin_batch();
+        try {
+            BOOST_FOREACH(uint32_t reg, regs) {
+                spi_config_t spi_config = spi_config_t(spi_config_t::EDGE_RISE);
+                spi_config.use_custom_divider = true;
+                spi_config.divider = 67;
+                _db_iface->write_spi(unit, spi_config, reg, 32);
+            }
+        } catch (...) {
+            _db_iface->commit_batch();
+            throw;
         }
+        _db_iface->commit_batch();
     }
 
     void _commit()
+    {
+        //Waits inside a timed commit advance the command time. Restore it
+        //afterwards so every commit starts at the time it was given, which
+        //keeps radios that are retuned for the same time aligned.
+        //Untimed, all the writes of the commit go out in one batch. Timed,
+        //the waits between the LO writes have to advance the command time,
+        //which a batch would hold at its start.
+        const time_spec_t cmd_time = _db_iface->get_command_time();
+        const bool batch = (cmd_time == time_spec_t(0.0));
+        if (batch) _db_iface->begin_batch();
+        try {
+            _commit_regs();
+        } catch (...) {
+            if (batch) _db_iface->commit_batch();
+            _db_iface->set_command_time(cmd_time);
+            throw;
+        }
+        if (batch) _db_iface->commit_batch();
+        _db_iface->set_command_time(cmd_time);
+    }
+
+    void _commit_regs()
     {
         //Commit everything except the LO synthesizers
         _cpld_regs->flush();
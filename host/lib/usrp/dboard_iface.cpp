@@ -16,6 +16,7 @@
 //
 
 #include <uhd/usrp/dboard_iface.hpp>
+#include <uhd/utils/safe_call.hpp>
 
 using namespace uhd::usrp;
 
@@ -29,3 +30,31 @@ void dboard_iface::sleep(const boost::chrono::nanoseconds& time)
       boost::this_thread::sleep_for(time);
    }
 }
+
+void dboard_iface::begin_batch(void)
+{
+    //NOP
+}
+
+void dboard_iface::commit_batch(void)
+{
+    //NOP
+}
+
+void dboard_iface::write_spi_batch(
+    unit_t unit,
+    const spi_config_t &config,
+    const std::vector<uint32_t> &data,
+    size_t num_bits
+){
+    this->begin_batch();
+    try {
+        for (size_t i = 0; i < data.size(); i++) {
+            this->write_spi(unit, config, data[i], num_bits);
+        }
+    } catch (...) {
+        UHD_SAFE_CALL(this->commit_batch();)
+        throw;
+    }
+    this->commit_batch();
+}
@@ -20,6 +20,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/startup_profile.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/types/dict.hpp>
@@ -27,6 +28,7 @@
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/assign/list_of.hpp>
 
 using namespace uhd;
@@ -80,6 +82,19 @@ bool operator==(const dboard_key_t &lhs, const dboard_key_t &rhs){
     return false;
 }
 
+//! Hash to match operator==() (needed by uhd::dict)
+size_t hash_value(const dboard_key_t &key){
+    size_t seed = 0;
+    boost::hash_combine(seed, key.is_xcvr());
+    if (key.is_xcvr()){
+        boost::hash_combine(seed, key.rx_id().to_uint16());
+        boost::hash_combine(seed, key.tx_id().to_uint16());
+    } else {
+        boost::hash_combine(seed, key.xx_id().to_uint16());
+    }
+    return seed;
+}
+
 /***********************************************************************
  * storage and registering for dboards
  **********************************************************************/
@@ -88,7 +103,13 @@ typedef boost::tuple<dboard_manager::dboard_ctor_t, std::string, std::vector<std
 
 //map a dboard id to a dboard constructor
 typedef uhd::dict<dboard_key_t, args_t> id_to_args_map_t;
-UHD_SINGLETON_FCN(id_to_args_map_t, get_id_to_args_map)
+UHD_SINGLETON_FCN(id_to_args_map_t, get_registered_dboards)
+
+//the dboards of this library register on first use, see UHD_DEFERRED_BLOCK
+static id_to_args_map_t &get_id_to_args_map(void){
+    uhd::run_deferred_blocks("dboard");
+    return get_registered_dboards();
+}
 
 static void register_dboard_key(
     const dboard_key_t &dboard_key,
@@ -204,8 +225,10 @@ private:
     //the subdevice proxy is internal to the cpp file
     uhd::dict<std::string, dboard_base::sptr> _rx_dboards;
     uhd::dict<std::string, dboard_base::sptr> _tx_dboards;
-    std::vector<dboard_base::sptr>            _rx_containers;
-    std::vector<dboard_base::sptr>            _tx_containers;
+    //containers to initialize later, with their dboard names
+    typedef std::pair<std::string, dboard_base::sptr> named_container_t;
+    std::vector<named_container_t>            _rx_containers;
+    std::vector<named_container_t>            _tx_containers;
     std::vector<std::string>                  _rx_frontends;
     std::vector<std::string>                  _tx_frontends;
     dboard_iface::sptr _iface;
@@ -315,6 +338,7 @@ void dboard_manager_impl::init(
         db_ctor_args.rx_subtree = subtree->subtree("rx_frontends/" + db_ctor_args.sd_name);
         db_ctor_args.tx_subtree = subtree->subtree("tx_frontends/" + db_ctor_args.sd_name);
         if (container_ctor) {
+            startup_profile::scoped_phase phase("dboard " + name + " container");
             db_ctor_args.rx_container = container_ctor(&db_ctor_args);
         } else {
             db_ctor_args.rx_container = dboard_base::sptr();
@@ -326,6 +350,7 @@ void dboard_manager_impl::init(
             db_ctor_args.sd_name = subdev;
             db_ctor_args.rx_subtree = subtree->subtree("rx_frontends/" + db_ctor_args.sd_name);
             db_ctor_args.tx_subtree = subtree->subtree("tx_frontends/" + db_ctor_args.sd_name);
+            startup_profile::scoped_phase phase("dboard " + name + " " + subdev);
             dboard_base::sptr xcvr_dboard = subdev_ctor(&db_ctor_args);
             _rx_dboards[subdev] = xcvr_dboard;
             _tx_dboards[subdev] = xcvr_dboard;
@@ -335,8 +360,9 @@ void dboard_manager_impl::init(
         //initialize the container after all subdevs have been created
         if (container_ctor) {
             if (defer_db_init) {
-                _rx_containers.push_back(db_ctor_args.rx_container);
+                _rx_containers.push_back(named_container_t(name, db_ctor_args.rx_container));
             } else {
+                startup_profile::scoped_phase phase("dboard " + name + " init");
                 db_ctor_args.rx_container->initialize();
             }
         }
@@ -367,6 +393,7 @@ void dboard_manager_impl::init(
         db_ctor_args.rx_subtree = subtree->subtree("rx_frontends/" + db_ctor_args.sd_name);
         db_ctor_args.tx_subtree = property_tree::sptr();
         if (rx_cont_ctor) {
+            startup_profile::scoped_phase phase("dboard " + rx_name + " container");
             db_ctor_args.rx_container = rx_cont_ctor(&db_ctor_args);
         } else {
             db_ctor_args.rx_container = dboard_base::sptr();
@@ -376,6 +403,7 @@ void dboard_manager_impl::init(
         BOOST_FOREACH(const std::string &subdev, rx_subdevs){
             db_ctor_args.sd_name = subdev;
             db_ctor_args.rx_subtree = subtree->subtree("rx_frontends/" + db_ctor_args.sd_name);
+            startup_profile::scoped_phase phase("dboard " + rx_name + " " + subdev);
             _rx_dboards[subdev] = rx_dboard_ctor(&db_ctor_args);
             _rx_dboards[subdev]->initialize();
         }
@@ -383,8 +411,9 @@ void dboard_manager_impl::init(
         //initialize the container after all subdevs have been created
         if (rx_cont_ctor) {
             if (defer_db_init) {
-                _rx_containers.push_back(db_ctor_args.rx_container);
+                _rx_containers.push_back(named_container_t(rx_name, db_ctor_args.rx_container));
             } else {
+                startup_profile::scoped_phase phase("dboard " + rx_name + " init");
                 db_ctor_args.rx_container->initialize();
             }
         }
@@ -406,6 +435,7 @@ void dboard_manager_impl::init(
         db_ctor_args.rx_subtree = property_tree::sptr();
         db_ctor_args.tx_subtree = subtree->subtree("tx_frontends/" + db_ctor_args.sd_name);
         if (tx_cont_ctor) {
+            startup_profile::scoped_phase phase("dboard " + tx_name + " container");
             db_ctor_args.tx_container = tx_cont_ctor(&db_ctor_args);
         } else {
             db_ctor_args.tx_container = dboard_base::sptr();
@@ -415,6 +445,7 @@ void dboard_manager_impl::init(
         BOOST_FOREACH(const std::string &subdev, tx_subdevs){
             db_ctor_args.sd_name = subdev;
             db_ctor_args.tx_subtree = subtree->subtree("tx_frontends/" + db_ctor_args.sd_name);
+            startup_profile::scoped_phase phase("dboard " + tx_name + " " + subdev);
             _tx_dboards[subdev] = tx_dboard_ctor(&db_ctor_args);
             _tx_dboards[subdev]->initialize();
         }
@@ -422,8 +453,9 @@ void dboard_manager_impl::init(
         //initialize the container after all subdevs have been created
         if (tx_cont_ctor) {
             if (defer_db_init) {
-                _tx_containers.push_back(db_ctor_args.tx_container);
+                _tx_containers.push_back(named_container_t(tx_name, db_ctor_args.tx_container));
             } else {
+                startup_profile::scoped_phase phase("dboard " + tx_name + " init");
                 db_ctor_args.tx_container->initialize();
             }
         }
@@ -436,12 +468,14 @@ void dboard_manager_impl::init(
 }
 
 void dboard_manager_impl::initialize_dboards(void) {
-    BOOST_FOREACH(dboard_base::sptr& _rx_container, _rx_containers) {
-        _rx_container->initialize();
+    BOOST_FOREACH(named_container_t& _rx_container, _rx_containers) {
+        startup_profile::scoped_phase phase("dboard " + _rx_container.first + " init");
+        _rx_container.second->initialize();
     }
 
-    BOOST_FOREACH(dboard_base::sptr& _tx_container, _tx_containers) {
-        _tx_container->initialize();
+    BOOST_FOREACH(named_container_t& _tx_container, _tx_containers) {
+        startup_profile::scoped_phase phase("dboard " + _tx_container.first + " init");
+        _tx_container.second->initialize();
     }
 }
 
@@ -20,7 +20,11 @@
 #include "ctrl_iface.hpp"
 #include <uhd/utils/msg.hpp>
 #include <uhd/rfnoc/block_ctrl_base.hpp>
+#include <uhd/rfnoc/blockdef.hpp>
+#include <uhd/rfnoc/constants.hpp>
+#include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
 #include <algorithm>
 
 #define UHD_DEVICE3_LOG() UHD_LOGV(never)
@@ -100,6 +104,34 @@ void device3_impl::merge_channel_defs(
 /***********************************************************************
  * RFNoC-Specific
  **********************************************************************/
+//! What a block is, as read from the block itself
+struct block_ident_t
+{
+    block_ident_t() : noc_id(0) {}
+    uint64_t noc_id;
+    uhd::rfnoc::blockdef::sptr block_def;
+    //! An error while identifying, to throw from the enumerating thread
+    boost::shared_ptr<uhd::exception> error;
+};
+
+//! Read the NoC-ID of a block and find its block definition (runs in parallel for all blocks)
+static void identify_block(uhd::rfnoc::ctrl_iface::sptr ctrl, block_ident_t &ident)
+{
+    try {
+        ident.noc_id = ctrl->peek64(uhd::rfnoc::SR_READBACK_REG_ID);
+        ident.block_def = uhd::rfnoc::blockdef::make_from_noc_id(ident.noc_id);
+        if (not ident.block_def) {
+            UHD_DEVICE3_LOG() << "Using default block configuration." << std::endl;
+            ident.block_def = uhd::rfnoc::blockdef::make_from_noc_id(uhd::rfnoc::DEFAULT_NOC_ID);
+        }
+        UHD_ASSERT_THROW(ident.block_def);
+    } catch (const uhd::exception &ex) {
+        ident.error.reset(ex.dynamic_clone());
+    } catch (const std::exception &ex) {
+        ident.error.reset(new uhd::runtime_error(ex.what()));
+    }
+}
+
 void device3_impl::enumerate_rfnoc_blocks(
         size_t device_index,
         size_t n_blocks,
@@ -119,34 +151,49 @@ void device3_impl::enumerate_rfnoc_blocks(
     // 2) Destroy existing block controllers
     // TODO: Clear out all the old block control classes
     // 3) Create new block controllers
+    // First, make a transport for port number zero of every block, because we always need that:
+    std::vector<both_xports_t> xports;
+    std::vector<uhd::rfnoc::ctrl_iface::sptr> ctrls(n_blocks);
     for (size_t i = 0; i < n_blocks; i++) {
         UHD_DEVICE3_LOG() << "[RFNOC] ------- Block Setup -----------" << std::endl;
-        // First, make a transport for port number zero, because we always need that:
         ctrl_sid.set_dst_xbarport(base_port + i);
         ctrl_sid.set_dst_blockport(0);
-        both_xports_t xport = this->make_transport(
+        xports.push_back(this->make_transport(
             ctrl_sid,
             CTRL,
             transport_args
-        );
-        UHD_DEVICE3_LOG() << str(boost::format("Setting up NoC-Shell Control for port #0 (SID: %s)...") % xport.send_sid.to_pp_string_hex());
-        uhd::rfnoc::ctrl_iface::sptr ctrl = uhd::rfnoc::ctrl_iface::make(
+        ));
+        UHD_DEVICE3_LOG() << str(boost::format("Setting up NoC-Shell Control for port #0 (SID: %s)...") % xports[i].send_sid.to_pp_string_hex());
+        ctrls[i] = uhd::rfnoc::ctrl_iface::make(
                 endianness == ENDIANNESS_BIG,
-                xport.send,
-                xport.recv,
-                xport.send_sid,
+                xports[i].send,
+                xports[i].recv,
+                xports[i].send_sid,
                 str(boost::format("CE_%02d_Port_%02X") % i % ctrl_sid.get_dst_endpoint())
         );
+        ctrls[i]->set_posted_writes(transport_args.cast<size_t>("ctrl_posted_writes", 0));
         UHD_DEVICE3_LOG() << "OK" << std::endl;
-        uint64_t noc_id = ctrl->peek64(uhd::rfnoc::SR_READBACK_REG_ID);
+    }
+    // Identify all blocks at once: every NoC-ID readback is a round trip on
+    // the block's own transport, and the block definitions are independent.
+    std::vector<block_ident_t> idents(n_blocks);
+    boost::thread_group ident_threads;
+    for (size_t i = 0; i < n_blocks; i++) {
+        ident_threads.create_thread(boost::bind(&identify_block, ctrls[i], boost::ref(idents[i])));
+    }
+    ident_threads.join_all();
+    // The block controllers are made in crossbar order, which gives the block IDs
+    for (size_t i = 0; i < n_blocks; i++) {
+        if (idents[i].error) {
+            idents[i].error->dynamic_throw();
+        }
+        ctrl_sid.set_dst_xbarport(base_port + i);
+        const both_xports_t &xport = xports[i];
+        uhd::rfnoc::ctrl_iface::sptr ctrl = ctrls[i];
+        const uint64_t noc_id = idents[i].noc_id;
+        uhd::rfnoc::blockdef::sptr block_def = idents[i].block_def;
         UHD_DEVICE3_LOG() << str(boost::format("Port %d: Found NoC-Block with ID %016X.") % int(ctrl_sid.get_dst_endpoint()) % noc_id) << std::endl;
         uhd::rfnoc::make_args_t make_args;
-        uhd::rfnoc::blockdef::sptr block_def = uhd::rfnoc::blockdef::make_from_noc_id(noc_id);
-        if (not block_def) {
-            UHD_DEVICE3_LOG() << "Using default block configuration." << std::endl;
-            block_def = uhd::rfnoc::blockdef::make_from_noc_id(uhd::rfnoc::DEFAULT_NOC_ID);
-        }
-        UHD_ASSERT_THROW(block_def);
         make_args.ctrl_ifaces[0] = ctrl;
         BOOST_FOREACH(const size_t port_number, block_def->get_all_port_numbers()) {
             if (port_number == 0) { // We've already set this up
@@ -166,6 +213,7 @@ void device3_impl::enumerate_rfnoc_blocks(
                     xport1.send_sid,
                     str(boost::format("CE_%02d_Port_%02d") % i % ctrl_sid.get_dst_endpoint())
             );
+            ctrl1->set_posted_writes(transport_args.cast<size_t>("ctrl_posted_writes", 0));
             UHD_DEVICE3_LOG() << "OK" << std::endl;
             make_args.ctrl_ifaces[port_number] = ctrl1;
         }
@@ -174,7 +222,11 @@ void device3_impl::enumerate_rfnoc_blocks(
         make_args.device_index = device_index;
         make_args.tree = subtree;
         make_args.is_big_endian = (endianness == ENDIANNESS_BIG);
-        _rfnoc_block_ctrl.push_back(uhd::rfnoc::block_ctrl_base::make(make_args, noc_id));
+        make_args.noc_id = noc_id;
+        make_args.block_def = block_def;
+        uhd::rfnoc::block_ctrl_base::sptr block_ctrl = uhd::rfnoc::block_ctrl_base::make(make_args, noc_id);
+        boost::mutex::scoped_lock lock(_block_ctrl_mutex);
+        _rfnoc_block_ctrl.push_back(block_ctrl);
     }
 }
 
@@ -183,7 +235,17 @@ uhd::rfnoc::graph::sptr device3_impl::create_graph(const std::string &name)
 {
     return boost::make_shared<uhd::rfnoc::graph_impl>(
             name,
-            shared_from_this()
+            shared_from_this(),
+            // The graph only calls this while it holds a reference to us
+            boost::bind(&device3_impl::route_between_mboards, this, _1)
     );
 }
 
+void device3_impl::route_between_mboards(const uhd::sid_t &sid)
+{
+    throw uhd::not_implemented_error(str(
+        boost::format("This device can't route streams between motherboards (SID: %s).")
+        % sid.to_pp_string_hex()
+    ));
+}
+
@@ -22,6 +22,7 @@
 #define INCLUDED_DEVICE3_IMPL_HPP
 
 #include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/muxed_zero_copy_if.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/chdr.hpp>
 #include <uhd/transport/zero_copy.hpp>
@@ -32,6 +33,7 @@
 #include <uhd/utils/tasks.hpp>
 #include <uhd/device3.hpp>
 #include "xports.hpp"
+#include "../../transport/async_md_queue.hpp"
 
 namespace uhd { namespace usrp {
 
@@ -41,6 +43,7 @@ namespace uhd { namespace usrp {
 static const size_t DEVICE3_RX_FC_REQUEST_FREQ         = 32;    //per flow-control window
 static const size_t DEVICE3_TX_FC_RESPONSE_FREQ        = 8;
 static const size_t DEVICE3_TX_FC_RESPONSE_CYCLES      = 0;     // Cycles: Off.
+static const size_t DEVICE3_RX_CHANNEL_GROUP_SIZE      = 4;     // Channels per shared RX transport
 
 static const size_t DEVICE3_TX_MAX_HDR_LEN             = uhd::transport::vrt::chdr::max_if_hdr_words64 * sizeof(uint64_t);    // Bytes
 static const size_t DEVICE3_RX_MAX_HDR_LEN             = uhd::transport::vrt::chdr::max_if_hdr_words64 * sizeof(uint64_t);    // Bytes
@@ -51,7 +54,7 @@ public:
     /***********************************************************************
      * device3-specific Types
      **********************************************************************/
-    typedef uhd::transport::bounded_buffer<uhd::async_metadata_t> async_md_type;
+    typedef uhd::transport::async_md_queue async_md_type;
 
     //! The purpose of a transport
     enum xport_type_t {
@@ -133,6 +136,19 @@ protected:
         const uhd::device_addr_t& args
     ) = 0;
 
+    /*! \brief Route a block-to-block stream between two motherboards.
+     *
+     * Programs both motherboards such that the data packets of \p sid, and
+     * the flow control packets going the other way, travel directly from
+     * one motherboard to the other, and not through the host.
+     * The default implementation throws; devices that can do this override it.
+     *
+     * \param sid The SID of the stream. Its source and destination addresses
+     *            belong to different motherboards.
+     * \throws uhd::not_implemented_error if the device can't route between motherboards
+     */
+    virtual void route_between_mboards(const uhd::sid_t &sid);
+
     virtual uhd::device_addr_t get_tx_hints(size_t) { return uhd::device_addr_t(); };
     virtual uhd::device_addr_t get_rx_hints(size_t) { return uhd::device_addr_t(); };
     virtual uhd::endianness_t get_transport_endianness(size_t mb_index) = 0;
@@ -178,14 +194,56 @@ protected:
     //! A counter, designed to create unique SIDs
     size_t _sid_framer;
 
+    //! Protects _rfnoc_block_ctrl when several devices are enumerated at once
+    boost::mutex _block_ctrl_mutex;
+
     // TODO: Maybe move these to private
     uhd::dict<std::string, boost::weak_ptr<uhd::rx_streamer> > _rx_streamers;
     uhd::dict<std::string, boost::weak_ptr<uhd::tx_streamer> > _tx_streamers;
 
 private:
+    /*! Make the RX data transport of one channel of a channel group.
+     *
+     * The first channel of a group creates one transport to the host, and
+     * all blocks of the group send to its address. Every channel gets a
+     * virtual transport of it, which only receives the packets of its block.
+     *
+     * \param address The endpoint address of the block, as for make_transport()
+     * \param args Transport hints of the channel; they apply to the shared
+     *             transport when the group is created
+     * \param endianness Endianness of the transport
+     * \param group_key Identifies the group, unique per motherboard
+     * \param group_size The number of channels the group is made for
+     * \param[out] send_mutex Serializes the flow control packets of the group
+     */
+    uhd::both_xports_t make_rx_channel_group_xport(
+        const uhd::sid_t &address,
+        const uhd::device_addr_t &args,
+        const uhd::endianness_t endianness,
+        const std::string &group_key,
+        const size_t group_size,
+        boost::shared_ptr<boost::mutex> &send_mutex
+    );
+
+    //! The shared transport of an RX channel group
+    struct rx_channel_group_t
+    {
+        //! Lives as long as the streamers of the group
+        boost::weak_ptr<uhd::transport::muxed_zero_copy_if> mux;
+        boost::shared_ptr<boost::mutex> send_mutex;
+        //! Source address of all data sent to the group
+        uint32_t host_addr;
+        //! Software buffer of one channel, in bytes
+        size_t recv_buff_size;
+        size_t group_size;
+    };
+
     /***********************************************************************
      * Private Members
      **********************************************************************/
+    //! RX channel groups by motherboard and name
+    uhd::dict<std::string, rx_channel_group_t> _rx_channel_groups;
+
     //! Buffer for async metadata
     boost::shared_ptr<async_md_type> _async_md;
 
@@ -22,17 +22,24 @@
 #include <uhd/rfnoc/source_block_ctrl_base.hpp>
 #include <uhd/rfnoc/sink_block_ctrl_base.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/flight_recorder.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include "../common/async_packet_handler.hpp"
+#include "../common/streamer_args.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "../../rfnoc/rx_stream_terminator.hpp"
 #include "../../rfnoc/tx_stream_terminator.hpp"
 #include <uhd/rfnoc/rate_node_ctrl.hpp>
 #include <uhd/rfnoc/radio_ctrl.hpp>
+#include <uhd/rfnoc/dma_fifo_block_ctrl.hpp>
 #include <uhd/transport/zero_copy_flow_ctrl.hpp>
 #include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <algorithm>
 
 #define UHD_STREAMER_LOG() UHD_LOGV(never)
 
@@ -43,6 +50,9 @@ using namespace uhd::transport;
 //! CHDR uses 12-Bit sequence numbers
 static const uint32_t HW_SEQ_NUM_MASK = 0xfff;
 
+//! Microseconds a latency RX streamer busy-polls the NIC queue, see apply_stream_profile()
+static const int LATENCY_BUSY_POLL_USECS = 50;
+
 
 /***********************************************************************
  * Helper functions for get_?x_stream()
@@ -57,6 +67,132 @@ static uhd::stream_args_t sanitize_stream_args(const uhd::stream_args_t &args_)
     return args;
 }
 
+/*! \brief Resolves otw_format=auto for a streamer.
+ *
+ * A block that fixes its item type decides the format. Otherwise, this
+ * picks the widest of sc16, sc12 and sc8 whose sample stream fits the
+ * link, so narrower formats only cost precision when the link needs it.
+ *
+ * \param stream_sig The signature of the block port the streamer connects to
+ * \param samp_rate Sample rate of one channel, or a value <= 0 if unknown
+ * \param num_chans Number of channels of the streamer
+ * \param link_rate Max. payload rate of the link in bytes/s, or 0 if unknown
+ */
+static std::string select_auto_otw_format(
+        const rfnoc::stream_sig_t &stream_sig,
+        const double samp_rate,
+        const size_t num_chans,
+        const double link_rate
+) {
+    if (not stream_sig.item_type.empty()) {
+        return stream_sig.item_type;
+    }
+    static const char *formats[] = {"sc16", "sc12", "sc8"};
+    static const size_t num_formats = sizeof(formats) / sizeof(formats[0]);
+    if (samp_rate <= 0 or link_rate <= 0) {
+        return formats[0];
+    }
+    for (size_t i = 0; i < num_formats; i++) {
+        const double bytes_per_sec = samp_rate * num_chans * convert::get_bytes_per_item(formats[i]);
+        if (bytes_per_sec <= link_rate) {
+            return formats[i];
+        }
+    }
+    return formats[num_formats-1];
+}
+
+//! Returns the max. payload rate of a motherboard's link in bytes/s, or 0 if unknown
+static double get_link_max_rate(property_tree::sptr tree, const size_t mb_index)
+{
+    const fs_path link_rate_path = fs_path("/mboards") / mb_index / "link_max_rate";
+    if (not tree->exists(link_rate_path)) {
+        return 0.0;
+    }
+    return tree->access<double>(link_rate_path).get();
+}
+
+//! Returns the largest frame of a motherboard's link in one direction ("recv" or "send"), or 0 if unknown
+static size_t get_link_mtu(property_tree::sptr tree, const size_t mb_index, const std::string &dir)
+{
+    const fs_path mtu_path = fs_path("/mboards") / mb_index / "mtu" / dir;
+    if (not tree->exists(mtu_path)) {
+        return 0;
+    }
+    return tree->access<size_t>(mtu_path).get();
+}
+
+//! Largest spp not above \p spp whose payload fills whole 32-bit words (sc12 and sc8 pack several items per word)
+static size_t align_spp_to_item32(size_t spp, const size_t bpi)
+{
+    while (spp > 1 and (spp * bpi) % sizeof(uint32_t) != 0) {
+        spp--;
+    }
+    return spp;
+}
+
+/*! \brief Applies stream arg "profile" to the transport hints of a streamer.
+ *
+ * Sets the frame size, number of frames and (RX only) socket buffer size
+ * the profile picks for this rate and link. An RX latency streamer with a
+ * CPU (hint recv_cpu) also spins and busy-polls on its socket. The same
+ * keys given in the stream args override the profile.
+ *
+ * \param[in,out] hints The transport hints
+ * \param stream_args The stream args of this channel
+ * \param samp_rate Sample rate of the channel, or a value <= 0 if unknown
+ * \param bpi Bytes per item over the wire
+ * \param hdr_size The largest packet header, in bytes
+ * \param mtu The largest frame the link allows, or 0 if unknown
+ * \param tx_rx "RX" or "TX"
+ */
+static void apply_stream_profile(
+        device_addr_t &hints,
+        const device_addr_t &stream_args,
+        const double samp_rate,
+        const size_t bpi,
+        const size_t hdr_size,
+        const size_t mtu,
+        const std::string &tx_rx
+) {
+    const usrp::stream_profile_t profile = usrp::get_stream_profile(stream_args);
+    if (profile == usrp::STREAM_PROFILE_DEFAULT) {
+        return;
+    }
+    const usrp::stream_profile_settings_t settings =
+        usrp::compute_stream_profile(profile, samp_rate, bpi, hdr_size, mtu);
+    const std::string dir = (tx_rx == "RX") ? "recv" : "send";
+    if (settings.frame_size) {
+        hints[dir + "_frame_size"] = boost::lexical_cast<std::string>(settings.frame_size);
+    }
+    if (settings.num_frames) {
+        hints["num_" + dir + "_frames"] = boost::lexical_cast<std::string>(settings.num_frames);
+    }
+    // On TX, send_buff_size sets the flow control window instead
+    if (settings.buff_size and tx_rx == "RX") {
+        hints["recv_buff_size"] = boost::lexical_cast<std::string>(settings.buff_size);
+    }
+    // A latency streamer pinned to a CPU may keep that CPU busy: it spins
+    // on the socket and busy-polls the NIC queue instead of sleeping
+    if (profile == usrp::STREAM_PROFILE_LATENCY and tx_rx == "RX" and hints.has_key("recv_cpu")) {
+        hints["recv_spin"] = "1";
+        hints["recv_batch_size"] = "1";
+        hints["busy_poll"] = boost::lexical_cast<std::string>(LATENCY_BUSY_POLL_USECS);
+        hints["prefer_busy_poll"] = "1";
+    }
+    static const char *xport_keys[] = {
+        "recv_frame_size", "num_recv_frames", "recv_buff_size",
+        "send_frame_size", "num_send_frames",
+        "recv_spin", "busy_poll", "prefer_busy_poll"
+    };
+    BOOST_FOREACH(const char *key, xport_keys) {
+        if (stream_args.has_key(key)) {
+            hints[key] = stream_args[key];
+        }
+    }
+    UHD_MSG(status) << boost::format("[%s Streamer] profile=%s: %s")
+        % tx_rx % stream_args["profile"] % settings.to_string() << std::endl;
+}
+
 static void check_stream_sig_compatible(const rfnoc::stream_sig_t &stream_sig, stream_args_t &args, const std::string &tx_rx)
 {
     if (args.otw_format.empty()) {
@@ -137,6 +273,10 @@ void generate_channel_list(
         if (args.args.has_key(key)) {
             chan_args_[i]["radio_port"] = args.args.pop(key);
         }
+        key = str(boost::format("cpu%d") % chan_idx);
+        if (args.args.has_key(key)) {
+            chan_args_[i]["cpu"] = args.args.pop(key);
+        }
     }
 
     // Add all remaining args to all channel args
@@ -205,53 +345,64 @@ static size_t get_rx_flow_control_window(
 }
 
 
+/*! Recover the 32-Bit sequence number of an RX flow control update.
+ *
+ * The sequence numbers handled by the streamers are 12 Bits, but the
+ * flow control packets carry 32-Bit sequence numbers.
+ *
+ * \param fc_cache Saves the 32-Bit state of the sequence numbers
+ * \param last_seq The 12-Bit sequence number of the last consumed packet
+ */
+static size_t unwrap_rx_fc_seq(rx_fc_cache_t &fc_cache, const size_t last_seq)
+{
+    size_t &seq32 = fc_cache.last_seq_in;
+    const size_t seq12 = seq32 & HW_SEQ_NUM_MASK;
+    if (last_seq < seq12)
+        seq32 += (HW_SEQ_NUM_MASK + 1);
+    seq32 &= ~HW_SEQ_NUM_MASK;
+    seq32 |= last_seq;
+    return seq32;
+}
+
 /*! Send out RX flow control packets.
  *
  * For an rx stream, this function takes care of sending back
  * a flow control packet to the source telling it which
  * packets have been consumed.
  *
- * This function should only be called by the function handling
- * the rx stream, usually recv() in super_recv_packet_handler.
+ * This function should only be called by the rx_flowctrl_handler of
+ * the rx stream. It never throws when the transport has no buffer,
+ * the caller decides when to try again.
  *
  * \param sid The SID that goes into this packet. This is the reversed()
  *            version of the data stream's SID.
  * \param xport A transport object over which to send the data
  * \param big_endian Endianness of the transport
- * \param seq32_state Pointer to a variable that saves the 32-Bit state
- *                    of the sequence numbers, since we only have 12 Bit
- *                    sequence numbers in CHDR.
- * \param last_seq The value to send: The last consumed packet's sequence number.
+ * \param seq32 The value to send: The 32-Bit sequence number of the
+ *              last consumed packet (see unwrap_rx_fc_seq()).
+ * \param timeout How long to wait for a send buffer
+ * \returns false if no send buffer was available within the timeout
  */
-static void handle_rx_flowctrl(
+static bool send_rx_flowctrl(
         const sid_t &sid,
-        zero_copy_if::sptr xport,
+        const zero_copy_if::sptr &xport,
         endianness_t endianness,
-        boost::shared_ptr<rx_fc_cache_t> fc_cache,
-        const size_t last_seq
+        const size_t seq32,
+        const double timeout
 ) {
     static const size_t RXFC_PACKET_LEN_IN_WORDS    = 2;
     static const size_t RXFC_CMD_CODE_OFFSET        = 0;
     static const size_t RXFC_SEQ_NUM_OFFSET         = 1;
 
-    managed_send_buffer::sptr buff = xport->get_send_buff(0.0);
+    managed_send_buffer::sptr buff = xport->get_send_buff(timeout);
     if (not buff) {
-        throw uhd::runtime_error("handle_rx_flowctrl timed out getting a send buffer");
+        return false;
     }
     uint32_t *pkt = buff->cast<uint32_t *>();
 
-    // Recover sequence number. The sequence numbers handled by the streamers
-    // are 12 Bits, but we want to know the 32-Bit sequence number.
-    size_t &seq32 = fc_cache->last_seq_in;
-    const size_t seq12 = seq32 & HW_SEQ_NUM_MASK;
-    if (last_seq < seq12)
-        seq32 += (HW_SEQ_NUM_MASK + 1);
-    seq32 &= ~HW_SEQ_NUM_MASK;
-    seq32 |= last_seq;
-
     // Super-verbose mode:
     //static size_t fc_pkt_count = 0;
-    //UHD_MSG(status) << "sending flow ctrl packet " << fc_pkt_count++ << ", acking " << str(boost::format("%04d\tseq_sw==0x%08x") % last_seq % seq32) << std::endl;
+    //UHD_MSG(status) << "sending flow ctrl packet " << fc_pkt_count++ << ", acking " << str(boost::format("%04d\tseq_sw==0x%08x") % (seq32 & HW_SEQ_NUM_MASK) % seq32) << std::endl;
 
     //load packet info
     vrt::if_packet_info_t packet_info;
@@ -293,22 +444,119 @@ static void handle_rx_flowctrl(
 
     //send the buffer over the interface
     buff->commit(sizeof(uint32_t)*(packet_info.num_packet_words32));
+    return true;
 }
 
+/*! RX flow control handler of a streamer channel.
+ *
+ * Updates are sent from the receive thread when the return path has a
+ * buffer right away. Otherwise the update is left for a sender task
+ * (started on first use), which waits for a buffer and sends the newest
+ * pending sequence number. Updates that pile up meanwhile are coalesced
+ * into one, since each one acknowledges everything before it.
+ *
+ * Channels that send on the same transport from different threads (see
+ * make_rx_channel_group_xport()) share \p xport_mutex.
+ */
+class rx_flowctrl_handler : public sph::recv_packet_handler::flowctrl_handler
+{
+public:
+    rx_flowctrl_handler(
+            const sid_t &sid,
+            zero_copy_if::sptr xport,
+            endianness_t endianness,
+            boost::shared_ptr<boost::mutex> xport_mutex = boost::shared_ptr<boost::mutex>()
+    ):
+        _sid(sid), _xport(xport), _endianness(endianness),
+        _xport_mutex(xport_mutex ? xport_mutex : boost::make_shared<boost::mutex>()),
+        _pending(false), _pending_seq32(0) {}
+
+    void handle_flowctrl(const size_t last_seq)
+    {
+        const size_t seq32 = unwrap_rx_fc_seq(_fc_cache, last_seq);
+
+        //send right away unless the transport is in use by another sender
+        boost::mutex::scoped_try_lock lock(*_xport_mutex);
+        if (lock.owns_lock() and send_rx_flowctrl(_sid, _xport, _endianness, seq32, 0.0)) {
+            //anything pending is older than what was just sent
+            boost::mutex::scoped_lock pending_lock(_pending_mutex);
+            _pending = false;
+            return;
+        }
+
+        //leave it to the sender task, replacing any older update
+        {
+            boost::mutex::scoped_lock pending_lock(_pending_mutex);
+            _pending_seq32 = seq32;
+            _pending = true;
+        }
+        _pending_cond.notify_one();
+        if (not _sender) {
+            _sender = task::make(boost::bind(&rx_flowctrl_handler::sender_loop, this), "rx", "rx flow control");
+        }
+    }
+
+private:
+    void sender_loop(void)
+    {
+        boost::mutex::scoped_lock pending_lock(_pending_mutex);
+        while (not _pending) {
+            _pending_cond.wait(pending_lock); //interruption point
+        }
+        pending_lock.unlock();
+
+        //same lock order as handle_flowctrl(): transport, then pending
+        boost::mutex::scoped_lock lock(*_xport_mutex);
+        pending_lock.lock();
+        if (not _pending) return; //already sent from the receive thread
+        const size_t seq32 = _pending_seq32;
+        pending_lock.unlock();
+
+        if (send_rx_flowctrl(_sid, _xport, _endianness, seq32, 0.1)) {
+            pending_lock.lock();
+            if (_pending_seq32 == seq32) _pending = false;
+        }
+    }
+
+    const sid_t _sid;
+    const zero_copy_if::sptr _xport;
+    const endianness_t _endianness;
+    rx_fc_cache_t _fc_cache; //only used from the receive thread
+    const boost::shared_ptr<boost::mutex> _xport_mutex;
+    boost::mutex _pending_mutex;
+    boost::condition_variable _pending_cond;
+    bool _pending;
+    size_t _pending_seq32;
+    task::sptr _sender; //declared last, stops before the members it uses
+};
+
 /***********************************************************************
  * TX Flow Control Functions
  **********************************************************************/
 #define DEVICE3_ASYNC_EVENT_CODE_FLOW_CTRL 0
 
-//! Stores the state of TX flow control
+/*! Stores the state of TX flow control.
+ *
+ * The credit is capacity + num_acked - num_sent. The sending thread
+ * owns num_sent, the flow control reader task owns last_seq_ack and
+ * adds up num_acked.
+ */
 struct tx_fc_cache_t
 {
     tx_fc_cache_t(size_t capacity):
+        capacity(capacity),
+        num_sent(0),
+        num_acked(0),
         last_seq_ack(0),
-        space(capacity) {}
+        waiting(false) {}
 
+    const size_t capacity;
+    size_t num_sent;
+    boost::atomic<size_t> num_acked;
     size_t last_seq_ack;
-    size_t space;
+    boost::atomic<bool> waiting; //the sending thread sleeps on cond
+    boost::mutex mutex;
+    boost::condition_variable cond;
 };
 
 /*! Return the size of the flow control window in packets.
@@ -334,56 +582,112 @@ static size_t get_tx_flow_control_window(
     return window_in_pkts;
 }
 
+/*! Return the number of bytes a TX stream into \p blk_ctrl may have in flight.
+ *
+ * Usually, this is the size of the block's input buffer. A DMA FIFO moves
+ * its input into DRAM as it arrives, so a stream that ends in one may also
+ * fill up the DRAM FIFO.
+ */
+static size_t get_tx_hw_buff_size(
+        const uhd::rfnoc::sink_block_ctrl_base::sptr &blk_ctrl,
+        const size_t block_port
+) {
+    size_t hw_buff_size = blk_ctrl->get_fifo_size(block_port);
+    uhd::rfnoc::dma_fifo_block_ctrl::sptr dma_fifo =
+        boost::dynamic_pointer_cast<uhd::rfnoc::dma_fifo_block_ctrl>(blk_ctrl);
+    if (dma_fifo) {
+        hw_buff_size += dma_fifo->get_depth(block_port);
+    }
+    return hw_buff_size;
+}
+
+/*! Wait for TX flow control credit and take one packet's worth.
+ *
+ * Called by zero_copy_flow_ctrl for every send buffer. The credit is
+ * updated by tx_flow_ctrl_reader() on another thread, so this only
+ * watches a counter: it spins for a short while, then sleeps until the
+ * reader signals an update.
+ */
 static bool tx_flow_ctrl(
-    boost::shared_ptr<tx_fc_cache_t> fc_cache,
-	zero_copy_if::sptr async_xport,
-    uint32_t (*endian_conv)(uint32_t),
-    void (*unpack)(const uint32_t *packet_buff, vrt::if_packet_info_t &),
+    const boost::shared_ptr<tx_fc_cache_t> &fc_cache,
     managed_buffer::sptr
 ) {
-    while (true)
+    static const size_t spins_before_wait = 1000;
+    tx_fc_cache_t &fc = *fc_cache;
+    for (size_t spins = 0; ; spins++)
     {
         // If there is space
-        if (fc_cache->space)
+        if (fc.capacity + fc.num_acked.load(boost::memory_order_acquire) != fc.num_sent)
         {
             // All is good - packet will be sent
-            fc_cache->space--;
+            fc.num_sent++;
             return true;
         }
-
-		// Look for a flow control message to update the space available in the buffer.
-        // A minimal timeout is used because larger timeouts can cause the thread to be
-        // scheduled out for too long at high data rates and result in underruns.
-		managed_recv_buffer::sptr buff = async_xport->get_recv_buff(0.000001);
-		if (buff)
-		{
-			vrt::if_packet_info_t if_packet_info;
-			if_packet_info.num_packet_words32 = buff->size()/sizeof(uint32_t);
-			const uint32_t *packet_buff = buff->cast<const uint32_t *>();
-			try {
-				unpack(packet_buff, if_packet_info);
-			}
-			catch(const std::exception &ex)
-			{
-				UHD_MSG(error) << "Error unpacking async flow control packet: " << ex.what() << std::endl;
-				continue;
-			}
-
-			if (if_packet_info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_FC)
-			{
-				UHD_MSG(error) << "Unexpected packet type received by flow control handler: " << if_packet_info.packet_type << std::endl;
-				continue;
-			}
-
-			// update the amount of space
-			size_t seq_ack = endian_conv(packet_buff[if_packet_info.num_header_words32+1]);
-			fc_cache->space += (seq_ack - fc_cache->last_seq_ack) & HW_SEQ_NUM_MASK;
-			fc_cache->last_seq_ack = seq_ack;
-		}
+        if (spins < spins_before_wait) continue;
+
+        // Sleep until the reader sees an ack. The flag is set before the
+        // credit is checked again and the reader adds credit before it
+        // checks the flag, so a wake-up can't be missed. The timeout is
+        // only a safety net.
+        boost::mutex::scoped_lock lock(fc.mutex);
+        fc.waiting = true;
+        if (fc.capacity + fc.num_acked.load() == fc.num_sent) {
+            fc.cond.timed_wait(lock, boost::posix_time::milliseconds(1));
+        }
+        fc.waiting = false;
     }
     return false;
 }
 
+/*! Read TX flow control responses and update the credit.
+ *
+ * This is run inside a uhd::task as long as this streamer lives, so the
+ * thread calling send() never polls the response transport itself.
+ */
+static void tx_flow_ctrl_reader(
+    const boost::shared_ptr<tx_fc_cache_t> &fc_cache,
+    const zero_copy_if::sptr &xport,
+    uint32_t (*endian_conv)(uint32_t),
+    void (*unpack)(const uint32_t *packet_buff, vrt::if_packet_info_t &)
+) {
+    managed_recv_buffer::sptr buff = xport->get_recv_buff(0.1);
+    if (not buff)
+    {
+        return;
+    }
+
+    vrt::if_packet_info_t if_packet_info;
+    if_packet_info.num_packet_words32 = buff->size()/sizeof(uint32_t);
+    const uint32_t *packet_buff = buff->cast<const uint32_t *>();
+    try {
+        unpack(packet_buff, if_packet_info);
+    }
+    catch(const std::exception &ex)
+    {
+        UHD_MSG(error) << "Error unpacking async flow control packet: " << ex.what() << std::endl;
+        return;
+    }
+
+    if (if_packet_info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_FC)
+    {
+        UHD_MSG(error) << "Unexpected packet type received by flow control handler: " << if_packet_info.packet_type << std::endl;
+        return;
+    }
+
+    // update the amount of space
+    tx_fc_cache_t &fc = *fc_cache;
+    const size_t seq_ack = endian_conv(packet_buff[if_packet_info.num_header_words32+1]);
+    fc.num_acked.fetch_add((seq_ack - fc.last_seq_ack) & HW_SEQ_NUM_MASK);
+    fc.last_seq_ack = seq_ack;
+    flight_recorder::record(flight_recorder::RECORD_FLOW_CTRL, 0,
+        if_packet_info.sid, uint32_t(seq_ack), 0, 0);
+    if (fc.waiting.load())
+    {
+        boost::mutex::scoped_lock lock(fc.mutex);
+        fc.cond.notify_one();
+    }
+}
+
 /***********************************************************************
  * TX Async Message Functions
  **********************************************************************/
@@ -398,18 +702,19 @@ struct async_tx_info_t
 /*! Handle incoming messages.
  *  Send them to the async message queue for the user to poll.
  *
- * This is run inside a uhd::task as long as this streamer lives.
+ * This is run as a pooled uhd::task as long as this streamer lives.
  */
-static void handle_tx_async_msgs(
+static bool handle_tx_async_msgs(
         boost::shared_ptr<async_tx_info_t> async_info,
         zero_copy_if::sptr xport,
         endianness_t endianness,
         boost::function<double(void)> get_tick_rate
 ) {
-    managed_recv_buffer::sptr buff = xport->get_recv_buff();
+    //runs as a pooled task, so it must not block
+    managed_recv_buffer::sptr buff = xport->get_recv_buff(0.0);
     if (not buff)
     {
-        return;
+        return false;
     }
 
     //extract packet info
@@ -435,7 +740,7 @@ static void handle_tx_async_msgs(
     catch(const std::exception &ex)
     {
         UHD_MSG(error) << "Error parsing async message packet: " << ex.what() << std::endl;
-        return;
+        return true;
     }
 
     double tick_rate = get_tick_rate();
@@ -464,6 +769,7 @@ static void handle_tx_async_msgs(
         async_info->old_async_queue->push_with_pop_on_full(metadata);
         standard_async_msg_prints(metadata);
     }
+    return true;
 }
 
 bool device3_impl::recv_async_msg(
@@ -473,9 +779,91 @@ bool device3_impl::recv_async_msg(
     return _async_md->pop_with_timed_wait(async_metadata, timeout);
 }
 
+/***********************************************************************
+ * RX channel groups
+ **********************************************************************/
+//! Return the source address of a CHDR packet, which tells its block
+static uint32_t classify_chdr_by_src(const endianness_t endianness, void *buff, size_t)
+{
+    const uint32_t sid = reinterpret_cast<const uint32_t *>(buff)[1];
+    return ((endianness == ENDIANNESS_BIG) ? uhd::ntohx(sid) : uhd::wtohx(sid)) >> 16;
+}
+
+both_xports_t device3_impl::make_rx_channel_group_xport(
+        const uhd::sid_t &address,
+        const uhd::device_addr_t &args,
+        const uhd::endianness_t endianness,
+        const std::string &group_key,
+        const size_t group_size,
+        boost::shared_ptr<boost::mutex> &send_mutex
+) {
+    muxed_zero_copy_if::sptr mux;
+    if (_rx_channel_groups.has_key(group_key)) {
+        mux = _rx_channel_groups[group_key].mux.lock();
+    }
+
+    if (not mux) {
+        if (group_size == 0) {
+            throw uhd::value_error("channel_group_size must be at least 1");
+        }
+        both_xports_t base = make_transport(address, RX_DATA, args);
+        if (base.recv->get_num_recv_frames() < group_size) {
+            throw uhd::value_error(str(boost::format(
+                "The transport of channel group %s has %d frames, it needs at least one per channel (%d)")
+                % group_key % base.recv->get_num_recv_frames() % group_size));
+        }
+        rx_channel_group_t group;
+        group.mux = mux = muxed_zero_copy_if::make(
+            base.recv,
+            boost::bind(&classify_chdr_by_src, endianness, _1, _2),
+            group_size
+        );
+        group.send_mutex = boost::make_shared<boost::mutex>();
+        group.host_addr = base.send_sid.get_src();
+        group.recv_buff_size = base.recv_buff_size / group_size;
+        group.group_size = group_size;
+        _rx_channel_groups[group_key] = group;
+        UHD_STREAMER_LOG() << "[RX Streamer] new channel group " << group_key << " for " << group_size << " channels" << std::endl;
+    }
+
+    const rx_channel_group_t &group = _rx_channel_groups[group_key];
+    both_xports_t xport;
+    xport.send_sid = address;
+    xport.send_sid.set_src(group.host_addr);
+    xport.recv_sid = xport.send_sid.reversed();
+    xport.recv = mux->make_stream(xport.send_sid.get_dst());
+    xport.send = xport.recv;
+    xport.recv_buff_size = group.recv_buff_size;
+    send_mutex = group.send_mutex;
+    return xport;
+}
+
 /***********************************************************************
  * Receive streamer
  **********************************************************************/
+/*!
+ * The command time of the block a streamer terminator is connected to, which
+ * is the time of the rate change when the block's rate was set with one.
+ * Returns 0.0 for untimed changes.
+ */
+static time_spec_t get_cmd_time(rfnoc::node_ctrl_base::sptr terminator, const bool upstream)
+{
+    const rfnoc::node_ctrl_base::node_map_t nodes = upstream ?
+        terminator->list_upstream_nodes() : terminator->list_downstream_nodes();
+    BOOST_FOREACH(const rfnoc::node_ctrl_base::node_map_t::value_type &node, nodes) {
+        rfnoc::block_ctrl_base::sptr block =
+            boost::dynamic_pointer_cast<rfnoc::block_ctrl_base>(node.second.lock());
+        if (not block) continue;
+        const std::vector<size_t> ctrl_ports = block->get_ctrl_ports();
+        if (ctrl_ports.empty()) continue;
+        const size_t port = upstream ?
+            terminator->get_upstream_port(node.first) : terminator->get_downstream_port(node.first);
+        const bool has_port = std::find(ctrl_ports.begin(), ctrl_ports.end(), port) != ctrl_ports.end();
+        return block->get_command_time(has_port ? port : ctrl_ports.front());
+    }
+    return time_spec_t(0.0);
+}
+
 void device3_impl::update_rx_streamers(double /* rate */)
 {
     BOOST_FOREACH(const std::string &block_id, _rx_streamers.keys()) {
@@ -499,8 +887,14 @@ void device3_impl::update_rx_streamers(double /* rate */)
             UHD_STREAMER_LOG() << "  New tick_rate == " << tick_rate << "  New samp_rate == " << samp_rate << " New scaling == " << scaling << std::endl;
 
             my_streamer->set_tick_rate(tick_rate);
-            my_streamer->set_samp_rate(samp_rate);
-            my_streamer->set_scale_factor(scaling);
+            // A timed rate change takes effect in the stream at its command time
+            const time_spec_t cmd_time = get_cmd_time(my_streamer->get_terminator(), true);
+            if (cmd_time != time_spec_t(0.0)) {
+                my_streamer->set_samp_rate(cmd_time, samp_rate, scaling);
+            } else {
+                my_streamer->set_samp_rate(samp_rate);
+                my_streamer->set_scale_factor(scaling);
+            }
         }
     }
 }
@@ -516,6 +910,12 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
     generate_channel_list(args, chan_list, chan_args);
     // Note: All 'args.args' are merged into chan_args now.
 
+    const std::string overflow_policy = args.args.get("overflow_policy", "restart");
+    if (overflow_policy != "restart" and overflow_policy != "continue") {
+        throw uhd::value_error(str(boost::format(
+            "Invalid overflow_policy `%s', must be `restart' or `continue'") % overflow_policy));
+    }
+
     // II. Iterate over all channels
     boost::shared_ptr<sph::recv_packet_streamer> my_streamer;
     // The terminator's lifetime is coupled to the streamer.
@@ -546,15 +946,46 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
         recv_terminator->set_upstream_port(terminator_port, block_port);
 
         // Check if the block connection is compatible (spp and item type)
+        rfnoc::rate_node_ctrl::sptr rate_ctrl = boost::dynamic_pointer_cast<rfnoc::rate_node_ctrl>(blk_ctrl);
+        const double samp_rate = rate_ctrl ? rate_ctrl->get_output_samp_rate(block_port) : rfnoc::rate_node_ctrl::RATE_UNDEFINED;
+        if (args.otw_format == "auto") {
+            args.otw_format = select_auto_otw_format(
+                    blk_ctrl->get_output_signature(block_port),
+                    samp_rate,
+                    chan_list.size(),
+                    get_link_max_rate(_tree, mb_index)
+            );
+            UHD_STREAMER_LOG() << "[RX Streamer] otw_format=auto selected " << args.otw_format << std::endl;
+        }
         check_stream_sig_compatible(blk_ctrl->get_output_signature(block_port), args, "RX");
 
         // Setup the DSP transport hints
         device_addr_t rx_hints = get_rx_hints(mb_index);
+        // Steer this channel's socket processing to the CPU of its streamer thread
+        if (args.args.has_key("cpu")) {
+            rx_hints["recv_cpu"] = args.args["cpu"];
+        }
+        apply_stream_profile(
+                rx_hints, args.args, samp_rate,
+                convert::get_bytes_per_item(args.otw_format),
+                stream_options.rx_max_len_hdr,
+                get_link_mtu(_tree, mb_index, "recv"),
+                "RX"
+        );
 
         //allocate sid and create transport
         uhd::sid_t stream_address = blk_ctrl->get_address(block_port);
         UHD_STREAMER_LOG() << "[RX Streamer] creating rx stream " << rx_hints.to_string() << std::endl;
-        both_xports_t xport = make_transport(stream_address, RX_DATA, rx_hints);
+        boost::shared_ptr<boost::mutex> fc_send_mutex;
+        both_xports_t xport = args.args.has_key("channel_group") ?
+            make_rx_channel_group_xport(
+                    stream_address, rx_hints,
+                    get_transport_endianness(mb_index),
+                    str(boost::format("%d/%s") % mb_index % args.args["channel_group"]),
+                    args.args.cast<size_t>("channel_group_size", DEVICE3_RX_CHANNEL_GROUP_SIZE),
+                    fc_send_mutex
+            ) :
+            make_transport(stream_address, RX_DATA, rx_hints);
         UHD_STREAMER_LOG() << std::hex << "[RX Streamer] data_sid = " << xport.send_sid << std::dec << " actual recv_buff_size = " << xport.recv_buff_size << std::endl;
 
         // Configure the block
@@ -574,7 +1005,7 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
         // to avoid fragmentation should the entire header be used.
         const size_t bpp = xport.recv->get_recv_frame_size() - stream_options.rx_max_len_hdr; // bytes per packet
         const size_t bpi = convert::get_bytes_per_item(args.otw_format); // bytes per item
-        const size_t spp = std::min(args.args.cast<size_t>("spp", bpp/bpi), bpp/bpi); // samples per packet
+        const size_t spp = align_spp_to_item32(std::min(args.args.cast<size_t>("spp", bpp/bpi), bpp/bpi), bpi); // samples per packet
         UHD_STREAMER_LOG() << "[RX Streamer] spp == " << spp << std::endl;
 
         //make the new streamer given the samples per packet
@@ -585,12 +1016,14 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
         //init some streamer stuff
         std::string conv_endianness;
         if (get_transport_endianness(mb_index) == ENDIANNESS_BIG) {
-            my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_be);
+            my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_cached_be);
             conv_endianness = "be";
         } else {
-            my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_le);
+            my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_cached_le);
             conv_endianness = "le";
         }
+        // Blocks may leave out the time stamps of a continuous stream
+        my_streamer->set_tsf_elision(true);
 
         //set the converter
         uhd::convert::id_type id;
@@ -610,11 +1043,11 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
                 block_port
         );
 
-        //Give the streamer a functor to get the recv_buffer
-        //bind requires a zero_copy_if::sptr to add a streamer->xport lifetime dependency
-        my_streamer->set_xport_chan_get_buff(
+        //Give the streamer the transport to receive from
+        //the zero_copy_if::sptr adds a streamer->xport lifetime dependency
+        my_streamer->set_xport_chan(
             stream_i,
-            boost::bind(&zero_copy_if::get_recv_buff, xport.recv, _1),
+            xport.recv,
             true /*flush*/
         );
 
@@ -625,21 +1058,20 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
               stream_i,
               boost::bind(
                   &uhd::rfnoc::rx_stream_terminator::handle_overrun, recv_terminator,
-                  boost::weak_ptr<uhd::rx_streamer>(my_streamer), stream_i
+                  boost::weak_ptr<uhd::rx_streamer>(my_streamer), stream_i,
+                  overflow_policy == "continue"
               )
         );
 
-        //Give the streamer a functor to send flow control messages
+        //Give the streamer a handler to send flow control messages
         //handle_rx_flowctrl is static and has no lifetime issues
-        boost::shared_ptr<rx_fc_cache_t> fc_cache(new rx_fc_cache_t());
-        my_streamer->set_xport_handle_flowctrl(
-            stream_i, boost::bind(
-                &handle_rx_flowctrl,
+        my_streamer->set_xport_flowctrl_handler(
+            stream_i,
+            boost::make_shared<rx_flowctrl_handler>(
                 xport.send_sid,
                 xport.send,
                 get_transport_endianness(mb_index),
-                fc_cache,
-                _1
+                fc_send_mutex
             ),
             fc_handle_window,
             true/*init*/
@@ -647,9 +1079,11 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
 
         //Give the streamer a functor issue stream cmd
         //bind requires a shared pointer to add a streamer->framer lifetime dependency
+        //the commands to each motherboard go out in parallel
         my_streamer->set_issue_stream_cmd(
             stream_i,
-            boost::bind(&uhd::rfnoc::source_block_ctrl_base::issue_stream_cmd, blk_ctrl, _1, block_port)
+            boost::bind(&uhd::rfnoc::source_block_ctrl_base::issue_stream_cmd, blk_ctrl, _1, block_port),
+            mb_index
         );
 
         // Tell the streamer which SID is valid for this channel
@@ -667,6 +1101,17 @@ rx_streamer::sptr device3_impl::get_rx_stream(const stream_args_t &args_)
     // ID to do so.
     _rx_streamers[recv_terminator->unique_id()] = boost::weak_ptr<sph::recv_packet_streamer>(my_streamer);
 
+    // Optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(args.args.cast<size_t>("convert_threads", 1));
+    // Optionally receive the transports of each motherboard on a thread of its own
+    my_streamer->set_recv_threads(args.args.cast<size_t>("recv_threads", 0) != 0);
+    // Keep large receive buffers out of the caches, see set_nontemporal_stores()
+    my_streamer->set_nontemporal_stores(args.args.get("nontemporal_stores", "auto"));
+    // Report the sample power in the metadata, see set_power_metadata()
+    my_streamer->set_power_metadata(args.args.cast<size_t>("power_meta", 0) != 0);
+    // A latency streamer delivers each packet as soon as it arrives
+    my_streamer->set_one_packet(usrp::get_stream_profile(args.args) == usrp::STREAM_PROFILE_LATENCY);
+
     // Sets tick rate, samp rate and scaling on this streamer.
     // A registered terminator is required to do this.
     update_rx_streamers();
@@ -699,8 +1144,13 @@ void device3_impl::update_tx_streamers(double /* rate */)
             }
             UHD_STREAMER_LOG() << "  New tick_rate == " << tick_rate << "  New samp_rate == " << samp_rate << " New scaling == " << scaling << std::endl;
             my_streamer->set_tick_rate(tick_rate);
-            my_streamer->set_samp_rate(samp_rate);
-            my_streamer->set_scale_factor(scaling);
+            const time_spec_t cmd_time = get_cmd_time(my_streamer->get_terminator(), false);
+            if (cmd_time != time_spec_t(0.0)) {
+                my_streamer->set_samp_rate(cmd_time, samp_rate, scaling);
+            } else {
+                my_streamer->set_samp_rate(samp_rate);
+                my_streamer->set_scale_factor(scaling);
+            }
         }
     }
 }
@@ -711,12 +1161,15 @@ class device3_send_packet_streamer : public sph::send_packet_streamer
 public:
 	device3_send_packet_streamer(const size_t max_num_samps) : sph::send_packet_streamer(max_num_samps) {};
 	~device3_send_packet_streamer() {
+		this->set_pipeline_depth(0);	// Send queued packets while flow control still gets credits
 		_tx_async_msg_task.reset();	// Make sure the async task is destroyed before the transports
+		_tx_fc_tasks.clear();
 	};
 
 	both_xports_t _xport;
 	both_xports_t _async_xport;
 	task::sptr _tx_async_msg_task;
+	std::vector<task::sptr> _tx_fc_tasks;
 };
 
 tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
@@ -764,10 +1217,28 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
         send_terminator->set_downstream_port(terminator_port, block_port);
 
         // Check if the block connection is compatible (spp and item type)
+        rfnoc::rate_node_ctrl::sptr rate_ctrl = boost::dynamic_pointer_cast<rfnoc::rate_node_ctrl>(blk_ctrl);
+        const double samp_rate = rate_ctrl ? rate_ctrl->get_input_samp_rate(block_port) : rfnoc::rate_node_ctrl::RATE_UNDEFINED;
+        if (args.otw_format == "auto") {
+            args.otw_format = select_auto_otw_format(
+                    blk_ctrl->get_input_signature(block_port),
+                    samp_rate,
+                    chan_list.size(),
+                    get_link_max_rate(_tree, mb_index)
+            );
+            UHD_STREAMER_LOG() << "[TX Streamer] otw_format=auto selected " << args.otw_format << std::endl;
+        }
         check_stream_sig_compatible(blk_ctrl->get_input_signature(block_port), args, "TX");
 
         // Setup the dsp transport hints
         device_addr_t tx_hints = get_tx_hints(mb_index);
+        apply_stream_profile(
+                tx_hints, args.args, samp_rate,
+                convert::get_bytes_per_item(args.otw_format),
+                stream_options.tx_max_len_hdr,
+                get_link_mtu(_tree, mb_index, "send"),
+                "TX"
+        );
 
         //allocate sid and create transport
         uhd::sid_t stream_address = blk_ctrl->get_address(block_port);
@@ -780,7 +1251,7 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
         // to avoid fragmentation should the entire header be used.
         const size_t bpp = tx_hints.cast<size_t>("bpp", xport.send->get_send_frame_size()) - stream_options.tx_max_len_hdr;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format); // bytes per item
-        const size_t spp = std::min(args.args.cast<size_t>("spp", bpp/bpi), bpp/bpi); // samples per packet
+        const size_t spp = align_spp_to_item32(std::min(args.args.cast<size_t>("spp", bpp/bpi), bpp/bpi), bpi); // samples per packet
         UHD_STREAMER_LOG() << "[TX Streamer] spp == " << spp << std::endl;
 
         //make the new streamer given the samples per packet
@@ -813,9 +1284,17 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
         // For flow control, this value is used to determine the window size in *packets*
         size_t fc_window = get_tx_flow_control_window(
                 pkt_size, // This is the maximum packet size
-                blk_ctrl->get_fifo_size(block_port),
+                get_tx_hw_buff_size(blk_ctrl, block_port),
                 tx_hints // This can override the value reported by the block!
         );
+        // ACKs only carry the lower bits of the sequence number, so no more
+        // packets than that may be unacknowledged (this only matters for
+        // deep buffers such as the DMA FIFO).
+        fc_window = std::min<size_t>(fc_window, HW_SEQ_NUM_MASK);
+        // Bound the samples queued in the device at the latency the user
+        // asked for. The acks are requested relative to this window, so the
+        // credit keeps up with what the device actually consumed.
+        fc_window = usrp::compute_tx_latency_window(fc_window, args.args, spp, samp_rate);
         const size_t fc_handle_window = std::max<size_t>(1, fc_window / stream_options.tx_fc_response_freq);
         UHD_STREAMER_LOG() << "[TX Streamer] Flow Control Window = " << fc_window << ", Flow Control Handler Window = " << fc_handle_window << std::endl;
         blk_ctrl->configure_flow_control_in(
@@ -836,14 +1315,15 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
                 std::set< rfnoc::node_ctrl_base::sptr >() // Need to specify default args with bind
         );
 
-        my_streamer->_tx_async_msg_task = task::make(
+        my_streamer->_tx_async_msg_task = task::make_pooled(
                 boost::bind(
                     &handle_tx_async_msgs,
                     async_tx_info,
                     my_streamer->_async_xport.recv,
                     endianness,
                     tick_rate_retriever
-                )
+                ),
+                "async", "tx async messages"
         );
 
         blk_ctrl->sr_write(uhd::rfnoc::SR_CLEAR_RX_FC, 0xc1ea12, block_port);
@@ -883,24 +1363,30 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
         boost::shared_ptr<tx_fc_cache_t> fc_cache(new tx_fc_cache_t(fc_window));
         my_streamer->_xport.send = zero_copy_flow_ctrl::make(
             my_streamer->_xport.send,
+            boost::bind(&tx_flow_ctrl, fc_cache, _1),
+            NULL);
+        my_streamer->_tx_fc_tasks.push_back(task::make(
             boost::bind(
-				&tx_flow_ctrl,
+				&tx_flow_ctrl_reader,
 				fc_cache,
 				my_streamer->_xport.recv,
 				(endianness == ENDIANNESS_BIG ? uhd::ntohx<uint32_t> : uhd::wtohx<uint32_t>),
-				(endianness == ENDIANNESS_BIG ? vrt::chdr::if_hdr_unpack_be : vrt::chdr::if_hdr_unpack_le),
-				 _1),
-            NULL);
+				(endianness == ENDIANNESS_BIG ? vrt::chdr::if_hdr_unpack_be : vrt::chdr::if_hdr_unpack_le)),
+            "tx", "tx flow control"
+        ));
 
-        //Give the streamer a functor to get the send buffer
-        my_streamer->set_xport_chan_get_buff(
+        //Give the streamer the transport to send to
+        my_streamer->set_xport_chan(
             stream_i,
-            boost::bind(&zero_copy_if::get_send_buff, my_streamer->_xport.send, _1)
+            my_streamer->_xport.send
         );
         //Give the streamer a functor handled received async messages
         my_streamer->set_async_receiver(
             boost::bind(&async_md_type::pop_with_timed_wait, async_md, _1, _2)
         );
+        my_streamer->set_async_batch_receiver(
+            boost::bind(&async_md_type::pop_all_with_timed_wait, async_md, _1, _2, _3)
+        );
         my_streamer->set_xport_chan_sid(stream_i, true, xport.send_sid);
         // CHDR does not support trailers
         my_streamer->set_enable_trailer(false);
@@ -917,6 +1403,11 @@ tx_streamer::sptr device3_impl::get_tx_stream(const uhd::stream_args_t &args_)
     // ID to do so.
     _tx_streamers[send_terminator->unique_id()] = boost::weak_ptr<sph::send_packet_streamer>(my_streamer);
 
+    // Optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(args.args.cast<size_t>("convert_threads", 1));
+    // Optionally send on a separate thread while the next packets are converted
+    my_streamer->set_pipeline_depth(args.args.cast<size_t>("pipeline_depth", 0));
+
     // Sets tick rate, samp rate and scaling on this streamer
     // A registered terminator is required to do this.
     update_tx_streamers();
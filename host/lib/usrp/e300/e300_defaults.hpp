@@ -39,8 +39,12 @@ static const size_t DEFAULT_RX_DATA_NUM_FRAMES = 32;
 static const size_t DEFAULT_TX_DATA_FRAME_SIZE = 4096;
 static const size_t DEFAULT_TX_DATA_NUM_FRAMES = 32;
 
+static const double DEFAULT_RECV_COALESCE_TIMEOUT = 200e-6; // seconds
+static const size_t DEFAULT_TUNNEL_BATCH_SIZE  = 16; // packets per system call in network mode
+
 static const size_t DEFAULT_CTRL_FRAME_SIZE    = 64;
 static const size_t DEFAULT_CTRL_NUM_FRAMES    = 32;
+static const size_t DEFAULT_CODEC_FRAME_SIZE   = 1024; // room for a batch of codec actions
 
 static const size_t MAX_NET_RX_DATA_FRAME_SIZE = 1200;
 static const size_t MAX_NET_TX_DATA_FRAME_SIZE = 1200;
@@ -87,6 +87,7 @@ static UHD_INLINE size_t ZF_STREAM_OFF(const size_t which)
 #include <uhd/types/time_spec.hpp> //timeout
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/atomic.hpp>
+#include <algorithm>
 
 //locking stuff for shared irq
 #include <boost/thread/mutex.hpp>
@@ -201,13 +202,18 @@ public:
         const size_t num_frames,
         const size_t frame_size,
         e300_fifo_poll_waiter *waiter,
-        const bool auto_release
+        const bool auto_release,
+        const size_t coalesce_frames,
+        const double coalesce_timeout
     ):
         _allocator(allocator),
         _addrs(addrs),
         _num_frames(num_frames),
         _frame_size(frame_size),
         _index(0),
+        _num_claimed(0),
+        _coalesce_frames(std::min(coalesce_frames, num_frames)),
+        _coalesce_timeout(coalesce_timeout),
         _waiter(waiter)
     {
         //UHD_MSG(status) << boost::format("phys 0x%x") % addrs.phys << std::endl;
@@ -243,29 +249,69 @@ public:
     template <typename T>
     UHD_INLINE typename T::sptr get_buff(const double timeout)
     {
+        //frames that were claimed earlier need no register access at all
+        if (_num_claimed > 0 or _claim_completed() > 0) {
+            return _next_buff<T>();
+        }
+
         const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
         while (1)
         {
-            if (zf_peek32(_addrs.ctrl + ARBITER_RB_STATUS_OCC))
-            {
-                const uint32_t sts = zf_peek32(_addrs.ctrl + ARBITER_RB_STATUS);
-                UHD_ASSERT_THROW((sts >> 7) & 0x1); //assert OK
-                UHD_ASSERT_THROW((sts & 0xf) == _addrs.which); //expected tag
-                zf_poke32(_addrs.ctrl + ARBITER_WR_STS_RDY, 1); //pop from sts fifo
-                if (_index == _num_frames)
-                    _index = 0;
-                return _buffs[_index++]->get_new<T>();
-            }
             if (time_spec_t::get_system_time() > exit_time) {
                 break;
             }
             _waiter->wait(timeout);
             //boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+
+            //once the first frame is in, give the FIFO a moment to fill up
+            //so the next frames don't need a wakeup each
+            if (_coalesce_frames > 1) {
+                const uint32_t occ = zf_peek32(_addrs.ctrl + ARBITER_RB_STATUS_OCC);
+                if (occ > 0 and occ < _coalesce_frames) {
+                    const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+                    const double wait_time = std::min(_coalesce_timeout, remaining);
+                    if (wait_time > 0) {
+                        boost::this_thread::sleep(boost::posix_time::microseconds(long(wait_time*1e6)));
+                    }
+                }
+            }
+
+            if (_claim_completed() > 0) {
+                return _next_buff<T>();
+            }
         }
 
         return typename T::sptr();
     }
 
+    /*!
+     * Pop the status of all frames the FIFO has completed so far.
+     * The frames are handed out in order, so only their count is kept.
+     * \return the number of frames that are ready to be handed out
+     */
+    UHD_INLINE size_t _claim_completed(void)
+    {
+        const uint32_t occ = zf_peek32(_addrs.ctrl + ARBITER_RB_STATUS_OCC);
+        for (uint32_t i = 0; i < occ; i++)
+        {
+            const uint32_t sts = zf_peek32(_addrs.ctrl + ARBITER_RB_STATUS);
+            UHD_ASSERT_THROW((sts >> 7) & 0x1); //assert OK
+            UHD_ASSERT_THROW((sts & 0xf) == _addrs.which); //expected tag
+            zf_poke32(_addrs.ctrl + ARBITER_WR_STS_RDY, 1); //pop from sts fifo
+        }
+        _num_claimed += occ;
+        return _num_claimed;
+    }
+
+    template <typename T>
+    UHD_INLINE typename T::sptr _next_buff(void)
+    {
+        _num_claimed--;
+        if (_index == _num_frames)
+            _index = 0;
+        return _buffs[_index++]->get_new<T>();
+    }
+
     managed_recv_buffer::sptr get_recv_buff(const double timeout)
     {
         return this->get_buff<managed_recv_buffer>(timeout);
@@ -302,6 +348,9 @@ private:
     const size_t _num_frames;
     const size_t _frame_size;
     size_t _index;
+    size_t _num_claimed;
+    const size_t _coalesce_frames;
+    const double _coalesce_timeout;
     e300_fifo_poll_waiter *_waiter;
     std::vector<boost::shared_ptr<e300_fifo_mb> > _buffs;
 };
@@ -358,16 +407,17 @@ public:
 
     uhd::transport::zero_copy_if::sptr make_recv_xport(
         const size_t which_stream,
-        const uhd::transport::zero_copy_xport_params &params)
+        const uhd::transport::zero_copy_xport_params &params,
+        const bool coalesce)
     {
-        return this->_make_xport(which_stream, params, true);
+        return this->_make_xport(which_stream, params, true, coalesce);
     }
 
     uhd::transport::zero_copy_if::sptr make_send_xport(
         const size_t which_stream,
         const uhd::transport::zero_copy_xport_params &params)
     {
-        return this->_make_xport(which_stream, params, false);
+        return this->_make_xport(which_stream, params, false, false);
     }
 
     size_t get_global_regs_base() const
@@ -379,7 +429,8 @@ private:
     uhd::transport::zero_copy_if::sptr _make_xport(
         const size_t which_stream,
         const uhd::transport::zero_copy_xport_params &params,
-        const bool is_recv)
+        const bool is_recv,
+        const bool coalesce)
     {
         boost::mutex::scoped_lock lock(_setup_mutex);
 
@@ -395,8 +446,9 @@ private:
         addrs.ctrl = ((is_recv)? S2H_BASE(_ctrl_space) : H2S_BASE(_ctrl_space)) + ZF_STREAM_OFF(which_stream);
 
         uhd::transport::zero_copy_if::sptr xport;
-        if (is_recv) xport.reset(new e300_transport(shared_from_this(), addrs, num_frames, frame_size, _waiter, is_recv));
-        else         xport.reset(new e300_transport(shared_from_this(), addrs, num_frames, frame_size, _waiter, is_recv));
+        if (coalesce) xport.reset(new e300_transport(shared_from_this(), addrs, num_frames, frame_size, _waiter, is_recv,
+                                                     _config.recv_coalesce_frames, _config.recv_coalesce_timeout));
+        else          xport.reset(new e300_transport(shared_from_this(), addrs, num_frames, frame_size, _waiter, is_recv, 1, 0.0));
 
         _bytes_in_use += num_frames*frame_size;
         entries_in_use += num_frames;
@@ -28,6 +28,10 @@ struct e300_fifo_config_t
     size_t ctrl_length;
     size_t buff_length;
     size_t phys_addr;
+    //! Wait for this many completed frames before waking up a receiver
+    size_t recv_coalesce_frames;
+    //! Max. time in seconds to wait for recv_coalesce_frames
+    double recv_coalesce_timeout;
 };
 
 e300_fifo_config_t e300_read_sysfs(void);
@@ -38,9 +42,16 @@ struct e300_fifo_interface : boost::enable_shared_from_this<e300_fifo_interface>
     typedef boost::shared_ptr<e300_fifo_interface> sptr;
     static sptr make(const e300_fifo_config_t &config);
 
+    /*!
+     * Make a transport that receives from a DMA FIFO stream.
+     * With coalesce, a waiting receiver is woken up for several frames
+     * at once (see e300_fifo_config_t::recv_coalesce_frames). Use it for
+     * sample data, not for latency sensitive control responses.
+     */
     virtual uhd::transport::zero_copy_if::sptr make_recv_xport(
         const size_t which_stream,
-        const uhd::transport::zero_copy_xport_params &params) = 0;
+        const uhd::transport::zero_copy_xport_params &params,
+        const bool coalesce) = 0;
 
     virtual uhd::transport::zero_copy_if::sptr make_send_xport(
         const size_t which_stream,
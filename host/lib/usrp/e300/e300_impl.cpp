@@ -364,8 +364,11 @@ e300_impl::e300_impl(const uhd::device_addr_t &device_addr)
     udp_zero_copy::buff_params dummy_buff_params_out;
 
     if (_xport_path == ETH) {
+        zero_copy_xport_params codec_xport_params = _ctrl_xport_params;
+        codec_xport_params.recv_frame_size = e300::DEFAULT_CODEC_FRAME_SIZE;
+        codec_xport_params.send_frame_size = e300::DEFAULT_CODEC_FRAME_SIZE;
         zero_copy_if::sptr codec_xport =
-            udp_zero_copy::make(device_addr["addr"], E300_SERVER_CODEC_PORT, _ctrl_xport_params, dummy_buff_params_out, device_addr);
+            udp_zero_copy::make(device_addr["addr"], E300_SERVER_CODEC_PORT, codec_xport_params, dummy_buff_params_out, device_addr);
         _codec_ctrl = e300_remote_codec_ctrl::make(codec_xport);
         zero_copy_if::sptr gregs_xport =
             udp_zero_copy::make(device_addr["addr"], E300_SERVER_GREGS_PORT, _ctrl_xport_params, dummy_buff_params_out, device_addr);
@@ -392,6 +395,8 @@ e300_impl::e300_impl(const uhd::device_addr_t &device_addr)
         } catch (...) {
             throw uhd::runtime_error("Failed to get driver parameters from sysfs.");
         }
+        fifo_cfg.recv_coalesce_frames = device_addr.cast<size_t>("recv_coalesce_frames", 1);
+        fifo_cfg.recv_coalesce_timeout = device_addr.cast<double>("recv_coalesce_timeout", e300::DEFAULT_RECV_COALESCE_TIMEOUT);
         _fifo_iface = e300_fifo_interface::make(fifo_cfg);
         _global_regs = global_regs::make(_fifo_iface->get_global_regs_base());
 
@@ -473,6 +478,8 @@ e300_impl::e300_impl(const uhd::device_addr_t &device_addr)
         _tree->create<sensor_value_t>(mb_path / "sensors" / name)
             .set_publisher(boost::bind(&e300_sensor_manager::get_sensor, _sensor_manager, name));
     }
+    _tree->create<uhd::dict<std::string, sensor_value_t> >(mb_path / "sensor_snapshot")
+        .set_publisher(boost::bind(&e300_sensor_manager::get_all_sensors, _sensor_manager));
 #ifdef E300_GPSD
     if (_gps) {
         BOOST_FOREACH(const std::string &name, _gps->get_sensors())
@@ -501,8 +508,10 @@ e300_impl::e300_impl(const uhd::device_addr_t &device_addr)
         .add_coerced_subscriber(boost::bind(&e300_impl::_update_tick_rate, this, _1));
 
     //default some chains on -- needed for setup purposes
+    _codec_ctrl->begin_batch();
     _codec_ctrl->set_active_chains(true, false, true, false);
     _codec_ctrl->set_clock_rate(50e6);
+    _codec_ctrl->commit();
 
     ////////////////////////////////////////////////////////////////////
     // setup radios
@@ -544,6 +553,10 @@ e300_impl::e300_impl(const uhd::device_addr_t &device_addr)
     //re-sync the times when the tick rate changes
     _tree->access<double>(mb_path / "tick_rate")
         .add_coerced_subscriber(boost::bind(&e300_impl::_sync_times, this));
+    _tree->create<time_spec_t>(mb_path / "time" / "estimate")
+        .set_publisher(boost::bind(&time_core_3000::get_time_estimate, _radio_perifs[0].time64, static_cast<double *>(NULL)));
+    _tree->create<double>(mb_path / "time" / "estimate_error")
+        .set_publisher(boost::bind(&time_core_3000::get_time_estimate_error, _radio_perifs[0].time64));
     _tree->create<time_spec_t>(mb_path / "time" / "pps")
         .set_publisher(boost::bind(&time_core_3000::get_time_last_pps, _radio_perifs[0].time64))
         .add_coerced_subscriber(boost::bind(&time_core_3000::set_time_next_pps, _radio_perifs[0].time64, _1))
@@ -884,7 +897,7 @@ e300_impl::both_xports_t e300_impl::_make_transport(
         xports.send =
             _fifo_iface->make_send_xport(stream, params);
         xports.recv =
-            _fifo_iface->make_recv_xport(stream, params);
+            _fifo_iface->make_recv_xport(stream, params, prefix == E300_RADIO_DEST_PREFIX_RX);
 
     // in network mode
     } else if (_xport_path == ETH) {
@@ -1084,10 +1097,12 @@ void e300_impl::_update_enables(void)
     const bool mimo = num_rx == 2 or num_tx == 2;
 
     //setup the active chains in the codec
+    _codec_ctrl->begin_batch();
     _codec_ctrl->set_active_chains(enb_tx1, enb_tx2, enb_rx1, enb_rx2);
     if ((num_rx + num_tx) == 0)
         _codec_ctrl->set_active_chains(
             true, false, true, false); // enable something
+    _codec_ctrl->commit();
 
     //set_active_chains could cause a clock rate change - reset dcm
     _reset_codec_mmcm();
@@ -19,6 +19,7 @@
 #include "e300_impl.hpp"
 #include "e300_fpga_defs.hpp"
 #include "validate_subdev_spec.hpp"
+#include "streamer_args.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "async_packet_handler.hpp"
@@ -423,6 +424,7 @@ rx_streamer::sptr e300_impl::get_rx_stream(const uhd::stream_args_t &args_)
     }
     args.otw_format = "sc16";
     args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    const streamer_args_t streamer_args(args);
 
     boost::shared_ptr<sph::recv_packet_streamer> my_streamer;
     for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
@@ -451,7 +453,7 @@ rx_streamer::sptr e300_impl::get_rx_stream(const uhd::stream_args_t &args_)
         ;
         const size_t bpp = data_xports.recv->get_recv_frame_size() - hdr_size;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-        const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+        const size_t spp = streamer_args.get_spp(bpp/bpi);
 
         //make the new streamer given the samples per packet
         if (not my_streamer)
@@ -531,6 +533,7 @@ tx_streamer::sptr e300_impl::get_tx_stream(const uhd::stream_args_t &args_)
     }
     args.otw_format = "sc16";
     args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    const streamer_args_t streamer_args(args);
 
 
     //shared async queue for all channels in streamer
@@ -565,7 +568,7 @@ tx_streamer::sptr e300_impl::get_tx_stream(const uhd::stream_args_t &args_)
         ;
         const size_t bpp = data_xports.send->get_send_frame_size() - hdr_size;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-        const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+        const size_t spp = streamer_args.get_spp(bpp/bpi);
 
         //make the new streamer given the samples per packet
         if (not my_streamer)
@@ -606,7 +609,7 @@ tx_streamer::sptr e300_impl::get_tx_stream(const uhd::stream_args_t &args_)
 
         task::sptr task = task::make(boost::bind(&handle_tx_async_msgs,
                                                  fc_cache, data_xports.recv,
-                                                 get_tick_rate_fn));
+                                                 get_tick_rate_fn), "async", "tx async messages");
 
         my_streamer->set_xport_chan_get_buff(
             stream_i,
@@ -34,6 +34,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/paths.hpp>
+#include <uhd/utils/thread_priority.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
@@ -41,6 +42,13 @@
 #include <boost/make_shared.hpp>
 
 #include <fstream>
+#include <deque>
+#include <cerrno>
+#include <cstring>
+#if defined(HAVE_SENDMMSG) or defined(HAVE_RECVMMSG)
+#include <sys/socket.h> //sendmmsg, recvmmsg
+#include <sys/uio.h> //iovec
+#endif
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -69,26 +77,83 @@ static inline bool wait_for_recv_ready(int sock_fd, const size_t timeout_ms)
 
 static boost::mutex endpoint_mutex;
 
+/***********************************************************************
+ * Tunnel settings and statistics
+ **********************************************************************/
+struct tunnel_params_t
+{
+    //! Max. number of packets forwarded per system call
+    size_t batch_size;
+    //! The CPU to pin the tunnel thread to, or -1
+    int cpu;
+};
+
+struct tunnel_stats_t
+{
+    tunnel_stats_t(void): packets(0), bytes(0), batches(0) {}
+
+    void update(const size_t num_packets, const size_t num_bytes)
+    {
+        packets += num_packets;
+        bytes += num_bytes;
+        batches++;
+    }
+
+    std::string to_pp_string(void) const
+    {
+        return str(boost::format("%u packets, %u bytes, %.1f packets per batch")
+            % packets % bytes % (batches ? double(packets)/batches : 0.0));
+    }
+
+    size_t packets;
+    size_t bytes;
+    size_t batches;
+};
+
+static void setup_tunnel_thread(const std::string &name, const tunnel_params_t &params)
+{
+    if (params.cpu < 0) return;
+    try {
+        uhd::set_thread_affinity(std::vector<size_t>(1, size_t(params.cpu)));
+    } catch (const std::exception &ex) {
+        UHD_MSG(warning) << name << ": could not pin to CPU " << params.cpu << ": " << ex.what() << std::endl;
+    }
+}
+
 /***********************************************************************
  * Receive tunnel - forwards recv interface to send socket
+ *
+ * All frames that the FIFO has completed are sent with one system call,
+ * straight out of the mmapped FIFO memory.
  **********************************************************************/
 static void e300_recv_tunnel(
     const std::string &name,
     uhd::transport::zero_copy_if::sptr recver,
     boost::shared_ptr<asio::ip::udp::socket> sender,
     asio::ip::udp::endpoint *endpoint,
-    bool *running
+    bool *running,
+    const tunnel_params_t &params
 )
 {
+    setup_tunnel_thread(name, params);
+    tunnel_stats_t stats;
     asio::ip::udp::endpoint _tx_endpoint;
+    const size_t batch_size = std::max<size_t>(1, std::min(params.batch_size, recver->get_num_recv_frames()));
+    std::vector<managed_recv_buffer::sptr> buffs(batch_size);
+#ifdef HAVE_SENDMMSG
+    std::vector<mmsghdr> msgs(batch_size);
+    std::vector<iovec> iovs(batch_size);
+#endif /*HAVE_SENDMMSG*/
     try
     {
         while (*running)
         {
-            //step 1 - get the buffer
-            managed_recv_buffer::sptr buff = recver->get_recv_buff();
-            if (not buff) continue;
-            if (E300_NETWORK_DEBUG) UHD_MSG(status) << name << " got " << buff->size() << std::endl;
+            //step 1 - get the buffers, wait for the first one only
+            buffs[0] = recver->get_recv_buff();
+            if (not buffs[0]) continue;
+            size_t num_buffs = 1;
+            while (num_buffs < batch_size and (buffs[num_buffs] = recver->get_recv_buff(0.0))) num_buffs++;
+            if (E300_NETWORK_DEBUG) UHD_MSG(status) << name << " got " << num_buffs << " frames" << std::endl;
 
             //step 1.5 -- update endpoint
             {
@@ -97,7 +162,37 @@ static void e300_recv_tunnel(
             }
 
             //step 2 - send to the socket
-            sender->send_to(asio::buffer(buff->cast<const void *>(), buff->size()), _tx_endpoint);
+            size_t num_bytes = 0;
+#ifdef HAVE_SENDMMSG
+            for (size_t i = 0; i < num_buffs; i++)
+            {
+                iovs[i].iov_base = const_cast<void *>(buffs[i]->cast<const void *>());
+                iovs[i].iov_len = buffs[i]->size();
+                std::memset(&msgs[i], 0, sizeof(mmsghdr));
+                msgs[i].msg_hdr.msg_name = _tx_endpoint.data();
+                msgs[i].msg_hdr.msg_namelen = _tx_endpoint.size();
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                num_bytes += buffs[i]->size();
+            }
+            for (size_t num_sent = 0; num_sent < num_buffs;)
+            {
+                const int ret = ::sendmmsg(sender->native(), &msgs[num_sent], num_buffs - num_sent, 0);
+                if (ret < 0 and errno == EINTR) continue;
+                if (ret < 0) throw uhd::os_error(str(boost::format("sendmmsg: %s") % strerror(errno)));
+                num_sent += size_t(ret);
+            }
+#else
+            for (size_t i = 0; i < num_buffs; i++)
+            {
+                sender->send_to(asio::buffer(buffs[i]->cast<const void *>(), buffs[i]->size()), _tx_endpoint);
+                num_bytes += buffs[i]->size();
+            }
+#endif /*HAVE_SENDMMSG*/
+            stats.update(num_buffs, num_bytes);
+
+            //step 3 - release the frames back to the FIFO
+            for (size_t i = 0; i < num_buffs; i++) buffs[i].reset();
         }
     }
     catch(const std::exception &ex)
@@ -108,35 +203,79 @@ static void e300_recv_tunnel(
     {
         UHD_MSG(error) << "e300_recv_tunnel exit " << name << std::endl;
     }
-    UHD_MSG(status) << "e300_recv_tunnel exit " << name << std::endl;
+    UHD_MSG(status) << "e300_recv_tunnel exit " << name << ": " << stats.to_pp_string() << std::endl;
     *running = false;
 }
 
 /***********************************************************************
  * Send tunnel - forwards recv socket to send interface
+ *
+ * Packets are received straight into the mmapped FIFO frames, as many
+ * as there are free frames with one system call.
  **********************************************************************/
 static void e300_send_tunnel(
     const std::string &name,
     boost::shared_ptr<asio::ip::udp::socket> recver,
     uhd::transport::zero_copy_if::sptr sender,
     asio::ip::udp::endpoint *endpoint,
-    bool *running
+    bool *running,
+    const tunnel_params_t &params
 )
 {
+    setup_tunnel_thread(name, params);
+    tunnel_stats_t stats;
+    const size_t batch_size = std::max<size_t>(1, std::min(params.batch_size, sender->get_num_send_frames()));
+    //frames that were claimed from the FIFO but not filled yet
+    std::deque<managed_send_buffer::sptr> buffs;
+#ifdef HAVE_RECVMMSG
+    std::vector<mmsghdr> msgs(batch_size);
+    std::vector<iovec> iovs(batch_size);
+    std::vector<asio::ip::udp::endpoint> rx_endpoints(batch_size);
+#endif /*HAVE_RECVMMSG*/
     asio::ip::udp::endpoint _rx_endpoint;
     try
     {
         while (*running)
         {
-            //step 1 - get the buffer
-            managed_send_buffer::sptr buff = sender->get_send_buff();
-            if (not buff) continue;
+            //step 1 - get the buffers, wait only when there are none
+            if (buffs.empty())
+            {
+                managed_send_buffer::sptr buff = sender->get_send_buff();
+                if (not buff) continue;
+                buffs.push_back(buff);
+            }
+            while (buffs.size() < batch_size)
+            {
+                managed_send_buffer::sptr buff = sender->get_send_buff(0.0);
+                if (not buff) break;
+                buffs.push_back(buff);
+            }
 
             //step 2 - recv from socket
             while (not wait_for_recv_ready(recver->native(), 100) and *running){}
             if (not *running) break;
-            const size_t num_bytes = recver->receive_from(asio::buffer(buff->cast<void *>(), buff->size()), _rx_endpoint);
-            if (E300_NETWORK_DEBUG) UHD_MSG(status) << name << " got " << num_bytes << std::endl;
+#ifdef HAVE_RECVMMSG
+            for (size_t i = 0; i < buffs.size(); i++)
+            {
+                iovs[i].iov_base = buffs[i]->cast<void *>();
+                iovs[i].iov_len = buffs[i]->size();
+                std::memset(&msgs[i], 0, sizeof(mmsghdr));
+                msgs[i].msg_hdr.msg_name = rx_endpoints[i].data();
+                msgs[i].msg_hdr.msg_namelen = rx_endpoints[i].capacity();
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int ret = ::recvmmsg(recver->native(), &msgs[0], buffs.size(), MSG_DONTWAIT, NULL);
+            if (ret < 0 and (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR)) continue;
+            if (ret < 0) throw uhd::os_error(str(boost::format("recvmmsg: %s") % strerror(errno)));
+            const size_t num_recvd = size_t(ret);
+            rx_endpoints[num_recvd-1].resize(msgs[num_recvd-1].msg_hdr.msg_namelen);
+            _rx_endpoint = rx_endpoints[num_recvd-1];
+#else
+            const size_t num_recvd = 1;
+            const size_t num_bytes = recver->receive_from(asio::buffer(buffs[0]->cast<void *>(), buffs[0]->size()), _rx_endpoint);
+#endif /*HAVE_RECVMMSG*/
+            if (E300_NETWORK_DEBUG) UHD_MSG(status) << name << " got " << num_recvd << " packets" << std::endl;
 
             //step 2.5 -- update endpoint
             {
@@ -144,8 +283,18 @@ static void e300_send_tunnel(
                 *endpoint = _rx_endpoint;
             }
 
-            //step 3 - commit the buffer
-            buff->commit(num_bytes);
+            //step 3 - commit the buffers
+            size_t total_bytes = 0;
+            for (size_t i = 0; i < num_recvd; i++)
+            {
+#ifdef HAVE_RECVMMSG
+                const size_t num_bytes = msgs[i].msg_len;
+#endif /*HAVE_RECVMMSG*/
+                buffs.front()->commit(num_bytes);
+                buffs.pop_front();
+                total_bytes += num_bytes;
+            }
+            stats.update(num_recvd, total_bytes);
         }
     }
     catch(const std::exception &ex)
@@ -156,10 +305,93 @@ static void e300_send_tunnel(
     {
         UHD_MSG(error) << "e300_send_tunnel exit " << name << std::endl;
     }
-    UHD_MSG(status) << "e300_send_tunnel exit " << name << std::endl;
+    UHD_MSG(status) << "e300_send_tunnel exit " << name << ": " << stats.to_pp_string() << std::endl;
     *running = false;
 }
 
+typedef e300_remote_codec_ctrl::transaction_t codec_xact_t;
+
+static void e300_codec_ctrl_transact(
+    ad9361_ctrl::sptr _codec_ctrl,
+    const codec_xact_t *in,
+    codec_xact_t *out
+)
+{
+    std::memcpy(out, in, sizeof(codec_xact_t));
+
+    std::string which_str;
+    switch (uhd::ntohx<uint32_t>(in->which)) {
+    case codec_xact_t::CHAIN_TX1:
+        which_str = "TX1"; break;
+    case codec_xact_t::CHAIN_TX2:
+        which_str = "TX2"; break;
+    case codec_xact_t::CHAIN_RX1:
+        which_str = "RX1"; break;
+    case codec_xact_t::CHAIN_RX2:
+        which_str = "RX2"; break;
+    default:
+        which_str = ""; break;
+    }
+
+    switch (uhd::ntohx<uint32_t>(in->action)) {
+    case codec_xact_t::ACTION_SET_GAIN:
+        out->gain = _codec_ctrl->set_gain(which_str, in->gain);
+        break;
+    case codec_xact_t::ACTION_SET_CLOCK_RATE:
+        out->rate = _codec_ctrl->set_clock_rate(in->rate);
+        break;
+    case codec_xact_t::ACTION_SET_ACTIVE_CHANS:
+        _codec_ctrl->set_active_chains(
+            uhd::ntohx<uint32_t>(in->bits) & (1<<0),
+            uhd::ntohx<uint32_t>(in->bits) & (1<<1),
+            uhd::ntohx<uint32_t>(in->bits) & (1<<2),
+            uhd::ntohx<uint32_t>(in->bits) & (1<<3));
+        break;
+    case codec_xact_t::ACTION_TUNE:
+        out->freq = _codec_ctrl->tune(which_str, in->freq);
+        break;
+    case codec_xact_t::ACTION_GET_FREQ:
+            out->freq = _codec_ctrl->get_freq(which_str);
+        break;
+    case codec_xact_t::ACTION_SET_LOOPBACK:
+        _codec_ctrl->data_port_loopback(
+            uhd::ntohx<uint32_t>(in->bits) & 1);
+        break;
+    case codec_xact_t::ACTION_GET_RSSI:
+        out->rssi = _codec_ctrl->get_rssi(which_str).to_real();
+        break;
+    case codec_xact_t::ACTION_GET_TEMPERATURE:
+        out->temp = _codec_ctrl->get_temperature().to_real();
+        break;
+    case codec_xact_t::ACTION_SET_DC_OFFSET_AUTO:
+        _codec_ctrl->set_dc_offset_auto(which_str, in->use_dc_correction == 1);
+        break;
+    case codec_xact_t::ACTION_SET_IQ_BALANCE_AUTO:
+        _codec_ctrl->set_iq_balance_auto(which_str, in->use_iq_correction == 1);
+        break;
+    case codec_xact_t::ACTION_SET_AGC:
+        _codec_ctrl->set_agc(which_str, in->use_agc == 1);
+        break;
+    case codec_xact_t::ACTION_SET_AGC_MODE:
+        if(in->agc_mode == 0) {
+            _codec_ctrl->set_agc_mode(which_str, "slow");
+        } else if (in->agc_mode == 1) {
+            _codec_ctrl->set_agc_mode(which_str, "fast");
+        }
+        break;
+    case codec_xact_t::ACTION_SET_BW:
+        out->bw = _codec_ctrl->set_bw_filter(which_str, in->bw);
+        break;
+    case codec_xact_t::ACTION_RECALIBRATE:
+        _codec_ctrl->recalibrate();
+        break;
+    default:
+        UHD_MSG(status) << "Got unknown request?!" << std::endl;
+        //Zero out actions to fail this request on client
+        out->action = uhd::htonx<uint32_t>(0);
+    }
+}
+
 static void e300_codec_ctrl_tunnel(
     const std::string &name,
     boost::shared_ptr<asio::ip::udp::socket> socket,
@@ -173,91 +405,23 @@ static void e300_codec_ctrl_tunnel(
     {
         while (*running)
         {
-            uint8_t in_buff[64] = {};
-            uint8_t out_buff[64] = {};
+            codec_xact_t in_buff[e300::DEFAULT_CODEC_FRAME_SIZE/sizeof(codec_xact_t)];
+            codec_xact_t out_buff[e300::DEFAULT_CODEC_FRAME_SIZE/sizeof(codec_xact_t)];
 
             const size_t num_bytes = socket->receive_from(asio::buffer(in_buff), *endpoint);
 
-            typedef e300_remote_codec_ctrl::transaction_t codec_xact_t;
-
             if (num_bytes < sizeof(codec_xact_t)) {
                 std::cout << "Received short packet of " << num_bytes  << std::endl;
                 continue;
             }
 
-            codec_xact_t *in = reinterpret_cast<codec_xact_t*>(in_buff);
-            codec_xact_t *out = reinterpret_cast<codec_xact_t*>(out_buff);
-            std::memcpy(out, in, sizeof(codec_xact_t));
-
-            std::string which_str;
-            switch (uhd::ntohx<uint32_t>(in->which)) {
-            case codec_xact_t::CHAIN_TX1:
-                which_str = "TX1"; break;
-            case codec_xact_t::CHAIN_TX2:
-                which_str = "TX2"; break;
-            case codec_xact_t::CHAIN_RX1:
-                which_str = "RX1"; break;
-            case codec_xact_t::CHAIN_RX2:
-                which_str = "RX2"; break;
-            default:
-                which_str = ""; break;
-            }
-
-            switch (uhd::ntohx<uint32_t>(in->action)) {
-            case codec_xact_t::ACTION_SET_GAIN:
-                out->gain = _codec_ctrl->set_gain(which_str, in->gain);
-                break;
-            case codec_xact_t::ACTION_SET_CLOCK_RATE:
-                out->rate = _codec_ctrl->set_clock_rate(in->rate);
-                break;
-            case codec_xact_t::ACTION_SET_ACTIVE_CHANS:
-                _codec_ctrl->set_active_chains(
-                    uhd::ntohx<uint32_t>(in->bits) & (1<<0),
-                    uhd::ntohx<uint32_t>(in->bits) & (1<<1),
-                    uhd::ntohx<uint32_t>(in->bits) & (1<<2),
-                    uhd::ntohx<uint32_t>(in->bits) & (1<<3));
-                break;
-            case codec_xact_t::ACTION_TUNE:
-                out->freq = _codec_ctrl->tune(which_str, in->freq);
-                break;
-            case codec_xact_t::ACTION_GET_FREQ:
-                    out->freq = _codec_ctrl->get_freq(which_str);
-                break;
-            case codec_xact_t::ACTION_SET_LOOPBACK:
-                _codec_ctrl->data_port_loopback(
-                    uhd::ntohx<uint32_t>(in->bits) & 1);
-                break;
-            case codec_xact_t::ACTION_GET_RSSI:
-                out->rssi = _codec_ctrl->get_rssi(which_str).to_real();
-                break;
-            case codec_xact_t::ACTION_GET_TEMPERATURE:
-                out->temp = _codec_ctrl->get_temperature().to_real();
-                break;
-            case codec_xact_t::ACTION_SET_DC_OFFSET_AUTO:
-                _codec_ctrl->set_dc_offset_auto(which_str, in->use_dc_correction == 1);
-                break;
-            case codec_xact_t::ACTION_SET_IQ_BALANCE_AUTO:
-                _codec_ctrl->set_iq_balance_auto(which_str, in->use_iq_correction == 1);
-            case codec_xact_t::ACTION_SET_AGC:
-                _codec_ctrl->set_agc(which_str, in->use_agc == 1);
-                break;
-            case codec_xact_t::ACTION_SET_AGC_MODE:
-                if(in->agc_mode == 0) {
-                    _codec_ctrl->set_agc_mode(which_str, "slow");
-                } else if (in->agc_mode == 1) {
-                    _codec_ctrl->set_agc_mode(which_str, "fast");
-                }
-                break;
-            case codec_xact_t::ACTION_SET_BW:
-                out->bw = _codec_ctrl->set_bw_filter(which_str, in->bw);
-                break;
-            default:
-                UHD_MSG(status) << "Got unknown request?!" << std::endl;
-                //Zero out actions to fail this request on client
-                out->action = uhd::htonx<uint32_t>(0);
+            //a request holds one or more actions, run them in order
+            const size_t num_xacts = num_bytes/sizeof(codec_xact_t);
+            for (size_t i = 0; i < num_xacts; i++) {
+                e300_codec_ctrl_transact(_codec_ctrl, &in_buff[i], &out_buff[i]);
             }
 
-            socket->send_to(asio::buffer(out_buff, 64), *endpoint);
+            socket->send_to(asio::buffer(out_buff, num_xacts*sizeof(codec_xact_t)), *endpoint);
         }
     }
     catch(const std::exception &ex)
@@ -469,6 +633,9 @@ private:
     boost::shared_ptr<global_regs>           _global_regs;
     boost::shared_ptr<e300_sensor_manager>   _sensor_manager;
     boost::shared_ptr<e300_eeprom_manager>   _eeprom_manager;
+    tunnel_params_t                          _tunnel_params;
+    int                                      _rx_tunnel_cpu;
+    int                                      _tx_tunnel_cpu;
 };
 
 network_server_impl::~network_server_impl(void)
@@ -507,17 +674,23 @@ void network_server_impl::_run_server(
             boost::thread_group tg;
             bool running = true;
             xports_t &perif = _xports[fe];
+            tunnel_params_t unpinned = _tunnel_params;
+            unpinned.cpu = -1;
+            tunnel_params_t rx_pinned = _tunnel_params;
+            rx_pinned.cpu = _rx_tunnel_cpu;
+            tunnel_params_t tx_pinned = _tunnel_params;
+            tx_pinned.cpu = _tx_tunnel_cpu;
             if (what == "RX") {
-                tg.create_thread(boost::bind(&e300_recv_tunnel, "RX data tunnel", perif.rx_data_xport, socket, &endpoint, &running));
-                tg.create_thread(boost::bind(&e300_send_tunnel, "RX flow tunnel", socket, perif.rx_flow_xport, &endpoint, &running));
+                tg.create_thread(boost::bind(&e300_recv_tunnel, "RX data tunnel", perif.rx_data_xport, socket, &endpoint, &running, rx_pinned));
+                tg.create_thread(boost::bind(&e300_send_tunnel, "RX flow tunnel", socket, perif.rx_flow_xport, &endpoint, &running, unpinned));
             }
             if (what == "TX") {
-                tg.create_thread(boost::bind(&e300_recv_tunnel, "TX flow tunnel", perif.tx_flow_xport, socket, &endpoint, &running));
-                tg.create_thread(boost::bind(&e300_send_tunnel, "TX data tunnel", socket, perif.tx_data_xport, &endpoint, &running));
+                tg.create_thread(boost::bind(&e300_recv_tunnel, "TX flow tunnel", perif.tx_flow_xport, socket, &endpoint, &running, unpinned));
+                tg.create_thread(boost::bind(&e300_send_tunnel, "TX data tunnel", socket, perif.tx_data_xport, &endpoint, &running, tx_pinned));
             }
             if (what == "CTRL") {
-                tg.create_thread(boost::bind(&e300_recv_tunnel, "response tunnel", perif.recv_ctrl_xport, socket, &endpoint, &running));
-                tg.create_thread(boost::bind(&e300_send_tunnel, "control tunnel", socket, perif.send_ctrl_xport, &endpoint, &running));
+                tg.create_thread(boost::bind(&e300_recv_tunnel, "response tunnel", perif.recv_ctrl_xport, socket, &endpoint, &running, unpinned));
+                tg.create_thread(boost::bind(&e300_send_tunnel, "control tunnel", socket, perif.send_ctrl_xport, &endpoint, &running, unpinned));
             }
             if (what == "CODEC") {
                 tg.create_thread(boost::bind(&e300_codec_ctrl_tunnel, "CODEC tunnel", socket, _codec_ctrl, &endpoint, &running));
@@ -564,6 +737,10 @@ void network_server_impl::run()
 network_server_impl::network_server_impl(const uhd::device_addr_t &device_addr)
 {
     _eeprom_manager = boost::make_shared<e300_eeprom_manager>(i2c::make_i2cdev(E300_I2CDEV_DEVICE));
+    _tunnel_params.batch_size = device_addr.cast<size_t>("tunnel_batch_size", e300::DEFAULT_TUNNEL_BATCH_SIZE);
+    _tunnel_params.cpu = -1;
+    _rx_tunnel_cpu = device_addr.cast<int>("rx_tunnel_cpu", -1);
+    _tx_tunnel_cpu = device_addr.cast<int>("tx_tunnel_cpu", -1);
     if (not device_addr.has_key("no_reload_fpga")) {
         // Load FPGA image if provided via args
         if (device_addr.has_key("fpga")) {
@@ -619,22 +796,24 @@ network_server_impl::network_server_impl(const uhd::device_addr_t &device_addr)
     } catch (uhd::lookup_error &e) {
         throw uhd::runtime_error("Failed to get driver parameters from sysfs.");
     }
+    fifo_cfg.recv_coalesce_frames = device_addr.cast<size_t>("recv_coalesce_frames", 1);
+    fifo_cfg.recv_coalesce_timeout = device_addr.cast<double>("recv_coalesce_timeout", e300::DEFAULT_RECV_COALESCE_TIMEOUT);
     _fifo_iface = e300_fifo_interface::make(fifo_cfg);
     _global_regs = global_regs::make(_fifo_iface->get_global_regs_base());
 
     // static mapping, boooohhhhhh
     _xports[0].send_ctrl_xport = _fifo_iface->make_send_xport(E300_R0_CTRL_STREAM, ctrl_xport_params);
-    _xports[0].recv_ctrl_xport = _fifo_iface->make_recv_xport(E300_R0_CTRL_STREAM, ctrl_xport_params);
+    _xports[0].recv_ctrl_xport = _fifo_iface->make_recv_xport(E300_R0_CTRL_STREAM, ctrl_xport_params, false);
     _xports[0].tx_data_xport   = _fifo_iface->make_send_xport(E300_R0_TX_DATA_STREAM, data_xport_params);
-    _xports[0].tx_flow_xport   = _fifo_iface->make_recv_xport(E300_R0_TX_DATA_STREAM, ctrl_xport_params);
-    _xports[0].rx_data_xport   = _fifo_iface->make_recv_xport(E300_R0_RX_DATA_STREAM, data_xport_params);
+    _xports[0].tx_flow_xport   = _fifo_iface->make_recv_xport(E300_R0_TX_DATA_STREAM, ctrl_xport_params, false);
+    _xports[0].rx_data_xport   = _fifo_iface->make_recv_xport(E300_R0_RX_DATA_STREAM, data_xport_params, true);
     _xports[0].rx_flow_xport   = _fifo_iface->make_send_xport(E300_R0_RX_DATA_STREAM, ctrl_xport_params);
 
     _xports[1].send_ctrl_xport = _fifo_iface->make_send_xport(E300_R1_CTRL_STREAM, ctrl_xport_params);
-    _xports[1].recv_ctrl_xport = _fifo_iface->make_recv_xport(E300_R1_CTRL_STREAM, ctrl_xport_params);
+    _xports[1].recv_ctrl_xport = _fifo_iface->make_recv_xport(E300_R1_CTRL_STREAM, ctrl_xport_params, false);
     _xports[1].tx_data_xport   = _fifo_iface->make_send_xport(E300_R1_TX_DATA_STREAM, data_xport_params);
-    _xports[1].tx_flow_xport   = _fifo_iface->make_recv_xport(E300_R1_TX_DATA_STREAM, ctrl_xport_params);
-    _xports[1].rx_data_xport   = _fifo_iface->make_recv_xport(E300_R1_RX_DATA_STREAM, data_xport_params);
+    _xports[1].tx_flow_xport   = _fifo_iface->make_recv_xport(E300_R1_TX_DATA_STREAM, ctrl_xport_params, false);
+    _xports[1].rx_data_xport   = _fifo_iface->make_recv_xport(E300_R1_RX_DATA_STREAM, data_xport_params, true);
     _xports[1].rx_flow_xport   = _fifo_iface->make_send_xport(E300_R1_RX_DATA_STREAM, ctrl_xport_params);
 
     ad9361_params::sptr client_settings = boost::make_shared<e300_ad9361_client_t>();
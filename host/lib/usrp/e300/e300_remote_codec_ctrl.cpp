@@ -20,15 +20,22 @@
 #include <stdint.h>
 #include <uhd/exception.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <map>
+#include <vector>
 
 namespace uhd { namespace usrp { namespace e300 {
 
 class e300_remote_codec_ctrl_impl : public e300_remote_codec_ctrl
 {
 public:
-    e300_remote_codec_ctrl_impl(uhd::transport::zero_copy_if::sptr xport) : _xport(xport)
+    e300_remote_codec_ctrl_impl(uhd::transport::zero_copy_if::sptr xport) :
+        _xport(xport),
+        _max_batch(std::max<size_t>(1, std::min(
+            xport->get_send_frame_size(), xport->get_recv_frame_size()) / sizeof(transaction_t))),
+        _batch_depth(0)
     {
     }
 
@@ -81,7 +88,7 @@ public:
                      (rx1 ? (1<<2) : 0) |
                      (rx2 ? (1<<3) : 0));
 
-        _transact();
+        _post();
     }
 
     double tune(const std::string &which, const double value)
@@ -113,6 +120,31 @@ public:
         return _retval.freq;
     }
 
+    /* The tunnel transactions can't carry a frequency list, so the
+     * table is kept here and every hop is a regular network tune. */
+    std::vector<double> set_hop_table(const std::string &which, const std::vector<double> &freqs)
+    {
+        _hop_tables[which] = freqs;
+        return freqs;
+    }
+
+    double hop(const std::string &which, const size_t index)
+    {
+        const std::vector<double> &table = _hop_tables[which];
+        if (index >= table.size())
+            throw uhd::index_error("e300_remote_codec_ctrl_impl hop index out of range.");
+        return tune(which, table[index]);
+    }
+
+    void recalibrate()
+    {
+        _clear();
+        _args.action = uhd::htonx<uint32_t>(transaction_t::ACTION_RECALIBRATE);
+        _args.which  = uhd::htonx<uint32_t>(transaction_t::CHAIN_NONE);  /*Unused*/
+
+        _post();
+    }
+
     void data_port_loopback(const bool on)
     {
         _clear();
@@ -120,7 +152,7 @@ public:
         _args.which  = uhd::htonx<uint32_t>(transaction_t::CHAIN_NONE);  /*Unused*/
         _args.bits = uhd::htonx<uint32_t>(on ? 1 : 0);
 
-        _transact();
+        _post();
     }
 
     sensor_value_t get_rssi(const std::string &which)
@@ -158,7 +190,7 @@ public:
         else throw std::runtime_error("e300_remote_codec_ctrl_impl incorrect chain string.");
         _args.use_dc_correction = on ? 1 : 0;
 
-        _transact();
+        _post();
     }
 
     void set_iq_balance_auto(const std::string &which, const bool on)
@@ -172,7 +204,7 @@ public:
         else throw std::runtime_error("e300_remote_codec_ctrl_impl incorrect chain string.");
         _args.use_iq_correction = on ? 1 : 0;
 
-        _transact();
+        _post();
     }
 
     void set_agc(const std::string &which, bool enable)
@@ -186,7 +218,7 @@ public:
        else throw std::runtime_error("e300_remote_codec_ctrl_impl incorrect chain string.");
        _args.use_agc = enable ? 1 : 0;
 
-       _transact();
+       _post();
     }
 
     void set_agc_mode(const std::string &which, const std::string &mode)
@@ -208,7 +240,7 @@ public:
            throw std::runtime_error("e300_remote_codec_ctrl_impl incorrect agc mode.");
        }
 
-       _transact();
+       _post();
     }
 
     //! set the filter bandwidth for the frontend's analog low pass
@@ -250,24 +282,56 @@ public:
         UHD_THROW_INVALID_CODE_PATH();
     }
 
+    void begin_batch()
+    {
+        _batch_depth++;
+    }
+
+    void commit()
+    {
+        if (_batch_depth == 0) return;
+        if (--_batch_depth == 0) _flush();
+    }
+
 private:
+    //! send an action and all queued ones, and wait for its result
     void _transact() {
+        _queue.push_back(_args);
+        _flush();
+    }
+
+    //! queue an action without a result, or send it now outside a batch
+    void _post() {
+        _queue.push_back(_args);
+        if (_batch_depth == 0 or _queue.size() >= _max_batch) _flush();
+    }
+
+    //! send the queued actions in one request, the last result goes to _retval
+    void _flush() {
+        std::vector<transaction_t> args;
+        args.swap(_queue);
+        if (args.empty()) return;
+        const size_t len = args.size()*sizeof(transaction_t);
         {
             uhd::transport::managed_send_buffer::sptr buff = _xport->get_send_buff(10.0);
-            if (not buff or buff->size() < sizeof(_args))
+            if (not buff or buff->size() < len)
                 throw std::runtime_error("e300_remote_codec_ctrl_impl send timeout");
-            std::memcpy(buff->cast<void *>(), &_args, sizeof(_args));
-            buff->commit(sizeof(_args));
+            std::memcpy(buff->cast<void *>(), &args.front(), len);
+            buff->commit(len);
         }
+        std::vector<transaction_t> retvals(args.size());
         {
             uhd::transport::managed_recv_buffer::sptr buff = _xport->get_recv_buff(10.0);
-            if (not buff or buff->size() < sizeof(_retval))
+            if (not buff or buff->size() < len)
                 throw std::runtime_error("e300_remote_codec_ctrl_impl recv timeout");
-            std::memcpy(&_retval, buff->cast<const void *>(), sizeof(_retval));
+            std::memcpy(&retvals.front(), buff->cast<const void *>(), len);
         }
 
-        if (_args.action != _retval.action)
-            throw std::runtime_error("e300_remote_codec_ctrl_impl transaction failed.");
+        for (size_t i = 0; i < args.size(); i++) {
+            if (args[i].action != retvals[i].action)
+                throw std::runtime_error("e300_remote_codec_ctrl_impl transaction failed.");
+        }
+        _retval = retvals.back();
     }
 
     void _clear() {
@@ -280,8 +344,12 @@ private:
     }
 
     uhd::transport::zero_copy_if::sptr _xport;
+    const size_t                       _max_batch;
+    size_t                             _batch_depth;
+    std::vector<transaction_t>         _queue;
     transaction_t                      _args;
     transaction_t                      _retval;
+    std::map<std::string, std::vector<double> > _hop_tables;
 };
 
 ad9361_ctrl::sptr e300_remote_codec_ctrl::make(uhd::transport::zero_copy_if::sptr xport)
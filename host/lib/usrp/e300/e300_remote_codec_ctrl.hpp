@@ -26,6 +26,11 @@ namespace uhd { namespace usrp { namespace e300 {
 class e300_remote_codec_ctrl : public uhd::usrp::ad9361_ctrl
 {
 public:
+    /*!
+     * One codec action. A request datagram holds one or more of them,
+     * which the server executes in order; the reply holds the results
+     * in the same order.
+     */
     struct transaction_t {
         uint32_t     action;
         uint32_t     which;
@@ -57,6 +62,7 @@ public:
         static const uint32_t ACTION_SET_AGC_MODE        = 20;
         static const uint32_t ACTION_SET_BW              = 21;
         static const uint32_t ACTION_GET_FREQ            = 22;
+        static const uint32_t ACTION_RECALIBRATE         = 23;
 
         //Values for "which"
         static const uint32_t CHAIN_NONE = 0;
@@ -51,79 +51,81 @@ public:
                 str(boost::format("Invalid sensor %s requested.") % key));
     }
 
+    uhd::dict<std::string, uhd::sensor_value_t> get_all_sensors(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        // Send both requests before waiting for the first reply, the
+        // sensor tunnel answers them in order
+        _send_request(ZYNQ_TEMP);
+        _send_request(REF_LOCK);
+        uhd::dict<std::string, uhd::sensor_value_t> sensors;
+        sensors.set("temp", _make_mb_temp(_recv_reply(ZYNQ_TEMP)));
+        sensors.set("ref_locked", _make_ref_lock(_recv_reply(REF_LOCK)));
+        return sensors;
+    }
+
     uhd::sensor_value_t get_mb_temp(void)
     {
-        boost::mutex::scoped_lock(_mutex);
+        boost::mutex::scoped_lock lock(_mutex);
+        _send_request(ZYNQ_TEMP);
+        return _make_mb_temp(_recv_reply(ZYNQ_TEMP));
+    }
+
+    uhd::sensor_value_t get_ref_lock(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _send_request(REF_LOCK);
+        return _make_ref_lock(_recv_reply(REF_LOCK));
+    }
+
+private:
+    void _send_request(const uint32_t which)
+    {
         sensor_transaction_t transaction;
-        transaction.which = uhd::htonx<uint32_t>(ZYNQ_TEMP);
-        {
-            uhd::transport::managed_send_buffer::sptr buff
-                = _xport->get_send_buff(1.0);
-            if (not buff or buff->size() < sizeof(transaction)) {
-                throw uhd::runtime_error("sensor proxy send timeout");
-            }
-            std::memcpy(
-                buff->cast<void *>(),
-                &transaction,
-                sizeof(transaction));
-            buff->commit(sizeof(transaction));
+        transaction.which = uhd::htonx<uint32_t>(which);
+        uhd::transport::managed_send_buffer::sptr buff
+            = _xport->get_send_buff(1.0);
+        if (not buff or buff->size() < sizeof(transaction)) {
+            throw uhd::runtime_error("sensor proxy send timeout");
         }
-        {
-            uhd::transport::managed_recv_buffer::sptr buff
-                = _xport->get_recv_buff(1.0);
+        std::memcpy(
+            buff->cast<void *>(),
+            &transaction,
+            sizeof(transaction));
+        buff->commit(sizeof(transaction));
+    }
 
-            if (not buff or buff->size() < sizeof(transaction))
-                throw uhd::runtime_error("sensor proxy recv timeout");
+    uint32_t _recv_reply(const uint32_t which)
+    {
+        sensor_transaction_t transaction;
+        uhd::transport::managed_recv_buffer::sptr buff
+            = _xport->get_recv_buff(1.0);
+
+        if (not buff or buff->size() < sizeof(transaction))
+            throw uhd::runtime_error("sensor proxy recv timeout");
+
+        std::memcpy(
+            &transaction,
+            buff->cast<const void *>(),
+            sizeof(transaction));
+        UHD_ASSERT_THROW(uhd::ntohx<uint32_t>(transaction.which) == which);
+        return uhd::ntohx(transaction.value);
+    }
 
-            std::memcpy(
-                &transaction,
-                buff->cast<const void *>(),
-                sizeof(transaction));
-        }
-        UHD_ASSERT_THROW(uhd::ntohx<uint32_t>(transaction.which) == ZYNQ_TEMP);
-        // TODO: Use proper serialization here ...
+    // TODO: Use proper serialization here ...
+    static uhd::sensor_value_t _make_mb_temp(const uint32_t value)
+    {
         return sensor_value_t(
             "temp",
-            e300_sensor_manager::unpack_float_from_uint32_t(
-                uhd::ntohx(transaction.value)),
+            e300_sensor_manager::unpack_float_from_uint32_t(value),
             "C");
     }
 
-    uhd::sensor_value_t get_ref_lock(void)
+    static uhd::sensor_value_t _make_ref_lock(const uint32_t value)
     {
-        boost::mutex::scoped_lock(_mutex);
-        sensor_transaction_t transaction;
-        transaction.which = uhd::htonx<uint32_t>(REF_LOCK);
-        {
-            uhd::transport::managed_send_buffer::sptr buff
-                = _xport->get_send_buff(1.0);
-            if (not buff or buff->size() < sizeof(transaction)) {
-                throw uhd::runtime_error("sensor proxy send timeout");
-            }
-            std::memcpy(
-                buff->cast<void *>(),
-                &transaction,
-                sizeof(transaction));
-            buff->commit(sizeof(transaction));
-        }
-        {
-            uhd::transport::managed_recv_buffer::sptr buff
-                = _xport->get_recv_buff(1.0);
-
-            if (not buff or buff->size() < sizeof(transaction))
-                throw uhd::runtime_error("sensor proxy recv timeout");
-
-            std::memcpy(
-                &transaction,
-                buff->cast<const void *>(),
-                sizeof(transaction));
-        }
-        UHD_ASSERT_THROW(uhd::ntohx<uint32_t>(transaction.which) == REF_LOCK);
-        // TODO: Use proper serialization here ...
-        return sensor_value_t("Ref", (uhd::ntohx(transaction.value) > 0), "locked", "unlocked");
+        return sensor_value_t("Ref", (value > 0), "locked", "unlocked");
     }
 
-private:
     uhd::transport::zero_copy_if::sptr _xport;
     boost::mutex                       _mutex;
 };
@@ -169,6 +171,14 @@ public:
                 str(boost::format("Invalid sensor %s requested.") % key));
     }
 
+    uhd::dict<std::string, uhd::sensor_value_t> get_all_sensors(void)
+    {
+        uhd::dict<std::string, uhd::sensor_value_t> sensors;
+        sensors.set("temp", get_mb_temp());
+        sensors.set("ref_locked", get_ref_lock());
+        return sensors;
+    }
+
     uhd::sensor_value_t get_mb_temp(void)
     {
         double scale = boost::lexical_cast<double>(
@@ -20,6 +20,7 @@
 
 #include <uhd/transport/zero_copy.hpp>
 #include <uhd/types/sensors.hpp>
+#include <uhd/types/dict.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/usrp/gps_ctrl.hpp>
 #include "e300_global_regs.hpp"
@@ -50,6 +51,8 @@ public:
 
     virtual uhd::sensor_value_t get_sensor(const std::string &key) = 0;
     virtual std::vector<std::string> get_sensors(void) = 0;
+    //! Read all sensors at once, keyed like get_sensors()
+    virtual uhd::dict<std::string, uhd::sensor_value_t> get_all_sensors(void) = 0;
 
     virtual uhd::sensor_value_t get_mb_temp(void) = 0;
     virtual uhd::sensor_value_t get_ref_lock(void) = 0;
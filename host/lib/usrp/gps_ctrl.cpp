@@ -19,6 +19,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/exception.hpp>
+#include <uhd/utils/tasks.hpp>
 #include <uhd/types/sensors.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/list_of.hpp>
@@ -28,6 +29,7 @@
 #include <boost/tokenizer.hpp>
 #include <boost/format.hpp>
 #include <boost/regex.hpp>
+#include <boost/bind.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include "boost/tuple/tuple.hpp"
@@ -112,6 +114,17 @@ private:
         return sentence;
     }
 
+    //! Return the cached sentence if it's fresh enough, or an empty string. Never blocks.
+    std::string get_cached_sentence(const std::string which, const int max_age_ms)
+    {
+        if (sentences.find(which) == sentences.end()
+            or boost::get_system_time() - sentences[which].get<1>() >= milliseconds(max_age_ms))
+        {
+            return std::string();
+        }
+        return sentences[which].get<0>();
+    }
+
     static bool is_nmea_checksum_ok(std::string nmea)
     {
         if (nmea.length() < 5 || nmea[0] != '$' || nmea[nmea.length()-3] != '*')
@@ -259,10 +272,15 @@ public:
 
     // initialize cache
     update_cache();
+
+    // keep it fresh, so that sensors are answered without reading the GPS
+    if (gps_detected()) {
+      _cache_task = task::make_pooled(boost::bind(&gps_ctrl_impl::poll_cache, this), "async", "gps nmea reader");
+    }
   }
 
   ~gps_ctrl_impl(void){
-    /* NOP */
+    _cache_task.reset();
   }
 
   //return a list of supported sensors
@@ -301,7 +319,60 @@ public:
     }
   }
 
+  uhd::dict<std::string, uhd::sensor_value_t> get_all_sensors(void) {
+    uhd::dict<std::string, uhd::sensor_value_t> sensors;
+    boost::lock_guard<boost::mutex> lock(cache_mutex);
+    try {
+        update_cache();
+    } catch(std::exception &e) {
+        UHD_LOGV(often) << "get_all_sensors: " << e.what();
+    }
+
+    const std::string gpgga = get_cached_sentence("GPGGA", GPS_NMEA_NORMAL_FRESHNESS);
+    if (not gpgga.empty()) {
+        sensors.set("gps_gpgga", sensor_value_t("GPS_GPGGA", gpgga, ""));
+    }
+    const std::string gprmc = get_cached_sentence("GPRMC", GPS_NMEA_NORMAL_FRESHNESS);
+    if (not gprmc.empty()) {
+        sensors.set("gps_gprmc", sensor_value_t("GPS_GPRMC", gprmc, ""));
+        try {
+            sensors.set("gps_time", sensor_value_t("GPS epoch time",
+                int((parse_time(gprmc) - from_time_t(0)).total_seconds()), "seconds"));
+        } catch(std::exception &e) {
+            UHD_LOGV(often) << "get_all_sensors: " << e.what();
+        }
+    }
+    const std::string lock_gpgga = get_cached_sentence("GPGGA", GPS_LOCK_FRESHNESS);
+    if (not lock_gpgga.empty()) {
+        try {
+            sensors.set("gps_locked", sensor_value_t("GPS lock status",
+                get_token(lock_gpgga, 6) != "0", "locked", "unlocked"));
+        } catch(std::exception &e) {
+            UHD_LOGV(often) << "get_all_sensors: " << e.what();
+        }
+    }
+    const std::string servo = get_cached_sentence("SERVO", GPS_SERVO_FRESHNESS);
+    if (not servo.empty()) {
+        sensors.set("gps_servo", sensor_value_t("GPS_SERVO", servo, ""));
+    }
+    return sensors;
+  }
+
 private:
+  //! Update the cache in the background, at most every GPS_CACHE_POLL_MS
+  bool poll_cache(void) {
+    boost::lock_guard<boost::mutex> lock(cache_mutex);
+    if (boost::get_system_time() - _last_cache_update < milliseconds(GPS_CACHE_POLL_MS)) {
+      return false;
+    }
+    try {
+      update_cache();
+    } catch(std::exception &e) {
+      UHD_LOGV(often) << "poll_cache: " << e.what();
+    }
+    return true;
+  }
+
   void init_gpsdo(void) {
     //issue some setup stuff so it spits out the appropriate data
     //none of these should issue replies so we don't bother looking for them
@@ -334,6 +405,27 @@ private:
     return toked[offset];
   }
 
+  //! Get the time from a GPRMC sentence
+  ptime parse_time(const std::string &reply) {
+    std::string datestr = get_token(reply, 9);
+    std::string timestr = get_token(reply, 1);
+
+    if(datestr.size() == 0 or timestr.size() == 0) {
+        throw uhd::value_error(str(boost::format("Invalid response \"%s\"") % reply));
+    }
+
+    //just trust me on this one
+    return ptime( date(
+                     greg_year(boost::lexical_cast<int>(datestr.substr(4, 2)) + 2000),
+                     greg_month(boost::lexical_cast<int>(datestr.substr(2, 2))),
+                     greg_day(boost::lexical_cast<int>(datestr.substr(0, 2)))
+                   ),
+                  hours(  boost::lexical_cast<int>(timestr.substr(0, 2)))
+                + minutes(boost::lexical_cast<int>(timestr.substr(2, 2)))
+                + seconds(boost::lexical_cast<int>(timestr.substr(4, 2)))
+             );
+  }
+
   ptime get_time(void) {
     int error_cnt = 0;
     ptime gps_time;
@@ -341,24 +433,7 @@ private:
         try {
             // wait for next GPRMC string
             std::string reply = get_sentence("GPRMC", GPS_NMEA_NORMAL_FRESHNESS, GPS_COMM_TIMEOUT_MS, true);
-
-            std::string datestr = get_token(reply, 9);
-            std::string timestr = get_token(reply, 1);
-
-            if(datestr.size() == 0 or timestr.size() == 0) {
-                throw uhd::value_error(str(boost::format("Invalid response \"%s\"") % reply));
-            }
-
-            //just trust me on this one
-            gps_time = ptime( date(
-                             greg_year(boost::lexical_cast<int>(datestr.substr(4, 2)) + 2000),
-                             greg_month(boost::lexical_cast<int>(datestr.substr(2, 2))),
-                             greg_day(boost::lexical_cast<int>(datestr.substr(0, 2)))
-                           ),
-                          hours(  boost::lexical_cast<int>(timestr.substr(0, 2)))
-                        + minutes(boost::lexical_cast<int>(timestr.substr(2, 2)))
-                        + seconds(boost::lexical_cast<int>(timestr.substr(4, 2)))
-                     );
+            gps_time = parse_time(reply);
             return gps_time;
 
         } catch(std::exception &e) {
@@ -424,6 +499,9 @@ private:
   static const int GPS_LOCK_FRESHNESS = 2500;
   static const int GPS_TIMEOUT_DELAY_MS = 200;
   static const int GPSDO_COMMAND_DELAY_MS = 200;
+  static const int GPS_CACHE_POLL_MS = 50;
+
+  task::sptr _cache_task;
 };
 
 /***********************************************************************
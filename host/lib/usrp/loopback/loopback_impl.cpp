@@ -0,0 +1,316 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "loopback_impl.hpp"
+#include "../../transport/super_recv_packet_handler.hpp"
+#include "../../transport/super_send_packet_handler.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/usrp/mboard_eeprom.hpp>
+#include <uhd/usrp/dboard_eeprom.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Discovery
+ **********************************************************************/
+static device_addrs_t loopback_find(const device_addr_t &hint)
+{
+    device_addrs_t addrs;
+
+    //only found when asked for by type, so it never shows up next to real devices
+    if (not hint.has_key("type") or hint["type"] != "loopback") return addrs;
+
+    device_addr_t new_addr;
+    new_addr["type"] = "loopback";
+    new_addr["name"] = hint.get("name", "loopback");
+    new_addr["serial"] = hint.get("serial", "LOOPBACK0");
+    addrs.push_back(new_addr);
+    return addrs;
+}
+
+/***********************************************************************
+ * Make
+ **********************************************************************/
+static device::sptr loopback_make(const device_addr_t &device_addr)
+{
+    return device::sptr(new loopback_impl(device_addr));
+}
+
+UHD_STATIC_BLOCK(register_loopback_device)
+{
+    device::register_device(&loopback_find, &loopback_make, device::USRP);
+}
+
+/***********************************************************************
+ * Structors
+ **********************************************************************/
+loopback_impl::loopback_impl(const device_addr_t &device_addr):
+    _tick_rate(device_addr.cast<double>("master_clock_rate", LOOPBACK_DEFAULT_TICK_RATE)),
+    _recv_frame_size(device_addr.cast<size_t>("recv_frame_size", LOOPBACK_DEFAULT_FRAME_SIZE)),
+    _num_recv_frames(device_addr.cast<size_t>("num_recv_frames", LOOPBACK_DEFAULT_NUM_FRAMES)),
+    _send_frame_size(device_addr.cast<size_t>("send_frame_size", LOOPBACK_DEFAULT_FRAME_SIZE)),
+    _num_send_frames(device_addr.cast<size_t>("num_send_frames", LOOPBACK_DEFAULT_NUM_FRAMES)),
+    _throttle(device_addr.cast<int>("throttle", 1) != 0),
+    _time_offset(time_spec_t::get_system_time()),
+    _async_md(new async_md_type(1000/*messages deep*/))
+{
+    const size_t num_chans = device_addr.cast<size_t>("num_channels", 1);
+    if (num_chans == 0) {
+        throw uhd::value_error("loopback: num_channels must be at least 1");
+    }
+    if (_tick_rate <= 0.0) {
+        throw uhd::value_error("loopback: master_clock_rate must be positive");
+    }
+    if (_recv_frame_size <= LOOPBACK_HDR_SIZE or _send_frame_size <= LOOPBACK_HDR_SIZE) {
+        throw uhd::value_error("loopback: the frame sizes must be larger than the packet header");
+    }
+    if (_num_recv_frames == 0 or _num_send_frames == 0) {
+        throw uhd::value_error("loopback: the number of frames must be at least 1");
+    }
+    _rx_chans.resize(num_chans);
+    _tx_chans.resize(num_chans);
+
+    _tree = property_tree::make();
+    _type = device::USRP;
+    this->setup_tree();
+
+    UHD_MSG(status) << boost::format(
+        "Loopback device: %u channel(s), %f MHz tick rate, %s\n"
+    ) % num_chans % (_tick_rate/1e6) % (_throttle ? "paced at the sample rate" : "unthrottled");
+
+    _producer_task = task::make(boost::bind(&loopback_impl::produce, this));
+    _consumer_task = task::make(boost::bind(&loopback_impl::consume, this));
+}
+
+loopback_impl::~loopback_impl(void)
+{
+    UHD_SAFE_CALL(
+        _producer_task.reset();
+        _consumer_task.reset();
+    )
+}
+
+/***********************************************************************
+ * Property tree
+ **********************************************************************/
+static std::string coerce_source(const std::vector<std::string> &options, const std::string &source)
+{
+    if (std::find(options.begin(), options.end(), source) == options.end()) {
+        throw uhd::value_error("loopback: unknown source " + source);
+    }
+    return source;
+}
+
+static subdev_spec_t coerce_subdev_spec(const size_t num_chans, const subdev_spec_t &spec)
+{
+    BOOST_FOREACH(const subdev_spec_pair_t &pair, spec) {
+        if (pair.db_name != "A" or pair.sd_name.empty()
+                or boost::lexical_cast<size_t>(pair.sd_name) >= num_chans) {
+            throw uhd::value_error("loopback: invalid subdev spec " + spec.to_string());
+        }
+    }
+    return spec;
+}
+
+void loopback_impl::setup_tree(void)
+{
+    const fs_path mb_path = "/mboards/0";
+    const size_t num_chans = _rx_chans.size();
+
+    _tree->create<std::string>("/name").set("Loopback Device");
+    _tree->create<std::string>(mb_path / "name").set("Loopback");
+    _tree->create<std::string>(mb_path / "codename").set("Loopback");
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["name"] = "loopback";
+    mb_eeprom["serial"] = "LOOPBACK0";
+    _tree->create<mboard_eeprom_t>(mb_path / "eeprom").set(mb_eeprom);
+
+    //the tick rate is fixed at construction, use master_clock_rate to change it
+    _tree->create<double>(mb_path / "tick_rate")
+        .set_coercer(boost::bind(&loopback_impl::get_tick_rate_coerced, this, _1))
+        .set(_tick_rate);
+
+    //time keeping follows the host clock
+    _tree->create<time_spec_t>(mb_path / "time" / "now")
+        .set_publisher(boost::bind(&loopback_impl::get_time_now, this))
+        .add_coerced_subscriber(boost::bind(&loopback_impl::set_time_now, this, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "pps")
+        .set_publisher(boost::bind(&loopback_impl::get_time_last_pps, this))
+        .add_coerced_subscriber(boost::bind(&loopback_impl::set_time_next_pps, this, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "cmd"); //timed commands have nothing to time
+
+    static const std::vector<std::string> sources = boost::assign::list_of("internal")("external");
+    _tree->create<std::vector<std::string> >(mb_path / "time_source" / "options").set(sources);
+    _tree->create<std::string>(mb_path / "time_source" / "value")
+        .set_coercer(boost::bind(&coerce_source, sources, _1))
+        .set("internal");
+    _tree->create<std::vector<std::string> >(mb_path / "clock_source" / "options").set(sources);
+    _tree->create<std::string>(mb_path / "clock_source" / "value")
+        .set_coercer(boost::bind(&coerce_source, sources, _1))
+        .set("internal");
+    _tree->create<sensor_value_t>(mb_path / "sensors" / "ref_locked")
+        .set(sensor_value_t("Ref", true, "locked", "unlocked"));
+
+    //one daughterboard with a front end per channel
+    dboard_eeprom_t db_eeprom;
+    const fs_path db_path = mb_path / "dboards" / "A";
+    _tree->create<dboard_eeprom_t>(db_path / "rx_eeprom").set(db_eeprom);
+    _tree->create<dboard_eeprom_t>(db_path / "tx_eeprom").set(db_eeprom);
+    subdev_spec_t default_spec;
+    const std::vector<std::string> directions = boost::assign::list_of("rx")("tx");
+    for (size_t i = 0; i < num_chans; i++) {
+        const std::string fe_name = boost::lexical_cast<std::string>(i);
+        default_spec.push_back(subdev_spec_pair_t("A", fe_name));
+        BOOST_FOREACH(const std::string &xx, directions) {
+            const fs_path fe_path = db_path / (xx + "_frontends") / fe_name;
+            const std::string ant = (xx == "rx") ? "RX" : "TX";
+            _tree->create<std::string>(fe_path / "name").set("Loopback");
+            _tree->create<std::string>(fe_path / "connection").set("IQ");
+            _tree->create<bool>(fe_path / "enabled").set(true);
+            _tree->create<bool>(fe_path / "use_lo_offset").set(false);
+            _tree->create<std::vector<std::string> >(fe_path / "antenna" / "options")
+                .set(std::vector<std::string>(1, ant));
+            _tree->create<std::string>(fe_path / "antenna" / "value").set(ant);
+            _tree->create<double>(fe_path / "freq" / "value").set(0.0);
+            _tree->create<meta_range_t>(fe_path / "freq" / "range").set(meta_range_t(0.0, 6e9));
+            _tree->create<double>(fe_path / "bandwidth" / "value").set(_tick_rate);
+            _tree->create<meta_range_t>(fe_path / "bandwidth" / "range")
+                .set(meta_range_t(_tick_rate, _tick_rate));
+        }
+    }
+    _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
+        .set_coercer(boost::bind(&coerce_subdev_spec, num_chans, _1))
+        .set(default_spec);
+    _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
+        .set_coercer(boost::bind(&coerce_subdev_spec, num_chans, _1))
+        .set(default_spec);
+
+    //one DSP chain per channel, the rate is set by decimation of the tick rate
+    const meta_range_t rate_range(_tick_rate/LOOPBACK_MAX_DECIM, _tick_rate);
+    const meta_range_t dsp_freq_range(-_tick_rate/2, _tick_rate/2);
+    for (size_t i = 0; i < num_chans; i++) {
+        const fs_path rx_dsp_path = mb_path / "rx_dsps" / boost::lexical_cast<std::string>(i);
+        _tree->create<meta_range_t>(rx_dsp_path / "rate" / "range").set(rate_range);
+        _tree->create<double>(rx_dsp_path / "rate" / "value")
+            .set_coercer(boost::bind(&loopback_impl::set_rate, this, i, false, _1))
+            .set(1e6);
+        _tree->create<double>(rx_dsp_path / "freq" / "value").set(0.0);
+        _tree->create<meta_range_t>(rx_dsp_path / "freq" / "range").set(dsp_freq_range);
+        _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
+            .add_coerced_subscriber(boost::bind(&loopback_impl::issue_stream_cmd, this, i, _1));
+
+        const fs_path tx_dsp_path = mb_path / "tx_dsps" / boost::lexical_cast<std::string>(i);
+        _tree->create<meta_range_t>(tx_dsp_path / "rate" / "range").set(rate_range);
+        _tree->create<double>(tx_dsp_path / "rate" / "value")
+            .set_coercer(boost::bind(&loopback_impl::set_rate, this, i, true, _1))
+            .set(1e6);
+        _tree->create<double>(tx_dsp_path / "freq" / "value").set(0.0);
+        _tree->create<meta_range_t>(tx_dsp_path / "freq" / "range").set(dsp_freq_range);
+    }
+}
+
+double loopback_impl::get_tick_rate_coerced(const double)
+{
+    return _tick_rate;
+}
+
+/***********************************************************************
+ * Time keeping
+ **********************************************************************/
+time_spec_t loopback_impl::tsf_to_wall(const uint64_t tsf) const
+{
+    return time_spec_t::from_ticks(tsf, _tick_rate) + _time_offset;
+}
+
+uint64_t loopback_impl::wall_to_tsf(const time_spec_t &wall) const
+{
+    const time_spec_t time = wall - _time_offset;
+    if (time < time_spec_t(0.0)) return 0;
+    return uint64_t(time.to_ticks(_tick_rate));
+}
+
+time_spec_t loopback_impl::get_time_now(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return time_spec_t::get_system_time() - _time_offset;
+}
+
+void loopback_impl::set_time_now(const time_spec_t &time)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    _time_offset = time_spec_t::get_system_time() - time;
+}
+
+time_spec_t loopback_impl::get_time_last_pps(void)
+{
+    //the PPS edges are on the full seconds of the device time
+    return time_spec_t(std::floor(get_time_now().get_real_secs()));
+}
+
+void loopback_impl::set_time_next_pps(const time_spec_t &time)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    const time_spec_t wall = time_spec_t::get_system_time();
+    const time_spec_t now = wall - _time_offset;
+    const time_spec_t to_next_pps = time_spec_t(1.0) - time_spec_t(0, now.get_frac_secs());
+    _time_offset = wall - (time - to_next_pps);
+}
+
+/***********************************************************************
+ * Sample rates
+ **********************************************************************/
+double loopback_impl::set_rate(const size_t index, const bool is_tx, const double rate)
+{
+    if (rate <= 0.0) {
+        throw uhd::value_error("loopback: the sample rate must be positive");
+    }
+    const size_t decim = size_t(std::max<double>(1.0, std::min<double>(
+        double(LOOPBACK_MAX_DECIM), boost::math::round(_tick_rate/rate)
+    )));
+    const double actual_rate = _tick_rate/decim;
+
+    boost::mutex::scoped_lock lock(_mutex);
+    if (is_tx) {
+        _tx_chans.at(index).decim = decim;
+        boost::shared_ptr<sph::send_packet_streamer> my_streamer =
+            boost::dynamic_pointer_cast<sph::send_packet_streamer>(_tx_chans[index].streamer.lock());
+        if (my_streamer) my_streamer->set_samp_rate(actual_rate);
+    } else {
+        _rx_chans.at(index).decim = decim;
+        boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+            boost::dynamic_pointer_cast<sph::recv_packet_streamer>(_rx_chans[index].streamer.lock());
+        if (my_streamer) my_streamer->set_samp_rate(actual_rate);
+    }
+    return actual_rate;
+}
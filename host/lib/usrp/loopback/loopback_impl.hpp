@@ -0,0 +1,147 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LOOPBACK_IMPL_HPP
+#define INCLUDED_LOOPBACK_IMPL_HPP
+
+#include "loopback_ring.hpp"
+#include <uhd/device.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/weak_ptr.hpp>
+#include <vector>
+
+static const double LOOPBACK_DEFAULT_TICK_RATE = 200e6;
+static const size_t LOOPBACK_MAX_DECIM         = 1024;
+static const size_t LOOPBACK_DEFAULT_FRAME_SIZE = 8000;
+static const size_t LOOPBACK_DEFAULT_NUM_FRAMES = 32;
+static const size_t LOOPBACK_HDR_SIZE          = 16; //CHDR header with SID and time
+
+/*!
+ * A device with no hardware behind it.
+ *
+ * Each RX channel has a producer that writes CHDR data packets into
+ * an in-memory ring at the channel's sample rate, and each TX channel
+ * has a consumer that drains its ring the same way. The regular packet
+ * handlers sit on top, so benchmark_rate and latency_test can measure
+ * the host side of streaming without a radio.
+ *
+ * With throttle=0 the producer fills the rings as fast as the streamer
+ * empties them and the consumer drains them as fast as they are filled,
+ * which measures the maximum rate of the streamer stack.
+ */
+class loopback_impl : public uhd::device
+{
+public:
+    loopback_impl(const uhd::device_addr_t &device_addr);
+    ~loopback_impl(void);
+
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t &args);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t &args);
+    bool recv_async_msg(uhd::async_metadata_t &, double);
+
+private:
+    //! State of one RX channel, owned by the producer under _mutex
+    struct rx_chan_t
+    {
+        rx_chan_t(void):
+            decim(1), seq(0), active(false), continuous(false),
+            eob_at_end(false), samps_left(0), next_tsf(0), bpi(4), spp(0),
+            overflow_pending(false), late_pending(false) {}
+        size_t decim;
+        loopback_ring::sptr ring;
+        boost::weak_ptr<uhd::rx_streamer> streamer;
+        size_t seq;
+        bool active;
+        bool continuous;
+        bool eob_at_end;
+        uint64_t samps_left;
+        uint64_t next_tsf;
+        size_t bpi;
+        size_t spp;
+        bool overflow_pending;
+        bool late_pending;
+    };
+
+    //! State of one TX channel, owned by the consumer under _mutex
+    struct tx_chan_t
+    {
+        tx_chan_t(void):
+            decim(1), stream_chan(0), seq(0), in_burst(false), next_tsf(0), bpi(4),
+            underflow_reported(false) {}
+        size_t decim;
+        size_t stream_chan; //channel index in the streamer, for async messages
+        loopback_ring::sptr ring;
+        boost::weak_ptr<uhd::tx_streamer> streamer;
+        size_t seq;
+        bool in_burst;
+        uint64_t next_tsf;
+        size_t bpi;
+        bool underflow_reported;
+        uhd::transport::managed_recv_buffer::sptr held;
+        uhd::transport::vrt::if_packet_info_t held_info;
+    };
+
+    void setup_tree(void);
+    double get_tick_rate_coerced(const double);
+    double set_rate(const size_t decim_index, const bool is_tx, const double rate);
+    uhd::time_spec_t get_time_now(void);
+    void set_time_now(const uhd::time_spec_t &time);
+    uhd::time_spec_t get_time_last_pps(void);
+    void set_time_next_pps(const uhd::time_spec_t &time);
+    //conversions between device ticks and the wall clock, call with _mutex held
+    uhd::time_spec_t tsf_to_wall(const uint64_t tsf) const;
+    uint64_t wall_to_tsf(const uhd::time_spec_t &wall) const;
+
+    void issue_stream_cmd(const size_t chan, const uhd::stream_cmd_t &cmd);
+    void produce(void);
+    bool produce_chan(rx_chan_t &chan, const uhd::time_spec_t &now, uhd::time_spec_t &next_due);
+    bool send_rx_error(rx_chan_t &chan, const uhd::rx_metadata_t::error_code_t code, const uint64_t tsf);
+    void consume(void);
+    bool consume_chan(tx_chan_t &chan, const uhd::time_spec_t &now, uhd::time_spec_t &next_due);
+    void post_async(const tx_chan_t &chan, const uhd::async_metadata_t::event_code_t code, const uint64_t tsf);
+
+    const double _tick_rate;
+    const size_t _recv_frame_size;
+    const size_t _num_recv_frames;
+    const size_t _send_frame_size;
+    const size_t _num_send_frames;
+    const bool _throttle;
+    uhd::time_spec_t _time_offset; //wall clock minus device time, under _mutex
+    std::vector<rx_chan_t> _rx_chans;
+    std::vector<tx_chan_t> _tx_chans;
+    boost::mutex _mutex;
+    boost::condition_variable _rx_cond;
+    boost::condition_variable _tx_cond;
+    boost::mutex _transport_setup_mutex;
+    typedef uhd::transport::bounded_buffer<uhd::async_metadata_t> async_md_type;
+    boost::shared_ptr<async_md_type> _async_md;
+    //the tasks use the members above, so they are declared last
+    uhd::task::sptr _producer_task;
+    uhd::task::sptr _consumer_task;
+};
+
+#endif /* INCLUDED_LOOPBACK_IMPL_HPP */
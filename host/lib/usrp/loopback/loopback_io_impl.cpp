@@ -0,0 +1,454 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "loopback_impl.hpp"
+#include "streamer_args.hpp"
+#include "../../transport/super_recv_packet_handler.hpp"
+#include "../../transport/super_send_packet_handler.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <algorithm>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+//! How long the tasks sleep when there is nothing to pace
+static const double IDLE_WAIT_TIME = 0.1;
+//! How often the tasks poll the rings when not paced by the sample rate
+static const double POLL_WAIT_TIME = 100e-6;
+//! Sequence numbers of CHDR packets
+static const size_t SEQ_NUM_MASK = 0xfff;
+
+static void wait_until(
+    boost::condition_variable &cond,
+    boost::mutex::scoped_lock &lock,
+    const time_spec_t &now,
+    const time_spec_t &when
+){
+    const double wait_time = std::max(0.0, (when - now).get_real_secs());
+    cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::microseconds(long(wait_time*1e6)));
+}
+
+static void check_channels(const std::vector<size_t> &channels, const size_t num_chans, const std::string &xx)
+{
+    for (size_t i = 0; i < channels.size(); i++) {
+        if (channels[i] >= num_chans) {
+            throw uhd::index_error(str(boost::format(
+                "loopback: %s channel %u out of range for %u channel(s)")
+                % xx % channels[i] % num_chans));
+        }
+    }
+}
+
+/***********************************************************************
+ * RX: the producer
+ **********************************************************************/
+void loopback_impl::issue_stream_cmd(const size_t index, const stream_cmd_t &cmd)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    rx_chan_t &chan = _rx_chans.at(index);
+    _rx_cond.notify_one();
+
+    if (cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS) {
+        chan.active = false;
+        return;
+    }
+
+    const time_spec_t now = time_spec_t::get_system_time();
+    uint64_t start_tsf;
+    if (cmd.stream_now) {
+        //round up to a whole packet, so that channels started by the same
+        //command line up even though they get the command one by one
+        const uint64_t packet_ticks = std::max<size_t>(chan.spp, 1) * chan.decim;
+        start_tsf = ((wall_to_tsf(now) + packet_ticks - 1) / packet_ticks) * packet_ticks;
+    } else {
+        start_tsf = uint64_t(std::max<long long>(0, cmd.time_spec.to_ticks(_tick_rate)));
+        if (_throttle and tsf_to_wall(start_tsf) < now) {
+            chan.active = false;
+            chan.late_pending = true;
+            return;
+        }
+    }
+
+    chan.next_tsf = start_tsf;
+    chan.continuous = (cmd.stream_mode == stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    chan.eob_at_end = (cmd.stream_mode == stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    chan.samps_left = cmd.num_samps;
+    chan.active = chan.continuous or chan.samps_left != 0;
+}
+
+bool loopback_impl::send_rx_error(rx_chan_t &chan, const rx_metadata_t::error_code_t code, const uint64_t tsf)
+{
+    managed_send_buffer::sptr buff = chan.ring->get_send_buff(0.0);
+    if (not buff) return false;
+
+    vrt::if_packet_info_t packet_info;
+    packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_ERROR;
+    packet_info.num_payload_words32 = 2;
+    packet_info.num_payload_bytes = packet_info.num_payload_words32*sizeof(uint32_t);
+    packet_info.packet_count = chan.seq & SEQ_NUM_MASK; //inline messages have no sequence number of their own
+    packet_info.sob = false;
+    packet_info.eob = true;
+    packet_info.has_sid = true;
+    packet_info.sid = 0;
+    packet_info.has_cid = false;
+    packet_info.has_tsi = false;
+    packet_info.has_tsf = true;
+    packet_info.tsf = tsf;
+    packet_info.has_tlr = false;
+
+    uint32_t *pkt = buff->cast<uint32_t *>();
+    vrt::chdr::if_hdr_pack_le(pkt, packet_info);
+    pkt[packet_info.num_header_words32 + 0] = uhd::htowx<uint32_t>(uint32_t(code));
+    pkt[packet_info.num_header_words32 + 1] = uhd::htowx<uint32_t>(uint32_t(chan.seq & SEQ_NUM_MASK));
+    buff->commit(packet_info.num_packet_words32*sizeof(uint32_t));
+    return true;
+}
+
+bool loopback_impl::produce_chan(rx_chan_t &chan, const time_spec_t &now, time_spec_t &next_due)
+{
+    if (chan.ring and chan.streamer.expired()) {
+        //the streamer is gone, so is the reader of the ring
+        chan.ring.reset();
+        chan.active = chan.late_pending = chan.overflow_pending = false;
+    }
+    if (not chan.ring) return false;
+
+    //inline messages go out first, as soon as the ring has room for them
+    if (chan.late_pending) {
+        if (not send_rx_error(chan, rx_metadata_t::ERROR_CODE_LATE_COMMAND, wall_to_tsf(now))) return false;
+        chan.late_pending = false;
+    }
+    if (chan.overflow_pending and send_rx_error(chan, rx_metadata_t::ERROR_CODE_OVERFLOW, chan.next_tsf)) {
+        chan.overflow_pending = false;
+    }
+    if (not chan.active) return false;
+
+    const size_t nsamps = chan.continuous ? chan.spp : size_t(std::min<uint64_t>(chan.spp, chan.samps_left));
+
+    //a packet is ready once its last sample has been taken
+    if (_throttle) {
+        const time_spec_t due = tsf_to_wall(chan.next_tsf + nsamps*chan.decim);
+        if (due > now) {
+            next_due = std::min(next_due, due);
+            return false;
+        }
+    }
+
+    managed_send_buffer::sptr buff = chan.ring->get_send_buff(0.0);
+    const bool last = not chan.continuous and nsamps == chan.samps_left;
+    if (buff) {
+        vrt::if_packet_info_t packet_info;
+        packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        packet_info.num_payload_bytes = nsamps*chan.bpi;
+        packet_info.num_payload_words32 = (packet_info.num_payload_bytes + sizeof(uint32_t) - 1)/sizeof(uint32_t);
+        packet_info.packet_count = chan.seq & SEQ_NUM_MASK;
+        packet_info.sob = false;
+        packet_info.eob = last and chan.eob_at_end;
+        packet_info.has_sid = true;
+        packet_info.sid = 0;
+        packet_info.has_cid = false;
+        packet_info.has_tsi = false;
+        packet_info.has_tsf = true;
+        packet_info.tsf = chan.next_tsf;
+        packet_info.has_tlr = false;
+        vrt::chdr::if_hdr_pack_le(buff->cast<uint32_t *>(), packet_info);
+        buff->commit(packet_info.num_packet_words32*sizeof(uint32_t));
+        chan.seq++;
+    } else if (_throttle) {
+        //the streamer fell behind: the samples are lost like on a radio
+        chan.overflow_pending = true;
+    } else {
+        //wait for the streamer to catch up
+        return false;
+    }
+
+    chan.next_tsf += nsamps*chan.decim;
+    if (not chan.continuous) {
+        chan.samps_left -= nsamps;
+        if (chan.samps_left == 0) chan.active = false;
+    }
+    return bool(buff);
+}
+
+void loopback_impl::produce(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    const time_spec_t now = time_spec_t::get_system_time();
+    time_spec_t next_due = now + time_spec_t(IDLE_WAIT_TIME);
+    bool progress = false, any_active = false;
+    for (size_t i = 0; i < _rx_chans.size(); i++) {
+        progress = produce_chan(_rx_chans[i], now, next_due) or progress;
+        any_active = any_active or _rx_chans[i].active or _rx_chans[i].overflow_pending or _rx_chans[i].late_pending;
+    }
+    if (progress) return;
+
+    //nothing to do right now: sleep until the next packet is due, or
+    //poll while a full ring or a pending message waits for the streamer
+    if (any_active and (not _throttle or next_due > now + time_spec_t(IDLE_WAIT_TIME / 2))) {
+        next_due = std::min(next_due, now + time_spec_t(POLL_WAIT_TIME));
+    }
+    wait_until(_rx_cond, lock, now, next_due);
+}
+
+/***********************************************************************
+ * TX: the consumer
+ **********************************************************************/
+void loopback_impl::post_async(const tx_chan_t &chan, const async_metadata_t::event_code_t code, const uint64_t tsf)
+{
+    async_metadata_t metadata;
+    metadata.channel = chan.stream_chan;
+    metadata.has_time_spec = true;
+    metadata.time_spec = time_spec_t::from_ticks(tsf, _tick_rate);
+    metadata.event_code = code;
+    std::fill(metadata.user_payload, metadata.user_payload + 4, 0);
+    _async_md->push_with_pop_on_full(metadata);
+}
+
+bool loopback_impl::consume_chan(tx_chan_t &chan, const time_spec_t &now, time_spec_t &next_due)
+{
+    if (chan.ring and chan.streamer.expired()) {
+        chan.held.reset();
+        chan.ring.reset();
+        chan.in_burst = false;
+    }
+    if (not chan.ring) return false;
+
+    if (not chan.held) {
+        chan.held = chan.ring->get_recv_buff(0.0);
+        if (not chan.held) {
+            //the samples did not come in time
+            if (_throttle and chan.in_burst and not chan.underflow_reported and tsf_to_wall(chan.next_tsf) < now) {
+                post_async(chan, async_metadata_t::EVENT_CODE_UNDERFLOW, chan.next_tsf);
+                chan.underflow_reported = true;
+            }
+            return false;
+        }
+
+        vrt::if_packet_info_t &info = chan.held_info;
+        info.num_packet_words32 = chan.held->size()/sizeof(uint32_t);
+        try {
+            vrt::chdr::if_hdr_unpack_le(chan.held->cast<const uint32_t *>(), info);
+        }
+        catch(const std::exception &ex) {
+            UHD_MSG(error) << "loopback: error unpacking TX packet: " << ex.what() << std::endl;
+            chan.held.reset();
+            return true;
+        }
+        if (info.packet_count != (chan.seq & SEQ_NUM_MASK)) {
+            post_async(chan, chan.in_burst ? async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST
+                : async_metadata_t::EVENT_CODE_SEQ_ERROR, chan.next_tsf);
+        }
+        chan.seq = info.packet_count + 1;
+
+        //start of a burst, or the first packet after an underflow
+        if (not chan.in_burst or chan.underflow_reported) {
+            uint64_t start_tsf = _throttle ? wall_to_tsf(now) : chan.next_tsf;
+            if (info.has_tsf and not chan.in_burst) {
+                if (_throttle and tsf_to_wall(info.tsf) < now) {
+                    post_async(chan, async_metadata_t::EVENT_CODE_TIME_ERROR, info.tsf);
+                } else {
+                    start_tsf = info.tsf;
+                }
+            }
+            chan.next_tsf = start_tsf;
+            chan.in_burst = true;
+            chan.underflow_reported = false;
+        }
+    }
+
+    //hold the packet until the radio would have sent its first sample
+    if (_throttle) {
+        const time_spec_t due = tsf_to_wall(chan.next_tsf);
+        if (due > now) {
+            next_due = std::min(next_due, due);
+            return false;
+        }
+    }
+
+    const size_t nsamps = chan.held_info.num_payload_bytes/chan.bpi;
+    chan.next_tsf += nsamps*chan.decim;
+    if (chan.held_info.eob) {
+        post_async(chan, async_metadata_t::EVENT_CODE_BURST_ACK, chan.next_tsf);
+        chan.in_burst = false;
+    }
+    chan.held.reset();
+    return true;
+}
+
+void loopback_impl::consume(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    const time_spec_t now = time_spec_t::get_system_time();
+    time_spec_t next_due = now + time_spec_t(IDLE_WAIT_TIME);
+    bool progress = false, any_ring = false;
+    for (size_t i = 0; i < _tx_chans.size(); i++) {
+        progress = consume_chan(_tx_chans[i], now, next_due) or progress;
+        any_ring = any_ring or bool(_tx_chans[i].ring);
+    }
+    if (progress) return;
+
+    //the rings have no way to signal new packets, so poll them
+    if (any_ring) {
+        next_due = std::min(next_due, now + time_spec_t(POLL_WAIT_TIME));
+    }
+    wait_until(_tx_cond, lock, now, next_due);
+}
+
+bool loopback_impl::recv_async_msg(async_metadata_t &async_metadata, double timeout)
+{
+    return _async_md->pop_with_timed_wait(async_metadata, timeout);
+}
+
+/***********************************************************************
+ * Receive streamer
+ **********************************************************************/
+rx_streamer::sptr loopback_impl::get_rx_stream(const uhd::stream_args_t &args_)
+{
+    boost::mutex::scoped_lock setup_lock(_transport_setup_mutex);
+
+    stream_args_t args = args_;
+
+    //setup defaults for unspecified values
+    if (args.otw_format.empty()) args.otw_format = "sc16";
+    args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    check_channels(args.channels, _rx_chans.size(), "RX");
+    const usrp::streamer_args_t streamer_args(args);
+
+    const size_t bpi = convert::get_bytes_per_item(args.otw_format);
+    const size_t bpp = _recv_frame_size - LOOPBACK_HDR_SIZE;
+    const size_t spp = std::min(streamer_args.get_spp(bpp/bpi), bpp/bpi);
+    if (spp == 0) {
+        throw uhd::value_error("loopback: recv_frame_size is too small for one sample");
+    }
+
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+        boost::make_shared<sph::recv_packet_streamer>(spp);
+    my_streamer->resize(args.channels.size());
+    my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_cached_le);
+
+    //set the converter
+    uhd::convert::id_type id;
+    id.input_format = args.otw_format + "_item32_le";
+    id.num_inputs = 1;
+    id.output_format = args.cpu_format;
+    id.num_outputs = 1;
+    my_streamer->set_converter(id);
+    my_streamer->set_tick_rate(_tick_rate);
+
+    for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
+    {
+        const size_t index = args.channels[stream_i];
+        loopback_ring::sptr ring = loopback_ring::make(_num_recv_frames, _recv_frame_size);
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            rx_chan_t &chan = _rx_chans[index];
+            chan.ring = ring;
+            chan.streamer = my_streamer;
+            chan.active = chan.overflow_pending = chan.late_pending = false;
+            chan.seq = 0;
+            chan.bpi = bpi;
+            chan.spp = spp;
+            my_streamer->set_samp_rate(_tick_rate/chan.decim);
+        }
+        my_streamer->set_xport_chan(stream_i, ring);
+        my_streamer->set_issue_stream_cmd(stream_i, boost::bind(
+            &loopback_impl::issue_stream_cmd, this, index, _1
+        ));
+    }
+    //optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(streamer_args.get_convert_threads());
+    //keep large receive buffers out of the caches, see set_nontemporal_stores()
+    my_streamer->set_nontemporal_stores(streamer_args.get_nontemporal_stores());
+    //report the sample power in the metadata, see set_power_metadata()
+    my_streamer->set_power_metadata(streamer_args.get_power_meta());
+
+    return my_streamer;
+}
+
+/***********************************************************************
+ * Transmit streamer
+ **********************************************************************/
+tx_streamer::sptr loopback_impl::get_tx_stream(const uhd::stream_args_t &args_)
+{
+    boost::mutex::scoped_lock setup_lock(_transport_setup_mutex);
+
+    stream_args_t args = args_;
+
+    //setup defaults for unspecified values
+    if (args.otw_format.empty()) args.otw_format = "sc16";
+    args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    check_channels(args.channels, _tx_chans.size(), "TX");
+    const usrp::streamer_args_t streamer_args(args);
+
+    const size_t bpi = convert::get_bytes_per_item(args.otw_format);
+    const size_t bpp = _send_frame_size - LOOPBACK_HDR_SIZE;
+    const size_t spp = std::min(streamer_args.get_spp(bpp/bpi), bpp/bpi);
+    if (spp == 0) {
+        throw uhd::value_error("loopback: send_frame_size is too small for one sample");
+    }
+
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer =
+        boost::make_shared<sph::send_packet_streamer>(spp);
+    my_streamer->resize(args.channels.size());
+    my_streamer->set_vrt_packer(&vrt::chdr::if_hdr_pack_le);
+
+    //set the converter
+    uhd::convert::id_type id;
+    id.input_format = args.cpu_format;
+    id.num_inputs = 1;
+    id.output_format = args.otw_format + "_item32_le";
+    id.num_outputs = 1;
+    my_streamer->set_converter(id);
+    my_streamer->set_tick_rate(_tick_rate);
+
+    for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
+    {
+        const size_t index = args.channels[stream_i];
+        loopback_ring::sptr ring = loopback_ring::make(_num_send_frames, _send_frame_size);
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            tx_chan_t &chan = _tx_chans[index];
+            chan.held.reset();
+            chan.ring = ring;
+            chan.streamer = my_streamer;
+            chan.stream_chan = stream_i;
+            chan.in_burst = chan.underflow_reported = false;
+            chan.seq = 0;
+            chan.bpi = bpi;
+            my_streamer->set_samp_rate(_tick_rate/chan.decim);
+        }
+        my_streamer->set_xport_chan(stream_i, ring);
+        my_streamer->set_async_receiver(boost::bind(
+            &async_md_type::pop_with_timed_wait, _async_md, _1, _2
+        ));
+        my_streamer->set_xport_chan_sid(stream_i, true, uint32_t(index));
+        my_streamer->set_enable_trailer(false);
+    }
+    //optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(streamer_args.get_convert_threads());
+    //optionally send on a separate thread while the next packets are converted
+    my_streamer->set_pipeline_depth(streamer_args.get_pipeline_depth());
+
+    return my_streamer;
+}
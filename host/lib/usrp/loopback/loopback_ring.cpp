@@ -0,0 +1,164 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "loopback_ring.hpp"
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <boost/make_shared.hpp>
+#include <vector>
+#include <cstring>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Managed buffers
+ **********************************************************************/
+class loopback_mrb : public managed_recv_buffer
+{
+public:
+    loopback_mrb(bounded_buffer<size_t> &free_frames, const size_t index):
+        _free_frames(free_frames), _index(index) {}
+
+    void release(void)
+    {
+        _free_frames.push_with_haste(_index);
+    }
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len)
+    {
+        return make(this, mem, len);
+    }
+
+private:
+    bounded_buffer<size_t> &_free_frames;
+    const size_t _index;
+};
+
+class loopback_msb : public managed_send_buffer
+{
+public:
+    loopback_msb(
+        bounded_buffer<size_t> &free_frames,
+        bounded_buffer<size_t> &full_frames,
+        size_t &committed_len,
+        const size_t index
+    ):
+        _free_frames(free_frames), _full_frames(full_frames),
+        _committed_len(committed_len), _index(index) {}
+
+    void release(void)
+    {
+        //a zero length commit drops the frame
+        if (size() == 0) {
+            _free_frames.push_with_haste(_index);
+            return;
+        }
+        _committed_len = size();
+        _full_frames.push_with_haste(_index);
+    }
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len)
+    {
+        return make(this, mem, len);
+    }
+
+private:
+    bounded_buffer<size_t> &_free_frames;
+    bounded_buffer<size_t> &_full_frames;
+    size_t &_committed_len;
+    const size_t _index;
+};
+
+/***********************************************************************
+ * Ring implementation
+ **********************************************************************/
+class loopback_ring_impl : public loopback_ring
+{
+public:
+    loopback_ring_impl(const size_t num_frames, const size_t frame_size):
+        _num_frames(num_frames),
+        _frame_size(frame_size),
+        _pool(buffer_pool::make(num_frames, frame_size)),
+        _free_frames(num_frames),
+        _full_frames(num_frames),
+        _committed_lens(num_frames, 0)
+    {
+        for (size_t i = 0; i < _num_frames; i++) {
+            //start from zeroed payloads so the data is deterministic
+            std::memset(_pool->at(i), 0, _frame_size);
+            _mrbs.push_back(boost::make_shared<loopback_mrb>(boost::ref(_free_frames), i));
+            _msbs.push_back(boost::make_shared<loopback_msb>(
+                boost::ref(_free_frames), boost::ref(_full_frames), boost::ref(_committed_lens[i]), i
+            ));
+            _free_frames.push_with_haste(i);
+        }
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double timeout)
+    {
+        size_t index;
+        if (not _full_frames.pop_with_timed_wait(index, timeout)) {
+            return managed_recv_buffer::sptr();
+        }
+        return _mrbs[index]->get_new(_pool->at(index), _committed_lens[index]);
+    }
+
+    size_t get_num_recv_frames(void) const
+    {
+        return _num_frames;
+    }
+
+    size_t get_recv_frame_size(void) const
+    {
+        return _frame_size;
+    }
+
+    managed_send_buffer::sptr get_send_buff(double timeout)
+    {
+        size_t index;
+        if (not _free_frames.pop_with_timed_wait(index, timeout)) {
+            return managed_send_buffer::sptr();
+        }
+        return _msbs[index]->get_new(_pool->at(index), _frame_size);
+    }
+
+    size_t get_num_send_frames(void) const
+    {
+        return _num_frames;
+    }
+
+    size_t get_send_frame_size(void) const
+    {
+        return _frame_size;
+    }
+
+private:
+    const size_t _num_frames;
+    const size_t _frame_size;
+    buffer_pool::sptr _pool;
+    bounded_buffer<size_t> _free_frames;
+    bounded_buffer<size_t> _full_frames;
+    std::vector<size_t> _committed_lens;
+    std::vector<boost::shared_ptr<loopback_mrb> > _mrbs;
+    std::vector<boost::shared_ptr<loopback_msb> > _msbs;
+};
+
+loopback_ring::sptr loopback_ring::make(const size_t num_frames, const size_t frame_size)
+{
+    return sptr(new loopback_ring_impl(num_frames, frame_size));
+}
@@ -0,0 +1,46 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LOOPBACK_RING_HPP
+#define INCLUDED_LOOPBACK_RING_HPP
+
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/shared_ptr.hpp>
+
+/*!
+ * An in-memory transport: a ring of frames shared by a producer and a
+ * consumer in the same process.
+ *
+ * A frame from get_send_buff() is queued for get_recv_buff() when it
+ * is released, and goes back to the free frames when the receive
+ * buffer is released. A send buffer committed with zero bytes is
+ * dropped instead of queued.
+ */
+class loopback_ring : public uhd::transport::zero_copy_if
+{
+public:
+    typedef boost::shared_ptr<loopback_ring> sptr;
+
+    /*!
+     * Make a new ring.
+     * \param num_frames the number of frames in the ring
+     * \param frame_size the size of each frame in bytes
+     */
+    static sptr make(const size_t num_frames, const size_t frame_size);
+};
+
+#endif /* INCLUDED_LOOPBACK_RING_HPP */
@@ -30,11 +30,13 @@
 #include "legacy_compat.hpp"
 #include <boost/assign/list_of.hpp>
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
 #include <cmath>
+#include <map>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -383,6 +385,90 @@ static double derive_freq_from_xx_subdev_and_dsp(
     return actual_rf_freq - actual_dsp_freq * xx_sign;
 }
 
+/*!
+ * A table of frequencies to hop through, planned in one go:
+ * consecutive frequencies that fit in the RF bandwidth around one LO
+ * share that LO, so hopping between them only sets the DSP frequency.
+ */
+struct freq_hop_plan_t{
+    std::vector<double> target_freqs;
+    std::vector<double> rf_freqs;
+    freq_range_t tune_range;
+    freq_range_t dsp_range;
+    //the LO requested by the last hop, and where the frontend tuned it
+    double rf_freq;
+    double actual_rf_freq;
+};
+
+static freq_hop_plan_t plan_xx_freq_hops(
+    property_tree::sptr dsp_subtree,
+    property_tree::sptr rf_fe_subtree,
+    const std::vector<double> &freqs
+){
+    const freq_range_t rf_range = rf_fe_subtree->access<meta_range_t>("freq/range").get();
+    const double bw = rf_fe_subtree->access<double>("bandwidth/value").get();
+
+    freq_hop_plan_t plan;
+    plan.dsp_range = dsp_subtree->access<meta_range_t>("freq/range").get();
+    plan.tune_range = make_overall_tune_range(rf_range, plan.dsp_range, bw);
+    plan.actual_rf_freq = rf_fe_subtree->access<double>("freq/value").get();
+    plan.rf_freq = plan.actual_rf_freq;
+
+    //without a bandwidth, only the CORDIC limits the DSP frequency
+    const double half_bw = (bw > 0.0)? bw/2 : plan.dsp_range.stop();
+
+    double rf_freq = plan.rf_freq;
+    BOOST_FOREACH(const double freq, freqs){
+        const double target_freq = plan.tune_range.clip(freq);
+        if (std::abs(target_freq - rf_freq) > half_bw){
+            rf_freq = rf_range.clip(target_freq);
+        }
+        plan.target_freqs.push_back(target_freq);
+        plan.rf_freqs.push_back(rf_freq);
+    }
+    return plan;
+}
+
+static tune_result_t hop_xx_subdev_and_dsp(
+    const double xx_sign,
+    property_tree::sptr dsp_subtree,
+    property_tree::sptr rf_fe_subtree,
+    freq_hop_plan_t &plan,
+    const size_t index
+){
+    if (index >= plan.target_freqs.size()) throw uhd::index_error(str(
+        boost::format("Frequency hop %u out of range (table of %u)")
+        % index % plan.target_freqs.size()
+    ));
+    const double target_freq = plan.target_freqs[index];
+    const double rf_freq = plan.rf_freqs[index];
+
+    //the LO is where the plan needs it: only the DSP moves
+    const double actual_rf_freq = rf_fe_subtree->access<double>("freq/value").get();
+    if (rf_freq == plan.rf_freq and actual_rf_freq == plan.actual_rf_freq){
+        tune_result_t tune_result;
+        tune_result.clipped_rf_freq = target_freq;
+        tune_result.target_rf_freq = rf_freq;
+        tune_result.actual_rf_freq = actual_rf_freq;
+        tune_result.target_dsp_freq = plan.dsp_range.clip((actual_rf_freq - target_freq)*xx_sign);
+        property<double> &dsp_freq = dsp_subtree->access<double>("freq/value");
+        dsp_freq.set(tune_result.target_dsp_freq);
+        tune_result.actual_dsp_freq = dsp_freq.get();
+        return tune_result;
+    }
+
+    //otherwise tune the LO, and the DSP relative to it
+    tune_request_t tune_request(target_freq);
+    tune_request.rf_freq_policy = tune_request_t::POLICY_MANUAL;
+    tune_request.rf_freq = rf_freq;
+    const tune_result_t tune_result = tune_xx_subdev_and_dsp(
+        xx_sign, dsp_subtree, rf_fe_subtree, tune_request
+    );
+    plan.rf_freq = rf_freq;
+    plan.actual_rf_freq = tune_result.actual_rf_freq;
+    return tune_result;
+}
+
 /***********************************************************************
  * Multi USRP Implementation
  **********************************************************************/
@@ -532,6 +618,13 @@ public:
         return _tree->access<time_spec_t>(mb_root(mboard) / "time/now").get();
     }
 
+    time_spec_t get_time_estimate(size_t mboard = 0){
+        if (not _tree->exists(mb_root(mboard) / "time/estimate")) {
+            return get_time_now(mboard);
+        }
+        return _tree->access<time_spec_t>(mb_root(mboard) / "time/estimate").get();
+    }
+
     time_spec_t get_time_last_pps(size_t mboard = 0){
         return _tree->access<time_spec_t>(mb_root(mboard) / "time/pps").get();
     }
@@ -749,6 +842,19 @@ public:
         return _tree->list(mb_root(mboard) / "sensors");
     }
 
+    dict<std::string, sensor_value_t> get_all_sensors(size_t mboard){
+        dict<std::string, sensor_value_t> sensors;
+        if (_tree->exists(mb_root(mboard) / "sensor_snapshot")) {
+            sensors = _tree->access<dict<std::string, sensor_value_t> >(mb_root(mboard) / "sensor_snapshot").get();
+        }
+        BOOST_FOREACH(const std::string &name, get_mboard_sensor_names(mboard)) {
+            if (not sensors.has_key(name)) {
+                sensors.set(name, get_mboard_sensor(name, mboard));
+            }
+        }
+        return sensors;
+    }
+
     void set_user_register(const uint8_t addr, const uint32_t data, size_t mboard){
         if (mboard != ALL_MBOARDS){
             typedef std::pair<uint8_t, uint32_t> user_reg_t;
@@ -854,6 +960,31 @@ public:
         return result;
     }
 
+    std::vector<tune_result_t> set_rx_freq_multi(
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const time_spec_t &time_spec
+    ){
+        return set_xx_freq_multi(true, tune_requests, chans, time_spec);
+    }
+
+    void set_rx_freq_hop_table(const std::vector<double> &freqs, size_t chan){
+        _rx_freq_hops[chan] = plan_xx_freq_hops(
+                _tree->subtree(rx_dsp_root(chan)),
+                _tree->subtree(rx_rf_fe_root(chan)),
+                freqs);
+    }
+
+    tune_result_t rx_freq_hop(size_t index, size_t chan){
+        if (_rx_freq_hops.count(chan) == 0) throw uhd::runtime_error(str(
+            boost::format("No RX frequency hop table on channel %u") % chan
+        ));
+        return hop_xx_subdev_and_dsp(RX_SIGN,
+                _tree->subtree(rx_dsp_root(chan)),
+                _tree->subtree(rx_rf_fe_root(chan)),
+                _rx_freq_hops[chan], index);
+    }
+
     double get_rx_freq(size_t chan){
         return derive_freq_from_xx_subdev_and_dsp(RX_SIGN, _tree->subtree(rx_dsp_root(chan)), _tree->subtree(rx_rf_fe_root(chan)));
     }
@@ -1394,6 +1525,31 @@ public:
         return result;
     }
 
+    std::vector<tune_result_t> set_tx_freq_multi(
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const time_spec_t &time_spec
+    ){
+        return set_xx_freq_multi(false, tune_requests, chans, time_spec);
+    }
+
+    void set_tx_freq_hop_table(const std::vector<double> &freqs, size_t chan){
+        _tx_freq_hops[chan] = plan_xx_freq_hops(
+                _tree->subtree(tx_dsp_root(chan)),
+                _tree->subtree(tx_rf_fe_root(chan)),
+                freqs);
+    }
+
+    tune_result_t tx_freq_hop(size_t index, size_t chan){
+        if (_tx_freq_hops.count(chan) == 0) throw uhd::runtime_error(str(
+            boost::format("No TX frequency hop table on channel %u") % chan
+        ));
+        return hop_xx_subdev_and_dsp(TX_SIGN,
+                _tree->subtree(tx_dsp_root(chan)),
+                _tree->subtree(tx_rf_fe_root(chan)),
+                _tx_freq_hops[chan], index);
+    }
+
     double get_tx_freq(size_t chan){
         return derive_freq_from_xx_subdev_and_dsp(TX_SIGN, _tree->subtree(tx_dsp_root(chan)), _tree->subtree(tx_rf_fe_root(chan)));
     }
@@ -1714,6 +1870,8 @@ private:
     device::sptr _dev;
     property_tree::sptr _tree;
     bool _is_device3;
+    std::map<size_t, freq_hop_plan_t> _rx_freq_hops;
+    std::map<size_t, freq_hop_plan_t> _tx_freq_hops;
     uhd::rfnoc::legacy_compat::sptr _legacy_compat;
 
     struct mboard_chan_pair{
@@ -1721,6 +1879,93 @@ private:
         mboard_chan_pair(void): mboard(0), chan(0){}
     };
 
+    /*******************************************************************
+     * Tune many channels: one thread per motherboard, batched writes
+     ******************************************************************/
+    std::vector<tune_result_t> set_xx_freq_multi(
+        const bool is_rx,
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const time_spec_t &time_spec
+    ){
+        if (tune_requests.size() != 1 and tune_requests.size() != chans.size()){
+            throw uhd::value_error(str(boost::format(
+                "multi_usrp: %u tune requests for %u channels"
+            ) % tune_requests.size() % chans.size()));
+        }
+
+        //the indexes into chans of each motherboard
+        std::map<size_t, std::vector<size_t> > mboard_indexes;
+        for (size_t i = 0; i < chans.size(); i++){
+            const mboard_chan_pair mcp = is_rx? rx_chan_to_mcp(chans[i]) : tx_chan_to_mcp(chans[i]);
+            mboard_indexes[mcp.mboard].push_back(i);
+        }
+
+        //the command time must be set before the batch begins
+        typedef std::pair<const size_t, std::vector<size_t> > mboard_indexes_pair;
+        const bool timed = time_spec != time_spec_t(0.0);
+        if (timed){
+            BOOST_FOREACH(const mboard_indexes_pair &p, mboard_indexes){
+                set_command_time(time_spec, p.first);
+            }
+        }
+
+        std::vector<tune_result_t> results(chans.size());
+        std::vector<std::string> errors(mboard_indexes.size());
+        _tree->begin_batch();
+        if (mboard_indexes.size() == 1){
+            tune_xx_chans(is_rx, tune_requests, chans, mboard_indexes.begin()->second, results, errors[0]);
+        }
+        else{
+            boost::thread_group tune_threads;
+            size_t n = 0;
+            BOOST_FOREACH(const mboard_indexes_pair &p, mboard_indexes){
+                tune_threads.create_thread(boost::bind(
+                    &multi_usrp_impl::tune_xx_chans, this, is_rx,
+                    boost::cref(tune_requests), boost::cref(chans), boost::cref(p.second),
+                    boost::ref(results), boost::ref(errors[n++])
+                ));
+            }
+            tune_threads.join_all();
+        }
+
+        try{
+            _tree->commit_batch();
+        }
+        catch(const std::exception &e){
+            errors.push_back(e.what());
+        }
+        if (timed){
+            BOOST_FOREACH(const mboard_indexes_pair &p, mboard_indexes){
+                clear_command_time(p.first);
+            }
+        }
+        BOOST_FOREACH(const std::string &error, errors){
+            if (not error.empty()) throw uhd::runtime_error("multi_usrp: tuning failed: " + error);
+        }
+        return results;
+    }
+
+    //! Tune the channels chans[i] for each i of indexes (runs on a tune thread)
+    void tune_xx_chans(
+        const bool is_rx,
+        const std::vector<tune_request_t> &tune_requests,
+        const std::vector<size_t> &chans,
+        const std::vector<size_t> &indexes,
+        std::vector<tune_result_t> &results,
+        std::string &error
+    ){
+        try{
+            BOOST_FOREACH(const size_t i, indexes){
+                const tune_request_t &tune_request = tune_requests[(tune_requests.size() == 1)? 0 : i];
+                results[i] = is_rx? set_rx_freq(tune_request, chans[i]) : set_tx_freq(tune_request, chans[i]);
+            }
+        }
+        catch(const std::exception &e){
+            error = e.what();
+        }
+    }
+
     mboard_chan_pair rx_chan_to_mcp(size_t chan){
         mboard_chan_pair mcp;
         mcp.chan = chan;
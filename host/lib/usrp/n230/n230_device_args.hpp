@@ -85,22 +85,11 @@ public:
 private:
     virtual void _parse(const device_addr_t& dev_args) {
         //Extract parameters from dev_args
-        if (dev_args.has_key(_master_clock_rate.key()))
-            _master_clock_rate.parse(dev_args[_master_clock_rate.key()]);
-        if (dev_args.has_key(_send_frame_size.key()))
-            _send_frame_size.parse(dev_args[_send_frame_size.key()]);
-        if (dev_args.has_key(_recv_frame_size.key()))
-            _recv_frame_size.parse(dev_args[_recv_frame_size.key()]);
-        if (dev_args.has_key(_num_send_frames.key()))
-            _num_send_frames.parse(dev_args[_num_send_frames.key()]);
-        if (dev_args.has_key(_num_recv_frames.key()))
-            _num_recv_frames.parse(dev_args[_num_recv_frames.key()]);
-        if (dev_args.has_key(_send_buff_size.key()))
-            _send_buff_size.parse(dev_args[_send_buff_size.key()]);
-        if (dev_args.has_key(_recv_buff_size.key()))
-            _recv_buff_size.parse(dev_args[_recv_buff_size.key()]);
-        if (dev_args.has_key(_safe_mode.key()))
-            _safe_mode.parse(dev_args[_safe_mode.key()]);
+        const std::vector<generic_arg*> schema = boost::assign::list_of<generic_arg*>
+            (&_master_clock_rate)(&_send_frame_size)(&_recv_frame_size)
+            (&_num_send_frames)(&_num_recv_frames)
+            (&_send_buff_size)(&_recv_buff_size)(&_safe_mode);
+        _parse_args(dev_args, schema);
         if (dev_args.has_key(_loopback_mode.key()))
             _loopback_mode.parse(dev_args[_loopback_mode.key()], false /* assert invalid */);
 
@@ -24,6 +24,7 @@
 #include <uhd/transport/udp_zero_copy.hpp>
 #include <uhd/usrp/subdev_spec.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/host_check.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/types/sensors.hpp>
@@ -226,6 +227,20 @@ n230_impl::n230_impl(const uhd::device_addr_t& dev_addr)
 
     //Initialize all subsystems
     _resource_mgr = boost::make_shared<n230_resource_manager>(ip_addrs, _dev_args.get_safe_mode());
+
+    //Check the host settings that streaming at full rate needs
+    if (dev_addr.get("host_check", "1") != "0") {
+        BOOST_FOREACH(const std::string &ip_addr, ip_addrs) {
+            const host_check::report_t report = host_check::check(
+                ip_addr, _dev_args.get_recv_frame_size(), _dev_args.get_recv_buff_size(), 0);
+            if (report.num_deficits() > 0) {
+                UHD_MSG(warning) << report.to_pp_string()
+                    << "Run uhd_host_check for details, or set host_check=0 to skip this check." << std::endl;
+            } else {
+                UHD_LOG << report.to_pp_string();
+            }
+        }
+    }
     _stream_mgr = boost::make_shared<n230_stream_manager>(_dev_args, _resource_mgr, _tree);
 
     //Build property tree
@@ -442,6 +457,8 @@ void n230_impl::_initialize_property_tree(const fs_path& mb_path)
             _tree->create<sensor_value_t>(mb_path / "sensors" / name)
                 .set_publisher(boost::bind(&gps_ctrl::get_sensor, gps_ctrl, name));
         }
+        _tree->create<uhd::dict<std::string, sensor_value_t> >(mb_path / "sensor_snapshot")
+            .set_publisher(boost::bind(&gps_ctrl::get_all_sensors, gps_ctrl));
     }
 }
 
@@ -20,6 +20,7 @@
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "async_packet_handler.hpp"
+#include "streamer_args.hpp"
 #include <uhd/transport/bounded_buffer.hpp>
 #include <boost/bind.hpp>
 #include <uhd/utils/tasks.hpp>
@@ -70,6 +71,7 @@ rx_streamer::sptr n230_stream_manager::get_rx_stream(const uhd::stream_args_t &a
     //setup defaults for unspecified values
     if (args.otw_format.empty()) args.otw_format = "sc16";
     args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    const streamer_args_t streamer_args(args);
 
     boost::shared_ptr<sph::recv_packet_streamer> my_streamer;
     for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
@@ -92,7 +94,7 @@ rx_streamer::sptr n230_stream_manager::get_rx_stream(const uhd::stream_args_t &a
 
         transport::udp_zero_copy::buff_params buff_params_out;
         sid_t sid;
-        zero_copy_if::sptr xport = _resource_mgr->create_transport(
+        zero_copy_if::sptr xport = _get_data_xport(
             RX_DATA, chan, device_addr, sid, buff_params_out);
 
         //calculate packet size
@@ -104,7 +106,7 @@ rx_streamer::sptr n230_stream_manager::get_rx_stream(const uhd::stream_args_t &a
         ;
         const size_t bpp = xport->get_recv_frame_size() - hdr_size;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-        size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+        size_t spp = streamer_args.get_spp(bpp/bpi);
         spp = std::min<size_t>(N230_TX_MAX_SPP, spp); //FPGA FIFO maximum for framing at full rate
 
         //make the new streamer given the samples per packet
@@ -194,6 +196,7 @@ tx_streamer::sptr n230_stream_manager::get_tx_stream(const uhd::stream_args_t &a
     }
     args.otw_format = "sc16";
     args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    const streamer_args_t streamer_args(args);
 
     //shared async queue for all channels in streamer
     boost::shared_ptr<async_md_queue_t> async_md(new async_md_queue_t(N230_TX_MAX_ASYNC_MESSAGES));
@@ -219,7 +222,7 @@ tx_streamer::sptr n230_stream_manager::get_tx_stream(const uhd::stream_args_t &a
 
         transport::udp_zero_copy::buff_params buff_params_out;
         sid_t sid;
-        zero_copy_if::sptr xport = _resource_mgr->create_transport(
+        zero_copy_if::sptr xport = _get_data_xport(
             TX_DATA, chan, device_addr, sid, buff_params_out);
 
         //calculate packet size
@@ -232,7 +235,7 @@ tx_streamer::sptr n230_stream_manager::get_tx_stream(const uhd::stream_args_t &a
         ;
         const size_t bpp = xport->get_send_frame_size() - hdr_size;
         const size_t bpi = convert::get_bytes_per_item(args.otw_format);
-        const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+        const size_t spp = streamer_args.get_spp(bpp/bpi);
 
         //make the new streamer given the samples per packet
         if (not my_streamer) my_streamer = boost::make_shared<sph::send_packet_streamer>(spp);
@@ -267,7 +270,7 @@ tx_streamer::sptr n230_stream_manager::get_tx_stream(const uhd::stream_args_t &a
         tick_rate_retriever_t get_tick_rate_fn = boost::bind(&n230_stream_manager::_get_tick_rate, this);
         task::sptr task = task::make(
             boost::bind(&n230_stream_manager::_handle_tx_async_msgs,
-                fc_cache, xport, get_tick_rate_fn));
+                fc_cache, xport, get_tick_rate_fn), "async", "tx async messages");
 
         //Give the streamer a functor to get the send buffer
         //get_tx_buff_with_flowctrl is static so bind has no lifetime issues
@@ -304,6 +307,53 @@ tx_streamer::sptr n230_stream_manager::get_tx_stream(const uhd::stream_args_t &a
     return my_streamer;
 }
 
+/***********************************************************************
+ * Data transport cache
+ **********************************************************************/
+zero_copy_if::sptr n230_stream_manager::_get_data_xport(
+    const n230_data_dir_t direction,
+    const size_t chan,
+    const device_addr_t& hints,
+    sid_t& sid,
+    transport::udp_zero_copy::buff_params& buff_params_out)
+{
+    static const char* XPORT_HINT_KEYS[] = {
+        "recv_buff_size", "recv_frame_size", "num_recv_frames",
+        "send_buff_size", "send_frame_size", "num_send_frames"
+    };
+
+    data_xport_cache_t& cache =
+        (direction == RX_DATA) ? _rx_xport_cache[chan] : _tx_xport_cache[chan];
+    const bool chan_in_use = (direction == RX_DATA) ?
+        bool(_rx_streamers[chan].lock()) : bool(_tx_streamers[chan].lock());
+
+    //A transport can only be reused once the streamer that owned it is gone
+    //and if it was created with the same buffer parameters. Its socket stays
+    //bound and the dispatcher still points at it, so nothing has to be
+    //reprogrammed in the FPGA.
+    bool reuse = cache.xport and not chan_in_use;
+    for (size_t i = 0; reuse and i < sizeof(XPORT_HINT_KEYS)/sizeof(XPORT_HINT_KEYS[0]); i++) {
+        const std::string key(XPORT_HINT_KEYS[i]);
+        reuse = (hints.get(key, "") == cache.hints.get(key, ""));
+    }
+
+    if (reuse) {
+        //Drop anything the previous streamer left behind (late data packets
+        //or flow control responses) so it is not mistaken for fresh input
+        while (cache.xport->get_recv_buff(0.0)) {}
+        UHD_LOG << "n230_stream_manager: reusing data transport for channel " << chan << std::endl;
+    } else {
+        cache.xport.reset(); //release the old socket before binding a new one
+        cache.xport = _resource_mgr->create_transport(
+            direction, chan, hints, cache.sid, cache.buff_params);
+        cache.hints = hints;
+    }
+
+    sid = cache.sid;
+    buff_params_out = cache.buff_params;
+    return cache.xport;
+}
+
 /***********************************************************************
  * Async Message Receiver
  **********************************************************************/
@@ -91,8 +91,24 @@ private:
         boost::shared_ptr<async_md_queue_t> old_async_queue;
     };
 
+    //! A data transport kept alive across streamer lifetimes
+    struct data_xport_cache_t
+    {
+        device_addr_t                           hints;
+        transport::zero_copy_if::sptr           xport;
+        sid_t                                   sid;
+        transport::udp_zero_copy::buff_params   buff_params;
+    };
+
     typedef boost::function<double(void)> tick_rate_retriever_t;
 
+    transport::zero_copy_if::sptr _get_data_xport(
+        const n230_data_dir_t direction,
+        const size_t chan,
+        const device_addr_t& hints,
+        sid_t& sid,
+        transport::udp_zero_copy::buff_params& buff_params_out);
+
     void _handle_overflow(const size_t i);
 
     double _get_tick_rate();
@@ -142,6 +158,8 @@ private:
     boost::weak_ptr<uhd::rx_streamer>       _rx_streamers[fpga::NUM_RADIOS];
     stream_args_t                           _tx_stream_cached_args[fpga::NUM_RADIOS];
     stream_args_t                           _rx_stream_cached_args[fpga::NUM_RADIOS];
+    data_xport_cache_t                      _tx_xport_cache[fpga::NUM_RADIOS];
+    data_xport_cache_t                      _rx_xport_cache[fpga::NUM_RADIOS];
 
     static const uint32_t HW_SEQ_NUM_MASK    = 0xFFF;
 };
@@ -0,0 +1,404 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "replay_capture.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/flight_recorder.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace ip = boost::interprocess;
+namespace fr = uhd::flight_recorder;
+
+static const uint32_t PCAP_MAGIC_USEC    = 0xa1b2c3d4;
+static const uint32_t PCAP_MAGIC_NSEC    = 0xa1b23c4d;
+static const uint32_t PCAPNG_MAGIC       = 0x0a0d0d0a;
+static const size_t PCAP_HDR_SIZE        = 24;
+static const size_t PCAP_REC_HDR_SIZE    = 16;
+static const uint32_t DLT_EN10MB         = 1;
+static const uint32_t DLT_RAW            = 101;
+static const uint32_t DLT_LINUX_SLL      = 113;
+static const uint32_t DLT_IPV4           = 228;
+static const uint16_t ETHERTYPE_IPV4     = 0x0800;
+static const uint16_t ETHERTYPE_VLAN     = 0x8100;
+static const uint16_t ETHERTYPE_QINQ     = 0x88a8;
+static const uint8_t IPPROTO_UDP_        = 17;
+static const size_t MIN_PACKET_SIZE      = 8; //the smallest CHDR header
+static const size_t RAW_CHDR_ALIGN       = 8;
+
+replay_capture::~replay_capture(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Helpers for the fields of the captures, which need not be aligned
+ **********************************************************************/
+static uint32_t load32(const char *p, const bool swap)
+{
+    uint32_t val;
+    std::memcpy(&val, p, sizeof(val));
+    return swap ? uhd::byteswap(val) : val;
+}
+
+static uint16_t load16_net(const char *p)
+{
+    return uint16_t((uint8_t(p[0]) << 8) | uint8_t(p[1]));
+}
+
+typedef void (*unpacker_t)(const uint32_t *, vrt::if_packet_info_t &);
+
+static unpacker_t get_unpacker(const replay_capture::protocol_t &protocol)
+{
+    if (protocol.vrt) return protocol.big_endian ? &vrt::if_hdr_unpack_be : &vrt::if_hdr_unpack_le;
+    return protocol.big_endian ? &vrt::chdr::if_hdr_unpack_be : &vrt::chdr::if_hdr_unpack_le;
+}
+
+/***********************************************************************
+ * Implementation
+ **********************************************************************/
+class replay_capture_impl : public replay_capture
+{
+public:
+    replay_capture_impl(const std::string &path, const protocol_t &protocol, const double tick_rate):
+        _path(path),
+        _protocol(protocol),
+        _unpacker(get_unpacker(protocol)),
+        _tick_rate(tick_rate),
+        _first_time(-1.0),
+        _num_skipped(0)
+    {
+        try {
+            _mapping = ip::file_mapping(path.c_str(), ip::read_only);
+            _region = ip::mapped_region(_mapping, ip::copy_on_write);
+        } catch (const ip::interprocess_exception &e) {
+            throw uhd::io_error(str(boost::format("replay: cannot map %s: %s") % path % e.what()));
+        }
+        _base = static_cast<char *>(_region.get_address());
+        _size = _region.get_size();
+
+        if (_size >= sizeof(fr::file_header_t) and std::memcmp(_base, "UHDFLREC", 8) == 0) {
+            _format = FORMAT_FLIGHT_RECORDER;
+            _protocol.vrt = false;
+            _protocol.big_endian = false;
+            this->index_flight_recorder();
+        } else if (_size >= PCAP_HDR_SIZE and (load32(_base, false) == PCAP_MAGIC_USEC
+                or load32(_base, false) == PCAP_MAGIC_NSEC or load32(_base, true) == PCAP_MAGIC_USEC
+                or load32(_base, true) == PCAP_MAGIC_NSEC)) {
+            _format = FORMAT_PCAP;
+            this->index_pcap();
+        } else if (_size >= 4 and load32(_base, false) == PCAPNG_MAGIC) {
+            throw uhd::io_error("replay: " + path + " is a pcapng file, convert it with: editcap -F pcap");
+        } else {
+            _format = FORMAT_RAW;
+            this->index_raw();
+        }
+
+        //the streams that carry data, ordered by SID
+        for (std::map<uint32_t, stream_t>::iterator it = _by_sid.begin(); it != _by_sid.end(); ++it) {
+            if (it->second.max_payload_bytes != 0) _streams.push_back(it->second);
+        }
+        _by_sid.clear();
+        if (_streams.empty()) {
+            throw uhd::io_error("replay: no data packets in " + path);
+        }
+        if (_num_skipped != 0) {
+            UHD_MSG(warning) << boost::format(
+                "replay: skipped %u packets of %s that were truncated, fragmented or not parsed"
+            ) % _num_skipped % path << std::endl;
+        }
+    }
+
+    format_t get_format(void) const
+    {
+        return _format;
+    }
+
+    protocol_t get_protocol(void) const
+    {
+        return _protocol;
+    }
+
+    const std::vector<stream_t> &get_streams(void) const
+    {
+        return _streams;
+    }
+
+    void *get_packet(const packet_t &packet, void *frame)
+    {
+        if (_format == FORMAT_FLIGHT_RECORDER) {
+            fr::record_t record;
+            std::memcpy(&record, _base + packet.offset, sizeof(record));
+            vrt::if_packet_info_t info;
+            info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+            info.has_sid = true;
+            info.sid = record.sid;
+            info.has_cid = info.has_tsi = info.has_tlr = false;
+            info.has_tsf = (record.flags & fr::FLAG_HAS_TSF) != 0;
+            info.tsf = record.tsf;
+            info.sob = false;
+            info.eob = (record.flags & fr::FLAG_EOB) != 0;
+            info.packet_count = record.seq & 0xfff;
+            info.num_payload_bytes = packet.size - (info.has_tsf ? 16 : 8);
+            info.num_payload_words32 = (info.num_payload_bytes + 3)/4;
+            vrt::chdr::if_hdr_pack_le(static_cast<uint32_t *>(frame), info);
+            return frame;
+        }
+        char *mem = _base + packet.offset;
+        if ((reinterpret_cast<size_t>(mem) & 0x3) == 0) return mem;
+        std::memcpy(frame, mem, packet.size);
+        return frame;
+    }
+
+private:
+    /*******************************************************************
+     * Indexing
+     ******************************************************************/
+    //! Unpack a header, false when it is not a packet
+    bool unpack(const char *mem, const size_t len, vrt::if_packet_info_t &info)
+    {
+        if (len < MIN_PACKET_SIZE) return false;
+        _scratch.resize((len + 3)/4);
+        std::memcpy(&_scratch.front(), mem, len);
+        info.num_packet_words32 = len/4;
+        try {
+            _unpacker(&_scratch.front(), info);
+        } catch (const uhd::value_error &) {
+            return false;
+        }
+        return true;
+    }
+
+    //! Add a packet to its stream
+    void add_packet(const uint64_t offset, const vrt::if_packet_info_t &info, const size_t size, const double time)
+    {
+        if (not info.has_sid) return;
+        const bool is_data = _protocol.vrt
+            ? (info.packet_type == vrt::if_packet_info_t::PACKET_TYPE_DATA
+                or info.packet_type == vrt::if_packet_info_t::PACKET_TYPE_IF_EXT)
+            : (info.packet_type == vrt::if_packet_info_t::PACKET_TYPE_DATA);
+        const bool is_message = _protocol.vrt
+            ? (info.packet_type == vrt::if_packet_info_t::PACKET_TYPE_CONTEXT)
+            : (info.packet_type == vrt::if_packet_info_t::PACKET_TYPE_ERROR and info.error);
+        if (not is_data and not is_message) return;
+
+        if (_first_time < 0) _first_time = time;
+        std::map<uint32_t, stream_t>::iterator it = _by_sid.find(info.sid);
+        if (it == _by_sid.end()) {
+            stream_t stream;
+            stream.sid = info.sid;
+            stream.max_payload_bytes = 0;
+            stream.ticks_per_byte = 0.0;
+            it = _by_sid.insert(std::make_pair(info.sid, stream)).first;
+            _last_data[info.sid] = last_data_t();
+        }
+        stream_t &stream = it->second;
+        packet_t packet;
+        packet.offset = offset;
+        packet.size = uint32_t(size);
+        packet.time = time - _first_time;
+        stream.packets.push_back(packet);
+
+        if (not is_data) return;
+        stream.max_payload_bytes = std::max(stream.max_payload_bytes, info.num_payload_bytes);
+        last_data_t &last = _last_data[info.sid];
+        if (stream.ticks_per_byte == 0.0 and last.has_tsf and info.has_tsf and info.tsf > last.tsf and last.payload_bytes != 0) {
+            stream.ticks_per_byte = double(info.tsf - last.tsf)/last.payload_bytes;
+        }
+        last.has_tsf = info.has_tsf;
+        last.tsf = info.tsf;
+        last.payload_bytes = info.num_payload_bytes;
+    }
+
+    //! The size of an unpacked packet, without the padding after it
+    size_t packet_size(const vrt::if_packet_info_t &info) const
+    {
+        if (_protocol.vrt) return (info.num_header_words32 + info.num_payload_words32 + (info.has_tlr ? 1 : 0))*4;
+        return info.num_header_words32*4 + info.num_payload_bytes;
+    }
+
+    void index_pcap(void)
+    {
+        const bool swap = (load32(_base, false) != PCAP_MAGIC_USEC and load32(_base, false) != PCAP_MAGIC_NSEC);
+        const uint32_t magic = load32(_base, swap);
+        const double frac_scale = (magic == PCAP_MAGIC_NSEC) ? 1e-9 : 1e-6;
+        const uint32_t link_type = load32(_base + 20, swap) & 0xffff;
+        if (link_type != DLT_EN10MB and link_type != DLT_RAW and link_type != DLT_LINUX_SLL and link_type != DLT_IPV4) {
+            throw uhd::io_error(str(boost::format("replay: %s has unsupported pcap link type %u") % _path % link_type));
+        }
+
+        size_t off = PCAP_HDR_SIZE;
+        while (off + PCAP_REC_HDR_SIZE <= _size) {
+            const double time = load32(_base + off, swap) + load32(_base + off + 4, swap)*frac_scale;
+            const size_t cap_len = load32(_base + off + 8, swap);
+            const size_t orig_len = load32(_base + off + 12, swap);
+            off += PCAP_REC_HDR_SIZE;
+            if (off + cap_len > _size) break; //cut off at the end
+            const char *frame = _base + off;
+            const size_t frame_off = off;
+            off += cap_len;
+            if (cap_len < orig_len) {
+                _num_skipped++;
+                continue;
+            }
+
+            //find the IPv4 header
+            size_t ip_off = 0;
+            if (link_type == DLT_EN10MB or link_type == DLT_LINUX_SLL) {
+                size_t type_off = (link_type == DLT_EN10MB) ? 12 : 14;
+                if (cap_len < type_off + 2) continue;
+                uint16_t ether_type = load16_net(frame + type_off);
+                while ((ether_type == ETHERTYPE_VLAN or ether_type == ETHERTYPE_QINQ) and cap_len >= type_off + 6) {
+                    type_off += 4;
+                    ether_type = load16_net(frame + type_off);
+                }
+                if (ether_type != ETHERTYPE_IPV4) continue;
+                ip_off = type_off + 2;
+            }
+            if (cap_len < ip_off + 20 or (uint8_t(frame[ip_off]) >> 4) != 4) continue;
+            const size_t ip_hdr_len = (uint8_t(frame[ip_off]) & 0xf)*4;
+            if (uint8_t(frame[ip_off + 9]) != IPPROTO_UDP_) continue;
+            if ((load16_net(frame + ip_off + 6) & 0x3fff) != 0) { //more fragments or an offset
+                _num_skipped++;
+                continue;
+            }
+            const size_t udp_off = ip_off + ip_hdr_len;
+            if (cap_len < udp_off + 8) continue;
+            const size_t udp_len = load16_net(frame + udp_off + 4);
+            if (udp_len < 8 or udp_off + udp_len > cap_len) continue;
+
+            const size_t payload_off = udp_off + 8;
+            const size_t payload_len = udp_len - 8;
+            vrt::if_packet_info_t info;
+            if (not this->unpack(frame + payload_off, payload_len, info)) {
+                _num_skipped++;
+                continue;
+            }
+            this->add_packet(frame_off + payload_off, info, std::min(payload_len, packet_size(info)), time);
+        }
+    }
+
+    void index_raw(void)
+    {
+        size_t off = 0;
+        double time = 0.0;
+        bool has_first_tsf = false;
+        uint64_t first_tsf = 0;
+        while (off + MIN_PACKET_SIZE <= _size) {
+            vrt::if_packet_info_t info;
+            if (not this->unpack(_base + off, _size - off, info)) {
+                _num_skipped++;
+                break; //without a header, the next packet cannot be found
+            }
+            if (info.has_tsf and _tick_rate > 0.0) {
+                if (not has_first_tsf) {
+                    has_first_tsf = true;
+                    first_tsf = info.tsf;
+                }
+                time = double(int64_t(info.tsf - first_tsf))/_tick_rate;
+            }
+            const size_t size = packet_size(info);
+            this->add_packet(off, info, size, time);
+            off += _protocol.vrt ? size : ((size + RAW_CHDR_ALIGN - 1)/RAW_CHDR_ALIGN)*RAW_CHDR_ALIGN;
+        }
+    }
+
+    void index_flight_recorder(void)
+    {
+        fr::file_header_t hdr;
+        std::memcpy(&hdr, _base, sizeof(hdr));
+        if (hdr.version != 1 or hdr.record_size != sizeof(fr::record_t) or hdr.ticks_per_sec == 0) {
+            throw uhd::io_error("replay: " + _path + " is a flight recorder dump of another version");
+        }
+
+        //the threads follow one another, each with its records oldest first
+        size_t off = sizeof(hdr);
+        std::vector<std::pair<uint64_t, uint64_t> > rx_records; //ticks, offset
+        for (size_t t = 0; t < hdr.num_threads and off + sizeof(fr::thread_header_t) <= _size; t++) {
+            fr::thread_header_t thread_hdr;
+            std::memcpy(&thread_hdr, _base + off, sizeof(thread_hdr));
+            off += sizeof(thread_hdr);
+            for (size_t i = 0; i < thread_hdr.num_records and off + sizeof(fr::record_t) <= _size; i++) {
+                fr::record_t record;
+                std::memcpy(&record, _base + off, sizeof(record));
+                if (record.type == fr::RECORD_RX_PACKET) {
+                    rx_records.push_back(std::make_pair(record.ticks, uint64_t(off)));
+                }
+                off += sizeof(record);
+            }
+        }
+
+        //the threads ran at the same time, so merge their records by time
+        std::sort(rx_records.begin(), rx_records.end());
+        for (size_t i = 0; i < rx_records.size(); i++) {
+            fr::record_t record;
+            std::memcpy(&record, _base + rx_records[i].second, sizeof(record));
+            vrt::if_packet_info_t info;
+            info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+            info.error = false;
+            info.has_sid = true;
+            info.sid = record.sid;
+            info.has_tsf = (record.flags & fr::FLAG_HAS_TSF) != 0;
+            info.tsf = record.tsf;
+            info.num_header_words32 = info.has_tsf ? 4 : 2;
+            if (record.value < info.num_header_words32*4 or record.value > 0xffff) {
+                _num_skipped++;
+                continue;
+            }
+            info.num_payload_bytes = record.value - info.num_header_words32*4;
+            this->add_packet(rx_records[i].second, info, record.value, double(record.ticks)/hdr.ticks_per_sec);
+        }
+    }
+
+    struct last_data_t {
+        last_data_t(void): has_tsf(false), tsf(0), payload_bytes(0) {}
+        bool has_tsf;
+        uint64_t tsf;
+        size_t payload_bytes;
+    };
+
+    const std::string _path;
+    protocol_t _protocol;
+    const unpacker_t _unpacker;
+    const double _tick_rate;
+    ip::file_mapping _mapping;
+    ip::mapped_region _region;
+    char *_base;
+    size_t _size;
+    format_t _format;
+    double _first_time;
+    size_t _num_skipped;
+    std::vector<uint32_t> _scratch;
+    std::map<uint32_t, stream_t> _by_sid;
+    std::map<uint32_t, last_data_t> _last_data;
+    std::vector<stream_t> _streams;
+};
+
+replay_capture::sptr replay_capture::make(const std::string &path, const protocol_t &protocol, const double tick_rate)
+{
+    return sptr(new replay_capture_impl(path, protocol, tick_rate));
+}
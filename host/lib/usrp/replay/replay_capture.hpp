@@ -0,0 +1,113 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_REPLAY_CAPTURE_HPP
+#define INCLUDED_REPLAY_CAPTURE_HPP
+
+#include <uhd/config.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ * A capture of streaming packets, mapped into memory and indexed by
+ * stream, for the replay device.
+ *
+ * It reads
+ * - pcap files (tcpdump -w, not pcapng) of Ethernet, Linux cooked or
+ *   raw IPv4 frames, the UDP payloads are the packets;
+ * - flight recorder dumps (see uhd/utils/flight_recorder.hpp), whose RX
+ *   packet records become CHDR packets with the recorded header, size
+ *   and time, and zeros for samples;
+ * - any other file as packets back to back (CHDR packets padded to 8
+ *   bytes), e.g. a dump of a DMA buffer.
+ *
+ * A stream is the data packets of one SID, with the error packets of
+ * that SID; flow control and command packets are left out.
+ */
+class replay_capture : boost::noncopyable
+{
+public:
+    typedef boost::shared_ptr<replay_capture> sptr;
+
+    enum format_t {
+        FORMAT_PCAP,
+        FORMAT_FLIGHT_RECORDER,
+        FORMAT_RAW
+    };
+
+    //! The packet headers, the flight recorder writes little endian CHDR
+    struct protocol_t {
+        bool vrt; //!< VRT instead of CHDR
+        bool big_endian;
+    };
+
+    //! One packet of a stream
+    struct packet_t {
+        //! Offset in the file, or of the record of a packet to make up
+        uint64_t offset;
+        //! Size in bytes
+        uint32_t size;
+        //! Capture time, in seconds since the first packet of the capture
+        double time;
+    };
+
+    struct stream_t {
+        uint32_t sid;
+        std::vector<packet_t> packets;
+        //! The largest payload of a data packet, in bytes
+        size_t max_payload_bytes;
+        //! Device ticks per payload byte, from the first packets with a time
+        //! stamp, 0 when unknown
+        double ticks_per_byte;
+    };
+
+    /*!
+     * Map and index a capture.
+     * \param path the capture file
+     * \param protocol the packet headers, not used for flight recorder
+     *        dumps
+     * \param tick_rate the device tick rate, to time the packets of raw
+     *        captures by their time stamps
+     * \throws uhd::io_error if the file cannot be read or parsed
+     */
+    static sptr make(const std::string &path, const protocol_t &protocol, const double tick_rate);
+
+    virtual ~replay_capture(void) = 0;
+
+    virtual format_t get_format(void) const = 0;
+
+    //! The protocol of the packets from get_packet()
+    virtual protocol_t get_protocol(void) const = 0;
+
+    //! The streams, ordered by SID
+    virtual const std::vector<stream_t> &get_streams(void) const = 0;
+
+    /*!
+     * Get a packet.
+     * \param packet a packet of get_streams()
+     * \param frame memory for packets that are made up or not aligned
+     *        in the file, at least packet.size bytes, 4-byte aligned and
+     *        with zeros after the header
+     * \return the packet, in the (copy on write) mapped file or in frame
+     */
+    virtual void *get_packet(const packet_t &packet, void *frame) = 0;
+};
+
+#endif /* INCLUDED_REPLAY_CAPTURE_HPP */
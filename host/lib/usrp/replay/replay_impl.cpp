@@ -0,0 +1,430 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "replay_impl.hpp"
+#include "streamer_args.hpp"
+#include "../../transport/super_recv_packet_handler.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/usrp/mboard_eeprom.hpp>
+#include <uhd/usrp/dboard_eeprom.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Discovery
+ **********************************************************************/
+static device_addrs_t replay_find(const device_addr_t &hint)
+{
+    device_addrs_t addrs;
+
+    //only found when asked for by type, so it never shows up next to real devices
+    if (not hint.has_key("type") or hint["type"] != "replay") return addrs;
+    if (not hint.has_key("file")) return addrs;
+
+    device_addr_t new_addr = hint;
+    new_addr["name"] = hint.get("name", "replay");
+    new_addr["serial"] = hint.get("serial", "REPLAY0");
+    addrs.push_back(new_addr);
+    return addrs;
+}
+
+/***********************************************************************
+ * Make
+ **********************************************************************/
+static device::sptr replay_make(const device_addr_t &device_addr)
+{
+    return device::sptr(new replay_impl(device_addr));
+}
+
+UHD_STATIC_BLOCK(register_replay_device)
+{
+    device::register_device(&replay_find, &replay_make, device::USRP);
+}
+
+/***********************************************************************
+ * Structors
+ **********************************************************************/
+static replay_capture::protocol_t get_protocol(const device_addr_t &device_addr)
+{
+    replay_capture::protocol_t protocol;
+    const std::string name = device_addr.get("protocol", "chdr");
+    const std::string endianness = device_addr.get("endianness", "big");
+    if (name != "chdr" and name != "vrt") {
+        throw uhd::value_error("replay: protocol must be chdr or vrt, not " + name);
+    }
+    if (endianness != "big" and endianness != "little") {
+        throw uhd::value_error("replay: endianness must be big or little, not " + endianness);
+    }
+    protocol.vrt = (name == "vrt");
+    protocol.big_endian = (endianness == "big");
+    return protocol;
+}
+
+replay_impl::replay_impl(const device_addr_t &device_addr):
+    _tick_rate(device_addr.cast<double>("master_clock_rate", REPLAY_DEFAULT_TICK_RATE)),
+    _rate(device_addr.cast<double>("rate", 0.0)),
+    _pace(device_addr.cast<int>("pace", 1) != 0),
+    _speed(device_addr.cast<double>("speed", 1.0)),
+    _loop(device_addr.cast<int>("loop", 0) != 0),
+    _loop_period(0.0),
+    _frame_size(0),
+    _time_offset(time_spec_t::get_system_time())
+{
+    if (_tick_rate <= 0.0 or _rate < 0.0 or _speed <= 0.0) {
+        throw uhd::value_error("replay: master_clock_rate, rate and speed must be positive");
+    }
+    _capture = replay_capture::make(device_addr.get("file", ""), get_protocol(device_addr), _tick_rate);
+    const std::vector<replay_capture::stream_t> &streams = _capture->get_streams();
+
+    //one channel per chosen stream, by default all of them in SID order
+    std::vector<size_t> chosen;
+    if (device_addr.has_key("sids")) {
+        std::vector<std::string> sids;
+        boost::split(sids, device_addr["sids"], boost::is_any_of(":;"));
+        BOOST_FOREACH(const std::string &sid_str, sids) {
+            const uint32_t sid = uint32_t(std::strtoul(sid_str.c_str(), NULL, 16));
+            size_t i = 0;
+            while (i < streams.size() and streams[i].sid != sid) i++;
+            if (i == streams.size()) {
+                throw uhd::key_error("replay: the capture has no stream with SID " + sid_str);
+            }
+            chosen.push_back(i);
+        }
+    } else {
+        for (size_t i = 0; i < streams.size(); i++) chosen.push_back(i);
+    }
+
+    size_t max_packets = 0;
+    double last_time = 0.0;
+    _rx_chans.resize(chosen.size());
+    for (size_t i = 0; i < chosen.size(); i++) {
+        const replay_capture::stream_t &stream = streams[chosen[i]];
+        _rx_chans[i].stream = chosen[i];
+        BOOST_FOREACH(const replay_capture::packet_t &packet, stream.packets) {
+            _frame_size = std::max<size_t>(_frame_size, packet.size);
+        }
+        max_packets = std::max(max_packets, stream.packets.size());
+        last_time = std::max(last_time, stream.packets.back().time);
+        UHD_MSG(status) << boost::format(
+            "Replay channel %u: SID 0x%08x, %u packets, %f Msps\n"
+        ) % i % stream.sid % stream.packets.size() % (this->get_rate(i, 4)/1e6);
+    }
+    //the next play through starts one average packet gap after the last packet
+    if (max_packets > 1) _loop_period = last_time*max_packets/(max_packets - 1);
+
+    _tree = property_tree::make();
+    _type = device::USRP;
+    this->setup_tree();
+}
+
+replay_impl::~replay_impl(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Property tree
+ **********************************************************************/
+static subdev_spec_t coerce_subdev_spec(const size_t num_chans, const subdev_spec_t &spec)
+{
+    BOOST_FOREACH(const subdev_spec_pair_t &pair, spec) {
+        if (pair.db_name != "A" or pair.sd_name.empty()
+                or boost::lexical_cast<size_t>(pair.sd_name) >= num_chans) {
+            throw uhd::value_error("replay: invalid subdev spec " + spec.to_string());
+        }
+    }
+    return spec;
+}
+
+void replay_impl::setup_tree(void)
+{
+    const fs_path mb_path = "/mboards/0";
+    const size_t num_chans = _rx_chans.size();
+
+    _tree->create<std::string>("/name").set("Replay Device");
+    _tree->create<std::string>(mb_path / "name").set("Replay");
+    _tree->create<std::string>(mb_path / "codename").set("Replay");
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["name"] = "replay";
+    mb_eeprom["serial"] = "REPLAY0";
+    _tree->create<mboard_eeprom_t>(mb_path / "eeprom").set(mb_eeprom);
+
+    //the tick rate is the one of the capture, use master_clock_rate to change it
+    _tree->create<double>(mb_path / "tick_rate")
+        .set_coercer(boost::bind(&replay_impl::get_tick_rate_coerced, this, _1))
+        .set(_tick_rate);
+
+    //time keeping follows the host clock, the packets keep their own times
+    _tree->create<time_spec_t>(mb_path / "time" / "now")
+        .set_publisher(boost::bind(&replay_impl::get_time_now, this))
+        .add_coerced_subscriber(boost::bind(&replay_impl::set_time_now, this, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "pps")
+        .set_publisher(boost::bind(&replay_impl::get_time_now, this))
+        .add_coerced_subscriber(boost::bind(&replay_impl::set_time_now, this, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "cmd");
+
+    //one daughterboard with an RX front end per channel
+    const fs_path db_path = mb_path / "dboards" / "A";
+    _tree->create<dboard_eeprom_t>(db_path / "rx_eeprom").set(dboard_eeprom_t());
+    _tree->create<dboard_eeprom_t>(db_path / "tx_eeprom").set(dboard_eeprom_t());
+    subdev_spec_t default_spec;
+    for (size_t i = 0; i < num_chans; i++) {
+        const std::string fe_name = boost::lexical_cast<std::string>(i);
+        default_spec.push_back(subdev_spec_pair_t("A", fe_name));
+        const fs_path fe_path = db_path / "rx_frontends" / fe_name;
+        const double rate = this->get_rate(i, 4);
+        _tree->create<std::string>(fe_path / "name").set("Replay");
+        _tree->create<std::string>(fe_path / "connection").set("IQ");
+        _tree->create<bool>(fe_path / "enabled").set(true);
+        _tree->create<bool>(fe_path / "use_lo_offset").set(false);
+        _tree->create<std::vector<std::string> >(fe_path / "antenna" / "options")
+            .set(std::vector<std::string>(1, "RX"));
+        _tree->create<std::string>(fe_path / "antenna" / "value").set("RX");
+        _tree->create<double>(fe_path / "freq" / "value").set(0.0);
+        _tree->create<meta_range_t>(fe_path / "freq" / "range").set(meta_range_t(0.0, 0.0));
+        _tree->create<double>(fe_path / "bandwidth" / "value").set(rate);
+        _tree->create<meta_range_t>(fe_path / "bandwidth" / "range").set(meta_range_t(rate, rate));
+
+        //the rate is the one of the capture
+        const fs_path rx_dsp_path = mb_path / "rx_dsps" / fe_name;
+        _tree->create<meta_range_t>(rx_dsp_path / "rate" / "range").set(meta_range_t(rate, rate));
+        _tree->create<double>(rx_dsp_path / "rate" / "value")
+            .set_coercer(boost::bind(&replay_impl::get_rate_coerced, this, i, _1))
+            .set(rate);
+        _tree->create<double>(rx_dsp_path / "freq" / "value").set(0.0);
+        _tree->create<meta_range_t>(rx_dsp_path / "freq" / "range").set(meta_range_t(0.0, 0.0));
+        _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
+            .add_coerced_subscriber(boost::bind(&replay_impl::issue_stream_cmd, this, i, _1));
+    }
+    _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
+        .set_coercer(boost::bind(&coerce_subdev_spec, num_chans, _1))
+        .set(default_spec);
+    _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
+        .set_coercer(boost::bind(&coerce_subdev_spec, 0, _1))
+        .set(subdev_spec_t());
+}
+
+double replay_impl::get_tick_rate_coerced(const double)
+{
+    return _tick_rate;
+}
+
+double replay_impl::get_rate(const size_t index, const size_t bpi) const
+{
+    if (_rate > 0.0) return _rate;
+    const double ticks_per_byte = _capture->get_streams().at(_rx_chans.at(index).stream).ticks_per_byte;
+    if (ticks_per_byte == 0.0) return REPLAY_DEFAULT_RATE;
+    return _tick_rate/(ticks_per_byte*bpi);
+}
+
+double replay_impl::get_rate_coerced(const size_t index, const double)
+{
+    return this->get_rate(index, 4);
+}
+
+time_spec_t replay_impl::get_time_now(void)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return time_spec_t::get_system_time() - _time_offset;
+}
+
+void replay_impl::set_time_now(const time_spec_t &time)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    _time_offset = time_spec_t::get_system_time() - time;
+}
+
+/***********************************************************************
+ * Playback
+ **********************************************************************/
+void replay_impl::issue_stream_cmd(const size_t index, const stream_cmd_t &cmd)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    rx_chan_t &chan = _rx_chans.at(index);
+
+    //the capture decides how many samples there are and when they come,
+    //so every start command resumes where the last stop left off
+    if (cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS) {
+        chan.active = false;
+        return;
+    }
+    if (chan.active) return;
+    chan.active = true;
+    const std::vector<replay_capture::packet_t> &packets = _capture->get_streams()[chan.stream].packets;
+    const double time = (chan.cursor < packets.size()) ? packets[chan.cursor].time : packets.back().time;
+    chan.wall_offset = time_spec_t::get_system_time() - time_spec_t((time + chan.loops*_loop_period)/_speed);
+}
+
+managed_recv_buffer::sptr replay_impl::get_recv_buff(const size_t index, const double timeout)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    rx_chan_t &chan = _rx_chans[index];
+    const std::vector<replay_capture::packet_t> &packets = _capture->get_streams()[chan.stream].packets;
+    if (chan.cursor == packets.size() and _loop) {
+        chan.cursor = 0;
+        chan.loops++;
+    }
+
+    //nothing to play back: wait like a radio that sends nothing
+    if (not chan.active or chan.cursor == packets.size()) {
+        lock.unlock();
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+        return managed_recv_buffer::sptr();
+    }
+
+    const replay_capture::packet_t &packet = packets[chan.cursor];
+    if (_pace) {
+        const time_spec_t due = chan.wall_offset + time_spec_t((packet.time + chan.loops*_loop_period)/_speed);
+        const double wait_time = (due - time_spec_t::get_system_time()).get_real_secs();
+        if (wait_time > timeout) {
+            lock.unlock();
+            boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+            return managed_recv_buffer::sptr();
+        }
+        if (wait_time > 0.0) {
+            lock.unlock();
+            boost::this_thread::sleep(boost::posix_time::microseconds(long(wait_time*1e6)));
+            lock.lock();
+        }
+    }
+
+    //a frame that the handler no longer holds, for packets that are copied
+    size_t frame = chan.next_frame;
+    while (chan.buffs[frame]->ref_count() != 0) {
+        frame = (frame + 1) % chan.buffs.size();
+        if (frame == chan.next_frame) return managed_recv_buffer::sptr();
+    }
+    chan.next_frame = (frame + 1) % chan.buffs.size();
+    void *mem = _capture->get_packet(packet, &chan.frames[frame].front());
+    chan.cursor++;
+    return chan.buffs[frame]->get_new(mem, packet.size);
+}
+
+bool replay_impl::recv_async_msg(async_metadata_t &, double timeout)
+{
+    //there is no TX, so there are no messages
+    boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+    return false;
+}
+
+/***********************************************************************
+ * Streamers
+ **********************************************************************/
+rx_streamer::sptr replay_impl::get_rx_stream(const uhd::stream_args_t &args_)
+{
+    boost::mutex::scoped_lock setup_lock(_transport_setup_mutex);
+
+    stream_args_t args = args_;
+
+    //setup defaults for unspecified values
+    if (args.otw_format.empty()) args.otw_format = "sc16";
+    args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+    BOOST_FOREACH(const size_t chan, args.channels) {
+        if (chan >= _rx_chans.size()) {
+            throw uhd::index_error(str(boost::format(
+                "replay: RX channel %u out of range for %u channel(s)") % chan % _rx_chans.size()));
+        }
+    }
+    const usrp::streamer_args_t streamer_args(args);
+    const replay_capture::protocol_t protocol = _capture->get_protocol();
+
+    //the packets are as large as in the capture, whatever spp asks for
+    const size_t bpi = convert::get_bytes_per_item(args.otw_format);
+    size_t spp = 0;
+    BOOST_FOREACH(const size_t chan, args.channels) {
+        spp = std::max(spp, _capture->get_streams()[_rx_chans[chan].stream].max_payload_bytes/bpi);
+    }
+    if (spp == 0) {
+        throw uhd::value_error("replay: the packets of the capture are too small for one sample");
+    }
+
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+        boost::make_shared<sph::recv_packet_streamer>(spp);
+    my_streamer->resize(args.channels.size());
+    if (protocol.vrt) {
+        my_streamer->set_vrt_unpacker(protocol.big_endian
+            ? &vrt::if_hdr_unpack_cached_be : &vrt::if_hdr_unpack_cached_le);
+    } else {
+        my_streamer->set_vrt_unpacker(protocol.big_endian
+            ? &vrt::chdr::if_hdr_unpack_cached_be : &vrt::chdr::if_hdr_unpack_cached_le);
+    }
+
+    //set the converter
+    uhd::convert::id_type id;
+    id.input_format = args.otw_format + (protocol.big_endian ? "_item32_be" : "_item32_le");
+    id.num_inputs = 1;
+    id.output_format = args.cpu_format;
+    id.num_outputs = 1;
+    my_streamer->set_converter(id);
+    my_streamer->set_tick_rate(_tick_rate);
+    my_streamer->set_samp_rate(this->get_rate(args.channels.front(), bpi));
+
+    for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
+    {
+        const size_t index = args.channels[stream_i];
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            rx_chan_t &chan = _rx_chans[index];
+            chan.streamer = my_streamer;
+            chan.active = false;
+            chan.cursor = chan.loops = chan.next_frame = 0;
+            chan.buffs.resize(REPLAY_NUM_FRAMES);
+            chan.frames.resize(REPLAY_NUM_FRAMES);
+            for (size_t i = 0; i < REPLAY_NUM_FRAMES; i++) {
+                if (not chan.buffs[i]) chan.buffs[i] = boost::make_shared<replay_buffer>();
+                chan.frames[i].assign((_frame_size + 3)/4, 0);
+            }
+        }
+        my_streamer->set_xport_chan_get_buff(stream_i, boost::bind(
+            &replay_impl::get_recv_buff, this, index, _1
+        ));
+        my_streamer->set_issue_stream_cmd(stream_i, boost::bind(
+            &replay_impl::issue_stream_cmd, this, index, _1
+        ));
+    }
+    //optionally spread the per-channel conversion over several threads
+    my_streamer->set_convert_threads(streamer_args.get_convert_threads());
+    //keep large receive buffers out of the caches, see set_nontemporal_stores()
+    my_streamer->set_nontemporal_stores(streamer_args.get_nontemporal_stores());
+    //report the sample power in the metadata, see set_power_metadata()
+    my_streamer->set_power_metadata(streamer_args.get_power_meta());
+
+    return my_streamer;
+}
+
+tx_streamer::sptr replay_impl::get_tx_stream(const uhd::stream_args_t &)
+{
+    throw uhd::not_implemented_error("replay: the replay device only receives");
+}
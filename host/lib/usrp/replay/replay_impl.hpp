@@ -0,0 +1,111 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_REPLAY_IMPL_HPP
+#define INCLUDED_REPLAY_IMPL_HPP
+
+#include "replay_capture.hpp"
+#include <uhd/device.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <vector>
+
+static const double REPLAY_DEFAULT_TICK_RATE = 200e6;
+static const double REPLAY_DEFAULT_RATE      = 1e6; //when the capture has no times
+static const size_t REPLAY_NUM_FRAMES        = 8;   //per channel, for packets that are copied
+
+/*!
+ * A device that plays back a capture of the packets of a real device.
+ *
+ * Each RX channel is one stream (SID) of the capture. Its packets go,
+ * without a copy when they are aligned in the mapped file, to the
+ * regular receive packet handler, paced at the times they were
+ * captured or as fast as the streamer reads them. Streamer and
+ * converter changes can so be measured on recorded traffic, with its
+ * bursts, gaps, sequence errors and inline messages.
+ */
+class replay_impl : public uhd::device
+{
+public:
+    replay_impl(const uhd::device_addr_t &device_addr);
+    ~replay_impl(void);
+
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t &args);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t &args);
+    bool recv_async_msg(uhd::async_metadata_t &, double);
+
+private:
+    //! Hands out packets of the capture, which the device keeps
+    class replay_buffer : public uhd::transport::managed_recv_buffer
+    {
+    public:
+        void release(void)
+        {
+            /* NOP */
+        }
+
+        sptr get_new(void *mem, const size_t len)
+        {
+            return make(this, mem, len);
+        }
+    };
+
+    //! State of one RX channel, under _mutex
+    struct rx_chan_t
+    {
+        rx_chan_t(void): stream(0), cursor(0), loops(0), active(false), next_frame(0) {}
+        size_t stream; //index in the streams of the capture
+        size_t cursor; //the next packet
+        size_t loops;  //times the capture was played through
+        bool active;
+        uhd::time_spec_t wall_offset; //wall clock at capture time zero
+        boost::weak_ptr<uhd::rx_streamer> streamer;
+        std::vector<boost::shared_ptr<replay_buffer> > buffs;
+        std::vector<std::vector<uint32_t> > frames;
+        size_t next_frame;
+    };
+
+    void setup_tree(void);
+    double get_tick_rate_coerced(const double);
+    double get_rate(const size_t index, const size_t bpi) const;
+    double get_rate_coerced(const size_t index, const double);
+    uhd::time_spec_t get_time_now(void);
+    void set_time_now(const uhd::time_spec_t &time);
+    void issue_stream_cmd(const size_t index, const uhd::stream_cmd_t &cmd);
+    uhd::transport::managed_recv_buffer::sptr get_recv_buff(const size_t index, const double timeout);
+
+    replay_capture::sptr _capture;
+    const double _tick_rate;
+    const double _rate; //0 for the rate of the capture
+    const bool _pace;
+    const double _speed;
+    const bool _loop;
+    double _loop_period; //capture seconds from one play through to the next
+    size_t _frame_size;
+    uhd::time_spec_t _time_offset; //wall clock minus device time, under _mutex
+    std::vector<rx_chan_t> _rx_chans;
+    boost::mutex _mutex;
+    boost::mutex _transport_setup_mutex;
+};
+
+#endif /* INCLUDED_REPLAY_IMPL_HPP */
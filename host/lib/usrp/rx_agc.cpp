@@ -0,0 +1,112 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/rx_agc.hpp>
+#include <uhd/exception.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+//! The peak |sample|^2 above which the samples are taken as clipped
+static const double CLIP_POWER = 0.9;
+//! The lowest mean power in the log, to keep silence finite
+static const double MIN_POWER = 1e-12;
+
+rx_agc::~rx_agc(void)
+{
+    /* NOP */
+}
+
+class rx_agc_impl : public rx_agc
+{
+public:
+    rx_agc_impl(
+        multi_usrp::sptr usrp,
+        const size_t chan,
+        const double target_dbfs,
+        const double hysteresis_db,
+        const double latency
+    ):
+        _usrp(usrp),
+        _chan(chan),
+        _target_dbfs(target_dbfs),
+        _hysteresis_db(hysteresis_db),
+        _latency(latency),
+        _rate(usrp->get_rx_rate(chan)),
+        _gain(usrp->get_rx_gain(chan)),
+        _settled_time(0.0)
+    {
+        if (hysteresis_db < 0.0) throw uhd::value_error("rx_agc: the hysteresis cannot be negative");
+    }
+
+    bool update(const rx_metadata_t &metadata, const size_t nsamps)
+    {
+        if (not metadata.has_power or metadata.error_code != rx_metadata_t::ERROR_CODE_NONE) return false;
+
+        //ignore the samples received before the last change took effect
+        if (metadata.has_time_spec and metadata.time_spec < _settled_time) return false;
+
+        //the gain error, take off at least the hysteresis when clipping
+        double error_db = _target_dbfs - 10*std::log10(std::max(metadata.mean_power, MIN_POWER));
+        if (metadata.peak_power >= CLIP_POWER) error_db = std::min(error_db, -2*_hysteresis_db);
+        if (std::abs(error_db) <= _hysteresis_db) return false;
+
+        const gain_range_t range = _usrp->get_rx_gain_range(_chan);
+        const double gain = range.clip(_gain + error_db, true);
+        if (gain == _gain) return false;
+
+        if (metadata.has_time_spec){
+            //after the last sample of this call, same for every channel
+            _settled_time = metadata.time_spec + time_spec_t::from_ticks(nsamps, _rate) + time_spec_t(_latency);
+            _usrp->set_command_time(_settled_time);
+            _usrp->set_rx_gain(gain, _chan);
+            _usrp->clear_command_time();
+        }
+        else{
+            _usrp->set_rx_gain(gain, _chan);
+        }
+        _gain = gain;
+        return true;
+    }
+
+    double get_gain(void)
+    {
+        return _gain;
+    }
+
+private:
+    multi_usrp::sptr _usrp;
+    const size_t _chan;
+    const double _target_dbfs;
+    const double _hysteresis_db;
+    const double _latency;
+    const double _rate;
+    double _gain;
+    time_spec_t _settled_time;
+};
+
+rx_agc::sptr rx_agc::make(
+    multi_usrp::sptr usrp,
+    const size_t chan,
+    const double target_dbfs,
+    const double hysteresis_db,
+    const double latency
+){
+    return sptr(new rx_agc_impl(usrp, chan, target_dbfs, hysteresis_db, latency));
+}
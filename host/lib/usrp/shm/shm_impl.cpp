@@ -0,0 +1,195 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../../transport/shm_ring.hpp"
+#include <uhd/device.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/utils/static.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * The read-only streamer
+ **********************************************************************/
+class shm_rx_streamer : public rx_streamer
+{
+public:
+    shm_rx_streamer(shm_ring::sptr ring, const std::vector<size_t> &chans):
+        _ring(ring),
+        _chans(chans),
+        _ring_buffs(ring->get_info().num_chans, NULL),
+        _pending_error(rx_metadata_t::ERROR_CODE_NONE)
+    {
+        /* NOP */
+    }
+
+    size_t get_num_channels(void) const
+    {
+        return _chans.size();
+    }
+
+    size_t get_max_num_samps(void) const
+    {
+        return _ring->get_info().spp;
+    }
+
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        const double timeout,
+        const bool one_packet
+    ){
+        //fill the buffers from successive packets, like the other streamers
+        if (_pending_error != rx_metadata_t::ERROR_CODE_NONE) {
+            metadata.reset();
+            metadata.error_code = _pending_error;
+            _pending_error = rx_metadata_t::ERROR_CODE_NONE;
+            return 0;
+        }
+
+        const size_t bytes_per_item = _ring->get_info().bytes_per_item;
+        size_t num_samps = 0;
+        rx_metadata_t md;
+        do {
+            for (size_t i = 0; i < _chans.size(); i++) {
+                _ring_buffs[_chans[i]] = static_cast<char *>(buffs[i]) + num_samps*bytes_per_item;
+            }
+            const size_t n = _ring->read(_ring_buffs, nsamps_per_buff - num_samps, md,
+                                         (num_samps == 0)? timeout : 0.0);
+            if (num_samps == 0) {
+                metadata = md;
+            } else if (md.error_code != rx_metadata_t::ERROR_CODE_NONE) {
+                //return the samples first, the error with the next call
+                if (md.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) _pending_error = md.error_code;
+                break;
+            }
+            num_samps += n;
+            metadata.more_fragments = md.more_fragments;
+            metadata.end_of_burst = md.end_of_burst;
+            if (md.error_code != rx_metadata_t::ERROR_CODE_NONE or md.end_of_burst) break;
+        } while (not one_packet and num_samps < nsamps_per_buff);
+        return num_samps;
+    }
+
+    void issue_stream_cmd(const stream_cmd_t &)
+    {
+        //the publisher owns the stream
+    }
+
+private:
+    shm_ring::sptr _ring;
+    const std::vector<size_t> _chans;
+    std::vector<void *> _ring_buffs;
+    rx_metadata_t::error_code_t _pending_error;
+};
+
+/***********************************************************************
+ * The device
+ **********************************************************************/
+class shm_impl : public uhd::device
+{
+public:
+    shm_impl(const device_addr_t &device_addr):
+        _name(device_addr.get("name", ""))
+    {
+        //check the ring is there and learn its stream
+        const shm_ring::info_t info = shm_ring::open(_name)->get_info();
+
+        _tree = property_tree::make();
+        _type = device::USRP;
+        _tree->create<std::string>("/name").set("Shared Memory Device");
+        _tree->create<std::string>("/mboards/0/name").set("SHM " + _name);
+        _tree->create<std::string>("/mboards/0/cpu_format").set(info.cpu_format);
+        _tree->create<size_t>("/mboards/0/num_channels").set(info.num_chans);
+        _tree->create<double>("/mboards/0/rx_rate").set(info.samp_rate);
+    }
+
+    rx_streamer::sptr get_rx_stream(const stream_args_t &args_)
+    {
+        stream_args_t args = args_;
+        if (args.channels.empty()) args.channels = std::vector<size_t>(1, 0);
+
+        //each streamer has its own reader, with its own cursor
+        shm_ring::sptr ring = shm_ring::open(_name);
+        const shm_ring::info_t &info = ring->get_info();
+        if (args.cpu_format != info.cpu_format) {
+            throw uhd::value_error(str(boost::format(
+                "shm: %s carries %s samples, cannot make a %s stream"
+            ) % _name % info.cpu_format % args.cpu_format));
+        }
+        BOOST_FOREACH(const size_t chan, args.channels) {
+            if (chan >= info.num_chans) {
+                throw uhd::index_error(str(boost::format(
+                    "shm: %s has %u channels, no channel %u"
+                ) % _name % info.num_chans % chan));
+            }
+        }
+        return rx_streamer::sptr(new shm_rx_streamer(ring, args.channels));
+    }
+
+    tx_streamer::sptr get_tx_stream(const stream_args_t &)
+    {
+        throw uhd::not_implemented_error("shm: the shared memory device is receive only");
+    }
+
+    bool recv_async_msg(async_metadata_t &, double timeout)
+    {
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+        return false;
+    }
+
+private:
+    const std::string _name;
+};
+
+/***********************************************************************
+ * Discovery and make
+ **********************************************************************/
+static device_addrs_t shm_find(const device_addr_t &hint)
+{
+    device_addrs_t addrs;
+
+    //only found when asked for by type and name, the ring cannot be enumerated
+    if (not hint.has_key("type") or hint["type"] != "shm" or not hint.has_key("name")) return addrs;
+    try {
+        shm_ring::open(hint["name"]);
+    } catch (const uhd::io_error &) {
+        return addrs;
+    }
+
+    device_addr_t new_addr;
+    new_addr["type"] = "shm";
+    new_addr["name"] = hint["name"];
+    addrs.push_back(new_addr);
+    return addrs;
+}
+
+static device::sptr shm_make(const device_addr_t &device_addr)
+{
+    return device::sptr(new shm_impl(device_addr));
+}
+
+UHD_STATIC_BLOCK(register_shm_device)
+{
+    device::register_device(&shm_find, &shm_make, device::USRP);
+}
@@ -0,0 +1,158 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/usrp/time_sync.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+//! How long to wait for a PPS edge, in milliseconds
+static const long PPS_TIMEOUT_MS = 1100;
+//! How long after the edge seen on motherboard 0 all have seen it, in milliseconds
+static const long PPS_SETTLE_MS = 200;
+//! How often the lock sensors are read, in milliseconds
+static const long LOCK_POLL_MS = 100;
+
+time_sync::~time_sync(void)
+{
+    /* NOP */
+}
+
+class time_sync_impl : public time_sync
+{
+public:
+    time_sync_impl(multi_usrp::sptr usrp):
+        _usrp(usrp)
+    {
+        /* NOP */
+    }
+
+    bool sync_to_gps(const double timeout)
+    {
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::microseconds(long(timeout*1e6));
+        run_on_mboards(boost::bind(&time_sync_impl::lock_to_gps, this, _1, exit_time));
+        run_on_mboards(boost::bind(&time_sync_impl::set_gps_time, this, _1));
+
+        //the times are set at this edge, but some devices only latch
+        //the new time at the last PPS on the edge after
+        wait_for_pps();
+        return verify();
+    }
+
+    bool verify(void)
+    {
+        wait_for_pps();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(PPS_SETTLE_MS));
+
+        std::vector<time_spec_t> pps_times(_usrp->get_num_mboards());
+        run_on_mboards(boost::bind(&time_sync_impl::read_pps_time, this, _1, boost::ref(pps_times)));
+        _pps_times = pps_times;
+        return std::count(pps_times.begin(), pps_times.end(), pps_times.front()) == std::ptrdiff_t(pps_times.size());
+    }
+
+    std::vector<time_spec_t> get_pps_times(void)
+    {
+        return _pps_times;
+    }
+
+private:
+    //! Run a step on all motherboards at once, throw the error of the first one that failed
+    void run_on_mboards(const boost::function<void(size_t)> &step)
+    {
+        const size_t num_mboards = _usrp->get_num_mboards();
+        std::vector<std::string> errors(num_mboards);
+        boost::thread_group threads;
+        for (size_t m = 0; m < num_mboards; m++){
+            threads.create_thread(boost::bind(&time_sync_impl::run_step, step, m, boost::ref(errors[m])));
+        }
+        threads.join_all();
+        for (size_t m = 0; m < num_mboards; m++){
+            if (not errors[m].empty()) throw uhd::runtime_error(str(
+                boost::format("time_sync: motherboard %u: %s") % m % errors[m]
+            ));
+        }
+    }
+
+    static void run_step(const boost::function<void(size_t)> &step, const size_t mboard, std::string &error)
+    {
+        try{
+            step(mboard);
+        }
+        catch(const std::exception &e){
+            error = e.what();
+        }
+    }
+
+    void lock_to_gps(const size_t mboard, const boost::system_time &exit_time)
+    {
+        const std::vector<std::string> sensors = _usrp->get_mboard_sensor_names(mboard);
+        if (std::find(sensors.begin(), sensors.end(), "gps_locked") == sensors.end()){
+            throw uhd::runtime_error("no GPSDO found");
+        }
+        const bool has_ref_locked = std::find(sensors.begin(), sensors.end(), "ref_locked") != sensors.end();
+
+        _usrp->set_clock_source("gpsdo", mboard);
+        _usrp->set_time_source("gpsdo", mboard);
+        while ((has_ref_locked and not _usrp->get_mboard_sensor("ref_locked", mboard).to_bool())
+               or not _usrp->get_mboard_sensor("gps_locked", mboard).to_bool()){
+            if (boost::get_system_time() > exit_time){
+                throw uhd::runtime_error("no lock to the GPSDO before the timeout");
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(LOCK_POLL_MS));
+        }
+    }
+
+    void set_gps_time(const size_t mboard)
+    {
+        //the GPS time comes with the sentence after a PPS edge, and holds until the next one
+        const time_spec_t gps_time(time_t(_usrp->get_mboard_sensor("gps_time", mboard).to_int()));
+        _usrp->set_time_next_pps(gps_time + 1.0, mboard);
+    }
+
+    void read_pps_time(const size_t mboard, std::vector<time_spec_t> &pps_times)
+    {
+        pps_times[mboard] = _usrp->get_time_last_pps(mboard);
+    }
+
+    void wait_for_pps(void)
+    {
+        const boost::system_time exit_time = boost::get_system_time() +
+            boost::posix_time::milliseconds(PPS_TIMEOUT_MS);
+        const time_spec_t last_pps = _usrp->get_time_last_pps(0);
+        while (_usrp->get_time_last_pps(0) == last_pps){
+            if (boost::get_system_time() > exit_time){
+                throw uhd::runtime_error("time_sync: no PPS edge detected");
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+    }
+
+    multi_usrp::sptr _usrp;
+    std::vector<time_spec_t> _pps_times;
+};
+
+time_sync::sptr time_sync::make(multi_usrp::sptr usrp)
+{
+    return sptr(new time_sync_impl(usrp));
+}
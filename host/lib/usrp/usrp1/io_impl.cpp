@@ -16,6 +16,7 @@
 //
 
 #include "validate_subdev_spec.hpp"
+#include "streamer_args.hpp"
 #define SRPH_DONT_CHECK_SEQUENCE
 #include "../../transport/super_recv_packet_handler.hpp"
 #define SSPH_DONT_PAD_TO_ONE
@@ -23,6 +24,7 @@
 #include "usrp1_calc_mux.hpp"
 #include "usrp1_impl.hpp"
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/fastpath.hpp>
 #include <uhd/utils/tasks.hpp>
 #include <uhd/utils/safe_call.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
@@ -248,7 +250,7 @@ void usrp1_impl::io_init(void){
     //create a new vandal thread to poll xerflow conditions
     _io_impl->vandal_task = task::make(boost::bind(
         &usrp1_impl::vandal_conquest_loop, this
-    ));
+    ), "async", "async messages");
 }
 
 void usrp1_impl::rx_stream_on_off(bool enb){
@@ -305,12 +307,13 @@ void usrp1_impl::vandal_conquest_loop(void){
         if (_tx_enabled and underflow){
             async_metadata.time_spec = _soft_time_ctrl->get_time();
             _soft_time_ctrl->get_async_queue().push_with_pop_on_full(async_metadata);
-            UHD_MSG(fastpath) << "U";
+            fastpath::post_event(fastpath::EVENT_UNDERFLOW, 0, true, async_metadata.time_spec);
         }
         if (_rx_enabled and overflow){
             inline_metadata.time_spec = _soft_time_ctrl->get_time();
             _soft_time_ctrl->get_inline_queue().push_with_pop_on_full(inline_metadata);
-            UHD_MSG(fastpath) << "O";
+            _soft_time_ctrl->rx_overflow();
+            fastpath::post_event(fastpath::EVENT_OVERFLOW, 0, true, inline_metadata.time_spec);
         }
 
         boost::this_thread::sleep(boost::posix_time::milliseconds(50));
@@ -518,6 +521,7 @@ double usrp1_impl::update_rx_samp_rate(size_t dspno, const double samp_rate){
         if (my_streamer.get() != NULL){
             my_streamer->set_samp_rate(_master_clock_rate / rate);
         }
+        _soft_time_ctrl->set_samp_rate(_master_clock_rate / rate);
     }
 
     return _master_clock_rate / rate;
@@ -612,6 +616,7 @@ rx_streamer::sptr usrp1_impl::get_rx_stream(const uhd::stream_args_t &args_){
     for (size_t ch = 0; ch < _rx_subdev_spec.size(); ch++){
         args.channels.push_back(ch);
     }
+    const streamer_args_t streamer_args(args);
 
     if (args.otw_format == "sc16"){
         _iface->poke32(FR_RX_FORMAT, 0
@@ -658,6 +663,9 @@ rx_streamer::sptr usrp1_impl::get_rx_stream(const uhd::stream_args_t &args_){
     if (args.otw_format == "sc8")
         my_streamer->set_scale_factor(1.0/127);
 
+    //resample on the host where the hardware cannot reach the rate
+    my_streamer->set_host_decim(streamer_args.get_host_decim());
+
     //save as weak ptr for update access
     _rx_streamer = my_streamer;
 
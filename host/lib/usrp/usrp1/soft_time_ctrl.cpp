@@ -17,6 +17,7 @@
 
 #include "soft_time_ctrl.hpp"
 #include <uhd/utils/tasks.hpp>
+#include <uhd/utils/log.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -29,6 +30,12 @@ namespace pt = boost::posix_time;
 
 static const time_spec_t TWIDDLE(0.0011);
 
+//! Busy-wait this long before a timed event instead of trusting the scheduler
+static const double SPIN_TAIL_SECS = 200e-6;
+
+//! Max number of stream commands that can be pending
+static const size_t CMD_QUEUE_DEPTH = 16;
+
 soft_time_ctrl::~soft_time_ctrl(void){
     /* NOP */
 }
@@ -42,7 +49,10 @@ public:
     soft_time_ctrl_impl(const cb_fcn_type &stream_on_off):
         _nsamps_remaining(0),
         _stream_mode(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS),
-        _cmd_queue(2),
+        _samp_rate(0.0),
+        _nsamps_since_start(0),
+        _timing_error(0.0),
+        _cmd_queue(CMD_QUEUE_DEPTH),
         _async_msg_queue(1000),
         _inline_msg_queue(1000),
         _stream_on_off(stream_on_off)
@@ -72,13 +82,47 @@ public:
         return time_spec_t::get_system_time() - _time_offset;
     }
 
+    /*!
+     * Sleep until the given device time and record the achieved error.
+     * The scheduler only gets the coarse part of the wait; the last
+     * SPIN_TAIL_SECS are spent polling the system clock, without the
+     * lock held, so the wakeup does not depend on timer slack.
+     */
     UHD_INLINE void sleep_until_time(
         boost::mutex::scoped_lock &lock, const time_spec_t &time
     ){
-        boost::condition_variable cond;
-        //use a condition variable to unlock, sleep, lock
-        double seconds_to_sleep = (time - time_now()).get_real_secs();
-        cond.timed_wait(lock, pt::microseconds(long(seconds_to_sleep*1e6)));
+        const double seconds_to_sleep = (time - time_now()).get_real_secs() - SPIN_TAIL_SECS;
+        if (seconds_to_sleep > 0){
+            boost::condition_variable cond;
+            //use a condition variable to unlock, sleep, lock
+            cond.timed_wait(lock, pt::microseconds(long(seconds_to_sleep*1e6)));
+        }
+
+        const time_spec_t system_time_at = time + _time_offset;
+        lock.unlock();
+        while (time_spec_t::get_system_time() < system_time_at){
+            /* spin */
+        }
+        lock.lock();
+
+        _timing_error = (time_now() - time).get_real_secs();
+        UHD_LOG << "soft_time_ctrl: timed event error " << _timing_error*1e6 << " us" << std::endl;
+    }
+
+    void set_samp_rate(const double rate){
+        boost::mutex::scoped_lock lock(_update_mutex);
+        _samp_rate = rate;
+    }
+
+    void rx_overflow(void){
+        boost::mutex::scoped_lock lock(_update_mutex);
+        _stream_start_time = time_now();
+        _nsamps_since_start = 0;
+    }
+
+    double get_timing_error(void){
+        boost::mutex::scoped_lock lock(_update_mutex);
+        return _timing_error;
     }
 
     /*******************************************************************
@@ -93,9 +137,17 @@ public:
             if (_inline_msg_queue.pop_with_haste(md)) return 0;
         }
 
-        //load the metadata with the expected time
+        //load the metadata with the expected time:
+        //count samples from the start of the stream when the rate is known,
+        //the system clock at the time of reception is much noisier
         md.has_time_spec = true;
-        md.time_spec = time_now();
+        if (_samp_rate > 0.0 and _stream_mode != stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS){
+            md.time_spec = _stream_start_time + time_spec_t::from_ticks(_nsamps_since_start, _samp_rate);
+        }
+        else{
+            md.time_spec = time_now();
+        }
+        _nsamps_since_start += nsamps;
 
         //none of the stuff below matters in continuous streaming mode
         if (_stream_mode == stream_cmd_t::STREAM_MODE_START_CONTINUOUS) return nsamps;
@@ -127,9 +179,11 @@ public:
         _cmd_queue.push_with_wait(boost::make_shared<stream_cmd_t>(cmd));
     }
 
-    void stream_on_off(bool enb){
+    void stream_on_off(bool enb, const time_spec_t &time){
         _stream_on_off(enb);
         _nsamps_remaining = 0;
+        _stream_start_time = time;
+        _nsamps_since_start = 0;
     }
 
     /*******************************************************************
@@ -164,7 +218,11 @@ public:
         boost::mutex::scoped_lock lock(_update_mutex);
 
         //handle the stream at time by sleeping
-        if (not cmd.stream_now){
+        time_spec_t stream_time = cmd.time_spec;
+        if (cmd.stream_now){
+            stream_time = time_now();
+        }
+        else{
             time_spec_t time_at(cmd.time_spec - TWIDDLE);
             if (time_at < time_now()){
                 rx_metadata_t metadata;
@@ -184,13 +242,13 @@ public:
         //Stop streaming when the command is a stop and streaming.
         if (cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS
            and _stream_mode != stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS
-        ) stream_on_off(false);
+        ) stream_on_off(false, stream_time);
 
         //When to start streaming:
         //Start streaming when the command is not a stop and not streaming.
         if (cmd.stream_mode != stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS
            and _stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS
-        ) stream_on_off(true);
+        ) stream_on_off(true, stream_time);
 
         //update the state
         _nsamps_remaining += cmd.num_samps;
@@ -201,6 +259,12 @@ public:
         boost::shared_ptr<stream_cmd_t> cmd;
         _cmd_queue.pop_with_wait(cmd);
         recv_cmd_handle_cmd(*cmd);
+
+        //handle the rest of the batch without going back to sleep,
+        //commands issued back-to-back are applied in one go
+        while (_cmd_queue.pop_with_haste(cmd)){
+            recv_cmd_handle_cmd(*cmd);
+        }
     }
 
     bounded_buffer<async_metadata_t> &get_async_queue(void){
@@ -220,6 +284,10 @@ private:
     size_t _nsamps_remaining;
     stream_cmd_t::stream_mode_t _stream_mode;
     time_spec_t _time_offset;
+    double _samp_rate;
+    time_spec_t _stream_start_time;
+    size_t _nsamps_since_start;
+    double _timing_error;
     bounded_buffer<boost::shared_ptr<stream_cmd_t> > _cmd_queue;
     bounded_buffer<async_metadata_t> _async_msg_queue;
     bounded_buffer<rx_metadata_t> _inline_msg_queue;
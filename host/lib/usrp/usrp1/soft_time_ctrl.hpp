@@ -55,6 +55,19 @@ public:
     //! Get the current time
     virtual time_spec_t get_time(void) = 0;
 
+    /*!
+     * Set the RX sample rate.
+     * Receive timestamps are derived from the number of samples
+     * received since the stream started at this rate.
+     */
+    virtual void set_samp_rate(const double rate) = 0;
+
+    //! Call when RX samples were dropped (restarts the sample count)
+    virtual void rx_overflow(void) = 0;
+
+    //! Get the error of the last timed event (actual minus requested time, in seconds)
+    virtual double get_timing_error(void) = 0;
+
     //! Call after the internal recv function
     virtual size_t recv_post(rx_metadata_t &md, const size_t nsamps) = 0;
 
@@ -271,8 +271,8 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
     ////////////////////////////////////////////////////////////////////
     // and do the misc mboard sensors
     ////////////////////////////////////////////////////////////////////
-    //none for now...
-    _tree->create<int>(mb_path / "sensors"); //phony property so this dir exists
+    _tree->create<sensor_value_t>(mb_path / "sensors/soft_time_error")
+        .set_publisher(boost::bind(&usrp1_impl::get_soft_time_error, this));
 
     ////////////////////////////////////////////////////////////////////
     // create frontend control objects
@@ -507,3 +507,9 @@ void usrp1_impl::set_reg(const std::pair<uint8_t, uint32_t> &reg)
 {
     _iface->poke32(reg.first, reg.second);
 }
+
+sensor_value_t usrp1_impl::get_soft_time_error(void){
+    //soft time control has no hardware timing, this is how late (positive)
+    //or early the host managed to apply the last timed command
+    return sensor_value_t("Soft Time Error", _soft_time_ctrl->get_timing_error()*1e6, "us");
+}
@@ -25,6 +25,7 @@
 #include <uhd/types/otw_type.hpp>
 #include <uhd/types/clock_config.hpp>
 #include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/sensors.hpp>
 #include <uhd/usrp/dboard_id.hpp>
 #include <uhd/usrp/mboard_eeprom.hpp>
 #include <uhd/usrp/subdev_spec.hpp>
@@ -108,6 +109,7 @@ private:
     void update_rx_subdev_spec(const uhd::usrp::subdev_spec_t &);
     void update_tx_subdev_spec(const uhd::usrp::subdev_spec_t &);
     double update_rx_samp_rate(size_t dspno, const double);
+    uhd::sensor_value_t get_soft_time_error(void);
     double update_tx_samp_rate(size_t dspno, const double);
     void update_rates(void);
     double update_rx_dsp_freq(const size_t, const double);
@@ -35,6 +35,7 @@
 #include <boost/asio.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/atomic.hpp>
 #include <iostream>
 
 using namespace uhd;
@@ -59,6 +60,9 @@ static const size_t vrt_send_header_offset_words32 = 1;
  * flow control monitor for a single tx channel
  *  - the pirate thread calls update
  *  - the get send buffer calls check
+ * The sender owns the sequence out, the pirate thread stores the last
+ * ACK atomically. The sender spins on it for a short while and only
+ * sleeps on the condition when there is still no credit.
  **********************************************************************/
 class flow_control_monitor{
 public:
@@ -69,7 +73,7 @@ public:
      * Make a new flow control monitor.
      * \param max_seqs_out num seqs before throttling
      */
-    flow_control_monitor(seq_type max_seqs_out):_max_seqs_out(max_seqs_out){
+    flow_control_monitor(seq_type max_seqs_out):_waiting(false), _max_seqs_out(max_seqs_out){
         this->clear();
         _ready_fcn = boost::bind(&flow_control_monitor::ready, this);
     }
@@ -95,10 +99,20 @@ public:
      * \return false on timeout
      */
     UHD_INLINE bool check_fc_condition(double timeout){
+        static const size_t spins_before_wait = 1000;
+        for (size_t spins = 0; spins < spins_before_wait; spins++){
+            if (this->ready()) return true;
+        }
+
+        //The flag is set before the condition is checked again and the
+        //pirate stores the ACK before it checks the flag, so a wake-up
+        //can't be missed.
         boost::mutex::scoped_lock lock(_fc_mutex);
-        if (this->ready()) return true;
         boost::this_thread::disable_interruption di; //disable because the wait can throw
-        return _fc_cond.timed_wait(lock, to_time_dur(timeout), _ready_fcn);
+        _waiting = true;
+        const bool ready = _fc_cond.timed_wait(lock, to_time_dur(timeout), _ready_fcn);
+        _waiting = false;
+        return ready;
     }
 
     /*!
@@ -106,20 +120,23 @@ public:
      * \param seq the last sequence number to be ACK'd
      */
     UHD_INLINE void update_fc_condition(seq_type seq){
-        boost::mutex::scoped_lock lock(_fc_mutex);
         _last_seq_ack = seq;
-        lock.unlock();
-        _fc_cond.notify_one();
+        if (_waiting.load()){
+            boost::mutex::scoped_lock lock(_fc_mutex);
+            _fc_cond.notify_one();
+        }
     }
 
 private:
     bool ready(void){
-        return seq_type(_last_seq_out -_last_seq_ack) < _max_seqs_out;
+        return seq_type(_last_seq_out -_last_seq_ack.load()) < _max_seqs_out;
     }
 
     boost::mutex _fc_mutex;
     boost::condition _fc_cond;
-    seq_type _last_seq_out, _last_seq_ack;
+    boost::atomic<bool> _waiting; //the sender sleeps on _fc_cond
+    seq_type _last_seq_out;
+    boost::atomic<seq_type> _last_seq_ack;
     const seq_type _max_seqs_out;
     boost::function<bool(void)> _ready_fcn;
 };
@@ -180,7 +197,11 @@ struct usrp2_impl::io_impl{
 void usrp2_impl::io_impl::recv_pirate_loop(
     zero_copy_if::sptr err_xport, size_t index
 ){
-    set_thread_priority_safe();
+    //a configured priority for the role was applied already
+    thread_config_t config;
+    if (not get_thread_config("async", config) or not config.set_priority){
+        set_thread_priority_safe();
+    }
 
     //store a reference to the flow control monitor (offset by max dsps)
     flow_control_monitor &fc_mon = *(this->fc_mons[index]);
@@ -253,7 +274,7 @@ void usrp2_impl::io_init(void){
         _io_impl->pirate_tasks.push_back(task::make(boost::bind(
             &usrp2_impl::io_impl::recv_pirate_loop, _io_impl.get(),
             _mbc[mb].tx_dsp_xport, index++
-        )));
+        ), "async", "async messages"));
     }
 }
 
@@ -440,7 +461,7 @@ rx_streamer::sptr usrp2_impl::get_rx_stream(const uhd::stream_args_t &args_){
 
     //init some streamer stuff
     my_streamer->resize(args.channels.size());
-    my_streamer->set_vrt_unpacker(&vrt::if_hdr_unpack_be);
+    my_streamer->set_vrt_unpacker(&vrt::if_hdr_unpack_cached_be);
 
     //set the converter
     uhd::convert::id_type id;
@@ -454,6 +475,7 @@ rx_streamer::sptr usrp2_impl::get_rx_stream(const uhd::stream_args_t &args_){
     for (size_t chan_i = 0; chan_i < args.channels.size(); chan_i++){
         const size_t chan = args.channels[chan_i];
         size_t num_chan_so_far = 0;
+        size_t mb_index = 0;
         BOOST_FOREACH(const std::string &mb, _mbc.keys()){
             num_chan_so_far += _mbc[mb].rx_chan_occ;
             if (chan < num_chan_so_far){
@@ -464,11 +486,13 @@ rx_streamer::sptr usrp2_impl::get_rx_stream(const uhd::stream_args_t &args_){
                 my_streamer->set_xport_chan_get_buff(chan_i, boost::bind(
                     &zero_copy_if::get_recv_buff, _mbc[mb].rx_dsp_xports[dsp], _1
                 ), true /*flush*/);
+                //the commands to each motherboard go out in parallel
                 my_streamer->set_issue_stream_cmd(chan_i, boost::bind(
-                    &rx_dsp_core_200::issue_stream_command, _mbc[mb].rx_dsps[dsp], _1));
+                    &rx_dsp_core_200::issue_stream_command, _mbc[mb].rx_dsps[dsp], _1), mb_index);
                 _mbc[mb].rx_streamers[dsp] = my_streamer; //store weak pointer
                 break;
             }
+            mb_index++;
         }
     }
 
@@ -254,6 +254,20 @@ public:
         return result;
     }
 
+    //override read_eeprom so we can write the offset once, then read sequentially
+    //as many bytes as fit into a control packet; the default reads byte by byte
+    byte_vector_t read_eeprom(uint16_t addr, uint16_t offset, size_t num_bytes){
+        static const size_t chunk_max_len = sizeof(usrp2_ctrl_data_t().data.i2c_args.data);
+        byte_vector_t bytes;
+        while (bytes.size() < num_bytes){
+            const size_t chunk_len = std::min(num_bytes - bytes.size(), chunk_max_len);
+            this->write_i2c(addr, byte_vector_t(1, uint8_t(offset + bytes.size())));
+            const byte_vector_t chunk = this->read_i2c(addr, chunk_len);
+            bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+        }
+        return bytes;
+    }
+
 /***********************************************************************
  * Send/Recv over control
  **********************************************************************/
@@ -23,6 +23,7 @@
 #include <uhd/exception.hpp>
 #include <uhd/transport/if_addrs.hpp>
 #include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/transport/buffer_pool.hpp>
 #include <uhd/types/ranges.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/utils/static.hpp>
@@ -288,6 +289,8 @@ static zero_copy_if::sptr make_xport(
         if (key.find(filter) == std::string::npos) continue;
         filtered_hints[key] = hints[key];
     }
+    //and the buffer allocation policy (hugepages, NUMA, mlock)
+    buffer_pool::alloc_policy_t::forward_hints(hints, filtered_hints);
 
     zero_copy_xport_params default_buff_args;
     default_buff_args.send_frame_size = transport::udp_simple::mtu;
@@ -68,12 +68,20 @@ struct uhd_tx_streamer {
     size_t usrp_index;
     size_t streamer_index;
     std::string last_error;
+    //! The streamer and its channel count, for the fast path; shares
+    //! ownership so the handle stays valid after uhd_usrp_free()
+    uhd::tx_streamer::sptr streamer;
+    size_t num_channels;
 };
 
 struct uhd_rx_streamer {
     size_t usrp_index;
     size_t streamer_index;
     std::string last_error;
+    //! The streamer and its channel count, for the fast path; shares
+    //! ownership so the handle stays valid after uhd_usrp_free()
+    uhd::rx_streamer::sptr streamer;
+    size_t num_channels;
 };
 
 /* Not public: We use this for our internal registry */
@@ -102,6 +110,7 @@ uhd_error uhd_rx_streamer_make(uhd_rx_streamer_handle* h){
     UHD_SAFE_C(
         boost::mutex::scoped_lock(_rx_streamer_make_mutex);
         (*h) = new uhd_rx_streamer;
+        (*h)->num_channels = 0;
     )
 }
 
@@ -143,6 +152,36 @@ uhd_error uhd_rx_streamer_recv(
     )
 }
 
+uhd_error uhd_rx_streamer_recv_fast(
+    uhd_rx_streamer_handle h,
+    void **buffs,
+    size_t samps_per_buff,
+    uhd_rx_metadata_info_t *md,
+    double timeout,
+    bool one_packet,
+    size_t *items_recvd
+){
+    UHD_SAFE_C_SAVE_ERROR_ON_FAIL(h,
+        if (not h->streamer){
+            throw uhd::runtime_error("uhd_rx_streamer_recv_fast: the streamer was not made by uhd_usrp_get_rx_stream");
+        }
+        uhd::rx_metadata_t md_cpp;
+        *items_recvd = h->streamer->recv(
+            uhd::rx_streamer::buffs_type(buffs, h->num_channels),
+            samps_per_buff, md_cpp, timeout, one_packet
+        );
+        md->has_time_spec       = md_cpp.has_time_spec;
+        md->time_spec_full_secs = md_cpp.time_spec.get_full_secs();
+        md->time_spec_frac_secs = md_cpp.time_spec.get_frac_secs();
+        md->more_fragments      = md_cpp.more_fragments;
+        md->fragment_offset     = md_cpp.fragment_offset;
+        md->start_of_burst      = md_cpp.start_of_burst;
+        md->end_of_burst        = md_cpp.end_of_burst;
+        md->out_of_sequence     = md_cpp.out_of_sequence;
+        md->error_code          = uhd_rx_metadata_error_code_t(md_cpp.error_code);
+    )
+}
+
 uhd_error uhd_rx_streamer_issue_stream_cmd(
     uhd_rx_streamer_handle h,
     const uhd_stream_cmd_t *stream_cmd
@@ -173,6 +212,7 @@ uhd_error uhd_tx_streamer_make(
     UHD_SAFE_C(
         boost::mutex::scoped_lock lock(_tx_streamer_make_mutex);
         (*h) = new uhd_tx_streamer;
+        (*h)->num_channels = 0;
     )
 }
 
@@ -224,6 +264,30 @@ uhd_error uhd_tx_streamer_send(
     )
 }
 
+uhd_error uhd_tx_streamer_send_fast(
+    uhd_tx_streamer_handle h,
+    const void **buffs,
+    size_t samps_per_buff,
+    const uhd_tx_metadata_info_t *md,
+    double timeout,
+    size_t *items_sent
+){
+    UHD_SAFE_C_SAVE_ERROR_ON_FAIL(h,
+        if (not h->streamer){
+            throw uhd::runtime_error("uhd_tx_streamer_send_fast: the streamer was not made by uhd_usrp_get_tx_stream");
+        }
+        uhd::tx_metadata_t md_cpp;
+        md_cpp.has_time_spec  = md->has_time_spec;
+        md_cpp.time_spec      = uhd::time_spec_t(md->time_spec_full_secs, md->time_spec_frac_secs);
+        md_cpp.start_of_burst = md->start_of_burst;
+        md_cpp.end_of_burst   = md->end_of_burst;
+        *items_sent = h->streamer->send(
+            uhd::tx_streamer::buffs_type(buffs, h->num_channels),
+            samps_per_buff, md_cpp, timeout
+        );
+    )
+}
+
 uhd_error uhd_tx_streamer_recv_async_msg(
     uhd_tx_streamer_handle h,
     uhd_async_metadata_handle *md,
@@ -337,6 +401,8 @@ uhd_error uhd_usrp_get_rx_stream(
         );
         h_s->usrp_index     = h_u->usrp_index;
         h_s->streamer_index = usrp.rx_streamers.size() - 1;
+        h_s->streamer       = usrp.rx_streamers.back();
+        h_s->num_channels   = h_s->streamer->get_num_channels();
     )
 }
 
@@ -359,6 +425,8 @@ uhd_error uhd_usrp_get_tx_stream(
         );
         h_s->usrp_index     = h_u->usrp_index;
         h_s->streamer_index = usrp.tx_streamers.size() - 1;
+        h_s->streamer       = usrp.tx_streamers.back();
+        h_s->num_channels   = h_s->streamer->get_num_channels();
     )
 }
 
@@ -59,25 +59,13 @@ public:
         _ads62p48_regs.clk_out_neg_edge = ads62p48_regs_t::CLK_OUT_NEG_EDGE_MINUS4_26;
 
 
-        this->send_ads62p48_reg(0);
-        this->send_ads62p48_reg(0x20);
-        this->send_ads62p48_reg(0x3f);
-        this->send_ads62p48_reg(0x40);
-        this->send_ads62p48_reg(0x41);
-        this->send_ads62p48_reg(0x44);
-        this->send_ads62p48_reg(0x50);
-        this->send_ads62p48_reg(0x51);
-        this->send_ads62p48_reg(0x52);
-        this->send_ads62p48_reg(0x53);
-        this->send_ads62p48_reg(0x55);
-        this->send_ads62p48_reg(0x57);
-        this->send_ads62p48_reg(0x62);
-        this->send_ads62p48_reg(0x63);
-        this->send_ads62p48_reg(0x66);
-        this->send_ads62p48_reg(0x68);
-        this->send_ads62p48_reg(0x6a);
-        this->send_ads62p48_reg(0x75);
-        this->send_ads62p48_reg(0x76);
+        static const uint8_t init_addrs[] = {
+            0x00, 0x20, 0x3f, 0x40, 0x41, 0x44, 0x50, 0x51, 0x52, 0x53,
+            0x55, 0x57, 0x62, 0x63, 0x66, 0x68, 0x6a, 0x75, 0x76
+        };
+        this->send_ads62p48_regs(std::vector<uint8_t>(
+            init_addrs, init_addrs + sizeof(init_addrs)/sizeof(init_addrs[0])
+        ));
 
     }
 
@@ -136,6 +124,16 @@ private:
         uint16_t reg = _ads62p48_regs.get_write_reg(addr);
         _iface->write_spi(_slaveno, spi_config_t::EDGE_FALL, reg, 16);
     }
+
+    //! Send several registers in one SPI batch
+    void send_ads62p48_regs(const std::vector<uint8_t> &addrs)
+    {
+        std::vector<uint32_t> regs;
+        for (size_t i = 0; i < addrs.size(); i++) {
+            regs.push_back(_ads62p48_regs.get_write_reg(addrs[i]));
+        }
+        _iface->transact_spi_batch(_slaveno, spi_config_t::EDGE_FALL, regs, 16, false);
+    }
 };
 
 /***********************************************************************
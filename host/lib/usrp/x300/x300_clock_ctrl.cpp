@@ -22,6 +22,8 @@
 #include <stdint.h>
 #include <boost/format.hpp>
 #include <boost/math/special_functions/round.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/locks.hpp>
 #include <stdexcept>
 #include <cmath>
 #include <cstdlib>
@@ -70,31 +72,32 @@ public:
         const size_t hw_rev,
         const double master_clock_rate,
         const double dboard_clock_rate,
-        const double system_ref_rate):
+        const double system_ref_rate,
+        const bool program):
         _spiface(spiface),
         _slaveno(slaveno),
         _hw_rev(hw_rev),
         _master_clock_rate(master_clock_rate),
         _dboard_clock_rate(dboard_clock_rate),
-        _system_ref_rate(system_ref_rate)
+        _system_ref_rate(system_ref_rate),
+        _program(program)
     {
         init();
+        //later changes always go to the LMK
+        _program = true;
     }
 
     void reset_clocks() {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         _lmk04816_regs.RESET = lmk04816_regs_t::RESET_RESET;
         this->write_regs(0);
         _lmk04816_regs.RESET = lmk04816_regs_t::RESET_NO_RESET;
-        for (size_t i = 0; i <= 16; ++i) {
-            this->write_regs(i);
-        }
-        for (size_t i = 24; i <= 31; ++i) {
-            this->write_regs(i);
-        }
+        this->write_all_regs(0);
         sync_clocks();
     }
 
     void sync_clocks(void) {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         //soft sync:
         //put the sync IO into output mode - FPGA must be input
         //write low, then write high - this triggers a soft sync
@@ -118,6 +121,7 @@ public:
     }
 
     void set_dboard_rate(const x300_clock_which_t which, double rate) {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         uint16_t div = uint16_t(_vco_freq / rate);
         uint16_t *reg = NULL;
         uint8_t addr = 0xFF;
@@ -162,6 +166,7 @@ public:
 
     double get_dboard_rate(const x300_clock_which_t which)
     {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         double rate = 0.0;
         switch (which)
         {
@@ -189,6 +194,7 @@ public:
 
     void enable_dboard_clock(const x300_clock_which_t which, const bool enable)
     {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         switch (which)
         {
         case X300_CLOCK_WHICH_DB0_RX:
@@ -225,6 +231,7 @@ public:
     }
 
     void set_ref_out(const bool enable) {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         // TODO  Implement divider configuration to allow for configurable output
         // rates
         if (enable)
@@ -235,11 +242,26 @@ public:
     }
 
     void write_regs(uint8_t addr) {
+        if (not _program) return;
         uint32_t data = _lmk04816_regs.get_reg(addr);
         _spiface->write_spi(_slaveno, spi_config_t::EDGE_RISE, data,32);
     }
 
+    //! Write registers first..16 and 24..31 in one SPI batch
+    void write_all_regs(uint8_t first) {
+        if (not _program) return;
+        std::vector<uint32_t> data;
+        for (uint8_t addr = first; addr <= 16; ++addr) {
+            data.push_back(_lmk04816_regs.get_reg(addr));
+        }
+        for (uint8_t addr = 24; addr <= 31; ++addr) {
+            data.push_back(_lmk04816_regs.get_reg(addr));
+        }
+        _spiface->transact_spi_batch(_slaveno, spi_config_t::EDGE_RISE, data, 32, false);
+    }
+
     double set_clock_delay(const x300_clock_which_t which, const double delay_ns, const bool resync = true) {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         //All dividers have are delayed by 5 taps by default. The delay
         //set by this function is relative to the 5 tap delay
         static const uint16_t DDLY_MIN_TAPS  = 5;
@@ -400,6 +422,7 @@ public:
     }
 
     double get_clock_delay(const x300_clock_which_t which) {
+        boost::lock_guard<boost::recursive_mutex> lock(_mutex);
         switch (which)
         {
         case X300_CLOCK_WHICH_FPGA:
@@ -718,12 +741,7 @@ private:
         set_clock_delay(X300_CLOCK_WHICH_DAC0,   _delays.dac_dly_ns,   false);  //Sets both Ch0 and Ch1
 
         /* Write the configuration values into the LMK */
-        for (size_t i = 1; i <= 16; ++i) {
-            this->write_regs(i);
-        }
-        for (size_t i = 24; i <= 31; ++i) {
-            this->write_regs(i);
-        }
+        this->write_all_regs(1);
 
         this->sync_clocks();
     }
@@ -734,9 +752,13 @@ private:
     const double            _master_clock_rate;
     const double            _dboard_clock_rate;
     const double            _system_ref_rate;
+    //! When false, only the register shadows are updated
+    bool                    _program;
     lmk04816_regs_t         _lmk04816_regs;
     double                  _vco_freq;
     x300_clk_delays         _delays;
+    //! The radios of a motherboard set up their dboards in parallel
+    boost::recursive_mutex  _mutex;
 };
 
 x300_clock_ctrl::sptr x300_clock_ctrl::make(uhd::spi_iface::sptr spiface,
@@ -744,7 +766,8 @@ x300_clock_ctrl::sptr x300_clock_ctrl::make(uhd::spi_iface::sptr spiface,
         const size_t hw_rev,
         const double master_clock_rate,
         const double dboard_clock_rate,
-        const double system_ref_rate) {
+        const double system_ref_rate,
+        const bool program) {
     return sptr(new x300_clock_ctrl_impl(spiface, slaveno, hw_rev,
-                master_clock_rate, dboard_clock_rate, system_ref_rate));
+                master_clock_rate, dboard_clock_rate, system_ref_rate, program));
 }
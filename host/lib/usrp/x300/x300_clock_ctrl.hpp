@@ -44,12 +44,18 @@ public:
 
     virtual ~x300_clock_ctrl(void) = 0;
 
+    /*! Make the LMK control and program the LMK.
+     * With program = false, the register shadows are set up for the given
+     * rates but nothing is written, for an LMK that still runs this
+     * configuration (see x300_warm_state.hpp). Later changes are written.
+     */
     static sptr make(uhd::spi_iface::sptr spiface,
             const size_t slaveno,
             const size_t hw_rev,
             const double master_clock_rate,
             const double dboard_clock_rate,
-            const double system_ref_rate);
+            const double system_ref_rate,
+            const bool program = true);
 
     /*! Get the master clock rate of the device.
      * \return the clock frequency in Hz
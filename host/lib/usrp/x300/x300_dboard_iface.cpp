@@ -187,6 +187,19 @@ void x300_dboard_iface::write_spi(
     _config.spi->write_spi(int(slave), config, data, num_bits);
 }
 
+void x300_dboard_iface::write_spi_batch(
+    unit_t unit,
+    const spi_config_t &config,
+    const std::vector<uint32_t> &data,
+    size_t num_bits
+){
+    uint32_t slave = 0;
+    if (unit == UNIT_TX) slave |= _config.tx_spi_slaveno;
+    if (unit == UNIT_RX) slave |= _config.rx_spi_slaveno;
+
+    _config.spi->transact_spi_batch(int(slave), config, data, num_bits, false);
+}
+
 uint32_t x300_dboard_iface::read_write_spi(
     unit_t unit,
     const spi_config_t &config,
@@ -299,6 +312,29 @@ void x300_dboard_iface::set_command_time(const uhd::time_spec_t& t)
     _config.cmd_time_ctrl->set_time(t);
 }
 
+void x300_dboard_iface::sleep(const boost::chrono::nanoseconds& time)
+{
+    //The writes of a timed sequence execute from the command FIFO at their
+    //command time, so a wait between them has to be spaced out in device
+    //time. Sleeping on the host would only delay queueing them.
+    const uhd::time_spec_t cmd_time = this->get_command_time();
+    if (cmd_time != uhd::time_spec_t(0.0)) {
+        this->set_command_time(cmd_time + uhd::time_spec_t(time.count() * 1e-9));
+    } else {
+        dboard_iface::sleep(time);
+    }
+}
+
+void x300_dboard_iface::begin_batch(void)
+{
+    _config.batch_ctrl->begin_batch();
+}
+
+void x300_dboard_iface::commit_batch(void)
+{
+    _config.batch_ctrl->commit();
+}
+
 void x300_dboard_iface::add_rx_fe(
     const std::string& fe_name,
     rx_frontend_core_3000::sptr fe_core)
@@ -40,6 +40,7 @@ struct x300_dboard_iface_config_t
     x300_clock_which_t                          which_tx_clk;
     uint8_t                              dboard_slot;
     uhd::timed_wb_iface::sptr                   cmd_time_ctrl;
+    uhd::wb_iface::sptr                         batch_ctrl;
 };
 
 class x300_dboard_iface : public uhd::usrp::dboard_iface
@@ -70,7 +71,10 @@ public:
     uint32_t read_gpio(unit_t unit);
 
     void set_command_time(const uhd::time_spec_t& t);
+    void begin_batch(void);
+    void commit_batch(void);
     uhd::time_spec_t get_command_time(void);
+    void sleep(const boost::chrono::nanoseconds& time);
 
     void write_i2c(uint16_t, const uhd::byte_vector_t &);
     uhd::byte_vector_t read_i2c(uint16_t, size_t);
@@ -88,6 +92,13 @@ public:
         size_t num_bits
     );
 
+    void write_spi_batch(
+        unit_t unit,
+        const uhd::spi_config_t &config,
+        const std::vector<uint32_t> &data,
+        size_t num_bits
+    );
+
     uint32_t read_write_spi(
         unit_t unit,
         const uhd::spi_config_t &config,
@@ -32,7 +32,7 @@ extern "C" {
 #define X300_REVISION_COMPAT 7
 #define X300_REVISION_MIN    2
 #define X300_FW_COMPAT_MAJOR 5
-#define X300_FW_COMPAT_MINOR 1
+#define X300_FW_COMPAT_MINOR 2
 #define X300_FPGA_COMPAT_MAJOR 0x21
 
 //shared memory sections - in between the stack and the program space
@@ -50,6 +50,10 @@ extern "C" {
 #define X300_FW_SHMEM_ROUTE_MAP_ADDR 11
 #define X300_FW_SHMEM_ROUTE_MAP_LEN 12
 #define X300_FW_SHMEM_IDENT 13 // (13-39) EEPROM values in use
+#define X300_FW_SHMEM_NET_PKTS 40 // packets handled by the network stack
+#define X300_FW_SHMEM_NET_CTRL_PKTS 41 // of those, control (fw comms) packets
+#define X300_FW_SHMEM_NET_MAX_BACKLOG 42 // most packets found waiting back to back
+#define X300_FW_SHMEM_WARM_STATE 43 // hash of the host configuration the hardware runs, 0 if unknown
 #define X300_FW_SHMEM_DEBUG 128
 #define X300_FW_SHMEM_ADDR(offset) X300_FW_SHMEM_BASE + (4 * (offset))
 
@@ -90,6 +94,7 @@ extern "C" {
 #define X300_FPGA_PROG_FLAGS_VERIFY    (1 << 5)
 #define X300_FPGA_PROG_CONFIGURE       (1 << 6)
 #define X300_FPGA_PROG_CONFIG_STATUS   (1 << 7)
+#define X300_FPGA_PROG_FLAGS_CHECKSUM  (1 << 8)
 
 #define X300_MTU_DETECT_ECHO_REQUEST (1 << 0)
 #define X300_MTU_DETECT_ECHO_REPLY (1 << 1)
@@ -141,6 +146,17 @@ typedef struct
     uint32_t flags;
 } x300_fpga_prog_flags_t;
 
+//Reply to an FPGA programming packet: the flags, followed by the
+//sector and index it acknowledges and the checksum when requested.
+//Older firmware only replies with the flags.
+typedef struct
+{
+    uint32_t flags;
+    uint32_t sector;
+    uint32_t index;
+    uint32_t checksum;
+} x300_fpga_prog_reply_t;
+
 typedef struct
 {
     uint32_t flags;
@@ -26,6 +26,7 @@
 #include <uhd/transport/nirio/status.h>
 #include <uhd/transport/nirio/niriok_proxy.h>
 #include "x300_regs.hpp"
+#include "../common/fw_ctrl_window.hpp"
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread/thread.hpp>
 
@@ -106,7 +107,9 @@ class x300_ctrl_iface_enet : public x300_ctrl_iface
 {
 public:
     x300_ctrl_iface_enet(uhd::transport::udp_simple::sptr udp, bool enable_errors = true):
-        x300_ctrl_iface(enable_errors), udp(udp), seq(0)
+        x300_ctrl_iface(enable_errors),
+        window(udp, &x300_ctrl_iface_enet::check_reply, "x300 fw", enable_errors),
+        batch_depth(0)
     {
         try
         {
@@ -115,34 +118,68 @@ public:
         catch(...){}
     }
 
+    //The window sends requests again itself, so there is no retry loop here
+    void poke32(const wb_addr_type addr, const uint32_t data)
+    {
+        boost::mutex::scoped_lock lock(reg_access);
+        try
+        {
+            this->__poke32(addr, data);
+        }
+        catch(const uhd::io_error &ex)
+        {
+            if (errors) UHD_MSG(error) << "x300 fw communication failure\n" << ex.what() << std::endl;
+            throw;
+        }
+    }
+
+    uint32_t peek32(const wb_addr_type addr)
+    {
+        boost::mutex::scoped_lock lock(reg_access);
+        try
+        {
+            return this->__peek32(addr);
+        }
+        catch(const uhd::io_error &ex)
+        {
+            if (errors) UHD_MSG(error) << "x300 fw communication failure\n" << ex.what() << std::endl;
+            throw;
+        }
+    }
+
+    //Pokes of a batch go out without waiting for their replies
+    void begin_batch(void)
+    {
+        boost::mutex::scoped_lock lock(reg_access);
+        batch_depth++;
+    }
+
+    void commit(void)
+    {
+        boost::mutex::scoped_lock lock(reg_access);
+        if (batch_depth == 0 or --batch_depth != 0) return;
+        try
+        {
+            window.wait_all();
+        }
+        catch(const uhd::io_error &ex)
+        {
+            if (errors) UHD_MSG(error) << "x300 fw communication failure\n" << ex.what() << std::endl;
+            throw;
+        }
+    }
+
 protected:
     virtual void __poke32(const wb_addr_type addr, const uint32_t data)
     {
         //load request struct
         x300_fw_comms_t request = x300_fw_comms_t();
         request.flags = uhd::htonx<uint32_t>(X300_FW_COMMS_FLAGS_ACK | X300_FW_COMMS_FLAGS_POKE32);
-        request.sequence = uhd::htonx<uint32_t>(seq++);
         request.addr = uhd::htonx(addr);
         request.data = uhd::htonx(data);
 
-        //send request
-        __flush();
-        udp->send(boost::asio::buffer(&request, sizeof(request)));
-
-        //recv reply
-        x300_fw_comms_t reply = x300_fw_comms_t();
-        const size_t nbytes = udp->recv(boost::asio::buffer(&reply, sizeof(reply)), 1.0);
-        if (nbytes == 0) throw uhd::io_error("x300 fw poke32 - reply timed out");
-
-        //sanity checks
-        const size_t flags = uhd::ntohx<uint32_t>(reply.flags);
-        UHD_ASSERT_THROW(nbytes == sizeof(reply));
-        UHD_ASSERT_THROW(not (flags & X300_FW_COMMS_FLAGS_ERROR));
-        UHD_ASSERT_THROW(flags & X300_FW_COMMS_FLAGS_POKE32);
-        UHD_ASSERT_THROW(flags & X300_FW_COMMS_FLAGS_ACK);
-        UHD_ASSERT_THROW(reply.sequence == request.sequence);
-        UHD_ASSERT_THROW(reply.addr == request.addr);
-        UHD_ASSERT_THROW(reply.data == request.data);
+        if (batch_depth != 0) window.post(request);
+        else window.transact(request);
     }
 
     virtual uint32_t __peek32(const wb_addr_type addr)
@@ -150,41 +187,35 @@ protected:
         //load request struct
         x300_fw_comms_t request = x300_fw_comms_t();
         request.flags = uhd::htonx<uint32_t>(X300_FW_COMMS_FLAGS_ACK | X300_FW_COMMS_FLAGS_PEEK32);
-        request.sequence = uhd::htonx<uint32_t>(seq++);
         request.addr = uhd::htonx(addr);
         request.data = 0;
 
-        //send request
-        __flush();
-        udp->send(boost::asio::buffer(&request, sizeof(request)));
-
-        //recv reply
-        x300_fw_comms_t reply = x300_fw_comms_t();
-        const size_t nbytes = udp->recv(boost::asio::buffer(&reply, sizeof(reply)), 1.0);
-        if (nbytes == 0) throw uhd::io_error("x300 fw peek32 - reply timed out");
-
-        //sanity checks
-        const size_t flags = uhd::ntohx<uint32_t>(reply.flags);
-        UHD_ASSERT_THROW(nbytes == sizeof(reply));
-        UHD_ASSERT_THROW(not (flags & X300_FW_COMMS_FLAGS_ERROR));
-        UHD_ASSERT_THROW(flags & X300_FW_COMMS_FLAGS_PEEK32);
-        UHD_ASSERT_THROW(flags & X300_FW_COMMS_FLAGS_ACK);
-        UHD_ASSERT_THROW(reply.sequence == request.sequence);
-        UHD_ASSERT_THROW(reply.addr == request.addr);
-
         //return result!
-        return uhd::ntohx<uint32_t>(reply.data);
+        return uhd::ntohx<uint32_t>(window.transact(request).data);
     }
 
     virtual void __flush(void)
     {
-        char buff[X300_FW_COMMS_MTU] = {};
-        while (udp->recv(boost::asio::buffer(buff), 0.0)){} //flush
+        window.wait_all();
+        window.flush();
     }
 
 private:
-    uhd::transport::udp_simple::sptr udp;
-    size_t seq;
+    //! Sanity checks of a reply
+    static void check_reply(const x300_fw_comms_t &request, const x300_fw_comms_t &reply, const size_t nbytes)
+    {
+        const uint32_t cmd = uhd::ntohx<uint32_t>(request.flags) & (X300_FW_COMMS_FLAGS_PEEK32 | X300_FW_COMMS_FLAGS_POKE32);
+        const uint32_t flags = uhd::ntohx<uint32_t>(reply.flags);
+        UHD_ASSERT_THROW(nbytes == sizeof(reply));
+        UHD_ASSERT_THROW(not (flags & X300_FW_COMMS_FLAGS_ERROR));
+        UHD_ASSERT_THROW((flags & cmd) == cmd);
+        UHD_ASSERT_THROW(flags & X300_FW_COMMS_FLAGS_ACK);
+        UHD_ASSERT_THROW(reply.addr == request.addr);
+        if (cmd & X300_FW_COMMS_FLAGS_POKE32) UHD_ASSERT_THROW(reply.data == request.data);
+    }
+
+    uhd::usrp::fw_ctrl_window<x300_fw_comms_t> window;
+    size_t batch_depth;
 };
 
 
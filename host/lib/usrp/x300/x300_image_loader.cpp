@@ -15,6 +15,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -54,7 +55,10 @@ using namespace uhd::transport;
 #define X300_PACKET_SIZE_BYTES 256
 #define X300_FPGA_SECTOR_START 32
 #define X300_MAX_RESPONSE_BYTES 128
+#define X300_PACKET_SIZE_WORDS (X300_PACKET_SIZE_BYTES/2)
+#define X300_DEFAULT_WINDOW 16
 #define UDP_TIMEOUT 3
+#define RETRANSMIT_TIMEOUT 0.25
 #define FPGA_LOAD_TIMEOUT 15
 
 /*
@@ -80,6 +84,9 @@ typedef struct {
     bool                             configure; // Reload FPGA after burning to flash (Ethernet only)
     bool                             verify;    // Device will verify the download along the way (Ethernet only)
     bool                             lvbitx;
+    bool                             force;     // Rewrite sectors whose checksum already matches (Ethernet only)
+    bool                             windowed;  // Firmware echoes the location in its acks (Ethernet only)
+    size_t                           window;    // Packets in flight (Ethernet only)
     uhd::device_addr_t               dev_addr;
     std::string                      ip_addr;
     std::string                      fpga_type;
@@ -89,6 +96,7 @@ typedef struct {
     uint32_t                  size;
     udp_simple::sptr                 xport;
     std::vector<char>                bitstream; // .bin image extracted from .lvbitx file
+    image_loader::progress_fcn_t     progress;  // Reports the progress instead of printing it
     uint8_t                   data_in[udp_simple::mtu];
 } x300_session_t;
 
@@ -191,6 +199,8 @@ static void x300_setup_session(x300_session_t &session,
         session.xport = udp_simple::make_connected(session.ip_addr,
                                                    BOOST_STRINGIZE(X300_FPGA_PROG_UDP_PORT));
         session.verify = args.has_key("verify");
+        session.force = args.has_key("force");
+        session.window = std::max<size_t>(1, args.cast<size_t>("window", X300_DEFAULT_WINDOW));
     }
     else{
         session.resource = session.dev_addr["resource"];
@@ -242,6 +252,168 @@ static UHD_INLINE void x300_bitswap(uint8_t *num){
     *num = ((*num & 0xAA) >> 1) | ((*num & 0x55) << 1);
 } 
 
+/*
+ * Read the whole image, bitswapped and padded to a whole number of packets.
+ * The words are in host order, which is what the device sees after the
+ * byteswap on the way out.
+ */
+static void x300_read_image_words(x300_session_t &session, std::vector<uint16_t> &words){
+    std::vector<uint8_t> bytes(session.size);
+    if(session.lvbitx){
+        std::copy(session.bitstream.begin(), session.bitstream.begin() + session.size, bytes.begin());
+    }
+    else{
+        // Devices loaded in parallel share the mapping of the image
+        image_loader::image_file::sptr image = image_loader::map_image(session.filepath);
+        if(image->size() < session.size){
+            throw uhd::runtime_error(str(boost::format("Could not read the FPGA image at path \"%s\".")
+                                         % session.filepath));
+        }
+        std::copy(image->data(), image->data() + session.size, bytes.begin());
+    }
+
+    const size_t num_packets = (session.size + X300_PACKET_SIZE_BYTES - 1) / X300_PACKET_SIZE_BYTES;
+    bytes.resize(num_packets * X300_PACKET_SIZE_BYTES, 0);
+    for(size_t k = 0; k < bytes.size(); k++){
+        x300_bitswap(&bytes[k]);
+    }
+    words.resize(bytes.size() / 2);
+    memcpy(&words.front(), &bytes.front(), bytes.size());
+}
+
+/*
+ * Same checksum the firmware computes over flash: Fletcher, modulo 2^16.
+ */
+static uint32_t x300_checksum(const uint16_t *words, size_t num_words){
+    uint16_t sum1 = 0, sum2 = 0;
+    for(size_t k = 0; k < num_words; k++){
+        sum1 += words[k];
+        sum2 += sum1;
+    }
+    return (uint32_t(sum2) << 16) | sum1;
+}
+
+static void x300_fill_packet(x300_fpga_update_data_t &pkt_out,
+                             const uint16_t *words,
+                             size_t sector,
+                             size_t index){
+    pkt_out.sector = htonx<uint32_t>(X300_FPGA_SECTOR_START + sector);
+    pkt_out.index  = htonx<uint32_t>(index);
+    pkt_out.size   = htonx<uint32_t>(X300_PACKET_SIZE_WORDS);
+    for(size_t k = 0; k < X300_PACKET_SIZE_WORDS; k++){
+        pkt_out.data16[k] = htonx<uint16_t>(words[k]);
+    }
+}
+
+/*
+ * Like x300_send_and_recv, but skips late acks of retransmitted packets
+ * which do not belong to this request.
+ */
+static size_t x300_send_and_match(x300_session_t &session,
+                                  uint32_t pkt_code,
+                                  x300_fpga_update_data_t *pkt_out){
+    const x300_fpga_prog_reply_t *pkt_in = reinterpret_cast<const x300_fpga_prog_reply_t*>(session.data_in);
+    size_t len = x300_send_and_recv(session.xport, pkt_code, pkt_out, session.data_in);
+    while(session.windowed and len >= sizeof(x300_fpga_prog_reply_t) and
+          (pkt_in->sector != pkt_out->sector or pkt_in->index != pkt_out->index)){
+        len = session.xport->recv(boost::asio::buffer(session.data_in, udp_simple::mtu), UDP_TIMEOUT);
+    }
+    return len;
+}
+
+/*
+ * Ask the device for the checksum of num_words words at the start of a sector.
+ */
+static uint32_t x300_sector_checksum(x300_session_t &session, size_t sector, size_t num_words){
+    x300_fpga_update_data_t pkt_out;
+    const x300_fpga_prog_reply_t *pkt_in = reinterpret_cast<const x300_fpga_prog_reply_t*>(session.data_in);
+    pkt_out.sector = htonx<uint32_t>(X300_FPGA_SECTOR_START + sector);
+    pkt_out.index  = 0;
+    pkt_out.size   = htonx<uint32_t>(num_words);
+    memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
+
+    const size_t len = x300_send_and_match(session,
+                                           (X300_FPGA_PROG_FLAGS_CHECKSUM | X300_FPGA_PROG_FLAGS_ACK),
+                                           &pkt_out);
+    if(len == 0){
+        throw uhd::runtime_error("Timed out waiting for reply from device.");
+    }
+    else if(len < sizeof(x300_fpga_prog_reply_t) or (ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)){
+        throw uhd::runtime_error(str(boost::format("Device could not read back sector %d.") % sector));
+    }
+    return ntohl(pkt_in->checksum);
+}
+
+/*
+ * Write the packets of one sector, keeping up to session.window of them in
+ * flight. The first packet erases the sector, so it is sent on its own.
+ * Packets that are not acked within RETRANSMIT_TIMEOUT are sent again;
+ * rewriting a packet with the same data is harmless.
+ */
+static void x300_write_sector(x300_session_t &session,
+                              const uint16_t *words,
+                              size_t sector,
+                              size_t num_packets){
+    x300_fpga_update_data_t pkt_out;
+    const x300_fpga_prog_reply_t *pkt_in = reinterpret_cast<const x300_fpga_prog_reply_t*>(session.data_in);
+
+    uint32_t flags = X300_FPGA_PROG_FLAGS_ACK;
+    if(session.verify) flags |= X300_FPGA_PROG_FLAGS_VERIFY;
+
+    // Erase and write the first packet
+    x300_fill_packet(pkt_out, words, sector, 0);
+    size_t len = x300_send_and_match(session, flags | X300_FPGA_PROG_FLAGS_ERASE, &pkt_out);
+    if(len == 0){
+        throw uhd::runtime_error("Timed out waiting for reply from device.");
+    }
+    else if((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)){
+        throw uhd::runtime_error("Device reported an error.");
+    }
+
+    const size_t window = session.windowed ? session.window : 1;
+    const size_t max_retries = size_t(UDP_TIMEOUT / RETRANSMIT_TIMEOUT);
+    std::vector<bool> acked(num_packets, false);
+    size_t next = 1, outstanding = 0, num_acked = 1, retries = 0;
+    pkt_out.flags = htonx<uint32_t>(flags);
+
+    while(num_acked < num_packets){
+        // Fill the window
+        while(outstanding < window and next < num_packets){
+            x300_fill_packet(pkt_out, &words[next*X300_PACKET_SIZE_WORDS], sector, next*X300_PACKET_SIZE_WORDS);
+            session.xport->send(boost::asio::buffer(&pkt_out, sizeof(pkt_out)));
+            next++;
+            outstanding++;
+        }
+
+        len = session.xport->recv(boost::asio::buffer(session.data_in, udp_simple::mtu),
+                                  session.windowed ? RETRANSMIT_TIMEOUT : UDP_TIMEOUT);
+        if(len == 0){
+            if(not session.windowed or ++retries > max_retries){
+                throw uhd::runtime_error("Timed out waiting for reply from device.");
+            }
+            // Selective retransmit of everything sent but not acked
+            for(size_t k = 0; k < next; k++){
+                if(acked[k]) continue;
+                x300_fill_packet(pkt_out, &words[k*X300_PACKET_SIZE_WORDS], sector, k*X300_PACKET_SIZE_WORDS);
+                session.xport->send(boost::asio::buffer(&pkt_out, sizeof(pkt_out)));
+            }
+            continue;
+        }
+        else if((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)){
+            throw uhd::runtime_error("Device reported an error.");
+        }
+        retries = 0;
+
+        // Without the location in the ack, it acks the only packet in flight
+        const size_t k = session.windowed ? (ntohl(pkt_in->index) / X300_PACKET_SIZE_WORDS) : (next - 1);
+        if(session.windowed and ntohl(pkt_in->sector) != X300_FPGA_SECTOR_START + sector) continue;
+        if(k >= next or acked[k]) continue; // Duplicate ack of a retransmit
+        acked[k] = true;
+        outstanding--;
+        num_acked++;
+    }
+}
+
 static void x300_ethernet_load(x300_session_t &session){
 
     // UDP receive buffer
@@ -250,6 +422,7 @@ static void x300_ethernet_load(x300_session_t &session){
 
     // Initialize write session
     uint32_t flags = X300_FPGA_PROG_FLAGS_ACK | X300_FPGA_PROG_FLAGS_INIT;
+    memset(&pkt_out, 0, sizeof(pkt_out));
     size_t len = x300_send_and_recv(session.xport, flags, &pkt_out, session.data_in);
     if(x300_recv_ok(pkt_in, len)){
         std::cout << "-- Initializing FPGA loading..." << std::flush;
@@ -268,73 +441,70 @@ static void x300_ethernet_load(x300_session_t &session){
         std::cout << "-- NOTE: Device is verifying the image it is receiving, increasing the loading time." << std::endl;
     }
 
-    size_t current_pos = 0;
-    size_t sectors = (session.size / X300_FLASH_SECTOR_SIZE);
-    std::ifstream image(session.filepath.c_str(), std::ios::binary);
+    // Firmware which echoes the location in its acks also does sector checksums
+    session.windowed = (len >= sizeof(x300_fpga_prog_reply_t));
+    if(not session.windowed){
+        std::cout << "-- NOTE: Device firmware does not support windowed loading, sending one packet at a time." << std::endl;
+    }
+
+    std::vector<uint16_t> words;
+    x300_read_image_words(session, words);
+
+    const size_t sector_words = X300_FLASH_SECTOR_SIZE / 2;
+    const size_t sectors = (words.size() + sector_words - 1) / sector_words;
+    size_t skipped = 0;
 
     // Each sector
-    for(size_t i = 0; i < session.size; i += X300_FLASH_SECTOR_SIZE){
+    for(size_t i = 0; i < sectors; i++){
 
         // Print progress percentage at beginning of each sector
-        std::cout << boost::format("\r-- Loading %s FPGA image: %d%% (%d/%d sectors)")
-                     % session.fpga_type
-                     % (int(double(i) / double(session.size) * 100.0))
-                     % (i / X300_FLASH_SECTOR_SIZE)
-                     % sectors
-                 << std::flush;
-
-        // Each packet
-        for(size_t j = i; (j < session.size and j < (i+X300_FLASH_SECTOR_SIZE)); j += X300_PACKET_SIZE_BYTES){
-            flags = X300_FPGA_PROG_FLAGS_ACK;
-            if(j == i)         flags |= X300_FPGA_PROG_FLAGS_ERASE; // Erase at beginning of sector
-            if(session.verify) flags |= X300_FPGA_PROG_FLAGS_VERIFY;
-
-            // Set burn location
-            pkt_out.sector = htonx<uint32_t>(X300_FPGA_SECTOR_START + (i/X300_FLASH_SECTOR_SIZE));
-            pkt_out.index  = htonx<uint32_t>((j % X300_FLASH_SECTOR_SIZE) / 2);
-            pkt_out.size   = htonx<uint32_t>(X300_PACKET_SIZE_BYTES / 2);
-
-            // Read next piece of image
-            memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
-            if(session.lvbitx){
-                memcpy(pkt_out.data8, &session.bitstream[current_pos], X300_PACKET_SIZE_BYTES);
-                current_pos += X300_PACKET_SIZE_BYTES;
-            }
-            else{
-                image.read((char*)pkt_out.data8, X300_PACKET_SIZE_BYTES);
-            }
+        if(session.progress){
+            session.progress(double(i) / double(sectors));
+        }
+        else std::cout << boost::format("\r-- Loading %s FPGA image: %d%% (%d/%d sectors)")
+                          % session.fpga_type
+                          % (int(double(i) / double(sectors) * 100.0))
+                          % i
+                          % sectors
+                      << std::flush;
+
+        const uint16_t *sector_data = &words[i*sector_words];
+        const size_t num_words = std::min(sector_words, words.size() - i*sector_words);
+        const uint32_t checksum = x300_checksum(sector_data, num_words);
+
+        // Skip sectors which already hold this part of the image
+        if(session.windowed and not session.force and
+           x300_sector_checksum(session, i, num_words) == checksum){
+            skipped++;
+            continue;
+        }
 
-            // Data must be bitswapped and byteswapped
-            for(size_t k = 0; k < X300_PACKET_SIZE_BYTES; k++){
-                x300_bitswap(&pkt_out.data8[k]);
-            }
-            for(size_t k = 0; k < (X300_PACKET_SIZE_BYTES/2); k++){
-                pkt_out.data16[k] = htonx<uint16_t>(pkt_out.data16[k]);
-            }
+        x300_write_sector(session, sector_data, i, num_words / X300_PACKET_SIZE_WORDS);
 
-            len = x300_send_and_recv(session.xport, flags, &pkt_out, session.data_in);
-            if(len == 0){
-                if(!session.lvbitx) image.close();
-                throw uhd::runtime_error("Timed out waiting for reply from device.");
-            }
-            else if((ntohl(pkt_in->flags) & X300_FPGA_PROG_FLAGS_ERROR)){
-                if(!session.lvbitx) image.close();
-                throw uhd::runtime_error("Device reported an error.");
-            }
+        if(session.windowed and x300_sector_checksum(session, i, num_words) != checksum){
+            std::cout << std::endl;
+            throw uhd::runtime_error(str(boost::format("Verification of sector %d failed.") % i));
         }
     }
-    if(!session.lvbitx){
-        image.close();
-    }
 
-    std::cout << boost::format("\r-- Loading %s FPGA image: 100%% (%d/%d sectors)")
-                 % session.fpga_type
-                 % sectors
-                 % sectors
-             << std::endl;
+    if(session.progress){
+        session.progress(1.0);
+    }
+    else std::cout << boost::format("\r-- Loading %s FPGA image: 100%% (%d/%d sectors)")
+                      % session.fpga_type
+                      % sectors
+                      % sectors
+                  << std::endl;
+    if(skipped == sectors){
+        std::cout << "-- Device already holds this image, it was verified but not rewritten." << std::endl;
+    }
+    else if(skipped > 0){
+        std::cout << boost::format("-- %d of %d sectors already matched the image and were not rewritten.")
+                     % skipped % sectors
+                 << std::endl;
+    }
 
     // Cleanup
-    if(!session.lvbitx) image.close();
     flags = (X300_FPGA_PROG_FLAGS_CLEANUP | X300_FPGA_PROG_FLAGS_ACK);
     pkt_out.sector = pkt_out.index = pkt_out.size = 0;
     memset(pkt_out.data8, 0, X300_PACKET_SIZE_BYTES);
@@ -397,6 +567,7 @@ static bool x300_image_loader(const image_loader::image_loader_args_t &image_loa
                        image_loader_args.fpga_path
                       );
     if(!session.found) return false;
+    session.progress = image_loader_args.progress;
 
     std::cout << boost::format("Unit: USRP %s (%s, %s)\nFPGA Image: %s\n")
                  % session.dev_addr["product"]
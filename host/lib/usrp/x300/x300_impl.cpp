@@ -19,28 +19,38 @@
 #include "x300_lvbitx.hpp"
 #include "x310_lvbitx.hpp"
 #include "x300_mb_eeprom.hpp"
+#include "x300_mtu_cache.hpp"
 #include "apply_corrections.hpp"
+#include "../../transport/zero_copy_stats.hpp"
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/host_check.hpp>
+#include <uhd/utils/startup_profile.hpp>
 #include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/usrp/dboard_eeprom.hpp>
 #include <uhd/transport/if_addrs.hpp>
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/thread/thread.hpp>
 #include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/transport/xdp_zero_copy.hpp>
 #include <uhd/transport/udp_constants.hpp>
+#include <uhd/transport/buffer_pool.hpp>
 #include <uhd/transport/zero_copy_recv_offload.hpp>
 #include <uhd/transport/nirio_zero_copy.hpp>
 #include <uhd/transport/nirio/niusrprio_session.h>
 #include <uhd/utils/platform.hpp>
 #include <uhd/types/sid.hpp>
+#include <uhd/types/mac_addr.hpp>
 #include <fstream>
+#include <algorithm>
 
 #define NIUSRPRIO_DEFAULT_RPC_PORT "5444"
 
@@ -217,7 +227,7 @@ static device_addrs_t x300_find_pcie(const device_addr_t &hint, bool explicit_qu
 
             //Hold on to the registry mutex as long as zpu_ctrl is alive
             //to prevent any use by different threads while enumerating
-            boost::mutex::scoped_lock(pcie_zpu_iface_registry_mutex);
+            boost::mutex::scoped_lock registry_lock(pcie_zpu_iface_registry_mutex);
 
             if (get_pcie_zpu_iface_registry().has_key(resource_d)) {
                 zpu_ctrl = get_pcie_zpu_iface_registry()[resource_d].lock();
@@ -405,9 +415,130 @@ x300_impl::x300_impl(const uhd::device_addr_t &dev_addr)
 
     const device_addrs_t device_args = separate_device_addr(dev_addr);
     _mb.resize(device_args.size());
+    _max_frame_sizes.recv_frame_size = X300_10GE_DATA_FRAME_MAX_SIZE;
+    _max_frame_sizes.send_frame_size = X300_10GE_DATA_FRAME_MAX_SIZE;
+    if (dev_addr.has_key("shared_frames")) {
+        _shared_frames = frame_pool::make(
+            size_t(dev_addr.cast<double>("shared_frames", 0)),
+            X300_10GE_DATA_FRAME_MAX_SIZE,
+            buffer_pool::alloc_policy_t::from_hints(dev_addr));
+    }
+    if (device_args.size() == 1) {
+        this->setup_mb(0, device_args[0]);
+        return;
+    }
+
+    // Motherboards are independent until streaming starts, so bring them
+    // up at the same time: frame size detection, clocking, radio and
+    // dboard initialization each take seconds per motherboard.
+    std::vector< boost::shared_ptr<uhd::exception> > errors(device_args.size());
+    boost::thread_group setup_threads;
     for (size_t i = 0; i < device_args.size(); i++)
     {
-        this->setup_mb(i, device_args[i]);
+        setup_threads.create_thread(boost::bind(
+            &x300_impl::setup_mb_thread, this, i, boost::cref(device_args[i]), boost::ref(errors[i])
+        ));
+    }
+    setup_threads.join_all();
+    for (size_t i = 0; i < device_args.size(); i++)
+    {
+        if (errors[i]) errors[i]->dynamic_throw();
+    }
+
+    // The blocks were registered in whichever order the threads got there,
+    // restore the order of a sequential setup (by motherboard)
+    std::stable_sort(_rfnoc_block_ctrl.begin(), _rfnoc_block_ctrl.end(), block_on_lower_mboard);
+}
+
+bool x300_impl::block_on_lower_mboard(
+        const uhd::rfnoc::block_ctrl_base::sptr &lhs,
+        const uhd::rfnoc::block_ctrl_base::sptr &rhs
+) {
+    return lhs->get_block_id().get_device_no() < rhs->get_block_id().get_device_no();
+}
+
+void x300_impl::setup_mb_thread(
+        const size_t mb_i,
+        const uhd::device_addr_t &dev_addr,
+        boost::shared_ptr<uhd::exception> &error
+) {
+    try {
+        this->setup_mb(mb_i, dev_addr);
+    } catch (const uhd::exception &ex) {
+        error.reset(ex.dynamic_clone());
+    } catch (const std::exception &ex) {
+        error.reset(new uhd::runtime_error(ex.what()));
+    }
+}
+
+void x300_impl::setup_radio_thread(
+        uhd::rfnoc::x300_radio_ctrl_impl::sptr radio,
+        uhd::i2c_iface::sptr zpu_i2c,
+        x300_clock_ctrl::sptr clock,
+        const uhd::device_addr_t &dev_addr,
+        const int32_t adc_capture_delay,
+        boost::shared_ptr<uhd::exception> &error
+) {
+    try {
+        radio->setup_radio(
+                zpu_i2c,
+                clock,
+                dev_addr.has_key("ignore-cal-file"),
+                dev_addr.has_key("self_cal_adc_delay"),
+                adc_capture_delay
+        );
+    } catch (const uhd::exception &ex) {
+        error.reset(ex.dynamic_clone());
+    } catch (const std::exception &ex) {
+        error.reset(new uhd::runtime_error(ex.what()));
+    }
+}
+
+size_t x300_impl::mboard_members_t::select_eth_link(const xport_type_t xport_type)
+{
+    size_t &next_src_addr =
+        xport_type == TX_DATA ? next_tx_src_addr :
+        xport_type == RX_DATA ? next_rx_src_addr :
+        next_src_addr;
+    size_t link = next_src_addr;
+
+    if (xport_type == RX_DATA or xport_type == TX_DATA) {
+        std::vector< std::vector< boost::weak_ptr<zero_copy_if> > > &link_xports =
+            (xport_type == TX_DATA) ? tx_link_xports : rx_link_xports;
+        link_xports.resize(eth_conns.size());
+        std::vector<size_t> num_live(eth_conns.size(), 0);
+        for (size_t i = 0; i < link_xports.size(); i++) {
+            // Forget transports whose streamers have been destroyed
+            std::vector< boost::weak_ptr<zero_copy_if> > live;
+            BOOST_FOREACH(const boost::weak_ptr<zero_copy_if> &xport, link_xports[i]) {
+                if (not xport.expired()) live.push_back(xport);
+            }
+            link_xports[i].swap(live);
+            num_live[i] = link_xports[i].size();
+        }
+        // Start the search at the round-robin position so ties keep the
+        // old alternating behaviour
+        for (size_t j = 1; j < eth_conns.size(); j++) {
+            const size_t i = (next_src_addr + j) % eth_conns.size();
+            if (num_live[i] < num_live[link]) link = i;
+        }
+    }
+
+    next_src_addr = (link + 1) % eth_conns.size();
+    return link;
+}
+
+void x300_impl::mboard_members_t::register_eth_link_xport(
+        const size_t link,
+        const xport_type_t xport_type,
+        zero_copy_if::sptr xport)
+{
+    if (xport_type == TX_DATA) {
+        tx_link_xports.resize(eth_conns.size());
+        tx_link_xports[link].push_back(xport);
+    } else if (xport_type == RX_DATA) {
+        rx_link_xports.resize(eth_conns.size());
+        rx_link_xports[link].push_back(xport);
     }
 }
 
@@ -518,6 +649,10 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     const fs_path mb_path = "/mboards/"+boost::lexical_cast<std::string>(mb_i);
     mboard_members_t &mb = _mb[mb_i];
     mb.initialization_done = false;
+    const std::string mb_name = str(boost::format("mb%u: ") % mb_i);
+    // Probe mode: only read the inventory (EEPROMs and versions)
+    const bool probe_only = dev_addr.get("probe_only", "0") != "0";
+    startup_profile::begin(mb_name + "connect");
 
     std::vector<std::string> eth_addrs;
     // Not choosing eth0 based on resource might cause user issues
@@ -568,6 +703,7 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
                     have a valid USRP X3x0, NI USRP-294xR or NI USRP-295xR device and that all the device \
                     drivers have loaded successfully.");
         }
+        startup_profile::begin(mb_name + "load FPGA (LVBITX)");
         //Load the lvbitx onto the device
         UHD_MSG(status) << boost::format("Using LVBITX bitfile %s...\n") % lvbitx->get_bitfile_path();
         mb.rio_fpga_interface.reset(new niusrprio_session(dev_addr["resource"], rpc_port_name));
@@ -587,9 +723,28 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     {
         if (key.find("recv") != std::string::npos) mb.recv_args[key] = dev_addr[key];
         if (key.find("send") != std::string::npos) mb.send_args[key] = dev_addr[key];
+        if (key.find("xdp_") == 0) mb.xdp_args[key] = dev_addr[key];
+    }
+    //the buffer allocation policy (hugepages, NUMA, mlock) of the data transports
+    buffer_pool::alloc_policy_t::forward_hints(dev_addr, mb.recv_args);
+    buffer_pool::alloc_policy_t::forward_hints(dev_addr, mb.send_args);
+
+    //Control responses share the link with sample data, so let them
+    //jump the socket and qdisc queues
+    mb.ctrl_args["priority"] = dev_addr.get("ctrl_priority", boost::lexical_cast<std::string>(X300_ETH_CTRL_PRIORITY));
+    mb.ctrl_args["dscp"] = dev_addr.get("ctrl_dscp", boost::lexical_cast<std::string>(X300_ETH_CTRL_DSCP));
+    if (dev_addr.has_key("ctrl_busy_poll")) {
+        mb.ctrl_args["busy_poll"] = dev_addr["ctrl_busy_poll"];
     }
 
-    if (mb.xport_path == "eth" ) {
+    //Data transports may bypass the kernel network stack with AF_XDP.
+    //Discovery and control traffic always use regular UDP sockets.
+    mb.use_xdp = (mb.xport_path == "eth" and dev_addr.get("data_xport", "udp") == "xdp");
+    if (mb.use_xdp and not xdp_zero_copy::is_supported()) {
+        throw uhd::not_implemented_error("data_xport=xdp requested, but this build of UHD has no AF_XDP support");
+    }
+
+    if (mb.xport_path == "eth" and not probe_only) {
         /* This is an ETH connection. Figure out what the maximum supported frame
          * size is for the transport in the up and down directions. The frame size
          * depends on the host PIC's NIC's MTU settings. To determine the frame size,
@@ -617,40 +772,57 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
             const std::string mtu_tool("ifconfig");
         #endif
 
-        // Detect the frame size on the path to the USRP
+        startup_profile::begin(mb_name + "detect frame size");
+        // Detect the frame size on the path to the USRP. Results are cached per
+        // device and host interface, so later sessions only verify them.
+        const std::string serial = dev_addr.get("serial", "");
+        const bool use_mtu_cache = dev_addr.get("mtu_cache", "1") != "0";
+        frame_size_t max_frame_sizes;
+        {
+            boost::mutex::scoped_lock lock(_max_frame_sizes_mutex);
+            max_frame_sizes = _max_frame_sizes;
+        }
         try {
-            frame_size_t pri_frame_sizes = determine_max_frame_size(
-                eth_addrs.at(0), req_max_frame_size
+            frame_size_t pri_frame_sizes = get_link_frame_size(
+                eth_addrs.at(0), serial, req_max_frame_size, use_mtu_cache
             );
 
-            _max_frame_sizes = pri_frame_sizes;
+            max_frame_sizes = pri_frame_sizes;
             if (eth_addrs.size() > 1) {
-                frame_size_t sec_frame_sizes = determine_max_frame_size(
-                    eth_addrs.at(1), req_max_frame_size
+                frame_size_t sec_frame_sizes = get_link_frame_size(
+                    eth_addrs.at(1), serial, req_max_frame_size, use_mtu_cache
                 );
 
                 // Choose the minimum of the max frame sizes
                 // to ensure we don't exceed any one of the links' MTU
-                _max_frame_sizes.recv_frame_size = std::min(
+                max_frame_sizes.recv_frame_size = std::min(
                     pri_frame_sizes.recv_frame_size,
                     sec_frame_sizes.recv_frame_size
                 );
 
-                _max_frame_sizes.send_frame_size = std::min(
+                max_frame_sizes.send_frame_size = std::min(
                     pri_frame_sizes.send_frame_size,
                     sec_frame_sizes.send_frame_size
                 );
             }
+
+            // The frame size is shared by all motherboards (which may be set
+            // up at the same time), it must fit the smallest of their links
+            boost::mutex::scoped_lock lock(_max_frame_sizes_mutex);
+            _max_frame_sizes.recv_frame_size = std::min(
+                _max_frame_sizes.recv_frame_size, max_frame_sizes.recv_frame_size);
+            _max_frame_sizes.send_frame_size = std::min(
+                _max_frame_sizes.send_frame_size, max_frame_sizes.send_frame_size);
         } catch(std::exception &e) {
             UHD_MSG(error) << e.what() << std::endl;
         }
 
         if ((mb.recv_args.has_key("recv_frame_size"))
-                && (req_max_frame_size.recv_frame_size > _max_frame_sizes.recv_frame_size)) {
+                && (req_max_frame_size.recv_frame_size > max_frame_sizes.recv_frame_size)) {
             UHD_MSG(warning)
                 << boost::format("You requested a receive frame size of (%lu) but your NIC's max frame size is (%lu).")
                 % req_max_frame_size.recv_frame_size
-                % _max_frame_sizes.recv_frame_size
+                % max_frame_sizes.recv_frame_size
                 << std::endl
                 << boost::format("Please verify your NIC's MTU setting using '%s' or set the recv_frame_size argument appropriately.")
                 % mtu_tool << std::endl
@@ -659,11 +831,11 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
         }
 
         if ((mb.recv_args.has_key("send_frame_size"))
-                && (req_max_frame_size.send_frame_size > _max_frame_sizes.send_frame_size)) {
+                && (req_max_frame_size.send_frame_size > max_frame_sizes.send_frame_size)) {
             UHD_MSG(warning)
                 << boost::format("You requested a send frame size of (%lu) but your NIC's max frame size is (%lu).")
                 % req_max_frame_size.send_frame_size
-                % _max_frame_sizes.send_frame_size
+                % max_frame_sizes.send_frame_size
                 << std::endl
                 << boost::format("Please verify your NIC's MTU setting using '%s' or set the send_frame_size argument appropriately.")
                 % mtu_tool << std::endl
@@ -671,15 +843,44 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
                 << std::endl;
         }
 
-        _tree->create<size_t>(mb_path / "mtu/recv").set(_max_frame_sizes.recv_frame_size);
-        _tree->create<size_t>(mb_path / "mtu/send").set(std::min(_max_frame_sizes.send_frame_size, X300_ETH_DATA_FRAME_MAX_TX_SIZE));
+        _tree->create<size_t>(mb_path / "mtu/recv").set(max_frame_sizes.recv_frame_size);
+        _tree->create<size_t>(mb_path / "mtu/send").set(std::min(max_frame_sizes.send_frame_size, X300_ETH_DATA_FRAME_MAX_TX_SIZE));
         _tree->create<double>(mb_path / "link_max_rate").set(X300_MAX_RATE_10GIGE);
+
+        // Check the host settings that streaming at full rate needs
+        if (dev_addr.get("host_check", "1") != "0") {
+            startup_profile::begin(mb_name + "host check");
+            BOOST_FOREACH(const std::string &eth_addr, eth_addrs) {
+                const host_check::report_t report = host_check::check(
+                    eth_addr, max_frame_sizes.recv_frame_size,
+                    mb.recv_args.cast<size_t>("recv_buff_size", X300_RX_SW_BUFF_SIZE_ETH),
+                    mb.send_args.cast<size_t>("send_buff_size", 0)
+                );
+                if (report.num_deficits() > 0) {
+                    UHD_MSG(warning) << report.to_pp_string()
+                        << "Run uhd_host_check for details, or set host_check=0 to skip this check." << std::endl;
+                } else {
+                    UHD_LOG << report.to_pp_string();
+                }
+            }
+        }
+
+        // Optionally keep probing, so a session that started before jumbo
+        // frames were enabled on the path picks them up for new streamers.
+        const double mtu_reprobe_period = dev_addr.cast<double>("mtu_reprobe", 0.0);
+        if (mtu_reprobe_period > 0.0) {
+            mb.mtu_reprobe_task = uhd::task::make(boost::bind(
+                &x300_impl::mtu_reprobe_loop, this, mb_path, eth_addrs, serial,
+                req_max_frame_size, use_mtu_cache, mtu_reprobe_period
+            ));
+        }
     }
 
+    startup_profile::begin(mb_name + "basic communication");
     //create basic communication
     UHD_MSG(status) << "Setup basic communication..." << std::endl;
     if (mb.xport_path == "nirio") {
-        boost::mutex::scoped_lock(pcie_zpu_iface_registry_mutex);
+        boost::mutex::scoped_lock registry_lock(pcie_zpu_iface_registry_mutex);
         if (get_pcie_zpu_iface_registry().has_key(mb.get_pri_eth().addr)) {
             throw uhd::assertion_error("Someone else has a ZPU transport to the device open. Internal error!");
         } else {
@@ -704,9 +905,11 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
         const std::string x300_fw_image = find_image_path(
             dev_addr.has_key("fw")? dev_addr["fw"] : X300_FW_FILE_NAME
         );
+        startup_profile::begin(mb_name + "load firmware");
         x300_load_fw(mb.zpu_ctrl, x300_fw_image);
     }
 
+    startup_profile::begin(mb_name + "check compat");
     //check compat numbers
     //check fpga compat before fw compat because the fw is a subset of the fpga image
     this->check_fpga_compat(mb_path, mb);
@@ -746,6 +949,7 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     }
     */
 
+    startup_profile::begin(mb_name + "EEPROM and routing");
     ////////////////////////////////////////////////////////////////////
     // setup the mboard eeprom
     ////////////////////////////////////////////////////////////////////
@@ -842,18 +1046,68 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
                 % mb.hw_rev));
     }
 
+    if (probe_only) {
+        startup_profile::begin(mb_name + "dboard EEPROMs");
+        this->setup_probe_dboards(mb_path, mb.zpu_i2c);
+        startup_profile::end();
+        return;
+    }
+
+    startup_profile::begin(mb_name + "clocking");
     ////////////////////////////////////////////////////////////////////
     // create clock control objects
     ////////////////////////////////////////////////////////////////////
     UHD_MSG(status) << "Setup RF frontend clocking..." << std::endl;
 
+    //Warm restore: when the device still runs the state the last
+    //initialization stored, the LMK and the ADC capture delays stay as they are
+    x300_warm_state_t &warm_state = mb.warm_state;
+    warm_state.fpga_git_hash = mb.zpu_ctrl->peek32(SR_ADDR(SET0_BASE, ZPU_RB_GIT_HASH));
+    warm_state.fpga_image = mb.loaded_fpga_image;
+    warm_state.master_clock_rate = dev_addr.cast<double>("master_clock_rate", X300_DEFAULT_TICK_RATE);
+    warm_state.dboard_clock_rate = dev_addr.cast<double>("dboard_clock_rate", X300_DEFAULT_DBOARD_CLK_RATE);
+    warm_state.system_ref_rate = dev_addr.cast<double>("system_ref_rate", X300_DEFAULT_SYSREF_RATE);
+    mb.serial = mb_eeprom.get("serial", "");
+    mb.warm_restore = dev_addr.get("warm_restore", "0") != "0"
+        and not dev_addr.has_key("self_cal_adc_delay")
+        and mb.hw_rev > 4; //needs the LMK lock status
+    x300_warm_state_t last_state;
+    const bool warm_start = mb.warm_restore
+        and x300_warm_state_lookup(mb.serial, last_state)
+        and last_state.same_config(warm_state)
+        and mb.zpu_ctrl->peek32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_WARM_STATE))
+            == x300_warm_state_hash(last_state);
+    if (not warm_start) {
+        last_state.adc_capture_delays.clear();
+    }
+    //until this initialization is done, the hardware state is unknown
+    mb.zpu_ctrl->poke32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_WARM_STATE), 0);
+
     //Initialize clock control registers. NOTE: This does not configure the LMK yet.
+    //On a warm start, only the register shadows are set up.
     mb.clock = x300_clock_ctrl::make(mb.zpu_spi,
         1 /*slaveno*/,
         mb.hw_rev,
-        dev_addr.cast<double>("master_clock_rate", X300_DEFAULT_TICK_RATE),
-        dev_addr.cast<double>("dboard_clock_rate", X300_DEFAULT_DBOARD_CLK_RATE),
-        dev_addr.cast<double>("system_ref_rate", X300_DEFAULT_SYSREF_RATE));
+        warm_state.master_clock_rate,
+        warm_state.dboard_clock_rate,
+        warm_state.system_ref_rate,
+        not warm_start);
+    if (warm_start) {
+        if (wait_for_clk_locked(mb, fw_regmap_t::clk_status_reg_t::LMK_LOCK, 0.01)
+                and wait_for_clk_locked(mb, fw_regmap_t::clk_status_reg_t::RADIO_CLK_LOCK, 0.01)) {
+            UHD_MSG(status) << "Restoring the clocking of the last session" << std::endl;
+            mb.current_refclk_src = last_state.clock_source;
+        } else {
+            UHD_MSG(status) << "Clocks of the last session are not locked, reconfiguring" << std::endl;
+            last_state.adc_capture_delays.clear();
+            mb.clock = x300_clock_ctrl::make(mb.zpu_spi,
+                1 /*slaveno*/,
+                mb.hw_rev,
+                warm_state.master_clock_rate,
+                warm_state.dboard_clock_rate,
+                warm_state.system_ref_rate);
+        }
+    }
 
     //Initialize clock source to use internal reference and generate
     //a valid radio clock. This may change after configuration is done.
@@ -870,6 +1124,7 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     UHD_MSG(status) << "Radio 1x clock:" << (mb.clock->get_master_clock_rate()/1e6)
         << std::endl;
 
+    startup_profile::begin(mb_name + "GPSDO");
     ////////////////////////////////////////////////////////////////////
     // Create the GPSDO control
     ////////////////////////////////////////////////////////////////////
@@ -904,11 +1159,14 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     ////////////////////////////////////////////////////////////////////
     //clear router?
     ////////////////////////////////////////////////////////////////////
+    mb.zpu_ctrl->begin_batch();
     for (size_t i = 0; i < 512; i++) {
         mb.zpu_ctrl->poke32(SR_ADDR(SETXB_BASE, i), 0);
     }
+    mb.zpu_ctrl->commit();
 
 
+    startup_profile::begin(mb_name + "time and clock sources");
     ////////////////////////////////////////////////////////////////////
     // setup time sources and properties
     ////////////////////////////////////////////////////////////////////
@@ -958,7 +1216,18 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     ////////////////////////////////////////////////////////////////////
     _tree->create<sensor_value_t>(mb_path / "sensors" / "ref_locked")
         .set_publisher(boost::bind(&x300_impl::get_ref_locked, this, mb));
+    //only firmware with compat minor 2 or later counts network packets
+    const uint32_t fw_compat_num = mb.zpu_ctrl->peek32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_COMPAT_NUM));
+    if ((fw_compat_num & 0xffff) >= 2) {
+        _tree->create<sensor_value_t>(mb_path / "sensors" / "fw_net_pkts")
+            .set_publisher(boost::bind(&x300_impl::get_fw_net_counter, this, mb.zpu_ctrl, "Firmware packets", X300_FW_SHMEM_NET_PKTS));
+        _tree->create<sensor_value_t>(mb_path / "sensors" / "fw_net_ctrl_pkts")
+            .set_publisher(boost::bind(&x300_impl::get_fw_net_counter, this, mb.zpu_ctrl, "Firmware control packets", X300_FW_SHMEM_NET_CTRL_PKTS));
+        _tree->create<sensor_value_t>(mb_path / "sensors" / "fw_net_max_backlog")
+            .set_publisher(boost::bind(&x300_impl::get_fw_net_counter, this, mb.zpu_ctrl, "Firmware max backlog", X300_FW_SHMEM_NET_MAX_BACKLOG));
+    }
 
+    startup_profile::begin(mb_name + "RFNoC blocks, radios and dboards");
     //////////////// RFNOC /////////////////
     const size_t n_rfnoc_blocks = mb.zpu_ctrl->peek32(SR_ADDR(SET0_BASE, ZPU_RB_NUM_CE));
     enumerate_rfnoc_blocks(
@@ -982,24 +1251,63 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
         }
 
         BOOST_FOREACH(const rfnoc::block_id_t &id, radio_ids) {
-            rfnoc::x300_radio_ctrl_impl::sptr radio(get_block_ctrl<rfnoc::x300_radio_ctrl_impl>(id));
-            mb.radios.push_back(radio);
-            radio->setup_radio(
-                    mb.zpu_i2c,
-                    mb.clock,
-                    dev_addr.has_key("ignore-cal-file"),
-                    dev_addr.has_key("self_cal_adc_delay")
+            mb.radios.push_back(get_block_ctrl<rfnoc::x300_radio_ctrl_impl>(id));
+        }
+
+        // The ADC delays of a warm restore, or else of the calibration
+        // cache, only need a validation instead of a full sweep
+        const bool adc_cal_cache = dev_addr.get("adc_cal_cache", "1") != "0";
+        std::vector<std::string> capture_keys;
+        for (size_t radio_i = 0; radio_i < mb.radios.size(); radio_i++) {
+            capture_keys.push_back(adc_cal_cache ? x300_adc_cal_key(
+                mb.serial, warm_state.fpga_git_hash, warm_state.master_clock_rate,
+                str(boost::format("capture%d") % radio_i)) : "");
+        }
+
+        // The slots have their own SPI, GPIO and ADC, only the I2C bus and
+        // the LMK are shared (and locked), so set up their dboards at the
+        // same time: some dboards take seconds to initialize.
+        std::vector< boost::shared_ptr<uhd::exception> > errors(mb.radios.size());
+        boost::thread_group radio_threads;
+        for (size_t radio_i = 0; radio_i < mb.radios.size(); radio_i++) {
+            double cached_delay = -1;
+            const int32_t adc_capture_delay = (radio_i < last_state.adc_capture_delays.size())
+                ? int32_t(last_state.adc_capture_delays[radio_i])
+                : x300_adc_cal_lookup(capture_keys[radio_i], cached_delay)
+                ? int32_t(cached_delay) : -1;
+            const boost::function<void(void)> setup = boost::bind(
+                &x300_impl::setup_radio_thread, mb.radios[radio_i], mb.zpu_i2c, mb.clock,
+                boost::cref(dev_addr), adc_capture_delay, boost::ref(errors[radio_i])
             );
+            if (mb.radios.size() == 1) setup();
+            else radio_threads.create_thread(setup);
+        }
+        radio_threads.join_all();
+        for (size_t radio_i = 0; radio_i < mb.radios.size(); radio_i++) {
+            if (errors[radio_i]) errors[radio_i]->dynamic_throw();
+            x300_adc_cal_store(capture_keys[radio_i], mb.radios[radio_i]->get_adc_capture_delay());
         }
 
+        startup_profile::begin(mb_name + "ADC self test");
         ////////////////////////////////////////////////////////////////////
         // ADC test and cal
         ////////////////////////////////////////////////////////////////////
         if (dev_addr.has_key("self_cal_adc_delay")) {
-            rfnoc::x300_radio_ctrl_impl::self_cal_adc_xfer_delay(
-                mb.radios, mb.clock,
-                boost::bind(&x300_impl::wait_for_clk_locked, this, mb, fw_regmap_t::clk_status_reg_t::LMK_LOCK, _1),
-                true /* Apply ADC delay */);
+            const boost::function<void(double)> wait_for_lmk_locked =
+                boost::bind(&x300_impl::wait_for_clk_locked, this, mb, fw_regmap_t::clk_status_reg_t::LMK_LOCK, _1);
+            const std::string xfer_key = adc_cal_cache ? x300_adc_cal_key(
+                mb.serial, warm_state.fpga_git_hash, warm_state.master_clock_rate, "xfer") : "";
+            double xfer_delay = 0.0;
+            if (x300_adc_cal_lookup(xfer_key, xfer_delay) and
+                    rfnoc::x300_radio_ctrl_impl::validate_adc_xfer_delay(
+                        mb.radios, mb.clock, wait_for_lmk_locked, xfer_delay)) {
+                UHD_MSG(status) << boost::format("Using the cached ADC transfer delay (%.3fns)") % xfer_delay << std::endl;
+            } else {
+                xfer_delay = rfnoc::x300_radio_ctrl_impl::self_cal_adc_xfer_delay(
+                    mb.radios, mb.clock, wait_for_lmk_locked,
+                    true /* Apply ADC delay */);
+                x300_adc_cal_store(xfer_key, xfer_delay);
+            }
         }
         if (dev_addr.has_key("ext_adc_self_test")) {
             rfnoc::x300_radio_ctrl_impl::extended_adc_test(
@@ -1011,6 +1319,7 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
             }
         }
 
+        startup_profile::begin(mb_name + "sync times");
         ////////////////////////////////////////////////////////////////////
         // Synchronize times (dboard initialization can desynchronize them)
         ////////////////////////////////////////////////////////////////////
@@ -1022,6 +1331,9 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
         UHD_MSG(status) << "No Radio Block found. Assuming radio-less operation." << std::endl;
     } /* end of radio block(s) initialization */
 
+    store_warm_state(mb);
+
+    startup_profile::end();
     mb.initialization_done = true;
 }
 
@@ -1031,10 +1343,11 @@ x300_impl::~x300_impl(void)
     {
         BOOST_FOREACH(mboard_members_t &mb, _mb)
         {
+            mb.mtu_reprobe_task.reset();
             //kill the claimer task and unclaim the device
             mb.claimer_task.reset();
             {   //Critical section
-                boost::mutex::scoped_lock(pcie_zpu_iface_registry_mutex);
+                boost::mutex::scoped_lock registry_lock(pcie_zpu_iface_registry_mutex);
                 release(mb.zpu_ctrl);
                 //If the process is killed, the entire registry will disappear so we
                 //don't need to worry about unclean shutdowns here.
@@ -1160,9 +1473,18 @@ uhd::both_xports_t x300_impl::make_transport(
                 ? X300_PCIE_RX_DATA_NUM_FRAMES
                 : X300_PCIE_MSG_NUM_FRAMES;
 
+            //Batch DMA FIFO acquires on data streams unless the user says otherwise
+            uhd::device_addr_t pcie_xport_args = xport_args;
+            if (xport_type == RX_DATA and not pcie_xport_args.has_key("recv_batch_size")) {
+                pcie_xport_args["recv_batch_size"] = boost::lexical_cast<std::string>(X300_PCIE_DATA_BATCH_SIZE);
+            }
+            if (xport_type == TX_DATA and not pcie_xport_args.has_key("send_batch_size")) {
+                pcie_xport_args["send_batch_size"] = boost::lexical_cast<std::string>(X300_PCIE_DATA_BATCH_SIZE);
+            }
+
             xports.recv = nirio_zero_copy::make(
                 mb.rio_fpga_interface, dma_channel_num,
-                default_buff_args, xport_args);
+                default_buff_args, pcie_xport_args);
         }
 
         xports.send = xports.recv;
@@ -1179,16 +1501,12 @@ uhd::both_xports_t x300_impl::make_transport(
 
     } else if (mb.xport_path == "eth") {
         // Decide on the IP/Interface pair based on the endpoint index
-        size_t &next_src_addr =
-            xport_type == TX_DATA ? mb.next_tx_src_addr :
-            xport_type == RX_DATA ? mb.next_rx_src_addr :
-            mb.next_src_addr;
-        std::string interface_addr = mb.eth_conns[next_src_addr].addr;
+        const size_t eth_link = mb.select_eth_link(xport_type);
+        std::string interface_addr = mb.eth_conns[eth_link].addr;
         const uint32_t xbar_src_addr =
-            next_src_addr==0 ? X300_SRC_ADDR0 : X300_SRC_ADDR1;
+            eth_link==0 ? X300_SRC_ADDR0 : X300_SRC_ADDR1;
         const uint32_t xbar_src_dst =
-            mb.eth_conns[next_src_addr].type==X300_IFACE_ETH0 ? X300_XB_DST_E0 : X300_XB_DST_E1;
-        next_src_addr = (next_src_addr + 1) % mb.eth_conns.size();
+            mb.eth_conns[eth_link].type==X300_IFACE_ETH0 ? X300_XB_DST_E0 : X300_XB_DST_E1;
 
         xports.send_sid = this->allocate_sid(mb, address, xbar_src_addr, xbar_src_dst);
         xports.recv_sid = xports.send_sid.reversed();
@@ -1225,30 +1543,43 @@ uhd::both_xports_t x300_impl::make_transport(
             throw uhd::runtime_error("Unable to determine ETH link type.");
         }
 
+        frame_size_t max_frame_sizes;
+        {
+            boost::mutex::scoped_lock lock(_max_frame_sizes_mutex);
+            max_frame_sizes = _max_frame_sizes;
+        }
+
         /* Print a warning if the system's max available frame size is less than the most optimal
          * frame size for this type of connection. */
-        if (_max_frame_sizes.send_frame_size < eth_data_rec_frame_size) {
+        if (max_frame_sizes.send_frame_size < eth_data_rec_frame_size) {
             UHD_MSG(warning)
                 << boost::format("For this connection, UHD recommends a send frame size of at least %lu for best\nperformance, but your system's MTU will only allow %lu.")
                 % eth_data_rec_frame_size
-                % _max_frame_sizes.send_frame_size
+                % max_frame_sizes.send_frame_size
                 << std::endl
                 << "This will negatively impact your maximum achievable sample rate."
                 << std::endl;
         }
 
-        if (_max_frame_sizes.recv_frame_size < eth_data_rec_frame_size) {
+        if (max_frame_sizes.recv_frame_size < eth_data_rec_frame_size) {
             UHD_MSG(warning)
                 << boost::format("For this connection, UHD recommends a receive frame size of at least %lu for best\nperformance, but your system's MTU will only allow %lu.")
                 % eth_data_rec_frame_size
-                % _max_frame_sizes.recv_frame_size
+                % max_frame_sizes.recv_frame_size
                 << std::endl
                 << "This will negatively impact your maximum achievable sample rate."
                 << std::endl;
         }
 
-        size_t system_max_send_frame_size = (size_t) _max_frame_sizes.send_frame_size;
-        size_t system_max_recv_frame_size = (size_t) _max_frame_sizes.recv_frame_size;
+        size_t system_max_send_frame_size = (size_t) max_frame_sizes.send_frame_size;
+        size_t system_max_recv_frame_size = (size_t) max_frame_sizes.recv_frame_size;
+
+        // AF_XDP frames must fit into a single UMEM chunk
+        const bool use_xdp = mb.use_xdp and (xport_type == RX_DATA or xport_type == TX_DATA);
+        if (use_xdp) {
+            system_max_send_frame_size = std::min(system_max_send_frame_size, xdp_zero_copy::max_frame_size());
+            system_max_recv_frame_size = std::min(system_max_recv_frame_size, xdp_zero_copy::max_frame_size());
+        }
 
         // Make sure frame sizes do not exceed the max available value supported by UHD
         default_buff_args.send_frame_size =
@@ -1274,22 +1605,39 @@ uhd::both_xports_t x300_impl::make_transport(
         //make a new transport - fpga has no idea how to talk to us on this yet
         udp_zero_copy::buff_params buff_params;
 
-        xports.recv = udp_zero_copy::make(
-                interface_addr,
-                BOOST_STRINGIZE(X300_VITA_UDP_PORT),
-                default_buff_args,
-                buff_params,
-                xport_args);
+        if (use_xdp) {
+            uhd::device_addr_t xdp_xport_args = mb.xdp_args;
+            BOOST_FOREACH(const std::string &key, xport_args.keys()) {
+                xdp_xport_args[key] = xport_args[key];
+            }
+            xports.recv = xdp_zero_copy::make(
+                    interface_addr,
+                    BOOST_STRINGIZE(X300_VITA_UDP_PORT),
+                    default_buff_args,
+                    buff_params,
+                    xdp_xport_args);
+        } else {
+            xports.recv = udp_zero_copy::make(
+                    interface_addr,
+                    BOOST_STRINGIZE(X300_VITA_UDP_PORT),
+                    default_buff_args,
+                    buff_params,
+                    (xport_type == CTRL) ? mb.ctrl_args : xport_args,
+                    (xport_type == CTRL) ? frame_pool::sptr() : _shared_frames);
+        }
 
         // Create a threaded transport for the receive chain only
-        // Note that this shouldn't affect PCIe
-        if (xport_type == RX_DATA) {
+        // Note that this shouldn't affect PCIe, and the AF_XDP transport
+        // does not need it either. A streamer with a CPU (hint recv_cpu)
+        // drains its socket itself, on the CPU the socket is steered to.
+        if (xport_type == RX_DATA and not use_xdp and not xport_args.has_key("recv_cpu")) {
             xports.recv = zero_copy_recv_offload::make(
                     xports.recv,
                     X300_THREAD_BUFFER_TIMEOUT
             );
         }
         xports.send = xports.recv;
+        mb.register_eth_link_xport(eth_link, xport_type, xports.recv);
 
         //For the UDP transport the buffer size if the size of the socket buffer
         //in the kernel
@@ -1321,6 +1669,13 @@ uhd::both_xports_t x300_impl::make_transport(
         //ethernet framer has been programmed before we return.
         mb.zpu_ctrl->peek32(0);
     }
+
+    //publish the transport counters, e.g. /mboards/0/xports/rx_00020030/stats
+    static const char *xport_type_names[] = {"ctrl", "async", "tx", "rx"};
+    const fs_path xport_path = fs_path("/mboards") / boost::lexical_cast<std::string>(mb_index) / "xports"
+        / str(boost::format("%s_%08x") % xport_type_names[xport_type] % xports.send_sid.get());
+    publish_zero_copy_stats(_tree, xport_path, xports.recv);
+
     return xports;
 }
 
@@ -1331,6 +1686,8 @@ uhd::sid_t x300_impl::allocate_sid(
         const uint32_t src_addr,
         const uint32_t src_dst
 ) {
+    // Motherboards may be set up in parallel, but the endpoints are shared
+    boost::mutex::scoped_lock lock(_sid_framer_mutex);
     uhd::sid_t sid = address;
     sid.set_src_addr(src_addr);
     sid.set_src_endpoint(_sid_framer);
@@ -1353,6 +1710,75 @@ uhd::sid_t x300_impl::allocate_sid(
     return sid;
 }
 
+void x300_impl::route_between_mboards(const uhd::sid_t &sid)
+{
+    const size_t src_mb_index = sid.get_src_addr() - X300_DST_ADDR;
+    const size_t dst_mb_index = sid.get_dst_addr() - X300_DST_ADDR;
+    if (sid.get_src_addr() < X300_DST_ADDR or src_mb_index >= _mb.size()
+        or sid.get_dst_addr() < X300_DST_ADDR or dst_mb_index >= _mb.size()) {
+        throw uhd::value_error(str(
+            boost::format("Can't route SID %s: Not an address of this device.")
+            % sid.to_pp_string_hex()
+        ));
+    }
+    if (_mb[src_mb_index].xport_path != "eth" or _mb[dst_mb_index].xport_path != "eth") {
+        throw uhd::not_implemented_error(str(
+            boost::format("Can't route SID %s: Streaming between motherboards requires both to be connected via Ethernet.")
+            % sid.to_pp_string_hex()
+        ));
+    }
+    // The data packets go from the source to the destination motherboard,
+    // the flow control packets take the opposite way.
+    program_mboard_route(_mb[src_mb_index], dst_mb_index, sid.get_dst_endpoint());
+    program_mboard_route(_mb[dst_mb_index], src_mb_index, sid.get_src_endpoint());
+    UHD_LOG << "done router config between motherboards for sid " << sid << std::endl;
+}
+
+void x300_impl::program_mboard_route(
+        mboard_members_t &mb,
+        const size_t dst_mb_index,
+        const uint32_t dst_endpoint
+) {
+    // The ethernet framer picks its destination by the endpoint of the
+    // packet, so it can't tell this endpoint from a host transport's
+    // endpoint with the same value.
+    if (dst_endpoint < _sid_framer) {
+        throw uhd::runtime_error(str(
+            boost::format("Can't route to endpoint 0x%02X on motherboard %d: Endpoint is in use by a host transport.")
+            % dst_endpoint % dst_mb_index
+        ));
+    }
+    const x300_eth_conn_t &eth_conn = mb.get_pri_eth();
+    const x300_eth_conn_t &dst_eth_conn = _mb[dst_mb_index].get_pri_eth();
+    const mboard_eeprom_t dst_mb_eeprom = _tree->access<mboard_eeprom_t>(
+        fs_path("/mboards") / boost::lexical_cast<std::string>(dst_mb_index) / "eeprom"
+    ).get();
+    const byte_vector_t dst_mac = mac_addr_t::from_string(
+        dst_mb_eeprom[dst_eth_conn.type == X300_IFACE_ETH0 ? "mac-addr0" : "mac-addr1"]
+    ).to_bytes();
+    const uint32_t dst_ip = uint32_t(boost::asio::ip::address_v4::from_string(dst_eth_conn.addr).to_ulong());
+
+    // Program CAM entry for packets to the other motherboard. They don't
+    // match our XB_LOCAL address, so they're looked up in the lower half.
+    mb.zpu_ctrl->poke32(
+        SR_ADDR(SETXB_BASE, 0 + X300_DST_ADDR + dst_mb_index),
+        eth_conn.type == X300_IFACE_ETH0 ? X300_XB_DST_E0 : X300_XB_DST_E1
+    );
+    // Program the ethernet framer like the firmware does for host
+    // transports, but with the other motherboard as destination
+    const int ethbase = eth_conn.type == X300_IFACE_ETH0 ? ZPU_SR_ETHINT0 : ZPU_SR_ETHINT1;
+    mb.zpu_ctrl->poke32(SR_ADDR(SET0_BASE, ethbase + ZPU_SR_ETH_FRAMER_DST_RAM_ADDR), dst_endpoint);
+    mb.zpu_ctrl->poke32(SR_ADDR(SET0_BASE, ethbase + ZPU_SR_ETH_FRAMER_DST_IP_ADDR), dst_ip);
+    mb.zpu_ctrl->poke32(SR_ADDR(SET0_BASE, ethbase + ZPU_SR_ETH_FRAMER_DST_UDP_MAC),
+        (uint32_t(X300_VITA_UDP_PORT) << 16) |
+        (uint32_t(dst_mac[0]) << 8) | (uint32_t(dst_mac[1]) << 0));
+    mb.zpu_ctrl->poke32(SR_ADDR(SET0_BASE, ethbase + ZPU_SR_ETH_FRAMER_DST_MAC_LO),
+        (uint32_t(dst_mac[2]) << 24) | (uint32_t(dst_mac[3]) << 16) |
+        (uint32_t(dst_mac[4]) << 8) | (uint32_t(dst_mac[5]) << 0));
+    // Make sure the routes are set up before any packets get sent
+    mb.zpu_ctrl->peek32(0);
+}
+
 /***********************************************************************
  * clock and time control logic
  **********************************************************************/
@@ -1367,6 +1793,9 @@ void x300_impl::update_clock_source(mboard_members_t &mb, const std::string &sou
     //to set it to internal. This is the only case where we are guaranteed that
     //the clock has not gone away so we can skip setting the MUX and reseting the LMK.
     const bool reconfigure_clks = (mb.current_refclk_src != "internal") or (source != "internal");
+    if (reconfigure_clks and mb.initialization_done) {
+        mb.zpu_ctrl->poke32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_WARM_STATE), 0);
+    }
     if (reconfigure_clks) {
         //Update the clock MUX on the motherboard to select the requested source
         if (source == "internal") {
@@ -1435,6 +1864,22 @@ void x300_impl::update_clock_source(mboard_members_t &mb, const std::string &sou
 
     //Update cache value
     mb.current_refclk_src = source;
+    if (reconfigure_clks and mb.initialization_done) {
+        store_warm_state(mb);
+    }
+}
+
+void x300_impl::store_warm_state(mboard_members_t &mb)
+{
+    if (not mb.warm_restore) return;
+    mb.warm_state.clock_source = mb.current_refclk_src;
+    mb.warm_state.adc_capture_delays.clear();
+    BOOST_FOREACH(rfnoc::x300_radio_ctrl_impl::sptr r, mb.radios) {
+        mb.warm_state.adc_capture_delays.push_back(r->get_adc_capture_delay());
+    }
+    x300_warm_state_store(mb.serial, mb.warm_state);
+    mb.zpu_ctrl->poke32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_WARM_STATE),
+        x300_warm_state_hash(mb.warm_state));
 }
 
 void x300_impl::update_time_source(mboard_members_t &mb, const std::string &source)
@@ -1491,6 +1936,11 @@ sensor_value_t x300_impl::get_ref_locked(mboard_members_t& mb)
     return sensor_value_t("Ref", lock, "locked", "unlocked");
 }
 
+sensor_value_t x300_impl::get_fw_net_counter(wb_iface::sptr zpu_ctrl, const std::string &name, const uint32_t offset)
+{
+    return sensor_value_t(name, int(zpu_ctrl->peek32(SR_ADDR(X300_FW_SHMEM_BASE, offset))), "packets");
+}
+
 bool x300_impl::is_pps_present(mboard_members_t& mb)
 {
     // The ZPU_RB_CLK_STATUS_PPS_DETECT bit toggles with each rising edge of the PPS.
@@ -1598,7 +2048,7 @@ void x300_impl::release(wb_iface::sptr iface)
  * Frame size detection
  **********************************************************************/
 x300_impl::frame_size_t x300_impl::determine_max_frame_size(const std::string &addr,
-        const frame_size_t &user_frame_size)
+        const frame_size_t &user_frame_size, const bool verbose)
 {
     udp_simple::sptr udp = udp_simple::make_connected(addr,
             BOOST_STRINGIZE(X300_MTU_DETECT_UDP_PORT));
@@ -1621,7 +2071,7 @@ x300_impl::frame_size_t x300_impl::determine_max_frame_size(const std::string &a
     size_t min_send_frame_size = sizeof(x300_mtu_t);
     size_t max_send_frame_size = std::min(user_frame_size.send_frame_size, X300_10GE_DATA_FRAME_MAX_SIZE) & size_t(~3);
 
-    UHD_MSG(status) << "Determining maximum frame size... ";
+    if (verbose) UHD_MSG(status) << "Determining maximum frame size... ";
     while (min_recv_frame_size < max_recv_frame_size)
     {
        size_t test_frame_size = (max_recv_frame_size/2 + min_recv_frame_size/2 + 3) & ~3;
@@ -1670,14 +2120,152 @@ x300_impl::frame_size_t x300_impl::determine_max_frame_size(const std::string &a
     // of the recv and send frame sizes.
     frame_size.recv_frame_size = std::min(min_recv_frame_size, min_send_frame_size);
     frame_size.send_frame_size = std::min(min_recv_frame_size, min_send_frame_size);
-    UHD_MSG(status) << frame_size.send_frame_size << " bytes." << std::endl;
+    if (verbose) UHD_MSG(status) << frame_size.send_frame_size << " bytes." << std::endl;
     return frame_size;
 }
 
+bool x300_impl::verify_frame_size(const std::string &addr, const frame_size_t &frame_size)
+{
+    udp_simple::sptr udp = udp_simple::make_connected(addr,
+            BOOST_STRINGIZE(X300_MTU_DETECT_UDP_PORT));
+
+    std::vector<uint8_t> buffer(std::max(frame_size.recv_frame_size, frame_size.send_frame_size));
+    x300_mtu_t *request = reinterpret_cast<x300_mtu_t *>(&buffer.front());
+    static const double echo_timeout = 0.020; //20 ms
+
+    //the device answers with a frame of the requested size
+    request->flags = uhd::htonx<uint32_t>(X300_MTU_DETECT_ECHO_REQUEST);
+    request->size = uhd::htonx<uint32_t>(frame_size.recv_frame_size);
+    udp->send(boost::asio::buffer(buffer, sizeof(x300_mtu_t)));
+    if (udp->recv(boost::asio::buffer(buffer), echo_timeout) < frame_size.recv_frame_size)
+        return false;
+
+    //the device answers with the size of the frame it got
+    request->flags = uhd::htonx<uint32_t>(X300_MTU_DETECT_ECHO_REQUEST);
+    request->size = uhd::htonx<uint32_t>(sizeof(x300_mtu_t));
+    udp->send(boost::asio::buffer(buffer, frame_size.send_frame_size));
+    const size_t len = udp->recv(boost::asio::buffer(buffer), echo_timeout);
+    return len >= sizeof(x300_mtu_t)
+        and (uhd::ntohx<uint32_t>(request->flags) & X300_MTU_DETECT_ECHO_REPLY)
+        and uhd::ntohx<uint32_t>(request->size) >= frame_size.send_frame_size;
+}
+
+x300_impl::frame_size_t x300_impl::get_link_frame_size(
+        const std::string &addr,
+        const std::string &serial,
+        const frame_size_t &user_frame_size,
+        const bool use_cache)
+{
+    //the detection never searches above these
+    frame_size_t ceiling;
+    ceiling.recv_frame_size = std::min(user_frame_size.recv_frame_size, X300_10GE_DATA_FRAME_MAX_SIZE) & size_t(~3);
+    ceiling.send_frame_size = std::min(user_frame_size.send_frame_size, X300_10GE_DATA_FRAME_MAX_SIZE) & size_t(~3);
+
+    const std::string key = x300_mtu_cache_key(serial, addr);
+    x300_mtu_cache_entry_t entry;
+    if (use_cache and x300_mtu_cache_lookup(key, entry)) {
+        //A cached result below its own ceiling was limited by the path and is
+        //good for any ceiling. Otherwise it only covers ceilings up to its own.
+        const size_t entry_ceiling = std::min(entry.recv_ceiling, entry.send_ceiling);
+        if ((entry.recv_frame_size < entry_ceiling or entry.recv_ceiling >= ceiling.recv_frame_size) and
+            (entry.send_frame_size < entry_ceiling or entry.send_ceiling >= ceiling.send_frame_size)) {
+            frame_size_t frame_size;
+            frame_size.recv_frame_size = std::min(entry.recv_frame_size, ceiling.recv_frame_size);
+            frame_size.send_frame_size = std::min(entry.send_frame_size, ceiling.send_frame_size);
+            if (verify_frame_size(addr, frame_size)) {
+                UHD_MSG(status) << "Using cached maximum frame size... "
+                                << frame_size.send_frame_size << " bytes." << std::endl;
+                return frame_size;
+            }
+            UHD_LOG << "[X300] Cached frame size for " << addr << " no longer works, detecting it again" << std::endl;
+        }
+    }
+
+    const frame_size_t frame_size = determine_max_frame_size(addr, user_frame_size);
+    if (use_cache) {
+        entry.recv_frame_size = frame_size.recv_frame_size;
+        entry.send_frame_size = frame_size.send_frame_size;
+        entry.recv_ceiling = ceiling.recv_frame_size;
+        entry.send_ceiling = ceiling.send_frame_size;
+        x300_mtu_cache_store(key, entry);
+    }
+    return frame_size;
+}
+
+void x300_impl::mtu_reprobe_loop(
+        const fs_path &mb_path,
+        const std::vector<std::string> &eth_addrs,
+        const std::string &serial,
+        const frame_size_t &user_frame_size,
+        const bool use_cache,
+        const double period)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(long(period*1000)));
+
+    frame_size_t frame_size = user_frame_size;
+    try {
+        BOOST_FOREACH(const std::string &addr, eth_addrs) {
+            const frame_size_t link_frame_size = determine_max_frame_size(addr, user_frame_size, false);
+            frame_size.recv_frame_size = std::min(frame_size.recv_frame_size, link_frame_size.recv_frame_size);
+            frame_size.send_frame_size = std::min(frame_size.send_frame_size, link_frame_size.send_frame_size);
+            if (use_cache) {
+                x300_mtu_cache_entry_t entry;
+                entry.recv_frame_size = link_frame_size.recv_frame_size;
+                entry.send_frame_size = link_frame_size.send_frame_size;
+                entry.recv_ceiling = std::min(user_frame_size.recv_frame_size, X300_10GE_DATA_FRAME_MAX_SIZE) & size_t(~3);
+                entry.send_ceiling = std::min(user_frame_size.send_frame_size, X300_10GE_DATA_FRAME_MAX_SIZE) & size_t(~3);
+                x300_mtu_cache_store(x300_mtu_cache_key(serial, addr), entry);
+            }
+        }
+    }
+    catch (const std::exception &e) {
+        //the links may be busy or down, try again next period
+        UHD_LOG << "[X300] Frame size re-probe failed: " << e.what() << std::endl;
+        return;
+    }
+
+    //Only ever grow: streamers that already exist keep their frame size, and
+    //a smaller result is more likely a lost echo than a shrunk path.
+    boost::mutex::scoped_lock lock(_max_frame_sizes_mutex);
+    if (frame_size.recv_frame_size <= _max_frame_sizes.recv_frame_size and
+        frame_size.send_frame_size <= _max_frame_sizes.send_frame_size) return;
+    _max_frame_sizes.recv_frame_size = std::max(_max_frame_sizes.recv_frame_size, frame_size.recv_frame_size);
+    _max_frame_sizes.send_frame_size = std::max(_max_frame_sizes.send_frame_size, frame_size.send_frame_size);
+    UHD_MSG(status) << boost::format("Maximum frame size on %s grew to %lu bytes, new streamers will use it.")
+        % eth_addrs.at(0) % _max_frame_sizes.send_frame_size << std::endl;
+    _tree->access<size_t>(mb_path / "mtu/recv").set(_max_frame_sizes.recv_frame_size);
+    _tree->access<size_t>(mb_path / "mtu/send").set(std::min(_max_frame_sizes.send_frame_size, X300_ETH_DATA_FRAME_MAX_TX_SIZE));
+}
+
 /***********************************************************************
  * compat checks
  **********************************************************************/
 
+void x300_impl::setup_probe_dboards(const fs_path &mb_path, i2c_iface::sptr i2c)
+{
+    // The dboard EEPROMs as the radio blocks would read them (see
+    // x300_radio_ctrl_impl), without initializing the radios and dboards
+    static const size_t BASE_ADDR       = 0x50;
+    static const size_t RX_EEPROM_ADDR  = 0x5;
+    static const size_t TX_EEPROM_ADDR  = 0x4;
+    static const size_t GDB_EEPROM_ADDR = 0x1;
+    const static std::vector<size_t> EEPROM_ADDRS =
+        boost::assign::list_of(RX_EEPROM_ADDR)(TX_EEPROM_ADDR)(GDB_EEPROM_ADDR);
+    const static std::vector<std::string> EEPROM_PATHS =
+        boost::assign::list_of("rx_eeprom")("tx_eeprom")("gdb_eeprom");
+    const static std::vector<std::string> SLOTS = boost::assign::list_of("A")("B");
+
+    for (size_t slot_i = 0; slot_i < SLOTS.size(); slot_i++) {
+        const size_t db_offset = slot_i * 0x2;
+        for (size_t i = 0; i < EEPROM_ADDRS.size(); i++) {
+            dboard_eeprom_t db_eeprom;
+            db_eeprom.load(*i2c, BASE_ADDR | (EEPROM_ADDRS[i] + db_offset));
+            _tree->create<dboard_eeprom_t>(mb_path / "dboards" / SLOTS[slot_i] / EEPROM_PATHS[i])
+                .set(db_eeprom);
+        }
+    }
+}
+
 void x300_impl::check_fw_compat(const fs_path &mb_path, wb_iface::sptr iface)
 {
     uint32_t compat_num = iface->peek32(SR_ADDR(X300_FW_SHMEM_BASE, X300_FW_SHMEM_COMPAT_NUM));
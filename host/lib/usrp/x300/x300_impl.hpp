@@ -25,14 +25,17 @@
 #include <uhd/types/sensors.hpp>
 #include "x300_radio_ctrl_impl.hpp"
 #include "x300_clock_ctrl.hpp"
+#include "x300_warm_state.hpp"
 #include "x300_fw_common.h"
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include "i2c_core_100_wb32.hpp"
 #include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <uhd/usrp/gps_ctrl.hpp>
 #include <uhd/transport/nirio/niusrprio_session.h>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/muxed_zero_copy_if.hpp>
+#include <uhd/transport/frame_pool.hpp>
 #include "recv_packet_demuxer_3000.hpp"
 #include "x300_regs.hpp"
 ///////////// RFNOC /////////////////////
@@ -61,6 +64,7 @@ static const size_t X300_PCIE_TX_DATA_FRAME_SIZE        = 4096;     //bytes
 static const size_t X300_PCIE_TX_DATA_NUM_FRAMES	    = 4096;
 static const size_t X300_PCIE_MSG_FRAME_SIZE            = 256;      //bytes
 static const size_t X300_PCIE_MSG_NUM_FRAMES            = 64;
+static const size_t X300_PCIE_DATA_BATCH_SIZE           = 32;       //frames per DMA FIFO acquire
 static const size_t X300_PCIE_MAX_CHANNELS              = 6;
 static const size_t X300_PCIE_MAX_MUXED_CTRL_XPORTS     = 32;
 static const size_t X300_PCIE_MAX_MUXED_ASYNC_XPORTS    = 4;
@@ -74,6 +78,8 @@ static const size_t X300_ETH_DATA_FRAME_MAX_TX_SIZE = 8000;
 static const double X300_THREAD_BUFFER_TIMEOUT      = 0.1;   // Time in seconds
 
 static const size_t X300_ETH_MSG_NUM_FRAMES         = 64;
+static const int    X300_ETH_CTRL_PRIORITY          = 6;     // SO_PRIORITY, highest without CAP_NET_ADMIN
+static const int    X300_ETH_CTRL_DSCP              = 46;    // Expedited forwarding
 static const size_t X300_ETH_DATA_NUM_FRAMES        = 32;
 static const double X300_DEFAULT_SYSREF_RATE        = 10e6;
 
@@ -159,12 +165,32 @@ private:
     {
         bool initialization_done;
         uhd::task::sptr claimer_task;
+        //! Periodic frame size detection (mtu_reprobe)
+        uhd::task::sptr mtu_reprobe_task;
         std::string xport_path;
 
         std::vector<x300_eth_conn_t> eth_conns;
         size_t next_src_addr;
         size_t next_tx_src_addr;
         size_t next_rx_src_addr;
+        //! Live RX/TX data transports per Ethernet link (index into eth_conns)
+        std::vector< std::vector< boost::weak_ptr<uhd::transport::zero_copy_if> > > rx_link_xports;
+        std::vector< std::vector< boost::weak_ptr<uhd::transport::zero_copy_if> > > tx_link_xports;
+
+        /*! Pick the Ethernet link for a new transport
+         *
+         * Data transports go to the link carrying the fewest live data
+         * transports of the same direction, so two full-rate channels
+         * always end up on separate links. Ties and control transports
+         * fall back to round-robin.
+         */
+        size_t select_eth_link(const xport_type_t xport_type);
+
+        //! Account for a new data transport on the given Ethernet link
+        void register_eth_link_xport(
+                const size_t link,
+                const xport_type_t xport_type,
+                uhd::transport::zero_copy_if::sptr xport);
 
         // Discover the ethernet connections per motherboard
         void discover_eth(const uhd::usrp::mboard_eeprom_t mb_eeprom,
@@ -178,6 +204,11 @@ private:
 
         uhd::device_addr_t send_args;
         uhd::device_addr_t recv_args;
+        //! Device args for the AF_XDP data transports (data_xport=xdp)
+        uhd::device_addr_t xdp_args;
+        //! Transport hints for the control transports (from the ctrl_* device args)
+        uhd::device_addr_t ctrl_args;
+        bool use_xdp;
         bool if_pkt_is_big_endian;
         uhd::niusrprio::niusrprio_session::sptr  rio_fpga_interface;
 
@@ -198,6 +229,11 @@ private:
         size_t hw_rev;
         std::string current_refclk_src;
 
+        //! Warm restore (warm_restore device arg), see x300_warm_state.hpp
+        bool warm_restore;
+        std::string serial;
+        x300_warm_state_t warm_state;
+
         std::vector<uhd::rfnoc::x300_radio_ctrl_impl::sptr> radios;
 
         // PCIe specific components:
@@ -220,7 +256,30 @@ private:
     //task for periodically reclaiming the device from others
     void claimer_loop(uhd::wb_iface::sptr);
 
+    //! setup_mb() for the parallel motherboard setup, keeps the error for the constructor
+    void setup_mb_thread(
+        const size_t mb_i,
+        const uhd::device_addr_t &dev_addr,
+        boost::shared_ptr<uhd::exception> &error
+    );
+
+    //! x300_radio_ctrl_impl::setup_radio() for the parallel dboard setup
+    static void setup_radio_thread(
+        uhd::rfnoc::x300_radio_ctrl_impl::sptr radio,
+        uhd::i2c_iface::sptr zpu_i2c,
+        x300_clock_ctrl::sptr clock,
+        const uhd::device_addr_t &dev_addr,
+        const int32_t adc_capture_delay,
+        boost::shared_ptr<uhd::exception> &error
+    );
+
+    static bool block_on_lower_mboard(
+        const uhd::rfnoc::block_ctrl_base::sptr &lhs,
+        const uhd::rfnoc::block_ctrl_base::sptr &rhs
+    );
+
     size_t _sid_framer;
+    boost::mutex _sid_framer_mutex;
 
     uhd::sid_t allocate_sid(
         mboard_members_t &mb,
@@ -233,6 +292,14 @@ private:
         const uhd::device_addr_t& args
     );
 
+    void route_between_mboards(const uhd::sid_t &sid);
+
+    //! Make \p mb send the packets for \p dst_endpoint on motherboard \p dst_mb_index over the network
+    void program_mboard_route(
+        mboard_members_t &mb,
+        const size_t dst_mb_index,
+        const uint32_t dst_endpoint);
+
     struct frame_size_t
     {
         size_t recv_frame_size;
@@ -245,7 +312,37 @@ private:
      * to the device and see which packet sizes actually work. This way, we can take
      * switches etc. into account which might live between the device and the host.
      */
-    frame_size_t determine_max_frame_size(const std::string &addr, const frame_size_t &user_mtu);
+    frame_size_t determine_max_frame_size(const std::string &addr, const frame_size_t &user_mtu, const bool verbose = true);
+
+    /*!
+     * Check that frames of the given sizes still make it to the device and back.
+     * This costs two round trips instead of the full search.
+     */
+    bool verify_frame_size(const std::string &addr, const frame_size_t &frame_size);
+
+    /*!
+     * Get the maximum frame size for one link, from the frame size cache if
+     * it holds a result that still holds up, otherwise by running the detection.
+     */
+    frame_size_t get_link_frame_size(
+        const std::string &addr,
+        const std::string &serial,
+        const frame_size_t &user_mtu,
+        const bool use_cache
+    );
+
+    //! Task to re-run the detection and grow the frame size when the links allow it
+    void mtu_reprobe_loop(
+        const uhd::fs_path &mb_path,
+        const std::vector<std::string> &eth_addrs,
+        const std::string &serial,
+        const frame_size_t &user_mtu,
+        const bool use_cache,
+        const double period
+    );
+
+    //! Protects _max_frame_sizes against the mtu_reprobe task and parallel setup_mb()
+    boost::mutex _max_frame_sizes_mutex;
 
     ////////////////////////////////////////////////////////////////////
     //
@@ -266,6 +363,11 @@ private:
     //
     uhd::dict<std::string, uhd::transport::zero_copy_if::sptr> _send_cache;
     //
+    //Optionally, the UDP data transports of all motherboards borrow
+    //their frames from one pool instead of allocating their own.
+    //
+    uhd::transport::frame_pool::sptr _shared_frames;
+    //
     ////////////////////////////////////////////////////////////////////
 
     uhd::dict<std::string, uhd::usrp::dboard_manager::sptr> _dboard_managers;
@@ -276,15 +378,20 @@ private:
     void initialize_clock_control(mboard_members_t &mb);
     void set_time_source_out(mboard_members_t&, const bool);
     void update_clock_source(mboard_members_t&, const std::string &);
+    void store_warm_state(mboard_members_t&);
     void update_time_source(mboard_members_t&, const std::string &);
     void sync_times(mboard_members_t&, const uhd::time_spec_t&);
 
     uhd::sensor_value_t get_ref_locked(mboard_members_t& mb);
+    uhd::sensor_value_t get_fw_net_counter(uhd::wb_iface::sptr zpu_ctrl, const std::string &name, const uint32_t offset);
     bool wait_for_clk_locked(mboard_members_t& mb, uint32_t which, double timeout);
     bool is_pps_present(mboard_members_t& mb);
 
     void set_mb_eeprom(uhd::i2c_iface::sptr i2c, const uhd::usrp::mboard_eeprom_t &);
 
+    //! Publish the dboard EEPROMs of both slots (probe mode, instead of the radios)
+    void setup_probe_dboards(const uhd::fs_path &mb_path, uhd::i2c_iface::sptr i2c);
+
     void check_fw_compat(const uhd::fs_path &mb_path, uhd::wb_iface::sptr iface);
     void check_fpga_compat(const uhd::fs_path &mb_path, const mboard_members_t &members);
 
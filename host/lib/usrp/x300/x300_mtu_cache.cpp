@@ -0,0 +1,120 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+/*
+ * The frame size cache lives in <app path>/.uhd/x300_mtu_cache. Each line
+ * holds one link:
+ *
+ *   <serial>,<host address>,<device address> <recv> <send> <recv ceiling> <send ceiling>
+ *
+ * The file is small and rewritten as a whole on every store.
+ */
+
+#include "x300_mtu_cache.hpp"
+#include <uhd/utils/paths.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/transport/if_addrs.hpp>
+#include <boost/asio/ip/address_v4.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace fs = boost::filesystem;
+
+static boost::mutex cache_mutex;
+
+static fs::path get_cache_path(void)
+{
+    return fs::path(uhd::get_app_path()) / ".uhd" / "x300_mtu_cache";
+}
+
+typedef std::map<std::string, x300_mtu_cache_entry_t> cache_map_t;
+
+static cache_map_t read_cache(const fs::path &path)
+{
+    cache_map_t cache;
+    std::ifstream file(path.string().c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string key;
+        x300_mtu_cache_entry_t entry;
+        if (ss >> key >> entry.recv_frame_size >> entry.send_frame_size
+                >> entry.recv_ceiling >> entry.send_ceiling) {
+            cache[key] = entry;
+        }
+    }
+    return cache;
+}
+
+std::string x300_mtu_cache_key(const std::string &serial, const std::string &addr)
+{
+    //find the host interface on the device's subnet, this is the link the
+    //frame size detection actually measured
+    std::string host_addr = "unknown";
+    try {
+        const boost::asio::ip::address_v4 dev_addr = boost::asio::ip::address_v4::from_string(addr);
+        BOOST_FOREACH(const uhd::transport::if_addrs_t &if_addrs, uhd::transport::get_if_addrs()) {
+            const boost::asio::ip::address_v4 inet = boost::asio::ip::address_v4::from_string(if_addrs.inet);
+            const boost::asio::ip::address_v4 mask = boost::asio::ip::address_v4::from_string(if_addrs.mask);
+            if ((inet.to_ulong() & mask.to_ulong()) == (dev_addr.to_ulong() & mask.to_ulong())) {
+                host_addr = if_addrs.inet;
+                break;
+            }
+        }
+    }
+    catch (const std::exception &) {
+        //not a numeric address, the key still identifies the device
+    }
+    return (serial.empty() ? std::string("unknown") : serial) + "," + host_addr + "," + addr;
+}
+
+bool x300_mtu_cache_lookup(const std::string &key, x300_mtu_cache_entry_t &entry)
+{
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const cache_map_t cache = read_cache(get_cache_path());
+    cache_map_t::const_iterator it = cache.find(key);
+    if (it == cache.end()) return false;
+    entry = it->second;
+    return true;
+}
+
+void x300_mtu_cache_store(const std::string &key, const x300_mtu_cache_entry_t &entry)
+{
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const fs::path path = get_cache_path();
+    try {
+        cache_map_t cache = read_cache(path);
+        cache[key] = entry;
+
+        std::ostringstream contents;
+        BOOST_FOREACH(const cache_map_t::value_type &item, cache) {
+            contents << item.first << " "
+                     << item.second.recv_frame_size << " "
+                     << item.second.send_frame_size << " "
+                     << item.second.recv_ceiling << " "
+                     << item.second.send_ceiling << std::endl;
+        }
+        uhd::write_file_atomically(path.string(), contents.str());
+    }
+    catch (const std::exception &e) {
+        UHD_LOG << "[X300] Could not update frame size cache " << path.string() << ": " << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,64 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_X300_MTU_CACHE_HPP
+#define INCLUDED_X300_MTU_CACHE_HPP
+
+#include <string>
+#include <cstddef>
+
+/*!
+ * One result of the frame size detection for a single link.
+ * The ceilings are the upper limits the detection was run with, so a
+ * later lookup with a higher ceiling can tell whether the cached result
+ * was limited by the path or only by what was asked for.
+ */
+struct x300_mtu_cache_entry_t
+{
+    size_t recv_frame_size;
+    size_t send_frame_size;
+    size_t recv_ceiling;
+    size_t send_ceiling;
+};
+
+/*!
+ * Make the cache key for the link between this host and a device.
+ * The key contains the device serial, the address of the host interface
+ * on the device's subnet, and the device address.
+ * \param serial the motherboard serial (may be empty)
+ * \param addr the IPv4 address of the device
+ * \return a key without whitespace
+ */
+std::string x300_mtu_cache_key(const std::string &serial, const std::string &addr);
+
+/*!
+ * Look up a previous detection result.
+ * \param key a key from x300_mtu_cache_key()
+ * \param entry filled in on success
+ * \return true when the cache has an entry for the key
+ */
+bool x300_mtu_cache_lookup(const std::string &key, x300_mtu_cache_entry_t &entry);
+
+/*!
+ * Add or replace a detection result. Failure to write the cache file
+ * is logged and otherwise ignored.
+ * \param key a key from x300_mtu_cache_key()
+ * \param entry the detection result
+ */
+void x300_mtu_cache_store(const std::string &key, const x300_mtu_cache_entry_t &entry);
+
+#endif /* INCLUDED_X300_MTU_CACHE_HPP */
@@ -30,6 +30,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/date_time/posix_time/posix_time_io.hpp>
+#include <algorithm>
 
 using namespace uhd;
 using namespace uhd::usrp;
@@ -43,6 +44,7 @@ static const size_t IO_MASTER_RADIO = 0;
  ***************************************************************************/
 UHD_RFNOC_RADIO_BLOCK_CONSTRUCTOR(x300_radio_ctrl)
     , _ignore_cal_file(false)
+    , _adc_capture_delay(0)
 {
     UHD_RFNOC_BLOCK_TRACE() << "x300_radio_ctrl_impl::ctor() " << std::endl;
 
@@ -325,9 +327,17 @@ void x300_radio_ctrl_impl::setup_radio(
         uhd::i2c_iface::sptr zpu_i2c,
         x300_clock_ctrl::sptr clock,
         bool ignore_cal_file,
-        bool verbose)
+        bool verbose,
+        int32_t adc_capture_delay)
 {
-    _self_cal_adc_capture_delay(verbose);
+    if (adc_capture_delay >= 0) {
+        if (not _validate_adc_capture_delay(uint32_t(adc_capture_delay))) {
+            UHD_MSG(status) << "Cached ADC capture delay does not work anymore, calibrating." << std::endl;
+            _self_cal_adc_capture_delay(verbose);
+        }
+    } else {
+        _self_cal_adc_capture_delay(verbose);
+    }
     _ignore_cal_file = ignore_cal_file;
 
     ////////////////////////////////////////////////////////////////////
@@ -368,6 +378,10 @@ void x300_radio_ctrl_impl::setup_radio(
     db_config.which_tx_clk = (_radio_slot == "A") ? X300_CLOCK_WHICH_DB0_TX : X300_CLOCK_WHICH_DB1_TX;
     db_config.dboard_slot = (_radio_slot == "A")? 0 : 1;
     db_config.cmd_time_ctrl = _get_ctrl(IO_MASTER_RADIO);
+    //the control port behind the SPI and GPIO cores of the dboard
+    db_config.batch_ctrl = get_ctrl_iface(IO_MASTER_RADIO);
+    //property tree transactions batch the register writes on that port
+    _tree->add_batch_iface(db_config.batch_ctrl);
 
     //create a new dboard manager
     boost::shared_ptr<x300_dboard_iface> db_iface = boost::make_shared<x300_dboard_iface>(db_config);
@@ -668,41 +682,7 @@ double x300_radio_ctrl_impl::self_cal_adc_xfer_delay(
         double delay = clock->set_clock_delay(X300_CLOCK_WHICH_ADC0, delay_incr*i + delay_start);
         wait_for_clk_locked(0.1);
 
-        uint32_t err_code = 0;
-        for (size_t r = 0; r < radios.size(); r++) {
-            //Test each channel (I and Q) individually so as to not accidentally trigger
-            //on the data from the other channel if there is a swap
-
-            // -- Test I Channel --
-            //Put ADC in ramp test mode. Tie the other channel to all ones.
-            radios[r]->_adc->set_test_word("ramp", "ones");
-            //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
-            //and count deviations from the expected value
-            radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
-            radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
-            //50ms @ 200MHz = 10 million samples
-            boost::this_thread::sleep(boost::posix_time::milliseconds(50));
-            if (radios[r]->_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_I_LOCKED)) {
-                err_code += radios[r]->_regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_I_ERROR);
-            } else {
-                err_code += 100;    //Increment error code by 100 to indicate no lock
-            }
-
-            // -- Test Q Channel --
-            //Put ADC in ramp test mode. Tie the other channel to all ones.
-            radios[r]->_adc->set_test_word("ones", "ramp");
-            //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
-            //and count deviations from the expected value
-            radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
-            radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
-            //50ms @ 200MHz = 10 million samples
-            boost::this_thread::sleep(boost::posix_time::milliseconds(50));
-            if (radios[r]->_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_Q_LOCKED)) {
-                err_code += radios[r]->_regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_Q_ERROR);
-            } else {
-                err_code += 100;    //Increment error code by 100 to indicate no lock
-            }
-        }
+        const uint32_t err_code = _test_adc_xfer_delay(radios);
         //UHD_MSG(status) << (boost::format("XferDelay=%fns, Error=%d\n") % delay % err_code);
         results.push_back(std::pair<double,bool>(delay, err_code==0));
     }
@@ -778,6 +758,32 @@ double x300_radio_ctrl_impl::self_cal_adc_xfer_delay(
 
     return win_center;
 }
+
+bool x300_radio_ctrl_impl::validate_adc_xfer_delay(
+    const std::vector<x300_radio_ctrl_impl::sptr>& radios,
+    x300_clock_ctrl::sptr clock,
+    boost::function<void(double)> wait_for_clk_locked,
+    const double delay)
+{
+    //The self-cal requires a window of a quarter period and picks its
+    //center, so the neighbours an eighth of a period away must work too
+    const double margin = (1.0e9 / clock->get_master_clock_rate()) / 8;
+    const double offsets[] = {-margin, margin, 0.0};
+    bool valid = true;
+    BOOST_FOREACH(const double offset, offsets) {
+        clock->set_clock_delay(X300_CLOCK_WHICH_ADC0, delay + offset);
+        wait_for_clk_locked(0.1);
+        valid = valid and (_test_adc_xfer_delay(radios) == 0);
+    }
+
+    //Teardown
+    for (size_t r = 0; r < radios.size(); r++) {
+        radios[r]->_adc->set_test_word("normal", "normal");
+        radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+    }
+    return valid;
+}
+
 /****************************************************************************
  * Helpers
  ***************************************************************************/
@@ -808,41 +814,9 @@ void x300_radio_ctrl_impl::_self_cal_adc_capture_delay(bool print_status)
     while (iter++ < NUM_RETRIES) {
         for (uint32_t dly_tap = 0; dly_tap < NUM_DELAY_STEPS; dly_tap++) {
             //Apply delay
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_VAL, dly_tap);
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 1);
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 0);
-
-            uint32_t err_code = 0;
-
-            // -- Test I Channel --
-            //Put ADC in ramp test mode. Tie the other channel to all ones.
-            _adc->set_test_word("ramp", "ones");
-            //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
-            //and count deviations from the expected value
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
-            //10ms @ 200MHz = 2 million samples
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            if (_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_I_LOCKED)) {
-                err_code += _regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_I_ERROR);
-            } else {
-                err_code += 100;    //Increment error code by 100 to indicate no lock
-            }
+            _set_adc_capture_delay(dly_tap);
 
-            // -- Test Q Channel --
-            //Put ADC in ramp test mode. Tie the other channel to all ones.
-            _adc->set_test_word("ones", "ramp");
-            //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
-            //and count deviations from the expected value
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
-            _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
-            //10ms @ 200MHz = 2 million samples
-            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
-            if (_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_Q_LOCKED)) {
-                err_code += _regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_Q_ERROR);
-            } else {
-                err_code += 100;    //Increment error code by 100 to indicate no lock
-            }
+            const uint32_t err_code = _test_adc_capture_delay();
 
             if (err_code == 0) {
                 if (win_start == -1) {      //This is the first window
@@ -884,9 +858,7 @@ void x300_radio_ctrl_impl::_self_cal_adc_capture_delay(bool print_status)
     }
 
     uint32_t ideal_tap = (win_stop + win_start) / 2;
-    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_VAL, ideal_tap);
-    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 1);
-    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 0);
+    _set_adc_capture_delay(ideal_tap);
 
     if (print_status) {
         double tap_delay = (1.0e12 / _radio_clk_rate) / (2*32); //in ps
@@ -894,6 +866,109 @@ void x300_radio_ctrl_impl::_self_cal_adc_capture_delay(bool print_status)
     }
 }
 
+void x300_radio_ctrl_impl::_set_adc_capture_delay(const uint32_t dly_tap)
+{
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_VAL, dly_tap);
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 1);
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_DATA_DLY_STB, 0);
+    _adc_capture_delay = dly_tap;
+}
+
+bool x300_radio_ctrl_impl::_validate_adc_capture_delay(const uint32_t dly_tap)
+{
+    //The self-cal picks the center of a window of at least MIN_WINDOW_LEN
+    //taps, so the taps next to it must work too
+    static const uint32_t MARGIN = 2;
+    static const uint32_t NUM_DELAY_STEPS = 32;
+
+    bool valid = (dly_tap < NUM_DELAY_STEPS);
+    for (uint32_t t = (dly_tap > MARGIN)? dly_tap - MARGIN : 0;
+            valid and t <= std::min(dly_tap + MARGIN, NUM_DELAY_STEPS - 1); t++) {
+        _set_adc_capture_delay(t);
+        valid = (_test_adc_capture_delay() == 0);
+    }
+    _adc->set_test_word("normal", "normal");
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+    if (valid) _set_adc_capture_delay(dly_tap);
+    return valid;
+}
+
+uint32_t x300_radio_ctrl_impl::_test_adc_xfer_delay(const std::vector<x300_radio_ctrl_impl::sptr>& radios)
+{
+    uint32_t err_code = 0;
+    for (size_t r = 0; r < radios.size(); r++) {
+        //Test each channel (I and Q) individually so as to not accidentally trigger
+        //on the data from the other channel if there is a swap
+
+        // -- Test I Channel --
+        //Put ADC in ramp test mode. Tie the other channel to all ones.
+        radios[r]->_adc->set_test_word("ramp", "ones");
+        //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
+        //and count deviations from the expected value
+        radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+        radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
+        //50ms @ 200MHz = 10 million samples
+        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        if (radios[r]->_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_I_LOCKED)) {
+            err_code += radios[r]->_regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_I_ERROR);
+        } else {
+            err_code += 100;    //Increment error code by 100 to indicate no lock
+        }
+
+        // -- Test Q Channel --
+        //Put ADC in ramp test mode. Tie the other channel to all ones.
+        radios[r]->_adc->set_test_word("ones", "ramp");
+        //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
+        //and count deviations from the expected value
+        radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+        radios[r]->_regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
+        //50ms @ 200MHz = 10 million samples
+        boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+        if (radios[r]->_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_Q_LOCKED)) {
+            err_code += radios[r]->_regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER1_Q_ERROR);
+        } else {
+            err_code += 100;    //Increment error code by 100 to indicate no lock
+        }
+    }
+    return err_code;
+}
+
+uint32_t x300_radio_ctrl_impl::_test_adc_capture_delay(void)
+{
+    uint32_t err_code = 0;
+
+    // -- Test I Channel --
+    //Put ADC in ramp test mode. Tie the other channel to all ones.
+    _adc->set_test_word("ramp", "ones");
+    //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
+    //and count deviations from the expected value
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
+    //10ms @ 200MHz = 2 million samples
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    if (_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_I_LOCKED)) {
+        err_code += _regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_I_ERROR);
+    } else {
+        err_code += 100;    //Increment error code by 100 to indicate no lock
+    }
+
+    // -- Test Q Channel --
+    //Put ADC in ramp test mode. Tie the other channel to all ones.
+    _adc->set_test_word("ones", "ramp");
+    //Turn on the pattern checker in the FPGA. It will lock when it sees a zero
+    //and count deviations from the expected value
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 0);
+    _regs->misc_outs_reg.write(radio_regmap_t::misc_outs_reg_t::ADC_CHECKER_ENABLED, 1);
+    //10ms @ 200MHz = 2 million samples
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    if (_regs->misc_ins_reg.read(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_Q_LOCKED)) {
+        err_code += _regs->misc_ins_reg.get(radio_regmap_t::misc_ins_reg_t::ADC_CHECKER0_Q_ERROR);
+    } else {
+        err_code += 100;    //Increment error code by 100 to indicate no lock
+    }
+    return err_code;
+}
+
 void x300_radio_ctrl_impl::_check_adc(const uint32_t val)
 {
     //Wait for previous control transaction to flush
@@ -71,14 +71,23 @@ public:
      * Hardware setup and control
      ***********************************************************************/
     /*! Set up the radio. No API calls may be made before this one.
+     *
+     * \param adc_capture_delay ADC capture delay tap of an earlier
+     *        self-cal (see get_adc_capture_delay()), or -1 to run the
+     *        self-cal. A tap that fails the ADC checker, or whose
+     *        neighbours do, is calibrated anew.
      */
     void setup_radio(
         uhd::i2c_iface::sptr zpu_i2c,
         x300_clock_ctrl::sptr clock,
         bool ignore_cal_file,
-        bool verbose
+        bool verbose,
+        int32_t adc_capture_delay = -1
     );
 
+    //! The ADC capture delay tap in use
+    uint32_t get_adc_capture_delay(void) const { return _adc_capture_delay; }
+
     void reset_codec();
 
     void self_test_adc(
@@ -96,6 +105,16 @@ public:
         boost::function<void(double)> wait_for_clk_locked,
         bool apply_delay);
 
+    /*! Apply an ADC transfer delay of an earlier self_cal_adc_xfer_delay()
+     *  and check it and the delays around it with the ADC checkers.
+     * \return true when the delay works, it is applied in any case
+     */
+    static bool validate_adc_xfer_delay(
+        const std::vector<x300_radio_ctrl_impl::sptr>& radios,
+        x300_clock_ctrl::sptr clock,
+        boost::function<void(double)> wait_for_clk_locked,
+        const double delay);
+
 protected:
     virtual bool check_radio_config();
 
@@ -154,6 +173,17 @@ private:
 
     void _self_cal_adc_capture_delay(bool print_status);
 
+    void _set_adc_capture_delay(const uint32_t dly_tap);
+
+    //! Count ADC checker errors at the current capture delay, 0 when clean
+    uint32_t _test_adc_capture_delay(void);
+
+    //! Apply the tap when it and its neighbours pass the ADC checker
+    bool _validate_adc_capture_delay(const uint32_t dly_tap);
+
+    //! Count ADC checker errors after the transfer delay, 0 when clean
+    static uint32_t _test_adc_xfer_delay(const std::vector<x300_radio_ctrl_impl::sptr>& radios);
+
     void _check_adc(const uint32_t val);
 
     void _set_db_eeprom(uhd::i2c_iface::sptr i2c, const size_t, const uhd::usrp::dboard_eeprom_t &);
@@ -198,6 +228,7 @@ private: // members
     std::map<size_t, tx_fe_perif>   _tx_fe_map;
 
     bool _ignore_cal_file;
+    uint32_t _adc_capture_delay;
 
 }; /* class radio_ctrl_impl */
 
@@ -46,6 +46,12 @@ static const int ZPU_SR_ETHINT1    = 56;
 static const int ZPU_SR_DRAM_FIFO0 = 72;
 static const int ZPU_SR_DRAM_FIFO1 = 80;
 
+//ethernet framer registers, relative to ZPU_SR_ETHINT0/1
+static const int ZPU_SR_ETH_FRAMER_DST_RAM_ADDR = 4;
+static const int ZPU_SR_ETH_FRAMER_DST_IP_ADDR  = 5;
+static const int ZPU_SR_ETH_FRAMER_DST_UDP_MAC  = 6;
+static const int ZPU_SR_ETH_FRAMER_DST_MAC_LO   = 7;
+
 //reset bits
 #define ZPU_SR_SW_RST_ETH_PHY           (1<<0)
 #define ZPU_SR_SW_RST_RADIO_RST         (1<<1)
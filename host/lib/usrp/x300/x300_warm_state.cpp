@@ -0,0 +1,217 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+/*
+ * The warm state cache lives in <app path>/.uhd/x300_warm_state. Each line
+ * holds one device:
+ *
+ *   <serial> <state>
+ *
+ * where <state> is the string from to_string() below, without whitespace.
+ * The hash on the device is taken over that same string.
+ *
+ * The ADC calibration cache in <app path>/.uhd/x300_adc_cal has the same
+ * layout, with one line per key from x300_adc_cal_key().
+ */
+
+#include "x300_warm_state.hpp"
+#include <uhd/utils/paths.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace fs = boost::filesystem;
+
+static boost::mutex cache_mutex;
+
+static fs::path get_cache_path(const std::string &name = "x300_warm_state")
+{
+    return fs::path(uhd::get_app_path()) / ".uhd" / name;
+}
+
+x300_warm_state_t::x300_warm_state_t(void):
+    fpga_git_hash(0),
+    master_clock_rate(0.0),
+    dboard_clock_rate(0.0),
+    system_ref_rate(0.0)
+{
+    /* NOP */
+}
+
+bool x300_warm_state_t::same_config(const x300_warm_state_t &other) const
+{
+    return fpga_git_hash == other.fpga_git_hash
+        and fpga_image == other.fpga_image
+        and master_clock_rate == other.master_clock_rate
+        and dboard_clock_rate == other.dboard_clock_rate
+        and system_ref_rate == other.system_ref_rate;
+}
+
+static std::string to_string(const x300_warm_state_t &state)
+{
+    std::string s = str(boost::format("fpga=%08x,image=%s,mcr=%.17g,dbclk=%.17g,sysref=%.17g,source=%s")
+        % state.fpga_git_hash % state.fpga_image
+        % state.master_clock_rate % state.dboard_clock_rate % state.system_ref_rate
+        % state.clock_source);
+    BOOST_FOREACH(const uint32_t tap, state.adc_capture_delays) {
+        s += str(boost::format(",adc_dly=%u") % tap);
+    }
+    return s;
+}
+
+static bool from_string(const std::string &str, x300_warm_state_t &state)
+{
+    std::vector<std::string> fields;
+    boost::split(fields, str, boost::is_any_of(","));
+    state = x300_warm_state_t();
+    try {
+        BOOST_FOREACH(const std::string &field, fields) {
+            const size_t eq = field.find('=');
+            if (eq == std::string::npos) return false;
+            const std::string key = field.substr(0, eq);
+            const std::string val = field.substr(eq + 1);
+            if (key == "fpga") {
+                std::istringstream ss(val);
+                ss >> std::hex >> state.fpga_git_hash;
+                if (not ss) return false;
+            }
+            else if (key == "image") state.fpga_image = val;
+            else if (key == "mcr") state.master_clock_rate = boost::lexical_cast<double>(val);
+            else if (key == "dbclk") state.dboard_clock_rate = boost::lexical_cast<double>(val);
+            else if (key == "sysref") state.system_ref_rate = boost::lexical_cast<double>(val);
+            else if (key == "source") state.clock_source = val;
+            else if (key == "adc_dly") state.adc_capture_delays.push_back(boost::lexical_cast<uint32_t>(val));
+            else return false;
+        }
+    }
+    catch (const boost::bad_lexical_cast &) {
+        return false;
+    }
+    return true;
+}
+
+uint32_t x300_warm_state_hash(const x300_warm_state_t &state)
+{
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    BOOST_FOREACH(const char c, to_string(state)) {
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return (hash == 0) ? 1 : hash;
+}
+
+typedef std::map<std::string, std::string> cache_map_t;
+
+static cache_map_t read_cache(const fs::path &path)
+{
+    cache_map_t cache;
+    std::ifstream file(path.string().c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string serial, state;
+        if (ss >> serial >> state) {
+            cache[serial] = state;
+        }
+    }
+    return cache;
+}
+
+//! Replace the cache file, throws on failure
+static void write_cache(const fs::path &path, const cache_map_t &cache)
+{
+    std::ostringstream contents;
+    BOOST_FOREACH(const cache_map_t::value_type &item, cache) {
+        contents << item.first << " " << item.second << std::endl;
+    }
+    uhd::write_file_atomically(path.string(), contents.str());
+}
+
+bool x300_warm_state_lookup(const std::string &serial, x300_warm_state_t &state)
+{
+    if (serial.empty()) return false;
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const cache_map_t cache = read_cache(get_cache_path());
+    cache_map_t::const_iterator it = cache.find(serial);
+    return it != cache.end() and from_string(it->second, state);
+}
+
+void x300_warm_state_store(const std::string &serial, const x300_warm_state_t &state)
+{
+    if (serial.empty()) return;
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const fs::path path = get_cache_path();
+    try {
+        cache_map_t cache = read_cache(path);
+        cache[serial] = to_string(state);
+        write_cache(path, cache);
+    }
+    catch (const std::exception &e) {
+        UHD_LOG << "[X300] Could not update warm state cache " << path.string() << ": " << e.what() << std::endl;
+    }
+}
+
+std::string x300_adc_cal_key(
+    const std::string &serial,
+    const uint32_t fpga_git_hash,
+    const double master_clock_rate,
+    const std::string &what
+) {
+    if (serial.empty()) return "";
+    return str(boost::format("%s,fpga=%08x,mcr=%.17g,%s")
+        % serial % fpga_git_hash % master_clock_rate % what);
+}
+
+bool x300_adc_cal_lookup(const std::string &key, double &value)
+{
+    if (key.empty()) return false;
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const cache_map_t cache = read_cache(get_cache_path("x300_adc_cal"));
+    cache_map_t::const_iterator it = cache.find(key);
+    if (it == cache.end()) return false;
+    try {
+        value = boost::lexical_cast<double>(it->second);
+    }
+    catch (const boost::bad_lexical_cast &) {
+        return false;
+    }
+    return true;
+}
+
+void x300_adc_cal_store(const std::string &key, const double value)
+{
+    if (key.empty()) return;
+    boost::mutex::scoped_lock lock(cache_mutex);
+    const fs::path path = get_cache_path("x300_adc_cal");
+    try {
+        cache_map_t cache = read_cache(path);
+        const std::string value_str = str(boost::format("%.17g") % value);
+        if (cache[key] == value_str) return;
+        cache[key] = value_str;
+        write_cache(path, cache);
+    }
+    catch (const std::exception &e) {
+        UHD_LOG << "[X300] Could not update ADC calibration cache " << path.string() << ": " << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_X300_WARM_STATE_HPP
+#define INCLUDED_X300_WARM_STATE_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ * The hardware state an X300 initialization leaves behind, for a warm
+ * restore (device arg warm_restore=1).
+ *
+ * At the end of every initialization with warm_restore, the state is
+ * stored in the host cache, and its hash in the firmware shared memory
+ * (X300_FW_SHMEM_WARM_STATE). Every initialization clears that word
+ * first, and it is gone after a power cycle or FPGA reload. So when the
+ * word read back from the device equals the hash of the cached state, the
+ * device still runs that state, and reprogramming the LMK and calibrating
+ * the ADC capture delay can be skipped.
+ */
+struct x300_warm_state_t
+{
+    //! What was asked for: a restore needs the same values
+    uint32_t fpga_git_hash;
+    std::string fpga_image;
+    double master_clock_rate;
+    double dboard_clock_rate;
+    double system_ref_rate;
+
+    //! What the hardware was left in
+    std::string clock_source;
+    std::vector<uint32_t> adc_capture_delays; //one per radio
+
+    x300_warm_state_t(void);
+
+    //! True when the configuration (not the state) is the same
+    bool same_config(const x300_warm_state_t &other) const;
+};
+
+/*!
+ * The hash stored on the device, never 0 (0 means "no known state").
+ */
+uint32_t x300_warm_state_hash(const x300_warm_state_t &state);
+
+/*!
+ * Look up the state stored for a device.
+ * \param serial the motherboard serial
+ * \param state filled in on success
+ * \return true when the cache has a state for the serial
+ */
+bool x300_warm_state_lookup(const std::string &serial, x300_warm_state_t &state);
+
+/*!
+ * Add or replace the state of a device. Failure to write the cache file
+ * is logged and otherwise ignored.
+ */
+void x300_warm_state_store(const std::string &serial, const x300_warm_state_t &state);
+
+/*!
+ * ADC calibration cache (device arg adc_cal_cache, on unless set to 0).
+ *
+ * Unlike the warm state, the ADC capture and transfer delays are kept
+ * across power cycles: they depend on the board, the FPGA image and the
+ * clock rate, which make up the key. A cached delay is only a starting
+ * point, it is validated at startup and calibrated anew when it fails.
+ *
+ * \param what which delay, e.g. "capture0" for the first radio
+ * \return the key, empty when the serial is unknown
+ */
+std::string x300_adc_cal_key(
+    const std::string &serial,
+    const uint32_t fpga_git_hash,
+    const double master_clock_rate,
+    const std::string &what
+);
+
+//! Look up a cached ADC delay, false when there is none
+bool x300_adc_cal_lookup(const std::string &key, double &value);
+
+//! Add or replace a cached ADC delay, failures are logged and ignored
+void x300_adc_cal_store(const std::string &key, const double value);
+
+#endif /* INCLUDED_X300_WARM_STATE_HPP */
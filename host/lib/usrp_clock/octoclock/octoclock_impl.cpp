@@ -37,6 +37,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/static.hpp>
+#include <uhd/utils/tasks.hpp>
 
 #include "octoclock_impl.hpp"
 #include "octoclock_uart.hpp"
@@ -186,7 +187,9 @@ UHD_STATIC_BLOCK(register_octoclock_device){
 /***********************************************************************
  * Structors
  **********************************************************************/
-octoclock_impl::octoclock_impl(const device_addr_t &_device_addr){
+octoclock_impl::octoclock_impl(const device_addr_t &_device_addr):
+    _state_max_age(_device_addr.cast<double>("state_max_age", 0.1))
+{
     UHD_MSG(status) << "Opening an OctoClock device..." << std::endl;
     _type = device::CLOCK;
     device_addrs_t device_args = separate_device_addr(_device_addr);
@@ -304,6 +307,15 @@ octoclock_impl::octoclock_impl(const device_addr_t &_device_addr){
                                                                                 % _which_ref(oc).value
                              << std::endl;
     }
+
+    ////////////////////////////////////////////////////////////////////
+    // Keep the state fresh in the background, if asked to
+    ////////////////////////////////////////////////////////////////////
+    const double state_poll_interval = _device_addr.cast<double>("state_poll_interval", 0.0);
+    if(state_poll_interval > 0.0){
+        _state_task = task::make(boost::bind(&octoclock_impl::_poll_state, this, state_poll_interval),
+                                 "async", "octoclock state poll");
+    }
 }
 
 rx_streamer::sptr octoclock_impl::get_rx_stream(UHD_UNUSED(const stream_args_t &args)){
@@ -359,10 +371,34 @@ void octoclock_impl::_get_state(const std::string &oc){
     if(UHD_OCTOCLOCK_PACKET_MATCHES(SEND_STATE_ACK, pkt_out, pkt_in, len)){
         const octoclock_state_t *state = reinterpret_cast<const octoclock_state_t*>(pkt_in->data);
         _oc_dict[oc].state = *state;
+        _oc_dict[oc].state_time = boost::get_system_time();
     }
     else throw uhd::runtime_error("Failed to retrieve state information from OctoClock.");
 }
 
+octoclock_state_t octoclock_impl::_get_cached_state(const std::string &oc){
+    boost::mutex::scoped_lock lock(_state_mutex);
+    if(_oc_dict[oc].state_time.is_not_a_date_time()
+       or boost::get_system_time() - _oc_dict[oc].state_time
+          > boost::posix_time::microseconds(long(_state_max_age*1e6))){
+        _get_state(oc);
+    }
+    return _oc_dict[oc].state;
+}
+
+void octoclock_impl::_poll_state(const double interval){
+    BOOST_FOREACH(const std::string &oc, _oc_dict.keys()){
+        try{
+            boost::mutex::scoped_lock lock(_state_mutex);
+            _get_state(oc);
+        }
+        catch(const uhd::exception &e){
+            UHD_MSG(warning) << "OctoClock " << oc << ": " << e.what() << std::endl;
+        }
+    }
+    boost::this_thread::sleep(boost::posix_time::microseconds(long(interval*1e6)));
+}
+
 uhd::dict<ref_t, std::string> _ref_strings = boost::assign::map_list_of
     (NO_REF,   "none")
     (INTERNAL, "internal")
@@ -375,9 +411,9 @@ uhd::dict<switch_pos_t, std::string> _switch_pos_strings = boost::assign::map_li
 ;
 
 sensor_value_t octoclock_impl::_ext_ref_detected(const std::string &oc){
-    _get_state(oc);
+    const octoclock_state_t state = _get_cached_state(oc);
 
-    return sensor_value_t("External reference detected", (_oc_dict[oc].state.external_detected > 0),
+    return sensor_value_t("External reference detected", (state.external_detected > 0),
                           "true", "false");
 }
 
@@ -389,23 +425,23 @@ sensor_value_t octoclock_impl::_gps_detected(const std::string &oc){
 }
 
 sensor_value_t octoclock_impl::_which_ref(const std::string &oc){
-    _get_state(oc);
+    const octoclock_state_t state = _get_cached_state(oc);
 
-    if(not _ref_strings.has_key(ref_t(_oc_dict[oc].state.which_ref))){
+    if(not _ref_strings.has_key(ref_t(state.which_ref))){
         throw uhd::runtime_error("Invalid reference detected.");
     }
 
-    return sensor_value_t("Using reference", _ref_strings[ref_t(_oc_dict[oc].state.which_ref)], "");
+    return sensor_value_t("Using reference", _ref_strings[ref_t(state.which_ref)], "");
 }
 
 sensor_value_t octoclock_impl::_switch_pos(const std::string &oc){
-    _get_state(oc);
+    const octoclock_state_t state = _get_cached_state(oc);
 
-    if(not _switch_pos_strings.has_key(switch_pos_t(_oc_dict[oc].state.switch_pos))){
+    if(not _switch_pos_strings.has_key(switch_pos_t(state.switch_pos))){
         throw uhd::runtime_error("Invalid switch position detected.");
     }
 
-    return sensor_value_t("Switch position", _switch_pos_strings[switch_pos_t(_oc_dict[oc].state.switch_pos)], "");
+    return sensor_value_t("Switch position", _switch_pos_strings[switch_pos_t(state.switch_pos)], "");
 }
 
 uint32_t octoclock_impl::_get_time(const std::string &oc){
@@ -28,6 +28,7 @@
 #include <uhd/types/device_addr.hpp>
 #include <uhd/types/dict.hpp>
 #include <uhd/types/sensors.hpp>
+#include <uhd/utils/tasks.hpp>
 
 #include "common.h"
 
@@ -51,6 +52,7 @@ private:
     struct oc_container_type{
         uhd::usrp_clock::octoclock_eeprom_t eeprom;
         octoclock_state_t state;
+        boost::system_time state_time; //when the state was read
         uhd::transport::udp_simple::sptr ctrl_xport;
         uhd::transport::udp_simple::sptr gpsdo_xport;
         uhd::gps_ctrl::sptr gps;
@@ -65,6 +67,11 @@ private:
 
     void _get_state(const std::string &oc);
 
+    //! Get the state, read again if older than the state_max_age arg
+    octoclock_state_t _get_cached_state(const std::string &oc);
+
+    void _poll_state(const double interval);
+
     uhd::sensor_value_t _ext_ref_detected(const std::string &oc);
 
     uhd::sensor_value_t _gps_detected(const std::string &oc);
@@ -78,6 +85,10 @@ private:
     std::string _get_images_help_message(const std::string &addr);
 
     boost::mutex _device_mutex;
+
+    double _state_max_age; //in seconds
+    boost::mutex _state_mutex;
+    uhd::task::sptr _state_task; //destroyed first, it uses the rest
 };
 
 #endif /* INCLUDED_OCTOCLOCK_IMPL_HPP */
@@ -0,0 +1,453 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/capture_file.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/format.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <algorithm>
+#include <cstring>
+
+using namespace uhd;
+namespace ip = boost::interprocess;
+
+static const char CAPTURE_MAGIC[8]    = {'U', 'H', 'D', 'C', 'A', 'P', 'T', 'R'};
+static const char INDEX_MAGIC[8]      = {'U', 'H', 'D', 'C', 'I', 'D', 'X', '1'};
+static const uint32_t CAPTURE_VERSION = 1;
+static const uint32_t BLOCK_MAGIC     = 0x4b424355; //"UCBK"
+static const size_t HEADER_SIZE       = 4096; //keeps the blocks page aligned for direct I/O
+static const size_t BLOCK_ALIGN       = 8;
+
+/***********************************************************************
+ * Layout of the file
+ **********************************************************************/
+struct capture_file_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t num_chans;
+    uint32_t bytes_per_samp;
+    double samp_rate;
+    char cpu_format[16];
+    char settings[HEADER_SIZE - 48]; //device_addr_t::to_string(), NUL terminated
+};
+
+struct capture_block_header_t
+{
+    uint32_t magic;
+    uint32_t flags;
+    uint32_t nsamps;
+    uint32_t stride; //samples per channel the block has room for
+    uint64_t sample_index;
+    int64_t full_secs;
+    double frac_secs;
+    int32_t error_code;
+    uint32_t payload_size; //bytes after the header
+};
+
+struct capture_index_entry_t
+{
+    int64_t full_secs;
+    double frac_secs;
+    uint64_t sample_index;
+    uint64_t offset; //of the block header
+};
+
+struct capture_index_trailer_t
+{
+    char magic[8];
+    uint64_t num_entries;
+    uint64_t index_offset;
+};
+
+static size_t align_up(const size_t size)
+{
+    return ((size + BLOCK_ALIGN - 1)/BLOCK_ALIGN)*BLOCK_ALIGN;
+}
+
+capture_file_info_t::capture_file_info_t(void):
+    num_chans(1), samp_rate(0.0)
+{
+    /* NOP */
+}
+
+capture_file_reader::block_t::block_t(void):
+    nsamps(0), flags(0), sample_index(0), error_code(rx_metadata_t::ERROR_CODE_NONE)
+{
+    /* NOP */
+}
+
+capture_file_writer::~capture_file_writer(void)
+{
+    /* NOP */
+}
+
+capture_file_reader::~capture_file_reader(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Writer
+ **********************************************************************/
+class capture_file_writer_impl : public capture_file_writer
+{
+public:
+    capture_file_writer_impl(
+        const std::string &path,
+        const capture_file_info_t &info,
+        const size_t index_interval,
+        const size_t buffer_size,
+        const bool direct
+    ):
+        _info(info),
+        _bytes_per_samp(convert::get_bytes_per_item(info.cpu_format)),
+        _index_interval(index_interval),
+        _offset(0),
+        _sample_index(0),
+        _reserved(0),
+        _has_expected(false),
+        _has_space(false)
+    {
+        if (info.num_chans == 0 or info.samp_rate <= 0.0) {
+            throw uhd::value_error("capture_file_writer: the capture needs channels and a sample rate");
+        }
+        capture_file_header_t header;
+        std::memset(&header, 0, sizeof(header));
+        if (info.cpu_format.size() >= sizeof(header.cpu_format)) {
+            throw uhd::value_error("capture_file_writer: cpu format name too long: " + info.cpu_format);
+        }
+        const std::string settings = info.settings.to_string();
+        if (settings.size() >= sizeof(header.settings)) {
+            throw uhd::value_error(str(boost::format(
+                "capture_file_writer: the settings take %u bytes, the header has room for %u")
+                % settings.size() % (sizeof(header.settings) - 1)));
+        }
+        std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+        header.version = CAPTURE_VERSION;
+        header.header_size = HEADER_SIZE;
+        header.num_chans = uint32_t(info.num_chans);
+        header.bytes_per_samp = uint32_t(_bytes_per_samp);
+        header.samp_rate = info.samp_rate;
+        std::strncpy(header.cpu_format, info.cpu_format.c_str(), sizeof(header.cpu_format));
+        std::strncpy(header.settings, settings.c_str(), sizeof(header.settings));
+
+        _writer = sample_file_writer::make(path, buffer_size, 4, direct);
+        _writer->write(&header, sizeof(header));
+        _offset = sizeof(header);
+        _buffs.resize(info.num_chans);
+    }
+
+    ~capture_file_writer_impl(void)
+    {
+        UHD_SAFE_CALL(this->close();)
+    }
+
+    const std::vector<void *> &get_write_space(const size_t nsamps)
+    {
+        if (not _writer) {
+            throw uhd::runtime_error("capture_file_writer: the file is closed");
+        }
+        const size_t payload_size = align_up(_info.num_chans*nsamps*_bytes_per_samp);
+        char *mem = static_cast<char *>(_writer->get_write_space(sizeof(capture_block_header_t) + payload_size));
+        for (size_t i = 0; i < _info.num_chans; i++) {
+            _buffs[i] = mem + sizeof(capture_block_header_t) + i*nsamps*_bytes_per_samp;
+        }
+        _space = mem;
+        _reserved = nsamps;
+        _has_space = true;
+        return _buffs;
+    }
+
+    void commit(const size_t nsamps, const rx_metadata_t &md)
+    {
+        if (not _has_space or nsamps > _reserved) {
+            throw uhd::value_error("capture_file_writer: commit() without get_write_space()");
+        }
+        const bool is_error = (md.error_code != rx_metadata_t::ERROR_CODE_NONE);
+        if (md.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) return;
+        if (nsamps == 0 and not is_error) return;
+        _has_space = false;
+
+        capture_block_header_t header;
+        header.magic = BLOCK_MAGIC;
+        header.flags = (md.has_time_spec ? capture_file_reader::FLAG_HAS_TIME : 0)
+                     | (md.start_of_burst ? capture_file_reader::FLAG_SOB : 0)
+                     | (md.end_of_burst ? capture_file_reader::FLAG_EOB : 0)
+                     | ((is_error and nsamps == 0) ? capture_file_reader::FLAG_ERROR : 0);
+        header.nsamps = uint32_t(nsamps);
+        header.stride = (nsamps == 0) ? 0 : uint32_t(_reserved);
+        header.sample_index = _sample_index;
+        header.full_secs = md.time_spec.get_full_secs();
+        header.frac_secs = md.time_spec.get_frac_secs();
+        header.error_code = int32_t(md.error_code);
+        header.payload_size = uint32_t(align_up(_info.num_chans*header.stride*_bytes_per_samp));
+
+        if (nsamps != 0 and md.has_time_spec) {
+            //a block that does not start where the one before ended
+            if (_has_expected and (md.time_spec - _expected).to_ticks(_info.samp_rate) != 0) {
+                header.flags |= capture_file_reader::FLAG_GAP;
+            }
+            _has_expected = true;
+            _expected = md.time_spec + time_spec_t::from_ticks((long long)(nsamps), _info.samp_rate);
+
+            if (_index.empty() or _offset - _index.back().offset >= _index_interval) {
+                capture_index_entry_t entry;
+                entry.full_secs = header.full_secs;
+                entry.frac_secs = header.frac_secs;
+                entry.sample_index = _sample_index;
+                entry.offset = _offset;
+                _index.push_back(entry);
+            }
+        }
+
+        std::memcpy(_space, &header, sizeof(header));
+        const size_t len = sizeof(header) + header.payload_size;
+        _writer->commit(len);
+        _offset += len;
+        _sample_index += nsamps;
+    }
+
+    void write(const std::vector<const void *> &buffs, const size_t nsamps, const rx_metadata_t &md)
+    {
+        const std::vector<void *> &space = this->get_write_space(nsamps);
+        for (size_t i = 0; i < space.size() and i < buffs.size(); i++) {
+            std::memcpy(space[i], buffs[i], nsamps*_bytes_per_samp);
+        }
+        this->commit(nsamps, md);
+    }
+
+    void close(void)
+    {
+        if (not _writer) return;
+        sample_file_writer::sptr writer = _writer;
+        _writer.reset();
+
+        capture_index_trailer_t trailer;
+        std::memcpy(trailer.magic, INDEX_MAGIC, sizeof(trailer.magic));
+        trailer.num_entries = _index.size();
+        trailer.index_offset = _offset;
+        if (not _index.empty()) {
+            writer->write(&_index.front(), _index.size()*sizeof(capture_index_entry_t));
+        }
+        writer->write(&trailer, sizeof(trailer));
+        _stats = writer->get_stats();
+        writer->close();
+    }
+
+    sample_file_writer::stats_t get_stats(void)
+    {
+        return _writer ? _writer->get_stats() : _stats;
+    }
+
+private:
+    const capture_file_info_t _info;
+    const size_t _bytes_per_samp;
+    const size_t _index_interval;
+    sample_file_writer::sptr _writer;
+    sample_file_writer::stats_t _stats; //of the closed writer
+    uint64_t _offset; //in the file, of the next block
+    uint64_t _sample_index;
+    std::vector<void *> _buffs;
+    char *_space;
+    size_t _reserved;
+    bool _has_expected;
+    time_spec_t _expected; //the time the next block should have
+    bool _has_space;
+    std::vector<capture_index_entry_t> _index;
+};
+
+capture_file_writer::sptr capture_file_writer::make(
+    const std::string &path,
+    const capture_file_info_t &info,
+    const size_t index_interval,
+    const size_t buffer_size,
+    const bool direct
+){
+    return sptr(new capture_file_writer_impl(path, info, index_interval, buffer_size, direct));
+}
+
+/***********************************************************************
+ * Reader
+ **********************************************************************/
+class capture_file_reader_impl : public capture_file_reader
+{
+public:
+    capture_file_reader_impl(const std::string &path):
+        _has_index(false)
+    {
+        try {
+            _mapping = ip::file_mapping(path.c_str(), ip::read_only);
+            _region = ip::mapped_region(_mapping, ip::read_only);
+        } catch (const ip::interprocess_exception &e) {
+            throw uhd::io_error(str(boost::format("capture_file_reader: cannot map %s: %s") % path % e.what()));
+        }
+        _base = static_cast<const char *>(_region.get_address());
+        _size = _region.get_size();
+
+        const capture_file_header_t *header = reinterpret_cast<const capture_file_header_t *>(_base);
+        if (_size < sizeof(*header) or std::memcmp(header->magic, CAPTURE_MAGIC, sizeof(header->magic)) != 0
+                or header->version != CAPTURE_VERSION or header->header_size != HEADER_SIZE) {
+            throw uhd::io_error("capture_file_reader: " + path + " is not a capture file of this UHD version");
+        }
+        _info.cpu_format = std::string(header->cpu_format, strnlen(header->cpu_format, sizeof(header->cpu_format)));
+        _info.num_chans = header->num_chans;
+        _info.samp_rate = header->samp_rate;
+        _info.settings = device_addr_t(std::string(header->settings, strnlen(header->settings, sizeof(header->settings))));
+        _bytes_per_samp = header->bytes_per_samp;
+
+        //the index at the end, or else one pass over the blocks
+        const capture_index_trailer_t *trailer = reinterpret_cast<const capture_index_trailer_t *>(
+            _base + _size - sizeof(capture_index_trailer_t));
+        if (_size >= HEADER_SIZE + sizeof(*trailer)
+                and std::memcmp(trailer->magic, INDEX_MAGIC, sizeof(trailer->magic)) == 0
+                and trailer->index_offset >= HEADER_SIZE
+                and trailer->index_offset + trailer->num_entries*sizeof(capture_index_entry_t) + sizeof(*trailer) == _size) {
+            _has_index = true;
+            _end = size_t(trailer->index_offset);
+            _index = reinterpret_cast<const capture_index_entry_t *>(_base + _end);
+            _num_entries = size_t(trailer->num_entries);
+        } else {
+            this->build_index();
+            UHD_MSG(warning) << "capture_file_reader: " << path
+                << " has no index (the recording was cut short), read the blocks to build it" << std::endl;
+        }
+        _cursor = HEADER_SIZE;
+    }
+
+    const capture_file_info_t &get_info(void) const
+    {
+        return _info;
+    }
+
+    bool has_index(void) const
+    {
+        return _has_index;
+    }
+
+    bool next(block_t &block)
+    {
+        const capture_block_header_t *header = this->block_at(_cursor);
+        if (header == NULL) return false;
+        block.nsamps = header->nsamps;
+        block.flags = int(header->flags);
+        block.time_spec = time_spec_t(time_t(header->full_secs), header->frac_secs);
+        block.sample_index = header->sample_index;
+        block.error_code = rx_metadata_t::error_code_t(header->error_code);
+        block.buffs.resize(_info.num_chans);
+        const char *samps = reinterpret_cast<const char *>(header + 1);
+        for (size_t i = 0; i < _info.num_chans; i++) {
+            block.buffs[i] = samps + i*header->stride*_bytes_per_samp;
+        }
+        _cursor += sizeof(*header) + header->payload_size;
+        return true;
+    }
+
+    bool seek(const time_spec_t &time)
+    {
+        //the last index entry at or before the time
+        size_t lo = 0, hi = _num_entries;
+        while (lo < hi) {
+            const size_t mid = (lo + hi)/2;
+            if (entry_time(mid) <= time) lo = mid + 1;
+            else hi = mid;
+        }
+        _cursor = (lo == 0) ? HEADER_SIZE : size_t(_index[lo - 1].offset);
+        if (lo == 0) return true;
+
+        //then the blocks up to the next entry; in a gap, go to the first
+        //block after the one before the gap, which may record an error
+        size_t after_last = _cursor;
+        for (const capture_block_header_t *header; (header = this->block_at(_cursor)) != NULL;
+                _cursor += sizeof(*header) + header->payload_size) {
+            if (not (header->flags & FLAG_HAS_TIME) or header->nsamps == 0) continue;
+            const time_spec_t start(time_t(header->full_secs), header->frac_secs);
+            const time_spec_t end = start + time_spec_t::from_ticks((long long)(header->nsamps), _info.samp_rate);
+            if (time < start) {
+                _cursor = after_last;
+                return true;
+            }
+            if (time < end) return true;
+            after_last = _cursor + sizeof(*header) + header->payload_size;
+        }
+        return false;
+    }
+
+    void rewind(void)
+    {
+        _cursor = HEADER_SIZE;
+    }
+
+private:
+    //! The block at an offset, or NULL at the end of the blocks
+    const capture_block_header_t *block_at(const size_t offset) const
+    {
+        if (offset + sizeof(capture_block_header_t) > _end) return NULL;
+        const capture_block_header_t *header = reinterpret_cast<const capture_block_header_t *>(_base + offset);
+        if (header->magic != BLOCK_MAGIC or offset + sizeof(*header) + header->payload_size > _end) return NULL;
+        return header;
+    }
+
+    time_spec_t entry_time(const size_t i) const
+    {
+        return time_spec_t(time_t(_index[i].full_secs), _index[i].frac_secs);
+    }
+
+    //! Index every block with samples and a time, up to the first broken one
+    void build_index(void)
+    {
+        _end = _size;
+        size_t offset = HEADER_SIZE;
+        for (const capture_block_header_t *header; (header = this->block_at(offset)) != NULL;
+                offset += sizeof(*header) + header->payload_size) {
+            if (not (header->flags & FLAG_HAS_TIME) or header->nsamps == 0) continue;
+            capture_index_entry_t entry;
+            entry.full_secs = header->full_secs;
+            entry.frac_secs = header->frac_secs;
+            entry.sample_index = header->sample_index;
+            entry.offset = offset;
+            _built_index.push_back(entry);
+        }
+        _end = offset;
+        _index = _built_index.empty() ? NULL : &_built_index.front();
+        _num_entries = _built_index.size();
+    }
+
+    capture_file_info_t _info;
+    size_t _bytes_per_samp;
+    ip::file_mapping _mapping;
+    ip::mapped_region _region;
+    const char *_base;
+    size_t _size;
+    size_t _end; //of the blocks
+    bool _has_index;
+    const capture_index_entry_t *_index;
+    size_t _num_entries;
+    std::vector<capture_index_entry_t> _built_index;
+    size_t _cursor;
+};
+
+capture_file_reader::sptr capture_file_reader::make(const std::string &path)
+{
+    return sptr(new capture_file_reader_impl(path));
+}
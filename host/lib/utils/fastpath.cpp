@@ -0,0 +1,261 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/fastpath.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/exception.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace uhd::fastpath;
+
+//! Events the ring holds before they are dropped, a power of 2
+static const size_t EVENT_RING_SIZE = 1024;
+
+//! How often the background thread takes the events out of the ring
+static const long EVENT_POLL_PERIOD_MS = 10;
+
+static const event_type_t EVENT_TYPES[] = {
+    EVENT_OVERFLOW, EVENT_DROPPED_PACKET, EVENT_UNDERFLOW,
+    EVENT_SEQ_ERROR, EVENT_LATE_PACKET
+};
+static const size_t NUM_EVENT_TYPES = sizeof(EVENT_TYPES)/sizeof(EVENT_TYPES[0]);
+
+static size_t get_type_index(const event_type_t type){
+    for (size_t i = 0; i < NUM_EVENT_TYPES; i++){
+        if (EVENT_TYPES[i] == type) return i;
+    }
+    throw uhd::value_error("unknown fast path event type");
+}
+
+/***********************************************************************
+ * The event ring and its background consumer
+ **********************************************************************/
+/*!
+ * A bounded ring with many producers and one consumer.
+ * Each cell has a sequence number that tells whose turn it is: a producer
+ * claims the cell at the enqueue position when its sequence equals the
+ * position, and hands the cell to the consumer by bumping the sequence.
+ */
+class fastpath_resource_type{
+public:
+    fastpath_resource_type(void):
+        _cells(EVENT_RING_SIZE),
+        _enqueue_pos(0),
+        _dequeue_pos(0),
+        _seq(0),
+        _num_dropped(0),
+        _console_output(true),
+        _started(false),
+        _next_id(0)
+    {
+        for (size_t i = 0; i < _cells.size(); i++){
+            _cells[i].sequence.store(i, boost::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < NUM_EVENT_TYPES; i++){
+            _counts[i].store(0, boost::memory_order_relaxed);
+        }
+    }
+
+    ~fastpath_resource_type(void){
+        if (_thread.joinable()){
+            _thread.interrupt();
+            _thread.join();
+        }
+    }
+
+    void post(event_t &event){
+        _counts[get_type_index(event.type)].fetch_add(1, boost::memory_order_relaxed);
+        event.seq = _seq.fetch_add(1, boost::memory_order_relaxed);
+        if (not _started.load(boost::memory_order_acquire)) _start();
+
+        size_t pos = _enqueue_pos.load(boost::memory_order_relaxed);
+        cell_type *cell;
+        while (true){
+            cell = &_cells[pos & (_cells.size() - 1)];
+            const size_t seq = cell->sequence.load(boost::memory_order_acquire);
+            const ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+            if (diff == 0){
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, boost::memory_order_relaxed)) break;
+            }
+            else if (diff < 0){
+                //the consumer has not taken this cell out yet: full
+                _num_dropped.fetch_add(1, boost::memory_order_relaxed);
+                return;
+            }
+            else pos = _enqueue_pos.load(boost::memory_order_relaxed);
+        }
+        cell->event = event;
+        cell->sequence.store(pos + 1, boost::memory_order_release);
+    }
+
+    boost::uint64_t get_count(const event_type_t type){
+        return _counts[get_type_index(type)].load(boost::memory_order_relaxed);
+    }
+
+    boost::uint64_t get_dropped_count(void){
+        return _num_dropped.load(boost::memory_order_relaxed);
+    }
+
+    size_t subscribe(const subscriber_t &subscriber){
+        _start();
+        boost::mutex::scoped_lock lock(_mutex);
+        _subscribers[_next_id] = subscriber;
+        return _next_id++;
+    }
+
+    void unsubscribe(const size_t id){
+        boost::mutex::scoped_lock lock(_mutex);
+        _subscribers.erase(id);
+    }
+
+    void set_console_output(const bool enb){
+        _console_output.store(enb, boost::memory_order_relaxed);
+    }
+
+private:
+    struct cell_type{
+        boost::atomic<size_t> sequence;
+        event_t event;
+    };
+
+    //! start the background thread, on the first event or subscriber
+    void _start(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_started.load(boost::memory_order_relaxed)) return;
+        _thread = boost::thread(boost::bind(&fastpath_resource_type::_run, this));
+        _started.store(true, boost::memory_order_release);
+    }
+
+    void _run(void){
+        uhd::scoped_internal_thread internal_thread("fastpath events", "other");
+        std::vector<event_t> events;
+        try{
+            while (true){
+                boost::this_thread::sleep(boost::posix_time::milliseconds(EVENT_POLL_PERIOD_MS));
+                _dispatch(events);
+            }
+        }
+        catch(const boost::thread_interrupted &){
+            //at exit: the message handler and the subscribers
+            //may have been destroyed already, leave the last events
+        }
+    }
+
+    //! take all events out of the ring, hand them to the subscribers and print them
+    void _dispatch(std::vector<event_t> &events){
+        events.clear();
+        while (true){
+            cell_type &cell = _cells[_dequeue_pos & (_cells.size() - 1)];
+            if (cell.sequence.load(boost::memory_order_acquire) != _dequeue_pos + 1) break;
+            events.push_back(cell.event);
+            cell.sequence.store(_dequeue_pos + _cells.size(), boost::memory_order_release);
+            _dequeue_pos++;
+        }
+        if (events.empty()) return;
+
+        //call the subscribers without the lock, so they may unsubscribe
+        std::map<size_t, subscriber_t> subscribers;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            subscribers = _subscribers;
+        }
+        if (not subscribers.empty()){
+            BOOST_FOREACH(const event_t &event, events){
+                typedef std::map<size_t, subscriber_t>::value_type pair_type;
+                BOOST_FOREACH(const pair_type &subscriber, subscribers){
+                    try{
+                        subscriber.second(event);
+                    }
+                    catch(const std::exception &e){
+                        UHD_MSG(error) << "Fast path event subscriber failed: " << e.what() << std::endl;
+                    }
+                }
+            }
+        }
+
+        if (_console_output.load(boost::memory_order_relaxed)){
+            std::string codes;
+            BOOST_FOREACH(const event_t &event, events){
+                codes += char(event.type);
+            }
+            UHD_MSG(fastpath) << codes;
+        }
+    }
+
+    std::vector<cell_type> _cells;
+    boost::atomic<size_t> _enqueue_pos;
+    size_t _dequeue_pos; //only used by the background thread
+    boost::atomic<boost::uint64_t> _seq;
+    boost::atomic<boost::uint64_t> _num_dropped;
+    boost::atomic<boost::uint64_t> _counts[NUM_EVENT_TYPES];
+    boost::atomic<bool> _console_output;
+
+    boost::atomic<bool> _started;
+    boost::thread _thread;
+
+    boost::mutex _mutex;
+    std::map<size_t, subscriber_t> _subscribers;
+    size_t _next_id;
+};
+
+UHD_SINGLETON_FCN(fastpath_resource_type, fastpath_rs);
+
+/***********************************************************************
+ * The fast path event interface
+ **********************************************************************/
+void uhd::fastpath::post_event(
+    const event_type_t type,
+    const size_t channel,
+    const bool has_time_spec,
+    const time_spec_t &time_spec
+){
+    event_t event;
+    event.type = type;
+    event.channel = channel;
+    event.has_time_spec = has_time_spec;
+    event.time_spec = time_spec;
+    fastpath_rs().post(event);
+}
+
+boost::uint64_t uhd::fastpath::get_event_count(const event_type_t type){
+    return fastpath_rs().get_count(type);
+}
+
+boost::uint64_t uhd::fastpath::get_dropped_event_count(void){
+    return fastpath_rs().get_dropped_count();
+}
+
+size_t uhd::fastpath::subscribe(const subscriber_t &subscriber){
+    return fastpath_rs().subscribe(subscriber);
+}
+
+void uhd::fastpath::unsubscribe(const size_t id){
+    fastpath_rs().unsubscribe(id);
+}
+
+void uhd::fastpath::set_console_output(const bool enb){
+    fastpath_rs().set_console_output(enb);
+}
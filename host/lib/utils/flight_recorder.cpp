@@ -0,0 +1,310 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/flight_recorder.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/exception.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_RECORDER_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_RECORDER_TSC
+#endif
+
+using namespace uhd;
+using namespace uhd::flight_recorder;
+
+namespace {
+
+    //! Records each thread keeps, a power of 2
+    static const size_t RECORDS_PER_THREAD = 8192;
+
+    //! How often the background thread looks for dump requests
+    static const long DUMP_POLL_PERIOD_MS = 20;
+
+    //! How long a requested dump waits, to also hold what followed
+    static const long DUMP_DELAY_MS = 100;
+
+    //! Errors within one second that ask for a dump
+    static const size_t ERROR_CASCADE_COUNT = 3;
+    static const boost::uint64_t ERROR_CASCADE_NSECS = 1000000000;
+
+    static const char *DEFAULT_DUMP_FILE = "uhd_flight_recorder.dat";
+
+    //! Set by the signal handler, which may do nothing else
+    static volatile std::sig_atomic_t signalled = 0;
+
+    extern "C" void on_dump_signal(int){
+        signalled = 1;
+    }
+
+    //! The time stamp counter, or nanoseconds of system time without one
+    UHD_INLINE boost::uint64_t get_ticks(void){
+    #ifdef HAVE_RECORDER_TSC
+        return __rdtsc();
+    #else
+        return boost::uint64_t(time_spec_t::get_system_time().to_ticks(1e9));
+    #endif
+    }
+
+    /*!
+     * The ring of one thread. Only the thread writes it: it announces
+     * each record with begun before it writes and publishes it with
+     * count after, so dump() can copy the ring at any time and drop
+     * the records the thread overwrote meanwhile.
+     */
+    struct thread_ring_t{
+        thread_ring_t(const size_t tid):
+            tid(tid), records(RECORDS_PER_THREAD), begun(0), count(0)
+        {
+            /* NOP */
+        }
+
+        const size_t tid;
+        std::vector<record_t> records;
+        boost::atomic<boost::uint64_t> begun;
+        boost::atomic<boost::uint64_t> count;
+    };
+
+    typedef boost::shared_ptr<thread_ring_t> thread_ring_sptr;
+
+    //! Owned by the thread local storage: the recorder keeps the ring
+    struct thread_ring_holder_t{
+        thread_ring_sptr ring;
+    };
+
+    struct recorder_t{
+        recorder_t(void):
+            enb(true),
+            dump_requested(false),
+            error_window_start(0),
+            error_window_count(0),
+            start_ticks(get_ticks()),
+            start_time(time_spec_t::get_system_time())
+        {
+            const char *enb_env = std::getenv("UHD_FLIGHT_RECORDER");
+            if (enb_env != NULL and std::string(enb_env) == "0") enb = false;
+            const char *file_env = std::getenv("UHD_FLIGHT_RECORDER_FILE");
+            if (file_env != NULL and file_env[0] != '\0') set_dump_file(file_env);
+        }
+
+        ~recorder_t(void){
+            if (dump_thread.joinable()){
+                dump_thread.interrupt();
+                dump_thread.join();
+            }
+        }
+
+        thread_ring_t &get_ring(void){
+            thread_ring_holder_t *holder = local_ring.get();
+            if (holder == NULL){
+                holder = new thread_ring_holder_t();
+                local_ring.reset(holder);
+                boost::mutex::scoped_lock lock(mutex);
+                holder->ring = boost::make_shared<thread_ring_t>(rings.size());
+                rings.push_back(holder->ring);
+            }
+            return *holder->ring;
+        }
+
+        //! the third error within a second asks for a dump
+        void count_error(void){
+            const boost::uint64_t now = boost::uint64_t(time_spec_t::get_system_time().to_ticks(1e9));
+            const boost::uint64_t start = error_window_start.load(boost::memory_order_relaxed);
+            if (now - start > ERROR_CASCADE_NSECS){
+                error_window_start.store(now, boost::memory_order_relaxed);
+                error_window_count.store(1, boost::memory_order_relaxed);
+            }
+            else if (error_window_count.fetch_add(1, boost::memory_order_relaxed) + 1 == ERROR_CASCADE_COUNT){
+                dump_requested.store(true, boost::memory_order_release);
+            }
+        }
+
+        size_t dump(const std::string &path){
+            boost::mutex::scoped_lock lock(mutex);
+
+            file_header_t header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "UHDFLREC", sizeof(header.magic));
+            header.version = 1;
+            header.record_size = sizeof(record_t);
+        #ifdef HAVE_RECORDER_TSC
+            const double secs = (time_spec_t::get_system_time() - start_time).get_real_secs();
+            const double ticks = double(get_ticks() - start_ticks);
+            header.ticks_per_sec = (secs > 0.0)? boost::uint64_t(ticks/secs) : 0;
+        #else
+            header.ticks_per_sec = 1000000000;
+        #endif
+            header.num_threads = boost::uint32_t(rings.size());
+
+            std::ofstream out(path.c_str(), std::ios::binary);
+            if (not out) throw uhd::io_error("flight recorder: cannot write " + path);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            size_t num_written = 0;
+            std::vector<record_t> copy(RECORDS_PER_THREAD);
+            BOOST_FOREACH(const thread_ring_sptr &ring, rings){
+                //records the thread wrote while they were copied are dropped
+                const boost::uint64_t count = ring->count.load(boost::memory_order_acquire);
+                std::memcpy(&copy.front(), &ring->records.front(), copy.size()*sizeof(record_t));
+                boost::atomic_thread_fence(boost::memory_order_acquire);
+                const boost::uint64_t begun = ring->begun.load(boost::memory_order_relaxed);
+                boost::uint64_t first = (count > RECORDS_PER_THREAD)? count - RECORDS_PER_THREAD : 0;
+                if (begun > first + RECORDS_PER_THREAD) first = begun - RECORDS_PER_THREAD;
+                if (first > count) first = count;
+
+                thread_header_t thread_header;
+                thread_header.thread = boost::uint32_t(ring->tid);
+                thread_header.num_records = boost::uint32_t(count - first);
+                thread_header.num_lost = first;
+                out.write(reinterpret_cast<const char *>(&thread_header), sizeof(thread_header));
+                for (boost::uint64_t i = first; i < count; i++){
+                    out.write(reinterpret_cast<const char *>(&copy[i & (RECORDS_PER_THREAD - 1)]), sizeof(record_t));
+                }
+                num_written += thread_header.num_records;
+            }
+            if (not out) throw uhd::io_error("flight recorder: cannot write " + path);
+            return num_written;
+        }
+
+        void set_dump_file(const std::string &path){
+            boost::mutex::scoped_lock lock(mutex);
+            dump_file = path;
+            if (not dump_thread.joinable()){
+                //requests from before there was a file are stale
+                dump_requested.store(false, boost::memory_order_relaxed);
+                dump_thread = boost::thread(boost::bind(&recorder_t::run_dumper, this));
+            }
+        }
+
+        std::string get_dump_file(void){
+            boost::mutex::scoped_lock lock(mutex);
+            return dump_file;
+        }
+
+        void run_dumper(void){
+            uhd::scoped_internal_thread internal_thread("flight recorder", "other");
+            try{
+                while (true){
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(DUMP_POLL_PERIOD_MS));
+                    if (not signalled and not dump_requested.load(boost::memory_order_acquire)) continue;
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(DUMP_DELAY_MS));
+                    signalled = 0;
+                    dump_requested.store(false, boost::memory_order_relaxed);
+                    const std::string path = get_dump_file();
+                    try{
+                        const size_t num_records = dump(path);
+                        UHD_MSG(status) << "Flight recorder: wrote " << num_records << " records to " << path << std::endl;
+                    }
+                    catch(const uhd::exception &e){
+                        UHD_MSG(error) << e.what() << std::endl;
+                    }
+                }
+            }
+            catch(const boost::thread_interrupted &){
+                //at exit
+            }
+        }
+
+        boost::atomic<bool> enb;
+        boost::atomic<bool> dump_requested;
+        boost::atomic<boost::uint64_t> error_window_start;
+        boost::atomic<size_t> error_window_count;
+        const boost::uint64_t start_ticks;
+        const time_spec_t start_time;
+        boost::thread_specific_ptr<thread_ring_holder_t> local_ring;
+        boost::mutex mutex;
+        std::vector<thread_ring_sptr> rings;
+        std::string dump_file;
+        boost::thread dump_thread;
+    };
+
+    UHD_SINGLETON_FCN(recorder_t, get_recorder);
+
+} //namespace /*anon*/
+
+bool flight_recorder::enabled(void){
+    return get_recorder().enb.load(boost::memory_order_relaxed);
+}
+
+void flight_recorder::set_enabled(const bool enb){
+    get_recorder().enb.store(enb, boost::memory_order_relaxed);
+}
+
+void flight_recorder::record(
+    const record_type_t type,
+    const size_t chan,
+    const boost::uint32_t sid,
+    const boost::uint32_t seq,
+    const boost::uint64_t tsf,
+    const boost::uint32_t value,
+    const boost::uint8_t flags
+){
+    recorder_t &recorder = get_recorder();
+    if (not recorder.enb.load(boost::memory_order_relaxed)) return;
+    thread_ring_t &ring = recorder.get_ring();
+    const boost::uint64_t count = ring.count.load(boost::memory_order_relaxed);
+    ring.begun.store(count + 1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+    record_t &rec = ring.records[count & (RECORDS_PER_THREAD - 1)];
+    rec.ticks = get_ticks();
+    rec.tsf = tsf;
+    rec.sid = sid;
+    rec.seq = seq;
+    rec.value = value;
+    rec.type = boost::uint8_t(type);
+    rec.flags = flags;
+    rec.chan = boost::uint16_t(chan);
+    ring.count.store(count + 1, boost::memory_order_release);
+    if (type == RECORD_ERROR) recorder.count_error();
+}
+
+size_t flight_recorder::dump(const std::string &path){
+    return get_recorder().dump(path);
+}
+
+void flight_recorder::request_dump(void){
+    get_recorder().dump_requested.store(true, boost::memory_order_release);
+}
+
+void flight_recorder::set_dump_file(const std::string &path){
+    get_recorder().set_dump_file(path);
+}
+
+void flight_recorder::dump_on_signal(const int signum){
+    recorder_t &recorder = get_recorder();
+    if (recorder.get_dump_file().empty()) recorder.set_dump_file(DEFAULT_DUMP_FILE);
+    std::signal(signum, &on_dump_signal);
+}
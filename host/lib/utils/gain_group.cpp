@@ -22,15 +22,20 @@
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
 #include <algorithm>
+#include <map>
 #include <vector>
 
 using namespace uhd;
 
+//! the number of distinct overall gains to remember for one set of ranges
+static const size_t MAX_CACHED_DISTRIBUTIONS = 4096;
+
 static bool compare_by_step_size(
-    const size_t &rhs, const size_t &lhs, std::vector<gain_fcns_t> &fcns
+    const size_t &rhs, const size_t &lhs, const std::vector<gain_range_t> &ranges
 ){
-    return fcns.at(rhs).get_range().step() > fcns.at(lhs).get_range().step();
+    return ranges.at(rhs).step() > ranges.at(lhs).step();
 }
 
 /*!
@@ -73,7 +78,7 @@ public:
         if (not name.empty()) return _name_to_fcns.get(name).get_range();
 
         double overall_min = 0, overall_max = 0, overall_step = 0;
-        BOOST_FOREACH(const gain_fcns_t &fcns, get_all_fcns()){
+        BOOST_FOREACH(const gain_fcns_t &fcns, _all_fcns){
             const gain_range_t range = fcns.get_range();
             overall_min += range.start();
             overall_max += range.stop();
@@ -88,7 +93,7 @@ public:
         if (not name.empty()) return _name_to_fcns.get(name).get_value();
 
         double overall_gain = 0;
-        BOOST_FOREACH(const gain_fcns_t &fcns, get_all_fcns()){
+        BOOST_FOREACH(const gain_fcns_t &fcns, _all_fcns){
             overall_gain += fcns.get_value();
         }
         return overall_gain;
@@ -97,13 +102,69 @@ public:
     void set_value(double gain, const std::string &name){
         if (not name.empty()) return _name_to_fcns.get(name).set_value(gain);
 
-        std::vector<gain_fcns_t> all_fcns = get_all_fcns();
+        boost::mutex::scoped_lock lock(_mutex);
+        const std::vector<gain_fcns_t> all_fcns = _all_fcns;
         if (all_fcns.size() == 0) return; //nothing to set!
 
+        //the element ranges may change (ex: per frequency band),
+        //drop the remembered distributions when any of them changed
+        std::vector<gain_range_t> ranges;
+        std::vector<double> range_key;
+        BOOST_FOREACH(const gain_fcns_t &fcns, all_fcns){
+            ranges.push_back(fcns.get_range());
+            range_key.push_back(ranges.back().start());
+            range_key.push_back(ranges.back().stop());
+            range_key.push_back(ranges.back().step());
+        }
+        if (range_key != _range_key){
+            _range_key = range_key;
+            _distributions.clear();
+        }
+
+        //look up the per-element gains for this overall gain or compute them
+        std::map<double, std::vector<double> >::const_iterator it = _distributions.find(gain);
+        if (it == _distributions.end()){
+            if (_distributions.size() >= MAX_CACHED_DISTRIBUTIONS) _distributions.clear();
+            it = _distributions.insert(std::make_pair(gain, distribute(gain, ranges))).first;
+        }
+        const std::vector<double> gain_bucket = it->second;
+        lock.unlock();
+
+        //now write the bucket out to the individual gain values
+        for (size_t i = 0; i < gain_bucket.size(); i++){
+            UHD_LOGV(often) << i << ": " << gain_bucket.at(i) << std::endl;
+            all_fcns.at(i).set_value(gain_bucket.at(i));
+        }
+    }
+
+    const std::vector<std::string> get_names(void){
+        return _name_to_fcns.keys();
+    }
+
+    void register_fcns(
+        const std::string &name,
+        const gain_fcns_t &gain_fcns,
+        size_t priority
+    ){
+        if (name.empty() or _name_to_fcns.has_key(name)){
+            //ensure the name name is unique and non-empty
+            return register_fcns(name + "_", gain_fcns, priority);
+        }
+        boost::mutex::scoped_lock lock(_mutex);
+        _registry[priority].push_back(gain_fcns);
+        _name_to_fcns[name] = gain_fcns;
+        _all_fcns = get_all_fcns();
+        _range_key.clear();
+        _distributions.clear();
+    }
+
+private:
+    //! distribute an overall gain across the elements (in get_all_fcns() order)
+    static std::vector<double> distribute(double gain, const std::vector<gain_range_t> &ranges){
         //get the max step size among the gains
         double max_step = 0;
-        BOOST_FOREACH(const gain_fcns_t &fcns, all_fcns){
-            max_step = std::max(max_step, fcns.get_range().step());
+        BOOST_FOREACH(const gain_range_t &range, ranges){
+            max_step = std::max(max_step, range.step());
         }
 
         //create gain bucket to distribute power
@@ -111,8 +172,7 @@ public:
 
         //distribute power according to priority (round to max step)
         double gain_left_to_distribute = gain;
-        BOOST_FOREACH(const gain_fcns_t &fcns, all_fcns){
-            const gain_range_t range = fcns.get_range();
+        BOOST_FOREACH(const gain_range_t &range, ranges){
             gain_bucket.push_back(floor_step(uhd::clip(
                 gain_left_to_distribute, range.start(), range.stop()
             ), max_step));
@@ -121,22 +181,22 @@ public:
 
         //get a list of indexes sorted by step size large to small
         std::vector<size_t> indexes_step_size_dec;
-        for (size_t i = 0; i < all_fcns.size(); i++){
+        for (size_t i = 0; i < ranges.size(); i++){
             indexes_step_size_dec.push_back(i);
         }
         std::sort(
             indexes_step_size_dec.begin(), indexes_step_size_dec.end(),
-            boost::bind(&compare_by_step_size, _1, _2, all_fcns)
+            boost::bind(&compare_by_step_size, _1, _2, boost::cref(ranges))
         );
         UHD_ASSERT_THROW(
-            all_fcns.at(indexes_step_size_dec.front()).get_range().step() >=
-            all_fcns.at(indexes_step_size_dec.back()).get_range().step()
+            ranges.at(indexes_step_size_dec.front()).step() >=
+            ranges.at(indexes_step_size_dec.back()).step()
         );
 
         //distribute the remainder (less than max step)
         //fill in the largest step sizes first that are less than the remainder
         BOOST_FOREACH(size_t i, indexes_step_size_dec){
-            const gain_range_t range = all_fcns.at(i).get_range();
+            const gain_range_t &range = ranges.at(i);
             double additional_gain = floor_step(uhd::clip(
                 gain_bucket.at(i) + gain_left_to_distribute, range.start(), range.stop()
             ), range.step()) - gain_bucket.at(i);
@@ -145,31 +205,9 @@ public:
         }
         UHD_LOGV(often) << "gain_left_to_distribute " << gain_left_to_distribute << std::endl;
 
-        //now write the bucket out to the individual gain values
-        for (size_t i = 0; i < gain_bucket.size(); i++){
-            UHD_LOGV(often) << i << ": " << gain_bucket.at(i) << std::endl;
-            all_fcns.at(i).set_value(gain_bucket.at(i));
-        }
+        return gain_bucket;
     }
 
-    const std::vector<std::string> get_names(void){
-        return _name_to_fcns.keys();
-    }
-
-    void register_fcns(
-        const std::string &name,
-        const gain_fcns_t &gain_fcns,
-        size_t priority
-    ){
-        if (name.empty() or _name_to_fcns.has_key(name)){
-            //ensure the name name is unique and non-empty
-            return register_fcns(name + "_", gain_fcns, priority);
-        }
-        _registry[priority].push_back(gain_fcns);
-        _name_to_fcns[name] = gain_fcns;
-    }
-
-private:
     //! get the gain function sets in order (highest priority first)
     std::vector<gain_fcns_t> get_all_fcns(void){
         std::vector<gain_fcns_t> all_fcns;
@@ -182,6 +220,12 @@ private:
 
     uhd::dict<size_t, std::vector<gain_fcns_t> > _registry;
     uhd::dict<std::string, gain_fcns_t> _name_to_fcns;
+    std::vector<gain_fcns_t> _all_fcns;
+    boost::mutex _mutex;
+
+    //! per-element gains by overall gain, valid for the ranges in _range_key
+    std::vector<double> _range_key;
+    std::map<double, std::vector<double> > _distributions;
 };
 
 /***********************************************************************
@@ -0,0 +1,279 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/host_check.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef UHD_PLATFORM_LINUX
+#include <boost/asio/ip/address_v4.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <set>
+#include <cstring>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#endif
+
+using namespace uhd;
+using namespace uhd::host_check;
+
+//! Bytes on the wire of a UDP packet besides its payload: UDP, IPv4,
+//! Ethernet header and FCS, preamble and inter-frame gap
+static const size_t WIRE_OVERHEAD_BYTES = 8 + 20 + 14 + 4 + 8 + 12;
+
+//! Bytes of a data packet payload besides the samples: CHDR header and time
+static const size_t CHDR_OVERHEAD_BYTES = 16;
+
+report_t::report_t(void):
+    link_rate(0.0)
+{
+    /* NOP */
+}
+
+size_t report_t::num_deficits(void) const{
+    size_t num = 0;
+    BOOST_FOREACH(const item_t &item, items){
+        if (not item.ok) num++;
+    }
+    return num;
+}
+
+std::string report_t::to_pp_string(void) const{
+    std::ostringstream ss;
+    ss << "Host check of interface " << (iface.empty()? "(not found)" : iface) << std::endl;
+    if (link_rate > 0.0){
+        ss << boost::format("  Link rate: %.1f MB/s of samples, %.1f Msps of sc16")
+            % (link_rate/1e6) % (link_rate/4/1e6) << std::endl;
+    }
+    if (items.empty()){
+        ss << "  No settings were checked on this host" << std::endl;
+    }
+    BOOST_FOREACH(const item_t &item, items){
+        ss << boost::format("  %-4s %s: %s") % (item.ok? "ok" : "FIX") % item.name % item.value;
+        if (not item.ok){
+            ss << " (want " << item.wanted << ")" << std::endl << "       " << item.fix;
+        }
+        ss << std::endl;
+    }
+    return ss.str();
+}
+
+#ifdef UHD_PLATFORM_LINUX
+
+//! The first line of a file from /proc or /sys, empty if there is none
+static std::string read_setting(const std::string &path){
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::getline(file, line);
+    return boost::algorithm::trim_copy(line);
+}
+
+static size_t read_size(const std::string &path){
+    try{
+        return boost::lexical_cast<size_t>(read_setting(path));
+    }
+    catch(const boost::bad_lexical_cast &){
+        return 0;
+    }
+}
+
+//! The interface whose subnet holds the address, empty if none does
+static std::string find_iface(const std::string &addr){
+    boost::uint32_t remote = 0;
+    try{
+        remote = boost::asio::ip::address_v4::from_string(addr).to_ulong();
+    }
+    catch(const std::exception &){
+        return "";
+    }
+    std::string iface;
+    struct ifaddrs *ifap;
+    if (getifaddrs(&ifap) != 0) return iface;
+    for (struct ifaddrs *iter = ifap; iter != NULL; iter = iter->ifa_next){
+        if (iter->ifa_addr == NULL or iter->ifa_netmask == NULL) continue;
+        if (iter->ifa_addr->sa_family != AF_INET) continue;
+        const boost::uint32_t local = ntohl(reinterpret_cast<sockaddr_in *>(iter->ifa_addr)->sin_addr.s_addr);
+        const boost::uint32_t mask = ntohl(reinterpret_cast<sockaddr_in *>(iter->ifa_netmask)->sin_addr.s_addr);
+        if ((local & mask) == (remote & mask)){
+            iface = iter->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(ifap);
+    return iface;
+}
+
+static item_t make_item(
+    const std::string &name, const std::string &value,
+    const std::string &wanted, const bool ok, const std::string &fix
+){
+    item_t item;
+    item.name = name;
+    item.value = value;
+    item.wanted = wanted;
+    item.ok = ok;
+    if (not ok) item.fix = fix;
+    return item;
+}
+
+static void check_buff_max(report_t &report, const std::string &name, const size_t buff_size){
+    if (buff_size == 0) return;
+    const size_t max = read_size("/proc/sys/net/core/" + name);
+    report.items.push_back(make_item("net.core." + name,
+        boost::lexical_cast<std::string>(max), boost::lexical_cast<std::string>(buff_size),
+        max >= buff_size,
+        str(boost::format("sudo sysctl -w net.core.%s=%u") % name % buff_size)));
+}
+
+static void check_ring(report_t &report, const std::string &iface){
+    struct ethtool_ringparam ring;
+    std::memset(&ring, 0, sizeof(ring));
+    ring.cmd = ETHTOOL_GRINGPARAM;
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, iface.c_str(), IFNAMSIZ - 1);
+    ifr.ifr_data = reinterpret_cast<char *>(&ring);
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return;
+    const int ret = ioctl(fd, SIOCETHTOOL, &ifr);
+    close(fd);
+    if (ret != 0) return; //not a NIC, e.g. loopback
+    report.items.push_back(make_item("RX ring of " + iface,
+        boost::lexical_cast<std::string>(ring.rx_pending),
+        boost::lexical_cast<std::string>(ring.rx_max_pending),
+        ring.rx_pending >= ring.rx_max_pending,
+        str(boost::format("sudo ethtool -G %s rx %u") % iface % ring.rx_max_pending)));
+}
+
+//! Interrupts that may run on any CPU move around and disturb the streaming threads
+static void check_irqs(report_t &report, const std::string &iface){
+    namespace fs = boost::filesystem;
+    std::vector<std::string> irqs;
+    const fs::path msi_path("/sys/class/net/" + iface + "/device/msi_irqs");
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(msi_path, ec), end; not ec and it != end; it.increment(ec)){
+        irqs.push_back(it->path().filename().string());
+    }
+    if (irqs.empty()){
+        const std::string irq = read_setting("/sys/class/net/" + iface + "/device/irq");
+        if (irq.empty() or irq == "0") return;
+        irqs.push_back(irq);
+    }
+    std::sort(irqs.begin(), irqs.end());
+
+    const std::string all_cpus = read_setting("/sys/devices/system/cpu/online");
+    std::vector<std::string> unpinned;
+    std::string affinities;
+    BOOST_FOREACH(const std::string &irq, irqs){
+        const std::string cpus = read_setting("/proc/irq/" + irq + "/smp_affinity_list");
+        if (cpus.empty()) continue;
+        if (cpus == all_cpus) unpinned.push_back(irq);
+        if (not affinities.empty()) affinities += ", ";
+        affinities += irq + ":" + cpus;
+    }
+    if (affinities.empty()) return;
+    report.items.push_back(make_item("IRQ CPUs of " + iface, affinities,
+        "each IRQ on CPUs apart from the streaming threads",
+        unpinned.empty(),
+        str(boost::format("echo <cpu> | sudo tee /proc/irq/%s/smp_affinity_list (IRQs %s)")
+            % unpinned.front() % boost::algorithm::join(unpinned, " "))));
+}
+
+static void check_governors(report_t &report){
+    std::set<std::string> governors;
+    for (size_t cpu = 0; ; cpu++){
+        const std::string path = str(boost::format("/sys/devices/system/cpu/cpu%u") % cpu);
+        if (not boost::filesystem::exists(path)) break;
+        const std::string governor = read_setting(path + "/cpufreq/scaling_governor");
+        if (not governor.empty()) governors.insert(governor);
+    }
+    if (governors.empty()) return; //no frequency scaling
+    report.items.push_back(make_item("CPU frequency governor",
+        boost::algorithm::join(governors, ", "), "performance",
+        governors.size() == 1 and *governors.begin() == "performance",
+        "sudo cpupower frequency-set -g performance"));
+}
+
+report_t host_check::check(
+    const std::string &addr,
+    const size_t frame_size,
+    const size_t recv_buff_size,
+    const size_t send_buff_size,
+    const double rate
+){
+    report_t report;
+    report.iface = find_iface(addr);
+
+    if (not report.iface.empty()){
+        const std::string iface_path = "/sys/class/net/" + report.iface;
+        const size_t mtu = read_size(iface_path + "/mtu");
+        const size_t wanted_mtu = frame_size + 28; //IPv4 and UDP headers
+        report.items.push_back(make_item("MTU of " + report.iface,
+            boost::lexical_cast<std::string>(mtu), boost::lexical_cast<std::string>(wanted_mtu),
+            mtu >= wanted_mtu,
+            str(boost::format("sudo ip link set dev %s mtu %u") % report.iface % std::max<size_t>(wanted_mtu, 9000))));
+
+        //the speed file holds -1 or fails to read without a link
+        const std::string speed = read_setting(iface_path + "/speed");
+        const double speed_mbps = std::atof(speed.c_str());
+        //packets larger than the MTU would not arrive, the stream uses smaller ones
+        const size_t link_frame_size = (mtu > 28)? std::min(frame_size, mtu - 28) : frame_size;
+        if (speed_mbps > 0.0 and link_frame_size > CHDR_OVERHEAD_BYTES){
+            report.link_rate = speed_mbps*1e6/8
+                * double(link_frame_size - CHDR_OVERHEAD_BYTES)/double(link_frame_size + WIRE_OVERHEAD_BYTES);
+        }
+        if (rate > 0.0 and report.link_rate > 0.0){
+            report.items.push_back(make_item("Link rate of " + report.iface,
+                str(boost::format("%.1f MB/s") % (report.link_rate/1e6)),
+                str(boost::format("%.1f MB/s") % (rate/1e6)),
+                report.link_rate >= rate,
+                "use a faster link, a smaller sample format (sc8), or a lower rate"));
+        }
+        check_ring(report, report.iface);
+        check_irqs(report, report.iface);
+    }
+    check_buff_max(report, "rmem_max", recv_buff_size);
+    check_buff_max(report, "wmem_max", send_buff_size);
+    check_governors(report);
+    return report;
+}
+
+#else
+
+report_t host_check::check(
+    const std::string &,
+    const size_t,
+    const size_t,
+    const size_t,
+    const double
+){
+    return report_t();
+}
+
+#endif /* UHD_PLATFORM_LINUX */
@@ -100,8 +100,10 @@ static void load_module_path(const fs::path &path){
 
 /*!
  * Load all the modules given in the module paths.
+ * This runs on the first lookup of a registry that modules may add to
+ * (devices, image loaders, converters), not before main().
  */
-UHD_STATIC_BLOCK(load_modules){
+UHD_DEFERRED_BLOCK("modules", load_modules){
     BOOST_FOREACH(const fs::path &path, uhd::get_module_paths()){
         load_module_path(path);
     }
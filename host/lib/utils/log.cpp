@@ -19,19 +19,136 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/paths.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/tokenizer.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 #include <cctype>
+#include <cstdlib>
+#include <list>
+#include <vector>
+#ifdef HAVE_SYSLOG
+#include <syslog.h>
+#endif
 
 namespace fs = boost::filesystem;
 namespace pt = boost::posix_time;
 namespace ip = boost::interprocess;
 
+/***********************************************************************
+ * Per-thread record rings for the asynchronous backend
+ **********************************************************************/
+//! A log record: the global sequence number keeps the threads in order
+struct log_record_t{
+    boost::uint64_t seq;
+    std::string text;
+};
+
+static bool log_record_comp(const log_record_t &a, const log_record_t &b){
+    return a.seq < b.seq;
+}
+
+/*!
+ * A single producer, single consumer ring of log records.
+ * The thread that logs pushes, the backend thread pops. The records are
+ * swapped in and out of the slots, so neither side copies the text.
+ */
+class log_ring_type{
+public:
+    typedef boost::shared_ptr<log_ring_type> sptr;
+
+    log_ring_type(const size_t size):
+        _slots(size), _head(0), _tail(0), _orphaned(false)
+    {
+        /* NOP */
+    }
+
+    /*!
+     * Called by the producer.
+     * \return the number of records in the ring before the push,
+     *         or the size of the ring when it is full and the push failed
+     */
+    size_t push(log_record_t &record){
+        const size_t head = _head.load(boost::memory_order_relaxed);
+        const size_t used = head - _tail.load(boost::memory_order_acquire);
+        if (used == _slots.size()) return used;
+        log_record_t &slot = _slots[head % _slots.size()];
+        slot.seq = record.seq;
+        slot.text.swap(record.text);
+        _head.store(head + 1, boost::memory_order_release);
+        return used;
+    }
+
+    size_t size(void) const{
+        return _slots.size();
+    }
+
+    //! Called by the consumer, appends all the records in the ring
+    void pop_all(std::vector<log_record_t> &records){
+        const size_t head = _head.load(boost::memory_order_acquire);
+        size_t tail = _tail.load(boost::memory_order_relaxed);
+        for (; tail != head; tail++){
+            log_record_t &slot = _slots[tail % _slots.size()];
+            records.push_back(log_record_t());
+            records.back().seq = slot.seq;
+            records.back().text.swap(slot.text);
+        }
+        _tail.store(tail, boost::memory_order_release);
+    }
+
+    //! The producer thread has exited, the ring goes when it is empty
+    void orphan(void){
+        _orphaned.store(true, boost::memory_order_release);
+    }
+
+    bool orphaned(void){
+        return _orphaned.load(boost::memory_order_acquire);
+    }
+
+private:
+    std::vector<log_record_t> _slots;
+    boost::atomic<size_t> _head;
+    boost::atomic<size_t> _tail;
+    boost::atomic<bool> _orphaned;
+};
+
+//! Owned by the thread local storage, orphans the ring at thread exit
+struct log_ring_holder_type{
+    log_ring_type::sptr ring;
+    ~log_ring_holder_type(void){
+        ring->orphan();
+    }
+};
+
+//! Records each thread can queue before they are dropped
+static const size_t LOG_RING_SIZE = 4096;
+
+//! How often the backend thread drains the rings
+static const long LOG_DRAIN_PERIOD_MS = 20;
+
+static bool get_env_flag(const char *name, const bool default_value){
+    const char *value = std::getenv(name);
+    if (value == NULL or value[0] == '\0') return default_value;
+    const std::string str(value);
+    return not (str == "0" or str == "false" or str == "off" or str == "no");
+}
+
 /***********************************************************************
  * Global resources for the logger
  **********************************************************************/
@@ -43,6 +160,11 @@ public:
 
         //file lock pointer must be null
         _file_lock = NULL;
+        _file_open = false;
+        _syslog_open = false;
+        _seq = 0;
+        _num_dropped = 0;
+        _running = false;
 
         //set the default log level
         level = uhd::_log::never;
@@ -55,24 +177,68 @@ public:
         //allow override from environment variable
         const char * log_level_env = std::getenv("UHD_LOG_LEVEL");
         if (log_level_env != NULL) _set_log_level(log_level_env);
+
+        //where the records go, and how
+        _to_file = _to_console = _to_syslog = false;
+        const char * log_sinks_env = std::getenv("UHD_LOG_SINKS");
+        _set_log_sinks((log_sinks_env != NULL)? log_sinks_env : "file");
+        _async = get_env_flag("UHD_LOG_ASYNC", true);
+        _use_file_lock = get_env_flag("UHD_LOG_FILE_LOCK", true);
     }
 
     ~log_resource_type(void){
-        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (_running){
+            {
+                boost::lock_guard<boost::mutex> lock(_mutex);
+                _running = false;
+            }
+            _drain_cond.notify_one();
+            _drain_thread.join();
+        }
+        boost::lock_guard<boost::mutex> lock(_write_mutex);
         _file_stream.close();
         if (_file_lock != NULL) delete _file_lock;
+        #ifdef HAVE_SYSLOG
+        if (_syslog_open) closelog();
+        #endif
     }
 
-    void log_to_file(const std::string &log_msg){
-        boost::lock_guard<boost::mutex> lock(_mutex);
-        if (_file_lock == NULL){
-            const std::string log_path = (fs::path(uhd::get_tmp_path()) / "uhd.log").string();
-            _file_stream.open(log_path.c_str(), std::fstream::out | std::fstream::app);
-            _file_lock = new ip::file_lock(log_path.c_str());
+    /*!
+     * Queue a record on the ring of the calling thread, or write it right
+     * away with the synchronous backend. Queuing takes no locks, except
+     * on the first record of a thread, which registers its ring.
+     */
+    void log_it(std::string &log_msg){
+        log_record_t record;
+        record.seq = _seq.fetch_add(1, boost::memory_order_relaxed);
+        record.text.swap(log_msg);
+
+        if (not _async){
+            boost::lock_guard<boost::mutex> lock(_write_mutex);
+            _write_records(std::vector<log_record_t>(1, record));
+            return;
+        }
+
+        log_ring_holder_type *holder = _ring.get();
+        if (holder == NULL){
+            holder = new log_ring_holder_type();
+            holder->ring = boost::make_shared<log_ring_type>(LOG_RING_SIZE);
+            _ring.reset(holder);
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _rings.push_back(holder->ring);
+            if (not _running){
+                _running = true;
+                _drain_thread = boost::thread(boost::bind(&log_resource_type::_drain_loop, this));
+            }
+        }
+        //a burst of records wakes the backend thread before its period
+        const size_t used = holder->ring->push(record);
+        if (used == holder->ring->size()){
+            _num_dropped.fetch_add(1, boost::memory_order_relaxed);
+        }
+        else if (used == holder->ring->size()/2){
+            _drain_cond.notify_one();
         }
-        _file_lock->lock();
-        _file_stream << log_msg << std::flush;
-        _file_lock->unlock();
     }
 
 private:
@@ -92,10 +258,119 @@ private:
         if_lls_equal(never);
     }
 
-    //file stream and lock:
+    //! set the sinks from a comma separated list of file, console and syslog
+    void _set_log_sinks(const std::string &log_sinks_str){
+        typedef boost::tokenizer<boost::char_separator<char> > tokenizer_t;
+        BOOST_FOREACH(const std::string &sink, tokenizer_t(log_sinks_str, boost::char_separator<char>(", "))){
+            if (sink == "file") _to_file = true;
+            else if (sink == "console") _to_console = true;
+            #ifdef HAVE_SYSLOG
+            else if (sink == "syslog") _to_syslog = true;
+            #endif
+        }
+    }
+
+    //! move the queued records to the sinks in batches, until destruction
+    void _drain_loop(void){
+        uhd::scoped_internal_thread internal_thread("log writer", "other");
+        std::vector<log_record_t> records;
+        bool running = true;
+        while (running){
+            {
+                boost::unique_lock<boost::mutex> lock(_mutex);
+                if (_running) _drain_cond.timed_wait(lock, pt::milliseconds(LOG_DRAIN_PERIOD_MS));
+                running = _running;
+
+                //take the orphaned rings out after their last records
+                for (std::list<log_ring_type::sptr>::iterator it = _rings.begin(); it != _rings.end();){
+                    const bool orphaned = (*it)->orphaned();
+                    (*it)->pop_all(records);
+                    if (orphaned) it = _rings.erase(it);
+                    else ++it;
+                }
+            }
+
+            const size_t num_dropped = _num_dropped.exchange(0, boost::memory_order_relaxed);
+            if (num_dropped != 0){
+                log_record_t record;
+                record.seq = _seq.load(boost::memory_order_relaxed);
+                record.text = str(boost::format("\n-- %u log records dropped, the queues were full\n") % num_dropped);
+                records.push_back(record);
+            }
+            if (records.empty()) continue;
+
+            std::stable_sort(records.begin(), records.end(), log_record_comp);
+            try{
+                boost::lock_guard<boost::mutex> lock(_write_mutex);
+                _write_records(records);
+            }
+            catch(const std::exception &e){
+                //see uhd::_log::log::~log() for why the level goes first
+                this->level = uhd::_log::never;
+                UHD_MSG(error)
+                    << "Logging failed: " << e.what() << std::endl
+                    << "Logging has been disabled for this process" << std::endl
+                ;
+            }
+            records.clear();
+        }
+    }
+
+    //! write records to all sinks, call with the write mutex held
+    void _write_records(const std::vector<log_record_t> &records){
+        if (_to_file){
+            if (not _file_open){
+                const std::string log_path = (fs::path(uhd::get_tmp_path()) / "uhd.log").string();
+                _file_stream.open(log_path.c_str(), std::fstream::out | std::fstream::app);
+                if (_use_file_lock) _file_lock = new ip::file_lock(log_path.c_str());
+                _file_open = true;
+            }
+            //one lock of the shared file for the whole batch
+            if (_file_lock != NULL) _file_lock->lock();
+            BOOST_FOREACH(const log_record_t &record, records){
+                _file_stream << record.text;
+            }
+            _file_stream << std::flush;
+            if (_file_lock != NULL) _file_lock->unlock();
+        }
+        if (_to_console){
+            BOOST_FOREACH(const log_record_t &record, records){
+                std::clog << record.text;
+            }
+            std::clog << std::flush;
+        }
+        #ifdef HAVE_SYSLOG
+        if (_to_syslog){
+            if (not _syslog_open){
+                openlog("uhd", LOG_PID, LOG_USER);
+                _syslog_open = true;
+            }
+            BOOST_FOREACH(const log_record_t &record, records){
+                syslog(LOG_DEBUG, "%s", record.text.c_str());
+            }
+        }
+        #endif
+    }
+
+    //configuration from the environment:
+    bool _async, _use_file_lock;
+    bool _to_file, _to_console, _to_syslog;
+
+    //file stream, lock and syslog connection, used under the write mutex:
     std::ofstream _file_stream;
     ip::file_lock *_file_lock;
+    bool _file_open, _syslog_open;
+    boost::mutex _write_mutex;
+
+    //the rings and the backend thread, registered under the mutex:
+    boost::atomic<boost::uint64_t> _seq;
+    boost::atomic<size_t> _num_dropped;
+    boost::thread_specific_ptr<log_ring_holder_type> _ring;
+    std::list<log_ring_type::sptr> _rings;
     boost::mutex _mutex;
+    boost::condition_variable _drain_cond;
+    boost::thread _drain_thread;
+    bool _running;
 };
 
 UHD_SINGLETON_FCN(log_resource_type, log_rs);
@@ -140,6 +415,11 @@ uhd::_log::log::log(
     }
 }
 
+bool uhd::_log::log::is_enabled(const verbosity_t verbosity)
+{
+    return verbosity >= log_rs().level;
+}
+
 uhd::_log::log::~log(void)
 {
     if (not _log_it)
@@ -147,7 +427,8 @@ uhd::_log::log::~log(void)
 
     _ss << std::endl;
     try{
-        log_rs().log_to_file(_ss.str());
+        std::string log_msg = _ss.str();
+        log_rs().log_it(log_msg);
     }
     catch(const std::exception &e){
         /*!
@@ -79,11 +79,17 @@ void uhd::msg::register_handler(const handler_t &handler){
 }
 
 static void default_msg_handler(uhd::msg::type_t type, const std::string &msg){
+    //fastpath messages come from the streaming threads: one small write
+    //to the unbuffered stderr, without waiting on the other messages
+    if (type == uhd::msg::fastpath){
+        std::cerr << msg << std::flush;
+        return;
+    }
+
     static boost::mutex msg_mutex;
     boost::mutex::scoped_lock lock(msg_mutex);
     switch(type){
     case uhd::msg::fastpath:
-        std::cerr << msg << std::flush;
         break;
 
     case uhd::msg::status:
@@ -371,3 +371,23 @@ std::string uhd::print_utility_error(const std::string &name, const std::string
     return "Please run:\n\n \"" + find_utility(name) + (args.empty() ? "" : (" " + args)) + "\"";
     #endif
 }
+
+void uhd::write_file_atomically(const std::string &path, const std::string &contents){
+    const fs::path file_path(path);
+    const fs::path tmp_path(path + ".tmp");
+    try {
+        if (file_path.has_parent_path()) {
+            fs::create_directories(file_path.parent_path());
+        }
+        std::ofstream file(tmp_path.string().c_str(), std::ios::out | std::ios::trunc);
+        file << contents;
+        file.close();
+        if (not file) {
+            throw uhd::io_error("Could not write " + tmp_path.string());
+        }
+        fs::rename(tmp_path, file_path);
+    }
+    catch (const fs::filesystem_error &e) {
+        throw uhd::io_error(e.what());
+    }
+}
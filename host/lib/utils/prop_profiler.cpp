@@ -0,0 +1,201 @@
+//
+// Copyright 2016 Ettus Research
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/prop_profiler.hpp>
+#include <uhd/utils/static.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+using namespace uhd;
+
+namespace {
+
+    //! The callbacks that are timed, see scoped_probe
+    static const char *PROBE_NAMES[] = {"desired", "coercer", "coerced", "publisher"};
+    static const size_t NUM_PROBES = sizeof(PROBE_NAMES)/sizeof(*PROBE_NAMES);
+
+    //! Limits the memory used for the trace in long running applications
+    static const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+    struct path_stats_t{
+        path_stats_t(void): accesses(0), sets(0), gets(0){
+            std::fill(calls, calls + NUM_PROBES, 0);
+            std::fill(secs, secs + NUM_PROBES, 0.0);
+        }
+        double total_secs(void) const{
+            double total = 0.0;
+            for (size_t i = 0; i < NUM_PROBES; i++) total += secs[i];
+            return total;
+        }
+        size_t accesses, sets, gets;
+        size_t calls[NUM_PROBES];
+        double secs[NUM_PROBES];
+    };
+
+    struct trace_event_t{
+        std::string path;
+        size_t probe;
+        double start_secs;
+        double duration_secs;
+        size_t thread;
+    };
+
+    struct prop_profiler_t{
+        prop_profiler_t(void): start(time_spec_t::get_system_time()){}
+
+        boost::mutex mutex;
+        time_spec_t start;
+        boost::unordered_map<std::string, path_stats_t> stats;
+        std::vector<trace_event_t> trace;
+    };
+
+    UHD_SINGLETON_FCN(prop_profiler_t, get_profiler);
+
+    size_t probe_index(const char *name){
+        for (size_t i = 0; i < NUM_PROBES; i++){
+            if (std::strcmp(PROBE_NAMES[i], name) == 0) return i;
+        }
+        return NUM_PROBES - 1;
+    }
+
+    bool compare_by_time(
+        const std::pair<std::string, path_stats_t> &lhs,
+        const std::pair<std::string, path_stats_t> &rhs
+    ){
+        if (lhs.second.total_secs() != rhs.second.total_secs()){
+            return lhs.second.total_secs() > rhs.second.total_secs();
+        }
+        return lhs.second.accesses > rhs.second.accesses;
+    }
+
+    std::string json_escape(const std::string &str){
+        std::string escaped;
+        BOOST_FOREACH(const char ch, str){
+            if (ch == '"' or ch == '\\') escaped += '\\';
+            escaped += ch;
+        }
+        return escaped;
+    }
+
+} //namespace /*anon*/
+
+bool prop_profiler::enabled(void){
+#ifdef UHD_PROPERTY_TREE_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void prop_profiler::reset(void){
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+    profiler.stats.clear();
+    profiler.trace.clear();
+    profiler.start = time_spec_t::get_system_time();
+}
+
+std::string prop_profiler::to_table(void){
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+
+    std::vector<std::pair<std::string, path_stats_t> > rows(
+        profiler.stats.begin(), profiler.stats.end());
+    std::sort(rows.begin(), rows.end(), &compare_by_time);
+
+    std::ostringstream table;
+    if (not enabled()){
+        table << "Property tree profiling is disabled (build with UHD_PROPERTY_TREE_PROFILING)" << std::endl;
+    }
+    table << boost::format("%-60s %10s %10s %10s %12s %12s %12s %12s %12s")
+        % "Path" % "Accesses" % "Sets" % "Gets"
+        % "Total [ms]" % "Desired [ms]" % "Coercer [ms]" % "Coerced [ms]" % "Publish [ms]" << std::endl;
+    typedef std::pair<std::string, path_stats_t> row_t;
+    BOOST_FOREACH(const row_t &row, rows){
+        const path_stats_t &stats = row.second;
+        table << boost::format("%-60s %10d %10d %10d %12.3f %12.3f %12.3f %12.3f %12.3f")
+            % row.first % stats.accesses % stats.sets % stats.gets
+            % (stats.total_secs()*1e3) % (stats.secs[0]*1e3) % (stats.secs[1]*1e3)
+            % (stats.secs[2]*1e3) % (stats.secs[3]*1e3) << std::endl;
+    }
+    return table.str();
+}
+
+std::string prop_profiler::to_chrome_trace(void){
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+
+    std::ostringstream json;
+    json << "{\"traceEvents\":[";
+    for (size_t i = 0; i < profiler.trace.size(); i++){
+        const trace_event_t &event = profiler.trace[i];
+        if (i != 0) json << ",";
+        json << boost::format(
+            "\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}")
+            % json_escape(event.path) % PROBE_NAMES[event.probe]
+            % (event.start_secs*1e6) % (event.duration_secs*1e6) % event.thread;
+    }
+    json << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    return json.str();
+}
+
+void prop_profiler::record_access(const std::string &path){
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+    profiler.stats[path].accesses++;
+}
+
+void prop_profiler::record_use(const std::string &path, bool is_set){
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+    path_stats_t &stats = profiler.stats[path];
+    if (is_set) stats.sets++;
+    else stats.gets++;
+}
+
+prop_profiler::scoped_probe::scoped_probe(const std::string &path, const char *name):
+    _path(path), _name(name), _start(time_spec_t::get_system_time())
+{
+    /* NOP */
+}
+
+prop_profiler::scoped_probe::~scoped_probe(void){
+    const time_spec_t stop = time_spec_t::get_system_time();
+    const size_t probe = probe_index(_name);
+    prop_profiler_t &profiler = get_profiler();
+    boost::mutex::scoped_lock lock(profiler.mutex);
+    path_stats_t &stats = profiler.stats[_path];
+    stats.calls[probe]++;
+    stats.secs[probe] += (stop - _start).get_real_secs();
+    if (profiler.trace.size() < MAX_TRACE_EVENTS){
+        trace_event_t event;
+        event.path = _path;
+        event.probe = probe;
+        event.start_secs = (_start - profiler.start).get_real_secs();
+        event.duration_secs = (stop - _start).get_real_secs();
+        event.thread = boost::hash<boost::thread::id>()(boost::this_thread::get_id());
+        profiler.trace.push_back(event);
+    }
+}
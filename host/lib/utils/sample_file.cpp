@@ -0,0 +1,589 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/sample_file.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_O_DIRECT
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include <cstdio>
+#endif
+
+using namespace uhd;
+using namespace uhd::transport;
+
+//! Alignment of buffers, file offsets and lengths for direct I/O
+static const size_t DIRECT_ALIGNMENT = 4096;
+//! Marks that no buffer is held
+static const size_t NO_BUFFER = size_t(-1);
+
+/***********************************************************************
+ * Platform file access
+ **********************************************************************/
+class sample_file : boost::noncopyable
+{
+public:
+    sample_file(const std::string &path, const bool for_write, const bool direct):
+        _path(path)
+    {
+#ifdef HAVE_O_DIRECT
+        const int flags = for_write? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+        _fd = direct? ::open(path.c_str(), flags | O_DIRECT, 0644) : -1;
+        //some file systems (e.g. tmpfs) refuse direct I/O
+        if (_fd < 0) _fd = ::open(path.c_str(), flags, 0644);
+        if (_fd < 0) error("cannot open");
+#else
+        (void)direct;
+        _file = std::fopen(path.c_str(), for_write? "wb" : "rb");
+        if (_file == NULL) error("cannot open");
+#endif
+    }
+
+    ~sample_file(void)
+    {
+        this->close();
+    }
+
+    void write(const char *data, size_t len)
+    {
+#ifdef HAVE_O_DIRECT
+        while (len != 0) {
+            const ssize_t n = ::write(_fd, data, len);
+            if (n < 0 and errno == EINTR) continue;
+            if (n <= 0) error("cannot write to");
+            data += n;
+            len -= size_t(n);
+        }
+#else
+        if (std::fwrite(data, 1, len, _file) != len) error("cannot write to");
+#endif
+    }
+
+    //! Read up to len bytes, fewer only at the end of the file
+    size_t read(char *data, const size_t len)
+    {
+        size_t num_read = 0;
+#ifdef HAVE_O_DIRECT
+        while (num_read < len) {
+            const ssize_t n = ::read(_fd, data + num_read, len - num_read);
+            if (n < 0 and errno == EINTR) continue;
+            if (n < 0) error("cannot read from");
+            if (n == 0) break;
+            num_read += size_t(n);
+        }
+#else
+        num_read = std::fread(data, 1, len, _file);
+        if (num_read != len and std::ferror(_file)) error("cannot read from");
+#endif
+        return num_read;
+    }
+
+    //! Leave direct I/O, for a tail that is not a multiple of the alignment
+    void end_direct(void)
+    {
+#ifdef HAVE_O_DIRECT
+        const int flags = fcntl(_fd, F_GETFL);
+        if (flags < 0 or fcntl(_fd, F_SETFL, flags & ~O_DIRECT) < 0) error("cannot write to");
+#endif
+    }
+
+    void close(void)
+    {
+#ifdef HAVE_O_DIRECT
+        if (_fd >= 0 and ::close(_fd) < 0) {
+            _fd = -1;
+            error("cannot close");
+        }
+        _fd = -1;
+#else
+        if (_file != NULL and std::fclose(_file) != 0) {
+            _file = NULL;
+            error("cannot close");
+        }
+        _file = NULL;
+#endif
+    }
+
+private:
+    void error(const std::string &what)
+    {
+#ifdef HAVE_O_DIRECT
+        const std::string reason = std::strerror(errno);
+#else
+        const std::string reason = "I/O error";
+#endif
+        throw uhd::io_error(str(boost::format("%s %s: %s") % what % _path % reason));
+    }
+
+    const std::string _path;
+#ifdef HAVE_O_DIRECT
+    int _fd;
+#else
+    std::FILE *_file;
+#endif
+};
+
+/***********************************************************************
+ * Aligned buffers shared by the caller and the I/O thread
+ **********************************************************************/
+class sample_file_buffers : boost::noncopyable
+{
+public:
+    sample_file_buffers(const size_t buffer_size, const size_t num_buffers):
+        _mems(num_buffers), _buffs(num_buffers)
+    {
+        if (buffer_size == 0 or buffer_size % DIRECT_ALIGNMENT != 0 or num_buffers < 2) {
+            throw uhd::value_error(str(boost::format(
+                "sample file: need at least 2 buffers of a non-zero multiple of %u bytes")
+                % DIRECT_ALIGNMENT));
+        }
+        for (size_t i = 0; i < num_buffers; i++) {
+            _mems[i].resize(buffer_size + DIRECT_ALIGNMENT);
+            const size_t addr = size_t(&_mems[i].front());
+            _buffs[i] = &_mems[i].front() + (DIRECT_ALIGNMENT - addr % DIRECT_ALIGNMENT) % DIRECT_ALIGNMENT;
+        }
+    }
+
+    char *operator[](const size_t i) const
+    {
+        return _buffs[i];
+    }
+
+private:
+    std::vector<std::vector<char> > _mems;
+    std::vector<char *> _buffs;
+};
+
+/***********************************************************************
+ * Writer
+ **********************************************************************/
+sample_file_writer::stats_t::stats_t(void):
+    bytes(0), num_waits(0), wait_time(0.0), max_queued(0)
+{
+    /* NOP */
+}
+
+sample_file_writer::~sample_file_writer(void)
+{
+    /* NOP */
+}
+
+class sample_file_writer_impl : public sample_file_writer
+{
+public:
+    sample_file_writer_impl(
+        const std::string &path,
+        const size_t buffer_size,
+        const size_t num_buffers,
+        const bool direct
+    ):
+        _buffer_size(buffer_size),
+        _num_buffers(num_buffers),
+        _buffs(buffer_size, num_buffers),
+        _free(num_buffers),
+        _full(num_buffers),
+        _current(NO_BUFFER),
+        _fill(0),
+        _open(true),
+        _num_queued(0)
+    {
+        _file.reset(new sample_file(path, true, direct));
+        for (size_t i = 0; i < num_buffers; i++) _free.push_with_haste(i);
+        _task = task::make(boost::bind(&sample_file_writer_impl::write_loop, this));
+    }
+
+    ~sample_file_writer_impl(void)
+    {
+        UHD_SAFE_CALL(
+            this->close();
+        )
+    }
+
+    void *get_write_space(const size_t len)
+    {
+        check_error();
+        if (not _open) {
+            throw uhd::runtime_error("sample_file_writer: the file is closed");
+        }
+        //leaves room for the unaligned tail carried into the next buffer
+        if (len > _buffer_size - DIRECT_ALIGNMENT) {
+            throw uhd::value_error(str(boost::format(
+                "sample_file_writer: cannot get %u bytes at once from %u byte buffers")
+                % len % _buffer_size));
+        }
+        if (_current == NO_BUFFER) {
+            _current = get_free_buffer();
+        }
+        else if (_fill + len > _buffer_size) {
+            hand_off();
+        }
+        return _buffs[_current] + _fill;
+    }
+
+    void commit(const size_t len)
+    {
+        if (_current == NO_BUFFER or _fill + len > _buffer_size) {
+            throw uhd::value_error("sample_file_writer: commit() without get_write_space()");
+        }
+        _fill += len;
+        boost::mutex::scoped_lock lock(_mutex);
+        _stats.bytes += len;
+    }
+
+    void write(const void *data, const size_t len)
+    {
+        const char *in = reinterpret_cast<const char *>(data);
+        const size_t max_len = _buffer_size - DIRECT_ALIGNMENT;
+        for (size_t offset = 0; offset < len; offset += max_len) {
+            const size_t n = std::min(len - offset, max_len);
+            std::memcpy(get_write_space(n), in + offset, n);
+            commit(n);
+        }
+    }
+
+    void close(void)
+    {
+        if (not _open) return;
+        _open = false;
+
+        //hand the aligned part to the thread and keep the tail
+        const size_t aligned = _fill - _fill % DIRECT_ALIGNMENT;
+        const size_t tail = _fill - aligned;
+        if (_current != NO_BUFFER) {
+            if (aligned != 0) queue_buffer(_current, aligned);
+            else _free.push_with_haste(_current);
+        }
+
+        //all buffers return once written
+        size_t index;
+        for (size_t i = 0; i < _num_buffers; i++) _free.pop_with_wait(index);
+
+        if (tail != 0 and get_error().empty()) {
+            try {
+                _file->end_direct();
+                _file->write(_buffs[_current] + aligned, tail);
+            }
+            catch(const uhd::exception &ex) {
+                set_error(ex.what());
+            }
+        }
+        try {
+            _file->close();
+        }
+        catch(const uhd::exception &ex) {
+            set_error(ex.what());
+        }
+        check_error();
+    }
+
+    stats_t get_stats(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _stats;
+    }
+
+private:
+    //! Queue the current buffer and carry its unaligned tail into a free one
+    void hand_off(void)
+    {
+        const size_t aligned = _fill - _fill % DIRECT_ALIGNMENT;
+        const size_t next = get_free_buffer();
+        std::memcpy(_buffs[next], _buffs[_current] + aligned, _fill - aligned);
+        queue_buffer(_current, aligned);
+        _current = next;
+        _fill -= aligned;
+    }
+
+    size_t get_free_buffer(void)
+    {
+        size_t index;
+        if (_free.pop_with_haste(index)) return index;
+
+        //the disk fell behind
+        const time_spec_t start = time_spec_t::get_system_time();
+        _free.pop_with_wait(index);
+        const double wait_time = (time_spec_t::get_system_time() - start).get_real_secs();
+        boost::mutex::scoped_lock lock(_mutex);
+        _stats.num_waits++;
+        _stats.wait_time += wait_time;
+        return index;
+    }
+
+    void queue_buffer(const size_t index, const size_t len)
+    {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_queued++;
+            _stats.max_queued = std::max(_stats.max_queued, _num_queued);
+        }
+        _full.push_with_haste(std::make_pair(index, len));
+    }
+
+    void write_loop(void)
+    {
+        std::pair<size_t, size_t> buff;
+        if (not _full.pop_with_timed_wait(buff, 0.1)) return;
+
+        //after an error, only recycle the buffers
+        if (get_error().empty()) {
+            try {
+                _file->write(_buffs[buff.first], buff.second);
+            }
+            catch(const uhd::exception &ex) {
+                set_error(ex.what());
+            }
+        }
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _num_queued--;
+        }
+        _free.push_with_haste(buff.first);
+    }
+
+    std::string get_error(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _error;
+    }
+
+    void set_error(const std::string &error)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_error.empty()) _error = error;
+    }
+
+    void check_error(void)
+    {
+        const std::string error = get_error();
+        if (not error.empty()) throw uhd::io_error(error);
+    }
+
+    const size_t _buffer_size;
+    const size_t _num_buffers;
+    boost::scoped_ptr<sample_file> _file;
+    sample_file_buffers _buffs;
+    bounded_buffer<size_t> _free;
+    bounded_buffer<std::pair<size_t, size_t> > _full; //index and length
+    size_t _current; //the buffer being filled by the caller
+    size_t _fill;
+    bool _open;
+    boost::mutex _mutex;
+    size_t _num_queued;
+    stats_t _stats;
+    std::string _error; //the first write error
+    task::sptr _task; //declared last, uses the members above
+};
+
+sample_file_writer::sptr sample_file_writer::make(
+    const std::string &path,
+    const size_t buffer_size,
+    const size_t num_buffers,
+    const bool direct
+){
+    return sptr(new sample_file_writer_impl(path, buffer_size, num_buffers, direct));
+}
+
+/***********************************************************************
+ * Reader
+ **********************************************************************/
+sample_file_reader::stats_t::stats_t(void):
+    bytes(0), num_waits(0), wait_time(0.0)
+{
+    /* NOP */
+}
+
+sample_file_reader::~sample_file_reader(void)
+{
+    /* NOP */
+}
+
+class sample_file_reader_impl : public sample_file_reader
+{
+public:
+    sample_file_reader_impl(
+        const std::string &path,
+        const size_t buffer_size,
+        const size_t num_buffers,
+        const bool direct
+    ):
+        _buffer_size(buffer_size),
+        _buffs(buffer_size, num_buffers),
+        _free(num_buffers),
+        _full(num_buffers),
+        _current(NO_BUFFER),
+        _len(0),
+        _pos(0),
+        _end(false),
+        _read_end(false)
+    {
+        _file.reset(new sample_file(path, false, direct));
+        for (size_t i = 0; i < num_buffers; i++) _free.push_with_haste(i);
+        _task = task::make(boost::bind(&sample_file_reader_impl::read_loop, this));
+    }
+
+    ~sample_file_reader_impl(void)
+    {
+        UHD_SAFE_CALL(
+            _task.reset();
+            _file->close();
+        )
+    }
+
+    const void *peek(size_t &len)
+    {
+        check_error();
+        if (_current == NO_BUFFER and not _end) {
+            std::pair<size_t, size_t> buff;
+            get_full_buffer(buff);
+            check_error();
+            _current = buff.first;
+            _len = buff.second;
+            _pos = 0;
+            if (_len == 0) release_buffer();
+        }
+        if (_current == NO_BUFFER) {
+            len = 0;
+            return NULL;
+        }
+        len = std::min(len, _len - _pos);
+        return _buffs[_current] + _pos;
+    }
+
+    void consume(const size_t len)
+    {
+        if (_current == NO_BUFFER or _pos + len > _len) {
+            throw uhd::value_error("sample_file_reader: consume() past what peek() returned");
+        }
+        _pos += len;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _stats.bytes += len;
+        }
+        if (_pos == _len) release_buffer();
+    }
+
+    size_t read(void *data, const size_t len)
+    {
+        char *out = reinterpret_cast<char *>(data);
+        size_t num_read = 0;
+        while (num_read < len) {
+            size_t n = len - num_read;
+            const void *in = peek(n);
+            if (n == 0) break;
+            std::memcpy(out + num_read, in, n);
+            consume(n);
+            num_read += n;
+        }
+        return num_read;
+    }
+
+    stats_t get_stats(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _stats;
+    }
+
+private:
+    void get_full_buffer(std::pair<size_t, size_t> &buff)
+    {
+        if (_full.pop_with_haste(buff)) return;
+
+        //the disk fell behind
+        const time_spec_t start = time_spec_t::get_system_time();
+        _full.pop_with_wait(buff);
+        const double wait_time = (time_spec_t::get_system_time() - start).get_real_secs();
+        boost::mutex::scoped_lock lock(_mutex);
+        _stats.num_waits++;
+        _stats.wait_time += wait_time;
+    }
+
+    //! Give the current buffer back; a short one was the last of the file
+    void release_buffer(void)
+    {
+        if (_len < _buffer_size) _end = true;
+        _free.push_with_haste(_current);
+        _current = NO_BUFFER;
+    }
+
+    void read_loop(void)
+    {
+        if (_read_end) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+            return;
+        }
+        size_t index;
+        if (not _free.pop_with_timed_wait(index, 0.1)) return;
+
+        size_t len = 0;
+        try {
+            len = _file->read(_buffs[index], _buffer_size);
+        }
+        catch(const uhd::exception &ex) {
+            boost::mutex::scoped_lock lock(_mutex);
+            _error = ex.what();
+        }
+        //with direct I/O, nothing can be read after a short read anyway
+        _read_end = (len < _buffer_size);
+        _full.push_with_haste(std::make_pair(index, len));
+    }
+
+    void check_error(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (not _error.empty()) throw uhd::io_error(_error);
+    }
+
+    const size_t _buffer_size;
+    boost::scoped_ptr<sample_file> _file;
+    sample_file_buffers _buffs;
+    bounded_buffer<size_t> _free;
+    bounded_buffer<std::pair<size_t, size_t> > _full; //index and length
+    size_t _current; //the buffer being read by the caller
+    size_t _len;
+    size_t _pos;
+    bool _end;
+    bool _read_end; //only used by the thread
+    boost::mutex _mutex;
+    stats_t _stats;
+    std::string _error; //the read error, if any
+    task::sptr _task; //declared last, uses the members above
+};
+
+sample_file_reader::sptr sample_file_reader::make(
+    const std::string &path,
+    const size_t buffer_size,
+    const size_t num_buffers,
+    const bool direct
+){
+    return sptr(new sample_file_reader_impl(path, buffer_size, num_buffers, direct));
+}
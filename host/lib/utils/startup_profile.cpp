@@ -0,0 +1,136 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/startup_profile.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/static.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+
+using namespace uhd;
+
+namespace {
+
+    struct startup_profile_t{
+        startup_profile_t(void): start(time_spec_t::get_system_time()){}
+
+        boost::mutex mutex;
+        time_spec_t start;
+        startup_profile::phases_t phases;
+    };
+
+    UHD_SINGLETON_FCN(startup_profile_t, get_profile);
+
+    //! The phase of each thread that was started with begin()
+    boost::thread_specific_ptr<startup_profile::phase_t> open_phase;
+
+    size_t this_thread_index(void){
+        return boost::hash<boost::thread::id>()(boost::this_thread::get_id());
+    }
+
+    double now_secs(void){
+        startup_profile_t &profile = get_profile();
+        boost::mutex::scoped_lock lock(profile.mutex);
+        return (time_spec_t::get_system_time() - profile.start).get_real_secs();
+    }
+
+    void add_phase(const std::string &name, const double start_secs){
+        startup_profile::phase_t phase;
+        phase.name = name;
+        phase.start_secs = start_secs;
+        phase.thread = this_thread_index();
+        startup_profile_t &profile = get_profile();
+        boost::mutex::scoped_lock lock(profile.mutex);
+        phase.duration_secs = (time_spec_t::get_system_time() - profile.start).get_real_secs() - start_secs;
+        profile.phases.push_back(phase);
+    }
+
+    struct static_blocks_t{
+        boost::mutex mutex;
+        time_spec_t first_start;
+        startup_profile::phases_t blocks;
+    };
+
+    UHD_SINGLETON_FCN(static_blocks_t, get_static_block_list);
+
+    bool started_earlier(const startup_profile::phase_t &lhs, const startup_profile::phase_t &rhs){
+        return lhs.start_secs < rhs.start_secs;
+    }
+
+} //namespace /*anon*/
+
+void startup_profile::reset(void){
+    startup_profile_t &profile = get_profile();
+    boost::mutex::scoped_lock lock(profile.mutex);
+    profile.phases.clear();
+    profile.start = time_spec_t::get_system_time();
+}
+
+startup_profile::phases_t startup_profile::get_phases(void){
+    startup_profile_t &profile = get_profile();
+    boost::mutex::scoped_lock lock(profile.mutex);
+    phases_t phases = profile.phases;
+    std::stable_sort(phases.begin(), phases.end(), &started_earlier);
+    return phases;
+}
+
+void startup_profile::begin(const std::string &name){
+    end();
+    phase_t *phase = new phase_t();
+    phase->name = name;
+    phase->start_secs = now_secs();
+    open_phase.reset(phase);
+}
+
+void startup_profile::end(void){
+    if (open_phase.get() == NULL) return;
+    add_phase(open_phase->name, open_phase->start_secs);
+    open_phase.reset();
+}
+
+startup_profile::scoped_phase::scoped_phase(const std::string &name):
+    _name(name), _start_secs(now_secs())
+{
+    /* NOP */
+}
+
+startup_profile::scoped_phase::~scoped_phase(void){
+    add_phase(_name, _start_secs);
+}
+
+startup_profile::phases_t startup_profile::get_static_blocks(void){
+    static_blocks_t &list = get_static_block_list();
+    boost::mutex::scoped_lock lock(list.mutex);
+    return list.blocks;
+}
+
+void startup_profile::add_static_block(
+    const std::string &name, const time_spec_t &start, const time_spec_t &duration
+){
+    static_blocks_t &list = get_static_block_list();
+    boost::mutex::scoped_lock lock(list.mutex);
+    if (list.blocks.empty()) list.first_start = start;
+    phase_t block;
+    block.name = name;
+    block.start_secs = (start - list.first_start).get_real_secs();
+    block.duration_secs = duration.get_real_secs();
+    block.thread = this_thread_index();
+    list.blocks.push_back(block);
+}
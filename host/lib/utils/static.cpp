@@ -16,9 +16,17 @@
 //
 
 #include <uhd/utils/static.hpp>
+#include <uhd/utils/startup_profile.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 #include <stdexcept>
 #include <iostream>
-_uhd_static_fixture::_uhd_static_fixture(void (*fcn)(void), const char *name){
+#include <map>
+#include <vector>
+
+//! Call a static block, print its exceptions and record its time
+static void run_static_block(void (*fcn)(void), const char *name){
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
     try{
         fcn();
     }
@@ -29,4 +37,55 @@ _uhd_static_fixture::_uhd_static_fixture(void (*fcn)(void), const char *name){
     catch(...){
         std::cerr << "Exception in static block " << name << std::endl;
     }
+    uhd::startup_profile::add_static_block(name, start, uhd::time_spec_t::get_system_time() - start);
+}
+
+_uhd_static_fixture::_uhd_static_fixture(void (*fcn)(void), const char *name){
+    run_static_block(fcn, name);
+}
+
+/***********************************************************************
+ * Deferred blocks
+ **********************************************************************/
+namespace {
+    struct deferred_block_t{
+        void (*fcn)(void);
+        const char *name;
+    };
+
+    struct deferred_group_t{
+        deferred_group_t(void): done(false){}
+        bool done;
+        std::vector<deferred_block_t> blocks;
+    };
+
+    typedef std::map<std::string, deferred_group_t> deferred_groups_t;
+    UHD_SINGLETON_FCN(deferred_groups_t, get_deferred_groups);
+    //recursive: blocks may register more blocks or run their group
+    UHD_SINGLETON_FCN(boost::recursive_mutex, get_deferred_mutex);
+}
+
+_uhd_deferred_fixture::_uhd_deferred_fixture(const char *group, void (*fcn)(void), const char *name){
+    boost::recursive_mutex::scoped_lock lock(get_deferred_mutex());
+    deferred_group_t &deferred_group = get_deferred_groups()[group];
+    if (deferred_group.done){
+        run_static_block(fcn, name);
+        return;
+    }
+    deferred_block_t block;
+    block.fcn = fcn;
+    block.name = name;
+    deferred_group.blocks.push_back(block);
+}
+
+void uhd::run_deferred_blocks(const std::string &group){
+    boost::recursive_mutex::scoped_lock lock(get_deferred_mutex());
+    deferred_group_t &deferred_group = get_deferred_groups()[group];
+    if (deferred_group.done) return;
+    deferred_group.done = true;
+    std::vector<deferred_block_t> blocks;
+    blocks.swap(deferred_group.blocks);
+    for (size_t i = 0; i < blocks.size(); i++){
+        run_static_block(blocks[i].fcn, blocks[i].name);
+    }
 }
@@ -18,10 +18,19 @@
 #include <uhd/utils/tasks.hpp>
 #include <uhd/utils/msg_task.hpp>
 #include <uhd/utils/msg.hpp>
+#include <uhd/utils/thread_priority.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <map>
 #include <vector>
 
 using namespace uhd;
@@ -29,7 +38,8 @@ using namespace uhd;
 class task_impl : public task{
 public:
 
-    task_impl(const task_fcn_type &task_fcn):
+    task_impl(const task_fcn_type &task_fcn, const std::string &role, const std::string &name):
+        _role(role), _name(name),
         _spawn_barrier(2)
     {
         (void)_thread_group.create_thread(boost::bind(&task_impl::task_loop, this, task_fcn));
@@ -45,6 +55,7 @@ public:
 private:
 
     void task_loop(const task_fcn_type &task_fcn){
+        scoped_internal_thread internal_thread(_name, _role);
         _running = true;
         _spawn_barrier.wait();
 
@@ -74,13 +85,188 @@ private:
         ;
     }
 
+    const std::string _role, _name;
     boost::thread_group _thread_group;
     boost::barrier _spawn_barrier;
     bool _running;
 };
 
 task::sptr task::make(const task_fcn_type &task_fcn){
-    return task::sptr(new task_impl(task_fcn));
+    return task::make(task_fcn, "other", "task");
+}
+
+task::sptr task::make(const task_fcn_type &task_fcn, const std::string &role, const std::string &name){
+    return task::sptr(new task_impl(task_fcn, role, name));
+}
+
+/***********************************************************************
+ * Pooled tasks
+ * - the tasks of a role share a few worker threads (UHD_TASK_POOL_THREADS)
+ * - each worker calls its tasks in turn, and backs off when none did work
+ **********************************************************************/
+static const double POOL_MIN_BACKOFF_US = 50;
+static const double POOL_MAX_BACKOFF_US = 2000;
+
+struct pooled_entry_t{
+    task::poll_fcn_type poll_fcn;
+    std::string name;
+    boost::mutex mutex; //held while the poll function runs
+    bool active;
+};
+typedef boost::shared_ptr<pooled_entry_t> pooled_entry_sptr;
+
+class task_pool_worker : boost::noncopyable{
+public:
+    task_pool_worker(const std::string &role): _generation(0){
+        _thread = boost::thread(boost::bind(&task_pool_worker::run, this, role));
+    }
+
+    size_t size(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return _entries.size();
+    }
+
+    void add(pooled_entry_sptr entry){
+        boost::mutex::scoped_lock lock(_mutex);
+        _entries.push_back(entry);
+        _generation++;
+        _cond.notify_one();
+    }
+
+    void remove(pooled_entry_sptr entry){
+        //wait for a call in progress, no further calls are made
+        {
+            boost::mutex::scoped_lock lock(entry->mutex);
+            entry->active = false;
+        }
+        boost::mutex::scoped_lock lock(_mutex);
+        _entries.erase(std::remove(_entries.begin(), _entries.end(), entry), _entries.end());
+        _generation++;
+    }
+
+private:
+    void run(const std::string &role){
+        scoped_internal_thread internal_thread("task pool", role);
+        std::vector<pooled_entry_sptr> entries;
+        size_t generation = ~size_t(0);
+        double backoff_us = POOL_MIN_BACKOFF_US;
+        try{
+            while (true){
+                {
+                    boost::mutex::scoped_lock lock(_mutex);
+                    if (_entries.empty()) entries.clear();
+                    while (_entries.empty()) _cond.wait(lock);
+                    if (generation != _generation){
+                        entries = _entries;
+                        generation = _generation;
+                    }
+                }
+
+                bool progress = false;
+                BOOST_FOREACH(const pooled_entry_sptr &entry, entries){
+                    boost::mutex::scoped_lock lock(entry->mutex);
+                    if (not entry->active) continue;
+                    try{
+                        if (entry->poll_fcn()) progress = true;
+                    }
+                    catch(const boost::thread_interrupted &){
+                        throw;
+                    }
+                    catch(const std::exception &e){
+                        entry->active = false;
+                        UHD_MSG(error)
+                            << "An unexpected exception was caught in the pooled task " << entry->name << "." << std::endl
+                            << "The task will not run again, things may not work." << std::endl
+                            << e.what() << std::endl
+                        ;
+                    }
+                }
+
+                if (progress){
+                    backoff_us = POOL_MIN_BACKOFF_US;
+                    continue;
+                }
+                boost::this_thread::sleep(boost::posix_time::microseconds(long(backoff_us)));
+                backoff_us = std::min(2*backoff_us, POOL_MAX_BACKOFF_US);
+            }
+        }
+        catch(const boost::thread_interrupted &){
+            //not expected, the pool lives until the process exits
+        }
+    }
+
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::vector<pooled_entry_sptr> _entries;
+    size_t _generation;
+    boost::thread _thread;
+};
+
+class task_pool_type{
+public:
+    task_pool_type(void): _num_workers(1){
+        const char *num_workers = std::getenv("UHD_TASK_POOL_THREADS");
+        if (num_workers == NULL) return;
+        try{
+            _num_workers = std::max<size_t>(1, boost::lexical_cast<size_t>(num_workers));
+        }
+        catch(const boost::bad_lexical_cast &){
+            UHD_MSG(warning) << "Ignoring UHD_TASK_POOL_THREADS=" << num_workers << std::endl;
+        }
+    }
+
+    //! add the entry to the least busy worker of the role
+    task_pool_worker &add(const std::string &role, pooled_entry_sptr entry){
+        boost::mutex::scoped_lock lock(_mutex);
+        std::vector<boost::shared_ptr<task_pool_worker> > &workers = _workers[role];
+        boost::shared_ptr<task_pool_worker> best;
+        if (workers.size() < _num_workers){
+            workers.push_back(boost::make_shared<task_pool_worker>(role));
+            best = workers.back();
+        }
+        else{
+            BOOST_FOREACH(const boost::shared_ptr<task_pool_worker> &worker, workers){
+                if (not best or worker->size() < best->size()) best = worker;
+            }
+        }
+        best->add(entry);
+        return *best;
+    }
+
+private:
+    boost::mutex _mutex;
+    size_t _num_workers;
+    std::map<std::string, std::vector<boost::shared_ptr<task_pool_worker> > > _workers;
+};
+
+//never destroyed: pooled tasks of other singletons go away at exit
+static task_pool_type &task_pool(void){
+    static task_pool_type *pool = new task_pool_type();
+    return *pool;
+}
+
+class pooled_task_impl : public task{
+public:
+    pooled_task_impl(const poll_fcn_type &poll_fcn, const std::string &role, const std::string &name):
+        _entry(boost::make_shared<pooled_entry_t>())
+    {
+        _entry->poll_fcn = poll_fcn;
+        _entry->name = name;
+        _entry->active = true;
+        _worker = &task_pool().add(role, _entry);
+    }
+
+    ~pooled_task_impl(void){
+        _worker->remove(_entry);
+    }
+
+private:
+    pooled_entry_sptr _entry;
+    task_pool_worker *_worker;
+};
+
+task::sptr task::make_pooled(const poll_fcn_type &poll_fcn, const std::string &role, const std::string &name){
+    return task::sptr(new pooled_task_impl(poll_fcn, role, name));
 }
 
 msg_task::~msg_task(void){
@@ -96,8 +282,10 @@ msg_task::~msg_task(void){
 class msg_task_impl : public msg_task{
 public:
 
-    msg_task_impl(const task_fcn_type &task_fcn):
-        _spawn_barrier(2)
+    msg_task_impl(const task_fcn_type &task_fcn, const std::string &role, const std::string &name):
+        _role(role), _name(name),
+        _spawn_barrier(2),
+        _next_seq(0)
     {
         (void)_thread_group.create_thread(boost::bind(&msg_task_impl::task_loop, this, task_fcn));
         _spawn_barrier.wait();
@@ -119,19 +307,25 @@ public:
     {
         boost::mutex::scoped_lock lock(_mutex);
         msg_payload_t b;
-        for (size_t i = 0; i < _dump_queue.size(); i++) {
-            if (sid == _dump_queue[i].first) {
-                b = _dump_queue[i].second;
-                _dump_queue.erase(_dump_queue.begin() + i);
-                break;
+        //the oldest message for this sid goes first
+        size_t found = DUMP_QUEUE_SIZE;
+        for (size_t i = 0; i < DUMP_QUEUE_SIZE; i++) {
+            if (_dump_queue[i].used and sid == _dump_queue[i].msg.first
+                and (found == DUMP_QUEUE_SIZE or _dump_queue[i].seq < _dump_queue[found].seq)) {
+                found = i;
             }
         }
+        if (found != DUMP_QUEUE_SIZE) {
+            b = _dump_queue[found].msg.second;
+            _dump_queue[found].used = false;
+        }
         return b;
     }
 
 private:
 
     void task_loop(const task_fcn_type &task_fcn){
+        scoped_internal_thread internal_thread(_name, _role);
         _running = true;
         _spawn_barrier.wait();
 
@@ -143,8 +337,7 @@ private:
             	     * If a message gets stranded it is returned by task_fcn and then pushed to the dump_queue.
             	     * This way ctrl_cores can check dump_queue for missing messages.
             	     */
-            	    boost::mutex::scoped_lock lock(_mutex);
-            	    _dump_queue.push_back(buff.get() );
+            	    push_to_dump_queue(buff.get());
             	}
             }
         }
@@ -169,17 +362,49 @@ private:
         ;
     }
 
+    //store a message in a free slot, or in place of the oldest one
+    void push_to_dump_queue(const msg_type_t &msg){
+        boost::mutex::scoped_lock lock(_mutex);
+        size_t slot = 0;
+        for (size_t i = 0; i < DUMP_QUEUE_SIZE; i++) {
+            if (not _dump_queue[i].used) {
+                slot = i;
+                break;
+            }
+            if (_dump_queue[i].seq < _dump_queue[slot].seq) slot = i;
+        }
+        _dump_queue[slot].msg = msg;
+        _dump_queue[slot].seq = _next_seq++;
+        _dump_queue[slot].used = true;
+    }
+
+    static const size_t DUMP_QUEUE_SIZE = 32;
+
+    struct dump_slot_t{
+        dump_slot_t(void): seq(0), used(false) {}
+        msg_type_t msg;
+        uint64_t seq;
+        bool used;
+    };
+
     boost::mutex _mutex;
+    const std::string _role, _name;
     boost::thread_group _thread_group;
     boost::barrier _spawn_barrier;
     bool _running;
 
     /*
      * This queue holds stranded messages until a radio_ctrl_core grabs them via 'get_msg_from_dump_queue'.
+     * The slots are allocated once, a full queue drops the oldest message.
      */
-    std::vector <msg_type_t> _dump_queue;
+    dump_slot_t _dump_queue[DUMP_QUEUE_SIZE];
+    uint64_t _next_seq;
 };
 
 msg_task::sptr msg_task::make(const task_fcn_type &task_fcn){
-    return msg_task::sptr(new msg_task_impl(task_fcn));
+    return msg_task::make(task_fcn, "other", "task");
+}
+
+msg_task::sptr msg_task::make(const task_fcn_type &task_fcn, const std::string &role, const std::string &name){
+    return msg_task::sptr(new msg_task_impl(task_fcn, role, name));
 }
@@ -19,7 +19,14 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <map>
 
 bool uhd::set_thread_priority_safe(float priority, bool realtime){
     try{
@@ -35,22 +42,74 @@ bool uhd::set_thread_priority_safe(float priority, bool realtime){
     }
 }
 
+bool uhd::set_thread_priority_safe(float priority, bool realtime, size_t cpu){
+    const bool prio_ok = set_thread_priority_safe(priority, realtime);
+    try{
+        set_thread_affinity(std::vector<size_t>(1, cpu));
+        return prio_ok;
+    }catch(const std::exception &e){
+        UHD_MSG(warning) << boost::format(
+            "Unable to pin the thread to CPU %u. Performance may be negatively affected.\n"
+            "%s\n"
+        ) % cpu % e.what();
+        return false;
+    }
+}
+
 static void check_priority_range(float priority){
     if (priority > +1.0 or priority < -1.0)
         throw uhd::value_error("priority out of range [-1.0, +1.0]");
 }
 
 /***********************************************************************
- * Pthread API to set priority
+ * Native thread handles
+ * - the current thread, to configure the calling thread
+ * - an opened handle, to configure a registered thread from another
  **********************************************************************/
-#ifdef HAVE_PTHREAD_SETSCHEDPARAM
+#if defined(HAVE_PTHREAD_SETSCHEDPARAM) || defined(HAVE_PTHREAD_SETAFFINITY_NP)
     #include <pthread.h>
 
-    void uhd::set_thread_priority(float priority, bool realtime){
+    typedef pthread_t native_thread_t;
+    static native_thread_t current_thread(void){return pthread_self();}
+    static native_thread_t open_current_thread(void){return pthread_self();}
+    static void close_thread(native_thread_t){}
+#elif defined(HAVE_WIN_SETTHREADPRIORITY) || defined(HAVE_WIN_SETTHREADAFFINITYMASK)
+    #include <windows.h>
+
+    typedef HANDLE native_thread_t;
+    static native_thread_t current_thread(void){return GetCurrentThread();}
+    static native_thread_t open_current_thread(void){
+        return OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, GetCurrentThreadId());
+    }
+    static void close_thread(native_thread_t thread){
+        if (thread != NULL) CloseHandle(thread);
+    }
+#else
+    typedef int native_thread_t;
+    static native_thread_t current_thread(void){return 0;}
+    static native_thread_t open_current_thread(void){return 0;}
+    static void close_thread(native_thread_t){}
+#endif
+
+#if defined(__linux__)
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    static size_t get_os_thread_id(void){return size_t(syscall(SYS_gettid));}
+#elif defined(HAVE_WIN_SETTHREADPRIORITY) || defined(HAVE_WIN_SETTHREADAFFINITYMASK)
+    static size_t get_os_thread_id(void){return size_t(GetCurrentThreadId());}
+#else
+    static size_t get_os_thread_id(void){return 0;}
+#endif
+
+/***********************************************************************
+ * Pthread API to set priority
+ **********************************************************************/
+#ifdef HAVE_PTHREAD_SETSCHEDPARAM
+    static void set_native_priority(native_thread_t thread, float priority, bool realtime, bool fifo){
         check_priority_range(priority);
 
         //when realtime is not enabled, use sched other
-        int policy = (realtime)? SCHED_RR : SCHED_OTHER;
+        int policy = (realtime)? ((fifo)? SCHED_FIFO : SCHED_RR) : SCHED_OTHER;
 
         //we cannot have below normal priority, set to zero
         if (priority < 0) priority = 0;
@@ -63,7 +122,7 @@ static void check_priority_range(float priority){
         //set the new priority and policy
         sched_param sp;
         sp.sched_priority = int(priority*(max_pri - min_pri)) + min_pri;
-        int ret = pthread_setschedparam(pthread_self(), policy, &sp);
+        int ret = pthread_setschedparam(thread, policy, &sp);
         if (ret != 0) throw uhd::os_error("error in pthread_setschedparam");
     }
 #endif /* HAVE_PTHREAD_SETSCHEDPARAM */
@@ -72,9 +131,7 @@ static void check_priority_range(float priority){
  * Windows API to set priority
  **********************************************************************/
 #ifdef HAVE_WIN_SETTHREADPRIORITY
-    #include <windows.h>
-
-    void uhd::set_thread_priority(float priority, UHD_UNUSED(bool realtime)){
+    static void set_native_priority(native_thread_t thread, float priority, UHD_UNUSED(bool realtime), UHD_UNUSED(bool fifo)){
         check_priority_range(priority);
 
         /*
@@ -94,17 +151,314 @@ static void check_priority_range(float priority){
         size_t pri_index = size_t((priority+1.0)*6/2.0); // -1 -> 0, +1 -> 6
 
         //set the thread priority on the thread
-        if (SetThreadPriority(GetCurrentThread(), priorities[pri_index]) == 0)
+        if (SetThreadPriority(thread, priorities[pri_index]) == 0)
             throw uhd::os_error("error in SetThreadPriority");
     }
 #endif /* HAVE_WIN_SETTHREADPRIORITY */
 
+/***********************************************************************
+ * Pthread API to set affinity
+ **********************************************************************/
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    static void set_native_affinity(native_thread_t thread, const std::vector<size_t> &cpus){
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (size_t i = 0; i < cpus.size(); i++){
+            if (cpus[i] >= CPU_SETSIZE) throw uhd::value_error("cpu index out of range");
+            CPU_SET(cpus[i], &cpuset);
+        }
+        int ret = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+        if (ret != 0) throw uhd::os_error("error in pthread_setaffinity_np");
+    }
+
+    static std::vector<size_t> get_native_affinity(native_thread_t thread){
+        std::vector<size_t> cpus;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        if (pthread_getaffinity_np(thread, sizeof(cpu_set_t), &cpuset) != 0) return cpus;
+        for (size_t i = 0; i < CPU_SETSIZE; i++){
+            if (CPU_ISSET(i, &cpuset)) cpus.push_back(i);
+        }
+        return cpus;
+    }
+#endif /* HAVE_PTHREAD_SETAFFINITY_NP */
+
+/***********************************************************************
+ * Windows API to set affinity
+ **********************************************************************/
+#ifdef HAVE_WIN_SETTHREADAFFINITYMASK
+    static void set_native_affinity(native_thread_t thread, const std::vector<size_t> &cpus){
+        DWORD_PTR mask = 0;
+        for (size_t i = 0; i < cpus.size(); i++){
+            if (cpus[i] >= sizeof(DWORD_PTR)*8) throw uhd::value_error("cpu index out of range");
+            mask |= DWORD_PTR(1) << cpus[i];
+        }
+        if (SetThreadAffinityMask(thread, mask) == 0)
+            throw uhd::os_error("error in SetThreadAffinityMask");
+    }
+
+    static std::vector<size_t> get_native_affinity(native_thread_t){
+        return std::vector<size_t>();
+    }
+#endif /* HAVE_WIN_SETTHREADAFFINITYMASK */
+
+/***********************************************************************
+ * Unimplemented API to set affinity
+ **********************************************************************/
+#ifdef HAVE_THREAD_AFFINITY_DUMMY
+    static void set_native_affinity(native_thread_t, const std::vector<size_t> &){
+        throw uhd::not_implemented_error("set thread affinity not implemented");
+    }
+
+    static std::vector<size_t> get_native_affinity(native_thread_t){
+        return std::vector<size_t>();
+    }
+#endif /* HAVE_THREAD_AFFINITY_DUMMY */
+
 /***********************************************************************
  * Unimplemented API to set priority
  **********************************************************************/
 #ifdef HAVE_THREAD_PRIO_DUMMY
-    void uhd::set_thread_priority(float, bool){
+    static void set_native_priority(native_thread_t, float, bool, bool){
         throw uhd::not_implemented_error("set thread priority not implemented");
     }
-
 #endif /* HAVE_THREAD_PRIO_DUMMY */
+
+void uhd::set_thread_priority(float priority, bool realtime){
+    set_native_priority(current_thread(), priority, realtime, false);
+}
+
+void uhd::set_thread_affinity(const std::vector<size_t> &cpus){
+    set_native_affinity(current_thread(), cpus);
+}
+
+/***********************************************************************
+ * CPU lists, as in sysfs ("0-3,6") and device args ("0-3:6")
+ **********************************************************************/
+static std::vector<size_t> parse_cpu_list(const std::string &list){
+    std::vector<size_t> cpus;
+    std::vector<std::string> ranges;
+    const std::string trimmed = boost::algorithm::trim_copy(list);
+    if (trimmed.empty()) return cpus;
+    boost::split(ranges, trimmed, boost::is_any_of(",:"));
+    BOOST_FOREACH(const std::string &range, ranges){
+        const size_t dash = range.find('-');
+        const size_t first = boost::lexical_cast<size_t>(boost::algorithm::trim_copy(range.substr(0, dash)));
+        const size_t last = (dash == std::string::npos)? first :
+            boost::lexical_cast<size_t>(boost::algorithm::trim_copy(range.substr(dash + 1)));
+        for (size_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static std::vector<size_t> read_sysfs_cpu_list(const std::string &name){
+    std::ifstream file(("/sys/devices/system/cpu/" + name).c_str());
+    std::string line;
+    if (not std::getline(file, line)) return std::vector<size_t>();
+    try{
+        return parse_cpu_list(line);
+    }
+    catch(const boost::bad_lexical_cast &){
+        return std::vector<size_t>();
+    }
+}
+
+std::vector<size_t> uhd::get_isolated_cpus(void){
+    return read_sysfs_cpu_list("isolated");
+}
+
+/***********************************************************************
+ * Internal thread registry
+ **********************************************************************/
+uhd::thread_config_t::thread_config_t(void):
+    set_priority(false),
+    priority(default_thread_priority),
+    realtime(true),
+    fifo(false)
+{
+    /* NOP */
+}
+
+struct internal_thread_t{
+    std::string name;
+    std::string role;
+    native_thread_t thread;
+    size_t os_id;
+};
+
+class thread_registry_type{
+public:
+    thread_registry_type(void): _next_key(0){
+        //the CPUs that are online and not isolated, when any are isolated
+        const std::vector<size_t> isolated = uhd::get_isolated_cpus();
+        if (isolated.empty()) return;
+        BOOST_FOREACH(const size_t cpu, read_sysfs_cpu_list("online")){
+            if (std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()){
+                _housekeeping_cpus.push_back(cpu);
+            }
+        }
+    }
+
+    size_t add(const std::string &name, const std::string &role){
+        boost::mutex::scoped_lock lock(_mutex);
+        internal_thread_t thread;
+        thread.name = name;
+        thread.role = role;
+        thread.thread = open_current_thread();
+        thread.os_id = get_os_thread_id();
+        const size_t key = _next_key++;
+        _threads[key] = thread;
+        apply(thread);
+        return key;
+    }
+
+    void remove(const size_t key){
+        boost::mutex::scoped_lock lock(_mutex);
+        std::map<size_t, internal_thread_t>::iterator it = _threads.find(key);
+        if (it == _threads.end()) return;
+        close_thread(it->second.thread);
+        _threads.erase(it);
+    }
+
+    void set_config(const std::string &role, const uhd::thread_config_t &config){
+        boost::mutex::scoped_lock lock(_mutex);
+        _configs[role] = config;
+        typedef std::map<size_t, internal_thread_t>::value_type thread_pair_t;
+        BOOST_FOREACH(const thread_pair_t &thread, _threads){
+            if (role.empty() or thread.second.role == role) apply(thread.second);
+        }
+    }
+
+    bool get_config(const std::string &role, uhd::thread_config_t &config){
+        boost::mutex::scoped_lock lock(_mutex);
+        std::map<std::string, uhd::thread_config_t>::const_iterator it = find_config(role);
+        if (it == _configs.end()) return false;
+        config = it->second;
+        return true;
+    }
+
+    std::vector<uhd::thread_info_t> get_threads(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        std::vector<uhd::thread_info_t> infos;
+        typedef std::map<size_t, internal_thread_t>::value_type thread_pair_t;
+        BOOST_FOREACH(const thread_pair_t &thread, _threads){
+            uhd::thread_info_t info;
+            info.name = thread.second.name;
+            info.role = thread.second.role;
+            info.os_id = thread.second.os_id;
+            info.cpus = get_native_affinity(thread.second.thread);
+            infos.push_back(info);
+        }
+        return infos;
+    }
+
+private:
+    std::map<std::string, uhd::thread_config_t>::const_iterator find_config(const std::string &role){
+        std::map<std::string, uhd::thread_config_t>::const_iterator it = _configs.find(role);
+        return (it == _configs.end())? _configs.find("") : it;
+    }
+
+    //! apply the configuration of its role, or the default, to a thread
+    void apply(const internal_thread_t &thread){
+        std::map<std::string, uhd::thread_config_t>::const_iterator it = find_config(thread.role);
+        if (it == _configs.end()){
+            //without a configuration, stay off the isolated CPUs
+            if (_housekeeping_cpus.empty()) return;
+            try{
+                set_native_affinity(thread.thread, _housekeeping_cpus);
+            }
+            catch(const std::exception &){
+                //the inherited affinity stays
+            }
+            return;
+        }
+        const uhd::thread_config_t &config = it->second;
+        if (not config.cpus.empty()){
+            try{
+                set_native_affinity(thread.thread, config.cpus);
+            }
+            catch(const std::exception &e){
+                UHD_MSG(warning) << boost::format(
+                    "Unable to set the CPU affinity of the %s thread.\n%s\n"
+                ) % thread.name % e.what();
+            }
+        }
+        if (config.set_priority){
+            try{
+                set_native_priority(thread.thread, config.priority, config.realtime, config.fifo);
+            }
+            catch(const std::exception &e){
+                UHD_MSG(warning) << boost::format(
+                    "Unable to set the priority of the %s thread.\n"
+                    "Please see the general application notes in the manual for instructions.\n"
+                    "%s\n"
+                ) % thread.name % e.what();
+            }
+        }
+    }
+
+    boost::mutex _mutex;
+    size_t _next_key;
+    std::map<size_t, internal_thread_t> _threads;
+    std::map<std::string, uhd::thread_config_t> _configs;
+    std::vector<size_t> _housekeeping_cpus;
+};
+
+//never destroyed: threads of other singletons unregister at exit
+static thread_registry_type &thread_registry(void){
+    static thread_registry_type *registry = new thread_registry_type();
+    return *registry;
+}
+
+void uhd::set_thread_config(const std::string &role, const thread_config_t &config){
+    if (config.set_priority) check_priority_range(config.priority);
+    thread_registry().set_config(role, config);
+}
+
+void uhd::set_thread_config(const device_addr_t &args){
+    static const char *roles[] = {"", "rx", "tx", "async", "transport", "other"};
+    BOOST_FOREACH(const std::string role, roles){
+        const std::string prefix = role.empty()? "thread_" : role + "_thread_";
+        if (not args.has_key(prefix + "cpu")
+            and not args.has_key(prefix + "priority")
+            and not args.has_key(prefix + "policy")
+        ) continue;
+
+        thread_config_t config;
+        try{
+            config.cpus = parse_cpu_list(args.get(prefix + "cpu", ""));
+        }
+        catch(const boost::bad_lexical_cast &){
+            throw uhd::value_error("invalid CPU list " + prefix + "cpu=" + args[prefix + "cpu"]);
+        }
+        if (args.has_key(prefix + "priority") or args.has_key(prefix + "policy")){
+            config.set_priority = true;
+            config.priority = args.cast<float>(prefix + "priority", default_thread_priority);
+            const std::string policy = args.get(prefix + "policy", "rr");
+            if (policy == "other") config.realtime = false;
+            else if (policy == "fifo") config.fifo = true;
+            else if (policy != "rr") throw uhd::value_error(
+                "invalid " + prefix + "policy=" + policy + ", use other, rr or fifo"
+            );
+        }
+        set_thread_config(role, config);
+    }
+}
+
+bool uhd::get_thread_config(const std::string &role, thread_config_t &config){
+    return thread_registry().get_config(role, config);
+}
+
+std::vector<uhd::thread_info_t> uhd::get_internal_threads(void){
+    return thread_registry().get_threads();
+}
+
+uhd::scoped_internal_thread::scoped_internal_thread(const std::string &name, const std::string &role):
+    _key(thread_registry().add(name, role))
+{
+    /* NOP */
+}
+
+uhd::scoped_internal_thread::~scoped_internal_thread(void){
+    thread_registry().remove(_key);
+}
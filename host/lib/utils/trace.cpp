@@ -0,0 +1,208 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/trace.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/atomic.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_TRACE_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_TRACE_TSC
+#endif
+
+using namespace uhd;
+
+namespace {
+
+    //! Limits the memory of the trace: spans per thread until reset()
+    static const size_t MAX_SPANS_PER_THREAD = 1 << 16;
+
+    //! The time stamp counter, or nanoseconds of system time without one
+    UHD_INLINE boost::uint64_t get_ticks(void){
+    #ifdef HAVE_TRACE_TSC
+        return __rdtsc();
+    #else
+        return boost::uint64_t(time_spec_t::get_system_time().to_ticks(1e9));
+    #endif
+    }
+
+    struct span_t{
+        const char *name;
+        boost::uint64_t start;
+        boost::uint64_t stop;
+    };
+
+    /*!
+     * The spans of one thread. Only the thread writes them, and publishes
+     * each with the count, so to_chrome_trace() can read them at any time.
+     * reset() asks the thread to start over on its next span.
+     */
+    struct thread_buffer_t{
+        thread_buffer_t(const size_t tid):
+            tid(tid), spans(MAX_SPANS_PER_THREAD), count(0), rewind(false)
+        {
+            /* NOP */
+        }
+
+        const size_t tid;
+        std::vector<span_t> spans;
+        boost::atomic<size_t> count;
+        boost::atomic<bool> rewind;
+    };
+
+    typedef boost::shared_ptr<thread_buffer_t> thread_buffer_sptr;
+
+    //! Owned by the thread local storage: the trace keeps the buffer
+    struct thread_buffer_holder_t{
+        thread_buffer_sptr buffer;
+    };
+
+    std::string json_escape(const std::string &str){
+        std::string escaped;
+        BOOST_FOREACH(const char ch, str){
+            if (ch == '"' or ch == '\\') escaped += '\\';
+            escaped += ch;
+        }
+        return escaped;
+    }
+
+    struct tracer_t{
+        tracer_t(void):
+            start_ticks(get_ticks()),
+            start_time(time_spec_t::get_system_time())
+        {
+            /* NOP */
+        }
+
+        ~tracer_t(void){
+            const char *trace_file = std::getenv("UHD_TRACE_FILE");
+            if (trace_file == NULL or buffers.empty()) return;
+            std::ofstream out(trace_file);
+            out << to_chrome_trace();
+        }
+
+        thread_buffer_t &get_buffer(void){
+            thread_buffer_holder_t *holder = local_buffer.get();
+            if (holder == NULL){
+                holder = new thread_buffer_holder_t();
+                local_buffer.reset(holder);
+                boost::mutex::scoped_lock lock(mutex);
+                holder->buffer = boost::make_shared<thread_buffer_t>(buffers.size());
+                buffers.push_back(holder->buffer);
+            }
+            return *holder->buffer;
+        }
+
+        //! Microseconds from the start of the trace, from the rate of the ticks so far
+        std::string to_chrome_trace(void){
+            boost::mutex::scoped_lock lock(mutex);
+            const double secs = (time_spec_t::get_system_time() - start_time).get_real_secs();
+            const double ticks = double(get_ticks() - start_ticks);
+            const double usecs_per_tick = (ticks > 0.0)? secs*1e6/ticks : 0.0;
+
+            std::ostringstream json;
+            json << "{\"traceEvents\":[";
+            bool first = true;
+            BOOST_FOREACH(const thread_buffer_sptr &buffer, buffers){
+                const size_t count = buffer->count.load(boost::memory_order_acquire);
+                for (size_t i = 0; i < count; i++){
+                    const span_t &span = buffer->spans[i];
+                    if (span.start < start_ticks) continue; //before reset()
+                    if (not first) json << ",";
+                    first = false;
+                    json << boost::format(
+                        "\n{\"name\":\"%s\",\"cat\":\"uhd\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}")
+                        % json_escape(span.name)
+                        % (double(span.start - start_ticks)*usecs_per_tick)
+                        % (double(span.stop - span.start)*usecs_per_tick)
+                        % buffer->tid;
+                }
+            }
+            json << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+            return json.str();
+        }
+
+        //the start of the trace, changed by reset() under the mutex
+        boost::uint64_t start_ticks;
+        time_spec_t start_time;
+        boost::thread_specific_ptr<thread_buffer_holder_t> local_buffer;
+        boost::mutex mutex;
+        std::vector<thread_buffer_sptr> buffers;
+    };
+
+    UHD_SINGLETON_FCN(tracer_t, get_tracer);
+
+} //namespace /*anon*/
+
+bool trace::enabled(void){
+#ifdef UHD_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void trace::reset(void){
+    tracer_t &tracer = get_tracer();
+    boost::mutex::scoped_lock lock(tracer.mutex);
+    BOOST_FOREACH(const thread_buffer_sptr &buffer, tracer.buffers){
+        buffer->rewind.store(true, boost::memory_order_relaxed);
+    }
+    //spans recorded before the reset, but not rewound yet, are skipped
+    tracer.start_ticks = get_ticks();
+    tracer.start_time = time_spec_t::get_system_time();
+}
+
+std::string trace::to_chrome_trace(void){
+    return get_tracer().to_chrome_trace();
+}
+
+trace::scoped_span::scoped_span(const char *name):
+    _name(name), _start(get_ticks())
+{
+    /* NOP */
+}
+
+trace::scoped_span::~scoped_span(void){
+    const boost::uint64_t stop = get_ticks();
+    thread_buffer_t &buffer = get_tracer().get_buffer();
+    if (buffer.rewind.load(boost::memory_order_relaxed)){
+        buffer.rewind.store(false, boost::memory_order_relaxed);
+        buffer.count.store(0, boost::memory_order_release);
+    }
+    const size_t count = buffer.count.load(boost::memory_order_relaxed);
+    if (count == buffer.spans.size()) return;
+    span_t &span = buffer.spans[count];
+    span.name = _name;
+    span.start = _start;
+    span.stop = stop;
+    buffer.count.store(count + 1, boost::memory_order_release);
+}
@@ -0,0 +1,242 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_nco.hpp"
+#include <uhd/waveform_source.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace uhd;
+
+static const size_t WAVE_BLOCK_SIZE = 1024; //samples per kernel call
+static const double TWO_TO_THE_64 = 18446744073709551616.0;
+
+waveform_source::~waveform_source(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * One tone or chirp
+ **********************************************************************/
+struct wave_component_t
+{
+    wave_component_t(void):
+        phase(0), incr(0), start_incr(0), incr_step(0),
+        chirp_len(0), chirp_pos(0), ampl(0.0f)
+    {}
+
+    uint64_t phase; //1 << 64 is a full turn
+    uint64_t incr; //the phase step of the next sample
+    uint64_t start_incr; //chirp: incr at the start of a period
+    uint64_t incr_step; //chirp: added to incr each sample, modulo 2^64
+    size_t chirp_len; //chirp: samples per period, 0 for a tone
+    size_t chirp_pos;
+    float ampl;
+};
+
+/***********************************************************************
+ * Implementation
+ **********************************************************************/
+class waveform_source_impl : public waveform_source
+{
+public:
+    waveform_source_impl(const double samp_rate):
+        _samp_rate(samp_rate),
+        _kernel(convert::get_nco_kernel()),
+        _phases(WAVE_BLOCK_SIZE),
+        _scratch(WAVE_BLOCK_SIZE)
+    {
+        if (samp_rate <= 0.0) {
+            throw uhd::value_error("waveform_source: the sample rate must be positive");
+        }
+    }
+
+    size_t add_tone(const double freq, const double ampl, const double phase)
+    {
+        wave_component_t comp;
+        static const double pi = std::acos(-1.0);
+        comp.phase = to_phase(phase/(2*pi));
+        comp.incr = to_phase(freq/_samp_rate);
+        comp.ampl = float(ampl);
+        _comps.push_back(comp);
+        return _comps.size() - 1;
+    }
+
+    size_t add_chirp(
+        const double start_freq,
+        const double stop_freq,
+        const double period,
+        const double ampl
+    ){
+        const double len = std::floor(period*_samp_rate + 0.5);
+        if (len < 2) {
+            throw uhd::value_error(str(boost::format(
+                "waveform_source: a chirp period of %g s is less than 2 samples") % period));
+        }
+        wave_component_t comp;
+        comp.start_incr = to_phase(start_freq/_samp_rate);
+        comp.incr = comp.start_incr;
+        comp.incr_step = to_phase((stop_freq - start_freq)/_samp_rate/len);
+        comp.chirp_len = size_t(len);
+        comp.ampl = float(ampl);
+        _comps.push_back(comp);
+        return _comps.size() - 1;
+    }
+
+    void set_freq(const size_t index, const double freq)
+    {
+        if (index >= _comps.size() or _comps[index].chirp_len != 0) {
+            throw uhd::index_error(str(boost::format(
+                "waveform_source: there is no tone %u") % index));
+        }
+        _comps[index].incr = to_phase(freq/_samp_rate);
+    }
+
+    void set_ampl(const size_t index, const double ampl)
+    {
+        if (index >= _comps.size()) {
+            throw uhd::index_error(str(boost::format(
+                "waveform_source: there is no tone or chirp %u") % index));
+        }
+        _comps[index].ampl = float(ampl);
+    }
+
+    size_t get_num_components(void) const
+    {
+        return _comps.size();
+    }
+
+    void clear(void)
+    {
+        _comps.clear();
+    }
+
+    void generate(std::complex<float> *buff, const size_t nsamps)
+    {
+        float *out = reinterpret_cast<float *>(buff);
+        std::memset(out, 0, nsamps*sizeof(std::complex<float>));
+        for (size_t i = 0; i < nsamps; i += WAVE_BLOCK_SIZE) {
+            const size_t n = std::min(WAVE_BLOCK_SIZE, nsamps - i);
+            for (size_t c = 0; c < _comps.size(); c++) {
+                this->fill_phases(_comps[c], n);
+                _kernel(&_phases.front(), out + 2*i, n, _comps[c].ampl);
+            }
+        }
+    }
+
+    void generate(std::complex<int16_t> *buff, const size_t nsamps)
+    {
+        for (size_t i = 0; i < nsamps; i += WAVE_BLOCK_SIZE) {
+            const size_t n = std::min(WAVE_BLOCK_SIZE, nsamps - i);
+            this->generate(&_scratch.front(), n);
+            for (size_t k = 0; k < n; k++) {
+                buff[i+k] = std::complex<int16_t>(
+                    to_sc16(_scratch[k].real()), to_sc16(_scratch[k].imag()));
+            }
+        }
+    }
+
+    void generate(const tx_streamer::zero_copy_buffs_t &buffs, const size_t nsamps)
+    {
+        if (nsamps > buffs.nsamps) {
+            throw uhd::value_error(str(boost::format(
+                "waveform_source: %u samples do not fit in a send buffer of %u")
+                % nsamps % buffs.nsamps));
+        }
+        if (not _conv or buffs.item_format != _conv_format) {
+            convert::id_type id;
+            id.input_format = "fc32";
+            id.num_inputs = 1;
+            id.output_format = buffs.item_format;
+            id.num_outputs = 1;
+            _conv = convert::get_converter(id)();
+            _conv->set_scalar(32767.);
+            _conv_format = buffs.item_format;
+        }
+        const size_t bpi = convert::get_bytes_per_item(buffs.item_format);
+        for (size_t i = 0; i < nsamps; i += WAVE_BLOCK_SIZE) {
+            const size_t n = std::min(WAVE_BLOCK_SIZE, nsamps - i);
+            this->generate(&_scratch.front(), n);
+            const void *in = &_scratch.front();
+            for (size_t ch = 0; ch < buffs.buffs.size(); ch++) {
+                void *out = static_cast<char *>(buffs.buffs[ch]) + i*bpi;
+                _conv->conv(in, out, n);
+            }
+        }
+    }
+
+private:
+    //! Turns (full circles) to the 64-bit phase, modulo one turn
+    static uint64_t to_phase(const double turns)
+    {
+        const double phase = std::ldexp(turns - std::floor(turns), 64);
+        return (phase < TWO_TO_THE_64)? uint64_t(phase) : 0;
+    }
+
+    static int16_t to_sc16(const float x)
+    {
+        const float v = x*32767.f;
+        if (v >= 32767.f) return 32767;
+        if (v <= -32768.f) return -32768;
+        return int16_t(v < 0? v - 0.5f : v + 0.5f);
+    }
+
+    //! The upper 32 bits of the next n phases of a component
+    void fill_phases(wave_component_t &comp, const size_t n)
+    {
+        uint32_t *phases = &_phases.front();
+        uint64_t phase = comp.phase;
+        if (comp.chirp_len == 0) {
+            const uint64_t incr = comp.incr;
+            for (size_t k = 0; k < n; k++) {
+                phases[k] = uint32_t(phase >> 32);
+                phase += incr;
+            }
+        } else {
+            for (size_t k = 0; k < n; k++) {
+                phases[k] = uint32_t(phase >> 32);
+                phase += comp.incr;
+                comp.incr += comp.incr_step;
+                if (++comp.chirp_pos == comp.chirp_len) {
+                    comp.chirp_pos = 0;
+                    comp.incr = comp.start_incr;
+                }
+            }
+        }
+        comp.phase = phase;
+    }
+
+    const double _samp_rate;
+    const convert::nco_kernel_t _kernel;
+    std::vector<wave_component_t> _comps;
+    std::vector<uint32_t> _phases;
+    std::vector<std::complex<float> > _scratch;
+    convert::converter::sptr _conv;
+    std::string _conv_format;
+};
+
+waveform_source::sptr waveform_source::make(const double samp_rate)
+{
+    return sptr(new waveform_source_impl(samp_rate));
+}
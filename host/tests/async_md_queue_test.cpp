@@ -0,0 +1,82 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../lib/transport/async_md_queue.hpp"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static async_metadata_t make_event(
+    const async_metadata_t::event_code_t event_code, const double time, const size_t channel = 0
+){
+    async_metadata_t metadata;
+    metadata.channel = channel;
+    metadata.has_time_spec = true;
+    metadata.time_spec = time_spec_t(time);
+    metadata.event_code = event_code;
+    return metadata;
+}
+
+BOOST_AUTO_TEST_CASE(test_async_md_queue_merges_repeated_errors){
+    async_md_queue queue(100);
+    for (size_t i = 0; i < 50; i++) {
+        queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_UNDERFLOW, 1.0 + i*0.001));
+    }
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_UNDERFLOW, 2.0, 1));
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_BURST_ACK, 3.0));
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_BURST_ACK, 3.1));
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_UNDERFLOW, 4.0));
+
+    std::vector<async_metadata_t> msgs;
+    BOOST_REQUIRE_EQUAL(queue.pop_all_with_timed_wait(msgs, 100, 0.0), size_t(5));
+    BOOST_CHECK_EQUAL(msgs[0].num_events, size_t(50));
+    BOOST_CHECK_CLOSE(msgs[0].time_spec.get_real_secs(), 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(msgs[0].last_time_spec.get_real_secs(), 1.049, 1e-9);
+    //another channel, burst ACKs and an error after them stay apart
+    BOOST_CHECK_EQUAL(msgs[1].channel, size_t(1));
+    BOOST_CHECK_EQUAL(msgs[2].num_events, size_t(1));
+    BOOST_CHECK_EQUAL(msgs[3].num_events, size_t(1));
+    BOOST_CHECK_EQUAL(msgs[4].num_events, size_t(1));
+    BOOST_CHECK_CLOSE(msgs[4].last_time_spec.get_real_secs(), 4.0, 1e-9);
+
+    //a message that was received is not merged into
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_SEQ_ERROR, 5.0));
+    async_metadata_t metadata;
+    BOOST_CHECK(queue.pop_with_timed_wait(metadata, 0.0));
+    queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_SEQ_ERROR, 5.1));
+    BOOST_CHECK(queue.pop_with_timed_wait(metadata, 0.0));
+    BOOST_CHECK_EQUAL(metadata.num_events, size_t(1));
+    BOOST_CHECK(not queue.pop_with_timed_wait(metadata, 0.01));
+}
+
+BOOST_AUTO_TEST_CASE(test_async_md_queue_batches){
+    async_md_queue queue(4);
+    for (size_t i = 0; i < 6; i++) {
+        queue.push_with_pop_on_full(make_event(async_metadata_t::EVENT_CODE_BURST_ACK, double(i)));
+    }
+
+    //the oldest messages were dropped
+    std::vector<async_metadata_t> msgs;
+    BOOST_REQUIRE_EQUAL(queue.pop_all_with_timed_wait(msgs, 3, 0.0), size_t(3));
+    BOOST_CHECK_CLOSE(msgs[0].time_spec.get_real_secs(), 2.0, 1e-9);
+    BOOST_REQUIRE_EQUAL(queue.pop_all_with_timed_wait(msgs, 3, 0.0), size_t(1));
+    BOOST_CHECK_CLOSE(msgs[0].time_spec.get_real_secs(), 5.0, 1e-9);
+    BOOST_CHECK_EQUAL(queue.pop_all_with_timed_wait(msgs, 3, 0.01), size_t(0));
+    BOOST_CHECK(msgs.empty());
+}
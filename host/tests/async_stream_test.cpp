@@ -0,0 +1,262 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include <uhd/async_stream.hpp>
+#include <uhd/exception.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+/***********************************************************************
+ * Streamers that number their calls, and throw or take time on request
+ **********************************************************************/
+class dummy_rx_streamer : public uhd::rx_streamer
+{
+public:
+    dummy_rx_streamer(void): throw_on_call(size_t(-1)), _num_calls(0) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return 1; }
+
+    //! Writes the call number to the first sample
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const double,
+        const bool
+    ){
+        metadata.reset();
+        const size_t call = _num_calls++;
+        if (call == throw_on_call) throw uhd::io_error("dummy recv failure");
+        static_cast<size_t *>(buffs[0])[0] = call;
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+        return nsamps_per_buff;
+    }
+
+    void issue_stream_cmd(const uhd::stream_cmd_t &) {}
+
+    size_t throw_on_call;
+
+private:
+    size_t _num_calls;
+};
+
+class dummy_tx_streamer : public uhd::tx_streamer
+{
+public:
+    dummy_tx_streamer(const double delay = 0.0): throw_on_call(size_t(-1)), _delay(delay) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return 1; }
+
+    size_t send(
+        const buffs_type &,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const double
+    ){
+        if (_delay > 0.0) boost::this_thread::sleep(boost::posix_time::microseconds(long(_delay*1e6)));
+        const size_t call = sent.size();
+        sent.push_back(metadata);
+        if (call == throw_on_call) throw uhd::io_error("dummy send failure");
+        return nsamps_per_buff;
+    }
+
+    bool recv_async_msg(uhd::async_metadata_t &, double) { return false; }
+
+    size_t throw_on_call;
+    std::vector<uhd::tx_metadata_t> sent;
+
+private:
+    const double _delay;
+};
+
+/***********************************************************************
+ * Completion records
+ **********************************************************************/
+struct rx_completion_t
+{
+    size_t nsamps;
+    uhd::rx_metadata_t::error_code_t error_code;
+    boost::thread::id thread;
+};
+
+struct completions_t
+{
+    completions_t(void): count(0) {}
+    boost::atomic<size_t> count;
+    std::vector<rx_completion_t> rx;
+    std::vector<size_t> tx;
+
+    //! Wait until n handlers were called, at most a second
+    bool wait_for(const size_t n)
+    {
+        for (size_t i = 0; i < 1000 and count < n; i++) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+        return count >= n;
+    }
+};
+
+static void rx_handler(completions_t &c, const size_t nsamps, const uhd::rx_metadata_t &md)
+{
+    rx_completion_t completion;
+    completion.nsamps = nsamps;
+    completion.error_code = md.error_code;
+    completion.thread = boost::this_thread::get_id();
+    c.rx.push_back(completion);
+    c.count++;
+}
+
+static void tx_handler(completions_t &c, const size_t nsamps_sent)
+{
+    c.tx.push_back(nsamps_sent);
+    c.count++;
+}
+
+static void count_notify(boost::atomic<size_t> &num_notified)
+{
+    num_notified++;
+}
+
+/***********************************************************************
+ * Tests
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_async_recv_order){
+    boost::shared_ptr<dummy_rx_streamer> streamer = boost::make_shared<dummy_rx_streamer>();
+    uhd::async_rx_streamer::sptr async = uhd::async_rx_streamer::make(streamer);
+    completions_t c;
+
+    // Requests complete in the order they were queued, on the worker thread
+    std::vector<size_t> samps(4, size_t(-1));
+    for (size_t i = 0; i < samps.size(); i++) {
+        async->async_recv(std::vector<void *>(1, &samps[i]), 1,
+            boost::bind(&rx_handler, boost::ref(c), _1, _2));
+    }
+    BOOST_REQUIRE(c.wait_for(samps.size()));
+    for (size_t i = 0; i < samps.size(); i++) {
+        BOOST_CHECK_EQUAL(samps[i], i);
+        BOOST_CHECK_EQUAL(c.rx[i].nsamps, 1u);
+        BOOST_CHECK_EQUAL(c.rx[i].error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(c.rx[i].thread != boost::this_thread::get_id());
+    }
+    BOOST_CHECK_EQUAL(async->poll(), 0u);
+
+    BOOST_CHECK_THROW(
+        async->async_recv(std::vector<void *>(), 1, boost::bind(&rx_handler, boost::ref(c), _1, _2)),
+        uhd::value_error
+    );
+}
+
+BOOST_AUTO_TEST_CASE(test_async_recv_poll){
+    boost::shared_ptr<dummy_rx_streamer> streamer = boost::make_shared<dummy_rx_streamer>();
+    boost::atomic<size_t> num_notified(0);
+    uhd::async_rx_streamer::sptr async = uhd::async_rx_streamer::make(
+        streamer, boost::bind(&count_notify, boost::ref(num_notified)));
+    completions_t c;
+
+    std::vector<size_t> samps(3, size_t(-1));
+    for (size_t i = 0; i < samps.size(); i++) {
+        async->async_recv(std::vector<void *>(1, &samps[i]), 1,
+            boost::bind(&rx_handler, boost::ref(c), _1, _2));
+    }
+
+    // Handlers only run in poll(), on the calling thread and in order
+    for (size_t i = 0; i < 1000 and c.count < samps.size(); i++) {
+        if (num_notified > 0) async->poll();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    BOOST_REQUIRE_EQUAL(c.rx.size(), samps.size());
+    BOOST_CHECK(num_notified >= 1u);
+    for (size_t i = 0; i < samps.size(); i++) {
+        BOOST_CHECK_EQUAL(samps[i], i);
+        BOOST_CHECK(c.rx[i].thread == boost::this_thread::get_id());
+    }
+    BOOST_CHECK_EQUAL(async->poll(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_async_recv_error){
+    boost::shared_ptr<dummy_rx_streamer> streamer = boost::make_shared<dummy_rx_streamer>();
+    streamer->throw_on_call = 1;
+    uhd::async_rx_streamer::sptr async = uhd::async_rx_streamer::make(streamer);
+    completions_t c;
+
+    // A failed recv completes as a bad packet, the next requests still run
+    std::vector<size_t> samps(3, size_t(-1));
+    for (size_t i = 0; i < samps.size(); i++) {
+        async->async_recv(std::vector<void *>(1, &samps[i]), 1,
+            boost::bind(&rx_handler, boost::ref(c), _1, _2));
+    }
+    BOOST_REQUIRE(c.wait_for(samps.size()));
+    BOOST_CHECK_EQUAL(c.rx[0].error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(c.rx[1].nsamps, 0u);
+    BOOST_CHECK_EQUAL(c.rx[1].error_code, uhd::rx_metadata_t::ERROR_CODE_BAD_PACKET);
+    BOOST_CHECK_EQUAL(c.rx[2].error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(samps[2], 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_async_send){
+    boost::shared_ptr<dummy_tx_streamer> streamer = boost::make_shared<dummy_tx_streamer>();
+    streamer->throw_on_call = 2;
+    uhd::async_tx_streamer::sptr async = uhd::async_tx_streamer::make(streamer);
+    completions_t c;
+
+    // Sends run in order with their own metadata, a failed send reports 0
+    const char samps[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < 4; i++) {
+        uhd::tx_metadata_t md;
+        md.has_time_spec = true;
+        md.time_spec = uhd::time_spec_t(double(i));
+        md.end_of_burst = (i == 3);
+        async->async_send(std::vector<const void *>(1, samps), i + 1, md,
+            boost::bind(&tx_handler, boost::ref(c), _1));
+    }
+    BOOST_REQUIRE(c.wait_for(4));
+    BOOST_REQUIRE_EQUAL(streamer->sent.size(), 4u);
+    for (size_t i = 0; i < 4; i++) {
+        BOOST_CHECK_EQUAL(streamer->sent[i].time_spec.get_real_secs(), double(i));
+        BOOST_CHECK_EQUAL(streamer->sent[i].end_of_burst, i == 3);
+    }
+    BOOST_CHECK_EQUAL(c.tx[0], 1u);
+    BOOST_CHECK_EQUAL(c.tx[1], 2u);
+    BOOST_CHECK_EQUAL(c.tx[2], 0u);
+    BOOST_CHECK_EQUAL(c.tx[3], 4u);
+}
+
+BOOST_AUTO_TEST_CASE(test_async_destroy_pending){
+    boost::shared_ptr<dummy_tx_streamer> streamer = boost::make_shared<dummy_tx_streamer>(0.01);
+    completions_t c;
+    const char samps[1] = {0};
+    const size_t num_requests = 100;
+    {
+        uhd::async_tx_streamer::sptr async = uhd::async_tx_streamer::make(streamer);
+        for (size_t i = 0; i < num_requests; i++) {
+            async->async_send(std::vector<const void *>(1, samps), 1, uhd::tx_metadata_t(),
+                boost::bind(&tx_handler, boost::ref(c), _1));
+        }
+        BOOST_REQUIRE(c.wait_for(1));
+    }
+
+    // Destruction stops the worker, the queued requests are dropped
+    const size_t num_completed = c.count;
+    BOOST_CHECK(num_completed < num_requests);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    BOOST_CHECK_EQUAL(size_t(c.count), num_completed);
+}
@@ -0,0 +1,74 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace uhd;
+
+BOOST_AUTO_TEST_CASE(test_simple_claimer){
+    simple_claimer claimer;
+    BOOST_CHECK(claimer.try_claim());
+    BOOST_CHECK(not claimer.try_claim());
+    BOOST_CHECK(not claimer.claim_with_wait(0.0));
+    BOOST_CHECK(not claimer.claim_with_wait(0.01));
+    claimer.release();
+    BOOST_CHECK(claimer.claim_with_wait(0.0));
+}
+
+static void release_later(simple_claimer *claimer){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    claimer->release();
+}
+
+BOOST_AUTO_TEST_CASE(test_simple_claimer_wakeup){
+    simple_claimer claimer;
+    BOOST_REQUIRE(claimer.try_claim());
+    boost::thread releaser(boost::bind(&release_later, &claimer));
+    const time_spec_t start = time_spec_t::get_system_time();
+    BOOST_CHECK(claimer.claim_with_wait(5.0));
+    BOOST_CHECK((time_spec_t::get_system_time() - start).get_real_secs() < 1.0);
+    releaser.join();
+}
+
+static void claim_many(simple_claimer *claimer, size_t *count, const size_t num){
+    for (size_t i = 0; i < num; i++){
+        BOOST_REQUIRE(claimer->claim_with_wait(5.0));
+        (*count)++; //protected by the claim
+        claimer->release();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_simple_claimer_contention){
+    static const size_t num_threads = 4, num_claims = 10000;
+    simple_claimer claimer(10);
+    size_t count = 0;
+    boost::thread_group threads;
+    for (size_t i = 0; i < num_threads; i++){
+        threads.create_thread(boost::bind(&claim_many, &claimer, &count, num_claims));
+    }
+    threads.join_all();
+    BOOST_CHECK_EQUAL(count, num_threads*num_claims);
+}
+
+BOOST_AUTO_TEST_CASE(test_spin_wait_with_timeout){
+    atomic_uint32_t cond;
+    BOOST_CHECK(spin_wait_with_timeout(cond, 0, 0.0));
+    BOOST_CHECK(not spin_wait_with_timeout(cond, 1, 0.01));
+}
@@ -115,3 +115,26 @@ BOOST_AUTO_TEST_CASE(test_block_id_cmp) {
     BOOST_CHECK(block_id_t("0/FFT_1") < block_id_t("1/aaaaaaaaa_0"));
     BOOST_CHECK(not (block_id_t("0/FFT_1") > block_id_t("1/aaaaaaaaa_0")));
 }
+
+BOOST_AUTO_TEST_CASE(test_block_id_parse) {
+    BOOST_CHECK(block_id_t::is_valid_block_id("FFT"));
+    BOOST_CHECK(block_id_t::is_valid_block_id("FFT_12"));
+    BOOST_CHECK(block_id_t::is_valid_block_id("123/FFT2"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id(""));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("0/"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("/FFT"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("FFT_"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("FFT_123"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("0/FFT_1 "));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("0FFT"));
+    BOOST_CHECK(not block_id_t::is_valid_block_id("99999999999999999999999/FFT"));
+    BOOST_CHECK(not block_id_t::is_valid_blockname(""));
+
+    // Names set in different ways compare equal
+    block_id_t block_id(0, "Radio", 0);
+    block_id.set("Radio_1");
+    BOOST_CHECK(block_id == block_id_t("0/Radio_1"));
+    block_id.set_block_name("DDC");
+    BOOST_CHECK(block_id == block_id_t(0, "DDC", 1));
+    BOOST_CHECK(block_id != block_id_t(0, "DUC", 1));
+}
@@ -17,7 +17,16 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/lockfree_bounded_buffer.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/transport/frame_pool.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/exception.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <vector>
 
 using namespace boost::assign;
 using namespace uhd::transport;
@@ -62,3 +71,245 @@ BOOST_AUTO_TEST_CASE(test_bounded_buffer_with_pop_on_full){
     BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
     BOOST_CHECK_EQUAL(val, 3);
 }
+
+template <typename buffer_type>
+static void check_lockfree_with_timed_wait(void){
+    buffer_type bb(3);
+
+    //push elements, check for timeout
+    BOOST_CHECK(bb.push_with_timed_wait(0, timeout));
+    BOOST_CHECK(bb.push_with_timed_wait(1, timeout));
+    BOOST_CHECK(bb.push_with_haste(2));
+    BOOST_CHECK(not bb.push_with_haste(3));
+    BOOST_CHECK(not bb.push_with_timed_wait(3, timeout));
+
+    int val;
+    //pop elements, check for timeout and check values
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 0);
+    BOOST_CHECK(bb.pop_with_haste(val));
+    BOOST_CHECK_EQUAL(val, 1);
+    BOOST_CHECK(bb.push_with_haste(3)); //wraps around
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 2);
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 3);
+    BOOST_CHECK(not bb.pop_with_haste(val));
+    BOOST_CHECK(not bb.pop_with_timed_wait(val, timeout));
+}
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_with_timed_wait){
+    check_lockfree_with_timed_wait<spsc_bounded_buffer<int> >();
+}
+
+BOOST_AUTO_TEST_CASE(test_mpmc_bounded_buffer_with_timed_wait){
+    check_lockfree_with_timed_wait<mpmc_bounded_buffer<int> >();
+}
+
+template <typename buffer_type>
+static void push_sequence(buffer_type *bb, const int first, const int num){
+    for (int i = first; i < first + num; i++) bb->push_with_wait(i);
+}
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_threaded){
+    static const int num_elems = 100000;
+    spsc_bounded_buffer<int> bb(16);
+    boost::thread producer(boost::bind(&push_sequence<spsc_bounded_buffer<int> >, &bb, 0, num_elems));
+
+    //the consumer must see every element, in order
+    int val;
+    for (int i = 0; i < num_elems; i++){
+        BOOST_REQUIRE(bb.pop_with_timed_wait(val, 1.0));
+        BOOST_REQUIRE_EQUAL(val, i);
+    }
+    producer.join();
+    BOOST_CHECK(not bb.pop_with_haste(val));
+}
+
+BOOST_AUTO_TEST_CASE(test_mpmc_bounded_buffer_threaded){
+    static const int num_elems = 50000;
+    static const int num_producers = 4;
+    mpmc_bounded_buffer<int> bb(16);
+    boost::thread_group producers;
+    for (int p = 0; p < num_producers; p++){
+        producers.create_thread(boost::bind(&push_sequence<mpmc_bounded_buffer<int> >, &bb, p*num_elems, num_elems));
+    }
+
+    //every element arrives exactly once
+    std::vector<int> seen(num_producers*num_elems, 0);
+    int val;
+    for (int i = 0; i < num_producers*num_elems; i++){
+        BOOST_REQUIRE(bb.pop_with_timed_wait(val, 1.0));
+        seen.at(val)++;
+    }
+    producers.join_all();
+    BOOST_CHECK(not bb.pop_with_haste(val));
+    BOOST_CHECK(std::count(seen.begin(), seen.end(), 1) == num_producers*num_elems);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_alloc_policy){
+    uhd::device_addr_t hints("buff_hugepages=2M,buff_numa_node=1,buff_mlock=1");
+    buffer_pool::alloc_policy_t policy = buffer_pool::alloc_policy_t::from_hints(hints);
+    BOOST_CHECK_EQUAL(policy.hugepage_size, size_t(2) << 20);
+    BOOST_CHECK_EQUAL(policy.numa_node, 1);
+    BOOST_CHECK(policy.lock);
+
+    policy = buffer_pool::alloc_policy_t::from_hints(uhd::device_addr_t("buff_hugepages=1g"));
+    BOOST_CHECK_EQUAL(policy.hugepage_size, size_t(1) << 30);
+    BOOST_CHECK_EQUAL(policy.numa_node, -1);
+    BOOST_CHECK(not policy.lock);
+
+    BOOST_CHECK_THROW(
+        buffer_pool::alloc_policy_t::from_hints(uhd::device_addr_t("buff_hugepages=big")),
+        uhd::value_error);
+
+    //the default policy gives aligned heap buffers
+    buffer_pool::sptr pool = buffer_pool::make(4, 1000, 64, buffer_pool::alloc_policy_t());
+    BOOST_REQUIRE_EQUAL(pool->size(), size_t(4));
+    for (size_t i = 0; i < pool->size(); i++){
+        BOOST_CHECK_EQUAL(size_t(pool->at(i)) % 64, size_t(0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_alloc_policy_forwarding){
+    //a device passes its data transports only their own keys, plus the policy
+    const uhd::device_addr_t args("addr=127.0.0.1,recv_frame_size=1472,buff_hugepages=2M,buff_mlock=1");
+    uhd::device_addr_t hints;
+    hints["recv_frame_size"] = args["recv_frame_size"];
+    buffer_pool::alloc_policy_t::forward_hints(args, hints);
+    BOOST_CHECK(not hints.has_key("addr"));
+    BOOST_CHECK(not hints.has_key("buff_numa_node"));
+    buffer_pool::alloc_policy_t policy = buffer_pool::alloc_policy_t::from_hints(hints);
+    BOOST_CHECK_EQUAL(policy.hugepage_size, size_t(2) << 20);
+    BOOST_CHECK(policy.lock);
+
+    //the transport reads the forwarded policy: an invalid one fails it
+    uhd::transport::zero_copy_xport_params default_buff_args;
+    default_buff_args.recv_frame_size = default_buff_args.send_frame_size = 1472;
+    default_buff_args.num_recv_frames = default_buff_args.num_send_frames = 4;
+    uhd::transport::udp_zero_copy::buff_params buff_params;
+    hints = uhd::device_addr_t();
+    buffer_pool::alloc_policy_t::forward_hints(uhd::device_addr_t("buff_hugepages=big"), hints);
+    BOOST_CHECK_THROW(
+        uhd::transport::udp_zero_copy::make("127.0.0.1", "49152", default_buff_args, buff_params, hints),
+        uhd::value_error);
+    hints = uhd::device_addr_t();
+    buffer_pool::alloc_policy_t::forward_hints(uhd::device_addr_t("buff_mlock=0"), hints);
+    BOOST_CHECK(uhd::transport::udp_zero_copy::make("127.0.0.1", "49152", default_buff_args, buff_params, hints));
+}
+
+static size_t user_mem_outstanding = 0;
+
+static void *user_alloc(size_t len){
+    user_mem_outstanding += len;
+    return new char[len];
+}
+
+static void user_free(void *mem, size_t len){
+    user_mem_outstanding -= len;
+    delete [] static_cast<char *>(mem);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_allocator){
+    buffer_pool::allocator_t allocator;
+    allocator.alloc = &user_alloc;
+    allocator.free = &user_free;
+    buffer_pool::set_allocator(allocator);
+
+    //the pool memory comes from the allocator, and goes back to it
+    buffer_pool::sptr pool = buffer_pool::make(4, 1000, 64);
+    BOOST_CHECK(user_mem_outstanding >= 4*1000);
+    for (size_t i = 0; i < pool->size(); i++){
+        BOOST_CHECK_EQUAL(size_t(pool->at(i)) % 64, size_t(0));
+    }
+    buffer_pool::set_allocator(buffer_pool::allocator_t());
+    pool.reset();
+    BOOST_CHECK_EQUAL(user_mem_outstanding, size_t(0));
+
+    //without an allocator, regular memory
+    pool = buffer_pool::make(4, 1000, 64);
+    BOOST_CHECK_EQUAL(user_mem_outstanding, size_t(0));
+
+    allocator.free.clear();
+    BOOST_CHECK_THROW(buffer_pool::set_allocator(allocator), uhd::value_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_frame_pool){
+    frame_pool::sptr pool = frame_pool::make(4, 1000);
+    BOOST_CHECK_EQUAL(pool->get_num_frames(), size_t(4));
+    BOOST_CHECK_EQUAL(pool->get_frame_size(), size_t(1000));
+
+    //take all frames, then the pool is empty
+    std::vector<void *> frames;
+    for (size_t i = 0; i < 4; i++){
+        frames.push_back(pool->alloc());
+        BOOST_REQUIRE(frames.back() != NULL);
+        BOOST_CHECK_EQUAL(size_t(frames.back()) % 16, size_t(0));
+    }
+    BOOST_CHECK_EQUAL(pool->get_num_free(), size_t(0));
+    BOOST_CHECK(pool->alloc() == NULL);
+    BOOST_CHECK(pool->alloc(timeout) == NULL);
+
+    //frames are distinct, and the last one given back goes out first
+    std::vector<void *> sorted(frames);
+    std::sort(sorted.begin(), sorted.end());
+    BOOST_CHECK(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+    pool->free(frames[1]);
+    pool->free(frames[2]);
+    BOOST_CHECK_EQUAL(pool->get_num_free(), size_t(2));
+    BOOST_CHECK(pool->alloc() == frames[2]);
+    BOOST_CHECK(pool->alloc() == frames[1]);
+
+    //only frames of the pool can be given back
+    char other[1000];
+    BOOST_CHECK_THROW(pool->free(other), uhd::value_error);
+    BOOST_CHECK_THROW(pool->free(static_cast<char *>(frames[0]) + 1), uhd::value_error);
+    BOOST_CHECK_THROW(frame_pool::make(0, 1000), uhd::value_error);
+}
+
+static void free_frame_later(frame_pool::sptr pool, void *frame){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    pool->free(frame);
+}
+
+BOOST_AUTO_TEST_CASE(test_frame_pool_wait){
+    frame_pool::sptr pool = frame_pool::make(1, 1000);
+    void *frame = pool->alloc();
+    BOOST_REQUIRE(frame != NULL);
+
+    //a waiting caller gets the frame given back by another thread
+    boost::thread freer(boost::bind(&free_frame_later, pool, frame));
+    BOOST_CHECK(pool->alloc(1.0) == frame);
+    freer.join();
+}
+
+static void take_and_give_back(frame_pool::sptr pool, const int num, bool *ok){
+    for (int i = 0; i < num; i++){
+        char *frame = static_cast<char *>(pool->alloc(1.0));
+        if (frame == NULL){
+            *ok = false;
+            return;
+        }
+        //nobody else may hold the frame meanwhile
+        std::fill(frame, frame + pool->get_frame_size(), char(i));
+        if (std::count(frame, frame + pool->get_frame_size(), char(i)) != std::ptrdiff_t(pool->get_frame_size())){
+            *ok = false;
+        }
+        pool->free(frame);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_frame_pool_threaded){
+    static const int num_frames = 20000;
+    static const int num_threads = 4;
+    frame_pool::sptr pool = frame_pool::make(3, 64);
+    bool ok[num_threads];
+    boost::thread_group threads;
+    for (int t = 0; t < num_threads; t++){
+        ok[t] = true;
+        threads.create_thread(boost::bind(&take_and_give_back, pool, num_frames, &ok[t]));
+    }
+    threads.join_all();
+    BOOST_CHECK(std::count(ok, ok + num_threads, true) == num_threads);
+    BOOST_CHECK_EQUAL(pool->get_num_free(), size_t(3));
+}
@@ -0,0 +1,163 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/capture_file.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <vector>
+
+using namespace uhd;
+namespace fs = boost::filesystem;
+
+static const double RATE = 1e6;
+static const size_t SPB = 100;
+static const size_t NUM_BLOCKS = 200;
+static const size_t OVERFLOW_BLOCK = 120; //an overflow, then 1000 samples lost
+
+static time_spec_t block_time(const size_t i)
+{
+    const long long ticks = (long long)(i*SPB + ((i >= OVERFLOW_BLOCK) ? 1000 : 0));
+    return time_spec_t(10.0) + time_spec_t::from_ticks(ticks, RATE);
+}
+
+//! sc16 samples, each one its sample index and channel
+static uint32_t sample_value(const size_t chan, const size_t index)
+{
+    return uint32_t(chan << 24 | index);
+}
+
+static void write_capture(const fs::path &path)
+{
+    capture_file_info_t info;
+    info.cpu_format = "sc16";
+    info.num_chans = 2;
+    info.samp_rate = RATE;
+    info.settings["freq"] = "2.4e9";
+    info.settings["gain"] = "30";
+    capture_file_writer::sptr writer = capture_file_writer::make(path.string(), info, 16*1024, 1024*1024, false);
+
+    rx_metadata_t md;
+    for (size_t i = 0; i < NUM_BLOCKS; i++) {
+        if (i == OVERFLOW_BLOCK) {
+            writer->get_write_space(SPB);
+            md.reset();
+            md.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+            writer->commit(0, md);
+        }
+        //timeouts are not recorded
+        writer->get_write_space(SPB);
+        md.reset();
+        md.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+        writer->commit(0, md);
+
+        md.reset();
+        md.has_time_spec = true;
+        md.time_spec = block_time(i);
+        md.start_of_burst = (i == 0);
+        std::vector<uint32_t> chan0(SPB), chan1(SPB);
+        for (size_t j = 0; j < SPB; j++) {
+            chan0[j] = sample_value(0, i*SPB + j);
+            chan1[j] = sample_value(1, i*SPB + j);
+        }
+        if (i % 2) {
+            const std::vector<void *> &buffs = writer->get_write_space(SPB);
+            std::memcpy(buffs[0], &chan0.front(), SPB*4);
+            std::memcpy(buffs[1], &chan1.front(), SPB*4);
+            writer->commit(SPB, md);
+        } else {
+            std::vector<const void *> buffs;
+            buffs.push_back(&chan0.front());
+            buffs.push_back(&chan1.front());
+            writer->write(buffs, SPB, md);
+        }
+    }
+    writer->close();
+    BOOST_CHECK(writer->get_stats().bytes > NUM_BLOCKS*SPB*8);
+}
+
+static void check_capture(capture_file_reader::sptr reader)
+{
+    BOOST_CHECK_EQUAL(reader->get_info().cpu_format, "sc16");
+    BOOST_CHECK_EQUAL(reader->get_info().num_chans, size_t(2));
+    BOOST_CHECK_EQUAL(reader->get_info().samp_rate, RATE);
+    BOOST_CHECK_EQUAL(reader->get_info().settings["gain"], "30");
+
+    //the blocks come back in order, with the overflow and the gap marked
+    capture_file_reader::block_t block;
+    size_t num_blocks = 0, num_errors = 0;
+    while (reader->next(block)) {
+        if (block.flags & capture_file_reader::FLAG_ERROR) {
+            BOOST_CHECK_EQUAL(block.error_code, rx_metadata_t::ERROR_CODE_OVERFLOW);
+            BOOST_CHECK_EQUAL(block.nsamps, size_t(0));
+            BOOST_CHECK_EQUAL(num_blocks, OVERFLOW_BLOCK);
+            num_errors++;
+            continue;
+        }
+        BOOST_REQUIRE_EQUAL(block.nsamps, SPB);
+        BOOST_CHECK_EQUAL(block.sample_index, num_blocks*SPB);
+        BOOST_CHECK(block.time_spec == block_time(num_blocks));
+        BOOST_CHECK_EQUAL(bool(block.flags & capture_file_reader::FLAG_GAP), num_blocks == OVERFLOW_BLOCK);
+        BOOST_CHECK_EQUAL(bool(block.flags & capture_file_reader::FLAG_SOB), num_blocks == 0);
+        const uint32_t *chan1 = static_cast<const uint32_t *>(block.buffs[1]);
+        BOOST_CHECK_EQUAL(chan1[SPB - 1], sample_value(1, num_blocks*SPB + SPB - 1));
+        num_blocks++;
+    }
+    BOOST_CHECK_EQUAL(num_errors, size_t(1));
+
+    //seek into a block, into the gap, before the start and past the end
+    BOOST_REQUIRE(reader->seek(block_time(77) + time_spec_t(50/RATE)));
+    BOOST_REQUIRE(reader->next(block));
+    BOOST_CHECK_EQUAL(block.sample_index, 77*SPB);
+    BOOST_REQUIRE(reader->seek(block_time(OVERFLOW_BLOCK) - time_spec_t(500/RATE)));
+    BOOST_REQUIRE(reader->next(block));
+    BOOST_CHECK_EQUAL(block.error_code, rx_metadata_t::ERROR_CODE_OVERFLOW);
+    BOOST_REQUIRE(reader->next(block));
+    BOOST_CHECK_EQUAL(block.sample_index, OVERFLOW_BLOCK*SPB);
+    BOOST_REQUIRE(reader->seek(time_spec_t(1.0)));
+    BOOST_REQUIRE(reader->next(block));
+    BOOST_CHECK_EQUAL(block.sample_index, size_t(0));
+    BOOST_CHECK(not reader->seek(block_time(NUM_BLOCKS)));
+    BOOST_CHECK(not reader->next(block));
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_file){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("capture_file_test_%%%%%%%%.dat");
+    write_capture(path);
+    {
+        capture_file_reader::sptr reader = capture_file_reader::make(path.string());
+        BOOST_CHECK(reader->has_index());
+        check_capture(reader);
+    }
+
+    //cut short in the last block: the index is rebuilt without that block
+    fs::resize_file(path, fs::file_size(path) - 64);
+    {
+        capture_file_reader::sptr reader = capture_file_reader::make(path.string());
+        BOOST_CHECK(not reader->has_index());
+        capture_file_reader::block_t block;
+        size_t num_blocks = 0;
+        while (reader->next(block)) num_blocks++;
+        BOOST_CHECK_EQUAL(num_blocks, NUM_BLOCKS + 1);
+        BOOST_REQUIRE(reader->seek(block_time(150)));
+        BOOST_REQUIRE(reader->next(block));
+        BOOST_CHECK_EQUAL(block.sample_index, 150*SPB);
+    }
+    fs::remove(path);
+
+    BOOST_CHECK_THROW(capture_file_reader::make(path.string()), uhd::io_error);
+}
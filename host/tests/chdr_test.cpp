@@ -17,6 +17,7 @@
 
 #include <uhd/transport/chdr.hpp>
 #include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/format.hpp>
 #include <cstdlib>
@@ -142,3 +143,62 @@ BOOST_AUTO_TEST_CASE(test_with_chdr_err){
     pack_and_unpack(if_packet_info);
 }
 
+
+BOOST_AUTO_TEST_CASE(test_with_chdr_cached){
+    uint32_t packet_buffs[4][32] = {{0}};
+    if_packet_info_t if_packet_info_in;
+    if_packet_info_in.packet_type = if_packet_info_t::PACKET_TYPE_DATA;
+    if_packet_info_in.eob = false;
+    if_packet_info_in.has_tsf = true;
+    if_packet_info_in.sid = 0xAABBCCDD;
+    if_packet_info_in.num_payload_words32 = 24;
+    if_packet_info_in.num_payload_bytes = 95;
+
+    // Same flags and length, then an EOB, then a shorter packet without time
+    for (size_t i = 0; i < 4; i++) {
+        if_packet_info_in.packet_count = 4094 + i;
+        if_packet_info_in.tsf = 0x1234567890ABCDEFull + 100*i;
+        if_packet_info_in.eob = (i == 2);
+        if (i == 3) {
+            if_packet_info_in.has_tsf = false;
+            if_packet_info_in.num_payload_words32 = 4;
+            if_packet_info_in.num_payload_bytes = 16;
+        }
+        chdr::if_hdr_pack_le(packet_buffs[i], if_packet_info_in);
+    }
+
+    chdr::if_hdr_cache_t cache;
+    if_packet_info_t if_packet_info_out[4], if_packet_info_ref;
+    const uint32_t *buffs[4];
+    for (size_t i = 0; i < 4; i++) {
+        buffs[i] = packet_buffs[i];
+        if_packet_info_out[i].num_packet_words32 = 32;
+    }
+    chdr::if_hdr_unpack_batch_le(buffs, if_packet_info_out, 4, cache);
+
+    for (size_t i = 0; i < 4; i++) {
+        if_packet_info_ref.num_packet_words32 = 32;
+        chdr::if_hdr_unpack_le(packet_buffs[i], if_packet_info_ref);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.packet_count, if_packet_info_out[i].packet_count);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.packet_type, if_packet_info_out[i].packet_type);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.eob, if_packet_info_out[i].eob);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.has_tsf, if_packet_info_out[i].has_tsf);
+        if (if_packet_info_ref.has_tsf) {
+            BOOST_CHECK_EQUAL(if_packet_info_ref.tsf, if_packet_info_out[i].tsf);
+        }
+        BOOST_CHECK_EQUAL(if_packet_info_ref.sid, if_packet_info_out[i].sid);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.num_header_words32, if_packet_info_out[i].num_header_words32);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.num_payload_words32, if_packet_info_out[i].num_payload_words32);
+        BOOST_CHECK_EQUAL(if_packet_info_ref.num_payload_bytes, if_packet_info_out[i].num_payload_bytes);
+    }
+
+    // A cached header must not hide a packet cut short by the transport
+    if_packet_info_t if_packet_info_short;
+    if_packet_info_short.num_packet_words32 = 32;
+    chdr::if_hdr_unpack_cached_le(packet_buffs[0], if_packet_info_short, cache);
+    if_packet_info_short.num_packet_words32 = 10;
+    BOOST_CHECK_THROW(
+        chdr::if_hdr_unpack_cached_le(packet_buffs[0], if_packet_info_short, cache),
+        uhd::value_error
+    );
+}
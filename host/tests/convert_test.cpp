@@ -16,6 +16,8 @@
 //
 
 #include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/foreach.hpp>
 #include <stdint.h>
@@ -23,6 +25,8 @@
 #include <complex>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <iostream>
 
 using namespace uhd;
@@ -615,3 +619,694 @@ BOOST_AUTO_TEST_CASE(test_convert_types_f32_and_f32){
         test_convert_types_f32(nsamps, id);
     }
 }
+
+/***********************************************************************
+ * Test the NEON, AVX2 and AVX-512 converters against the generic ones
+ **********************************************************************/
+static const int SIMD_PRIOS[] = {2, 4, 5}; //PRIORITY_SIMD on ARM, PRIORITY_SIMD_AVX2, PRIORITY_SIMD_AVX512
+
+template <typename in_type, typename out_type>
+static bool convert_with_prio(
+    const convert::id_type &id, const int prio, const double scalar,
+    const std::vector<in_type> &input, std::vector<out_type> &output
+){
+    convert::converter::sptr c;
+    try{
+        c = convert::get_converter(id, prio)();
+    }
+    catch(const uhd::key_error &){
+        return false; //not built in or not supported by this cpu
+    }
+    std::vector<const void *> inputs(1, &input[0]);
+    std::vector<void *> outputs(1, &output[0]);
+    c->set_scalar(scalar);
+    c->conv(inputs, outputs, input.size());
+    return true;
+}
+
+template <typename data_type>
+static void test_convert_simd_from_host(const std::string &host, const std::string &wire, const double scalar){
+    typedef typename data_type::value_type value_type;
+    convert::id_type id, back_id;
+    id.input_format = host;
+    id.output_format = wire;
+    id.num_inputs = id.num_outputs = 1;
+    back_id.input_format = wire;
+    back_id.output_format = "fc32";
+    back_id.num_inputs = back_id.num_outputs = 1;
+
+    BOOST_FOREACH(const int prio, SIMD_PRIOS){
+        for (size_t nsamps = 1; nsamps < 70; nsamps++){
+            std::vector<data_type> input(nsamps);
+            BOOST_FOREACH(data_type &in, input) in = data_type(
+                ((std::rand()/(value_type(RAND_MAX)/2)) - 1),
+                ((std::rand()/(value_type(RAND_MAX)/2)) - 1)
+            );
+            std::vector<uint32_t> simd(nsamps), generic(nsamps);
+            if (not convert_with_prio(id, prio, scalar, input, simd)) break;
+            convert_with_prio(id, 0, scalar, input, generic);
+
+            //read back in integer units, the rounding may differ by one
+            std::vector<fc32_t> simd_out(nsamps), generic_out(nsamps);
+            convert_with_prio(back_id, 0, 1.0, simd, simd_out);
+            convert_with_prio(back_id, 0, 1.0, generic, generic_out);
+            for (size_t i = 0; i < nsamps; i++){
+                MY_CHECK_CLOSE(simd_out[i].real(), generic_out[i].real(), 1.5f);
+                MY_CHECK_CLOSE(simd_out[i].imag(), generic_out[i].imag(), 1.5f);
+            }
+        }
+    }
+}
+
+template <typename data_type>
+static void test_convert_simd_to_host(const std::string &wire, const std::string &host, const double scalar){
+    typedef typename data_type::value_type value_type;
+    convert::id_type id;
+    id.input_format = wire;
+    id.output_format = host;
+    id.num_inputs = id.num_outputs = 1;
+
+    BOOST_FOREACH(const int prio, SIMD_PRIOS){
+        for (size_t nsamps = 1; nsamps < 70; nsamps++){
+            std::vector<uint32_t> input(nsamps);
+            BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+            std::vector<data_type> simd(nsamps), generic(nsamps);
+            if (not convert_with_prio(id, prio, scalar, input, simd)) break;
+            convert_with_prio(id, 0, scalar, input, generic);
+            for (size_t i = 0; i < nsamps; i++){
+                MY_CHECK_CLOSE(simd[i].real(), generic[i].real(), value_type(1e-6));
+                MY_CHECK_CLOSE(simd[i].imag(), generic[i].imag(), value_type(1e-6));
+            }
+        }
+    }
+}
+
+static void test_convert_simd_sc16(const std::string &in, const std::string &out){
+    convert::id_type id;
+    id.input_format = in;
+    id.output_format = out;
+    id.num_inputs = id.num_outputs = 1;
+
+    BOOST_FOREACH(const int prio, SIMD_PRIOS){
+        for (size_t nsamps = 1; nsamps < 70; nsamps++){
+            std::vector<uint32_t> input(nsamps);
+            BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+            std::vector<uint32_t> simd(nsamps), generic(nsamps);
+            if (not convert_with_prio(id, prio, 1.0, input, simd)) break;
+            convert_with_prio(id, 0, 1.0, input, generic);
+            BOOST_CHECK_EQUAL_COLLECTIONS(simd.begin(), simd.end(), generic.begin(), generic.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_simd_vs_generic){
+    test_convert_simd_from_host<fc32_t>("fc32", "sc16_item32_le", 32767.);
+    test_convert_simd_from_host<fc32_t>("fc32", "sc16_item32_be", 32767.);
+    test_convert_simd_from_host<fc64_t>("fc64", "sc16_item32_le", 32767.);
+    test_convert_simd_from_host<fc64_t>("fc64", "sc16_item32_be", 32767.);
+    test_convert_simd_from_host<fc32_t>("fc32", "sc8_item32_le", 127.);
+    test_convert_simd_from_host<fc32_t>("fc32", "sc8_item32_be", 127.);
+
+    test_convert_simd_to_host<fc32_t>("sc16_item32_le", "fc32", 1/32767.);
+    test_convert_simd_to_host<fc32_t>("sc16_item32_be", "fc32", 1/32767.);
+    test_convert_simd_to_host<fc64_t>("sc16_item32_le", "fc64", 1/32767.);
+    test_convert_simd_to_host<fc64_t>("sc16_item32_be", "fc64", 1/32767.);
+    test_convert_simd_to_host<fc32_t>("sc8_item32_le", "fc32", 1/127.);
+    test_convert_simd_to_host<fc32_t>("sc8_item32_be", "fc32", 1/127.);
+
+    test_convert_simd_sc16("sc16", "sc16_item32_le");
+    test_convert_simd_sc16("sc16", "sc16_item32_be");
+    test_convert_simd_sc16("sc16_item32_le", "sc16");
+    test_convert_simd_sc16("sc16_item32_be", "sc16");
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_registry_names){
+    convert::id_type id;
+    id.input_format = "fc32";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_le";
+    id.num_outputs = 1;
+
+    //priorities come best first, and the best one is the default
+    const std::vector<convert::priority_type> prios = convert::get_converter_priorities(id);
+    BOOST_REQUIRE(not prios.empty());
+    for (size_t i = 1; i < prios.size(); i++){
+        BOOST_CHECK(prios[i-1] > prios[i]);
+    }
+    BOOST_CHECK_EQUAL(convert::get_converter_name(id), convert::get_converter_name(id, prios.front()));
+    BOOST_CHECK_EQUAL(convert::get_converter_name(id, 0), "generic");
+
+    bool found = false;
+    BOOST_FOREACH(const convert::id_type &id_i, convert::get_converter_ids()){
+        if (id_i == id) found = true;
+    }
+    BOOST_CHECK(found);
+}
+
+/***********************************************************************
+ * Test the sc12 converters against the generic ones, bit for bit
+ **********************************************************************/
+template <typename data_type>
+static void test_convert_sc12_exact(
+    const std::string &host, const std::string &wire, const double scalar, const double range
+){
+    typedef typename data_type::value_type value_type;
+    convert::id_type pack_id, unpack_id;
+    pack_id.input_format = unpack_id.output_format = host;
+    pack_id.output_format = unpack_id.input_format = wire;
+    pack_id.num_inputs = pack_id.num_outputs = 1;
+    unpack_id.num_inputs = unpack_id.num_outputs = 1;
+
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(pack_id)){
+        if (prio == 0) continue;
+        for (size_t nsamps = 1; nsamps < 70; nsamps++){
+            std::vector<data_type> input(nsamps);
+            BOOST_FOREACH(data_type &in, input) in = data_type(
+                value_type((std::rand()/(RAND_MAX/2.0) - 1)*range),
+                value_type((std::rand()/(RAND_MAX/2.0) - 1)*range)
+            );
+            //3 words per 4 samples, padded to be safe either way
+            std::vector<uint32_t> simd(nsamps + 4), generic(nsamps + 4);
+            std::vector<const void *> inputs(1, &input[0]);
+            std::vector<void *> simd_outputs(1, &simd[0]), generic_outputs(1, &generic[0]);
+            convert::converter::sptr c = convert::get_converter(pack_id, prio)();
+            c->set_scalar(scalar);
+            c->conv(inputs, simd_outputs, nsamps);
+            c = convert::get_converter(pack_id, 0)();
+            c->set_scalar(scalar);
+            c->conv(inputs, generic_outputs, nsamps);
+            BOOST_CHECK_EQUAL_COLLECTIONS(simd.begin(), simd.end(), generic.begin(), generic.end());
+        }
+    }
+
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(unpack_id)){
+        if (prio == 0) continue;
+        for (size_t nsamps = 1; nsamps < 70; nsamps++){
+            std::vector<uint32_t> input(nsamps + 4);
+            BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+            std::vector<data_type> simd(nsamps), generic(nsamps);
+            std::vector<const void *> inputs(1, &input[0]);
+            std::vector<void *> simd_outputs(1, &simd[0]), generic_outputs(1, &generic[0]);
+            convert::converter::sptr c = convert::get_converter(unpack_id, prio)();
+            c->set_scalar(1/scalar);
+            c->conv(inputs, simd_outputs, nsamps);
+            c = convert::get_converter(unpack_id, 0)();
+            c->set_scalar(1/scalar);
+            c->conv(inputs, generic_outputs, nsamps);
+            for (size_t i = 0; i < nsamps; i++){
+                BOOST_CHECK(simd[i] == generic[i]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc12_simd_vs_generic){
+    test_convert_sc12_exact<fc32_t>("fc32", "sc12_item32_le", 2047., 1.0);
+    test_convert_sc12_exact<fc32_t>("fc32", "sc12_item32_be", 2047., 1.0);
+    test_convert_sc12_exact<sc16_t>("sc16", "sc12_item32_le", 1.0, 32767.);
+    test_convert_sc12_exact<sc16_t>("sc16", "sc12_item32_be", 1.0, 32767.);
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_and_sc12){
+    //sc16 keeps the upper 12 bits on the wire, the lower 4 are dropped
+    static const char *wires[] = {"sc12_item32_le", "sc12_item32_be"};
+    BOOST_FOREACH(const std::string wire, wires){
+        convert::id_type pack_id, unpack_id;
+        pack_id.input_format = unpack_id.output_format = "sc16";
+        pack_id.output_format = unpack_id.input_format = wire;
+        pack_id.num_inputs = pack_id.num_outputs = 1;
+        unpack_id.num_inputs = unpack_id.num_outputs = 1;
+
+        for (size_t nsamps = 1; nsamps < 16; nsamps++){
+            std::vector<sc16_t> input(nsamps), output(nsamps);
+            BOOST_FOREACH(sc16_t &in, input) in = sc16_t(
+                short(std::rand() - RAND_MAX/2), short(std::rand() - RAND_MAX/2)
+            );
+            std::vector<uint32_t> wire_buff(nsamps + 4);
+            std::vector<const void *> inputs(1, &input[0]), wire_inputs(1, &wire_buff[0]);
+            std::vector<void *> wire_outputs(1, &wire_buff[0]), outputs(1, &output[0]);
+            convert::get_converter(pack_id, 0)()->conv(inputs, wire_outputs, nsamps);
+            convert::get_converter(unpack_id, 0)()->conv(wire_inputs, outputs, nsamps);
+            for (size_t i = 0; i < nsamps; i++){
+                BOOST_CHECK_EQUAL(output[i].real(), short(input[i].real() & 0xfff0));
+                BOOST_CHECK_EQUAL(output[i].imag(), short(input[i].imag() & 0xfff0));
+            }
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the converters with DC offset and IQ correction
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_fc32_with_correction){
+    convert::correction_t correction;
+    correction.dc_offset = std::complex<double>(0.01, -0.02);
+    correction.set_iq_balance(std::complex<double>(0.05, -0.1));
+    const double scalar = 1/32767.;
+
+    static const char *wires[] = {"sc16_item32_le", "sc16_item32_be"};
+    BOOST_FOREACH(const std::string wire, wires){
+        convert::id_type id;
+        id.input_format = wire;
+        id.num_inputs = 1;
+        id.output_format = "fc32";
+        id.num_outputs = 1;
+
+        const size_t nsamps = 69;
+        std::vector<uint32_t> input(nsamps);
+        BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+        std::vector<const void *> inputs(1, &input[0]);
+
+        //the plain conversion, corrected afterwards
+        std::vector<fc32_t> expected(nsamps);
+        std::vector<void *> outputs(1, &expected[0]);
+        convert::converter::sptr c = convert::get_converter(id, 0)();
+        c->set_scalar(scalar);
+        c->conv(inputs, outputs, nsamps);
+        BOOST_FOREACH(fc32_t &out, expected){
+            const std::complex<double> x = std::complex<double>(out) - correction.dc_offset;
+            out = fc32_t(
+                float(correction.iq_matrix[0][0]*x.real() + correction.iq_matrix[0][1]*x.imag()),
+                float(correction.iq_matrix[1][0]*x.real() + correction.iq_matrix[1][1]*x.imag())
+            );
+        }
+
+        //every converter with correction
+        BOOST_CHECK(convert::get_converter_with_correction(id));
+        size_t num_tested = 0;
+        BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+            c = convert::get_converter(id, prio)();
+            try{
+                c->set_correction(correction);
+            }
+            catch(const uhd::not_implemented_error &){
+                continue;
+            }
+            c->set_scalar(scalar);
+            std::vector<fc32_t> output(nsamps);
+            outputs[0] = &output[0];
+            c->conv(inputs, outputs, nsamps);
+            for (size_t i = 0; i < nsamps; i++){
+                MY_CHECK_CLOSE(output[i].real(), expected[i].real(), float(1e-5));
+                MY_CHECK_CLOSE(output[i].imag(), expected[i].imag(), float(1e-5));
+            }
+            num_tested++;
+        }
+        BOOST_CHECK(num_tested > 0);
+    }
+
+    //not for every conversion
+    convert::id_type id;
+    id.input_format = "sc8_item32_le";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+    BOOST_CHECK_THROW(convert::get_converter_with_correction(id), uhd::key_error);
+}
+
+/***********************************************************************
+ * Test the power measured by the converters with correction
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_fc32_power){
+    convert::correction_t correction;
+    correction.dc_offset = std::complex<double>(0.01, -0.02);
+    const double scalar = 1/32767.;
+
+    convert::id_type id;
+    id.input_format = "sc16_item32_le";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    const size_t nsamps = 69;
+    std::vector<uint32_t> input(nsamps);
+    BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+    std::vector<const void *> inputs(1, &input[0]);
+
+    //the plain converters cannot measure
+    BOOST_CHECK_THROW(convert::get_converter(id, 0)()->set_power_measurement(true), uhd::not_implemented_error);
+
+    size_t num_tested = 0;
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+        convert::converter::sptr c = convert::get_converter(id, prio)();
+        try{
+            c->set_correction(correction);
+            c->set_power_measurement(true);
+        }
+        catch(const uhd::not_implemented_error &){
+            continue;
+        }
+        c->set_scalar(scalar);
+        std::vector<fc32_t> output(nsamps);
+        std::vector<void *> outputs(1, &output[0]);
+        c->conv(inputs, outputs, nsamps/2);
+        outputs[0] = &output[nsamps/2];
+        inputs[0] = &input[nsamps/2];
+        c->conv(inputs, outputs, nsamps - nsamps/2);
+        inputs[0] = &input[0];
+
+        //of the output, over both calls
+        double peak = 0, sum = 0;
+        BOOST_FOREACH(const fc32_t &out, output){
+            peak = std::max(peak, double(std::norm(out)));
+            sum += std::norm(out);
+        }
+        double measured_peak, measured_mean;
+        c->get_power(measured_peak, measured_mean);
+        MY_CHECK_CLOSE(measured_peak, peak, 1e-5);
+        MY_CHECK_CLOSE(measured_mean, sum/nsamps, 1e-5);
+
+        //and starts over
+        c->get_power(measured_peak, measured_mean);
+        BOOST_CHECK_EQUAL(measured_peak, 0.0);
+        BOOST_CHECK_EQUAL(measured_mean, 0.0);
+        num_tested++;
+    }
+    BOOST_CHECK(num_tested > 0);
+}
+
+/***********************************************************************
+ * Test the conversions to planar fc32 against the interleaved ones
+ **********************************************************************/
+static void test_convert_planar(const std::string &wire, const double scalar){
+    convert::id_type id, interleaved_id;
+    id.input_format = interleaved_id.input_format = wire;
+    id.num_inputs = interleaved_id.num_inputs = 1;
+    id.output_format = "fc32_planar";
+    id.num_outputs = 2;
+    interleaved_id.output_format = "fc32";
+    interleaved_id.num_outputs = 1;
+
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+        for (size_t nsamps = 1; nsamps < 1100; nsamps += 37){
+            std::vector<uint32_t> input(nsamps + 4);
+            BOOST_FOREACH(uint32_t &in, input) in = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+            std::vector<const void *> inputs(1, &input[0]);
+
+            std::vector<fc32_t> expected(nsamps);
+            std::vector<void *> outputs(1, &expected[0]);
+            convert::converter::sptr c = convert::get_converter(interleaved_id)();
+            c->set_scalar(scalar);
+            c->conv(inputs, outputs, nsamps);
+
+            std::vector<float> output_i(nsamps), output_q(nsamps);
+            outputs[0] = &output_i[0];
+            outputs.push_back(&output_q[0]);
+            c = convert::get_converter(id, prio)();
+            c->set_scalar(scalar);
+            c->conv(inputs, outputs, nsamps);
+            for (size_t i = 0; i < nsamps; i++){
+                BOOST_CHECK_EQUAL(output_i[i], expected[i].real());
+                BOOST_CHECK_EQUAL(output_q[i], expected[i].imag());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_to_fc32_planar){
+    BOOST_CHECK_EQUAL(convert::get_num_planes("fc32_planar"), size_t(2));
+    BOOST_CHECK_EQUAL(convert::get_num_planes("fc32"), size_t(1));
+    BOOST_CHECK_EQUAL(convert::get_bytes_per_item("fc32_planar"), sizeof(float));
+
+    test_convert_planar("sc16_item32_le", 1/32767.);
+    test_convert_planar("sc16_item32_be", 1/32767.);
+    test_convert_planar("sc8_item32_le", 1/127.);
+    test_convert_planar("sc8_item32_be", 1/127.);
+    test_convert_planar("sc12_item32_le", 1/2048.);
+    test_convert_planar("sc12_item32_be", 1/2048.);
+}
+
+/***********************************************************************
+ * Test half precision conversion: every converter matches the generic one
+ **********************************************************************/
+static void test_convert_half(const std::string &in, const std::string &out, const double scalar){
+    convert::id_type id;
+    id.input_format = in;
+    id.num_inputs = 1;
+    id.output_format = out;
+    id.num_outputs = 1;
+
+    //special values for the fc32 input: NaN, infinities, ties, overflow and subnormals
+    const float specials[] = {
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(), 65519.f, 65520.f, 1.f + 1/2048.f,
+        1.f + 3/2048.f, 1.f + 1/256.f, 1e-5f, -3e-8f, 1e-40f, -0.f
+    };
+
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+        for (size_t nsamps = 1; nsamps < 1100; nsamps += 37){
+            std::vector<uint32_t> input(2*nsamps + 4);
+            BOOST_FOREACH(uint32_t &word, input) word = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+            if (in == "fc32") for (size_t i = 0; i < input.size(); i++){
+                float num = (i % 3 == 0)? specials[i % 12] : float(std::rand() - RAND_MAX/2)/(RAND_MAX/2);
+                std::memcpy(&input[i], &num, sizeof(num));
+            }
+            std::vector<const void *> inputs(1, &input[0]);
+
+            std::vector<uint32_t> expected(nsamps), output(nsamps);
+            std::vector<void *> outputs(1, &expected[0]);
+            convert::converter::sptr c = convert::get_converter(id, 0)();
+            c->set_scalar(scalar);
+            c->conv(inputs, outputs, nsamps);
+
+            outputs[0] = &output[0];
+            c = convert::get_converter(id, prio)();
+            c->set_scalar(scalar);
+            c->conv(inputs, outputs, nsamps);
+            BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), expected.begin(), expected.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_to_half){
+    BOOST_CHECK_EQUAL(convert::get_bytes_per_item("fc16"), size_t(4));
+    BOOST_CHECK_EQUAL(convert::get_bytes_per_item("bf16"), size_t(4));
+
+    const char *formats[] = {"fc16", "bf16"};
+    BOOST_FOREACH(const std::string out, formats){
+        test_convert_half("sc16_item32_le", out, 1/32767.);
+        test_convert_half("sc16_item32_be", out, 1/32767.);
+        test_convert_half("sc12_item32_le", out, 1/2048.);
+        test_convert_half("sc12_item32_be", out, 1/2048.);
+        test_convert_half("fc32", out, 1.0);
+        test_convert_half("fc32", out, 1000.0);
+    }
+
+    //known values: 1.0 and -1/3, where fc16 and bf16 round differently
+    convert::id_type id;
+    id.input_format = "fc32";
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    const fc32_t input(1.f, -1/3.f);
+    std::vector<const void *> inputs(1, &input);
+    std::complex<uint16_t> output;
+    std::vector<void *> outputs(1, &output);
+
+    id.output_format = "fc16";
+    convert::converter::sptr c = convert::get_converter(id)();
+    c->set_scalar(1.0);
+    c->conv(inputs, outputs, 1);
+    BOOST_CHECK_EQUAL(output.real(), 0x3c00);
+    BOOST_CHECK_EQUAL(output.imag(), 0xb555);
+
+    id.output_format = "bf16";
+    c = convert::get_converter(id)();
+    c->set_scalar(1.0);
+    c->conv(inputs, outputs, 1);
+    BOOST_CHECK_EQUAL(output.real(), 0x3f80);
+    BOOST_CHECK_EQUAL(output.imag(), 0xbeab);
+}
+
+/***********************************************************************
+ * Test non-temporal stores: same output for any alignment of the output
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_fc32_nontemporal){
+    const char *formats[] = {"sc16_item32_le", "sc16_item32_be"};
+    BOOST_FOREACH(const std::string in, formats){
+        convert::id_type id;
+        id.input_format = in;
+        id.num_inputs = 1;
+        id.output_format = "fc32";
+        id.num_outputs = 1;
+
+        const size_t nsamps = 1003;
+        std::vector<uint32_t> input(nsamps);
+        BOOST_FOREACH(uint32_t &word, input) word = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+        std::vector<const void *> inputs(1, &input[0]);
+
+        BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+            for (size_t offset = 0; offset < 16; offset++){
+                //start the output at every float offset from a 64-byte boundary
+                std::vector<float> expected(2*nsamps+32), output(2*nsamps+32);
+                const size_t start = (64 - (size_t(&output[0]) & 63))/sizeof(float) + offset;
+                const size_t start_exp = (64 - (size_t(&expected[0]) & 63))/sizeof(float) + offset;
+
+                std::vector<void *> outputs(1, &expected[start_exp]);
+                convert::converter::sptr c = convert::get_converter(id, prio)();
+                c->set_scalar(1/32767.);
+                c->conv(inputs, outputs, nsamps);
+
+                outputs[0] = &output[start];
+                c->set_nontemporal(true);
+                c->conv(inputs, outputs, nsamps);
+                for (size_t i = 0; i < 2*nsamps; i++){
+                    BOOST_CHECK_EQUAL(output[start+i], expected[start_exp+i]);
+                }
+            }
+        }
+    }
+}
+
+/***********************************************************************
+ * Test decimating converters against a filter in double precision
+ **********************************************************************/
+static void test_convert_decim(const size_t decim, const std::vector<float> &taps){
+    convert::id_type id;
+    id.input_format = "sc16_item32_le";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    const size_t nsamps = 5003;
+    std::vector<uint32_t> input(nsamps);
+    BOOST_FOREACH(uint32_t &word, input) word = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+    std::vector<const void *> inputs(1, &input[0]);
+
+    //the reference filters the output of the plain converter
+    std::vector<fc32_t> samps(nsamps);
+    std::vector<void *> outputs(1, &samps[0]);
+    convert::converter::sptr c = convert::get_converter(id)();
+    c->set_scalar(1/32767.);
+    c->conv(inputs, outputs, nsamps);
+
+    const size_t nout = nsamps/decim;
+    std::vector<fc32_t> output(nout);
+    outputs[0] = &output[0];
+    c = convert::make_decimator(id, decim, taps);
+    c->set_scalar(1/32767.);
+    c->conv(inputs, outputs, nsamps);
+
+    for (size_t k = 0; k < nout; k++){
+        const size_t n = decim - 1 + k*decim;
+        std::complex<double> expected(0.0);
+        for (size_t j = 0; j < taps.size() and j <= n; j++){
+            expected += double(taps[j])*std::complex<double>(samps[n-j]);
+        }
+        MY_CHECK_CLOSE(expected.real(), output[k].real(), 1e-4);
+        MY_CHECK_CLOSE(expected.imag(), output[k].imag(), 1e-4);
+    }
+
+    //the filter state carries over, so any split into calls gives the same
+    std::vector<fc32_t> output_split(nout);
+    c = convert::make_decimator(id, decim, taps);
+    c->set_scalar(1/32767.);
+    size_t in_pos = 0, out_pos = 0;
+    for (size_t n = 1; in_pos < nsamps; n = n*3 + 1){
+        const size_t num = std::min(n, nsamps - in_pos);
+        std::vector<const void *> in_split(1, &input[in_pos]);
+        std::vector<void *> out_split(1, &output_split[out_pos]);
+        c->conv(in_split, out_split, num);
+        out_pos = (in_pos + num)/decim;
+        in_pos += num;
+    }
+    BOOST_CHECK_EQUAL(out_pos, nout);
+    for (size_t k = 0; k < nout; k++){
+        BOOST_CHECK_EQUAL(output[k], output_split[k]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_fc32_decim){
+    for (size_t decim = 1; decim <= 8; decim++){
+        std::vector<float> taps(5*decim + 3);
+        BOOST_FOREACH(float &tap, taps) tap = float(std::rand())/RAND_MAX - 0.5f;
+        test_convert_decim(decim, taps);
+    }
+
+    //the default filter passes DC with unity gain
+    convert::id_type id;
+    id.input_format = "sc16_item32_le";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+    const size_t decim = 5, nsamps = 2000;
+    std::vector<uint32_t> input(nsamps, (uint32_t(16384) << 16) | uint32_t(-8192 & 0xffff));
+    std::vector<fc32_t> output(nsamps/decim);
+    std::vector<const void *> inputs(1, &input[0]);
+    std::vector<void *> outputs(1, &output[0]);
+    convert::converter::sptr c = convert::make_decimator(id, decim);
+    c->set_scalar(1/32768.);
+    c->conv(inputs, outputs, nsamps);
+    MY_CHECK_CLOSE(output.back().real(), 0.5f, 1e-4f);
+    MY_CHECK_CLOSE(output.back().imag(), -0.25f, 1e-4f);
+
+    //and only decimates to fc32
+    id.output_format = "sc16";
+    BOOST_CHECK_THROW(convert::make_decimator(id, decim), uhd::value_error);
+}
+
+/***********************************************************************
+ * Test the table converters, whose tables are shared, against the generic ones
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_table_vs_generic){
+    const char *formats[] = {"sc16_item32_le", "sc16_item32_be", "sc8_item32_le", "sc8_item32_be"};
+    const double scalars[] = {1/32767., 0.5, 1/32767.};
+    BOOST_FOREACH(const std::string in, formats){
+        convert::id_type id;
+        id.input_format = in;
+        id.num_inputs = 1;
+        id.output_format = "fc32";
+        id.num_outputs = 1;
+
+        std::vector<uint32_t> input(1001);
+        BOOST_FOREACH(uint32_t &word, input) word = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+        std::vector<const void *> inputs(1, &input[0]);
+
+        //two converters of the same kind, the scalar set again and back
+        convert::converter::sptr c0 = convert::get_converter(id, 1)();
+        convert::converter::sptr c1 = convert::get_converter(id, 1)();
+        BOOST_FOREACH(const double scalar, scalars){
+            std::vector<fc32_t> expected(input.size()), output0(input.size()), output1(input.size());
+            BOOST_CHECK(convert_with_prio(id, 0, scalar, input, expected));
+            std::vector<void *> outputs(1, &output0[0]);
+            c0->set_scalar(scalar);
+            c0->conv(inputs, outputs, input.size());
+            outputs[0] = &output1[0];
+            c1->set_scalar(scalar);
+            c1->conv(inputs, outputs, input.size());
+            for (size_t i = 0; i < input.size(); i++){
+                MY_CHECK_CLOSE(expected[i].real(), output0[i].real(), 1e-6f);
+                MY_CHECK_CLOSE(expected[i].imag(), output0[i].imag(), 1e-6f);
+                BOOST_CHECK_EQUAL(output0[i], output1[i]);
+            }
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the raw item32 output: the wire items in host byte order
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_to_item32){
+    const char *formats[] = {"sc16_item32_le", "sc16_item32_be"};
+    BOOST_FOREACH(const std::string in, formats){
+        const bool big_endian = (in == "sc16_item32_be");
+        convert::id_type id;
+        id.input_format = in;
+        id.num_inputs = 1;
+        id.output_format = "item32";
+        id.num_outputs = 1;
+
+        std::vector<uint32_t> input(1001), output(input.size());
+        BOOST_FOREACH(uint32_t &word, input) word = uint32_t(std::rand()) ^ (uint32_t(std::rand()) << 16);
+        std::vector<const void *> inputs(1, &input[0]);
+        std::vector<void *> outputs(1, &output[0]);
+
+        convert::converter::sptr c = convert::get_converter(id)();
+        c->set_scalar(1.0);
+        c->conv(inputs, outputs, input.size());
+        std::vector<uint32_t> expected(input.size());
+        for (size_t i = 0; i < input.size(); i++){
+            expected[i] = big_endian ? uhd::ntohx(input[i]) : uhd::wtohx(input[i]);
+        }
+        BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), output.begin(), output.end());
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "ctrl_loopback_xport.hpp"
+#include "../lib/rfnoc/ctrl_iface.hpp"
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <vector>
+
+using namespace uhd;
+
+static const uint32_t CTRL_SID = 0x00000010;
+
+static void record_time(std::vector<time_spec_t> &times, const time_spec_t &time)
+{
+    times.push_back(time);
+}
+
+BOOST_AUTO_TEST_CASE(test_cmd_queue_full)
+{
+    ctrl_loopback_xport::sptr xport = boost::make_shared<ctrl_loopback_xport>(4);
+    rfnoc::ctrl_iface::sptr ctrl = rfnoc::ctrl_iface::make(true, xport, xport, CTRL_SID, "test");
+
+    // Without acks, the queue fills up: a write waits once it fills the queue
+    xport->hold_acks = true;
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 3);
+    for (size_t i = 0; i < 3; i++) {
+        BOOST_CHECK(ctrl->try_poke32(0x10, i));
+    }
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 0);
+    BOOST_CHECK(not ctrl->try_poke32(0x10, 3));
+    BOOST_CHECK_EQUAL(xport->num_cmds, 3);
+
+    // The acks free the queue again
+    xport->hold_acks = false;
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 3);
+    BOOST_CHECK(ctrl->try_poke32(0x10, 3));
+    BOOST_CHECK_EQUAL(xport->num_cmds, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_cmd_done_handler)
+{
+    ctrl_loopback_xport::sptr xport = boost::make_shared<ctrl_loopback_xport>(4);
+    rfnoc::ctrl_iface::sptr ctrl = rfnoc::ctrl_iface::make(true, xport, xport, CTRL_SID, "test");
+    ctrl->set_tick_rate(100e6);
+    std::vector<time_spec_t> done_times;
+    ctrl->set_cmd_done_handler(boost::bind(&record_time, boost::ref(done_times), _1));
+
+    // Timed commands are done once their acks come in
+    xport->hold_acks = true;
+    ctrl->set_time(time_spec_t(1.0));
+    BOOST_CHECK(ctrl->try_poke32(0x10, 0));
+    ctrl->set_time(time_spec_t(2.0));
+    BOOST_CHECK(ctrl->try_poke32(0x10, 1));
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 1);
+    BOOST_CHECK(done_times.empty());
+
+    xport->hold_acks = false;
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 3);
+    BOOST_REQUIRE_EQUAL(done_times.size(), 2);
+    BOOST_CHECK_EQUAL(done_times[0].get_real_secs(), 1.0);
+    BOOST_CHECK_EQUAL(done_times[1].get_real_secs(), 2.0);
+
+    // Untimed commands are not reported
+    ctrl->set_time(time_spec_t(0.0));
+    ctrl->poke32(0x10, 2);
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 3);
+    BOOST_CHECK_EQUAL(done_times.size(), 2);
+
+    // An empty handler stops the reports
+    ctrl->set_cmd_done_handler(timed_wb_iface::cmd_done_handler_t());
+    ctrl->set_time(time_spec_t(3.0));
+    BOOST_CHECK(ctrl->try_poke32(0x10, 3));
+    BOOST_CHECK_EQUAL(ctrl->get_cmd_queue_space(), 3);
+    BOOST_CHECK_EQUAL(done_times.size(), 2);
+    ctrl->set_time(time_spec_t(0.0));
+}
@@ -0,0 +1,119 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_TEST_CTRL_LOOPBACK_XPORT_HPP
+#define INCLUDED_TEST_CTRL_LOOPBACK_XPORT_HPP
+
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <vector>
+
+/*!
+ * A big endian CHDR control transport that acks every command the way
+ * the FPGA does: same sequence number, reversed sid, the command's data
+ * as readback value. Serves as both the command and the response
+ * transport of a control core. The acks can be held back to fill the
+ * command queue.
+ */
+class ctrl_loopback_xport : public uhd::transport::zero_copy_if
+{
+public:
+    typedef boost::shared_ptr<ctrl_loopback_xport> sptr;
+
+    ctrl_loopback_xport(const size_t num_recv_frames = 4):
+        num_cmds(0), hold_acks(false),
+        _num_recv_frames(num_recv_frames), _send_mem(64), _recv_mem(64),
+        _msb(this), _mrb()
+    {
+        /* NOP */
+    }
+
+    //! Commands sent so far
+    size_t num_cmds;
+
+    //! Keep the acks from the response transport until cleared
+    bool hold_acks;
+
+    uhd::transport::managed_recv_buffer::sptr get_recv_buff(double)
+    {
+        if (hold_acks or _acks.empty()) return uhd::transport::managed_recv_buffer::sptr();
+        _recv_mem = _acks.front();
+        _acks.pop_front();
+        return _mrb.get_new(&_recv_mem.front(), _recv_mem.size()*sizeof(uint32_t));
+    }
+
+    size_t get_num_recv_frames(void) const { return _num_recv_frames; }
+    size_t get_recv_frame_size(void) const { return _recv_mem.size()*sizeof(uint32_t); }
+
+    uhd::transport::managed_send_buffer::sptr get_send_buff(double)
+    {
+        return _msb.get_new(&_send_mem.front(), _send_mem.size()*sizeof(uint32_t));
+    }
+
+    size_t get_num_send_frames(void) const { return 1; }
+    size_t get_send_frame_size(void) const { return _send_mem.size()*sizeof(uint32_t); }
+
+private:
+    class loopback_msb : public uhd::transport::managed_send_buffer
+    {
+    public:
+        loopback_msb(ctrl_loopback_xport *xport): _xport(xport) {}
+        void release(void) { _xport->_ack(size()); }
+        sptr get_new(void *mem, const size_t len) { return make(this, mem, len); }
+    private:
+        ctrl_loopback_xport *_xport;
+    };
+
+    class loopback_mrb : public uhd::transport::managed_recv_buffer
+    {
+    public:
+        void release(void) {}
+        sptr get_new(void *mem, const size_t len) { return make(this, mem, len); }
+    };
+
+    //! Turn the command that was just committed into its ack
+    void _ack(const size_t num_bytes)
+    {
+        uhd::transport::vrt::if_packet_info_t info;
+        info.link_type = uhd::transport::vrt::if_packet_info_t::LINK_TYPE_CHDR;
+        info.num_packet_words32 = num_bytes/sizeof(uint32_t);
+        uhd::transport::vrt::if_hdr_unpack_be(&_send_mem.front(), info);
+        const uint32_t data = uhd::ntohx(_send_mem[info.num_header_words32+1]);
+
+        info.sid = (info.sid >> 16) | (info.sid << 16);
+        info.has_tsf = false;
+        std::vector<uint32_t> ack(_send_mem.size());
+        uhd::transport::vrt::if_hdr_pack_be(&ack.front(), info);
+        ack[info.num_header_words32+0] = 0;
+        ack[info.num_header_words32+1] = uhd::htonx(data);
+        ack.resize(info.num_packet_words32);
+        _acks.push_back(ack);
+        num_cmds++;
+    }
+
+    const size_t _num_recv_frames;
+    std::vector<uint32_t> _send_mem;
+    std::vector<uint32_t> _recv_mem;
+    std::deque<std::vector<uint32_t> > _acks;
+    loopback_msb _msb;
+    loopback_mrb _mrb;
+};
+
+#endif /* INCLUDED_TEST_CTRL_LOOPBACK_XPORT_HPP */
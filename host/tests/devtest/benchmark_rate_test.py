@@ -18,19 +18,83 @@
 """ Test using benchmark_rate. """
 
 import re
+import os
+import json
+import tempfile
+import itertools
 from uhd_test_base import uhd_example_test_case
 
+# Test keys that may be lists of values. A test with lists runs once per
+# combination of the values.
+SWEEP_KEYS = ('spp', 'recv_frame_size', 'num_recv_frames', 'otw', 'cpu', 'streamers')
+# Sweep keys that are device args, not benchmark_rate options.
+DEVICE_ARG_KEYS = ('recv_frame_size', 'num_recv_frames')
+
 class uhd_benchmark_rate_test(uhd_example_test_case):
     """
     Run benchmark_rate in various configurations.
+
+    Besides the sample counts, the tests can gate on the results in the
+    JSON file of benchmark_rate: 'max-recv-p99-us' and 'max-send-p99-us'
+    (99th percentile of the recv() and send() call durations, in the worst
+    streamer) and 'max-rx-cpu-load' and 'max-tx-cpu-load' (fraction of a
+    CPU used by the busiest streamer thread).
     """
     tests = {}
 
     def setup_example(self):
         """
-        Set args.
+        Set args, and expand the sweeps into one test per combination.
+        """
+        self.test_params = {}
+        for test_name, test_args in uhd_benchmark_rate_test.tests.iteritems():
+            sweep = [
+                (key, test_args[key]) for key in SWEEP_KEYS
+                if isinstance(test_args.get(key), list)
+            ]
+            if not sweep:
+                self.test_params[test_name] = test_args
+                continue
+            keys = [key for key, _ in sweep]
+            for values in itertools.product(*[vals for _, vals in sweep]):
+                point_args = dict(test_args)
+                point_args.update(zip(keys, values))
+                point_name = '{n}/{p}'.format(
+                    n=test_name,
+                    p=','.join('{k}={v}'.format(k=k, v=v) for k, v in zip(keys, values)),
+                )
+                self.test_params[point_name] = point_args
+
+    def create_device_args_str(self, test_args):
+        """ Returns the args string, with the device args of the test added. """
+        dev_args = [
+            '{k}={v}'.format(k=key, v=test_args[key])
+            for key in DEVICE_ARG_KEYS if key in test_args
+        ]
+        if not dev_args:
+            return self.create_addr_args_str()
+        return '--args={}'.format(','.join([a for a in [self.args_str] if a] + dev_args))
+
+    def parse_json_results(self, json_path, run_results):
+        """
+        Reads the JSON file of benchmark_rate, and adds the worst call
+        latency and CPU load of each direction to run_results.
         """
-        self.test_params = uhd_benchmark_rate_test.tests
+        try:
+            with open(json_path) as json_file:
+                results = json.load(json_file)
+        except (IOError, ValueError):
+            return
+        for direction, call in (('rx', 'recv'), ('tx', 'send')):
+            if direction not in results:
+                continue
+            streamers = results[direction]['streamers']
+            for pct in ('p50', 'p99', 'p999'):
+                run_results['{c}_{p}_us'.format(c=call, p=pct)] = \
+                    max(s['latency_us'][pct] for s in streamers)
+            loads = [s['cpu_load'] for s in streamers if s['cpu_load'] is not None]
+            if loads:
+                run_results['{d}_cpu_load'.format(d=direction)] = max(loads)
 
     def run_test(self, test_name, test_args):
         """
@@ -48,11 +112,25 @@ class uhd_benchmark_rate_test(uhd_example_test_case):
         self.log.info('Running test {n}, Channel = {c}, Sample Rate = {r}'.format(
             n=test_name, c=chan, r=samp_rate,
         ))
+        (json_fd, json_path) = tempfile.mkstemp(suffix='.json')
+        os.close(json_fd)
         args = [
-            self.create_addr_args_str(),
+            self.create_device_args_str(test_args),
             '--duration', str(duration),
             '--channels', str(chan),
+            '--json', json_path,
         ]
+        if 'spp' in test_args:
+            args += ['--rx_spp', str(test_args['spp']), '--tx_spp', str(test_args['spp'])]
+        if 'otw' in test_args:
+            args += ['--rx_otw', test_args['otw'], '--tx_otw', test_args['otw']]
+        if 'cpu' in test_args:
+            args += ['--rx_cpu', test_args['cpu'], '--tx_cpu', test_args['cpu']]
+        if 'streamers' in test_args:
+            args += [
+                '--rx_streamers', str(test_args['streamers']),
+                '--tx_streamers', str(test_args['streamers']),
+            ]
         if 'tx' in test_args.get('direction', ''):
             args.append('--tx_rate')
             args.append(str(samp_rate))
@@ -61,6 +139,8 @@ class uhd_benchmark_rate_test(uhd_example_test_case):
             args.append('--rx_rate')
             args.append(str(samp_rate))
         (app, run_results) = self.run_example('benchmark_rate', args)
+        self.parse_json_results(json_path, run_results)
+        os.remove(json_path)
         match = re.search(r'(Num received samples):\s*(.*)', app.stdout)
         run_results['num_rx_samples'] = int(match.group(2)) if match else -1
         if run_results['num_rx_samples'] != -1:
@@ -93,6 +173,14 @@ class uhd_benchmark_rate_test(uhd_example_test_case):
             run_results['num_timeouts'] == 0,
             # run_results['rel_rx_samples_error'] < rel_samp_err_threshold,
             # run_results['rel_tx_samples_error'] < rel_samp_err_threshold,
+        ] + [
+            run_results.get(result, 0) <= test_args[gate]
+            for gate, result in (
+                ('max-recv-p99-us', 'recv_p99_us'),
+                ('max-send-p99-us', 'send_p99_us'),
+                ('max-rx-cpu-load', 'rx_cpu_load'),
+                ('max-tx-cpu-load', 'tx_cpu_load'),
+            ) if gate in test_args
         ])
         self.report_example_results(test_name, run_results)
         return run_results
@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/types/dict.hpp>
+#include <uhd/types/sensors.hpp>
 #include <boost/assign/list_of.hpp>
 
 BOOST_AUTO_TEST_CASE(test_dict_init){
@@ -95,3 +96,45 @@ BOOST_AUTO_TEST_CASE(test_dict_update)
 }
 
 
+
+BOOST_AUTO_TEST_CASE(test_dict_large)
+{
+    // Large enough to be looked up by hash
+    uhd::dict<int, int> d;
+    for (int i = 0; i < 100; i++) {
+        d[i * 3] = i;
+    }
+    BOOST_CHECK_EQUAL(d.size(), 100);
+    BOOST_CHECK_EQUAL(d[42 * 3], 42);
+    BOOST_CHECK(not d.has_key(1));
+    for (int i = 0; i < 100; i += 2) {
+        BOOST_CHECK_EQUAL(d.pop(i * 3), i);
+    }
+    BOOST_CHECK_EQUAL(d.size(), 50);
+    BOOST_CHECK(not d.has_key(0));
+    BOOST_CHECK_EQUAL(d[99 * 3], 99);
+    // Keys stay in the order of insertion
+    BOOST_CHECK_EQUAL(d.keys()[0], 3);
+    BOOST_CHECK_EQUAL(d.keys()[1], 9);
+
+    // Copies are independent
+    uhd::dict<int, int> d2 = d;
+    d2[1] = -1;
+    BOOST_CHECK(d2.has_key(1));
+    BOOST_CHECK(not d.has_key(1));
+    BOOST_CHECK_EQUAL(d2[99 * 3], 99);
+    d = d2;
+    BOOST_CHECK_EQUAL(d[1], -1);
+    BOOST_CHECK_EQUAL(d.keys().back(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_dict_set_no_default_ctor)
+{
+    uhd::dict<std::string, uhd::sensor_value_t> d;
+    d.set("locked", uhd::sensor_value_t("Ref", true, "locked", "unlocked"));
+    d.set("temp", uhd::sensor_value_t("temp", 42.0, "C"));
+    d.set("locked", uhd::sensor_value_t("Ref", false, "locked", "unlocked"));
+    BOOST_CHECK_EQUAL(d.size(), 2);
+    BOOST_CHECK(not d.get("locked").to_bool());
+    BOOST_CHECK_EQUAL(d.get("temp").to_real(), 42.0);
+}
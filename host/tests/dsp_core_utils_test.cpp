@@ -0,0 +1,65 @@
+//
+// Copyright 2016 Ettus Research
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/usrp/cores/dsp_core_utils.hpp"
+#include <cmath>
+
+BOOST_AUTO_TEST_CASE(test_freq_word_exact){
+    const double tick_rate = 200e6;
+    const double scale = std::pow(2.0, 32);
+    double actual_freq;
+    int32_t freq_word;
+
+    //1 Hz steps land on the nearest word
+    get_freq_and_freq_word(1.0, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, 21);
+    BOOST_CHECK_EQUAL(actual_freq, 21/scale*tick_rate);
+
+    get_freq_and_freq_word(-1.0, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, -21);
+
+    //a frequency that is an exact fraction of the rate has an exact word
+    get_freq_and_freq_word(tick_rate/8, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, int32_t(1) << 29);
+    BOOST_CHECK_EQUAL(actual_freq, tick_rate/8);
+
+    //wrap around the rate
+    get_freq_and_freq_word(tick_rate + 25e6, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, int32_t(1) << 29);
+    get_freq_and_freq_word(-tick_rate*3/4, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, int32_t(1) << 30);
+
+    //half the rate saturates
+    get_freq_and_freq_word(tick_rate/2, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, 0x7fffffff);
+    get_freq_and_freq_word(-tick_rate/2, tick_rate, actual_freq, freq_word);
+    BOOST_CHECK_EQUAL(freq_word, -0x7fffffff - 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_freq_word_matches_float){
+    //whole and fractional frequencies round the same way
+    const double tick_rate = 184.32e6;
+    const double freqs[] = {12345678.0, -45678901.0, 12345678.5, -90e6, 1e-3};
+    for (size_t i = 0; i < sizeof(freqs)/sizeof(freqs[0]); i++){
+        double actual_freq;
+        int32_t freq_word;
+        get_freq_and_freq_word(freqs[i], tick_rate, actual_freq, freq_word);
+        const double expected = std::floor(freqs[i]/tick_rate*std::pow(2.0, 32) + 0.5);
+        BOOST_CHECK_EQUAL(double(freq_word), expected);
+    }
+}
@@ -18,6 +18,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
 #include "../lib/experts/expert_container.hpp"
 #include "../lib/experts/expert_factory.hpp"
 #include <uhd/property_tree.hpp>
@@ -144,6 +145,56 @@ private:
 
 //=============================================================================
 
+class counting_adder_t : public worker_node_t {
+public:
+    counting_adder_t(const node_retriever_t& db,
+        const std::string& a, const std::string& b, const std::string& sum,
+        boost::shared_ptr<int> count)
+    : worker_node_t(a + "+" + b + "=" + sum), _a(db, a), _b(db, b), _sum(db, sum), _count(count)
+    {
+        bind_accessor(_a);
+        bind_accessor(_b);
+        bind_accessor(_sum);
+    }
+
+private:
+    void resolve() {
+        _sum = _a + _b;
+        (*_count)++;
+    }
+
+    data_reader_t<int> _a;
+    data_reader_t<int> _b;
+    data_writer_t<int> _sum;
+
+    boost::shared_ptr<int> _count;
+};
+
+class thread_recorder_t : public worker_node_t {
+public:
+    thread_recorder_t(const node_retriever_t& db,
+        const std::string& in, const std::string& out, const std::string& resource,
+        boost::thread::id* thread_id)
+    : worker_node_t(in + "->" + out, resource), _in(db, in), _out(db, out), _thread_id(thread_id)
+    {
+        bind_accessor(_in);
+        bind_accessor(_out);
+    }
+
+private:
+    void resolve() {
+        _out = _in * 2;
+        *_thread_id = boost::this_thread::get_id();
+    }
+
+    data_reader_t<int> _in;
+    data_writer_t<int> _out;
+
+    boost::thread::id* _thread_id;
+};
+
+//=============================================================================
+
 #define DUMP_VARS \
     BOOST_TEST_MESSAGE( str(boost::format("### State = {A=%d%s, B=%d%s, C=%d%s, D=%d%s, E=%d%s, F=%d%s, G=%d%s}\n") % \
     nodeA.get() % (nodeA.is_dirty()?"*":"") % \
@@ -254,3 +305,77 @@ BOOST_AUTO_TEST_CASE(test_experts){
     container->resolve_to("Consume_G");
     VALIDATE_ALL_DEPENDENCIES
 }
+
+BOOST_AUTO_TEST_CASE(test_experts_incremental){
+    expert_container::sptr container = expert_factory::create_container("incremental");
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    boost::shared_ptr<int> count1 = boost::make_shared<int>(0);
+    boost::shared_ptr<int> count2 = boost::make_shared<int>(0);
+    boost::shared_ptr<int> count3 = boost::make_shared<int>(0);
+
+    //P+Q=R and S+Q=T only share Q, S+T=U consumes T
+    expert_factory::add_prop_node<int>(container, tree, "P", 0, uhd::experts::AUTO_RESOLVE_ON_WRITE);
+    expert_factory::add_prop_node<int>(container, tree, "Q", 0);
+    expert_factory::add_prop_node<int>(container, tree, "S", 0, uhd::experts::AUTO_RESOLVE_ON_WRITE);
+    expert_factory::add_data_node<int>(container, "R", 0);
+    expert_factory::add_data_node<int>(container, "T", 0);
+    expert_factory::add_prop_node<int>(container, tree, "U", 0, uhd::experts::AUTO_RESOLVE_ON_READ);
+    expert_factory::add_worker_node<counting_adder_t>(container, container->node_retriever(), "P", "Q", "R", count1);
+    expert_factory::add_worker_node<counting_adder_t>(container, container->node_retriever(), "S", "Q", "T", count2);
+    expert_factory::add_worker_node<counting_adder_t>(container, container->node_retriever(), "S", "T", "U", count3);
+    container->resolve_all(true);
+    *count1 = *count2 = *count3 = 0;
+
+    const dag_vertex_t& nodeT = container->node_retriever().lookup("T");
+
+    //Only the workers downstream of S may run
+    tree->access<int>("S").set(5);
+    BOOST_CHECK_EQUAL(*count1, 0);
+    BOOST_CHECK_EQUAL(*count2, 1);
+    BOOST_CHECK_EQUAL(*count3, 1);
+    BOOST_CHECK_EQUAL(tree->access<int>("U").get(), 10);
+    BOOST_CHECK(!nodeT.is_dirty());
+
+    //Q is consumed by both P+Q=R and S+Q=T, so resolving from P must
+    //also propagate the pending change of Q into T and U
+    tree->access<int>("Q").set(2);
+    tree->access<int>("P").set(1);
+    BOOST_CHECK_EQUAL(*count1, 1);
+    BOOST_CHECK_EQUAL(*count2, 2);
+    BOOST_CHECK(!nodeT.is_dirty());
+    BOOST_CHECK_EQUAL(tree->access<int>("U").get(), 12);
+
+    //Nothing is dirty so reading does not run anything
+    const int runs = *count1 + *count2 + *count3;
+    container->resolve_to("U");
+    container->resolve_from("P");
+    BOOST_CHECK_EQUAL(*count1 + *count2 + *count3, runs);
+    BOOST_CHECK_THROW(container->resolve_from("does_not_exist"), uhd::lookup_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_experts_concurrent){
+    expert_container::sptr container = expert_factory::create_container("concurrent");
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    boost::thread::id id_ch0, id_ch1, id_ch1_next, id_serial;
+
+    //ch0 and ch1 use different resources, ch1/next shares a resource with ch1
+    expert_factory::add_prop_node<int>(container, tree, "in", 1, uhd::experts::AUTO_RESOLVE_ON_WRITE);
+    expert_factory::add_data_node<int>(container, "ch0", 0);
+    expert_factory::add_data_node<int>(container, "ch1", 0);
+    expert_factory::add_data_node<int>(container, "ch1/next", 0);
+    expert_factory::add_data_node<int>(container, "serial", 0);
+    expert_factory::add_worker_node<thread_recorder_t>(container, container->node_retriever(), "in", "ch0", "iface0", &id_ch0);
+    expert_factory::add_worker_node<thread_recorder_t>(container, container->node_retriever(), "in", "ch1", "iface1", &id_ch1);
+    expert_factory::add_worker_node<thread_recorder_t>(container, container->node_retriever(), "ch1", "ch1/next", "iface1", &id_ch1_next);
+    expert_factory::add_worker_node<thread_recorder_t>(container, container->node_retriever(), "in", "serial", "", &id_serial);
+    container->resolve_all(true);
+
+    tree->access<int>("in").set(3);
+    const node_retriever_t& db = container->node_retriever();
+    BOOST_CHECK_EQUAL(dynamic_cast<const data_node_t<int>&>(db.lookup("ch0")).get(), 6);
+    BOOST_CHECK_EQUAL(dynamic_cast<const data_node_t<int>&>(db.lookup("ch1")).get(), 6);
+    BOOST_CHECK_EQUAL(dynamic_cast<const data_node_t<int>&>(db.lookup("ch1/next")).get(), 12);
+    BOOST_CHECK_EQUAL(dynamic_cast<const data_node_t<int>&>(db.lookup("serial")).get(), 6);
+    BOOST_CHECK(id_ch0 != id_ch1);
+    BOOST_CHECK(id_serial == boost::this_thread::get_id());
+}
@@ -0,0 +1,63 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/fastpath.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace uhd::fastpath;
+
+static boost::mutex events_mutex;
+static std::vector<event_t> events;
+
+static void record_event(const event_t &event){
+    boost::mutex::scoped_lock lock(events_mutex);
+    events.push_back(event);
+}
+
+BOOST_AUTO_TEST_CASE(test_fastpath_events){
+    set_console_output(false);
+    const size_t id = subscribe(&record_event);
+    const boost::uint64_t num_overflows = get_event_count(EVENT_OVERFLOW);
+
+    post_event(EVENT_OVERFLOW, 1, true, uhd::time_spec_t(1.5));
+    post_event(EVENT_UNDERFLOW, 2);
+    BOOST_CHECK_EQUAL(get_event_count(EVENT_OVERFLOW), num_overflows + 1);
+
+    //the background thread delivers them
+    for (size_t i = 0; i < 100; i++){
+        {
+            boost::mutex::scoped_lock lock(events_mutex);
+            if (events.size() >= 2) break;
+        }
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    unsubscribe(id);
+
+    boost::mutex::scoped_lock lock(events_mutex);
+    BOOST_REQUIRE_EQUAL(events.size(), size_t(2));
+    BOOST_CHECK_EQUAL(events[0].type, EVENT_OVERFLOW);
+    BOOST_CHECK_EQUAL(events[0].channel, size_t(1));
+    BOOST_CHECK(events[0].has_time_spec);
+    BOOST_CHECK_EQUAL(events[0].time_spec.get_real_secs(), 1.5);
+    BOOST_CHECK_EQUAL(events[1].type, EVENT_UNDERFLOW);
+    BOOST_CHECK(not events[1].has_time_spec);
+    BOOST_CHECK_EQUAL(events[1].seq, events[0].seq + 1);
+}
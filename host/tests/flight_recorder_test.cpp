@@ -0,0 +1,122 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/flight_recorder.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+using namespace uhd::flight_recorder;
+namespace fs = boost::filesystem;
+
+static void record_packets(const boost::uint32_t sid, const size_t num_packets){
+    for (size_t i = 0; i < num_packets; i++){
+        record(RECORD_RX_PACKET, 1, sid, boost::uint32_t(i), 1000*i, 64, FLAG_HAS_TSF);
+    }
+}
+
+//! Dump, read the file back and return the records of each thread by SID
+static std::map<boost::uint32_t, std::vector<record_t> > dump_records(
+    std::map<boost::uint32_t, boost::uint64_t> &num_lost
+){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("flight_recorder_test_%%%%%%%%.dat");
+    const size_t num_written = dump(path.string());
+
+    std::ifstream in(path.string().c_str(), std::ios::binary);
+    file_header_t header;
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    BOOST_REQUIRE(in);
+    BOOST_CHECK_EQUAL(std::string(header.magic, sizeof(header.magic)), "UHDFLREC");
+    BOOST_CHECK_EQUAL(header.version, boost::uint32_t(1));
+    BOOST_CHECK_EQUAL(header.record_size, boost::uint32_t(sizeof(record_t)));
+    BOOST_CHECK(header.ticks_per_sec > 0);
+
+    std::map<boost::uint32_t, std::vector<record_t> > records;
+    size_t num_read = 0;
+    for (size_t t = 0; t < header.num_threads; t++){
+        thread_header_t thread_header;
+        in.read(reinterpret_cast<char *>(&thread_header), sizeof(thread_header));
+        BOOST_REQUIRE(in);
+        for (size_t i = 0; i < thread_header.num_records; i++){
+            record_t rec;
+            in.read(reinterpret_cast<char *>(&rec), sizeof(rec));
+            BOOST_REQUIRE(in);
+            if (i == 0) num_lost[rec.sid] = thread_header.num_lost;
+            records[rec.sid].push_back(rec);
+        }
+        num_read += thread_header.num_records;
+    }
+    BOOST_CHECK_EQUAL(num_read, num_written);
+    in.close();
+    fs::remove(path);
+    return records;
+}
+
+BOOST_AUTO_TEST_CASE(test_flight_recorder_dump){
+    BOOST_REQUIRE(enabled());
+
+    //one thread fits its ring, the other one wraps around
+    boost::thread few(boost::bind(&record_packets, 0x10, 10));
+    boost::thread many(boost::bind(&record_packets, 0x20, 20000));
+    few.join();
+    many.join();
+
+    std::map<boost::uint32_t, boost::uint64_t> num_lost;
+    std::map<boost::uint32_t, std::vector<record_t> > records = dump_records(num_lost);
+
+    const std::vector<record_t> &few_records = records[0x10];
+    BOOST_REQUIRE_EQUAL(few_records.size(), size_t(10));
+    BOOST_CHECK_EQUAL(num_lost[0x10], boost::uint64_t(0));
+    for (size_t i = 0; i < few_records.size(); i++){
+        BOOST_CHECK_EQUAL(few_records[i].type, boost::uint8_t(RECORD_RX_PACKET));
+        BOOST_CHECK_EQUAL(few_records[i].chan, boost::uint16_t(1));
+        BOOST_CHECK_EQUAL(few_records[i].seq, boost::uint32_t(i));
+        BOOST_CHECK_EQUAL(few_records[i].tsf, boost::uint64_t(1000*i));
+        BOOST_CHECK_EQUAL(few_records[i].value, boost::uint32_t(64));
+        BOOST_CHECK_EQUAL(few_records[i].flags, boost::uint8_t(FLAG_HAS_TSF));
+        if (i > 0) BOOST_CHECK(few_records[i].ticks >= few_records[i-1].ticks);
+    }
+
+    //the newest records are kept, oldest first
+    const std::vector<record_t> &many_records = records[0x20];
+    BOOST_REQUIRE_EQUAL(many_records.size(), size_t(8192));
+    BOOST_CHECK_EQUAL(num_lost[0x20], boost::uint64_t(20000 - 8192));
+    BOOST_CHECK_EQUAL(many_records.front().seq, boost::uint32_t(20000 - 8192));
+    BOOST_CHECK_EQUAL(many_records.back().seq, boost::uint32_t(20000 - 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_flight_recorder_disabled){
+    set_enabled(false);
+    BOOST_CHECK(not enabled());
+    boost::thread thread(boost::bind(&record_packets, 0x30, 10));
+    thread.join();
+    set_enabled(true);
+
+    std::map<boost::uint32_t, boost::uint64_t> num_lost;
+    std::map<boost::uint32_t, std::vector<record_t> > records = dump_records(num_lost);
+    BOOST_CHECK_EQUAL(records.count(0x30), size_t(0));
+}
+
+BOOST_AUTO_TEST_CASE(test_flight_recorder_bad_path){
+    BOOST_CHECK_THROW(dump("/nonexistent/dir/flight_recorder.dat"), uhd::io_error);
+}
@@ -120,3 +120,64 @@ BOOST_AUTO_TEST_CASE(test_gain_group_priority){
     //test the the higher priority gain got filled first (gain 2)
     BOOST_CHECK_CLOSE(g2.get_value(), g2.get_range().stop(), tolerance);
 }
+
+/***********************************************************************
+ * Gain element with a range that depends on the band
+ **********************************************************************/
+class gain_element_banded{
+public:
+    gain_element_banded(void): _max(30), _gain(0){}
+
+    gain_range_t get_range(void){
+        return gain_range_t(0, _max, 1);
+    }
+
+    double get_value(void){
+        return _gain;
+    }
+
+    void set_value(double gain){
+        _gain = gain;
+    }
+
+    void set_band_max(double max){
+        _max = max;
+    }
+
+private:
+    double _max;
+    double _gain;
+};
+
+BOOST_AUTO_TEST_CASE(test_gain_group_range_change){
+    gain_element_banded ge1, ge2;
+    gain_fcns_t gain_fcns;
+    gain_group::sptr gg(gain_group::make());
+
+    gain_fcns.get_range = boost::bind(&gain_element_banded::get_range, &ge1);
+    gain_fcns.get_value = boost::bind(&gain_element_banded::get_value, &ge1);
+    gain_fcns.set_value = boost::bind(&gain_element_banded::set_value, &ge1, _1);
+    gg->register_fcns("ge1", gain_fcns, 1);
+
+    gain_fcns.get_range = boost::bind(&gain_element_banded::get_range, &ge2);
+    gain_fcns.get_value = boost::bind(&gain_element_banded::get_value, &ge2);
+    gain_fcns.set_value = boost::bind(&gain_element_banded::set_value, &ge2, _1);
+    gg->register_fcns("ge2", gain_fcns, 0);
+
+    gg->set_value(40);
+    BOOST_CHECK_CLOSE(ge1.get_value(), 30.0, tolerance);
+    BOOST_CHECK_CLOSE(ge2.get_value(), 10.0, tolerance);
+
+    //an element set by name is rewritten by the next overall set
+    gg->set_value(5, "ge1");
+    gg->set_value(40);
+    BOOST_CHECK_CLOSE(ge1.get_value(), 30.0, tolerance);
+    BOOST_CHECK_CLOSE(ge2.get_value(), 10.0, tolerance);
+
+    //the same overall gain is redistributed for the new ranges
+    ge1.set_band_max(20);
+    gg->set_value(40);
+    BOOST_CHECK_CLOSE(ge1.get_value(), 20.0, tolerance);
+    BOOST_CHECK_CLOSE(ge2.get_value(), 20.0, tolerance);
+    BOOST_CHECK_CLOSE(gg->get_value(), 40.0, tolerance);
+}
@@ -0,0 +1,140 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/usrp/cores/gpio_atr_3000.hpp"
+#include <uhd/exception.hpp>
+#include <boost/make_shared.hpp>
+#include <deque>
+#include <utility>
+
+using namespace uhd;
+using namespace uhd::usrp::gpio_atr;
+
+static const size_t QUEUE_SIZE = 4;
+
+//! A command queue that executes timed writes once the test moves the device time past them
+class fake_timed_iface : public timed_wb_iface
+{
+public:
+    fake_timed_iface(void): reg(0), _time(0.0), _now(0.0) {}
+
+    void poke32(const wb_addr_type, const uint32_t data)
+    {
+        this->execute();
+        if (_time == time_spec_t(0.0)) reg = data;
+        else _queue.push_back(std::make_pair(_time, data));
+    }
+
+    uint32_t peek32(const wb_addr_type) { return reg; }
+
+    time_spec_t get_time(void) { return _time; }
+    void set_time(const time_spec_t &t) { _time = t; }
+
+    size_t get_cmd_queue_space(void)
+    {
+        this->execute();
+        return QUEUE_SIZE - _queue.size();
+    }
+
+    bool try_poke32(const wb_addr_type addr, const uint32_t data)
+    {
+        if (this->get_cmd_queue_space() == 0) return false;
+        this->poke32(addr, data);
+        return true;
+    }
+
+    void set_cmd_done_handler(const cmd_done_handler_t &handler) { _handler = handler; }
+
+    void set_now(const time_spec_t &now) { _now = now; }
+
+    uint32_t reg;
+
+private:
+    void execute(void)
+    {
+        while (not _queue.empty() and _queue.front().first <= _now) {
+            reg = _queue.front().second;
+            if (_handler) _handler(_queue.front().first);
+            _queue.pop_front();
+        }
+    }
+
+    time_spec_t _time;
+    time_spec_t _now;
+    std::deque<std::pair<time_spec_t, uint32_t> > _queue;
+    cmd_done_handler_t _handler;
+};
+
+BOOST_AUTO_TEST_CASE(test_gpio_sequence)
+{
+    boost::shared_ptr<fake_timed_iface> iface = boost::make_shared<fake_timed_iface>();
+    gpio_atr_3000::sptr gpio = gpio_atr_3000::make_write_only(iface, 0);
+    gpio->set_atr_mode(MODE_GPIO, 0xff);
+
+    // Toggle bit 0 every 10 ms, bit 1 stays set
+    gpio->set_gpio_out(0x2, 0x2);
+    std::vector<gpio_atr_3000::gpio_event_t> events;
+    for (size_t i = 0; i < 10; i++) {
+        events.push_back(gpio_atr_3000::gpio_event_t(time_spec_t(1.0 + 0.01*i), i % 2, 0x1));
+    }
+    BOOST_CHECK_EQUAL(gpio->set_gpio_sequence(events), QUEUE_SIZE);
+    BOOST_CHECK_EQUAL(iface->reg, 0x2);
+    BOOST_CHECK(iface->get_time() == time_spec_t(0.0));
+
+    gpio_atr_3000::gpio_sequence_status_t status = gpio->get_gpio_sequence_status();
+    BOOST_CHECK_EQUAL(status.num_queued, 10 - QUEUE_SIZE);
+    BOOST_CHECK_EQUAL(status.num_pending, QUEUE_SIZE);
+    BOOST_CHECK_EQUAL(status.num_late, 0);
+
+    // Two writes execute, two more go out
+    iface->set_now(time_spec_t(1.015));
+    status = gpio->get_gpio_sequence_status();
+    BOOST_CHECK_EQUAL(iface->reg, 0x3);
+    BOOST_CHECK_EQUAL(status.num_queued, 10 - QUEUE_SIZE - 2);
+    BOOST_CHECK_EQUAL(status.num_pending, QUEUE_SIZE);
+
+    // Everything executes, the last write set bit 0
+    for (size_t i = 0; i < 5; i++) {
+        iface->set_now(time_spec_t(2.0));
+        status = gpio->get_gpio_sequence_status();
+    }
+    BOOST_CHECK_EQUAL(status.num_queued, 0);
+    BOOST_CHECK_EQUAL(status.num_pending, 0);
+    BOOST_CHECK_EQUAL(status.num_late, 0);
+    BOOST_CHECK_EQUAL(iface->reg, 0x3);
+
+    // A write for a time the device already passed is late
+    events.assign(1, gpio_atr_3000::gpio_event_t(events.back().time, 0x0, 0x2));
+    BOOST_CHECK_EQUAL(gpio->set_gpio_sequence(events), 1);
+    BOOST_CHECK_EQUAL(gpio->get_gpio_sequence_status().num_late, 1);
+    BOOST_CHECK_EQUAL(iface->reg, 0x1);
+}
+
+BOOST_AUTO_TEST_CASE(test_gpio_sequence_order)
+{
+    boost::shared_ptr<fake_timed_iface> iface = boost::make_shared<fake_timed_iface>();
+    gpio_atr_3000::sptr gpio = gpio_atr_3000::make_write_only(iface, 0);
+
+    std::vector<gpio_atr_3000::gpio_event_t> events;
+    events.push_back(gpio_atr_3000::gpio_event_t(time_spec_t(2.0), 0x1));
+    events.push_back(gpio_atr_3000::gpio_event_t(time_spec_t(1.0), 0x0));
+    BOOST_CHECK_THROW(gpio->set_gpio_sequence(events), uhd::value_error);
+    events.assign(1, gpio_atr_3000::gpio_event_t(time_spec_t(0.0), 0x1));
+    BOOST_CHECK_THROW(gpio->set_gpio_sequence(events), uhd::value_error);
+    BOOST_CHECK_EQUAL(gpio->get_gpio_sequence_status().num_queued, 0);
+}
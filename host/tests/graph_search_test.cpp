@@ -167,3 +167,27 @@ BOOST_AUTO_TEST_CASE(test_mini_cycle_downstream_and_upstream)
     BOOST_REQUIRE_EQUAL(result.size(), 1);
     BOOST_REQUIRE(result[0] == node_A);
 }
+
+BOOST_AUTO_TEST_CASE(test_search_after_reconnect)
+{
+    MAKE_NODE(node_A);
+    MAKE_RESULT_NODE(node_B);
+    MAKE_RESULT_NODE(node_C);
+
+    connect_nodes(node_A, node_B);
+    std::vector< result_node::sptr > result = node_A->find_downstream_node<result_node>();
+    BOOST_REQUIRE_EQUAL(result.size(), 1);
+    BOOST_CHECK(result[0] == node_B);
+    // Searching again must give the same result
+    result = node_A->find_downstream_node<result_node>();
+    BOOST_REQUIRE_EQUAL(result.size(), 1);
+    BOOST_CHECK(result[0] == node_B);
+
+    // Changing the graph anywhere must show up in the next search
+    node_B->disconnect();
+    BOOST_CHECK(node_A->find_downstream_node<result_node>().empty());
+    connect_nodes(node_A, node_C);
+    result = node_A->find_downstream_node<result_node>();
+    BOOST_REQUIRE_EQUAL(result.size(), 1);
+    BOOST_CHECK(result[0] == node_C);
+}
@@ -0,0 +1,66 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/host_check.hpp>
+#include <boost/foreach.hpp>
+
+using namespace uhd::host_check;
+
+BOOST_AUTO_TEST_CASE(test_host_check_report){
+    report_t report;
+    report.iface = "eth1";
+    item_t item;
+    item.name = "net.core.rmem_max";
+    item.value = "212992";
+    item.wanted = "33554432";
+    item.ok = false;
+    item.fix = "sudo sysctl -w net.core.rmem_max=33554432";
+    report.items.push_back(item);
+    item.name = "MTU of eth1";
+    item.value = "9000";
+    item.ok = true;
+    item.fix = "";
+    report.items.push_back(item);
+
+    BOOST_CHECK_EQUAL(report.num_deficits(), size_t(1));
+    const std::string pp = report.to_pp_string();
+    BOOST_CHECK(pp.find("eth1") != std::string::npos);
+    BOOST_CHECK(pp.find("sudo sysctl -w net.core.rmem_max=33554432") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_host_check_loopback){
+    const report_t report = check("127.0.0.1", 8000, 1024, 0);
+#ifdef UHD_PLATFORM_LINUX
+    BOOST_CHECK_EQUAL(report.iface, "lo");
+    bool checked_rmem = false;
+    BOOST_FOREACH(const item_t &item, report.items){
+        BOOST_CHECK(item.ok or not item.fix.empty());
+        if (item.name == "net.core.rmem_max") checked_rmem = true;
+        //a send buffer of 0 skips its check
+        BOOST_CHECK(item.name != "net.core.wmem_max");
+    }
+    BOOST_CHECK(checked_rmem);
+#else
+    BOOST_CHECK(report.items.empty());
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_host_check_bad_addr){
+    const report_t report = check("not an address", 8000, 0, 0);
+    BOOST_CHECK(report.iface.empty());
+}
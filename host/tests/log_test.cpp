@@ -0,0 +1,37 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/log.hpp>
+
+static int num_evaluations = 0;
+
+static int evaluate(void){
+    return ++num_evaluations;
+}
+
+BOOST_AUTO_TEST_CASE(test_log_disabled_args){
+    //nothing is more often than always: disabled unless UHD_LOG_LEVEL=1
+    if (uhd::_log::log::is_enabled(uhd::_log::always)) return;
+    UHD_LOGV(always) << "not evaluated: " << evaluate() << std::endl;
+    BOOST_CHECK_EQUAL(num_evaluations, 0);
+
+    //the macro is a single statement
+    if (num_evaluations == 0) UHD_LOGV(always) << evaluate();
+    else BOOST_ERROR("dangling else");
+    BOOST_CHECK_EQUAL(num_evaluations, 0);
+}
@@ -0,0 +1,149 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include "../lib/usrp/loopback/loopback_ring.hpp"
+#include "../lib/transport/super_recv_packet_handler.hpp"
+#include "../lib/transport/super_send_packet_handler.hpp"
+#include <uhd/device.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <boost/make_shared.hpp>
+#include <complex>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static const double TICK_RATE = 100e6;
+static const double SAMP_RATE = 1e6;
+static const size_t SPP = 100;
+
+static std::vector<std::complex<int16_t> > make_samples(const size_t nsamps)
+{
+    std::vector<std::complex<int16_t> > samps(nsamps);
+    for (size_t i = 0; i < nsamps; i++) {
+        samps[i] = std::complex<int16_t>(int16_t(i), int16_t(-int(i) - 1));
+    }
+    return samps;
+}
+
+/***********************************************************************
+ * A send streamer and a recv streamer on both ends of a ring
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_ring_round_trip){
+    loopback_ring::sptr ring = loopback_ring::make(8, 16 + SPP*4);
+
+    sph::send_packet_streamer tx(SPP);
+    tx.resize(1);
+    tx.set_vrt_packer(&vrt::chdr::if_hdr_pack_le);
+    tx.set_tick_rate(TICK_RATE);
+    tx.set_samp_rate(SAMP_RATE);
+    tx.set_xport_chan(0, ring);
+    tx.set_xport_chan_sid(0, true, 0);
+    tx.set_enable_trailer(false);
+    convert::id_type tx_id;
+    tx_id.input_format = "sc16";
+    tx_id.num_inputs = 1;
+    tx_id.output_format = "sc16_item32_le";
+    tx_id.num_outputs = 1;
+    tx.set_converter(tx_id);
+
+    sph::recv_packet_streamer rx(SPP);
+    rx.resize(1);
+    rx.set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_le);
+    rx.set_tick_rate(TICK_RATE);
+    rx.set_samp_rate(SAMP_RATE);
+    rx.set_xport_chan(0, ring);
+    convert::id_type rx_id;
+    rx_id.input_format = "sc16_item32_le";
+    rx_id.num_inputs = 1;
+    rx_id.output_format = "sc16";
+    rx_id.num_outputs = 1;
+    rx.set_converter(rx_id);
+
+    // A timed burst of two and a half packets
+    const size_t nsamps = 250;
+    const time_spec_t start_time(1.5);
+    const std::vector<std::complex<int16_t> > samps = make_samples(nsamps);
+    tx_metadata_t tx_md;
+    tx_md.start_of_burst = true;
+    tx_md.end_of_burst = true;
+    tx_md.has_time_spec = true;
+    tx_md.time_spec = start_time;
+    BOOST_REQUIRE_EQUAL(tx.send(&samps.front(), nsamps, tx_md, 1.0), nsamps);
+
+    // Each packet comes out with its samples and the time of its first one
+    std::vector<std::complex<int16_t> > result(nsamps);
+    size_t num_recvd = 0;
+    rx_metadata_t rx_md;
+    while (num_recvd < nsamps) {
+        const size_t n = rx.recv(&result[num_recvd], nsamps - num_recvd, rx_md, 1.0, true);
+        BOOST_REQUIRE_EQUAL(rx_md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_REQUIRE(n > 0);
+        BOOST_CHECK(rx_md.has_time_spec);
+        BOOST_CHECK_EQUAL(
+            rx_md.time_spec.to_ticks(TICK_RATE),
+            (start_time + time_spec_t::from_ticks(num_recvd, SAMP_RATE)).to_ticks(TICK_RATE));
+        num_recvd += n;
+        BOOST_CHECK_EQUAL(rx_md.end_of_burst, num_recvd == nsamps);
+    }
+    BOOST_CHECK(result == samps);
+
+    // Nothing more was queued
+    rx.recv(&result.front(), nsamps, rx_md, 0.01, true);
+    BOOST_CHECK_EQUAL(rx_md.error_code, rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+/***********************************************************************
+ * Timestamps through the device
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_device_timestamps){
+    device::sptr dev = device::make(device_addr_t("type=loopback,throttle=0,master_clock_rate=1e6"), device::USRP);
+    stream_args_t args("sc16");
+
+    // The end of a timed TX burst is acknowledged at its last sample
+    tx_streamer::sptr tx = dev->get_tx_stream(args);
+    const std::vector<std::complex<int16_t> > samps = make_samples(5000);
+    tx_metadata_t tx_md;
+    tx_md.start_of_burst = true;
+    tx_md.end_of_burst = true;
+    tx_md.has_time_spec = true;
+    tx_md.time_spec = time_spec_t(2.0);
+    BOOST_REQUIRE_EQUAL(tx->send(&samps.front(), samps.size(), tx_md, 1.0), samps.size());
+    async_metadata_t async_md;
+    BOOST_REQUIRE(tx->recv_async_msg(async_md, 1.0));
+    BOOST_CHECK_EQUAL(async_md.event_code, async_metadata_t::EVENT_CODE_BURST_ACK);
+    BOOST_CHECK_EQUAL(async_md.time_spec.to_ticks(1e6), 2000000 + 5000);
+
+    // A timed RX command yields exactly its samples, from its time on
+    rx_streamer::sptr rx = dev->get_rx_stream(args);
+    stream_cmd_t cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    cmd.num_samps = 3000;
+    cmd.stream_now = false;
+    cmd.time_spec = time_spec_t(3.0);
+    rx->issue_stream_cmd(cmd);
+    std::vector<std::complex<int16_t> > result(cmd.num_samps, std::complex<int16_t>(1, 1));
+    size_t num_recvd = 0;
+    rx_metadata_t rx_md;
+    while (num_recvd < cmd.num_samps) {
+        const size_t n = rx->recv(&result[num_recvd], cmd.num_samps - num_recvd, rx_md, 1.0, true);
+        BOOST_REQUIRE_EQUAL(rx_md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_EQUAL(rx_md.time_spec.to_ticks(1e6), (long long)(3000000 + num_recvd));
+        num_recvd += n;
+    }
+    BOOST_CHECK(rx_md.end_of_burst);
+    BOOST_CHECK(result == std::vector<std::complex<int16_t> >(cmd.num_samps));
+}
@@ -325,6 +325,19 @@ class functable_mockup_impl : public function_table
         throw uhd::syntax_error("eval(): unknown function");
     }
 
+    function_table::function_ptr get_function(
+            const std::string &name,
+            const expression_function::argtype_list_type &arg_types
+    ) const {
+        if (not function_exists(name, arg_types)) {
+            throw uhd::syntax_error("get_function(): unknown function");
+        }
+        return boost::bind(
+            &functable_mockup_impl::eval,
+            const_cast<functable_mockup_impl *>(this), name, arg_types, _1
+        );
+    }
+
     // We don't actually need this
     void register_function(
             const std::string &,
@@ -30,6 +30,7 @@
 #include "nocscript_common.hpp"
 
 const int SPP_VALUE = 64;
+int count_value = 0;
 
 // Need those for the variable testing:
 expression::type_t variable_get_type(const std::string &var_name)
@@ -42,6 +43,9 @@ expression::type_t variable_get_type(const std::string &var_name)
         std::cout << "Returning type for $is_true..." << std::endl;
         return expression::TYPE_BOOL;
     }
+    if (var_name == "count") {
+        return expression::TYPE_INT;
+    }
 
     throw uhd::syntax_error("Cannot infer type (unknown variable)");
 }
@@ -56,6 +60,9 @@ expression_literal variable_get_value(const std::string &var_name)
         std::cout << "Returning value for $is_true..." << std::endl;
         return expression_literal(true);
     }
+    if (var_name == "count") {
+        return expression_literal(count_value);
+    }
 
     throw uhd::syntax_error("Cannot read value (unknown variable)");
 }
@@ -109,6 +116,20 @@ BOOST_AUTO_TEST_CASE(test_adds_with_vars)
     BOOST_CHECK_EQUAL(result.get_int(), 1+2+SPP_VALUE);
 }
 
+BOOST_AUTO_TEST_CASE(test_reeval)
+{
+    SETUP_FT_AND_PARSER();
+
+    // Trees are parsed once and evaluated many times, so every eval() must
+    // see the current values of the variables
+    expression::sptr e = p->create_expr_tree("ADD(MULT($count, 2), 1)");
+    for (count_value = 0; count_value < 4; count_value++) {
+        expression_literal result = e->eval();
+        BOOST_REQUIRE_EQUAL(result.infer_type(), expression::TYPE_INT);
+        BOOST_CHECK_EQUAL(result.get_int(), 2*count_value + 1);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_fft_check)
 {
     SETUP_FT_AND_PARSER();
@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/property_tree.hpp>
+#include <uhd/types/wb_iface.hpp>
 #include <boost/bind.hpp>
 #include <exception>
 #include <iostream>
@@ -209,6 +210,112 @@ BOOST_AUTO_TEST_CASE(test_prop_tree){
 
 }
 
+BOOST_AUTO_TEST_CASE(test_prop_tree_resolve){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+
+    tree->create<int>("/test/prop2");
+    tree->create<int>("/test/prop0");
+    tree->create<int>("/test/prop1");
+
+    // Listing keeps the order of creation
+    const std::vector<std::string> props = tree->list("/test");
+    BOOST_REQUIRE_EQUAL(props.size(), 3);
+    BOOST_CHECK_EQUAL(props[0], "prop2");
+    BOOST_CHECK_EQUAL(props[1], "prop0");
+    BOOST_CHECK_EQUAL(props[2], "prop1");
+
+    boost::shared_ptr<uhd::property<int> > prop0 = tree->resolve<int>("/test/prop0");
+    prop0->set(42);
+    BOOST_CHECK_EQUAL(tree->access<int>("/test/prop0").get(), 42);
+    BOOST_CHECK(&tree->access<int>("/test/prop0") == prop0.get());
+    BOOST_CHECK_THROW(tree->resolve<int>("/test/prop3"), uhd::lookup_error);
+
+    // The resolved property outlives its removal from the tree
+    tree->remove("/test/prop0");
+    BOOST_CHECK_EQUAL(prop0->get(), 42);
+    BOOST_CHECK_EQUAL(tree->list("/test").size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_prop_tree_txn){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+
+    setter_type freq_setter, gain_setter;
+    coercer_type coercer;
+    uhd::property<int> &freq = tree->create<int>("/rx/freq")
+        .set(0)
+        .set_coercer(boost::bind(&coercer_type::doit, &coercer, _1))
+        .add_coerced_subscriber(boost::bind(&setter_type::doit, &freq_setter, _1));
+    uhd::property<int> &gain = tree->create<int>("/rx/gain")
+        .set(0)
+        .add_desired_subscriber(boost::bind(&setter_type::doit, &gain_setter, _1));
+    freq_setter._count = gain_setter._count = 0;
+
+    // Nothing is notified until the outermost commit
+    tree->begin_txn();
+    freq.set(33);
+    gain.set(5);
+    tree->subtree("/rx")->begin_txn();
+    freq.set(42);
+    tree->subtree("/rx")->commit();
+    BOOST_CHECK_EQUAL(freq_setter._count, 0);
+    BOOST_CHECK_EQUAL(gain_setter._count, 0);
+    BOOST_CHECK_EQUAL(freq.get_desired(), 42);
+    BOOST_CHECK_EQUAL(freq.get(), 0);
+    tree->commit();
+
+    // Every property is notified once, with its last value
+    BOOST_CHECK_EQUAL(freq_setter._count, 1);
+    BOOST_CHECK_EQUAL(freq_setter._x, 40);
+    BOOST_CHECK_EQUAL(freq.get(), 40);
+    BOOST_CHECK_EQUAL(gain_setter._count, 1);
+    BOOST_CHECK_EQUAL(gain_setter._x, 5);
+
+    // Without a transaction, subscribers run right away again
+    gain.set(6);
+    BOOST_CHECK_EQUAL(gain_setter._count, 2);
+    BOOST_CHECK_THROW(tree->commit(), uhd::runtime_error);
+}
+
+struct batch_iface_type : uhd::wb_iface{
+    batch_iface_type() : _begins(0), _commits(0) {}
+
+    void poke32(const wb_addr_type, const uint32_t){}
+    uint32_t peek32(const wb_addr_type){ return 0; }
+    void begin_batch(void){ _begins++; }
+    void commit(void){ _commits++; }
+
+    int _begins;
+    int _commits;
+};
+
+BOOST_AUTO_TEST_CASE(test_prop_tree_batch){
+    uhd::property_tree::sptr tree = uhd::property_tree::make();
+    boost::shared_ptr<batch_iface_type> iface(new batch_iface_type());
+    tree->add_batch_iface(iface);
+
+    setter_type setter;
+    uhd::property<int> &freq = tree->create<int>("/rx/freq")
+        .set(0)
+        .add_coerced_subscriber(boost::bind(&setter_type::doit, &setter, _1));
+    setter._count = 0;
+
+    // A batch does not defer the subscribers
+    tree->begin_batch();
+    BOOST_CHECK_EQUAL(iface->_begins, 1);
+    freq.set(42);
+    BOOST_CHECK_EQUAL(setter._count, 1);
+    BOOST_CHECK_EQUAL(freq.get(), 42);
+    BOOST_CHECK_EQUAL(iface->_commits, 0);
+    tree->commit_batch();
+    BOOST_CHECK_EQUAL(iface->_commits, 1);
+
+    // Transactions batch the writes as well
+    tree->begin_txn();
+    tree->commit();
+    BOOST_CHECK_EQUAL(iface->_begins, 2);
+    BOOST_CHECK_EQUAL(iface->_commits, 2);
+}
+
 BOOST_AUTO_TEST_CASE(test_prop_subtree){
     uhd::property_tree::sptr tree = uhd::property_tree::make();
     tree->create<int>("/subdir1/subdir2");
@@ -0,0 +1,245 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../lib/usrp/replay/replay_capture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/flight_recorder.hpp>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace uhd::transport;
+namespace fs = boost::filesystem;
+namespace fr = uhd::flight_recorder;
+
+static const uint32_t SID_A = 0x00a00010;
+static const uint32_t SID_B = 0x00a00020;
+static const size_t NSAMPS = 25; //sc16, 100 bytes of payload
+
+typedef std::vector<uint32_t> packet_t;
+
+//! A big endian CHDR packet with a time and a ramp as the payload
+static packet_t make_packet(
+    const uint32_t sid, const size_t seq, const uint64_t tsf,
+    const vrt::if_packet_info_t::packet_type_t type = vrt::if_packet_info_t::PACKET_TYPE_DATA
+){
+    vrt::if_packet_info_t info;
+    info.packet_type = type;
+    info.has_sid = true;
+    info.sid = sid;
+    info.has_cid = info.has_tsi = info.has_tlr = false;
+    info.has_tsf = true;
+    info.tsf = tsf;
+    info.sob = info.eob = false;
+    info.error = (type == vrt::if_packet_info_t::PACKET_TYPE_ERROR);
+    info.packet_count = seq;
+    info.num_payload_words32 = (type == vrt::if_packet_info_t::PACKET_TYPE_DATA) ? NSAMPS : 2;
+    info.num_payload_bytes = info.num_payload_words32*4;
+    packet_t packet(4 + info.num_payload_words32);
+    vrt::chdr::if_hdr_pack_be(&packet.front(), info);
+    for (size_t i = 4; i < packet.size(); i++) packet[i] = uhd::htonx(uint32_t(seq*1000 + i));
+    return packet;
+}
+
+static std::vector<packet_t> make_packets(void)
+{
+    std::vector<packet_t> packets;
+    packets.push_back(make_packet(SID_A, 0, 0));
+    packets.push_back(make_packet(SID_B, 0, 0));
+    packets.push_back(make_packet(SID_A, 1, 100));
+    packets.push_back(make_packet(SID_A, 0, 0, vrt::if_packet_info_t::PACKET_TYPE_FC)); //not replayed
+    packets.push_back(make_packet(SID_A, 2, 200));
+    packets.push_back(make_packet(SID_A, 3, 300, vrt::if_packet_info_t::PACKET_TYPE_ERROR));
+    packets.push_back(make_packet(SID_B, 1, 100));
+    packets.push_back(make_packet(0x00a00030, 0, 0, vrt::if_packet_info_t::PACKET_TYPE_FC)); //no data
+    return packets;
+}
+
+static fs::path temp_path(void)
+{
+    return fs::temp_directory_path() / fs::unique_path("replay_capture_test_%%%%%%%%");
+}
+
+static void put16_net(std::vector<char> &buf, const size_t off, const uint16_t val)
+{
+    buf[off] = char(val >> 8);
+    buf[off + 1] = char(val & 0xff);
+}
+
+//! Ethernet/IPv4/UDP frames in a pcap file, one every millisecond
+static void write_pcap(const fs::path &path, const std::vector<packet_t> &packets)
+{
+    std::ofstream out(path.string().c_str(), std::ios::binary);
+    const uint32_t global[6] = {0xa1b2c3d4, 0x00040002, 0, 0, 65535, 1};
+    out.write(reinterpret_cast<const char *>(global), sizeof(global));
+    for (size_t i = 0; i < packets.size(); i++) {
+        const size_t payload_len = packets[i].size()*4;
+        std::vector<char> frame(14 + 20 + 8 + payload_len, 0);
+        put16_net(frame, 12, 0x0800);
+        frame[14] = 0x45;
+        put16_net(frame, 16, uint16_t(20 + 8 + payload_len));
+        frame[14 + 9] = 17;
+        put16_net(frame, 34 + 4, uint16_t(8 + payload_len));
+        std::memcpy(&frame[42], &packets[i].front(), payload_len);
+        const uint32_t rec[4] = {10, uint32_t(i*1000), uint32_t(frame.size()), uint32_t(frame.size())};
+        out.write(reinterpret_cast<const char *>(rec), sizeof(rec));
+        out.write(&frame.front(), frame.size());
+    }
+}
+
+static void check_streams(replay_capture::sptr capture, const double tick_time)
+{
+    const std::vector<replay_capture::stream_t> &streams = capture->get_streams();
+    BOOST_REQUIRE_EQUAL(streams.size(), size_t(2));
+    BOOST_CHECK_EQUAL(streams[0].sid, SID_A);
+    BOOST_CHECK_EQUAL(streams[1].sid, SID_B);
+    BOOST_REQUIRE_EQUAL(streams[0].packets.size(), size_t(4)); //3 data, 1 error
+    BOOST_REQUIRE_EQUAL(streams[1].packets.size(), size_t(2));
+    BOOST_CHECK_EQUAL(streams[0].max_payload_bytes, NSAMPS*4);
+    BOOST_CHECK_CLOSE(streams[0].ticks_per_byte, 1.0, 1e-9);
+    BOOST_CHECK_EQUAL(streams[0].packets[0].size, uint32_t(16 + NSAMPS*4));
+    BOOST_CHECK_EQUAL(streams[0].packets[3].size, uint32_t(16 + 8));
+    BOOST_CHECK_CLOSE(streams[0].packets[2].time, 200*tick_time, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_pcap){
+    const std::vector<packet_t> packets = make_packets();
+    const fs::path path = temp_path();
+    write_pcap(path, packets);
+
+    replay_capture::protocol_t protocol;
+    protocol.vrt = false;
+    protocol.big_endian = true;
+    {
+        replay_capture::sptr capture = replay_capture::make(path.string(), protocol, 100.0);
+        BOOST_CHECK_EQUAL(capture->get_format(), replay_capture::FORMAT_PCAP);
+        //packets follow one every millisecond, data packet 2 of SID A is the 5th
+        check_streams(capture, 4e-3/200);
+
+        //the packets come back as they were captured
+        std::vector<uint32_t> frame(1024, 0);
+        const replay_capture::stream_t &stream = capture->get_streams()[0];
+        const uint32_t *mem = static_cast<const uint32_t *>(capture->get_packet(stream.packets[1], &frame.front()));
+        BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(mem) % 4, size_t(0));
+        BOOST_CHECK(std::memcmp(mem, &packets[2].front(), packets[2].size()*4) == 0);
+    }
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_raw){
+    const std::vector<packet_t> packets = make_packets();
+    const fs::path path = temp_path();
+    {
+        //CHDR packets start on 8 byte boundaries
+        std::ofstream out(path.string().c_str(), std::ios::binary);
+        for (size_t i = 0; i < packets.size(); i++) {
+            packet_t padded = packets[i];
+            if (padded.size() % 2) padded.push_back(0);
+            out.write(reinterpret_cast<const char *>(&padded.front()), padded.size()*4);
+        }
+    }
+
+    replay_capture::protocol_t protocol;
+    protocol.vrt = false;
+    protocol.big_endian = true;
+    {
+        replay_capture::sptr capture = replay_capture::make(path.string(), protocol, 100.0);
+        BOOST_CHECK_EQUAL(capture->get_format(), replay_capture::FORMAT_RAW);
+        //the times come from the packets, at 100 ticks per second
+        check_streams(capture, 1.0/100);
+    }
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_flight_recorder){
+    const fs::path path = temp_path();
+    {
+        std::ofstream out(path.string().c_str(), std::ios::binary);
+        fr::file_header_t header;
+        std::memcpy(header.magic, "UHDFLREC", 8);
+        header.version = 1;
+        header.record_size = sizeof(fr::record_t);
+        header.ticks_per_sec = 1000;
+        header.num_threads = 2;
+        header.reserved = 0;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        //two threads of two records each, interleaved in time
+        for (uint32_t t = 0; t < 2; t++) {
+            const fr::thread_header_t thread_header = {t, 3, 0};
+            out.write(reinterpret_cast<const char *>(&thread_header), sizeof(thread_header));
+            for (uint32_t i = 0; i < 3; i++) {
+                fr::record_t record;
+                std::memset(&record, 0, sizeof(record));
+                record.ticks = 1000 + 10*i + t;
+                record.tsf = 100*i;
+                record.sid = t ? SID_B : SID_A;
+                record.seq = i;
+                record.value = uint32_t(16 + NSAMPS*4);
+                record.type = (i == 2) ? uint8_t(fr::RECORD_FLOW_CTRL) : uint8_t(fr::RECORD_RX_PACKET);
+                record.flags = fr::FLAG_HAS_TSF;
+                out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            }
+        }
+    }
+
+    replay_capture::protocol_t protocol;
+    protocol.vrt = true;
+    protocol.big_endian = true;
+    {
+        replay_capture::sptr capture = replay_capture::make(path.string(), protocol, 100.0);
+        BOOST_CHECK_EQUAL(capture->get_format(), replay_capture::FORMAT_FLIGHT_RECORDER);
+        BOOST_CHECK(not capture->get_protocol().vrt);
+        BOOST_CHECK(not capture->get_protocol().big_endian);
+        const std::vector<replay_capture::stream_t> &streams = capture->get_streams();
+        BOOST_REQUIRE_EQUAL(streams.size(), size_t(2));
+        BOOST_REQUIRE_EQUAL(streams[1].packets.size(), size_t(2));
+        BOOST_CHECK_CLOSE(streams[1].packets[1].time, 11e-3, 1e-6);
+        BOOST_CHECK_CLOSE(streams[1].ticks_per_byte, 1.0, 1e-9);
+
+        //the packets are made up from the records
+        std::vector<uint32_t> frame(1024, 0);
+        const uint32_t *mem = static_cast<const uint32_t *>(capture->get_packet(streams[1].packets[1], &frame.front()));
+        vrt::if_packet_info_t info;
+        info.num_packet_words32 = streams[1].packets[1].size/4;
+        vrt::chdr::if_hdr_unpack_le(mem, info);
+        BOOST_CHECK_EQUAL(info.sid, SID_B);
+        BOOST_CHECK_EQUAL(info.packet_count, size_t(1));
+        BOOST_CHECK_EQUAL(info.tsf, uint64_t(100));
+        BOOST_CHECK_EQUAL(info.num_payload_bytes, NSAMPS*4);
+    }
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_replay_errors){
+    replay_capture::protocol_t protocol;
+    protocol.vrt = false;
+    protocol.big_endian = true;
+    BOOST_CHECK_THROW(replay_capture::make("/nonexistent/replay", protocol, 100.0), uhd::io_error);
+
+    const fs::path path = temp_path();
+    {
+        std::ofstream out(path.string().c_str(), std::ios::binary);
+        const uint32_t pcapng[8] = {0x0a0d0d0a, 28, 0x1a2b3c4d, 1, 0xffffffff, 0xffffffff, 28, 0};
+        out.write(reinterpret_cast<const char *>(pcapng), sizeof(pcapng));
+    }
+    BOOST_CHECK_THROW(replay_capture::make(path.string(), protocol, 100.0), uhd::io_error);
+    fs::remove(path);
+}
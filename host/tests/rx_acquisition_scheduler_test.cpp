@@ -0,0 +1,201 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/rx_acquisition_scheduler.hpp>
+#include <uhd/exception.hpp>
+#include <boost/make_shared.hpp>
+#include <deque>
+#include <vector>
+
+using namespace uhd;
+
+static const double SAMP_RATE = 1e6;
+static const size_t SPP = 100;
+
+/***********************************************************************
+ * A streamer that runs its stream commands like a radio: in order, each
+ * at its time or right after the one before, in packets of SPP samples
+ * that hold their sample number
+ **********************************************************************/
+class cmd_rx_streamer : public rx_streamer
+{
+public:
+    cmd_rx_streamer(void): _pos(0), _next_tick(0), _overflow_at(-1) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return SPP; }
+
+    void issue_stream_cmd(const stream_cmd_t &cmd)
+    {
+        cmds.push_back(cmd);
+        if (cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS) {
+            _queue.clear();
+            _pos = 0;
+        } else {
+            _queue.push_back(cmd);
+        }
+    }
+
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &md,
+        const double,
+        const bool
+    ){
+        md.reset();
+        if (_queue.empty()) {
+            md.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        const stream_cmd_t &cmd = _queue.front();
+        if (_pos == 0 and not cmd.stream_now) {
+            _next_tick = cmd.time_spec.to_ticks(SAMP_RATE);
+        }
+        if (_next_tick == _overflow_at) {
+            _overflow_at = -1;
+            md.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+        const size_t nsamps = std::min(std::min(nsamps_per_buff, SPP), cmd.num_samps - _pos);
+        long long *out = static_cast<long long *>(buffs[0]);
+        for (size_t i = 0; i < nsamps; i++) out[i] = _next_tick + i;
+        md.has_time_spec = true;
+        md.time_spec = time_spec_t::from_ticks(_next_tick, SAMP_RATE);
+        _next_tick += nsamps;
+        _pos += nsamps;
+        if (_pos == cmd.num_samps) {
+            md.end_of_burst = (cmd.stream_mode == stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+            _queue.pop_front();
+            _pos = 0;
+        }
+        return nsamps;
+    }
+
+    void overflow_at(const long long tick) { _overflow_at = tick; }
+
+    std::vector<stream_cmd_t> cmds;
+
+private:
+    std::deque<stream_cmd_t> _queue;
+    size_t _pos;
+    long long _next_tick;
+    long long _overflow_at;
+};
+
+//! Receive one whole capture, check its samples run on without a gap
+static void recv_capture(
+    rx_acquisition_scheduler::sptr sched,
+    const uint32_t id,
+    const long long first_tick,
+    const size_t nsamps
+){
+    std::vector<long long> buff(nsamps + 10);
+    size_t n = 0;
+    while (n < nsamps) {
+        rx_metadata_t md;
+        uint32_t capture_id = ~uint32_t(0);
+        const size_t num = sched->recv(&buff[n], 33, md, capture_id, 0.0);
+        BOOST_REQUIRE_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_EQUAL(capture_id, id);
+        BOOST_CHECK_EQUAL(md.start_of_burst, n == 0);
+        if (n == 0) BOOST_CHECK_EQUAL(md.time_spec.to_ticks(SAMP_RATE), first_tick);
+        n += num;
+        BOOST_CHECK_EQUAL(md.end_of_burst, n == nsamps);
+    }
+    BOOST_CHECK_EQUAL(n, nsamps);
+    for (size_t i = 0; i < nsamps; i++) {
+        BOOST_CHECK_EQUAL(buff[i], first_tick + (long long)(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_acquisition_chain){
+    boost::shared_ptr<cmd_rx_streamer> streamer = boost::make_shared<cmd_rx_streamer>();
+    rx_acquisition_scheduler::sptr sched = rx_acquisition_scheduler::make(streamer, SAMP_RATE, 3);
+
+    //three back to back, then one after a gap
+    const time_spec_t t0(1.0);
+    BOOST_CHECK_EQUAL(sched->schedule(t0, 250), 0u);
+    BOOST_CHECK_EQUAL(sched->schedule(t0 + time_spec_t::from_ticks(250, SAMP_RATE), 100), 1u);
+    BOOST_CHECK_EQUAL(sched->schedule(t0 + time_spec_t::from_ticks(350, SAMP_RATE), 70), 2u);
+    BOOST_CHECK_EQUAL(sched->schedule(t0 + time_spec_t::from_ticks(1000, SAMP_RATE), 50), 3u);
+    BOOST_CHECK_EQUAL(sched->get_num_pending(), 4u);
+
+    //only as many commands as the queue holds
+    BOOST_REQUIRE_EQUAL(streamer->cmds.size(), 3u);
+    recv_capture(sched, 0, t0.to_ticks(SAMP_RATE), 250);
+    BOOST_REQUIRE_EQUAL(streamer->cmds.size(), 4u);
+    recv_capture(sched, 1, t0.to_ticks(SAMP_RATE) + 250, 100);
+    recv_capture(sched, 2, t0.to_ticks(SAMP_RATE) + 350, 70);
+    recv_capture(sched, 3, t0.to_ticks(SAMP_RATE) + 1000, 50);
+    BOOST_CHECK_EQUAL(sched->get_num_pending(), 0u);
+
+    //chained while there is more, back to back ones without a time
+    const stream_cmd_t::stream_mode_t more = stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE;
+    BOOST_CHECK_EQUAL(streamer->cmds[0].stream_mode, more);
+    BOOST_CHECK_EQUAL(streamer->cmds[1].stream_mode, more);
+    BOOST_CHECK_EQUAL(streamer->cmds[2].stream_mode, more);
+    BOOST_CHECK_EQUAL(streamer->cmds[3].stream_mode, stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    BOOST_CHECK(not streamer->cmds[0].stream_now);
+    BOOST_CHECK(streamer->cmds[1].stream_now);
+    BOOST_CHECK(streamer->cmds[2].stream_now);
+    BOOST_CHECK(not streamer->cmds[3].stream_now);
+
+    rx_metadata_t md;
+    uint32_t capture_id;
+    long long sample;
+    BOOST_CHECK_EQUAL(sched->recv(&sample, 1, md, capture_id, 0.0), 0u);
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+BOOST_AUTO_TEST_CASE(test_acquisition_error){
+    boost::shared_ptr<cmd_rx_streamer> streamer = boost::make_shared<cmd_rx_streamer>();
+    rx_acquisition_scheduler::sptr sched = rx_acquisition_scheduler::make(streamer, SAMP_RATE, 2);
+    const time_spec_t t0(2.0);
+    for (size_t i = 0; i < 4; i++) {
+        sched->schedule(t0 + time_spec_t::from_ticks(1000*i, SAMP_RATE), 100);
+    }
+
+    recv_capture(sched, 0, t0.to_ticks(SAMP_RATE), 100);
+
+    //the error drops the two captures issued, the last is issued anew
+    streamer->overflow_at(t0.to_ticks(SAMP_RATE) + 1000);
+    std::vector<long long> buff(100);
+    rx_metadata_t md;
+    uint32_t capture_id;
+    BOOST_CHECK_EQUAL(sched->recv(&buff[0], 100, md, capture_id, 0.0), 0u);
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_OVERFLOW);
+    BOOST_CHECK_EQUAL(capture_id, 1u);
+    BOOST_CHECK_EQUAL(sched->get_num_pending(), 1u);
+    BOOST_REQUIRE_EQUAL(streamer->cmds.size(), 5u);
+    BOOST_CHECK_EQUAL(streamer->cmds[3].stream_mode, stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    BOOST_CHECK_EQUAL(streamer->cmds[4].stream_mode, stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    BOOST_CHECK(not streamer->cmds[4].stream_now);
+
+    recv_capture(sched, 3, t0.to_ticks(SAMP_RATE) + 3000, 100);
+}
+
+BOOST_AUTO_TEST_CASE(test_acquisition_overlap){
+    rx_acquisition_scheduler::sptr sched = rx_acquisition_scheduler::make(
+        boost::make_shared<cmd_rx_streamer>(), SAMP_RATE);
+    sched->schedule(time_spec_t(1.0), 1000);
+    BOOST_CHECK_THROW(sched->schedule(time_spec_t(1.0) + time_spec_t::from_ticks(999, SAMP_RATE), 10), uhd::value_error);
+    BOOST_CHECK_THROW(sched->schedule(time_spec_t(2.0), 0), uhd::value_error);
+    BOOST_CHECK_THROW(rx_acquisition_scheduler::make(
+        boost::make_shared<cmd_rx_streamer>(), SAMP_RATE, 1), uhd::value_error);
+}
@@ -0,0 +1,199 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include <uhd/rx_capture_ring.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+
+static const double SAMP_RATE = 1000.0;
+static const long long START_TICKS = 1000; //the stream starts at 1s
+
+/***********************************************************************
+ * A streamer that hands out samples the test releases
+ **********************************************************************/
+class timed_rx_streamer : public uhd::rx_streamer
+{
+public:
+    timed_rx_streamer(void):
+        overflow_at(size_t(-1)), overflow_gap(0), _released(0), _next(0), _tick_offset(START_TICKS) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return 10; }
+
+    //! Each sample holds its position in the stream, the time follows it
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        uhd::rx_metadata_t &metadata,
+        const double,
+        const bool
+    ){
+        metadata.reset();
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_next == overflow_at) {
+            overflow_at = size_t(-1);
+            _tick_offset += overflow_gap;
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+        if (_next == _released) {
+            lock.unlock();
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        const size_t nsamps = std::min(std::min(nsamps_per_buff, get_max_num_samps()), _released - _next);
+        for (size_t i = 0; i < nsamps; i++) {
+            static_cast<uint32_t *>(buffs[0])[i] = uint32_t(_next + i);
+        }
+        metadata.has_time_spec = true;
+        metadata.time_spec = uhd::time_spec_t::from_ticks(_tick_offset + (long long)_next, SAMP_RATE);
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+        _next += nsamps;
+        return nsamps;
+    }
+
+    void issue_stream_cmd(const uhd::stream_cmd_t &) {}
+
+    //! Let the next nsamps samples through
+    void release(const size_t nsamps)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _released += nsamps;
+    }
+
+    size_t overflow_at;
+    long long overflow_gap;
+
+private:
+    boost::mutex _mutex;
+    size_t _released;
+    size_t _next;
+    long long _tick_offset;
+};
+
+static uhd::time_spec_t ticks(const long long t)
+{
+    return uhd::time_spec_t::from_ticks(t, SAMP_RATE);
+}
+
+//! Wait until the ring holds samples up to the given tick, at most a second
+static bool wait_for_newest(uhd::rx_capture_ring::sptr ring, const long long t)
+{
+    for (size_t i = 0; i < 1000 and ring->get_newest_time().to_ticks(SAMP_RATE) != t; i++) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    return ring->get_newest_time().to_ticks(SAMP_RATE) == t;
+}
+
+//! Check that a view holds the stream positions from first on
+static void check_view(const uhd::rx_capture_ring::view_t &view, const uint32_t first)
+{
+    uint32_t expected = first;
+    for (size_t part = 0; part < 2; part++) {
+        const uint32_t *samps = static_cast<const uint32_t *>(view.buffs[part][0]);
+        for (size_t i = 0; i < view.nsamps[part]; i++) {
+            BOOST_CHECK_EQUAL(samps[i], expected++);
+        }
+    }
+}
+
+/***********************************************************************
+ * Tests
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_capture_window){
+    boost::shared_ptr<timed_rx_streamer> streamer = boost::make_shared<timed_rx_streamer>();
+    // 95 samples: packets do not divide the ring evenly
+    uhd::rx_capture_ring::sptr ring = uhd::rx_capture_ring::make(streamer, "sc16", SAMP_RATE, 0.095);
+    uhd::rx_capture_ring::view_t view;
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS), 1));
+
+    streamer->release(50);
+    BOOST_REQUIRE(wait_for_newest(ring, START_TICKS + 50));
+    BOOST_CHECK_EQUAL(ring->get_oldest_time().to_ticks(SAMP_RATE), START_TICKS);
+
+    // The window is found by its trigger time
+    BOOST_REQUIRE(ring->get_window(view, ticks(START_TICKS + 12), 20));
+    BOOST_CHECK_EQUAL(view.time_spec.to_ticks(SAMP_RATE), START_TICKS + 12);
+    BOOST_CHECK_EQUAL(view.nsamps[0], 20u);
+    BOOST_CHECK_EQUAL(view.nsamps[1], 0u);
+    check_view(view, 12);
+    BOOST_CHECK(ring->still_valid(view));
+
+    // Not yet received, and before the stream started
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS + 40), 20));
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS - 5), 10));
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS), 96));
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_wraparound){
+    boost::shared_ptr<timed_rx_streamer> streamer = boost::make_shared<timed_rx_streamer>();
+    uhd::rx_capture_ring::sptr ring = uhd::rx_capture_ring::make(streamer, "sc16", SAMP_RATE, 0.095);
+
+    streamer->release(250);
+    BOOST_REQUIRE(wait_for_newest(ring, START_TICKS + 250));
+    const long long oldest = ring->get_oldest_time().to_ticks(SAMP_RATE);
+    BOOST_CHECK(oldest > START_TICKS + 250 - 95);
+    BOOST_CHECK(oldest <= START_TICKS + 250 - 95 + 10);
+
+    // The pre-trigger window crosses the end of the ring (at 190)
+    uhd::rx_capture_ring::view_t view;
+    BOOST_REQUIRE(ring->get_window(view, ticks(START_TICKS + 180), 30));
+    BOOST_CHECK_EQUAL(view.time_spec.to_ticks(SAMP_RATE), START_TICKS + 180);
+    BOOST_CHECK_EQUAL(view.nsamps[0], 10u);
+    BOOST_CHECK_EQUAL(view.nsamps[1], 20u);
+    check_view(view, 180);
+
+    // Overwritten samples are gone
+    uhd::rx_capture_ring::view_t old_view;
+    BOOST_CHECK(not ring->get_window(old_view, ticks(START_TICKS + 100), 10));
+    BOOST_CHECK(not ring->get_window(old_view, ticks(oldest - 1), 10));
+    BOOST_CHECK(ring->get_window(old_view, ticks(oldest), 10));
+
+    // Once the ring wraps over the view, it is no longer valid
+    BOOST_CHECK(ring->still_valid(view));
+    streamer->release(100);
+    BOOST_REQUIRE(wait_for_newest(ring, START_TICKS + 350));
+    BOOST_CHECK(not ring->still_valid(view));
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS + 180), 30));
+}
+
+BOOST_AUTO_TEST_CASE(test_capture_overflow){
+    boost::shared_ptr<timed_rx_streamer> streamer = boost::make_shared<timed_rx_streamer>();
+    streamer->overflow_at = 40;
+    streamer->overflow_gap = 500;
+    uhd::rx_capture_ring::sptr ring = uhd::rx_capture_ring::make(streamer, "sc16", SAMP_RATE, 0.095);
+
+    // 40 samples, an overflow, and 30 samples after the time jumped
+    streamer->release(70);
+    BOOST_REQUIRE(wait_for_newest(ring, START_TICKS + 570));
+    BOOST_CHECK_EQUAL(ring->get_num_errors(), 1u);
+
+    // The trigger time finds the right stretch on both sides of the gap
+    uhd::rx_capture_ring::view_t view;
+    BOOST_REQUIRE(ring->get_window(view, ticks(START_TICKS + 30), 10));
+    check_view(view, 30);
+    BOOST_REQUIRE(ring->get_window(view, ticks(START_TICKS + 545), 20));
+    BOOST_CHECK_EQUAL(view.time_spec.to_ticks(SAMP_RATE), START_TICKS + 545);
+    check_view(view, 45);
+
+    // No window spans the gap or lies inside it
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS + 35), 10));
+    BOOST_CHECK(not ring->get_window(view, ticks(START_TICKS + 200), 10));
+}
@@ -0,0 +1,200 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/rx_channelizer.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <boost/make_shared.hpp>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace uhd;
+
+static const double SAMP_RATE = 1e6;
+static const size_t SPP = 1000;
+
+/***********************************************************************
+ * A streamer that hands out sc16_item32_le packets of a tone
+ **********************************************************************/
+class tone_rx_streamer : public rx_streamer
+{
+public:
+    tone_rx_streamer(const double freq, const size_t num_packets):
+        last_cmd(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS),
+        _freq(freq), _num_packets(num_packets), _sent(0), _overflow_at(~size_t(0))
+    {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return SPP; }
+
+    size_t recv(const buffs_type &, const size_t, rx_metadata_t &, const double, const bool)
+    {
+        throw uhd::not_implemented_error("only zero copy");
+    }
+
+    void issue_stream_cmd(const stream_cmd_t &cmd) { last_cmd = cmd; }
+
+    size_t recv_zero_copy(zero_copy_buffs_t &buffs, rx_metadata_t &md, const double)
+    {
+        static const double pi = std::acos(-1.0);
+        buffs.release();
+        md.reset();
+        if (_sent == _overflow_at) {
+            _overflow_at = ~size_t(0);
+            md.error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+        if (_sent == _num_packets) {
+            md.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        boost::shared_ptr<std::vector<uint32_t> > items = boost::make_shared<std::vector<uint32_t> >(SPP);
+        for (size_t i = 0; i < SPP; i++) {
+            const std::complex<double> x = std::polar(0.5, 2*pi*_freq*(_sent*SPP + i)/SAMP_RATE);
+            const uint16_t re = uint16_t(int16_t(std::floor(x.real()*32767 + 0.5)));
+            const uint16_t im = uint16_t(int16_t(std::floor(x.imag()*32767 + 0.5)));
+            (*items)[i] = uhd::htowx(uint32_t(re) << 16 | im);
+        }
+        buffs.buffs.push_back(&items->front());
+        buffs.nsamps = SPP;
+        buffs.item_format = "sc16_item32_le";
+        buffs.handle = items;
+        md.has_time_spec = true;
+        md.time_spec = time_spec_t(1.0) + time_spec_t::from_ticks((long long)(_sent*SPP), SAMP_RATE);
+        _sent++;
+        return SPP;
+    }
+
+    void overflow_before(const size_t packet) { _overflow_at = packet; }
+
+    stream_cmd_t last_cmd;
+
+private:
+    const double _freq;
+    const size_t _num_packets;
+    size_t _sent;
+    size_t _overflow_at;
+};
+
+//! Receive everything, per channel
+static std::vector<std::vector<std::complex<float> > > recv_all(
+    rx_streamer::sptr chan, const size_t nsamps, const size_t max_per_call
+){
+    std::vector<std::vector<std::complex<float> > > out(chan->get_num_channels(),
+        std::vector<std::complex<float> >(nsamps));
+    size_t n = 0;
+    while (n < nsamps) {
+        std::vector<void *> buffs;
+        for (size_t k = 0; k < out.size(); k++) buffs.push_back(&out[k][n]);
+        rx_metadata_t md;
+        const size_t num = chan->recv(buffs, std::min(max_per_call, nsamps - n), md, 0.0);
+        if (num == 0) break;
+        n += num;
+    }
+    BOOST_CHECK_EQUAL(n, nsamps);
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(test_channelizer_tone){
+    const size_t num_chans = 8;
+    //a tone in the middle of channel 3, i.e. at 3/8 of the rate
+    rx_channelizer::sptr chan = rx_channelizer::make(
+        boost::make_shared<tone_rx_streamer>(3*SAMP_RATE/num_chans, 20), num_chans, SAMP_RATE);
+    BOOST_CHECK_EQUAL(chan->get_num_channels(), num_chans);
+    BOOST_CHECK_EQUAL(chan->get_max_num_samps(), SPP/num_chans);
+
+    const std::vector<std::vector<std::complex<float> > > out =
+        recv_all(chan, 20*SPP/num_chans, 77);
+
+    //past the filter's settling, all of the tone is in channel 3
+    for (size_t k = 0; k < num_chans; k++) {
+        double peak = 0.0;
+        for (size_t j = 100; j < out[k].size(); j++) {
+            peak = std::max(peak, double(std::abs(out[k][j])));
+        }
+        if (k == 3) {
+            BOOST_CHECK_CLOSE(peak, 0.5, 1.0);
+        } else {
+            BOOST_CHECK_LT(peak, 1e-3);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_channelizer_threads){
+    const size_t num_chans = 16;
+    rx_channelizer::sptr chan1 = rx_channelizer::make(
+        boost::make_shared<tone_rx_streamer>(-123456.0, 30), num_chans, SAMP_RATE);
+    rx_channelizer::sptr chan4 = rx_channelizer::make(
+        boost::make_shared<tone_rx_streamer>(-123456.0, 30), num_chans, SAMP_RATE,
+        std::vector<float>(), 4);
+
+    //the threads split the outputs, the results stay the same
+    const size_t nsamps = 30*SPP/num_chans - 1;
+    const std::vector<std::vector<std::complex<float> > > out1 = recv_all(chan1, nsamps, 1000);
+    const std::vector<std::vector<std::complex<float> > > out4 = recv_all(chan4, nsamps, 1000);
+    for (size_t k = 0; k < num_chans; k++) {
+        for (size_t j = 0; j < nsamps; j++) {
+            BOOST_CHECK_EQUAL(out1[k][j], out4[k][j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_channelizer_metadata){
+    const size_t num_chans = 4;
+    boost::shared_ptr<tone_rx_streamer> streamer = boost::make_shared<tone_rx_streamer>(0.0, 10);
+    rx_channelizer::sptr chan = rx_channelizer::make(streamer, num_chans, SAMP_RATE);
+
+    stream_cmd_t cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    cmd.num_samps = 100;
+    chan->issue_stream_cmd(cmd);
+    BOOST_CHECK_EQUAL(streamer->last_cmd.num_samps, 400u);
+
+    //the time of an output is that of the newest sample in its window
+    std::vector<std::complex<float> > buff(num_chans*10);
+    std::vector<void *> buffs;
+    for (size_t k = 0; k < num_chans; k++) buffs.push_back(&buff[k*10]);
+    rx_metadata_t md;
+    BOOST_CHECK_EQUAL(chan->recv(buffs, 10, md, 0.0), 10u);
+    BOOST_CHECK(md.has_time_spec);
+    BOOST_CHECK_EQUAL(md.time_spec.to_ticks(SAMP_RATE), time_spec_t(1.0).to_ticks(SAMP_RATE) + 3);
+    BOOST_CHECK_EQUAL(chan->recv(buffs, 10, md, 0.0), 10u);
+    BOOST_CHECK_EQUAL(md.time_spec.to_ticks(SAMP_RATE), time_spec_t(1.0).to_ticks(SAMP_RATE) + 43);
+
+    //an overflow ends the call and restarts the filter
+    streamer->overflow_before(1);
+    BOOST_CHECK_EQUAL(chan->recv(buffs, 10, md, 0.0, true), 10u);
+    size_t nsamps = 0;
+    while (md.error_code == rx_metadata_t::ERROR_CODE_NONE) {
+        nsamps += chan->recv(buffs, 10, md, 0.0);
+    }
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_OVERFLOW);
+    BOOST_CHECK_EQUAL(chan->recv(buffs, 10, md, 0.0), 10u);
+    BOOST_CHECK_EQUAL(md.time_spec.to_ticks(SAMP_RATE), time_spec_t(1.0).to_ticks(SAMP_RATE) + 1003);
+}
+
+BOOST_AUTO_TEST_CASE(test_channelizer_errors){
+    rx_streamer::sptr streamer = boost::make_shared<tone_rx_streamer>(0.0, 1);
+    BOOST_CHECK_THROW(rx_channelizer::make(streamer, 6, SAMP_RATE), uhd::value_error);
+    BOOST_CHECK_THROW(rx_channelizer::make(streamer, 1, SAMP_RATE), uhd::value_error);
+
+    //the taps are padded to a whole number of rows
+    rx_channelizer::sptr chan = rx_channelizer::make(streamer, 4, SAMP_RATE, std::vector<float>(9, 0.1f));
+    BOOST_CHECK_EQUAL(chan->get_taps().size(), 12u);
+    BOOST_CHECK_EQUAL(chan->get_taps().back(), 0.0f);
+}
@@ -0,0 +1,120 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/sample_file.hpp>
+#include <uhd/exception.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace uhd;
+namespace fs = boost::filesystem;
+
+static const size_t BUFFER_SIZE = 16*1024;
+static const size_t NUM_BUFFERS = 3;
+
+//! sc16 samples, each one its sample index
+static std::vector<uint32_t> make_samples(const size_t nsamps)
+{
+    std::vector<uint32_t> samps(nsamps);
+    for (size_t i = 0; i < nsamps; i++) samps[i] = uint32_t(i*2654435761u);
+    return samps;
+}
+
+//! Write through both interfaces in pieces that do not line up with the buffers
+static void write_samples(const fs::path &path, const std::vector<uint32_t> &samps, const bool direct)
+{
+    sample_file_writer::sptr writer = sample_file_writer::make(path.string(), BUFFER_SIZE, NUM_BUFFERS, direct);
+    const char *in = reinterpret_cast<const char *>(&samps.front());
+    const size_t len = samps.size()*sizeof(uint32_t);
+    size_t offset = 0;
+    for (size_t i = 0; offset < len; i++) {
+        const size_t n = std::min<size_t>(len - offset, 4*(1000 + 333*(i % 5)));
+        if (i % 2 == 0) {
+            std::memcpy(writer->get_write_space(n), in + offset, n);
+            writer->commit(n);
+        }
+        else {
+            writer->write(in + offset, n);
+        }
+        offset += n;
+    }
+    writer->close();
+    BOOST_CHECK_EQUAL(writer->get_stats().bytes, len);
+}
+
+//! Read back through both interfaces, peeking at odd lengths
+static std::vector<uint32_t> read_samples(const fs::path &path, const size_t nsamps, const bool direct)
+{
+    sample_file_reader::sptr reader = sample_file_reader::make(path.string(), BUFFER_SIZE, NUM_BUFFERS, direct);
+    std::vector<uint32_t> samps(nsamps + 1);
+    char *out = reinterpret_cast<char *>(&samps.front());
+    const size_t len = samps.size()*sizeof(uint32_t);
+    size_t offset = 0;
+    for (size_t i = 0; offset < len; i++) {
+        size_t n = std::min<size_t>(len - offset, 4*(700 + 555*(i % 3)));
+        if (i % 2 == 0) {
+            const void *in = reader->peek(n);
+            if (n == 0) break;
+            std::memcpy(out + offset, in, n);
+            reader->consume(n);
+        }
+        else {
+            n = reader->read(out + offset, n);
+            if (n == 0) break;
+        }
+        offset += n;
+    }
+    BOOST_CHECK_EQUAL(reader->get_stats().bytes, offset);
+    samps.resize(offset/sizeof(uint32_t));
+    return samps;
+}
+
+BOOST_AUTO_TEST_CASE(test_sample_file_round_trip){
+    // Sizes around the 4 KiB direct I/O alignment and the buffer size
+    const size_t sizes[] = {1, 1001, 1024, 4096, 4097, 10007, 25000};
+    for (size_t direct = 0; direct < 2; direct++) {
+        for (size_t i = 0; i < sizeof(sizes)/sizeof(*sizes); i++) {
+            BOOST_TEST_CHECKPOINT("direct " << direct << ", " << sizes[i] << " samples");
+            const fs::path path = fs::temp_directory_path() / fs::unique_path("sample_file_test_%%%%%%%%.dat");
+            const std::vector<uint32_t> samps = make_samples(sizes[i]);
+            write_samples(path, samps, direct != 0);
+
+            // The unaligned tail is written on close, nothing more
+            BOOST_CHECK_EQUAL(fs::file_size(path), sizes[i]*sizeof(uint32_t));
+            const std::vector<uint32_t> result = read_samples(path, sizes[i], direct != 0);
+            BOOST_CHECK_EQUAL(result.size(), samps.size());
+            BOOST_CHECK(result == samps);
+            fs::remove(path);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sample_file_errors){
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("sample_file_test_%%%%%%%%.dat");
+    BOOST_CHECK_THROW(sample_file_writer::make(path.string(), 1000, NUM_BUFFERS), uhd::value_error);
+    BOOST_CHECK_THROW(sample_file_writer::make(path.string(), BUFFER_SIZE, 1), uhd::value_error);
+    BOOST_CHECK_THROW(sample_file_reader::make(path.string(), BUFFER_SIZE, NUM_BUFFERS), uhd::io_error);
+
+    sample_file_writer::sptr writer = sample_file_writer::make(path.string(), BUFFER_SIZE, NUM_BUFFERS);
+    BOOST_CHECK_THROW(writer->get_write_space(BUFFER_SIZE), uhd::value_error);
+    writer->close();
+    BOOST_CHECK_THROW(writer->get_write_space(4), uhd::runtime_error);
+    BOOST_CHECK_EQUAL(fs::file_size(path), 0u);
+    fs::remove(path);
+}
@@ -0,0 +1,183 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/sc16_delta.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/exception.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/make_shared.hpp>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+using namespace uhd::transport;
+
+static std::vector<uint32_t> round_trip(const std::vector<uint32_t> &samps, size_t &nwords)
+{
+    std::vector<uint32_t> enc(sc16_delta::max_encoded_words32(samps.size()));
+    nwords = sc16_delta::encode(samps.empty()? NULL : &samps.front(), samps.size(), &enc.front());
+    BOOST_CHECK(nwords <= enc.size());
+    std::vector<uint32_t> dec(samps.size() + 1);
+    const size_t nsamps = sc16_delta::decode(&enc.front(), nwords, &dec.front(), samps.size());
+    dec.resize(nsamps);
+    return dec;
+}
+
+BOOST_AUTO_TEST_CASE(test_sc16_delta_round_trip){
+    std::srand(1);
+    const size_t sizes[] = {0, 1, 2, 3, 364, 1000};
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        //full scale noise, small noise and a constant
+        for (int amplitude = 0x10000; amplitude >= 1; amplitude /= 0x1000) {
+            std::vector<uint32_t> samps(sizes[s]);
+            for (size_t i = 0; i < samps.size(); i++) {
+                samps[i] = (uint32_t(std::rand() % amplitude) << 16) | uint32_t(std::rand() % amplitude);
+            }
+            size_t nwords = 0;
+            const std::vector<uint32_t> dec = round_trip(samps, nwords);
+            BOOST_CHECK(dec == samps);
+            BOOST_CHECK(nwords <= samps.size() + 2);
+            if (amplitude <= 0x10 and samps.size() > 100) {
+                BOOST_CHECK(nwords < samps.size()/2);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sc16_delta_wraps){
+    //the largest steps, in both directions
+    std::vector<uint32_t> samps;
+    samps.push_back(0x7fff8000);
+    samps.push_back(0x80007fff);
+    samps.push_back(0x00000000);
+    samps.push_back(0xffffffff);
+    size_t nwords = 0;
+    BOOST_CHECK(round_trip(samps, nwords) == samps);
+}
+
+BOOST_AUTO_TEST_CASE(test_sc16_delta_malformed){
+    std::vector<uint32_t> samps(100, 0x00010002);
+    samps[50] = 0x12345678;
+    std::vector<uint32_t> enc(sc16_delta::max_encoded_words32(samps.size()));
+    const size_t nwords = sc16_delta::encode(&samps.front(), samps.size(), &enc.front());
+    std::vector<uint32_t> dec(samps.size());
+
+    BOOST_CHECK_THROW(sc16_delta::decode(&enc.front(), 0, &dec.front(), dec.size()), uhd::value_error);
+    BOOST_CHECK_THROW(sc16_delta::decode(&enc.front(), nwords - 1, &dec.front(), dec.size()), uhd::value_error);
+    BOOST_CHECK_THROW(sc16_delta::decode(&enc.front(), nwords, &dec.front(), dec.size() - 1), uhd::value_error);
+    enc[0] = (enc[0] & 0xffff0000) | 17;
+    BOOST_CHECK_THROW(sc16_delta::decode(&enc.front(), nwords, &dec.front(), dec.size()), uhd::value_error);
+}
+
+/***********************************************************************
+ * A transport that returns prepared packets
+ **********************************************************************/
+class packet_mrb : public managed_recv_buffer{
+public:
+    void release(void){
+        //NOP
+    }
+
+    sptr get_new(boost::shared_array<uint32_t> mem, size_t len){
+        _mem = mem;
+        return make(this, _mem.get(), len);
+    }
+
+private:
+    boost::shared_array<uint32_t> _mem;
+};
+
+class packet_xport : public zero_copy_if{
+public:
+    void push_back_packet(vrt::if_packet_info_t &ifpi, const std::vector<uint32_t> &payload){
+        boost::shared_array<uint32_t> mem(new uint32_t[vrt::max_if_hdr_words32 + payload.size()]);
+        ifpi.num_payload_words32 = payload.size();
+        ifpi.num_payload_bytes = payload.size()*sizeof(uint32_t);
+        vrt::chdr::if_hdr_pack_le(mem.get(), ifpi);
+        std::copy(payload.begin(), payload.end(), mem.get() + ifpi.num_header_words32);
+        _mems.push_back(mem);
+        _lens.push_back(ifpi.num_packet_words32*sizeof(uint32_t));
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double){
+        if (_mems.empty()) return managed_recv_buffer::sptr();
+        _mrbs.push_back(boost::make_shared<packet_mrb>());
+        managed_recv_buffer::sptr mrb = _mrbs.back()->get_new(_mems.front(), _lens.front());
+        _mems.pop_front();
+        _lens.pop_front();
+        return mrb;
+    }
+
+    size_t get_num_recv_frames(void) const { return 4; }
+    size_t get_recv_frame_size(void) const { return 8000; }
+    managed_send_buffer::sptr get_send_buff(double){ return managed_send_buffer::sptr(); }
+    size_t get_num_send_frames(void) const { return 0; }
+    size_t get_send_frame_size(void) const { return 0; }
+
+private:
+    std::list<boost::shared_array<uint32_t> > _mems;
+    std::list<size_t> _lens;
+    std::vector<boost::shared_ptr<packet_mrb> > _mrbs;
+};
+
+BOOST_AUTO_TEST_CASE(test_sc16_delta_decoder){
+    boost::shared_ptr<packet_xport> xport = boost::make_shared<packet_xport>();
+    std::vector<uint32_t> samps(500);
+    for (size_t i = 0; i < samps.size(); i++) {
+        samps[i] = uint32_t((i*3) << 16) | uint32_t(i & 0xff);
+    }
+    std::vector<uint32_t> enc(sc16_delta::max_encoded_words32(samps.size()));
+    enc.resize(sc16_delta::encode(&samps.front(), samps.size(), &enc.front()));
+
+    vrt::if_packet_info_t ifpi;
+    ifpi.link_type = vrt::if_packet_info_t::LINK_TYPE_CHDR;
+    ifpi.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.packet_count = 5;
+    ifpi.has_sid = true;
+    ifpi.sid = 0x02000010;
+    ifpi.has_tsf = true;
+    ifpi.tsf = 1234567;
+    xport->push_back_packet(ifpi, enc);
+    ifpi.eob = true;
+    xport->push_back_packet(ifpi, std::vector<uint32_t>());
+
+    sc16_delta::decoder::sptr decoder = sc16_delta::decoder::make(xport, true, false);
+    managed_recv_buffer::sptr buff = decoder->get_recv_buff(0.1);
+    BOOST_REQUIRE(buff);
+    vrt::if_packet_info_t out;
+    out.num_packet_words32 = buff->size()/sizeof(uint32_t);
+    vrt::chdr::if_hdr_unpack_le(buff->cast<const uint32_t *>(), out);
+    BOOST_CHECK_EQUAL(out.num_payload_bytes, samps.size()*sizeof(uint32_t));
+    BOOST_CHECK_EQUAL(out.packet_count, 5);
+    BOOST_CHECK_EQUAL(out.sid, ifpi.sid);
+    BOOST_CHECK(out.has_tsf);
+    BOOST_CHECK_EQUAL(out.tsf, ifpi.tsf);
+    const uint32_t *payload = buff->cast<const uint32_t *>() + out.num_header_words32;
+    BOOST_CHECK(std::vector<uint32_t>(payload, payload + samps.size()) == samps);
+    buff.reset();
+
+    //an empty end of burst passes through
+    buff = decoder->get_recv_buff(0.1);
+    BOOST_REQUIRE(buff);
+    out.num_packet_words32 = buff->size()/sizeof(uint32_t);
+    vrt::chdr::if_hdr_unpack_le(buff->cast<const uint32_t *>(), out);
+    BOOST_CHECK(out.eob);
+    BOOST_CHECK_EQUAL(out.num_payload_words32, 0);
+
+    BOOST_CHECK(not decoder->get_recv_buff(0.1));
+}
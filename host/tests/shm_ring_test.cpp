@@ -0,0 +1,119 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "../lib/transport/shm_ring.hpp"
+#include <boost/test/unit_test.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
+
+using uhd::transport::shm_ring;
+
+static shm_ring::info_t make_info(void){
+    shm_ring::info_t info;
+    info.cpu_format = "sc16";
+    info.bytes_per_item = 4;
+    info.num_chans = 1;
+    info.spp = 8;
+    info.num_slots = 4;
+    info.samp_rate = 1e6;
+    return info;
+}
+
+//! Fill one slot with a ramp starting at first and commit it
+static void publish(shm_ring::sptr ring, const boost::uint32_t first, const size_t nsamps){
+    boost::uint32_t *mem = reinterpret_cast<boost::uint32_t *>(ring->claim()[0]);
+    for (size_t i = 0; i < nsamps; i++) mem[i] = first + boost::uint32_t(i);
+    uhd::rx_metadata_t md;
+    md.has_time_spec = true;
+    md.time_spec = uhd::time_spec_t(0, first, 1e6);
+    ring->commit(nsamps, md);
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_ring_read){
+    shm_ring::sptr writer = shm_ring::create("test_read", make_info());
+    shm_ring::sptr reader = shm_ring::open("test_read");
+    BOOST_CHECK_EQUAL(writer->get_num_readers(), size_t(1));
+    BOOST_CHECK_EQUAL(reader->get_info().cpu_format, "sc16");
+    BOOST_CHECK_EQUAL(reader->get_info().spp, size_t(8));
+
+    std::vector<boost::uint32_t> buff(8);
+    std::vector<void *> buffs(1, &buff.front());
+    uhd::rx_metadata_t md;
+
+    //nothing published yet
+    BOOST_CHECK_EQUAL(reader->read(buffs, buff.size(), md, 0.01), size_t(0));
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    publish(writer, 100, 8);
+    BOOST_CHECK_EQUAL(reader->read(buffs, buff.size(), md, 0.1), size_t(8));
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK(md.has_time_spec);
+    BOOST_CHECK_EQUAL(md.time_spec.to_ticks(1e6), 100);
+    for (size_t i = 0; i < 8; i++) BOOST_CHECK_EQUAL(buff[i], 100 + i);
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_ring_partial_read){
+    shm_ring::sptr writer = shm_ring::create("test_partial", make_info());
+    shm_ring::sptr reader = shm_ring::open("test_partial");
+
+    std::vector<boost::uint32_t> buff(5);
+    std::vector<void *> buffs(1, &buff.front());
+    uhd::rx_metadata_t md;
+
+    publish(writer, 200, 8);
+    BOOST_CHECK_EQUAL(reader->read(buffs, buff.size(), md, 0.1), size_t(5));
+    BOOST_CHECK(md.more_fragments);
+    BOOST_CHECK_EQUAL(buff[0], boost::uint32_t(200));
+
+    BOOST_CHECK_EQUAL(reader->read(buffs, buff.size(), md, 0.1), size_t(3));
+    BOOST_CHECK(not md.more_fragments);
+    BOOST_CHECK_EQUAL(md.fragment_offset, size_t(5));
+    BOOST_CHECK_EQUAL(md.time_spec.to_ticks(1e6), 205);
+    BOOST_CHECK_EQUAL(buff[0], boost::uint32_t(205));
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_ring_overflow){
+    shm_ring::sptr writer = shm_ring::create("test_overflow", make_info());
+    shm_ring::sptr reader = shm_ring::open("test_overflow");
+
+    std::vector<boost::uint32_t> buff(8);
+    std::vector<void *> buffs(1, &buff.front());
+    uhd::rx_metadata_t md;
+
+    //lap the reader: six packets into four slots
+    for (size_t i = 0; i < 6; i++) publish(writer, boost::uint32_t(1000 + 8*i), 8);
+
+    reader->read(buffs, buff.size(), md, 0.1);
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+
+    //the reader resumes at the newest packet
+    BOOST_CHECK_EQUAL(reader->read(buffs, buff.size(), md, 0.1), size_t(8));
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(buff[0], boost::uint32_t(1000 + 8*5));
+}
+
+BOOST_AUTO_TEST_CASE(test_shm_ring_closed){
+    shm_ring::sptr writer = shm_ring::create("test_closed", make_info());
+    shm_ring::sptr reader = shm_ring::open("test_closed");
+    writer.reset();
+
+    std::vector<boost::uint32_t> buff(8);
+    std::vector<void *> buffs(1, &buff.front());
+    uhd::rx_metadata_t md;
+    BOOST_CHECK_THROW(reader->read(buffs, buff.size(), md, 0.1), uhd::io_error);
+    BOOST_CHECK_THROW(shm_ring::open("test_closed"), uhd::exception);
+}
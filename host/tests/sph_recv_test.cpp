@@ -19,6 +19,7 @@
 #include "../lib/transport/super_recv_packet_handler.hpp"
 #include <boost/shared_array.hpp>
 #include <boost/bind.hpp>
+#include <boost/foreach.hpp>
 #include <complex>
 #include <vector>
 #include <list>
@@ -44,8 +45,10 @@ struct overflow_handler_type{
  **********************************************************************/
 class dummy_mrb : public uhd::transport::managed_recv_buffer{
 public:
+    dummy_mrb(size_t *num_released = NULL): _num_released(num_released){}
+
     void release(void){
-        //NOP
+        if (_num_released != NULL) (*_num_released)++;
     }
 
     sptr get_new(boost::shared_array<char> mem, size_t len){
@@ -55,6 +58,7 @@ public:
 
 private:
     boost::shared_array<char> _mem;
+    size_t *_num_released;
 };
 
 /***********************************************************************
@@ -62,7 +66,7 @@ private:
  **********************************************************************/
 class dummy_recv_xport_class{
 public:
-    dummy_recv_xport_class(const std::string &end) : io_status(true) {
+    dummy_recv_xport_class(const std::string &end) : num_released(0), io_status(true) {
         _end = end;
     }
 
@@ -89,13 +93,15 @@ public:
     uhd::transport::managed_recv_buffer::sptr get_recv_buff(double){
         if (!io_status) throw uhd::io_error("IO error exception"); //simulate an IO error
         if (_mems.empty()) return uhd::transport::managed_recv_buffer::sptr(); //timeout
-        _mrbs.push_back(boost::shared_ptr<dummy_mrb>(new dummy_mrb()));
+        _mrbs.push_back(boost::shared_ptr<dummy_mrb>(new dummy_mrb(&num_released)));
         uhd::transport::managed_recv_buffer::sptr mrb = _mrbs.back()->get_new(_mems.front(), _lens.front());
         _mems.pop_front();
         _lens.pop_front();
         return mrb;
     }
 
+    size_t num_released; //buffers handed back by the handler
+
 private:
     std::list<boost::shared_array<char> > _mems;
     std::list<size_t> _lens;
@@ -179,6 +185,133 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_normal){
     BOOST_REQUIRE_THROW(handler.recv(&buff.front(), buff.size(), metadata, 1.0, true), uhd::io_error);
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_zero_copy){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+
+    //check the received packets
+    size_t num_accum_samps = 0;
+    uhd::rx_streamer::zero_copy_buffs_t buffs;
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv_zero_copy(buffs, metadata, 1.0);
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not metadata.more_fragments);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        BOOST_CHECK_EQUAL(buffs.nsamps, num_samps_ret);
+        BOOST_CHECK_EQUAL(buffs.item_format, "sc16_item32_be");
+        BOOST_REQUIRE_EQUAL(buffs.buffs.size(), 1);
+        BOOST_CHECK(buffs.buffs[0] != NULL);
+        BOOST_CHECK(buffs.handle);
+        num_accum_samps += num_samps_ret;
+    }
+    buffs.release();
+    BOOST_CHECK(not buffs.handle);
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        BOOST_CHECK_EQUAL(handler.recv_zero_copy(buffs, metadata, 1.0), 0);
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_zero_copy_handles){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.packet_count = 0;
+    ifpi.sob = false;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = false;
+    ifpi.has_tsf = false;
+    ifpi.has_tlr = false;
+
+    //more packets than the handler has handles for
+    static const size_t NUM_PKTS_TO_TEST = 2*SRPH_ZERO_COPY_HANDLES + 5;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+    }
+
+    boost::shared_ptr<uhd::transport::sph::recv_packet_handler> handler(
+        new uhd::transport::sph::recv_packet_handler(1));
+    handler->set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler->set_tick_rate(100e6);
+    handler->set_samp_rate(10e6);
+    handler->set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler->set_converter(id);
+
+    //hold on to every packet, the handles keep their buffers
+    std::vector<uhd::rx_streamer::zero_copy_buffs_t> held(NUM_PKTS_TO_TEST);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        BOOST_REQUIRE_EQUAL(handler->recv_zero_copy(held[i], metadata, 1.0), 10);
+    }
+    BOOST_CHECK_EQUAL(dummy_recv_xport.num_released, 0);
+
+    //dropping a handle releases its buffer, also after the handler is gone
+    held[0].release();
+    BOOST_CHECK_EQUAL(dummy_recv_xport.num_released, 1);
+    handler.reset();
+    held.clear();
+    BOOST_CHECK_EQUAL(dummy_recv_xport.num_released, NUM_PKTS_TO_TEST);
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
 ////////////////////////////////////////////////////////////////////////
@@ -247,6 +380,8 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
             BOOST_CHECK(metadata.has_time_spec);
             BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
             BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+            //the lost packet had 10 + 15%10 samples
+            BOOST_CHECK_EQUAL(metadata.num_lost_samps, (i == NUM_PKTS_TO_TEST/2 + 1)? 15 : 0);
             num_accum_samps += num_samps_ret;
         }
     }
@@ -265,6 +400,151 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_sequence_error){
     BOOST_REQUIRE_THROW(handler.recv(&buff.front(), buff.size(), metadata, 1.0, true), uhd::io_error);
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_tsf_elision){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = false;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 1000;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t SPP = 16;
+
+    //only the first packet has a time stamp
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = SPP;
+        if (i != NUM_PKTS_TO_TEST/2){ //simulate a lost packet
+            dummy_recv_xport.push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.has_tsf = false;
+        ifpi.sob = false;
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tsf_elision(true);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+
+    //check the restored times, across the lost packet too
+    const uhd::time_spec_t start_time = uhd::time_spec_t::from_ticks(1000, TICK_RATE);
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > buff(20);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata, 1.0, true
+        );
+        if (i == NUM_PKTS_TO_TEST/2){
+            BOOST_REQUIRE(metadata.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+            num_accum_samps += SPP;
+            continue;
+        }
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, start_time + uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, SPP);
+        BOOST_CHECK_EQUAL(metadata.num_lost_samps, (i == NUM_PKTS_TO_TEST/2 + 1)? SPP : 0);
+        num_accum_samps += num_samps_ret;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_timed_rate_change){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = false;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 1000;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const double NEW_SAMP_RATE = 5e6;
+    static const size_t NUM_PKTS_TO_TEST = 10;
+    static const size_t SWITCH_PKT = 4;
+    static const size_t SPP = 16;
+
+    //only the first packet has a time stamp, the rate halves at packet SWITCH_PKT
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = SPP;
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.has_tsf = false;
+        ifpi.sob = false;
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tsf_elision(true);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+
+    const uhd::time_spec_t start_time = uhd::time_spec_t::from_ticks(1000, TICK_RATE);
+    const uhd::time_spec_t switch_time = start_time + uhd::time_spec_t::from_ticks(SWITCH_PKT*SPP, SAMP_RATE);
+    handler.set_samp_rate(switch_time, NEW_SAMP_RATE, 1/32767.);
+
+    //the packets before the switch keep the old rate, fragments too
+    uhd::time_spec_t expected_time = start_time;
+    std::vector<std::complex<float> > buff(SPP/2);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        const double rate = (i < SWITCH_PKT)? SAMP_RATE : NEW_SAMP_RATE;
+        for (size_t frag = 0; frag < 2; frag++){
+            size_t num_samps_ret = handler.recv(
+                &buff.front(), buff.size(), metadata, 1.0, true
+            );
+            BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+            BOOST_CHECK_EQUAL(num_samps_ret, SPP/2);
+            BOOST_CHECK_TS_CLOSE(metadata.time_spec, expected_time);
+            expected_time += uhd::time_spec_t::from_ticks(num_samps_ret, rate);
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_inline_message){
 ////////////////////////////////////////////////////////////////////////
@@ -451,7 +731,7 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_normal){
 }
 
 ////////////////////////////////////////////////////////////////////////
-BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_convert_threads){
 ////////////////////////////////////////////////////////////////////////
     uhd::convert::id_type id;
     id.input_format = "sc16_item32_be";
@@ -485,9 +765,6 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
     for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
         ifpi.num_payload_words32 = 10 + i%10;
         for (size_t ch = 0; ch < NCHANNELS; ch++){
-            if (i == NUM_PKTS_TO_TEST/2 and ch == 2){
-                continue; //simulates a lost packet
-            }
             dummy_recv_xports[ch].push_back_packet(ifpi);
         }
         ifpi.packet_count++;
@@ -503,6 +780,7 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
         handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
     }
     handler.set_converter(id);
+    handler.set_convert_threads(3);
 
     //check the received packets
     size_t num_accum_samps = 0;
@@ -517,42 +795,21 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
         size_t num_samps_ret = handler.recv(
             buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
         );
-        if (i == NUM_PKTS_TO_TEST/2){
-            //must get the soft overflow here
-            BOOST_REQUIRE(metadata.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
-            BOOST_REQUIRE(metadata.out_of_sequence == true);
-            BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
-            num_accum_samps += 10 + i%10;
-        }
-        else{
-            BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
-            BOOST_CHECK(not metadata.more_fragments);
-            BOOST_CHECK(metadata.has_time_spec);
-            BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
-            BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
-            num_accum_samps += num_samps_ret;
-        }
-    }
-
-    //subsequent receives should be a timeout
-    for (size_t i = 0; i < 3; i++){
-        std::cout << "timeout check " << i << std::endl;
-        handler.recv(
-            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
-        );
-        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
-    }
-
-    //simulate the transport failing
-    for (size_t ch = 0; ch < NCHANNELS; ch++){
-        dummy_recv_xports[ch].set_io_status(false);
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not metadata.more_fragments);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        num_accum_samps += num_samps_ret;
     }
+}
 
-    BOOST_REQUIRE_THROW(handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true), uhd::io_error);
+static void null_stream_cmd(const uhd::stream_cmd_t &){
+    /* NOP */
 }
 
 ////////////////////////////////////////////////////////////////////////
-BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_recv_threads){
 ////////////////////////////////////////////////////////////////////////
     uhd::convert::id_type id;
     id.input_format = "sc16_item32_be";
@@ -576,7 +833,7 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
 
     static const double TICK_RATE = 100e6;
     static const double SAMP_RATE = 10e6;
-    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_PKTS_TO_TEST = 50; //more than a receive thread queues
     static const size_t NUM_SAMPS_PER_BUFF = 20;
     static const size_t NCHANNELS = 4;
 
@@ -590,20 +847,19 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
         }
         ifpi.packet_count++;
         ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
-        if (i == NUM_PKTS_TO_TEST/2){
-            ifpi.tsf = 0; //simulate the user changing the time
-        }
     }
 
-    //create the super receive packet handler
+    //create the super receive packet handler, two channels per group
     uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
     handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
     handler.set_tick_rate(TICK_RATE);
     handler.set_samp_rate(SAMP_RATE);
     for (size_t ch = 0; ch < NCHANNELS; ch++){
         handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+        handler.set_issue_stream_cmd(ch, &null_stream_cmd, ch/2);
     }
     handler.set_converter(id);
+    handler.set_recv_threads(true);
 
     //check the received packets
     size_t num_accum_samps = 0;
@@ -624,19 +880,204 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
         BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
         BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
         num_accum_samps += num_samps_ret;
-        if (i == NUM_PKTS_TO_TEST/2){
-            num_accum_samps = 0; //simulate the user changing the time
-        }
     }
 
-    //subsequent receives should be a timeout
-    for (size_t i = 0; i < 3; i++){
-        std::cout << "timeout check " << i << std::endl;
-        handler.recv(
-            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
-        );
-        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
-    }
+    //all channels ran dry: a timeout, not an error
+    handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 0.05, true);
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    //an error of a receive thread reaches recv()
+    dummy_recv_xports[3].set_io_status(false);
+    BOOST_REQUIRE_THROW(handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true), uhd::io_error);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 20;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            if (i == NUM_PKTS_TO_TEST/2 and ch == 2){
+                continue; //simulates a lost packet
+            }
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //check the received packets
+    size_t num_accum_samps = 0;
+    std::complex<float> mem[NUM_SAMPS_PER_BUFF*NCHANNELS];
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+        );
+        if (i == NUM_PKTS_TO_TEST/2){
+            //must get the soft overflow here
+            BOOST_REQUIRE(metadata.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+            BOOST_REQUIRE(metadata.out_of_sequence == true);
+            BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+            num_accum_samps += 10 + i%10;
+        }
+        else{
+            BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+            BOOST_CHECK(not metadata.more_fragments);
+            BOOST_CHECK(metadata.has_time_spec);
+            BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+            BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+            num_accum_samps += num_samps_ret;
+        }
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+
+    //simulate the transport failing
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        dummy_recv_xports[ch].set_io_status(false);
+    }
+
+    BOOST_REQUIRE_THROW(handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true), uhd::io_error);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 20;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+        if (i == NUM_PKTS_TO_TEST/2){
+            ifpi.tsf = 0; //simulate the user changing the time
+        }
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //check the received packets
+    size_t num_accum_samps = 0;
+    std::complex<float> mem[NUM_SAMPS_PER_BUFF*NCHANNELS];
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not metadata.more_fragments);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        num_accum_samps += num_samps_ret;
+        if (i == NUM_PKTS_TO_TEST/2){
+            num_accum_samps = 0; //simulate the user changing the time
+        }
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
 
     //simulate the transport failing
     for (size_t ch = 0; ch < NCHANNELS; ch++){
@@ -815,3 +1256,248 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_fragment){
 
     BOOST_REQUIRE_THROW(handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true), uhd::io_error);
 }
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_power_metadata){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 10;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        dummy_recv_xport.push_back_packet(ifpi, uint32_t(0x12345678*(i+1)));
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+    handler.set_power_metadata(true);
+
+    //the power is that of the samples returned by each call
+    std::vector<std::complex<float> > buff(30);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        const size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata, 1.0, true
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(metadata.has_power);
+        double peak = 0, sum = 0;
+        for (size_t j = 0; j < num_samps_ret; j++){
+            peak = std::max(peak, double(std::norm(buff[j])));
+            sum += std::norm(buff[j]);
+        }
+        BOOST_CHECK_CLOSE(metadata.peak_power, peak, 0.01);
+        BOOST_CHECK_CLOSE(metadata.mean_power, sum/num_samps_ret, 0.01);
+    }
+
+    //not together with host decimation
+    BOOST_CHECK_THROW(handler.set_host_decim(2), uhd::value_error);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_channel_batch){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t MAX_PKTS = 8;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        if (i != NUM_PKTS_TO_TEST/2){ //simulate a lost packet
+            dummy_recv_xport.push_back_packet(ifpi);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+
+    //the batches hold every packet, the one after the lost one marked
+    size_t num_accum_samps = 0, pkt = 0;
+    std::vector<std::complex<float> > buff(1000);
+    std::vector<uhd::rx_streamer::packet_info_t> packets;
+    uhd::rx_metadata_t metadata;
+    while (pkt < NUM_PKTS_TO_TEST){
+        const size_t num_samps_ret = handler.recv_batch(
+            &buff.front(), buff.size(), packets, MAX_PKTS, metadata, 1.0
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_REQUIRE(not packets.empty());
+        BOOST_CHECK(packets.size() <= MAX_PKTS);
+        size_t offset = 0;
+        BOOST_FOREACH(const uhd::rx_streamer::packet_info_t &info, packets){
+            if (pkt == NUM_PKTS_TO_TEST/2){
+                num_accum_samps += 10 + pkt%10;
+                pkt++;
+                BOOST_CHECK(info.gap_before);
+            }
+            else BOOST_CHECK(not info.gap_before);
+            BOOST_CHECK_EQUAL(info.offset, offset);
+            BOOST_CHECK_EQUAL(info.nsamps, 10 + pkt%10);
+            BOOST_CHECK(info.has_time_spec);
+            BOOST_CHECK_TS_CLOSE(info.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+            offset += info.nsamps;
+            num_accum_samps += info.nsamps;
+            pkt++;
+        }
+        BOOST_CHECK_EQUAL(num_samps_ret, offset);
+    }
+
+    //subsequent receives should be a timeout
+    handler.recv_batch(&buff.front(), buff.size(), packets, MAX_PKTS, metadata, 1.0);
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    BOOST_CHECK(packets.empty());
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_one_packet_mode){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    dummy_recv_xport_class dummy_recv_xport("big");
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //generate a bunch of packets
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        dummy_recv_xport.push_back_packet(ifpi);
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(1);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xport, _1));
+    handler.set_converter(id);
+    handler.set_one_packet(true);
+
+    //a buffer for many packets still gets one packet per call
+    size_t num_accum_samps = 0;
+    std::vector<std::complex<float> > buff(1000);
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        const size_t num_samps_ret = handler.recv(
+            &buff.front(), buff.size(), metadata, 1.0, false
+        );
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
+        num_accum_samps += num_samps_ret;
+    }
+}
+
+/***********************************************************************
+ * Test stream commands to groups of channels
+ **********************************************************************/
+static void slow_stream_cmd(size_t *num_cmds, const double secs, const bool fail, const uhd::stream_cmd_t &){
+    boost::this_thread::sleep(boost::posix_time::microseconds(long(secs*1e6)));
+    if (fail) throw uhd::io_error("no ack");
+    (*num_cmds)++;
+}
+
+BOOST_AUTO_TEST_CASE(test_sph_recv_stream_cmd_groups){
+    static const size_t NUM_CHANNELS = 4;
+    static const double CMD_TIME = 0.05;
+    uhd::transport::sph::recv_packet_handler handler(NUM_CHANNELS);
+    std::vector<size_t> num_cmds(NUM_CHANNELS, 0);
+    const uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+
+    //two groups of two channels: the groups run in parallel
+    for (size_t ch = 0; ch < NUM_CHANNELS; ch++){
+        handler.set_issue_stream_cmd(ch, boost::bind(&slow_stream_cmd, &num_cmds[ch], CMD_TIME, false, _1), ch/2);
+    }
+    handler.issue_stream_cmd(stream_cmd);
+    BOOST_CHECK(handler.get_stream_cmd_latency() >= 2*CMD_TIME);
+    BOOST_CHECK(handler.get_stream_cmd_latency() < 4*CMD_TIME);
+    for (size_t ch = 0; ch < NUM_CHANNELS; ch++){
+        BOOST_CHECK_EQUAL(num_cmds[ch], size_t(1));
+    }
+
+    //an error of one group is thrown once all groups are done
+    handler.set_issue_stream_cmd(3, boost::bind(&slow_stream_cmd, &num_cmds[3], CMD_TIME, true, _1), 1);
+    BOOST_CHECK_THROW(handler.issue_stream_cmd(stream_cmd), uhd::runtime_error);
+    BOOST_CHECK_EQUAL(num_cmds[0], size_t(2));
+    BOOST_CHECK_EQUAL(num_cmds[2], size_t(2));
+}
@@ -190,3 +190,64 @@ BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_full_buffer_mode){
         num_accum_samps += ifpi.num_payload_words32;
     }
 }
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_zero_copy){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_be";
+    id.num_outputs = 1;
+
+    dummy_send_xport_class dummy_send_xport("big");
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_converter(id);
+    handler.set_max_samples_per_packet(20);
+
+    uhd::tx_metadata_t metadata;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(0.0);
+
+    //commit without a buffer is an error
+    BOOST_CHECK_THROW(handler.commit(1), uhd::runtime_error);
+
+    //fill the packets in place
+    uhd::tx_streamer::zero_copy_buffs_t buffs;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        metadata.start_of_burst = (i == 0);
+        metadata.end_of_burst = (i == NUM_PKTS_TO_TEST-1);
+        BOOST_CHECK_EQUAL(handler.get_send_buffer(buffs, metadata, 1.0), 20);
+        BOOST_CHECK_EQUAL(buffs.item_format, "sc16_item32_be");
+        BOOST_REQUIRE_EQUAL(buffs.buffs.size(), 1);
+        std::memset(buffs.buffs[0], 0, (10 + i%10)*sizeof(uint32_t));
+        BOOST_CHECK_THROW(handler.commit(21), uhd::value_error);
+        handler.commit(10 + i%10);
+        metadata.time_spec += uhd::time_spec_t(0, 10 + i%10, SAMP_RATE);
+    }
+
+    //check the sent packets
+    size_t num_accum_samps = 0;
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        dummy_send_xport.pop_front_packet(ifpi);
+        BOOST_CHECK_EQUAL(ifpi.num_payload_words32, 10+i%10);
+        BOOST_CHECK(ifpi.has_tsf);
+        BOOST_CHECK_EQUAL(ifpi.tsf, num_accum_samps*TICK_RATE/SAMP_RATE);
+        BOOST_CHECK_EQUAL(ifpi.sob, i == 0);
+        BOOST_CHECK_EQUAL(ifpi.eob, i == NUM_PKTS_TO_TEST-1);
+        BOOST_CHECK_EQUAL(ifpi.packet_count, i%16);
+        num_accum_samps += ifpi.num_payload_words32;
+    }
+}
@@ -0,0 +1,75 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/startup_profile.hpp>
+#include <uhd/utils/static.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace uhd;
+
+static void sleep_ms(const int ms){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(ms));
+}
+
+BOOST_AUTO_TEST_CASE(test_startup_profile_phases){
+    startup_profile::reset();
+    {
+        startup_profile::scoped_phase phase("make");
+        startup_profile::begin("first");
+        sleep_ms(10);
+        startup_profile::begin("second");
+        sleep_ms(10);
+        startup_profile::end();
+    }
+
+    const startup_profile::phases_t phases = startup_profile::get_phases();
+    BOOST_REQUIRE_EQUAL(phases.size(), size_t(3));
+    BOOST_CHECK_EQUAL(phases[0].name, "make");
+    BOOST_CHECK_EQUAL(phases[1].name, "first");
+    BOOST_CHECK_EQUAL(phases[2].name, "second");
+    BOOST_CHECK(phases[1].duration_secs >= 0.009);
+    BOOST_CHECK(phases[2].start_secs >= phases[1].start_secs + phases[1].duration_secs);
+    BOOST_CHECK(phases[0].duration_secs >= phases[1].duration_secs + phases[2].duration_secs);
+
+    //end() without an open phase records nothing, reset() forgets
+    startup_profile::end();
+    BOOST_CHECK_EQUAL(startup_profile::get_phases().size(), size_t(3));
+    startup_profile::reset();
+    BOOST_CHECK(startup_profile::get_phases().empty());
+}
+
+static size_t num_deferred_calls = 0;
+
+UHD_DEFERRED_BLOCK("startup_profile_test", count_deferred_calls){
+    num_deferred_calls++;
+}
+
+BOOST_AUTO_TEST_CASE(test_startup_profile_deferred_blocks){
+    BOOST_CHECK_EQUAL(num_deferred_calls, size_t(0));
+    uhd::run_deferred_blocks("startup_profile_test");
+    BOOST_CHECK_EQUAL(num_deferred_calls, size_t(1));
+    uhd::run_deferred_blocks("startup_profile_test");
+    BOOST_CHECK_EQUAL(num_deferred_calls, size_t(1));
+
+    bool recorded = false;
+    BOOST_FOREACH(const startup_profile::phase_t &block, startup_profile::get_static_blocks()){
+        if (block.name == "count_deferred_calls") recorded = true;
+    }
+    BOOST_CHECK(recorded);
+}
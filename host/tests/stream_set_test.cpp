@@ -0,0 +1,91 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/exception.hpp>
+#include <boost/make_shared.hpp>
+#include <vector>
+
+/***********************************************************************
+ * A streamer that returns a fixed number of one-sample packets
+ **********************************************************************/
+class dummy_rx_streamer : public uhd::rx_streamer
+{
+public:
+    dummy_rx_streamer(const size_t num_packets): _num_packets(num_packets) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return 1; }
+
+    size_t recv(
+        const buffs_type &,
+        const size_t,
+        uhd::rx_metadata_t &metadata,
+        const double,
+        const bool
+    ){
+        metadata.reset();
+        if (_num_packets == 0) {
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        _num_packets--;
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+        return 1;
+    }
+
+    void issue_stream_cmd(const uhd::stream_cmd_t &) {}
+
+private:
+    size_t _num_packets;
+};
+
+BOOST_AUTO_TEST_CASE(test_stream_set_round_robin){
+    uhd::rx_streamer_set streams;
+    std::vector<char> buff(8);
+    const std::vector<void *> buffs(1, &buff.front());
+    streams.add(boost::make_shared<dummy_rx_streamer>(2), buffs, 1);
+    streams.add(boost::make_shared<dummy_rx_streamer>(0), buffs, 1);
+    streams.add(boost::make_shared<dummy_rx_streamer>(1), buffs, 1);
+    BOOST_CHECK_EQUAL(streams.size(), 3u);
+
+    // Every streamer with packets is served before one is served twice
+    uhd::rx_metadata_t md;
+    size_t index;
+    BOOST_CHECK_EQUAL(streams.recv(index, md, 0.0), 1u);
+    BOOST_CHECK_EQUAL(index, 0u);
+    BOOST_CHECK_EQUAL(streams.recv(index, md, 0.0), 1u);
+    BOOST_CHECK_EQUAL(index, 2u);
+    BOOST_CHECK_EQUAL(streams.recv(index, md, 0.0), 1u);
+    BOOST_CHECK_EQUAL(index, 0u);
+
+    // All streamers are drained
+    BOOST_CHECK_EQUAL(streams.recv(index, md, 0.001), 0u);
+    BOOST_CHECK_EQUAL(md.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+BOOST_AUTO_TEST_CASE(test_stream_set_checks){
+    uhd::rx_streamer_set streams;
+    uhd::rx_metadata_t md;
+    size_t index;
+    BOOST_CHECK_THROW(streams.recv(index, md, 0.0), uhd::runtime_error);
+    BOOST_CHECK_THROW(
+        streams.add(boost::make_shared<dummy_rx_streamer>(1), std::vector<void *>(), 1),
+        uhd::value_error
+    );
+}
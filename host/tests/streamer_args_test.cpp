@@ -0,0 +1,129 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/usrp/common/streamer_args.hpp"
+#include <uhd/utils/msg.hpp>
+#include <string>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+static std::string warnings;
+
+static void collect_warnings(msg::type_t type, const std::string &msg){
+    if (type == msg::warning) warnings += msg;
+}
+
+BOOST_AUTO_TEST_CASE(test_streamer_args_defaults){
+    const streamer_args_t streamer_args((stream_args_t("fc32", "sc16")));
+    BOOST_CHECK(not streamer_args.has_spp());
+    BOOST_CHECK_EQUAL(streamer_args.get_spp(364), size_t(364));
+    BOOST_CHECK_EQUAL(streamer_args.get_fullscale(), 1.0);
+    BOOST_CHECK_EQUAL(streamer_args.get_peak(), 1.0);
+    BOOST_CHECK_EQUAL(streamer_args.get_convert_threads(), size_t(1));
+    BOOST_CHECK_EQUAL(streamer_args.get_pipeline_depth(), size_t(0));
+    BOOST_CHECK_EQUAL(streamer_args.get_host_decim(), size_t(1));
+    BOOST_CHECK(not streamer_args.get_power_meta());
+    BOOST_CHECK_EQUAL(streamer_args.get_nontemporal_stores(), "auto");
+}
+
+BOOST_AUTO_TEST_CASE(test_streamer_args_parse){
+    stream_args_t args("fc32", "sc16");
+    args.args = device_addr_t("spp=200.0,fullscale=32768,convert_threads=2,power_meta=yes,nontemporal_stores=ON");
+    const streamer_args_t streamer_args(args);
+    BOOST_CHECK(streamer_args.has_spp());
+    BOOST_CHECK_EQUAL(streamer_args.get_spp(364), size_t(200));
+    BOOST_CHECK_EQUAL(streamer_args.get_fullscale(), 32768.0);
+    BOOST_CHECK_EQUAL(streamer_args.get_convert_threads(), size_t(2));
+    BOOST_CHECK(streamer_args.get_power_meta());
+    BOOST_CHECK_EQUAL(streamer_args.get_nontemporal_stores(), "on");
+
+    args.args = device_addr_t("spp=many");
+    BOOST_CHECK_THROW(streamer_args_t s(args), uhd::value_error);
+    args.args = device_addr_t("spp=-1");
+    BOOST_CHECK_THROW(streamer_args_t s(args), uhd::value_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_streamer_args_unknown_keys){
+    msg::register_handler(&collect_warnings);
+    stream_args_t args("fc32", "sc16");
+
+    //device specific keys, with or without a channel number
+    warnings.clear();
+    args.args = device_addr_t("underflow_policy=next_packet,dc_offset_i1=0.01,block_id0=0/Radio_0,recv_buff_size=1e6");
+    streamer_args_t s0(args);
+    BOOST_CHECK(warnings.empty());
+
+    warnings.clear();
+    args.args = device_addr_t("sp=200,fullscale=2.0");
+    streamer_args_t s1(args);
+    BOOST_CHECK(warnings.find("\"sp\"") != std::string::npos);
+    BOOST_CHECK(warnings.find("fullscale") == std::string::npos);
+    BOOST_CHECK_EQUAL(s1.get_fullscale(), 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_streamer_args_profile){
+    stream_args_t args("fc32", "sc16");
+    BOOST_CHECK_EQUAL(streamer_args_t(args).get_profile(), STREAM_PROFILE_DEFAULT);
+    args.args = device_addr_t("profile=Latency");
+    BOOST_CHECK_EQUAL(streamer_args_t(args).get_profile(), STREAM_PROFILE_LATENCY);
+    BOOST_CHECK_EQUAL(get_stream_profile(args.args), STREAM_PROFILE_LATENCY);
+    args.args = device_addr_t("profile=fast");
+    BOOST_CHECK_THROW(streamer_args_t s(args), uhd::value_error);
+
+    //the default profile leaves everything to the device
+    const stream_profile_settings_t def = compute_stream_profile(STREAM_PROFILE_DEFAULT, 1e6, 4, 16, 8000);
+    BOOST_CHECK_EQUAL(def.spp, size_t(0));
+    BOOST_CHECK_EQUAL(def.frame_size, size_t(0));
+
+    //throughput fills the frames, latency keeps packets near 100 us
+    const stream_profile_settings_t tput = compute_stream_profile(STREAM_PROFILE_THROUGHPUT, 1e6, 4, 16, 8000);
+    BOOST_CHECK_EQUAL(tput.spp, size_t((8000-16)/4));
+    BOOST_CHECK_EQUAL(tput.frame_size, 16 + tput.spp*4);
+    const stream_profile_settings_t lat = compute_stream_profile(STREAM_PROFILE_LATENCY, 1e6, 4, 16, 8000);
+    BOOST_CHECK_EQUAL(lat.spp, size_t(100));
+    BOOST_CHECK_EQUAL(lat.frame_size, size_t(16 + 400));
+    BOOST_CHECK(lat.buff_size < tput.buff_size);
+    BOOST_CHECK(lat.buff_size >= lat.num_frames*lat.frame_size);
+
+    //high rates are limited by the frame, payloads are whole words
+    BOOST_CHECK_EQUAL(compute_stream_profile(STREAM_PROFILE_LATENCY, 200e6, 4, 16, 8000).spp, tput.spp);
+    const stream_profile_settings_t sc12 = compute_stream_profile(STREAM_PROFILE_LATENCY, 1.01e6, 3, 16, 8000);
+    BOOST_CHECK_EQUAL((sc12.spp*3) % 4, size_t(0));
+
+    //unknown rate: the frame size only
+    const stream_profile_settings_t norate = compute_stream_profile(STREAM_PROFILE_LATENCY, -1.0, 4, 16, 8000);
+    BOOST_CHECK_EQUAL(norate.spp, tput.spp);
+    BOOST_CHECK_EQUAL(norate.num_frames, size_t(0));
+}
+
+BOOST_AUTO_TEST_CASE(test_streamer_args_tx_latency_window){
+    //no cap: the window of the device buffers
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t(""), 100, 1e6), size_t(64));
+
+    //whole packets up to the cap, at least one
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t("max_latency_samps=1000"), 100, 1e6), size_t(10));
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t("max_latency_samps=1050"), 100, 1e6), size_t(10));
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t("max_latency_samps=10"), 100, 1e6), size_t(1));
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t("max_latency_samps=1e6"), 100, 1e6), size_t(64));
+
+    //seconds at the rate of the stream
+    BOOST_CHECK_EQUAL(compute_tx_latency_window(64, device_addr_t("max_latency=2e-3"), 100, 1e6), size_t(20));
+    BOOST_CHECK_THROW(compute_tx_latency_window(64, device_addr_t("max_latency=2e-3"), 100, -1.0), uhd::value_error);
+    BOOST_CHECK_THROW(compute_tx_latency_window(64, device_addr_t("max_latency_samps=0"), 100, 1e6), uhd::value_error);
+}
@@ -0,0 +1,65 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+static bool count_calls(boost::atomic<size_t> *calls, bool progress){
+    calls->fetch_add(1);
+    return progress;
+}
+
+static void wait_for_calls(boost::atomic<size_t> &calls, size_t num){
+    for (size_t i = 0; i < 200 and calls.load() < num; i++){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_pooled_tasks_share_a_worker){
+    boost::atomic<size_t> busy_calls(0), idle_calls(0);
+    std::vector<uhd::task::sptr> tasks;
+    tasks.push_back(uhd::task::make_pooled(boost::bind(&count_calls, &busy_calls, true), "test", "busy"));
+    tasks.push_back(uhd::task::make_pooled(boost::bind(&count_calls, &idle_calls, false), "test", "idle"));
+    wait_for_calls(busy_calls, 100);
+    wait_for_calls(idle_calls, 100);
+    BOOST_CHECK_GE(busy_calls.load(), size_t(100));
+    BOOST_CHECK_GE(idle_calls.load(), size_t(100));
+
+    //no calls after the task is gone
+    tasks.clear();
+    const size_t num_calls = busy_calls.load();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    BOOST_CHECK_EQUAL(busy_calls.load(), num_calls);
+}
+
+static bool throw_error(boost::atomic<size_t> *calls){
+    calls->fetch_add(1);
+    throw std::runtime_error("pooled task error");
+}
+
+BOOST_AUTO_TEST_CASE(test_pooled_task_stops_on_error){
+    boost::atomic<size_t> error_calls(0), other_calls(0);
+    uhd::task::sptr error_task = uhd::task::make_pooled(boost::bind(&throw_error, &error_calls), "test", "error");
+    uhd::task::sptr other_task = uhd::task::make_pooled(boost::bind(&count_calls, &other_calls, false), "test", "other");
+    wait_for_calls(other_calls, 10);
+    BOOST_CHECK_EQUAL(error_calls.load(), size_t(1));
+    BOOST_CHECK_GE(other_calls.load(), size_t(10));
+}
@@ -0,0 +1,76 @@
+//
+// Copyright 2010-2011 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/foreach.hpp>
+
+static void idle(void){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+}
+
+static bool find_thread(const std::string &name, uhd::thread_info_t &info){
+    BOOST_FOREACH(const uhd::thread_info_t &thread, uhd::get_internal_threads()){
+        if (thread.name == name){
+            info = thread;
+            return true;
+        }
+    }
+    return false;
+}
+
+BOOST_AUTO_TEST_CASE(test_internal_thread_registry){
+    uhd::thread_info_t info;
+    {
+        uhd::task::sptr task = uhd::task::make(&idle, "async", "test task");
+        BOOST_REQUIRE(find_thread("test task", info));
+        BOOST_CHECK_EQUAL(info.role, "async");
+    }
+    BOOST_CHECK(not find_thread("test task", info));
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_config_applies_to_running_threads){
+    uhd::task::sptr task = uhd::task::make(&idle, "rx", "test rx task");
+    uhd::thread_info_t info;
+    BOOST_REQUIRE(find_thread("test rx task", info));
+    if (info.cpus.empty()) return; //the OS cannot tell the affinity
+
+    uhd::thread_config_t config;
+    config.cpus.push_back(info.cpus.front());
+    uhd::set_thread_config("rx", config);
+    BOOST_REQUIRE(find_thread("test rx task", info));
+    BOOST_CHECK_EQUAL(info.cpus.size(), size_t(1));
+    BOOST_CHECK_EQUAL(info.cpus.front(), config.cpus.front());
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_config_from_args){
+    BOOST_CHECK_THROW(
+        uhd::set_thread_config(uhd::device_addr_t("tx_thread_policy=batch")),
+        uhd::value_error
+    );
+    BOOST_CHECK_THROW(
+        uhd::set_thread_config(uhd::device_addr_t("tx_thread_cpu=two")),
+        uhd::value_error
+    );
+    BOOST_CHECK_THROW(
+        uhd::set_thread_config(uhd::device_addr_t("tx_thread_priority=2")),
+        uhd::value_error
+    );
+}
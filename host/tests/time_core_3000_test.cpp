@@ -0,0 +1,85 @@
+//
+// Copyright 2016 Ettus Research
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/usrp/cores/time_core_3000.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+
+using namespace uhd;
+
+static const double TICK_RATE = 200e6;
+
+//! A device clock that runs a little fast compared to the host
+class fake_time_iface : public wb_iface
+{
+public:
+    fake_time_iface(void): peeks(0), _start(time_spec_t::get_system_time()) {}
+
+    void poke32(const wb_addr_type, const uint32_t) {}
+    uint32_t peek32(const wb_addr_type) { return 0; }
+
+    uint64_t peek64(const wb_addr_type)
+    {
+        peeks++;
+        const double host_secs = (time_spec_t::get_system_time() - _start).get_real_secs();
+        return uint64_t(host_secs * (1.0 + 20e-6) * TICK_RATE);
+    }
+
+    size_t peeks;
+
+private:
+    const time_spec_t _start;
+};
+
+BOOST_AUTO_TEST_CASE(test_time_estimate)
+{
+    boost::shared_ptr<fake_time_iface> iface = boost::make_shared<fake_time_iface>();
+    time_core_3000::readback_bases_type rb_bases;
+    rb_bases.rb_now = 0;
+    rb_bases.rb_pps = 8;
+    time_core_3000::sptr time64 = time_core_3000::make(iface, 0, rb_bases);
+    time64->set_tick_rate(TICK_RATE);
+
+    // The first estimate reads the device, the next ones don't
+    double error = -1.0;
+    time64->get_time_estimate(&error);
+    BOOST_CHECK_EQUAL(iface->peeks, 1);
+    for (size_t i = 0; i < 100; i++) {
+        time64->get_time_estimate();
+    }
+    BOOST_CHECK_EQUAL(iface->peeks, 1);
+
+    // Estimates stay within their error bound of the device time
+    for (size_t i = 0; i < 5; i++) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(60));
+        const time_spec_t estimate = time64->get_time_estimate(&error);
+        const time_spec_t exact = time64->get_time_now();
+        BOOST_CHECK_GE(error, 0.0);
+        BOOST_CHECK_LT(error, 0.01);
+        // the exact read happens later, allow for the time in between
+        BOOST_CHECK_LE(std::abs((exact - estimate).get_real_secs()), error + 0.001);
+    }
+    BOOST_CHECK_LE(iface->peeks, 1 + 5 + 5);
+
+    // Setting the time at the next PPS means exact reads for a while
+    time64->set_time_next_pps(time_spec_t(0.0));
+    const size_t peeks = iface->peeks;
+    time64->get_time_estimate(&error);
+    time64->get_time_estimate(&error);
+    BOOST_CHECK_EQUAL(iface->peeks, peeks + 2);
+}
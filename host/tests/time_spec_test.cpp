@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/types/time_spec.hpp>
+#include <uhd/types/tick_time.hpp>
 #include <boost/foreach.hpp>
 #include <boost/thread.hpp> //sleep
 #include <iostream>
@@ -130,3 +131,27 @@ BOOST_AUTO_TEST_CASE(test_time_error_irrational_rate)
 
     BOOST_CHECK_EQUAL(err, (long long)(0));
 }
+
+BOOST_AUTO_TEST_CASE(test_tick_time_round_trip)
+{
+    static const double rate = 1625e3/6.0;
+    const uhd::tick_time_t t0(23423436291667ll, rate);
+    const uhd::tick_time_t t1 = uhd::tick_time_t::from_time_spec(t0.to_time_spec(), rate);
+    BOOST_CHECK(t0 == t1);
+    BOOST_CHECK_EQUAL(t1.ticks, t0.ticks);
+}
+
+BOOST_AUTO_TEST_CASE(test_tick_time_math)
+{
+    const uhd::tick_time_t t0(1000, 100e6);
+    const uhd::tick_time_t t1 = t0 + 250;
+    BOOST_CHECK(t1 > t0);
+    BOOST_CHECK_EQUAL(t1.ticks_since(t0), 250);
+    BOOST_CHECK(t1 - 250 == t0);
+
+    //different rates compare by time
+    const uhd::tick_time_t t2(125, 10e6);
+    BOOST_CHECK(t2 == t1);
+    BOOST_CHECK_EQUAL(t1.ticks_since(t2), 0);
+    BOOST_CHECK_EQUAL(t2.at_rate(100e6).ticks, 1250);
+}
@@ -0,0 +1,238 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <boost/test/unit_test.hpp>
+#include <uhd/tx_burst_scheduler.hpp>
+#include <uhd/exception.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+/***********************************************************************
+ * A device clock the test sets
+ **********************************************************************/
+class fake_clock
+{
+public:
+    void set(const double secs)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _now = uhd::time_spec_t(secs);
+    }
+
+    uhd::time_spec_t get(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _now;
+    }
+
+private:
+    boost::mutex _mutex;
+    uhd::time_spec_t _now;
+};
+
+/***********************************************************************
+ * A streamer that records what it is sent
+ **********************************************************************/
+struct sent_t
+{
+    uhd::tx_metadata_t metadata;
+    size_t nsamps;
+    uint32_t first_samp;
+};
+
+class recording_tx_streamer : public uhd::tx_streamer
+{
+public:
+    recording_tx_streamer(const size_t max_samps = 1000):
+        stalled(false), _max_samps(max_samps) {}
+
+    size_t get_num_channels(void) const { return 1; }
+    size_t get_max_num_samps(void) const { return _max_samps; }
+
+    //! Takes up to max_samps samples, or none while stalled (like flow control)
+    size_t send(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const double
+    ){
+        if (stalled) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            return 0;
+        }
+        sent_t s;
+        s.metadata = metadata;
+        s.nsamps = std::min(nsamps_per_buff, _max_samps);
+        s.first_samp = static_cast<const uint32_t *>(buffs[0])[0];
+        boost::mutex::scoped_lock lock(_mutex);
+        _sent.push_back(s);
+        return s.nsamps;
+    }
+
+    bool recv_async_msg(uhd::async_metadata_t &, double timeout)
+    {
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+        return false;
+    }
+
+    std::vector<sent_t> get_sent(void)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _sent;
+    }
+
+    //! Wait until n sends were recorded, at most a second
+    bool wait_for(const size_t n)
+    {
+        for (size_t i = 0; i < 1000 and get_sent().size() < n; i++) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+        return get_sent().size() >= n;
+    }
+
+    volatile bool stalled;
+
+private:
+    const size_t _max_samps;
+    boost::mutex _mutex;
+    std::vector<sent_t> _sent;
+};
+
+static uint32_t schedule(
+    uhd::tx_burst_scheduler::sptr scheduler,
+    const uint32_t first_samp,
+    const size_t nsamps,
+    const double time
+){
+    std::vector<uint32_t> samps(nsamps, 0);
+    for (size_t i = 0; i < nsamps; i++) samps[i] = first_samp + uint32_t(i);
+    return scheduler->schedule(
+        uhd::tx_streamer::buffs_type(&samps.front()), nsamps, uhd::time_spec_t(time));
+}
+
+/***********************************************************************
+ * Tests
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_burst_time_order){
+    boost::shared_ptr<recording_tx_streamer> streamer = boost::make_shared<recording_tx_streamer>();
+    fake_clock clock;
+    uhd::tx_burst_scheduler::sptr scheduler = uhd::tx_burst_scheduler::make(
+        streamer, "sc16", boost::bind(&fake_clock::get, &clock), 0.1);
+
+    // Scheduled out of order, bursts with the same time keep their order
+    schedule(scheduler, 300, 4, 3.0);
+    schedule(scheduler, 100, 4, 1.0);
+    schedule(scheduler, 200, 4, 2.0);
+    schedule(scheduler, 110, 4, 1.0);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    BOOST_CHECK(streamer->get_sent().empty());
+    BOOST_CHECK_EQUAL(scheduler->get_num_pending(), 4u);
+
+    // Each burst goes out once it is less than the lead time away
+    clock.set(0.95);
+    BOOST_REQUIRE(streamer->wait_for(2));
+    clock.set(1.95);
+    BOOST_REQUIRE(streamer->wait_for(3));
+    clock.set(2.95);
+    BOOST_REQUIRE(streamer->wait_for(4));
+
+    const std::vector<sent_t> sent = streamer->get_sent();
+    BOOST_REQUIRE_EQUAL(sent.size(), 4u);
+    const uint32_t first_samps[] = {100, 110, 200, 300};
+    const double times[] = {1.0, 1.0, 2.0, 3.0};
+    for (size_t i = 0; i < sent.size(); i++) {
+        BOOST_CHECK_EQUAL(sent[i].first_samp, first_samps[i]);
+        BOOST_CHECK_EQUAL(sent[i].nsamps, 4u);
+        BOOST_CHECK(sent[i].metadata.start_of_burst);
+        BOOST_CHECK(sent[i].metadata.end_of_burst);
+        BOOST_CHECK(sent[i].metadata.has_time_spec);
+        BOOST_CHECK_EQUAL(sent[i].metadata.time_spec.get_real_secs(), times[i]);
+    }
+    BOOST_CHECK_EQUAL(scheduler->get_num_pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_burst_split_send){
+    boost::shared_ptr<recording_tx_streamer> streamer = boost::make_shared<recording_tx_streamer>(3);
+    fake_clock clock;
+    uhd::tx_burst_scheduler::sptr scheduler = uhd::tx_burst_scheduler::make(
+        streamer, "sc16", boost::bind(&fake_clock::get, &clock), 0.1);
+
+    // A burst that takes several sends only has the time on the first
+    schedule(scheduler, 0, 7, 0.05);
+    BOOST_REQUIRE(streamer->wait_for(3));
+    const std::vector<sent_t> sent = streamer->get_sent();
+    BOOST_REQUIRE_EQUAL(sent.size(), 3u);
+    BOOST_CHECK_EQUAL(sent[0].first_samp, 0u);
+    BOOST_CHECK_EQUAL(sent[1].first_samp, 3u);
+    BOOST_CHECK_EQUAL(sent[2].first_samp, 6u);
+    BOOST_CHECK_EQUAL(sent[2].nsamps, 1u);
+    BOOST_CHECK(sent[0].metadata.start_of_burst and sent[0].metadata.has_time_spec);
+    for (size_t i = 1; i < sent.size(); i++) {
+        BOOST_CHECK(not sent[i].metadata.start_of_burst);
+        BOOST_CHECK(not sent[i].metadata.has_time_spec);
+    }
+    BOOST_CHECK(sent[2].metadata.end_of_burst);
+}
+
+BOOST_AUTO_TEST_CASE(test_late_burst){
+    boost::shared_ptr<recording_tx_streamer> streamer = boost::make_shared<recording_tx_streamer>();
+    fake_clock clock;
+    clock.set(5.0);
+    uhd::tx_burst_scheduler::sptr scheduler = uhd::tx_burst_scheduler::make(
+        streamer, "sc16", boost::bind(&fake_clock::get, &clock), 0.1);
+
+    // A burst in the past is reported instead of sent
+    schedule(scheduler, 0, 4, 5.2);
+    const uint32_t late_id = schedule(scheduler, 0, 4, 1.0);
+    uhd::async_metadata_t md;
+    BOOST_REQUIRE(scheduler->recv_async_msg(md, 1.0));
+    BOOST_CHECK_EQUAL(md.event_code, uhd::async_metadata_t::EVENT_CODE_TIME_ERROR);
+    BOOST_CHECK(md.has_time_spec);
+    BOOST_CHECK_EQUAL(md.time_spec.get_real_secs(), 1.0);
+    BOOST_CHECK_EQUAL(md.user_payload[0], late_id);
+    BOOST_CHECK(streamer->get_sent().empty());
+
+    // The burst behind it is still sent on time
+    clock.set(5.15);
+    BOOST_REQUIRE(streamer->wait_for(1));
+    BOOST_CHECK_EQUAL(streamer->get_sent()[0].metadata.time_spec.get_real_secs(), 5.2);
+    BOOST_CHECK(not scheduler->recv_async_msg(md, 0.0));
+
+    std::vector<uint32_t> samps(1);
+    BOOST_CHECK_THROW(
+        scheduler->schedule(uhd::tx_streamer::buffs_type(&samps.front()), 0, uhd::time_spec_t(6.0)),
+        uhd::value_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_shutdown){
+    boost::shared_ptr<recording_tx_streamer> streamer = boost::make_shared<recording_tx_streamer>();
+    fake_clock clock;
+    {
+        uhd::tx_burst_scheduler::sptr scheduler = uhd::tx_burst_scheduler::make(
+            streamer, "sc16", boost::bind(&fake_clock::get, &clock), 0.1);
+        // One burst stuck in flow control, more waiting behind it
+        streamer->stalled = true;
+        schedule(scheduler, 0, 4, 0.0);
+        for (size_t i = 0; i < 10; i++) schedule(scheduler, 0, 4, 100.0 + i);
+        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+        BOOST_CHECK_EQUAL(scheduler->get_num_pending(), 11u);
+    }
+    // Destruction returned without sending anything
+    BOOST_CHECK(streamer->get_sent().empty());
+}
@@ -0,0 +1,486 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Times the receive and send packet handlers on in-memory CHDR packets,
+// so changes to the streamers can be measured without a device.
+// With --check-allocs, it also fails when recv() or send() allocate
+// memory once streaming, and shows where the allocations came from.
+
+#include "../lib/transport/super_recv_packet_handler.hpp"
+#include "../lib/transport/super_send_packet_handler.hpp"
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/convert.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+static const double TICK_RATE = 200e6;
+static const double SAMP_RATE = 10e6;
+static const size_t NUM_FRAMES = 32;
+static const size_t FC_WINDOW = 8; //packets per flow control update
+static const size_t HDR_WORDS32 = 4; //CHDR header, SID and time
+
+/***********************************************************************
+ * Allocation check: while armed, operator new counts the allocations
+ * of the timed thread and keeps the call stacks of the first ones.
+ * This replaces operator new for libuhd too where the program's
+ * operator new is used by shared libraries (ELF and Mach-O, not
+ * Windows DLLs), and the call stacks need glibc.
+ **********************************************************************/
+static const size_t MAX_ALLOC_STACKS = 4;
+static const int ALLOC_STACK_DEPTH = 16;
+
+struct alloc_check_t{
+    bool armed;
+    bool in_hook;
+    boost::thread::id thread;
+    size_t num_allocs;
+    size_t num_stacks;
+    void *stacks[MAX_ALLOC_STACKS][ALLOC_STACK_DEPTH];
+    int depths[MAX_ALLOC_STACKS];
+};
+
+static alloc_check_t alloc_check;
+
+void *operator new(std::size_t size){
+    if (alloc_check.armed and not alloc_check.in_hook and boost::this_thread::get_id() == alloc_check.thread){
+        alloc_check.in_hook = true;
+        alloc_check.num_allocs++;
+        #ifdef __GLIBC__
+        if (alloc_check.num_stacks < MAX_ALLOC_STACKS){
+            const size_t i = alloc_check.num_stacks++;
+            alloc_check.depths[i] = backtrace(alloc_check.stacks[i], ALLOC_STACK_DEPTH);
+        }
+        #endif
+        alloc_check.in_hook = false;
+    }
+    void *mem = std::malloc((size == 0)? 1 : size);
+    if (mem == NULL) throw std::bad_alloc();
+    return mem;
+}
+
+void operator delete(void *mem) throw(){
+    std::free(mem);
+}
+
+//! Start counting the allocations of the calling thread
+static void arm_alloc_check(void){
+    #ifdef __GLIBC__
+    void *stack[1];
+    backtrace(stack, 1); //loads libgcc, which allocates the first time
+    #endif
+    alloc_check.thread = boost::this_thread::get_id();
+    alloc_check.num_allocs = 0;
+    alloc_check.num_stacks = 0;
+    alloc_check.armed = true;
+}
+
+//! Stop counting, print the call stacks, return the number of allocations
+static size_t disarm_alloc_check(void){
+    alloc_check.armed = false;
+    for (size_t i = 0; i < alloc_check.num_stacks; i++){
+        std::cerr << "allocation " << i << " in the streaming loop:" << std::endl;
+        #ifdef __GLIBC__
+        char **symbols = backtrace_symbols(alloc_check.stacks[i], alloc_check.depths[i]);
+        for (int j = 1; symbols != NULL and j < alloc_check.depths[i]; j++){
+            std::cerr << "    " << symbols[j] << std::endl;
+        }
+        std::free(symbols);
+        #endif
+    }
+    return alloc_check.num_allocs;
+}
+
+/***********************************************************************
+ * A managed buffer on one frame of a ring, released by doing nothing
+ **********************************************************************/
+class frame_mrb : public managed_recv_buffer{
+public:
+    void release(void){}
+    sptr get_new(char *mem, const size_t len){
+        return make(this, mem, len);
+    }
+};
+
+class frame_msb : public managed_send_buffer{
+public:
+    void release(void){}
+    sptr get_new(char *mem, const size_t len){
+        return make(this, mem, len);
+    }
+};
+
+/***********************************************************************
+ * An endless source of data packets for one channel. The payloads are
+ * written once, the headers on each packet like a device would.
+ **********************************************************************/
+class packet_source{
+public:
+    packet_source(const size_t chan, const size_t spp, const size_t bytes_per_item):
+        _frame_size((HDR_WORDS32 + (spp*bytes_per_item + 3)/4)*sizeof(uint32_t)),
+        _mem(NUM_FRAMES*_frame_size),
+        _index(0)
+    {
+        for (size_t i = 0; i < NUM_FRAMES; i++) _mrbs.push_back(boost::make_shared<frame_mrb>());
+        for (size_t i = 0; i < _mem.size(); i++) _mem[i] = char(i*7);
+        _ifpi.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        _ifpi.num_payload_words32 = (spp*bytes_per_item + 3)/4;
+        _ifpi.num_payload_bytes = spp*bytes_per_item;
+        _ifpi.packet_count = 0;
+        _ifpi.sob = false;
+        _ifpi.eob = false;
+        _ifpi.has_sid = true;
+        _ifpi.sid = uint32_t(chan);
+        _ifpi.has_cid = false;
+        _ifpi.has_tsi = false;
+        _ifpi.has_tsf = true;
+        _ifpi.tsf = 0;
+        _ifpi.has_tlr = false;
+        _tsf_per_packet = uint64_t(spp*(TICK_RATE/SAMP_RATE));
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(double){
+        char *frame = &_mem[_index*_frame_size];
+        vrt::chdr::if_hdr_pack_le(reinterpret_cast<uint32_t *>(frame), _ifpi);
+        managed_recv_buffer::sptr mrb = _mrbs[_index]->get_new(frame, _ifpi.num_packet_words32*sizeof(uint32_t));
+        _ifpi.packet_count++;
+        _ifpi.tsf += _tsf_per_packet;
+        _index = (_index + 1) % NUM_FRAMES;
+        return mrb;
+    }
+
+private:
+    const size_t _frame_size;
+    std::vector<char> _mem;
+    std::vector<boost::shared_ptr<frame_mrb> > _mrbs;
+    size_t _index;
+    vrt::if_packet_info_t _ifpi;
+    uint64_t _tsf_per_packet;
+};
+
+/***********************************************************************
+ * An endless sink of packets for one channel. With flow control,
+ * every buffer takes a credit, and the credits come back a window
+ * at a time, like the flow control responses of a device.
+ **********************************************************************/
+class packet_sink{
+public:
+    packet_sink(const size_t frame_size, const bool flow_control):
+        _frame_size(frame_size),
+        _mem(NUM_FRAMES*_frame_size),
+        _index(0),
+        _flow_control(flow_control),
+        _credits(FC_WINDOW)
+    {
+        for (size_t i = 0; i < NUM_FRAMES; i++) _msbs.push_back(boost::make_shared<frame_msb>());
+    }
+
+    managed_send_buffer::sptr get_send_buff(double){
+        if (_flow_control){
+            if (_credits == 0) _credits = FC_WINDOW; //an update came in
+            _credits--;
+        }
+        managed_send_buffer::sptr msb = _msbs[_index]->get_new(&_mem[_index*_frame_size], _frame_size);
+        _index = (_index + 1) % NUM_FRAMES;
+        return msb;
+    }
+
+private:
+    const size_t _frame_size;
+    std::vector<char> _mem;
+    std::vector<boost::shared_ptr<frame_msb> > _msbs;
+    size_t _index;
+    const bool _flow_control;
+    size_t _credits;
+};
+
+//! Count the flow control updates of the receive handler
+static void count_flowctrl(size_t *num_updates, const size_t){
+    (*num_updates)++;
+}
+
+/***********************************************************************
+ * The benchmarks
+ **********************************************************************/
+struct bench_config_t{
+    std::string direction;
+    size_t num_chans;
+    size_t spp;
+    size_t buff_samps;
+    std::string otw;
+    std::string cpu;
+    std::string converter;
+    bool flow_control;
+    size_t num_packets;
+    size_t convert_threads;
+    bool zero_copy;
+    bool check_allocs;
+};
+
+struct bench_result_t{
+    double ns_per_packet;
+    double gbytes_per_sec; //of the samples in the user buffers
+    size_t num_allocs; //in the timed loop, with check_allocs
+};
+
+//! Make the converter with priority 0 the best one, for the scalar timings.
+//! There is no way back, so this has to come after the default timings.
+static void prefer_generic_converter(const uhd::convert::id_type &id){
+    static const uhd::convert::priority_type PRIO_OVER_ALL = 1 << 20;
+    uhd::convert::register_converter(id, uhd::convert::get_converter(id, 0), PRIO_OVER_ALL, "generic");
+}
+
+static bench_result_t bench_recv(const bench_config_t &config){
+    uhd::convert::id_type id;
+    id.input_format = config.otw + "_item32_le";
+    id.num_inputs = 1;
+    id.output_format = config.cpu;
+    id.num_outputs = 1;
+    if (config.converter == "generic") prefer_generic_converter(id);
+    const size_t bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.input_format);
+    const size_t bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.output_format);
+
+    std::vector<boost::shared_ptr<packet_source> > sources;
+    size_t num_fc_updates = 0;
+    sph::recv_packet_handler handler(config.num_chans);
+    handler.set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_le);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < config.num_chans; ch++){
+        sources.push_back(boost::shared_ptr<packet_source>(
+            new packet_source(ch, config.spp, bytes_per_otw_item)));
+        handler.set_xport_chan_get_buff(ch, boost::bind(&packet_source::get_recv_buff, sources.back(), _1));
+        handler.set_xport_chan_sid(ch, true, uint32_t(ch));
+        if (config.flow_control){
+            handler.set_xport_handle_flowctrl(ch, boost::bind(&count_flowctrl, &num_fc_updates, _1), FC_WINDOW);
+        }
+    }
+    handler.set_converter(id);
+    handler.set_convert_threads(config.convert_threads);
+
+    std::vector<std::vector<char> > buffs_mem(config.num_chans,
+        std::vector<char>(config.buff_samps*bytes_per_cpu_item));
+    std::vector<void *> buff_ptrs;
+    for (size_t ch = 0; ch < config.num_chans; ch++) buff_ptrs.push_back(&buffs_mem[ch].front());
+    const uhd::rx_streamer::buffs_type buffs(buff_ptrs);
+
+    //warm up, then time until the channels got num_packets each
+    uhd::rx_metadata_t md;
+    uhd::rx_streamer::zero_copy_buffs_t zc_buffs;
+    const size_t num_samps = config.num_packets*config.spp;
+    size_t num_accum_samps = 0;
+    for (size_t i = 0; i < NUM_FRAMES; i++){
+        if (config.zero_copy) handler.recv_zero_copy(zc_buffs, md, 1.0);
+        else handler.recv(buffs, config.buff_samps, md, 1.0, false);
+    }
+    if (config.check_allocs) arm_alloc_check();
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    while (num_accum_samps < num_samps){
+        if (config.zero_copy) num_accum_samps += handler.recv_zero_copy(zc_buffs, md, 1.0);
+        else num_accum_samps += handler.recv(buffs, config.buff_samps, md, 1.0, false);
+        if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE){
+            disarm_alloc_check();
+            throw uhd::runtime_error("recv() failed: " + md.strerror());
+        }
+    }
+    const double secs = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+
+    bench_result_t result;
+    result.num_allocs = config.check_allocs? disarm_alloc_check() : 0;
+    result.ns_per_packet = secs*1e9*config.spp/num_accum_samps/config.num_chans;
+    result.gbytes_per_sec = num_accum_samps*config.num_chans*bytes_per_cpu_item/secs/1e9;
+    return result;
+}
+
+static bench_result_t bench_send(const bench_config_t &config){
+    uhd::convert::id_type id;
+    id.input_format = config.cpu;
+    id.num_inputs = 1;
+    id.output_format = config.otw + "_item32_le";
+    id.num_outputs = 1;
+    if (config.converter == "generic") prefer_generic_converter(id);
+    const size_t bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.output_format);
+    const size_t bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.input_format);
+    const size_t frame_size = (HDR_WORDS32 + (config.spp*bytes_per_otw_item + 3)/4)*sizeof(uint32_t);
+
+    std::vector<boost::shared_ptr<packet_sink> > sinks;
+    sph::send_packet_handler handler(config.num_chans);
+    handler.set_vrt_packer(&vrt::chdr::if_hdr_pack_le);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < config.num_chans; ch++){
+        sinks.push_back(boost::shared_ptr<packet_sink>(new packet_sink(frame_size, config.flow_control)));
+        handler.set_xport_chan_get_buff(ch, boost::bind(&packet_sink::get_send_buff, sinks.back(), _1));
+        handler.set_xport_chan_sid(ch, true, uint32_t(ch));
+    }
+    handler.set_enable_trailer(false);
+    handler.set_converter(id);
+    handler.set_convert_threads(config.convert_threads);
+    handler.set_max_samples_per_packet(config.spp);
+
+    std::vector<std::vector<char> > buffs_mem(config.num_chans,
+        std::vector<char>(config.buff_samps*bytes_per_cpu_item));
+    std::vector<const void *> buff_ptrs;
+    for (size_t ch = 0; ch < config.num_chans; ch++) buff_ptrs.push_back(&buffs_mem[ch].front());
+    const uhd::tx_streamer::buffs_type buffs(buff_ptrs);
+
+    uhd::tx_metadata_t md;
+    md.start_of_burst = md.end_of_burst = md.has_time_spec = false;
+    uhd::tx_streamer::zero_copy_buffs_t zc_buffs;
+    const size_t num_samps = config.num_packets*config.spp;
+    size_t num_accum_samps = 0;
+    for (size_t i = 0; i < NUM_FRAMES; i++){
+        if (config.zero_copy) handler.commit(handler.get_send_buffer(zc_buffs, md, 1.0));
+        else handler.send(buffs, config.buff_samps, md, 1.0);
+    }
+    if (config.check_allocs) arm_alloc_check();
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    while (num_accum_samps < num_samps){
+        if (config.zero_copy){
+            const size_t nsamps = handler.get_send_buffer(zc_buffs, md, 1.0);
+            handler.commit(nsamps);
+            num_accum_samps += nsamps;
+        }
+        else num_accum_samps += handler.send(buffs, config.buff_samps, md, 1.0);
+    }
+    const double secs = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+
+    bench_result_t result;
+    result.num_allocs = config.check_allocs? disarm_alloc_check() : 0;
+    result.ns_per_packet = secs*1e9*config.spp/num_accum_samps/config.num_chans;
+    result.gbytes_per_sec = num_accum_samps*config.num_chans*bytes_per_cpu_item/secs/1e9;
+    return result;
+}
+
+/***********************************************************************
+ * Main code + dispatcher
+ **********************************************************************/
+static std::vector<std::string> split_list(const std::string &list){
+    std::vector<std::string> items;
+    boost::split(items, list, boost::is_any_of(","));
+    return items;
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    std::string directions, channels, converters;
+    bench_config_t config;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("directions", po::value<std::string>(&directions)->default_value("rx,tx"), "which handlers to time (rx, tx or rx,tx)")
+        ("channels", po::value<std::string>(&channels)->default_value("1,2,4,8,16"), "numbers of channels per streamer to time, e.g. \"1,4\"")
+        ("converters", po::value<std::string>(&converters)->default_value("default,generic"), "converters to time: default (the best one for this CPU) and/or generic")
+        ("spp", po::value<size_t>(&config.spp)->default_value(2000), "samples per packet")
+        ("buff_samps", po::value<size_t>(&config.buff_samps)->default_value(0), "samples per recv() or send() call, 0 for one packet (fewer than spp fragments the packets)")
+        ("otw", po::value<std::string>(&config.otw)->default_value("sc16"), "over-the-wire format")
+        ("cpu", po::value<std::string>(&config.cpu)->default_value("fc32"), "host format")
+        ("fc", "call the flow control callbacks, every 8 packets")
+        ("convert_threads", po::value<size_t>(&config.convert_threads)->default_value(1), "threads converting the channels of a streamer")
+        ("zero-copy", "time recv_zero_copy() and get_send_buffer()/commit() instead, without conversion")
+        ("packets", po::value<size_t>(&config.num_packets)->default_value(100000), "packets per channel to time")
+        ("csv", "print the results as CSV")
+        ("check-allocs", "fail when recv() or send() allocate memory after the warm-up")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Streamer Microbenchmark %s") % desc << std::endl;
+        std::cout <<
+        "    Times the receive and send packet handlers on in-memory CHDR\n"
+        "    packets, without a device. The time per packet includes making\n"
+        "    the packet headers, as a device would, and is per channel.\n"
+        "    GB/s is the throughput of the samples in the user buffers."
+        << std::endl;
+        return EXIT_SUCCESS;
+    }
+    config.flow_control = vm.count("fc") != 0;
+    config.zero_copy = vm.count("zero-copy") != 0;
+    config.check_allocs = vm.count("check-allocs") != 0;
+    if (config.buff_samps == 0) config.buff_samps = config.spp;
+
+    if (vm.count("csv")){
+        std::cout << "direction,channels,spp,buff_samps,otw,cpu,converter,fc,ns_per_packet,gbytes_per_sec" << std::endl;
+    } else {
+        std::cout << boost::format("%-4s %4s %6s %6s %-10s %-9s %3s %12s %8s")
+            % "dir" % "chan" % "spp" % "buff" % "otw/cpu" % "converter" % "fc" % "ns/packet" % "GB/s" << std::endl;
+    }
+    const std::vector<std::string> converter_list = split_list(converters);
+    BOOST_FOREACH(const std::string &converter, converter_list){
+        if (converter != "default" and converter != "generic"){
+            throw uhd::value_error("Unknown converter: " + converter);
+        }
+    }
+    size_t num_allocating = 0;
+    static const char *converter_order[] = {"default", "generic"};
+    BOOST_FOREACH(const std::string &converter, converter_order){
+        if (std::find(converter_list.begin(), converter_list.end(), converter) == converter_list.end()) continue;
+        BOOST_FOREACH(const std::string &direction, split_list(directions)){
+            BOOST_FOREACH(const std::string &chans, split_list(channels)){
+                config.direction = direction;
+                config.num_chans = boost::lexical_cast<size_t>(chans);
+                config.converter = converter;
+                if (config.num_chans == 0){
+                    throw uhd::value_error("The number of channels must be at least 1.");
+                }
+
+                bench_result_t result;
+                if (direction == "rx") result = bench_recv(config);
+                else if (direction == "tx") result = bench_send(config);
+                else throw uhd::value_error("Unknown direction: " + direction);
+
+                if (vm.count("csv")){
+                    std::cout << boost::format("%s,%u,%u,%u,%s,%s,%s,%d,%.1f,%.3f")
+                        % direction % config.num_chans % config.spp % config.buff_samps
+                        % config.otw % config.cpu % converter % config.flow_control
+                        % result.ns_per_packet % result.gbytes_per_sec << std::endl;
+                } else {
+                    std::cout << boost::format("%-4s %4u %6u %6u %-10s %-9s %3s %12.1f %8.3f")
+                        % direction % config.num_chans % config.spp % config.buff_samps
+                        % (config.otw + "/" + config.cpu) % converter
+                        % (config.flow_control? "on" : "off")
+                        % result.ns_per_packet % result.gbytes_per_sec << std::endl;
+                }
+                if (result.num_allocs != 0){
+                    std::cerr << boost::format("%s with %u channels: %u allocations in %u packets per channel")
+                        % direction % config.num_chans % result.num_allocs % config.num_packets << std::endl;
+                    num_allocating++;
+                }
+            }
+        }
+    }
+    return (num_allocating == 0)? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/waveform_source.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace uhd;
+
+static const double SAMP_RATE = 10e6;
+static const double PI = std::acos(-1.0);
+
+static double max_error(
+    const std::vector<std::complex<float> > &buff,
+    const std::vector<std::complex<double> > &expected
+){
+    double err = 0.0;
+    for (size_t k = 0; k < buff.size(); k++) {
+        err = std::max(err, std::abs(std::complex<double>(buff[k]) - expected[k]));
+    }
+    return err;
+}
+
+BOOST_AUTO_TEST_CASE(test_waveform_tones){
+    waveform_source::sptr wave = waveform_source::make(SAMP_RATE);
+    wave->add_tone(1234567.8, 0.5, 1.0);
+    wave->add_tone(-3.3e6, 0.25);
+    BOOST_CHECK_EQUAL(wave->get_num_components(), 2u);
+
+    //odd lengths cover the tails of the SIMD kernels
+    std::vector<std::complex<float> > buff(100003);
+    wave->generate(&buff.front(), 1001);
+    wave->generate(&buff.front() + 1001, buff.size() - 1001);
+
+    std::vector<std::complex<double> > expected(buff.size());
+    for (size_t k = 0; k < buff.size(); k++) {
+        const double t = k/SAMP_RATE;
+        expected[k] = std::polar(0.5, 2*PI*1234567.8*t + 1.0)
+                    + std::polar(0.25, -2*PI*3.3e6*t);
+    }
+    BOOST_CHECK_LT(max_error(buff, expected), 2e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_waveform_set_freq){
+    waveform_source::sptr wave = waveform_source::make(SAMP_RATE);
+    const size_t index = wave->add_tone(1e6, 1.0);
+    std::vector<std::complex<float> > buff(2000);
+    wave->generate(&buff.front(), 1000);
+    wave->set_freq(index, 2e6);
+    wave->generate(&buff.front() + 1000, 1000);
+
+    //the phase carries over the frequency change
+    std::vector<std::complex<double> > expected(buff.size());
+    for (size_t k = 0; k < buff.size(); k++) {
+        const double turns = (k < 1000)? k*0.1 : 100.0 + (k - 1000)*0.2;
+        expected[k] = std::polar(1.0, 2*PI*turns);
+    }
+    BOOST_CHECK_LT(max_error(buff, expected), 2e-6);
+
+    BOOST_CHECK_THROW(wave->set_freq(1, 1e6), uhd::index_error);
+    BOOST_CHECK_THROW(wave->set_ampl(1, 1.0), uhd::index_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_waveform_chirp){
+    waveform_source::sptr wave = waveform_source::make(SAMP_RATE);
+    const size_t len = 1000;
+    wave->add_chirp(-2e6, 3e6, len/SAMP_RATE, 0.8);
+
+    //2.5 periods: the frequency jumps back, the phase does not
+    std::vector<std::complex<float> > buff(2500);
+    wave->generate(&buff.front(), buff.size());
+
+    std::vector<std::complex<double> > expected(buff.size());
+    double turns = 0.0;
+    for (size_t k = 0; k < buff.size(); k++) {
+        expected[k] = std::polar(0.8, 2*PI*turns);
+        turns += (-2e6 + (k % len)*5e6/len)/SAMP_RATE;
+    }
+    BOOST_CHECK_LT(max_error(buff, expected), 2e-6);
+
+    BOOST_CHECK_THROW(wave->add_chirp(0.0, 1e6, 1e-7, 1.0), uhd::value_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_waveform_sc16){
+    waveform_source::sptr wave = waveform_source::make(SAMP_RATE);
+    wave->add_tone(0.0, 0.5);
+    wave->add_tone(0.0, 0.75, PI/2);
+    std::vector<std::complex<int16_t> > buff(10);
+    wave->generate(&buff.front(), buff.size());
+    //I is 0.5 and Q 0.75 of full scale
+    BOOST_CHECK_EQUAL(buff[9].real(), 16384);
+    BOOST_CHECK_EQUAL(buff[9].imag(), 24575);
+
+    wave->set_ampl(1, 1.5);
+    wave->generate(&buff.front(), buff.size());
+    BOOST_CHECK_EQUAL(buff[9].imag(), 32767);
+}
+
+BOOST_AUTO_TEST_CASE(test_waveform_send_buffer){
+    waveform_source::sptr ref = waveform_source::make(SAMP_RATE);
+    waveform_source::sptr wave = waveform_source::make(SAMP_RATE);
+    ref->add_tone(1e6, 0.7);
+    wave->add_tone(1e6, 0.7);
+
+    std::vector<std::complex<int16_t> > expected(1500);
+    ref->generate(&expected.front(), expected.size());
+
+    std::vector<uint32_t> items0(expected.size()), items1(expected.size());
+    tx_streamer::zero_copy_buffs_t buffs;
+    buffs.buffs.push_back(&items0.front());
+    buffs.buffs.push_back(&items1.front());
+    buffs.nsamps = items0.size();
+    buffs.item_format = "sc16_item32_le";
+    wave->generate(buffs, buffs.nsamps);
+
+    //I in the upper half, Q in the lower half, the same on both channels
+    for (size_t k = 0; k < expected.size(); k++) {
+        const int16_t i = int16_t(uhd::wtohx(items0[k]) >> 16);
+        const int16_t q = int16_t(uhd::wtohx(items0[k]) & 0xffff);
+        BOOST_CHECK_LE(std::abs(i - expected[k].real()), 1);
+        BOOST_CHECK_LE(std::abs(q - expected[k].imag()), 1);
+        BOOST_CHECK_EQUAL(items0[k], items1[k]);
+    }
+
+    BOOST_CHECK_THROW(wave->generate(buffs, buffs.nsamps + 1), uhd::value_error);
+}
@@ -23,11 +23,20 @@
 #include <boost/format.hpp>
 #include <boost/timer.hpp>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <map>
 #include <complex>
+#include <limits>
 #include <stdint.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define HAVE_CYCLE_COUNTER
+#endif
 
 namespace po = boost::program_options;
 using namespace uhd::convert;
@@ -71,6 +80,19 @@ void configure_conv(
             conv->set_scalar(32767.);
             return;
         }
+        if (out_type == "sc12") {
+            std::cout << "Setting scalar to 2047." << std::endl;
+            conv->set_scalar(2047.);
+            return;
+        }
+    }
+
+    if (in_type == "sc12") {
+        if (out_type == "fc32") {
+            std::cout << "Setting scalar to 1/2048." << std::endl;
+            conv->set_scalar(1/2048.);
+            return;
+        }
     }
 
     std::cout << "No configuration required." << std::endl;
@@ -147,6 +169,8 @@ void init_buffers(
             } else if (type == "item32") {
                 init_inc_vector< uint32_t >(buf[i], n_items);
                 init_random_vector_real_int<uint32_t>(buf[i], n_items);
+            } else if (type == "sc12") {
+                init_inc_vector< uint8_t >(buf[i], buf[i].size());
             } else {
                 throw uhd::runtime_error(str(
                             boost::format("Cannot handle data type: %s") % type
@@ -177,6 +201,8 @@ void init_buffers(
             init_random_vector_real_int<int16_t>(buf[i], n_items);
         } else if (type == "item32") {
             init_random_vector_real_int<uint32_t>(buf[i], n_items);
+        } else if (type == "sc12") {
+            init_random_vector_real_int<uint8_t>(buf[i], buf[i].size());
         } else {
             throw uhd::runtime_error(str(
                 boost::format("Cannot handle data type: %s") % type
@@ -185,21 +211,51 @@ void init_buffers(
     }
 }
 
-// Returns time elapsed
+// The time stamp counter, which counts at a constant rate close to the
+// nominal clock of the CPU; 0 where there is none
+uint64_t read_cycle_counter(void)
+{
+#ifdef HAVE_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Returns time elapsed, and the cycles elapsed in cycles
 double run_benchmark(
         converter::sptr conv,
         const std::vector<const void *> &input_buf_refs,
         const std::vector<void *> &output_buf_refs,
         size_t n_items,
-        size_t iterations
+        size_t iterations,
+        uint64_t &cycles
 ) {
     boost::timer benchmark_timer;
+    const uint64_t start_cycles = read_cycle_counter();
     for (size_t i = 0; i < iterations; i++) {
         conv->conv(input_buf_refs, output_buf_refs, n_items);
     }
+    cycles = read_cycle_counter() - start_cycles;
     return benchmark_timer.elapsed();
 }
 
+// Print every registered conversion with the bytes per item of its formats
+void list_converters(void)
+{
+    std::cout << "{{{" << std::endl;
+    std::cout << "in,n_inputs,out,n_outputs,in_bytes,out_bytes" << std::endl;
+    BOOST_FOREACH(const id_type &id, get_converter_ids()) {
+        std::cout << boost::format("%s,%d,%s,%d,%d,%d")
+            % id.input_format % id.num_inputs
+            % id.output_format % id.num_outputs
+            % get_bytes_per_item(id.input_format)
+            % get_bytes_per_item(id.output_format)
+            << std::endl;
+    }
+    std::cout << "}}}" << std::endl;
+}
+
 template <typename T>
 std::string void_ptr_to_hexstring(const void *v_ptr, size_t index)
 {
@@ -283,12 +339,15 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
         ("samples",  po::value<size_t>(&n_samples)->default_value(1000000), "Number of samples per iteration")
         ("iterations",  po::value<size_t>(&iterations)->default_value(10000), "Number of iterations per benchmark")
         ("priorities", po::value<std::string>(&priorities)->default_value("default"), "Converter priorities. Can be 'default', 'all', or a comma-separated list of priorities.")
-        ("max-prio", po::value<priority_type>(&max_prio)->default_value(4), "Largest available priority (advanced feature)")
+        ("max-prio", po::value<priority_type>(&max_prio)->default_value(-1), "With 'all', skip this priority and above, -1 for no limit (advanced feature)")
         ("n-inputs",   po::value<size_t>(&n_inputs)->default_value(1),  "Number of input vectors")
         ("n-outputs",  po::value<size_t>(&n_outputs)->default_value(1), "Number of output vectors")
         ("debug-converter", "Skip benchmark and print conversion results. Implies iterations==1 and will only run on a single converter.")
         ("seed-mode", po::value<std::string>(&seed_mode)->default_value("random"), "How to initialize the data: random, incremental")
         ("hex", "When using debug mode, dump memory in hex")
+        ("list", "List every registered conversion and exit")
+        ("nontemporal", "Ask the converters to write with non-temporal stores, which bypass the caches (only some converters have them)")
+        ("verify", "After the benchmark, check that every converter gives the same output as the generic one (prio 0), bit for bit. Converters that round instead of truncating will differ.")
     ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -300,12 +359,19 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
         std::cout << "  Use this to benchmark or debug converters." << std::endl
                   << "  When using as a benchmark tool, it will output the execution time\n"
                      "  for every conversion run in CSV format to stdout. Every line between\n"
-                     "  the output delimiters {{{ }}} is of the format: <PRIO>,<TIME IN MILLISECONDS>\n"
+                     "  the output delimiters {{{ }}} is of the format: <PRIO>,<TIME IN MILLISECONDS>,...\n"
+                     "  with the throughput (input and output bytes) and the time stamp counter\n"
+                     "  cycles per sample, where the CPU has such a counter.\n"
                      "  When using for converter debugging, every line is formatted as\n"
                      "  <INPUT_VALUE>,<OUTPUT_VALUE>\n" << std::endl;
         return EXIT_FAILURE;
     }
 
+    if (vm.count("list")) {
+        list_converters();
+        return EXIT_SUCCESS;
+    }
+
     // Parse more arguments
     if (seed_mode == "incremental") {
         buf_seed_mode = INC;
@@ -337,14 +403,21 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
             return EXIT_FAILURE;
         }
     } else if (priorities == "all") {
-        for (priority_type i = 0; i < max_prio; i++) {
-            try {
-                // get_converter() returns a factory function, execute that immediately:
-                converter::sptr conv_for_prio = get_converter(converter_id, i)(); // Can throw a uhd::key_error
-                conv_list[i] = conv_for_prio;
-            } catch (...) {
+        // Only the converters this CPU supports are registered
+        std::vector<priority_type> registered_prios;
+        try {
+            registered_prios = get_converter_priorities(converter_id); // Can throw a uhd::key_error
+        } catch(const uhd::key_error &e) {
+            std::cout << "No converters found." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::reverse(registered_prios.begin(), registered_prios.end()); // Lowest first
+        BOOST_FOREACH(const priority_type i, registered_prios) {
+            if (max_prio >= 0 and i >= max_prio) {
                 continue;
             }
+            // get_converter() returns a factory function, execute that immediately:
+            conv_list[i] = get_converter(converter_id, i)();
         }
     } else { // Assume that priorities contains a list of prios (e.g. 0,2,3)
         std::vector<std::string> prios_in_list;
@@ -369,8 +442,10 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     const size_t in_size  = get_bytes_per_item(in_type);
     const size_t out_size = get_bytes_per_item(out_type);
     // Create the buffers and fill them with random data & zeros, respectively
-    std::vector< std::vector<char> > input_buffers(n_inputs, std::vector<char>(in_size * n_samples, 0));
-    std::vector< std::vector<char> > output_buffers(n_outputs, std::vector<char>(out_size * n_samples, 0));
+    // Packed formats (e.g. sc12) are read and written in whole lines, so leave room after the last item
+    const size_t pad_size = 16;
+    std::vector< std::vector<char> > input_buffers(n_inputs, std::vector<char>(in_size * n_samples + pad_size, 0));
+    std::vector< std::vector<char> > output_buffers(n_outputs, std::vector<char>(out_size * n_samples + pad_size, 0));
     init_buffers(input_buffers, in_type, in_size, buf_seed_mode);
     // Create ref vectors for the converter:
     std::vector<const void *>  input_buf_refs(n_inputs);
@@ -385,28 +460,41 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     /// Final configurations to the converter:
     std::cout << "Configuring converters:" << std::endl;
     BOOST_FOREACH(priority_type prio_i, conv_list.keys()) {
-        std::cout << "* [" << prio_i << "]: ";
+        std::cout << "* [" << prio_i << "] " << get_converter_name(converter_id, prio_i) << ": ";
         configure_conv(conv_list[prio_i], in_type, out_type);
+        conv_list[prio_i]->set_nontemporal(vm.count("nontemporal") > 0);
     }
 
     /// Run the benchmark for every converter ////////////////////////////////
     std::cout << "{{{" << std::endl;
     if (not debug_mode) {
-        std::cout << "prio,duration_ms,avg_duration_ms,n_samples,iterations" << std::endl;
+        // Bytes read and written per iteration, in the real item sizes of the formats
+        const double bytes_per_iteration = double(n_samples) * (
+            n_inputs * get_bytes_per_item(in_format) + n_outputs * get_bytes_per_item(out_format));
+        std::cout << "prio,duration_ms,avg_duration_ms,n_samples,iterations,name,gbytes_per_sec,cycles_per_sample" << std::endl;
         BOOST_FOREACH(priority_type prio_i, conv_list.keys()) {
+            uint64_t cycles = 0;
+            // Warm up the caches and the branch predictors first
+            conv_list[prio_i]->conv(input_buf_refs, output_buf_refs, n_samples);
             double duration = run_benchmark(
                     conv_list[prio_i],
                     input_buf_refs,
                     output_buf_refs,
                     n_samples,
-                    iterations
+                    iterations,
+                    cycles
             );
-            std::cout << boost::format("%i,%d,%d,%d,%d")
+            const double cycles_per_sample = (cycles == 0)?
+                std::numeric_limits<double>::quiet_NaN() : double(cycles) / (double(n_samples) * iterations);
+            std::cout << boost::format("%i,%d,%d,%d,%d,%s,%d,%d")
                 % prio_i
                 % (duration * 1000)
                 % (duration * 1000.0 / iterations)
                 % n_samples
                 % iterations
+                % get_converter_name(converter_id, prio_i)
+                % (duration > 0 ? bytes_per_iteration * iterations / duration / 1e9 : 0.0)
+                % cycles_per_sample
                 << std::endl;
         }
     }
@@ -414,12 +502,14 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     /// Or run debug mode, which runs one conversion and prints the results ////
     if (debug_mode) {
         // Only run on the first converter:
+        uint64_t cycles = 0;
         run_benchmark(
             conv_list[conv_list.keys().at(0)],
             input_buf_refs,
             output_buf_refs,
             n_samples,
-            iterations
+            iterations,
+            cycles
         );
         for (size_t i = 0; i < n_samples; i++) {
             std::cout << item_to_string(input_buf_refs[0], i, in_type, vm.count("hex"))
@@ -430,5 +520,54 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     }
     std::cout << "}}}" << std::endl;
 
+    /// Compare the outputs with the generic converter /////////////////////////
+    if (vm.count("verify") and not debug_mode) {
+        std::cout << "Verifying against the generic converter:" << std::endl;
+        converter::sptr generic_conv;
+        try {
+            generic_conv = get_converter(converter_id, 0)(); // Can throw a uhd::key_error
+        } catch(const uhd::key_error &e) {
+            std::cout << "No generic converter found." << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "* [0] " << get_converter_name(converter_id, 0) << ": ";
+        configure_conv(generic_conv, in_type, out_type);
+        std::vector< std::vector<char> > expected_buffers(n_outputs, std::vector<char>(out_size * n_samples + pad_size, 0));
+        std::vector<void *> expected_buf_refs(n_outputs);
+        for (size_t i = 0; i < n_outputs; i++) {
+            expected_buf_refs[i] = reinterpret_cast<void *>(&expected_buffers[i][0]);
+        }
+        generic_conv->conv(input_buf_refs, expected_buf_refs, n_samples);
+
+        bool all_exact = true;
+        BOOST_FOREACH(priority_type prio_i, conv_list.keys()) {
+            for (size_t i = 0; i < n_outputs; i++) {
+                std::fill(output_buffers[i].begin(), output_buffers[i].end(), 0);
+            }
+            conv_list[prio_i]->conv(input_buf_refs, output_buf_refs, n_samples);
+            size_t n_mismatches = 0, first_mismatch = 0;
+            for (size_t i = 0; i < n_outputs; i++) {
+                for (size_t j = 0; j < output_buffers[i].size(); j++) {
+                    if (output_buffers[i][j] == expected_buffers[i][j]) {
+                        continue;
+                    }
+                    if (n_mismatches++ == 0) {
+                        first_mismatch = j;
+                    }
+                }
+            }
+            std::cout << "* [" << prio_i << "] " << get_converter_name(converter_id, prio_i) << ": ";
+            if (n_mismatches == 0) {
+                std::cout << "bit-exact" << std::endl;
+            } else {
+                std::cout << n_mismatches << " bytes differ, the first at byte " << first_mismatch << std::endl;
+                all_exact = false;
+            }
+        }
+        if (not all_exact) {
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
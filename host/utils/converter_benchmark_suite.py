@@ -0,0 +1,272 @@
+#!/usr/bin/env python
+#
+# Copyright 2017 Ettus Research LLC
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+"""
+Benchmark every registered converter over a range of buffer sizes.
+
+Runs the converter_benchmark tool for every conversion it lists, with
+all the implementations registered on this CPU, at buffer sizes from
+the L1 cache out to main memory. The results (throughput in GB/s and
+time stamp counter cycles per sample) are written as JSON, and can be
+compared against the JSON of an earlier run to find regressions.
+"""
+
+from __future__ import print_function
+import argparse
+import csv
+import datetime
+import json
+import math
+import platform
+import re
+import subprocess
+import sys
+
+# Bytes of input plus output per conversion: L1, L2, last level cache, DRAM
+DEFAULT_SIZES = '16K,256K,4M,64M'
+
+def parse_size(size):
+    """ Parse a byte count like 16K or 4M """
+    units = {'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}
+    size = size.strip().upper()
+    if size[-1] in units:
+        return int(float(size[:-1]) * units[size[-1]])
+    return int(size)
+
+def run_tool(tool, args):
+    """ Run the tool with the given arguments, return the CSV rows in the {{{ }}} brackets """
+    output = subprocess.check_output([tool,] + args, stderr=subprocess.STDOUT)
+    if not isinstance(output, str):
+        output = output.decode('utf-8', 'replace')
+    if '{{{' not in output or '}}}' not in output:
+        raise RuntimeError(output.strip().split('\n')[-1])
+    section = output.split('{{{', 1)[1].split('}}}', 1)[0]
+    return list(csv.DictReader(section.strip().split('\n')))
+
+def list_conversions(tool, pattern):
+    """ All registered conversions whose `in -> out' name matches the pattern """
+    conversions = []
+    for row in run_tool(tool, ['--list']):
+        conv = {
+            'in': row['in'],
+            'n_inputs': int(row['n_inputs']),
+            'out': row['out'],
+            'n_outputs': int(row['n_outputs']),
+            'bytes_per_sample': int(row['n_inputs']) * int(row['in_bytes'])
+                                + int(row['n_outputs']) * int(row['out_bytes']),
+        }
+        if pattern and not re.search(pattern, conversion_name(conv)):
+            continue
+        conversions.append(conv)
+    return sorted(conversions, key=conversion_name)
+
+def conversion_name(conv):
+    """ E.g. sc16_item32_le -> fc32 (2 outputs) """
+    name = '{0} -> {1}'.format(conv['in'], conv['out'])
+    if conv['n_inputs'] != 1:
+        name += ' ({0} inputs)'.format(conv['n_inputs'])
+    if conv['n_outputs'] != 1:
+        name += ' ({0} outputs)'.format(conv['n_outputs'])
+    return name
+
+def result_key(result):
+    """ Identify a result across runs: the priorities may change, the names do not """
+    return (result['in'], result['n_inputs'], result['out'], result['n_outputs'],
+            result['name'], result['buffer_bytes'])
+
+def to_number(value):
+    """ A float from the CSV, None for NaN (not valid JSON) """
+    value = float(value)
+    return None if math.isnan(value) else value
+
+def run_suite(args):
+    """ Benchmark all matching conversions at all sizes, return the results and the skipped ones """
+    results = []
+    skipped = []
+    sizes = [parse_size(size) for size in args.sizes.split(',')]
+    for conv in list_conversions(args.tool, args.filter):
+        for size in sizes:
+            n_samples = max(16, size // conv['bytes_per_sample'])
+            iterations = max(args.min_iterations, int(args.work_bytes // (n_samples * conv['bytes_per_sample'])))
+            tool_args = [
+                '--in', conv['in'], '--out', conv['out'],
+                '--n-inputs', str(conv['n_inputs']), '--n-outputs', str(conv['n_outputs']),
+                '--samples', str(n_samples), '--iterations', str(iterations),
+                '--priorities', 'all',
+            ]
+            try:
+                # Keep the fastest of the repeats, the others were disturbed
+                best = {}
+                for _ in range(args.repeat):
+                    for row in run_tool(args.tool, tool_args):
+                        old = best.get(row['prio'])
+                        if old is None or float(row['avg_duration_ms']) < float(old['avg_duration_ms']):
+                            best[row['prio']] = row
+                rows = sorted(best.values(), key=lambda row: int(row['prio']))
+            except (RuntimeError, subprocess.CalledProcessError) as ex:
+                message = getattr(ex, 'output', None) or str(ex)
+                if not isinstance(message, str):
+                    message = message.decode('utf-8', 'replace')
+                skipped.append({'conversion': conversion_name(conv), 'reason': message.strip().split('\n')[-1]})
+                print('{0}: skipped ({1})'.format(conversion_name(conv), skipped[-1]['reason']), file=sys.stderr)
+                break # The other sizes would fail the same way
+            for row in rows:
+                results.append({
+                    'in': conv['in'],
+                    'n_inputs': conv['n_inputs'],
+                    'out': conv['out'],
+                    'n_outputs': conv['n_outputs'],
+                    'prio': int(row['prio']),
+                    'name': row['name'],
+                    'buffer_bytes': n_samples * conv['bytes_per_sample'],
+                    'n_samples': n_samples,
+                    'iterations': iterations,
+                    'ns_per_sample': float(row['avg_duration_ms']) * 1e6 / n_samples,
+                    'gbytes_per_sec': to_number(row['gbytes_per_sec']),
+                    'cycles_per_sample': to_number(row['cycles_per_sample']),
+                })
+                if args.verbose:
+                    print_result(results[-1])
+    return results, skipped
+
+def print_result(result):
+    """ One line per result """
+    cycles = result['cycles_per_sample']
+    print('{conv:<48} {name:<16} {size:>9} B {gbps:>8.2f} GB/s {cycles:>8} cycles/sample'.format(
+        conv=conversion_name(result), name=result['name'], size=result['buffer_bytes'],
+        gbps=result['gbytes_per_sec'] or 0.0,
+        cycles='-' if cycles is None else '{0:.3f}'.format(cycles),
+    ))
+
+def cpu_model():
+    """ The CPU model, where the OS tells (ARM kernels may only name the board) """
+    try:
+        with open('/proc/cpuinfo') as cpuinfo:
+            fields = dict(
+                [part.strip() for part in line.split(':', 1)]
+                for line in cpuinfo if ':' in line
+            )
+        for field in ('model name', 'Hardware'):
+            if fields.get(field):
+                return fields[field]
+    except IOError:
+        pass
+    return platform.processor() or platform.machine()
+
+def compare(results, baseline_file, tolerance, pattern):
+    """ Print the results slower than in the baseline by more than the tolerance, return their number """
+    with open(baseline_file) as baseline_json:
+        baseline = dict(
+            (result_key(result), result) for result in json.load(baseline_json)['results']
+            if not pattern or re.search(pattern, conversion_name(result))
+        )
+    regressions = 0
+    for result in results:
+        old = baseline.get(result_key(result))
+        if old is None or not old['gbytes_per_sec'] or not result['gbytes_per_sec']:
+            continue
+        ratio = result['gbytes_per_sec'] / old['gbytes_per_sec']
+        if ratio < 1.0 - tolerance:
+            regressions += 1
+            print('Regression: {conv}, {name}, {size} B: {old:.2f} -> {new:.2f} GB/s ({pct:+.1f}%)'.format(
+                conv=conversion_name(result), name=result['name'], size=result['buffer_bytes'],
+                old=old['gbytes_per_sec'], new=result['gbytes_per_sec'], pct=(ratio - 1.0) * 100))
+    missing = set(baseline.keys()) - set(result_key(result) for result in results)
+    for key in sorted(missing):
+        print('Missing from this run: {0} -> {2}, {4}, {5} B'.format(*key))
+    return regressions
+
+def setup_argparse():
+    """ Configure arg parser. """
+    parser = argparse.ArgumentParser(
+        description="UHD Converter Benchmark Suite: benchmark all converters and track regressions.",
+    )
+    parser.add_argument(
+        "--tool", default="./converter_benchmark",
+        help="Path to the converter_benchmark tool",
+    )
+    parser.add_argument(
+        "--sizes", default=DEFAULT_SIZES,
+        help="Comma-separated input plus output bytes per conversion, e.g. 16K,256K,4M,64M",
+    )
+    parser.add_argument(
+        "--work-bytes", type=parse_size, default='1G',
+        help="Bytes to convert per measurement, sets the number of iterations",
+    )
+    parser.add_argument(
+        "--min-iterations", type=int, default=3,
+        help="Least number of iterations per measurement",
+    )
+    parser.add_argument(
+        "--repeat", type=int, default=3,
+        help="Measurements per converter and size, the fastest one counts",
+    )
+    parser.add_argument(
+        "-f", "--filter",
+        help="Only benchmark conversions whose name (e.g. 'sc16_item32_le -> fc32') matches this regular expression",
+    )
+    parser.add_argument(
+        "-o", "--output",
+        help="Write the results to this JSON file",
+    )
+    parser.add_argument(
+        "--label",
+        help="Label of this run in the JSON, e.g. the commit",
+    )
+    parser.add_argument(
+        "--baseline",
+        help="JSON file of an earlier run: report converters that got slower, and fail if there are any",
+    )
+    parser.add_argument(
+        "--tolerance", type=float, default=0.1,
+        help="Slowdown against the baseline that is not a regression, as a fraction",
+    )
+    parser.add_argument(
+        "-v", "--verbose", action='store_true',
+        help="Print every result as it comes in",
+    )
+    return parser
+
+def main():
+    """ Go, go, go! """
+    args = setup_argparse().parse_args()
+    results, skipped = run_suite(args)
+    report = {
+        'version': 1,
+        'label': args.label,
+        'date': datetime.datetime.utcnow().isoformat() + 'Z',
+        'host': platform.node(),
+        'machine': platform.machine(),
+        'cpu': cpu_model(),
+        'sizes': args.sizes,
+        'results': results,
+        'skipped': skipped,
+    }
+    if args.output:
+        with open(args.output, 'w') as output:
+            json.dump(report, output, indent=1, sort_keys=True)
+    elif not args.verbose:
+        for result in results:
+            print_result(result)
+    if args.baseline:
+        regressions = compare(results, args.baseline, args.tolerance, args.filter)
+        print('{0} regression(s) of more than {1:.0f}%'.format(regressions, args.tolerance * 100))
+        return 1 if regressions else 0
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -108,7 +108,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     double tx_wave_ampl, tx_offset;
     double freq_start, freq_stop, freq_step;
     size_t nsamps;
-    double precision;
+    double precision, refine_threshold;
 
     po::options_description desc("Allowed options");
     desc.add_options()
@@ -123,6 +123,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
         ("freq_step", po::value<double>(&freq_step)->default_value(default_freq_step), "Step size for LO sweep in Hz")
         ("nsamps", po::value<size_t>(&nsamps), "Samples per data capture")
         ("precision", po::value<double>(&precision)->default_value(default_precision), "Correction precision (default=0.0001)")
+        ("refine_threshold", po::value<double>(&refine_threshold)->default_value(default_refine_threshold), "Bisect the LO step where the correction changes by more than this (0 = fixed steps)")
     ;
 
     po::variables_map vm;
@@ -186,7 +187,8 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
 
     UHD_MSG(status) << boost::format("Calibration frequency range: %d MHz -> %d MHz") % (freq_start/1e6) % (freq_stop/1e6) << std::endl;
 
-    for (double rx_lo_i = freq_start; rx_lo_i <= freq_stop; rx_lo_i += freq_step)
+    sweep_plan plan(freq_start, freq_stop, freq_step, refine_threshold);
+    for (double rx_lo_i = 0.0; plan.next(rx_lo_i);)
     {
         const double rx_lo = tune_rx_and_tx(usrp, rx_lo_i, tx_offset);
 
@@ -258,6 +260,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
             result.best = best_suppression;
             result.delta = best_suppression - initial_suppression;
             results.push_back(result);
+            plan.record(rx_lo_i, result);
             if (vm.count("verbose"))
                 std::cout << boost::format("RX IQ: %f MHz: best suppression %f dB, corrected %f dB") % (rx_lo/1e6) % result.best % result.delta << std::endl;
             else
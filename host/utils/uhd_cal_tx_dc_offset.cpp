@@ -115,7 +115,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     double tx_wave_freq, tx_wave_ampl, rx_offset;
     double freq_start, freq_stop, freq_step;
     size_t nsamps;
-    double precision;
+    double precision, refine_threshold;
 
     po::options_description desc("Allowed options");
     desc.add_options()
@@ -131,6 +131,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
         ("freq_step", po::value<double>(&freq_step)->default_value(default_freq_step), "Step size for LO sweep in Hz")
         ("nsamps", po::value<size_t>(&nsamps), "Samples per data capture")
         ("precision", po::value<double>(&precision)->default_value(default_precision), "Correction precision (default=0.0001)")
+        ("refine_threshold", po::value<double>(&refine_threshold)->default_value(default_refine_threshold), "Bisect the LO step where the correction changes by more than this (0 = fixed steps)")
     ;
 
     po::variables_map vm;
@@ -197,7 +198,8 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
     //set RX gain
     usrp->set_rx_gain(0);
 
-    for (double tx_lo_i = freq_start; tx_lo_i <= freq_stop; tx_lo_i += freq_step)
+    sweep_plan plan(freq_start, freq_stop, freq_step, refine_threshold);
+    for (double tx_lo_i = 0.0; plan.next(tx_lo_i);)
     {
         const double tx_lo = tune_rx_and_tx(usrp, tx_lo_i, rx_offset);
 
@@ -263,6 +265,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[])
             result.best = best_dc_dbrms;
             result.delta = initial_dc_dbrms - best_dc_dbrms;
             results.push_back(result);
+            plan.record(tx_lo_i, result);
             if (vm.count("verbose"))
                 std::cout << boost::format("TX DC: %f MHz: lowest offset %f dB, corrected %f dB") % (tx_lo/1e6) % result.best % result.delta << std::endl;
             else
@@ -16,15 +16,23 @@
 //
 
 #include <uhd/build_info.hpp>
+#include <uhd/convert.hpp>
 #include <uhd/version.hpp>
 #include <uhd/utils/paths.hpp>
 #include <uhd/utils/safe_main.hpp>
 
+#include <boost/algorithm/string/join.hpp>
+#include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
 
 namespace po = boost::program_options;
 
+static bool id_less(const uhd::convert::id_type &lhs, const uhd::convert::id_type &rhs) {
+    return lhs.to_string() < rhs.to_string();
+}
+
 int UHD_SAFE_MAIN(int argc, char* argv[]) {
     // Program Options
     po::options_description desc("Allowed Options");
@@ -41,6 +49,7 @@ int UHD_SAFE_MAIN(int argc, char* argv[]) {
         ("pkg-path",           "Print pkg path")
         ("images-dir",         "Print images dir")
         ("abi-version",        "Print ABI version string")
+        ("converters",         "Print the converters and the implementation used for each")
         ("print-all",          "Print everything")
         ("version",            "Print this UHD build's version")
         ("help",               "Print help message")
@@ -99,5 +108,23 @@ int UHD_SAFE_MAIN(int argc, char* argv[]) {
         std::cout << "ABI version string: " << uhd::get_abi_string() << std::endl;
     }
 
+    if(vm.count("converters") > 0 or print_all) {
+        std::cout << "Converters:" << std::endl;
+        std::vector<uhd::convert::id_type> ids = uhd::convert::get_converter_ids();
+        std::sort(ids.begin(), ids.end(), &id_less);
+        BOOST_FOREACH(const uhd::convert::id_type &id, ids) {
+            std::vector<std::string> names;
+            BOOST_FOREACH(const uhd::convert::priority_type prio, uhd::convert::get_converter_priorities(id)) {
+                names.push_back(uhd::convert::get_converter_name(id, prio));
+            }
+            std::cout << boost::format("  %s: %s") % id.to_string() % names.front();
+            if (names.size() > 1) {
+                names.erase(names.begin());
+                std::cout << " (also " << boost::algorithm::join(names, ", ") << ")";
+            }
+            std::cout << std::endl;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
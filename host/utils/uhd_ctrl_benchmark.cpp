@@ -0,0 +1,221 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <iostream>
+#include <complex>
+#include <vector>
+#include <cstdlib>
+
+namespace po = boost::program_options;
+
+/***********************************************************************
+ * Background streaming, to load the transport while timing
+ **********************************************************************/
+static bool stop_streaming = false;
+
+static void rx_load(uhd::rx_streamer::sptr rx_stream){
+    uhd::set_thread_priority_safe();
+    std::vector<std::complex<short> > buff(rx_stream->get_max_num_samps());
+    uhd::rx_metadata_t md;
+
+    uhd::stream_cmd_t cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    cmd.stream_now = true;
+    rx_stream->issue_stream_cmd(cmd);
+    while (not stop_streaming){
+        rx_stream->recv(&buff.front(), buff.size(), md, 0.1);
+    }
+    rx_stream->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+}
+
+static void tx_load(uhd::tx_streamer::sptr tx_stream){
+    uhd::set_thread_priority_safe();
+    std::vector<std::complex<short> > buff(tx_stream->get_max_num_samps());
+    uhd::tx_metadata_t md;
+    md.has_time_spec = false;
+
+    while (not stop_streaming){
+        tx_stream->send(&buff.front(), buff.size(), md, 0.1);
+    }
+    md.end_of_burst = true;
+    tx_stream->send("", 0, md);
+}
+
+/***********************************************************************
+ * Timing of one kind of control transaction
+ **********************************************************************/
+//! The nearest rank percentile of sorted latencies
+static double percentile(const std::vector<double> &sorted, const double q){
+    return sorted[std::min(sorted.size() - 1, size_t(q*sorted.size()))];
+}
+
+//! Call the transaction num_iters times and print the latency percentiles
+static void time_transaction(
+    const std::string &name,
+    const boost::function<void(size_t)> &transaction,
+    const size_t num_iters
+){
+    std::vector<double> latencies_us;
+    latencies_us.reserve(num_iters);
+    double sum_us = 0.0;
+    for (size_t i = 0; i < num_iters; i++){
+        const boost::chrono::high_resolution_clock::time_point start = boost::chrono::high_resolution_clock::now();
+        transaction(i);
+        const double us = boost::chrono::duration<double, boost::micro>(
+            boost::chrono::high_resolution_clock::now() - start).count();
+        latencies_us.push_back(us);
+        sum_us += us;
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+
+    std::cout << boost::format("%-14s %8u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f")
+        % name % num_iters % (sum_us/num_iters) % latencies_us.front()
+        % percentile(latencies_us, 0.5) % percentile(latencies_us, 0.99)
+        % percentile(latencies_us, 0.999) % latencies_us.back()
+        << std::endl;
+}
+
+//! Write one of two values, so a register cache cannot skip the write
+static void gpio_write(uhd::usrp::multi_usrp::sptr usrp,
+    const std::string &bank, const std::string &attr,
+    const uint32_t value, const size_t i
+){
+    usrp->set_gpio_attr(bank, attr, (i % 2)? ~value : value);
+}
+
+static void time_read(uhd::usrp::multi_usrp::sptr usrp, const size_t){
+    usrp->get_time_now();
+}
+
+static void rx_tune(uhd::usrp::multi_usrp::sptr usrp,
+    const double freq, const double step, const size_t i
+){
+    usrp->set_rx_freq(uhd::tune_request_t((i % 2)? freq + step : freq));
+}
+
+static void rx_gain(uhd::usrp::multi_usrp::sptr usrp,
+    const double gain, const double step, const size_t i
+){
+    usrp->set_rx_gain((i % 2)? gain + step : gain);
+}
+
+/***********************************************************************
+ * Main code + dispatcher
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, bank, attr;
+    size_t num_iters;
+    double rx_rate, tx_rate, freq, freq_step, gain_step;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("iters", po::value<size_t>(&num_iters)->default_value(1000), "transactions to time per test")
+        ("rx_rate", po::value<double>(&rx_rate)->default_value(0.0), "stream RX at this rate while timing, 0 for no streaming")
+        ("tx_rate", po::value<double>(&tx_rate)->default_value(0.0), "stream TX at this rate while timing, 0 for no streaming")
+        ("bank", po::value<std::string>(&bank)->default_value("FP0"), "GPIO bank for the register writes")
+        ("attr", po::value<std::string>(&attr)->default_value("ATR_XX"), "GPIO attribute for the register writes")
+        ("freq", po::value<double>(&freq), "RX center frequency to tune around (default: the current one)")
+        ("freq_step", po::value<double>(&freq_step)->default_value(1e6), "RX tunes alternate between freq and freq + freq_step")
+        ("gain_step", po::value<double>(&gain_step)->default_value(1.0), "RX gain changes alternate between the current gain and gain + gain_step")
+        ("no_tune", "skip the set_rx_freq and set_rx_gain timings")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help") or num_iters == 0){
+        std::cout << boost::format("UHD Control Benchmark %s") % desc << std::endl;
+        std::cout <<
+        "    Times control transactions of a device, optionally while data\n"
+        "    streams. Register writes are GPIO attribute writes, register\n"
+        "    reads are time readbacks, and the tune and gain timings are the\n"
+        "    full set_rx_freq() and set_rx_gain() calls. Run it once per\n"
+        "    transport to compare them. The written GPIO attribute is\n"
+        "    restored afterwards; by default it is the full duplex ATR\n"
+        "    value, which drives no pins unless they are in ATR mode.\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+
+    //start the background streams
+    boost::thread_group thread_group;
+    if (rx_rate > 0.0){
+        usrp->set_rx_rate(rx_rate);
+        std::cout << boost::format("Streaming RX at %f Msps") % (usrp->get_rx_rate()/1e6) << std::endl;
+        uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(uhd::stream_args_t("sc16"));
+        thread_group.create_thread(boost::bind(&rx_load, rx_stream));
+    }
+    if (tx_rate > 0.0){
+        usrp->set_tx_rate(tx_rate);
+        std::cout << boost::format("Streaming TX at %f Msps") % (usrp->get_tx_rate()/1e6) << std::endl;
+        uhd::tx_streamer::sptr tx_stream = usrp->get_tx_stream(uhd::stream_args_t("sc16"));
+        thread_group.create_thread(boost::bind(&tx_load, tx_stream));
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+
+    std::cout << std::endl << boost::format("%-14s %8s %10s %10s %10s %10s %10s %10s")
+        % "test" % "iters" % "mean(us)" % "min(us)" % "p50(us)" % "p99(us)" % "p99.9(us)" % "max(us)" << std::endl;
+
+    const std::vector<std::string> banks = usrp->get_gpio_banks(0);
+    if (std::find(banks.begin(), banks.end(), bank) != banks.end()){
+        const uint32_t value = usrp->get_gpio_attr(bank, attr);
+        time_transaction("reg write", boost::bind(&gpio_write, usrp, bank, attr, value, _1), num_iters);
+        usrp->set_gpio_attr(bank, attr, value);
+    } else {
+        std::cout << boost::format("%-14s skipped, no GPIO bank %s") % "reg write" % bank << std::endl;
+    }
+
+    time_transaction("reg read", boost::bind(&time_read, usrp, _1), num_iters);
+
+    if (not vm.count("no_tune")){
+        if (not vm.count("freq")) freq = usrp->get_rx_freq();
+        const double gain = usrp->get_rx_gain_range().clip(usrp->get_rx_gain(), true);
+        const double gain_up = usrp->get_rx_gain_range().clip(gain + gain_step, true) - gain;
+        time_transaction("set_rx_freq", boost::bind(&rx_tune, usrp, freq, freq_step, _1), num_iters);
+        time_transaction("set_rx_gain", boost::bind(&rx_gain, usrp, gain, gain_up, _1), num_iters);
+    }
+
+    //stop the background streams
+    stop_streaming = true;
+    thread_group.join_all();
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/rx_shm_publisher.hpp>
+#include <uhd/exception.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/asio.hpp>
+#include <iostream>
+#include <csignal>
+#include <map>
+
+namespace po = boost::program_options;
+namespace asio = boost::asio;
+
+static bool stop_signal_called = false;
+void sig_int_handler(int){stop_signal_called = true;}
+
+/***********************************************************************
+ * The calls clients can make, see uhd/usrp/daemon_client.hpp.
+ * A request is one line of tab separated fields, the call name and its
+ * arguments. The reply is one line too: "ok" and the results, or
+ * "error" and a message.
+ **********************************************************************/
+typedef std::vector<std::string> fields_t;
+
+template <typename T> static std::string to_field(const T &value){
+    return boost::lexical_cast<std::string>(value);
+}
+
+template <typename T> static T arg(const fields_t &request, const size_t i){
+    if (request.size() <= i) throw uhd::value_error(
+        str(boost::format("%s is missing argument %u") % request.front() % i));
+    return boost::lexical_cast<T>(request[i]);
+}
+
+class daemon_calls
+{
+public:
+    typedef boost::function<fields_t(const fields_t &)> call_t;
+
+    daemon_calls(uhd::usrp::multi_usrp::sptr usrp, const std::string &shm_name):
+        _usrp(usrp), _shm_name(shm_name)
+    {
+        _calls["get_pp_string"] = boost::bind(&daemon_calls::get_pp_string, this, _1);
+        _calls["get_rx_num_channels"] = boost::bind(&daemon_calls::get_rx_num_channels, this, _1);
+        _calls["get_shm_name"] = boost::bind(&daemon_calls::get_shm_name, this, _1);
+        _calls["get_rx_rate"] = boost::bind(&daemon_calls::get_rx_rate, this, _1);
+        _calls["set_rx_freq"] = boost::bind(&daemon_calls::set_rx_freq, this, _1);
+        _calls["get_rx_freq"] = boost::bind(&daemon_calls::get_rx_freq, this, _1);
+        _calls["set_rx_gain"] = boost::bind(&daemon_calls::set_rx_gain, this, _1);
+        _calls["get_rx_gain"] = boost::bind(&daemon_calls::get_rx_gain, this, _1);
+        _calls["get_rx_gain_range"] = boost::bind(&daemon_calls::get_rx_gain_range, this, _1);
+        _calls["set_rx_antenna"] = boost::bind(&daemon_calls::set_rx_antenna, this, _1);
+        _calls["get_rx_antenna"] = boost::bind(&daemon_calls::get_rx_antenna, this, _1);
+        _calls["set_rx_bandwidth"] = boost::bind(&daemon_calls::set_rx_bandwidth, this, _1);
+        _calls["get_rx_bandwidth"] = boost::bind(&daemon_calls::get_rx_bandwidth, this, _1);
+        _calls["get_time_now"] = boost::bind(&daemon_calls::get_time_now, this, _1);
+        _calls["get_mboard_sensor"] = boost::bind(&daemon_calls::get_mboard_sensor, this, _1);
+        _calls["get_rx_sensor"] = boost::bind(&daemon_calls::get_rx_sensor, this, _1);
+    }
+
+    //! Handle one request line, return the reply line
+    std::string handle(const std::string &line)
+    {
+        fields_t request;
+        boost::split(request, line, boost::is_any_of("\t"));
+        fields_t reply(1, "ok");
+        try {
+            if (_calls.count(request.front()) == 0) {
+                throw uhd::not_implemented_error("no call named " + request.front());
+            }
+            boost::mutex::scoped_lock lock(_mutex);
+            const fields_t results = _calls[request.front()](request);
+            reply.insert(reply.end(), results.begin(), results.end());
+        } catch (const std::exception &e) {
+            reply = fields_t(1, "error");
+            reply.push_back(e.what());
+        }
+        //tabs and newlines would split the reply
+        BOOST_FOREACH(std::string &field, reply) {
+            boost::replace_all(field, "\t", " ");
+            boost::replace_all(field, "\n", " ");
+        }
+        return boost::algorithm::join(reply, "\t") + "\n";
+    }
+
+private:
+    fields_t get_pp_string(const fields_t &)
+    {
+        fields_t lines;
+        boost::split(lines, _usrp->get_pp_string(), boost::is_any_of("\n"));
+        return lines;
+    }
+
+    fields_t get_rx_num_channels(const fields_t &)
+    {
+        return fields_t(1, to_field(_usrp->get_rx_num_channels()));
+    }
+
+    fields_t get_shm_name(const fields_t &)
+    {
+        return fields_t(1, _shm_name);
+    }
+
+    fields_t get_rx_rate(const fields_t &request)
+    {
+        return fields_t(1, to_field(_usrp->get_rx_rate(arg<size_t>(request, 1))));
+    }
+
+    fields_t set_rx_freq(const fields_t &request)
+    {
+        uhd::tune_request_t tune_request(arg<double>(request, 2));
+        tune_request.rf_freq_policy = uhd::tune_request_t::policy_t(arg<char>(request, 3));
+        tune_request.rf_freq = arg<double>(request, 4);
+        tune_request.dsp_freq_policy = uhd::tune_request_t::policy_t(arg<char>(request, 5));
+        tune_request.dsp_freq = arg<double>(request, 6);
+        tune_request.args = uhd::device_addr_t(request.size() > 7? request[7] : "");
+        const uhd::tune_result_t tune_result = _usrp->set_rx_freq(tune_request, arg<size_t>(request, 1));
+
+        fields_t results;
+        results.push_back(to_field(tune_result.clipped_rf_freq));
+        results.push_back(to_field(tune_result.target_rf_freq));
+        results.push_back(to_field(tune_result.actual_rf_freq));
+        results.push_back(to_field(tune_result.target_dsp_freq));
+        results.push_back(to_field(tune_result.actual_dsp_freq));
+        return results;
+    }
+
+    fields_t get_rx_freq(const fields_t &request)
+    {
+        return fields_t(1, to_field(_usrp->get_rx_freq(arg<size_t>(request, 1))));
+    }
+
+    fields_t set_rx_gain(const fields_t &request)
+    {
+        _usrp->set_rx_gain(arg<double>(request, 2), gain_name(request, 3), arg<size_t>(request, 1));
+        return fields_t();
+    }
+
+    fields_t get_rx_gain(const fields_t &request)
+    {
+        return fields_t(1, to_field(_usrp->get_rx_gain(gain_name(request, 2), arg<size_t>(request, 1))));
+    }
+
+    fields_t get_rx_gain_range(const fields_t &request)
+    {
+        const uhd::gain_range_t range = _usrp->get_rx_gain_range(gain_name(request, 2), arg<size_t>(request, 1));
+        fields_t results;
+        results.push_back(to_field(range.start()));
+        results.push_back(to_field(range.stop()));
+        results.push_back(to_field(range.step()));
+        return results;
+    }
+
+    fields_t set_rx_antenna(const fields_t &request)
+    {
+        _usrp->set_rx_antenna(arg<std::string>(request, 2), arg<size_t>(request, 1));
+        return fields_t();
+    }
+
+    fields_t get_rx_antenna(const fields_t &request)
+    {
+        return fields_t(1, _usrp->get_rx_antenna(arg<size_t>(request, 1)));
+    }
+
+    fields_t set_rx_bandwidth(const fields_t &request)
+    {
+        _usrp->set_rx_bandwidth(arg<double>(request, 2), arg<size_t>(request, 1));
+        return fields_t();
+    }
+
+    fields_t get_rx_bandwidth(const fields_t &request)
+    {
+        return fields_t(1, to_field(_usrp->get_rx_bandwidth(arg<size_t>(request, 1))));
+    }
+
+    fields_t get_time_now(const fields_t &request)
+    {
+        const uhd::time_spec_t now = _usrp->get_time_now(arg<size_t>(request, 1));
+        fields_t results;
+        results.push_back(to_field(now.get_full_secs()));
+        results.push_back(to_field(now.get_frac_secs()));
+        return results;
+    }
+
+    fields_t get_mboard_sensor(const fields_t &request)
+    {
+        return sensor_fields(_usrp->get_mboard_sensor(arg<std::string>(request, 2), arg<size_t>(request, 1)));
+    }
+
+    fields_t get_rx_sensor(const fields_t &request)
+    {
+        return sensor_fields(_usrp->get_rx_sensor(arg<std::string>(request, 2), arg<size_t>(request, 1)));
+    }
+
+    //! The gain name is optional, empty for all gains
+    static std::string gain_name(const fields_t &request, const size_t i)
+    {
+        return (request.size() > i)? request[i] : uhd::usrp::multi_usrp::ALL_GAINS;
+    }
+
+    static fields_t sensor_fields(const uhd::sensor_value_t &sensor)
+    {
+        fields_t results;
+        results.push_back(sensor.name);
+        results.push_back(sensor.value);
+        results.push_back(sensor.unit);
+        results.push_back(std::string(1, char(sensor.type)));
+        return results;
+    }
+
+    uhd::usrp::multi_usrp::sptr _usrp;
+    const std::string _shm_name;
+    std::map<std::string, call_t> _calls;
+    boost::mutex _mutex;
+};
+
+/***********************************************************************
+ * Client connections, polled so they end with the daemon
+ **********************************************************************/
+static const boost::posix_time::milliseconds POLL_TIME(10);
+
+static void serve_client(boost::shared_ptr<asio::ip::tcp::socket> socket, daemon_calls &calls)
+{
+    socket->set_option(asio::ip::tcp::no_delay(true));
+    socket->non_blocking(true);
+    std::string pending;
+    char chunk[4096];
+    while (not stop_signal_called) {
+        boost::system::error_code ec;
+        const size_t len = socket->read_some(asio::buffer(chunk), ec);
+        if (ec == asio::error::would_block) {
+            boost::this_thread::sleep(POLL_TIME);
+            continue;
+        }
+        if (ec) break; //the client is gone
+        pending.append(chunk, len);
+
+        size_t end;
+        while ((end = pending.find('\n')) != std::string::npos) {
+            const std::string reply = calls.handle(pending.substr(0, end));
+            pending.erase(0, end + 1);
+            socket->non_blocking(false);
+            asio::write(*socket, asio::buffer(reply), ec);
+            socket->non_blocking(true);
+            if (ec) return;
+        }
+    }
+}
+
+/***********************************************************************
+ * Main code + dispatcher
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    //variables to be set by po
+    std::string args, name, channel_list, cpu_format, otw_format, addr, port;
+    double rate;
+    size_t num_packets;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "uhd device address args")
+        ("name", po::value<std::string>(&name)->default_value("uhd_daemon"), "name of the shared memory ring of the receive stream")
+        ("channels", po::value<std::string>(&channel_list)->default_value("0"), "which RX channels to publish (specify \"0\", \"1\", \"0,1\", etc)")
+        ("rate", po::value<double>(&rate), "RX sample rate (default: the device's)")
+        ("cpu", po::value<std::string>(&cpu_format)->default_value("sc16"), "cpu format of the published samples")
+        ("otw", po::value<std::string>(&otw_format)->default_value("sc16"), "over the wire format")
+        ("packets", po::value<size_t>(&num_packets)->default_value(1024), "packets the ring holds")
+        ("addr", po::value<std::string>(&addr)->default_value("127.0.0.1"), "address to listen for clients on")
+        ("port", po::value<std::string>(&port)->default_value("50200"), "port to listen for clients on")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Daemon %s") % desc << std::endl;
+        std::cout <<
+        "    Keeps a device open for other applications. The receive stream\n"
+        "    of the channels is published in shared memory, and clients\n"
+        "    control the device with uhd::usrp::daemon_client. Applications\n"
+        "    connect to a running daemon without initializing the device.\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //create a usrp device
+    std::cout << std::endl;
+    std::cout << boost::format("Creating the usrp device with: %s...") % args << std::endl;
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+    std::cout << boost::format("Using Device: %s") % usrp->get_pp_string() << std::endl;
+
+    //detect which channels to use
+    std::vector<std::string> channel_strings;
+    std::vector<size_t> channel_nums;
+    boost::split(channel_strings, channel_list, boost::is_any_of("\"',"));
+    for (size_t ch = 0; ch < channel_strings.size(); ch++){
+        size_t chan = boost::lexical_cast<int>(channel_strings[ch]);
+        if (chan >= usrp->get_rx_num_channels()){
+            throw std::runtime_error("Invalid channel(s) specified.");
+        }
+        else channel_nums.push_back(chan);
+    }
+
+    if (vm.count("rate")) usrp->set_rx_rate(rate);
+    const double actual_rate = usrp->get_rx_rate(channel_nums.front());
+    std::cout << boost::format("RX rate: %f Msps") % (actual_rate/1e6) << std::endl;
+
+    //start streaming, aligned across channels, and publish the stream
+    uhd::stream_args_t stream_args(cpu_format, otw_format);
+    stream_args.channels = channel_nums;
+    uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(stream_args);
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = (channel_nums.size() == 1);
+    stream_cmd.time_spec = usrp->get_time_now() + uhd::time_spec_t(0.1);
+    rx_stream->issue_stream_cmd(stream_cmd);
+    uhd::rx_shm_publisher::sptr publisher = uhd::rx_shm_publisher::make(
+        rx_stream, name, cpu_format, actual_rate, num_packets);
+
+    //listen for clients
+    asio::io_service io_service;
+    asio::ip::tcp::resolver resolver(io_service);
+    asio::ip::tcp::resolver::query query(asio::ip::tcp::v4(), addr, port);
+    asio::ip::tcp::acceptor acceptor(io_service, *resolver.resolve(query));
+    acceptor.non_blocking(true);
+
+    daemon_calls calls(usrp, name);
+    boost::thread_group clients;
+    std::signal(SIGINT, &sig_int_handler);
+    std::cout << boost::format("Publishing channels %s as %s, listening on %s:%s, press Ctrl + C to stop...")
+        % channel_list % name % addr % port << std::endl;
+
+    while (not stop_signal_called){
+        boost::shared_ptr<asio::ip::tcp::socket> socket(new asio::ip::tcp::socket(io_service));
+        boost::system::error_code ec;
+        acceptor.accept(*socket, ec);
+        if (ec == asio::error::would_block or ec == asio::error::try_again){
+            boost::this_thread::sleep(POLL_TIME);
+            continue;
+        }
+        if (ec) throw boost::system::system_error(ec);
+        clients.create_thread(boost::bind(&serve_client, socket, boost::ref(calls)));
+    }
+
+    //stop the clients before the stream
+    clients.join_all();
+    publisher.reset();
+    rx_stream->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/host_check.hpp>
+#include <uhd/device.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace po = boost::program_options;
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    //variables to be set by po
+    std::string args, addr;
+    double rate;
+    size_t bytes_per_samp, frame_size, recv_buff_size, send_buff_size;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "device address args, to find network devices")
+        ("addr", po::value<std::string>(&addr), "check the interface to this IPv4 address, without finding devices")
+        ("rate", po::value<double>(&rate)->default_value(0.0), "sample rate of all streams to the host, 0 to skip the rate check")
+        ("bytes_per_samp", po::value<size_t>(&bytes_per_samp)->default_value(4), "bytes per sample over the wire, 4 for sc16, 2 for sc8")
+        ("frame_size", po::value<size_t>(&frame_size)->default_value(8000), "UDP payload of the data packets")
+        ("recv_buff_size", po::value<size_t>(&recv_buff_size)->default_value(0x2000000), "socket receive buffer of a stream")
+        ("send_buff_size", po::value<size_t>(&send_buff_size)->default_value(0x2000000), "socket send buffer of a stream")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Host Check %s") % desc << std::endl;
+        std::cout <<
+        "    Checks the host settings that streaming over the network needs:\n"
+        "    MTU, link speed, NIC RX ring, IRQ affinity, socket buffer limits\n"
+        "    and CPU frequency governor, for the interface of each network\n"
+        "    device found with the args, and prints the commands that fix\n"
+        "    what falls short. Returns 1 if anything does. Linux only.\n"
+        << std::endl;
+        return ~0;
+    }
+
+    std::vector<std::string> addrs;
+    if (vm.count("addr")){
+        addrs.push_back(addr);
+    }
+    else BOOST_FOREACH(const uhd::device_addr_t &dev_addr, uhd::device::find(args)){
+        if (dev_addr.has_key("addr")) addrs.push_back(dev_addr["addr"]);
+        if (dev_addr.has_key("second_addr")) addrs.push_back(dev_addr["second_addr"]);
+    }
+    if (addrs.empty()){
+        std::cerr << "No network devices found" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t num_deficits = 0;
+    BOOST_FOREACH(const std::string &dev_ip, addrs){
+        const uhd::host_check::report_t report = uhd::host_check::check(
+            dev_ip, frame_size, recv_buff_size, send_buff_size, rate*bytes_per_samp
+        );
+        std::cout << "Device address " << dev_ip << std::endl << report.to_pp_string() << std::endl;
+        num_deficits += report.num_deficits();
+    }
+    std::cout << num_deficits << " setting(s) to fix" << std::endl;
+    return (num_deficits == 0)? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -20,10 +20,13 @@
 #include <iostream>
 
 #include <boost/assign.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <uhd/config.hpp>
+#include <uhd/device.hpp>
 #include <uhd/image_loader.hpp>
 #include <uhd/types/device_addr.hpp>
 #include <uhd/utils/safe_main.hpp>
@@ -54,6 +57,56 @@ void sigint_handler(int){
     }
 }
 
+/*
+ * With several devices loading at once, each prints its progress on a line
+ * of its own every 10%, instead of rewriting one line.
+ */
+static boost::mutex print_mutex;
+
+static void print_progress(const std::string &name, int &last_percent, double fraction){
+    const int percent = int(fraction * 100.0);
+    if(percent < 100 and percent < last_percent + 10) return;
+    last_percent = percent;
+    boost::mutex::scoped_lock lock(print_mutex);
+    std::cout << boost::format("-- %s: %d%%") % name % percent << std::endl;
+}
+
+static int load_all(const uhd::image_loader::image_loader_args_t &image_loader_args){
+    const uhd::device_addrs_t found = uhd::device::find(image_loader_args.args);
+    if(found.empty()){
+        std::cerr << "No applicable UHD devices found" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Each device gets the user's args, narrowed down to that device
+    std::vector<std::string> names(found.size());
+    std::vector<int> last_percent(found.size(), -10);
+    std::vector<uhd::image_loader::image_loader_args_t> all_args(found.size(), image_loader_args);
+    for(size_t i = 0; i < found.size(); i++){
+        static const char *id_keys[] = {"addr", "resource", "serial"};
+        for(size_t k = 0; k < sizeof(id_keys)/sizeof(id_keys[0]); k++){
+            if(found[i].has_key(id_keys[k])) all_args[i].args[id_keys[k]] = found[i][id_keys[k]];
+        }
+        names[i] = found[i].get("addr", found[i].get("resource", found[i].get("serial", "")));
+        all_args[i].progress = boost::bind(&print_progress, names[i], boost::ref(last_percent[i]), _1);
+    }
+
+    std::cout << boost::format("Loading %d devices in parallel...") % found.size() << std::endl;
+    const std::vector<uhd::image_loader::load_result_t> results = uhd::image_loader::load_parallel(all_args);
+
+    int ret = EXIT_SUCCESS;
+    std::cout << std::endl << "Summary:" << std::endl;
+    for(size_t i = 0; i < results.size(); i++){
+        std::cout << boost::format("  %s: ") % names[i];
+        if(not results[i].error.empty())  std::cout << "failed (" << results[i].error << ")";
+        else if(not results[i].loaded)    std::cout << "not loaded, no applicable device";
+        else                              std::cout << "loaded";
+        std::cout << std::endl;
+        if(not results[i].loaded) ret = EXIT_FAILURE;
+    }
+    return ret;
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
 
     std::string fw_path = "";
@@ -67,6 +120,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("fpga-path", po::value<std::string>(&fpga_path)->default_value(""), "FPGA path (uses default if none specified)")
         ("no-fw", "Don't burn firmware")
         ("no-fpga", "Don't burn FPGA")
+        ("all", "Load every device matching the args, in parallel")
     ;
 
     po::variables_map vm;
@@ -118,6 +172,9 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     device_type = image_loader_args.args.get("type","");
 
     std::signal(SIGINT, &sigint_handler);
+    if(vm.count("all")){
+        return load_all(image_loader_args);
+    }
     if(not uhd::image_loader::load(image_loader_args)){
         std::cerr << "No applicable UHD devices found" << std::endl;
         return EXIT_FAILURE;
@@ -0,0 +1,185 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/utils/startup_profile.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/property_tree.hpp>
+#include <boost/program_options.hpp>
+#include <boost/format.hpp>
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <complex>
+#include <cstdlib>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace po = boost::program_options;
+
+//! Seconds from the start of this process to now, or a negative value where unknown
+static double get_secs_since_process_start(void)
+{
+#ifdef __linux__
+    //the start time (field 22) of /proc/self/stat is in clock ticks since boot
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    std::getline(stat, line);
+    const size_t comm_end = line.rfind(')');
+    if (comm_end == std::string::npos) return -1.0;
+    std::istringstream fields(line.substr(comm_end + 2));
+    std::string field;
+    for (size_t i = 3; i <= 22 and fields >> field; i++){}
+    double uptime = 0.0;
+    std::ifstream("/proc/uptime") >> uptime;
+    return uptime - std::strtod(field.c_str(), NULL)/sysconf(_SC_CLK_TCK);
+#else
+    return -1.0;
+#endif
+}
+
+static bool took_longer(const uhd::startup_profile::phase_t &lhs, const uhd::startup_profile::phase_t &rhs)
+{
+    return lhs.duration_secs > rhs.duration_secs;
+}
+
+//! Print the total time of the static blocks, and the slowest of them
+static void print_static_blocks(const size_t num_slowest)
+{
+    uhd::startup_profile::phases_t blocks = uhd::startup_profile::get_static_blocks();
+    double total_secs = 0.0;
+    BOOST_FOREACH(const uhd::startup_profile::phase_t &block, blocks){
+        total_secs += block.duration_secs;
+    }
+    std::cout << boost::format("Static blocks: %u, %.3f ms in all (deferred ones included)")
+        % blocks.size() % (total_secs*1e3) << std::endl;
+    std::sort(blocks.begin(), blocks.end(), &took_longer);
+    for (size_t i = 0; i < blocks.size() and i < num_slowest; i++){
+        std::cout << boost::format("  %10.3f  %s") % (blocks[i].duration_secs*1e3) % blocks[i].name << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+static void print_phase(const std::string &name, const double start_secs, const double duration_secs)
+{
+    std::cout << boost::format("  %10.3f %10.3f  %s") % (start_secs*1e3) % (duration_secs*1e3) % name << std::endl;
+}
+
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    const double main_secs = get_secs_since_process_start();
+    const uhd::time_spec_t main_time = uhd::time_spec_t::get_system_time();
+
+    //variables to be set by po
+    std::string args, cpu, otw;
+    double rate;
+
+    //setup the program options
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("args", po::value<std::string>(&args)->default_value(""), "single uhd device address args")
+        ("rate", po::value<double>(&rate)->default_value(1e6), "RX rate of the first sample stream")
+        ("cpu", po::value<std::string>(&cpu)->default_value("fc32"), "host sample format")
+        ("otw", po::value<std::string>(&otw)->default_value("sc16"), "over-the-wire sample format")
+        ("no-stream", "stop after making the device")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Startup Profile %s") % desc << std::endl;
+        std::cout <<
+        "    Prints how long each phase of starting up a device takes, from\n"
+        "    process start to the first received sample. The phases of the\n"
+        "    device make are recorded by UHD into the property tree. The\n"
+        "    static blocks (registrations that run before main() or on first\n"
+        "    use) are listed with the slowest first.\n"
+        << std::endl;
+        return ~0;
+    }
+
+    //make the device, and time the streaming setup
+    const uhd::time_spec_t make_time = uhd::time_spec_t::get_system_time();
+    uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(args);
+    const uhd::time_spec_t made_time = uhd::time_spec_t::get_system_time();
+
+    uhd::time_spec_t rate_time = made_time, streamer_time = made_time, first_sample_time = made_time;
+    if (not vm.count("no-stream")){
+        usrp->set_rx_rate(rate);
+        rate_time = uhd::time_spec_t::get_system_time();
+        uhd::rx_streamer::sptr rx_stream = usrp->get_rx_stream(uhd::stream_args_t(cpu, otw));
+        streamer_time = uhd::time_spec_t::get_system_time();
+
+        std::vector<std::complex<float> > buff(rx_stream->get_max_num_samps()*2);
+        uhd::rx_metadata_t md;
+        uhd::stream_cmd_t cmd(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+        cmd.num_samps = rx_stream->get_max_num_samps();
+        cmd.stream_now = true;
+        rx_stream->issue_stream_cmd(cmd);
+        while (rx_stream->recv(&buff.front(), rx_stream->get_max_num_samps(), md, 1.0) == 0){
+            if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT){
+                throw uhd::runtime_error("Timeout waiting for the first sample");
+            }
+        }
+        first_sample_time = uhd::time_spec_t::get_system_time();
+    }
+
+    //all times relative to main()
+    std::cout << std::endl << boost::format("  %10s %10s  %s") % "start(ms)" % "time(ms)" % "phase" << std::endl;
+    if (main_secs >= 0.0) {
+        print_phase("process start to main()", -main_secs, main_secs);
+    }
+    print_phase("multi_usrp::make", (make_time - main_time).get_real_secs(), (made_time - make_time).get_real_secs());
+
+    //the phases of the device make start with device::make itself
+    uhd::property_tree::sptr tree = usrp->get_device()->get_tree();
+    if (tree->exists("/startup_profile")){
+        const uhd::startup_profile::phases_t phases =
+            tree->access<uhd::startup_profile::phases_t>("/startup_profile").get();
+        const double offset = (make_time - main_time).get_real_secs();
+        //number the threads in order of appearance, for parallel phases
+        boost::unordered_map<size_t, size_t> thread_nums;
+        BOOST_FOREACH(const uhd::startup_profile::phase_t &phase, phases){
+            if (not thread_nums.count(phase.thread)) {
+                const size_t num = thread_nums.size();
+                thread_nums[phase.thread] = num;
+            }
+            const std::string thread_tag = (thread_nums[phase.thread] == 0)? "" :
+                str(boost::format(" [thread %u]") % thread_nums[phase.thread]);
+            print_phase("  " + phase.name + thread_tag, offset + phase.start_secs, phase.duration_secs);
+        }
+    }
+
+    if (not vm.count("no-stream")){
+        print_phase("set_rx_rate", (made_time - main_time).get_real_secs(), (rate_time - made_time).get_real_secs());
+        print_phase("get_rx_stream", (rate_time - main_time).get_real_secs(), (streamer_time - rate_time).get_real_secs());
+        print_phase("first sample", (streamer_time - main_time).get_real_secs(), (first_sample_time - streamer_time).get_real_secs());
+    }
+    std::cout << std::endl;
+    print_static_blocks(10);
+
+    const double total = (first_sample_time - main_time).get_real_secs() + std::max(main_secs, 0.0);
+    std::cout << std::endl << boost::format("Time to %s: %.3f s")
+        % (vm.count("no-stream")? "device" : "first sample") % total << std::endl << std::endl;
+    return EXIT_SUCCESS;
+}
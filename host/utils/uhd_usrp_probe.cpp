@@ -26,9 +26,12 @@
 #include <uhd/usrp/mboard_eeprom.hpp>
 #include <uhd/usrp/dboard_eeprom.hpp>
 #include <uhd/types/sensors.hpp>
+#include <uhd/transport/zero_copy.hpp>
 #include <boost/program_options.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -146,6 +149,19 @@ static std::string get_rfnoc_pp_string(property_tree::sptr tree, const fs_path &
     return ss.str();
 }
 
+static std::string get_xport_pp_string(property_tree::sptr tree, const fs_path &path){
+    std::stringstream ss;
+    const transport::zero_copy_stats_t stats = tree->access<transport::zero_copy_stats_t>(path / "stats").get();
+    ss << "Transport: " << path.leaf() << std::endl << std::endl;
+    ss << boost::format("RX packets: %u (%u bytes)") % stats.num_recv_packets % stats.num_recv_bytes << std::endl;
+    ss << boost::format("RX timeouts: %u, pool empty: %u, wait: %u ns") % stats.num_recv_timeouts % stats.num_recv_pool_empty % stats.recv_wait_ns << std::endl;
+    ss << boost::format("TX packets: %u") % stats.num_send_packets << std::endl;
+    ss << boost::format("TX timeouts: %u, pool empty: %u, wait: %u ns") % stats.num_send_timeouts % stats.num_send_pool_empty % stats.send_wait_ns << std::endl;
+    ss << boost::format("Dropped: %u, RX queue depth: %u") % stats.num_dropped % stats.recv_queue_depth << std::endl;
+    ss << boost::format("Kernel drops: %u, max RX latency: %u ns") % stats.num_kernel_drops % stats.max_recv_latency_ns << std::endl;
+    return ss.str();
+}
+
 static std::string get_mboard_pp_string(property_tree::sptr tree, const fs_path &path){
     std::stringstream ss;
     ss << boost::format("Mboard: %s") % (tree->access<std::string>(path / "name").get()) << std::endl;
@@ -189,6 +205,12 @@ static std::string get_mboard_pp_string(property_tree::sptr tree, const fs_path
         }
         BOOST_FOREACH(const std::string &name, tree->list(path / "dboards")){
             ss << make_border(get_dboard_pp_string("TX", tree, path / "dboards" / name));
+        }
+        if (tree->exists(path / "xports")){
+            BOOST_FOREACH(const std::string &name, tree->list(path / "xports")){
+                if (not tree->exists(path / "xports" / name / "stats")) continue;
+                ss << make_border(get_xport_pp_string(tree, path / "xports" / name));
+            }
         }
             ss << make_border(get_rfnoc_pp_string(tree, path / "xbar"));
     }
@@ -209,6 +231,66 @@ static std::string get_device_pp_string(property_tree::sptr tree){
     return ss.str();
 }
 
+static std::string get_inventory_pp_string(property_tree::sptr tree){
+    std::stringstream ss;
+    BOOST_FOREACH(const std::string &name, tree->list("/mboards")){
+        const fs_path path = "/mboards/" + name;
+        ss << boost::format("Mboard %s: %s") % name % tree->access<std::string>(path / "name").get() << std::endl;
+        const usrp::mboard_eeprom_t mb_eeprom = tree->access<usrp::mboard_eeprom_t>(path / "eeprom").get();
+        BOOST_FOREACH(const std::string &key, mb_eeprom.keys()){
+            if (not mb_eeprom[key].empty()) ss << boost::format("  %s: %s") % key % mb_eeprom[key] << std::endl;
+        }
+        if (tree->exists(path / "fw_version")){
+            ss << "  FW Version: " << tree->access<std::string>(path / "fw_version").get() << std::endl;
+        }
+        if (tree->exists(path / "fpga_version")){
+            ss << "  FPGA Version: " << tree->access<std::string>(path / "fpga_version").get() << std::endl;
+        }
+        if (not tree->exists(path / "dboards")) continue;
+        BOOST_FOREACH(const std::string &db_name, tree->list(path / "dboards")){
+            static const char *eeprom_names[] = {"rx_eeprom", "tx_eeprom", "gdb_eeprom"};
+            BOOST_FOREACH(const char *eeprom_name, eeprom_names){
+                const fs_path eeprom_path = path / "dboards" / db_name / eeprom_name;
+                if (not tree->exists(eeprom_path)) continue;
+                const usrp::dboard_eeprom_t db_eeprom = tree->access<usrp::dboard_eeprom_t>(eeprom_path).get();
+                if (db_eeprom.id == usrp::dboard_id_t::none()) continue;
+                ss << boost::format("  Dboard %s %s: %s") % db_name % eeprom_name % db_eeprom.id.to_pp_string();
+                if (not db_eeprom.serial.empty()) ss << ", serial " << db_eeprom.serial;
+                ss << std::endl;
+            }
+        }
+    }
+    return ss.str();
+}
+
+//! Make one device in probe mode and describe it, or the error
+static void probe_inventory(const device_addr_t &dev_addr, std::string &result){
+    try {
+        device_addr_t probe_addr = dev_addr;
+        probe_addr["probe_only"] = "1";
+        device::sptr dev = device::make(probe_addr);
+        result = get_inventory_pp_string(dev->get_tree());
+    }
+    catch (const std::exception &e) {
+        result = std::string("  Error: ") + e.what() + "\n";
+    }
+}
+
+//! Probe all devices that match the args at the same time
+static void print_inventory(const device_addr_t &args){
+    const device_addrs_t dev_addrs = device::find(args);
+    std::vector<std::string> results(dev_addrs.size());
+    boost::thread_group probe_threads;
+    for (size_t i = 0; i < dev_addrs.size(); i++){
+        probe_threads.create_thread(boost::bind(&probe_inventory, dev_addrs[i], boost::ref(results[i])));
+    }
+    probe_threads.join_all();
+    for (size_t i = 0; i < dev_addrs.size(); i++){
+        std::cout << "Device " << dev_addrs[i].to_string() << std::endl << results[i] << std::endl;
+    }
+    if (dev_addrs.empty()) std::cout << "No devices found" << std::endl;
+}
+
 void print_tree(const uhd::fs_path &path, uhd::property_tree::sptr tree){
     std::cout << path << std::endl;
     BOOST_FOREACH(const std::string &name, tree->list(path)){
@@ -230,6 +312,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         ("range", po::value<std::string>(), "query a range (gain, bandwidth, frequency, ...)  from the property tree")
         ("vector", "when querying a string, interpret that as std::vector")
         ("init-only", "skip all queries, only initialize device")
+        ("inventory", "list the mboards, dboards, serials and versions of all matching devices, without a full initialization")
     ;
 
     po::variables_map vm;
@@ -247,6 +330,11 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         return EXIT_SUCCESS;
     }
 
+    if (vm.count("inventory")){
+        print_inventory(device_addr_t(vm["args"].as<std::string>()));
+        return EXIT_SUCCESS;
+    }
+
     device::sptr dev = device::make(vm["args"].as<std::string>());
     property_tree::sptr tree = dev->get_tree();
 
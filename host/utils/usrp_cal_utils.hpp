@@ -24,8 +24,13 @@
 #include <uhd/utils/msg.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
+#include <boost/cstdint.hpp>
 #include <iostream>
+#include <algorithm>
 #include <vector>
+#include <deque>
+#include <map>
+#include <set>
 #include <complex>
 #include <cmath>
 #include <cstdlib>
@@ -46,6 +51,9 @@ static const size_t num_search_steps = 5;
 static const double default_precision = 0.0001;
 static const double default_freq_step = 7.3e6;
 static const size_t default_fft_bin_size = 1000;
+static const double default_refine_threshold = 0.0;
+static const size_t refine_step_divisions = 8;
+static const size_t tone_phasor_resync = 1024;
 
 /***********************************************************************
  * Set standard defaults for devices
@@ -158,14 +166,85 @@ static inline double compute_tone_dbrms(
     const double freq)  //freq is fractional
 {
     //shift the samples so the tone at freq is down at DC
-    //and average the samples to measure the DC component
-    samp_type average = 0;
-    for (size_t i = 0; i < samples.size(); i++)
-        average += samp_type(std::polar(1.0, -freq*tau*i)) * samples[i];
+    //and average the samples to measure the DC component.
+    //the shift is a rotating phasor, recomputed exactly every
+    //tone_phasor_resync samples to keep the rounding error bounded
+    const std::complex<double> rotation = std::polar(1.0, -freq*tau);
+    std::complex<double> average = 0;
+    for (size_t i0 = 0; i0 < samples.size(); i0 += tone_phasor_resync)
+    {
+        const size_t i1 = std::min(samples.size(), i0 + tone_phasor_resync);
+        std::complex<double> phasor = std::polar(1.0, -freq*tau*i0);
+        for (size_t i = i0; i < i1; i++)
+        {
+            average += phasor * std::complex<double>(samples[i]);
+            phasor *= rotation;
+        }
+    }
 
-    return 20*std::log10(std::abs(average/float(samples.size())));
+    return 20*std::log10(std::abs(average/double(samples.size())));
 }
 
+/***********************************************************************
+ * Sweep frequencies with adaptive refinement
+ **********************************************************************/
+class sweep_plan
+{
+public:
+    /*!
+     * Plan a sweep from start to stop in step increments.
+     * With a non-zero refine threshold, the interval between two kept
+     * results is bisected (down to step/refine_step_divisions) when their
+     * corrections differ by more than the threshold.
+     */
+    sweep_plan(const double start, const double stop, const double step, const double refine_threshold):
+        _min_step(step/refine_step_divisions),
+        _refine_threshold(refine_threshold)
+    {
+        for (double freq = start; freq <= stop; freq += step)
+            _pending.push_back(freq);
+    }
+
+    //! Get the next requested frequency to calibrate, false when done
+    bool next(double &freq)
+    {
+        if (_pending.empty() and _refine_threshold > 0.0) this->refine();
+        if (_pending.empty()) return false;
+        freq = _pending.front();
+        _pending.pop_front();
+        _visited.insert(freq);
+        return true;
+    }
+
+    //! Record a kept result for the requested frequency
+    void record(const double freq, const result_t &result)
+    {
+        _corrections[freq] = std::complex<double>(result.real_corr, result.imag_corr);
+    }
+
+private:
+    void refine(void)
+    {
+        if (_corrections.size() < 2) return;
+        typedef std::map<double, std::complex<double> >::const_iterator iter_t;
+        iter_t prev = _corrections.begin();
+        for (iter_t it = ++_corrections.begin(); it != _corrections.end(); prev = it++)
+        {
+            const double mid = (prev->first + it->first)/2;
+            if (it->first - prev->first < 2*_min_step) continue;
+            if (std::abs(it->second - prev->second) <= _refine_threshold) continue;
+            if (_visited.count(mid)) continue;
+            _pending.push_back(mid);
+        }
+    }
+
+    const double _min_step;
+    const double _refine_threshold;
+    std::deque<double> _pending;
+    std::set<double> _visited;
+    std::map<double, std::complex<double> > _corrections;
+};
+
 /***********************************************************************
  * Write a dat file
  **********************************************************************/
@@ -193,6 +272,10 @@ static std::string get_serial(
     return db_eeprom.serial;
 }
 
+static bool result_freq_comp(const result_t &a, const result_t &b){
+    return a.freq < b.freq;
+}
+
 /***********************************************************************
  * Store data to file
  **********************************************************************/
@@ -221,18 +304,39 @@ static void store_results(
     cal_data << boost::format("DATA STARTS HERE\n");
     cal_data << "lo_frequency, correction_real, correction_imag, measured, delta\n";
 
-    for (size_t i = 0; i < results.size(); i++)
+    //refined sweeps record results out of order
+    std::vector<result_t> sorted_results(results);
+    std::stable_sort(sorted_results.begin(), sorted_results.end(), result_freq_comp);
+    for (size_t i = 0; i < sorted_results.size(); i++)
     {
         cal_data
-            << results[i].freq << ", "
-            << results[i].real_corr << ", "
-            << results[i].imag_corr << ", "
-            << results[i].best << ", "
-            << results[i].delta << "\n"
+            << sorted_results[i].freq << ", "
+            << sorted_results[i].real_corr << ", "
+            << sorted_results[i].imag_corr << ", "
+            << sorted_results[i].best << ", "
+            << sorted_results[i].delta << "\n"
         ;
     }
 
     std::cout << "wrote cal data to " << cal_data_path << std::endl;
+
+    //fill the binary table next to it, this is what the driver loads on
+    //every tune when it is not older than the csv file (see apply_corrections.cpp):
+    //magic, uint64_t entry count, then {lo_freq, real, imag} sorted by lo_freq
+    fs::path cal_bin_path = cal_data_path;
+    cal_bin_path.replace_extension(".bin");
+    std::ofstream cal_bin(cal_bin_path.string().c_str(), std::ios::binary);
+    const char magic[8] = {'U', 'H', 'D', 'C', 'A', 'L', '0', '1'};
+    const boost::uint64_t num_entries = sorted_results.size();
+    cal_bin.write(magic, sizeof(magic));
+    cal_bin.write(reinterpret_cast<const char *>(&num_entries), sizeof(num_entries));
+    for (size_t i = 0; i < sorted_results.size(); i++)
+    {
+        const double entry[3] = {
+            sorted_results[i].freq, sorted_results[i].real_corr, sorted_results[i].imag_corr
+        };
+        cal_bin.write(reinterpret_cast<const char *>(entry), sizeof(entry));
+    }
 }
 
 /***********************************************************************
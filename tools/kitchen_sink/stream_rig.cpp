@@ -0,0 +1,469 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Streaming load generator for soak tests: runs the RX, TX and loopback
+// streams of one or more devices, as described by a JSON config file,
+// each on its own thread, and serves their counters in the Prometheus
+// text format over HTTP.
+
+#include <uhd/utils/thread_priority.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/asio.hpp>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <csignal>
+
+namespace po = boost::program_options;
+namespace pt = boost::property_tree;
+using boost::asio::ip::tcp;
+
+static volatile bool stop_signal_called = false;
+
+static void sig_int_handler(int)
+{
+    stop_signal_called = true;
+}
+
+/***********************************************************************
+ * Streams and their counters
+ **********************************************************************/
+//! Counters of one stream, written by its thread and read by the reporters
+struct stream_stats_t
+{
+    stream_stats_t(void):
+        num_samps(0), num_overflows(0), num_dropped(0), num_underflows(0),
+        num_seq_errors(0), num_late(0), num_timeouts(0), num_other_errors(0),
+        num_calls(0), call_secs(0.0), max_call_secs(0.0)
+    {}
+
+    unsigned long long num_samps;
+    unsigned long long num_overflows;
+    unsigned long long num_dropped;     //!< RX sequence errors
+    unsigned long long num_underflows;
+    unsigned long long num_seq_errors;  //!< TX sequence errors
+    unsigned long long num_late;
+    unsigned long long num_timeouts;
+    unsigned long long num_other_errors;
+    unsigned long long num_calls;
+    double call_secs;
+    double max_call_secs;
+};
+
+struct stream_t
+{
+    typedef boost::shared_ptr<stream_t> sptr;
+
+    std::string device;
+    std::string type;                   //!< rx, tx or loopback
+    size_t index;
+    std::vector<size_t> rx_channels, tx_channels;
+    std::string cpu, otw;
+    double rate;
+    size_t spp;
+
+    uhd::usrp::multi_usrp::sptr usrp;
+    uhd::rx_streamer::sptr rx_stream;
+    uhd::tx_streamer::sptr tx_stream;
+
+    boost::mutex mutex;
+    stream_stats_t stats;
+
+    stream_stats_t get_stats(void)
+    {
+        boost::mutex::scoped_lock l(mutex);
+        return stats;
+    }
+};
+
+static std::vector<size_t> get_channels(const std::string &channel_list)
+{
+    std::vector<std::string> channel_strings;
+    std::vector<size_t> channel_nums;
+    boost::split(channel_strings, channel_list, boost::is_any_of(","));
+    BOOST_FOREACH(const std::string &chan, channel_strings) {
+        channel_nums.push_back(boost::lexical_cast<size_t>(boost::algorithm::trim_copy(chan)));
+    }
+    return channel_nums;
+}
+
+//! Add the time of one streamer call, and the errors in its metadata
+static void add_rx_call(stream_t &stream, const size_t num_samps, const double secs, const uhd::rx_metadata_t &md)
+{
+    boost::mutex::scoped_lock l(stream.mutex);
+    stream_stats_t &stats = stream.stats;
+    stats.num_samps += num_samps;
+    stats.num_calls++;
+    stats.call_secs += secs;
+    stats.max_call_secs = std::max(stats.max_call_secs, secs);
+    switch (md.error_code) {
+    case uhd::rx_metadata_t::ERROR_CODE_NONE:
+        break;
+    case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+        if (md.out_of_sequence) stats.num_dropped++;
+        else stats.num_overflows++;
+        break;
+    case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+        stats.num_timeouts++;
+        break;
+    case uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND:
+        stats.num_late++;
+        break;
+    default:
+        stats.num_other_errors++;
+    }
+}
+
+static void add_tx_call(stream_t &stream, const size_t num_samps, const double secs)
+{
+    boost::mutex::scoped_lock l(stream.mutex);
+    stream.stats.num_samps += num_samps;
+    stream.stats.num_calls++;
+    stream.stats.call_secs += secs;
+    stream.stats.max_call_secs = std::max(stream.stats.max_call_secs, secs);
+}
+
+//! Count the async messages that have come in, without waiting
+static void poll_async_msgs(stream_t &stream)
+{
+    uhd::async_metadata_t async_md;
+    while (stream.tx_stream->recv_async_msg(async_md, 0.0)) {
+        boost::mutex::scoped_lock l(stream.mutex);
+        switch (async_md.event_code) {
+        case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
+            break;
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+        case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
+            stream.stats.num_underflows++;
+            break;
+        case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR:
+        case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST:
+            stream.stats.num_seq_errors++;
+            break;
+        case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR:
+            stream.stats.num_late++;
+            break;
+        default:
+            stream.stats.num_other_errors++;
+        }
+    }
+}
+
+static double secs_since(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds()/1e6;
+}
+
+/***********************************************************************
+ * Stream threads
+ **********************************************************************/
+//! RX, TX and loopback in one: loopback sends what it received
+static void run_stream(stream_t::sptr stream)
+{
+    uhd::set_thread_priority_safe();
+
+    const size_t bytes_per_samp = uhd::convert::get_bytes_per_item(stream->cpu);
+    const size_t num_chans = std::max(stream->rx_channels.size(), stream->tx_channels.size());
+    const size_t samps_per_buff = std::max(
+        stream->rx_stream? stream->rx_stream->get_max_num_samps() : 0,
+        stream->tx_stream? stream->tx_stream->get_max_num_samps() : 0);
+    std::vector<std::vector<char> > buffs(num_chans, std::vector<char>(samps_per_buff*bytes_per_samp));
+    std::vector<void *> buff_ptrs;
+    for (size_t ch = 0; ch < num_chans; ch++) buff_ptrs.push_back(&buffs[ch].front());
+
+    if (stream->rx_stream) {
+        uhd::stream_cmd_t cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+        cmd.stream_now = true;
+        stream->rx_stream->issue_stream_cmd(cmd);
+    }
+
+    uhd::rx_metadata_t rx_md;
+    uhd::tx_metadata_t tx_md;
+    tx_md.start_of_burst = true;
+    tx_md.has_time_spec = false;
+    while (not stop_signal_called) {
+        size_t num_samps = samps_per_buff;
+        if (stream->rx_stream) {
+            const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            num_samps = stream->rx_stream->recv(buff_ptrs, samps_per_buff, rx_md, 0.1);
+            add_rx_call(*stream, num_samps, secs_since(start), rx_md);
+            if (num_samps == 0) continue;
+        }
+        if (stream->tx_stream) {
+            const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            const size_t num_sent = stream->tx_stream->send(buff_ptrs, num_samps, tx_md, 0.1);
+            tx_md.start_of_burst = false;
+            if (not stream->rx_stream) add_tx_call(*stream, num_sent, secs_since(start));
+            poll_async_msgs(*stream);
+        }
+    }
+
+    if (stream->rx_stream) {
+        stream->rx_stream->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    }
+    if (stream->tx_stream) {
+        tx_md.end_of_burst = true;
+        stream->tx_stream->send("", 0, tx_md);
+    }
+}
+
+/***********************************************************************
+ * Reporting
+ **********************************************************************/
+//! All streams in the Prometheus text exposition format
+static std::string format_metrics(const std::vector<stream_t::sptr> &streams)
+{
+    std::vector<stream_stats_t> stats;
+    BOOST_FOREACH(const stream_t::sptr &stream, streams) {
+        stats.push_back(stream->get_stats());
+    }
+
+    std::ostringstream ss;
+    #define UHD_RIG_METRIC(name, kind, help, field) \
+        ss << "# HELP uhd_stream_" name " " help "\n# TYPE uhd_stream_" name " " kind "\n"; \
+        for (size_t i = 0; i < streams.size(); i++) { \
+            ss << boost::format("uhd_stream_%s{device=\"%s\",stream=\"%u\",type=\"%s\"} %s\n") \
+                % name % streams[i]->device % streams[i]->index % streams[i]->type % stats[i].field; \
+        }
+    UHD_RIG_METRIC("samples_total", "counter", "Samples per channel streamed", num_samps)
+    UHD_RIG_METRIC("overflows_total", "counter", "RX overflows", num_overflows)
+    UHD_RIG_METRIC("dropped_packets_total", "counter", "RX packets lost on the transport", num_dropped)
+    UHD_RIG_METRIC("underflows_total", "counter", "TX underflows", num_underflows)
+    UHD_RIG_METRIC("seq_errors_total", "counter", "TX sequence errors", num_seq_errors)
+    UHD_RIG_METRIC("late_total", "counter", "Late commands and TX time errors", num_late)
+    UHD_RIG_METRIC("timeouts_total", "counter", "RX timeouts", num_timeouts)
+    UHD_RIG_METRIC("other_errors_total", "counter", "Other streaming errors", num_other_errors)
+    UHD_RIG_METRIC("calls_total", "counter", "recv() or send() calls", num_calls)
+    UHD_RIG_METRIC("call_seconds_total", "counter", "Time spent in recv() or send()", call_secs)
+    UHD_RIG_METRIC("call_seconds_max", "gauge", "Longest recv() or send() call", max_call_secs)
+    #undef UHD_RIG_METRIC
+    return ss.str();
+}
+
+//! Answer every HTTP request with the metrics, until the streams stop
+static void serve_metrics(
+    boost::asio::io_service *io_service,
+    tcp::acceptor *acceptor,
+    const std::vector<stream_t::sptr> *streams
+){
+    acceptor->non_blocking(true);
+    while (not stop_signal_called) {
+        tcp::socket socket(*io_service);
+        boost::system::error_code ec;
+        acceptor->accept(socket, ec);
+        if (ec == boost::asio::error::would_block or ec == boost::asio::error::try_again) {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+            continue;
+        }
+        if (ec) return;
+
+        //read the request head, which is not looked at: every path gets the metrics
+        socket.non_blocking(false);
+        boost::asio::streambuf request;
+        boost::asio::read_until(socket, request, "\r\n\r\n", ec);
+
+        const std::string body = format_metrics(*streams);
+        const std::string response = str(boost::format(
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: %u\r\n"
+            "\r\n%s") % body.size() % body);
+        boost::asio::write(socket, boost::asio::buffer(response), ec);
+        socket.close(ec);
+    }
+}
+
+static void print_stats(
+    const std::vector<stream_t::sptr> &streams,
+    std::vector<stream_stats_t> &last,
+    const double interval
+){
+    for (size_t i = 0; i < streams.size(); i++) {
+        const stream_stats_t now = streams[i]->get_stats();
+        std::cout << boost::format(
+            "%-12s %-8s #%-2u %9.3f Msps  O %-6llu D %-6llu U %-6llu S %-6llu L %-6llu T %-6llu max call %.3f ms"
+        ) % streams[i]->device % streams[i]->type % streams[i]->index
+          % ((now.num_samps - last[i].num_samps)/interval/1e6)
+          % now.num_overflows % now.num_dropped % now.num_underflows
+          % now.num_seq_errors % now.num_late % now.num_timeouts
+          % (now.max_call_secs*1e3) << std::endl;
+        last[i] = now;
+    }
+}
+
+/***********************************************************************
+ * Main code + dispatcher
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    uhd::set_thread_priority_safe();
+
+    std::string config_file;
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("config", po::value<std::string>(&config_file), "JSON file describing the devices and streams")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help") or not vm.count("config")) {
+        std::cout << boost::format("UHD Stream Rig %s") % desc << std::endl;
+        std::cout <<
+        "    Runs the streams of a config file until the duration is over or\n"
+        "    Ctrl-C, and serves their counters for Prometheus. Example:\n"
+        "\n"
+        "    {\n"
+        "      \"duration\": 259200,\n"
+        "      \"stats_port\": 9100,\n"
+        "      \"stats_interval\": 10,\n"
+        "      \"devices\": [\n"
+        "        {\"name\": \"x310\", \"args\": \"addr=192.168.40.2\", \"streams\": [\n"
+        "          {\"type\": \"rx\", \"channels\": \"0,1\", \"rate\": 50e6},\n"
+        "          {\"type\": \"tx\", \"channels\": \"0\", \"rate\": 50e6, \"cpu\": \"sc16\"},\n"
+        "          {\"type\": \"loopback\", \"rx_channels\": \"0\", \"tx_channels\": \"1\", \"rate\": 10e6}\n"
+        "        ]}\n"
+        "      ]\n"
+        "    }\n"
+        "\n"
+        "    duration is in seconds, 0 runs until Ctrl-C. stats_port 0 disables\n"
+        "    the HTTP endpoint. Streams default to fc32 on the host, sc16 over\n"
+        "    the wire and the transport's samples per packet (spp 0).\n"
+        << std::endl;
+        return ~0;
+    }
+
+    pt::ptree config;
+    pt::read_json(config_file, config);
+    const double duration = config.get<double>("duration", 0.0);
+    const unsigned short stats_port = config.get<unsigned short>("stats_port", 9100);
+    const double stats_interval = config.get<double>("stats_interval", 10.0);
+
+    //create the devices and their streamers
+    std::vector<stream_t::sptr> streams;
+    BOOST_FOREACH(const pt::ptree::value_type &dev, config.get_child("devices")) {
+        const std::string name = dev.second.get<std::string>("name", dev.second.get<std::string>("args", ""));
+        std::cout << boost::format("Creating the usrp device %s with: %s...") % name % dev.second.get<std::string>("args", "") << std::endl;
+        uhd::usrp::multi_usrp::sptr usrp = uhd::usrp::multi_usrp::make(dev.second.get<std::string>("args", ""));
+
+        size_t index = 0;
+        BOOST_FOREACH(const pt::ptree::value_type &s, dev.second.get_child("streams")) {
+            stream_t::sptr stream(new stream_t());
+            stream->device = name;
+            stream->index = index++;
+            stream->usrp = usrp;
+            stream->type = s.second.get<std::string>("type");
+            stream->cpu = s.second.get<std::string>("cpu", "fc32");
+            stream->otw = s.second.get<std::string>("otw", "sc16");
+            stream->rate = s.second.get<double>("rate", 0.0);
+            stream->spp = s.second.get<size_t>("spp", 0);
+            if (stream->type == "rx") {
+                stream->rx_channels = get_channels(s.second.get<std::string>("channels", "0"));
+            } else if (stream->type == "tx") {
+                stream->tx_channels = get_channels(s.second.get<std::string>("channels", "0"));
+            } else if (stream->type == "loopback") {
+                stream->rx_channels = get_channels(s.second.get<std::string>("rx_channels", "0"));
+                stream->tx_channels = get_channels(s.second.get<std::string>("tx_channels", "0"));
+                if (stream->rx_channels.size() != stream->tx_channels.size()) {
+                    throw uhd::value_error("A loopback stream needs as many RX as TX channels.");
+                }
+            } else {
+                throw uhd::value_error("Unknown stream type: " + stream->type);
+            }
+
+            uhd::stream_args_t stream_args(stream->cpu, stream->otw);
+            if (stream->spp != 0) stream_args.args["spp"] = boost::lexical_cast<std::string>(stream->spp);
+            if (not stream->rx_channels.empty()) {
+                BOOST_FOREACH(const size_t chan, stream->rx_channels) {
+                    if (stream->rate > 0.0) usrp->set_rx_rate(stream->rate, chan);
+                }
+                stream_args.channels = stream->rx_channels;
+                stream->rx_stream = usrp->get_rx_stream(stream_args);
+            }
+            if (not stream->tx_channels.empty()) {
+                BOOST_FOREACH(const size_t chan, stream->tx_channels) {
+                    if (stream->rate > 0.0) usrp->set_tx_rate(stream->rate, chan);
+                }
+                stream_args.channels = stream->tx_channels;
+                stream->tx_stream = usrp->get_tx_stream(stream_args);
+            }
+            streams.push_back(stream);
+        }
+    }
+
+    //serve the metrics on the local host only
+    boost::asio::io_service io_service;
+    tcp::acceptor acceptor(io_service);
+    boost::thread_group thread_group;
+    if (stats_port != 0) {
+        const tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), stats_port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(tcp::acceptor::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        std::cout << boost::format("Serving metrics on http://127.0.0.1:%u/metrics") % stats_port << std::endl;
+    }
+    boost::thread *server_thread = (stats_port != 0)?
+        new boost::thread(boost::bind(&serve_metrics, &io_service, &acceptor, &streams)) : NULL;
+
+    std::signal(SIGINT, &sig_int_handler);
+    BOOST_FOREACH(const stream_t::sptr &stream, streams) {
+        thread_group.create_thread(boost::bind(&run_stream, stream));
+    }
+    std::cout << boost::format("Running %u streams, press Ctrl + C to stop...") % streams.size() << std::endl;
+
+    //print the counters every interval until the end
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    std::vector<stream_stats_t> last(streams.size());
+    double next_print = stats_interval;
+    while (not stop_signal_called) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+        const double elapsed = secs_since(start);
+        if (duration > 0.0 and elapsed >= duration) stop_signal_called = true;
+        if (elapsed >= next_print) {
+            std::cout << boost::format("--- %.0f s") % elapsed << std::endl;
+            print_stats(streams, last, stats_interval);
+            next_print += stats_interval;
+        }
+    }
+
+    thread_group.join_all();
+    if (server_thread != NULL) {
+        server_thread->join();
+        delete server_thread;
+    }
+
+    std::cout << std::endl << "Totals:" << std::endl;
+    std::vector<stream_stats_t> zero(streams.size());
+    print_stats(streams, zero, secs_since(start));
+
+    //finished
+    std::cout << std::endl << "Done!" << std::endl << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,726 @@
+//
+// Copyright 2016 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+//
+// chdr_stats: per-SID statistics of a CHDR capture.
+//
+// The capture (pcap or pcapng) is mapped into memory, cut into chunks of
+// whole records, and the chunks are parsed by one thread each. The chunk
+// results are merged in file order, so sequence gaps and bursts that
+// cross a chunk boundary are still accounted for. Flow control ack
+// latencies are matched within a chunk only; with millions of packets
+// per chunk the few acks at the boundaries do not change the figures.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Endpoint encodings for USRP3 from SID LSB's, as in uhd_dump.h
+#define RADIO 0
+#define RADIO_CTRL 1
+#define SRC_FLOW_CTRL 2
+
+// CHDR bit masks
+#define EXT_CONTEXT (1u<<31)
+#define HAS_TIME (1u<<29)
+#define EOB (1u<<28)
+
+// UDP used as source for all CHDR comms.
+#define CHDR_PORT 49153
+
+#define ETH_SIZE 14
+#define UDP_SIZE 8
+#define CHDR_SIZE 8
+#define VITA_TIME_SIZE 8
+
+#define TX_ACK 0x00
+
+#define MAX_SIDS 4096           // Power of 2, distinct SIDs per capture
+#define MAX_STREAMS 256         // Data streams with flow control matching, per chunk
+#define SEQ_RANGE 4096          // CHDR sequence numbers are 12 bits
+#define MAX_INTERFACES 16       // pcapng interfaces with their own time resolution
+#define MAX_THREADS 64
+
+typedef unsigned char u8;
+typedef unsigned short u16;
+typedef unsigned int u32;
+typedef unsigned long long u64;
+
+/*
+  Capture file formats
+*/
+
+#define PCAP_MAGIC_US 0xa1b2c3d4
+#define PCAP_MAGIC_NS 0xa1b23c4d
+#define PCAP_HDR_SIZE 24
+#define PCAP_REC_SIZE 16
+
+#define PCAPNG_SHB 0x0A0D0D0A
+#define PCAPNG_IDB 0x00000001
+#define PCAPNG_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER 0x1A2B3C4D
+#define PCAPNG_IF_TSRESOL 9
+
+struct capture {
+  const u8 *data;
+  u64 size;
+  int pcapng;
+  int swapped;                  // File byte order differs from ours
+  u64 ns_per_tick;              // Classic pcap: 1000 (us) or 1 (ns)
+  u64 if_ticks_per_sec[MAX_INTERFACES]; // pcapng
+  int num_interfaces;
+};
+
+// One captured packet
+struct record {
+  u64 ts_ns;
+  const u8 *frame;
+  u32 caplen;
+};
+
+/*
+  Per-SID statistics
+*/
+
+struct sid_stats {
+  int used;
+  u32 sid;
+  int h2u;                      // Host -> USRP
+  int endpoint;                 // Device side endpoint type, low 2 bits of SID
+  u64 packets;
+  u64 bytes;                    // CHDR bytes, from the CHDR size field
+  u64 ext_packets;              // Extension context (response/ack/ctrl) packets
+  u64 first_ts, last_ts;
+  u32 first_seq, last_seq;
+  u64 gaps;                     // Number of sequence discontinuities
+  u64 lost;                     // Packets missing according to the sequence
+  // Bursts: complete ones in the sum, the one still open in open_start_ts
+  u64 bursts;
+  u64 burst_ns_sum;
+  u64 burst_ns_max;
+  int in_burst;
+  u64 open_start_ts;
+  int seen_eob;                 // An EOB was seen in this chunk
+  u64 first_eob_ts;
+  // Flow control acks that came back for this (data) stream
+  u64 fc_acks;
+  u64 fc_ns_sum;
+  u64 fc_ns_max;
+};
+
+struct stream_ring {
+  u32 key;                      // Device side address of the stream, see stream_key()
+  int h2u;
+  int sid_index;
+  u64 ts[SEQ_RANGE];            // Capture time of the data packet with each sequence, 0 if none
+};
+
+struct chunk {
+  const struct capture *cap;
+  u64 start, end;               // Byte offsets of whole records
+  u16 port;                     // 0 for any UDP port
+  struct sid_stats sids[MAX_SIDS];
+  struct stream_ring *streams;
+  int num_streams;
+  u64 non_chdr;
+};
+
+static u16 rd16(const u8 *p, const int swapped)
+{
+  u16 x;
+  memcpy(&x,p,sizeof x);
+  return swapped ? (u16)((x>>8)|(x<<8)) : x;
+}
+
+static u32 rd32(const u8 *p, const int swapped)
+{
+  u32 x;
+  memcpy(&x,p,sizeof x);
+  return swapped ? __builtin_bswap32(x) : x;
+}
+
+// Network (big endian) order, which is also the CHDR order over Ethernet
+static u16 be16(const u8 *p)
+{
+  return (u16)((p[0]<<8) | p[1]);
+}
+
+static u32 be32(const u8 *p)
+{
+  return ((u32)p[0]<<24) | ((u32)p[1]<<16) | ((u32)p[2]<<8) | p[3];
+}
+
+/*
+  Capture file walking
+*/
+
+static void open_capture(const char *filename, struct capture *cap)
+{
+  struct stat st;
+  u32 magic;
+  int fd;
+  int x;
+
+  if ((fd = open(filename,O_RDONLY)) < 0) {
+    perror(filename);
+    exit(2);
+  }
+  if (fstat(fd,&st) < 0 || st.st_size < PCAP_HDR_SIZE) {
+    fprintf(stderr,"%s: not a capture file\n",filename);
+    exit(2);
+  }
+  cap->size = (u64)st.st_size;
+  cap->data = mmap(NULL,cap->size,PROT_READ,MAP_PRIVATE,fd,0);
+  if (cap->data == MAP_FAILED) {
+    perror("mmap");
+    exit(2);
+  }
+  close(fd);
+  madvise((void *)cap->data,cap->size,MADV_SEQUENTIAL);
+
+  memcpy(&magic,cap->data,sizeof magic);
+  cap->pcapng = 0;
+  cap->swapped = 0;
+  cap->ns_per_tick = 1000;
+  cap->num_interfaces = 0;
+  for (x = 0; x < MAX_INTERFACES; x++)
+    cap->if_ticks_per_sec[x] = 1000000;
+
+  if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+    cap->ns_per_tick = (magic == PCAP_MAGIC_NS) ? 1 : 1000;
+  } else if (magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS)) {
+    cap->swapped = 1;
+    cap->ns_per_tick = (magic == __builtin_bswap32(PCAP_MAGIC_NS)) ? 1 : 1000;
+  } else if (magic == PCAPNG_SHB) {
+    cap->pcapng = 1;
+    cap->swapped = (rd32(cap->data+8,0) != PCAPNG_BYTE_ORDER);
+  } else {
+    fprintf(stderr,"%s: unknown capture format, magic 0x%08x\n",filename,magic);
+    exit(2);
+  }
+}
+
+// Remember the time resolution of a pcapng interface description block.
+static void read_idb(struct capture *cap, const u8 *block, const u32 len)
+{
+  u64 off = 16;
+  u64 ticks = 1000000;
+  u8 res;
+  int x;
+
+  while (off + 4 <= (u64)len - 4) {
+    u16 code = rd16(block+off,cap->swapped);
+    u16 olen = rd16(block+off+2,cap->swapped);
+    if (code == 0)
+      break;
+    if (code == PCAPNG_IF_TSRESOL && olen >= 1) {
+      res = block[off+4];
+      ticks = 1;
+      if (res & 0x80)
+        for (x = 0; x < (res & 0x7f); x++) ticks *= 2;
+      else
+        for (x = 0; x < res; x++) ticks *= 10;
+    }
+    off += 4 + ((olen + 3) & ~3u);
+  }
+  if (cap->num_interfaces < MAX_INTERFACES)
+    cap->if_ticks_per_sec[cap->num_interfaces] = ticks;
+  cap->num_interfaces++;
+}
+
+// Get the record at *off and move *off past it. Returns 0 at the end of the
+// file, -1 for a block that holds no packet, 1 for a packet.
+static int next_record(const struct capture *cap, u64 *off, struct record *rec)
+{
+  const u8 *p = cap->data + *off;
+  u64 left = cap->size - *off;
+  u32 len, type, iface;
+  u64 ticks, ticks_per_sec;
+
+  if (!cap->pcapng) {
+    if (left < PCAP_REC_SIZE)
+      return 0;
+    len = rd32(p+8,cap->swapped);
+    if (len > left - PCAP_REC_SIZE)
+      return 0;                 // Truncated capture
+    rec->ts_ns = (u64)rd32(p,cap->swapped)*1000000000ull + (u64)rd32(p+4,cap->swapped)*cap->ns_per_tick;
+    rec->frame = p + PCAP_REC_SIZE;
+    rec->caplen = len;
+    *off += PCAP_REC_SIZE + len;
+    return 1;
+  }
+
+  if (left < 12)
+    return 0;
+  type = rd32(p,cap->swapped);
+  len = rd32(p+4,cap->swapped);
+  if (len < 12 || len > left || (len & 3))
+    return 0;
+  *off += len;
+  if (type != PCAPNG_EPB || len < 32)
+    return -1;
+  iface = rd32(p+8,cap->swapped);
+  ticks = ((u64)rd32(p+12,cap->swapped) << 32) | rd32(p+16,cap->swapped);
+  ticks_per_sec = cap->if_ticks_per_sec[iface < MAX_INTERFACES ? iface : 0];
+  rec->ts_ns = (ticks / ticks_per_sec)*1000000000ull + (ticks % ticks_per_sec)*1000000000ull/ticks_per_sec;
+  rec->frame = p + 28;
+  rec->caplen = rd32(p+20,cap->swapped);
+  if (rec->caplen > len - 32)
+    rec->caplen = len - 32;
+  return 1;
+}
+
+// Cut the capture into num_chunks ranges of whole records of about the
+// same size. The walk only touches record headers.
+static int split_capture(struct capture *cap, u64 *bounds, const int num_chunks)
+{
+  u64 off, next_bound;
+  struct record rec;
+  int n = 0;
+  int r;
+
+  if (cap->pcapng) {
+    off = 0;
+  } else {
+    off = PCAP_HDR_SIZE;
+  }
+  bounds[n++] = off;
+  next_bound = off + (cap->size - off)/num_chunks;
+
+  for (;;) {
+    if (cap->pcapng && cap->size - off >= 8 && rd32(cap->data+off,cap->swapped) == PCAPNG_IDB)
+      read_idb(cap,cap->data+off,rd32(cap->data+off+4,cap->swapped));
+    if ((r = next_record(cap,&off,&rec)) == 0)
+      break;
+    if (off >= next_bound && n < num_chunks) {
+      bounds[n++] = off;
+      next_bound = off + (cap->size - off)/(num_chunks - n + 1);
+    }
+  }
+  bounds[n] = off;
+  return n;
+}
+
+/*
+  Parsing of one chunk
+*/
+
+static struct sid_stats *find_sid(struct sid_stats *sids, const u32 sid)
+{
+  u32 h = (sid * 2654435761u) & (MAX_SIDS - 1);
+  u32 x;
+
+  for (x = 0; x < MAX_SIDS; x++) {
+    struct sid_stats *s = &sids[(h + x) & (MAX_SIDS - 1)];
+    if (!s->used) {
+      s->used = 1;
+      s->sid = sid;
+      return s;
+    }
+    if (s->sid == sid)
+      return s;
+  }
+  fprintf(stderr,"More than %d SIDs in capture, exiting.\n",MAX_SIDS);
+  exit(2);
+}
+
+// Device side address of a stream, shared by its data and its flow
+// control/response packets: the device byte and the endpoint without the
+// endpoint type bits.
+static u32 stream_key(const u32 sid, const int h2u)
+{
+  u32 device_side = h2u ? (sid & 0xFFFF) : (sid >> 16);
+  return device_side & ~3u;
+}
+
+static struct stream_ring *find_stream(struct chunk *c, const u32 key, const int h2u, const int create)
+{
+  int x;
+
+  for (x = 0; x < c->num_streams; x++)
+    if (c->streams[x].key == key && c->streams[x].h2u == h2u)
+      return &c->streams[x];
+  if (!create || c->num_streams == MAX_STREAMS)
+    return NULL;
+  x = c->num_streams++;
+  memset(&c->streams[x],0,sizeof c->streams[x]);
+  c->streams[x].key = key;
+  c->streams[x].h2u = h2u;
+  c->streams[x].sid_index = -1;
+  return &c->streams[x];
+}
+
+static void add_fc_ack(struct chunk *c, const u32 key, const int data_h2u, const u32 seq, const u64 ts)
+{
+  struct stream_ring *stream = find_stream(c,key,data_h2u,0);
+  struct sid_stats *data;
+  u64 sent, latency;
+
+  if (stream == NULL || stream->sid_index < 0)
+    return;
+  sent = stream->ts[seq & (SEQ_RANGE-1)];
+  if (sent == 0 || sent > ts)
+    return;
+  stream->ts[seq & (SEQ_RANGE-1)] = 0;
+  latency = ts - sent;
+  data = &c->sids[stream->sid_index];
+  data->fc_acks++;
+  data->fc_ns_sum += latency;
+  if (latency > data->fc_ns_max)
+    data->fc_ns_max = latency;
+}
+
+static void parse_packet(struct chunk *c, const struct record *rec)
+{
+  const u8 *p = rec->frame;
+  u32 left = rec->caplen;
+  u16 eth_typ, src_port, dst_port;
+  u32 ihl, hdr, sid, seq, size, payload_off;
+  int h2u, endpoint, is_ext;
+  struct sid_stats *s;
+  struct stream_ring *stream;
+
+  // Ethernet, with an optional VLAN tag
+  if (left < ETH_SIZE)
+    goto not_chdr;
+  eth_typ = be16(p+12);
+  p += ETH_SIZE;
+  left -= ETH_SIZE;
+  if (eth_typ == 0x8100) {
+    if (left < 4)
+      goto not_chdr;
+    eth_typ = be16(p+2);
+    p += 4;
+    left -= 4;
+  }
+  if (eth_typ != 0x0800)
+    goto not_chdr;
+
+  // IPv4, UDP
+  if (left < 20 || (p[0] >> 4) != 4 || p[9] != 17)
+    goto not_chdr;
+  ihl = (p[0] & 0xf)*4;
+  if (left < ihl + UDP_SIZE + CHDR_SIZE)
+    goto not_chdr;
+  p += ihl;
+  left -= ihl;
+  src_port = be16(p);
+  dst_port = be16(p+2);
+  if (c->port && src_port != c->port && dst_port != c->port)
+    goto not_chdr;
+  p += UDP_SIZE;
+  left -= UDP_SIZE;
+
+  // CHDR. The reserved bit is always 0, and the host uses device address 0.
+  hdr = be32(p);
+  sid = be32(p+4);
+  if ((hdr & 0x40000000) != 0)
+    goto not_chdr;
+  h2u = ((sid >> 24) == 0);
+  if (!h2u && ((sid >> 8) & 0xFF) != 0)
+    goto not_chdr;
+  endpoint = h2u ? (sid & 0x3) : ((sid >> 16) & 0x3);
+  is_ext = (hdr & EXT_CONTEXT) != 0;
+  seq = (hdr >> 16) & 0xFFF;
+  size = hdr & 0xFFFF;
+  payload_off = CHDR_SIZE + ((hdr & HAS_TIME) ? VITA_TIME_SIZE : 0);
+
+  s = find_sid(c->sids,sid);
+  if (s->packets == 0) {
+    s->h2u = h2u;
+    s->endpoint = endpoint;
+    s->first_ts = rec->ts_ns;
+    s->first_seq = seq;
+  } else if (seq != ((s->last_seq + 1) & 0xFFF)) {
+    s->gaps++;
+    s->lost += (seq - s->last_seq - 1) & 0xFFF;
+  }
+  s->packets++;
+  s->bytes += size;
+  s->ext_packets += is_ext;
+  s->last_ts = rec->ts_ns;
+  s->last_seq = seq;
+
+  if (endpoint == RADIO && !is_ext) {
+    // Data: bursts, and the send times for the flow control matching
+    if (!s->in_burst) {
+      s->in_burst = 1;
+      s->open_start_ts = rec->ts_ns;
+    }
+    if (hdr & EOB) {
+      if (!s->seen_eob) {
+        // Its start may be in an earlier chunk, the merge decides
+        s->seen_eob = 1;
+        s->first_eob_ts = rec->ts_ns;
+      } else {
+        u64 d = rec->ts_ns - s->open_start_ts;
+        s->bursts++;
+        s->burst_ns_sum += d;
+        if (d > s->burst_ns_max)
+          s->burst_ns_max = d;
+      }
+      s->in_burst = 0;
+    }
+    stream = find_stream(c,stream_key(sid,h2u),h2u,1);
+    if (stream != NULL) {
+      stream->sid_index = (int)(s - c->sids);
+      stream->ts[seq] = rec->ts_ns;
+    }
+  } else if (is_ext && left >= payload_off + 8) {
+    // Host flow control for RX data, or device ack for TX data
+    if (h2u && endpoint == SRC_FLOW_CTRL)
+      add_fc_ack(c,stream_key(sid,h2u),0,be32(p+payload_off+4),rec->ts_ns);
+    else if (!h2u && endpoint == RADIO && be32(p+payload_off) == TX_ACK)
+      add_fc_ack(c,stream_key(sid,h2u),1,be32(p+payload_off+4),rec->ts_ns);
+  }
+  return;
+
+ not_chdr:
+  c->non_chdr++;
+}
+
+static void *parse_chunk(void *arg)
+{
+  struct chunk *c = arg;
+  struct record rec;
+  u64 off = c->start;
+  int r;
+
+  while (off < c->end && (r = next_record(c->cap,&off,&rec)) != 0)
+    if (r > 0)
+      parse_packet(c,&rec);
+  return NULL;
+}
+
+/*
+  Merging of the chunk results, in file order
+*/
+
+static void merge_sid(struct sid_stats *m, const struct sid_stats *s)
+{
+  if (m->packets == 0) {
+    *m = *s;
+    // The burst up to the first EOB of this chunk is complete
+    if (s->seen_eob) {
+      u64 d = s->first_eob_ts - s->first_ts;
+      m->bursts++;
+      m->burst_ns_sum += d;
+      if (d > m->burst_ns_max)
+        m->burst_ns_max = d;
+    }
+    m->seen_eob = 0;
+    return;
+  }
+
+  if (s->first_seq != ((m->last_seq + 1) & 0xFFF)) {
+    m->gaps++;
+    m->lost += (s->first_seq - m->last_seq - 1) & 0xFFF;
+  }
+  if (s->seen_eob) {
+    // The first EOB closes the burst open in m, or one that started in this chunk
+    u64 d = s->first_eob_ts - (m->in_burst ? m->open_start_ts : s->first_ts);
+    m->bursts++;
+    m->burst_ns_sum += d;
+    if (d > m->burst_ns_max)
+      m->burst_ns_max = d;
+    m->in_burst = s->in_burst;
+    m->open_start_ts = s->open_start_ts;
+  } else if (!m->in_burst && s->in_burst) {
+    m->in_burst = 1;
+    m->open_start_ts = s->open_start_ts;
+  }
+  m->packets += s->packets;
+  m->bytes += s->bytes;
+  m->ext_packets += s->ext_packets;
+  m->last_ts = s->last_ts;
+  m->last_seq = s->last_seq;
+  m->gaps += s->gaps;
+  m->lost += s->lost;
+  m->bursts += s->bursts;
+  m->burst_ns_sum += s->burst_ns_sum;
+  if (s->burst_ns_max > m->burst_ns_max)
+    m->burst_ns_max = s->burst_ns_max;
+  m->fc_acks += s->fc_acks;
+  m->fc_ns_sum += s->fc_ns_sum;
+  if (s->fc_ns_max > m->fc_ns_max)
+    m->fc_ns_max = s->fc_ns_max;
+}
+
+static int compare_sid(const void *a, const void *b)
+{
+  const struct sid_stats *x = a, *y = b;
+  return (x->sid > y->sid) - (x->sid < y->sid);
+}
+
+/*
+  Output
+*/
+
+static const char *endpoint_name(const struct sid_stats *s)
+{
+  if (s->endpoint == RADIO)
+    return s->h2u ? "tx_data" : (s->ext_packets == s->packets ? "tx_resp" : "rx_data");
+  if (s->endpoint == RADIO_CTRL)
+    return s->h2u ? "ctrl" : "ctrl_resp";
+  if (s->endpoint == SRC_FLOW_CTRL)
+    return "flow_ctrl";
+  return "other";
+}
+
+static void print_stats(const struct sid_stats *sids, const int num_sids, const u64 origin_ts, const int json)
+{
+  int x;
+
+  if (json)
+    fprintf(stdout,"[\n");
+  else
+    fprintf(stdout,"sid,direction,type,packets,bytes,start_s,duration_s,mbytes_per_s,"
+            "seq_gaps,lost_packets,bursts,burst_mean_us,burst_max_us,fc_acks,fc_mean_us,fc_max_us\n");
+
+  for (x = 0; x < num_sids; x++) {
+    const struct sid_stats *s = &sids[x];
+    double duration = (double)(s->last_ts - s->first_ts)/1e9;
+    char sid_str[32];
+
+    sprintf(sid_str,"%02x.%02x>%02x.%02x",s->sid>>24,(s->sid>>16)&0xFF,(s->sid>>8)&0xFF,s->sid&0xFF);
+    fprintf(stdout,json ?
+            "  {\"sid\": \"%s\", \"direction\": \"%s\", \"type\": \"%s\", \"packets\": %llu, \"bytes\": %llu, "
+            "\"start_s\": %.9f, \"duration_s\": %.9f, \"mbytes_per_s\": %.3f, \"seq_gaps\": %llu, \"lost_packets\": %llu, "
+            "\"bursts\": %llu, \"burst_mean_us\": %.3f, \"burst_max_us\": %.3f, \"fc_acks\": %llu, \"fc_mean_us\": %.3f, \"fc_max_us\": %.3f}%s\n"
+            :
+            "%s,%s,%s,%llu,%llu,%.9f,%.9f,%.3f,%llu,%llu,%llu,%.3f,%.3f,%llu,%.3f,%.3f%s\n",
+            sid_str,s->h2u ? "host_to_usrp" : "usrp_to_host",endpoint_name(s),
+            s->packets,s->bytes,(double)(s->first_ts - origin_ts)/1e9,duration,
+            duration > 0 ? (double)s->bytes/duration/1e6 : 0.0,
+            s->gaps,s->lost,s->bursts,
+            s->bursts ? (double)s->burst_ns_sum/s->bursts/1e3 : 0.0,(double)s->burst_ns_max/1e3,
+            s->fc_acks,s->fc_acks ? (double)s->fc_ns_sum/s->fc_acks/1e3 : 0.0,(double)s->fc_ns_max/1e3,
+            (json && x + 1 < num_sids) ? "," : "");
+  }
+
+  if (json)
+    fprintf(stdout,"]\n");
+}
+
+void usage()
+{
+  fprintf(stderr,"Usage: chdr_stats [-j] [-t threads] [-p udp_port] filename.pcap|filename.pcapng\n");
+  fprintf(stderr,"  -j  JSON output instead of CSV\n");
+  fprintf(stderr,"  -t  number of parsing threads, default one per CPU\n");
+  fprintf(stderr,"  -p  UDP port of the CHDR traffic, default %d, 0 for any port\n",CHDR_PORT);
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  struct capture cap;                   // The mapped capture file
+  struct chunk *chunks;                 // Work and results of each thread
+  pthread_t threads[MAX_THREADS];
+  u64 bounds[MAX_THREADS+1];            // Byte offsets of the chunks
+  struct sid_stats *merged;             // Results of all chunks
+  struct sid_stats *sorted;
+  u64 non_chdr = 0;
+  u64 origin_ts = ~0ull;                // Timestamp of first packet in file.
+  int num_threads;
+  int num_chunks;
+  int json = 0;
+  int port = CHDR_PORT;
+  int num_sids = 0;
+  int c, x, y;
+
+  num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  while ((c = getopt(argc, argv, "jt:p:")) != -1) {
+    switch(c) {
+    case 'j':
+      json = 1;
+      break;
+    case 't':
+      num_threads = atoi(optarg);
+      break;
+    case 'p':
+      port = atoi(optarg);
+      if (port < 0 || port > 65535)
+        usage();
+      break;
+    case'?':
+    default:
+      usage();
+    }
+  }
+  if (optind != argc - 1)
+    usage();
+  if (num_threads < 1)
+    num_threads = 1;
+  if (num_threads > MAX_THREADS)
+    num_threads = MAX_THREADS;
+
+  open_capture(argv[optind],&cap);
+  num_chunks = split_capture(&cap,bounds,num_threads);
+
+  chunks = calloc(num_chunks,sizeof(struct chunk));
+  merged = calloc(MAX_SIDS,sizeof(struct sid_stats));
+  sorted = calloc(MAX_SIDS,sizeof(struct sid_stats));
+  if (chunks == NULL || merged == NULL || sorted == NULL) {
+    fprintf(stderr,"Out of memory.\n");
+    exit(2);
+  }
+
+  for (x = 0; x < num_chunks; x++) {
+    chunks[x].cap = &cap;
+    chunks[x].start = bounds[x];
+    chunks[x].end = bounds[x+1];
+    chunks[x].port = (u16)port;
+    chunks[x].streams = malloc(MAX_STREAMS*sizeof(struct stream_ring));
+    if (chunks[x].streams == NULL || pthread_create(&threads[x],NULL,parse_chunk,&chunks[x]) != 0) {
+      fprintf(stderr,"Could not start parsing thread.\n");
+      exit(2);
+    }
+  }
+
+  for (x = 0; x < num_chunks; x++) {
+    pthread_join(threads[x],NULL);
+    non_chdr += chunks[x].non_chdr;
+    for (y = 0; y < MAX_SIDS; y++) {
+      const struct sid_stats *s = &chunks[x].sids[y];
+      if (!s->used)
+        continue;
+      merge_sid(find_sid(merged,s->sid),s);
+      if (s->first_ts < origin_ts)
+        origin_ts = s->first_ts;
+    }
+    free(chunks[x].streams);
+  }
+
+  for (y = 0; y < MAX_SIDS; y++)
+    if (merged[y].used)
+      sorted[num_sids++] = merged[y];
+  qsort(sorted,num_sids,sizeof(struct sid_stats),compare_sid);
+
+  print_stats(sorted,num_sids,origin_ts,json);
+  fprintf(stderr,"%d SIDs, %llu packets skipped as not CHDR, %d threads\n",num_sids,non_chdr,num_chunks);
+
+  // Normal Exit
+  return(0);
+}
@@ -0,0 +1,259 @@
+//
+// Copyright 2017 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+//
+// flight_log: print a dump of the UHD flight recorder.
+//
+// The dump holds the last records of every streaming thread of the host
+// (see uhd/utils/flight_recorder.hpp). The records of all threads are
+// merged by time and printed one per line, followed by per-SID packet
+// counts and sequence gaps and the list of errors, so the packets around
+// a drop can be seen without a packet capture.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#define MAX_SIDS 1024
+
+// The file format, as in uhd/utils/flight_recorder.hpp
+struct file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t ticks_per_sec;
+  uint32_t num_threads;
+  uint32_t reserved;
+};
+
+struct thread_header {
+  uint32_t thread;
+  uint32_t num_records;
+  uint64_t num_lost;
+};
+
+struct record {
+  uint64_t ticks;
+  uint64_t tsf;
+  uint32_t sid;
+  uint32_t seq;
+  uint32_t value;
+  uint8_t type;
+  uint8_t flags;
+  uint16_t chan;
+};
+
+#define FLAG_HAS_TSF (1<<0)
+#define FLAG_SOB (1<<1)
+#define FLAG_EOB (1<<2)
+
+// A record, and the thread that wrote it
+struct entry {
+  struct record rec;
+  uint32_t thread;
+};
+
+struct sid_stats {
+  uint32_t sid;
+  char type;
+  uint64_t packets;
+  uint64_t bytes;
+  uint64_t gaps;
+  uint64_t errors;
+  uint32_t last_seq;
+};
+
+const char *error_name(uint32_t code)
+{
+  switch(code) {
+  case 0x1: return "timeout";
+  case 0x2: return "late command";
+  case 0x4: return "broken chain";
+  case 0x8: return "overflow";
+  case 0xc: return "alignment";
+  case 0xf: return "bad packet";
+  default: return "unknown";
+  }
+}
+
+int compare_entries(const void *a, const void *b)
+{
+  const struct entry *x = a;
+  const struct entry *y = b;
+  if (x->rec.ticks != y->rec.ticks)
+    return x->rec.ticks < y->rec.ticks ? -1 : 1;
+  return (int)x->thread - (int)y->thread;
+}
+
+struct sid_stats *find_sid(struct sid_stats *sids, int *num_sids, uint32_t sid, char type)
+{
+  int x;
+  for (x = 0; x < *num_sids; x++)
+    if (sids[x].sid == sid && sids[x].type == type)
+      return &sids[x];
+  if (*num_sids == MAX_SIDS)
+    return NULL;
+  memset(&sids[*num_sids],0,sizeof(struct sid_stats));
+  sids[*num_sids].sid = sid;
+  sids[*num_sids].type = type;
+  return &sids[(*num_sids)++];
+}
+
+void print_sid(uint32_t sid)
+{
+  fprintf(stdout,"%02x.%02x>%02x.%02x",sid>>24,(sid>>16)&0xFF,(sid>>8)&0xFF,sid&0xFF);
+}
+
+void usage()
+{
+  fprintf(stderr,"Usage: flight_log [-s] uhd_flight_recorder.dat\n");
+  fprintf(stderr,"  -s  summary only, without the records\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *in;
+  struct file_header header;
+  struct entry *entries = NULL;
+  struct sid_stats sids[MAX_SIDS];
+  size_t num_entries = 0;
+  size_t i;
+  double usecs_per_tick;
+  int summary_only = 0;
+  int num_sids = 0;
+  int c, x;
+
+  while ((c = getopt(argc, argv, "s")) != -1) {
+    switch(c) {
+    case 's':
+      summary_only = 1;
+      break;
+    case'?':
+    default:
+      usage();
+    }
+  }
+  if (optind != argc - 1)
+    usage();
+
+  in = fopen(argv[optind],"rb");
+  if (in == NULL) {
+    perror(argv[optind]);
+    exit(2);
+  }
+  if (fread(&header,sizeof(header),1,in) != 1 || memcmp(header.magic,"UHDFLREC",8) != 0) {
+    fprintf(stderr,"%s: not a flight recorder dump\n",argv[optind]);
+    exit(2);
+  }
+  if (header.version != 1 || header.record_size != sizeof(struct record)) {
+    fprintf(stderr,"%s: unknown version %u\n",argv[optind],header.version);
+    exit(2);
+  }
+  usecs_per_tick = header.ticks_per_sec ? 1e6/(double)header.ticks_per_sec : 0.0;
+
+  for (x = 0; x < (int)header.num_threads; x++) {
+    struct thread_header thread;
+    if (fread(&thread,sizeof(thread),1,in) != 1) {
+      fprintf(stderr,"%s: truncated\n",argv[optind]);
+      exit(2);
+    }
+    entries = realloc(entries,(num_entries + thread.num_records)*sizeof(struct entry));
+    if (entries == NULL) {
+      fprintf(stderr,"Out of memory.\n");
+      exit(2);
+    }
+    for (i = 0; i < thread.num_records; i++) {
+      if (fread(&entries[num_entries].rec,sizeof(struct record),1,in) != 1) {
+        fprintf(stderr,"%s: truncated\n",argv[optind]);
+        exit(2);
+      }
+      entries[num_entries++].thread = thread.thread;
+    }
+    fprintf(stderr,"thread %u: %u records, %llu older ones overwritten\n",
+            thread.thread,thread.num_records,(unsigned long long)thread.num_lost);
+  }
+  fclose(in);
+
+  qsort(entries,num_entries,sizeof(struct entry),compare_entries);
+
+  if (!summary_only)
+    fprintf(stdout,"time_us,thread,type,chan,sid,seq,tsf,value,flags\n");
+  for (i = 0; i < num_entries; i++) {
+    const struct record *r = &entries[i].rec;
+    struct sid_stats *s = find_sid(sids,&num_sids,r->sid,(char)r->type);
+
+    if (s != NULL) {
+      if (r->type == 'R' || r->type == 'T') {
+        // CHDR sequence numbers have 12 bits
+        if (s->packets > 0 && r->seq != ((s->last_seq + 1) & 0xFFF))
+          s->gaps++;
+        s->packets++;
+        s->bytes += r->value;
+        s->last_seq = r->seq;
+      }
+      else if (r->type == 'E')
+        s->errors++;
+      else
+        s->packets++;
+    }
+
+    if (summary_only)
+      continue;
+    fprintf(stdout,"%.3f,%u,%c,%u,",
+            (double)(r->ticks - entries[0].rec.ticks)*usecs_per_tick,
+            entries[i].thread,r->type,r->chan);
+    print_sid(r->sid);
+    fprintf(stdout,",%u,",r->seq);
+    if (r->flags & FLAG_HAS_TSF)
+      fprintf(stdout,"%llu",(unsigned long long)r->tsf);
+    if (r->type == 'E')
+      fprintf(stdout,",%s,",error_name(r->value));
+    else if (r->type == 'C')
+      fprintf(stdout,",0x%x,",r->value);
+    else
+      fprintf(stdout,",%u,",r->value);
+    fprintf(stdout,"%s%s%s\n",(r->flags & FLAG_SOB) ? "sob" : "",
+            ((r->flags & FLAG_SOB) && (r->flags & FLAG_EOB)) ? " " : "",(r->flags & FLAG_EOB) ? "eob" : "");
+  }
+
+  fprintf(stdout,"\nsid,type,records,bytes,seq_gaps,errors\n");
+  for (x = 0; x < num_sids; x++) {
+    print_sid(sids[x].sid);
+    fprintf(stdout,",%c,%llu,%llu,%llu,%llu\n",sids[x].type,
+            (unsigned long long)sids[x].packets,(unsigned long long)sids[x].bytes,
+            (unsigned long long)sids[x].gaps,(unsigned long long)sids[x].errors);
+  }
+
+  fprintf(stdout,"\nErrors:\n");
+  for (i = 0; i < num_entries; i++) {
+    const struct record *r = &entries[i].rec;
+    if (r->type != 'E')
+      continue;
+    fprintf(stdout,"  %.3f us: %s on channel %u, ",
+            (double)(r->ticks - entries[0].rec.ticks)*usecs_per_tick,error_name(r->value),r->chan);
+    print_sid(r->sid);
+    fprintf(stdout," seq %u\n",r->seq);
+  }
+
+  free(entries);
+  // Normal Exit
+  return(0);
+}